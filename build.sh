@@ -32,6 +32,10 @@ do
         CMAKE_EXTRA_OPTIONS="-DOPENCL_MINE=1 ${CMAKE_EXTRA_OPTIONS}"
         echo "Build with OpenCL"
     ;;
+    secp256k1)
+        CMAKE_EXTRA_OPTIONS="-DUSE_SECP256K1=ON ${CMAKE_EXTRA_OPTIONS}"
+        echo "Build with libsecp256k1 curve backend"
+    ;;
     tsan)
         CMAKE_EXTRA_OPTIONS="-DTHREAD_SANITIZER=ON ${CMAKE_EXTRA_OPTIONS}"
         echo "Build with ThreadSanitizer"
@@ -50,6 +54,22 @@ do
         run_clang_tidy_fix=1
         echo "Build with LLVM Extra Tools for linter check (clang-tidy-fix)"
     ;;
+    lto)
+        CMAKE_EXTRA_OPTIONS="-DENABLE_LTO=ON ${CMAKE_EXTRA_OPTIONS}"
+        echo "Build with link-time optimization"
+    ;;
+    pch)
+        CMAKE_EXTRA_OPTIONS="-DENABLE_PCH=ON ${CMAKE_EXTRA_OPTIONS}"
+        echo "Build with precompiled headers"
+    ;;
+    pgo-gen)
+        CMAKE_EXTRA_OPTIONS="-DPGO_GENERATE=ON -DPGO_USE=OFF ${CMAKE_EXTRA_OPTIONS}"
+        echo "Build instrumented for profile-guided optimization"
+    ;;
+    pgo-use)
+        CMAKE_EXTRA_OPTIONS="-DPGO_GENERATE=OFF -DPGO_USE=ON ${CMAKE_EXTRA_OPTIONS}"
+        echo "Build with profile-guided optimization"
+    ;;
     heartbeattest)
         CMAKE_EXTRA_OPTIONS="-DHEARTBEATTEST=1 ${CMAKE_EXTRA_OPTIONS}"
         echo "Build with HeartBeat test"
@@ -115,7 +135,7 @@ do
         echo "Build with DSMBMerging test - DS leader composed invalid DSMicroBlock"
     ;;
     *)
-        echo "Usage $0 [cuda|opencl] [tsan|asan] [style] [heartbeattest] [fallbacktest] [vc<1-8>] [dm<1-5>]"
+        echo "Usage $0 [cuda|opencl] [tsan|asan] [lto] [pch] [pgo-gen|pgo-use] [style] [heartbeattest] [fallbacktest] [vc<1-8>] [dm<1-5>]"
         exit 1
     ;;
     esac
@@ -15,9 +15,11 @@ find_library(
 set(LEVELDB_INCLUDE_DIRS ${LEVELDB_INCLUDE_DIR})
 set(LEVELDB_LIBRARIES ${LEVELDB_LIBRARY})
 
+# Snappy is also used directly to compress state deltas on the wire
+find_path(SNAPPY_INCLUDE_DIR snappy.h PATH_SUFFIXES snappy)
+find_library(SNAPPY_LIBRARY snappy)
+
 if (NOT BUILD_SHARED_LIBS AND APPLE)
-	find_path(SNAPPY_INCLUDE_DIR snappy.h PATH_SUFFIXES snappy)
-	find_library(SNAPPY_LIBRARY snappy)
 	set(LEVELDB_INCLUDE_DIRS ${LEVELDB_INCLUDE_DIR} ${SNAPPY_INCLUDE_DIR})
 	set(LEVELDB_LIBRARIES ${LEVELDB_LIBRARY} ${SNAPPY_LIBRARY})
 endif()
@@ -30,6 +30,7 @@
 #include "libData/AccountData/Transaction.h"
 #include "libMessage/Messenger.h"
 #include "libUtils/Logger.h"
+#include "libUtils/TxnCorpus.h"
 
 namespace po = boost::program_options;
 
@@ -61,10 +62,21 @@ std::vector<KeyPairAddress> get_genesis_keypair_and_address() {
   return result;
 }
 
+Transaction gen_txn(const KeyPairAddress& from, const Address& toAddr,
+                    const std::size_t nonce) {
+  return Transaction{DataConversion::Pack(CHAIN_ID, 0),
+                     nonce,
+                     toAddr,
+                     std::make_pair(std::get<0>(from), std::get<1>(from)),
+                     nonce,
+                     GAS_PRICE_MIN_VALUE,
+                     1,
+                     {},
+                     {}};
+}
+
 void gen_txn_file(const std::string& prefix, const KeyPairAddress& from,
                   const Address& toAddr, const NonceRange& nonce_range) {
-  const auto& privKey = std::get<0>(from);
-  const auto& pubKey = std::get<1>(from);
   const auto& address = std::get<2>(from);
 
   const auto& begin = std::get<0>(nonce_range);
@@ -83,17 +95,9 @@ void gen_txn_file(const std::string& prefix, const KeyPairAddress& from,
   std::vector<uint32_t> txnOffsets;
 
   for (auto nonce = begin; nonce < end; nonce++) {
-    Transaction txn{DataConversion::Pack(CHAIN_ID, 0),
-                    nonce,
-                    toAddr,
-                    std::make_pair(privKey, pubKey),
-                    nonce,
-                    GAS_PRICE_MIN_VALUE,
-                    1,
-                    {},
-                    {}};
     txnOffsets.push_back(txnBuff.size());
-    if (!Messenger::SetTransaction(txnBuff, txnBuff.size(), txn)) {
+    if (!Messenger::SetTransaction(txnBuff, txnBuff.size(),
+                                   gen_txn(from, toAddr, nonce))) {
       std::cout << "Messenger::SetTransaction failed." << std::endl;
       return;
     }
@@ -124,6 +128,46 @@ void gen_txn_file(const std::string& prefix, const KeyPairAddress& from,
   }
 }
 
+// All the batches of all the senders go into one corpus file, which the
+// lookup maps instead of reading a file per batch
+bool gen_txn_corpus(const std::string& filename,
+                    const std::vector<KeyPairAddress>& fromAccounts,
+                    const Address& toAddr, const NonceRange& nonce_range) {
+  const auto& begin = std::get<0>(nonce_range);
+  const auto& end = std::get<1>(nonce_range);
+
+  TxnCorpusWriter writer(filename);
+  bytes txnBuff;
+
+  for (const auto& from : fromAccounts) {
+    if (!writer.BeginSender(std::get<2>(from), begin)) {
+      return false;
+    }
+    for (auto nonce = begin; nonce < end; nonce++) {
+      txnBuff.clear();
+      if (!Messenger::SetTransaction(txnBuff, 0,
+                                     gen_txn(from, toAddr, nonce))) {
+        std::cerr << "Messenger::SetTransaction failed." << std::endl;
+        return false;
+      }
+      if (!writer.AddTxn(txnBuff)) {
+        return false;
+      }
+    }
+    if (!writer.EndSender()) {
+      return false;
+    }
+  }
+
+  if (!writer.Finish()) {
+    std::cerr << "Error writing to file " << filename << "\n";
+    return false;
+  }
+
+  std::cout << "Write to file " << filename << "\n";
+  return true;
+}
+
 using namespace std;
 
 void description() {
@@ -136,12 +180,15 @@ void description() {
          "to one random wallet\n";
   std::cout << "\tThe batch size is decided by NUM_TXN_TO_SEND_PER_ACCOUNT "
                "(constants.xml)\n";
+  std::cout << "\tWith --corpus, all batches go into one file for "
+               "TXN_CORPUS_FILE (constants.xml)\n";
 }
 
 int main(int argc, char** argv) {
   try {
     const unsigned long delta = 10000;
     unsigned long begin = 0, end;
+    string corpus;
 
     po::options_description desc("Options");
 
@@ -150,7 +197,8 @@ int main(int argc, char** argv) {
         "Start of transaction batch (default to 0)")(
         "end, e", po::value<unsigned long>(&end),
         "End of transaction batch (default to parameter value --begin + "
-        "10000)");
+        "10000)")("corpus,c", po::value<string>(&corpus),
+                  "Write all batches to this txn corpus file instead");
 
     po::variables_map vm;
     try {
@@ -187,6 +235,22 @@ int main(int argc, char** argv) {
     auto receiver = Schnorr::GetInstance().GenKeyPair();
     auto toAddr = Account::GetAddressFromPublicKey(receiver.second);
 
+    auto batch_size = NUM_TXN_TO_SEND_PER_ACCOUNT;
+
+    auto fromAccounts = get_genesis_keypair_and_address();
+
+    if (!corpus.empty()) {
+      std::cout << "Number of genesis accounts: " << fromAccounts.size()
+                << "\n";
+      std::cout << "Batches: " << begin << " to " << end << " of "
+                << batch_size << "\n";
+      auto nonce_range =
+          std::make_tuple(begin * batch_size + 1, end * batch_size + 1);
+      return gen_txn_corpus(corpus, fromAccounts, toAddr, nonce_range)
+                 ? SUCCESS
+                 : ERROR_UNEXPECTED;
+    }
+
     std::string txn_path{TXN_PATH};
     if (!boost::filesystem::exists(txn_path)) {
       std::cerr << "Cannot find path '" << txn_path
@@ -194,10 +258,6 @@ int main(int argc, char** argv) {
       return 1;
     }
 
-    auto batch_size = NUM_TXN_TO_SEND_PER_ACCOUNT;
-
-    auto fromAccounts = get_genesis_keypair_and_address();
-
     std::cout << "Number of genesis accounts: " << fromAccounts.size() << "\n";
     std::cout << "Begin batch: " << begin << "\n";
     std::cout << "End batch: " << end << "\n";
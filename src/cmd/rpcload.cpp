@@ -0,0 +1,601 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <curl/curl.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <json/json.h>
+#include <boost/algorithm/string.hpp>
+#include <boost/program_options.hpp>
+
+#include "common/Constants.h"
+#include "libData/AccountData/Account.h"
+#include "libData/AccountData/Transaction.h"
+#include "libServer/AddressChecksum.h"
+#include "libUtils/DataConversion.h"
+#include "libUtils/Logger.h"
+
+namespace po = boost::program_options;
+
+#define SUCCESS 0
+#define ERROR_IN_COMMAND_LINE -1
+#define ERROR_UNHANDLED_EXCEPTION -2
+#define ERROR_UNEXPECTED -3
+
+using namespace std;
+using namespace std::chrono;
+
+namespace {
+
+enum Method : unsigned int {
+  CREATE_TRANSACTION = 0,
+  GET_BALANCE,
+  GET_TRANSACTION,
+  GET_SMART_CONTRACT_STATE,
+  NUM_METHODS
+};
+
+const vector<string> METHOD_NAMES = {"CreateTransaction", "GetBalance",
+                                     "GetTransaction", "GetSmartContractState"};
+
+/// Latencies in microseconds, bucketed within about 3% so that hours of
+/// requests take a fixed amount of memory. Values below 64 us are exact,
+/// above that each power of two is split into 32 buckets.
+class LatencyHistogram {
+  static const unsigned int LINEAR = 64;
+  static const unsigned int SUB_BUCKETS = 32;
+
+  vector<uint64_t> m_counts;
+  uint64_t m_total = 0;
+  double m_sum = 0;
+  double m_max = 0;
+
+  static size_t Index(uint64_t value) {
+    if (value < LINEAR) {
+      return value;
+    }
+    const unsigned int shift = (63 - __builtin_clzll(value)) - 5;
+    return LINEAR + (shift - 1) * SUB_BUCKETS + ((value >> shift) - 32);
+  }
+
+  static double Midpoint(size_t index) {
+    if (index < LINEAR) {
+      return index;
+    }
+    const unsigned int shift = (index - LINEAR) / SUB_BUCKETS + 1;
+    const uint64_t sub = (index - LINEAR) % SUB_BUCKETS + 32;
+    return (sub << shift) + (1ull << shift) / 2.0;
+  }
+
+ public:
+  LatencyHistogram() : m_counts(LINEAR + 58 * SUB_BUCKETS, 0) {}
+
+  void Add(double us) {
+    us = max(us, 0.0);
+    m_counts[Index(static_cast<uint64_t>(us))]++;
+    m_total++;
+    m_sum += us;
+    m_max = max(m_max, us);
+  }
+
+  void Merge(const LatencyHistogram& other) {
+    for (size_t i = 0; i < m_counts.size(); i++) {
+      m_counts[i] += other.m_counts[i];
+    }
+    m_total += other.m_total;
+    m_sum += other.m_sum;
+    m_max = max(m_max, other.m_max);
+  }
+
+  uint64_t GetCount() const { return m_total; }
+
+  double Percentile(double p) const {
+    const uint64_t rank = static_cast<uint64_t>(p * (m_total - 1)) + 1;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < m_counts.size(); i++) {
+      seen += m_counts[i];
+      if (seen >= rank) {
+        return min(Midpoint(i), m_max);
+      }
+    }
+    return m_max;
+  }
+
+  Json::Value Summarize() const {
+    Json::Value result;
+    if (m_total == 0) {
+      return result;
+    }
+    result["mean_us"] = m_sum / m_total;
+    result["p50_us"] = Percentile(0.5);
+    result["p90_us"] = Percentile(0.9);
+    result["p99_us"] = Percentile(0.99);
+    result["p999_us"] = Percentile(0.999);
+    result["max_us"] = m_max;
+    return result;
+  }
+};
+
+struct MethodStats {
+  /// From the time the request was due, so a lookup that falls behind the
+  /// target rate shows up as latency and not as a lower request rate
+  LatencyHistogram m_latency;
+  /// From the time the request was sent
+  LatencyHistogram m_service;
+  uint64_t m_rpcErrors = 0;
+  uint64_t m_transportErrors = 0;
+
+  void Merge(const MethodStats& other) {
+    m_latency.Merge(other.m_latency);
+    m_service.Merge(other.m_service);
+    m_rpcErrors += other.m_rpcErrors;
+    m_transportErrors += other.m_transportErrors;
+  }
+
+  Json::Value Summarize(double elapsedInS) const {
+    Json::Value result;
+    result["count"] = static_cast<Json::UInt64>(m_latency.GetCount());
+    result["rate"] = m_latency.GetCount() / elapsedInS;
+    result["rpc_errors"] = static_cast<Json::UInt64>(m_rpcErrors);
+    result["transport_errors"] = static_cast<Json::UInt64>(m_transportErrors);
+    result["latency"] = m_latency.Summarize();
+    result["service"] = m_service.Summarize();
+    return result;
+  }
+};
+
+/// A genesis account sending CreateTransaction, nonces handed out in order
+struct Sender {
+  PairOfKey m_keys;
+  Address m_addr;
+  atomic<uint64_t> m_nonce;
+};
+
+size_t WriteString(void* contents, size_t size, size_t nmemb, void* userp) {
+  ((string*)userp)->append((char*)contents, size * nmemb);
+  return size * nmemb;
+}
+
+/// One keep-alive connection to the lookup, used by a single thread
+class RpcClient {
+  CURL* m_curl;
+  curl_slist* m_headers;
+  string m_response;
+
+ public:
+  RpcClient(const string& url, long timeoutInMs)
+      : m_curl(curl_easy_init()), m_headers(nullptr) {
+    if (m_curl == nullptr) {
+      return;
+    }
+    m_headers =
+        curl_slist_append(m_headers, "Content-Type: application/json");
+    curl_easy_setopt(m_curl, CURLOPT_URL, url.c_str());
+    curl_easy_setopt(m_curl, CURLOPT_HTTPHEADER, m_headers);
+    curl_easy_setopt(m_curl, CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_easy_setopt(m_curl, CURLOPT_TCP_NODELAY, 1L);
+    curl_easy_setopt(m_curl, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(m_curl, CURLOPT_TIMEOUT_MS, timeoutInMs);
+    curl_easy_setopt(m_curl, CURLOPT_WRITEFUNCTION, WriteString);
+    curl_easy_setopt(m_curl, CURLOPT_WRITEDATA, &m_response);
+  }
+
+  ~RpcClient() {
+    if (m_curl != nullptr) {
+      curl_easy_cleanup(m_curl);
+    }
+    curl_slist_free_all(m_headers);
+  }
+
+  RpcClient(const RpcClient&) = delete;
+  RpcClient& operator=(const RpcClient&) = delete;
+
+  /// Returns false if no JSON-RPC response came back. rpcError tells
+  /// whether the lookup answered with an error.
+  bool Call(const string& method, const Json::Value& params,
+            Json::Value& result, bool& rpcError) {
+    rpcError = false;
+    if (m_curl == nullptr) {
+      return false;
+    }
+
+    Json::Value request;
+    request["jsonrpc"] = "2.0";
+    request["id"] = "1";
+    request["method"] = method;
+    request["params"] = params;
+    Json::StreamWriterBuilder writeBuilder;
+    writeBuilder["indentation"] = "";
+    const string body = Json::writeString(writeBuilder, request);
+
+    m_response.clear();
+    curl_easy_setopt(m_curl, CURLOPT_POSTFIELDS, body.c_str());
+    curl_easy_setopt(m_curl, CURLOPT_POSTFIELDSIZE, (long)body.size());
+    if (curl_easy_perform(m_curl) != CURLE_OK) {
+      return false;
+    }
+
+    Json::Value response;
+    Json::CharReaderBuilder readBuilder;
+    unique_ptr<Json::CharReader> reader(readBuilder.newCharReader());
+    string errors;
+    if (!reader->parse(m_response.data(), m_response.data() + m_response.size(),
+                       &response, &errors) ||
+        !response.isObject()) {
+      return false;
+    }
+
+    if (response.isMember("error")) {
+      rpcError = true;
+      return true;
+    }
+    result = response["result"];
+    return true;
+  }
+};
+
+/// Hashes of the accepted transactions, for GetTransaction to look up
+class TxnHashPool {
+  static const size_t CAPACITY = 100000;
+
+  mutex m_mutex;
+  vector<string> m_hashes;
+  size_t m_next = 0;
+
+ public:
+  void Add(const string& hash) {
+    lock_guard<mutex> g(m_mutex);
+    if (m_hashes.size() < CAPACITY) {
+      m_hashes.emplace_back(hash);
+    } else {
+      m_hashes[m_next] = hash;
+      m_next = (m_next + 1) % CAPACITY;
+    }
+  }
+
+  bool Pick(mt19937_64& rng, string& hash) {
+    lock_guard<mutex> g(m_mutex);
+    if (m_hashes.empty()) {
+      return false;
+    }
+    hash = m_hashes[rng() % m_hashes.size()];
+    return true;
+  }
+};
+
+Json::Value TransactionToJson(const Transaction& txn) {
+  Json::Value json;
+  string pubKey, signature;
+  DataConversion::SerializableToHexStr(txn.GetSenderPubKey(), pubKey);
+  DataConversion::SerializableToHexStr(txn.GetSignature(), signature);
+
+  json["version"] = txn.GetVersion();
+  json["nonce"] = static_cast<Json::UInt64>(txn.GetNonce());
+  json["toAddr"] =
+      AddressChecksum::GetCheckSumedAddress(txn.GetToAddr().hex());
+  json["amount"] = txn.GetAmount().str();
+  json["pubKey"] = pubKey;
+  json["gasPrice"] = txn.GetGasPrice().str();
+  json["gasLimit"] = to_string(txn.GetGasLimit());
+  json["code"] = "";
+  json["data"] = "";
+  json["signature"] = signature;
+  return json;
+}
+
+bool ParseMix(const string& mix, vector<double>& weights) {
+  weights.assign(NUM_METHODS, 0);
+  vector<string> entries;
+  boost::split(entries, mix, boost::is_any_of(","));
+  for (const auto& entry : entries) {
+    const auto eq = entry.find('=');
+    if (eq == string::npos) {
+      return false;
+    }
+    const auto it = find(METHOD_NAMES.begin(), METHOD_NAMES.end(),
+                         entry.substr(0, eq));
+    if (it == METHOD_NAMES.end()) {
+      return false;
+    }
+    try {
+      weights[it - METHOD_NAMES.begin()] = stod(entry.substr(eq + 1));
+    } catch (const exception&) {
+      return false;
+    }
+  }
+  return any_of(weights.begin(), weights.end(),
+                [](double weight) { return weight > 0; });
+}
+
+struct LoadConfig {
+  string m_url;
+  double m_rate;
+  unsigned int m_durationInS;
+  unsigned int m_connections;
+  long m_timeoutInMs;
+  vector<double> m_weights;
+  Address m_toAddr;
+  string m_contract;
+};
+
+/// Sends the requests due at start + k / rate, for the k it takes, until
+/// their due time passes the end of the run
+void RunConnection(const LoadConfig& config, unsigned int id,
+                   atomic<uint64_t>& next, steady_clock::time_point start,
+                   vector<unique_ptr<Sender>>& senders, TxnHashPool& hashes,
+                   vector<MethodStats>& stats) {
+  RpcClient client(config.m_url, config.m_timeoutInMs);
+  mt19937_64 rng(id);
+  discrete_distribution<unsigned int> pick(config.m_weights.begin(),
+                                           config.m_weights.end());
+  const auto end = start + seconds(config.m_durationInS);
+
+  while (true) {
+    const uint64_t k = next.fetch_add(1);
+    const auto due =
+        start + duration_cast<steady_clock::duration>(
+                    duration<double>(k / config.m_rate));
+    if (due >= end) {
+      break;
+    }
+    this_thread::sleep_until(due);
+
+    const unsigned int method = pick(rng);
+    Json::Value params(Json::arrayValue);
+    switch (method) {
+      case CREATE_TRANSACTION: {
+        auto& sender = *senders[k % senders.size()];
+        Transaction txn(DataConversion::Pack(CHAIN_ID, TRANSACTION_VERSION),
+                        sender.m_nonce.fetch_add(1), config.m_toAddr,
+                        sender.m_keys, 1, GAS_PRICE_MIN_VALUE, 1);
+        params.append(TransactionToJson(txn));
+        break;
+      }
+      case GET_BALANCE:
+        params.append(senders[rng() % senders.size()]->m_addr.hex());
+        break;
+      case GET_TRANSACTION: {
+        // Unknown hashes until CreateTransaction got some accepted
+        string hash;
+        if (!hashes.Pick(rng, hash)) {
+          TxnHash random;
+          for (auto& c : random.asArray()) {
+            c = rng();
+          }
+          hash = random.hex();
+        }
+        params.append(hash);
+        break;
+      }
+      case GET_SMART_CONTRACT_STATE:
+        params.append(config.m_contract);
+        break;
+    }
+
+    Json::Value result;
+    bool rpcError = false;
+    const auto sent = steady_clock::now();
+    const bool ok = client.Call(METHOD_NAMES[method], params, result, rpcError);
+    const auto done = steady_clock::now();
+
+    auto& methodStats = stats[method];
+    methodStats.m_latency.Add(
+        duration_cast<nanoseconds>(done - due).count() / 1000.0);
+    methodStats.m_service.Add(
+        duration_cast<nanoseconds>(done - sent).count() / 1000.0);
+    if (!ok) {
+      methodStats.m_transportErrors++;
+    } else if (rpcError) {
+      methodStats.m_rpcErrors++;
+    } else if (method == CREATE_TRANSACTION && result.isMember("TranID")) {
+      hashes.Add(result["TranID"].asString());
+    }
+  }
+}
+
+}  // namespace
+
+/// Replays a mix of lookup RPC calls at a target rate over many keep-alive
+/// connections and reports the rate reached and the latency percentiles.
+/// CreateTransaction sends payments from the genesis accounts of
+/// constants.xml, so point it at a testnet whose genesis keys it knows.
+int main(int argc, const char* argv[]) {
+  try {
+    LoadConfig config;
+    string mix;
+    string toAddr;
+    string strResultName;
+
+    po::options_description desc("Options");
+
+    desc.add_options()("help,h", "Print help messages")(
+        "url,u",
+        po::value<string>(&config.m_url)
+            ->default_value("http://127.0.0.1:4201"),
+        "JSON-RPC endpoint of the lookup")(
+        "rate", po::value<double>(&config.m_rate)->required(),
+        "requests per second to send, over all connections")(
+        "duration,d",
+        po::value<unsigned int>(&config.m_durationInS)->default_value(60),
+        "seconds to send for")(
+        "connections,c",
+        po::value<unsigned int>(&config.m_connections)->default_value(64),
+        "keep-alive connections, each with its own thread")(
+        "timeout", po::value<long>(&config.m_timeoutInMs)->default_value(10000),
+        "milliseconds before a request counts as a transport error")(
+        "mix,m",
+        po::value<string>(&mix)->default_value(
+            "CreateTransaction=1,GetBalance=4,GetTransaction=4"),
+        "relative weights of CreateTransaction, GetBalance, GetTransaction "
+        "and GetSmartContractState")(
+        "to", po::value<string>(&toAddr),
+        "where CreateTransaction pays to (default: a fresh address)")(
+        "contract", po::value<string>(&config.m_contract),
+        "contract address for GetSmartContractState")(
+        "result-file-name,r", po::value<string>(&strResultName),
+        "also write the json result into this file");
+
+    po::variables_map vm;
+    try {
+      po::store(po::parse_command_line(argc, argv, desc), vm);
+
+      /** --help option
+       */
+      if (vm.count("help")) {
+        cout << desc << endl;
+        return SUCCESS;
+      }
+      po::notify(vm);
+    } catch (boost::program_options::error& e) {
+      cerr << "ERROR: " << e.what() << endl << endl;
+      cerr << desc;
+      return ERROR_IN_COMMAND_LINE;
+    }
+
+    if (config.m_rate <= 0 || config.m_connections == 0 ||
+        config.m_durationInS == 0) {
+      cerr << "ERROR: rate, duration and connections must be positive"
+           << endl;
+      return ERROR_IN_COMMAND_LINE;
+    }
+    if (!ParseMix(mix, config.m_weights)) {
+      cerr << "ERROR: bad mix " << mix << endl;
+      return ERROR_IN_COMMAND_LINE;
+    }
+    if (config.m_weights[GET_SMART_CONTRACT_STATE] > 0 &&
+        config.m_contract.empty()) {
+      cerr << "ERROR: GetSmartContractState needs --contract" << endl;
+      return ERROR_IN_COMMAND_LINE;
+    }
+
+    INIT_FILE_LOGGER("rpcload");
+
+    if (toAddr.empty()) {
+      config.m_toAddr = Account::GetAddressFromPublicKey(
+          Schnorr::GetInstance().GenKeyPair().second);
+    } else {
+      bytes addrBytes;
+      if (!DataConversion::HexStrToUint8Vec(toAddr, addrBytes) ||
+          addrBytes.size() != ACC_ADDR_SIZE) {
+        cerr << "ERROR: bad address " << toAddr << endl;
+        return ERROR_IN_COMMAND_LINE;
+      }
+      config.m_toAddr = Address(addrBytes);
+    }
+
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+
+    // CreateTransaction carries on from the nonce each account has now
+    vector<unique_ptr<Sender>> senders;
+    RpcClient client(config.m_url, config.m_timeoutInMs);
+    for (const auto& privKeyHexStr : GENESIS_KEYS) {
+      bytes privKeyBytes;
+      if (!DataConversion::HexStrToUint8Vec(privKeyHexStr, privKeyBytes)) {
+        continue;
+      }
+      unique_ptr<Sender> sender(new Sender());
+      sender->m_keys.first = PrivKey(privKeyBytes, 0);
+      sender->m_keys.second = PubKey(sender->m_keys.first);
+      sender->m_addr = Account::GetAddressFromPublicKey(sender->m_keys.second);
+
+      Json::Value params(Json::arrayValue), result;
+      params.append(sender->m_addr.hex());
+      bool rpcError = false;
+      if (!client.Call("GetBalance", params, result, rpcError)) {
+        cerr << "ERROR: no response from " << config.m_url << endl;
+        curl_global_cleanup();
+        return ERROR_UNEXPECTED;
+      }
+      sender->m_nonce = rpcError ? 1 : result["nonce"].asUInt64() + 1;
+      senders.emplace_back(move(sender));
+    }
+    if (senders.empty()) {
+      cerr << "ERROR: no GENESIS_KEYS in constants.xml" << endl;
+      curl_global_cleanup();
+      return ERROR_IN_COMMAND_LINE;
+    }
+
+    TxnHashPool hashes;
+    atomic<uint64_t> next{0};
+    vector<vector<MethodStats>> stats(config.m_connections,
+                                      vector<MethodStats>(NUM_METHODS));
+    const auto start = steady_clock::now();
+
+    vector<thread> connections;
+    for (unsigned int i = 0; i < config.m_connections; i++) {
+      connections.emplace_back([&, i]() {
+        RunConnection(config, i, next, start, senders, hashes, stats[i]);
+      });
+    }
+    for (auto& connection : connections) {
+      connection.join();
+    }
+    const double elapsedInS =
+        duration_cast<duration<double>>(steady_clock::now() - start).count();
+
+    curl_global_cleanup();
+
+    Json::Value result;
+    result["url"] = config.m_url;
+    result["target_rate"] = config.m_rate;
+    result["connections"] = config.m_connections;
+    result["elapsed_s"] = elapsedInS;
+
+    MethodStats total;
+    for (unsigned int method = 0; method < NUM_METHODS; method++) {
+      MethodStats methodStats;
+      for (const auto& connectionStats : stats) {
+        methodStats.Merge(connectionStats[method]);
+      }
+      total.Merge(methodStats);
+      if (methodStats.m_latency.GetCount() > 0) {
+        result["methods"][METHOD_NAMES[method]] =
+            methodStats.Summarize(elapsedInS);
+      }
+    }
+    result["total"] = total.Summarize(elapsedInS);
+
+    Json::StreamWriterBuilder writeBuilder;
+    const string output = Json::writeString(writeBuilder, result);
+    cout << output << endl;
+
+    if (!strResultName.empty()) {
+      ofstream fs(strResultName, ofstream::out);
+      fs << output << endl;
+      if (!fs) {
+        cerr << "ERROR: failed to write " << strResultName << endl;
+        return ERROR_UNEXPECTED;
+      }
+    }
+  } catch (exception& e) {
+    cerr << "Unhandled Exception reached the top of main: " << e.what()
+         << ", application will now exit" << endl;
+    return ERROR_UNHANDLED_EXCEPTION;
+  }
+  return SUCCESS;
+}
@@ -0,0 +1,344 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <json/json.h>
+#include <boost/program_options.hpp>
+
+#include "common/Constants.h"
+#include "libData/AccountData/AccountStore.h"
+#include "libData/AccountData/Address.h"
+#include "libData/AccountData/Transaction.h"
+#include "libData/AccountData/TransactionReceipt.h"
+#include "libPersistence/BlockStorage.h"
+#include "libUtils/Logger.h"
+#include "libUtils/TimeUtils.h"
+
+namespace po = boost::program_options;
+
+#define SUCCESS 0
+#define ERROR_IN_COMMAND_LINE -1
+#define ERROR_UNHANDLED_EXCEPTION -2
+#define ERROR_UNEXPECTED -3
+
+using namespace std;
+
+namespace {
+/// The kinds of transaction AccountStoreSC::UpdateAccounts tells apart
+string TransactionKind(const Transaction& transaction) {
+  if (!transaction.GetCode().empty()) {
+    return "contract_creation";
+  }
+  if (!transaction.GetData().empty() &&
+      transaction.GetToAddr() != NullAddress) {
+    return "contract_call";
+  }
+  return "payment";
+}
+
+/// Execution time of the transactions of one kind
+struct KindStats {
+  vector<double> m_latencies;
+  uint64_t m_gas = 0;
+  uint64_t m_failed = 0;
+  uint64_t m_receiptMismatches = 0;
+};
+
+Json::Value Summarize(KindStats& stats) {
+  Json::Value result;
+  auto& latencies = stats.m_latencies;
+  result["count"] = static_cast<Json::UInt64>(latencies.size());
+  result["failed"] = static_cast<Json::UInt64>(stats.m_failed);
+  result["receipt_mismatches"] =
+      static_cast<Json::UInt64>(stats.m_receiptMismatches);
+  result["gas"] = static_cast<Json::UInt64>(stats.m_gas);
+  if (latencies.empty()) {
+    return result;
+  }
+
+  sort(latencies.begin(), latencies.end());
+  double total = 0;
+  for (const auto& latency : latencies) {
+    total += latency;
+  }
+  auto percentile = [&latencies](double p) {
+    return latencies.at(static_cast<size_t>(p * (latencies.size() - 1)));
+  };
+  result["total_ms"] = total / 1000;
+  result["mean_us"] = total / latencies.size();
+  result["p50_us"] = percentile(0.5);
+  result["p99_us"] = percentile(0.99);
+  result["max_us"] = latencies.back();
+  if (total > 0) {
+    result["gas_per_second"] = stats.m_gas * 1e6 / total;
+  }
+  return result;
+}
+
+/// Applies the state delta the node stored for blockNum
+bool ApplyStoredDelta(const uint64_t& blockNum) {
+  bytes stateDelta;
+  if (!BlockStorage::GetBlockStorage().GetStateDelta(blockNum, stateDelta)) {
+    LOG_GENERAL(WARNING, "No state delta stored for TxBlock " << blockNum);
+    return false;
+  }
+  return AccountStore::GetInstance().DeserializeDelta(stateDelta, 0);
+}
+
+/// Re-executes the transactions of one TxBlock on the temp state, shard
+/// micro blocks first and the DS micro block last, and commits the result.
+/// The shards ran their transactions side by side on the state of the
+/// previous block, so running them one after the other gives the same
+/// result as long as they touch different accounts, which sharding ensures.
+bool ReplayBlock(const TxBlock& txBlock, map<string, KindStats>& kinds,
+                 Json::Value& entry) {
+  const uint64_t& blockNum = txBlock.GetHeader().GetBlockNum();
+  const auto& mbInfos = txBlock.GetMicroBlockInfos();
+  const unsigned int numShards = mbInfos.empty() ? 0 : mbInfos.size() - 1;
+
+  AccountStore::GetInstance().InitTemp();
+
+  uint64_t numTxns = 0;
+  double executeInUs = 0;
+  for (const auto& mbInfo : mbInfos) {
+    if (mbInfo.m_txnRootHash == TxnHash()) {
+      continue;
+    }
+    MicroBlockSharedPtr microBlock;
+    if (!BlockStorage::GetBlockStorage().GetMicroBlock(mbInfo.m_microBlockHash,
+                                                       microBlock)) {
+      LOG_GENERAL(WARNING, "Missing MicroBlock " << mbInfo.m_microBlockHash
+                                                 << " of TxBlock "
+                                                 << blockNum);
+      return false;
+    }
+    vector<TxBodySharedPtr> bodies;
+    if (!BlockStorage::GetBlockStorage().GetTxBodies(
+            microBlock->GetTranHashes(), bodies)) {
+      LOG_GENERAL(WARNING, "Missing transactions of MicroBlock "
+                               << mbInfo.m_microBlockHash);
+      return false;
+    }
+
+    const bool isDS = (mbInfo.m_shardId == numShards);
+    for (const auto& body : bodies) {
+      const Transaction& transaction = body->GetTransaction();
+      const TransactionReceipt& stored = body->GetTransactionReceipt();
+      KindStats& stats = kinds[TransactionKind(transaction)];
+
+      TransactionReceipt receipt;
+      auto startTime = r_timer_start();
+      const bool ok = AccountStore::GetInstance().UpdateAccountsTemp(
+          blockNum, numShards, isDS, transaction, receipt);
+      const double elapsedInUs = r_timer_end(startTime);
+
+      stats.m_latencies.emplace_back(elapsedInUs);
+      executeInUs += elapsedInUs;
+      numTxns++;
+      if (!ok) {
+        stats.m_failed++;
+        continue;
+      }
+      stats.m_gas += receipt.GetCumGas();
+      if (receipt.GetCumGas() != stored.GetCumGas() ||
+          receipt.GetJsonValue()["success"] !=
+              stored.GetJsonValue()["success"]) {
+        stats.m_receiptMismatches++;
+      }
+    }
+  }
+
+  auto startTime = r_timer_start();
+  if (!AccountStore::GetInstance().SerializeDelta()) {
+    return false;
+  }
+  const double serializeInUs = r_timer_end(startTime);
+
+  // Blocks that pay out coinbase rewards, and replays that came out
+  // differently, go on from the delta the node stored
+  const bool deltaMatches = (AccountStore::GetInstance().GetStateDeltaHash() ==
+                             txBlock.GetHeader().GetStateDeltaHash());
+  startTime = r_timer_start();
+  if (deltaMatches) {
+    AccountStore::GetInstance().CommitTemp();
+  } else if (!ApplyStoredDelta(blockNum)) {
+    return false;
+  }
+  const double commitInUs = r_timer_end(startTime);
+
+  entry["block"] = static_cast<Json::UInt64>(blockNum);
+  entry["transactions"] = static_cast<Json::UInt64>(numTxns);
+  entry["execute_ms"] = executeInUs / 1000;
+  entry["serialize_delta_ms"] = serializeInUs / 1000;
+  entry["commit_ms"] = commitInUs / 1000;
+  entry["delta_matches"] = deltaMatches;
+  return true;
+}
+}  // namespace
+
+/// Re-executes TxBlocks from..to of the persistence in the working
+/// directory, as laid down by a lookup node (only those keep transaction
+/// bodies), and reports the time spent per kind of transaction. The state
+/// on disk is the one of the last vacuous epoch, as Retriever takes it, so
+/// from has to come after that; the stored state deltas bring it up to
+/// from. Nothing is written back, but run it on a copy of the persistence.
+int main(int argc, const char* argv[]) {
+  try {
+    uint64_t fromBlock = 0;
+    uint64_t toBlock = 0;
+    bool perBlock = false;
+    string strResultName;
+
+    po::options_description desc("Options");
+
+    desc.add_options()("help,h", "Print help messages")(
+        "from,f", po::value<uint64_t>(&fromBlock)->required(),
+        "first TxBlock to re-execute")(
+        "to,t", po::value<uint64_t>(&toBlock),
+        "last TxBlock to re-execute (default: the last one stored)")(
+        "per-block", po::bool_switch(&perBlock),
+        "also report the time spent on each block")(
+        "result-file-name,r", po::value<string>(&strResultName),
+        "also write the json result into this file");
+
+    po::variables_map vm;
+    try {
+      po::store(po::parse_command_line(argc, argv, desc), vm);
+
+      /** --help option
+       */
+      if (vm.count("help")) {
+        cout << desc << endl;
+        return SUCCESS;
+      }
+      po::notify(vm);
+    } catch (boost::program_options::error& e) {
+      cerr << "ERROR: " << e.what() << endl << endl;
+      cerr << desc;
+      return ERROR_IN_COMMAND_LINE;
+    }
+
+    if (!LOOKUP_NODE_MODE) {
+      cerr << "ERROR: transaction bodies are only kept in LOOKUP_NODE_MODE"
+           << endl;
+      return ERROR_IN_COMMAND_LINE;
+    }
+
+    INIT_FILE_LOGGER("txnreplay");
+    INIT_STATE_LOGGER("state");
+
+    vector<uint64_t> blockNums;
+    if (!BlockStorage::GetBlockStorage().GetAllTxBlockNums(blockNums) ||
+        blockNums.empty()) {
+      cerr << "ERROR: no TxBlocks in " << PERSISTENCE_PATH << endl;
+      return ERROR_UNEXPECTED;
+    }
+    const uint64_t lastBlock =
+        *max_element(blockNums.begin(), blockNums.end());
+    if (!vm.count("to")) {
+      toBlock = lastBlock;
+    }
+    // As in Retriever::RetrieveTxBlocks
+    const uint64_t stateBlock =
+        lastBlock - (lastBlock + 1) % NUM_FINAL_BLOCK_PER_POW;
+    if (fromBlock <= stateBlock || toBlock < fromBlock ||
+        toBlock > lastBlock) {
+      cerr << "ERROR: the state on disk is the one after TxBlock "
+           << stateBlock << ", so blocks " << stateBlock + 1 << " to "
+           << lastBlock << " can be re-executed" << endl;
+      return ERROR_IN_COMMAND_LINE;
+    }
+
+    Json::Value result;
+    auto startTime = r_timer_start();
+    if (!AccountStore::GetInstance().RetrieveFromDisk()) {
+      cerr << "ERROR: failed to load the state" << endl;
+      return ERROR_UNEXPECTED;
+    }
+    result["load_state_ms"] = r_timer_end(startTime) / 1000;
+
+    startTime = r_timer_start();
+    for (uint64_t blockNum = stateBlock + 1; blockNum < fromBlock;
+         blockNum++) {
+      if (!ApplyStoredDelta(blockNum)) {
+        cerr << "ERROR: failed to apply the state delta of TxBlock "
+             << blockNum << endl;
+        return ERROR_UNEXPECTED;
+      }
+    }
+    result["catch_up_ms"] = r_timer_end(startTime) / 1000;
+
+    map<string, KindStats> kinds;
+    double serializeInMs = 0;
+    double commitInMs = 0;
+    uint64_t deltaMismatches = 0;
+    for (uint64_t blockNum = fromBlock; blockNum <= toBlock; blockNum++) {
+      TxBlockSharedPtr txBlock;
+      if (!BlockStorage::GetBlockStorage().GetTxBlock(blockNum, txBlock)) {
+        cerr << "ERROR: missing TxBlock " << blockNum << endl;
+        return ERROR_UNEXPECTED;
+      }
+      Json::Value entry;
+      if (!ReplayBlock(*txBlock, kinds, entry)) {
+        cerr << "ERROR: failed to re-execute TxBlock " << blockNum << endl;
+        return ERROR_UNEXPECTED;
+      }
+      serializeInMs += entry["serialize_delta_ms"].asDouble();
+      commitInMs += entry["commit_ms"].asDouble();
+      if (!entry["delta_matches"].asBool()) {
+        deltaMismatches++;
+      }
+      if (perBlock) {
+        result["blocks"].append(entry);
+      }
+    }
+
+    result["from"] = static_cast<Json::UInt64>(fromBlock);
+    result["to"] = static_cast<Json::UInt64>(toBlock);
+    for (auto& kind : kinds) {
+      result["transactions"][kind.first] = Summarize(kind.second);
+    }
+    result["serialize_delta_ms"] = serializeInMs;
+    result["commit_ms"] = commitInMs;
+    result["delta_mismatches"] = static_cast<Json::UInt64>(deltaMismatches);
+
+    Json::StreamWriterBuilder writeBuilder;
+    const string output = Json::writeString(writeBuilder, result);
+    cout << output << endl;
+
+    if (!strResultName.empty()) {
+      ofstream fs(strResultName, ofstream::out);
+      if (!fs.is_open()) {
+        cerr << "Failed to open file " << strResultName << endl;
+        return ERROR_UNEXPECTED;
+      }
+      fs << output << endl;
+    }
+  } catch (exception& e) {
+    cerr << "Unhandled Exception reached the top of main: " << e.what()
+         << ", application will now exit" << endl;
+    return ERROR_UNHANDLED_EXCEPTION;
+  }
+
+  return SUCCESS;
+}
@@ -31,15 +31,17 @@ class Broadcastable {
       [[gnu::unused]] unsigned char ins_type,
       const Peer& broadcast_originator) {
     LOG_MARKER();
-    std::vector<Peer> peers = PeerStore::GetStore().GetAllPeers();
-    for (std::vector<Peer>::iterator peer = peers.begin(); peer != peers.end();
-         peer++) {
-      if ((peer->m_ipAddress == broadcast_originator.m_ipAddress) &&
-          (peer->m_listenPortHost == broadcast_originator.m_listenPortHost)) {
-        *peer = std::move(peers.back());
-        peers.pop_back();
-        break;
+    const auto snapshot = PeerStore::GetStore().GetPeersSnapshot();
+    std::vector<Peer> peers;
+    peers.reserve(snapshot->size());
+    bool skipped = false;
+    for (const auto& peer : *snapshot) {
+      if (!skipped && (peer.m_ipAddress == broadcast_originator.m_ipAddress) &&
+          (peer.m_listenPortHost == broadcast_originator.m_listenPortHost)) {
+        skipped = true;
+        continue;
       }
+      peers.emplace_back(peer);
     }
     LOG_GENERAL(INFO, "Number of peers to broadcast = " << peers.size());
     return peers;
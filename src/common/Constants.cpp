@@ -60,6 +60,24 @@ const vector<string> ReadAccountsFromConstantsFile(string propName) {
   return result;
 }
 
+const vector<LevelDBProfile> ReadLevelDBProfilesFromConstantsFile() {
+  auto pt = PTree::GetInstance();
+  vector<LevelDBProfile> result;
+  for (auto& profile : pt.get_child("node.leveldb")) {
+    if (profile.first != "profile") {
+      continue;
+    }
+    const auto& p = profile.second;
+    result.push_back({p.get<string>("DB_NAME"),
+                      p.get<unsigned int>("BLOCK_CACHE_SIZE_IN_MB"),
+                      p.get<unsigned int>("BLOOM_FILTER_BITS_PER_KEY"),
+                      p.get<unsigned int>("WRITE_BUFFER_SIZE_IN_MB"),
+                      p.get<unsigned int>("BLOCK_SIZE_IN_KB"),
+                      p.get<string>("COMPRESSION") == "true"});
+  }
+  return result;
+}
+
 // General constants
 const unsigned int DEBUG_LEVEL{ReadConstantNumeric("DEBUG_LEVEL")};
 const bool ENABLE_DO_REJOIN{ReadConstantString("ENABLE_DO_REJOIN") == "true"};
@@ -67,6 +85,52 @@ const bool LOOKUP_NODE_MODE{ReadConstantString("LOOKUP_NODE_MODE") == "true"};
 const unsigned int MAX_ENTRIES_FOR_DIAGNOSTIC_DATA{
     ReadConstantNumeric("MAX_ENTRIES_FOR_DIAGNOSTIC_DATA")};
 const uint16_t CHAIN_ID{(uint16_t)ReadConstantNumeric("CHAIN_ID")};
+const unsigned int TRIE_NODE_CACHE_SIZE_IN_MB{
+    ReadConstantNumeric("TRIE_NODE_CACHE_SIZE_IN_MB")};
+const unsigned int TRIE_NODE_CACHE_SHARDS{
+    ReadConstantNumeric("TRIE_NODE_CACHE_SHARDS")};
+const unsigned int TRIE_NODE_NEGATIVE_CACHE_SIZE{
+    ReadConstantNumeric("TRIE_NODE_NEGATIVE_CACHE_SIZE")};
+const unsigned int KEY_HASH_CACHE_SIZE{
+    ReadConstantNumeric("KEY_HASH_CACHE_SIZE")};
+const unsigned int STATE_DELTA_RETENTION_BLOCKS{
+    ReadConstantNumeric("STATE_DELTA_RETENTION_BLOCKS")};
+const unsigned int STATE_PRUNING_KEEP_ROOTS{
+    ReadConstantNumeric("STATE_PRUNING_KEEP_ROOTS")};
+const unsigned int STATE_PRUNING_BATCH_SIZE{
+    ReadConstantNumeric("STATE_PRUNING_BATCH_SIZE")};
+const bool STATE_ARCHIVE_MODE{ReadConstantString("STATE_ARCHIVE_MODE") ==
+                              "true"};
+const bool BLOCK_ARCHIVE_ENABLED{
+    ReadConstantString("BLOCK_ARCHIVE_ENABLED") == "true"};
+const unsigned int BLOCK_ARCHIVE_SEGMENT_SIZE_MB{
+    ReadConstantNumeric("BLOCK_ARCHIVE_SEGMENT_SIZE_MB")};
+const bool FAST_RESTART_ENABLED{ReadConstantString("FAST_RESTART_ENABLED") ==
+                                "true"};
+const string EPOCH_METRICS_DUMP_FILE{
+    ReadConstantString("EPOCH_METRICS_DUMP_FILE")};
+const unsigned int EPOCH_METRICS_DUMP_INTERVAL{
+    ReadConstantNumeric("EPOCH_METRICS_DUMP_INTERVAL")};
+const unsigned int EPOCH_TIMELINE_EVENTS{
+    ReadConstantNumeric("EPOCH_TIMELINE_EVENTS")};
+const bool TRACE_ENABLED{ReadConstantString("TRACE_ENABLED") == "true"};
+const unsigned int TRACE_SAMPLE_RATE{ReadConstantNumeric("TRACE_SAMPLE_RATE")};
+const unsigned int TRACE_BUFFER_EVENTS{
+    ReadConstantNumeric("TRACE_BUFFER_EVENTS")};
+const string TRACE_DUMP_FILE{ReadConstantString("TRACE_DUMP_FILE")};
+const bool PROFILER_API{ReadConstantString("PROFILER_API") == "true"};
+const unsigned int PROFILER_MAX_SAMPLES{
+    ReadConstantNumeric("PROFILER_MAX_SAMPLES")};
+const bool MEMORY_STATS_API{ReadConstantString("MEMORY_STATS_API") == "true"};
+const bool LOCK_PROFILING{ReadConstantString("LOCK_PROFILING") == "true"};
+const unsigned int ASYNC_EXECUTOR_THREADS{
+    ReadConstantNumeric("ASYNC_EXECUTOR_THREADS")};
+const unsigned int ASYNC_EXECUTOR_QUEUE_SIZE{
+    ReadConstantNumeric("ASYNC_EXECUTOR_QUEUE_SIZE")};
+const unsigned int BACKGROUND_WRITER_QUEUE_SIZE{
+    ReadConstantNumeric("BACKGROUND_WRITER_QUEUE_SIZE")};
+const unsigned int BACKGROUND_WRITER_BATCH_SIZE{
+    ReadConstantNumeric("BACKGROUND_WRITER_BATCH_SIZE")};
 
 // Version constants
 const unsigned int MSG_VERSION{
@@ -91,14 +155,109 @@ const unsigned int SHARDINGSTRUCTURE_VERSION{
     ReadConstantNumeric("SHARDINGSTRUCTURE_VERSION", "node.version.")};
 const unsigned int ACCOUNT_VERSION{
     ReadConstantNumeric("ACCOUNT_VERSION", "node.version.")};
+const unsigned int TXROOT_MERKLE_MICROBLOCK_VERSION{
+    ReadConstantNumeric("TXROOT_MERKLE_MICROBLOCK_VERSION", "node.version.")};
+const unsigned int STATE_DELTA_VERSION{
+    ReadConstantNumeric("STATE_DELTA_VERSION", "node.version.")};
 
 // Seed constans
 const bool ARCHIVAL_LOOKUP{
     ReadConstantString("ARCHIVAL_LOOKUP", "node.seed.") == "true"};
 const unsigned int SEED_TXN_COLLECTION_TIME_IN_SEC{
     ReadConstantNumeric("SEED_TXN_COLLECTION_TIME_IN_SEC", "node.seed.")};
+const bool ENABLE_TXN_ADDRESS_INDEX{
+    ReadConstantString("ENABLE_TXN_ADDRESS_INDEX", "node.seed.") == "true"};
+const unsigned int TXN_ADDRESS_INDEX_PAGE_SIZE{
+    ReadConstantNumeric("TXN_ADDRESS_INDEX_PAGE_SIZE", "node.seed.")};
+const unsigned int TXN_BODY_PARSE_THREADS{
+    ReadConstantNumeric("TXN_BODY_PARSE_THREADS", "node.seed.")};
+const unsigned int MAX_PENDING_TX_BODIES{
+    ReadConstantNumeric("MAX_PENDING_TX_BODIES", "node.seed.")};
+const unsigned int TXN_FILTER_SLICES{
+    ReadConstantNumeric("TXN_FILTER_SLICES", "node.seed.")};
+const unsigned int TXN_FILTER_EPOCHS_PER_SLICE{
+    ReadConstantNumeric("TXN_FILTER_EPOCHS_PER_SLICE", "node.seed.")};
+const unsigned int TXN_FILTER_SLICE_BITS{
+    ReadConstantNumeric("TXN_FILTER_SLICE_BITS", "node.seed.")};
+const unsigned int TXN_FILTER_PROBES{
+    ReadConstantNumeric("TXN_FILTER_PROBES", "node.seed.")};
+const unsigned int JSON_RESPONSE_CACHE_SIZE{
+    ReadConstantNumeric("JSON_RESPONSE_CACHE_SIZE", "node.seed.")};
+const unsigned int RPC_SERVER_THREADS{
+    ReadConstantNumeric("RPC_SERVER_THREADS", "node.seed.")};
+const unsigned int RPC_MAX_CONNECTIONS{
+    ReadConstantNumeric("RPC_MAX_CONNECTIONS", "node.seed.")};
+const unsigned int RPC_KEEPALIVE_TIMEOUT_IN_SEC{
+    ReadConstantNumeric("RPC_KEEPALIVE_TIMEOUT_IN_SEC", "node.seed.")};
+const unsigned int RPC_MAX_REQUEST_BYTES{
+    ReadConstantNumeric("RPC_MAX_REQUEST_BYTES", "node.seed.")};
+const unsigned int RPC_MAX_IN_FLIGHT{
+    ReadConstantNumeric("RPC_MAX_IN_FLIGHT", "node.seed.")};
+const bool RPC_METRICS_ENDPOINT{
+    ReadConstantString("RPC_METRICS_ENDPOINT", "node.seed.") == "true"};
+const unsigned int RPC_RATE_LIMIT_MAX_CLIENTS{
+    ReadConstantNumeric("RPC_RATE_LIMIT_MAX_CLIENTS", "node.seed.")};
+const unsigned int RPC_CHEAP_READ_RATE{
+    ReadConstantNumeric("RPC_CHEAP_READ_RATE", "node.seed.")};
+const unsigned int RPC_CHEAP_READ_BURST{
+    ReadConstantNumeric("RPC_CHEAP_READ_BURST", "node.seed.")};
+const unsigned int RPC_HEAVY_READ_RATE{
+    ReadConstantNumeric("RPC_HEAVY_READ_RATE", "node.seed.")};
+const unsigned int RPC_HEAVY_READ_BURST{
+    ReadConstantNumeric("RPC_HEAVY_READ_BURST", "node.seed.")};
+const unsigned int RPC_WRITE_RATE{
+    ReadConstantNumeric("RPC_WRITE_RATE", "node.seed.")};
+const unsigned int RPC_WRITE_BURST{
+    ReadConstantNumeric("RPC_WRITE_BURST", "node.seed.")};
+const unsigned int CREATE_TXN_BATCH_MAX_SIZE{
+    ReadConstantNumeric("CREATE_TXN_BATCH_MAX_SIZE", "node.seed.")};
+const unsigned int CONTRACT_STATE_PAGE_SIZE{
+    ReadConstantNumeric("CONTRACT_STATE_PAGE_SIZE", "node.seed.")};
+const bool ENABLE_WEBSOCKET{
+    ReadConstantString("ENABLE_WEBSOCKET", "node.seed.") == "true"};
+const unsigned int WEBSOCKET_PORT{
+    ReadConstantNumeric("WEBSOCKET_PORT", "node.seed.")};
+const unsigned int WEBSOCKET_MAX_CONNECTIONS{
+    ReadConstantNumeric("WEBSOCKET_MAX_CONNECTIONS", "node.seed.")};
+const unsigned int WEBSOCKET_MAX_CLIENT_BUFFER_BYTES{
+    ReadConstantNumeric("WEBSOCKET_MAX_CLIENT_BUFFER_BYTES", "node.seed.")};
+const bool ENABLE_PROTO_RPC{
+    ReadConstantString("ENABLE_PROTO_RPC", "node.seed.") == "true"};
+const unsigned int PROTO_RPC_PORT{
+    ReadConstantNumeric("PROTO_RPC_PORT", "node.seed.")};
+const unsigned int PROTO_RPC_MAX_CONNECTIONS{
+    ReadConstantNumeric("PROTO_RPC_MAX_CONNECTIONS", "node.seed.")};
+const unsigned int STATE_SNAPSHOT_CHUNK_ACCOUNTS{
+    ReadConstantNumeric("STATE_SNAPSHOT_CHUNK_ACCOUNTS", "node.seed.")};
+const bool CHUNKED_STATE_SYNC{
+    ReadConstantString("CHUNKED_STATE_SYNC", "node.seed.") == "true"};
+const unsigned int TXBLOCK_SYNC_WINDOW_SIZE{
+    ReadConstantNumeric("TXBLOCK_SYNC_WINDOW_SIZE", "node.seed.")};
+const bool STATE_DELTA_WIRE_COMPRESSION{
+    ReadConstantString("STATE_DELTA_WIRE_COMPRESSION", "node.seed.") ==
+    "true"};
+const unsigned int SEED_RESPONSE_CACHE_SIZE{
+    ReadConstantNumeric("SEED_RESPONSE_CACHE_SIZE", "node.seed.")};
+const unsigned int SYNC_REQUEST_MAX_TARGETS{
+    ReadConstantNumeric("SYNC_REQUEST_MAX_TARGETS", "node.seed.")};
+const unsigned int SYNC_REQUEST_HEDGE_PERCENTILE{
+    ReadConstantNumeric("SYNC_REQUEST_HEDGE_PERCENTILE", "node.seed.")};
+const unsigned int SYNC_REQUEST_HEDGE_MAX_DELAY_IN_MS{
+    ReadConstantNumeric("SYNC_REQUEST_HEDGE_MAX_DELAY_IN_MS", "node.seed.")};
+const unsigned int SYNC_REQUEST_TIMEOUT_IN_MS{
+    ReadConstantNumeric("SYNC_REQUEST_TIMEOUT_IN_MS", "node.seed.")};
+const bool READ_REPLICA_MODE{
+    ReadConstantString("READ_REPLICA_MODE", "node.seed.") == "true"};
+const unsigned int READ_REPLICA_POLL_INTERVAL_IN_SEC{
+    ReadConstantNumeric("READ_REPLICA_POLL_INTERVAL_IN_SEC", "node.seed.")};
 
 // Consensus constants
+const unsigned int CONSENSUS_AGGREGATION_GROUP_SIZE{
+    ReadConstantNumeric("CONSENSUS_AGGREGATION_GROUP_SIZE", "node.consensus.")};
+const unsigned int CONSENSUS_AGGREGATION_TIMEOUT_IN_MS{ReadConstantNumeric(
+    "CONSENSUS_AGGREGATION_TIMEOUT_IN_MS", "node.consensus.")};
+const unsigned int COMMIT_POOL_SIZE{
+    ReadConstantNumeric("COMMIT_POOL_SIZE", "node.consensus.")};
 const unsigned int COMMIT_WINDOW_IN_SECONDS{
     ReadConstantNumeric("COMMIT_WINDOW_IN_SECONDS", "node.consensus.")};
 const unsigned int CONSENSUS_MSG_ORDER_BLOCK_WINDOW{
@@ -107,13 +266,38 @@ const unsigned int CONSENSUS_OBJECT_TIMEOUT{
     ReadConstantNumeric("CONSENSUS_OBJECT_TIMEOUT", "node.consensus.")};
 const unsigned int NUM_CONSENSUS_SUBSETS{
     ReadConstantNumeric("NUM_CONSENSUS_SUBSETS", "node.consensus.")};
+const string CONSENSUS_TRACE_FILE{
+    ReadConstantString("CONSENSUS_TRACE_FILE", "node.consensus.")};
+const bool CONSENSUS_TRACE_API{
+    ReadConstantString("CONSENSUS_TRACE_API", "node.consensus.") == "true"};
 
 // Data sharing constants
 const bool BROADCAST_TREEBASED_CLUSTER_MODE{
     ReadConstantString("BROADCAST_TREEBASED_CLUSTER_MODE",
                        "node.data_sharing.") == "true"};
+const bool BROADCAST_TREE_BY_NETWORK_PREFIX{
+    ReadConstantString("BROADCAST_TREE_BY_NETWORK_PREFIX",
+                       "node.data_sharing.") == "true"};
+const bool ENABLE_SHARDING_DIFF{
+    ReadConstantString("ENABLE_SHARDING_DIFF", "node.data_sharing.") ==
+    "true"};
+const bool ERASURE_CODED_BROADCAST_MODE{
+    ReadConstantString("ERASURE_CODED_BROADCAST_MODE",
+                       "node.data_sharing.") == "true"};
+const unsigned int ERASURE_CODED_DATA_CHUNKS_PERCENT{ReadConstantNumeric(
+    "ERASURE_CODED_DATA_CHUNKS_PERCENT", "node.data_sharing.")};
+const unsigned int ERASURE_CODED_MIN_MESSAGE_SIZE{ReadConstantNumeric(
+    "ERASURE_CODED_MIN_MESSAGE_SIZE", "node.data_sharing.")};
+const bool MBNFORWARD_TXN_HASHES_ONLY{
+    ReadConstantString("MBNFORWARD_TXN_HASHES_ONLY", "node.data_sharing.") ==
+    "true"};
+const bool MBNFORWARD_ON_MICROBLOCK_CONSENSUS{
+    ReadConstantString("MBNFORWARD_ON_MICROBLOCK_CONSENSUS",
+                       "node.data_sharing.") == "true"};
 const unsigned int MULTICAST_CLUSTER_SIZE{
     ReadConstantNumeric("MULTICAST_CLUSTER_SIZE", "node.data_sharing.")};
+const unsigned int MULTICAST_REDUNDANCY{
+    ReadConstantNumeric("MULTICAST_REDUNDANCY", "node.data_sharing.")};
 const unsigned int NUM_FORWARDED_BLOCK_RECEIVERS_PER_SHARD{ReadConstantNumeric(
     "NUM_FORWARDED_BLOCK_RECEIVERS_PER_SHARD", "node.data_sharing.")};
 const unsigned int NUM_NODES_TO_SEND_LOOKUP{
@@ -127,6 +311,8 @@ const unsigned int TX_SHARING_CLUSTER_SIZE{
 
 // Dispatcher constants
 const string TXN_PATH{ReadConstantString("TXN_PATH", "node.dispatcher.")};
+const string TXN_CORPUS_FILE{
+    ReadConstantString("TXN_CORPUS_FILE", "node.dispatcher.")};
 const bool USE_REMOTE_TXN_CREATOR{
     ReadConstantString("USE_REMOTE_TXN_CREATOR", "node.dispatcher.") == "true"};
 
@@ -139,6 +325,10 @@ const unsigned int FINALBLOCK_DELAY_IN_MS{
     ReadConstantNumeric("FINALBLOCK_DELAY_IN_MS", "node.epoch_timing.")};
 const unsigned int LOOKUP_DELAY_SEND_TXNPACKET_IN_MS{ReadConstantNumeric(
     "LOOKUP_DELAY_SEND_TXNPACKET_IN_MS", "node.epoch_timing.")};
+const unsigned int LOOKUP_TXN_STREAM_INTERVAL_IN_MS{ReadConstantNumeric(
+    "LOOKUP_TXN_STREAM_INTERVAL_IN_MS", "node.epoch_timing.")};
+const unsigned int LOOKUP_TXN_STREAM_BATCH_SIZE{
+    ReadConstantNumeric("LOOKUP_TXN_STREAM_BATCH_SIZE", "node.epoch_timing.")};
 const unsigned int MICROBLOCK_TIMEOUT{
     ReadConstantNumeric("MICROBLOCK_TIMEOUT", "node.epoch_timing.")};
 const unsigned int NEW_NODE_SYNC_INTERVAL{
@@ -153,6 +343,13 @@ const unsigned int RECOVERY_SYNC_TIMEOUT{
     ReadConstantNumeric("RECOVERY_SYNC_TIMEOUT", "node.epoch_timing.")};
 const unsigned int TX_DISTRIBUTE_TIME_IN_MS{
     ReadConstantNumeric("TX_DISTRIBUTE_TIME_IN_MS", "node.epoch_timing.")};
+const bool PIPELINED_MICROBLOCK_CONSENSUS{
+    ReadConstantString("PIPELINED_MICROBLOCK_CONSENSUS",
+                       "node.epoch_timing.") == "true"};
+const unsigned int TXN_POOL_SUMMARY_LEAD_TIME_IN_MS{ReadConstantNumeric(
+    "TXN_POOL_SUMMARY_LEAD_TIME_IN_MS", "node.epoch_timing.")};
+const unsigned int BACKUP_PRE_EXECUTION_LEAD_TIME_IN_MS{ReadConstantNumeric(
+    "BACKUP_PRE_EXECUTION_LEAD_TIME_IN_MS", "node.epoch_timing.")};
 const unsigned int NEW_LOOKUP_SYNC_DELAY_IN_SECONDS{ReadConstantNumeric(
     "NEW_LOOKUP_SYNC_DELAY_IN_SECONDS", "node.epoch_timing.")};
 
@@ -167,10 +364,25 @@ const unsigned int FALLBACK_INTERVAL_STARTED{
     ReadConstantNumeric("FALLBACK_INTERVAL_STARTED", "node.fallback.")};
 const unsigned int FALLBACK_INTERVAL_WAITING{
     ReadConstantNumeric("FALLBACK_INTERVAL_WAITING", "node.fallback.")};
+const unsigned int FALLBACK_ADAPTIVE_FACTOR{
+    ReadConstantNumeric("FALLBACK_ADAPTIVE_FACTOR", "node.fallback.")};
+const unsigned int FALLBACK_INTERVAL_WAITING_MIN{
+    ReadConstantNumeric("FALLBACK_INTERVAL_WAITING_MIN", "node.fallback.")};
+const unsigned int FALLBACK_HEALTH_WINDOW{
+    ReadConstantNumeric("FALLBACK_HEALTH_WINDOW", "node.fallback.")};
 
 // Gas constants
 const unsigned int MICROBLOCK_GAS_LIMIT{
     ReadConstantNumeric("MICROBLOCK_GAS_LIMIT", "node.gas.")};
+const bool ADAPTIVE_MICROBLOCK_GAS_LIMIT{
+    ReadConstantString("ADAPTIVE_MICROBLOCK_GAS_LIMIT", "node.gas.") ==
+    "true"};
+const unsigned int MICROBLOCK_GAS_LIMIT_MIN{
+    ReadConstantNumeric("MICROBLOCK_GAS_LIMIT_MIN", "node.gas.")};
+const unsigned int MICROBLOCK_EXECUTION_TARGET_IN_MS{
+    ReadConstantNumeric("MICROBLOCK_EXECUTION_TARGET_IN_MS", "node.gas.")};
+const unsigned int MICROBLOCK_GAS_TIMING_WINDOW{
+    ReadConstantNumeric("MICROBLOCK_GAS_TIMING_WINDOW", "node.gas.")};
 const unsigned int CONTRACT_CREATE_GAS{
     ReadConstantNumeric("CONTRACT_CREATE_GAS", "node.gas.")};
 const unsigned int CONTRACT_INVOKE_GAS{
@@ -232,6 +444,16 @@ const bool SIGN_VERIFY_EMPTY_MSGTYP{
 const bool SIGN_VERIFY_NONEMPTY_MSGTYP{
     ReadConstantString("SIGN_VERIFY_NONEMPTY_MSGTYP", "node.gossip.") ==
     "true"};
+const bool GOSSIP_BATCH_MESSAGES{
+    ReadConstantString("GOSSIP_BATCH_MESSAGES", "node.gossip.") == "true"};
+const bool GOSSIP_ADAPTIVE_FANOUT{
+    ReadConstantString("GOSSIP_ADAPTIVE_FANOUT", "node.gossip.") == "true"};
+const unsigned int GOSSIP_ADAPTIVE_MIN_NEIGHBORS{
+    ReadConstantNumeric("GOSSIP_ADAPTIVE_MIN_NEIGHBORS", "node.gossip.")};
+const unsigned int GOSSIP_ADAPTIVE_MIN_ROUNDS{
+    ReadConstantNumeric("GOSSIP_ADAPTIVE_MIN_ROUNDS", "node.gossip.")};
+const unsigned int GOSSIP_RAW_MSG_BUDGET_IN_BYTES{
+    ReadConstantNumeric("GOSSIP_RAW_MSG_BUDGET_IN_BYTES", "node.gossip.")};
 
 // GPU mining constants
 const string GPU_TO_USE{ReadConstantString("GPU_TO_USE", "node.gpu.")};
@@ -249,6 +471,8 @@ const unsigned int CUDA_STREAM_NUM{
     ReadConstantNumeric("STREAM_NUM", "node.gpu.cuda.")};
 const unsigned int CUDA_SCHEDULE_FLAG{
     ReadConstantNumeric("SCHEDULE_FLAG", "node.gpu.cuda.")};
+const string CUDA_GPU_TO_USE{
+    ReadConstantString("GPU_TO_USE", "node.gpu.cuda.")};
 
 // Guard mode constants
 const bool GUARD_MODE{ReadConstantString("GUARD_MODE", "node.guard_mode.") ==
@@ -262,6 +486,10 @@ const unsigned int WINDOW_FOR_DS_NETWORK_INFO_UPDATE{ReadConstantNumeric(
 const unsigned int HEARTBEAT_INTERVAL_IN_SECONDS{
     ReadConstantNumeric("HEARTBEAT_INTERVAL_IN_SECONDS", "node.heartbeat.")};
 
+// LevelDB constants
+const vector<LevelDBProfile> LEVELDB_PROFILES{
+    ReadLevelDBProfilesFromConstantsFile()};
+
 // Network composition constants
 const unsigned int COMM_SIZE{
     ReadConstantNumeric("COMM_SIZE", "node.network_composition.")};
@@ -282,24 +510,84 @@ const unsigned int FETCH_LOOKUP_MSG_MAX_RETRY{
 const uint32_t MAXMESSAGE{ReadConstantNumeric("MAXMESSAGE", "node.p2pcomm.")};
 const unsigned int MAXRETRYCONN{
     ReadConstantNumeric("MAXRETRYCONN", "node.p2pcomm.")};
-const unsigned int MSGQUEUE_SIZE{
-    ReadConstantNumeric("MSGQUEUE_SIZE", "node.p2pcomm.")};
 const unsigned int PUMPMESSAGE_MILLISECONDS{
     ReadConstantNumeric("PUMPMESSAGE_MILLISECONDS", "node.p2pcomm.")};
 const unsigned int SENDQUEUE_SIZE{
     ReadConstantNumeric("SENDQUEUE_SIZE", "node.p2pcomm.")};
+const unsigned int SENDQUEUE_BULK_SIZE{
+    ReadConstantNumeric("SENDQUEUE_BULK_SIZE", "node.p2pcomm.")};
 const unsigned int MAX_GOSSIP_MSG_SIZE_IN_BYTES{
     ReadConstantNumeric("MAX_GOSSIP_MSG_SIZE_IN_BYTES", "node.p2pcomm.")};
 const unsigned int MIN_READ_WATERMARK_IN_BYTES{
     ReadConstantNumeric("MIN_READ_WATERMARK_IN_BYTES", "node.p2pcomm.")};
 const unsigned int MAX_READ_WATERMARK_IN_BYTES{
     ReadConstantNumeric("MAX_READ_WATERMARK_IN_BYTES", "node.p2pcomm.")};
+const unsigned int MAX_IDLE_CONNECTIONS_PER_PEER{
+    ReadConstantNumeric("MAX_IDLE_CONNECTIONS_PER_PEER", "node.p2pcomm.")};
+const unsigned int IDLE_CONNECTION_TIMEOUT_IN_SECONDS{
+    ReadConstantNumeric("IDLE_CONNECTION_TIMEOUT_IN_SECONDS", "node.p2pcomm.")};
+const unsigned int INBOUND_BYTES_PER_SECOND{
+    ReadConstantNumeric("INBOUND_BYTES_PER_SECOND", "node.p2pcomm.")};
+const unsigned int INBOUND_MESSAGES_PER_SECOND{
+    ReadConstantNumeric("INBOUND_MESSAGES_PER_SECOND", "node.p2pcomm.")};
+const unsigned int P2P_COMPRESSION_THRESHOLD_IN_BYTES{ReadConstantNumeric(
+    "P2P_COMPRESSION_THRESHOLD_IN_BYTES", "node.p2pcomm.")};
+const unsigned int RECEIVE_REACTOR_THREADS{
+    ReadConstantNumeric("RECEIVE_REACTOR_THREADS", "node.p2pcomm.")};
+const unsigned int SEND_EVENT_LOOP_THREADS{
+    ReadConstantNumeric("SEND_EVENT_LOOP_THREADS", "node.p2pcomm.")};
+const unsigned int MESSAGE_POOL_IN_MB{
+    ReadConstantNumeric("MESSAGE_POOL_IN_MB", "node.p2pcomm.")};
+const unsigned int DISPATCH_CONSENSUS_THREADS{
+    ReadConstantNumeric("DISPATCH_CONSENSUS_THREADS", "node.p2pcomm.")};
+const unsigned int DISPATCH_CONSENSUS_QUEUE_SIZE{
+    ReadConstantNumeric("DISPATCH_CONSENSUS_QUEUE_SIZE", "node.p2pcomm.")};
+const unsigned int DISPATCH_DIRECTORY_THREADS{
+    ReadConstantNumeric("DISPATCH_DIRECTORY_THREADS", "node.p2pcomm.")};
+const unsigned int DISPATCH_DIRECTORY_QUEUE_SIZE{
+    ReadConstantNumeric("DISPATCH_DIRECTORY_QUEUE_SIZE", "node.p2pcomm.")};
+const unsigned int DISPATCH_NODE_THREADS{
+    ReadConstantNumeric("DISPATCH_NODE_THREADS", "node.p2pcomm.")};
+const unsigned int DISPATCH_NODE_QUEUE_SIZE{
+    ReadConstantNumeric("DISPATCH_NODE_QUEUE_SIZE", "node.p2pcomm.")};
+const unsigned int DISPATCH_LOOKUP_THREADS{
+    ReadConstantNumeric("DISPATCH_LOOKUP_THREADS", "node.p2pcomm.")};
+const unsigned int DISPATCH_LOOKUP_QUEUE_SIZE{
+    ReadConstantNumeric("DISPATCH_LOOKUP_QUEUE_SIZE", "node.p2pcomm.")};
+const unsigned int DISPATCH_TXN_THREADS{
+    ReadConstantNumeric("DISPATCH_TXN_THREADS", "node.p2pcomm.")};
+const unsigned int DISPATCH_TXN_QUEUE_SIZE{
+    ReadConstantNumeric("DISPATCH_TXN_QUEUE_SIZE", "node.p2pcomm.")};
+
+// Thread placement constants
+const string RECEIVE_PLACEMENT{
+    ReadConstantString("RECEIVE_PLACEMENT", "node.affinity.")};
+const string DISPATCH_PLACEMENT{
+    ReadConstantString("DISPATCH_PLACEMENT", "node.affinity.")};
+const string SEND_PLACEMENT{
+    ReadConstantString("SEND_PLACEMENT", "node.affinity.")};
+const string VERIFY_PLACEMENT{
+    ReadConstantString("VERIFY_PLACEMENT", "node.affinity.")};
+const string CPU_MINE_PLACEMENT{
+    ReadConstantString("CPU_MINE_PLACEMENT", "node.affinity.")};
 
 // PoW constants
 const bool CUDA_GPU_MINE{ReadConstantString("CUDA_GPU_MINE", "node.pow.") ==
                          "true"};
 const bool FULL_DATASET_MINE{
     ReadConstantString("FULL_DATASET_MINE", "node.pow.") == "true"};
+const string ETHASH_HUGE_PAGES{
+    ReadConstantString("ETHASH_HUGE_PAGES", "node.pow.")};
+const unsigned int CPU_MINE_THREADS{
+    ReadConstantNumeric("CPU_MINE_THREADS", "node.pow.")};
+const bool CPU_MINE_PIN_THREADS{
+    ReadConstantString("CPU_MINE_PIN_THREADS", "node.pow.") == "true"};
+const unsigned int POW_VERIFY_THREADS{
+    ReadConstantNumeric("POW_VERIFY_THREADS", "node.pow.")};
+const unsigned int ETHASH_PREGEN_BLOCKS{
+    ReadConstantNumeric("ETHASH_PREGEN_BLOCKS", "node.pow.")};
+const unsigned int POW_BATCH_VERIFY_THRESHOLD{
+    ReadConstantNumeric("POW_BATCH_VERIFY_THRESHOLD", "node.pow.")};
 const bool OPENCL_GPU_MINE{ReadConstantString("OPENCL_GPU_MINE", "node.pow.") ==
                            "true"};
 const bool REMOTE_MINE{ReadConstantString("REMOTE_MINE", "node.pow.") ==
@@ -312,6 +600,14 @@ const bool GETWORK_SERVER_MINE{
     ReadConstantString("GETWORK_SERVER_MINE", "node.pow.") == "true"};
 const unsigned int GETWORK_SERVER_PORT{
     ReadConstantNumeric("GETWORK_SERVER_PORT", "node.pow.")};
+const bool ENABLE_STRATUM_SERVER{
+    ReadConstantString("ENABLE_STRATUM_SERVER", "node.pow.") == "true"};
+const unsigned int STRATUM_SERVER_PORT{
+    ReadConstantNumeric("STRATUM_SERVER_PORT", "node.pow.")};
+const unsigned int STRATUM_MAX_CONNECTIONS{
+    ReadConstantNumeric("STRATUM_MAX_CONNECTIONS", "node.pow.")};
+const unsigned int STRATUM_SHARE_DIFFICULTY{
+    ReadConstantNumeric("STRATUM_SHARE_DIFFICULTY", "node.pow.")};
 const unsigned int DS_POW_DIFFICULTY{
     ReadConstantNumeric("DS_POW_DIFFICULTY", "node.pow.")};
 const unsigned int POW_DIFFICULTY{
@@ -352,6 +648,10 @@ const string UPGRADE_HOST_ACCOUNT{
     ReadConstantString("UPGRADE_HOST_ACCOUNT", "node.recovery.")};
 const string UPGRADE_HOST_REPO{
     ReadConstantString("UPGRADE_HOST_REPO", "node.recovery.")};
+const unsigned int UPGRADE_PEER_SEEDS{
+    ReadConstantNumeric("UPGRADE_PEER_SEEDS", "node.recovery.")};
+const unsigned int UPGRADE_PEER_FETCH_TIMEOUT_IN_SECONDS{ReadConstantNumeric(
+    "UPGRADE_PEER_FETCH_TIMEOUT_IN_SECONDS", "node.recovery.")};
 const bool RECOVERY_TRIM_INCOMPLETED_BLOCK{
     ReadConstantString("RECOVERY_TRIM_INCOMPLETED_BLOCK", "node.recovery.") ==
     "true"};
@@ -397,6 +697,15 @@ const bool HASHMAP_CONTRACT_STATE_DB{
 const bool ENABLE_SCILLA_MULTI_VERSION{
     ReadConstantString("ENABLE_SCILLA_MULTI_VERSION", "node.smart_contract.") ==
     "true"};
+const string SCILLA_SERVER_SOCKET{
+    ReadConstantString("SCILLA_SERVER_SOCKET", "node.smart_contract.")};
+const unsigned int SCILLA_SERVER_TIMEOUT_IN_MS{ReadConstantNumeric(
+    "SCILLA_SERVER_TIMEOUT_IN_MS", "node.smart_contract.")};
+const bool SCILLA_SERVER_LAZY_STATE{
+    ReadConstantString("SCILLA_SERVER_LAZY_STATE", "node.smart_contract.") ==
+    "true"};
+const unsigned int SCILLA_CODE_CACHE_SIZE{
+    ReadConstantNumeric("SCILLA_CODE_CACHE_SIZE", "node.smart_contract.")};
 
 // Test constants
 const bool ENABLE_CHECK_PERFORMANCE_LOG{
@@ -428,6 +737,24 @@ const unsigned int TXN_MISORDER_TOLERANCE_IN_PERCENT{ReadConstantNumeric(
     "TXN_MISORDER_TOLERANCE_IN_PERCENT", "node.transactions.")};
 const unsigned int PACKET_EPOCH_LATE_ALLOW{
     ReadConstantNumeric("PACKET_EPOCH_LATE_ALLOW", "node.transactions.")};
+const unsigned int TXN_PACKET_DECODE_BATCH_SIZE{ReadConstantNumeric(
+    "TXN_PACKET_DECODE_BATCH_SIZE", "node.transactions.")};
+const unsigned int TXN_VERIFY_THREADS{
+    ReadConstantNumeric("TXN_VERIFY_THREADS", "node.transactions.")};
+const unsigned int TXN_POOL_MAX_SIZE{
+    ReadConstantNumeric("TXN_POOL_MAX_SIZE", "node.transactions.")};
+const unsigned int TXN_POOL_MAX_TXNS_PER_SENDER{
+    ReadConstantNumeric("TXN_POOL_MAX_TXNS_PER_SENDER", "node.transactions.")};
+const unsigned int TXN_POOL_MAX_MB{
+    ReadConstantNumeric("TXN_POOL_MAX_MB", "node.transactions.")};
+const unsigned int PARALLEL_PAYMENT_BATCH_SIZE{
+    ReadConstantNumeric("PARALLEL_PAYMENT_BATCH_SIZE", "node.transactions.")};
+const bool BACKUP_APPLY_LEADER_TXN_ORDER{
+    ReadConstantString("BACKUP_APPLY_LEADER_TXN_ORDER", "node.transactions.") ==
+    "true"};
+const bool PREFETCH_PROPOSED_ACCOUNTS{
+    ReadConstantString("PREFETCH_PROPOSED_ACCOUNTS", "node.transactions.") ==
+    "true"};
 
 // Viewchange constants
 const unsigned int POST_VIEWCHANGE_BUFFER{
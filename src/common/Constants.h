@@ -49,6 +49,8 @@ const unsigned int CHALLENGE_SIZE = 32;
 const unsigned int RESPONSE_SIZE = 32;
 
 const unsigned int BLOCKCHAIN_SIZE = 50;
+// Blocks read back from persistent storage that a chain keeps in memory
+const unsigned int BLOCKCHAIN_HISTORY_CACHE_SIZE = 64;
 
 // Number of nodes sent from lookup node to newly joined node
 const unsigned int SEED_PEER_LIST_SIZE = 20;
@@ -76,6 +78,7 @@ enum MetaType : unsigned char {
   DSINCOMPLETED,
   LATESTACTIVEDSBLOCKNUM,
   WAKEUPFORUPGRADE,
+  VALIDATEDBCHECKPOINT,
 };
 
 // Sync Type
@@ -125,6 +128,32 @@ extern const bool ENABLE_DO_REJOIN;
 extern const bool LOOKUP_NODE_MODE;
 extern const unsigned int MAX_ENTRIES_FOR_DIAGNOSTIC_DATA;
 extern const uint16_t CHAIN_ID;
+extern const unsigned int TRIE_NODE_CACHE_SIZE_IN_MB;
+extern const unsigned int TRIE_NODE_CACHE_SHARDS;
+extern const unsigned int TRIE_NODE_NEGATIVE_CACHE_SIZE;
+extern const unsigned int KEY_HASH_CACHE_SIZE;
+extern const unsigned int STATE_DELTA_RETENTION_BLOCKS;
+extern const unsigned int STATE_PRUNING_KEEP_ROOTS;
+extern const unsigned int STATE_PRUNING_BATCH_SIZE;
+extern const bool STATE_ARCHIVE_MODE;
+extern const bool BLOCK_ARCHIVE_ENABLED;
+extern const unsigned int BLOCK_ARCHIVE_SEGMENT_SIZE_MB;
+extern const bool FAST_RESTART_ENABLED;
+extern const std::string EPOCH_METRICS_DUMP_FILE;
+extern const unsigned int EPOCH_METRICS_DUMP_INTERVAL;
+extern const unsigned int EPOCH_TIMELINE_EVENTS;
+extern const bool TRACE_ENABLED;
+extern const unsigned int TRACE_SAMPLE_RATE;
+extern const unsigned int TRACE_BUFFER_EVENTS;
+extern const std::string TRACE_DUMP_FILE;
+extern const bool PROFILER_API;
+extern const unsigned int PROFILER_MAX_SAMPLES;
+extern const bool MEMORY_STATS_API;
+extern const bool LOCK_PROFILING;
+extern const unsigned int ASYNC_EXECUTOR_THREADS;
+extern const unsigned int ASYNC_EXECUTOR_QUEUE_SIZE;
+extern const unsigned int BACKGROUND_WRITER_QUEUE_SIZE;
+extern const unsigned int BACKGROUND_WRITER_BATCH_SIZE;
 
 // Version constants
 extern const unsigned int MSG_VERSION;
@@ -138,20 +167,77 @@ extern const unsigned int BLOCKLINK_VERSION;
 extern const unsigned int DSCOMMITTEE_VERSION;
 extern const unsigned int SHARDINGSTRUCTURE_VERSION;
 extern const unsigned int ACCOUNT_VERSION;
+extern const unsigned int TXROOT_MERKLE_MICROBLOCK_VERSION;
+extern const unsigned int STATE_DELTA_VERSION;
 
 // Seed Node
 extern const bool ARCHIVAL_LOOKUP;
 extern const unsigned int SEED_TXN_COLLECTION_TIME_IN_SEC;
+extern const bool ENABLE_TXN_ADDRESS_INDEX;
+extern const unsigned int TXN_ADDRESS_INDEX_PAGE_SIZE;
+extern const unsigned int TXN_BODY_PARSE_THREADS;
+extern const unsigned int MAX_PENDING_TX_BODIES;
+extern const unsigned int TXN_FILTER_SLICES;
+extern const unsigned int TXN_FILTER_EPOCHS_PER_SLICE;
+extern const unsigned int TXN_FILTER_SLICE_BITS;
+extern const unsigned int TXN_FILTER_PROBES;
+extern const unsigned int JSON_RESPONSE_CACHE_SIZE;
+extern const unsigned int RPC_SERVER_THREADS;
+extern const unsigned int RPC_MAX_CONNECTIONS;
+extern const unsigned int RPC_KEEPALIVE_TIMEOUT_IN_SEC;
+extern const unsigned int RPC_MAX_REQUEST_BYTES;
+extern const unsigned int RPC_MAX_IN_FLIGHT;
+extern const bool RPC_METRICS_ENDPOINT;
+extern const unsigned int RPC_RATE_LIMIT_MAX_CLIENTS;
+extern const unsigned int RPC_CHEAP_READ_RATE;
+extern const unsigned int RPC_CHEAP_READ_BURST;
+extern const unsigned int RPC_HEAVY_READ_RATE;
+extern const unsigned int RPC_HEAVY_READ_BURST;
+extern const unsigned int RPC_WRITE_RATE;
+extern const unsigned int RPC_WRITE_BURST;
+extern const unsigned int CREATE_TXN_BATCH_MAX_SIZE;
+extern const unsigned int CONTRACT_STATE_PAGE_SIZE;
+extern const bool ENABLE_WEBSOCKET;
+extern const unsigned int WEBSOCKET_PORT;
+extern const unsigned int WEBSOCKET_MAX_CONNECTIONS;
+extern const unsigned int WEBSOCKET_MAX_CLIENT_BUFFER_BYTES;
+extern const bool ENABLE_PROTO_RPC;
+extern const unsigned int PROTO_RPC_PORT;
+extern const unsigned int PROTO_RPC_MAX_CONNECTIONS;
+extern const unsigned int STATE_SNAPSHOT_CHUNK_ACCOUNTS;
+extern const bool CHUNKED_STATE_SYNC;
+extern const unsigned int TXBLOCK_SYNC_WINDOW_SIZE;
+extern const bool STATE_DELTA_WIRE_COMPRESSION;
+extern const unsigned int SEED_RESPONSE_CACHE_SIZE;
+extern const unsigned int SYNC_REQUEST_MAX_TARGETS;
+extern const unsigned int SYNC_REQUEST_HEDGE_PERCENTILE;
+extern const unsigned int SYNC_REQUEST_HEDGE_MAX_DELAY_IN_MS;
+extern const unsigned int SYNC_REQUEST_TIMEOUT_IN_MS;
+extern const bool READ_REPLICA_MODE;
+extern const unsigned int READ_REPLICA_POLL_INTERVAL_IN_SEC;
 
 // Consensus constants
+extern const unsigned int CONSENSUS_AGGREGATION_GROUP_SIZE;
+extern const unsigned int CONSENSUS_AGGREGATION_TIMEOUT_IN_MS;
+extern const unsigned int COMMIT_POOL_SIZE;
 extern const unsigned int COMMIT_WINDOW_IN_SECONDS;
 extern const unsigned int CONSENSUS_MSG_ORDER_BLOCK_WINDOW;
 extern const unsigned int CONSENSUS_OBJECT_TIMEOUT;
 extern const unsigned int NUM_CONSENSUS_SUBSETS;
+extern const std::string CONSENSUS_TRACE_FILE;
+extern const bool CONSENSUS_TRACE_API;
 
 // Data sharing constants
 extern const bool BROADCAST_TREEBASED_CLUSTER_MODE;
+extern const bool BROADCAST_TREE_BY_NETWORK_PREFIX;
+extern const bool ENABLE_SHARDING_DIFF;
+extern const bool ERASURE_CODED_BROADCAST_MODE;
+extern const unsigned int ERASURE_CODED_DATA_CHUNKS_PERCENT;
+extern const unsigned int ERASURE_CODED_MIN_MESSAGE_SIZE;
+extern const bool MBNFORWARD_TXN_HASHES_ONLY;
+extern const bool MBNFORWARD_ON_MICROBLOCK_CONSENSUS;
 extern const unsigned int MULTICAST_CLUSTER_SIZE;
+extern const unsigned int MULTICAST_REDUNDANCY;
 extern const unsigned int NUM_FORWARDED_BLOCK_RECEIVERS_PER_SHARD;
 extern const unsigned int NUM_NODES_TO_SEND_LOOKUP;
 extern const unsigned int NUM_OF_TREEBASED_CHILD_CLUSTERS;
@@ -161,12 +247,15 @@ extern const unsigned int TX_SHARING_CLUSTER_SIZE;
 // Dispatcher constants
 extern const bool USE_REMOTE_TXN_CREATOR;
 extern const std::string TXN_PATH;
+extern const std::string TXN_CORPUS_FILE;
 
 // Epoch timing constants
 extern const unsigned int DELAY_FIRSTXNEPOCH_IN_MS;
 extern const unsigned int FETCHING_MISSING_DATA_TIMEOUT;
 extern const unsigned int FINALBLOCK_DELAY_IN_MS;
 extern const unsigned int LOOKUP_DELAY_SEND_TXNPACKET_IN_MS;
+extern const unsigned int LOOKUP_TXN_STREAM_INTERVAL_IN_MS;
+extern const unsigned int LOOKUP_TXN_STREAM_BATCH_SIZE;
 extern const unsigned int MICROBLOCK_TIMEOUT;
 extern const unsigned int NEW_NODE_SYNC_INTERVAL;
 extern const unsigned int POW_SUBMISSION_TIMEOUT;
@@ -174,6 +263,9 @@ extern const unsigned int POW_WINDOW_IN_SECONDS;
 extern const unsigned int POWPACKETSUBMISSION_WINDOW_IN_SECONDS;
 extern const unsigned int RECOVERY_SYNC_TIMEOUT;
 extern const unsigned int TX_DISTRIBUTE_TIME_IN_MS;
+extern const bool PIPELINED_MICROBLOCK_CONSENSUS;
+extern const unsigned int TXN_POOL_SUMMARY_LEAD_TIME_IN_MS;
+extern const unsigned int BACKUP_PRE_EXECUTION_LEAD_TIME_IN_MS;
 extern const unsigned int NEW_LOOKUP_SYNC_DELAY_IN_SECONDS;
 
 // Fallback constants
@@ -182,9 +274,16 @@ extern const unsigned int FALLBACK_CHECK_INTERVAL;
 extern const unsigned int FALLBACK_EXTRA_TIME;
 extern const unsigned int FALLBACK_INTERVAL_STARTED;
 extern const unsigned int FALLBACK_INTERVAL_WAITING;
+extern const unsigned int FALLBACK_ADAPTIVE_FACTOR;
+extern const unsigned int FALLBACK_INTERVAL_WAITING_MIN;
+extern const unsigned int FALLBACK_HEALTH_WINDOW;
 
 // Gas constants
 extern const unsigned int MICROBLOCK_GAS_LIMIT;
+extern const bool ADAPTIVE_MICROBLOCK_GAS_LIMIT;
+extern const unsigned int MICROBLOCK_GAS_LIMIT_MIN;
+extern const unsigned int MICROBLOCK_EXECUTION_TARGET_IN_MS;
+extern const unsigned int MICROBLOCK_GAS_TIMING_WINDOW;
 extern const unsigned int CONTRACT_CREATE_GAS;
 extern const unsigned int CONTRACT_INVOKE_GAS;
 extern const unsigned int NORMAL_TRAN_GAS;
@@ -215,6 +314,11 @@ extern const unsigned int SIMULATED_NETWORK_DELAY_IN_MS;
 extern const unsigned int KEEP_RAWMSG_FROM_LAST_N_ROUNDS;
 extern const bool SIGN_VERIFY_EMPTY_MSGTYP;
 extern const bool SIGN_VERIFY_NONEMPTY_MSGTYP;
+extern const bool GOSSIP_BATCH_MESSAGES;
+extern const bool GOSSIP_ADAPTIVE_FANOUT;
+extern const unsigned int GOSSIP_ADAPTIVE_MIN_NEIGHBORS;
+extern const unsigned int GOSSIP_ADAPTIVE_MIN_ROUNDS;
+extern const unsigned int GOSSIP_RAW_MSG_BUDGET_IN_BYTES;
 
 // GPU mining constants
 extern const std::string GPU_TO_USE;
@@ -225,6 +329,7 @@ extern const unsigned int CUDA_BLOCK_SIZE;
 extern const unsigned int CUDA_GRID_SIZE;
 extern const unsigned int CUDA_STREAM_NUM;
 extern const unsigned int CUDA_SCHEDULE_FLAG;
+extern const std::string CUDA_GPU_TO_USE;
 
 // Guard mode constants
 extern const bool GUARD_MODE;
@@ -234,6 +339,18 @@ extern const unsigned int WINDOW_FOR_DS_NETWORK_INFO_UPDATE;
 // Heartbeat constants
 extern const unsigned int HEARTBEAT_INTERVAL_IN_SECONDS;
 
+// LevelDB constants
+/// Open options for one database; 0 keeps the LevelDB default
+struct LevelDBProfile {
+  std::string m_dbName;
+  unsigned int m_blockCacheSizeInMB;
+  unsigned int m_bloomFilterBitsPerKey;
+  unsigned int m_writeBufferSizeInMB;
+  unsigned int m_blockSizeInKB;
+  bool m_compression;
+};
+extern const std::vector<LevelDBProfile> LEVELDB_PROFILES;
+
 // Network composition constants
 extern const unsigned int COMM_SIZE;
 extern const unsigned int NUM_DS_ELECTION;
@@ -246,22 +363,57 @@ extern const unsigned int BROADCAST_EXPIRY;
 extern const unsigned int FETCH_LOOKUP_MSG_MAX_RETRY;
 extern const uint32_t MAXMESSAGE;
 extern const unsigned int MAXRETRYCONN;
-extern const unsigned int MSGQUEUE_SIZE;
 extern const unsigned int PUMPMESSAGE_MILLISECONDS;
 extern const unsigned int SENDQUEUE_SIZE;
+extern const unsigned int SENDQUEUE_BULK_SIZE;
 extern const unsigned int MAX_GOSSIP_MSG_SIZE_IN_BYTES;
 extern const unsigned int MIN_READ_WATERMARK_IN_BYTES;
 extern const unsigned int MAX_READ_WATERMARK_IN_BYTES;
+extern const unsigned int MAX_IDLE_CONNECTIONS_PER_PEER;
+extern const unsigned int IDLE_CONNECTION_TIMEOUT_IN_SECONDS;
+extern const unsigned int INBOUND_BYTES_PER_SECOND;
+extern const unsigned int INBOUND_MESSAGES_PER_SECOND;
+extern const unsigned int P2P_COMPRESSION_THRESHOLD_IN_BYTES;
+extern const unsigned int RECEIVE_REACTOR_THREADS;
+extern const unsigned int SEND_EVENT_LOOP_THREADS;
+extern const unsigned int MESSAGE_POOL_IN_MB;
+extern const unsigned int DISPATCH_CONSENSUS_THREADS;
+extern const unsigned int DISPATCH_CONSENSUS_QUEUE_SIZE;
+extern const unsigned int DISPATCH_DIRECTORY_THREADS;
+extern const unsigned int DISPATCH_DIRECTORY_QUEUE_SIZE;
+extern const unsigned int DISPATCH_NODE_THREADS;
+extern const unsigned int DISPATCH_NODE_QUEUE_SIZE;
+extern const unsigned int DISPATCH_LOOKUP_THREADS;
+extern const unsigned int DISPATCH_LOOKUP_QUEUE_SIZE;
+extern const unsigned int DISPATCH_TXN_THREADS;
+extern const unsigned int DISPATCH_TXN_QUEUE_SIZE;
+
+// Thread placement constants
+extern const std::string RECEIVE_PLACEMENT;
+extern const std::string DISPATCH_PLACEMENT;
+extern const std::string SEND_PLACEMENT;
+extern const std::string VERIFY_PLACEMENT;
+extern const std::string CPU_MINE_PLACEMENT;
 
 // PoW constants
 extern const bool CUDA_GPU_MINE;
 extern const bool FULL_DATASET_MINE;
+extern const std::string ETHASH_HUGE_PAGES;
+extern const unsigned int CPU_MINE_THREADS;
+extern const bool CPU_MINE_PIN_THREADS;
+extern const unsigned int POW_VERIFY_THREADS;
+extern const unsigned int ETHASH_PREGEN_BLOCKS;
+extern const unsigned int POW_BATCH_VERIFY_THRESHOLD;
 extern const bool OPENCL_GPU_MINE;
 extern const bool REMOTE_MINE;
 extern const std::string MINING_PROXY_URL;
 extern const unsigned int CHECK_MINING_RESULT_INTERVAL;
 extern const bool GETWORK_SERVER_MINE;
 extern const unsigned int GETWORK_SERVER_PORT;
+extern const bool ENABLE_STRATUM_SERVER;
+extern const unsigned int STRATUM_SERVER_PORT;
+extern const unsigned int STRATUM_MAX_CONNECTIONS;
+extern const unsigned int STRATUM_SHARE_DIFFICULTY;
 extern const unsigned int DS_POW_DIFFICULTY;
 extern const unsigned int POW_DIFFICULTY;
 extern const unsigned int POW_SUBMISSION_LIMIT;
@@ -283,6 +435,8 @@ extern const unsigned int SHARD_DELAY_WAKEUP_IN_SECONDS;
 extern const unsigned int TERMINATION_COUNTDOWN_IN_SECONDS;
 extern const std::string UPGRADE_HOST_ACCOUNT;
 extern const std::string UPGRADE_HOST_REPO;
+extern const unsigned int UPGRADE_PEER_SEEDS;
+extern const unsigned int UPGRADE_PEER_FETCH_TIMEOUT_IN_SECONDS;
 extern const bool RECOVERY_TRIM_INCOMPLETED_BLOCK;
 extern const bool REJOIN_NODE_NOT_IN_NETWORK;
 extern const unsigned int RESUME_BLACKLIST_DELAY_IN_SECONDS;
@@ -302,6 +456,10 @@ extern const std::string OUTPUT_JSON;
 extern const std::string INPUT_CODE;
 extern const bool HASHMAP_CONTRACT_STATE_DB;
 extern const bool ENABLE_SCILLA_MULTI_VERSION;
+extern const std::string SCILLA_SERVER_SOCKET;
+extern const unsigned int SCILLA_SERVER_TIMEOUT_IN_MS;
+extern const bool SCILLA_SERVER_LAZY_STATE;
+extern const unsigned int SCILLA_CODE_CACHE_SIZE;
 
 // Test constants
 extern const bool ENABLE_CHECK_PERFORMANCE_LOG;
@@ -320,6 +478,14 @@ extern const unsigned int MAX_CONTRACT_DEPTH;
 extern const unsigned int SYS_TIMESTAMP_VARIANCE_IN_SECONDS;
 extern const unsigned int TXN_MISORDER_TOLERANCE_IN_PERCENT;
 extern const unsigned int PACKET_EPOCH_LATE_ALLOW;
+extern const unsigned int TXN_PACKET_DECODE_BATCH_SIZE;
+extern const unsigned int TXN_VERIFY_THREADS;
+extern const unsigned int TXN_POOL_MAX_SIZE;
+extern const unsigned int TXN_POOL_MAX_TXNS_PER_SENDER;
+extern const unsigned int TXN_POOL_MAX_MB;
+extern const unsigned int PARALLEL_PAYMENT_BATCH_SIZE;
+extern const bool BACKUP_APPLY_LEADER_TXN_ORDER;
+extern const bool PREFETCH_PROPOSED_ACCOUNTS;
 
 // Viewchange constants
 extern const unsigned int POST_VIEWCHANGE_BUFFER;
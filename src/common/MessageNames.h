@@ -85,9 +85,14 @@ static const std::string LookupInstructionStrings[]{
     MAKE_LITERAL_STRING(VCGETLATESTDSTXBLOCK),
     MAKE_LITERAL_STRING(FORWARDTXN),
     MAKE_LITERAL_STRING(GETGUARDNODENETWORKINFOUPDATE),
-    MAKE_LITERAL_STRING(SETHISTORICALDB)};
-
-static_assert(ARRAY_SIZE(LookupInstructionStrings) == SETHISTORICALDB + 1,
+    MAKE_LITERAL_STRING(SETHISTORICALDB),
+    MAKE_LITERAL_STRING(GETSTATESNAPSHOTFROMSEED),
+    MAKE_LITERAL_STRING(SETSTATESNAPSHOTFROMSEED),
+    MAKE_LITERAL_STRING(GETSTATECHUNKFROMSEED),
+    MAKE_LITERAL_STRING(SETSTATECHUNKFROMSEED)};
+
+static_assert(ARRAY_SIZE(LookupInstructionStrings) ==
+                  SETSTATECHUNKFROMSEED + 1,
               "LookupInstructionStrings definition is not correct");
 
 static const std::string *MessageTypeInstructionStrings[]{
@@ -110,6 +115,27 @@ static_assert(
     ARRAY_SIZE(MessageTypeInstructionStrings) == ARRAY_SIZE(MessageTypeStrings),
     "Size of MessageTypeInstructionStrings and MessageTypeStrings is not same");
 
+/// Returns TYPE_INSTRUCTION for a message, or INVALID_MESSAGE if either byte
+/// is out of range
+inline std::string GetMessageName(unsigned char msgType,
+                                  unsigned char instruction) {
+  const std::string InvalidMessageType = "INVALID_MESSAGE";
+  if (msgType >= ARRAY_SIZE(MessageTypeStrings)) {
+    return InvalidMessageType;
+  }
+
+  if (NULL == MessageTypeInstructionStrings[msgType]) {
+    return InvalidMessageType;
+  }
+
+  if (instruction >= MessageTypeInstructionSize[msgType]) {
+    return InvalidMessageType;
+  }
+
+  return MessageTypeStrings[msgType] + "_" +
+         MessageTypeInstructionStrings[msgType][instruction];
+}
+
 static const std::string MessageSizeKeyword = "Size of message ";
 static const std::string MessgeTimeKeyword = "Time to process message ";
 
@@ -57,6 +57,14 @@ enum NodeInstructionType : unsigned char {
   FALLBACKBLOCK = 0x0A,
   PROPOSEGASPRICE = 0x0B,
   DSGUARDNODENETWORKINFOUPDATE = 0x0C,
+  BLOCKCHUNK = 0x0D,
+  MBNFORWARDTXNHASHES = 0x0E,
+  GETMBNFORWARDTXNBODIES = 0x0F,
+  MBNFORWARDTXNBODIES = 0x10,
+  TXNPOOLSUMMARY = 0x11,
+  GETTXNPOOLBODIES = 0x12,
+  GETUPGRADECHUNK = 0x13,
+  UPGRADECHUNK = 0x14,
 };
 
 enum LookupInstructionType : unsigned char {
@@ -88,7 +96,11 @@ enum LookupInstructionType : unsigned char {
   VCGETLATESTDSTXBLOCK = 0x19,
   FORWARDTXN = 0x1A,
   GETGUARDNODENETWORKINFOUPDATE = 0x1B,
-  SETHISTORICALDB = 0x1C
+  SETHISTORICALDB = 0x1C,
+  GETSTATESNAPSHOTFROMSEED = 0x1D,
+  SETSTATESNAPSHOTFROMSEED = 0x1E,
+  GETSTATECHUNKFROMSEED = 0x1F,
+  SETSTATECHUNKFROMSEED = 0x20
 };
 
 enum TxSharingMode : unsigned char {
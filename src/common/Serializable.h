@@ -18,8 +18,101 @@
 #ifndef __SERIALIZABLE_H__
 #define __SERIALIZABLE_H__
 
+#include <cstring>
+#include <type_traits>
+
 #include "BaseType.h"
 
+namespace serializable_detail {
+
+template <unsigned int size>
+struct ByteSwapper;
+
+template <>
+struct ByteSwapper<1> {
+  template <class unsignedtype>
+  static unsignedtype Swap(unsignedtype value) {
+    return value;
+  }
+};
+
+template <>
+struct ByteSwapper<2> {
+  template <class unsignedtype>
+  static unsignedtype Swap(unsignedtype value) {
+    return static_cast<unsignedtype>(__builtin_bswap16(value));
+  }
+};
+
+template <>
+struct ByteSwapper<4> {
+  template <class unsignedtype>
+  static unsignedtype Swap(unsignedtype value) {
+    return static_cast<unsignedtype>(__builtin_bswap32(value));
+  }
+};
+
+template <>
+struct ByteSwapper<8> {
+  template <class unsignedtype>
+  static unsignedtype Swap(unsignedtype value) {
+    return static_cast<unsignedtype>(__builtin_bswap64(value));
+  }
+};
+
+/// Converts between host and big-endian byte order
+template <class unsignedtype>
+inline unsignedtype HostToBigEndian(unsignedtype value) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  return value;
+#else
+  return ByteSwapper<sizeof(unsignedtype)>::Swap(value);
+#endif
+}
+
+/// Big-endian codec of a width known at compile time. Types like uint128_t
+/// and fields narrower than their type go through an unrolled byte loop.
+template <class numerictype, unsigned int numerictype_len,
+          bool native = std::is_integral<numerictype>::value &&
+                        !std::is_same<numerictype, bool>::value &&
+                        numerictype_len == sizeof(numerictype)>
+struct BigEndianCodec {
+  static numerictype Read(const unsigned char* src) {
+    numerictype result = 0;
+    for (unsigned int i = 0; i < numerictype_len; i++) {
+      result = (result << 8) | numerictype(src[i]);
+    }
+    return result;
+  }
+
+  static void Write(unsigned char* dst, const numerictype& value) {
+    for (unsigned int i = 0; i < numerictype_len; i++) {
+      dst[i] = static_cast<uint8_t>(
+          (value >> ((numerictype_len - 1 - i) * 8)) & 0xFF);
+    }
+  }
+};
+
+/// Fields as wide as a native integer are one load or store plus a byte swap
+template <class numerictype, unsigned int numerictype_len>
+struct BigEndianCodec<numerictype, numerictype_len, true> {
+  typedef typename std::make_unsigned<numerictype>::type unsignedtype;
+
+  static numerictype Read(const unsigned char* src) {
+    unsignedtype raw;
+    std::memcpy(&raw, src, numerictype_len);
+    return static_cast<numerictype>(HostToBigEndian(raw));
+  }
+
+  static void Write(unsigned char* dst, numerictype value) {
+    const unsignedtype raw =
+        HostToBigEndian(static_cast<unsignedtype>(value));
+    std::memcpy(dst, &raw, numerictype_len);
+  }
+};
+
+}  // namespace serializable_detail
+
 /// Specifies the interface required for classes that are byte serializable.
 class Serializable {
  public:
@@ -52,6 +145,16 @@ class Serializable {
     return result;
   }
 
+  /// Same as GetNumber() above, with the length fixed at compile time.
+  template <class numerictype, unsigned int numerictype_len>
+  static numerictype GetNumber(const bytes& src, unsigned int offset) {
+    if (offset + numerictype_len > src.size()) {
+      return 0;
+    }
+    return serializable_detail::BigEndianCodec<
+        numerictype, numerictype_len>::Read(src.data() + offset);
+  }
+
   /// Template function for placing a number into the destination byte stream at
   /// the specified offset. Destination is resized if necessary.
   template <class numerictype>
@@ -69,6 +172,16 @@ class Serializable {
       right_shift -= 8;
     }
   }
+
+  /// Same as SetNumber() above, with the length fixed at compile time.
+  template <class numerictype, unsigned int numerictype_len>
+  static void SetNumber(bytes& dst, unsigned int offset, numerictype value) {
+    if (dst.size() < offset + numerictype_len) {
+      dst.resize(offset + numerictype_len);
+    }
+    serializable_detail::BigEndianCodec<numerictype, numerictype_len>::Write(
+        dst.data() + offset, value);
+  }
 };
 
 // This is a temporary class for use with data blocks
@@ -103,6 +216,16 @@ class SerializableDataBlock {
     return result;
   }
 
+  /// Same as GetNumber() above, with the length fixed at compile time.
+  template <class numerictype, unsigned int numerictype_len>
+  static numerictype GetNumber(const bytes& src, unsigned int offset) {
+    if (offset + numerictype_len > src.size()) {
+      return 0;
+    }
+    return serializable_detail::BigEndianCodec<
+        numerictype, numerictype_len>::Read(src.data() + offset);
+  }
+
   /// Template function for placing a number into the destination byte stream at
   /// the specified offset. Destination is resized if necessary.
   template <class numerictype>
@@ -120,6 +243,52 @@ class SerializableDataBlock {
       right_shift -= 8;
     }
   }
+
+  /// Same as SetNumber() above, with the length fixed at compile time.
+  template <class numerictype, unsigned int numerictype_len>
+  static void SetNumber(bytes& dst, unsigned int offset, numerictype value) {
+    if (dst.size() < offset + numerictype_len) {
+      dst.resize(offset + numerictype_len);
+    }
+    serializable_detail::BigEndianCodec<numerictype, numerictype_len>::Write(
+        dst.data() + offset, value);
+  }
+};
+
+/// Writes consecutive fields into a byte stream from a moving offset. Reserve()
+/// the total length up front so that the fields are appended without
+/// reallocating the stream.
+class SerializableWriter {
+  bytes& m_dst;
+  unsigned int m_offset;
+
+ public:
+  SerializableWriter(bytes& dst, unsigned int offset)
+      : m_dst(dst), m_offset(offset) {}
+
+  /// Makes room for len more bytes past the current offset.
+  void Reserve(unsigned int len) { m_dst.reserve(m_offset + len); }
+
+  template <class numerictype, unsigned int numerictype_len>
+  void Write(numerictype value) {
+    Serializable::SetNumber<numerictype, numerictype_len>(m_dst, m_offset,
+                                                          value);
+    m_offset += numerictype_len;
+  }
+
+  void WriteBytes(const unsigned char* src, unsigned int len) {
+    if (m_dst.size() < m_offset + len) {
+      m_dst.resize(m_offset + len);
+    }
+    if (len > 0) {
+      std::memcpy(m_dst.data() + m_offset, src, len);
+    }
+    m_offset += len;
+  }
+
+  void WriteBytes(const bytes& src) { WriteBytes(src.data(), src.size()); }
+
+  unsigned int GetOffset() const { return m_offset; }
 };
 
 #endif  // __SERIALIZABLE_H__
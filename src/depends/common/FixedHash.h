@@ -24,6 +24,7 @@
 #include <algorithm>
 #include <array>
 #include <cstdint>
+#include <cstring>
 #include <random>
 
 #include <boost/functional/hash.hpp>
@@ -362,6 +363,19 @@ namespace dev
         return boost::hash_range(data, data + 4);
     }
 
+    /// Fast std::hash compatible hash function object for h160. Addresses are
+    /// hash outputs themselves, so the leading words are already well mixed.
+    template<> inline size_t FixedHash<20>::hash::operator()(FixedHash<20> const& value) const
+    {
+        uint64_t words[2];
+        std::memcpy(words, value.data(), sizeof(words));
+        uint32_t tail;
+        std::memcpy(&tail, value.data() + sizeof(words), sizeof(tail));
+        size_t seed = boost::hash_range(words, words + 2);
+        boost::hash_combine(seed, tail);
+        return seed;
+    }
+
     /// Stream I/O for the FixedHash class.
     template <unsigned N>
     inline std::ostream& operator<<(std::ostream& _out, FixedHash<N> const& _h)
@@ -218,6 +218,10 @@ public:
 	}
 
 	virtual bool mine(const WorkPackage &w, Solution &solution) = 0;
+
+	/// Loads the DAG of the epoch of blockNumber onto the device ahead of
+	/// mine(), keeping it resident for every later work package of that epoch
+	virtual bool prepare(uint64_t blockNumber) { (void)blockNumber; return true; }
 	std::string getLog() const { return s_ssLog.str(); }
 
 protected:
@@ -15,6 +15,7 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include <string>
 
 #include <boost/filesystem.hpp>
@@ -39,9 +40,7 @@ LevelDB::LevelDB(const string& dbName, const string& path, const string& subdire
         return;
     }
 
-    leveldb::Options options;
-    options.max_open_files = 256;
-    options.create_if_missing = true;
+    leveldb::Options options = GetOptions();
 
     leveldb::DB* db;
     leveldb::Status status;
@@ -76,9 +75,7 @@ LevelDB::LevelDB(const std::string & dbName, const std::string& subdirectory, bo
     this->m_subdirectory = subdirectory;
     this->m_dbName = dbName;
 
-    leveldb::Options options;
-    options.max_open_files = 256;
-    options.create_if_missing = true;
+    leveldb::Options options = GetOptions();
 
     leveldb::DB* db;
     leveldb::Status status;
@@ -103,6 +100,61 @@ LevelDB::LevelDB(const std::string & dbName, const std::string& subdirectory, bo
     m_db.reset(db);
 }
 
+leveldb::Options LevelDB::GetOptions()
+{
+    leveldb::Options options;
+    options.max_open_files = 256;
+    options.create_if_missing = true;
+
+    auto profile = std::find_if(LEVELDB_PROFILES.begin(), LEVELDB_PROFILES.end(),
+                                [this](const LevelDBProfile& p) { return p.m_dbName == m_dbName; });
+    if (profile == LEVELDB_PROFILES.end())
+    {
+        return options;
+    }
+
+    // The cache and filter must outlive every DB opened with them, and are
+    // reused when the DB is reset
+    if (profile->m_blockCacheSizeInMB > 0)
+    {
+        if (!m_blockCache)
+        {
+            m_blockCache.reset(leveldb::NewLRUCache((size_t)profile->m_blockCacheSizeInMB * 1024 * 1024));
+        }
+        options.block_cache = m_blockCache.get();
+    }
+
+    if (profile->m_bloomFilterBitsPerKey > 0)
+    {
+        if (!m_filterPolicy)
+        {
+            m_filterPolicy.reset(leveldb::NewBloomFilterPolicy(profile->m_bloomFilterBitsPerKey));
+        }
+        options.filter_policy = m_filterPolicy.get();
+    }
+
+    if (profile->m_writeBufferSizeInMB > 0)
+    {
+        options.write_buffer_size = (size_t)profile->m_writeBufferSizeInMB * 1024 * 1024;
+    }
+
+    if (profile->m_blockSizeInKB > 0)
+    {
+        options.block_size = (size_t)profile->m_blockSizeInKB * 1024;
+    }
+
+    options.compression = profile->m_compression ? leveldb::kSnappyCompression : leveldb::kNoCompression;
+
+    LOG_GENERAL(INFO, "LevelDB " << m_dbName
+                      << " block cache " << profile->m_blockCacheSizeInMB << " MB"
+                      << ", bloom filter " << profile->m_bloomFilterBitsPerKey << " bits/key"
+                      << ", write buffer " << options.write_buffer_size
+                      << ", block size " << options.block_size
+                      << ", compression " << (profile->m_compression ? "on" : "off"));
+
+    return options;
+}
+
 leveldb::Slice toSlice(boost::multiprecision::uint256_t num)
 {
     dev::FixedHash<32> h;
@@ -182,6 +234,27 @@ std::shared_ptr<leveldb::DB> LevelDB::GetDB()
     return this->m_db;
 }
 
+size_t LevelDB::GetApproximateMemoryUsage() const
+{
+    string value;
+
+    if (!m_db || !m_db->GetProperty("leveldb.approximate-memory-usage", &value))
+    {
+        return 0;
+    }
+
+    try
+    {
+        return stoull(value);
+    }
+    catch (const exception&)
+    {
+        LOG_GENERAL(WARNING, "Bad memory usage " << value << " for "
+                                                 << m_dbName);
+        return 0;
+    }
+}
+
 int LevelDB::Insert(const dev::h256 & key, dev::bytesConstRef value)
 {
     return Insert(key, value.toString());
@@ -327,6 +400,51 @@ bool LevelDB::BatchInsert(const std::unordered_map<std::string, std::string>& kv
     return true;
 }
 
+void LevelDB::WriteBatch::Put(const leveldb::Slice & key, const leveldb::Slice & value)
+{
+    m_batch.Put(key, value);
+    m_count++;
+}
+
+void LevelDB::WriteBatch::Put(const dev::h256 & key, const dev::bytes & body)
+{
+    Put(leveldb::Slice(key.hex()), leveldb::Slice(dev::bytesConstRef(&body)));
+}
+
+void LevelDB::WriteBatch::Put(const boost::multiprecision::uint256_t & blockNum, const dev::bytes & body)
+{
+    Put(leveldb::Slice(blockNum.convert_to<string>()), leveldb::Slice(dev::bytesConstRef(&body)));
+}
+
+void LevelDB::WriteBatch::Delete(const leveldb::Slice & key)
+{
+    m_batch.Delete(key);
+    m_count++;
+}
+
+void LevelDB::WriteBatch::Delete(const boost::multiprecision::uint256_t & blockNum)
+{
+    Delete(leveldb::Slice(blockNum.convert_to<string>()));
+}
+
+bool LevelDB::Write(WriteBatch & batch)
+{
+    if (batch.m_count == 0)
+    {
+        return true;
+    }
+
+    ldb::Status s = m_db->Write(leveldb::WriteOptions(), &batch.m_batch);
+
+    if (!s.ok())
+    {
+        LOG_GENERAL(WARNING, "Batch write of " << batch.m_count << " entries to " << m_dbName << " failed: " << s.ToString());
+        return false;
+    }
+
+    return true;
+}
+
 bool LevelDB::Exists(const dev::h256 & key) const
 {
     auto ret = Lookup(key);
@@ -428,9 +546,7 @@ bool LevelDB::ResetDBForNormalNode()
     {
         boost::filesystem::remove_all("./" + PERSISTENCE_PATH + "/" + this->m_dbName);
 
-        leveldb::Options options;
-        options.max_open_files = 256;
-        options.create_if_missing = true;
+        leveldb::Options options = GetOptions();
 
         leveldb::DB* db;
 
@@ -472,9 +588,7 @@ bool LevelDB::ResetDBForLookupNode()
     {
         boost::filesystem::remove_all("./" + PERSISTENCE_PATH + "/" + this->m_dbName);
 
-        leveldb::Options options;
-        options.max_open_files = 256;
-        options.create_if_missing = true;
+        leveldb::Options options = GetOptions();
 
         leveldb::DB* db;
 
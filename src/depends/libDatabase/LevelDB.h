@@ -24,7 +24,10 @@
 #include <unordered_map>
 #include <vector>
 
+#include <leveldb/cache.h>
 #include <leveldb/db.h>
+#include <leveldb/filter_policy.h>
+#include <leveldb/write_batch.h>
 
 #include "depends/common/Common.h"
 #include "depends/common/FixedHash.h"
@@ -39,10 +42,44 @@ class LevelDB
 
     std::string m_subdirectory;
 
+    /// Set from the database's profile in LEVELDB_PROFILES, if any
+    std::shared_ptr<leveldb::Cache> m_blockCache;
+    std::shared_ptr<const leveldb::FilterPolicy> m_filterPolicy;
+
     std::shared_ptr<leveldb::DB> m_db;
 
+    /// Open options, including the database's profile
+    leveldb::Options GetOptions();
+
 public:
 
+    /// Puts collected and then applied to one database in a single write.
+    /// Keys are encoded as the matching Insert overloads do, and the data is
+    /// copied straight into the batch.
+    class WriteBatch
+    {
+        friend class LevelDB;
+
+        leveldb::WriteBatch m_batch;
+        size_t m_count = 0;
+
+    public:
+        void Put(const leveldb::Slice & key, const leveldb::Slice & value);
+
+        /// Same key as Insert(const dev::h256 &, const std::vector<unsigned char> &)
+        void Put(const dev::h256 & key, const dev::bytes & body);
+
+        /// Same key as Insert(const boost::multiprecision::uint256_t &, ...)
+        void Put(const boost::multiprecision::uint256_t & blockNum, const dev::bytes & body);
+
+        void Delete(const leveldb::Slice & key);
+
+        void Delete(const boost::multiprecision::uint256_t & blockNum);
+
+        /// Number of puts and deletes in the batch
+        size_t Count() const { return m_count; }
+    };
+
     /// Constructor.
     explicit LevelDB(const std::string & dbName, const std::string& subdirectory = "", bool diagnostic = false);
     explicit LevelDB(const std::string& dbName, const std::string& path, const std::string& subdirectory = "");
@@ -55,6 +92,9 @@ public:
     /// Returns the DB Name
     std::string GetDBName();
 
+    /// Bytes held by the memtables and the block cache, as leveldb estimates
+    size_t GetApproximateMemoryUsage() const;
+
     /// Returns the value at the specified key.
     std::string Lookup(const std::string & key) const;
 
@@ -99,6 +139,9 @@ public:
 
     bool BatchInsert(const std::unordered_map<std::string, std::string>& kv_map);
 
+    /// Applies all the puts and deletes in the batch atomically.
+    bool Write(WriteBatch & batch);
+
     /// Returns true if value corresponding to specified key exists.
     bool Exists(const dev::h256 & key) const;
     bool Exists(const boost::multiprecision::uint256_t & blockNum) const;
@@ -180,4 +180,15 @@ namespace dev
                 ret.insert(i.first);
         return ret;
     }
+
+    size_t MemoryDB::memoryUsage() const
+    {
+        shared_lock<shared_timed_mutex> lock(x_this);
+        size_t bytes = 0;
+        for (auto const& i: m_main)
+            bytes += sizeof(i) + i.second.first.size();
+        for (auto const& i: m_aux)
+            bytes += sizeof(i) + i.second.first.size();
+        return bytes;
+    }
 }
\ No newline at end of file
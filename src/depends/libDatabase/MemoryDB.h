@@ -54,6 +54,9 @@ namespace dev
 
         h256Hash keys() const;
 
+        /// Bytes of the nodes held in memory, keys included
+        size_t memoryUsage() const;
+
     protected:
 // #if DEV_GUARDED_DB
         mutable std::shared_timed_mutex x_this;
@@ -0,0 +1,170 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "NodeCache.h"
+
+using namespace std;
+
+namespace dev {
+
+NodeCache::NodeCache(size_t capacityInBytes, unsigned int numShards,
+                     size_t negativeCapacity) {
+  if (numShards == 0) {
+    numShards = 1;
+  }
+  for (unsigned int i = 0; i < numShards; i++) {
+    m_shards.emplace_back(make_unique<Shard>());
+  }
+  m_shardCapacity = capacityInBytes / numShards;
+  m_shardNegativeCapacity = (negativeCapacity + numShards - 1) / numShards;
+}
+
+NodeCache::Shard& NodeCache::GetShard(const h256& key) {
+  return *m_shards[std::hash<h256>{}(key) % m_shards.size()];
+}
+
+size_t NodeCache::Cost(const Entry& entry) {
+  // Rough per-entry overhead of the list node and the index slot
+  static constexpr size_t OVERHEAD = 96;
+  return entry.first.size + entry.second.size() + OVERHEAD;
+}
+
+bool NodeCache::Get(const h256& key, string& value) {
+  Shard& shard = GetShard(key);
+  lock_guard<mutex> g(shard.m_mutex);
+
+  auto it = shard.m_index.find(key);
+  if (it != shard.m_index.end()) {
+    shard.m_lru.splice(shard.m_lru.begin(), shard.m_lru, it->second);
+    value = it->second->second;
+    m_hits++;
+    return true;
+  }
+
+  auto missing = shard.m_missing.find(key);
+  if (missing != shard.m_missing.end()) {
+    shard.m_missingLru.splice(shard.m_missingLru.begin(), shard.m_missingLru,
+                              missing->second);
+    value.clear();
+    m_negativeHits++;
+    return true;
+  }
+
+  m_misses++;
+  return false;
+}
+
+void NodeCache::Put(const h256& key, const string& value) {
+  Shard& shard = GetShard(key);
+  Entry entry{key, value};
+  const size_t cost = Cost(entry);
+  if (cost > m_shardCapacity) {
+    return;
+  }
+
+  lock_guard<mutex> g(shard.m_mutex);
+
+  if (shard.m_index.count(key) > 0) {
+    return;
+  }
+
+  auto missing = shard.m_missing.find(key);
+  if (missing != shard.m_missing.end()) {
+    shard.m_missingLru.erase(missing->second);
+    shard.m_missing.erase(missing);
+  }
+
+  shard.m_lru.emplace_front(move(entry));
+  shard.m_index.emplace(key, shard.m_lru.begin());
+  shard.m_bytes += cost;
+
+  while (shard.m_bytes > m_shardCapacity) {
+    shard.m_bytes -= Cost(shard.m_lru.back());
+    shard.m_index.erase(shard.m_lru.back().first);
+    shard.m_lru.pop_back();
+  }
+}
+
+void NodeCache::PutMissing(const h256& key) {
+  if (m_shardNegativeCapacity == 0) {
+    return;
+  }
+
+  Shard& shard = GetShard(key);
+  lock_guard<mutex> g(shard.m_mutex);
+
+  if (shard.m_missing.count(key) > 0 || shard.m_index.count(key) > 0) {
+    return;
+  }
+
+  shard.m_missingLru.emplace_front(key);
+  shard.m_missing.emplace(key, shard.m_missingLru.begin());
+
+  while (shard.m_missingLru.size() > m_shardNegativeCapacity) {
+    shard.m_missing.erase(shard.m_missingLru.back());
+    shard.m_missingLru.pop_back();
+  }
+}
+
+void NodeCache::ForgetMissing(const h256& key) {
+  Shard& shard = GetShard(key);
+  lock_guard<mutex> g(shard.m_mutex);
+
+  auto missing = shard.m_missing.find(key);
+  if (missing != shard.m_missing.end()) {
+    shard.m_missingLru.erase(missing->second);
+    shard.m_missing.erase(missing);
+  }
+}
+
+void NodeCache::Forget(const h256& key) {
+  Shard& shard = GetShard(key);
+  lock_guard<mutex> g(shard.m_mutex);
+
+  auto it = shard.m_index.find(key);
+  if (it != shard.m_index.end()) {
+    shard.m_bytes -= Cost(*it->second);
+    shard.m_lru.erase(it->second);
+    shard.m_index.erase(it);
+  }
+}
+
+void NodeCache::Clear() {
+  for (auto& shard : m_shards) {
+    lock_guard<mutex> g(shard->m_mutex);
+    shard->m_lru.clear();
+    shard->m_index.clear();
+    shard->m_bytes = 0;
+    shard->m_missingLru.clear();
+    shard->m_missing.clear();
+  }
+}
+
+NodeCache::Stats NodeCache::GetStats() const {
+  return {m_hits.load(), m_negativeHits.load(), m_misses.load()};
+}
+
+size_t NodeCache::Size() {
+  size_t bytes = 0;
+  for (auto& shard : m_shards) {
+    lock_guard<mutex> g(shard->m_mutex);
+    bytes += shard->m_bytes;
+  }
+  return bytes;
+}
+
+}  // namespace dev
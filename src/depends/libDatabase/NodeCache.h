@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __NODECACHE_H__
+#define __NODECACHE_H__
+
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "depends/common/FixedHash.h"
+
+namespace dev {
+
+/// Trie nodes read from disk, keyed by node hash.
+///
+/// A node never changes under its hash, so an entry stays valid until the
+/// database is reset or the node is pruned. Keys are spread over shards with
+/// their own lock and least recently used list, and each shard keeps to its
+/// share of the byte budget; the upper trie levels, touched by every lookup,
+/// stay resident.
+/// Hashes found missing are remembered separately, up to a fixed count.
+class NodeCache {
+ public:
+  struct Stats {
+    uint64_t m_hits;
+    uint64_t m_negativeHits;
+    uint64_t m_misses;
+  };
+
+  NodeCache(size_t capacityInBytes, unsigned int numShards,
+            size_t negativeCapacity);
+
+  /// Returns true if the hash is cached, with value left empty if the
+  /// node is known to be missing
+  bool Get(const h256& key, std::string& value);
+
+  void Put(const h256& key, const std::string& value);
+  void PutMissing(const h256& key);
+
+  /// Called once a node is written, so it is no longer reported missing
+  void ForgetMissing(const h256& key);
+
+  /// Called once a node is deleted from disk
+  void Forget(const h256& key);
+
+  void Clear();
+
+  Stats GetStats() const;
+
+  /// Bytes currently charged against the budget
+  size_t Size();
+
+ private:
+  using Entry = std::pair<h256, std::string>;
+
+  struct Shard {
+    std::mutex m_mutex;
+    std::list<Entry> m_lru;
+    std::unordered_map<h256, std::list<Entry>::iterator> m_index;
+    size_t m_bytes = 0;
+    std::list<h256> m_missingLru;
+    std::unordered_map<h256, std::list<h256>::iterator> m_missing;
+  };
+
+  Shard& GetShard(const h256& key);
+  static size_t Cost(const Entry& entry);
+
+  std::vector<std::unique_ptr<Shard>> m_shards;
+  size_t m_shardCapacity;
+  size_t m_shardNegativeCapacity;
+
+  std::atomic<uint64_t> m_hits{0};
+  std::atomic<uint64_t> m_negativeHits{0};
+  std::atomic<uint64_t> m_misses{0};
+};
+
+}  // namespace dev
+
+#endif  // __NODECACHE_H__
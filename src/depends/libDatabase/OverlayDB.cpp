@@ -16,6 +16,8 @@
  * @date 2014
  */
 
+#include <cinttypes>
+#include <cstdio>
 #include <shared_mutex>
 #include <thread>
 
@@ -23,18 +25,129 @@
 
 #include "depends/common/Common.h"
 #include "depends/common/SHA3.h"
+#include "libUtils/Logger.h"
 #include "OverlayDB.h"
 
 using namespace std;
 using namespace dev;
 
+namespace
+{
+	// Kept apart from the nodes (hex keys) and the aux entries (255 suffix)
+	const string PRUNE_COMMIT_KEY = "prune.commit";
+	const string PRUNE_OLDEST_KEY = "prune.oldest";
+	const string PRUNE_JOURNAL_PREFIX = "prune.journal.";
+	const unsigned char REF_COUNT_SUFFIX = 254;
+
+	/// Marks a node that was on disk before pruning was enabled
+	const uint32_t REFS_PINNED = 0xFFFFFFFF;
+	const size_t REF_RECORD_SIZE = 12;
+
+	struct RefRecord
+	{
+		uint32_t m_refs;
+		/// Commit at which m_refs last dropped to zero
+		uint64_t m_zeroedAt;
+	};
+
+	string refKey(h256 const& _h)
+	{
+		string key(reinterpret_cast<char const*>(_h.data()), h256::size);
+		key.push_back(REF_COUNT_SUFFIX);
+		return key;
+	}
+
+	string journalKey(uint64_t _commit)
+	{
+		char digits[17];
+		snprintf(digits, sizeof(digits), "%016" PRIx64, _commit);
+		return PRUNE_JOURNAL_PREFIX + digits;
+	}
+
+	string encodeRecord(RefRecord const& _r)
+	{
+		string ret(REF_RECORD_SIZE, '\0');
+		for (unsigned int i = 0; i < 4; i++)
+			ret[i] = char(_r.m_refs >> (8 * (3 - i)));
+		for (unsigned int i = 0; i < 8; i++)
+			ret[4 + i] = char(_r.m_zeroedAt >> (8 * (7 - i)));
+		return ret;
+	}
+
+	bool decodeRecord(string const& _s, RefRecord& _r)
+	{
+		if (_s.size() != REF_RECORD_SIZE)
+			return false;
+		_r = {0, 0};
+		for (unsigned int i = 0; i < 4; i++)
+			_r.m_refs = (_r.m_refs << 8) | (unsigned char)_s[i];
+		for (unsigned int i = 0; i < 8; i++)
+			_r.m_zeroedAt = (_r.m_zeroedAt << 8) | (unsigned char)_s[4 + i];
+		return true;
+	}
+
+	uint64_t readCounter(LevelDB const& _db, string const& _key)
+	{
+		string value = _db.Lookup(_key);
+		return value.empty() ? 0 : stoull(value);
+	}
+}
+
 namespace dev
 {
 	h256 const EmptyTrie = sha3(rlp(""));
 
+	OverlayDB::OverlayDB(const std::string & dbName): m_levelDB(dbName)
+	{
+		if (TRIE_NODE_CACHE_SIZE_IN_MB > 0)
+			m_cache = make_unique<NodeCache>((size_t)TRIE_NODE_CACHE_SIZE_IN_MB * 1024 * 1024, TRIE_NODE_CACHE_SHARDS, TRIE_NODE_NEGATIVE_CACHE_SIZE);
+	}
+
+	OverlayDB::~OverlayDB()
+	{
+		{
+			lock_guard<mutex> g(m_pruneMutex);
+			m_pruneStop = true;
+		}
+		m_pruneCv.notify_all();
+		if (m_pruneThread.joinable())
+			m_pruneThread.join();
+	}
+
+	void OverlayDB::enablePruning(unsigned int keepRoots)
+	{
+		if (keepRoots == 0 || m_pruneThread.joinable())
+			return;
+
+		{
+			lock_guard<mutex> g(m_pruneMutex);
+			m_pruneKeepRoots = keepRoots;
+			m_pruneCommit = readCounter(m_levelDB, PRUNE_COMMIT_KEY);
+			m_pruneOldest = readCounter(m_levelDB, PRUNE_OLDEST_KEY);
+		}
+		m_pruneThread = thread(&OverlayDB::pruneLoop, this);
+	}
+
+	std::pair<uint64_t, uint64_t> OverlayDB::pruningProgress()
+	{
+		lock_guard<mutex> g(m_pruneMutex);
+		return {m_pruneCommit, m_pruneOldest};
+	}
+
 	void OverlayDB::ResetDB()
 	{
-		m_levelDB.ResetDB();
+		{
+			lock_guard<mutex> g(m_pruneMutex);
+			m_levelDB.ResetDB();
+			if (m_cache)
+				m_cache->Clear();
+			m_pruneCommit = 0;
+			m_pruneOldest = 0;
+			m_pruneResets++;
+		}
+
+		unique_lock<shared_timed_mutex> lock(x_this);
+		m_refDelta.clear();
 	}
 
 	void OverlayDB::commit()
@@ -44,7 +157,20 @@ namespace dev
 	// #endif
 		{
 			shared_lock<shared_timed_mutex> lock(x_this);
-			m_levelDB.BatchInsert(m_main, m_aux);
+			if (m_pruneKeepRoots > 0)
+				commitCounted();
+			else
+				m_levelDB.BatchInsert(m_main, m_aux);
+			if (m_cache)
+				for (auto const& i: m_main)
+					if (i.second.second)
+						m_cache->ForgetMissing(i.first);
+		}
+
+		if (m_cache)
+		{
+			NodeCache::Stats stats = m_cache->GetStats();
+			LOG_GENERAL(INFO, "Trie node cache hits " << stats.m_hits << " negative hits " << stats.m_negativeHits << " misses " << stats.m_misses << " size " << m_cache->Size());
 		}
 			
 	// #if DEV_GUARDED_DB
@@ -54,7 +180,151 @@ namespace dev
 			unique_lock<shared_timed_mutex> lock(x_this);
 			m_aux.clear();
 			m_main.clear();
+			m_refDelta.clear();
+		}
+
+		if (m_pruneKeepRoots > 0)
+			m_pruneCv.notify_one();
+	}
+
+	void OverlayDB::commitCounted()
+	{
+		lock_guard<mutex> g(m_pruneMutex);
+
+		LevelDB::WriteBatch batch;
+		for (auto const& i: m_main)
+			if (i.second.second)
+				batch.Put(leveldb::Slice(i.first.hex()), leveldb::Slice(i.second.first));
+		for (auto const& i: m_aux)
+			if (i.second.second)
+			{
+				bytes b = i.first.asBytes();
+				b.push_back(255);	// for aux
+				batch.Put(leveldb::Slice((char const*)b.data(), b.size()), leveldb::Slice((char const*)i.second.first.data(), i.second.first.size()));
+			}
+
+		string zeroed;
+		for (auto const& i: m_refDelta)
+		{
+			if (i.second == 0)
+				continue;
+
+			string const key = refKey(i.first);
+			RefRecord record;
+			if (!decodeRecord(m_levelDB.Lookup(key), record))
+			{
+				// Not counted from the start, so its other references are unknown
+				if (i.second < 0 || m_levelDB.Exists(i.first))
+					record = {REFS_PINNED, 0};
+				else
+					record = {0, 0};
+			}
+			else if (record.m_refs == REFS_PINNED)
+				continue;
+
+			if (record.m_refs != REFS_PINNED)
+			{
+				int64_t refs = (int64_t)record.m_refs + i.second;
+				if (refs < 0)
+				{
+					LOG_GENERAL(WARNING, "Trie node " << i.first << " killed more often than inserted, it is kept");
+					record.m_refs = REFS_PINNED;
+				}
+				else
+				{
+					record.m_refs = (uint32_t)refs;
+					if (refs == 0)
+					{
+						record.m_zeroedAt = m_pruneCommit;
+						zeroed.append(reinterpret_cast<char const*>(i.first.data()), h256::size);
+					}
+				}
+			}
+			batch.Put(leveldb::Slice(key), leveldb::Slice(encodeRecord(record)));
+		}
+
+		if (!zeroed.empty())
+			batch.Put(leveldb::Slice(journalKey(m_pruneCommit)), leveldb::Slice(zeroed));
+		string const next = to_string(m_pruneCommit + 1);
+		batch.Put(leveldb::Slice(PRUNE_COMMIT_KEY), leveldb::Slice(next));
+
+		if (!m_levelDB.Write(batch))
+		{
+			LOG_GENERAL(WARNING, "Failed to write the trie nodes and their reference counts");
+			return;
+		}
+		m_pruneCommit++;
+	}
+
+	void OverlayDB::pruneLoop()
+	{
+		unique_lock<mutex> lock(m_pruneMutex);
+		while (true)
+		{
+			m_pruneCv.wait(lock, [this] { return m_pruneStop || m_pruneOldest + m_pruneKeepRoots <= m_pruneCommit; });
+			if (m_pruneStop)
+				return;
+			pruneOldest(lock);
+		}
+	}
+
+	void OverlayDB::pruneOldest(unique_lock<mutex>& lock)
+	{
+		const uint64_t commit = m_pruneOldest;
+		const uint64_t resets = m_pruneResets;
+		const string key = journalKey(commit);
+		const string zeroed = m_levelDB.Lookup(key);
+		const size_t batchSize = max(STATE_PRUNING_BATCH_SIZE, 1u);
+
+		size_t deleted = 0;
+		for (size_t offset = 0; offset < zeroed.size();)
+		{
+			LevelDB::WriteBatch batch;
+			vector<h256> hashes;
+			for (size_t n = 0; n < batchSize && offset + h256::size <= zeroed.size(); n++, offset += h256::size)
+			{
+				h256 const h((byte const*)zeroed.data() + offset, h256::ConstructFromPointer);
+				string const refs = refKey(h);
+				RefRecord record;
+				// Referenced again since, or dropped to zero again later and
+				// left to that commit's journal
+				if (!decodeRecord(m_levelDB.Lookup(refs), record) || record.m_refs != 0 || record.m_zeroedAt != commit)
+					continue;
+				batch.Delete(leveldb::Slice(h.hex()));
+				batch.Delete(leveldb::Slice(refs));
+				hashes.emplace_back(h);
+			}
+			if (!m_levelDB.Write(batch))
+			{
+				LOG_GENERAL(WARNING, "Failed to delete unreachable trie nodes");
+				return;
+			}
+			if (m_cache)
+				for (auto const& h: hashes)
+					m_cache->Forget(h);
+			deleted += hashes.size();
+
+			// Let commits in between batches
+			lock.unlock();
+			this_thread::yield();
+			lock.lock();
+			if (m_pruneStop || m_pruneResets != resets)
+				return;
 		}
+
+		LevelDB::WriteBatch batch;
+		batch.Delete(leveldb::Slice(key));
+		string const next = to_string(commit + 1);
+		batch.Put(leveldb::Slice(PRUNE_OLDEST_KEY), leveldb::Slice(next));
+		if (!m_levelDB.Write(batch))
+		{
+			LOG_GENERAL(WARNING, "Failed to advance the trie pruning journal");
+			return;
+		}
+		m_pruneOldest = commit + 1;
+
+		if (deleted > 0)
+			LOG_GENERAL(INFO, "Deleted " << deleted << " unreachable trie nodes of commit " << commit);
 	}
 
 	bytes OverlayDB::lookupAux(h256 const& _h) const
@@ -76,15 +346,29 @@ namespace dev
 		unique_lock<shared_timed_mutex> lock(x_this);
 	// #endif
 		m_main.clear();
+		m_refDelta.clear();
 	}
 
 	std::string OverlayDB::lookup(h256 const& _h) const
 	{
 		std::string ret = MemoryDB::lookup(_h);
-	
-		if (ret.empty())
-			ret = m_levelDB.Lookup(_h);
-	
+
+		if (!ret.empty())
+			return ret;
+
+		if (m_cache && m_cache->Get(_h, ret))
+			return ret;
+
+		ret = m_levelDB.Lookup(_h);
+
+		if (m_cache)
+		{
+			if (ret.empty())
+				m_cache->PutMissing(_h);
+			else
+				m_cache->Put(_h, ret);
+		}
+
 		return ret;
 	}
 
@@ -93,11 +377,47 @@ namespace dev
 		if (MemoryDB::exists(_h))
 			return true;
 
-		return m_levelDB.Exists(_h);
+		std::string cached;
+		if (m_cache && m_cache->Get(_h, cached))
+			return !cached.empty();
+
+		bool ret = m_levelDB.Exists(_h);
+
+		if (m_cache && !ret)
+			m_cache->PutMissing(_h);
+
+		return ret;
+	}
+
+	NodeCache::Stats OverlayDB::cacheStats() const
+	{
+		if (m_cache)
+			return m_cache->GetStats();
+		return {0, 0, 0};
+	}
+
+	size_t OverlayDB::memoryUsage() const
+	{
+		return MemoryDB::memoryUsage() + (m_cache ? m_cache->Size() : 0);
+	}
+
+	void OverlayDB::insert(h256 const& _h, bytesConstRef _v)
+	{
+		MemoryDB::insert(_h, _v);
+		if (m_pruneKeepRoots > 0)
+		{
+			unique_lock<shared_timed_mutex> lock(x_this);
+			m_refDelta[_h]++;
+		}
 	}
 
 	void OverlayDB::kill(h256 const& _h)
 	{
 		MemoryDB::kill(_h);
+		if (m_pruneKeepRoots > 0)
+		{
+			unique_lock<shared_timed_mutex> lock(x_this);
+			m_refDelta[_h]--;
+		}
 	}
 }
\ No newline at end of file
@@ -19,13 +19,17 @@
 #ifndef __OVERLAYDB_H__
 #define __OVERLAYDB_H__
 
+#include <condition_variable>
 #include <memory>
+#include <mutex>
+#include <thread>
 
 #include "common/Constants.h"
 #include "depends/common/Common.h"
 #include "depends/common/RLP.h"
 #include "LevelDB.h"
 #include "MemoryDB.h"
+#include "NodeCache.h"
 
 namespace dev
 {
@@ -33,8 +37,14 @@ namespace dev
 	class OverlayDB: public MemoryDB
 	{
 	public:
-		explicit OverlayDB(const std::string & dbName): m_levelDB(dbName) {}
-		~OverlayDB() = default;
+		explicit OverlayDB(const std::string & dbName);
+		~OverlayDB();
+
+		/// Keeps a reference count on disk for every node written from now on
+		/// and deletes, in the background, the nodes no longer reachable from
+		/// any of the last keepRoots committed roots. Nodes already on disk
+		/// are never deleted.
+		void enablePruning(unsigned int keepRoots);
 
 		void ResetDB();
 
@@ -43,14 +53,50 @@ namespace dev
 
 		std::string lookup(h256 const& _h) const;
 		bool exists(h256 const& _h) const;
+		void insert(h256 const& _h, bytesConstRef _v);
 		void kill(h256 const& _h);
 
 		bytes lookupAux(h256 const& _h) const;
 
+		/// Node cache counters, all zero if the cache is disabled
+		NodeCache::Stats cacheStats() const;
+
+		/// Bytes of the uncommitted nodes and of the node cache
+		size_t memoryUsage() const;
+
+		/// Commits so far, and the oldest one whose unreachable nodes are not
+		/// deleted yet; both zero if pruning is disabled
+		std::pair<uint64_t, uint64_t> pruningProgress();
+
 	private:
 		using MemoryDB::clear;
 
+		/// Writes the uncommitted nodes together with their new reference
+		/// counts and the journal of the nodes that dropped to zero
+		void commitCounted();
+
+		/// Deletes the nodes that dropped to zero in the oldest journaled
+		/// commit and still are, STATE_PRUNING_BATCH_SIZE at a time
+		void pruneOldest(std::unique_lock<std::mutex>& lock);
+		void pruneLoop();
+
 		LevelDB m_levelDB;
+		/// Nodes already read from m_levelDB, null if TRIE_NODE_CACHE_SIZE_IN_MB is 0
+		std::unique_ptr<NodeCache> m_cache;
+
+		/// Roots kept whole, 0 if pruning is disabled
+		unsigned int m_pruneKeepRoots = 0;
+		/// Inserts less kills of each node since the last commit
+		std::unordered_map<h256, int> m_refDelta;
+		/// Guards the counts on disk and the fields below
+		std::mutex m_pruneMutex;
+		std::condition_variable m_pruneCv;
+		uint64_t m_pruneCommit = 0;
+		uint64_t m_pruneOldest = 0;
+		/// Bumped by ResetDB so that a prune in progress gives up
+		uint64_t m_pruneResets = 0;
+		bool m_pruneStop = false;
+		std::thread m_pruneThread;
 	};
 }
 
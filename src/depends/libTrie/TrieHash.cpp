@@ -13,6 +13,7 @@
 */
 // adapted from https://github.com/ethereum/cpp-ethereum/blob/develop/libdevcore/TrieHash.cpp
 
+#include <future>
 #include <vector>
 
 #include "depends/libDatabase/MemoryDB.h"
@@ -109,6 +110,118 @@ namespace dev
         return sha3(rlp256(_s));
     }
 
+    namespace
+    {
+        using TrieNodes = std::vector<std::pair<h256, bytes>>;
+
+        void buildTrieAux(HexMap::const_iterator _begin, HexMap::const_iterator _end, unsigned _preLen, RLPStream& _rlp, TrieNodes& _nodes, bool _parallel);
+
+        /// hash256rlp, also collecting the nodes referenced by hash
+        void buildTrieRlp(HexMap::const_iterator _begin, HexMap::const_iterator _end, unsigned _preLen, RLPStream& _rlp, TrieNodes& _nodes, bool _parallel)
+        {
+            if (_begin == _end)
+                _rlp << "";	// NULL
+            else if (std::next(_begin) == _end)
+            {
+                // only one left - terminate with the pair.
+                _rlp.appendList(2) << hexPrefixEncode(_begin->first, true, _preLen) << _begin->second;
+            }
+            else
+            {
+                // find the number of common prefix nibbles shared
+                unsigned sharedPre = (unsigned)-1;
+                for (auto i = std::next(_begin); i != _end && sharedPre; ++i)
+                {
+                    unsigned x = std::min(sharedPre, std::min((unsigned)_begin->first.size(), (unsigned)i->first.size()));
+                    unsigned shared = _preLen;
+                    for (; shared < x && _begin->first[shared] == i->first[shared]; ++shared) {}
+                    sharedPre = std::min(shared, sharedPre);
+                }
+                if (sharedPre > _preLen)
+                {
+                    // if they all have the same next nibble, we also want a pair.
+                    _rlp.appendList(2) << hexPrefixEncode(_begin->first, false, _preLen, (int)sharedPre);
+                    buildTrieAux(_begin, _end, (unsigned)sharedPre, _rlp, _nodes, _parallel);
+                }
+                else
+                {
+                    // otherwise enumerate all 16+1 entries.
+                    _rlp.appendList(17);
+                    auto b = _begin;
+                    if (_preLen == b->first.size())
+                        ++b;
+
+                    // The 16 subtrees share nothing, so each one can be built on its own thread
+                    std::array<HexMap::const_iterator, 17> bounds;
+                    bounds[0] = b;
+                    for (auto i = 0; i < 16; ++i)
+                    {
+                        auto n = bounds[i];
+                        for (; n != _end && n->first[_preLen] == i; ++n) {}
+                        bounds[i + 1] = n;
+                    }
+
+                    std::array<RLPStream, 16> children;
+                    std::array<TrieNodes, 16> childNodes;
+                    std::vector<std::future<void>> pending;
+                    for (auto i = 0; i < 16; ++i)
+                    {
+                        if (bounds[i] == bounds[i + 1])
+                            children[i] << "";
+                        else if (_parallel)
+                            pending.emplace_back(std::async(std::launch::async, [&, i]() {
+                                buildTrieAux(bounds[i], bounds[i + 1], _preLen + 1, children[i], childNodes[i], false);
+                            }));
+                        else
+                            buildTrieAux(bounds[i], bounds[i + 1], _preLen + 1, children[i], _nodes, false);
+                    }
+                    for (auto& f: pending)
+                        f.get();
+
+                    for (auto i = 0; i < 16; ++i)
+                    {
+                        _rlp.appendRaw(children[i].out());
+                        _nodes.insert(_nodes.end(), std::make_move_iterator(childNodes[i].begin()), std::make_move_iterator(childNodes[i].end()));
+                    }
+
+                    if (_preLen == _begin->first.size())
+                        _rlp << _begin->second;
+                    else
+                        _rlp << "";
+                }
+            }
+        }
+
+        void buildTrieAux(HexMap::const_iterator _begin, HexMap::const_iterator _end, unsigned _preLen, RLPStream& _rlp, TrieNodes& _nodes, bool _parallel)
+        {
+            RLPStream rlp;
+            buildTrieRlp(_begin, _end, _preLen, rlp, _nodes, _parallel);
+            if (rlp.out().size() < 32)
+            {
+                // RECURSIVE RLP
+                _rlp.appendRaw(rlp.out());
+            }
+            else
+            {
+                h256 h = sha3(rlp.out());
+                _rlp << h;
+                _nodes.emplace_back(h, rlp.out());
+            }
+        }
+    }
+
+    h256 buildTrie(BytesMap const& _s, std::vector<std::pair<h256, bytes>>& _nodes)
+    {
+        HexMap hexMap;
+        for (auto const& i: _s)
+            hexMap[asNibbles(bytesConstRef(&i.first))] = i.second;
+        RLPStream s;
+        buildTrieRlp(hexMap.cbegin(), hexMap.cend(), 0, s, _nodes, true);
+        h256 root = sha3(s.out());
+        _nodes.emplace_back(root, s.out());
+        return root;
+    }
+
     h256 orderedTrieRoot(std::vector<bytes> const& _data)
     {
         BytesMap m;
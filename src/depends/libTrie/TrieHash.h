@@ -23,6 +23,8 @@
 #include <array>
 #include <list>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "depends/common/FixedHash.h"
 #include "common/Constants.h"
@@ -46,6 +48,14 @@ namespace dev
 
     h256 orderedTrieRoot(std::vector<bytesConstRef> const& _data);
     h256 orderedTrieRoot(std::vector<bytes> const& _data);
+
+    /// Builds the trie holding _s from scratch and returns its root, as
+    /// hash256() does. _nodes receives every node a GenericTrieDB stores for
+    /// it (those referenced by hash, and the root), so that loading them into
+    /// its DB and setting the root gives the same trie as inserting _s one
+    /// pair at a time. The subtrees under the first branch node are built in
+    /// parallel.
+    h256 buildTrie(BytesMap const& _s, std::vector<std::pair<h256, bytes>>& _nodes);
 }
 
 #endif // __TRIEHASH_H__
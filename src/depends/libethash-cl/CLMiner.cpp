@@ -273,6 +273,20 @@ typedef struct {
     unsigned mix[8];
 } search_results;
 
+bool CLMiner::prepare(uint64_t blockNumber)
+{
+    if (m_currentWP.blockNumber / ETHASH_EPOCH_LENGTH == blockNumber / ETHASH_EPOCH_LENGTH)
+        return true;
+
+    if (!init(blockNumber))
+        return false;
+
+    // Same epoch from now on, so mine() only has to upload the next header
+    m_currentWP.header = h256();
+    m_currentWP.blockNumber = blockNumber;
+    return true;
+}
+
 bool CLMiner::mine(const WorkPackage &w, Solution &solution)
 {
     // Memory for zero-ing buffers. Cannot be static because crashes on macOS.
@@ -87,6 +87,7 @@ public:
 	}
 	static void setCLKernel(unsigned _clKernel) { s_clKernelName = _clKernel == 1 ? CLKernelName::Experimental : CLKernelName::Stable; }
     bool mine(const WorkPackage &w, Solution &solution) override;
+	bool prepare(uint64_t blockNumber) override;
 
 private:
 
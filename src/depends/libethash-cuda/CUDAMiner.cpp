@@ -431,6 +431,18 @@ void CUDAMiner::search(
         solution = Solution{current_nonce, h256{}, false};
 }
 
+bool CUDAMiner::prepare(uint64_t blockNumber)
+{
+    if (m_currentWP.blockNumber / ETHASH_EPOCH_LENGTH == blockNumber / ETHASH_EPOCH_LENGTH)
+        return true;
+
+    if (!init(blockNumber))
+        return false;
+
+    m_currentWP.blockNumber = blockNumber;
+    return true;
+}
+
 bool CUDAMiner::mine(const WorkPackage &w, Solution &solution)
 {
     if (m_currentWP.blockNumber / ETHASH_EPOCH_LENGTH != w.blockNumber / ETHASH_EPOCH_LENGTH)
@@ -84,6 +84,7 @@ public:
 	// default number of CUDA streams
 	static unsigned const c_defaultNumStreams;
 	bool mine(const WorkPackage &w, Solution &solution) override;
+	bool prepare(uint64_t blockNumber) override;
 
 private:
 
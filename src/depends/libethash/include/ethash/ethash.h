@@ -7,6 +7,7 @@
 
 #include <ethash/hash_types.h>
 
+#include <stddef.h>
 #include <stdint.h>
 
 #ifdef __cplusplus
@@ -61,6 +62,20 @@ int ethash_calculate_light_cache_num_items(int epoch_number) NOEXCEPT;
 int ethash_calculate_full_dataset_num_items(int epoch_number) NOEXCEPT;
 
 
+/**
+ * Allocator for the light cache and the full dataset of new contexts.
+ *
+ * allocate must return zero-filled memory, or null when out of memory, and
+ * release gets back what allocate returned. Defaults to calloc() and free().
+ * A context is released with the functions set at the time it is destroyed,
+ * so they should be set before the first context is created.
+ */
+typedef void* (*ethash_allocate_fn)(size_t size);
+typedef void (*ethash_release_fn)(void* ptr);
+
+void ethash_set_allocator(ethash_allocate_fn allocate, ethash_release_fn release) NOEXCEPT;
+
+
 struct ethash_epoch_context* ethash_create_epoch_context(int epoch_number) NOEXCEPT;
 
 /**
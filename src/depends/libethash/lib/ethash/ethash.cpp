@@ -361,6 +361,14 @@ int ethash_calculate_full_dataset_num_items(int epoch_number) noexcept
 
 namespace
 {
+void* default_allocate(size_t size) noexcept
+{
+    return std::calloc(1, size);
+}
+
+ethash_allocate_fn allocate_memory = default_allocate;
+ethash_release_fn release_memory = std::free;
+
 epoch_context_full* create_epoch_context(int epoch_number, bool full) noexcept
 {
     static_assert(sizeof(epoch_context_full) < sizeof(hash512), "epoch_context too big");
@@ -370,7 +378,7 @@ epoch_context_full* create_epoch_context(int epoch_number, bool full) noexcept
     const size_t light_cache_size = get_light_cache_size(light_cache_num_items);
     const size_t alloc_size = context_alloc_size + light_cache_size;
 
-    char* const alloc_data = static_cast<char*>(std::malloc(alloc_size));
+    char* const alloc_data = static_cast<char*>(allocate_memory(alloc_size));
     if (!alloc_data)
         return nullptr;  // Signal out-of-memory by returning null pointer.
 
@@ -384,10 +392,10 @@ epoch_context_full* create_epoch_context(int epoch_number, bool full) noexcept
     {
         // TODO: This can be "optimized" by doing single allocation for light and full caches.
         const size_t num_items = static_cast<size_t>(full_dataset_num_items);
-        full_dataset = static_cast<hash1024*>(std::calloc(num_items, sizeof(hash1024)));
+        full_dataset = static_cast<hash1024*>(allocate_memory(num_items * sizeof(hash1024)));
         if (!full_dataset)
         {
-            std::free(alloc_data);
+            release_memory(alloc_data);
             return nullptr;
         }
     }
@@ -403,6 +411,12 @@ epoch_context_full* create_epoch_context(int epoch_number, bool full) noexcept
 }
 }  // namespace
 
+void ethash_set_allocator(ethash_allocate_fn allocate, ethash_release_fn release) noexcept
+{
+    allocate_memory = allocate ? allocate : default_allocate;
+    release_memory = release ? release : std::free;
+}
+
 epoch_context* ethash_create_epoch_context(int epoch_number) noexcept
 {
     return create_epoch_context(epoch_number, false);
@@ -415,14 +429,15 @@ epoch_context_full* ethash_create_epoch_context_full(int epoch_number) noexcept
 
 void ethash_destroy_epoch_context_full(epoch_context_full* context) noexcept
 {
-    std::free(context->full_dataset);
+    if (context->full_dataset)
+        release_memory(context->full_dataset);
     ethash_destroy_epoch_context(context);
 }
 
 void ethash_destroy_epoch_context(epoch_context* context) noexcept
 {
     context->~epoch_context();
-    std::free(context);
+    release_memory(context);
 }
 
 }  // extern "C"
@@ -0,0 +1,152 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <json/json.h>
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+// Merges the GetEpochTimeline responses of several nodes into one
+// network-wide timeline. Each input file holds either the JSON-RPC response
+// or just its result. Every event is written to the output csv with its
+// offset from the first event of its epoch on any node, using the wall
+// clock of each node; a per-epoch summary of when each event happened
+// across the network is printed.
+
+struct MergedEvent {
+  uint64_t epoch;
+  uint64_t wall;
+  std::string peer;
+  std::string role;
+  std::string event;
+};
+
+bool readTimeline(const std::string& filename,
+                  std::vector<MergedEvent>& events) {
+  std::ifstream in(filename);
+  Json::Value root;
+  Json::CharReaderBuilder builder;
+  std::string errors;
+  if (!in.is_open() || !Json::parseFromStream(builder, in, &root, &errors)) {
+    std::cout << "Cannot parse " << filename << " " << errors << std::endl;
+    return false;
+  }
+
+  const Json::Value& timeline = root.isMember("result") ? root["result"] : root;
+  if (!timeline.isMember("Events") || !timeline["Events"].isArray()) {
+    std::cout << filename << " holds no timeline" << std::endl;
+    return false;
+  }
+
+  const std::string peer = timeline.get("Peer", filename).asString();
+  for (const auto& entry : timeline["Events"]) {
+    events.push_back({entry["Epoch"].asUInt64(), entry["Wall"].asUInt64(),
+                      peer, entry["Role"].asString(),
+                      entry["Kind"].asString() + " " +
+                          entry["Name"].asString()});
+  }
+  return true;
+}
+
+double toMilliseconds(uint64_t microseconds) { return microseconds / 1000.0; }
+
+void printSummary(uint64_t epoch,
+                  std::map<std::string, std::vector<uint64_t>>& offsets) {
+  std::cout << "Epoch " << epoch << std::endl;
+  std::cout << "  " << std::left << std::setw(36) << "event" << std::right
+            << std::setw(7) << "nodes" << std::setw(12) << "first ms"
+            << std::setw(12) << "median ms" << std::setw(12) << "last ms"
+            << std::endl;
+
+  // Ordered by when the event was first seen
+  std::vector<std::pair<std::string, std::vector<uint64_t>*>> rows;
+  for (auto& it : offsets) {
+    std::sort(it.second.begin(), it.second.end());
+    rows.emplace_back(it.first, &it.second);
+  }
+  std::sort(rows.begin(), rows.end(),
+            [](const std::pair<std::string, std::vector<uint64_t>*>& a,
+               const std::pair<std::string, std::vector<uint64_t>*>& b) {
+              return a.second->front() < b.second->front();
+            });
+
+  std::cout << std::fixed << std::setprecision(1);
+  for (const auto& row : rows) {
+    const std::vector<uint64_t>& values = *row.second;
+    std::cout << "  " << std::left << std::setw(36) << row.first
+              << std::right << std::setw(7) << values.size() << std::setw(12)
+              << toMilliseconds(values.front()) << std::setw(12)
+              << toMilliseconds(values.at(values.size() / 2))
+              << std::setw(12) << toMilliseconds(values.back()) << std::endl;
+  }
+}
+
+int main(int argc, char** argv) {
+  if (argc < 3) {
+    std::cout << "[USAGE] " << argv[0]
+              << " <output csv filename> <timeline json> [timeline json...]"
+              << std::endl;
+    return -1;
+  }
+
+  std::vector<MergedEvent> events;
+  for (int i = 2; i < argc; i++) {
+    if (!readTimeline(argv[i], events)) {
+      return -1;
+    }
+  }
+  if (events.empty()) {
+    std::cout << "No events in the timelines" << std::endl;
+    return 0;
+  }
+
+  std::sort(events.begin(), events.end(),
+            [](const MergedEvent& a, const MergedEvent& b) {
+              return (a.epoch != b.epoch) ? (a.epoch < b.epoch)
+                                          : (a.wall < b.wall);
+            });
+
+  std::ofstream out(argv[1]);
+  out << "Epoch,OffsetMs,Peer,Role,Event" << std::endl;
+  out << std::fixed << std::setprecision(3);
+
+  // Offset of each event from the start of its epoch, per event name
+  std::map<std::string, std::vector<uint64_t>> offsets;
+  uint64_t epoch = events.front().epoch;
+  uint64_t epochStart = events.front().wall;
+  for (const auto& event : events) {
+    if (event.epoch != epoch) {
+      printSummary(epoch, offsets);
+      offsets.clear();
+      epoch = event.epoch;
+      epochStart = event.wall;
+    }
+
+    const uint64_t offset = event.wall - epochStart;
+    offsets[event.event].push_back(offset);
+    out << event.epoch << "," << toMilliseconds(offset) << "," << event.peer
+        << "," << event.role << "," << event.event << std::endl;
+  }
+  printSummary(epoch, offsets);
+  out.close();
+
+  return 0;
+}
@@ -0,0 +1,50 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "CommitLatencyTracker.h"
+
+using namespace std;
+
+CommitLatencyTracker& CommitLatencyTracker::GetInstance() {
+  static CommitLatencyTracker tracker;
+  return tracker;
+}
+
+void CommitLatencyTracker::Record(const PubKey& pubkey, double latencyInMs) {
+  lock_guard<mutex> g(m_mutex);
+
+  auto it = m_latencies.find(pubkey);
+  if (it == m_latencies.end()) {
+    m_latencies.emplace(pubkey, latencyInMs);
+  } else {
+    it->second = SMOOTHING * latencyInMs + (1 - SMOOTHING) * it->second;
+  }
+}
+
+bool CommitLatencyTracker::Get(const PubKey& pubkey,
+                               double& latencyInMs) const {
+  lock_guard<mutex> g(m_mutex);
+
+  auto it = m_latencies.find(pubkey);
+  if (it == m_latencies.end()) {
+    return false;
+  }
+
+  latencyInMs = it->second;
+  return true;
+}
@@ -0,0 +1,55 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef __COMMITLATENCYTRACKER_H__
+#define __COMMITLATENCYTRACKER_H__
+
+#include <mutex>
+#include <unordered_map>
+
+#include "libCrypto/Schnorr.h"
+
+/// How long each backup takes to send its commit, kept across consensus
+/// rounds.
+///
+/// The leader records the time from the start of a round to the arrival of
+/// each commit. Values are smoothed over rounds, so that one slow round does
+/// not push a usually fast backup out of the first consensus subset.
+class CommitLatencyTracker {
+  static constexpr double SMOOTHING = 0.3;  // Weight of the newest sample
+
+  mutable std::mutex m_mutex;
+  std::unordered_map<PubKey, double> m_latencies;
+
+  CommitLatencyTracker() = default;
+
+  CommitLatencyTracker(CommitLatencyTracker const&) = delete;
+  void operator=(CommitLatencyTracker const&) = delete;
+
+ public:
+  /// Returns the singleton instance.
+  static CommitLatencyTracker& GetInstance();
+
+  /// Adds a commit arrival latency sample for the backup.
+  void Record(const PubKey& pubkey, double latencyInMs);
+
+  /// Returns the smoothed latency of the backup, or false if it has none.
+  bool Get(const PubKey& pubkey, double& latencyInMs) const;
+};
+
+#endif  // __COMMITLATENCYTRACKER_H__
@@ -15,14 +15,19 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
+#include <tuple>
+
 #include "ConsensusBackup.h"
 #include "common/Constants.h"
 #include "common/Messages.h"
+#include "libCrypto/CommitPool.h"
 #include "libMessage/Messenger.h"
 #include "libNetwork/P2PComm.h"
 #include "libUtils/BitVector.h"
 #include "libUtils/DataConversion.h"
 #include "libUtils/Logger.h"
+#include "libUtils/TimeUtils.h"
 
 using namespace std;
 
@@ -129,11 +134,11 @@ bool ConsensusBackup::ProcessMessageAnnounce(const bytes& announcement,
     // Update internal state
     // =====================
     m_state = COMMIT_DONE;
+    m_phaseStartTime = r_timer_start();
 
-    // Unicast to the leader
-    // =====================
-    P2PComm::GetInstance().SendMessage(GetCommitteeMember(m_leaderID).second,
-                                       commit);
+    // Unicast to the leader, or the aggregator
+    // ========================================
+    SendCommit(commit, false);
   }
   return result;
 }
@@ -151,6 +156,9 @@ bool ConsensusBackup::ProcessMessageConsensusFailure(const bytes& announcement,
 
   m_state = INITIAL;
 
+  lock_guard<mutex> g(m_mutexGroup);
+  ResetGroupRounds();
+
   return true;
 }
 
@@ -176,8 +184,7 @@ bool ConsensusBackup::GenerateCommitMessage(bytes& commit,
 
   // Generate new commit
   // ===================
-  m_commitSecret.reset(new CommitSecret());
-  m_commitPoint.reset(new CommitPoint(*m_commitSecret));
+  tie(m_commitSecret, m_commitPoint) = CommitPool::GetInstance().Take();
 
   // Assemble commit message body
   // ============================
@@ -252,24 +259,29 @@ bool ConsensusBackup::ProcessMessageChallengeCore(
     return false;
   }
 
+  m_subsetID = subsetID;
+  RecordPhase((action == PROCESS_CHALLENGE) ? PHASE_BACKUP_CHALLENGE_WAIT
+                                            : PHASE_BACKUP_FINALCHALLENGE_WAIT,
+              m_subsetID);
+
   // Generate response
   // =================
 
   bytes response = {m_classByte, m_insByte,
                     static_cast<uint8_t>(returnmsgtype)};
+  Response r;
   bool result = GenerateResponseMessage(
-      response, MessageOffset::BODY + sizeof(uint8_t), subsetID);
+      response, MessageOffset::BODY + sizeof(uint8_t), subsetID, r);
   if (result) {
     // Update internal state
     // =====================
 
     m_state = nextstate;
 
-    // Unicast to the leader
-    // =====================
+    // Unicast to the leader, or the aggregator
+    // ========================================
 
-    P2PComm::GetInstance().SendMessage(GetCommitteeMember(m_leaderID).second,
-                                       response);
+    SendResponse(response, r, action == PROCESS_FINALCHALLENGE, subsetID);
   }
 
   return result;
@@ -284,13 +296,13 @@ bool ConsensusBackup::ProcessMessageChallenge(const bytes& challenge,
 
 bool ConsensusBackup::GenerateResponseMessage(bytes& response,
                                               unsigned int offset,
-                                              uint16_t subsetID) {
+                                              uint16_t subsetID, Response& r) {
   LOG_MARKER();
 
   // Assemble response message body
   // ==============================
 
-  Response r(*m_commitSecret, m_challenge, m_myPrivKey);
+  r = Response(*m_commitSecret, m_challenge, m_myPrivKey);
 
   if (!Messenger::SetConsensusResponse(
           response, offset, m_consensusID, m_blockNumber, subsetID, m_blockHash,
@@ -342,6 +354,11 @@ bool ConsensusBackup::ProcessMessageCollectiveSigCore(
     return false;
   }
 
+  RecordPhase((action == PROCESS_COLLECTIVESIG)
+                  ? PHASE_BACKUP_COLLECTIVESIG_WAIT
+                  : PHASE_BACKUP_FINALCOLLECTIVESIG_WAIT,
+              m_subsetID);
+
   // Generate final commit
   // =====================
 
@@ -369,10 +386,9 @@ bool ConsensusBackup::ProcessMessageCollectiveSigCore(
       m_CS1 = m_collectiveSig;
       m_B1 = m_responseMap;
 
-      // Unicast to the leader
-      // =====================
-      P2PComm::GetInstance().SendMessage(GetCommitteeMember(m_leaderID).second,
-                                         finalcommit);
+      // Unicast to the leader, or the aggregator
+      // ========================================
+      SendCommit(finalcommit, true);
     }
   } else {
     // Save the collective sig over the second round
@@ -410,6 +426,377 @@ bool ConsensusBackup::ProcessMessageFinalCollectiveSig(
                                          PROCESS_FINALCOLLECTIVESIG, DONE);
 }
 
+void ConsensusBackup::ResetGroupRounds() {
+  for (unsigned int round = 0; round < 2; round++) {
+    if (m_groupTimerArmed[round]) {
+      AsyncExecutor::GetInstance().Cancel(m_groupTimer[round]);
+      m_groupTimerArmed[round] = false;
+    }
+    GroupRound& groupRound = m_groupRounds[round];
+    groupRound.commitMap.Reset(m_committee.size());
+    groupRound.commitPointMap.assign(m_committee.size(), CommitPoint());
+    groupRound.forwarded = false;
+    groupRound.subsets.clear();
+    m_coveredByGroup[round] = false;
+    m_pendingCommit[round].clear();
+  }
+}
+
+void ConsensusBackup::SendCommit(const bytes& commit, bool final) {
+  if (!m_inGroup) {
+    P2PComm::GetInstance().SendMessage(GetCommitteeMember(m_leaderID).second,
+                                       commit);
+    return;
+  }
+
+  const unsigned int round = final ? 1 : 0;
+  lock_guard<mutex> g(m_mutexGroup);
+
+  if (m_myID == m_aggregatorID) {
+    AddGroupCommit(round, m_myID, *m_commitPoint);
+    if (!m_groupRounds[round].forwarded) {
+      m_groupTimer[round] = AsyncExecutor::GetInstance().PostAfter(
+          chrono::milliseconds(CONSENSUS_AGGREGATION_TIMEOUT_IN_MS),
+          [this, round]() {
+            lock_guard<mutex> g(m_mutexGroup);
+            m_groupTimerArmed[round] = false;
+            ForwardGroupCommits(round);
+          },
+          "consensus_aggregation");
+      m_groupTimerArmed[round] = true;
+    }
+    return;
+  }
+
+  P2PComm::GetInstance().SendMessage(GetCommitteeMember(m_aggregatorID).second,
+                                     commit);
+
+  // Keep the commit, for the leader in case the aggregator leaves it out
+  m_pendingCommit[round] = commit;
+  m_groupTimer[round] = AsyncExecutor::GetInstance().PostAfter(
+      chrono::milliseconds(2 * CONSENSUS_AGGREGATION_TIMEOUT_IN_MS),
+      [this, round]() {
+        lock_guard<mutex> g(m_mutexGroup);
+        m_groupTimerArmed[round] = false;
+        FallBackToLeader(round);
+      },
+      "consensus_aggregation");
+  m_groupTimerArmed[round] = true;
+}
+
+void ConsensusBackup::FallBackToLeader(unsigned int round) {
+  if (m_coveredByGroup[round] || m_pendingCommit[round].empty()) {
+    return;
+  }
+
+  LOG_GENERAL(INFO, "[Aggregator " << m_aggregatorID
+                                   << "] Commit not covered by the group, "
+                                      "sending it to the leader");
+  P2PComm::GetInstance().SendMessage(GetCommitteeMember(m_leaderID).second,
+                                     m_pendingCommit[round]);
+  m_pendingCommit[round].clear();
+}
+
+void ConsensusBackup::AddGroupCommit(unsigned int round, uint16_t backupID,
+                                     const CommitPoint& commitPoint) {
+  GroupRound& groupRound = m_groupRounds[round];
+  groupRound.commitMap.Set(backupID);
+  groupRound.commitPointMap.at(backupID) = commitPoint;
+
+  if (groupRound.commitMap == m_groupMembers) {
+    ForwardGroupCommits(round);
+  }
+}
+
+void ConsensusBackup::ForwardGroupCommits(unsigned int round) {
+  LOG_MARKER();
+
+  GroupRound& groupRound = m_groupRounds[round];
+
+  // Wait for my own commit, which is only there if I accept the announcement
+  if (groupRound.forwarded || !groupRound.commitMap.Test(m_myID)) {
+    return;
+  }
+  if (m_groupTimerArmed[round]) {
+    AsyncExecutor::GetInstance().Cancel(m_groupTimer[round]);
+    m_groupTimerArmed[round] = false;
+  }
+  groupRound.forwarded = true;
+
+  vector<CommitPoint> commitPoints;
+  commitPoints.reserve(groupRound.commitMap.Count());
+  groupRound.commitMap.ForEachSet([&groupRound, &commitPoints](size_t index) {
+    commitPoints.emplace_back(groupRound.commitPointMap.at(index));
+  });
+
+  CommitPoint aggregatedCommit = AggregateCommits(commitPoints);
+  if (!aggregatedCommit.Initialized()) {
+    LOG_GENERAL(WARNING, "AggregateCommits failed");
+    return;
+  }
+
+  bytes aggregated = {m_classByte, m_insByte,
+                      static_cast<uint8_t>(
+                          (round == 0)
+                              ? ConsensusMessageType::AGGREGATEDCOMMIT
+                              : ConsensusMessageType::AGGREGATEDFINALCOMMIT)};
+  if (!Messenger::SetConsensusAggregatedCommit(
+          aggregated, MessageOffset::BODY + sizeof(uint8_t), m_consensusID,
+          m_blockNumber, m_blockHash, m_myID, groupRound.commitMap.ToVector(),
+          aggregatedCommit,
+          make_pair(m_myPrivKey, GetCommitteeMember(m_myID).first))) {
+    LOG_GENERAL(WARNING, "Messenger::SetConsensusAggregatedCommit failed.");
+    return;
+  }
+
+  LOG_GENERAL(INFO, "[Aggregator " << m_myID << "] Forwarding "
+                                   << commitPoints.size() << " of "
+                                   << m_groupMembers.Count() << " commits");
+  m_coveredByGroup[round] = true;
+
+  // To the leader, and to the group so that those left out fall back
+  vector<Peer> group;
+  groupRound.commitMap.ForEachSet([this, &group](size_t index) {
+    if (index != m_myID) {
+      group.emplace_back(m_committee.at(index).second);
+    }
+  });
+  P2PComm::GetInstance().SendMessage(GetCommitteeMember(m_leaderID).second,
+                                     aggregated);
+  P2PComm::GetInstance().SendMessage(group, aggregated);
+}
+
+ConsensusBackup::GroupResponses& ConsensusBackup::GetGroupResponses(
+    unsigned int round, uint16_t subsetID) {
+  GroupResponses& responses = m_groupRounds[round].subsets[subsetID];
+  if (responses.responseMap.size() == 0) {
+    responses.responseMap.Reset(m_committee.size());
+    responses.responseDataMap.resize(m_committee.size());
+    responses.forwarded = false;
+  }
+  return responses;
+}
+
+void ConsensusBackup::SendResponse(const bytes& response, const Response& r,
+                                   bool final, uint16_t subsetID) {
+  const unsigned int round = final ? 1 : 0;
+  unique_lock<mutex> g(m_mutexGroup);
+
+  // Only a backup whose commit went through the aggregator responds through
+  // it, as the leader only has the commit of the whole group
+  if (!m_inGroup || !m_coveredByGroup[round]) {
+    g.unlock();
+    P2PComm::GetInstance().SendMessage(GetCommitteeMember(m_leaderID).second,
+                                       response);
+    return;
+  }
+
+  if (m_myID != m_aggregatorID) {
+    g.unlock();
+    P2PComm::GetInstance().SendMessage(
+        GetCommitteeMember(m_aggregatorID).second, response);
+    return;
+  }
+
+  GroupResponses& responses = GetGroupResponses(round, subsetID);
+  responses.challenge = m_challenge;
+  responses.responseMap.Set(m_myID);
+  responses.responseDataMap.at(m_myID) = r;
+  ForwardGroupResponses(round, subsetID);
+}
+
+void ConsensusBackup::ForwardGroupResponses(unsigned int round,
+                                            uint16_t subsetID) {
+  GroupRound& groupRound = m_groupRounds[round];
+  GroupResponses& responses = groupRound.subsets.at(subsetID);
+
+  // The challenge commits to every backup in the group's commit, so all of
+  // them have to respond
+  if (responses.forwarded || !responses.challenge.Initialized() ||
+      (responses.responseMap != groupRound.commitMap)) {
+    return;
+  }
+  responses.forwarded = true;
+
+  bool valid = true;
+  vector<Response> responseData;
+  responseData.reserve(groupRound.commitMap.Count());
+  groupRound.commitMap.ForEachSet([this, &groupRound, &responses, &valid,
+                                   &responseData](size_t index) {
+    const Response& r = responses.responseDataMap.at(index);
+    if ((index != m_myID) &&
+        !MultiSig::VerifyResponse(r, responses.challenge,
+                                  m_committee.at(index).first,
+                                  groupRound.commitPointMap.at(index))) {
+      LOG_GENERAL(WARNING, "[Backup " << index
+                                      << "] Invalid response for this backup");
+      valid = false;
+    }
+    responseData.emplace_back(r);
+  });
+  if (!valid) {
+    return;
+  }
+
+  Response aggregatedResponse = AggregateResponses(responseData);
+  if (!aggregatedResponse.Initialized()) {
+    LOG_GENERAL(WARNING, "AggregateResponses failed");
+    return;
+  }
+
+  bytes aggregated = {m_classByte, m_insByte,
+                      static_cast<uint8_t>(
+                          (round == 0)
+                              ? ConsensusMessageType::AGGREGATEDRESPONSE
+                              : ConsensusMessageType::AGGREGATEDFINALRESPONSE)};
+  if (!Messenger::SetConsensusAggregatedResponse(
+          aggregated, MessageOffset::BODY + sizeof(uint8_t), m_consensusID,
+          m_blockNumber, subsetID, m_blockHash, m_myID,
+          groupRound.commitMap.ToVector(), aggregatedResponse,
+          make_pair(m_myPrivKey, GetCommitteeMember(m_myID).first))) {
+    LOG_GENERAL(WARNING, "Messenger::SetConsensusAggregatedResponse failed.");
+    return;
+  }
+
+  P2PComm::GetInstance().SendMessage(GetCommitteeMember(m_leaderID).second,
+                                     aggregated);
+}
+
+bool ConsensusBackup::ProcessMessageGroupCommit(const bytes& commit,
+                                                unsigned int offset,
+                                                bool final) {
+  LOG_MARKER();
+
+  if (!m_inGroup || (m_myID != m_aggregatorID)) {
+    LOG_GENERAL(WARNING, "Commit received but I am not an aggregator");
+    return false;
+  }
+
+  uint16_t backupID = 0;
+  CommitPoint commitPoint;
+  if (!CheckCommitMessage(commit, offset, backupID, commitPoint)) {
+    return false;
+  }
+
+  if ((backupID == m_myID) || !m_groupMembers.Test(backupID)) {
+    LOG_GENERAL(WARNING,
+                "[Backup " << backupID << "] Backup is not in my group");
+    return false;
+  }
+
+  const unsigned int round = final ? 1 : 0;
+  lock_guard<mutex> g(m_mutexGroup);
+
+  // A late backup is told it was left out, and sends to the leader itself
+  if (m_groupRounds[round].forwarded) {
+    LOG_GENERAL(WARNING, "[Backup " << backupID
+                                    << "] Commit arrived after the group's "
+                                       "commits were forwarded");
+    return false;
+  }
+
+  if (m_groupRounds[round].commitMap.Test(backupID)) {
+    LOG_GENERAL(WARNING, "Backup has already sent validated commit");
+    return false;
+  }
+
+  AddGroupCommit(round, backupID, commitPoint);
+  return true;
+}
+
+bool ConsensusBackup::ProcessMessageGroupResponse(const bytes& response,
+                                                  unsigned int offset,
+                                                  bool final) {
+  LOG_MARKER();
+
+  if (!m_inGroup || (m_myID != m_aggregatorID)) {
+    LOG_GENERAL(WARNING, "Response received but I am not an aggregator");
+    return false;
+  }
+
+  uint16_t backupID = 0;
+  uint16_t subsetID = 0;
+  Response r;
+  if (!Messenger::GetConsensusResponse(response, offset, m_consensusID,
+                                       m_blockNumber, m_blockHash, backupID,
+                                       subsetID, r, m_committee)) {
+    LOG_GENERAL(WARNING, "Messenger::GetConsensusResponse failed.");
+    return false;
+  }
+
+  if (subsetID >= max(NUM_CONSENSUS_SUBSETS, 1u)) {
+    LOG_GENERAL(WARNING, "Error: Subset ID ("
+                             << subsetID << ") >= NUM_CONSENSUS_SUBSETS: "
+                             << NUM_CONSENSUS_SUBSETS);
+    return false;
+  }
+
+  const unsigned int round = final ? 1 : 0;
+  lock_guard<mutex> g(m_mutexGroup);
+
+  const GroupRound& groupRound = m_groupRounds[round];
+  if ((backupID == m_myID) || !groupRound.forwarded ||
+      !groupRound.commitMap.Test(backupID)) {
+    LOG_GENERAL(WARNING, "[Backup " << backupID
+                                    << "] Backup is not in the group's "
+                                       "commit");
+    return false;
+  }
+
+  GroupResponses& responses = GetGroupResponses(round, subsetID);
+  if (responses.forwarded || responses.responseMap.Test(backupID)) {
+    LOG_GENERAL(WARNING, "[Subset " << subsetID << "] [Backup " << backupID
+                                    << "] Backup has already sent response");
+    return false;
+  }
+
+  // Checked once all are in, as the challenge may not be here yet
+  responses.responseMap.Set(backupID);
+  responses.responseDataMap.at(backupID) = r;
+  ForwardGroupResponses(round, subsetID);
+  return true;
+}
+
+bool ConsensusBackup::ProcessMessageAggregatedCommit(const bytes& commit,
+                                                     unsigned int offset,
+                                                     bool final) {
+  LOG_MARKER();
+
+  uint16_t aggregatorID = 0;
+  vector<bool> bitmap;
+  CommitPoint aggregatedCommit;
+  if (!Messenger::GetConsensusAggregatedCommit(
+          commit, offset, m_consensusID, m_blockNumber, m_blockHash,
+          aggregatorID, bitmap, aggregatedCommit, m_committee)) {
+    LOG_GENERAL(WARNING, "Messenger::GetConsensusAggregatedCommit failed.");
+    return false;
+  }
+
+  if (!m_inGroup || (aggregatorID != m_aggregatorID) ||
+      (m_myID == m_aggregatorID)) {
+    LOG_GENERAL(WARNING, "[Backup " << aggregatorID
+                                    << "] Backup is not my aggregator");
+    return false;
+  }
+
+  const unsigned int round = final ? 1 : 0;
+  lock_guard<mutex> g(m_mutexGroup);
+
+  if (m_groupTimerArmed[round]) {
+    AsyncExecutor::GetInstance().Cancel(m_groupTimer[round]);
+    m_groupTimerArmed[round] = false;
+  }
+
+  if ((m_myID < bitmap.size()) && bitmap.at(m_myID)) {
+    m_coveredByGroup[round] = true;
+    m_pendingCommit[round].clear();
+  } else {
+    FallBackToLeader(round);
+  }
+
+  return true;
+}
+
 ConsensusBackup::ConsensusBackup(uint32_t consensus_id, uint64_t block_number,
                                  const bytes& block_hash, uint16_t node_id,
                                  uint16_t leader_id, const PrivKey& privkey,
@@ -419,12 +806,28 @@ ConsensusBackup::ConsensusBackup(uint32_t consensus_id, uint64_t block_number,
     : ConsensusCommon(consensus_id, block_number, block_hash, node_id, privkey,
                       committee, class_byte, ins_byte),
       m_leaderID(leader_id),
-      m_msgContentValidator(msg_validator) {
+      m_subsetID(0),
+      m_msgContentValidator(msg_validator),
+      m_aggregatorID(0) {
   LOG_MARKER();
   m_state = INITIAL;
+  m_inGroup =
+      GetAggregationGroup(m_myID, m_leaderID, m_aggregatorID, m_groupMembers);
+  for (unsigned int round = 0; round < 2; round++) {
+    m_groupTimerArmed[round] = false;
+    m_groupTimer[round] = 0;
+  }
+  ResetGroupRounds();
 }
 
-ConsensusBackup::~ConsensusBackup() {}
+ConsensusBackup::~ConsensusBackup() {
+  lock_guard<mutex> g(m_mutexGroup);
+  for (unsigned int round = 0; round < 2; round++) {
+    if (m_groupTimerArmed[round]) {
+      AsyncExecutor::GetInstance().Cancel(m_groupTimer[round]);
+    }
+  }
+}
 
 bool ConsensusBackup::ProcessMessage(const bytes& message, unsigned int offset,
                                      [[gnu::unused]] const Peer& from) {
@@ -454,6 +857,24 @@ bool ConsensusBackup::ProcessMessage(const bytes& message, unsigned int offset,
     case ConsensusMessageType::FINALCOLLECTIVESIG:
       result = ProcessMessageFinalCollectiveSig(message, offset + 1);
       break;
+    case ConsensusMessageType::COMMIT:
+      result = ProcessMessageGroupCommit(message, offset + 1, false);
+      break;
+    case ConsensusMessageType::FINALCOMMIT:
+      result = ProcessMessageGroupCommit(message, offset + 1, true);
+      break;
+    case ConsensusMessageType::RESPONSE:
+      result = ProcessMessageGroupResponse(message, offset + 1, false);
+      break;
+    case ConsensusMessageType::FINALRESPONSE:
+      result = ProcessMessageGroupResponse(message, offset + 1, true);
+      break;
+    case ConsensusMessageType::AGGREGATEDCOMMIT:
+      result = ProcessMessageAggregatedCommit(message, offset + 1, false);
+      break;
+    case ConsensusMessageType::AGGREGATEDFINALCOMMIT:
+      result = ProcessMessageAggregatedCommit(message, offset + 1, true);
+      break;
     default:
       LOG_GENERAL(WARNING, "Unknown consensus message received");
   }
@@ -28,6 +28,8 @@
 #include "ConsensusCommon.h"
 #include "libCrypto/MultiSig.h"
 #include "libNetwork/PeerStore.h"
+#include "libUtils/AsyncExecutor.h"
+#include "libUtils/BitSet.h"
 #include "libUtils/TimeLockedFunction.h"
 
 typedef std::function<bool(const bytes& input, unsigned int offset,
@@ -54,12 +56,63 @@ class ConsensusBackup : public ConsensusCommon {
   // Received challenge
   Challenge m_challenge;
 
+  // Subset of the received challenge
+  uint16_t m_subsetID;
+
   // Function handler for validating message content
   MsgContentValidatorFunc m_msgContentValidator;
 
+  // Aggregation group, if commits and responses go through an aggregator
+  bool m_inGroup;
+  uint16_t m_aggregatorID;
+  BitSet m_groupMembers;
+
+  // Responses of the group to the challenge of one subset, at the aggregator
+  struct GroupResponses {
+    Challenge challenge;
+    BitSet responseMap;
+    std::vector<Response> responseDataMap;
+    bool forwarded;
+  };
+
+  // Commits of the group in one round, at the aggregator
+  struct GroupRound {
+    BitSet commitMap;
+    std::vector<CommitPoint> commitPointMap;
+    bool forwarded;
+    std::map<uint16_t, GroupResponses> subsets;
+  };
+
+  // Group state of the first and the final round. At the aggregator the timer
+  // forwards the commits it has; at the others it sends their commit to the
+  // leader unless the aggregator has reported it covered by then.
+  std::mutex m_mutexGroup;
+  GroupRound m_groupRounds[2];
+  bool m_coveredByGroup[2];
+  bytes m_pendingCommit[2];
+  bool m_groupTimerArmed[2];
+  AsyncExecutor::TaskId m_groupTimer[2];
+
   // Internal functions
   bool CheckState(Action action);
 
+  void ResetGroupRounds();
+  void SendCommit(const bytes& commit, bool final);
+  void SendResponse(const bytes& response, const Response& r, bool final,
+                    uint16_t subsetID);
+  void AddGroupCommit(unsigned int round, uint16_t backupID,
+                      const CommitPoint& commitPoint);
+  void ForwardGroupCommits(unsigned int round);
+  void ForwardGroupResponses(unsigned int round, uint16_t subsetID);
+  void FallBackToLeader(unsigned int round);
+  GroupResponses& GetGroupResponses(unsigned int round, uint16_t subsetID);
+  bool ProcessMessageGroupCommit(const bytes& commit, unsigned int offset,
+                                 bool final);
+  bool ProcessMessageGroupResponse(const bytes& response, unsigned int offset,
+                                   bool final);
+  bool ProcessMessageAggregatedCommit(const bytes& commit, unsigned int offset,
+                                      bool final);
+
   bool ProcessMessageAnnounce(const bytes& announcement, unsigned int offset);
   bool GenerateCommitFailureMessage(bytes& commitFailure, unsigned int offset,
                                     const bytes& errorMsg);
@@ -72,7 +125,7 @@ class ConsensusBackup : public ConsensusCommon {
                                    State nextstate);
   bool ProcessMessageChallenge(const bytes& challenge, unsigned int offset);
   bool GenerateResponseMessage(bytes& response, unsigned int offset,
-                               uint16_t subsetID);
+                               uint16_t subsetID, Response& r);
   bool ProcessMessageCollectiveSigCore(const bytes& collectivesig,
                                        unsigned int offset, Action action,
                                        State nextstate);
@@ -27,6 +27,7 @@
 #include "libUtils/BitVector.h"
 #include "libUtils/DataConversion.h"
 #include "libUtils/Logger.h"
+#include "libUtils/TimeUtils.h"
 
 #define MAKE_LITERAL_PAIR(s) \
   { s, #s }
@@ -80,7 +81,8 @@ ConsensusCommon::ConsensusCommon(uint32_t consensus_id, uint64_t block_number,
       m_committee(committee),
       m_classByte(class_byte),
       m_insByte(ins_byte),
-      m_responseMap(committee.size(), false) {}
+      m_responseMap(committee.size(), false),
+      m_phaseStartTime(r_timer_start()) {}
 
 ConsensusCommon::~ConsensusCommon() {}
 
@@ -137,6 +139,22 @@ PubKey ConsensusCommon::AggregateKeys(const vector<bool>& peer_map) {
   return *result;
 }
 
+PubKey ConsensusCommon::AggregateKeys(const BitSet& peer_map) {
+  LOG_MARKER();
+
+  vector<PubKey> keys;
+  keys.reserve(peer_map.Count());
+  peer_map.ForEachSet([this, &keys](size_t index) {
+    keys.emplace_back(m_committee.at(index).first);
+  });
+  shared_ptr<PubKey> result = MultiSig::AggregatePubKeys(keys);
+  if (result == nullptr) {
+    return PubKey();
+  }
+
+  return *result;
+}
+
 CommitPoint ConsensusCommon::AggregateCommits(
     const vector<CommitPoint>& commits) {
   LOG_MARKER();
@@ -195,6 +213,81 @@ pair<PubKey, Peer> ConsensusCommon::GetCommitteeMember(
   return m_committee.at(index);
 }
 
+bool ConsensusCommon::CheckCommitMessage(const bytes& commit,
+                                         unsigned int offset,
+                                         uint16_t& backupID,
+                                         CommitPoint& commitPoint) {
+  // Extract and check commit message body
+  // =====================================
+
+  CommitPointHash commitPointHash;
+
+  if (!Messenger::GetConsensusCommit(commit, offset, m_consensusID,
+                                     m_blockNumber, m_blockHash, backupID,
+                                     commitPoint, commitPointHash,
+                                     m_committee)) {
+    LOG_GENERAL(WARNING, "Messenger::GetConsensusCommit failed.");
+    return false;
+  }
+
+  // Check the commit
+  if (!commitPoint.Initialized()) {
+    LOG_GENERAL(WARNING, "Invalid commit received");
+    return false;
+  }
+
+  // Check the deserialized commit hash
+  if (!commitPointHash.Initialized()) {
+    LOG_GENERAL(WARNING, "Invalid commit hash received");
+    return false;
+  }
+
+  // Check the value of the commit hash
+  CommitPointHash commitPointHashExpected(commitPoint);
+  if (!(commitPointHashExpected == commitPointHash)) {
+    LOG_GENERAL(WARNING, "Commit hash check failed. Deserialized = "
+                             << string(commitPointHash) << " Expected = "
+                             << string(commitPointHashExpected));
+    return false;
+  }
+
+  return true;
+}
+
+bool ConsensusCommon::GetAggregationGroup(uint16_t memberID, uint16_t leaderID,
+                                          uint16_t& aggregatorID,
+                                          BitSet& members) const {
+  const unsigned int groupSize = CONSENSUS_AGGREGATION_GROUP_SIZE;
+  if ((groupSize < 2) || (memberID >= m_committee.size()) ||
+      (memberID == leaderID)) {
+    return false;
+  }
+
+  const unsigned int first = memberID - memberID % groupSize;
+  const unsigned int last =
+      min(first + groupSize, static_cast<unsigned int>(m_committee.size()));
+
+  members.Reset(m_committee.size());
+  for (unsigned int i = first; i < last; i++) {
+    if (i != leaderID) {
+      members.Set(i);
+    }
+  }
+  if (members.Count() < 2) {
+    return false;
+  }
+
+  aggregatorID = (first == leaderID) ? first + 1 : first;
+  return true;
+}
+
+void ConsensusCommon::RecordPhase(ConsensusPhase phase, uint16_t subsetID) {
+  ConsensusTrace::GetInstance().Record(
+      m_consensusID, ConsensusTrace::GetBlockType(m_classByte, m_insByte),
+      subsetID, phase, static_cast<uint64_t>(r_timer_end(m_phaseStartTime)));
+  m_phaseStartTime = r_timer_start();
+}
+
 ConsensusCommon::State ConsensusCommon::GetState() const { return m_state; }
 
 bool ConsensusCommon::GetConsensusID(const bytes& message,
@@ -234,6 +327,16 @@ bool ConsensusCommon::GetConsensusID(const bytes& message,
         return Messenger::GetLeaderConsensusID<
             ZilliqaMessage::ConsensusCollectiveSig>(
             message, offset + 1, m_committee, from, consensusID, senderPubKey);
+      case ConsensusMessageType::AGGREGATEDCOMMIT:
+      case ConsensusMessageType::AGGREGATEDFINALCOMMIT:
+        return Messenger::GetBackupConsensusID<
+            ZilliqaMessage::ConsensusAggregatedCommit>(
+            message, offset + 1, m_committee, from, consensusID, senderPubKey);
+      case ConsensusMessageType::AGGREGATEDRESPONSE:
+      case ConsensusMessageType::AGGREGATEDFINALRESPONSE:
+        return Messenger::GetBackupConsensusID<
+            ZilliqaMessage::ConsensusAggregatedResponse>(
+            message, offset + 1, m_committee, from, consensusID, senderPubKey);
       default:
         LOG_GENERAL(WARNING, "Unknown consensus message received");
         break;
@@ -18,6 +18,7 @@
 #ifndef __CONSENSUSCOMMON_H__
 #define __CONSENSUSCOMMON_H__
 
+#include <chrono>
 #include <deque>
 #include <functional>
 #include <memory>
@@ -25,9 +26,11 @@
 #include <string>
 #include <vector>
 
+#include "ConsensusTrace.h"
 #include "libCrypto/MultiSig.h"
 #include "libNetwork/PeerStore.h"
 #include "libNetwork/ShardStruct.h"
+#include "libUtils/BitSet.h"
 #include "libUtils/TimeLockedFunction.h"
 
 /// Implements base functionality shared between all consensus committee members
@@ -95,6 +98,10 @@ class ConsensusCommon {
     FINALCOLLECTIVESIG = 0x08,
     COMMITFAILURE = 0x09,
     CONSENSUSFAILURE = 0x10,
+    AGGREGATEDCOMMIT = 0x11,
+    AGGREGATEDRESPONSE = 0x12,
+    AGGREGATEDFINALCOMMIT = 0x13,
+    AGGREGATEDFINALRESPONSE = 0x14,
   };
 
   /// State of the active consensus session.
@@ -154,6 +161,9 @@ class ConsensusCommon {
   /// Generated commit point
   std::shared_ptr<CommitPoint> m_commitPoint;
 
+  /// Start of the consensus phase currently being timed
+  std::chrono::system_clock::time_point m_phaseStartTime;
+
   /// Constructor.
   ConsensusCommon(uint32_t consensus_id, uint64_t block_number,
                   const bytes& block_hash, uint16_t my_id,
@@ -173,6 +183,7 @@ class ConsensusCommon {
 
   /// Aggregates public keys according to the response map.
   PubKey AggregateKeys(const std::vector<bool>& peer_map);
+  PubKey AggregateKeys(const BitSet& peer_map);
 
   /// Aggregates the list of received commits.
   CommitPoint AggregateCommits(const std::vector<CommitPoint>& commits);
@@ -190,6 +201,23 @@ class ConsensusCommon {
 
   std::pair<PubKey, Peer> GetCommitteeMember(const unsigned int index);
 
+  /// Checks a commit message from a backup: signature and commit hash.
+  bool CheckCommitMessage(const bytes& commit, unsigned int offset,
+                          uint16_t& backupID, CommitPoint& commitPoint);
+
+  /// Returns the group that backup memberID sends its commits and responses
+  /// through when CONSENSUS_AGGREGATION_GROUP_SIZE is set. Groups are runs of
+  /// that many committee indices, without the leader; the aggregator is the
+  /// lowest index in the group. Returns false if the backup sends to the
+  /// leader directly because aggregation is off or it has the group to
+  /// itself.
+  bool GetAggregationGroup(uint16_t memberID, uint16_t leaderID,
+                           uint16_t& aggregatorID, BitSet& members) const;
+
+  /// Adds the time since the start of the phase to the consensus trace, and
+  /// starts timing the next phase.
+  void RecordPhase(ConsensusPhase phase, uint16_t subsetID = 0);
+
  public:
   /// Consensus message processing function
   virtual bool ProcessMessage([[gnu::unused]] const bytes& message,
@@ -199,6 +227,12 @@ class ConsensusCommon {
                    // ConsensusBackup
   }
 
+  /// Checks the message ahead of ProcessMessage. Thread-safe, so callers can
+  /// run it for many messages in parallel before taking their consensus
+  /// lock; ProcessMessage then skips the checks already done.
+  virtual void PreProcessMessage([[gnu::unused]] const bytes& message,
+                                 [[gnu::unused]] unsigned int offset) {}
+
   /// The minimum fraction of peers necessary to achieve consensus.
   static constexpr double TOLERANCE_FRACTION = 0.667;
 
@@ -15,15 +15,23 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
+#include <tuple>
+
+#include "CommitLatencyTracker.h"
 #include "ConsensusLeader.h"
 #include "common/Constants.h"
 #include "common/Messages.h"
+#include "libCrypto/CommitPool.h"
 #include "libMessage/Messenger.h"
+#include "libNetwork/Guard.h"
 #include "libNetwork/P2PComm.h"
 #include "libUtils/BitVector.h"
 #include "libUtils/DataConversion.h"
 #include "libUtils/DetachedFunction.h"
 #include "libUtils/Logger.h"
+#include "libUtils/TimeUtils.h"
+#include "libUtils/Tracer.h"
 
 using namespace std;
 
@@ -102,22 +110,50 @@ void ConsensusLeader::SetStateSubset(uint16_t subsetID, State newState) {
 void ConsensusLeader::GenerateConsensusSubsets() {
   LOG_MARKER();
 
-  // Get the list of all the peers who committed, by peer index
+  // Get the list of all the peers who committed, by peer index. A group that
+  // committed through its aggregator is listed once, at the aggregator.
+  BitSet groupedMap(m_committee.size());
+  for (const auto& group : m_commitGroups) {
+    groupedMap |= group.second;
+  }
+  const unsigned int numPeersWhoCommitted = m_commitMap.Count() - 1;
   vector<unsigned int> peersWhoCommitted;
-  for (unsigned int index = 0; index < m_commitMap.size(); index++) {
-    if (m_commitMap.at(index) && index != m_myID) {
-      peersWhoCommitted.push_back(index);
+  peersWhoCommitted.reserve(numPeersWhoCommitted);
+  m_commitMap.ForEachSet(
+      [this, &groupedMap, &peersWhoCommitted](size_t index) {
+        if ((index != m_myID) && (!groupedMap.Test(index) ||
+                                  (m_commitGroups.count(index) > 0))) {
+          peersWhoCommitted.push_back(index);
+        }
+      });
+
+  // The first subset is taken from the front of the list, so put the guards
+  // there, followed by the backups that have been quickest to commit
+  vector<tuple<bool, double, unsigned int>> commitOrder;
+  for (const auto& index : peersWhoCommitted) {
+    const PubKey& pubKey = GetCommitteeMember(index).first;
+    const bool isGuard =
+        GUARD_MODE && (Guard::GetInstance().IsNodeInDSGuardList(pubKey) ||
+                       Guard::GetInstance().IsNodeInShardGuardList(pubKey));
+    double latency = 0;
+    if (!CommitLatencyTracker::GetInstance().Get(pubKey, latency)) {
+      latency = r_timer_end(m_roundStartTime) / 1000;
     }
+    commitOrder.emplace_back(!isGuard, latency, index);
+  }
+  sort(commitOrder.begin(), commitOrder.end());
+  for (unsigned int i = 0; i < commitOrder.size(); i++) {
+    peersWhoCommitted.at(i) = get<2>(commitOrder.at(i));
   }
+
   // Generate NUM_CONSENSUS_SUBSETS lists (= subsets of peersWhoCommitted)
   // If we have exactly the minimum num required for consensus, no point making
   // more than 1 subset
 
-  const unsigned int numSubsets = (peersWhoCommitted.size() < m_numForConsensus)
-                                      ? 1
-                                      : NUM_CONSENSUS_SUBSETS;
+  const unsigned int numSubsets =
+      (numPeersWhoCommitted < m_numForConsensus) ? 1 : NUM_CONSENSUS_SUBSETS;
   LOG_GENERAL(INFO, "PeerCommited:"
-                        << peersWhoCommitted.size() + 1 << " m_numForConsensus:"
+                        << numPeersWhoCommitted + 1 << " m_numForConsensus:"
                         << m_numForConsensus << " numSubsets:" << numSubsets);
 
   m_consensusSubsets.clear();
@@ -125,34 +161,53 @@ void ConsensusLeader::GenerateConsensusSubsets() {
 
   for (unsigned int i = 0; i < numSubsets; i++) {
     ConsensusSubset& subset = m_consensusSubsets.at(i);
-    subset.commitMap.resize(m_committee.size());
-    fill(subset.commitMap.begin(), subset.commitMap.end(), false);
+    subset.commitMap.Reset(m_committee.size());
     subset.commitPointMap.resize(m_committee.size());
     subset.commitPoints.clear();
+    subset.commitGroups.clear();
+    subset.groupedMap.Reset(m_committee.size());
     subset.responseCounter = 0;
     subset.responseDataMap.resize(m_committee.size());
-    subset.responseMap.resize(m_committee.size());
-    fill(subset.responseMap.begin(), subset.responseMap.end(), false);
+    subset.responseMap.Reset(m_committee.size());
     subset.responseData.clear();
 
     subset.state = m_state;
     // add myself to subset commit map always
     subset.commitPointMap.at(m_myID) = m_commitPointMap.at(m_myID);
     subset.commitPoints.emplace_back(m_commitPointMap.at(m_myID));
-    subset.commitMap.at(m_myID) = true;
-
-    for (unsigned int j = 0; j < m_numForConsensus - 1; j++) {
+    subset.commitMap.Set(m_myID);
+
+    // Take peers until the subset has m_numForConsensus backups, counting a
+    // group as all the backups it covers
+    unsigned int numPeers = 0;
+    unsigned int j = 0;
+    for (; (j < peersWhoCommitted.size()) && (numPeers < m_numForConsensus - 1);
+         j++) {
       unsigned int index = peersWhoCommitted.at(j);
       subset.commitPointMap.at(index) = m_commitPointMap.at(index);
       subset.commitPoints.emplace_back(m_commitPointMap.at(index));
-      subset.commitMap.at(index) = true;
+      const auto group = m_commitGroups.find(index);
+      if (group == m_commitGroups.end()) {
+        subset.commitMap.Set(index);
+        numPeers++;
+      } else {
+        subset.commitMap |= group->second;
+        subset.groupedMap |= group->second;
+        subset.commitGroups.emplace(*group);
+        numPeers += group->second.Count();
+      }
+    }
+
+    if ((i == 0) && (j > 0)) {
+      LOG_GENERAL(INFO, "Slowest backup in the first subset commits in about "
+                            << get<1>(commitOrder.at(j - 1)) << " ms");
     }
 
     if (DEBUG_LEVEL >= 5) {
       LOG_GENERAL(INFO, "SubsetID: " << i);
       for (unsigned int k = 0; k < subset.commitMap.size(); k++) {
         LOG_GENERAL(INFO,
-                    "Commit map " << k << " = " << subset.commitMap.at(k));
+                    "Commit map " << k << " = " << subset.commitMap.Test(k));
       }
     }
 
@@ -162,7 +217,8 @@ void ConsensusLeader::GenerateConsensusSubsets() {
   // point
   m_commitPointMap.clear();
   m_commitPoints.clear();
-  m_commitMap.clear();
+  m_commitMap.Reset(0);
+  m_commitGroups.clear();
   LOG_GENERAL(INFO, "Generated " << numSubsets << " subsets of "
                                  << m_numForConsensus
                                  << " backups each for this consensus");
@@ -171,7 +227,7 @@ void ConsensusLeader::GenerateConsensusSubsets() {
 void ConsensusLeader::StartConsensusSubsets() {
   LOG_MARKER();
 
-  ConsensusMessageType type;
+  ConsensusMessageType type = ConsensusMessageType::CHALLENGE;
   // Update overall internal state
   if (m_state == ANNOUNCE_DONE) {
     m_state = CHALLENGE_DONE;
@@ -201,7 +257,7 @@ void ConsensusLeader::StartConsensusSubsets() {
       Response r(*m_commitSecret, subset.challenge, m_myPrivKey);
       subset.responseData.emplace_back(r);
       subset.responseDataMap.at(m_myID) = r;
-      subset.responseMap.at(m_myID) = true;
+      subset.responseMap.Set(m_myID);
       subset.responseCounter = 1;
 
       // If we only have one subset, let's avoid using gossip to send the
@@ -214,13 +270,11 @@ void ConsensusLeader::StartConsensusSubsets() {
       } else {
         // Multicast challenge to all nodes who send validated commits
         vector<Peer> commit_peers;
-        deque<pair<PubKey, Peer>>::const_iterator j = m_committee.begin();
-
-        for (unsigned int i = 0; i < subset.commitMap.size(); i++, j++) {
-          if ((subset.commitMap.at(i)) && (i != m_myID)) {
-            commit_peers.emplace_back(j->second);
+        subset.commitMap.ForEachSet([this, &commit_peers](size_t i) {
+          if (i != m_myID) {
+            commit_peers.emplace_back(m_committee.at(i).second);
           }
-        }
+        });
         P2PComm::GetInstance().SendMessage(commit_peers, challenge);
       }
     } else {
@@ -228,6 +282,9 @@ void ConsensusLeader::StartConsensusSubsets() {
       SubsetEnded(index);
     }
   }
+
+  RecordPhase((type == ConsensusMessageType::CHALLENGE) ? PHASE_CHALLENGE
+                                                        : PHASE_FINALCHALLENGE);
 }
 void ConsensusLeader::SubsetEnded(uint16_t subsetID) {
   LOG_MARKER();
@@ -260,79 +317,158 @@ void ConsensusLeader::SubsetEnded(uint16_t subsetID) {
   }
 }
 
-bool ConsensusLeader::ProcessMessageCommitCore(
-    const bytes& commit, unsigned int offset, Action action,
-    [[gnu::unused]] ConsensusMessageType returnmsgtype,
-    [[gnu::unused]] State nextstate) {
-  LOG_MARKER();
+bool ConsensusLeader::VerifyCommit(const bytes& commit, unsigned int offset,
+                                   VerifiedMessage& verified) {
+  return CheckCommitMessage(commit, offset, verified.backupID,
+                            verified.commitPoint);
+}
 
-  lock_guard<mutex> g(m_mutex);
+bool ConsensusLeader::VerifyAggregatedCommit(const bytes& commit,
+                                             unsigned int offset,
+                                             VerifiedMessage& verified) {
+  // Extract and check aggregated commit message body
+  // ================================================
 
-  // Initial checks
-  // ==============
+  vector<bool> bitmap;
 
-  if (!CheckState(action)) {
+  if (!Messenger::GetConsensusAggregatedCommit(
+          commit, offset, m_consensusID, m_blockNumber, m_blockHash,
+          verified.backupID, bitmap, verified.commitPoint, m_committee)) {
+    LOG_GENERAL(WARNING, "Messenger::GetConsensusAggregatedCommit failed.");
     return false;
   }
 
-  // Extract and check commit message body
-  // =====================================
-
-  uint16_t backupID = 0;
-
-  CommitPoint commitPoint;
-  CommitPointHash commitPointHash;
+  // Check the aggregated commit
+  if (!verified.commitPoint.Initialized()) {
+    LOG_GENERAL(WARNING, "Invalid aggregated commit received");
+    return false;
+  }
 
-  if (!Messenger::GetConsensusCommit(
-          commit, offset, m_consensusID, m_blockNumber, m_blockHash, backupID,
-          commitPoint, commitPointHash, m_committee)) {
-    LOG_GENERAL(WARNING, "Messenger::GetConsensusCommit failed.");
+  // Check the sender aggregates for its group, and only for the backups in it
+  uint16_t aggregatorID = 0;
+  BitSet group;
+  if (!GetAggregationGroup(verified.backupID, m_myID, aggregatorID, group) ||
+      (aggregatorID != verified.backupID)) {
+    LOG_GENERAL(WARNING, "[Backup " << verified.backupID
+                                    << "] Backup is not an aggregator");
     return false;
   }
 
-  if (m_commitMap.at(backupID)) {
-    LOG_GENERAL(WARNING, "Backup has already sent validated commit");
+  verified.members = BitSet(bitmap);
+  if ((verified.members.size() != m_committee.size()) ||
+      !verified.members.Test(aggregatorID) ||
+      (verified.members.CountCommon(group) != verified.members.Count())) {
+    LOG_GENERAL(WARNING, "[Backup " << verified.backupID
+                                    << "] Aggregated commit map is not "
+                                       "within the group");
     return false;
   }
 
-  // Check the commit
-  if (!commitPoint.Initialized()) {
-    LOG_GENERAL(WARNING, "Invalid commit received");
+  // Individual commits were checked by the aggregator. A bad one only makes
+  // the group's aggregated response fail, which fails its subsets.
+  return true;
+}
+
+bool ConsensusLeader::TakeVerified(const bytes& message, unsigned int offset,
+                                   VerifiedMessage& verified) {
+  lock_guard<mutex> g(m_mutexVerified);
+
+  auto it =
+      m_verifiedMessages.find(bytes(message.begin() + offset, message.end()));
+  if (it == m_verifiedMessages.end()) {
     return false;
   }
 
-  // Check the deserialized commit hash
-  if (!commitPointHash.Initialized()) {
-    LOG_GENERAL(WARNING, "Invalid commit hash received");
+  verified = it->second;
+  m_verifiedMessages.erase(it);
+  return true;
+}
+
+bool ConsensusLeader::ProcessMessageCommitCore(
+    const bytes& commit, unsigned int offset, Action action,
+    [[gnu::unused]] ConsensusMessageType returnmsgtype,
+    [[gnu::unused]] State nextstate, bool aggregated) {
+  LOG_MARKER();
+  TRACE_SPAN("ConsensusLeader::ProcessMessageCommitCore");
+
+  // Initial checks
+  // ==============
+
+  if (!CheckState(action)) {
     return false;
   }
 
-  // Check the value of the commit hash
-  CommitPointHash commitPointHashExpected(commitPoint);
-  if (!(commitPointHashExpected == commitPointHash)) {
-    LOG_GENERAL(WARNING, "Commit hash check failed. Deserialized = "
-                             << string(commitPointHash) << " Expected = "
-                             << string(commitPointHashExpected));
+  // Verify outside m_mutex, so commits from many backups are checked in
+  // parallel. PreProcessMessage may already have done it (the message type
+  // byte is at offset - 1).
+  VerifiedMessage verified;
+  if (!TakeVerified(commit, offset - 1, verified) &&
+      !(aggregated ? VerifyAggregatedCommit(commit, offset, verified)
+                   : VerifyCommit(commit, offset, verified))) {
     return false;
   }
 
+  const uint16_t backupID = verified.backupID;
+  const CommitPoint& commitPoint = verified.commitPoint;
+
   bool result = false;
 
   // Update internal state
   // =====================
 
+  lock_guard<mutex> g(m_mutex);
+
   if (!CheckState(action)) {
     return false;
   }
 
+  unsigned int numCommits = 1;
+  if (aggregated) {
+    // Backups that have fallen back to sending their own commits are in
+    // already, and the aggregate cannot be split
+    if (verified.members.CountCommon(m_commitMap) > 0) {
+      LOG_GENERAL(WARNING, "[Backup " << backupID
+                                      << "] Group has backups that have "
+                                         "already sent validated commits");
+      return false;
+    }
+    numCommits = verified.members.Count();
+  } else if (m_commitMap.Test(backupID)) {
+    LOG_GENERAL(WARNING, "Backup has already sent validated commit");
+    return false;
+  }
+
   // 33-byte commit
   m_commitPoints.emplace_back(commitPoint);
   m_commitPointMap.at(backupID) = commitPoint;
-  m_commitMap.at(backupID) = true;
+  if (aggregated) {
+    m_commitMap |= verified.members;
+    m_commitGroups[backupID] = verified.members;
+  } else {
+    m_commitMap.Set(backupID);
+  }
 
-  m_commitCounter++;
+  const unsigned int prevCommitCounter = m_commitCounter;
+  m_commitCounter += numCommits;
+  const auto reached = [this, prevCommitCounter](unsigned int count) {
+    return (prevCommitCounter < count) && (m_commitCounter >= count);
+  };
+
+  CommitLatencyTracker::GetInstance().Record(
+      GetCommitteeMember(backupID).first,
+      r_timer_end(m_roundStartTime) / 1000);
+
+  if (reached(m_numForConsensus)) {
+    LOG_GENERAL(INFO, "[Round " << ((action == PROCESS_COMMIT) ? 1 : 2)
+                                << "] Commit quorum of " << m_numForConsensus
+                                << " reached in "
+                                << r_timer_end(m_roundStartTime) / 1000
+                                << " ms");
+    RecordPhase((action == PROCESS_COMMIT) ? PHASE_COMMIT_QUORUM
+                                           : PHASE_FINALCOMMIT_QUORUM);
+  }
 
-  if (m_commitCounter % 10 == 0) {
+  if (prevCommitCounter / 10 != m_commitCounter / 10) {
     LOG_GENERAL(INFO, "Received " << m_commitCounter << " out of "
                                   << m_numForConsensus << ".");
   }
@@ -340,20 +476,27 @@ bool ConsensusLeader::ProcessMessageCommitCore(
   // Redundant commits
   if (m_commitCounter > m_numForConsensus) {
     m_commitRedundantPointMap.at(backupID) = commitPoint;
-    m_commitRedundantMap.at(backupID) = true;
-    m_commitRedundantCounter++;
+    m_commitRedundantMap.Set(backupID);
+    m_commitRedundantCounter += numCommits;
   }
 
   if (NUM_CONSENSUS_SUBSETS > 1) {
     // notify the waiting thread to start with subset creations and subset
     // consensus.
-    if (m_commitCounter == m_committee.size()) {
+    if (reached(m_committee.size())) {
       lock_guard<mutex> g(m_mutexAnnounceSubsetConsensus);
       m_allCommitsReceived = true;
-      cv_scheduleSubsetConsensus.notify_all();
+      // Close the window now, off this thread as it holds m_mutex. If the
+      // timer is firing already, it closes the window instead.
+      if (m_commitWindowOpen &&
+          AsyncExecutor::GetInstance().Cancel(m_commitWindowTimer)) {
+        m_commitWindowTimer = AsyncExecutor::GetInstance().PostAfter(
+            chrono::milliseconds(0), [this]() { CloseCommitWindow(); },
+            "commit_window");
+      }
     }
   } else {
-    if (m_commitCounter == m_numForConsensus) {
+    if (reached(m_numForConsensus)) {
       LOG_GENERAL(INFO, "Sufficient commits obtained. Required/Actual = "
                             << m_commitCounter);
       GenerateConsensusSubsets();
@@ -365,10 +508,11 @@ bool ConsensusLeader::ProcessMessageCommitCore(
 }
 
 bool ConsensusLeader::ProcessMessageCommit(const bytes& commit,
-                                           unsigned int offset) {
+                                           unsigned int offset,
+                                           bool aggregated) {
   LOG_MARKER();
   return ProcessMessageCommitCore(commit, offset, PROCESS_COMMIT, CHALLENGE,
-                                  CHALLENGE_DONE);
+                                  CHALLENGE_DONE, aggregated);
 }
 
 bool ConsensusLeader::ProcessMessageCommitFailure(const bytes& commitFailureMsg,
@@ -434,6 +578,7 @@ bool ConsensusLeader::GenerateChallengeMessage(bytes& challenge,
                                                unsigned int offset,
                                                uint16_t subsetID) {
   LOG_MARKER();
+  TRACE_SPAN("ConsensusLeader::GenerateChallengeMessage");
 
   // Generate challenge object
   // =========================
@@ -479,74 +624,195 @@ bool ConsensusLeader::GenerateChallengeMessage(bytes& challenge,
   return true;
 }
 
-bool ConsensusLeader::ProcessMessageResponseCore(
-    const bytes& response, unsigned int offset, Action action,
-    ConsensusMessageType returnmsgtype, State nextstate) {
-  LOG_MARKER();
-  // Initial checks
-  // ==============
+bool ConsensusLeader::VerifyResponse(const bytes& response, unsigned int offset,
+                                     Action action, VerifiedMessage& verified) {
+  // Extract and check response message body
+  // =======================================
 
-  if (!CheckState(action)) {
+  if (!Messenger::GetConsensusResponse(
+          response, offset, m_consensusID, m_blockNumber, m_blockHash,
+          verified.backupID, verified.subsetID, verified.response,
+          m_committee)) {
+    LOG_GENERAL(WARNING, "Messenger::GetConsensusResponse failed.");
     return false;
   }
 
-  // Extract and check response message body
-  // =======================================
+  const uint16_t backupID = verified.backupID;
+  const uint16_t subsetID = verified.subsetID;
 
-  uint16_t backupID = 0;
-  uint16_t subsetID = 0;
-  Response r;
+  // Take what the response is checked against; the check itself runs
+  // without the lock
+  {
+    lock_guard<mutex> g(m_mutex);
 
-  if (!Messenger::GetConsensusResponse(response, offset, m_consensusID,
-                                       m_blockNumber, m_blockHash, backupID,
-                                       subsetID, r, m_committee)) {
-    LOG_GENERAL(WARNING, "Messenger::GetConsensusResponse failed.");
-    return false;
+    if (!CheckState(action)) {
+      return false;
+    }
+
+    // Check the subset id
+    if (subsetID >= m_consensusSubsets.size()) {
+      LOG_GENERAL(WARNING, "Error: Subset ID ("
+                               << subsetID << ") >= NUM_CONSENSUS_SUBSETS: "
+                               << NUM_CONSENSUS_SUBSETS);
+      return false;
+    }
+
+    // Check subset state
+    if (!CheckStateSubset(subsetID, action)) {
+      return false;
+    }
+
+    const ConsensusSubset& subset = m_consensusSubsets.at(subsetID);
+
+    // Check the backup id
+    if (backupID >= subset.responseDataMap.size()) {
+      LOG_GENERAL(WARNING, "[Subset " << subsetID << "] [Backup " << backupID
+                                      << "] Backup ID beyond backup count");
+      return false;
+    }
+    if (!subset.commitMap.Test(backupID)) {
+      LOG_GENERAL(
+          WARNING, "[Subset "
+                       << subsetID << "] [Backup " << backupID
+                       << "] Backup has not participated in the commit phase");
+      return false;
+    }
+    if (subset.groupedMap.Test(backupID)) {
+      LOG_GENERAL(WARNING, "[Subset " << subsetID << "] [Backup " << backupID
+                                      << "] Backup has committed through "
+                                         "its aggregator");
+      return false;
+    }
+
+    if (subset.responseMap.Test(backupID)) {
+      LOG_GENERAL(WARNING,
+                  "[Subset " << subsetID << "] [Backup " << backupID
+                             << "] Backup has already sent validated response");
+      return false;
+    }
+
+    verified.challenge = subset.challenge;
+    verified.commitPoint = subset.commitPointMap.at(backupID);
   }
 
-  // Check the subset id
-  if (subsetID >= m_consensusSubsets.size()) {
-    LOG_GENERAL(WARNING, "Error: Subset ID (" << subsetID
-                                              << ") >= NUM_CONSENSUS_SUBSETS: "
-                                              << NUM_CONSENSUS_SUBSETS);
+  if (!MultiSig::VerifyResponse(verified.response, verified.challenge,
+                                GetCommitteeMember(backupID).first,
+                                verified.commitPoint)) {
+    LOG_GENERAL(WARNING, "Invalid response for this backup");
     return false;
   }
 
-  // Check subset state
-  if (!CheckStateSubset(subsetID, action)) {
+  return true;
+}
+
+bool ConsensusLeader::VerifyAggregatedResponse(const bytes& response,
+                                               unsigned int offset,
+                                               Action action,
+                                               VerifiedMessage& verified) {
+  // Extract and check aggregated response message body
+  // ==================================================
+
+  vector<bool> bitmap;
+
+  if (!Messenger::GetConsensusAggregatedResponse(
+          response, offset, m_consensusID, m_blockNumber, m_blockHash,
+          verified.backupID, verified.subsetID, bitmap, verified.response,
+          m_committee)) {
+    LOG_GENERAL(WARNING, "Messenger::GetConsensusAggregatedResponse failed.");
     return false;
   }
 
-  ConsensusSubset& subset = m_consensusSubsets.at(subsetID);
+  const uint16_t backupID = verified.backupID;
+  const uint16_t subsetID = verified.subsetID;
+  verified.members = BitSet(bitmap);
 
-  // Check the backup id
-  if (backupID >= subset.responseDataMap.size()) {
-    LOG_GENERAL(WARNING, "[Subset " << subsetID << "] [Backup " << backupID
-                                    << "] Backup ID beyond backup count");
-    return false;
+  // Take what the response is checked against; the check itself runs
+  // without the lock
+  {
+    lock_guard<mutex> g(m_mutex);
+
+    if (!CheckState(action)) {
+      return false;
+    }
+
+    // Check the subset id
+    if (subsetID >= m_consensusSubsets.size()) {
+      LOG_GENERAL(WARNING, "Error: Subset ID ("
+                               << subsetID << ") >= NUM_CONSENSUS_SUBSETS: "
+                               << NUM_CONSENSUS_SUBSETS);
+      return false;
+    }
+
+    // Check subset state
+    if (!CheckStateSubset(subsetID, action)) {
+      return false;
+    }
+
+    const ConsensusSubset& subset = m_consensusSubsets.at(subsetID);
+
+    // Check the group is in the subset with the same backups it committed
+    const auto group = subset.commitGroups.find(backupID);
+    if (group == subset.commitGroups.end()) {
+      LOG_GENERAL(WARNING, "[Subset " << subsetID << "] [Backup " << backupID
+                                      << "] Group is not in the subset");
+      return false;
+    }
+    if (group->second != verified.members) {
+      LOG_GENERAL(WARNING, "[Subset " << subsetID << "] [Backup " << backupID
+                                      << "] Aggregated response map differs "
+                                         "from the commit map");
+      return false;
+    }
+
+    if (subset.responseMap.Test(backupID)) {
+      LOG_GENERAL(WARNING, "[Subset " << subsetID << "] [Backup " << backupID
+                                      << "] Group has already sent validated "
+                                         "response");
+      return false;
+    }
+
+    verified.challenge = subset.challenge;
+    verified.commitPoint = subset.commitPointMap.at(backupID);
   }
-  if (!subset.commitMap.at(backupID)) {
-    LOG_GENERAL(
-        WARNING, "[Subset "
-                     << subsetID << "] [Backup " << backupID
-                     << "] Backup has not participated in the commit phase");
+
+  // One check for the whole group, against its aggregated commit and key
+  const PubKey aggregatedKey = AggregateKeys(verified.members);
+  if (!aggregatedKey.Initialized() ||
+      !MultiSig::VerifyResponse(verified.response, verified.challenge,
+                                aggregatedKey, verified.commitPoint)) {
+    LOG_GENERAL(WARNING, "Invalid aggregated response for this group");
     return false;
   }
 
-  if (subset.responseMap.at(backupID)) {
-    LOG_GENERAL(WARNING, "[Subset "
-                             << subsetID << "] [Backup " << backupID
-                             << "] Backup has already sent validated response");
+  return true;
+}
+
+bool ConsensusLeader::ProcessMessageResponseCore(
+    const bytes& response, unsigned int offset, Action action,
+    ConsensusMessageType returnmsgtype, State nextstate, bool aggregated) {
+  LOG_MARKER();
+  TRACE_SPAN("ConsensusLeader::ProcessMessageResponseCore");
+  // Initial checks
+  // ==============
+
+  if (!CheckState(action)) {
     return false;
   }
 
-  if (!MultiSig::VerifyResponse(r, subset.challenge,
-                                GetCommitteeMember(backupID).first,
-                                subset.commitPointMap.at(backupID))) {
-    LOG_GENERAL(WARNING, "Invalid response for this backup");
+  // Verify outside m_mutex, unless PreProcessMessage already has (the message
+  // type byte is at offset - 1)
+  VerifiedMessage verified;
+  if (!TakeVerified(response, offset - 1, verified) &&
+      !(aggregated
+            ? VerifyAggregatedResponse(response, offset, action, verified)
+            : VerifyResponse(response, offset, action, verified))) {
     return false;
   }
 
+  const uint16_t backupID = verified.backupID;
+  const uint16_t subsetID = verified.subsetID;
+  const Response& r = verified.response;
+
   // Update internal state
   // =====================
 
@@ -555,17 +821,42 @@ bool ConsensusLeader::ProcessMessageResponseCore(
     return false;
   }
 
-  if (!CheckStateSubset(subsetID, action)) {
+  // The subsets may have been regenerated since the response was checked
+  if ((subsetID >= m_consensusSubsets.size()) ||
+      !CheckStateSubset(subsetID, action)) {
+    return false;
+  }
+
+  ConsensusSubset& subset = m_consensusSubsets.at(subsetID);
+
+  if (!(subset.challenge == verified.challenge)) {
+    LOG_GENERAL(WARNING, "[Subset " << subsetID << "] [Backup " << backupID
+                                    << "] Response checked against an old "
+                                       "challenge");
+    return false;
+  }
+
+  if (aggregated ? (subset.responseMap.CountCommon(verified.members) > 0)
+                 : subset.responseMap.Test(backupID)) {
+    LOG_GENERAL(WARNING, "[Subset "
+                             << subsetID << "] [Backup " << backupID
+                             << "] Backup has already sent validated response");
     return false;
   }
 
   // 32-byte response
+  const unsigned int prevResponseCounter = subset.responseCounter;
   subset.responseData.emplace_back(r);
   subset.responseDataMap.at(backupID) = r;
-  subset.responseMap.at(backupID) = true;
-  subset.responseCounter++;
+  if (aggregated) {
+    subset.responseMap |= verified.members;
+    subset.responseCounter += verified.members.Count();
+  } else {
+    subset.responseMap.Set(backupID);
+    subset.responseCounter++;
+  }
 
-  if (subset.responseCounter % 10 == 0) {
+  if (prevResponseCounter / 10 != subset.responseCounter / 10) {
     LOG_GENERAL(INFO, "[Subset " << subsetID << "] Received "
                                  << subset.responseCounter << " out of "
                                  << m_numForConsensus << ".");
@@ -576,7 +867,17 @@ bool ConsensusLeader::ProcessMessageResponseCore(
 
   bool result = true;
 
-  if (subset.responseCounter == m_numForConsensus) {
+  // Every backup in the subset's commit has to respond, and a group can take
+  // the subset past m_numForConsensus
+  if (subset.responseCounter == subset.commitMap.Count()) {
+    LOG_GENERAL(INFO, "[Round " << ((action == PROCESS_RESPONSE) ? 1 : 2)
+                                << "] [Subset " << subsetID
+                                << "] Response quorum reached in "
+                                << r_timer_end(m_roundStartTime) / 1000
+                                << " ms");
+    RecordPhase((action == PROCESS_RESPONSE) ? PHASE_RESPONSE_QUORUM
+                                             : PHASE_FINALRESPONSE_QUORUM,
+                subsetID);
     LOG_GENERAL(INFO, "Sufficient responses obtained");
 
     bytes collectivesig = {m_classByte, m_insByte,
@@ -595,35 +896,37 @@ bool ConsensusLeader::ProcessMessageResponseCore(
         // Second round: consensus over part of message + CS1 + B1
         subset.collectiveSig.Serialize(m_messageToCosign,
                                        m_messageToCosign.size());
-        BitVector::SetBitVector(m_messageToCosign, m_messageToCosign.size(),
-                                subset.responseMap);
+        subset.responseMap.Serialize(m_messageToCosign,
+                                     m_messageToCosign.size());
 
         // Save the collective sig over the first round
         m_CS1 = subset.collectiveSig;
-        m_B1 = subset.responseMap;
+        m_B1 = subset.responseMap.ToVector();
 
         // reset settings for second round of consensus
-        m_commitMap.resize(m_committee.size());
-        fill(m_commitMap.begin(), m_commitMap.end(), false);
+        m_commitMap.Reset(m_committee.size());
         m_commitPointMap.resize(m_committee.size());
         m_commitPoints.clear();
 
         // Add the leader to the commits
-        m_commitMap.at(m_myID) = true;
+        m_commitMap.Set(m_myID);
         m_commitPoints.emplace_back(*m_commitPoint);
         m_commitPointMap.at(m_myID) = *m_commitPoint;
         m_commitCounter = 1;
+        m_commitGroups.clear();
 
         m_commitFailureCounter = 0;
         m_commitFailureMap.clear();
 
         m_commitRedundantCounter = 0;
-        fill(m_commitRedundantMap.begin(), m_commitRedundantMap.end(), false);
+        m_commitRedundantMap.Reset(m_committee.size());
+
+        m_roundStartTime = r_timer_start();
 
       } else {
         // Save the collective sig over the second round
         m_CS2 = subset.collectiveSig;
-        m_B2 = subset.responseMap;
+        m_B2 = subset.responseMap.ToVector();
       }
 
       // Subset has finished consensus! Either Round 1 or Round 2
@@ -651,40 +954,14 @@ bool ConsensusLeader::ProcessMessageResponseCore(
         P2PComm::GetInstance().SendMessage(peerInfo, collectivesig);
       }
 
+      RecordPhase((action == PROCESS_RESPONSE) ? PHASE_COLLECTIVESIG
+                                               : PHASE_FINALCOLLECTIVESIG,
+                  subsetID);
+
       if ((m_state == COLLECTIVESIG_DONE) && (NUM_CONSENSUS_SUBSETS > 1)) {
         // Start timer for accepting final commits
         // =================================
-        auto func = [this]() -> void {
-          std::unique_lock<std::mutex> cv_lk(m_mutexAnnounceSubsetConsensus);
-          m_allCommitsReceived = false;
-          if (cv_scheduleSubsetConsensus.wait_for(
-                  cv_lk, std::chrono::seconds(COMMIT_WINDOW_IN_SECONDS),
-                  [&] { return m_allCommitsReceived; })) {
-            LOG_GENERAL(
-                INFO, "Received all final commits within the Commit window. !!")
-          } else {
-            LOG_GENERAL(INFO,
-                        "Timeout - Final Commit window closed. Will process "
-                        "commits received !!");
-          }
-          if (m_commitCounter < m_numForConsensus) {
-            LOG_GENERAL(
-                WARNING,
-                "Insufficient final commits obtained after timeout. Required "
-                "= " << m_numForConsensus
-                     << " Actual = " << m_commitCounter);
-            m_state = ERROR;
-          } else {
-            LOG_GENERAL(
-                INFO,
-                "Sufficient final commits obtained after timeout. Required = "
-                    << m_numForConsensus << " Actual = " << m_commitCounter);
-            lock_guard<mutex> g(m_mutex);
-            GenerateConsensusSubsets();
-            StartConsensusSubsets();
-          }
-        };
-        DetachedFunction(1, func);
+        OpenCommitWindow(true);
       }
     }
   }
@@ -693,16 +970,19 @@ bool ConsensusLeader::ProcessMessageResponseCore(
 }
 
 bool ConsensusLeader::ProcessMessageResponse(const bytes& response,
-                                             unsigned int offset) {
+                                             unsigned int offset,
+                                             bool aggregated) {
   LOG_MARKER();
   return ProcessMessageResponseCore(response, offset, PROCESS_RESPONSE,
-                                    COLLECTIVESIG, COLLECTIVESIG_DONE);
+                                    COLLECTIVESIG, COLLECTIVESIG_DONE,
+                                    aggregated);
 }
 
 bool ConsensusLeader::GenerateCollectiveSigMessage(bytes& collectivesig,
                                                    unsigned int offset,
                                                    uint16_t subsetID) {
   LOG_MARKER();
+  TRACE_SPAN("ConsensusLeader::GenerateCollectiveSigMessage");
 
   // Generate collective signature object
   // ====================================
@@ -750,7 +1030,7 @@ bool ConsensusLeader::GenerateCollectiveSigMessage(bytes& collectivesig,
 
   if (!Messenger::SetConsensusCollectiveSig(
           collectivesig, offset, m_consensusID, m_blockNumber, m_blockHash,
-          m_myID, subset.collectiveSig, subset.responseMap,
+          m_myID, subset.collectiveSig, subset.responseMap.ToVector(),
           make_pair(m_myPrivKey, GetCommitteeMember(m_myID).first))) {
     LOG_GENERAL(WARNING, "Messenger::SetConsensusCollectiveSig failed.");
     return false;
@@ -763,17 +1043,21 @@ bool ConsensusLeader::GenerateCollectiveSigMessage(bytes& collectivesig,
 }
 
 bool ConsensusLeader::ProcessMessageFinalCommit(const bytes& finalcommit,
-                                                unsigned int offset) {
+                                                unsigned int offset,
+                                                bool aggregated) {
   LOG_MARKER();
   return ProcessMessageCommitCore(finalcommit, offset, PROCESS_FINALCOMMIT,
-                                  FINALCHALLENGE, FINALCHALLENGE_DONE);
+                                  FINALCHALLENGE, FINALCHALLENGE_DONE,
+                                  aggregated);
 }
 
 bool ConsensusLeader::ProcessMessageFinalResponse(const bytes& finalresponse,
-                                                  unsigned int offset) {
+                                                  unsigned int offset,
+                                                  bool aggregated) {
   LOG_MARKER();
-  return ProcessMessageResponseCore(
-      finalresponse, offset, PROCESS_FINALRESPONSE, FINALCOLLECTIVESIG, DONE);
+  return ProcessMessageResponseCore(finalresponse, offset,
+                                    PROCESS_FINALRESPONSE, FINALCOLLECTIVESIG,
+                                    DONE, aggregated);
 }
 
 ConsensusLeader::ConsensusLeader(
@@ -785,9 +1069,9 @@ ConsensusLeader::ConsensusLeader(
     ShardCommitFailureHandlerFunc shardCommitFailureHandlerFunc)
     : ConsensusCommon(consensus_id, block_number, block_hash, node_id, privkey,
                       committee, class_byte, ins_byte),
-      m_commitMap(committee.size(), false),
+      m_commitMap(committee.size()),
       m_commitPointMap(committee.size(), CommitPoint()),
-      m_commitRedundantMap(committee.size(), false),
+      m_commitRedundantMap(committee.size()),
       m_commitRedundantPointMap(committee.size(), CommitPoint()) {
   LOG_MARKER();
 
@@ -804,26 +1088,86 @@ ConsensusLeader::ConsensusLeader(
   m_nodeCommitFailureHandlerFunc = nodeCommitFailureHandlerFunc;
   m_shardCommitFailureHandlerFunc = shardCommitFailureHandlerFunc;
 
-  m_commitSecret.reset(new CommitSecret());
-  m_commitPoint.reset(new CommitPoint(*m_commitSecret));
+  tie(m_commitSecret, m_commitPoint) = CommitPool::GetInstance().Take();
 
   // Add the leader to the commits
-  m_commitMap.at(m_myID) = true;
+  m_commitMap.Set(m_myID);
   m_commitPoints.emplace_back(*m_commitPoint);
   m_commitPointMap.at(m_myID) = *m_commitPoint;
   m_commitCounter = 1;
 
+  m_commitWindowOpen = false;
+  m_commitWindowFinal = false;
   m_allCommitsReceived = false;
+  m_commitWindowTimer = 0;
   m_commitRedundantCounter = 0;
   m_commitFailureCounter = 0;
   m_numSubsetsRunning = 0;
+  m_roundStartTime = r_timer_start();
 }
 
-ConsensusLeader::~ConsensusLeader() {}
+ConsensusLeader::~ConsensusLeader() {
+  lock_guard<mutex> g(m_mutexAnnounceSubsetConsensus);
+  if (m_commitWindowOpen) {
+    AsyncExecutor::GetInstance().Cancel(m_commitWindowTimer);
+  }
+}
+
+void ConsensusLeader::OpenCommitWindow(bool finalCommits) {
+  lock_guard<mutex> g(m_mutexAnnounceSubsetConsensus);
+  m_commitWindowOpen = true;
+  m_commitWindowFinal = finalCommits;
+  m_allCommitsReceived = false;
+  m_commitWindowTimer = AsyncExecutor::GetInstance().PostAfter(
+      chrono::seconds(COMMIT_WINDOW_IN_SECONDS),
+      [this]() { CloseCommitWindow(); }, "commit_window");
+}
+
+void ConsensusLeader::CloseCommitWindow() {
+  bool finalCommits = false;
+  bool allCommitsReceived = false;
+  {
+    lock_guard<mutex> g(m_mutexAnnounceSubsetConsensus);
+    if (!m_commitWindowOpen) {
+      return;
+    }
+    m_commitWindowOpen = false;
+    finalCommits = m_commitWindowFinal;
+    allCommitsReceived = m_allCommitsReceived;
+  }
+  const string commits = finalCommits ? "final commits" : "commits";
+
+  if (allCommitsReceived) {
+    LOG_GENERAL(INFO,
+                "Received all " << commits << " within the Commit window. !!");
+  } else {
+    LOG_GENERAL(INFO, "Timeout - " << (finalCommits ? "Final " : "")
+                                   << "Commit window closed. Will process "
+                                      "commits received !!");
+  }
+
+  if (m_commitCounter < m_numForConsensus) {
+    LOG_GENERAL(WARNING, "Insufficient " << commits
+                                         << " obtained after timeout. Required "
+                                            "= "
+                                         << m_numForConsensus
+                                         << " Actual = " << m_commitCounter);
+    m_state = ERROR;
+  } else {
+    LOG_GENERAL(INFO, "Sufficient " << commits
+                                    << " obtained after timeout. Required = "
+                                    << m_numForConsensus
+                                    << " Actual = " << m_commitCounter);
+    lock_guard<mutex> g(m_mutex);
+    GenerateConsensusSubsets();
+    StartConsensusSubsets();
+  }
+}
 
 bool ConsensusLeader::StartConsensus(
     AnnouncementGeneratorFunc announcementGeneratorFunc, bool useGossipProto) {
   LOG_MARKER();
+  TRACE_SPAN("ConsensusLeader::StartConsensus");
 
   // Initial checks
   // ==============
@@ -855,6 +1199,8 @@ bool ConsensusLeader::StartConsensus(
   m_state = ANNOUNCE_DONE;
   m_commitRedundantCounter = 0;
   m_commitFailureCounter = 0;
+  m_roundStartTime = r_timer_start();
+  m_phaseStartTime = m_roundStartTime;
 
   // Multicast to all nodes in the committee
   // =======================================
@@ -874,35 +1220,7 @@ bool ConsensusLeader::StartConsensus(
   if (NUM_CONSENSUS_SUBSETS > 1) {
     // Start timer for accepting commits
     // =================================
-    auto func = [this]() -> void {
-      std::unique_lock<std::mutex> cv_lk(m_mutexAnnounceSubsetConsensus);
-      m_allCommitsReceived = false;
-      if (cv_scheduleSubsetConsensus.wait_for(
-              cv_lk, std::chrono::seconds(COMMIT_WINDOW_IN_SECONDS),
-              [&] { return m_allCommitsReceived; })) {
-        LOG_GENERAL(INFO, "Received all commits within the Commit window. !!");
-      } else {
-        LOG_GENERAL(
-            INFO,
-            "Timeout - Commit window closed. Will process commits received !!");
-      }
-
-      if (m_commitCounter < m_numForConsensus) {
-        LOG_GENERAL(WARNING,
-                    "Insufficient commits obtained after timeout. Required = "
-                        << m_numForConsensus
-                        << " Actual = " << m_commitCounter);
-        m_state = ERROR;
-      } else {
-        LOG_GENERAL(
-            INFO, "Sufficient commits obtained after timeout. Required = "
-                      << m_numForConsensus << " Actual = " << m_commitCounter);
-        lock_guard<mutex> g(m_mutex);
-        GenerateConsensusSubsets();
-        StartConsensusSubsets();
-      }
-    };
-    DetachedFunction(1, func);
+    OpenCommitWindow(false);
   }
 
   return true;
@@ -919,19 +1237,31 @@ bool ConsensusLeader::ProcessMessage(const bytes& message, unsigned int offset,
 
   switch (message.at(offset)) {
     case ConsensusMessageType::COMMIT:
-      result = ProcessMessageCommit(message, offset + 1);
+      result = ProcessMessageCommit(message, offset + 1, false);
       break;
     case ConsensusMessageType::COMMITFAILURE:
       result = ProcessMessageCommitFailure(message, offset + 1, from);
       break;
     case ConsensusMessageType::RESPONSE:
-      result = ProcessMessageResponse(message, offset + 1);
+      result = ProcessMessageResponse(message, offset + 1, false);
       break;
     case ConsensusMessageType::FINALCOMMIT:
-      result = ProcessMessageFinalCommit(message, offset + 1);
+      result = ProcessMessageFinalCommit(message, offset + 1, false);
       break;
     case ConsensusMessageType::FINALRESPONSE:
-      result = ProcessMessageFinalResponse(message, offset + 1);
+      result = ProcessMessageFinalResponse(message, offset + 1, false);
+      break;
+    case ConsensusMessageType::AGGREGATEDCOMMIT:
+      result = ProcessMessageCommit(message, offset + 1, true);
+      break;
+    case ConsensusMessageType::AGGREGATEDRESPONSE:
+      result = ProcessMessageResponse(message, offset + 1, true);
+      break;
+    case ConsensusMessageType::AGGREGATEDFINALCOMMIT:
+      result = ProcessMessageFinalCommit(message, offset + 1, true);
+      break;
+    case ConsensusMessageType::AGGREGATEDFINALRESPONSE:
+      result = ProcessMessageFinalResponse(message, offset + 1, true);
       break;
     default:
       LOG_GENERAL(WARNING, "Unknown consensus message received. No: "
@@ -941,6 +1271,52 @@ bool ConsensusLeader::ProcessMessage(const bytes& message, unsigned int offset,
   return result;
 }
 
+void ConsensusLeader::PreProcessMessage(const bytes& message,
+                                        unsigned int offset) {
+  if (offset >= message.size()) {
+    return;
+  }
+
+  VerifiedMessage verified;
+  bool result = false;
+
+  switch (message.at(offset)) {
+    case ConsensusMessageType::COMMIT:
+    case ConsensusMessageType::FINALCOMMIT:
+      result = VerifyCommit(message, offset + 1, verified);
+      break;
+    case ConsensusMessageType::RESPONSE:
+      result =
+          VerifyResponse(message, offset + 1, PROCESS_RESPONSE, verified);
+      break;
+    case ConsensusMessageType::FINALRESPONSE:
+      result = VerifyResponse(message, offset + 1, PROCESS_FINALRESPONSE,
+                              verified);
+      break;
+    case ConsensusMessageType::AGGREGATEDCOMMIT:
+    case ConsensusMessageType::AGGREGATEDFINALCOMMIT:
+      result = VerifyAggregatedCommit(message, offset + 1, verified);
+      break;
+    case ConsensusMessageType::AGGREGATEDRESPONSE:
+      result = VerifyAggregatedResponse(message, offset + 1, PROCESS_RESPONSE,
+                                        verified);
+      break;
+    case ConsensusMessageType::AGGREGATEDFINALRESPONSE:
+      result = VerifyAggregatedResponse(message, offset + 1,
+                                        PROCESS_FINALRESPONSE, verified);
+      break;
+    default:
+      return;
+  }
+
+  // A message that failed is checked again, and rejected, by ProcessMessage
+  if (result) {
+    lock_guard<mutex> g(m_mutexVerified);
+    m_verifiedMessages.emplace(bytes(message.begin() + offset, message.end()),
+                               verified);
+  }
+}
+
 #define MAKE_LITERAL_PAIR(s) \
   { s, #s }
 
@@ -18,8 +18,10 @@
 #ifndef __CONSENSUSLEADER_H__
 #define __CONSENSUSLEADER_H__
 
+#include <chrono>
 #include <deque>
 #include <functional>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <vector>
@@ -27,6 +29,8 @@
 #include "ConsensusCommon.h"
 #include "libCrypto/MultiSig.h"
 #include "libNetwork/PeerStore.h"
+#include "libUtils/AsyncExecutor.h"
+#include "libUtils/BitSet.h"
 #include "libUtils/TimeLockedFunction.h"
 
 typedef std::function<bool(const bytes& errorMsg, const Peer& from)>
@@ -58,21 +62,27 @@ class ConsensusLeader : public ConsensusCommon {
   std::mutex m_mutex;
   std::atomic<unsigned int> m_commitCounter;
 
+  // Commit window of subset consensus, closed by its timer or once all
+  // commits are in
   std::mutex m_mutexAnnounceSubsetConsensus;
-  std::condition_variable cv_scheduleSubsetConsensus;
+  bool m_commitWindowOpen;
+  bool m_commitWindowFinal;
   bool m_allCommitsReceived;
+  AsyncExecutor::TaskId m_commitWindowTimer;
 
-  // TODO: the vectors should be replaced by more space efficient DS
-  std::vector<bool> m_commitMap;
+  BitSet m_commitMap;
   std::vector<CommitPoint>
       m_commitPointMap;  // ordered list of commits of size = committee size
   std::vector<CommitPoint> m_commitPoints;  // unordered list of commits of size
                                             // = 2/3 of committee size + 1
   unsigned int m_commitRedundantCounter;
-  std::vector<bool> m_commitRedundantMap;
+  BitSet m_commitRedundantMap;
   std::vector<CommitPoint>
       m_commitRedundantPointMap;  // ordered list of redundant commits of size =
                                   // 1/3 of committee size
+  // Groups whose aggregated commit is in, keyed by aggregator. The aggregated
+  // commit is at the aggregator's index in m_commitPointMap.
+  std::map<uint16_t, BitSet> m_commitGroups;
   // Generated challenge
   Challenge m_challenge;
 
@@ -80,18 +90,20 @@ class ConsensusLeader : public ConsensusCommon {
   std::map<unsigned int, bytes> m_commitFailureMap;
 
   // Tracking data for each consensus subset
-  // TODO: the vectors should be replaced by more space efficient DS
   struct ConsensusSubset {
-    std::vector<bool> commitMap;
+    BitSet commitMap;
     std::vector<CommitPoint> commitPointMap;  // Ordered list of commits of
                                               // fixed size = committee size
     std::vector<CommitPoint> commitPoints;
+    /// Groups in the subset, keyed by aggregator, and the backups they cover
+    std::map<uint16_t, BitSet> commitGroups;
+    BitSet groupedMap;
     unsigned int responseCounter;
     Challenge challenge;  // Challenge / Finalchallenge value generated
     std::vector<Response> responseDataMap;  // Ordered list of responses of
                                             // fixed size = committee size
     /// Response map for the generated collective signature
-    std::vector<bool> responseMap;
+    BitSet responseMap;
     std::vector<Response> responseData;
     Signature collectiveSig;
     State state;  // Subset consensus state
@@ -99,6 +111,21 @@ class ConsensusLeader : public ConsensusCommon {
   std::vector<ConsensusSubset> m_consensusSubsets;
   unsigned int m_numSubsetsRunning;
 
+  // Commits and responses checked by PreProcessMessage, keyed by message
+  struct VerifiedMessage {
+    uint16_t backupID;
+    uint16_t subsetID;
+    CommitPoint commitPoint;
+    Challenge challenge;  // Challenge the response was checked against
+    Response response;
+    BitSet members;  // Backups covered by an aggregated message, else empty
+  };
+  std::mutex m_mutexVerified;
+  std::map<bytes, VerifiedMessage> m_verifiedMessages;
+
+  // Time-to-quorum of the current round
+  std::chrono::system_clock::time_point m_roundStartTime;
+
   NodeCommitFailureHandlerFunc m_nodeCommitFailureHandlerFunc;
   ShardCommitFailureHandlerFunc m_shardCommitFailureHandlerFunc;
 
@@ -108,12 +135,25 @@ class ConsensusLeader : public ConsensusCommon {
   void SetStateSubset(uint16_t subsetID, State newState);
   void GenerateConsensusSubsets();
   void StartConsensusSubsets();
+  void OpenCommitWindow(bool finalCommits);
+  void CloseCommitWindow();
   void SubsetEnded(uint16_t subsetID);
+  bool VerifyCommit(const bytes& commit, unsigned int offset,
+                    VerifiedMessage& verified);
+  bool VerifyAggregatedCommit(const bytes& commit, unsigned int offset,
+                              VerifiedMessage& verified);
+  bool VerifyResponse(const bytes& response, unsigned int offset,
+                      Action action, VerifiedMessage& verified);
+  bool VerifyAggregatedResponse(const bytes& response, unsigned int offset,
+                                Action action, VerifiedMessage& verified);
+  bool TakeVerified(const bytes& message, unsigned int offset,
+                    VerifiedMessage& verified);
   bool ProcessMessageCommitCore(const bytes& commit, unsigned int offset,
                                 Action action,
                                 ConsensusMessageType returnmsgtype,
-                                State nextstate);
-  bool ProcessMessageCommit(const bytes& commit, unsigned int offset);
+                                State nextstate, bool aggregated);
+  bool ProcessMessageCommit(const bytes& commit, unsigned int offset,
+                            bool aggregated);
   bool ProcessMessageCommitFailure(const bytes& commitFailureMsg,
                                    unsigned int offset, const Peer& from);
   bool GenerateChallengeMessage(bytes& challenge, unsigned int offset,
@@ -121,13 +161,15 @@ class ConsensusLeader : public ConsensusCommon {
   bool ProcessMessageResponseCore(const bytes& response, unsigned int offset,
                                   Action action,
                                   ConsensusMessageType returnmsgtype,
-                                  State nextstate);
-  bool ProcessMessageResponse(const bytes& response, unsigned int offset);
+                                  State nextstate, bool aggregated);
+  bool ProcessMessageResponse(const bytes& response, unsigned int offset,
+                              bool aggregated);
   bool GenerateCollectiveSigMessage(bytes& collectivesig, unsigned int offset,
                                     uint16_t subsetID);
-  bool ProcessMessageFinalCommit(const bytes& finalcommit, unsigned int offset);
+  bool ProcessMessageFinalCommit(const bytes& finalcommit, unsigned int offset,
+                                 bool aggregated);
   bool ProcessMessageFinalResponse(const bytes& finalresponse,
-                                   unsigned int offset);
+                                   unsigned int offset, bool aggregated);
 
  public:
   /// Constructor.
@@ -159,6 +201,9 @@ class ConsensusLeader : public ConsensusCommon {
   bool ProcessMessage(const bytes& message, unsigned int offset,
                       const Peer& from);
 
+  /// Verifies commits and responses outside the consensus locks.
+  void PreProcessMessage(const bytes& message, unsigned int offset);
+
   unsigned int GetNumForConsensusFailure() { return m_numForConsensusFailure; }
 
  private:
@@ -0,0 +1,182 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <algorithm>
+#include <chrono>
+
+#include "ConsensusTrace.h"
+#include "common/Constants.h"
+#include "common/Messages.h"
+#include "common/Serializable.h"
+#include "libUtils/Logger.h"
+
+using namespace std;
+
+ConsensusTrace::ConsensusTrace() {
+  if (!CONSENSUS_TRACE_FILE.empty()) {
+    m_traceFile.open(CONSENSUS_TRACE_FILE, ios::binary | ios::app);
+    if (!m_traceFile.is_open()) {
+      LOG_GENERAL(WARNING,
+                  "Cannot open consensus trace file " << CONSENSUS_TRACE_FILE);
+    }
+  }
+}
+
+ConsensusTrace::~ConsensusTrace() {
+  if (m_traceFile.is_open()) {
+    m_traceFile.close();
+  }
+}
+
+ConsensusTrace& ConsensusTrace::GetInstance() {
+  static ConsensusTrace trace;
+  return trace;
+}
+
+ConsensusBlockType ConsensusTrace::GetBlockType(unsigned char classByte,
+                                                unsigned char insByte) {
+  if (classByte == MessageType::DIRECTORY) {
+    switch (insByte) {
+      case DSInstructionType::DSBLOCKCONSENSUS:
+        return CONSENSUS_BLOCK_DS;
+      case DSInstructionType::FINALBLOCKCONSENSUS:
+        return CONSENSUS_BLOCK_FINAL;
+      case DSInstructionType::VIEWCHANGECONSENSUS:
+        return CONSENSUS_BLOCK_VIEWCHANGE;
+      default:
+        break;
+    }
+  } else if (classByte == MessageType::NODE) {
+    switch (insByte) {
+      case NodeInstructionType::MICROBLOCKCONSENSUS:
+        return CONSENSUS_BLOCK_MICRO;
+      case NodeInstructionType::FALLBACKCONSENSUS:
+        return CONSENSUS_BLOCK_FALLBACK;
+      default:
+        break;
+    }
+  }
+  return CONSENSUS_BLOCK_OTHER;
+}
+
+const char* ConsensusTrace::GetBlockTypeName(ConsensusBlockType blockType) {
+  switch (blockType) {
+    case CONSENSUS_BLOCK_DS:
+      return "DS";
+    case CONSENSUS_BLOCK_MICRO:
+      return "MB";
+    case CONSENSUS_BLOCK_FINAL:
+      return "FB";
+    case CONSENSUS_BLOCK_VIEWCHANGE:
+      return "VC";
+    case CONSENSUS_BLOCK_FALLBACK:
+      return "FALLBACK";
+    default:
+      return "OTHER";
+  }
+}
+
+const char* ConsensusTrace::GetPhaseName(ConsensusPhase phase) {
+  switch (phase) {
+    case PHASE_COMMIT_QUORUM:
+      return "COMMIT_QUORUM";
+    case PHASE_CHALLENGE:
+      return "CHALLENGE";
+    case PHASE_RESPONSE_QUORUM:
+      return "RESPONSE_QUORUM";
+    case PHASE_COLLECTIVESIG:
+      return "COLLECTIVESIG";
+    case PHASE_FINALCOMMIT_QUORUM:
+      return "FINALCOMMIT_QUORUM";
+    case PHASE_FINALCHALLENGE:
+      return "FINALCHALLENGE";
+    case PHASE_FINALRESPONSE_QUORUM:
+      return "FINALRESPONSE_QUORUM";
+    case PHASE_FINALCOLLECTIVESIG:
+      return "FINALCOLLECTIVESIG";
+    case PHASE_BACKUP_CHALLENGE_WAIT:
+      return "BACKUP_CHALLENGE_WAIT";
+    case PHASE_BACKUP_COLLECTIVESIG_WAIT:
+      return "BACKUP_COLLECTIVESIG_WAIT";
+    case PHASE_BACKUP_FINALCHALLENGE_WAIT:
+      return "BACKUP_FINALCHALLENGE_WAIT";
+    case PHASE_BACKUP_FINALCOLLECTIVESIG_WAIT:
+      return "BACKUP_FINALCOLLECTIVESIG_WAIT";
+    default:
+      return "UNKNOWN";
+  }
+}
+
+void ConsensusTrace::Record(uint32_t consensusID, ConsensusBlockType blockType,
+                            uint16_t subsetID, ConsensusPhase phase,
+                            uint64_t durationInMicroseconds) {
+  unsigned int bucket = 0;
+  for (uint64_t ms = durationInMicroseconds / 1000;
+       ms > 0 && bucket < ConsensusPhaseStats::NUM_BUCKETS - 1; ms >>= 1) {
+    bucket++;
+  }
+
+  lock_guard<mutex> g(m_mutex);
+
+  auto it = m_stats.find(Key(blockType, phase, subsetID));
+  if (it == m_stats.end()) {
+    ConsensusPhaseStats stats{blockType, phase, subsetID, 0, 0, 0, 0, {}};
+    it = m_stats.emplace(Key(blockType, phase, subsetID), stats).first;
+  }
+
+  ConsensusPhaseStats& stats = it->second;
+  stats.m_lastConsensusID = consensusID;
+  stats.m_count++;
+  stats.m_totalInMicroseconds += durationInMicroseconds;
+  stats.m_maxInMicroseconds =
+      max(stats.m_maxInMicroseconds, durationInMicroseconds);
+  stats.m_buckets.at(bucket)++;
+
+  if (m_traceFile.is_open()) {
+    const uint64_t now = chrono::duration_cast<chrono::microseconds>(
+                             chrono::system_clock::now().time_since_epoch())
+                             .count();
+    const uint32_t duration = static_cast<uint32_t>(
+        min<uint64_t>(durationInMicroseconds, UINT32_MAX));
+
+    bytes record;
+    record.reserve(RECORD_SIZE);
+    Serializable::SetNumber<uint64_t>(record, 0, now, sizeof(uint64_t));
+    Serializable::SetNumber<uint32_t>(record, 8, consensusID,
+                                      sizeof(uint32_t));
+    Serializable::SetNumber<uint32_t>(record, 12, duration, sizeof(uint32_t));
+    Serializable::SetNumber<uint16_t>(record, 16, subsetID, sizeof(uint16_t));
+    record.push_back(blockType);
+    record.push_back(phase);
+
+    m_traceFile.write(reinterpret_cast<const char*>(record.data()),
+                      record.size());
+    m_traceFile.flush();
+  }
+}
+
+vector<ConsensusPhaseStats> ConsensusTrace::GetStats() {
+  lock_guard<mutex> g(m_mutex);
+
+  vector<ConsensusPhaseStats> result;
+  result.reserve(m_stats.size());
+  for (const auto& entry : m_stats) {
+    result.emplace_back(entry.second);
+  }
+  return result;
+}
@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef __CONSENSUSTRACE_H__
+#define __CONSENSUSTRACE_H__
+
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <tuple>
+#include <vector>
+
+/// Kind of block a consensus session is agreeing on
+enum ConsensusBlockType : uint8_t {
+  CONSENSUS_BLOCK_DS = 0,
+  CONSENSUS_BLOCK_MICRO,
+  CONSENSUS_BLOCK_FINAL,
+  CONSENSUS_BLOCK_VIEWCHANGE,
+  CONSENSUS_BLOCK_FALLBACK,
+  CONSENSUS_BLOCK_OTHER
+};
+
+/// Timed intervals of a consensus session.
+///
+/// Leader phases run from the end of the previous phase (the announcement for
+/// the first one) to the named event. Backup phases measure how long the
+/// backup waited for the leader after sending its own message.
+enum ConsensusPhase : uint8_t {
+  PHASE_COMMIT_QUORUM = 0,
+  PHASE_CHALLENGE,
+  PHASE_RESPONSE_QUORUM,
+  PHASE_COLLECTIVESIG,
+  PHASE_FINALCOMMIT_QUORUM,
+  PHASE_FINALCHALLENGE,
+  PHASE_FINALRESPONSE_QUORUM,
+  PHASE_FINALCOLLECTIVESIG,
+  PHASE_BACKUP_CHALLENGE_WAIT,
+  PHASE_BACKUP_COLLECTIVESIG_WAIT,
+  PHASE_BACKUP_FINALCHALLENGE_WAIT,
+  PHASE_BACKUP_FINALCOLLECTIVESIG_WAIT
+};
+
+struct ConsensusPhaseStats {
+  /// Bucket i counts durations below 2^i ms; the last bucket is unbounded
+  static const unsigned int NUM_BUCKETS = 20;
+
+  ConsensusBlockType m_blockType;
+  ConsensusPhase m_phase;
+  uint16_t m_subsetID;
+  uint32_t m_lastConsensusID;
+  uint64_t m_count;
+  uint64_t m_totalInMicroseconds;
+  uint64_t m_maxInMicroseconds;
+  std::array<uint64_t, NUM_BUCKETS> m_buckets;
+};
+
+/// Per-phase latency histograms of all consensus sessions on this node.
+///
+/// Histograms are kept per block type, phase and consensus subset. If a trace
+/// file is configured, every sample is also appended to it as a fixed-size
+/// big-endian record: timestamp (8 bytes, microseconds since epoch),
+/// consensus ID (4), duration in microseconds (4), subset ID (2), block type
+/// (1) and phase (1).
+class ConsensusTrace {
+  using Key = std::tuple<uint8_t, uint8_t, uint16_t>;
+
+  std::mutex m_mutex;
+  std::map<Key, ConsensusPhaseStats> m_stats;
+  std::ofstream m_traceFile;
+
+  ConsensusTrace();
+  ~ConsensusTrace();
+
+  ConsensusTrace(ConsensusTrace const&) = delete;
+  void operator=(ConsensusTrace const&) = delete;
+
+ public:
+  static const unsigned int RECORD_SIZE = 20;
+
+  /// Returns the singleton instance.
+  static ConsensusTrace& GetInstance();
+
+  /// Maps the class and instruction bytes of a consensus object to its block
+  /// type
+  static ConsensusBlockType GetBlockType(unsigned char classByte,
+                                         unsigned char insByte);
+
+  static const char* GetBlockTypeName(ConsensusBlockType blockType);
+  static const char* GetPhaseName(ConsensusPhase phase);
+
+  /// Adds one phase duration sample
+  void Record(uint32_t consensusID, ConsensusBlockType blockType,
+              uint16_t subsetID, ConsensusPhase phase,
+              uint64_t durationInMicroseconds);
+
+  /// Returns the histograms that have at least one sample
+  std::vector<ConsensusPhaseStats> GetStats();
+};
+
+#endif  // __CONSENSUSTRACE_H__
@@ -62,10 +62,9 @@ bool ConsensusUser::ProcessSetLeader(const bytes& message, unsigned int offset,
   peerstore.AddPeerPair(m_selfKey.second,
                         Peer());  // Add myself, but with dummy IP info
 
-  vector<pair<PubKey, Peer>> tmp = peerstore.GetAllPeerPairs();
-  deque<pair<PubKey, Peer>> peerList(tmp.size());
-  copy(tmp.begin(), tmp.end(),
-       peerList.begin());                  // This will be sorted by PubKey
+  // This will be sorted by PubKey
+  const auto tmp = peerstore.GetPeerPairsSnapshot();
+  deque<pair<PubKey, Peer>> peerList(tmp->begin(), tmp->end());
   peerstore.RemovePeer(m_selfKey.second);  // Remove myself
 
   // Now I need to find my index in the sorted list (this will be my ID for the
@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "CommitPool.h"
+#include "common/Constants.h"
+#include "libUtils/Logger.h"
+
+using namespace std;
+
+CommitPool::CommitPool(unsigned int poolSize) : m_poolSize(poolSize) {
+  if (m_poolSize > 0) {
+    m_thread = thread([this]() { Run(); });
+  }
+}
+
+CommitPool::~CommitPool() {
+  {
+    lock_guard<mutex> g(m_mutexPool);
+    m_stop = true;
+  }
+  m_cvPool.notify_all();
+  if (m_thread.joinable()) {
+    m_thread.join();
+  }
+}
+
+CommitPool& CommitPool::GetInstance() {
+  static CommitPool pool(COMMIT_POOL_SIZE);
+  return pool;
+}
+
+CommitPool::Commit CommitPool::Generate() {
+  auto secret = make_shared<CommitSecret>();
+  auto point = make_shared<CommitPoint>(*secret);
+  return make_pair(move(secret), move(point));
+}
+
+void CommitPool::Run() {
+  while (true) {
+    {
+      unique_lock<mutex> g(m_mutexPool);
+      m_cvPool.wait(
+          g, [this]() { return m_stop || (m_pool.size() < m_poolSize); });
+      if (m_stop) {
+        return;
+      }
+    }
+
+    // The scalar multiplication runs outside the lock, so Take never waits
+    // on it
+    Commit commit = Generate();
+    if (!commit.first->Initialized() || !commit.second->Initialized()) {
+      LOG_GENERAL(WARNING, "Failed to generate a pooled commit");
+      continue;
+    }
+
+    {
+      lock_guard<mutex> g(m_mutexPool);
+      m_pool.emplace_back(move(commit));
+    }
+    m_cvFull.notify_all();
+  }
+}
+
+CommitPool::Commit CommitPool::Take() {
+  {
+    lock_guard<mutex> g(m_mutexPool);
+    if (!m_pool.empty()) {
+      Commit commit = move(m_pool.front());
+      m_pool.pop_front();
+      m_hits++;
+      m_cvPool.notify_one();
+      return commit;
+    }
+    m_misses++;
+  }
+
+  if (m_poolSize > 0) {
+    LOG_GENERAL(INFO, "Commit pool empty, generating a commit inline");
+  }
+  return Generate();
+}
+
+void CommitPool::WaitUntilFull() {
+  unique_lock<mutex> g(m_mutexPool);
+  m_cvFull.wait(g, [this]() { return m_pool.size() >= m_poolSize; });
+}
+
+CommitPool::Stats CommitPool::GetStats() {
+  lock_guard<mutex> g(m_mutexPool);
+  Stats stats;
+  stats.m_ready = m_pool.size();
+  stats.m_hits = m_hits;
+  stats.m_misses = m_misses;
+  return stats;
+}
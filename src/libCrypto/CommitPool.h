@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __COMMITPOOL_H__
+#define __COMMITPOOL_H__
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include "MultiSig.h"
+
+/// Commit secrets and their points, generated ahead of the consensus rounds
+/// that use them.
+///
+/// A CommitPoint costs a scalar multiplication, which ConsensusLeader and
+/// ConsensusBackup would otherwise pay on the critical path of each round.
+/// A background thread keeps up to poolSize pairs ready and tops the pool up
+/// as soon as one is taken. Each pair is handed out once and then dropped by
+/// the pool, as reusing a secret across two signatures leaks the private key.
+/// Take falls back to generating a pair inline when the pool is empty or
+/// sized 0.
+class CommitPool {
+ public:
+  using Commit =
+      std::pair<std::shared_ptr<CommitSecret>, std::shared_ptr<CommitPoint>>;
+
+  struct Stats {
+    /// Pairs ready to be taken
+    uint64_t m_ready = 0;
+    /// Taken from the pool
+    uint64_t m_hits = 0;
+    /// Generated inline because the pool was empty
+    uint64_t m_misses = 0;
+  };
+
+ private:
+  const unsigned int m_poolSize;
+
+  std::mutex m_mutexPool;
+  std::condition_variable m_cvPool;
+  /// Signalled each time a pair is added, for WaitUntilFull
+  std::condition_variable m_cvFull;
+  std::deque<Commit> m_pool;
+  uint64_t m_hits = 0;
+  uint64_t m_misses = 0;
+  bool m_stop = false;
+
+  std::thread m_thread;
+
+  CommitPool(CommitPool const&) = delete;
+  void operator=(CommitPool const&) = delete;
+
+  static Commit Generate();
+
+  void Run();
+
+ public:
+  /// Keeps up to poolSize pairs ready; 0 generates every pair inline
+  explicit CommitPool(unsigned int poolSize);
+
+  /// Stops the background thread and drops the pairs not taken
+  ~CommitPool();
+
+  /// Returns the pool sized by COMMIT_POOL_SIZE.
+  static CommitPool& GetInstance();
+
+  /// Returns a fresh secret and its point, never returned before.
+  Commit Take();
+
+  /// Waits until the pool is full, for tests and start-up
+  void WaitUntilFull();
+
+  Stats GetStats();
+};
+
+#endif  // __COMMITPOOL_H__
@@ -0,0 +1,47 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+
+#include "CommitteeKeyCache.h"
+#include "libUtils/Logger.h"
+
+using namespace std;
+
+shared_ptr<PubKey> CommitteeKeyCache::AggregateLocked(
+    const vector<bool>& bitmap) {
+  if (m_committeeKey == nullptr) {
+    LOG_GENERAL(WARNING, "Committee key aggregation failed");
+    return nullptr;
+  }
+
+  const size_t numPresent = count(bitmap.begin(), bitmap.end(), true);
+
+  // Sum whichever side needs fewer point additions
+  const bool sumPresent = (numPresent <= bitmap.size() - numPresent);
+
+  vector<PubKey> keys;
+  keys.reserve(sumPresent ? numPresent : bitmap.size() - numPresent);
+  for (unsigned int i = 0; i < bitmap.size(); i++) {
+    if (bitmap.at(i) == sumPresent) {
+      keys.emplace_back(m_keys.at(i));
+    }
+  }
+
+  return sumPresent ? MultiSig::AggregatePubKeys(keys)
+                    : MultiSig::SubtractPubKeys(*m_committeeKey, keys);
+}
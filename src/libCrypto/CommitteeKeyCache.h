@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __COMMITTEEKEYCACHE_H__
+#define __COMMITTEEKEYCACHE_H__
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "MultiSig.h"
+
+/// Aggregate public key of a whole committee, kept between co-signature
+/// checks.
+///
+/// A co-signature is produced by at least two thirds of a committee, so the
+/// key of the signers is derived as the committee aggregate minus the keys
+/// missing from the bitmap. That is a few point operations instead of one
+/// addition per signer. The cache compares the committee it is given against
+/// the one it was built from and rebuilds on any difference, so callers need
+/// not track committee changes.
+class CommitteeKeyCache {
+  std::mutex m_mutex;
+  std::vector<PubKey> m_keys;
+  std::shared_ptr<PubKey> m_committeeKey;
+
+  CommitteeKeyCache(CommitteeKeyCache const&) = delete;
+  void operator=(CommitteeKeyCache const&) = delete;
+
+  template <class Container, class GetKey>
+  bool IsCachedLocked(const Container& committee, GetKey getKey) const {
+    if ((m_committeeKey == nullptr) || (committee.size() != m_keys.size())) {
+      return false;
+    }
+
+    unsigned int index = 0;
+    for (const auto& member : committee) {
+      if (!(getKey(member) == m_keys.at(index++))) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  std::shared_ptr<PubKey> AggregateLocked(const std::vector<bool>& bitmap);
+
+ public:
+  CommitteeKeyCache() = default;
+
+  /// Returns the aggregated key of the committee members set in bitmap, or
+  /// nullptr if it cannot be built. getKey returns the PubKey of a committee
+  /// entry.
+  template <class Container, class GetKey>
+  std::shared_ptr<PubKey> Aggregate(const Container& committee, GetKey getKey,
+                                    const std::vector<bool>& bitmap) {
+    if (committee.size() != bitmap.size()) {
+      return nullptr;
+    }
+
+    std::lock_guard<std::mutex> g(m_mutex);
+
+    if (!IsCachedLocked(committee, getKey)) {
+      m_keys.clear();
+      m_keys.reserve(committee.size());
+      for (const auto& member : committee) {
+        m_keys.emplace_back(getKey(member));
+      }
+      m_committeeKey = MultiSig::AggregatePubKeys(m_keys);
+    }
+
+    return AggregateLocked(bitmap);
+  }
+};
+
+#endif  // __COMMITTEEKEYCACHE_H__
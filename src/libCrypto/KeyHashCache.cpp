@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "KeyHashCache.h"
+#include "Sha2.h"
+#include "common/Constants.h"
+
+using namespace std;
+
+KeyHashCache::KeyHashCache(size_t capacity)
+    : m_shardCapacity((capacity + NUM_SHARDS - 1) / NUM_SHARDS) {
+  for (unsigned int i = 0; i < NUM_SHARDS; i++) {
+    m_shards.emplace_back(make_unique<Shard>());
+  }
+}
+
+KeyHashCache& KeyHashCache::GetInstance() {
+  static KeyHashCache cache(KEY_HASH_CACHE_SIZE);
+  return cache;
+}
+
+KeyHashCache::Shard& KeyHashCache::GetShard(const string& key) {
+  return *m_shards[std::hash<string>{}(key) % m_shards.size()];
+}
+
+dev::h256 KeyHashCache::Get(const string& key) {
+  Shard& shard = GetShard(key);
+
+  if (m_shardCapacity > 0) {
+    lock_guard<mutex> g(shard.m_mutex);
+    auto it = shard.m_index.find(key);
+    if (it != shard.m_index.end()) {
+      shard.m_lru.splice(shard.m_lru.begin(), shard.m_lru, it->second);
+      m_hits++;
+      return it->second->second;
+    }
+  }
+
+  // Hashed outside the lock, a racing miss on the same key only repeats it
+  SHA2<HASH_TYPE::HASH_VARIANT_256> sha2;
+  sha2.Update(reinterpret_cast<const unsigned char*>(key.data()), key.size());
+  const dev::h256 hash(sha2.Finalize());
+  m_misses++;
+
+  if (m_shardCapacity == 0) {
+    return hash;
+  }
+
+  lock_guard<mutex> g(shard.m_mutex);
+  if (shard.m_index.count(key) > 0) {
+    return hash;
+  }
+  shard.m_lru.emplace_front(key, hash);
+  shard.m_index.emplace(key, shard.m_lru.begin());
+  if (shard.m_lru.size() > m_shardCapacity) {
+    shard.m_index.erase(shard.m_lru.back().first);
+    shard.m_lru.pop_back();
+  }
+
+  return hash;
+}
+
+KeyHashCache::Stats KeyHashCache::GetStats() const {
+  return {m_hits.load(), m_misses.load()};
+}
+
+void KeyHashCache::Clear() {
+  for (auto& shard : m_shards) {
+    lock_guard<mutex> g(shard->m_mutex);
+    shard->m_lru.clear();
+    shard->m_index.clear();
+  }
+}
@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __KEYHASHCACHE_H__
+#define __KEYHASHCACHE_H__
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "depends/common/FixedHash.h"
+
+/// SHA-256 digests of contract state keys, kept so that hot keys are hashed
+/// once.
+///
+/// Account::GetKeyHash and the contract storage indexes hash the same few
+/// keys of popular contracts on every read and write. A key maps to the
+/// digest of its bytes, whoever asks, so one cache serves all of them. It
+/// holds up to a fixed number of entries, spread over shards with their own
+/// lock and least recently used list.
+class KeyHashCache {
+ public:
+  struct Stats {
+    uint64_t m_hits;
+    uint64_t m_misses;
+  };
+
+ private:
+  static const unsigned int NUM_SHARDS = 16;
+
+  using Entry = std::pair<std::string, dev::h256>;
+
+  struct Shard {
+    std::mutex m_mutex;
+    std::list<Entry> m_lru;
+    std::unordered_map<std::string, std::list<Entry>::iterator> m_index;
+  };
+
+  std::vector<std::unique_ptr<Shard>> m_shards;
+  size_t m_shardCapacity;
+
+  std::atomic<uint64_t> m_hits{0};
+  std::atomic<uint64_t> m_misses{0};
+
+  KeyHashCache(KeyHashCache const&) = delete;
+  void operator=(KeyHashCache const&) = delete;
+
+  Shard& GetShard(const std::string& key);
+
+ public:
+  /// Keeps up to capacity digests; 0 hashes every key
+  explicit KeyHashCache(size_t capacity);
+
+  /// Returns the cache sized by KEY_HASH_CACHE_SIZE.
+  static KeyHashCache& GetInstance();
+
+  /// Returns the SHA-256 of key
+  dev::h256 Get(const std::string& key);
+
+  Stats GetStats() const;
+
+  void Clear();
+};
+
+#endif  // __KEYHASHCACHE_H__
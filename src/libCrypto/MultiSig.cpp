@@ -16,8 +16,12 @@
  */
 
 #include "MultiSig.h"
+#include "PubKeyTable.h"
 #include "Sha2.h"
 #include "libUtils/Logger.h"
+#ifdef USE_SECP256K1
+#include "Secp256k1Backend.h"
+#endif  // USE_SECP256K1
 
 using namespace std;
 
@@ -679,13 +683,26 @@ MultiSig& MultiSig::GetInstance() {
 }
 
 shared_ptr<PubKey> MultiSig::AggregatePubKeys(const vector<PubKey>& pubkeys) {
-  const Curve& curve = Schnorr::GetInstance().GetCurve();
-
   if (pubkeys.size() == 0) {
     LOG_GENERAL(WARNING, "Empty list of public keys");
     return nullptr;
   }
 
+#ifdef USE_SECP256K1
+  bytes aggregated;
+  if (!Secp256k1Backend::GetInstance().AggregatePubKeys(pubkeys, aggregated)) {
+    LOG_GENERAL(WARNING, "Pubkey aggregation failed");
+    return nullptr;
+  }
+
+  shared_ptr<PubKey> aggregatedPubkey(new PubKey(aggregated, 0));
+  if (!aggregatedPubkey->Initialized()) {
+    LOG_GENERAL(WARNING, "Aggregated pubkey decoding failed");
+    return nullptr;
+  }
+#else
+  const Curve& curve = Schnorr::GetInstance().GetCurve();
+
   shared_ptr<PubKey> aggregatedPubkey(new PubKey(pubkeys.at(0)));
   if (aggregatedPubkey == nullptr) {
     LOG_GENERAL(WARNING, "Memory allocation failure");
@@ -702,9 +719,64 @@ shared_ptr<PubKey> MultiSig::AggregatePubKeys(const vector<PubKey>& pubkeys) {
     }
   }
 
+  if (!aggregatedPubkey->CacheCompressed()) {
+    LOG_GENERAL(WARNING, "Aggregated pubkey encoding failed");
+    return nullptr;
+  }
+#endif  // USE_SECP256K1
+
   return aggregatedPubkey;
 }
 
+shared_ptr<PubKey> MultiSig::SubtractPubKeys(const PubKey& aggregate,
+                                             const vector<PubKey>& pubkeys) {
+  if (!aggregate.Initialized()) {
+    LOG_GENERAL(WARNING, "Aggregated key not initialized");
+    return nullptr;
+  }
+
+  if (pubkeys.empty()) {
+    return make_shared<PubKey>(aggregate);
+  }
+
+#ifdef USE_SECP256K1
+  bytes difference;
+  if (!Secp256k1Backend::GetInstance().SubtractPubKeys(aggregate, pubkeys,
+                                                       difference)) {
+    LOG_GENERAL(WARNING, "Pubkey subtraction failed");
+    return nullptr;
+  }
+
+  shared_ptr<PubKey> result(new PubKey(difference, 0));
+  if (!result->Initialized()) {
+    LOG_GENERAL(WARNING, "Subtracted pubkey decoding failed");
+    return nullptr;
+  }
+#else
+  const Curve& curve = Schnorr::GetInstance().GetCurve();
+
+  shared_ptr<PubKey> sum = AggregatePubKeys(pubkeys);
+  if (sum == nullptr) {
+    return nullptr;
+  }
+
+  shared_ptr<PubKey> result(new PubKey(aggregate));
+  if ((EC_POINT_invert(curve.m_group.get(), sum->m_P.get(), NULL) == 0) ||
+      (EC_POINT_add(curve.m_group.get(), result->m_P.get(),
+                    result->m_P.get(), sum->m_P.get(), NULL) == 0)) {
+    LOG_GENERAL(WARNING, "Pubkey subtraction failed");
+    return nullptr;
+  }
+
+  if (!result->CacheCompressed()) {
+    LOG_GENERAL(WARNING, "Subtracted pubkey encoding failed");
+    return nullptr;
+  }
+#endif  // USE_SECP256K1
+
+  return result;
+}
+
 shared_ptr<CommitPoint> MultiSig::AggregateCommits(
     const vector<CommitPoint>& commitPoints) {
   const Curve& curve = Schnorr::GetInstance().GetCurve();
@@ -850,10 +922,33 @@ bool MultiSig::VerifyResponse(const Response& response,
         return false;
       }
 
-      // 2. Compute Q = sG + r*kpub
-      err =
-          (EC_POINT_mul(curve.m_group.get(), Q.get(), response.m_r.get(),
-                        pubkey.m_P.get(), challenge.m_c.get(), ctx.get()) == 0);
+#ifdef USE_SECP256K1
+      // 2. Compute Q = sG + r*kpub, as octets
+      bytes regenerated, committed(Schnorr::PUBKEY_COMPRESSED_SIZE_BYTES);
+      if (!Secp256k1Backend::GetInstance().ComputeCommit(
+              response.m_r.get(), challenge.m_c.get(), pubkey, regenerated)) {
+        LOG_GENERAL(WARNING, "Commit regenerate failed");
+        return false;
+      }
+
+      // 3. Q == commitPoint
+      err = (EC_POINT_point2oct(curve.m_group.get(), commitPoint.m_p.get(),
+                                POINT_CONVERSION_COMPRESSED, committed.data(),
+                                committed.size(), ctx.get()) !=
+             committed.size()) ||
+            (regenerated != committed);
+#else
+      // 2. Compute Q = sG + r*kpub, from the committee key table if any
+      const auto table = PubKeyTableCache::GetInstance().Get(pubkey);
+      if (table != nullptr) {
+        err = !PubKeyTable::MultiplyAdd(
+            PubKeyTableCache::GetInstance().GetGenerator(), response.m_r.get(),
+            *table, challenge.m_c.get(), Q.get(), ctx.get());
+      } else {
+        err = (EC_POINT_mul(curve.m_group.get(), Q.get(), response.m_r.get(),
+                            pubkey.m_P.get(), challenge.m_c.get(),
+                            ctx.get()) == 0);
+      }
       if (err) {
         LOG_GENERAL(WARNING, "Commit regenerate failed");
         return false;
@@ -862,6 +957,7 @@ bool MultiSig::VerifyResponse(const Response& response,
       // 3. Q == commitPoint
       err = (EC_POINT_cmp(curve.m_group.get(), Q.get(), commitPoint.m_p.get(),
                           ctx.get()) != 0);
+#endif  // USE_SECP256K1
       if (err) {
         LOG_GENERAL(WARNING,
                     "Generated commit point doesn't match the "
@@ -906,9 +1002,8 @@ bool MultiSig::MultiSigVerify(const bytes& message, const Signature& toverify,
 bool MultiSig::MultiSigVerify(const bytes& message, unsigned int offset,
                               unsigned int size, const Signature& toverify,
                               const PubKey& pubkey) {
-  // This mutex is to prevent multi-threaded issues with the use of openssl
-  // functions
-  lock_guard<mutex> g(m_mutexMultiSigVerify);
+  // All OpenSSL state below is local, and the curve is only read, so
+  // co-signatures of different committees can be checked concurrently
 
   // Initial checks
   if (message.size() == 0) {
@@ -991,6 +1086,24 @@ bool MultiSig::MultiSigVerify(const bytes& message, unsigned int offset,
         return false;
       }
 
+#ifdef USE_SECP256K1
+      // 2. Compute Q = sG + r*kpub, already as octets
+      // 3. The backend fails if Q = O (the neutral point)
+      err2 = !Secp256k1Backend::GetInstance().ComputeCommit(
+          toverify.m_s.get(), toverify.m_r.get(), pubkey, buf);
+      err = err || err2;
+      if (err2) {
+        LOG_GENERAL(WARNING, "Commit regenerate failed");
+        return false;
+      }
+
+      // 4. r' = H(Q, kpub, m)
+      sha2.Update(buf);
+
+      // 4.2 The public key octets are cached in the key
+      copy(pubkey.m_compressed.begin(), pubkey.m_compressed.end(),
+           buf.begin());
+#else
       // 2. Compute Q = sG + r*kpub
       err2 =
           (EC_POINT_mul(curve.m_group.get(), Q.get(), toverify.m_s.get(),
@@ -1037,6 +1150,7 @@ bool MultiSig::MultiSigVerify(const bytes& message, unsigned int offset,
         LOG_GENERAL(WARNING, "Pubkey octet conversion failed");
         return false;
       }
+#endif  // USE_SECP256K1
 
       // Hash public key
       sha2.Update(buf);
@@ -1055,7 +1169,7 @@ bool MultiSig::MultiSigVerify(const bytes& message, unsigned int offset,
       }
 
       err2 = (BN_nnmod(challenge_built.get(), challenge_built.get(),
-                       curve.m_order.get(), NULL) == 0);
+                       curve.m_order.get(), ctx.get()) == 0);
       err = err || err2;
       if (err2) {
         LOG_GENERAL(WARNING, "Challenge rebuild mod failed");
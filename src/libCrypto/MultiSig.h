@@ -261,8 +261,6 @@ class MultiSig {
   MultiSig(MultiSig const&) = delete;
   void operator=(MultiSig const&) = delete;
 
-  std::mutex m_mutexMultiSigVerify;
-
  public:
   /// Returns a MultiSig instance.
   static MultiSig& GetInstance();
@@ -271,6 +269,11 @@ class MultiSig {
   static std::shared_ptr<PubKey> AggregatePubKeys(
       const std::vector<PubKey>& pubkeys);
 
+  /// Returns aggregate minus the sum of pubkeys. Used to derive the key of a
+  /// large subset of a committee from the aggregate of the whole committee.
+  static std::shared_ptr<PubKey> SubtractPubKeys(
+      const PubKey& aggregate, const std::vector<PubKey>& pubkeys);
+
   /// Aggregates the received commitments for the multisignature aggregator.
   static std::shared_ptr<CommitPoint> AggregateCommits(
       const std::vector<CommitPoint>& commitPoints);
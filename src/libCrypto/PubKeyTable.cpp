@@ -0,0 +1,229 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "PubKeyTable.h"
+#include "libUtils/Logger.h"
+
+using namespace std;
+
+PubKeyTable::PubKeyTable(const EC_POINT* base) : m_initialized(false) {
+  const EC_GROUP* group = Schnorr::GetInstance().GetCurve().m_group.get();
+
+  unique_ptr<BN_CTX, void (*)(BN_CTX*)> ctx(BN_CTX_new(), BN_CTX_free);
+  if (ctx == nullptr) {
+    LOG_GENERAL(WARNING, "Memory allocation failure");
+    return;
+  }
+
+  if ((base == nullptr) || EC_POINT_is_at_infinity(group, base)) {
+    LOG_GENERAL(WARNING, "Invalid table base");
+    return;
+  }
+
+  const unsigned int size = 1 << TEETH;
+  vector<EC_POINT*> points;
+  m_points.resize(size);
+  for (unsigned int j = 1; j < size; j++) {
+    m_points.at(j).reset(EC_POINT_new(group), EC_POINT_free);
+    if (m_points.at(j) == nullptr) {
+      LOG_GENERAL(WARNING, "Memory allocation failure");
+      return;
+    }
+    points.emplace_back(m_points.at(j).get());
+  }
+
+  // Teeth: entry 2^i holds 2^(i * SPACING) * base
+  if (EC_POINT_copy(m_points.at(1).get(), base) == 0) {
+    LOG_GENERAL(WARNING, "Table base copy failed");
+    return;
+  }
+  for (unsigned int i = 1; i < TEETH; i++) {
+    EC_POINT* tooth = m_points.at(1 << i).get();
+    if (EC_POINT_copy(tooth, m_points.at(1 << (i - 1)).get()) == 0) {
+      LOG_GENERAL(WARNING, "Table tooth copy failed");
+      return;
+    }
+    for (unsigned int k = 0; k < SPACING; k++) {
+      if (EC_POINT_dbl(group, tooth, tooth, ctx.get()) == 0) {
+        LOG_GENERAL(WARNING, "Table tooth doubling failed");
+        return;
+      }
+    }
+  }
+
+  // Combinations: entry j is the sum of the teeth set in j
+  for (unsigned int j = 3; j < size; j++) {
+    const unsigned int low = j & (~j + 1);
+    if (low == j) {
+      continue;
+    }
+    if (EC_POINT_add(group, m_points.at(j).get(), m_points.at(j - low).get(),
+                     m_points.at(low).get(), ctx.get()) == 0) {
+      LOG_GENERAL(WARNING, "Table combination failed");
+      return;
+    }
+  }
+
+  // Affine entries make every addition in MultiplyAdd a mixed one
+  if (EC_POINTs_make_affine(group, points.size(), points.data(), ctx.get()) ==
+      0) {
+    LOG_GENERAL(WARNING, "Table normalization failed");
+    return;
+  }
+
+  m_initialized = true;
+}
+
+bool PubKeyTable::Initialized() const { return m_initialized; }
+
+unsigned int PubKeyTable::GetColumn(const BIGNUM* k, unsigned int column) {
+  unsigned int index = 0;
+  for (unsigned int i = 0; i < TEETH; i++) {
+    if (BN_is_bit_set(k, i * SPACING + column)) {
+      index |= 1 << i;
+    }
+  }
+  return index;
+}
+
+bool PubKeyTable::MultiplyAdd(const PubKeyTable& tableP, const BIGNUM* a,
+                              const PubKeyTable& tableQ, const BIGNUM* b,
+                              EC_POINT* result, BN_CTX* ctx) {
+  if (!tableP.Initialized() || !tableQ.Initialized()) {
+    LOG_GENERAL(WARNING, "Table not initialized");
+    return false;
+  }
+
+  const int maxBits = TEETH * SPACING;
+  if (BN_is_negative(a) || BN_is_negative(b) || (BN_num_bits(a) > maxBits) ||
+      (BN_num_bits(b) > maxBits)) {
+    LOG_GENERAL(WARNING, "Scalar out of table range");
+    return false;
+  }
+
+  const EC_GROUP* group = Schnorr::GetInstance().GetCurve().m_group.get();
+
+  if (EC_POINT_set_to_infinity(group, result) == 0) {
+    return false;
+  }
+
+  for (unsigned int column = SPACING; column-- > 0;) {
+    if (EC_POINT_dbl(group, result, result, ctx) == 0) {
+      return false;
+    }
+
+    const unsigned int indexP = GetColumn(a, column);
+    if ((indexP != 0) &&
+        (EC_POINT_add(group, result, result, tableP.m_points[indexP].get(),
+                      ctx) == 0)) {
+      return false;
+    }
+
+    const unsigned int indexQ = GetColumn(b, column);
+    if ((indexQ != 0) &&
+        (EC_POINT_add(group, result, result, tableQ.m_points[indexQ].get(),
+                      ctx) == 0)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+PubKeyTableCache::PubKeyTableCache()
+    : m_generator(new PubKeyTable(EC_GROUP_get0_generator(
+          Schnorr::GetInstance().GetCurve().m_group.get()))) {}
+
+PubKeyTableCache& PubKeyTableCache::GetInstance() {
+  static PubKeyTableCache cache;
+  return cache;
+}
+
+const PubKeyTable& PubKeyTableCache::GetGenerator() const {
+  return *m_generator;
+}
+
+#ifdef USE_SECP256K1
+void PubKeyTableCache::Prepare([[gnu::unused]] PubKeyTableGroup group,
+                               [[gnu::unused]] const vector<PubKey>& keys) {}
+#else
+void PubKeyTableCache::Prepare(PubKeyTableGroup group,
+                               const vector<PubKey>& keys) {
+  vector<PubKey> missing;
+  {
+    lock_guard<mutex> g(m_mutex);
+    for (const auto& key : keys) {
+      if (m_tables.find(key) == m_tables.end()) {
+        missing.emplace_back(key);
+      }
+    }
+  }
+
+  // Build outside the lock so verification can carry on meanwhile
+  vector<pair<PubKey, shared_ptr<const PubKeyTable>>> built;
+  for (const auto& key : missing) {
+    if (!key.Initialized()) {
+      continue;
+    }
+    auto table = make_shared<const PubKeyTable>(key.m_P.get());
+    if (!table->Initialized()) {
+      LOG_GENERAL(WARNING, "Failed to build table for " << key);
+      continue;
+    }
+    built.emplace_back(key, move(table));
+  }
+
+  lock_guard<mutex> g(m_mutex);
+
+  for (auto& entry : m_tables) {
+    entry.second.m_groups &= ~group;
+  }
+  for (auto& table : built) {
+    m_tables.emplace(table.first, Entry{move(table.second), 0});
+  }
+  for (const auto& key : keys) {
+    auto it = m_tables.find(key);
+    if (it != m_tables.end()) {
+      it->second.m_groups |= group;
+    }
+  }
+
+  for (auto it = m_tables.begin(); it != m_tables.end();) {
+    if (it->second.m_groups == 0) {
+      it = m_tables.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  LOG_GENERAL(INFO, "Built " << built.size() << " key tables, "
+                             << m_tables.size() << " held");
+}
+#endif  // USE_SECP256K1
+
+shared_ptr<const PubKeyTable> PubKeyTableCache::Get(
+    const PubKey& pubkey) const {
+  lock_guard<mutex> g(m_mutex);
+  auto it = m_tables.find(pubkey);
+  return (it == m_tables.end()) ? nullptr : it->second.m_table;
+}
+
+size_t PubKeyTableCache::Size() const {
+  lock_guard<mutex> g(m_mutex);
+  return m_tables.size();
+}
@@ -0,0 +1,112 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef __PUBKEYTABLE_H__
+#define __PUBKEYTABLE_H__
+
+#include <openssl/bn.h>
+#include <openssl/ec.h>
+
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "Schnorr.h"
+
+/// Fixed-base comb table for one curve point.
+///
+/// Holds the 2^TEETH - 1 combinations of the points 2^(i * SPACING) P, so
+/// that a multiple of P costs SPACING doublings and at most SPACING mixed
+/// additions. Building a table is about as expensive as one multiplication,
+/// which pays off for keys used many times, such as those of the committee a
+/// consensus leader checks responses from. Tables are read-only once built
+/// and may be shared across threads.
+class PubKeyTable {
+ public:
+  static const unsigned int TEETH = 6;
+  static const unsigned int SPACING = 43;  // ceil(256 / TEETH)
+
+ private:
+  std::vector<std::shared_ptr<EC_POINT>> m_points;  // Entry 0 is unused
+  bool m_initialized;
+
+  PubKeyTable(PubKeyTable const&) = delete;
+  void operator=(PubKeyTable const&) = delete;
+
+  static unsigned int GetColumn(const BIGNUM* k, unsigned int column);
+
+ public:
+  /// Builds the table for base, which must not be the point at infinity.
+  explicit PubKeyTable(const EC_POINT* base);
+
+  /// Indicates if the table has been built.
+  bool Initialized() const;
+
+  /// Computes result = a * P + b * Q, where P and Q are the bases of tableP
+  /// and tableQ. a and b must be in [0, ..., order-1].
+  static bool MultiplyAdd(const PubKeyTable& tableP, const BIGNUM* a,
+                          const PubKeyTable& tableQ, const BIGNUM* b,
+                          EC_POINT* result, BN_CTX* ctx);
+};
+
+/// Sets of keys PubKeyTableCache keeps tables for.
+enum PubKeyTableGroup : unsigned int {
+  TABLE_GROUP_DS_COMMITTEE = 0x01,
+  TABLE_GROUP_SHARD = 0x02
+};
+
+/// Comb tables of the current committee keys, plus one for the generator.
+///
+/// Prepare() is called once per epoch with the members of a committee.
+/// Tables of keys that stay in a committee are kept, and those of keys that
+/// left every group are dropped. In USE_SECP256K1 builds the multiplications
+/// run on libsecp256k1 instead, so no key tables are built.
+class PubKeyTableCache {
+  struct Entry {
+    std::shared_ptr<const PubKeyTable> m_table;
+    unsigned int m_groups;
+  };
+
+  mutable std::mutex m_mutex;
+  std::unordered_map<PubKey, Entry> m_tables;
+  std::unique_ptr<PubKeyTable> m_generator;
+
+  PubKeyTableCache();
+
+  PubKeyTableCache(PubKeyTableCache const&) = delete;
+  void operator=(PubKeyTableCache const&) = delete;
+
+ public:
+  /// Returns the singleton instance.
+  static PubKeyTableCache& GetInstance();
+
+  /// Returns the table of the curve generator.
+  const PubKeyTable& GetGenerator() const;
+
+  /// Makes keys the members of group, building the missing tables.
+  void Prepare(PubKeyTableGroup group, const std::vector<PubKey>& keys);
+
+  /// Returns the table of pubkey, or nullptr if it has none.
+  std::shared_ptr<const PubKeyTable> Get(const PubKey& pubkey) const;
+
+  /// Number of key tables held.
+  size_t Size() const;
+};
+
+#endif  // __PUBKEYTABLE_H__
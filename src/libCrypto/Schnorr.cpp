@@ -36,6 +36,9 @@
 
 #include "Schnorr.h"
 #include "libUtils/Logger.h"
+#ifdef USE_SECP256K1
+#include "Secp256k1Backend.h"
+#endif  // USE_SECP256K1
 
 using namespace std;
 
@@ -333,7 +336,7 @@ PubKey::PubKey(const PrivKey& privkey)
       return;
     }
 
-    m_initialized = true;
+    m_initialized = CacheCompressed();
   }
 }
 
@@ -358,6 +361,7 @@ PubKey::PubKey(const PubKey& src)
     if (EC_POINT_copy(m_P.get(), src.m_P.get()) != 1) {
       LOG_GENERAL(WARNING, "PubKey copy failed");
     } else {
+      m_compressed = src.m_compressed;
       m_initialized = true;
     }
   }
@@ -367,9 +371,26 @@ PubKey::~PubKey() {}
 
 bool PubKey::Initialized() const { return m_initialized; }
 
+bool PubKey::CacheCompressed() {
+  if ((m_P == nullptr) ||
+      (EC_POINT_point2oct(Schnorr::GetInstance().GetCurve().m_group.get(),
+                          m_P.get(), POINT_CONVERSION_COMPRESSED,
+                          m_compressed.data(), m_compressed.size(),
+                          NULL) != m_compressed.size())) {
+    // Also the case for the point at infinity, which serializes as zeroes
+    m_compressed.fill(0x00);
+    return false;
+  }
+
+  return true;
+}
+
 unsigned int PubKey::Serialize(bytes& dst, unsigned int offset) const {
   if (m_initialized) {
-    ECPOINTSerialize::SetNumber(dst, offset, PUB_KEY_SIZE, m_P);
+    if (offset + PUB_KEY_SIZE > dst.size()) {
+      dst.resize(offset + PUB_KEY_SIZE);
+    }
+    copy(m_compressed.begin(), m_compressed.end(), dst.begin() + offset);
   }
 
   return PUB_KEY_SIZE;
@@ -406,7 +427,7 @@ int PubKey::Deserialize(const bytes& src, unsigned int offset) {
       m_initialized = false;
       return -1;
     } else {
-      m_initialized = true;
+      m_initialized = CacheCompressed();
     }
   } catch (const std::exception& e) {
     LOG_GENERAL(WARNING, "Error with PubKey::Deserialize." << ' ' << e.what());
@@ -418,66 +439,28 @@ int PubKey::Deserialize(const bytes& src, unsigned int offset) {
 PubKey& PubKey::operator=(const PubKey& src) {
   m_initialized =
       src.m_initialized && (EC_POINT_copy(m_P.get(), src.m_P.get()) == 1);
+  m_compressed = src.m_compressed;
   return *this;
 }
 
 bool PubKey::operator<(const PubKey& r) const {
-  unique_ptr<BN_CTX, void (*)(BN_CTX*)> ctx(BN_CTX_new(), BN_CTX_free);
-  if (ctx == nullptr) {
-    LOG_GENERAL(WARNING, "Memory allocation failure");
-    // throw exception();
-    return false;
-  }
-
-  shared_ptr<BIGNUM> lhs_bnvalue(
-      EC_POINT_point2bn(Schnorr::GetInstance().GetCurve().m_group.get(),
-                        m_P.get(), POINT_CONVERSION_COMPRESSED, NULL,
-                        ctx.get()),
-      BN_clear_free);
-  shared_ptr<BIGNUM> rhs_bnvalue(
-      EC_POINT_point2bn(Schnorr::GetInstance().GetCurve().m_group.get(),
-                        r.m_P.get(), POINT_CONVERSION_COMPRESSED, NULL,
-                        ctx.get()),
-      BN_clear_free);
-
+  // The leading parity byte is never zero, so this orders keys the same way
+  // as comparing their encodings as big numbers
   return (m_initialized && r.m_initialized &&
-          (BN_cmp(lhs_bnvalue.get(), rhs_bnvalue.get()) == -1));
+          (memcmp(m_compressed.data(), r.m_compressed.data(),
+                  PUB_KEY_SIZE) < 0));
 }
 
 bool PubKey::operator>(const PubKey& r) const {
-  unique_ptr<BN_CTX, void (*)(BN_CTX*)> ctx(BN_CTX_new(), BN_CTX_free);
-  if (ctx == nullptr) {
-    LOG_GENERAL(WARNING, "Memory allocation failure");
-    // throw exception();
-    return false;
-  }
-
-  shared_ptr<BIGNUM> lhs_bnvalue(
-      EC_POINT_point2bn(Schnorr::GetInstance().GetCurve().m_group.get(),
-                        m_P.get(), POINT_CONVERSION_COMPRESSED, NULL,
-                        ctx.get()),
-      BN_clear_free);
-  shared_ptr<BIGNUM> rhs_bnvalue(
-      EC_POINT_point2bn(Schnorr::GetInstance().GetCurve().m_group.get(),
-                        r.m_P.get(), POINT_CONVERSION_COMPRESSED, NULL,
-                        ctx.get()),
-      BN_clear_free);
-
   return (m_initialized && r.m_initialized &&
-          (BN_cmp(lhs_bnvalue.get(), rhs_bnvalue.get()) == 1));
+          (memcmp(m_compressed.data(), r.m_compressed.data(),
+                  PUB_KEY_SIZE) > 0));
 }
 
 bool PubKey::operator==(const PubKey& r) const {
-  unique_ptr<BN_CTX, void (*)(BN_CTX*)> ctx(BN_CTX_new(), BN_CTX_free);
-  if (ctx == nullptr) {
-    LOG_GENERAL(WARNING, "Memory allocation failure");
-    // throw exception();
-    return false;
-  }
-
   return (m_initialized && r.m_initialized &&
-          (EC_POINT_cmp(Schnorr::GetInstance().GetCurve().m_group.get(),
-                        m_P.get(), r.m_P.get(), ctx.get()) == 0));
+          (memcmp(m_compressed.data(), r.m_compressed.data(),
+                  PUB_KEY_SIZE) == 0));
 }
 
 Signature::Signature()
@@ -682,6 +665,15 @@ bool Schnorr::Sign(const bytes& message, unsigned int offset, unsigned int size,
         }
       } while (BN_is_zero(k.get()));
 
+#ifdef USE_SECP256K1
+      // 2. Compute the commitment Q = kG, already as octets
+      if (!Secp256k1Backend::GetInstance().MultiplyGenerator(k.get(), buf)) {
+        LOG_GENERAL(WARNING, "Commit generation failed");
+        return false;
+      }
+
+      // 3. Compute the challenge r = H(Q, kpub, m)
+#else
       // 2. Compute the commitment Q = kG, where G is the base point
       err = (EC_POINT_mul(m_curve.m_group.get(), Q.get(), k.get(), NULL, NULL,
                           NULL) == 0);
@@ -701,6 +693,7 @@ bool Schnorr::Sign(const bytes& message, unsigned int offset, unsigned int size,
         LOG_GENERAL(WARNING, "Commit octet conversion failed");
         return false;
       }
+#endif  // USE_SECP256K1
 
       // Hash commitment
       sha2.Update(buf);
@@ -789,6 +782,108 @@ bool Schnorr::Verify(const bytes& message, unsigned int offset,
   // functions
   lock_guard<mutex> g(m_mutexSchnorr);
 
+  try {
+    VerifyContext vctx(m_curve);
+    if (!vctx.Initialized()) {
+      LOG_GENERAL(WARNING, "Memory allocation failure");
+      // throw exception();
+      return false;
+    }
+    return VerifyCore(message, offset, size, toverify, pubkey, vctx);
+  } catch (const std::exception& e) {
+    LOG_GENERAL(WARNING, "Error with Schnorr::Verify." << ' ' << e.what());
+    return false;
+  }
+}
+
+bool Schnorr::BatchVerify(const vector<VerifyItem>& items,
+                          vector<bool>& results) {
+  results.assign(items.size(), false);
+
+  if (items.empty()) {
+    return true;
+  }
+
+  // This mutex is to prevent multi-threaded issues with the use of openssl
+  // functions
+  lock_guard<mutex> g(m_mutexSchnorr);
+
+  bool allValid = true;
+
+  try {
+    VerifyContext vctx(m_curve);
+    if (!vctx.Initialized()) {
+      LOG_GENERAL(WARNING, "Memory allocation failure");
+      return false;
+    }
+
+    for (unsigned int i = 0; i < items.size(); i++) {
+      const VerifyItem& item = items.at(i);
+      if ((item.m_message == nullptr) || (item.m_signature == nullptr) ||
+          (item.m_pubkey == nullptr)) {
+        allValid = false;
+        continue;
+      }
+
+      results[i] = VerifyCore(*item.m_message, item.m_offset, item.m_size,
+                              *item.m_signature, *item.m_pubkey, vctx);
+      allValid = allValid && results[i];
+    }
+  } catch (const std::exception& e) {
+    LOG_GENERAL(WARNING, "Error with Schnorr::BatchVerify." << ' ' << e.what());
+    return false;
+  }
+
+  return allValid;
+}
+
+bool Schnorr::VerifyRange(const vector<VerifyItem>& items, size_t begin,
+                          size_t end, vector<unsigned char>& results) {
+  if ((end > items.size()) || (results.size() < items.size())) {
+    LOG_GENERAL(WARNING, "Verify range beyond batch size");
+    return false;
+  }
+
+  bool allValid = true;
+
+  try {
+    // Only read-only curve data is shared between threads
+    thread_local VerifyContext vctx(m_curve);
+    if (!vctx.Initialized()) {
+      LOG_GENERAL(WARNING, "Memory allocation failure");
+      return false;
+    }
+
+    for (size_t i = begin; i < end; i++) {
+      const VerifyItem& item = items.at(i);
+      results[i] = (item.m_message != nullptr) &&
+                   (item.m_signature != nullptr) &&
+                   (item.m_pubkey != nullptr) &&
+                   VerifyCore(*item.m_message, item.m_offset, item.m_size,
+                              *item.m_signature, *item.m_pubkey, vctx);
+      allValid = allValid && results[i];
+    }
+  } catch (const std::exception& e) {
+    LOG_GENERAL(WARNING, "Error with Schnorr::VerifyRange." << ' ' << e.what());
+    return false;
+  }
+
+  return allValid;
+}
+
+Schnorr::VerifyContext::VerifyContext(const Curve& curve)
+    : m_challenge(BN_new(), BN_clear_free),
+      m_Q(EC_POINT_new(curve.m_group.get()), EC_POINT_clear_free),
+      m_ctx(BN_CTX_new(), BN_CTX_free),
+      m_buf(PUBKEY_COMPRESSED_SIZE_BYTES) {}
+
+bool Schnorr::VerifyContext::Initialized() const {
+  return (m_challenge != nullptr) && (m_Q != nullptr) && (m_ctx != nullptr);
+}
+
+bool Schnorr::VerifyCore(const bytes& message, unsigned int offset,
+                         unsigned int size, const Signature& toverify,
+                         const PubKey& pubkey, VerifyContext& vctx) {
   // Initial checks
 
   if (message.size() == 0) {
@@ -811,132 +906,110 @@ bool Schnorr::Verify(const bytes& message, unsigned int offset,
     return false;
   }
 
-  try {
-    // Main verification procedure
-
-    // The algorithm to check the signature (r, s) on a message m using a public
-    // key kpub is as follows
-    // 1. Check if r,s is in [1, ..., order-1]
-    // 2. Compute Q = sG + r*kpub
-    // 3. If Q = O (the neutral point), return 0;
-    // 4. r' = H(Q, kpub, m)
-    // 5. return r' == r
-
-    bytes buf(PUBKEY_COMPRESSED_SIZE_BYTES);
-    SHA2<HASH_TYPE::HASH_VARIANT_256> sha2;
-
-    bool err = false;
-    bool err2 = false;
-
-    // Regenerate the commitmment part of the signature
-    unique_ptr<BIGNUM, void (*)(BIGNUM*)> challenge_built(BN_new(),
-                                                          BN_clear_free);
-    unique_ptr<EC_POINT, void (*)(EC_POINT*)> Q(
-        EC_POINT_new(m_curve.m_group.get()), EC_POINT_clear_free);
-    unique_ptr<BN_CTX, void (*)(BN_CTX*)> ctx(BN_CTX_new(), BN_CTX_free);
+  // Main verification procedure
 
-    if ((challenge_built != nullptr) && (ctx != nullptr) && (Q != nullptr)) {
-      // 1. Check if r,s is in [1, ..., order-1]
-      err2 = (BN_is_zero(toverify.m_r.get()) ||
-              BN_is_negative(toverify.m_r.get()) ||
-              (BN_cmp(toverify.m_r.get(), m_curve.m_order.get()) != -1));
-      err = err || err2;
-      if (err2) {
-        LOG_GENERAL(WARNING, "Challenge not in range");
-        return false;
-      }
+  // The algorithm to check the signature (r, s) on a message m using a public
+  // key kpub is as follows
+  // 1. Check if r,s is in [1, ..., order-1]
+  // 2. Compute Q = sG + r*kpub
+  // 3. If Q = O (the neutral point), return 0;
+  // 4. r' = H(Q, kpub, m)
+  // 5. return r' == r
 
-      err2 = (BN_is_zero(toverify.m_s.get()) ||
-              BN_is_negative(toverify.m_s.get()) ||
-              (BN_cmp(toverify.m_s.get(), m_curve.m_order.get()) != -1));
-      err = err || err2;
-      if (err2) {
-        LOG_GENERAL(WARNING, "Response not in range");
-        return false;
-      }
+  bytes& buf = vctx.m_buf;
+  SHA2<HASH_TYPE::HASH_VARIANT_256> sha2;
 
-      // 2. Compute Q = sG + r*kpub
-      err2 =
-          (EC_POINT_mul(m_curve.m_group.get(), Q.get(), toverify.m_s.get(),
-                        pubkey.m_P.get(), toverify.m_r.get(), ctx.get()) == 0);
-      err = err || err2;
-      if (err2) {
-        LOG_GENERAL(WARNING, "Commit regenerate failed");
-        return false;
-      }
+  BIGNUM* challenge_built = vctx.m_challenge.get();
+  BN_CTX* ctx = vctx.m_ctx.get();
 
-      // 3. If Q = O (the neutral point), return 0;
-      err2 = (EC_POINT_is_at_infinity(m_curve.m_group.get(), Q.get()));
-      err = err || err2;
-      if (err2) {
-        LOG_GENERAL(WARNING, "Commit at infinity");
-        return false;
-      }
+  // 1. Check if r,s is in [1, ..., order-1]
+  if (BN_is_zero(toverify.m_r.get()) || BN_is_negative(toverify.m_r.get()) ||
+      (BN_cmp(toverify.m_r.get(), m_curve.m_order.get()) != -1)) {
+    LOG_GENERAL(WARNING, "Challenge not in range");
+    return false;
+  }
 
-      // 4. r' = H(Q, kpub, m)
-      // 4.1 Convert the committment to octets first
-      err2 = (EC_POINT_point2oct(m_curve.m_group.get(), Q.get(),
-                                 POINT_CONVERSION_COMPRESSED, buf.data(),
-                                 PUBKEY_COMPRESSED_SIZE_BYTES,
-                                 NULL) != PUBKEY_COMPRESSED_SIZE_BYTES);
-      err = err || err2;
-      if (err2) {
-        LOG_GENERAL(WARNING, "Commit octet conversion failed");
-        return false;
-      }
+  if (BN_is_zero(toverify.m_s.get()) || BN_is_negative(toverify.m_s.get()) ||
+      (BN_cmp(toverify.m_s.get(), m_curve.m_order.get()) != -1)) {
+    LOG_GENERAL(WARNING, "Response not in range");
+    return false;
+  }
 
-      // Hash commitment
-      sha2.Update(buf);
+#ifdef USE_SECP256K1
+  // 2. Compute Q = sG + r*kpub, already as octets
+  // 3. The backend fails if Q = O (the neutral point)
+  if (!Secp256k1Backend::GetInstance().ComputeCommit(
+          toverify.m_s.get(), toverify.m_r.get(), pubkey, buf)) {
+    LOG_GENERAL(WARNING, "Commit regenerate failed");
+    return false;
+  }
 
-      // Reset buf
-      fill(buf.begin(), buf.end(), 0x00);
+  // 4. r' = H(Q, kpub, m)
+  sha2.Update(buf);
 
-      // 4.2 Convert the public key to octets
-      err2 = (EC_POINT_point2oct(m_curve.m_group.get(), pubkey.m_P.get(),
-                                 POINT_CONVERSION_COMPRESSED, buf.data(),
-                                 PUBKEY_COMPRESSED_SIZE_BYTES,
-                                 NULL) != PUBKEY_COMPRESSED_SIZE_BYTES);
-      err = err || err2;
-      if (err2) {
-        LOG_GENERAL(WARNING, "Pubkey octet conversion failed");
-        return false;
-      }
+  // 4.2 The public key octets are cached in the key
+  copy(pubkey.m_compressed.begin(), pubkey.m_compressed.end(), buf.begin());
+#else
+  EC_POINT* Q = vctx.m_Q.get();
 
-      // Hash public key
-      sha2.Update(buf);
+  // 2. Compute Q = sG + r*kpub
+  if (EC_POINT_mul(m_curve.m_group.get(), Q, toverify.m_s.get(),
+                   pubkey.m_P.get(), toverify.m_r.get(), ctx) == 0) {
+    LOG_GENERAL(WARNING, "Commit regenerate failed");
+    return false;
+  }
 
-      // 4.3 Hash message
-      sha2.Update(message, offset, size);
-      bytes digest = sha2.Finalize();
+  // 3. If Q = O (the neutral point), return 0;
+  if (EC_POINT_is_at_infinity(m_curve.m_group.get(), Q)) {
+    LOG_GENERAL(WARNING, "Commit at infinity");
+    return false;
+  }
 
-      // 5. return r' == r
-      err2 = (BN_bin2bn(digest.data(), digest.size(), challenge_built.get()) ==
-              NULL);
-      err = err || err2;
-      if (err2) {
-        LOG_GENERAL(WARNING, "Challenge bin2bn conversion failed");
-        return false;
-      }
+  // 4. r' = H(Q, kpub, m)
+  // 4.1 Convert the committment to octets first
+  if (EC_POINT_point2oct(m_curve.m_group.get(), Q, POINT_CONVERSION_COMPRESSED,
+                         buf.data(), PUBKEY_COMPRESSED_SIZE_BYTES,
+                         ctx) != PUBKEY_COMPRESSED_SIZE_BYTES) {
+    LOG_GENERAL(WARNING, "Commit octet conversion failed");
+    return false;
+  }
 
-      err2 = (BN_nnmod(challenge_built.get(), challenge_built.get(),
-                       m_curve.m_order.get(), NULL) == 0);
-      err = err || err2;
-      if (err2) {
-        LOG_GENERAL(WARNING, "Challenge rebuild mod failed");
-        return false;
-      }
+  // Hash commitment
+  sha2.Update(buf);
 
-      sha2.Reset();
-    } else {
-      LOG_GENERAL(WARNING, "Memory allocation failure");
-      // throw exception();
-      return false;
-    }
-    return (!err) && (BN_cmp(challenge_built.get(), toverify.m_r.get()) == 0);
-  } catch (const std::exception& e) {
-    LOG_GENERAL(WARNING, "Error with Schnorr::Verify." << ' ' << e.what());
+  // Reset buf
+  fill(buf.begin(), buf.end(), 0x00);
+
+  // 4.2 Convert the public key to octets
+  if (EC_POINT_point2oct(m_curve.m_group.get(), pubkey.m_P.get(),
+                         POINT_CONVERSION_COMPRESSED, buf.data(),
+                         PUBKEY_COMPRESSED_SIZE_BYTES,
+                         ctx) != PUBKEY_COMPRESSED_SIZE_BYTES) {
+    LOG_GENERAL(WARNING, "Pubkey octet conversion failed");
     return false;
   }
+#endif  // USE_SECP256K1
+
+  // Hash public key
+  sha2.Update(buf);
+
+  // 4.3 Hash message
+  sha2.Update(message, offset, size);
+  bytes digest = sha2.Finalize();
+
+  // 5. return r' == r
+  if (BN_bin2bn(digest.data(), digest.size(), challenge_built) == NULL) {
+    LOG_GENERAL(WARNING, "Challenge bin2bn conversion failed");
+    return false;
+  }
+
+  if (BN_nnmod(challenge_built, challenge_built, m_curve.m_order.get(), ctx) ==
+      0) {
+    LOG_GENERAL(WARNING, "Challenge rebuild mod failed");
+    return false;
+  }
+
+  return (BN_cmp(challenge_built, toverify.m_r.get()) == 0);
 }
 
 void Schnorr::PrintPoint(const EC_POINT* point) {
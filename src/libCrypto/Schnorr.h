@@ -22,6 +22,7 @@
 #include <openssl/ec.h>
 
 #include <array>
+#include <cstring>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -122,6 +123,10 @@ struct PubKey : public Serializable {
   /// Flag to indicate if parameters have been initialized.
   bool m_initialized;
 
+  /// Compressed encoding of m_P, used for serialization, comparisons and
+  /// hashing. Must be refreshed with CacheCompressed() whenever m_P changes.
+  std::array<unsigned char, PUB_KEY_SIZE> m_compressed{};
+
   /// Default constructor for an uninitialized key.
   PubKey();
 
@@ -141,6 +146,9 @@ struct PubKey : public Serializable {
   /// Indicates if key parameters have been initialized.
   bool Initialized() const;
 
+  /// Recomputes m_compressed from m_P.
+  bool CacheCompressed();
+
   /// Implements the Serialize function inherited from Serializable.
   unsigned int Serialize(bytes& dst, unsigned int offset) const;
 
@@ -169,6 +177,19 @@ struct PubKey : public Serializable {
   }
 };
 
+// define its hash function in order to used as key in unordered containers
+namespace std {
+template <>
+struct hash<PubKey> {
+  size_t operator()(PubKey const& key) const noexcept {
+    // Skip the parity byte; the x coordinate is uniformly distributed
+    size_t res;
+    memcpy(&res, key.m_compressed.data() + 1, sizeof(res));
+    return res;
+  }
+};
+}  // namespace std
+
 using PairOfKey = std::pair<PrivKey, PubKey>;
 
 inline std::ostream& operator<<(std::ostream& os, const PubKey& p) {
@@ -243,6 +264,21 @@ inline std::ostream& operator<<(std::ostream& os, const Signature& s) {
 class Schnorr {
   Curve m_curve;
 
+  /// Scratch objects reused across the verifications of one call.
+  struct VerifyContext {
+    std::unique_ptr<BIGNUM, void (*)(BIGNUM*)> m_challenge;
+    std::unique_ptr<EC_POINT, void (*)(EC_POINT*)> m_Q;
+    std::unique_ptr<BN_CTX, void (*)(BN_CTX*)> m_ctx;
+    bytes m_buf;
+
+    explicit VerifyContext(const Curve& curve);
+    bool Initialized() const;
+  };
+
+  bool VerifyCore(const bytes& message, unsigned int offset, unsigned int size,
+                  const Signature& toverify, const PubKey& pubkey,
+                  VerifyContext& vctx);
+
   Schnorr();
   ~Schnorr();
 
@@ -285,6 +321,30 @@ class Schnorr {
   bool Verify(const bytes& message, unsigned int offset, unsigned int size,
               const Signature& toverify, const PubKey& pubkey);
 
+  /// One signature to check in BatchVerify. The referenced objects must
+  /// outlive the call.
+  struct VerifyItem {
+    const bytes* m_message;
+    unsigned int m_offset;
+    unsigned int m_size;
+    const Signature* m_signature;
+    const PubKey* m_pubkey;
+  };
+
+  /// Checks many signatures in one call, taking the lock and setting up the
+  /// OpenSSL context once. results[i] tells whether items[i] is valid.
+  /// Returns true if all of them are.
+  bool BatchVerify(const std::vector<VerifyItem>& items,
+                   std::vector<bool>& results);
+
+  /// Checks items [begin, end) like BatchVerify, but without taking the
+  /// Schnorr lock and with an OpenSSL context kept per calling thread, so
+  /// disjoint ranges of one batch can be checked concurrently. results must
+  /// already hold items.size() entries; only [begin, end) is written.
+  /// Returns true if all items in the range are valid.
+  bool VerifyRange(const std::vector<VerifyItem>& items, size_t begin,
+                   size_t end, std::vector<unsigned char>& results);
+
   /// Utility function for printing EC_POINT coordinates.
   void PrintPoint(const EC_POINT* point);
 };
@@ -0,0 +1,172 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <array>
+
+#include "Secp256k1Backend.h"
+#include "libUtils/Logger.h"
+
+using namespace std;
+
+namespace {
+const unsigned int SCALAR_SIZE = 32;
+
+using Scalar = array<unsigned char, SCALAR_SIZE>;
+
+bool ToScalar(const BIGNUM* bn, Scalar& result) {
+  const int numBytes = BN_num_bytes(bn);
+  if ((numBytes <= 0) || (numBytes > static_cast<int>(SCALAR_SIZE))) {
+    return false;
+  }
+
+  result.fill(0x00);
+  return BN_bn2bin(bn, result.data() + SCALAR_SIZE - numBytes) == numBytes;
+}
+}  // namespace
+
+Secp256k1Backend::Secp256k1Backend()
+    : m_ctx(secp256k1_context_create(SECP256K1_CONTEXT_SIGN |
+                                     SECP256K1_CONTEXT_VERIFY)) {
+  if (m_ctx == nullptr) {
+    LOG_GENERAL(WARNING, "secp256k1 context creation failed");
+  }
+}
+
+Secp256k1Backend::~Secp256k1Backend() {
+  if (m_ctx != nullptr) {
+    secp256k1_context_destroy(m_ctx);
+  }
+}
+
+Secp256k1Backend& Secp256k1Backend::GetInstance() {
+  static Secp256k1Backend backend;
+  return backend;
+}
+
+bool Secp256k1Backend::ParsePubKey(const PubKey& pubkey,
+                                   secp256k1_pubkey& result) const {
+  return pubkey.Initialized() &&
+         (secp256k1_ec_pubkey_parse(m_ctx, &result, pubkey.m_compressed.data(),
+                                    pubkey.m_compressed.size()) == 1);
+}
+
+bool Secp256k1Backend::SerializePoint(const secp256k1_pubkey& point,
+                                      bytes& result) const {
+  size_t size = PUB_KEY_SIZE;
+  result.resize(PUB_KEY_SIZE);
+  return (secp256k1_ec_pubkey_serialize(m_ctx, result.data(), &size, &point,
+                                        SECP256K1_EC_COMPRESSED) == 1) &&
+         (size == PUB_KEY_SIZE);
+}
+
+bool Secp256k1Backend::MultiplyGenerator(const BIGNUM* k,
+                                         bytes& result) const {
+  Scalar scalar;
+  secp256k1_pubkey point;
+
+  if ((m_ctx == nullptr) || !ToScalar(k, scalar) ||
+      (secp256k1_ec_pubkey_create(m_ctx, &point, scalar.data()) != 1)) {
+    return false;
+  }
+
+  return SerializePoint(point, result);
+}
+
+bool Secp256k1Backend::ComputeCommit(const BIGNUM* s, const BIGNUM* r,
+                                     const PubKey& pubkey,
+                                     bytes& result) const {
+  Scalar sScalar, rScalar;
+  secp256k1_pubkey sG, rP, Q;
+
+  if ((m_ctx == nullptr) || !ToScalar(s, sScalar) || !ToScalar(r, rScalar) ||
+      !ParsePubKey(pubkey, rP)) {
+    return false;
+  }
+
+  if ((secp256k1_ec_pubkey_create(m_ctx, &sG, sScalar.data()) != 1) ||
+      (secp256k1_ec_pubkey_tweak_mul(m_ctx, &rP, rScalar.data()) != 1)) {
+    return false;
+  }
+
+  // Combining fails if the sum is the point at infinity
+  const secp256k1_pubkey* terms[] = {&sG, &rP};
+  if (secp256k1_ec_pubkey_combine(m_ctx, &Q, terms, 2) != 1) {
+    return false;
+  }
+
+  return SerializePoint(Q, result);
+}
+
+bool Secp256k1Backend::AggregatePubKeys(const vector<PubKey>& pubkeys,
+                                        bytes& result) const {
+  if ((m_ctx == nullptr) || pubkeys.empty()) {
+    return false;
+  }
+
+  vector<secp256k1_pubkey> points(pubkeys.size());
+  vector<const secp256k1_pubkey*> terms(pubkeys.size());
+
+  for (unsigned int i = 0; i < pubkeys.size(); i++) {
+    if (!ParsePubKey(pubkeys.at(i), points.at(i))) {
+      LOG_GENERAL(WARNING, "Pubkey " << i << " could not be parsed");
+      return false;
+    }
+    terms.at(i) = &points.at(i);
+  }
+
+  secp256k1_pubkey sum;
+  if (secp256k1_ec_pubkey_combine(m_ctx, &sum, terms.data(), terms.size()) !=
+      1) {
+    return false;
+  }
+
+  return SerializePoint(sum, result);
+}
+
+bool Secp256k1Backend::SubtractPubKeys(const PubKey& aggregate,
+                                       const vector<PubKey>& pubkeys,
+                                       bytes& result) const {
+  if (m_ctx == nullptr) {
+    return false;
+  }
+
+  vector<secp256k1_pubkey> points(pubkeys.size() + 1);
+  vector<const secp256k1_pubkey*> terms(points.size());
+
+  if (!ParsePubKey(aggregate, points.at(0))) {
+    LOG_GENERAL(WARNING, "Aggregated pubkey could not be parsed");
+    return false;
+  }
+  terms.at(0) = &points.at(0);
+
+  for (unsigned int i = 0; i < pubkeys.size(); i++) {
+    if (!ParsePubKey(pubkeys.at(i), points.at(i + 1)) ||
+        (secp256k1_ec_pubkey_negate(m_ctx, &points.at(i + 1)) != 1)) {
+      LOG_GENERAL(WARNING, "Pubkey " << i << " could not be negated");
+      return false;
+    }
+    terms.at(i + 1) = &points.at(i + 1);
+  }
+
+  secp256k1_pubkey difference;
+  if (secp256k1_ec_pubkey_combine(m_ctx, &difference, terms.data(),
+                                  terms.size()) != 1) {
+    return false;
+  }
+
+  return SerializePoint(difference, result);
+}
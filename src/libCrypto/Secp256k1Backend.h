@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __SECP256K1BACKEND_H__
+#define __SECP256K1BACKEND_H__
+
+#include <openssl/bn.h>
+#include <secp256k1.h>
+
+#include <vector>
+
+#include "Schnorr.h"
+
+/// Curve arithmetic on libsecp256k1, enabled with -DUSE_SECP256K1=ON.
+///
+/// Takes over the point multiplications and additions on the hot paths of
+/// Schnorr and MultiSig from OpenSSL's generic EC_POINT code, using
+/// libsecp256k1's constant-time, endomorphism-accelerated field arithmetic.
+/// Points and scalars cross over in their 33- and 32-byte encodings, so the
+/// PrivKey/PubKey/Signature/CommitPoint/Response types are unchanged and all
+/// intermediate values live in fixed-size stack objects.
+class Secp256k1Backend {
+  secp256k1_context* m_ctx;
+
+  Secp256k1Backend();
+  ~Secp256k1Backend();
+
+  Secp256k1Backend(Secp256k1Backend const&) = delete;
+  void operator=(Secp256k1Backend const&) = delete;
+
+  bool ParsePubKey(const PubKey& pubkey, secp256k1_pubkey& result) const;
+  bool SerializePoint(const secp256k1_pubkey& point, bytes& result) const;
+
+ public:
+  /// Returns the singleton instance.
+  static Secp256k1Backend& GetInstance();
+
+  /// Computes kG as a compressed point. k must be in [1, ..., order-1].
+  bool MultiplyGenerator(const BIGNUM* k, bytes& result) const;
+
+  /// Computes sG + rP as a compressed point. s and r must be in
+  /// [1, ..., order-1]. Fails if the result is the point at infinity.
+  bool ComputeCommit(const BIGNUM* s, const BIGNUM* r, const PubKey& pubkey,
+                     bytes& result) const;
+
+  /// Sums the keys as a compressed point. Fails if the sum is the point at
+  /// infinity.
+  bool AggregatePubKeys(const std::vector<PubKey>& pubkeys,
+                        bytes& result) const;
+
+  /// Computes aggregate minus the sum of pubkeys as a compressed point. Fails
+  /// if the difference is the point at infinity.
+  bool SubtractPubKeys(const PubKey& aggregate,
+                       const std::vector<PubKey>& pubkeys,
+                       bytes& result) const;
+};
+
+#endif  // __SECP256K1BACKEND_H__
@@ -70,6 +70,11 @@ class SHA2 {
     SHA256_Update(&m_context, input.data() + offset, size);
   }
 
+  /// Hash update function, for data not held in a byte vector.
+  void Update(const unsigned char* input, size_t size) {
+    SHA256_Update(&m_context, input, size);
+  }
+
   /// Resets the algorithm.
   void Reset() { SHA256_Init(&m_context); }
 
@@ -0,0 +1,276 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <openssl/sha.h>
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+
+#include "Sha2Batch.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <immintrin.h>
+#define SHA2_BATCH_X86
+#endif
+
+using namespace std;
+
+namespace {
+const unsigned int SHA256_BLOCK_SIZE = 64;
+const unsigned int SHA256_OUTPUT_SIZE = 32;
+const unsigned int MIN_BATCH_SIZE = 4;
+
+void HashWithOpenSSL(const bytes& input, bytes& output) {
+  output.resize(SHA256_OUTPUT_SIZE);
+  SHA256(input.data(), input.size(), output.data());
+}
+
+#ifdef SHA2_BATCH_X86
+const unsigned int LANES = 8;
+
+const uint32_t K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1,
+    0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+    0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786,
+    0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
+    0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+    0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+    0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a,
+    0x5b9cca4f, 0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+    0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+const uint32_t H0[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                        0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+
+size_t NumPaddedBlocks(size_t size) {
+  return (size + 9 + SHA256_BLOCK_SIZE - 1) / SHA256_BLOCK_SIZE;
+}
+
+/// Copies block number `block` of the padded message into `out`
+void LoadPaddedBlock(const bytes& input, size_t block, size_t numBlocks,
+                     uint8_t out[SHA256_BLOCK_SIZE]) {
+  const size_t start = block * SHA256_BLOCK_SIZE;
+  if (start + SHA256_BLOCK_SIZE <= input.size()) {
+    memcpy(out, input.data() + start, SHA256_BLOCK_SIZE);
+    return;
+  }
+
+  memset(out, 0, SHA256_BLOCK_SIZE);
+  if (start <= input.size()) {
+    memcpy(out, input.data() + start, input.size() - start);
+    out[input.size() - start] = 0x80;
+  }
+  if (block == numBlocks - 1) {
+    const uint64_t bitLength = static_cast<uint64_t>(input.size()) * 8;
+    for (unsigned int i = 0; i < 8; i++) {
+      out[SHA256_BLOCK_SIZE - 1 - i] =
+          static_cast<uint8_t>(bitLength >> (8 * i));
+    }
+  }
+}
+
+#define AVX2_TARGET __attribute__((target("avx2")))
+
+AVX2_TARGET inline __m256i Rotr(__m256i x, int n) {
+  return _mm256_or_si256(_mm256_srli_epi32(x, n), _mm256_slli_epi32(x, 32 - n));
+}
+
+AVX2_TARGET inline __m256i Add(__m256i a, __m256i b) {
+  return _mm256_add_epi32(a, b);
+}
+
+/// Runs one compression round on eight independent states; w[t] holds word t
+/// of the block of every lane
+AVX2_TARGET void Compress8(__m256i state[8], const __m256i block[16]) {
+  __m256i w[64];
+  for (unsigned int t = 0; t < 16; t++) {
+    w[t] = block[t];
+  }
+  for (unsigned int t = 16; t < 64; t++) {
+    const __m256i s0 = _mm256_xor_si256(
+        _mm256_xor_si256(Rotr(w[t - 15], 7), Rotr(w[t - 15], 18)),
+        _mm256_srli_epi32(w[t - 15], 3));
+    const __m256i s1 = _mm256_xor_si256(
+        _mm256_xor_si256(Rotr(w[t - 2], 17), Rotr(w[t - 2], 19)),
+        _mm256_srli_epi32(w[t - 2], 10));
+    w[t] = Add(Add(w[t - 16], s0), Add(w[t - 7], s1));
+  }
+
+  __m256i a = state[0], b = state[1], c = state[2], d = state[3];
+  __m256i e = state[4], f = state[5], g = state[6], h = state[7];
+
+  for (unsigned int t = 0; t < 64; t++) {
+    const __m256i S1 = _mm256_xor_si256(
+        _mm256_xor_si256(Rotr(e, 6), Rotr(e, 11)), Rotr(e, 25));
+    const __m256i ch =
+        _mm256_xor_si256(_mm256_and_si256(e, f), _mm256_andnot_si256(e, g));
+    const __m256i t1 = Add(Add(Add(h, S1), Add(ch, w[t])),
+                           _mm256_set1_epi32(static_cast<int>(K[t])));
+    const __m256i S0 = _mm256_xor_si256(
+        _mm256_xor_si256(Rotr(a, 2), Rotr(a, 13)), Rotr(a, 22));
+    const __m256i maj = _mm256_xor_si256(
+        _mm256_xor_si256(_mm256_and_si256(a, b), _mm256_and_si256(a, c)),
+        _mm256_and_si256(b, c));
+    const __m256i t2 = Add(S0, maj);
+
+    h = g;
+    g = f;
+    f = e;
+    e = Add(d, t1);
+    d = c;
+    c = b;
+    b = a;
+    a = Add(t1, t2);
+  }
+
+  state[0] = Add(state[0], a);
+  state[1] = Add(state[1], b);
+  state[2] = Add(state[2], c);
+  state[3] = Add(state[3], d);
+  state[4] = Add(state[4], e);
+  state[5] = Add(state[5], f);
+  state[6] = Add(state[6], g);
+  state[7] = Add(state[7], h);
+}
+
+/// Hashes up to eight inputs, whose indices are given, at once
+AVX2_TARGET void HashLanesWithAVX2(const vector<bytes>& inputs,
+                                   const size_t* indices, unsigned int count,
+                                   vector<bytes>& outputs) {
+  size_t numBlocks[LANES] = {0};
+  size_t maxBlocks = 0;
+  for (unsigned int lane = 0; lane < count; lane++) {
+    numBlocks[lane] = NumPaddedBlocks(inputs[indices[lane]].size());
+    maxBlocks = max(maxBlocks, numBlocks[lane]);
+  }
+
+  __m256i state[8];
+  for (unsigned int i = 0; i < 8; i++) {
+    state[i] = _mm256_set1_epi32(static_cast<int>(H0[i]));
+  }
+
+  alignas(32) uint32_t words[16][LANES];
+  alignas(32) uint32_t digests[8][LANES];
+  uint8_t blockBytes[SHA256_BLOCK_SIZE];
+
+  for (size_t block = 0; block < maxBlocks; block++) {
+    memset(words, 0, sizeof(words));
+    for (unsigned int lane = 0; lane < count; lane++) {
+      if (block >= numBlocks[lane]) {
+        continue;
+      }
+      LoadPaddedBlock(inputs[indices[lane]], block, numBlocks[lane],
+                      blockBytes);
+      for (unsigned int t = 0; t < 16; t++) {
+        words[t][lane] = (static_cast<uint32_t>(blockBytes[4 * t]) << 24) |
+                         (static_cast<uint32_t>(blockBytes[4 * t + 1]) << 16) |
+                         (static_cast<uint32_t>(blockBytes[4 * t + 2]) << 8) |
+                         static_cast<uint32_t>(blockBytes[4 * t + 3]);
+      }
+    }
+
+    __m256i blockWords[16];
+    for (unsigned int t = 0; t < 16; t++) {
+      blockWords[t] =
+          _mm256_load_si256(reinterpret_cast<const __m256i*>(words[t]));
+    }
+    Compress8(state, blockWords);
+
+    bool stored = false;
+    for (unsigned int lane = 0; lane < count; lane++) {
+      if (block + 1 != numBlocks[lane]) {
+        continue;
+      }
+      if (!stored) {
+        for (unsigned int i = 0; i < 8; i++) {
+          _mm256_store_si256(reinterpret_cast<__m256i*>(digests[i]), state[i]);
+        }
+        stored = true;
+      }
+      bytes& output = outputs[indices[lane]];
+      output.resize(SHA256_OUTPUT_SIZE);
+      for (unsigned int i = 0; i < 8; i++) {
+        output[4 * i] = static_cast<uint8_t>(digests[i][lane] >> 24);
+        output[4 * i + 1] = static_cast<uint8_t>(digests[i][lane] >> 16);
+        output[4 * i + 2] = static_cast<uint8_t>(digests[i][lane] >> 8);
+        output[4 * i + 3] = static_cast<uint8_t>(digests[i][lane]);
+      }
+    }
+  }
+}
+
+bool HasSHANI() {
+  unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+  if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+    return false;
+  }
+  return (ebx & (1u << 29)) != 0;
+}
+#endif  // SHA2_BATCH_X86
+}  // namespace
+
+bool SHA256BatchHasAVX2() {
+#ifdef SHA2_BATCH_X86
+  static const bool hasAVX2 = __builtin_cpu_supports("avx2");
+  return hasAVX2;
+#else
+  return false;
+#endif
+}
+
+void SHA256Batch(const vector<bytes>& inputs, vector<bytes>& outputs,
+                 SHA256BatchImpl impl) {
+  outputs.resize(inputs.size());
+
+  if (impl == SHA256BatchImpl::AUTO) {
+#ifdef SHA2_BATCH_X86
+    static const bool preferAVX2 = SHA256BatchHasAVX2() && !HasSHANI();
+#else
+    static const bool preferAVX2 = false;
+#endif
+    impl = (preferAVX2 && inputs.size() >= MIN_BATCH_SIZE)
+               ? SHA256BatchImpl::AVX2
+               : SHA256BatchImpl::OPENSSL;
+  }
+
+#ifdef SHA2_BATCH_X86
+  if (impl == SHA256BatchImpl::AVX2 && SHA256BatchHasAVX2()) {
+    // Lanes of one group run for as many blocks as the longest input in it,
+    // so group inputs of similar length
+    vector<size_t> order(inputs.size());
+    iota(order.begin(), order.end(), 0);
+    stable_sort(order.begin(), order.end(), [&inputs](size_t a, size_t b) {
+      return inputs[a].size() < inputs[b].size();
+    });
+
+    for (size_t i = 0; i < order.size(); i += LANES) {
+      HashLanesWithAVX2(
+          inputs, order.data() + i,
+          static_cast<unsigned int>(min<size_t>(LANES, order.size() - i)),
+          outputs);
+    }
+    return;
+  }
+#endif
+
+  for (size_t i = 0; i < inputs.size(); i++) {
+    HashWithOpenSSL(inputs[i], outputs[i]);
+  }
+}
@@ -0,0 +1,40 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __SHA2BATCH_H__
+#define __SHA2BATCH_H__
+
+#include <vector>
+#include "common/BaseType.h"
+
+/// Implementations SHA256Batch can be told to use; AUTO picks one at run time
+enum class SHA256BatchImpl { AUTO, OPENSSL, AVX2 };
+
+/// Returns true if the CPU supports the 8-lane AVX2 implementation
+bool SHA256BatchHasAVX2();
+
+/// Hashes every input independently, so that outputs[i] is the SHA-256 of
+/// inputs[i].
+///
+/// OpenSSL already uses the SHA extensions (SHA-NI) for a single stream when
+/// the CPU has them, and nothing beats that, so AUTO only switches to hashing
+/// eight inputs at once with AVX2 on CPUs without SHA-NI, for batches of at
+/// least four inputs.
+void SHA256Batch(const std::vector<bytes>& inputs, std::vector<bytes>& outputs,
+                 SHA256BatchImpl impl = SHA256BatchImpl::AUTO);
+
+#endif  // __SHA2BATCH_H__
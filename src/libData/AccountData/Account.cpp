@@ -22,6 +22,7 @@
 #include "depends/common/CommonIO.h"
 #include "depends/common/FixedHash.h"
 #include "depends/common/RLP.h"
+#include "libCrypto/KeyHashCache.h"
 #include "libCrypto/Sha2.h"
 #include "libMessage/Messenger.h"
 #include "libUtils/DataConversion.h"
@@ -35,6 +36,33 @@ using namespace dev;
 
 using namespace Contract;
 
+namespace {
+/// Stored values of maps and ADTs are serialized json, the rest are literals
+bool StorageValueToJson(const string& tValue, Json::Value& value) {
+  if (tValue[0] != '[' && tValue[0] != '{') {
+    value = tValue;
+    return true;
+  }
+
+  Json::CharReaderBuilder builder;
+  unique_ptr<Json::CharReader> reader(builder.newCharReader());
+  string errors;
+  if (!reader->parse(tValue.c_str(), tValue.c_str() + tValue.size(), &value,
+                     &errors)) {
+    LOG_GENERAL(WARNING, "The json object cannot be extracted from Storage: "
+                             << tValue << endl
+                             << "Error: " << errors);
+    return false;
+  }
+  return true;
+}
+
+const bytes& EmptyBytes() {
+  static const bytes empty;
+  return empty;
+}
+}  // namespace
+
 Account::Account() {}
 
 Account::Account(const bytes& src, unsigned int offset) {
@@ -80,15 +108,16 @@ bool Account::InitContract(const bytes& data, const Address& addr) {
 
 bool Account::InitContract(const Address& addr) {
   // LOG_MARKER();
-  if (m_initData.empty()) {
+  const bytes& initData = GetInitData();
+  if (initData.empty()) {
     LOG_GENERAL(WARNING, "Init data for the contract is empty");
-    m_initValJson = Json::arrayValue;
+    m_initValJson = make_shared<const Json::Value>(Json::arrayValue);
     return false;
   }
   Json::CharReaderBuilder builder;
   unique_ptr<Json::CharReader> reader(builder.newCharReader());
   Json::Value root;
-  string dataStr(m_initData.begin(), m_initData.end());
+  string dataStr(initData.begin(), initData.end());
   string errors;
   if (!reader->parse(dataStr.c_str(), dataStr.c_str() + dataStr.size(), &root,
                      &errors)) {
@@ -97,7 +126,7 @@ bool Account::InitContract(const Address& addr) {
     return false;
   }
 
-  m_initValJson = root;
+  auto initValJson = make_shared<Json::Value>(root);
 
   // Append createBlockNum
   {
@@ -105,7 +134,7 @@ bool Account::InitContract(const Address& addr) {
     createBlockNumObj["vname"] = "_creation_block";
     createBlockNumObj["type"] = "BNum";
     createBlockNumObj["value"] = to_string(GetCreateBlockNum());
-    m_initValJson.append(createBlockNumObj);
+    initValJson->append(createBlockNumObj);
   }
 
   // Append _this_address
@@ -114,9 +143,11 @@ bool Account::InitContract(const Address& addr) {
     createBlockNumObj["vname"] = "_this_address";
     createBlockNumObj["type"] = "ByStr20";
     createBlockNumObj["value"] = "0x" + addr.hex();
-    m_initValJson.append(createBlockNumObj);
+    initValJson->append(createBlockNumObj);
   }
 
+  m_initValJson = move(initValJson);
+
   bool hasScillaVersion = false;
   std::vector<StateEntry> state_entries;
 
@@ -313,11 +344,17 @@ string Account::GetRawStorage(const h256& k_hash) const {
   return m_storage.at(k_hash);
 }
 
-Json::Value Account::GetInitJson() const { return m_initValJson; }
+Json::Value Account::GetInitJson() const {
+  return m_initValJson ? *m_initValJson : Json::Value();
+}
 
-const bytes& Account::GetInitData() const { return m_initData; }
+const bytes& Account::GetInitData() const {
+  return m_initData ? *m_initData : EmptyBytes();
+}
 
-void Account::SetInitData(const bytes& initData) { m_initData = initData; }
+void Account::SetInitData(const bytes& initData) {
+  m_initData = make_shared<const bytes>(initData);
+}
 
 vector<h256> Account::GetStorageKeyHashes() const {
   if (HASHMAP_CONTRACT_STATE_DB) {
@@ -362,36 +399,89 @@ Json::Value Account::GetStorageJson() const {
       Json::Value item;
       item["vname"] = tVname;
       item["type"] = tType;
-      if (tValue[0] == '[' || tValue[0] == '{') {
-        Json::CharReaderBuilder builder;
-        unique_ptr<Json::CharReader> reader(builder.newCharReader());
-        Json::Value obj;
-        string errors;
-        if (!reader->parse(tValue.c_str(), tValue.c_str() + tValue.size(), &obj,
-                           &errors)) {
-          LOG_GENERAL(WARNING,
-                      "The json object cannot be extracted from Storage: "
-                          << tValue << endl
-                          << "Error: " << errors);
-          continue;
-        }
-        item["value"] = obj;
-      } else {
-        item["value"] = tValue;
+      if (!StorageValueToJson(tValue, item["value"])) {
+        continue;
       }
       root.append(item);
     }
   }
 
+  root.append(GetBalanceStateJson());
+
+  // LOG_GENERAL(INFO, "States: " << root);
+
+  return root;
+}
+
+Json::Value Account::GetBalanceStateJson() const {
   Json::Value balance;
   balance["vname"] = "_balance";
   balance["type"] = "Uint128";
   balance["value"] = GetBalance().convert_to<string>();
-  root.append(balance);
+  return balance;
+}
 
-  // LOG_GENERAL(INFO, "States: " << root);
+bool Account::GetStorageValue(const string& vname, const Json::Value& keys,
+                              Json::Value& value) const {
+  if (!isContract()) {
+    LOG_GENERAL(WARNING,
+                "Not contract account, why call Account::GetStorageValue!");
+    return false;
+  }
 
-  return root;
+  if (vname == "_balance") {
+    value = GetBalanceStateJson()["value"];
+    return true;
+  }
+
+  string tValue;
+
+  if (HASHMAP_CONTRACT_STATE_DB) {
+    StateEntry entry;
+    if (!ContractStorage::GetContractStorage().GetContractStateEntry(
+            m_address, vname, entry) ||
+        !std::get<MUTABLE>(entry)) {
+      return false;
+    }
+    tValue = std::get<VALUE>(entry);
+  } else {
+    const string rlpStr = m_storage.at(GetKeyHash(vname));
+    if (rlpStr.empty()) {
+      return false;
+    }
+    dev::RLP rlp(rlpStr);
+    if (rlp[1].toString() == "False") {
+      return false;
+    }
+    tValue = rlp[3].toString();
+  }
+
+  Json::Value field;
+  if (!StorageValueToJson(tValue, field)) {
+    return false;
+  }
+
+  // Maps are stored as arrays of {"key": k, "val": v} entries
+  for (const auto& key : keys) {
+    if (!field.isArray()) {
+      return false;
+    }
+    bool found = false;
+    for (const auto& entry : field) {
+      if (entry.isObject() && entry["key"] == key) {
+        Json::Value next = entry["val"];
+        field.swap(next);
+        found = true;
+        break;
+      }
+    }
+    if (!found) {
+      return false;
+    }
+  }
+
+  value.swap(field);
+  return true;
 }
 
 void Account::Commit() { m_prevRoot = m_storageRoot; }
@@ -463,7 +553,7 @@ void Account::SetCode(const bytes& code) {
     return;
   }
 
-  m_codeCache = code;
+  m_codeCache = make_shared<const bytes>(code);
   SHA2<HASH_TYPE::HASH_VARIANT_256> sha2;
   sha2.Update(code);
   m_codeHash = dev::h256(sha2.Finalize());
@@ -472,12 +562,12 @@ void Account::SetCode(const bytes& code) {
   InitStorage();
 }
 
-const bytes& Account::GetCode() const { return m_codeCache; }
+const bytes& Account::GetCode() const {
+  return m_codeCache ? *m_codeCache : EmptyBytes();
+}
 
 const dev::h256& Account::GetCodeHash() const { return m_codeHash; }
 
 const h256 Account::GetKeyHash(const string& key) const {
-  SHA2<HASH_TYPE::HASH_VARIANT_256> sha2;
-  sha2.Update(DataConversion::StringToCharArray(key));
-  return h256(sha2.Finalize());
+  return KeyHashCache::GetInstance().Get(key);
 }
\ No newline at end of file
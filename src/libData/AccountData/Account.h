@@ -21,6 +21,7 @@
 #include <json/json.h>
 #include <leveldb/db.h>
 #include <array>
+#include <memory>
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wunused-parameter"
 #include <boost/multiprecision/cpp_int.hpp>
@@ -55,9 +56,11 @@ class Account : public SerializableDataBlock {
   // The associated code for this account.
   uint64_t m_createBlockNum = 0;
   uint32_t m_scillaVersion = 0;
-  Json::Value m_initValJson;
-  bytes m_initData;
-  bytes m_codeCache;
+  // Set once per contract and only ever replaced, so the copies made for the
+  // temp state share them with the committed account instead of cloning
+  std::shared_ptr<const Json::Value> m_initValJson;
+  std::shared_ptr<const bytes> m_initData;
+  std::shared_ptr<const bytes> m_codeCache;
   Address m_address;  // used by contract account only
 
   // TODO: remove if choose HASHMAP_CONTRACT_STATE_DB finally
@@ -161,6 +164,14 @@ class Account : public SerializableDataBlock {
 
   Json::Value GetStorageJson() const;
 
+  /// Returns the _balance entry that the interpreter expects in the state
+  Json::Value GetBalanceStateJson() const;
+
+  /// Looks up one mutable field, or with keys the entry of a (nested) map
+  /// field. Returns false if there is no such field or key.
+  bool GetStorageValue(const std::string& vname, const Json::Value& keys,
+                       Json::Value& value) const;
+
   void Commit();
 
   void RollBack();
@@ -15,23 +15,71 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+#include <boost/filesystem.hpp>
 #include <leveldb/db.h>
 
 #include "AccountStore.h"
 #include "depends/common/RLP.h"
 #include "libCrypto/Sha2.h"
 #include "libMessage/Messenger.h"
+#include "libMessage/MessengerAccountStoreBase.h"
 #include "libPersistence/BlockStorage.h"
 #include "libPersistence/ContractStorage.h"
 #include "libUtils/SysCommand.h"
+#include "libUtils/TimeUtils.h"
+#include "libUtils/Tracer.h"
 
 using namespace std;
 using namespace dev;
 using namespace boost::multiprecision;
 using namespace Contract;
 
+namespace {
+
+const string RESTART_SNAPSHOT_FILE = "./" + PERSISTENCE_PATH + "/stateSnapshot";
+const char RESTART_SNAPSHOT_MAGIC[] = {'Z', 'S', 'N', 'P'};
+const uint32_t RESTART_SNAPSHOT_VERSION = 1;
+// magic (4) || version (4) || state root (32) || account count (8)
+const size_t RESTART_SNAPSHOT_HEADER_SIZE = 48;
+// address (20) || balance (16) || nonce (8) || storage root (32) || code
+// size (4), followed by the code
+const size_t RESTART_SNAPSHOT_ENTRY_SIZE = 80;
+const size_t RESTART_SNAPSHOT_CHECKSUM_SIZE = 32;
+
+template <class T>
+void AppendBigEndian(const T& value, size_t size, bytes& out) {
+  for (size_t i = 0; i < size; i++) {
+    out.push_back(
+        static_cast<uint8_t>((value >> (8 * (size - 1 - i))) & 0xFF));
+  }
+}
+
+template <class T>
+T ReadBigEndian(const uint8_t* in, size_t size) {
+  T value = 0;
+  for (size_t i = 0; i < size; i++) {
+    value = (value << 8) | in[i];
+  }
+  return value;
+}
+
+}  // namespace
+
 AccountStore::AccountStore() {
   m_accountStoreTemp = make_unique<AccountStoreTemp>(*this);
+
+  // Archival lookups serve the state at any past root
+  if (!ARCHIVAL_LOOKUP && !STATE_ARCHIVE_MODE) {
+    m_db.enablePruning(STATE_PRUNING_KEEP_ROOTS);
+  }
 }
 
 AccountStore::~AccountStore() {
@@ -59,6 +107,9 @@ void AccountStore::InitSoft() {
   InitReversibles();
 
   InitTemp();
+
+  m_readSnapshotDirty.clear();
+  PublishReadSnapshot(true);
 }
 
 void AccountStore::InitTemp() {
@@ -84,6 +135,114 @@ AccountStore& AccountStore::GetInstance() {
   return accountstore;
 }
 
+namespace {
+// Layers kept on top of a read snapshot before they are merged into one
+const unsigned int READ_SNAPSHOT_MAX_DEPTH = 16;
+}  // namespace
+
+void AccountStore::PublishReadSnapshot(bool full) {
+  const auto current = atomic_load(&m_readSnapshot);
+
+  auto snapshot = make_shared<ReadSnapshot>();
+  snapshot->m_version = current ? current->m_version + 1 : 0;
+  snapshot->m_stateRoot = m_state.root();
+
+  if (full || !current) {
+    snapshot->m_accounts.reserve(m_addressToAccount->size());
+    for (const auto& entry : *m_addressToAccount) {
+      snapshot->m_accounts.emplace(entry.first,
+                               make_shared<const Account>(entry.second));
+    }
+  } else {
+    for (const auto& address : m_readSnapshotDirty) {
+      const auto it = m_addressToAccount->find(address);
+      snapshot->m_accounts.emplace(
+          address, it == m_addressToAccount->end()
+                       ? nullptr
+                       : make_shared<const Account>(it->second));
+    }
+
+    if (current->m_depth < READ_SNAPSHOT_MAX_DEPTH) {
+      snapshot->m_parent = current;
+      snapshot->m_depth = current->m_depth + 1;
+    } else {
+      // Newest first, so that each address keeps its latest account
+      for (auto layer = current; layer; layer = layer->m_parent) {
+        for (const auto& entry : layer->m_accounts) {
+          snapshot->m_accounts.emplace(entry);
+        }
+      }
+      // With no parent left there is nothing for a removal to hide
+      for (auto it = snapshot->m_accounts.begin();
+           it != snapshot->m_accounts.end();) {
+        it = it->second ? std::next(it) : snapshot->m_accounts.erase(it);
+      }
+    }
+  }
+
+  m_readSnapshotDirty.clear();
+  atomic_store(&m_readSnapshot, shared_ptr<const ReadSnapshot>(move(snapshot)));
+}
+
+shared_ptr<const Account> AccountStore::GetCommittedAccount(
+    const Address& address) const {
+  for (auto layer = atomic_load(&m_readSnapshot); layer;
+       layer = layer->m_parent) {
+    const auto it = layer->m_accounts.find(address);
+    if (it != layer->m_accounts.end()) {
+      return it->second;
+    }
+  }
+
+  // Not published, so look it up in the live state without adding it to the
+  // account map, which a shared lock would not allow
+  shared_lock<shared_timed_mutex> lock(m_mutexPrimary);
+
+  const auto it = m_addressToAccount->find(address);
+  if (it != m_addressToAccount->end()) {
+    return make_shared<const Account>(it->second);
+  }
+
+  Account account;
+  if (!GetAccountFromTrie(address, account)) {
+    return nullptr;
+  }
+  return make_shared<const Account>(move(account));
+}
+
+uint64_t AccountStore::GetReadSnapshotVersion() const {
+  const auto snapshot = atomic_load(&m_readSnapshot);
+  return snapshot ? snapshot->m_version : 0;
+}
+
+MemoryUsage AccountStore::GetMemoryUsage() {
+  MemoryUsage usage;
+  {
+    shared_lock<shared_timed_mutex> lock(m_mutexPrimary);
+    usage.m_objects = m_addressToAccount->size();
+    usage.m_bytes = MemoryStats::HashContainerBytes(*m_addressToAccount);
+    for (const auto& entry : *m_addressToAccount) {
+      usage.m_bytes +=
+          entry.second.GetCode().size() + entry.second.GetInitData().size();
+    }
+  }
+  {
+    lock_guard<mutex> g(m_mutexDelta);
+    usage.m_bytes +=
+        MemoryStats::TreeContainerBytes(
+            *m_accountStoreTemp->GetAddressToAccount()) +
+        m_stateDeltaSerialized.capacity();
+  }
+  // The snapshots hold copies of the accounts, sharing their code
+  for (auto layer = atomic_load(&m_readSnapshot); layer;
+       layer = layer->m_parent) {
+    usage.m_bytes += MemoryStats::HashContainerBytes(layer->m_accounts) +
+                     layer->m_accounts.size() * sizeof(Account);
+  }
+  usage.m_bytes += m_db.memoryUsage();
+  return usage;
+}
+
 bool AccountStore::Serialize(bytes& src, unsigned int offset) const {
   LOG_MARKER();
 
@@ -99,7 +258,108 @@ bool AccountStore::Deserialize(const bytes& src, unsigned int offset) {
 
   unique_lock<shared_timed_mutex> g(m_mutexPrimary);
 
-  if (!Messenger::GetAccountStore(src, offset, *this)) {
+  const bool result = Messenger::GetAccountStore(src, offset, *this);
+  PublishReadSnapshot(true);
+  if (!result) {
+    LOG_GENERAL(WARNING, "Messenger::GetAccountStore failed.");
+    return false;
+  }
+
+  return true;
+}
+
+bool AccountStore::GetSnapshotChunks(vector<bytes>& chunks,
+                                     vector<h256>& chunkHashes) const {
+  LOG_MARKER();
+
+  chunks.clear();
+  chunkHashes.clear();
+
+  if (STATE_SNAPSHOT_CHUNK_ACCOUNTS == 0) {
+    LOG_GENERAL(WARNING, "STATE_SNAPSHOT_CHUNK_ACCOUNTS must not be zero");
+    return false;
+  }
+
+  shared_lock<shared_timed_mutex> lock(m_mutexPrimary);
+
+  vector<Address> addresses;
+  addresses.reserve(m_addressToAccount->size());
+  for (const auto& entry : *m_addressToAccount) {
+    addresses.emplace_back(entry.first);
+  }
+  sort(addresses.begin(), addresses.end());
+
+  for (size_t begin = 0; begin < addresses.size();
+       begin += STATE_SNAPSHOT_CHUNK_ACCOUNTS) {
+    const size_t end =
+        min(addresses.size(), begin + STATE_SNAPSHOT_CHUNK_ACCOUNTS);
+
+    map<Address, Account> chunkAccounts;
+    for (size_t i = begin; i < end; i++) {
+      chunkAccounts.emplace(addresses[i], m_addressToAccount->at(addresses[i]));
+    }
+
+    bytes chunk;
+    if (!MessengerAccountStoreBase::SetAccountStore(chunk, 0, chunkAccounts)) {
+      LOG_GENERAL(WARNING, "SetAccountStore failed for chunk "
+                               << chunks.size());
+      return false;
+    }
+
+    chunkHashes.emplace_back(GetSnapshotChunkHash(chunk));
+    chunks.emplace_back(move(chunk));
+  }
+
+  LOG_GENERAL(INFO, "State snapshot: " << addresses.size() << " accounts in "
+                                       << chunks.size() << " chunks");
+
+  return true;
+}
+
+bool AccountStore::SetSnapshotChunks(const vector<bytes>& chunks,
+                                     const vector<h256>& chunkHashes,
+                                     const h256& stateRoot) {
+  LOG_MARKER();
+
+  if (chunks.size() != chunkHashes.size()) {
+    LOG_GENERAL(WARNING, "Got " << chunks.size() << " chunks for "
+                                << chunkHashes.size() << " hashes");
+    return false;
+  }
+
+  // Check every chunk before touching the current state
+  for (size_t i = 0; i < chunks.size(); i++) {
+    if (GetSnapshotChunkHash(chunks[i]) != chunkHashes[i]) {
+      LOG_GENERAL(WARNING, "Hash mismatch for snapshot chunk " << i);
+      return false;
+    }
+  }
+
+  this->Init();
+
+  for (size_t i = 0; i < chunks.size(); i++) {
+    if (!AddSnapshotChunk(chunks[i])) {
+      LOG_GENERAL(WARNING, "Failed to add snapshot chunk " << i);
+      return false;
+    }
+  }
+
+  if (GetStateRootHash() != stateRoot) {
+    LOG_GENERAL(WARNING, "State root mismatch after loading snapshot. "
+                         "Expected: "
+                             << stateRoot << " Got: " << GetStateRootHash());
+    return false;
+  }
+
+  return true;
+}
+
+bool AccountStore::AddSnapshotChunk(const bytes& chunk) {
+  unique_lock<shared_timed_mutex> g(m_mutexPrimary);
+
+  const bool result = Messenger::GetAccountStore(chunk, 0, *this);
+  PublishReadSnapshot(false);
+  if (!result) {
     LOG_GENERAL(WARNING, "Messenger::GetAccountStore failed.");
     return false;
   }
@@ -107,6 +367,56 @@ bool AccountStore::Deserialize(const bytes& src, unsigned int offset) {
   return true;
 }
 
+bool AccountStore::ImportAccounts(
+    const function<bool(Address&, Account&)>& next) {
+  LOG_MARKER();
+
+  auto startTime = r_timer_start();
+
+  lock(m_mutexPrimary, m_mutexDB);
+  unique_lock<shared_timed_mutex> g(m_mutexPrimary, adopt_lock);
+  lock_guard<mutex> g2(m_mutexDB, adopt_lock);
+
+  if (!m_addressToAccount->empty() || !m_state.isEmpty()) {
+    LOG_GENERAL(WARNING, "Accounts can only be imported into an empty store");
+    return false;
+  }
+
+  BytesMap entries;
+  Address address;
+  Account account;
+  while (next(address, account)) {
+    if (!entries.empty() && !(entries.rbegin()->first < address.asBytes())) {
+      LOG_GENERAL(WARNING, "Imported account " << address
+                                               << " out of ascending order");
+      m_addressToAccount->clear();
+      return false;
+    }
+    // In order, each entry goes in at the end without searching the map
+    entries.emplace_hint(entries.end(), address.asBytes(),
+                         GetStateTrieValue(account));
+    m_addressToAccount->emplace(address, move(account));
+  }
+
+  BuildStateTrie(entries);
+  PublishReadSnapshot(true);
+
+  const double elapsedInMs = r_timer_end(startTime) / 1000;
+  LOG_GENERAL(INFO, "Imported " << entries.size() << " accounts in "
+                                << elapsedInMs << " ms ("
+                                << entries.size() * 1000 /
+                                       max(elapsedInMs, 1.0)
+                                << " accounts/s)");
+
+  return true;
+}
+
+h256 AccountStore::GetSnapshotChunkHash(const bytes& chunk) {
+  SHA2<HASH_TYPE::HASH_VARIANT_256> sha2;
+  sha2.Update(chunk);
+  return h256(sha2.Finalize());
+}
+
 bool AccountStore::SerializeDelta() {
   LOG_MARKER();
 
@@ -141,14 +451,20 @@ bool AccountStore::DeserializeDelta(const bytes& src, unsigned int offset,
     unique_lock<shared_timed_mutex> g(m_mutexPrimary, adopt_lock);
     lock_guard<mutex> g2(m_mutexReversibles, adopt_lock);
 
-    if (!Messenger::GetAccountStoreDelta(src, offset, *this, reversible)) {
+    const bool result =
+        Messenger::GetAccountStoreDelta(src, offset, *this, reversible);
+    PublishReadSnapshot(false);
+    if (!result) {
       LOG_GENERAL(WARNING, "Messenger::GetAccountStoreDelta failed.");
       return false;
     }
   } else {
     unique_lock<shared_timed_mutex> g(m_mutexPrimary);
 
-    if (!Messenger::GetAccountStoreDelta(src, offset, *this, reversible)) {
+    const bool result =
+        Messenger::GetAccountStoreDelta(src, offset, *this, reversible);
+    PublishReadSnapshot(false);
+    if (!result) {
       LOG_GENERAL(WARNING, "Messenger::GetAccountStoreDelta failed.");
       return false;
     }
@@ -162,14 +478,64 @@ bool AccountStore::DeserializeDeltaTemp(const bytes& src, unsigned int offset) {
   return m_accountStoreTemp->DeserializeDelta(src, offset);
 }
 
+bool AccountStore::DeserializeDeltasTemp(const vector<const bytes*>& deltas,
+                                         vector<bool>& applied) {
+  lock_guard<mutex> g(m_mutexDelta);
+  return m_accountStoreTemp->DeserializeDeltas(deltas, applied);
+}
+
 void AccountStore::MoveRootToDisk(const h256& root) {
   // convert h256 to bytes
   if (!BlockStorage::GetBlockStorage().PutMetadata(STATEROOT, root.asBytes()))
     LOG_GENERAL(INFO, "FAIL: Put metadata failed");
 }
 
+bool AccountStore::RetainStateRoot(const uint64_t& blockNum) {
+  if (!STATE_ARCHIVE_MODE) {
+    return true;
+  }
+
+  dev::h256 root;
+  {
+    lock(m_mutexPrimary, m_mutexDB);
+    unique_lock<shared_timed_mutex> g(m_mutexPrimary, adopt_lock);
+    lock_guard<mutex> g2(m_mutexDB, adopt_lock);
+
+    // Only the account trie, contract states are still written per DS epoch
+    try {
+      m_state.db()->commit();
+    } catch (const boost::exception& e) {
+      LOG_GENERAL(WARNING, "Error with AccountStore::RetainStateRoot. "
+                               << boost::diagnostic_information(e));
+      return false;
+    }
+    root = m_state.root();
+  }
+
+  return BlockStorage::GetBlockStorage().PutStateRoot(blockNum, root);
+}
+
+bool AccountStore::GetAccountAt(const uint64_t& blockNum,
+                                const Address& address, Account& account) {
+  dev::h256 root;
+  if (!BlockStorage::GetBlockStorage().GetStateRoot(blockNum, root)) {
+    return false;
+  }
+
+  shared_lock<shared_timed_mutex> g(m_mutexPrimary);
+  try {
+    return GetAccountFromTrie(root, address, account);
+  } catch (const boost::exception& e) {
+    LOG_GENERAL(WARNING, "State root " << root << " of block " << blockNum
+                                       << " unreadable: "
+                                       << boost::diagnostic_information(e));
+    return false;
+  }
+}
+
 bool AccountStore::MoveUpdatesToDisk() {
   LOG_MARKER();
+  TRACE_SPAN("AccountStore::MoveUpdatesToDisk");
 
   lock(m_mutexPrimary, m_mutexDB);
   unique_lock<shared_timed_mutex> g(m_mutexPrimary, adopt_lock);
@@ -177,7 +543,7 @@ bool AccountStore::MoveUpdatesToDisk() {
 
   unordered_map<string, string> batch;
 
-  for (auto i : *m_addressToAccount) {
+  for (const auto& i : *m_addressToAccount) {
     if (i.second.isContract()) {
       if (ContractStorage::GetContractStorage()
               .GetContractCode(i.first)
@@ -224,6 +590,12 @@ bool AccountStore::MoveUpdatesToDisk() {
     return false;
   }
 
+  // The snapshot must match what is on disk, which is only the case right
+  // after a commit; a restart replays the state deltas from here on
+  if (FAST_RESTART_ENABLED) {
+    SaveRestartSnapshot(m_prevRoot);
+  }
+
   // TODO: If the accountstore is cleared here, lookup is unable to serialize
   // accountstore in ProcessGetStateFromSeed. We need to first change
   // serialization to get from database, so that we can avoid keeping
@@ -254,6 +626,8 @@ void AccountStore::DiscardUnsavedUpdates() {
     LOG_GENERAL(WARNING, "Error with AccountStore::DiscardUnsavedUpdates. "
                              << boost::diagnostic_information(e));
   }
+
+  PublishReadSnapshot(true);
 }
 
 bool AccountStore::RetrieveFromDisk() {
@@ -270,6 +644,11 @@ bool AccountStore::RetrieveFromDisk() {
     return false;
   }
 
+  if (FAST_RESTART_ENABLED && LoadRestartSnapshot(h256(rootBytes))) {
+    PublishReadSnapshot(true);
+    return true;
+  }
+
   try {
     h256 root(rootBytes);
     m_state.setRoot(root);
@@ -299,8 +678,166 @@ bool AccountStore::RetrieveFromDisk() {
   } catch (const boost::exception& e) {
     LOG_GENERAL(WARNING, "Error with AccountStore::RetrieveFromDisk. "
                              << boost::diagnostic_information(e));
+    PublishReadSnapshot(true);
     return false;
   }
+  PublishReadSnapshot(true);
+  return true;
+}
+
+bool AccountStore::SaveRestartSnapshot(const h256& root) const {
+  LOG_MARKER();
+
+  auto startTime = r_timer_start();
+
+  // Written next to the old one and renamed over it, so a crash while
+  // writing leaves the previous snapshot in place
+  const string tmpName = RESTART_SNAPSHOT_FILE + ".tmp";
+  ofstream file(tmpName, ios::binary | ios::trunc);
+  if (!file) {
+    LOG_GENERAL(WARNING, "Cannot create " << tmpName);
+    return false;
+  }
+
+  SHA2<HASH_TYPE::HASH_VARIANT_256> sha2;
+  bytes buffer(RESTART_SNAPSHOT_MAGIC,
+               RESTART_SNAPSHOT_MAGIC + sizeof(RESTART_SNAPSHOT_MAGIC));
+  AppendBigEndian(RESTART_SNAPSHOT_VERSION, 4, buffer);
+  buffer.insert(buffer.end(), root.begin(), root.end());
+  AppendBigEndian(static_cast<uint64_t>(m_addressToAccount->size()), 8,
+                  buffer);
+
+  for (const auto& entry : *m_addressToAccount) {
+    const Account& account = entry.second;
+    buffer.insert(buffer.end(), entry.first.begin(), entry.first.end());
+    AppendBigEndian(account.GetBalance(), UINT128_SIZE, buffer);
+    AppendBigEndian(account.GetNonce(), 8, buffer);
+    buffer.insert(buffer.end(), account.GetStorageRoot().begin(),
+                  account.GetStorageRoot().end());
+    AppendBigEndian(static_cast<uint32_t>(account.GetCode().size()), 4,
+                    buffer);
+    buffer.insert(buffer.end(), account.GetCode().begin(),
+                  account.GetCode().end());
+
+    if (buffer.size() >= 1024 * 1024) {
+      sha2.Update(buffer);
+      file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+      buffer.clear();
+    }
+  }
+
+  if (!buffer.empty()) {
+    sha2.Update(buffer);
+  }
+  const bytes checksum = sha2.Finalize();
+  buffer.insert(buffer.end(), checksum.begin(), checksum.end());
+  file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+  file.close();
+
+  boost::system::error_code ec;
+  if (file.fail()) {
+    LOG_GENERAL(WARNING, "Cannot write " << tmpName);
+    boost::filesystem::remove(tmpName, ec);
+    return false;
+  }
+
+  boost::filesystem::rename(tmpName, RESTART_SNAPSHOT_FILE, ec);
+  if (ec) {
+    LOG_GENERAL(WARNING, "Cannot rename " << tmpName << ": " << ec.message());
+    return false;
+  }
+
+  LOG_GENERAL(INFO, "Saved " << m_addressToAccount->size()
+                             << " accounts for restart in "
+                             << r_timer_end(startTime) / 1000 << " ms");
+  return true;
+}
+
+bool AccountStore::LoadRestartSnapshot(const h256& root) {
+  LOG_MARKER();
+
+  auto startTime = r_timer_start();
+
+  int fd = open(RESTART_SNAPSHOT_FILE.c_str(), O_RDONLY);
+  if (fd < 0) {
+    LOG_GENERAL(INFO, "No restart snapshot, reading the state trie");
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 ||
+      static_cast<uint64_t>(st.st_size) <
+          RESTART_SNAPSHOT_HEADER_SIZE + RESTART_SNAPSHOT_CHECKSUM_SIZE) {
+    LOG_GENERAL(WARNING, "Restart snapshot is truncated");
+    close(fd);
+    return false;
+  }
+  const size_t size = st.st_size;
+  void* addr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (addr == MAP_FAILED) {
+    LOG_GENERAL(WARNING, "Cannot map restart snapshot: " << strerror(errno));
+    return false;
+  }
+  const auto* data = static_cast<const uint8_t*>(addr);
+  madvise(addr, size, MADV_SEQUENTIAL);
+
+  auto fail = [&](const string& reason) {
+    LOG_GENERAL(WARNING, "Restart snapshot not used: " << reason);
+    munmap(addr, size);
+    m_addressToAccount->clear();
+    return false;
+  };
+
+  if (memcmp(data, RESTART_SNAPSHOT_MAGIC, sizeof(RESTART_SNAPSHOT_MAGIC)) !=
+          0 ||
+      ReadBigEndian<uint32_t>(data + 4, 4) != RESTART_SNAPSHOT_VERSION) {
+    return fail("unknown format");
+  }
+  if (h256(data + 8, h256::ConstructFromPointer) != root) {
+    return fail("written for another state root");
+  }
+
+  const size_t end = size - RESTART_SNAPSHOT_CHECKSUM_SIZE;
+  SHA2<HASH_TYPE::HASH_VARIANT_256> sha2;
+  sha2.Update(data, end);
+  if (!equal(data + end, data + size, sha2.Finalize().begin())) {
+    return fail("checksum mismatch");
+  }
+
+  const uint64_t count = ReadBigEndian<uint64_t>(data + 40, 8);
+  m_addressToAccount->clear();
+  m_addressToAccount->reserve(count);
+  size_t pos = RESTART_SNAPSHOT_HEADER_SIZE;
+  for (uint64_t i = 0; i < count; i++) {
+    if (end - pos < RESTART_SNAPSHOT_ENTRY_SIZE) {
+      return fail("entries are truncated");
+    }
+    const Address address(data + pos, Address::ConstructFromPointer);
+    Account account(ReadBigEndian<uint128_t>(data + pos + 20, UINT128_SIZE),
+                    ReadBigEndian<uint64_t>(data + pos + 36, 8));
+    const h256 storageRoot(data + pos + 44, h256::ConstructFromPointer);
+    const uint32_t codeSize = ReadBigEndian<uint32_t>(data + pos + 76, 4);
+    pos += RESTART_SNAPSHOT_ENTRY_SIZE;
+
+    if (end - pos < codeSize) {
+      return fail("code is truncated");
+    }
+    if (codeSize > 0) {
+      account.SetCode(bytes(data + pos, data + pos + codeSize));
+      account.SetStorageRoot(storageRoot);
+      pos += codeSize;
+    }
+    m_addressToAccount->emplace(address, move(account));
+  }
+  if (pos != end) {
+    return fail("trailing data");
+  }
+
+  munmap(addr, size);
+  m_state.setRoot(root);
+
+  LOG_GENERAL(INFO, "Loaded " << count << " accounts from restart snapshot in "
+                              << r_timer_end(startTime) / 1000 << " ms");
   return true;
 }
 
@@ -317,6 +854,240 @@ bool AccountStore::UpdateAccountsTemp(const uint64_t& blockNum,
                                             transaction, receipt);
 }
 
+namespace {
+const unsigned int MIN_PAYMENTS_PER_JOB = 16;
+const unsigned int MIN_ACCOUNTS_PER_PREFETCH_JOB = 8;
+
+/// Splits [0, count) into contiguous ranges of at least minPerJob, runs the
+/// first one on this thread and the others on up to numThreads threads of
+/// pool, and waits for all of them
+void RunRanges(size_t count, size_t minPerJob, ThreadPool* pool,
+               unsigned int numThreads,
+               const function<void(size_t, size_t)>& runRange) {
+  const size_t numJobs =
+      min<size_t>((pool != nullptr) ? numThreads + 1 : 1,
+                  (count + minPerJob - 1) / minPerJob);
+  const size_t jobSize = (numJobs > 0) ? (count + numJobs - 1) / numJobs : 0;
+
+  mutex mutexDone;
+  condition_variable cvDone;
+  size_t jobsLeft = 0;
+
+  vector<ThreadPool::Job> jobs;
+  for (size_t begin = jobSize; begin < count; begin += jobSize) {
+    const size_t end = min(begin + jobSize, count);
+    jobs.emplace_back([&runRange, &mutexDone, &cvDone, &jobsLeft, begin,
+                       end]() {
+      runRange(begin, end);
+      lock_guard<mutex> g(mutexDone);
+      if (--jobsLeft == 0) {
+        cvDone.notify_one();
+      }
+    });
+  }
+
+  if (!jobs.empty()) {
+    jobsLeft = jobs.size();
+    pool->AddJobs(jobs.begin(), jobs.end());
+  }
+
+  runRange(0, min(jobSize, count));
+
+  unique_lock<mutex> lock(mutexDone);
+  cvDone.wait(lock, [&jobsLeft] { return jobsLeft == 0; });
+}
+
+/// The few accounts of one payment, so that it can run beside the others
+class PaymentOverlay : public AccountStoreBase<map<Address, Account>> {
+ public:
+  map<Address, Account>& GetAccounts() { return *m_addressToAccount; }
+
+  bool Run(const Transaction& transaction, TransactionReceipt& receipt) {
+    // As in AccountStoreSC::UpdateAccounts for a normal transaction
+    const Address toAddr = transaction.GetToAddr();
+    const Account* toAccount = GetAccount(toAddr);
+    if (toAccount != nullptr && toAccount->isContract()) {
+      LOG_GENERAL(WARNING, "Contract account won't accept normal transaction");
+      // The sender would not have been looked up yet
+      if (transaction.GetSenderAddr() != toAddr) {
+        m_addressToAccount->erase(transaction.GetSenderAddr());
+      }
+      return false;
+    }
+    return UpdateAccounts(transaction, receipt);
+  }
+};
+
+/// Whether a payment sees the same accounts in both, as far as it reads them
+bool SamePaymentInputs(const map<Address, Account>& a,
+                       const map<Address, Account>& b) {
+  return a.size() == b.size() &&
+         equal(a.begin(), a.end(), b.begin(),
+               [](const pair<const Address, Account>& x,
+                  const pair<const Address, Account>& y) {
+                 return x.first == y.first &&
+                        x.second.GetBalance() == y.second.GetBalance() &&
+                        x.second.GetNonce() == y.second.GetNonce() &&
+                        x.second.isContract() == y.second.isContract();
+               });
+}
+}  // namespace
+
+const Account* AccountStore::GetAccountTempReadOnly(const Address& address) {
+  // Not through m_accountStoreTemp->GetAccount, which would leave a copy
+  // in the temp state (and so in the delta) for a txn never committed
+  const auto& tempAccounts = *m_accountStoreTemp->GetAddressToAccount();
+  auto it = tempAccounts.find(address);
+  return (it != tempAccounts.end()) ? &it->second : GetAccount(address);
+}
+
+void AccountStore::ExecutePaymentsTemp(const vector<Transaction>& txns,
+                                       const vector<bool>& eligible,
+                                       vector<PaymentResult>& results,
+                                       ThreadPool* pool,
+                                       unsigned int numThreads) {
+  lock_guard<mutex> g(m_mutexDelta);
+
+  results.resize(txns.size());
+
+  // Copies are taken here, on one thread, since looking up the parent
+  // store may fill its cache. The runs below only touch their own copies.
+  vector<PaymentOverlay> overlays(txns.size());
+  vector<size_t> toRun;
+  lock_guard<mutex> preExecutedLock(m_mutexPreExecuted);
+  for (size_t i = 0; i < txns.size(); i++) {
+    results.at(i).m_ok = false;
+    if (!eligible.at(i)) {
+      continue;
+    }
+    for (const auto& address :
+         {txns.at(i).GetSenderAddr(), txns.at(i).GetToAddr()}) {
+      const Account* account = GetAccountTempReadOnly(address);
+      if (account != nullptr) {
+        overlays.at(i).AddAccount(address, *account);
+      }
+    }
+
+    // A payment already run on the same accounts needs no second run; the
+    // receipt also has to be for the same epoch
+    auto pre = m_preExecutedPayments.find(txns.at(i).GetTranID());
+    if (pre != m_preExecutedPayments.end() &&
+        SamePaymentInputs(pre->second.m_preState,
+                          overlays.at(i).GetAccounts()) &&
+        pre->second.m_result.m_receipt.GetJsonValue()["epoch_num"] ==
+            results.at(i).m_receipt.GetJsonValue()["epoch_num"]) {
+      results.at(i) = pre->second.m_result;
+      continue;
+    }
+
+    toRun.emplace_back(i);
+  }
+
+  auto runRange = [&txns, &overlays, &results, &toRun](size_t begin,
+                                                       size_t end) {
+    for (size_t j = begin; j < end; j++) {
+      const size_t i = toRun.at(j);
+      PaymentResult& result = results.at(i);
+      result.m_ok = overlays.at(i).Run(txns.at(i), result.m_receipt);
+      result.m_accounts.swap(overlays.at(i).GetAccounts());
+    }
+  };
+
+  RunRanges(toRun.size(), MIN_PAYMENTS_PER_JOB, pool, numThreads, runRange);
+}
+
+void AccountStore::PrefetchAccounts(const vector<Address>& addresses,
+                                    ThreadPool* pool,
+                                    unsigned int numThreads) {
+  // Held like the execution that would otherwise fault the accounts in
+  lock_guard<mutex> g(m_mutexDelta);
+
+  vector<Address> toLoad;
+  {
+    shared_lock<shared_timed_mutex> lock(m_mutexPrimary);
+    const auto& tempAccounts = *m_accountStoreTemp->GetAddressToAccount();
+    unordered_set<Address> seen;
+    for (const auto& address : addresses) {
+      if (seen.insert(address).second && (tempAccounts.count(address) == 0) &&
+          (m_addressToAccount->count(address) == 0)) {
+        toLoad.emplace_back(address);
+      }
+    }
+  }
+
+  if (toLoad.empty()) {
+    return;
+  }
+
+  // The trie and the contract code are only read here, as by
+  // GetCommittedAccount, so the lookups can run side by side
+  vector<Account> accounts(toLoad.size());
+  vector<unsigned char> found(toLoad.size(), 0);
+  RunRanges(toLoad.size(), MIN_ACCOUNTS_PER_PREFETCH_JOB, pool, numThreads,
+            [this, &toLoad, &accounts, &found](size_t begin, size_t end) {
+              for (size_t i = begin; i < end; i++) {
+                found.at(i) = GetAccountFromTrie(toLoad.at(i), accounts.at(i));
+              }
+            });
+
+  unique_lock<shared_timed_mutex> lock(m_mutexPrimary);
+  for (size_t i = 0; i < toLoad.size(); i++) {
+    if (found.at(i)) {
+      m_addressToAccount->emplace(toLoad.at(i), move(accounts.at(i)));
+    }
+  }
+}
+
+void AccountStore::PreExecutePayments(const vector<Transaction>& txns,
+                                      const uint64_t& epochNum) {
+  unordered_map<TxnHash, PreExecutedPayment> preExecuted;
+  // The accounts as the payments so far have left them
+  map<Address, Account> state;
+
+  for (const auto& txn : txns) {
+    PreExecutedPayment entry;
+    PaymentOverlay overlay;
+    for (const auto& address : {txn.GetSenderAddr(), txn.GetToAddr()}) {
+      auto it = state.find(address);
+      if (it != state.end()) {
+        overlay.AddAccount(address, it->second);
+        entry.m_preState.emplace(address, it->second);
+        continue;
+      }
+      lock_guard<mutex> g(m_mutexDelta);
+      const Account* account = GetAccountTempReadOnly(address);
+      if (account != nullptr) {
+        overlay.AddAccount(address, *account);
+        entry.m_preState.emplace(address, *account);
+      }
+    }
+
+    entry.m_result.m_receipt.SetEpochNum(epochNum);
+    entry.m_result.m_ok = overlay.Run(txn, entry.m_result.m_receipt);
+    entry.m_result.m_accounts.swap(overlay.GetAccounts());
+
+    // As CommitPaymentTemp would leave them, whether or not it went through
+    for (const auto& account : entry.m_result.m_accounts) {
+      state[account.first] = account.second;
+    }
+
+    preExecuted[txn.GetTranID()] = move(entry);
+  }
+
+  lock_guard<mutex> g(m_mutexPreExecuted);
+  m_preExecutedPayments.swap(preExecuted);
+}
+
+void AccountStore::CommitPaymentTemp(const PaymentResult& result) {
+  lock_guard<mutex> g(m_mutexDelta);
+
+  // The sequential run would have copied the same accounts into the temp
+  // state, whether or not the payment went through
+  for (const auto& entry : result.m_accounts) {
+    (*m_accountStoreTemp->GetAddressToAccount())[entry.first] = entry.second;
+  }
+}
+
 bool AccountStore::UpdateCoinbaseTemp(const Address& rewardee,
                                       const Address& genesisAddress,
                                       const uint128_t& amount) {
@@ -331,13 +1102,35 @@ bool AccountStore::UpdateCoinbaseTemp(const Address& rewardee,
   // Should the nonce increase ??
 }
 
+size_t AccountStore::UpdateCoinbaseTemp(
+    const vector<pair<Address, uint128_t>>& credits,
+    const Address& genesisAddress, vector<bool>& paid) {
+  lock_guard<mutex> g(m_mutexDelta);
+
+  paid.assign(credits.size(), false);
+  size_t numPaid = 0;
+  for (size_t i = 0; i < credits.size(); i++) {
+    const Address& rewardee = credits[i].first;
+    if (m_accountStoreTemp->GetAccount(rewardee) == nullptr) {
+      m_accountStoreTemp->AddAccount(rewardee, {0, 0});
+    }
+    if (m_accountStoreTemp->TransferBalance(genesisAddress, rewardee,
+                                            credits[i].second)) {
+      paid[i] = true;
+      numPaid++;
+    }
+  }
+  return numPaid;
+}
+
 boost::multiprecision::uint128_t AccountStore::GetNonceTemp(
     const Address& address) {
   lock_guard<mutex> g(m_mutexDelta);
 
-  if (m_accountStoreTemp->GetAddressToAccount()->find(address) !=
-      m_accountStoreTemp->GetAddressToAccount()->end()) {
-    return m_accountStoreTemp->GetNonce(address);
+  const auto& tempAccounts = *m_accountStoreTemp->GetAddressToAccount();
+  auto it = tempAccounts.find(address);
+  if (it != tempAccounts.end()) {
+    return it->second.GetNonce();
   } else {
     return this->GetNonce(address);
   }
@@ -391,10 +1184,14 @@ void AccountStore::RevertCommitTemp() {
     // LOG_GENERAL(INFO, "Revert changed address: " << entry.first);
     (*m_addressToAccount)[entry.first] = entry.second;
     UpdateStateTrie(entry.first, entry.second);
+    m_readSnapshotDirty.insert(entry.first);
   }
   for (auto const entry : m_addressToAccountRevCreated) {
     // LOG_GENERAL(INFO, "Remove created address: " << entry.first);
     RemoveAccount(entry.first);
     RemoveFromTrie(entry.first);
+    m_readSnapshotDirty.insert(entry.first);
   }
+
+  PublishReadSnapshot(false);
 }
@@ -19,10 +19,12 @@
 #define __ACCOUNTSTORE_H__
 
 #include <json/json.h>
+#include <functional>
 #include <map>
 #include <set>
 #include <shared_mutex>
 #include <unordered_map>
+#include <unordered_set>
 
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wunused-parameter"
@@ -42,11 +44,21 @@
 #include "depends/libTrie/TrieDB.h"
 #include "libCrypto/Schnorr.h"
 #include "libData/AccountData/Transaction.h"
+#include "libUtils/MemoryStats.h"
+#include "libUtils/ThreadPool.h"
 
 using StateHash = dev::h256;
 
 class AccountStore;
 
+/// Outcome of a plain transfer run on private copies of the accounts it
+/// touches, waiting to be applied to the temp state
+struct PaymentResult {
+  bool m_ok;
+  TransactionReceipt m_receipt;
+  std::map<Address, Account> m_accounts;
+};
+
 class AccountStoreTemp : public AccountStoreSC<std::map<Address, Account>> {
   // shared_ptr<unordered_map<Address, Account>> m_superAddressToAccount;
   AccountStore& m_parent;
@@ -58,6 +70,9 @@ class AccountStoreTemp : public AccountStoreSC<std::map<Address, Account>> {
 
   bool DeserializeDelta(const bytes& src, unsigned int offset);
 
+  bool DeserializeDeltas(const std::vector<const bytes*>& deltas,
+                         std::vector<bool>& applied);
+
   /// Returns the Account associated with the specified address.
   Account* GetAccount(const Address& address) override;
 
@@ -90,20 +105,103 @@ class AccountStore
 
   bytes m_stateDeltaSerialized;
 
+  /// A payment run by PreExecutePayments, with the accounts it started from
+  struct PreExecutedPayment {
+    std::map<Address, Account> m_preState;
+    PaymentResult m_result;
+  };
+  std::mutex m_mutexPreExecuted;
+  std::unordered_map<TxnHash, PreExecutedPayment> m_preExecutedPayments;
+
+  /// The account as the temp state sees it, without copying it into the
+  /// temp state. Requires m_mutexDelta.
+  const Account* GetAccountTempReadOnly(const Address& address);
+
+  /// One published version of the committed accounts. A version holds the
+  /// accounts changed since its parent (nullptr for a removed one) and
+  /// leaves the rest to the parent, so publishing costs as much as the
+  /// delta did. Never changed once published.
+  struct ReadSnapshot {
+    uint64_t m_version = 0;
+    dev::h256 m_stateRoot;
+    std::shared_ptr<const ReadSnapshot> m_parent;
+    unsigned int m_depth = 0;
+    std::unordered_map<Address, std::shared_ptr<const Account>> m_accounts;
+  };
+  /// Only accessed through std::atomic_load and std::atomic_store
+  std::shared_ptr<const ReadSnapshot> m_readSnapshot;
+  /// Accounts changed since the last publish. Requires m_mutexPrimary.
+  std::unordered_set<Address> m_readSnapshotDirty;
+
+  /// Publishes the accounts changed since the last publish, or all of them
+  /// if full, as the next read snapshot. Requires a unique lock on
+  /// m_mutexPrimary.
+  void PublishReadSnapshot(bool full);
+
   AccountStore();
   ~AccountStore();
 
   /// Store the trie root to leveldb
   void MoveRootToDisk(const dev::h256& root);
 
+  /// Writes the accounts, as RetrieveFromDisk would rebuild them, to the
+  /// restart snapshot file, tagged with the committed state root. Requires
+  /// m_mutexPrimary.
+  bool SaveRestartSnapshot(const dev::h256& root) const;
+
+  /// Maps the restart snapshot file and loads the accounts from it if it
+  /// was written for root and is intact. Requires a unique lock on
+  /// m_mutexPrimary.
+  bool LoadRestartSnapshot(const dev::h256& root);
+
  public:
   /// Returns the singleton AccountStore instance.
   static AccountStore& GetInstance();
 
+  /// Returns the account as of the last committed state, for readers such
+  /// as the RPC servers. Served from the read snapshot without waiting for
+  /// a commit in progress, unless the account was never published (e.g.,
+  /// it is still only on disk). Returns nullptr if there is no account.
+  std::shared_ptr<const Account> GetCommittedAccount(
+      const Address& address) const;
+
+  /// Version of the read snapshot GetCommittedAccount serves from, bumped
+  /// on every commit
+  uint64_t GetReadSnapshotVersion() const;
+
+  /// Estimated memory held by the live and temp accounts, the read
+  /// snapshots and the state trie nodes in memory
+  MemoryUsage GetMemoryUsage();
+
   bool Serialize(bytes& src, unsigned int offset) const override;
 
   bool Deserialize(const bytes& src, unsigned int offset) override;
 
+  /// Splits the state into chunks of up to STATE_SNAPSHOT_CHUNK_ACCOUNTS
+  /// accounts taken in address order, so that nodes holding the same state
+  /// produce the same chunks, and returns the hash of each chunk
+  bool GetSnapshotChunks(std::vector<bytes>& chunks,
+                         std::vector<dev::h256>& chunkHashes) const;
+
+  /// Rebuilds the state from chunks made by GetSnapshotChunks, checking each
+  /// one against its hash and the resulting trie against stateRoot
+  bool SetSnapshotChunks(const std::vector<bytes>& chunks,
+                         const std::vector<dev::h256>& chunkHashes,
+                         const dev::h256& stateRoot);
+
+  /// Adds the accounts of one snapshot chunk to the state. The trie root
+  /// does not depend on the order in which chunks are added.
+  bool AddSnapshotChunk(const bytes& chunk);
+
+  /// Returns the content address of a snapshot chunk
+  static dev::h256 GetSnapshotChunkHash(const bytes& chunk);
+
+  /// Loads an empty store with the accounts next hands out, until it
+  /// returns false, and builds the state trie from them in one pass. The
+  /// addresses must come in ascending order, each once; otherwise nothing
+  /// is imported and false is returned.
+  bool ImportAccounts(const std::function<bool(Address&, Account&)>& next);
+
   bool SerializeDelta();
 
   void GetSerializedDelta(bytes& dst);
@@ -113,6 +211,11 @@ class AccountStore
 
   bool DeserializeDeltaTemp(const bytes& src, unsigned int offset);
 
+  /// Same as calling DeserializeDeltaTemp on each delta in order, but merges
+  /// them in parallel (see Messenger::GetAccountStoreDeltas)
+  bool DeserializeDeltasTemp(const std::vector<const bytes*>& deltas,
+                             std::vector<bool>& applied);
+
   /// Empty the state trie, must be called explicitly otherwise will retrieve
   /// the historical data
   void Init() override;
@@ -122,6 +225,16 @@ class AccountStore
   bool MoveUpdatesToDisk();
   void DiscardUnsavedUpdates();
 
+  /// With STATE_ARCHIVE_MODE, writes out the state trie nodes not on disk
+  /// yet and records the state root as that of final block blockNum
+  bool RetainStateRoot(const uint64_t& blockNum);
+
+  /// Reads the account at address as it was after final block blockNum,
+  /// straight from the retained state root of that block. False if no root
+  /// was retained for it or the account did not exist then.
+  bool GetAccountAt(const uint64_t& blockNum, const Address& address,
+                    Account& account);
+
   bool RetrieveFromDisk();
 
   bool UpdateAccountsTemp(const uint64_t& blockNum,
@@ -129,6 +242,37 @@ class AccountStore
                           const Transaction& transaction,
                           TransactionReceipt& receipt);
 
+  /// Runs plain transfers (no code, no data) concurrently on the pool, each
+  /// against copies of its sender and recipient taken from the temp state.
+  /// The transactions must not share any account. Only those with
+  /// eligible[i] set are run; the temp state is left untouched until
+  /// CommitPaymentTemp, so results[i] can be dropped if txns[i] is not taken.
+  /// Receipts already in results (e.g., with the epoch set) are filled in.
+  /// Runs are spread over up to numThreads threads of pool besides the caller.
+  void ExecutePaymentsTemp(const std::vector<Transaction>& txns,
+                           const std::vector<bool>& eligible,
+                           std::vector<PaymentResult>& results,
+                           ThreadPool* pool, unsigned int numThreads);
+
+  /// Loads the accounts, and the code of contracts among them, from the state
+  /// trie ahead of execution, which would otherwise fault them in one at a
+  /// time. The lookups are spread over up to numThreads threads of pool
+  /// besides the caller. Accounts already loaded are skipped.
+  void PrefetchAccounts(const std::vector<Address>& addresses,
+                        ThreadPool* pool, unsigned int numThreads);
+
+  /// Applies one result of ExecutePaymentsTemp to the temp state, leaving it
+  /// as UpdateAccountsTemp on that transaction would have
+  void CommitPaymentTemp(const PaymentResult& result);
+
+  /// Runs plain transfers ahead of time, one after the other in the given
+  /// order, against private copies of the accounts taken from the temp
+  /// state. ExecutePaymentsTemp then reuses the result of a payment whose
+  /// sender and recipient still have the balance and nonce it started from.
+  /// Replaces the results of the previous call.
+  void PreExecutePayments(const std::vector<Transaction>& txns,
+                          const uint64_t& epochNum);
+
   void AddAccountTemp(const Address& address, const Account& account) {
     m_accountStoreTemp->AddAccount(address, account);
   }
@@ -143,6 +287,7 @@ class AccountStore
                                        const bool fullCopy = false,
                                        const bool reversible = false) {
     (*m_addressToAccount)[address] = account;
+    m_readSnapshotDirty.insert(address);
 
     if (reversible) {
       if (fullCopy) {
@@ -161,6 +306,14 @@ class AccountStore
                           const Address& genesisAddress,
                           const boost::multiprecision::uint128_t& amount);
 
+  /// Same as calling UpdateCoinbaseTemp on each of credits in order, but
+  /// takes the delta lock once. Sets paid[i] if credits[i] went through and
+  /// returns how many did.
+  size_t UpdateCoinbaseTemp(
+      const std::vector<std::pair<Address, boost::multiprecision::uint128_t>>&
+          credits,
+      const Address& genesisAddress, std::vector<bool>& paid);
+
   StateHash GetStateDeltaHash();
 
   void CommitTemp();
@@ -20,6 +20,8 @@
 
 #include <json/json.h>
 #include <mutex>
+#include <string>
+#include <vector>
 
 #include "AccountStoreBase.h"
 
@@ -59,11 +61,15 @@ class AccountStoreSC : public AccountStoreBase<MAP> {
   TransactionReceipt m_curTranReceipt;
 
   std::string m_root_w_version;
+  std::string m_curCodePath;
 
   unsigned int m_curDepth = 0;
 
   bool ParseContractCheckerOutput(const std::string& checkerPrint);
 
+  bool ReadInterpreterOutput(const std::string& runnerPrint,
+                             std::string& outStr);
+
   bool ParseCreateContract(uint64_t& gasRemained,
                            const std::string& runnerPrint);
   bool ParseCreateContractJsonOutput(const Json::Value& _json,
@@ -75,15 +81,30 @@ class AccountStoreSC : public AccountStoreBase<MAP> {
 
   Json::Value GetBlockStateJson(const uint64_t& BlockNum) const;
 
-  std::string GetContractCheckerCmdStr(const std::string& root_w_version);
-  std::string GetCreateContractCmdStr(const std::string& root_w_version,
-                                      const uint64_t& available_gas);
-  std::string GetCallContractCmdStr(const std::string& root_w_version,
-                                    const uint64_t& available_gas);
+  std::vector<std::string> GetContractCheckerArgs(
+      const std::string& root_w_version);
+  std::vector<std::string> GetCreateContractArgs(
+      const std::string& root_w_version, const uint64_t& available_gas);
+  std::vector<std::string> GetCallContractArgs(
+      const std::string& root_w_version, const uint64_t& available_gas);
+
+  /// Runs scilla-checker or scilla-runner on the exported files, on the
+  /// Scilla server if one is configured, else as a child process
+  bool InvokeInterpreter(bool isChecker, const Address& contractAddr,
+                         const std::string& root_w_version,
+                         std::vector<std::string> args,
+                         std::string& interpreterPrint);
+
+  /// Answers a lazy state server's field lookup for the running contract
+  bool ServeStateRequest(const Address& contractAddr,
+                         const std::string& method, const Json::Value& params,
+                         Json::Value& result);
 
   bool PrepareRootPathWVersion(std::string& root_w_version,
                                const uint32_t& scilla_version);
 
+  void PrepareScillaDirectories();
+
   // Generate input for interpreter to check the correctness of contract
   void ExportCreateContractFiles(const Account& contract);
 
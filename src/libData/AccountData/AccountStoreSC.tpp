@@ -18,6 +18,8 @@
 
 #include <boost/filesystem.hpp>
 
+#include "ScillaClient.h"
+#include "ScillaCodeCache.h"
 #include "libPersistence/ContractStorage.h"
 #include "libUtils/DataConversion.h"
 #include "libUtils/JsonUtils.h"
@@ -184,8 +186,10 @@ bool AccountStoreSC<MAP>::UpdateAccounts(const uint64_t& blockNum,
     // Undergo scilla checker
     bool ret_checker = true;
     std::string checkerPrint;
-    if (ret && !SysCommand::ExecuteCmdWithOutput(
-                   GetContractCheckerCmdStr(m_root_w_version), checkerPrint)) {
+    if (ret &&
+        !InvokeInterpreter(true, toAddr, m_root_w_version,
+                           GetContractCheckerArgs(m_root_w_version),
+                           checkerPrint)) {
       ret_checker = false;
     }
     if (ret && ret_checker && !ParseContractCheckerOutput(checkerPrint)) {
@@ -194,8 +198,9 @@ bool AccountStoreSC<MAP>::UpdateAccounts(const uint64_t& blockNum,
 
     // Undergo scilla runner
     std::string runnerPrint;
-    if (ret && !SysCommand::ExecuteCmdWithOutput(
-                   GetCreateContractCmdStr(m_root_w_version, gasRemained),
+    if (ret && !InvokeInterpreter(
+                   false, toAddr, m_root_w_version,
+                   GetCreateContractArgs(m_root_w_version, gasRemained),
                    runnerPrint)) {
       ret = false;
     }
@@ -322,8 +327,9 @@ bool AccountStoreSC<MAP>::UpdateAccounts(const uint64_t& blockNum,
       tpStart = r_timer_start();
     }
     std::string runnerPrint;
-    if (ret && !SysCommand::ExecuteCmdWithOutput(
-                   GetCallContractCmdStr(m_root_w_version, gasRemained),
+    if (ret && !InvokeInterpreter(
+                   false, toAddr, m_root_w_version,
+                   GetCallContractArgs(m_root_w_version, gasRemained),
                    runnerPrint)) {
       ret = false;
     }
@@ -399,21 +405,28 @@ Json::Value AccountStoreSC<MAP>::GetBlockStateJson(
 }
 
 template <class MAP>
-void AccountStoreSC<MAP>::ExportCreateContractFiles(const Account& contract) {
-  LOG_MARKER();
-
-  boost::filesystem::remove_all("./" + SCILLA_FILES);
-  boost::filesystem::create_directories("./" + SCILLA_FILES);
+void AccountStoreSC<MAP>::PrepareScillaDirectories() {
+  // The input files are overwritten in place, so only the output of the
+  // previous run must go lest it be read as the result of this one
+  if (!boost::filesystem::exists("./" + SCILLA_FILES)) {
+    boost::filesystem::create_directories("./" + SCILLA_FILES);
+  } else {
+    boost::filesystem::remove(OUTPUT_JSON);
+  }
 
   if (!(boost::filesystem::exists("./" + SCILLA_LOG))) {
     boost::filesystem::create_directories("./" + SCILLA_LOG);
   }
+}
+
+template <class MAP>
+void AccountStoreSC<MAP>::ExportCreateContractFiles(const Account& contract) {
+  LOG_MARKER();
+
+  PrepareScillaDirectories();
 
-  // Scilla code
-  // JSONUtils::writeJsontoFile(INPUT_CODE, contract.GetCode());
-  std::ofstream os(INPUT_CODE);
-  os << DataConversion::CharArrayToString(contract.GetCode());
-  os.close();
+  // Scilla code, written once per code hash
+  m_curCodePath = ScillaCodeCache::GetInstance().GetCodePath(contract);
 
   // Initialize Json
   JSONUtils::writeJsontoFile(INIT_JSON, contract.GetInitJson());
@@ -428,27 +441,25 @@ void AccountStoreSC<MAP>::ExportContractFiles(const Account& contract) {
   LOG_MARKER();
   std::chrono::system_clock::time_point tpStart;
 
-  boost::filesystem::remove_all("./" + SCILLA_FILES);
-  boost::filesystem::create_directories("./" + SCILLA_FILES);
-
-  if (!(boost::filesystem::exists("./" + SCILLA_LOG))) {
-    boost::filesystem::create_directories("./" + SCILLA_LOG);
-  }
+  PrepareScillaDirectories();
 
   if (ENABLE_CHECK_PERFORMANCE_LOG) {
     tpStart = r_timer_start();
   }
-  // Scilla code
-  // JSONUtils::writeJsontoFile(INPUT_CODE, contract.GetCode());
-  std::ofstream os(INPUT_CODE);
-  os << DataConversion::CharArrayToString(contract.GetCode());
-  os.close();
+  // Scilla code, written once per code hash
+  m_curCodePath = ScillaCodeCache::GetInstance().GetCodePath(contract);
 
   // Initialize Json
   JSONUtils::writeJsontoFile(INIT_JSON, contract.GetInitJson());
 
-  // State Json
-  JSONUtils::writeJsontoFile(INPUT_STATE_JSON, contract.GetStorageJson());
+  // State Json; a lazy server fetches the fields it reads on its own
+  if (ScillaClient::IsLazyStateEnabled()) {
+    Json::Value state = Json::arrayValue;
+    state.append(contract.GetBalanceStateJson());
+    JSONUtils::writeJsontoFile(INPUT_STATE_JSON, state);
+  } else {
+    JSONUtils::writeJsontoFile(INPUT_STATE_JSON, contract.GetStorageJson());
+  }
 
   // Block Json
   JSONUtils::writeJsontoFile(INPUT_BLOCKCHAIN_JSON,
@@ -511,40 +522,81 @@ bool AccountStoreSC<MAP>::PrepareRootPathWVersion(
 }
 
 template <class MAP>
-std::string AccountStoreSC<MAP>::GetContractCheckerCmdStr(
+std::vector<std::string> AccountStoreSC<MAP>::GetContractCheckerArgs(
     const std::string& root_w_version) {
-  std::string cmdStr = root_w_version + '/' + SCILLA_CHECKER + " -libdir " +
-                       root_w_version + '/' + SCILLA_LIB + " " + INPUT_CODE;
-
-  LOG_GENERAL(INFO, cmdStr);
-  return cmdStr;
+  return {"-libdir", root_w_version + '/' + SCILLA_LIB, m_curCodePath};
 }
 
 template <class MAP>
-std::string AccountStoreSC<MAP>::GetCreateContractCmdStr(
+std::vector<std::string> AccountStoreSC<MAP>::GetCreateContractArgs(
     const std::string& root_w_version, const uint64_t& available_gas) {
-  std::string cmdStr = root_w_version + '/' + SCILLA_BINARY + " -init " +
-                       INIT_JSON + " -iblockchain " + INPUT_BLOCKCHAIN_JSON +
-                       " -o " + OUTPUT_JSON + " -i " + INPUT_CODE +
-                       " -libdir " + root_w_version + '/' + SCILLA_LIB +
-                       " -gaslimit " + std::to_string(available_gas);
-
-  LOG_GENERAL(INFO, cmdStr);
-  return cmdStr;
+  return {"-init",
+          INIT_JSON,
+          "-iblockchain",
+          INPUT_BLOCKCHAIN_JSON,
+          "-i",
+          m_curCodePath,
+          "-libdir",
+          root_w_version + '/' + SCILLA_LIB,
+          "-gaslimit",
+          std::to_string(available_gas)};
 }
 
 template <class MAP>
-std::string AccountStoreSC<MAP>::GetCallContractCmdStr(
+std::vector<std::string> AccountStoreSC<MAP>::GetCallContractArgs(
     const std::string& root_w_version, const uint64_t& available_gas) {
+  return {"-init",
+          INIT_JSON,
+          "-istate",
+          INPUT_STATE_JSON,
+          "-iblockchain",
+          INPUT_BLOCKCHAIN_JSON,
+          "-imessage",
+          INPUT_MESSAGE_JSON,
+          "-i",
+          m_curCodePath,
+          "-libdir",
+          root_w_version + '/' + SCILLA_LIB,
+          "-gaslimit",
+          std::to_string(available_gas),
+          "-disable-pp-json",
+          "-disable-validate-json"};
+}
+
+template <class MAP>
+bool AccountStoreSC<MAP>::InvokeInterpreter(bool isChecker,
+                                            const Address& contractAddr,
+                                            const std::string& root_w_version,
+                                            std::vector<std::string> args,
+                                            std::string& interpreterPrint) {
+  if (ScillaClient::IsEnabled()) {
+    ScillaClient::RequestHandler handler;
+    if (!isChecker && ScillaClient::IsLazyStateEnabled()) {
+      handler = [this, &contractAddr](const std::string& method,
+                                      const Json::Value& params,
+                                      Json::Value& result) {
+        return ServeStateRequest(contractAddr, method, params, result);
+      };
+    }
+
+    // The server returns the runner output in memory, so no -o is given
+    return ScillaClient::GetInstance().Call(isChecker ? "check" : "run", args,
+                                            interpreterPrint, handler);
+  }
+
+  if (!isChecker) {
+    args.emplace_back("-o");
+    args.emplace_back(OUTPUT_JSON);
+  }
+
   std::string cmdStr =
-      root_w_version + '/' + SCILLA_BINARY + " -init " + INIT_JSON +
-      " -istate " + INPUT_STATE_JSON + " -iblockchain " +
-      INPUT_BLOCKCHAIN_JSON + " -imessage " + INPUT_MESSAGE_JSON + " -o " +
-      OUTPUT_JSON + " -i " + INPUT_CODE + " -libdir " + root_w_version + '/' +
-      SCILLA_LIB + " -gaslimit " + std::to_string(available_gas) +
-      " -disable-pp-json" + " -disable-validate-json";
+      root_w_version + '/' + (isChecker ? SCILLA_CHECKER : SCILLA_BINARY);
+  for (const auto& arg : args) {
+    cmdStr += ' ' + arg;
+  }
+
   LOG_GENERAL(INFO, cmdStr);
-  return cmdStr;
+  return SysCommand::ExecuteCmdWithOutput(cmdStr, interpreterPrint);
 }
 
 template <class MAP>
@@ -568,22 +620,37 @@ bool AccountStoreSC<MAP>::ParseContractCheckerOutput(
 }
 
 template <class MAP>
-bool AccountStoreSC<MAP>::ParseCreateContract(uint64_t& gasRemained,
-                                              const std::string& runnerPrint) {
-  Json::Value jsonOutput;
-  if (!ParseCreateContractOutput(jsonOutput, runnerPrint)) {
+bool AccountStoreSC<MAP>::ServeStateRequest(const Address& contractAddr,
+                                            const std::string& method,
+                                            const Json::Value& params,
+                                            Json::Value& result) {
+  if (method != "fetchStateValue" || !params["vname"].isString()) {
+    LOG_GENERAL(WARNING, "Unexpected Scilla server request " << method);
     return false;
   }
-  return ParseCreateContractJsonOutput(jsonOutput, gasRemained);
+
+  const Account* contract = this->GetAccount(contractAddr);
+  if (contract == nullptr) {
+    LOG_GENERAL(WARNING, "Contract " << contractAddr.hex() << " not found");
+    return false;
+  }
+
+  Json::Value value;
+  result["found"] = contract->GetStorageValue(params["vname"].asString(),
+                                              params["keys"], value);
+  result["value"] = value;
+  return true;
 }
 
 template <class MAP>
-bool AccountStoreSC<MAP>::ParseCreateContractOutput(
-    Json::Value& jsonOutput, const std::string& runnerPrint) {
-  // LOG_MARKER();
+bool AccountStoreSC<MAP>::ReadInterpreterOutput(const std::string& runnerPrint,
+                                                std::string& outStr) {
+  if (ScillaClient::IsEnabled()) {
+    outStr = runnerPrint;
+    return !outStr.empty();
+  }
 
   std::ifstream in(OUTPUT_JSON, std::ios::binary);
-  std::string outStr;
 
   if (!in.is_open()) {
     LOG_GENERAL(WARNING,
@@ -600,6 +667,29 @@ bool AccountStoreSC<MAP>::ParseCreateContractOutput(
               std::istreambuf_iterator<char>()};
   }
 
+  return true;
+}
+
+template <class MAP>
+bool AccountStoreSC<MAP>::ParseCreateContract(uint64_t& gasRemained,
+                                              const std::string& runnerPrint) {
+  Json::Value jsonOutput;
+  if (!ParseCreateContractOutput(jsonOutput, runnerPrint)) {
+    return false;
+  }
+  return ParseCreateContractJsonOutput(jsonOutput, gasRemained);
+}
+
+template <class MAP>
+bool AccountStoreSC<MAP>::ParseCreateContractOutput(
+    Json::Value& jsonOutput, const std::string& runnerPrint) {
+  // LOG_MARKER();
+
+  std::string outStr;
+  if (!ReadInterpreterOutput(runnerPrint, outStr)) {
+    return false;
+  }
+
   LOG_GENERAL(
       INFO,
       "Output: " << std::endl
@@ -678,22 +768,9 @@ bool AccountStoreSC<MAP>::ParseCallContractOutput(
   if (ENABLE_CHECK_PERFORMANCE_LOG) {
     tpStart = r_timer_start();
   }
-  std::ifstream in(OUTPUT_JSON, std::ios::binary);
   std::string outStr;
-
-  if (!in.is_open()) {
-    LOG_GENERAL(WARNING,
-                "Error opening output file or no output file generated");
-
-    // Check the printout
-    if (!runnerPrint.empty()) {
-      outStr = runnerPrint;
-    } else {
-      return false;
-    }
-  } else {
-    outStr = {std::istreambuf_iterator<char>(in),
-              std::istreambuf_iterator<char>()};
+  if (!ReadInterpreterOutput(runnerPrint, outStr)) {
+    return false;
   }
   LOG_GENERAL(INFO, "Output: " << std::endl << outStr);
 
@@ -898,8 +975,9 @@ bool AccountStoreSC<MAP>::ParseCallContractJsonOutput(const Json::Value& _json,
   if (ENABLE_CHECK_PERFORMANCE_LOG) {
     tpStart = r_timer_start();
   }
-  if (!SysCommand::ExecuteCmdWithOutput(
-          GetCallContractCmdStr(m_root_w_version, gasRemained), runnerPrint)) {
+  if (!InvokeInterpreter(false, recipient, m_root_w_version,
+                         GetCallContractArgs(m_root_w_version, gasRemained),
+                         runnerPrint)) {
     return false;
   }
   if (ENABLE_CHECK_PERFORMANCE_LOG) {
@@ -34,9 +34,7 @@ Account* AccountStoreTemp::GetAccount(const Address& address) {
   account = m_parent.GetAccount(address);
   if (account) {
     // LOG_GENERAL(INFO, "Got From Parent");
-    Account newaccount(*account);
-    m_addressToAccount->insert(make_pair(address, newaccount));
-    return &(m_addressToAccount->find(address))->second;
+    return &m_addressToAccount->emplace(address, *account).first->second;
   }
 
   // LOG_GENERAL(INFO, "Got Nullptr");
@@ -54,3 +52,15 @@ bool AccountStoreTemp::DeserializeDelta(const bytes& src, unsigned int offset) {
 
   return true;
 }
+
+bool AccountStoreTemp::DeserializeDeltas(const vector<const bytes*>& deltas,
+                                         vector<bool>& applied) {
+  LOG_MARKER();
+
+  if (!Messenger::GetAccountStoreDeltas(deltas, *this, applied)) {
+    LOG_GENERAL(WARNING, "Messenger::GetAccountStoreDeltas failed.");
+    return false;
+  }
+
+  return true;
+}
@@ -21,6 +21,7 @@
 #include "AccountStoreSC.h"
 #include "depends/libDatabase/MemoryDB.h"
 #include "depends/libDatabase/OverlayDB.h"
+#include "depends/libTrie/TrieHash.h"
 
 template <class DB, class MAP>
 class AccountStoreTrie : public AccountStoreSC<MAP> {
@@ -34,9 +35,33 @@ class AccountStoreTrie : public AccountStoreSC<MAP> {
 
   AccountStoreTrie();
 
+  /// The value stored for an account in the state trie
+  static dev::bytes GetStateTrieValue(const Account& account);
+
   bool UpdateStateTrie(const Address& address, const Account& account);
   bool RemoveFromTrie(const Address& address);
 
+  /// Fills an empty state trie with all accounts in one pass, building the
+  /// subtrees in parallel
+  void BuildStateTrie();
+
+  /// As BuildStateTrie, from entries mapping each address to the value
+  /// GetStateTrieValue gives for its account
+  void BuildStateTrie(const dev::BytesMap& entries);
+
+  /// Decodes the account stored for address in the state trie without
+  /// adding it to the account map
+  bool GetAccountFromTrie(const Address& address, Account& account) const;
+
+  /// As GetAccountFromTrie, from the state trie as it was at root; throws if
+  /// the nodes under root are not in m_db
+  bool GetAccountFromTrie(const dev::h256& root, const Address& address,
+                          Account& account);
+
+  /// Decodes an account from its value in the state trie
+  static bool DecodeStateTrieValue(const Address& address,
+                                   const std::string& value, Account& account);
+
  public:
   virtual void Init() override;
 
@@ -41,53 +41,107 @@ Account* AccountStoreTrie<DB, MAP>::GetAccount(const Address& address) {
     return account;
   }
 
-  std::string accountDataString = m_state.at(address);
-  if (accountDataString.empty()) {
+  Account fromTrie;
+  if (!GetAccountFromTrie(address, fromTrie)) {
     return nullptr;
   }
 
-  dev::RLP accountDataRLP(accountDataString);
+  auto it2 = this->m_addressToAccount->emplace(address, std::move(fromTrie));
+
+  return &it2.first->second;
+}
+
+template <class DB, class MAP>
+bool AccountStoreTrie<DB, MAP>::GetAccountFromTrie(const Address& address,
+                                                   Account& account) const {
+  return DecodeStateTrieValue(address, m_state.at(address), account);
+}
+
+template <class DB, class MAP>
+bool AccountStoreTrie<DB, MAP>::GetAccountFromTrie(const dev::h256& root,
+                                                   const Address& address,
+                                                   Account& account) {
+  dev::SpecificTrieDB<dev::GenericTrieDB<DB>, Address> state(&m_db);
+  state.setRoot(root);
+  return DecodeStateTrieValue(address, state.at(address), account);
+}
+
+template <class DB, class MAP>
+bool AccountStoreTrie<DB, MAP>::DecodeStateTrieValue(const Address& address,
+                                                     const std::string& value,
+                                                     Account& account) {
+  using namespace boost::multiprecision;
+
+  if (value.empty()) {
+    return false;
+  }
+
+  dev::RLP accountDataRLP(value);
   if (accountDataRLP.itemCount() != RLP_ITEM_COUNT) {
     LOG_GENERAL(WARNING, "Account data corrupted");
-    return nullptr;
+    return false;
   }
 
-  auto it2 = this->m_addressToAccount->emplace(
-      std::piecewise_construct, std::forward_as_tuple(address),
-      std::forward_as_tuple(accountDataRLP[0].toInt<uint128_t>(),
-                            accountDataRLP[1].toInt<uint64_t>()));
+  account = Account(accountDataRLP[0].toInt<uint128_t>(),
+                    accountDataRLP[1].toInt<uint64_t>());
 
   // Code Hash
   if (accountDataRLP[3].toHash<dev::h256>() != dev::h256()) {
     // Extract Code Content
-    it2.first->second.SetCode(
+    account.SetCode(
         Contract::ContractStorage::GetContractStorage().GetContractCode(
             address));
-    if (accountDataRLP[3].toHash<dev::h256>() !=
-        it2.first->second.GetCodeHash()) {
+    if (accountDataRLP[3].toHash<dev::h256>() != account.GetCodeHash()) {
       LOG_GENERAL(WARNING, "Account Code Content doesn't match Code Hash")
-      this->m_addressToAccount->erase(it2.first);
-      return nullptr;
+      return false;
     }
     // Storage Root
-    it2.first->second.SetStorageRoot(accountDataRLP[2].toHash<dev::h256>());
+    account.SetStorageRoot(accountDataRLP[2].toHash<dev::h256>());
   }
 
-  return &it2.first->second;
+  return true;
 }
 
 template <class DB, class MAP>
-bool AccountStoreTrie<DB, MAP>::UpdateStateTrie(const Address& address,
-                                                const Account& account) {
-  // LOG_MARKER();
+dev::bytes AccountStoreTrie<DB, MAP>::GetStateTrieValue(
+    const Account& account) {
   dev::RLPStream rlpStream(RLP_ITEM_COUNT);
   rlpStream << account.GetBalance() << account.GetNonce()
             << account.GetStorageRoot() << account.GetCodeHash();
-  m_state.insert(address, &rlpStream.out());
+  return rlpStream.out();
+}
+
+template <class DB, class MAP>
+bool AccountStoreTrie<DB, MAP>::UpdateStateTrie(const Address& address,
+                                                const Account& account) {
+  // LOG_MARKER();
+  m_state.insert(address, GetStateTrieValue(account));
 
   return true;
 }
 
+template <class DB, class MAP>
+void AccountStoreTrie<DB, MAP>::BuildStateTrie() {
+  LOG_MARKER();
+
+  dev::BytesMap entries;
+  for (auto const& entry : *(this->m_addressToAccount)) {
+    entries.emplace(entry.first.asBytes(), GetStateTrieValue(entry.second));
+  }
+
+  BuildStateTrie(entries);
+}
+
+template <class DB, class MAP>
+void AccountStoreTrie<DB, MAP>::BuildStateTrie(const dev::BytesMap& entries) {
+  std::vector<std::pair<dev::h256, dev::bytes>> nodes;
+  const dev::h256 root = dev::buildTrie(entries, nodes);
+  for (const auto& node : nodes) {
+    m_db.insert(node.first, &node.second);
+  }
+  m_state.setRoot(root);
+}
+
 template <class DB, class MAP>
 bool AccountStoreTrie<DB, MAP>::RemoveFromTrie(const Address& address) {
   // LOG_MARKER();
@@ -105,6 +159,11 @@ dev::h256 AccountStoreTrie<DB, MAP>::GetStateRootHash() const {
 
 template <class DB, class MAP>
 bool AccountStoreTrie<DB, MAP>::UpdateStateTrieAll() {
+  if (m_state.isEmpty()) {
+    BuildStateTrie();
+    return true;
+  }
+
   for (auto const& entry : *(this->m_addressToAccount)) {
     if (!UpdateStateTrie(entry.first, entry.second)) {
       return false;
@@ -119,7 +178,7 @@ void AccountStoreTrie<DB, MAP>::RepopulateStateTrie() {
   LOG_MARKER();
   m_state.init();
   m_prevRoot = m_state.root();
-  UpdateStateTrieAll();
+  BuildStateTrie();
 }
 
 template <class DB, class MAP>
@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "PendingTxnQueue.h"
+
+using namespace std;
+using namespace boost::multiprecision;
+
+void PendingTxnQueue::Insert(const Transaction& t) {
+  const Address sender = t.GetSenderAddr();
+  auto& chain = m_chains[sender];
+
+  auto it = chain.find(t.GetNonce());
+  if (it == chain.end()) {
+    chain.emplace(t.GetNonce(), t);
+    return;
+  }
+
+  if (t.GetGasPrice() <= it->second.GetGasPrice()) {
+    return;
+  }
+
+  // Keep a replaced ready head in the ready set under its new key
+  auto ready =
+      m_ready.find(ReadyKey(it->second.GetGasPrice(), it->second.GetTranID()));
+  if (ready != m_ready.end()) {
+    m_ready.erase(ready);
+    m_ready.emplace(ReadyKey(t.GetGasPrice(), t.GetTranID()), sender);
+  }
+  it->second = t;
+}
+
+void PendingTxnQueue::Promote(const Address& sender,
+                              const uint128_t& nextNonce) {
+  auto chain = m_chains.find(sender);
+  if (chain == m_chains.end()) {
+    return;
+  }
+
+  const Transaction& head = chain->second.begin()->second;
+  if (head.GetNonce() == nextNonce) {
+    m_ready.emplace(ReadyKey(head.GetGasPrice(), head.GetTranID()), sender);
+  }
+}
+
+bool PendingTxnQueue::PopReady(Transaction& t) {
+  if (m_ready.empty()) {
+    return false;
+  }
+
+  auto ready = m_ready.begin();
+  auto chain = m_chains.find(ready->second);
+  m_ready.erase(ready);
+
+  t = chain->second.begin()->second;
+  chain->second.erase(chain->second.begin());
+  if (chain->second.empty()) {
+    m_chains.erase(chain);
+  }
+  return true;
+}
+
+void PendingTxnQueue::Clear() {
+  m_chains.clear();
+  m_ready.clear();
+}
@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef __PENDINGTXNQUEUE_H__
+#define __PENDINGTXNQUEUE_H__
+
+#include <functional>
+#include <map>
+#include <unordered_map>
+#include <utility>
+
+#include "Address.h"
+#include "Transaction.h"
+
+/// Transactions whose nonce is ahead of their sender's account, waiting for
+/// the missing nonces to be processed.
+///
+/// Each sender has a chain of pending transactions ordered by nonce. The
+/// head of a chain becomes ready once it carries the sender's next nonce,
+/// and ready heads are handed out highest gas price first. Picking a ready
+/// transaction and promoting a sender are both O(log n).
+class PendingTxnQueue {
+  using ReadyKey = std::pair<boost::multiprecision::uint128_t, TxnHash>;
+
+  struct ReadyOrder {
+    bool operator()(const ReadyKey& a, const ReadyKey& b) const {
+      return (a.first > b.first) || (a.first == b.first && a.second < b.second);
+    }
+  };
+
+  // Looked up once per transaction, never iterated in key order
+  std::unordered_map<Address, std::map<uint64_t, Transaction>> m_chains;
+  std::map<ReadyKey, Address, ReadyOrder> m_ready;
+
+ public:
+  /// Adds a transaction with a nonce beyond the sender's next one. Of two
+  /// transactions with the same sender and nonce, the one with the higher gas
+  /// price is kept.
+  void Insert(const Transaction& t);
+
+  /// Marks the head of the sender's chain ready if it carries nextNonce.
+  /// Call after each attempt to process a transaction of the sender.
+  void Promote(const Address& sender,
+               const boost::multiprecision::uint128_t& nextNonce);
+
+  /// Removes and returns the ready transaction with the highest gas price
+  bool PopReady(Transaction& t);
+
+  bool HasReady() const { return !m_ready.empty(); }
+
+  /// All transactions still queued, ready or not
+  const std::unordered_map<Address, std::map<uint64_t, Transaction>>&
+  GetChains() const {
+    return m_chains;
+  }
+
+  void Clear();
+};
+
+#endif  // __PENDINGTXNQUEUE_H__
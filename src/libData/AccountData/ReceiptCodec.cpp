@@ -0,0 +1,251 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cstring>
+
+#include "ReceiptCodec.h"
+
+using namespace std;
+
+namespace {
+
+const unsigned char FORMAT_VERSION = 1;
+
+/// Opcodes; every other byte stands for itself. None of them can appear
+/// outside a string in the receipt text, which has no spaces, newlines or
+/// control characters besides the tab indentation.
+enum Op : unsigned char {
+  OP_STRING = 0x01,   // varint length, raw contents
+  OP_HEX = 0x02,      // varint length, bytes of "0x..." lowercase hex
+  OP_DECIMAL = 0x03,  // varint value of a canonical decimal string
+  OP_WORD = 0x04,     // index into WORDS
+  OP_TABS = 0x05,     // count of a run of tabs
+};
+
+/// Member names and values common in receipts. Stored receipts refer to
+/// these by index, so entries may only ever be appended.
+const char* const WORDS[] = {
+    // Receipt and event members
+    "address", "cumulative_gas", "epoch_num", "event_logs", "_eventname",
+    "params", "success", "vname", "type", "value",
+    // Scilla errors and messages
+    "errors", "exceptions", "transitions", "accepted", "depth", "addr", "msg",
+    "_tag", "_amount", "_recipient", "line", "message",
+    // Scilla types and values
+    "ByStr20", "Uint128", "Uint32", "Uint64", "String", "BNum", "True",
+    "False", "Bool", "Int32",
+};
+const unsigned int WORD_COUNT = sizeof(WORDS) / sizeof(WORDS[0]);
+
+/// Decimal strings up to this many digits always fit in a uint64_t
+const size_t MAX_DECIMAL_DIGITS = 19;
+
+void PutVarint(uint64_t value, bytes& dst) {
+  while (value >= 0x80) {
+    dst.push_back(static_cast<unsigned char>(value | 0x80));
+    value >>= 7;
+  }
+  dst.push_back(static_cast<unsigned char>(value));
+}
+
+bool GetVarint(const bytes& src, size_t& pos, uint64_t& value) {
+  value = 0;
+  for (unsigned int shift = 0; shift < 64; shift += 7) {
+    if (pos >= src.size()) {
+      return false;
+    }
+    const unsigned char b = src[pos++];
+    value |= static_cast<uint64_t>(b & 0x7f) << shift;
+    if (!(b & 0x80)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+int HexValue(char c) {
+  if (c >= '0' && c <= '9') {
+    return c - '0';
+  }
+  if (c >= 'a' && c <= 'f') {
+    return c - 'a' + 10;
+  }
+  return -1;
+}
+
+bool IsHex(const char* str, size_t size) {
+  if (size < 4 || size % 2 != 0 || str[0] != '0' || str[1] != 'x') {
+    return false;
+  }
+  for (size_t i = 2; i < size; i++) {
+    if (HexValue(str[i]) < 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool IsDecimal(const char* str, size_t size) {
+  if (size == 0 || size > MAX_DECIMAL_DIGITS ||
+      (str[0] == '0' && size > 1)) {
+    return false;
+  }
+  for (size_t i = 0; i < size; i++) {
+    if (str[i] < '0' || str[i] > '9') {
+      return false;
+    }
+  }
+  return true;
+}
+
+/// Appends the string whose contents, escapes included, are str
+void PutString(const char* str, size_t size, bytes& dst) {
+  for (unsigned int i = 0; i < WORD_COUNT; i++) {
+    if (strlen(WORDS[i]) == size && memcmp(WORDS[i], str, size) == 0) {
+      dst.push_back(OP_WORD);
+      dst.push_back(static_cast<unsigned char>(i));
+      return;
+    }
+  }
+
+  if (IsHex(str, size)) {
+    dst.push_back(OP_HEX);
+    PutVarint((size - 2) / 2, dst);
+    for (size_t i = 2; i < size; i += 2) {
+      dst.push_back(static_cast<unsigned char>(HexValue(str[i]) << 4 |
+                                               HexValue(str[i + 1])));
+    }
+    return;
+  }
+
+  if (IsDecimal(str, size)) {
+    dst.push_back(OP_DECIMAL);
+    PutVarint(stoull(string(str, size)), dst);
+    return;
+  }
+
+  dst.push_back(OP_STRING);
+  PutVarint(size, dst);
+  dst.insert(dst.end(), str, str + size);
+}
+
+}  // namespace
+
+bool ReceiptCodec::Encode(const string& json, bytes& dst) {
+  dst.clear();
+  dst.reserve(json.size() / 2);
+  dst.push_back(FORMAT_VERSION);
+
+  const char* pos = json.data();
+  const char* const end = pos + json.size();
+  while (pos < end) {
+    const unsigned char c = *pos;
+    if (c == '"') {
+      const char* close = pos + 1;
+      while (close < end && *close != '"') {
+        close += (*close == '\\') ? 2 : 1;
+      }
+      if (close >= end) {
+        return false;
+      }
+      PutString(pos + 1, close - pos - 1, dst);
+      pos = close + 1;
+    } else if (c == '\t') {
+      const char* run = pos;
+      while (run < end && *run == '\t' && run - pos < 0xff) {
+        run++;
+      }
+      if (run - pos > 1) {
+        dst.push_back(OP_TABS);
+        dst.push_back(static_cast<unsigned char>(run - pos));
+      } else {
+        dst.push_back(c);
+      }
+      pos = run;
+    } else if (c >= OP_STRING && c <= OP_TABS) {
+      return false;
+    } else {
+      dst.push_back(c);
+      pos++;
+    }
+  }
+  return true;
+}
+
+bool ReceiptCodec::Decode(const bytes& src, string& json) {
+  static const char HEX_DIGITS[] = "0123456789abcdef";
+
+  json.clear();
+  if (src.empty() || src[0] != FORMAT_VERSION) {
+    return false;
+  }
+  json.reserve(src.size() * 2);
+
+  size_t pos = 1;
+  uint64_t value;
+  while (pos < src.size()) {
+    const unsigned char c = src[pos++];
+    switch (c) {
+      case OP_STRING:
+        if (!GetVarint(src, pos, value) || value > src.size() - pos) {
+          return false;
+        }
+        json += '"';
+        json.append(src.begin() + pos, src.begin() + pos + value);
+        json += '"';
+        pos += value;
+        break;
+      case OP_HEX:
+        if (!GetVarint(src, pos, value) || value > src.size() - pos) {
+          return false;
+        }
+        json += "\"0x";
+        for (const size_t last = pos + value; pos < last; pos++) {
+          json += HEX_DIGITS[src[pos] >> 4];
+          json += HEX_DIGITS[src[pos] & 0x0f];
+        }
+        json += '"';
+        break;
+      case OP_DECIMAL:
+        if (!GetVarint(src, pos, value)) {
+          return false;
+        }
+        json += '"';
+        json += to_string(value);
+        json += '"';
+        break;
+      case OP_WORD:
+        if (pos >= src.size() || src[pos] >= WORD_COUNT) {
+          return false;
+        }
+        json += '"';
+        json += WORDS[src[pos++]];
+        json += '"';
+        break;
+      case OP_TABS:
+        if (pos >= src.size()) {
+          return false;
+        }
+        json.append(src[pos++], '\t');
+        break;
+      default:
+        json += static_cast<char>(c);
+        break;
+    }
+  }
+  return true;
+}
@@ -0,0 +1,39 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __RECEIPTCODEC_H__
+#define __RECEIPTCODEC_H__
+
+#include <string>
+
+#include "common/BaseType.h"
+
+/// Compact binary form of a receipt's JSON string, as written to tx bodies.
+///
+/// The encoding is lossless over the exact text: decoding gives back the
+/// bytes that were encoded, so receipt hashes do not depend on which form
+/// a receipt was stored in. Member names and common values become
+/// dictionary indices, hex and decimal strings are packed, and indentation
+/// runs shrink to a count.
+class ReceiptCodec {
+ public:
+  /// Returns false if json is not the output of TransactionReceipt::update()
+  static bool Encode(const std::string& json, bytes& dst);
+  static bool Decode(const bytes& src, std::string& json);
+};
+
+#endif  // __RECEIPTCODEC_H__
@@ -0,0 +1,241 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <json/json.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <memory>
+
+#include "ScillaClient.h"
+#include "common/Constants.h"
+#include "libUtils/Logger.h"
+
+using namespace std;
+
+ScillaClient::ScillaClient() : m_socket(-1), m_requestID(0) {}
+
+ScillaClient::~ScillaClient() { Disconnect(); }
+
+ScillaClient& ScillaClient::GetInstance() {
+  static ScillaClient client;
+  return client;
+}
+
+bool ScillaClient::IsEnabled() { return !SCILLA_SERVER_SOCKET.empty(); }
+
+bool ScillaClient::IsLazyStateEnabled() {
+  return IsEnabled() && SCILLA_SERVER_LAZY_STATE;
+}
+
+bool ScillaClient::Connect() {
+  sockaddr_un addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  if (SCILLA_SERVER_SOCKET.size() >= sizeof(addr.sun_path)) {
+    LOG_GENERAL(WARNING, "Scilla server socket path too long: "
+                             << SCILLA_SERVER_SOCKET);
+    return false;
+  }
+  strncpy(addr.sun_path, SCILLA_SERVER_SOCKET.c_str(),
+          sizeof(addr.sun_path) - 1);
+
+  m_socket = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (m_socket < 0) {
+    LOG_GENERAL(WARNING, "Failed to create socket: " << strerror(errno));
+    return false;
+  }
+
+  timeval timeout;
+  timeout.tv_sec = SCILLA_SERVER_TIMEOUT_IN_MS / 1000;
+  timeout.tv_usec = (SCILLA_SERVER_TIMEOUT_IN_MS % 1000) * 1000;
+  setsockopt(m_socket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+  setsockopt(m_socket, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+  if (connect(m_socket, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) <
+      0) {
+    LOG_GENERAL(WARNING, "Failed to connect to Scilla server at "
+                             << SCILLA_SERVER_SOCKET << ": "
+                             << strerror(errno));
+    Disconnect();
+    return false;
+  }
+
+  return true;
+}
+
+void ScillaClient::Disconnect() {
+  if (m_socket >= 0) {
+    close(m_socket);
+    m_socket = -1;
+  }
+  m_readBuffer.clear();
+}
+
+bool ScillaClient::SendAll(const string& data) {
+  size_t sent = 0;
+  while (sent < data.size()) {
+    ssize_t n =
+        send(m_socket, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      LOG_GENERAL(WARNING, "Send to Scilla server failed: " << strerror(errno));
+      return false;
+    }
+    sent += n;
+  }
+  return true;
+}
+
+bool ScillaClient::ReadLine(string& line) {
+  char buffer[4096];
+  size_t pos;
+  while ((pos = m_readBuffer.find('\n')) == string::npos) {
+    ssize_t n = recv(m_socket, buffer, sizeof(buffer), 0);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      LOG_GENERAL(WARNING, "Read from Scilla server failed: "
+                               << (n == 0 ? "connection closed"
+                                          : strerror(errno)));
+      return false;
+    }
+    m_readBuffer.append(buffer, n);
+  }
+  line = m_readBuffer.substr(0, pos);
+  m_readBuffer.erase(0, pos + 1);
+  return true;
+}
+
+bool ScillaClient::ParseMessage(const string& line, Json::Value& msg) {
+  Json::CharReaderBuilder readBuilder;
+  unique_ptr<Json::CharReader> reader(readBuilder.newCharReader());
+  string errors;
+  if (!reader->parse(line.c_str(), line.c_str() + line.size(), &msg,
+                     &errors)) {
+    LOG_GENERAL(WARNING, "Malformed Scilla server message: " << errors);
+    return false;
+  }
+  return true;
+}
+
+bool ScillaClient::Exchange(const string& request,
+                            const RequestHandler& handler,
+                            Json::Value& response) {
+  if (m_socket < 0 && !Connect()) {
+    return false;
+  }
+  if (!SendAll(request)) {
+    Disconnect();
+    return false;
+  }
+
+  // The framing is one message per line, so nothing may be pretty-printed
+  Json::StreamWriterBuilder writeBuilder;
+  writeBuilder["indentation"] = "";
+
+  string line;
+  while (ReadLine(line)) {
+    Json::Value msg;
+    if (!ParseMessage(line, msg)) {
+      break;
+    }
+
+    if (!msg.isMember("method")) {
+      response = msg;
+      return true;
+    }
+
+    Json::Value reply;
+    reply["jsonrpc"] = "2.0";
+    reply["id"] = msg["id"];
+    Json::Value result;
+    if (handler && handler(msg["method"].asString(), msg["params"], result)) {
+      reply["result"] = result;
+    } else {
+      reply["error"]["code"] = -32601;
+      reply["error"]["message"] = "Cannot serve " + msg["method"].asString();
+    }
+    if (!SendAll(Json::writeString(writeBuilder, reply) + '\n')) {
+      break;
+    }
+  }
+
+  Disconnect();
+  return false;
+}
+
+bool ScillaClient::Call(const string& method, const vector<string>& argv,
+                        string& output, const RequestHandler& handler) {
+  LOG_MARKER();
+
+  lock_guard<mutex> g(m_mutex);
+
+  Json::Value params;
+  params["argv"] = Json::arrayValue;
+  for (const auto& arg : argv) {
+    params["argv"].append(arg);
+  }
+
+  Json::Value req;
+  req["jsonrpc"] = "2.0";
+  req["id"] = ++m_requestID;
+  req["method"] = method;
+  req["params"] = params;
+
+  Json::StreamWriterBuilder writeBuilder;
+  writeBuilder["indentation"] = "";
+  const string request = Json::writeString(writeBuilder, req) + '\n';
+
+  // A kept-alive connection may have been dropped by a server restart.
+  // Served requests only read state, so replaying the call is harmless.
+  Json::Value response;
+  if (!Exchange(request, handler, response) &&
+      !Exchange(request, handler, response)) {
+    return false;
+  }
+
+  if (!response["id"].isIntegral() ||
+      response["id"].asUInt() != m_requestID) {
+    LOG_GENERAL(WARNING, "Scilla server response id mismatch");
+    Disconnect();
+    return false;
+  }
+
+  if (response.isMember("error")) {
+    // Interpreter failures still carry their json output in the message
+    const Json::Value& error = response["error"];
+    if (error.isObject() && error["message"].isString()) {
+      output = error["message"].asString();
+      return true;
+    }
+    LOG_GENERAL(WARNING, "Scilla server error: "
+                             << Json::writeString(writeBuilder, response));
+    return false;
+  }
+
+  const Json::Value& result = response["result"];
+  output = result.isString() ? result.asString()
+                             : Json::writeString(writeBuilder, result);
+  return true;
+}
@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef __SCILLACLIENT_H__
+#define __SCILLACLIENT_H__
+
+#include <json/json.h>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/// Connection to a long-lived Scilla interpreter server on a Unix domain
+/// socket.
+///
+/// Each call is a newline-delimited JSON-RPC 2.0 request whose params carry
+/// the same arguments scilla-checker or scilla-runner take on the command
+/// line; the interpreter output comes back in the response instead of an
+/// output file. The connection is kept open across calls and reopened once
+/// if the server has gone away.
+///
+/// While a call is in flight the server may send its own requests on the
+/// same connection (e.g. to fetch contract state lazily); these are passed
+/// to the caller's handler and answered before waiting for the result.
+class ScillaClient {
+ public:
+  /// Serves one server-side request; returns false to answer with an error
+  using RequestHandler =
+      std::function<bool(const std::string& method, const Json::Value& params,
+                         Json::Value& result)>;
+
+ private:
+  std::mutex m_mutex;
+  int m_socket;
+  unsigned int m_requestID;
+  std::string m_readBuffer;
+
+  ScillaClient();
+  ~ScillaClient();
+
+  ScillaClient(ScillaClient const&) = delete;
+  void operator=(ScillaClient const&) = delete;
+
+  bool Connect();
+  void Disconnect();
+  bool SendAll(const std::string& data);
+  bool ReadLine(std::string& line);
+  bool ParseMessage(const std::string& line, Json::Value& msg);
+  bool Exchange(const std::string& request, const RequestHandler& handler,
+                Json::Value& response);
+
+ public:
+  static ScillaClient& GetInstance();
+
+  /// True if SCILLA_SERVER_SOCKET is set, i.e. contracts run on the server
+  static bool IsEnabled();
+
+  /// True if the server also fetches contract fields on demand instead of
+  /// reading the whole state from the exported state file
+  static bool IsLazyStateEnabled();
+
+  /// Runs the named server method ("check" or "run") with the given
+  /// interpreter arguments and returns its output
+  bool Call(const std::string& method, const std::vector<std::string>& argv,
+            std::string& output, const RequestHandler& handler = nullptr);
+};
+
+#endif  // __SCILLACLIENT_H__
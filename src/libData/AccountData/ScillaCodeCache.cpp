@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <boost/filesystem.hpp>
+#include <fstream>
+
+#include "Account.h"
+#include "ScillaCodeCache.h"
+#include "common/Constants.h"
+#include "libUtils/DataConversion.h"
+#include "libUtils/Logger.h"
+
+using namespace std;
+
+ScillaCodeCache::ScillaCodeCache(size_t capacity) : m_capacity(capacity) {}
+
+ScillaCodeCache& ScillaCodeCache::GetInstance() {
+  static ScillaCodeCache cache(SCILLA_CODE_CACHE_SIZE);
+  return cache;
+}
+
+bool ScillaCodeCache::WriteCode(const Account& contract, const string& path) {
+  ofstream os(path, ios::binary | ios::trunc);
+  os << DataConversion::CharArrayToString(contract.GetCode());
+  os.close();
+  if (!os) {
+    LOG_GENERAL(WARNING, "Failed to write contract code to " << path);
+    return false;
+  }
+  return true;
+}
+
+string ScillaCodeCache::GetCodePath(const Account& contract) {
+  if (m_capacity == 0) {
+    return WriteCode(contract, INPUT_CODE) ? INPUT_CODE : "";
+  }
+
+  const dev::h256& codeHash = contract.GetCodeHash();
+
+  lock_guard<mutex> g(m_mutex);
+
+  auto it = m_index.find(codeHash);
+  if (it != m_index.end()) {
+    m_lru.splice(m_lru.begin(), m_lru, it->second);
+    const string& path = it->second->second;
+    // Someone may have cleaned up the scilla files in between
+    if (boost::filesystem::exists(path) || WriteCode(contract, path)) {
+      return path;
+    }
+    m_lru.erase(it->second);
+    m_index.erase(it);
+    return "";
+  }
+
+  const string dir = SCILLA_FILES + "/code";
+  boost::system::error_code ec;
+  boost::filesystem::create_directories(dir, ec);
+
+  const string path = dir + '/' + codeHash.hex() + ".scilla";
+  if (!WriteCode(contract, path)) {
+    return "";
+  }
+
+  m_lru.emplace_front(codeHash, path);
+  m_index.emplace(codeHash, m_lru.begin());
+
+  while (m_lru.size() > m_capacity) {
+    boost::filesystem::remove(m_lru.back().second, ec);
+    m_index.erase(m_lru.back().first);
+    m_lru.pop_back();
+  }
+
+  return path;
+}
+
+void ScillaCodeCache::Clear() {
+  lock_guard<mutex> g(m_mutex);
+  boost::system::error_code ec;
+  for (const auto& entry : m_lru) {
+    boost::filesystem::remove(entry.second, ec);
+  }
+  m_lru.clear();
+  m_index.clear();
+}
+
+size_t ScillaCodeCache::Size() {
+  lock_guard<mutex> g(m_mutex);
+  return m_lru.size();
+}
@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef __SCILLACODECACHE_H__
+#define __SCILLACODECACHE_H__
+
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "depends/common/FixedHash.h"
+
+class Account;
+
+/// Contract code exported for the Scilla interpreter, one file per code hash.
+///
+/// A contract's code is written out the first time it runs and reused by
+/// every later call, across transactions and epochs, until it is evicted
+/// as the least recently used entry. Because a given code always lives at
+/// the same path, a Scilla server can keep its parsed and checked form too.
+class ScillaCodeCache {
+  using Entry = std::pair<dev::h256, std::string>;
+
+  std::mutex m_mutex;
+  std::list<Entry> m_lru;
+  std::unordered_map<dev::h256, std::list<Entry>::iterator> m_index;
+  size_t m_capacity;
+
+  ScillaCodeCache(ScillaCodeCache const&) = delete;
+  void operator=(ScillaCodeCache const&) = delete;
+
+  static bool WriteCode(const Account& contract, const std::string& path);
+
+ public:
+  /// capacity is the number of contracts to keep, 0 disables the cache
+  explicit ScillaCodeCache(size_t capacity);
+
+  static ScillaCodeCache& GetInstance();
+
+  /// Returns the path of a file holding the contract's code, or an empty
+  /// string if it could not be written
+  std::string GetCodePath(const Account& contract);
+
+  /// Drops all entries and their files
+  void Clear();
+
+  size_t Size();
+};
+
+#endif  // __SCILLACODECACHE_H__
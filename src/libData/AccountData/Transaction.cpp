@@ -30,6 +30,33 @@ unsigned char LOW_BITS_MASK = 0x0F;
 unsigned char ACC_COND = 0x1;
 unsigned char TX_COND = 0x2;
 
+const PubKey& TransactionCoreInfo::GetSenderPubKey() const {
+  static const PubKey emptyKey;
+  return senderPubKey ? *senderPubKey : emptyKey;
+}
+
+void TransactionCoreInfo::SetSenderPubKey(const PubKey& pubKey) {
+  senderPubKey = make_shared<const PubKey>(pubKey);
+  senderAddr = Account::GetAddressFromPublicKey(pubKey);
+}
+
+const bytes& TransactionCoreInfo::GetCode() const {
+  static const bytes empty;
+  return code ? *code : empty;
+}
+
+const bytes& TransactionCoreInfo::GetData() const {
+  static const bytes empty;
+  return data ? *data : empty;
+}
+
+shared_ptr<const bytes> TransactionCoreInfo::MakePayload(bytes&& payload) {
+  if (payload.empty()) {
+    return nullptr;
+  }
+  return make_shared<const bytes>(move(payload));
+}
+
 bool Transaction::SerializeCoreFields(bytes& dst, unsigned int offset) const {
   return Messenger::SetTransactionCoreInfo(dst, offset, m_coreInfo);
 }
@@ -41,6 +68,11 @@ Transaction::Transaction(const Transaction& src)
       m_coreInfo(src.m_coreInfo),
       m_signature(src.m_signature) {}
 
+Transaction::Transaction(Transaction&& src) noexcept
+    : m_tranID(src.m_tranID),
+      m_coreInfo(std::move(src.m_coreInfo)),
+      m_signature(src.m_signature) {}
+
 Transaction::Transaction(const bytes& src, unsigned int offset) {
   Deserialize(src, offset);
 }
@@ -48,10 +80,9 @@ Transaction::Transaction(const bytes& src, unsigned int offset) {
 Transaction::Transaction(const uint32_t& version, const uint64_t& nonce,
                          const Address& toAddr, const PairOfKey& senderKeyPair,
                          const uint128_t& amount, const uint128_t& gasPrice,
-                         const uint64_t& gasLimit, const bytes& code,
-                         const bytes& data)
+                         const uint64_t& gasLimit, bytes code, bytes data)
     : m_coreInfo(version, nonce, toAddr, senderKeyPair.second, amount, gasPrice,
-                 gasLimit, code, data) {
+                 gasLimit, move(code), move(data)) {
   bytes txnData;
   SerializeCoreFields(txnData, 0);
 
@@ -67,7 +98,7 @@ Transaction::Transaction(const uint32_t& version, const uint64_t& nonce,
 
   // Generate the signature
   if (!Schnorr::GetInstance().Sign(txnData, senderKeyPair.first,
-                                   m_coreInfo.senderPubKey, m_signature)) {
+                                   m_coreInfo.GetSenderPubKey(), m_signature)) {
     LOG_GENERAL(WARNING, "We failed to generate m_signature.");
   }
 }
@@ -76,20 +107,19 @@ Transaction::Transaction(const TxnHash& tranID, const uint32_t& version,
                          const uint64_t& nonce, const Address& toAddr,
                          const PubKey& senderPubKey, const uint128_t& amount,
                          const uint128_t& gasPrice, const uint64_t& gasLimit,
-                         const bytes& code, const bytes& data,
-                         const Signature& signature)
+                         bytes code, bytes data, const Signature& signature)
     : m_tranID(tranID),
       m_coreInfo(version, nonce, toAddr, senderPubKey, amount, gasPrice,
-                 gasLimit, code, data),
+                 gasLimit, move(code), move(data)),
       m_signature(signature) {}
 
 Transaction::Transaction(const uint32_t& version, const uint64_t& nonce,
                          const Address& toAddr, const PubKey& senderPubKey,
                          const uint128_t& amount, const uint128_t& gasPrice,
-                         const uint64_t& gasLimit, const bytes& code,
-                         const bytes& data, const Signature& signature)
+                         const uint64_t& gasLimit, bytes code, bytes data,
+                         const Signature& signature)
     : m_coreInfo(version, nonce, toAddr, senderPubKey, amount, gasPrice,
-                 gasLimit, code, data),
+                 gasLimit, move(code), move(data)),
       m_signature(signature) {
   bytes txnData;
   SerializeCoreFields(txnData, 0);
@@ -106,15 +136,17 @@ Transaction::Transaction(const uint32_t& version, const uint64_t& nonce,
 
   // Verify the signature
   if (!Schnorr::GetInstance().Verify(txnData, m_signature,
-                                     m_coreInfo.senderPubKey)) {
+                                     m_coreInfo.GetSenderPubKey())) {
     LOG_GENERAL(WARNING, "We failed to verify the input signature.");
   }
 }
 
 Transaction::Transaction(const TxnHash& tranID,
-                         const TransactionCoreInfo coreInfo,
+                         TransactionCoreInfo coreInfo,
                          const Signature& signature)
-    : m_tranID(tranID), m_coreInfo(coreInfo), m_signature(signature) {}
+    : m_tranID(tranID),
+      m_coreInfo(std::move(coreInfo)),
+      m_signature(signature) {}
 
 bool Transaction::Serialize(bytes& dst, unsigned int offset) const {
   if (!Messenger::SetTransaction(dst, offset, *this)) {
@@ -147,11 +179,11 @@ const uint64_t& Transaction::GetNonce() const { return m_coreInfo.nonce; }
 const Address& Transaction::GetToAddr() const { return m_coreInfo.toAddr; }
 
 const PubKey& Transaction::GetSenderPubKey() const {
-  return m_coreInfo.senderPubKey;
+  return m_coreInfo.GetSenderPubKey();
 }
 
-Address Transaction::GetSenderAddr() const {
-  return Account::GetAddressFromPublicKey(GetSenderPubKey());
+const Address& Transaction::GetSenderAddr() const {
+  return m_coreInfo.senderAddr;
 }
 
 const uint128_t& Transaction::GetAmount() const { return m_coreInfo.amount; }
@@ -162,9 +194,9 @@ const uint128_t& Transaction::GetGasPrice() const {
 
 const uint64_t& Transaction::GetGasLimit() const { return m_coreInfo.gasLimit; }
 
-const bytes& Transaction::GetCode() const { return m_coreInfo.code; }
+const bytes& Transaction::GetCode() const { return m_coreInfo.GetCode(); }
 
-const bytes& Transaction::GetData() const { return m_coreInfo.data; }
+const bytes& Transaction::GetData() const { return m_coreInfo.GetData(); }
 
 const Signature& Transaction::GetSignature() const { return m_signature; }
 
@@ -189,6 +221,10 @@ unsigned int Transaction::GetShardIndex(const Address& fromAddr,
   return x % numShards;
 }
 
+unsigned int Transaction::GetSenderShardIndex(unsigned int numShards) const {
+  return GetShardIndex(GetSenderAddr(), numShards);
+}
+
 bool Transaction::operator==(const Transaction& tran) const {
   return ((m_tranID == tran.m_tranID) && (m_signature == tran.m_signature));
 }
@@ -209,3 +245,11 @@ Transaction& Transaction::operator=(const Transaction& src) {
 
   return *this;
 }
+
+Transaction& Transaction::operator=(Transaction&& src) noexcept {
+  m_tranID = src.m_tranID;
+  m_signature = src.m_signature;
+  m_coreInfo = std::move(src.m_coreInfo);
+
+  return *this;
+}
@@ -19,6 +19,7 @@
 #define __TRANSACTION_H__
 
 #include <array>
+#include <memory>
 #include <vector>
 
 #pragma GCC diagnostic push
@@ -34,6 +35,17 @@
 
 using TxnHash = dev::h256;
 
+static_assert(sizeof(boost::multiprecision::uint128_t) == UINT128_SIZE,
+              "uint128_t is expected to be stored inline in 16 bytes");
+
+/// Core fields of a transaction, i.e. the part covered by the signature.
+///
+/// Copies of a transaction share the sender key and the code and data
+/// payloads, which are immutable once the transaction is built, so copying a
+/// transaction into the pool or a block does not allocate. Empty payloads are
+/// held as null pointers. The sender address is derived from the key once,
+/// when the key is set, and travels with the transaction from then on.
+/// Fields are ordered to avoid padding.
 struct TransactionCoreInfo {
   TransactionCoreInfo() = default;
   TransactionCoreInfo(const uint32_t& versionInput, const uint64_t& nonceInput,
@@ -41,27 +53,45 @@ struct TransactionCoreInfo {
                       const PubKey& senderPubKeyInput,
                       const boost::multiprecision::uint128_t& amountInput,
                       const boost::multiprecision::uint128_t& gasPriceInput,
-                      const uint64_t& gasLimitInput, const bytes& codeInput,
-                      const bytes& dataInput)
-      : version(versionInput),
-        nonce(nonceInput),
-        toAddr(toAddrInput),
-        senderPubKey(senderPubKeyInput),
-        amount(amountInput),
+                      const uint64_t& gasLimitInput, bytes codeInput,
+                      bytes dataInput)
+      : amount(amountInput),
         gasPrice(gasPriceInput),
+        nonce(nonceInput),
         gasLimit(gasLimitInput),
-        code(codeInput),
-        data(dataInput) {}
-
-  uint32_t version;
-  uint64_t nonce;  // counter: the number of tx from m_fromAddr
+        code(MakePayload(std::move(codeInput))),
+        data(MakePayload(std::move(dataInput))),
+        toAddr(toAddrInput),
+        version(versionInput) {
+    SetSenderPubKey(senderPubKeyInput);
+  }
+
+  boost::multiprecision::uint128_t amount{0};
+  boost::multiprecision::uint128_t gasPrice{0};
+  uint64_t nonce{0};  // counter: the number of tx from m_fromAddr
+  uint64_t gasLimit{0};
+  std::shared_ptr<const PubKey> senderPubKey;
+  std::shared_ptr<const bytes> code;
+  std::shared_ptr<const bytes> data;
   Address toAddr;
-  PubKey senderPubKey;
-  boost::multiprecision::uint128_t amount;
-  boost::multiprecision::uint128_t gasPrice;
-  uint64_t gasLimit;
-  bytes code;
-  bytes data;
+  /// Set with senderPubKey by SetSenderPubKey
+  Address senderAddr;
+  uint32_t version{0};
+
+  /// Returns the sender key, or an uninitialized key if it is not set.
+  const PubKey& GetSenderPubKey() const;
+
+  /// Sets the sender key and the address derived from it
+  void SetSenderPubKey(const PubKey& pubKey);
+
+  /// Returns the code, or an empty buffer if there is none.
+  const bytes& GetCode() const;
+
+  /// Returns the data, or an empty buffer if there is none.
+  const bytes& GetData() const;
+
+  /// Wraps a payload for sharing, returning nullptr if it is empty.
+  static std::shared_ptr<const bytes> MakePayload(bytes&& payload);
 };
 
 /// Stores information on a single transaction.
@@ -77,13 +107,15 @@ class Transaction : public SerializableDataBlock {
   /// Copy constructor.
   Transaction(const Transaction& src);
 
+  /// Move constructor.
+  Transaction(Transaction&& src) noexcept;
+
   /// Constructor with specified transaction fields.
   Transaction(const uint32_t& version, const uint64_t& nonce,
               const Address& toAddr, const PairOfKey& senderKeyPair,
               const boost::multiprecision::uint128_t& amount,
               const boost::multiprecision::uint128_t& gasPrice,
-              const uint64_t& gasLimit, const bytes& code = {},
-              const bytes& data = {});
+              const uint64_t& gasLimit, bytes code = {}, bytes data = {});
 
   /// Constructor with specified transaction fields.
   Transaction(const TxnHash& tranID, const uint32_t& version,
@@ -91,7 +123,7 @@ class Transaction : public SerializableDataBlock {
               const PubKey& senderPubKey,
               const boost::multiprecision::uint128_t& amount,
               const boost::multiprecision::uint128_t& gasPrice,
-              const uint64_t& gasLimit, const bytes& code, const bytes& data,
+              const uint64_t& gasLimit, bytes code, bytes data,
               const Signature& signature);
 
   /// Constructor with specified transaction fields.
@@ -99,11 +131,11 @@ class Transaction : public SerializableDataBlock {
               const Address& toAddr, const PubKey& senderPubKey,
               const boost::multiprecision::uint128_t& amount,
               const boost::multiprecision::uint128_t& gasPrice,
-              const uint64_t& gasLimit, const bytes& code, const bytes& data,
+              const uint64_t& gasLimit, bytes code, bytes data,
               const Signature& signature);
 
   /// Constructor with core information.
-  Transaction(const TxnHash& tranID, const TransactionCoreInfo coreInfo,
+  Transaction(const TxnHash& tranID, TransactionCoreInfo coreInfo,
               const Signature& signature);
 
   /// Constructor for loading transaction information from a byte stream.
@@ -135,8 +167,8 @@ class Transaction : public SerializableDataBlock {
   //// Returns the sender's Public Key.
   const PubKey& GetSenderPubKey() const;
 
-  /// Returns the sender's Address
-  Address GetSenderAddr() const;
+  /// Returns the sender's Address, derived when the sender key was set
+  const Address& GetSenderAddr() const;
 
   /// Returns the transaction amount.
   const boost::multiprecision::uint128_t& GetAmount() const;
@@ -163,6 +195,9 @@ class Transaction : public SerializableDataBlock {
   static unsigned int GetShardIndex(const Address& fromAddr,
                                     unsigned int numShards);
 
+  /// Shard of the sender, from the address kept with the transaction
+  unsigned int GetSenderShardIndex(unsigned int numShards) const;
+
   /// Equality comparison operator.
   bool operator==(const Transaction& tran) const;
 
@@ -174,6 +209,9 @@ class Transaction : public SerializableDataBlock {
 
   /// Assignment operator.
   Transaction& operator=(const Transaction& src);
+
+  /// Move assignment operator.
+  Transaction& operator=(Transaction&& src) noexcept;
 };
 
 #endif  // __TRANSACTION_H__
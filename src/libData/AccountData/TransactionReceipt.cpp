@@ -16,6 +16,7 @@
  */
 
 #include "TransactionReceipt.h"
+#include "ReceiptCodec.h"
 #include "libMessage/Messenger.h"
 #include "libUtils/JsonUtils.h"
 
@@ -40,6 +41,10 @@ bool TransactionReceipt::Deserialize(const bytes& src, unsigned int offset) {
       return false;
     }
 
+    // Binary receipts are parsed when their JSON is first asked for
+    if (m_objPending) {
+      return true;
+    }
     if (!JSONUtils::convertStrtoJson(m_tranReceiptStr, m_tranReceiptObj)) {
       LOG_GENERAL(WARNING, "Error with convert receipt string to json object");
       return false;
@@ -54,6 +59,7 @@ bool TransactionReceipt::Deserialize(const bytes& src, unsigned int offset) {
 }
 
 void TransactionReceipt::SetResult(const bool& result) {
+  ResolvePending();
   if (result) {
     m_tranReceiptObj["success"] = true;
   } else {
@@ -62,11 +68,13 @@ void TransactionReceipt::SetResult(const bool& result) {
 }
 
 void TransactionReceipt::SetCumGas(const uint64_t& cumGas) {
+  ResolvePending();
   m_cumGas = cumGas;
   m_tranReceiptObj["cumulative_gas"] = to_string(m_cumGas);
 }
 
 void TransactionReceipt::SetEpochNum(const uint64_t& epochNum) {
+  ResolvePending();
   m_tranReceiptObj["epoch_num"] = to_string(epochNum);
 }
 
@@ -77,6 +85,8 @@ void TransactionReceipt::SetString(const std::string& tranReceiptStr) {
       return;
     }
     m_tranReceiptStr = tranReceiptStr;
+    m_objPending = false;
+    m_parsedObj = ParsedObj();
   } catch (const std::exception& e) {
     LOG_GENERAL(WARNING,
                 "Error with TransactionReceipt::SetString." << ' ' << e.what());
@@ -84,17 +94,78 @@ void TransactionReceipt::SetString(const std::string& tranReceiptStr) {
   }
 }
 
+bool TransactionReceipt::GetBinary(bytes& binary) const {
+  return ReceiptCodec::Encode(m_tranReceiptStr, binary);
+}
+
+bool TransactionReceipt::SetBinary(const bytes& binary,
+                                   const uint64_t& cumGas) {
+  if (!ReceiptCodec::Decode(binary, m_tranReceiptStr)) {
+    LOG_GENERAL(WARNING, "Error with decode binary receipt");
+    return false;
+  }
+  m_tranReceiptObj = Json::nullValue;
+  m_cumGas = cumGas;
+  m_objPending = true;
+  m_parsedObj = ParsedObj();
+  return true;
+}
+
+const Json::Value& TransactionReceipt::GetJsonValue() const {
+  if (!m_objPending) {
+    return m_tranReceiptObj;
+  }
+
+  shared_ptr<const Json::Value> parsed = atomic_load(&m_parsedObj.m_ptr);
+  if (parsed) {
+    return *parsed;
+  }
+
+  // As SetString and SetCumGas would leave it
+  auto obj = make_shared<Json::Value>();
+  try {
+    if (!JSONUtils::convertStrtoJson(m_tranReceiptStr, *obj)) {
+      LOG_GENERAL(WARNING, "Error with convert receipt string to json object");
+    }
+  } catch (const std::exception& e) {
+    LOG_GENERAL(WARNING, "Error with TransactionReceipt::GetJsonValue."
+                             << ' ' << e.what());
+  }
+  (*obj)["cumulative_gas"] = to_string(m_cumGas);
+
+  // Threads that lose the race use, and return, the winner's object
+  shared_ptr<const Json::Value> expected;
+  if (atomic_compare_exchange_strong(&m_parsedObj.m_ptr, &expected,
+                                     shared_ptr<const Json::Value>(obj))) {
+    return *obj;
+  }
+  return *expected;
+}
+
+void TransactionReceipt::ResolvePending() {
+  if (!m_objPending) {
+    return;
+  }
+  m_tranReceiptObj = GetJsonValue();
+  m_objPending = false;
+  m_parsedObj = ParsedObj();
+}
+
 void TransactionReceipt::AddEntry(const LogEntry& entry) {
+  ResolvePending();
   m_tranReceiptObj["event_logs"].append(entry.GetJsonObject());
 }
 
 void TransactionReceipt::clear() {
   m_tranReceiptStr.clear();
   m_tranReceiptObj.clear();
+  m_objPending = false;
+  m_parsedObj = ParsedObj();
   update();
 }
 
 void TransactionReceipt::update() {
+  ResolvePending();
   if (m_tranReceiptObj == Json::nullValue) {
     m_tranReceiptStr = "{}";
     return;
@@ -23,6 +23,8 @@
 #pragma GCC diagnostic ignored "-Wunused-parameter"
 #include <boost/multiprecision/cpp_int.hpp>
 #pragma GCC diagnostic pop
+#include <atomic>
+#include <memory>
 #include <unordered_map>
 #include <vector>
 
@@ -34,9 +36,28 @@
 #include "libUtils/Logger.h"
 
 class TransactionReceipt : public SerializableDataBlock {
+  /// Json form of a binary receipt, parsed the first time it is asked for.
+  /// Set at most once, so the reference GetJsonValue returns stays valid.
+  struct ParsedObj {
+    std::shared_ptr<const Json::Value> m_ptr;
+
+    ParsedObj() = default;
+    ParsedObj(const ParsedObj& other) : m_ptr(std::atomic_load(&other.m_ptr)) {}
+    ParsedObj& operator=(const ParsedObj& other) {
+      m_ptr = std::atomic_load(&other.m_ptr);
+      return *this;
+    }
+  };
+
   Json::Value m_tranReceiptObj = Json::nullValue;
   std::string m_tranReceiptStr;
   uint64_t m_cumGas = 0;
+  /// Whether m_tranReceiptObj is still to be parsed from m_tranReceiptStr
+  bool m_objPending = false;
+  mutable ParsedObj m_parsedObj;
+
+  /// Makes m_tranReceiptObj current before it is changed
+  void ResolvePending();
 
  public:
   TransactionReceipt();
@@ -48,9 +69,13 @@ class TransactionReceipt : public SerializableDataBlock {
   void AddEntry(const LogEntry& entry);
   const std::string& GetString() const { return m_tranReceiptStr; }
   void SetString(const std::string& tranReceiptStr);
+  /// The receipt string in ReceiptCodec form, as tx bodies store it
+  bool GetBinary(bytes& binary) const;
+  /// Sets a receipt from GetBinary without parsing its JSON yet
+  bool SetBinary(const bytes& binary, const uint64_t& cumGas);
   const uint64_t& GetCumGas() const { return m_cumGas; }
   void clear();
-  const Json::Value& GetJsonValue() const { return m_tranReceiptObj; }
+  const Json::Value& GetJsonValue() const;
   void update();
 };
 
@@ -60,9 +85,8 @@ class TransactionWithReceipt : public SerializableDataBlock {
 
  public:
   TransactionWithReceipt() = default;
-  TransactionWithReceipt(const Transaction& tran,
-                         const TransactionReceipt& tranReceipt)
-      : m_transaction(tran), m_tranReceipt(tranReceipt) {}
+  TransactionWithReceipt(Transaction tran, TransactionReceipt tranReceipt)
+      : m_transaction(std::move(tran)), m_tranReceipt(std::move(tranReceipt)) {}
   TransactionWithReceipt(const bytes& src, unsigned int offset) {
     Deserialize(src, offset);
   }
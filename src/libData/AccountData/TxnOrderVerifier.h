@@ -18,6 +18,8 @@
 #ifndef __TXNORDERVERIFIER_H__
 #define __TXNORDERVERIFIER_H__
 
+#include <algorithm>
+#include <cmath>
 #include <unordered_map>
 #include <vector>
 
@@ -25,51 +27,81 @@
 #include "libData/AccountData/Transaction.h"
 #include "libUtils/Logger.h"
 
-bool VerifyTxnOrderWTolerance(const std::vector<TxnHash>& expectedTxns,
-                              const std::vector<TxnHash>& receivedTxns,
-                              unsigned int tolerance_in_percent) {
-  LOG_MARKER();
+/// Position of each txn in a received order, e.g. the txn hashes of a
+/// microblock. Rebuilding it keeps the buckets allocated, so one index can
+/// serve microblock after microblock.
+class TxnOrderIndex {
+  std::unordered_map<TxnHash, unsigned int> m_positions;
+
+ public:
+  /// Indexes txns. A txn listed twice keeps its first position.
+  void Build(const std::vector<TxnHash>& txns) {
+    m_positions.clear();
+    m_positions.reserve(txns.size());
+    for (unsigned int i = 0; i < txns.size(); i++) {
+      m_positions.emplace(txns[i], i);
+    }
+  }
 
-  if (expectedTxns.empty() && receivedTxns.empty()) {
+  size_t size() const { return m_positions.size(); }
+
+  /// Returns false if txn is not indexed
+  bool Find(const TxnHash& txn, unsigned int& position) const {
+    auto it = m_positions.find(txn);
+    if (it == m_positions.end()) {
+      return false;
+    }
+    position = it->second;
     return true;
   }
+};
+
+/// Returns true if at least (100 - tolerance_in_percent)% of expectedTxns
+/// appear in receivedTxns in the same relative order, taking the longest
+/// such subsequence in O(n log n). The expected txns left out of it,
+/// missing or misplaced, are put in mismatchedTxns if given.
+inline bool VerifyTxnOrderWTolerance(
+    const std::vector<TxnHash>& expectedTxns,
+    const TxnOrderIndex& receivedTxns, unsigned int tolerance_in_percent,
+    std::vector<TxnHash>* mismatchedTxns = nullptr) {
+  LOG_MARKER();
 
-  if (expectedTxns.empty()) {
-    return false;
+  if (mismatchedTxns != nullptr) {
+    mismatchedTxns->clear();
   }
 
-  std::unordered_map<TxnHash, unsigned int> m_tranHashMap;
+  if (expectedTxns.empty() && receivedTxns.size() == 0) {
+    return true;
+  }
 
-  for (unsigned int i = 0; i < receivedTxns.size(); i++) {
-    m_tranHashMap.insert({receivedTxns.at(i), i});
+  if (expectedTxns.empty()) {
+    return false;
   }
 
-  std::vector<unsigned int> matchedIndexes;
-
-  for (const auto& th : expectedTxns) {
-    auto t = m_tranHashMap.find(th);
-    // if txn was found in map &&
-    // (matchedIndexs empty || the txn has larger index than previous element
-    //    (to ensure txn has incremental index in the order)) &&
-    // if the index of this txn was in the potion where can guarantee the
-    // successive of the verification,
-    //    which can be used to avoid too big index being inserted in the
-    //    matchedIndexes too early causing all the txns left was not able to be
-    //    inserted. e.g. to verify 10 txns with tolerance of 20%, ordered by 0 9
-    //    1 3 2 4 5 6 7 8 10, the expected order is 0 1 2 3 4 5 6 7 8 9 10 11 12
-    //    when it comes to 9, which is out of the 20% of the size of the
-    //    received order(2) + sizeof matchedIndexes(1), discard when it comes to
-    //    3, which is in the the range (2 + sizeof{0,1}) = 4, accept finally the
-    //    indexed items are 0 1 3 4 5 6 7 8 10, size(9), which is more than 80%
-    //    of the size in the expecting order (12*0.8 = 9), thus return true if
-    //    the expectig order is 0 1 2 3 4 5 6 7 8 9 10 11 12 13, then the min
-    //    size will be (10), it will return false
-    if (t != m_tranHashMap.end() &&
-        (matchedIndexes.empty() || t->second > matchedIndexes.back()) &&
-        (t->second <
-         ((tolerance_in_percent * receivedTxns.size() / ONE_HUNDRED_PERCENT +
-           matchedIndexes.size())))) {
-      matchedIndexes.push_back(t->second);
+  // Longest strictly increasing run of received positions, by patience
+  // sorting: tails[k] is the index in expectedTxns ending the best run of
+  // length k + 1 found so far, and prev links each entry to the one before
+  // it in its run
+  const unsigned int NONE = expectedTxns.size();
+  std::vector<unsigned int> positions(expectedTxns.size());
+  std::vector<unsigned int> tails;
+  std::vector<unsigned int> prev(expectedTxns.size(), NONE);
+
+  for (unsigned int i = 0; i < expectedTxns.size(); i++) {
+    if (!receivedTxns.Find(expectedTxns[i], positions[i])) {
+      continue;
+    }
+    auto it = std::lower_bound(tails.begin(), tails.end(), positions[i],
+                               [&positions](unsigned int j, unsigned int pos) {
+                                 return positions[j] < pos;
+                               });
+    if (it != tails.begin()) {
+      prev[i] = *(it - 1);
+    }
+    if (it == tails.end()) {
+      tails.push_back(i);
+    } else {
+      *it = i;
     }
   }
 
@@ -80,22 +112,34 @@ bool VerifyTxnOrderWTolerance(const std::vector<TxnHash>& expectedTxns,
 
   LOG_GENERAL(INFO, "Minimum in order num required: "
                         << min_ordered_txn_num << " actual in order num: "
-                        << matchedIndexes.size() << " similarity: "
-                        << (matchedIndexes.size() * ONE_HUNDRED_PERCENT /
+                        << tails.size() << " similarity: "
+                        << (tails.size() * ONE_HUNDRED_PERCENT /
                             expectedTxns.size())
                         << "% "
                         << "tolerance: " << tolerance_in_percent << "%");
 
-  if (matchedIndexes.size() >= min_ordered_txn_num) {
-    return true;
+  if (mismatchedTxns != nullptr) {
+    std::vector<bool> inOrder(expectedTxns.size(), false);
+    for (unsigned int i = tails.empty() ? NONE : tails.back(); i != NONE;
+         i = prev[i]) {
+      inOrder[i] = true;
+    }
+    for (unsigned int i = 0; i < expectedTxns.size(); i++) {
+      if (!inOrder[i]) {
+        mismatchedTxns->emplace_back(expectedTxns[i]);
+      }
+    }
   }
 
-  LOG_GENERAL(INFO, "Txns not in order, ordered txns:");
-  for (const auto& index : matchedIndexes) {
-    LOG_GENERAL(INFO, receivedTxns.at(index).hex());
-  }
+  return tails.size() >= min_ordered_txn_num;
+}
 
-  return false;
+inline bool VerifyTxnOrderWTolerance(const std::vector<TxnHash>& expectedTxns,
+                                     const std::vector<TxnHash>& receivedTxns,
+                                     unsigned int tolerance_in_percent) {
+  TxnOrderIndex index;
+  index.Build(receivedTxns);
+  return VerifyTxnOrderWTolerance(expectedTxns, index, tolerance_in_percent);
 }
 
 #endif  // __TXNORDERVERIFIER_H__
@@ -0,0 +1,403 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "TxnPool.h"
+#include "libUtils/Logger.h"
+
+using namespace std;
+using namespace boost::multiprecision;
+
+namespace {
+// True if a should be kept over b, both having the same sender and nonce
+bool IsPreferred(const Transaction& a, const Transaction& b) {
+  return (a.GetGasPrice() > b.GetGasPrice()) ||
+         (a.GetGasPrice() == b.GetGasPrice() && a.GetTranID() < b.GetTranID());
+}
+}  // namespace
+
+TxnPool::TxnPool(size_t maxSize, size_t maxPerSender, size_t maxBytes)
+    : m_maxSize(max<size_t>(maxSize, 1)),
+      m_maxPerSender(maxPerSender),
+      m_maxBytes(maxBytes),
+      m_bytes(0),
+      m_numTaken(0),
+      m_taking(false) {}
+
+TxnPool::Handle TxnPool::allocate(Transaction&& t) {
+  if (!m_freeSlots.empty()) {
+    Handle h = m_freeSlots.back();
+    m_freeSlots.pop_back();
+    m_slots[h].m_txn = move(t);
+    return h;
+  }
+
+  m_slots.push_back({move(t), false});
+  return m_slots.size() - 1;
+}
+
+void TxnPool::release(Handle h) {
+  m_slots[h].m_txn = Transaction();
+  m_slots[h].m_taken = false;
+  m_freeSlots.emplace_back(h);
+}
+
+size_t TxnPool::txnBytes(const Transaction& t) {
+  return sizeof(Slot) + t.GetCode().size() + t.GetData().size();
+}
+
+void TxnPool::index(Handle h) {
+  const Transaction& t = m_slots[h].m_txn;
+  m_hashIndex.emplace(t.GetTranID(), h);
+  m_senderCount[t.GetSenderPubKey().m_compressed]++;
+  m_bytes += txnBytes(t);
+}
+
+void TxnPool::unindex(Handle h) {
+  const Transaction& t = m_slots[h].m_txn;
+  if (m_hashIndex.erase(t.GetTranID()) == 0) {
+    return;
+  }
+
+  auto searchSender = m_senderCount.find(t.GetSenderPubKey().m_compressed);
+  if (searchSender != m_senderCount.end() && --searchSender->second == 0) {
+    m_senderCount.erase(searchSender);
+  }
+  m_bytes -= min(m_bytes, txnBytes(t));
+}
+
+bool TxnPool::link(Handle h) {
+  const Transaction& t = m_slots[h].m_txn;
+  const SenderNonce key(t);
+
+  auto searchNonce = m_nonceIndex.find(key);
+  if (searchNonce != m_nonceIndex.end()) {
+    if (!IsPreferred(t, m_slots[searchNonce->second].m_txn)) {
+      unindex(h);
+      release(h);
+      return false;
+    }
+    remove(searchNonce->second);
+  }
+
+  m_nonceIndex.emplace(key, h);
+  m_gasIndex[t.GetGasPrice()].emplace(t.GetTranID(), h);
+  return true;
+}
+
+void TxnPool::unlink(Handle h) {
+  const Transaction& t = m_slots[h].m_txn;
+
+  m_nonceIndex.erase(SenderNonce(t));
+
+  auto searchGas = m_gasIndex.find(t.GetGasPrice());
+  if (searchGas != m_gasIndex.end()) {
+    searchGas->second.erase(t.GetTranID());
+    if (searchGas->second.empty()) {
+      m_gasIndex.erase(searchGas);
+    }
+  }
+}
+
+void TxnPool::remove(Handle h) {
+  unlink(h);
+  unindex(h);
+  release(h);
+}
+
+void TxnPool::take(Handle h, Transaction& t) {
+  if (!m_taking) {
+    unlink(h);
+    unindex(h);
+    t = move(m_slots[h].m_txn);
+    release(h);
+    return;
+  }
+
+  t = m_slots[h].m_txn;
+  unlink(h);
+  m_slots[h].m_taken = true;
+  m_takenSlots.emplace_back(h);
+  m_numTaken++;
+}
+
+bool TxnPool::canReserve(const uint128_t& gasPrice, size_t bytes) const {
+  if (m_maxBytes > 0 && bytes > m_maxBytes) {
+    return false;
+  }
+
+  size_t count = m_hashIndex.size();
+  size_t total = m_bytes;
+  auto full = [this, &count, &total, bytes]() {
+    return count >= m_maxSize || (m_maxBytes > 0 && total + bytes > m_maxBytes);
+  };
+
+  // Lowest gas price comes last
+  for (auto gas = m_gasIndex.rbegin(); gas != m_gasIndex.rend() && full();
+       ++gas) {
+    if (gas->first >= gasPrice) {
+      return false;
+    }
+    for (auto hash = gas->second.rbegin();
+         hash != gas->second.rend() && full(); ++hash) {
+      count--;
+      total -= min(total, txnBytes(m_slots[hash->second].m_txn));
+    }
+  }
+  return !full();
+}
+
+bool TxnPool::reserve(const uint128_t& gasPrice, size_t bytes) {
+  if (!canReserve(gasPrice, bytes)) {
+    return false;
+  }
+
+  while (m_hashIndex.size() >= m_maxSize ||
+         (m_maxBytes > 0 && m_bytes + bytes > m_maxBytes)) {
+    remove(m_gasIndex.rbegin()->second.rbegin()->second);
+  }
+  return true;
+}
+
+bool TxnPool::checkAdmission(const Transaction& t) const {
+  auto searchNonce = m_nonceIndex.find(SenderNonce(t));
+  if (searchNonce != m_nonceIndex.end()) {
+    // Replacing a transaction with the same nonce does not grow the pool
+    return IsPreferred(t, m_slots[searchNonce->second].m_txn);
+  }
+
+  if (m_maxPerSender > 0) {
+    auto searchSender = m_senderCount.find(t.GetSenderPubKey().m_compressed);
+    if (searchSender != m_senderCount.end() &&
+        searchSender->second >= m_maxPerSender) {
+      return false;
+    }
+  }
+
+  return canReserve(t.GetGasPrice(), txnBytes(t));
+}
+
+void TxnPool::clear() {
+  m_slots.clear();
+  m_freeSlots.clear();
+  m_takenSlots.clear();
+  m_numTaken = 0;
+  m_taking = false;
+  m_hashIndex.clear();
+  m_gasIndex.clear();
+  m_nonceIndex.clear();
+  m_senderCount.clear();
+  m_bytes = 0;
+}
+
+unsigned int TxnPool::size() const { return m_hashIndex.size() - m_numTaken; }
+
+MemoryUsage TxnPool::memoryUsage() const {
+  MemoryUsage usage;
+  usage.m_objects = m_hashIndex.size();
+  usage.m_bytes = MemoryStats::ArrayBytes(m_slots) +
+                  MemoryStats::ArrayBytes(m_freeSlots) +
+                  MemoryStats::ArrayBytes(m_takenSlots) +
+                  MemoryStats::HashContainerBytes(m_hashIndex) +
+                  MemoryStats::HashContainerBytes(m_nonceIndex) +
+                  MemoryStats::HashContainerBytes(m_senderCount) +
+                  MemoryStats::TreeContainerBytes(m_gasIndex);
+  for (const auto& gasPrice : m_gasIndex) {
+    usage.m_bytes += MemoryStats::TreeContainerBytes(gasPrice.second);
+  }
+  for (const auto& entry : m_hashIndex) {
+    const Transaction& t = m_slots[entry.second].m_txn;
+    usage.m_bytes +=
+        sizeof(PubKey) + t.GetCode().size() + t.GetData().size();
+  }
+  return usage;
+}
+
+bool TxnPool::exist(const TxnHash& th) const {
+  return m_hashIndex.find(th) != m_hashIndex.end();
+}
+
+bool TxnPool::get(const TxnHash& th, Transaction& t) const {
+  auto searchHash = m_hashIndex.find(th);
+  if (searchHash == m_hashIndex.end()) {
+    return false;
+  }
+  t = m_slots[searchHash->second].m_txn;
+
+  return true;
+}
+
+uint64_t TxnPool::shortHash(const TxnHash& th) {
+  uint64_t res;
+  memcpy(&res, th.data(), sizeof(res));
+  return res;
+}
+
+vector<uint64_t> TxnPool::shortHashes() const {
+  vector<uint64_t> res;
+  res.reserve(m_hashIndex.size());
+  for (const auto& entry : m_hashIndex) {
+    res.emplace_back(shortHash(entry.first));
+  }
+  return res;
+}
+
+void TxnPool::getByShortHashes(const unordered_set<uint64_t>& shortHashes,
+                               vector<Transaction>& txns) const {
+  for (const auto& entry : m_hashIndex) {
+    if (shortHashes.find(shortHash(entry.first)) != shortHashes.end()) {
+      txns.emplace_back(m_slots[entry.second].m_txn);
+    }
+  }
+}
+
+bool TxnPool::admit(const Transaction& t) const {
+  return !exist(t.GetTranID()) && checkAdmission(t);
+}
+
+uint128_t TxnPool::marginalGasPrice() const {
+  // Judged for the smallest possible txn
+  if (m_gasIndex.empty() ||
+      (m_hashIndex.size() < m_maxSize &&
+       (m_maxBytes == 0 || m_bytes + sizeof(Slot) <= m_maxBytes))) {
+    return 0;
+  }
+  return m_gasIndex.rbegin()->first;
+}
+
+bool TxnPool::insert(Transaction t) {
+  if (exist(t.GetTranID())) {
+    return false;
+  }
+
+  // Replacing a transaction with the same nonce does not grow the pool
+  if (m_nonceIndex.find(SenderNonce(t)) == m_nonceIndex.end() &&
+      (!checkAdmission(t) || !reserve(t.GetGasPrice(), txnBytes(t)))) {
+    LOG_GENERAL(WARNING, "TxnPool is full or the sender is over its quota, "
+                         "dropped txn "
+                             << t.GetTranID());
+    return false;
+  }
+
+  Handle h = allocate(move(t));
+  index(h);
+  link(h);
+  return true;
+}
+
+void TxnPool::findSameNonceButHigherGas(Transaction& t) {
+  auto searchNonce = m_nonceIndex.find(SenderNonce(t));
+  if (searchNonce != m_nonceIndex.end()) {
+    if (m_slots[searchNonce->second].m_txn.GetGasPrice() > t.GetGasPrice()) {
+      take(searchNonce->second, t);
+    }
+  }
+}
+
+bool TxnPool::findOne(Transaction& t) {
+  if (m_gasIndex.empty()) {
+    return false;
+  }
+
+  auto firstGas = m_gasIndex.begin();
+  auto firstHash = firstGas->second.begin();
+
+  if (firstHash != firstGas->second.end()) {
+    take(firstHash->second, t);
+    return true;
+  }
+  return false;
+}
+
+void TxnPool::getInGasOrder(size_t maxCount, vector<Transaction>& txns) const {
+  for (const auto& gasEntry : m_gasIndex) {
+    for (const auto& hashEntry : gasEntry.second) {
+      if (maxCount == 0) {
+        return;
+      }
+      txns.emplace_back(m_slots[hashEntry.second].m_txn);
+      maxCount--;
+    }
+  }
+}
+
+bool TxnPool::findByHash(const TxnHash& th, Transaction& t) {
+  auto searchHash = m_hashIndex.find(th);
+  if (searchHash == m_hashIndex.end() || m_slots[searchHash->second].m_taken) {
+    return false;
+  }
+
+  take(searchHash->second, t);
+  return true;
+}
+
+void TxnPool::beginTake() {
+  rollbackTake();
+  m_taking = true;
+}
+
+bool TxnPool::putBack(const Transaction& t) {
+  auto searchHash = m_hashIndex.find(t.GetTranID());
+  if (searchHash == m_hashIndex.end()) {
+    return insert(t);
+  }
+
+  Handle h = searchHash->second;
+  if (!m_slots[h].m_taken) {
+    return false;
+  }
+
+  m_slots[h].m_taken = false;
+  m_numTaken--;
+  return link(h);
+}
+
+void TxnPool::rollbackTake() {
+  // Slots put back since have m_taken cleared and are skipped
+  for (const auto& h : m_takenSlots) {
+    if (m_slots[h].m_taken) {
+      m_slots[h].m_taken = false;
+      link(h);
+    }
+  }
+  m_takenSlots.clear();
+  m_numTaken = 0;
+  m_taking = false;
+}
+
+void TxnPool::commitTake() {
+  for (const auto& h : m_takenSlots) {
+    if (m_slots[h].m_taken) {
+      unindex(h);
+      release(h);
+    }
+  }
+  m_takenSlots.clear();
+  m_numTaken = 0;
+  m_taking = false;
+}
+
+ostream& operator<<(ostream& os, const TxnPool& t) {
+  os << "Txn in txnPool: " << endl;
+  for (const auto& entry : t.m_hashIndex) {
+    const Transaction& txn = t.m_slots[entry.second].m_txn;
+    os << "TranID: " << entry.first.hex() << " Sender:"
+       << txn.GetSenderAddr()
+       << " Nonce: " << txn.GetNonce() << endl;
+  }
+  return os;
+}
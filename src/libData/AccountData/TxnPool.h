@@ -15,145 +15,207 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+
 #ifndef __TXNPOOL_H__
 #define __TXNPOOL_H__
 
+#include <array>
+#include <cstring>
+#include <deque>
 #include <functional>
 #include <map>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 #include "Account.h"
 #include "Transaction.h"
+#include "common/Constants.h"
+#include "libUtils/MemoryStats.h"
+
+/// Pool of pending transactions, ordered by gas price.
+///
+/// Each transaction is stored once, in a slot of a chunked arena; the hash,
+/// gas price and sender nonce indices refer to it by slot number. The pool
+/// holds at most maxSize transactions and maxBytes of them, and at most
+/// maxPerSender from one sender (0 lifts either bound). When full, a new
+/// transaction replaces the ones with the lowest gas price if it pays more,
+/// and is rejected otherwise. admit() applies the same rules without
+/// inserting, so that transactions the pool would refuse can be dropped
+/// before their signatures are checked.
+///
+/// Microblock processing consumes transactions inside a take: between
+/// beginTake() and commitTake(), findOne() and findSameNonceButHigherGas()
+/// only unlink the transactions they return, and rollbackTake() puts them
+/// all back. This replaces copying the whole pool before every attempt.
+class TxnPool {
+  using Handle = uint32_t;
+
+  struct Slot {
+    Transaction m_txn;
+    bool m_taken;
+  };
+
+  /// Sender and nonce of a transaction. Holds the compressed sender key
+  /// rather than a PubKey, so building a key does not allocate.
+  struct SenderNonce {
+    std::array<unsigned char, PUB_KEY_SIZE> m_sender;
+    uint64_t m_nonce;
+
+    explicit SenderNonce(const Transaction& t)
+        : m_sender(t.GetSenderPubKey().m_compressed), m_nonce(t.GetNonce()) {}
+
+    bool operator==(const SenderNonce& r) const {
+      return m_nonce == r.m_nonce && m_sender == r.m_sender;
+    }
+  };
+
+  struct SenderNonceHash {
+    std::size_t operator()(const SenderNonce& k) const noexcept {
+      // Skip the parity byte; the x coordinate is uniformly distributed
+      uint64_t res;
+      memcpy(&res, k.m_sender.data() + 1, sizeof(res));
+      return res ^ (k.m_nonce * 0x9E3779B97F4A7C15ULL);
+    }
+  };
 
-struct TxnPool {
-  struct PubKeyNonceHash {
-    std::size_t operator()(
-        const std::pair<PubKey, boost::multiprecision::uint128_t>& p) const {
-      std::size_t seed = 0;
-      boost::hash_combine(seed, std::string(p.first));
-      boost::hash_combine(seed, p.second.convert_to<std::string>());
+  using Sender = std::array<unsigned char, PUB_KEY_SIZE>;
 
-      return seed;
+  struct SenderHash {
+    std::size_t operator()(const Sender& k) const noexcept {
+      uint64_t res;
+      memcpy(&res, k.data() + 1, sizeof(res));
+      return res;
     }
   };
 
-  std::unordered_map<TxnHash, Transaction> HashIndex;
-  std::map<boost::multiprecision::uint128_t, std::map<TxnHash, Transaction>,
+  size_t m_maxSize;
+  size_t m_maxPerSender;
+  size_t m_maxBytes;
+  /// Estimated bytes of the transactions in m_hashIndex
+  size_t m_bytes;
+  std::deque<Slot> m_slots;
+  std::vector<Handle> m_freeSlots;
+  std::vector<Handle> m_takenSlots;
+  size_t m_numTaken;
+  bool m_taking;
+
+  std::unordered_map<TxnHash, Handle> m_hashIndex;
+  std::map<boost::multiprecision::uint128_t, std::map<TxnHash, Handle>,
            std::greater<boost::multiprecision::uint128_t>>
-      GasIndex;
-  std::unordered_map<std::pair<PubKey, uint64_t>, Transaction, PubKeyNonceHash>
-      NonceIndex;
+      m_gasIndex;
+  std::unordered_map<SenderNonce, Handle, SenderNonceHash> m_nonceIndex;
+  /// Transactions in m_hashIndex per sender
+  std::unordered_map<Sender, size_t, SenderHash> m_senderCount;
 
-  void clear() {
-    HashIndex.clear();
-    GasIndex.clear();
-    NonceIndex.clear();
-  }
+  Handle allocate(Transaction&& t);
+  void release(Handle h);
 
-  unsigned int size() { return HashIndex.size(); }
+  /// Bytes charged against maxBytes for t
+  static size_t txnBytes(const Transaction& t);
 
-  bool exist(const TxnHash& th) {
-    return HashIndex.find(th) != HashIndex.end();
-  }
+  /// Adds the slot to, or removes it from, the hash index and the sender
+  /// and memory accounting
+  void index(Handle h);
+  void unindex(Handle h);
 
-  bool get(const TxnHash& th, Transaction& t) {
-    if (!exist(th)) {
-      return false;
-    }
-    t = HashIndex.at(th);
+  /// Adds the slot to the gas and nonce indices, resolving a clash with a
+  /// pooled transaction of the same sender and nonce. Returns false if the
+  /// slot lost and was released.
+  bool link(Handle h);
 
-    return true;
-  }
+  /// Removes the slot from the gas and nonce indices
+  void unlink(Handle h);
 
-  bool insert(const Transaction& t) {
-    if (exist(t.GetTranID())) {
-      return false;
-    }
+  /// Removes the slot from all indices and releases it
+  void remove(Handle h);
 
-    auto searchNonce = NonceIndex.find({t.GetSenderPubKey(), t.GetNonce()});
-    if (searchNonce != NonceIndex.end()) {
-      if ((t.GetGasPrice() > searchNonce->second.GetGasPrice()) ||
-          (t.GetGasPrice() == searchNonce->second.GetGasPrice() &&
-           t.GetTranID() < searchNonce->second.GetTranID())) {
-        // erase from HashIdxTxns
-        auto searchHash = HashIndex.find(searchNonce->second.GetTranID());
-        if (searchHash != HashIndex.end()) {
-          HashIndex.erase(searchHash);
-        }
-        // erase from GasIdxTxns
-        auto searchGas = GasIndex.find(searchNonce->second.GetGasPrice());
-        if (searchGas != GasIndex.end()) {
-          auto searchGasHash =
-              searchGas->second.find(searchNonce->second.GetTranID());
-          if (searchGasHash != searchGas->second.end()) {
-            searchGas->second.erase(searchGasHash);
-          }
-        }
-        HashIndex[t.GetTranID()] = t;
-        GasIndex[t.GetGasPrice()][t.GetTranID()] = t;
-        searchNonce->second = t;
-      }
-    } else {
-      HashIndex[t.GetTranID()] = t;
-      GasIndex[t.GetGasPrice()][t.GetTranID()] = t;
-      NonceIndex[{t.GetSenderPubKey(), t.GetNonce()}] = t;
-    }
-    return true;
-  }
-
-  void findSameNonceButHigherGas(Transaction& t) {
-    auto searchNonce = NonceIndex.find({t.GetSenderPubKey(), t.GetNonce()});
-    if (searchNonce != NonceIndex.end()) {
-      if (searchNonce->second.GetGasPrice() > t.GetGasPrice()) {
-        t = std::move(searchNonce->second);
-
-        // erase tx nonce map
-        NonceIndex.erase(searchNonce);
-        // erase tx gas map
-        GasIndex[t.GetGasPrice()].erase(t.GetTranID());
-        if (GasIndex[t.GetGasPrice()].empty()) {
-          GasIndex.erase(t.GetGasPrice());
-        }
-        // erase tx hash map
-        HashIndex.erase(t.GetTranID());
-      }
-    }
-  }
+  /// Takes the slot out of the pool, keeping it until the take ends
+  void take(Handle h, Transaction& t);
 
-  bool findOne(Transaction& t) {
-    if (GasIndex.empty()) {
-      return false;
-    }
+  /// Returns true if room can be made for a transaction paying gasPrice
+  /// and taking bytes, evicting only transactions that pay less
+  bool canReserve(const boost::multiprecision::uint128_t& gasPrice,
+                  size_t bytes) const;
 
-    auto firstGas = GasIndex.begin();
-    auto firstHash = firstGas->second.begin();
-
-    if (firstHash != firstGas->second.end()) {
-      t = std::move(firstHash->second);
-
-      // erase tx gas map
-      firstGas->second.erase(firstHash);
-      if (firstGas->second.empty()) {
-        GasIndex.erase(firstGas);
-      }
-      // erase tx nonce map
-      NonceIndex.erase({t.GetSenderPubKey(), t.GetNonce()});
-      // erase tx hash m ap
-      HashIndex.erase(t.GetTranID());
-      return true;
-    }
-    return false;
-  }
+  /// Makes room for a transaction paying gasPrice and taking bytes, if the
+  /// pool is full
+  bool reserve(const boost::multiprecision::uint128_t& gasPrice, size_t bytes);
+
+  /// Returns false if t would be refused for its sender's quota or, when it
+  /// does not replace a pooled transaction, for a full pool
+  bool checkAdmission(const Transaction& t) const;
+
+  friend std::ostream& operator<<(std::ostream& os, const TxnPool& t);
+
+ public:
+  explicit TxnPool(size_t maxSize = TXN_POOL_MAX_SIZE,
+                   size_t maxPerSender = TXN_POOL_MAX_TXNS_PER_SENDER,
+                   size_t maxBytes = size_t{TXN_POOL_MAX_MB} << 20);
+
+  void clear();
+
+  /// Number of transactions available, not counting those in a take
+  unsigned int size() const;
+
+  /// Estimated memory held by the pool, also by transactions in a take.
+  /// A payload shared with copies outside the pool is counted in full.
+  MemoryUsage memoryUsage() const;
+
+  /// Also finds transactions in a take
+  bool exist(const TxnHash& th) const;
+
+  /// Also finds transactions in a take
+  bool get(const TxnHash& th, Transaction& t) const;
+
+  /// Leading eight bytes of a txn hash, which is how pool summaries
+  /// exchanged between shard nodes refer to a transaction
+  static uint64_t shortHash(const TxnHash& th);
+
+  /// Short hashes of all transactions, also those in a take
+  std::vector<uint64_t> shortHashes() const;
+
+  /// Appends copies of the transactions whose short hash is listed, also
+  /// those in a take
+  void getByShortHashes(const std::unordered_set<uint64_t>& shortHashes,
+                        std::vector<Transaction>& txns) const;
+
+  /// Returns true if insert() would take t as the pool is now. Cheaper
+  /// than the signature check, which it is meant to come before.
+  bool admit(const Transaction& t) const;
+
+  /// Lowest gas price a new transaction has to beat, or 0 while the pool
+  /// has room for one more
+  boost::multiprecision::uint128_t marginalGasPrice() const;
+
+  /// Takes ownership of t; callers done with it should move it in
+  bool insert(Transaction t);
+
+  void findSameNonceButHigherGas(Transaction& t);
+
+  bool findOne(Transaction& t);
+
+  /// Appends copies of up to maxCount transactions, in the order findOne()
+  /// hands them out, leaving the pool as it is
+  void getInGasOrder(size_t maxCount, std::vector<Transaction>& txns) const;
+
+  /// Takes the transaction with the given hash, as findOne() does. Fails if
+  /// it is not in the pool or already taken.
+  bool findByHash(const TxnHash& th, Transaction& t);
+
+  /// Starts a take, returning any transactions of an unfinished one first
+  void beginTake();
+
+  /// Returns a transaction obtained in the current take to the pool
+  bool putBack(const Transaction& t);
+
+  /// Returns all transactions obtained since beginTake() to the pool
+  void rollbackTake();
+
+  /// Drops all transactions obtained since beginTake()
+  void commitTake();
 };
 
-inline std::ostream& operator<<(std::ostream& os, const TxnPool& t) {
-  os << "Txn in txnPool: " << std::endl;
-  for (const auto& entry : t.HashIndex) {
-    os << "TranID: " << entry.first.hex() << " Sender:"
-       << Account::GetAddressFromPublicKey(entry.second.GetSenderPubKey())
-       << " Nonce: " << entry.second.GetNonce() << std::endl;
-  }
-  return os;
-}
+std::ostream& operator<<(std::ostream& os, const TxnPool& t);
 
 #endif  // __TXNPOOL_H__
@@ -18,7 +18,10 @@
 #ifndef __BLOCKCHAIN_H__
 #define __BLOCKCHAIN_H__
 
+#include <list>
+#include <memory>
 #include <mutex>
+#include <unordered_map>
 #include <vector>
 
 #pragma GCC diagnostic push
@@ -26,29 +29,96 @@
 #include <boost/multiprecision/cpp_int.hpp>
 #pragma GCC diagnostic pop
 
+#include "BlockChainStats.h"
+#include "BlockRangeSums.h"
 #include "libData/BlockData/Block/DSBlock.h"
 #include "libData/DataStructures/CircularArray.h"
 #include "libPersistence/BlockStorage.h"
+#include "libUtils/MemoryStats.h"
 
 /// Transient storage for DS/Tx/ Blocks. The block should have function
 /// .GetHeader().GetBlockNum()
+///
+/// Blocks are kept as shared immutable objects, so GetBlockPtr and
+/// GetLastBlockPtr hand them out without copying. Blocks older than the ones
+/// in memory are read from persistent storage, and the most recent of those
+/// are kept in a small LRU cache.
 template <class T>
 class BlockChain {
+ public:
+  using BlockPtr = std::shared_ptr<const T>;
+
+ private:
   std::mutex m_mutexBlocks;
-  CircularArray<T> m_blocks;
+  /// Slots never written hold nullptr
+  CircularArray<BlockPtr> m_blocks;
+
+  /// Blocks read from persistent storage, most recently used first
+  std::list<BlockPtr> m_historyLRU;
+  std::unordered_map<uint64_t, typename std::list<BlockPtr>::iterator>
+      m_historyIndex;
+
+  static const BlockPtr& GetDummyBlock() {
+    static const BlockPtr dummy = std::make_shared<const T>();
+    return dummy;
+  }
+
+  static uint64_t GetBlockNum(const BlockPtr& block) {
+    return (block == nullptr) ? INIT_BLOCK_NUMBER
+                              : block->GetHeader().GetBlockNum();
+  }
+
+  BlockPtr GetHistoricalBlockLocked(const uint64_t& blockNum) {
+    auto it = m_historyIndex.find(blockNum);
+    if (it != m_historyIndex.end()) {
+      m_historyLRU.splice(m_historyLRU.begin(), m_historyLRU, it->second);
+      return *it->second;
+    }
+
+    BlockPtr block = GetBlockFromPersistentStorage(blockNum);
+    if (block == nullptr) {
+      LOG_GENERAL(WARNING, "Block " << blockNum
+                                    << " not in persistent storage, a dummy "
+                                       "block will be used");
+      return GetDummyBlock();
+    }
+
+    m_historyLRU.push_front(block);
+    m_historyIndex[blockNum] = m_historyLRU.begin();
+    if (m_historyLRU.size() > BLOCKCHAIN_HISTORY_CACHE_SIZE) {
+      m_historyIndex.erase(GetBlockNum(m_historyLRU.back()));
+      m_historyLRU.pop_back();
+    }
+    return block;
+  }
 
  protected:
   /// Constructor.
   BlockChain() { Reset(); }
 
-  virtual T GetBlockFromPersistentStorage(const uint64_t& blockNum) = 0;
+  /// Returns nullptr if the block is not found
+  virtual BlockPtr GetBlockFromPersistentStorage(const uint64_t& blockNum) = 0;
+
+  /// Called with the blocks lock held once a block is added
+  virtual void OnBlockAdded([[gnu::unused]] const T& block) {}
+
+  /// Called when the chain is reset, except from the constructor
+  virtual void OnReset() {}
 
  public:
   /// Destructor.
   ~BlockChain() {}
 
   /// Reset
-  void Reset() { m_blocks.resize(BLOCKCHAIN_SIZE); }
+  void Reset() {
+    {
+      std::lock_guard<std::mutex> g(m_mutexBlocks);
+      m_blocks.resize(BLOCKCHAIN_SIZE);
+      m_historyLRU.clear();
+      m_historyIndex.clear();
+    }
+    OnReset();
+  }
 
   /// Returns the number of blocks.
   uint64_t GetBlockCount() {
@@ -56,41 +126,82 @@ class BlockChain {
     return m_blocks.size();
   }
 
-  /// Returns the last stored block.
-  T GetLastBlock() {
+  /// Returns the last stored block, never nullptr.
+  BlockPtr GetLastBlockPtr() {
     std::lock_guard<std::mutex> g(m_mutexBlocks);
     try {
-      return m_blocks.back();
+      const BlockPtr& block = m_blocks.back();
+      return (block == nullptr) ? GetDummyBlock() : block;
     } catch (...) {
-      return T();
+      return GetDummyBlock();
     }
   }
 
-  /// Returns the block at the specified block number.
-  T GetBlock(const uint64_t& blockNum) {
+  /// Returns a copy of the last stored block.
+  T GetLastBlock() { return *GetLastBlockPtr(); }
+
+  /// Returns the block at the specified block number, never nullptr.
+  BlockPtr GetBlockPtr(const uint64_t& blockNum) {
     std::lock_guard<std::mutex> g(m_mutexBlocks);
 
-    if (m_blocks.size() > 0 &&
-        (m_blocks.back().GetHeader().GetBlockNum() < blockNum)) {
+    if (m_blocks.size() > 0 && (GetBlockNum(m_blocks.back()) < blockNum)) {
       LOG_GENERAL(WARNING,
                   "BlockNum too high " << blockNum << " Dummy block used");
-      return T();
+      return GetDummyBlock();
     }
 
     else if (blockNum + m_blocks.capacity() < m_blocks.size()) {
-      return GetBlockFromPersistentStorage(blockNum);
+      return GetHistoricalBlockLocked(blockNum);
     }
 
-    if (m_blocks[blockNum].GetHeader().GetBlockNum() != blockNum) {
+    const BlockPtr& block = m_blocks[blockNum];
+    if (GetBlockNum(block) != blockNum) {
       LOG_GENERAL(WARNING,
                   "BlockNum : " << blockNum << " != GetBlockNum() : "
-                                << m_blocks[blockNum].GetHeader().GetBlockNum()
+                                << GetBlockNum(block)
                                 << ", a dummy block will be used and abnormal "
                                    "behavior may happen!");
-      return T();
+      return GetDummyBlock();
+    }
+    return block;
+  }
+
+  /// Returns a copy of the block at the specified block number.
+  T GetBlock(const uint64_t& blockNum) { return *GetBlockPtr(blockNum); }
+
+  /// Estimated memory held by the blocks in memory and in the history
+  /// cache, taking the serialized size of a block as its own
+  MemoryUsage GetMemoryUsage() {
+    std::lock_guard<std::mutex> g(m_mutexBlocks);
+
+    MemoryUsage usage;
+    auto addBlock = [&usage](const BlockPtr& block) {
+      if (block == nullptr) {
+        return;
+      }
+      bytes serialized;
+      block->Serialize(serialized, 0);
+      usage.m_bytes += sizeof(T) + serialized.size();
+      usage.m_objects++;
+    };
+    for (uint64_t i = 0; i < m_blocks.capacity(); i++) {
+      addBlock(m_blocks[i]);
+    }
+    for (const auto& block : m_historyLRU) {
+      addBlock(block);
     }
-    return m_blocks[blockNum];
+    usage.m_bytes += m_blocks.capacity() * sizeof(BlockPtr) +
+                     MemoryStats::ListBytes(m_historyLRU) +
+                     MemoryStats::HashContainerBytes(m_historyIndex);
+    return usage;
   }
+  /// Counts blocks left in persistent storage as added before the ones in
+  /// memory, when only the most recent blocks are restored
+  void IncreaseBlockCount(const uint64_t& count) {
+    std::lock_guard<std::mutex> g(m_mutexBlocks);
+    m_blocks.increase_size(count);
+  }
+
   /// Adds a block to the chain.
   int AddBlock(const T& block) {
     uint64_t blockNumOfNewBlock = block.GetHeader().GetBlockNum();
@@ -98,13 +209,12 @@ class BlockChain {
     std::lock_guard<std::mutex> g(m_mutexBlocks);
 
     uint64_t blockNumOfExistingBlock =
-        m_blocks[blockNumOfNewBlock].GetHeader().GetBlockNum();
+        GetBlockNum(m_blocks[blockNumOfNewBlock]);
 
     if (blockNumOfExistingBlock < blockNumOfNewBlock ||
         INIT_BLOCK_NUMBER == blockNumOfExistingBlock) {
       if (m_blocks.size() > 0) {
-        uint64_t blockNumOfLastBlock =
-            m_blocks.back().GetHeader().GetBlockNum();
+        uint64_t blockNumOfLastBlock = GetBlockNum(m_blocks.back());
         uint64_t blockNumMissed = blockNumOfNewBlock - blockNumOfLastBlock - 1;
         if (blockNumMissed > 0) {
           LOG_GENERAL(INFO,
@@ -114,7 +224,8 @@ class BlockChain {
           m_blocks.increase_size(blockNumMissed);
         }
       }
-      m_blocks.insert_new(blockNumOfNewBlock, block);
+      m_blocks.insert_new(blockNumOfNewBlock, std::make_shared<const T>(block));
+      OnBlockAdded(block);
     } else {
       LOG_GENERAL(WARNING, "Failed to add " << blockNumOfNewBlock << " "
                                             << blockNumOfExistingBlock);
@@ -126,35 +237,114 @@ class BlockChain {
 };
 
 class DSBlockChain : public BlockChain<DSBlock> {
+  BlockChainStats m_stats;
+  /// Gas prices, for the mean over the last MEAN_GAS_PRICE_DS_NUM blocks
+  BlockRangeSums<boost::multiprecision::uint128_t> m_gasPrices{
+      MEAN_GAS_PRICE_DS_NUM + 1};
+
+  void OnBlockAdded(const DSBlock& block) override {
+    m_stats.OnBlockAdded(block.GetHeader().GetBlockNum(),
+                         block.GetTimestamp(), 0,
+                         block.GetHeader().GetBlockNum());
+    m_gasPrices.OnBlockAdded(block.GetHeader().GetBlockNum(),
+                             block.GetHeader().GetGasPrice());
+  }
+
+  void OnReset() override {
+    m_stats.Reset();
+    m_gasPrices.Reset();
+  }
+
  public:
-  DSBlock GetBlockFromPersistentStorage(const uint64_t& blockNum) {
+  BlockPtr GetBlockFromPersistentStorage(const uint64_t& blockNum) override {
     DSBlockSharedPtr block;
     BlockStorage::GetBlockStorage().GetDSBlock(blockNum, block);
-    return *block;
+    return block;
+  }
+
+  const BlockChainStats& GetStats() const { return m_stats; }
+
+  /// Sum of the gas prices of blocks lo to hi. Returns false if those are
+  /// not all among the most recent blocks added.
+  bool GetGasPriceSum(uint64_t lo, uint64_t hi,
+                      boost::multiprecision::uint128_t& sum) const {
+    return m_gasPrices.GetSum(lo, hi, sum);
   }
 };
 
 class TxBlockChain : public BlockChain<TxBlock> {
+  BlockChainStats m_stats;
+  /// 1 for each block using at least GAS_CONGESTION_PERCENT of its gas limit
+  BlockRangeSums<uint64_t> m_fullBlocks{BLOCKCHAIN_SIZE};
+  std::mutex m_mutexBackfill;
+  bool m_backfilled = false;
+
+  void OnBlockAdded(const TxBlock& block) override {
+    m_stats.OnBlockAdded(block.GetHeader().GetBlockNum(),
+                         block.GetTimestamp(), block.GetHeader().GetNumTxs(),
+                         block.GetHeader().GetDSBlockNum());
+    m_fullBlocks.OnBlockAdded(block.GetHeader().GetBlockNum(),
+                              IsFullBlock(block.GetHeader()) ? 1 : 0);
+  }
+
+  void OnReset() override {
+    m_stats.Reset();
+    m_fullBlocks.Reset();
+    std::lock_guard<std::mutex> g(m_mutexBackfill);
+    m_backfilled = false;
+  }
+
  public:
-  TxBlock GetBlockFromPersistentStorage(const uint64_t& blockNum) {
+  BlockPtr GetBlockFromPersistentStorage(const uint64_t& blockNum) override {
     TxBlockSharedPtr block;
     BlockStorage::GetBlockStorage().GetTxBlock(blockNum, block);
-    return *block;
+    return block;
+  }
+
+  const BlockChainStats& GetStats() const { return m_stats; }
+
+  static bool IsFullBlock(const TxBlockHeader& header) {
+    return header.GetGasUsed() >=
+           header.GetGasLimit() * GAS_CONGESTION_PERCENT / 100;
+  }
+
+  /// Number of full blocks among blocks lo to hi. Returns false if those
+  /// are not all among the most recent blocks added.
+  bool GetFullBlockCount(uint64_t lo, uint64_t hi, uint64_t& count) const {
+    return m_fullBlocks.GetSum(lo, hi, count);
+  }
+
+  /// Returns the txns of the whole chain. The first call after restoring
+  /// only the most recent blocks reads the older ones once to count theirs.
+  boost::multiprecision::uint128_t GetNumTxns() {
+    std::lock_guard<std::mutex> g(m_mutexBackfill);
+    if (!m_backfilled) {
+      const uint64_t firstBlockNum = m_stats.GetFirstBlockNum();
+      if (firstBlockNum > 0) {
+        boost::multiprecision::uint128_t numTxns = 0;
+        for (uint64_t i = 1; i < firstBlockNum; i++) {
+          numTxns += GetBlockPtr(i)->GetHeader().GetNumTxs();
+        }
+        m_stats.AddTxns(numTxns);
+        m_backfilled = true;
+      }
+    }
+    return m_stats.GetNumTxns();
   }
 };
 
 class VCBlockChain : public BlockChain<VCBlock> {
  public:
-  VCBlock GetBlockFromPersistentStorage([
-      [gnu::unused]] const uint64_t& blockNum) {
+  BlockPtr GetBlockFromPersistentStorage([
+      [gnu::unused]] const uint64_t& blockNum) override {
     throw "vc block persistent storage not supported";
   }
 };
 
 class FallbackBlockChain : public BlockChain<FallbackBlock> {
  public:
-  FallbackBlock GetBlockFromPersistentStorage([
-      [gnu::unused]] const uint64_t& blockNum) {
+  BlockPtr GetBlockFromPersistentStorage([
+      [gnu::unused]] const uint64_t& blockNum) override {
     throw "fallback block persistent storage not supported";
   }
 };
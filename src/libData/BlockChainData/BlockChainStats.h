@@ -0,0 +1,157 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __BLOCKCHAINSTATS_H__
+#define __BLOCKCHAINSTATS_H__
+
+#include <algorithm>
+#include <deque>
+#include <mutex>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+#include <boost/multiprecision/cpp_int.hpp>
+#pragma GCC diagnostic pop
+
+/// Running totals of a chain, updated as blocks are added, so that the
+/// stats RPCs never walk the chain. Block 0 only counts towards the txns.
+class BlockChainStats {
+  struct Sample {
+    uint64_t m_blockNum;
+    uint64_t m_timestamp;
+    uint32_t m_numTxs;
+  };
+
+  mutable std::mutex m_mutex;
+  const size_t m_rateWindow;
+
+  boost::multiprecision::uint128_t m_numTxns = 0;
+  uint64_t m_numBlocks = 0;
+  uint64_t m_firstBlockNum = 0;
+  uint64_t m_firstTimestamp = 0;
+  uint64_t m_lastBlockNum = 0;
+  uint64_t m_lastTimestamp = 0;
+
+  uint64_t m_dsBlockNum = 0;
+  uint64_t m_numTxnsDSEpoch = 0;
+
+  /// The newest m_rateWindow + 1 blocks, oldest first
+  std::deque<Sample> m_window;
+
+ public:
+  /// rateWindow is the number of block intervals the txn rate is taken over
+  explicit BlockChainStats(size_t rateWindow = 1)
+      : m_rateWindow(std::max<size_t>(rateWindow, 1)) {}
+
+  void Reset() {
+    std::lock_guard<std::mutex> g(m_mutex);
+    m_numTxns = 0;
+    m_numBlocks = 0;
+    m_firstBlockNum = 0;
+    m_firstTimestamp = 0;
+    m_lastBlockNum = 0;
+    m_lastTimestamp = 0;
+    m_dsBlockNum = 0;
+    m_numTxnsDSEpoch = 0;
+    m_window.clear();
+  }
+
+  /// dsBlockNum is the DS epoch the block belongs to
+  void OnBlockAdded(uint64_t blockNum, uint64_t timestamp, uint32_t numTxs,
+                    uint64_t dsBlockNum) {
+    std::lock_guard<std::mutex> g(m_mutex);
+
+    m_numTxns += numTxs;
+    if (blockNum == 0) {
+      return;
+    }
+
+    m_numBlocks++;
+    if (m_firstBlockNum == 0 || blockNum < m_firstBlockNum) {
+      m_firstBlockNum = blockNum;
+      m_firstTimestamp = timestamp;
+    }
+    // Blocks filling a gap behind the tip only count towards the totals
+    if (blockNum <= m_lastBlockNum) {
+      return;
+    }
+    m_lastBlockNum = blockNum;
+    m_lastTimestamp = timestamp;
+
+    if (dsBlockNum != m_dsBlockNum) {
+      m_dsBlockNum = dsBlockNum;
+      m_numTxnsDSEpoch = 0;
+    }
+    m_numTxnsDSEpoch += numTxs;
+
+    m_window.push_back({blockNum, timestamp, numTxs});
+    if (m_window.size() > m_rateWindow + 1) {
+      m_window.pop_front();
+    }
+  }
+
+  /// Adds the txns of blocks that were never added, such as those left on
+  /// disk when only the most recent blocks were restored
+  void AddTxns(const boost::multiprecision::uint128_t& numTxns) {
+    std::lock_guard<std::mutex> g(m_mutex);
+    m_numTxns += numTxns;
+  }
+
+  boost::multiprecision::uint128_t GetNumTxns() const {
+    std::lock_guard<std::mutex> g(m_mutex);
+    return m_numTxns;
+  }
+
+  /// Lowest non-genesis block number added so far, 0 if none
+  uint64_t GetFirstBlockNum() const {
+    std::lock_guard<std::mutex> g(m_mutex);
+    return m_firstBlockNum;
+  }
+
+  /// Txns of the current DS epoch
+  uint64_t GetNumTxnsDSEpoch() const {
+    std::lock_guard<std::mutex> g(m_mutex);
+    return m_numTxnsDSEpoch;
+  }
+
+  /// Txns per second over the rate window
+  double GetTxnRate() const {
+    std::lock_guard<std::mutex> g(m_mutex);
+    if (m_window.size() < 2 ||
+        m_window.back().m_timestamp <= m_window.front().m_timestamp) {
+      return 0;
+    }
+    uint64_t numTxns = 0;
+    for (auto it = m_window.begin() + 1; it != m_window.end(); ++it) {
+      numTxns += it->m_numTxs;
+    }
+    // Timestamps are in microseconds
+    return numTxns * 1000000.0 /
+           (m_window.back().m_timestamp - m_window.front().m_timestamp);
+  }
+
+  /// Blocks per second since the first block added
+  double GetBlockRate() const {
+    std::lock_guard<std::mutex> g(m_mutex);
+    if (m_numBlocks < 2 || m_lastTimestamp <= m_firstTimestamp) {
+      return 0;
+    }
+    return (m_numBlocks - 1) * 1000000.0 / (m_lastTimestamp - m_firstTimestamp);
+  }
+};
+
+#endif  // __BLOCKCHAINSTATS_H__
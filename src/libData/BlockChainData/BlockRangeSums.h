@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __BLOCKRANGESUMS_H__
+#define __BLOCKRANGESUMS_H__
+
+#include <deque>
+#include <mutex>
+
+/// Running sums of a value over consecutive block numbers, updated as
+/// blocks are added, so that the sum over a range of the most recent blocks
+/// takes two lookups instead of a walk over the chain. Adding a block that
+/// does not follow the last one, or whose value would overflow the sum,
+/// starts the sums over from that block.
+template <class T>
+class BlockRangeSums {
+  mutable std::mutex m_mutex;
+  const size_t m_capacity;
+
+  /// Block number of the oldest block kept
+  uint64_t m_firstBlockNum = 0;
+  /// Sum up to, but not including, the oldest block kept
+  T m_base = 0;
+  /// m_sums[i] is the sum up to and including block m_firstBlockNum + i
+  std::deque<T> m_sums;
+
+ public:
+  /// capacity is the number of most recent blocks ranges can cover
+  explicit BlockRangeSums(size_t capacity) : m_capacity(capacity) {}
+
+  void Reset() {
+    std::lock_guard<std::mutex> g(m_mutex);
+    m_firstBlockNum = 0;
+    m_base = 0;
+    m_sums.clear();
+  }
+
+  void OnBlockAdded(uint64_t blockNum, const T& value) {
+    std::lock_guard<std::mutex> g(m_mutex);
+
+    if (m_sums.empty() || blockNum != m_firstBlockNum + m_sums.size() ||
+        m_sums.back() + value < m_sums.back()) {
+      m_firstBlockNum = blockNum;
+      m_base = 0;
+      m_sums.assign(1, value);
+      return;
+    }
+
+    m_sums.push_back(m_sums.back() + value);
+    if (m_sums.size() > m_capacity) {
+      m_base = m_sums.front();
+      m_sums.pop_front();
+      m_firstBlockNum++;
+    }
+  }
+
+  /// Sets sum to the sum over blocks lo to hi, both included. Returns false
+  /// if not all of them are covered.
+  bool GetSum(uint64_t lo, uint64_t hi, T& sum) const {
+    std::lock_guard<std::mutex> g(m_mutex);
+
+    if (lo > hi) {
+      sum = 0;
+      return true;
+    }
+    if (m_sums.empty() || lo < m_firstBlockNum ||
+        hi >= m_firstBlockNum + m_sums.size()) {
+      return false;
+    }
+
+    const T& before =
+        (lo == m_firstBlockNum) ? m_base : m_sums[lo - m_firstBlockNum - 1];
+    sum = m_sums[hi - m_firstBlockNum] - before;
+    return true;
+  }
+};
+
+#endif  // __BLOCKRANGESUMS_H__
@@ -28,6 +28,29 @@
 using namespace std;
 using namespace boost::multiprecision;
 
+uint32_t DirectoryService::GetCoinbaseIndex(const PubKey& key) {
+  auto it = m_coinbaseKeyIndexes.find(key);
+  if (it != m_coinbaseKeyIndexes.end()) {
+    return it->second;
+  }
+
+  const uint32_t index = m_coinbaseKeys.size();
+  m_coinbaseKeyIndexes.emplace(key, index);
+  m_coinbaseKeys.emplace_back(key);
+  m_coinbaseSigCounts.emplace_back(0);
+  m_coinbaseLookupCounts.emplace_back(0);
+  return index;
+}
+
+void DirectoryService::ClearCoinbase() {
+  m_coinbaseRewardees.clear();
+  m_coinbaseKeys.clear();
+  m_coinbaseKeyIndexes.clear();
+  m_coinbaseSigCounts.clear();
+  m_coinbaseLookupCounts.clear();
+  m_coinbaseCommitteeIndexes.clear();
+}
+
 template <class Container>
 bool DirectoryService::SaveCoinbaseCore(const vector<bool>& b1,
                                         const vector<bool>& b2,
@@ -62,23 +85,36 @@ bool DirectoryService::SaveCoinbaseCore(const vector<bool>& b1,
     return false;
   }
 
-  unsigned int i = 0;
   constexpr uint16_t MAX_REPUTATION =
       4096;  // This means the max priority is 12. A node need to continually
              // run for 5 days to achieve this reputation.
 
+  // The members rarely move within a DS epoch, so their positions in
+  // m_coinbaseKeys are looked up once and only checked after that
+  auto& indexes = m_coinbaseCommitteeIndexes[shard_id];
+  indexes.resize(shard.size(), UINT32_MAX);
+  vector<uint32_t>* rewardees = nullptr;
+
+  unsigned int i = 0;
   for (const auto& kv : shard) {
-    const auto& pubKey = std::get<SHARD_NODE_PUBKEY>(kv);
-    if (b1.at(i)) {
-      m_coinbaseRewardees[epochNum][shard_id].push_back(pubKey);
-      if (m_mapNodeReputation[pubKey] < MAX_REPUTATION) {
-        ++m_mapNodeReputation[pubKey];
+    const unsigned int sigs = (b1[i] ? 1 : 0) + (b2[i] ? 1 : 0);
+    if (sigs > 0) {
+      const auto& pubKey = std::get<SHARD_NODE_PUBKEY>(kv);
+      uint32_t& index = indexes[i];
+      if (index >= m_coinbaseKeys.size() ||
+          !(m_coinbaseKeys[index] == pubKey)) {
+        index = GetCoinbaseIndex(pubKey);
       }
-    }
-    if (b2.at(i)) {
-      m_coinbaseRewardees[epochNum][shard_id].push_back(pubKey);
-      if (m_mapNodeReputation[pubKey] < MAX_REPUTATION) {
-        ++m_mapNodeReputation[pubKey];
+
+      if (rewardees == nullptr) {
+        rewardees = &m_coinbaseRewardees[epochNum][shard_id];
+      }
+      rewardees->insert(rewardees->end(), sigs, index);
+      m_coinbaseSigCounts[index] += sigs;
+
+      auto& reputation = m_mapNodeReputation[pubKey];
+      if (reputation < MAX_REPUTATION) {
+        reputation = min<unsigned int>(reputation + sigs, MAX_REPUTATION);
       }
     }
     i++;
@@ -111,8 +147,10 @@ void DirectoryService::LookupCoinbase(
 
   for (const auto& lookupNode : vecLookup) {
     LOG_GENERAL(INFO, " " << lookupNode.first);
+    const uint32_t index = GetCoinbaseIndex(lookupNode.first);
     m_coinbaseRewardees[epochNum][CoinbaseReward::LOOKUP_REWARD].push_back(
-        lookupNode.first);
+        index);
+    m_coinbaseLookupCounts[index]++;
   }
 
   /*for (const auto& shard : shards) {
@@ -212,8 +250,10 @@ void DirectoryService::InitCoinbase() {
   lock_guard<mutex> g(m_mutexCoinbaseRewardees);
 
   for (const auto& lookupNode : vecLookup) {
+    const uint32_t index = GetCoinbaseIndex(lookupNode.first);
     m_coinbaseRewardees[epochNum][CoinbaseReward::LOOKUP_REWARD].push_back(
-        lookupNode.first);
+        index);
+    m_coinbaseLookupCounts[index]++;
   }
 
   if (m_coinbaseRewardees.size() < NUM_FINAL_BLOCK_PER_POW - 1) {
@@ -230,14 +270,9 @@ void DirectoryService::InitCoinbase() {
 
   uint128_t sig_count = 0;
   uint32_t lookup_count = 0;
-  for (auto const& epochNum : m_coinbaseRewardees) {
-    for (auto const& shardId : epochNum.second) {
-      if (shardId.first == CoinbaseReward::LOOKUP_REWARD) {
-        lookup_count += shardId.second.size();
-      } else {
-        sig_count += shardId.second.size();
-      }
-    }
+  for (size_t i = 0; i < m_coinbaseKeys.size(); i++) {
+    sig_count += m_coinbaseSigCounts[i];
+    lookup_count += m_coinbaseLookupCounts[i];
   }
   LOG_GENERAL(INFO, "Total signatures count: " << sig_count << " lookup count "
                                                << lookup_count);
@@ -300,36 +335,28 @@ void DirectoryService::InitCoinbase() {
   AccountStore::GetInstance().IncreaseBalanceTemp(coinbaseAddress,
                                                   m_totalTxnFees);
 
-  uint128_t suc_counter = 0;
-  uint128_t suc_lookup_counter = 0;
   const auto& myAddr =
       Account::GetAddressFromPublicKey(m_mediator.m_selfKey.second);
 
-  // Reward to all nodes
+  // Every account gets its base, cosig and lookup rewards in one credit,
+  // so each address is derived and each account touched once. Base reward
+  // shares are counted per key alongside the cosigs.
+  vector<uint32_t> baseShares;
+  auto addBaseShare = [this, &baseShares](const PubKey& key) {
+    const uint32_t index = GetCoinbaseIndex(key);
+    baseShares.resize(m_coinbaseKeys.size(), 0);
+    baseShares[index]++;
+  };
+
   // DS nodes
   for (const auto& ds : *m_mediator.m_DSCommittee) {
-    Address addr = Account::GetAddressFromPublicKey(ds.first);
-    if (GUARD_MODE) {
-      if (Guard::GetInstance().IsNodeInDSGuardList(ds.first)) {
-        if (addr == myAddr) {
-          LOG_GENERAL(INFO, "I am a Guard Node, skip coinbase");
-        }
-        continue;
-      }
-    }
-    if (!AccountStore::GetInstance().UpdateCoinbaseTemp(addr, coinbaseAddress,
-                                                        base_reward_each)) {
-      LOG_GENERAL(WARNING, "Could Not reward base reward  " << addr);
-    } else {
-      if (addr == myAddr) {
-        LOG_EPOCH(INFO, m_mediator.m_currentEpochNum,
-                  "[REWARD] Rewarded base reward " << base_reward_each);
-        LOG_STATE("[REWARD][" << setw(15) << left
-                              << m_mediator.m_selfPeer.GetPrintableIPAddress()
-                              << "][" << m_mediator.m_currentEpochNum << "]["
-                              << base_reward_each << "] base reward");
+    if (GUARD_MODE && Guard::GetInstance().IsNodeInDSGuardList(ds.first)) {
+      if (ds.first == m_mediator.m_selfKey.second) {
+        LOG_GENERAL(INFO, "I am a Guard Node, skip coinbase");
       }
+      continue;
     }
+    addBaseShare(ds.first);
   }
   // shard nodes
   for (const auto& shard : m_shards) {
@@ -338,59 +365,80 @@ void DirectoryService::InitCoinbase() {
               std::get<SHARD_NODE_PUBKEY>(node))) {
         continue;
       }
-      Address addr =
-          Account::GetAddressFromPublicKey(std::get<SHARD_NODE_PUBKEY>(node));
-      if (!AccountStore::GetInstance().UpdateCoinbaseTemp(addr, coinbaseAddress,
-                                                          base_reward_each)) {
-        LOG_GENERAL(WARNING, "Could Not reward base reward  " << addr);
-      }
-      // No need to log as shard node won't call InitCoinbase
+      addBaseShare(std::get<SHARD_NODE_PUBKEY>(node));
+    }
+  }
+  baseShares.resize(m_coinbaseKeys.size(), 0);
+
+  vector<pair<Address, uint128_t>> credits;
+  vector<uint32_t> creditKeys;
+  vector<uint32_t> paidSigs;
+  credits.reserve(m_coinbaseKeys.size());
+  for (uint32_t i = 0; i < m_coinbaseKeys.size(); i++) {
+    const PubKey& key = m_coinbaseKeys[i];
+    uint32_t sigs = m_coinbaseSigCounts[i];
+    if (sigs > 0 && GUARD_MODE &&
+        (Guard::GetInstance().IsNodeInDSGuardList(key) ||
+         Guard::GetInstance().IsNodeInShardGuardList(key))) {
+      sigs = 0;
+    }
+    if (baseShares[i] == 0 && sigs == 0 && m_coinbaseLookupCounts[i] == 0) {
+      continue;
     }
+
+    credits.emplace_back(Account::GetAddressFromPublicKey(key),
+                         baseShares[i] * base_reward_each +
+                             sigs * reward_each +
+                             m_coinbaseLookupCounts[i] * reward_each_lookup);
+    creditKeys.emplace_back(i);
+    paidSigs.emplace_back(sigs);
   }
 
-  // Reward based on cosigs
-  for (auto const& epochNumShardRewardee : m_coinbaseRewardees) {
-    LOG_GENERAL(
-        INFO, "[CNBSE] Rewarding " << epochNumShardRewardee.first << " epoch");
-
-    for (auto const& shardIdRewardee : epochNumShardRewardee.second) {
-      LOG_GENERAL(INFO,
-                  "[CNBSE] Rewarding " << shardIdRewardee.first << " shard");
-      if (shardIdRewardee.first == CoinbaseReward::LOOKUP_REWARD) {
-        for (auto const& pk : shardIdRewardee.second) {
-          const auto& addr = Account::GetAddressFromPublicKey(pk);
-          if (!AccountStore::GetInstance().UpdateCoinbaseTemp(
-                  addr, coinbaseAddress, reward_each_lookup)) {
-            LOG_GENERAL(WARNING, "Could Not reward " << addr);
-          } else {
-            suc_lookup_counter++;
-          }
+  vector<bool> paid;
+  AccountStore::GetInstance().UpdateCoinbaseTemp(credits, coinbaseAddress,
+                                                 paid);
+
+  uint128_t suc_counter = 0;
+  uint128_t suc_lookup_counter = 0;
+  for (size_t i = 0; i < credits.size(); i++) {
+    if (!paid[i]) {
+      LOG_GENERAL(WARNING, "Could Not reward " << credits[i].first);
+      continue;
+    }
+    suc_counter += paidSigs[i];
+    suc_lookup_counter += m_coinbaseLookupCounts[creditKeys[i]];
+
+    if (credits[i].first != myAddr) {
+      continue;
+    }
+    if (baseShares[creditKeys[i]] > 0) {
+      LOG_EPOCH(INFO, m_mediator.m_currentEpochNum,
+                "[REWARD] Rewarded base reward " << base_reward_each);
+      LOG_STATE("[REWARD][" << setw(15) << left
+                            << m_mediator.m_selfPeer.GetPrintableIPAddress()
+                            << "][" << m_mediator.m_currentEpochNum << "]["
+                            << base_reward_each << "] base reward");
+    }
+    if (paidSigs[i] == 0) {
+      continue;
+    }
+    for (auto const& epochNumShardRewardee : m_coinbaseRewardees) {
+      for (auto const& shardIdRewardee : epochNumShardRewardee.second) {
+        if (shardIdRewardee.first == CoinbaseReward::LOOKUP_REWARD) {
+          continue;
         }
-      } else {
-        for (auto const& pk : shardIdRewardee.second) {
-          if (GUARD_MODE) {
-            if (Guard::GetInstance().IsNodeInDSGuardList(pk) ||
-                Guard::GetInstance().IsNodeInShardGuardList(pk)) {
-              continue;
-            }
-          }
-          const auto& addr = Account::GetAddressFromPublicKey(pk);
-          if (!AccountStore::GetInstance().UpdateCoinbaseTemp(
-                  addr, coinbaseAddress, reward_each)) {
-            LOG_GENERAL(WARNING, "Could Not reward " << addr);
-          } else {
-            if (addr == myAddr) {
-              LOG_EPOCH(INFO, m_mediator.m_currentEpochNum,
-                        "[REWARD] Rewarded " << reward_each << " for blk "
-                                             << epochNumShardRewardee.first);
-              LOG_STATE("[REWARD]["
-                        << setw(15) << left
-                        << m_mediator.m_selfPeer.GetPrintableIPAddress() << "]["
-                        << m_mediator.m_currentEpochNum << "][" << reward_each
-                        << "] for blk " << epochNumShardRewardee.first);
-            }
-            suc_counter++;
+        for (const auto index : shardIdRewardee.second) {
+          if (index != creditKeys[i]) {
+            continue;
           }
+          LOG_EPOCH(INFO, m_mediator.m_currentEpochNum,
+                    "[REWARD] Rewarded " << reward_each << " for blk "
+                                         << epochNumShardRewardee.first);
+          LOG_STATE("[REWARD]["
+                    << setw(15) << left
+                    << m_mediator.m_selfPeer.GetPrintableIPAddress() << "]["
+                    << m_mediator.m_currentEpochNum << "][" << reward_each
+                    << "] for blk " << epochNumShardRewardee.first);
         }
       }
     }
@@ -403,7 +451,7 @@ void DirectoryService::InitCoinbase() {
   LOG_GENERAL(INFO, "Left reward: " << balance_left);
 
   uint16_t lastBlockHash = DataConversion::charArrTo16Bits(
-      m_mediator.m_txBlockChain.GetLastBlock().GetBlockHash().asBytes());
+      m_mediator.m_txBlockChain.GetLastBlockPtr()->GetBlockHash().asBytes());
   uint16_t shardIndex =
       lastBlockHash % m_coinbaseRewardees[m_mediator.m_currentEpochNum].size();
   uint16_t count = 0;
@@ -414,9 +462,9 @@ void DirectoryService::InitCoinbase() {
       uint16_t rdm_index_copy = rdm_index;
       if (GUARD_MODE) {
         while (Guard::GetInstance().IsNodeInDSGuardList(
-                   shard.second.at(rdm_index)) ||
+                   m_coinbaseKeys.at(shard.second.at(rdm_index))) ||
                Guard::GetInstance().IsNodeInShardGuardList(
-                   shard.second.at(rdm_index))) {
+                   m_coinbaseKeys.at(shard.second.at(rdm_index)))) {
           rdm_index = (rdm_index + 1) % shard.second.size();
           if (rdm_index == rdm_index_copy) {
             LOG_GENERAL(WARNING, "Going into infinite loop");
@@ -429,8 +477,8 @@ void DirectoryService::InitCoinbase() {
         break;
       }
 
-      const Address& winnerAddr =
-          Account::GetAddressFromPublicKey(shard.second.at(rdm_index));
+      const Address& winnerAddr = Account::GetAddressFromPublicKey(
+          m_coinbaseKeys.at(shard.second.at(rdm_index)));
       LOG_GENERAL(INFO, "Lucky draw winner: " << winnerAddr);
       if (!AccountStore::GetInstance().UpdateCoinbaseTemp(
               winnerAddr, coinbaseAddress, balance_left)) {
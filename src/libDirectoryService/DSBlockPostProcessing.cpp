@@ -27,6 +27,7 @@
 #include "depends/common/RLP.h"
 #include "depends/libTrie/TrieDB.h"
 #include "depends/libTrie/TrieHash.h"
+#include "libCrypto/PubKeyTable.h"
 #include "libCrypto/Sha2.h"
 #include "libMediator/Mediator.h"
 #include "libMessage/Messenger.h"
@@ -108,6 +109,72 @@ bool DirectoryService::ComposeDSBlockMessageForSender(bytes& dsblock_message) {
   return true;
 }
 
+bool DirectoryService::ComposeDSBlockDiffMessage(
+    const DequeOfShard& prevShards) {
+  m_dsBlockDiffMessage.clear();
+  m_shardTakesDiff.assign(m_shards.size(), false);
+
+  if (prevShards.empty()) {
+    return false;
+  }
+
+  // Only a structure matching the previous DS block can serve as the base
+  const uint64_t blockNum = m_pendingDSBlock->GetHeader().GetBlockNum();
+  ShardingHash prevShardingHash;
+  if (blockNum == 0 ||
+      !Messenger::GetShardingStructureHash(SHARDINGSTRUCTURE_VERSION,
+                                           prevShards, prevShardingHash) ||
+      prevShardingHash != m_mediator.m_dsBlockChain.GetBlockPtr(blockNum - 1)
+                              ->GetHeader()
+                              .GetShardingHash()) {
+    LOG_GENERAL(INFO, "No previous sharding structure to send a diff against");
+    return false;
+  }
+
+  unordered_set<PubKey> prevMembers;
+  for (const auto& shard : prevShards) {
+    for (const auto& node : shard) {
+      prevMembers.emplace(std::get<SHARD_NODE_PUBKEY>(node));
+    }
+  }
+
+  // A shard forwards the message among its members, so it only gets the diff
+  // if all of them hold the previous structure
+  bool anyShard = false;
+  for (unsigned int i = 0; i < m_shards.size(); i++) {
+    m_shardTakesDiff[i] =
+        all_of(m_shards[i].begin(), m_shards[i].end(),
+               [&prevMembers](const auto& node) {
+                 return prevMembers.count(std::get<SHARD_NODE_PUBKEY>(node)) >
+                        0;
+               });
+    anyShard = anyShard || m_shardTakesDiff[i];
+  }
+
+  if (!anyShard) {
+    return false;
+  }
+
+  m_dsBlockDiffMessage = {MessageType::NODE, NodeInstructionType::DSBLOCK};
+  if (!Messenger::SetNodeVCDSBlocksMessage(
+          m_dsBlockDiffMessage, MessageOffset::BODY, 0, *m_pendingDSBlock,
+          m_VCBlockVector, SHARDINGSTRUCTURE_VERSION, m_shards, prevShards,
+          prevShardingHash)) {
+    LOG_EPOCH(WARNING, m_mediator.m_currentEpochNum,
+              "Messenger::SetNodeVCDSBlocksMessage failed.");
+    m_dsBlockDiffMessage.clear();
+    m_shardTakesDiff.assign(m_shards.size(), false);
+    return false;
+  }
+
+  LOG_GENERAL(INFO, "Sharding structure diff "
+                        << m_dsBlockDiffMessage.size() << " bytes for "
+                        << count(m_shardTakesDiff.begin(),
+                                 m_shardTakesDiff.end(), true)
+                        << " of " << m_shards.size() << " shards");
+  return true;
+}
+
 void DirectoryService::SendDSBlockToLookupNodesAndNewDSMembers(
     const bytes& dsblock_message) {
   if (LOOKUP_NODE_MODE) {
@@ -135,7 +202,7 @@ void DirectoryService::SendDSBlockToLookupNodesAndNewDSMembers(
 }
 
 void DirectoryService::SendDSBlockToShardNodes(
-    [[gnu::unused]] const bytes& dsblock_message, const DequeOfShard& shards,
+    const bytes& dsblock_message, const DequeOfShard& shards,
     const unsigned int& my_shards_lo, const unsigned int& my_shards_hi) {
   if (LOOKUP_NODE_MODE) {
     LOG_GENERAL(WARNING,
@@ -154,14 +221,16 @@ void DirectoryService::SendDSBlockToShardNodes(
     uint32_t shardId =
         m_publicKeyToshardIdMap.at(std::get<SHARD_NODE_PUBKEY>(p->front()));
 
-    bytes dsblock_message_to_shard = {MessageType::NODE,
-                                      NodeInstructionType::DSBLOCK};
-    if (!Messenger::SetNodeVCDSBlocksMessage(
-            dsblock_message_to_shard, MessageOffset::BODY, shardId,
-            *m_pendingDSBlock, m_VCBlockVector, SHARDINGSTRUCTURE_VERSION,
-            m_shards)) {
+    // The composed message only differs by shard id, so it is not serialized
+    // again for every shard
+    const bool sendDiff =
+        !m_dsBlockDiffMessage.empty() && m_shardTakesDiff.at(i);
+    bytes dsblock_message_to_shard =
+        sendDiff ? m_dsBlockDiffMessage : dsblock_message;
+    if (!Messenger::SetNodeVCDSBlocksMessageShardId(
+            dsblock_message_to_shard, MessageOffset::BODY, shardId)) {
       LOG_EPOCH(WARNING, m_mediator.m_currentEpochNum,
-                "Messenger::SetNodeVCDSBlocksMessage failed.");
+                "Messenger::SetNodeVCDSBlocksMessageShardId failed.");
       continue;
     }
 
@@ -217,8 +286,8 @@ void DirectoryService::SendDSBlockToShardNodes(
 
 void DirectoryService::UpdateMyDSModeAndConsensusId() {
   LOG_MARKER();
-  uint16_t numOfIncomingDs = m_mediator.m_dsBlockChain.GetLastBlock()
-                                 .GetHeader()
+  uint16_t numOfIncomingDs = m_mediator.m_dsBlockChain.GetLastBlockPtr()
+                                 ->GetHeader()
                                  .GetDSPoWWinners()
                                  .size();
 
@@ -232,10 +301,11 @@ void DirectoryService::UpdateMyDSModeAndConsensusId() {
   uint16_t lastBlockHash = 0;
   if (m_mediator.m_currentEpochNum > 1) {
     lastBlockHash =
-        DataConversion::charArrTo16Bits(m_mediator.m_dsBlockChain.GetLastBlock()
-                                            .GetHeader()
-                                            .GetHashForRandom()
-                                            .asBytes());
+        DataConversion::charArrTo16Bits(
+            m_mediator.m_dsBlockChain.GetLastBlockPtr()
+                ->GetHeader()
+                .GetHashForRandom()
+                .asBytes());
   }
   // Check if I am the oldest backup DS (I will no longer be part of the DS
   // committee)
@@ -306,7 +376,9 @@ void DirectoryService::UpdateDSCommiteeComposition() {
   LOG_MARKER();
 
   const map<PubKey, Peer> NewDSMembers =
-      m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetDSPoWWinners();
+      m_mediator.m_dsBlockChain.GetLastBlockPtr()
+          ->GetHeader()
+          .GetDSPoWWinners();
   deque<pair<PubKey, Peer>>::iterator it;
 
   for (const auto& DSPowWinner : NewDSMembers) {
@@ -332,6 +404,17 @@ void DirectoryService::UpdateDSCommiteeComposition() {
     }
     m_mediator.m_DSCommittee->pop_back();
   }
+  {
+    lock_guard<mutex> g(m_mediator.m_mutexDSCommittee);
+    m_mediator.PublishDSCommittee();
+  }
+
+  // Precompute the keys the DS consensus responses are checked against
+  vector<PubKey> dsKeys;
+  for (const auto& dsMember : *m_mediator.m_DSCommittee) {
+    dsKeys.emplace_back(dsMember.first);
+  }
+  PubKeyTableCache::GetInstance().Prepare(TABLE_GROUP_DS_COMMITTEE, dsKeys);
 }
 
 void DirectoryService::StartFirstTxEpoch() {
@@ -356,7 +439,7 @@ void DirectoryService::StartFirstTxEpoch() {
   m_viewChangeCounter = 0;
 
   {
-    std::lock_guard<mutex> lock(m_mutexMicroBlocks);
+    std::lock_guard<ProfiledMutex> lock(m_mutexMicroBlocks);
     m_microBlocks.clear();
     m_missingMicroBlocks.clear();
     m_microBlockStateDeltas.clear();
@@ -366,6 +449,7 @@ void DirectoryService::StartFirstTxEpoch() {
   if (m_mode != IDLE) {
     lock_guard<mutex> g(m_mediator.m_node->m_mutexShardMember);
     m_mediator.m_node->m_myShardMembers = m_mediator.m_DSCommittee;
+    m_mediator.m_node->InvalidateBroadcastLists();
 
     LOG_EPOCH(INFO, m_mediator.m_currentEpochNum, " DS Sharding structure: ");
 
@@ -412,7 +496,9 @@ void DirectoryService::StartFirstTxEpoch() {
         "[MIBLKSWAIT]["
         << setw(15) << left << m_mediator.m_selfPeer.GetPrintableIPAddress()
         << "]["
-        << m_mediator.m_txBlockChain.GetLastBlock().GetHeader().GetBlockNum() +
+        << m_mediator.m_txBlockChain.GetLastBlockPtr()
+            ->GetHeader()
+            .GetBlockNum() +
                1
         << "] BEGIN");
 
@@ -441,8 +527,8 @@ void DirectoryService::StartFirstTxEpoch() {
         LOG_STATE("[MIBLKSWAIT]["
                   << setw(15) << left
                   << m_mediator.m_selfPeer.GetPrintableIPAddress() << "]["
-                  << m_mediator.m_txBlockChain.GetLastBlock()
-                             .GetHeader()
+                  << m_mediator.m_txBlockChain.GetLastBlockPtr()
+                             ->GetHeader()
                              .GetBlockNum() +
                          1
                   << "] TIMEOUT: Didn't receive all Microblock.");
@@ -504,7 +590,9 @@ void DirectoryService::ProcessDSBlockConsensusWhenDone(
         "[DSCON]["
         << setw(15) << left << m_mediator.m_selfPeer.GetPrintableIPAddress()
         << "]["
-        << m_mediator.m_txBlockChain.GetLastBlock().GetHeader().GetBlockNum() +
+        << m_mediator.m_txBlockChain.GetLastBlockPtr()
+            ->GetHeader()
+            .GetBlockNum() +
                1
         << "] DONE");
   }
@@ -521,7 +609,7 @@ void DirectoryService::ProcessDSBlockConsensusWhenDone(
     m_pendingDSBlock->SetCoSignatures(*m_consensusObject);
 
     if (m_pendingDSBlock->GetHeader().GetBlockNum() >
-        m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetBlockNum() +
+        m_mediator.m_dsBlockChain.GetLastBlockPtr()->GetHeader().GetBlockNum() +
             1) {
       LOG_EPOCH(WARNING, m_mediator.m_currentEpochNum,
                 "We are missing some blocks. What to do here?");
@@ -546,6 +634,17 @@ void DirectoryService::ProcessDSBlockConsensusWhenDone(
   } else if (m_mode == PRIMARY_DS) {
     ClearReputationOfNodeFailToJoin(m_shards, m_mapNodeReputation);
   }
+  {
+    lock_guard<mutex> g(m_mutexShards);
+    PublishShards();
+  }
+
+  // The stored structure is still the previous DS epoch's
+  DequeOfShard prevShards;
+  if (ENABLE_SHARDING_DIFF &&
+      !BlockStorage::GetBlockStorage().GetShardStructure(prevShards)) {
+    prevShards.clear();
+  }
 
   m_mediator.m_node->m_myshardId = m_shards.size();
   BlockStorage::GetBlockStorage().PutShardStructure(
@@ -564,7 +663,9 @@ void DirectoryService::ProcessDSBlockConsensusWhenDone(
     LOG_EPOCH(INFO, m_mediator.m_currentEpochNum,
               "DSBlock to be sent to the lookup nodes");
 
-    auto composeDSBlockMessageForSender = [this](bytes& message) -> bool {
+    auto composeDSBlockMessageForSender =
+        [this, &prevShards](bytes& message) -> bool {
+      ComposeDSBlockDiffMessage(prevShards);
       return ComposeDSBlockMessageForSender(message);
     };
 
@@ -584,7 +685,7 @@ void DirectoryService::ProcessDSBlockConsensusWhenDone(
     DataSender::GetInstance().SendDataToOthers(
         *m_pendingDSBlock, *(m_mediator.m_DSCommittee), m_shards, {},
         m_mediator.m_lookup->GetLookupNodes(),
-        m_mediator.m_txBlockChain.GetLastBlock().GetBlockHash(),
+        m_mediator.m_txBlockChain.GetLastBlockPtr()->GetBlockHash(),
         m_consensusMyID, composeDSBlockMessageForSender,
         sendDSBlockToLookupNodesAndNewDSMembers, sendDSBlockToShardNodes);
   }
@@ -593,7 +694,9 @@ void DirectoryService::ProcessDSBlockConsensusWhenDone(
       "[DSBLK]["
       << setw(15) << left << m_mediator.m_selfPeer.GetPrintableIPAddress()
       << "]["
-      << m_mediator.m_txBlockChain.GetLastBlock().GetHeader().GetBlockNum() + 1
+      << m_mediator.m_txBlockChain.GetLastBlockPtr()
+          ->GetHeader()
+          .GetBlockNum() + 1
       << "] AFTER SENDING DSBLOCK");
 
   ClearVCBlockVector();
@@ -702,6 +805,17 @@ bool DirectoryService::ProcessDSBlockConsensus(
     return false;
   }
 
+  // Verify outside m_mutexConsensus, so that the commits and responses of
+  // many backups are checked in parallel
+  shared_ptr<ConsensusCommon> consensusObject;
+  {
+    lock_guard<mutex> g(m_mutexConsensus);
+    consensusObject = m_consensusObject;
+  }
+  if (consensusObject != nullptr) {
+    consensusObject->PreProcessMessage(message, offset);
+  }
+
   lock_guard<mutex> g(m_mutexConsensus);
 
   if (!m_consensusObject->ProcessMessage(message, offset, from)) {
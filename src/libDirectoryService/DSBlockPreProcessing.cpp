@@ -18,8 +18,10 @@
 #include <algorithm>
 #include <chrono>
 #include <thread>
+#include <unordered_map>
 
 #include "DirectoryService.h"
+#include "PoWOrdering.h"
 #include "common/Constants.h"
 #include "common/Messages.h"
 #include "common/Serializable.h"
@@ -94,20 +96,24 @@ unsigned int DirectoryService::ComputeDSBlockParameters(
   // Start to adjust difficulty from second DS block.
   if (blockNum > 1) {
     dsDifficulty = CalculateNewDSDifficulty(
-        m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetDSDifficulty());
+        m_mediator.m_dsBlockChain.GetLastBlockPtr()
+            ->GetHeader()
+            .GetDSDifficulty());
     LOG_EPOCH(INFO, m_mediator.m_currentEpochNum,
               "Current DS difficulty "
-                  << std::to_string(m_mediator.m_dsBlockChain.GetLastBlock()
-                                        .GetHeader()
+                  << std::to_string(m_mediator.m_dsBlockChain.GetLastBlockPtr()
+                                        ->GetHeader()
                                         .GetDSDifficulty())
                   << ", new DS difficulty " << std::to_string(dsDifficulty));
 
     difficulty = CalculateNewDifficulty(
-        m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetDifficulty());
+        m_mediator.m_dsBlockChain.GetLastBlockPtr()
+            ->GetHeader()
+            .GetDifficulty());
     LOG_EPOCH(INFO, m_mediator.m_currentEpochNum,
               "Current difficulty "
-                  << std::to_string(m_mediator.m_dsBlockChain.GetLastBlock()
-                                        .GetHeader()
+                  << std::to_string(m_mediator.m_dsBlockChain.GetLastBlockPtr()
+                                        ->GetHeader()
                                         .GetDifficulty())
                   << ", new difficulty " << std::to_string(difficulty));
   }
@@ -162,33 +168,21 @@ void DirectoryService::ComputeSharding(const VectorOfPoWSoln& sortedPoWSolns) {
     m_shards.emplace_back();
   }
 
-  // Push all the sorted PoW submissions into an ordered map with key =
-  // H(last_block_hash, pow_hash)
-  map<array<unsigned char, BLOCK_HASH_SIZE>, PubKey> sortedPoWs;
+  // Order the sorted PoW submissions by H(last_block_hash, pow_hash)
   bytes lastBlockHash(BLOCK_HASH_SIZE);
 
   if (m_mediator.m_currentEpochNum > 1) {
     lastBlockHash =
-        m_mediator.m_txBlockChain.GetLastBlock().GetBlockHash().asBytes();
+        m_mediator.m_txBlockChain.GetLastBlockPtr()->GetBlockHash().asBytes();
   }
 
-  bytes hashVec(BLOCK_HASH_SIZE + POW_SIZE);
-  copy(lastBlockHash.begin(), lastBlockHash.end(), hashVec.begin());
-  for (const auto& kv : sortedPoWSolns) {
-    const PubKey& key = kv.second;
-    const auto& powHash = kv.first;
-    copy(powHash.begin(), powHash.end(), hashVec.begin() + BLOCK_HASH_SIZE);
+  const auto shardingOrder =
+      PoWOrdering::ShardingOrder(sortedPoWSolns, lastBlockHash);
 
-    const bytes& sortHashVec = HashUtils::BytesToHash(hashVec);
-    array<unsigned char, BLOCK_HASH_SIZE> sortHash;
-    copy(sortHashVec.begin(), sortHashVec.end(), sortHash.begin());
-    sortedPoWs.emplace(sortHash, key);
-  }
-
-  // Distribute the map-ordered nodes among the generated shards
+  // Distribute the ordered nodes among the generated shards
   // First fill up first shard, then second shard, ..., then final shard
   uint32_t shard_index = 0;
-  for (const auto& kv : sortedPoWs) {
+  for (const auto index : shardingOrder) {
     // Move to next shard counter if current shard already filled up
     if (shardCounts.at(shard_index) == 0) {
       shard_index++;
@@ -197,17 +191,20 @@ void DirectoryService::ComputeSharding(const VectorOfPoWSoln& sortedPoWSolns) {
         break;
       }
     }
+    const PubKey& key = sortedPoWSolns[index].second;
     if (DEBUG_LEVEL >= 5) {
       string hashStr;
-      if (!DataConversion::charArrToHexStr(kv.first, hashStr)) {
+      if (!DataConversion::charArrToHexStr(
+              PoWOrdering::ShardingHasher(lastBlockHash)(
+                  sortedPoWSolns[index].first),
+              hashStr)) {
         LOG_GENERAL(WARNING, "[DSSORT] "
                                  << " unable to convert hash to string");
       } else {
-        LOG_GENERAL(INFO, "[DSSORT] " << kv.second << " " << hashStr << endl);
+        LOG_GENERAL(INFO, "[DSSORT] " << key << " " << hashStr << endl);
       }
     }
     // Put the node into the shard
-    const PubKey& key = kv.second;
     m_shards.at(shard_index)
         .emplace_back(key, m_allPoWConns.at(key), m_mapNodeReputation[key]);
     m_publicKeyToshardIdMap.emplace(key, shard_index);
@@ -313,8 +310,8 @@ bool DirectoryService::VerifyPoWWinner(
                       << ". Will continue look for it in PoW from leader.");
       if (dsWinnerPoWsFromLeader.find(DSPowWinner.first) !=
           dsWinnerPoWsFromLeader.end()) {
-        uint8_t expectedDSDiff = m_mediator.m_dsBlockChain.GetLastBlock()
-                                     .GetHeader()
+        uint8_t expectedDSDiff = m_mediator.m_dsBlockChain.GetLastBlockPtr()
+                                     ->GetHeader()
                                      .GetDSDifficulty();
         const auto& peer = m_allPoWConns.at(DSPowWinner.first);
         const auto& dsPowSoln = dsWinnerPoWsFromLeader.at(DSPowWinner.first);
@@ -355,7 +352,9 @@ bool DirectoryService::VerifyPoWWinner(
 bool DirectoryService::VerifyDifficulty() {
   auto remoteDSDifficulty = m_pendingDSBlock->GetHeader().GetDSDifficulty();
   auto localDSDifficulty = CalculateNewDSDifficulty(
-      m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetDSDifficulty());
+      m_mediator.m_dsBlockChain.GetLastBlockPtr()
+          ->GetHeader()
+          .GetDSDifficulty());
   constexpr uint8_t DIFFICULTY_TOL = 1;
   if (std::max(remoteDSDifficulty, localDSDifficulty) -
           std::min(remoteDSDifficulty, localDSDifficulty) >
@@ -371,7 +370,7 @@ bool DirectoryService::VerifyDifficulty() {
 
   auto remoteDifficulty = m_pendingDSBlock->GetHeader().GetDifficulty();
   auto localDifficulty = CalculateNewDifficulty(
-      m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetDifficulty());
+      m_mediator.m_dsBlockChain.GetLastBlockPtr()->GetHeader().GetDifficulty());
   if (std::max(remoteDifficulty, localDifficulty) -
           std::min(remoteDifficulty, localDifficulty) >
       DIFFICULTY_TOL) {
@@ -394,7 +393,7 @@ bool DirectoryService::VerifyPoWOrdering(
 
   if (m_mediator.m_currentEpochNum > 1) {
     lastBlockHash =
-        m_mediator.m_txBlockChain.GetLastBlock().GetBlockHash().asBytes();
+        m_mediator.m_txBlockChain.GetLastBlockPtr()->GetBlockHash().asBytes();
   }
 
   const float MISORDER_TOLERANCE =
@@ -422,23 +421,24 @@ bool DirectoryService::VerifyPoWOrdering(
     }
   }
 
-  bytes hashVec(BLOCK_HASH_SIZE + BLOCK_HASH_SIZE);
-  std::copy(lastBlockHash.begin(), lastBlockHash.end(), hashVec.begin());
+  // Index the solutions by key, rather than searching them for every node
+  unordered_map<PubKey, uint32_t> indexOfKey;
+  indexOfKey.reserve(sortedPoWSolns.size());
+  for (uint32_t i = 0; i < sortedPoWSolns.size(); i++) {
+    indexOfKey.emplace(sortedPoWSolns[i].second, i);
+  }
+
+  PoWOrdering::ShardingHasher hasher(lastBlockHash);
   bool ret = true;
-  bytes vec(BLOCK_HASH_SIZE), preVec(BLOCK_HASH_SIZE);
+  PoWOrdering::PoWHash vec{}, preVec{};
   uint32_t misorderNodes = 0;
   for (const auto& shard : shards) {
     for (const auto& shardNode : shard) {
       const PubKey& toFind = std::get<SHARD_NODE_PUBKEY>(shardNode);
-      auto it = std::find_if(
-          sortedPoWSolns.cbegin(), sortedPoWSolns.cend(),
-          [&toFind](
-              const std::pair<std::array<unsigned char, 32>, PubKey>& item) {
-            return item.second == toFind;
-          });
+      auto it = indexOfKey.find(toFind);
 
       std::array<unsigned char, 32> result;
-      if (it == sortedPoWSolns.cend()) {
+      if (it == indexOfKey.end()) {
         LOG_GENERAL(WARNING, "Failed to find key in the PoW ordering "
                                  << toFind << " " << sortedPoWSolns.size());
 
@@ -457,8 +457,8 @@ bool DirectoryService::VerifyPoWOrdering(
               (GUARD_MODE &&
                Guard::GetInstance().IsNodeInShardGuardList(pubKeyToPoW->first))
                   ? (POW_DIFFICULTY / POW_DIFFICULTY)
-                  : m_mediator.m_dsBlockChain.GetLastBlock()
-                        .GetHeader()
+                  : m_mediator.m_dsBlockChain.GetLastBlockPtr()
+                        ->GetHeader()
                         .GetDifficulty();
 
           string resultStr, mixHashStr;
@@ -489,7 +489,7 @@ bool DirectoryService::VerifyPoWOrdering(
           break;
         }
       } else {
-        result = it->first;
+        result = sortedPoWSolns[it->second].first;
       }
 
       auto r = keyset.insert(std::get<SHARD_NODE_PUBKEY>(shardNode));
@@ -500,12 +500,11 @@ bool DirectoryService::VerifyPoWOrdering(
         break;
       }
 
-      copy(result.begin(), result.end(), hashVec.begin() + BLOCK_HASH_SIZE);
-      const bytes& sortHashVec = HashUtils::BytesToHash(hashVec);
+      const auto sortHashVec = hasher(result);
 
       if (DEBUG_LEVEL >= 5) {
         string sortHashVecStr;
-        if (!DataConversion::Uint8VecToHexStr(sortHashVec, sortHashVecStr)) {
+        if (!DataConversion::charArrToHexStr(sortHashVec, sortHashVecStr)) {
           LOG_GENERAL(INFO,
                       "[DSSORT]"
                           << " Unable to convert sortHashVec to hex string");
@@ -517,8 +516,8 @@ bool DirectoryService::VerifyPoWOrdering(
       }
       if (sortHashVec < vec) {
         string vecStr, sortHashVecStr;
-        if (!DataConversion::Uint8VecToHexStr(vec, vecStr) ||
-            !DataConversion::Uint8VecToHexStr(sortHashVec, sortHashVecStr)) {
+        if (!DataConversion::charArrToHexStr(vec, vecStr) ||
+            !DataConversion::charArrToHexStr(sortHashVec, sortHashVecStr)) {
           LOG_GENERAL(WARNING,
                       "Unable to convert vec or sortHashVec to hex string");
         } else {
@@ -600,109 +599,52 @@ bool DirectoryService::VerifyNodePriority(const DequeOfShard& shards) {
 
 VectorOfPoWSoln DirectoryService::SortPoWSoln(const MapOfPubKeyPoW& mapOfPoWs,
                                               bool trimBeyondCommSize) {
-  std::map<array<unsigned char, 32>, PubKey> PoWOrderSorter;
-  for (const auto& powsoln : mapOfPoWs) {
-    PoWOrderSorter[powsoln.second.result] = powsoln.first;
-  }
-
-  // Put it back to vector for easy manipulation and adjustment of the ordering
-  VectorOfPoWSoln sortedPoWSolns;
-  if (trimBeyondCommSize) {
-    const uint32_t numNodesTotal = PoWOrderSorter.size();
-    const uint32_t numNodesAfterTrim =
-        ShardSizeCalculator::GetTrimmedShardCount(
-            m_mediator.GetShardSize(false), SHARD_SIZE_TOLERANCE_LO,
-            SHARD_SIZE_TOLERANCE_HI, numNodesTotal);
-
-    LOG_GENERAL(INFO, "Trimming the solutions sorted list from "
-                          << numNodesTotal << " to " << numNodesAfterTrim);
-
-    uint32_t count = 0;
-    if (!GUARD_MODE) {
-      for (auto kv = PoWOrderSorter.begin();
-           (kv != PoWOrderSorter.end()) && (count < numNodesAfterTrim);
-           kv++, count++) {
-        sortedPoWSolns.emplace_back(*kv);
-      }
-    } else {
-      // If total num of shard nodes to be trim, ensure shard guards do not get
-      // trimmed. To do it, a new map  will be created to included all shard
-      // guards and a subset of normal shard nods
-      // Steps:
-      // 1. Maintain a map that called "FilteredPoWOrderSorter". It will
-      // eventually contains Shard guards + subset of normal nodes
-      // 2. Maintain a shadow copy of "PoWOrderSorter" called
-      // "ShadowPoWOrderSorter". It is to track non guards node.
-      // 3. Add shard guards to "FilteredPoWOrderSorter" ands remove it from
-      // "ShadowPoWOrderSorter"
-      // 4. If there are still slots left, obtained remaining normal shard node
-      // from "ShadowPoWOrderSorter". Use it to populate
-      // "FilteredPoWOrderSorter"
-      // 5. Finally, sort "FilteredPoWOrderSorter" and stored result in
-      // "PoWOrderSorter"
-      uint32_t trimmedGuardCount =
-          ceil(numNodesAfterTrim * ConsensusCommon::TOLERANCE_FRACTION);
-      uint32_t trimmedNonGuardCount = numNodesAfterTrim - trimmedGuardCount;
-
-      if (trimmedGuardCount + trimmedNonGuardCount < numNodesAfterTrim) {
-        LOG_GENERAL(WARNING,
-                    "Network has less than 1/3 non shard guard node. Filling "
-                    "it with guard nodes");
-        trimmedGuardCount +=
-            (numNodesAfterTrim - trimmedGuardCount - trimmedNonGuardCount);
-      }
-
-      // Assign all shard guards first
-      std::map<array<unsigned char, 32>, PubKey> FilteredPoWOrderSorter;
-      std::map<array<unsigned char, 32>, PubKey> ShadowPoWOrderSorter =
-          PoWOrderSorter;
-
-      // Add shard guards to "FilteredPoWOrderSorter"
-      // Remove it from "ShadowPoWOrderSorter"
-      for (auto kv = PoWOrderSorter.begin();
-           (kv != PoWOrderSorter.end()) && (count < numNodesAfterTrim); kv++) {
-        if (Guard::GetInstance().IsNodeInShardGuardList(kv->second)) {
-          if (count == trimmedGuardCount) {
-            LOG_GENERAL(
-                INFO,
-                "Did not manage to form max number of shard. Only allowed "
-                    << trimmedGuardCount << " shard guards");
-            break;
-          }
-          FilteredPoWOrderSorter.emplace(*kv);
-          ShadowPoWOrderSorter.erase(kv->first);
-          count++;
-        }
-      }
-
-      // Assign non shard guards if there is any slots
-      for (auto kv = ShadowPoWOrderSorter.begin();
-           (kv != ShadowPoWOrderSorter.end()) && (count < numNodesAfterTrim);
-           kv++) {
-        FilteredPoWOrderSorter.emplace(*kv);
-        count++;
-      }
+  VectorOfPoWSoln sortedPoWSolns = PoWOrdering::SortByResult(mapOfPoWs);
+  if (!trimBeyondCommSize) {
+    return sortedPoWSolns;
+  }
 
-      // Sort "FilteredPoWOrderSorter" and stored it in "sortedPoWSolns"
-      for (auto kv : FilteredPoWOrderSorter) {
-        sortedPoWSolns.emplace_back(kv);
-      }
-      LOG_GENERAL(INFO, "trimmedGuardCount: "
-                            << trimmedGuardCount
-                            << " trimmedNonGuardCount: " << trimmedNonGuardCount
-                            << " Total number of accepted soln: "
-                            << sortedPoWSolns.size());
-    }
+  const uint32_t numNodesTotal = sortedPoWSolns.size();
+  const uint32_t numNodesAfterTrim = ShardSizeCalculator::GetTrimmedShardCount(
+      m_mediator.GetShardSize(false), SHARD_SIZE_TOLERANCE_LO,
+      SHARD_SIZE_TOLERANCE_HI, numNodesTotal);
 
-    LOG_GENERAL(INFO,
-                "Number of solns after trimming is " << sortedPoWSolns.size());
+  LOG_GENERAL(INFO, "Trimming the solutions sorted list from "
+                        << numNodesTotal << " to " << numNodesAfterTrim);
 
+  if (!GUARD_MODE) {
+    sortedPoWSolns = PoWOrdering::Trim(sortedPoWSolns, numNodesAfterTrim);
   } else {
-    for (const auto& kv : PoWOrderSorter) {
-      sortedPoWSolns.emplace_back(kv);
+    // If total num of shard nodes to be trim, ensure shard guards do not get
+    // trimmed: up to trimmedGuardCount shard guards are kept first, and the
+    // slots left go to the best of the remaining solutions
+    uint32_t trimmedGuardCount =
+        ceil(numNodesAfterTrim * ConsensusCommon::TOLERANCE_FRACTION);
+    uint32_t trimmedNonGuardCount = numNodesAfterTrim - trimmedGuardCount;
+
+    if (trimmedGuardCount + trimmedNonGuardCount < numNodesAfterTrim) {
+      LOG_GENERAL(WARNING,
+                  "Network has less than 1/3 non shard guard node. Filling "
+                  "it with guard nodes");
+      trimmedGuardCount +=
+          (numNodesAfterTrim - trimmedGuardCount - trimmedNonGuardCount);
     }
+
+    sortedPoWSolns = PoWOrdering::TrimWithGuards(
+        sortedPoWSolns, numNodesAfterTrim, trimmedGuardCount,
+        [](const PubKey& key) {
+          return Guard::GetInstance().IsNodeInShardGuardList(key);
+        });
+    LOG_GENERAL(INFO, "trimmedGuardCount: "
+                          << trimmedGuardCount
+                          << " trimmedNonGuardCount: " << trimmedNonGuardCount
+                          << " Total number of accepted soln: "
+                          << sortedPoWSolns.size());
   }
 
+  LOG_GENERAL(INFO,
+              "Number of solns after trimming is " << sortedPoWSolns.size());
+
   return sortedPoWSolns;
 }
 
@@ -837,7 +779,7 @@ bool DirectoryService::RunConsensusOnDSBlockWhenDSPrimary() {
   // Create new consensus object
   uint32_t consensusID = 0;
   m_consensusBlockHash =
-      m_mediator.m_txBlockChain.GetLastBlock().GetBlockHash().asBytes();
+      m_mediator.m_txBlockChain.GetLastBlockPtr()->GetBlockHash().asBytes();
 
 #ifdef VC_TEST_DS_SUSPEND_1
   if (m_mode == PRIMARY_DS && m_viewChangeCounter < 1) {
@@ -875,7 +817,9 @@ bool DirectoryService::RunConsensusOnDSBlockWhenDSPrimary() {
       "[DSCON]["
       << std::setw(15) << std::left
       << m_mediator.m_selfPeer.GetPrintableIPAddress() << "]["
-      << m_mediator.m_txBlockChain.GetLastBlock().GetHeader().GetBlockNum() + 1
+      << m_mediator.m_txBlockChain.GetLastBlockPtr()
+          ->GetHeader()
+          .GetBlockNum() + 1
       << "] BGIN, POWS = " << m_allPoWs.size());
 
   // Refer to Effective mordern C++. Item 32: Use init capture to move objects
@@ -1042,10 +986,27 @@ bool DirectoryService::DSBlockValidator(
     return false;
   }
 
-  auto func = [this]() mutable -> void {
+  // As in the shards, only the first few DS members go to the release host
+  vector<Peer> upgradePeers;
+  {
+    lock_guard<mutex> g(m_mediator.m_mutexDSCommittee);
+    const auto& dsCommittee = *m_mediator.m_DSCommittee;
+    for (unsigned int i = 0;
+         i < min<size_t>(UPGRADE_PEER_SEEDS, dsCommittee.size()); i++) {
+      const Peer& peer = dsCommittee.at(i).second;
+      if (peer == Peer() || peer == m_mediator.m_selfPeer) {
+        upgradePeers.clear();
+        break;
+      }
+      upgradePeers.emplace_back(peer);
+    }
+  }
+
+  auto func = [this, upgradePeers]() mutable -> void {
     lock_guard<mutex> g(m_mediator.m_mutexCurSWInfo);
     if (m_mediator.m_curSWInfo != m_pendingDSBlock->GetHeader().GetSWInfo()) {
-      if (UpgradeManager::GetInstance().DownloadSW()) {
+      if (UpgradeManager::GetInstance().DownloadSW(
+              upgradePeers, m_mediator.m_selfPeer.m_listenPortHost)) {
         m_mediator.m_curSWInfo =
             *UpgradeManager::GetInstance().GetLatestSWInfo();
       }
@@ -1085,7 +1046,7 @@ bool DirectoryService::RunConsensusOnDSBlockWhenDSBackup() {
   // Dummy values for now
   uint32_t consensusID = 0x0;
   m_consensusBlockHash =
-      m_mediator.m_txBlockChain.GetLastBlock().GetBlockHash().asBytes();
+      m_mediator.m_txBlockChain.GetLastBlockPtr()->GetBlockHash().asBytes();
 
   auto func = [this](const bytes& input, unsigned int offset, bytes& errorMsg,
                      const uint32_t consensusID, const uint64_t blockNumber,
@@ -1203,7 +1164,7 @@ void DirectoryService::RunConsensusOnDSBlock(bool isRejoin) {
 
   {
     lock_guard<mutex> h(m_mutexCoinbaseRewardees);
-    m_coinbaseRewardees.clear();
+    ClearCoinbase();
   }
 
   {
@@ -1240,6 +1201,8 @@ void DirectoryService::RunConsensusOnDSBlock(bool isRejoin) {
     cv_DSBlockConsensusObject.notify_all();
   }
 
+  PrepareViewChangeCandidate();
+
   // View change will wait for timeout. If conditional variable is notified
   // before timeout, the thread will return without triggering view change.
   std::unique_lock<std::mutex> cv_lk(m_MutexCVViewChangeDSBlock);
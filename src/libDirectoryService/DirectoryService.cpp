@@ -32,6 +32,7 @@
 #include "libNetwork/Guard.h"
 #include "libNetwork/P2PComm.h"
 #include "libPOW/pow.h"
+#include "libUtils/AsyncExecutor.h"
 #include "libUtils/DataConversion.h"
 #include "libUtils/DetachedFunction.h"
 #include "libUtils/HashUtils.h"
@@ -52,6 +53,11 @@ DirectoryService::DirectoryService(Mediator& mediator) : m_mediator(mediator) {
   m_consensusLeaderID = 0;
   m_mediator.m_consensusID = 1;
   m_viewChangeCounter = 0;
+  if (!LOOKUP_NODE_MODE && POW_VERIFY_THREADS > 0) {
+    m_powVerifyPool = std::make_unique<ThreadPool>(
+        POW_VERIFY_THREADS, "PoWVerifyPool",
+        ThreadPlacement::Resolve(VERIFY_PLACEMENT, "PoWVerifyPool"));
+  }
 }
 
 DirectoryService::~DirectoryService() {}
@@ -79,7 +85,9 @@ void DirectoryService::StartSynchronization() {
           m_mediator.m_blocklinkchain.GetLatestIndex() + 1);
       m_synchronizer.FetchLatestTxBlocks(
           m_mediator.m_lookup,
-          m_mediator.m_txBlockChain.GetLastBlock().GetHeader().GetBlockNum() +
+          m_mediator.m_txBlockChain.GetLastBlockPtr()
+              ->GetHeader()
+              .GetBlockNum() +
               1);
       this_thread::sleep_for(chrono::seconds(NEW_NODE_SYNC_INTERVAL));
     }
@@ -199,9 +207,8 @@ bool DirectoryService::ProcessSetPrimary(const bytes& message,
     dsstore.AddPeerPair(
         m_mediator.m_selfKey.second,
         m_mediator.m_selfPeer);  // Add myself, but with dummy IP info
-    vector<pair<PubKey, Peer>> ds = dsstore.GetAllPeerPairs();
-    m_mediator.m_DSCommittee->resize(ds.size());
-    copy(ds.begin(), ds.end(), m_mediator.m_DSCommittee->begin());
+    const auto ds = dsstore.GetPeerPairsSnapshot();
+    m_mediator.m_DSCommittee->assign(ds->begin(), ds->end());
 
     bytes setDSBootstrapNodeMessage = {
         MessageType::LOOKUP, LookupInstructionType::SETDSINFOFROMSEED};
@@ -222,9 +229,8 @@ bool DirectoryService::ProcessSetPrimary(const bytes& message,
   peerstore.AddPeerPair(m_mediator.m_selfKey.second,
                         Peer());  // Add myself, but with dummy IP info
 
-  vector<pair<PubKey, Peer>> tmp1 = peerstore.GetAllPeerPairs();
-  m_mediator.m_DSCommittee->resize(tmp1.size());
-  copy(tmp1.begin(), tmp1.end(), m_mediator.m_DSCommittee->begin());
+  const auto tmp1 = peerstore.GetPeerPairsSnapshot();
+  m_mediator.m_DSCommittee->assign(tmp1->begin(), tmp1->end());
   peerstore.RemovePeer(m_mediator.m_selfKey.second);  // Remove myself
 
   // Lets start the gossip as earliest as possible
@@ -275,16 +281,17 @@ bool DirectoryService::ProcessSetPrimary(const bytes& message,
     LOG_GENERAL(WARNING, "ProcessSetPrimary called in epoch "
                              << m_mediator.m_currentEpochNum);
     m_consensusLeaderID =
-        DataConversion::charArrTo16Bits(m_mediator.m_dsBlockChain.GetLastBlock()
-                                            .GetHeader()
-                                            .GetHashForRandom()
-                                            .asBytes()) %
+        DataConversion::charArrTo16Bits(
+            m_mediator.m_dsBlockChain.GetLastBlockPtr()
+                ->GetHeader()
+                .GetHashForRandom()
+                .asBytes()) %
         m_mediator.m_DSCommittee->size();
   }
 
   LOG_EPOCH(INFO, m_mediator.m_currentEpochNum,
-            "START OF EPOCH " << m_mediator.m_dsBlockChain.GetLastBlock()
-                                         .GetHeader()
+            "START OF EPOCH " << m_mediator.m_dsBlockChain.GetLastBlockPtr()
+                                         ->GetHeader()
                                          .GetBlockNum() +
                                      1);
 
@@ -308,10 +315,8 @@ bool DirectoryService::ProcessSetPrimary(const bytes& message,
     this_thread::sleep_for(chrono::seconds(POW_WINDOW_IN_SECONDS));
 
     // create and send POW submission packets
-    auto func = [this]() mutable -> void {
-      this->ProcessAndSendPoWPacketSubmissionToOtherDSComm();
-    };
-    DetachedFunction(1, func);
+    AsyncExecutor::GetInstance().Post(
+        [this]() { this->ProcessAndSendPoWPacketSubmissionToOtherDSComm(); });
 
     LOG_EPOCH(INFO, m_mediator.m_currentEpochNum,
               "Waiting " << POWPACKETSUBMISSION_WINDOW_IN_SECONDS
@@ -350,9 +355,9 @@ bool DirectoryService::CheckWhetherDSBlockIsFresh(const uint64_t dsblock_num) {
   }
 
   // uint128_t latest_block_num_in_blockchain =
-  // m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetBlockNum();
+  // m_mediator.m_dsBlockChain.GetLastBlockPtr()->GetHeader().GetBlockNum();
   uint64_t latest_block_num_in_blockchain =
-      m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetBlockNum();
+      m_mediator.m_dsBlockChain.GetLastBlockPtr()->GetHeader().GetBlockNum();
 
   if (dsblock_num < latest_block_num_in_blockchain + 1) {
     LOG_EPOCH(WARNING, m_mediator.m_currentEpochNum,
@@ -378,6 +383,31 @@ void DirectoryService::SetState(DirState state) {
   }
 
   m_state = state;
+
+  switch (state) {
+    case POW_SUBMISSION:
+      m_epochPhaseTimer.Enter(EPOCH_PHASE_POW);
+      break;
+    case DSBLOCK_CONSENSUS_PREP:
+    case DSBLOCK_CONSENSUS:
+      m_epochPhaseTimer.Enter(EPOCH_PHASE_DS_CONSENSUS);
+      break;
+    case MICROBLOCK_SUBMISSION:
+      m_epochPhaseTimer.Enter(EPOCH_PHASE_MICROBLOCK_SUBMISSION);
+      break;
+    case FINALBLOCK_CONSENSUS_PREP:
+    case FINALBLOCK_CONSENSUS:
+      m_epochPhaseTimer.Enter(EPOCH_PHASE_FINALBLOCK_CONSENSUS);
+      break;
+    case VIEWCHANGE_CONSENSUS_PREP:
+    case VIEWCHANGE_CONSENSUS:
+      m_epochPhaseTimer.Enter(EPOCH_PHASE_VIEWCHANGE);
+      break;
+    default:
+      m_epochPhaseTimer.Enter(EPOCH_PHASE_NONE);
+      break;
+  }
+
   LOG_EPOCH(INFO, m_mediator.m_currentEpochNum,
             "DS State is now " << GetStateString());
 }
@@ -403,6 +433,15 @@ uint16_t DirectoryService::GetConsensusLeaderID() const {
   return m_consensusLeaderID.load();
 }
 
+void DirectoryService::PublishShards() {
+  m_shardsSnapshot.Publish(m_shards, m_mediator.m_currentEpochNum);
+}
+
+std::shared_ptr<const DequeOfShard> DirectoryService::GetShardsSnapshot()
+    const {
+  return m_shardsSnapshot.Get();
+}
+
 vector<Peer> DirectoryService::GetBroadcastList(
     [[gnu::unused]] unsigned char ins_type,
     [[gnu::unused]] const Peer& broadcast_originator) {
@@ -428,7 +467,11 @@ bool DirectoryService::CleanVariables() {
 
   LOG_MARKER();
 
-  m_shards.clear();
+  {
+    lock_guard<mutex> g(m_mutexShards);
+    m_shards.clear();
+    PublishShards();
+  }
   m_publicKeyToshardIdMap.clear();
   m_allPoWConns.clear();
   m_mapNodeReputation.clear();
@@ -436,6 +479,7 @@ bool DirectoryService::CleanVariables() {
   {
     lock_guard<mutex> g(m_mediator.m_mutexDSCommittee);
     m_mediator.m_DSCommittee->clear();
+    m_mediator.PublishDSCommittee();
   }
 
   m_stopRecvNewMBSubmission = false;
@@ -462,7 +506,7 @@ bool DirectoryService::CleanVariables() {
   ResetPoWSubmissionCounter();
 
   {
-    std::lock_guard<mutex> lock(m_mutexMicroBlocks);
+    std::lock_guard<ProfiledMutex> lock(m_mutexMicroBlocks);
     m_microBlocks.clear();
     m_microBlockStateDeltas.clear();
     m_missingMicroBlocks.clear();
@@ -521,6 +565,7 @@ bool DirectoryService::FinishRejoinAsDS() {
         break;
       }
     }
+    m_mediator.PublishDSCommittee();
 
     LOG_GENERAL(INFO, "DS committee is ");
     for (const auto& i : *m_mediator.m_DSCommittee) {
@@ -634,7 +679,9 @@ void DirectoryService::StartNewDSEpochConsensus(bool fromFallback,
   cv_POWSubmission.notify_all();
 
   POW::GetInstance().EthashConfigureClient(
-      m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetBlockNum() + 1,
+      m_mediator.m_dsBlockChain.GetLastBlockPtr()
+          ->GetHeader()
+          .GetBlockNum() + 1,
       FULL_DATASET_MINE);
 
   if (m_mode == PRIMARY_DS) {
@@ -668,10 +715,8 @@ void DirectoryService::StartNewDSEpochConsensus(bool fromFallback,
                         (fromFallback ? FALLBACK_EXTRA_TIME : 0)));
 
     // create and send POW submission packets
-    auto func = [this]() mutable -> void {
-      this->ProcessAndSendPoWPacketSubmissionToOtherDSComm();
-    };
-    DetachedFunction(1, func);
+    AsyncExecutor::GetInstance().Post(
+        [this]() { this->ProcessAndSendPoWPacketSubmissionToOtherDSComm(); });
 
     LOG_EPOCH(INFO, m_mediator.m_currentEpochNum,
               "Waiting " << POWPACKETSUBMISSION_WINDOW_IN_SECONDS
@@ -764,7 +809,9 @@ bool DirectoryService::UpdateDSGuardIdentity() {
                                         DSInstructionType::NEWDSGUARDIDENTITY};
 
   uint64_t curDSEpochNo =
-      m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetBlockNum() + 1;
+      m_mediator.m_dsBlockChain.GetLastBlockPtr()
+          ->GetHeader()
+          .GetBlockNum() + 1;
 
   if (!Messenger::SetDSLookupNewDSGuardNetworkInfo(
           updatedsguardidentitymessage, MessageOffset::BODY, curDSEpochNo,
@@ -847,7 +894,9 @@ bool DirectoryService::ProcessNewDSGuardNetworkInfo(
   }
 
   uint64_t currentDSEpochNumber =
-      m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetBlockNum() + 1;
+      m_mediator.m_dsBlockChain.GetLastBlockPtr()
+          ->GetHeader()
+          .GetBlockNum() + 1;
   uint64_t loCurrentDSEpochNumber = currentDSEpochNumber - 1;
   uint64_t hiCurrentDSEpochNumber = currentDSEpochNumber + 1;
 
@@ -885,6 +934,7 @@ bool DirectoryService::ProcessNewDSGuardNetworkInfo(
                         << " -> " << dsGuardNewNetworkInfo);
         m_mediator.m_DSCommittee->at(indexOfDSGuard).second =
             dsGuardNewNetworkInfo;
+        m_mediator.PublishDSCommittee();
         break;
       }
     }
@@ -29,21 +29,29 @@
 #include <map>
 #include <set>
 #include <shared_mutex>
+#include <unordered_map>
 #include <vector>
 
 #include "common/Broadcastable.h"
 #include "common/Executable.h"
 #include "libConsensus/Consensus.h"
+#include "libCrypto/CommitteeKeyCache.h"
 #include "libCrypto/Schnorr.h"
 #include "libData/BlockData/Block.h"
 #include "libData/BlockData/BlockHeader/BlockHashSet.h"
 #include "libData/MiningData/DSPowSolution.h"
+#include "libDirectoryService/MicroBlockSet.h"
 #include "libLookup/Synchronizer.h"
 #include "libNetwork/DataSender.h"
 #include "libNetwork/P2PComm.h"
 #include "libNetwork/PeerStore.h"
 #include "libNetwork/ShardStruct.h"
 #include "libPersistence/BlockStorage.h"
+#include "libUtils/EpochMetrics.h"
+#include "libUtils/LockProfiler.h"
+#include "libUtils/Scheduler.h"
+#include "libUtils/Snapshot.h"
+#include "libUtils/ThreadPool.h"
 #include "libUtils/TimeUtils.h"
 
 class Mediator;
@@ -110,8 +118,6 @@ using MapOfPubKeyPoW = std::map<PubKey, PoWSolution>;
 /// Implements Directory Service functionality including PoW verification, DS,
 /// Tx Block Consensus and sharding management.
 class DirectoryService : public Executable, public Broadcastable {
-  std::chrono::system_clock::time_point m_timespec;
-
   enum Action {
     PROCESS_POWSUBMISSION = 0x00,
     VERIFYPOW,
@@ -128,6 +134,11 @@ class DirectoryService : public Executable, public Broadcastable {
   std::map<PubKey, uint32_t> m_tempPublicKeyToshardIdMap;
   std::map<PubKey, uint16_t> m_tempMapNodeReputation;
 
+  // DS block message sending the sharding structure as a diff against the
+  // previous DS epoch's, and whether each shard can take it
+  bytes m_dsBlockDiffMessage;
+  std::vector<bool> m_shardTakesDiff;
+
   // PoW common variables
   std::mutex m_mutexAllPoWConns;
   std::map<PubKey, Peer> m_allPoWConns;
@@ -186,8 +197,9 @@ class DirectoryService : public Executable, public Broadcastable {
   std::mutex m_MutexCVViewChangeDSBlock;
   std::condition_variable cv_viewChangeFinalBlock;
   std::mutex m_MutexCVViewChangeFinalBlock;
-  std::condition_variable cv_ViewChangeVCBlock;
-  std::mutex m_MutexCVViewChangeVCBlock;
+  // Restarts the view change unless its VC block is done in time
+  std::mutex m_mutexViewChangeTimer;
+  Scheduler::TimerId m_viewChangeTimer = 0;
 
   // To be used to store vc block (ds block consensus) for "normal nodes"
   std::mutex m_mutexVCBlockVector;
@@ -212,14 +224,33 @@ class DirectoryService : public Executable, public Broadcastable {
   Mediator& m_mediator;
 
   // Coinbase
-  // Map<EpochNumber, Map<shard-id, vector <Public keys to be rewarded>>
-  std::map<uint64_t, std::map<int32_t, std::vector<PubKey>>>
+  /// Everyone rewarded in this DS epoch, each once. The rewardees refer to
+  /// them by their position here, and the counts are kept alongside, so
+  /// InitCoinbase pays each account once.
+  std::vector<PubKey> m_coinbaseKeys;
+  std::unordered_map<PubKey, uint32_t> m_coinbaseKeyIndexes;
+  std::vector<uint32_t> m_coinbaseSigCounts;
+  std::vector<uint32_t> m_coinbaseLookupCounts;
+  /// Position in m_coinbaseKeys of each member of a committee, by shard-id
+  std::map<int32_t, std::vector<uint32_t>> m_coinbaseCommitteeIndexes;
+  // Map<EpochNumber, Map<shard-id, vector <Positions in m_coinbaseKeys>>
+  std::map<uint64_t, std::map<int32_t, std::vector<uint32_t>>>
       m_coinbaseRewardees;
   std::mutex m_mutexCoinbaseRewardees;
 
+  /// Returns the position of key in m_coinbaseKeys, adding it if needed.
+  /// Requires m_mutexCoinbaseRewardees.
+  uint32_t GetCoinbaseIndex(const PubKey& key);
+
+  /// Forgets the rewardees of the DS epoch. Requires
+  /// m_mutexCoinbaseRewardees.
+  void ClearCoinbase();
+
   // pow solutions
   std::vector<DSPowSolution> m_powSolutions;
   std::mutex m_mutexPowSolution;
+  /// Verifies the solutions of a PoW packet in parallel
+  std::unique_ptr<ThreadPool> m_powVerifyPool;
 
   const uint32_t RESHUFFLE_INTERVAL = 500;
 
@@ -230,7 +261,12 @@ class DirectoryService : public Executable, public Broadcastable {
                             const Peer& from);
   bool ProcessPoWPacketSubmission(const bytes& message, unsigned int offset,
                                   const Peer& from);
-  bool ProcessPoWSubmissionFromPacket(const DSPowSolution& sol);
+  bool ProcessPoWSubmissionFromPacket(const DSPowSolution& sol,
+                                      bool fullDataset = false);
+  /// Runs ProcessPoWSubmissionFromPacket for every solution on the calling
+  /// thread and m_powVerifyPool, and returns once all are done. Batches of
+  /// POW_BATCH_VERIFY_THRESHOLD or more are verified on the full dataset.
+  void ProcessPoWSubmissionsFromPacket(const std::vector<DSPowSolution>& sols);
 
   bool ProcessDSBlockConsensus(const bytes& message, unsigned int offset,
                                const Peer& from);
@@ -315,6 +351,9 @@ class DirectoryService : public Executable, public Broadcastable {
                                const DequeOfShard& shards,
                                const unsigned int& my_shards_lo,
                                const unsigned int& my_shards_hi);
+  /// Composes m_dsBlockDiffMessage against prevShards and marks the shards
+  /// whose members were all in it; returns false if there is no usable diff
+  bool ComposeDSBlockDiffMessage(const DequeOfShard& prevShards);
   void UpdateMyDSModeAndConsensusId();
   void UpdateDSCommiteeComposition();
 
@@ -336,6 +375,15 @@ class DirectoryService : public Executable, public Broadcastable {
       const std::vector<bytes>& stateDelta);
   bool ProcessMicroblockSubmissionFromShardCore(const MicroBlock& microBlocks,
                                                 const bytes& stateDelta);
+  /// Checks of a submitted microblock that do not change any DS state, so
+  /// submissions from different shards can be checked concurrently
+  bool CheckMicroBlockSubmission(const MicroBlock& microBlock);
+  /// Stores checked microblocks and their state deltas under
+  /// m_mutexMicroBlocks. The deltas are merged into the temp state in one
+  /// pass. Returns false unless all of them were stored.
+  bool StoreMicroBlockSubmissions(
+      const std::vector<std::pair<const MicroBlock*, const bytes*>>&
+          submissions);
   bool ProcessMissingMicroblockSubmission(
       const uint64_t epochNumber, const std::vector<MicroBlock>& microBlocks,
       const std::vector<bytes>& stateDeltas);
@@ -348,6 +396,13 @@ class DirectoryService : public Executable, public Broadcastable {
   bool ProcessStateDelta(const bytes& stateDelta,
                          const StateHash& microBlockStateDeltaHash,
                          const BlockHash& microBlockHash);
+  /// Checks a state delta against the hash in its microblock. hasDelta is
+  /// set if there is a delta to apply.
+  bool CheckStateDelta(const bytes& stateDelta,
+                       const StateHash& microBlockStateDeltaHash,
+                       bool& hasDelta);
+  /// Refreshes m_stateDeltaFromShards from the temp state
+  bool SerializeStateDeltaFromShards();
   void SkipDSMicroBlock();
   void PrepareRunConsensusOnFinalBlockNormal();
 
@@ -414,7 +469,15 @@ class DirectoryService : public Executable, public Broadcastable {
   void RunConsensusOnViewChange();
   void ScheduleViewChangeTimeout();
   bool ComputeNewCandidateLeader(const uint16_t candidateLeaderIndex);
-  uint16_t CalculateNewLeaderIndex();
+  uint16_t CalculateNewLeaderIndex(uint32_t vcCounter);
+  /// Returns the candidate leader and committee hash of a view change with
+  /// vcCounter, reusing the prepared ones while their inputs are unchanged.
+  /// The caller holds m_mediator.m_mutexDSCommittee.
+  bool GetViewChangeCandidate(uint32_t vcCounter, uint16_t& leaderIndex,
+                              CommitteeHash& committeeHash);
+  /// Prepares the view change candidate of the next view change while a
+  /// consensus round is running, so the view change finds it ready
+  void PrepareViewChangeCandidate();
   bool RunConsensusOnViewChangeWhenCandidateLeader(
       const uint16_t candidateLeaderIndex);
   bool RunConsensusOnViewChangeWhenNotCandidateLeader(
@@ -486,12 +549,22 @@ class DirectoryService : public Executable, public Broadcastable {
   DequeOfShard m_shards;
   std::map<PubKey, uint32_t> m_publicKeyToshardIdMap;
 
+  /// Copy of m_shards for readers that must not wait on m_mutexShards.
+  Snapshot<DequeOfShard> m_shardsSnapshot;
+
+  /// Aggregated key of each shard, for microblock co-signature checks.
+  std::map<uint32_t, CommitteeKeyCache> m_shardKeyCaches;
+  std::mutex m_mutexShardKeyCaches;
+
   // Proof of Reputation(PoR) variables.
   std::map<PubKey, uint16_t> m_mapNodeReputation;
 
   /// The current internal state of this DirectoryService instance.
   std::atomic<DirState> m_state;
 
+  /// Times how long m_state stays in each epoch phase
+  EpochPhaseTimer m_epochPhaseTimer{TIMELINE_ROLE_DS};
+
   /// The state (before view change) of this DirectoryService instance.
   std::atomic<DirState> m_viewChangestate;
 
@@ -512,8 +585,8 @@ class DirectoryService : public Executable, public Broadcastable {
   std::mutex m_mutexPrepareRunFinalblockConsensus;
   std::atomic<bool> m_startedRunFinalblockConsensus;
 
-  std::mutex m_mutexMicroBlocks;
-  std::unordered_map<uint64_t, std::set<MicroBlock>> m_microBlocks;
+  ProfiledMutex m_mutexMicroBlocks{"DirectoryService::MicroBlocks"};
+  std::unordered_map<uint64_t, MicroBlockSet> m_microBlocks;
   std::unordered_map<uint64_t, std::vector<BlockHash>> m_missingMicroBlocks;
   std::unordered_map<uint64_t, std::unordered_map<BlockHash, bytes>>
       m_microBlockStateDeltas;
@@ -528,6 +601,23 @@ class DirectoryService : public Executable, public Broadcastable {
 
   std::mutex m_MutexCVViewChangePrecheck;
   std::condition_variable cv_viewChangePrecheck;
+  bool m_vcPreCheckReceived = false;
+
+  // View change candidate and the state it was derived from
+  struct VCCandidate {
+    uint64_t blockLinkIndex;
+    bool latestIsVC;
+    BlockHash txBlockHash;
+    uint64_t epochNum;
+    uint16_t consensusLeaderID;
+    uint32_t viewChangeCounter;
+    DirState viewChangeState;
+    size_t committeeSize;
+    uint16_t leaderIndex;
+    CommitteeHash committeeHash;
+  };
+  std::unique_ptr<VCCandidate> m_vcCandidate;
+  std::mutex m_mutexVCCandidate;
 
   // Guard mode recovery. currently used only by lookup node.
   std::mutex m_mutexLookupStoreForGuardNodeUpdate;
@@ -560,6 +650,13 @@ class DirectoryService : public Executable, public Broadcastable {
   // Get m_consensusLeaderID
   uint16_t GetConsensusLeaderID() const;
 
+  /// Publishes the current m_shards to lock-free readers. Call with
+  /// m_mutexShards held once the sharding structure has been changed.
+  void PublishShards();
+
+  /// Returns the last published sharding structure without locking.
+  std::shared_ptr<const DequeOfShard> GetShardsSnapshot() const;
+
   // Increment m_consensusMyID
   void IncrementConsensusMyID();
 
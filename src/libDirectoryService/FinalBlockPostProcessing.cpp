@@ -30,6 +30,7 @@
 #include "libMediator/Mediator.h"
 #include "libMessage/Messenger.h"
 #include "libNetwork/Blacklist.h"
+#include "libUtils/AsyncExecutor.h"
 #include "libUtils/DataConversion.h"
 #include "libUtils/DetachedFunction.h"
 #include "libUtils/Logger.h"
@@ -64,14 +65,16 @@ void DirectoryService::StoreFinalBlockToDisk() {
 
   bytes serializedTxBlock;
   m_finalBlock->Serialize(serializedTxBlock, 0);
-  BlockStorage::GetBlockStorage().PutTxBlock(
-      m_finalBlock->GetHeader().GetBlockNum(), serializedTxBlock);
 
   bytes stateDelta;
   AccountStore::GetInstance().GetSerializedDelta(stateDelta);
-  BlockStorage::GetBlockStorage().PutStateDelta(
-      m_mediator.m_txBlockChain.GetLastBlock().GetHeader().GetBlockNum(),
-      stateDelta);
+
+  if (!BlockStorage::GetBlockStorage().CommitEpoch(
+          m_finalBlock->GetHeader().GetBlockNum(), serializedTxBlock,
+          stateDelta)) {
+    LOG_GENERAL(WARNING, "Failed to store final block "
+                             << m_finalBlock->GetHeader().GetBlockNum());
+  }
 }
 
 bool DirectoryService::ComposeFinalBlockMessageForSender(
@@ -88,7 +91,7 @@ bool DirectoryService::ComposeFinalBlockMessageForSender(
   finalblock_message = {MessageType::NODE, NodeInstructionType::FINALBLOCK};
 
   const uint64_t dsBlockNumber =
-      m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetBlockNum();
+      m_mediator.m_dsBlockChain.GetLastBlockPtr()->GetHeader().GetBlockNum();
 
   bytes stateDelta;
   AccountStore::GetInstance().GetSerializedDelta(stateDelta);
@@ -125,7 +128,9 @@ void DirectoryService::ProcessFinalBlockConsensusWhenDone() {
         "[FBCON]["
         << setw(15) << left << m_mediator.m_selfPeer.GetPrintableIPAddress()
         << "]["
-        << m_mediator.m_txBlockChain.GetLastBlock().GetHeader().GetBlockNum() +
+        << m_mediator.m_txBlockChain.GetLastBlockPtr()
+            ->GetHeader()
+            .GetBlockNum() +
                1
         << "] DONE");
   }
@@ -142,12 +147,9 @@ void DirectoryService::ProcessFinalBlockConsensusWhenDone() {
   // StoreMicroBlocksToDisk();
   StoreFinalBlockToDisk();
 
-  auto resumeBlackList = []() mutable -> void {
-    this_thread::sleep_for(chrono::seconds(RESUME_BLACKLIST_DELAY_IN_SECONDS));
-    Blacklist::GetInstance().Enable(true);
-  };
-
-  DetachedFunction(1, resumeBlackList);
+  AsyncExecutor::GetInstance().PostAfter(
+      chrono::seconds(RESUME_BLACKLIST_DELAY_IN_SECONDS),
+      []() { Blacklist::GetInstance().Enable(true); });
 
   if (isVacuousEpoch) {
     if (!AccountStore::GetInstance().MoveUpdatesToDisk()) {
@@ -173,7 +175,7 @@ void DirectoryService::ProcessFinalBlockConsensusWhenDone() {
   // Acquire shard receivers cosigs from MicroBlocks
   unordered_map<uint32_t, BlockBase> t_microBlocks;
   const auto& microBlocks = m_microBlocks
-      [m_mediator.m_txBlockChain.GetLastBlock().GetHeader().GetBlockNum()];
+      [m_mediator.m_txBlockChain.GetLastBlockPtr()->GetHeader().GetBlockNum()];
   for (const auto& microBlock : microBlocks) {
     t_microBlocks.emplace(microBlock.GetHeader().GetShardId(), microBlock);
   }
@@ -181,14 +183,17 @@ void DirectoryService::ProcessFinalBlockConsensusWhenDone() {
   DataSender::GetInstance().SendDataToOthers(
       *m_finalBlock, *m_mediator.m_DSCommittee, m_shards, t_microBlocks,
       m_mediator.m_lookup->GetLookupNodes(),
-      m_mediator.m_txBlockChain.GetLastBlock().GetBlockHash(), m_consensusMyID,
+      m_mediator.m_txBlockChain.GetLastBlockPtr()
+          ->GetBlockHash(), m_consensusMyID,
       composeFinalBlockMessageForSender);
 
   LOG_STATE(
       "[FLBLK]["
       << setw(15) << left << m_mediator.m_selfPeer.GetPrintableIPAddress()
       << "]["
-      << m_mediator.m_txBlockChain.GetLastBlock().GetHeader().GetBlockNum() + 1
+      << m_mediator.m_txBlockChain.GetLastBlockPtr()
+          ->GetHeader()
+          .GetBlockNum() + 1
       << "] AFTER SENDING FLBLK");
 
   if (m_mediator.m_node->m_microblock != nullptr && !isVacuousEpoch) {
@@ -202,12 +207,16 @@ void DirectoryService::ProcessFinalBlockConsensusWhenDone() {
   if (isVacuousEpoch) {
     lock_guard<mutex> g(m_mediator.m_mutexCurSWInfo);
     if (m_mediator.m_curSWInfo.GetZilliqaUpgradeDS() - 1 ==
-        m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetBlockNum()) {
+        m_mediator.m_dsBlockChain.GetLastBlockPtr()
+            ->GetHeader()
+            .GetBlockNum()) {
       UpgradeManager::GetInstance().ReplaceNode(m_mediator);
     }
 
     if (m_mediator.m_curSWInfo.GetScillaUpgradeDS() - 1 ==
-        m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetBlockNum()) {
+        m_mediator.m_dsBlockChain.GetLastBlockPtr()
+            ->GetHeader()
+            .GetBlockNum()) {
       UpgradeManager::GetInstance().InstallScilla();
     }
   }
@@ -235,8 +244,8 @@ void DirectoryService::ProcessFinalBlockConsensusWhenDone() {
       LOG_STATE("[MIBLKSWAIT][" << setw(15) << left
                                 << m_mediator.m_selfPeer.GetPrintableIPAddress()
                                 << "]["
-                                << m_mediator.m_txBlockChain.GetLastBlock()
-                                           .GetHeader()
+                                << m_mediator.m_txBlockChain.GetLastBlockPtr()
+                                           ->GetHeader()
                                            .GetBlockNum() +
                                        1
                                 << "] BEGIN");
@@ -259,8 +268,8 @@ void DirectoryService::ProcessFinalBlockConsensusWhenDone() {
         LOG_STATE("[MIBLKSWAIT]["
                   << setw(15) << left
                   << m_mediator.m_selfPeer.GetPrintableIPAddress() << "]["
-                  << m_mediator.m_txBlockChain.GetLastBlock()
-                             .GetHeader()
+                  << m_mediator.m_txBlockChain.GetLastBlockPtr()
+                             ->GetHeader()
                              .GetBlockNum() +
                          1
                   << "] TIMEOUT: Didn't receive all Microblock.");
@@ -444,6 +453,17 @@ bool DirectoryService::ProcessFinalBlockConsensusCore(
     return false;
   }
 
+  // Verify outside m_mutexConsensus, so that the commits and responses of
+  // many backups are checked in parallel
+  shared_ptr<ConsensusCommon> consensusObject;
+  {
+    lock_guard<mutex> g(m_mutexConsensus);
+    consensusObject = m_consensusObject;
+  }
+  if (consensusObject != nullptr) {
+    consensusObject->PreProcessMessage(message, offset);
+  }
+
   lock_guard<mutex> g(m_mutexConsensus);
 
   if (!m_consensusObject->ProcessMessage(message, offset, from)) {
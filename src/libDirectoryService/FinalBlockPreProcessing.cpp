@@ -57,7 +57,7 @@ void DirectoryService::ExtractDataFromMicroblocks(
   vector<BlockHash> microblockHashes;
 
   {
-    lock_guard<mutex> g(m_mutexMicroBlocks);
+    lock_guard<ProfiledMutex> g(m_mutexMicroBlocks);
 
     auto& microBlocks = m_microBlocks[m_mediator.m_currentEpochNum];
 
@@ -182,7 +182,9 @@ bool DirectoryService::ComposeFinalBlock() {
           allGasLimit, allGasUsed, allRewards, blockNum,
           {stateRoot, stateDeltaHash, mbInfoHash}, numTxs,
           m_mediator.m_selfKey.second,
-          m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetBlockNum(),
+          m_mediator.m_dsBlockChain.GetLastBlockPtr()
+              ->GetHeader()
+              .GetBlockNum(),
           version, committeeHash, prevHash),
       mbInfos, CoSignatures(m_mediator.m_DSCommittee->size())));
 
@@ -190,7 +192,9 @@ bool DirectoryService::ComposeFinalBlock() {
       "[STATS]["
       << std::setw(15) << std::left
       << m_mediator.m_selfPeer.GetPrintableIPAddress() << "]["
-      << m_mediator.m_txBlockChain.GetLastBlock().GetHeader().GetBlockNum() + 1
+      << m_mediator.m_txBlockChain.GetLastBlockPtr()
+          ->GetHeader()
+          .GetBlockNum() + 1
       << "][" << m_finalBlock->GetHeader().GetNumTxs() << "] FINAL");
 
   LOG_EPOCH(INFO, m_mediator.m_currentEpochNum,
@@ -263,7 +267,7 @@ bool DirectoryService::RunConsensusOnFinalBlockWhenDSPrimary(
 
   // Create new consensus object
   m_consensusBlockHash =
-      m_mediator.m_txBlockChain.GetLastBlock().GetBlockHash().asBytes();
+      m_mediator.m_txBlockChain.GetLastBlockPtr()->GetBlockHash().asBytes();
 
   auto commitErrorFunc = [this](const bytes& errorMsg,
                                 const Peer& from) mutable -> bool {
@@ -290,7 +294,9 @@ bool DirectoryService::RunConsensusOnFinalBlockWhenDSPrimary(
         "[FBCON]["
         << setw(15) << left << m_mediator.m_selfPeer.GetPrintableIPAddress()
         << "]["
-        << m_mediator.m_txBlockChain.GetLastBlock().GetHeader().GetBlockNum() +
+        << m_mediator.m_txBlockChain.GetLastBlockPtr()
+            ->GetHeader()
+            .GetBlockNum() +
                1
         << "] BGIN");
   }
@@ -372,7 +378,7 @@ bool DirectoryService::CheckPreviousFinalBlockHash() {
 
   const BlockHash& finalblockPrevHash = m_finalBlock->GetHeader().GetPrevHash();
   BlockHash expectedPrevHash =
-      m_mediator.m_txBlockChain.GetLastBlock().GetBlockHash();
+      m_mediator.m_txBlockChain.GetLastBlockPtr()->GetBlockHash();
 
   LOG_EPOCH(INFO, m_mediator.m_currentEpochNum,
             "Prev block hash recvd: "
@@ -380,7 +386,7 @@ bool DirectoryService::CheckPreviousFinalBlockHash() {
                 << "Prev block hash expected: " << expectedPrevHash.hex()
                 << endl
                 << "TxBlockHeader: "
-                << m_mediator.m_txBlockChain.GetLastBlock().GetHeader());
+                << m_mediator.m_txBlockChain.GetLastBlockPtr()->GetHeader());
 
   if (finalblockPrevHash != expectedPrevHash) {
     LOG_GENERAL(WARNING, "Previous hash check failed.");
@@ -423,12 +429,10 @@ bool DirectoryService::CheckMicroBlocks(bytes& errorMsg, bool fromShards,
   LOG_MARKER();
 
   {
-    lock_guard<mutex> g(m_mutexMicroBlocks);
+    lock_guard<ProfiledMutex> g(m_mutexMicroBlocks);
 
     m_missingMicroBlocks[m_mediator.m_currentEpochNum].clear();
-    // O(n^2) might be fine since number of shards is low
-    // If its slow on benchmarking, may be first populate an unordered_set and
-    // then std::find
+    const auto& microBlocks = m_microBlocks[m_mediator.m_currentEpochNum];
     for (const auto& info : m_finalBlock->GetMicroBlockInfos()) {
       if (info.m_shardId == m_shards.size()) {
         continue;
@@ -436,16 +440,7 @@ bool DirectoryService::CheckMicroBlocks(bytes& errorMsg, bool fromShards,
 
       BlockHash hash = info.m_microBlockHash;
       LOG_GENERAL(INFO, "MicroBlock hash: " << hash);
-      bool found = false;
-      auto& microBlocks = m_microBlocks[m_mediator.m_currentEpochNum];
-      for (auto& microBlock : microBlocks) {
-        if (microBlock.GetBlockHash() == hash) {
-          found = true;
-          break;
-        }
-      }
-
-      if (!found) {
+      if (microBlocks.Find(hash) == nullptr) {
         LOG_GENERAL(WARNING, "cannot find microblock with hash: " << hash);
         m_missingMicroBlocks[m_mediator.m_currentEpochNum].emplace_back(hash);
       }
@@ -495,46 +490,23 @@ bool DirectoryService::CheckLegitimacyOfMicroBlocks() {
 
   LOG_MARKER();
 
-  uint64_t allGasLimit = 0;
-  uint64_t allGasUsed = 0;
-  uint128_t allRewards = 0;
-  uint32_t allNumTxns = 0;
+  MicroBlockSet::Totals totals;
   uint32_t allNumMicroBlockHashes = 0;
 
   {
-    lock_guard<mutex> g(m_mutexMicroBlocks);
+    lock_guard<ProfiledMutex> g(m_mutexMicroBlocks);
 
-    auto& microBlocks = m_microBlocks[m_mediator.m_currentEpochNum];
-    for (auto& microBlock : microBlocks) {
-      uint64_t tmpGasLimit = allGasLimit, tmpGasUsed = allGasUsed;
-      uint128_t tmpRewards = allRewards;
-
-      bool flag = true;
-      if (!SafeMath<uint64_t>::add(
-              allGasLimit, microBlock.GetHeader().GetGasLimit(), allGasLimit)) {
-        flag = false;
-      }
-      if (flag &&
-          !SafeMath<uint64_t>::add(
-              allGasUsed, microBlock.GetHeader().GetGasUsed(), allGasUsed)) {
-        flag = false;
-      }
-      if (flag &&
-          !SafeMath<uint128_t>::add(
-              allRewards, microBlock.GetHeader().GetRewards(), allRewards)) {
-        flag = false;
-      }
-      if (!flag) {
-        allGasLimit = tmpGasLimit;
-        allGasUsed = tmpGasUsed;
-        allRewards = tmpRewards;
-      }
-
-      allNumTxns += microBlock.GetHeader().GetNumTxs();
-      ++allNumMicroBlockHashes;
-    }
+    // Summed as the microblocks arrived
+    const auto& microBlocks = m_microBlocks[m_mediator.m_currentEpochNum];
+    totals = microBlocks.GetTotals();
+    allNumMicroBlockHashes = microBlocks.size();
   }
 
+  const uint64_t allGasLimit = totals.m_gasLimit;
+  const uint64_t allGasUsed = totals.m_gasUsed;
+  const uint128_t allRewards = totals.m_rewards;
+  const uint32_t allNumTxns = totals.m_numTxns;
+
   bool ret = true;
 
   if (allGasLimit != m_finalBlock->GetHeader().GetGasLimit()) {
@@ -663,7 +635,7 @@ bool DirectoryService::OnNodeMissingMicroBlocks(const bytes& errorMsg,
 
   Peer peer(from.m_ipAddress, portNo);
 
-  lock_guard<mutex> g(m_mutexMicroBlocks);
+  lock_guard<ProfiledMutex> g(m_mutexMicroBlocks);
 
   auto& microBlocks = m_microBlocks[epochNum];
 
@@ -671,38 +643,28 @@ bool DirectoryService::OnNodeMissingMicroBlocks(const bytes& errorMsg,
   vector<bytes> stateDeltasSent;
 
   for (const auto& hash : missingMicroBlocks) {
-    bool found = false;
-    // O(n^2) might be fine since number of shards is low
-    // If its slow on benchmarking, may be first populate an unordered_set and
-    // then std::find
-    auto microBlockIter = microBlocks.begin();
-    for (; microBlockIter != microBlocks.end(); microBlockIter++) {
-      if (microBlockIter->GetBlockHash() == hash) {
-        found = true;
-        break;
-      }
-    }
+    const MicroBlock* microBlock = microBlocks.Find(hash);
 
-    if (microBlockIter->GetHeader().GetShardId() == m_shards.size()) {
-      LOG_GENERAL(WARNING, "Ignore the fetching of DS microblock");
+    if (microBlock == nullptr) {
+      LOG_GENERAL(WARNING,
+                  "cannot find missing microblock: (hash)" << hash.hex());
       continue;
     }
 
-    if (!found) {
-      LOG_GENERAL(WARNING,
-                  "cannot find missing microblock: (hash)" << hash.hex());
+    if (microBlock->GetHeader().GetShardId() == m_shards.size()) {
+      LOG_GENERAL(WARNING, "Ignore the fetching of DS microblock");
       continue;
     }
 
     auto found_delta =
-        m_microBlockStateDeltas[epochNum].find(microBlockIter->GetBlockHash());
+        m_microBlockStateDeltas[epochNum].find(microBlock->GetBlockHash());
     if (found_delta != m_microBlockStateDeltas[epochNum].end()) {
       stateDeltasSent.emplace_back(found_delta->second);
     } else {
       stateDeltasSent.push_back({});
     }
 
-    microBlocksSent.emplace_back(*microBlockIter);
+    microBlocksSent.emplace_back(*microBlock);
   }
 
   // // Final state delta
@@ -746,47 +708,38 @@ bool DirectoryService::CheckMicroBlockInfo() {
   LOG_GENERAL(INFO,
               "Total num of microblocks to check: " << microBlockInfos.size())
 
-  for (unsigned int i = 0; i < microBlockInfos.size(); i++) {
-    // LOG_GENERAL(INFO,
-    //             "Microblock" << i
-    //                 << "; shardId: " << shardIdsInMicroBlocks[i]
-    //                 << "; hashes: " << hashesInMicroBlocks[i]
-    //                 << "; IsMicroBlockEmpty: "
-    //                 << m_finalBlock->GetIsMicroBlockEmpty()[i]);
-    auto& microBlocks = m_microBlocks[m_mediator.m_currentEpochNum];
-    for (auto& microBlock : microBlocks) {
-      if (microBlock.GetBlockHash() == microBlockInfos.at(i).m_microBlockHash) {
-        if (m_finalBlock->GetMicroBlockInfos().at(i).m_txnRootHash !=
-            microBlock.GetHeader().GetTxRootHash()) {
-          LOG_GENERAL(
-              WARNING,
-              "MicroBlockInfo::m_txnRootHash in proposed final block is "
-              "incorrect"
-                  << endl
-                  << "MB Hash: " << microBlockInfos.at(i).m_microBlockHash
-                  << endl
-                  << "Expected: " << microBlock.GetHeader().GetTxRootHash()
-                  << " Received: "
-                  << m_finalBlock->GetMicroBlockInfos().at(i).m_txnRootHash);
+  {
+    lock_guard<ProfiledMutex> g(m_mutexMicroBlocks);
 
-          m_consensusObject->SetConsensusErrorCode(
-              ConsensusCommon::FINALBLOCK_MICROBLOCK_TXNROOT_ERROR);
-
-          return false;
-        } else if (m_finalBlock->GetMicroBlockInfos().at(i).m_shardId !=
-                   microBlock.GetHeader().GetShardId()) {
-          LOG_GENERAL(
-              WARNING,
-              "ShardIds in proposed final block is incorrect"
-                  << endl
-                  << "MB Hash: " << microBlockInfos.at(i).m_microBlockHash
-                  << endl
-                  << "Expected: " << (microBlock.GetHeader().GetShardId() == 0)
-                  << " Received: "
-                  << m_finalBlock->GetMicroBlockInfos().at(i).m_shardId);
-          return false;
-        }
-        break;
+    const auto& microBlocks = m_microBlocks[m_mediator.m_currentEpochNum];
+    for (const auto& info : microBlockInfos) {
+      const MicroBlock* microBlock = microBlocks.Find(info.m_microBlockHash);
+      if (microBlock == nullptr) {
+        continue;
+      }
+
+      if (info.m_txnRootHash != microBlock->GetHeader().GetTxRootHash()) {
+        LOG_GENERAL(
+            WARNING,
+            "MicroBlockInfo::m_txnRootHash in proposed final block is "
+            "incorrect"
+                << endl
+                << "MB Hash: " << info.m_microBlockHash << endl
+                << "Expected: " << microBlock->GetHeader().GetTxRootHash()
+                << " Received: " << info.m_txnRootHash);
+
+        m_consensusObject->SetConsensusErrorCode(
+            ConsensusCommon::FINALBLOCK_MICROBLOCK_TXNROOT_ERROR);
+
+        return false;
+      } else if (info.m_shardId != microBlock->GetHeader().GetShardId()) {
+        LOG_GENERAL(WARNING,
+                    "ShardIds in proposed final block is incorrect"
+                        << endl
+                        << "MB Hash: " << info.m_microBlockHash << endl
+                        << "Expected: " << microBlock->GetHeader().GetShardId()
+                        << " Received: " << info.m_shardId);
+        return false;
       }
     }
   }
@@ -1075,7 +1028,7 @@ bool DirectoryService::RunConsensusOnFinalBlockWhenDSBackup() {
 
   // Create new consensus object
   m_consensusBlockHash =
-      m_mediator.m_txBlockChain.GetLastBlock().GetBlockHash().asBytes();
+      m_mediator.m_txBlockChain.GetLastBlockPtr()->GetBlockHash().asBytes();
 
   auto func = [this](const bytes& input, unsigned int offset, bytes& errorMsg,
                      const uint32_t consensusID, const uint64_t blockNumber,
@@ -1212,6 +1165,8 @@ void DirectoryService::RunConsensusOnFinalBlock(
   }
 
   auto func1 = [this]() -> void {
+    PrepareViewChangeCandidate();
+
     // View change will wait for timeout. If conditional variable is notified
     // before timeout, the thread will return without triggering view change.
     std::unique_lock<std::mutex> cv_lk(m_MutexCVViewChangeFinalBlock);
@@ -1223,7 +1178,7 @@ void DirectoryService::RunConsensusOnFinalBlock(
       auto func2 = [this]() -> void {
         // Remove DS microblock from my list of microblocks
         {
-          lock_guard<mutex> g(m_mutexMicroBlocks);
+          lock_guard<ProfiledMutex> g(m_mutexMicroBlocks);
           auto& microBlocksAtEpoch =
               m_microBlocks[m_mediator.m_currentEpochNum];
           auto dsmb =
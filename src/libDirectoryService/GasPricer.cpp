@@ -26,21 +26,24 @@ uint128_t DirectoryService::GetNewGasPrice() {
   LOG_MARKER();
 
   uint64_t loBlockNum =
-      m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetEpochNum();
+      m_mediator.m_dsBlockChain.GetLastBlockPtr()->GetHeader().GetEpochNum();
   uint64_t hiBlockNum =
-      m_mediator.m_txBlockChain.GetLastBlock().GetHeader().GetBlockNum();
-  uint64_t totalBlockNum = 0;
+      m_mediator.m_txBlockChain.GetLastBlockPtr()->GetHeader().GetBlockNum();
+  uint64_t totalBlockNum = (hiBlockNum >= loBlockNum)
+                               ? hiBlockNum - loBlockNum + 1
+                               : 0;
   uint64_t fullBlockNum = 0;
 
-  for (uint64_t i = loBlockNum; i <= hiBlockNum; ++i) {
-    uint128_t gasUsed =
-        m_mediator.m_txBlockChain.GetBlock(i).GetHeader().GetGasUsed();
-    uint128_t gasLimit =
-        m_mediator.m_txBlockChain.GetBlock(i).GetHeader().GetGasLimit();
-    if (gasUsed >= gasLimit * GAS_CONGESTION_PERCENT / 100) {
-      fullBlockNum++;
+  // Kept up to date as the blocks are added; only if some of them were not,
+  // e.g. after restoring only part of the chain, walk the blocks instead
+  if (!m_mediator.m_txBlockChain.GetFullBlockCount(loBlockNum, hiBlockNum,
+                                                   fullBlockNum)) {
+    for (uint64_t i = loBlockNum; i <= hiBlockNum; ++i) {
+      if (TxBlockChain::IsFullBlock(
+              m_mediator.m_txBlockChain.GetBlockPtr(i)->GetHeader())) {
+        fullBlockNum++;
+      }
     }
-    totalBlockNum++;
   }
 
   if (fullBlockNum < totalBlockNum * UNFILLED_PERCENT_LOW / 100) {
@@ -48,33 +51,47 @@ uint128_t DirectoryService::GetNewGasPrice() {
   } else if (fullBlockNum > totalBlockNum * UNFILLED_PERCENT_HIGH / 100) {
     return GetIncreasedGasPrice();
   }
-  return max(m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetGasPrice(),
+  return max(m_mediator.m_dsBlockChain.GetLastBlockPtr()
+      ->GetHeader()
+      .GetGasPrice(),
              max(PRECISION_MIN_VALUE, GAS_PRICE_MIN_VALUE));
 }
 
 uint128_t DirectoryService::GetHistoricalMeanGasPrice() {
   uint64_t curDSBlockNum =
-      m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetBlockNum();
+      m_mediator.m_dsBlockChain.GetLastBlockPtr()->GetHeader().GetBlockNum();
   uint64_t lowDSBlockNum = (curDSBlockNum > MEAN_GAS_PRICE_DS_NUM)
                                ? (curDSBlockNum - MEAN_GAS_PRICE_DS_NUM)
                                : 0;
   uint64_t totalBlockNum = 0;
   uint128_t totalGasPrice = 0;
-  for (uint64_t i = curDSBlockNum; i >= lowDSBlockNum; --i) {
-    if (i == 0) {
-      break;
-    }
-    if (!SafeMath<uint128_t>::add(
-            totalGasPrice,
-            m_mediator.m_dsBlockChain.GetBlock(i).GetHeader().GetGasPrice(),
-            totalGasPrice)) {
-      continue;
+  // The genesis block does not count
+  const uint64_t firstDSBlockNum = max<uint64_t>(lowDSBlockNum, 1);
+  if (m_mediator.m_dsBlockChain.GetGasPriceSum(firstDSBlockNum, curDSBlockNum,
+                                               totalGasPrice)) {
+    totalBlockNum = (curDSBlockNum >= firstDSBlockNum)
+                        ? curDSBlockNum - firstDSBlockNum + 1
+                        : 0;
+  } else {
+    for (uint64_t i = curDSBlockNum; i >= lowDSBlockNum; --i) {
+      if (i == 0) {
+        break;
+      }
+      if (!SafeMath<uint128_t>::add(totalGasPrice,
+                                    m_mediator.m_dsBlockChain.GetBlockPtr(i)
+                                        ->GetHeader()
+                                        .GetGasPrice(),
+                                    totalGasPrice)) {
+        continue;
+      }
+      totalBlockNum++;
     }
-    totalBlockNum++;
   }
   uint128_t ret;
   if (!SafeMath<uint128_t>::div(totalGasPrice, totalBlockNum, ret)) {
-    return m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetGasPrice();
+    return m_mediator.m_dsBlockChain.GetLastBlockPtr()
+        ->GetHeader()
+        .GetGasPrice();
   }
   return ret;
 }
@@ -17,6 +17,7 @@
 
 #include <algorithm>
 #include <chrono>
+#include <future>
 #include <thread>
 
 #include "DirectoryService.h"
@@ -36,6 +37,7 @@
 #include "libUtils/Logger.h"
 #include "libUtils/SanityChecks.h"
 #include "libUtils/TimestampVerifier.h"
+#include "libUtils/Tracer.h"
 
 using namespace std;
 using namespace boost::multiprecision;
@@ -52,10 +54,15 @@ bool DirectoryService::VerifyMicroBlockCoSignature(const MicroBlock& microBlock,
   LOG_MARKER();
 
   const vector<bool>& B2 = microBlock.GetB2();
-  vector<PubKey> keys;
-  unsigned int index = 0;
-  unsigned int count = 0;
+  shared_ptr<PubKey> aggregatedKey;
 
+  if (static_cast<unsigned int>(count(B2.begin(), B2.end(), true)) !=
+      ConsensusCommon::NumForConsensus(B2.size())) {
+    LOG_GENERAL(WARNING, "Cosig was not generated by enough nodes");
+    return false;
+  }
+
+  // Generate the aggregated key
   if (shardId == m_shards.size()) {
     if (m_mediator.m_DSCommittee->size() != B2.size()) {
       LOG_GENERAL(WARNING, "Mismatch: Shard(DS) size = "
@@ -64,13 +71,9 @@ bool DirectoryService::VerifyMicroBlockCoSignature(const MicroBlock& microBlock,
       return false;
     }
 
-    for (const auto& ds : *m_mediator.m_DSCommittee) {
-      if (B2.at(index)) {
-        keys.emplace_back(ds.first);
-        count++;
-      }
-      index++;
-    }
+    aggregatedKey = m_mediator.m_DSCommitteeKeyCache.Aggregate(
+        *m_mediator.m_DSCommittee,
+        [](const PairOfNode& ds) -> const PubKey& { return ds.first; }, B2);
   } else {
     const auto& shard = m_shards.at(shardId);
 
@@ -81,22 +84,21 @@ bool DirectoryService::VerifyMicroBlockCoSignature(const MicroBlock& microBlock,
       return false;
     }
 
-    // Generate the aggregated key
-    for (const auto& kv : shard) {
-      if (B2.at(index)) {
-        keys.emplace_back(std::get<SHARD_NODE_PUBKEY>(kv));
-        count++;
-      }
-      index++;
+    // Map entries are stable, so the cache is used outside the map lock
+    CommitteeKeyCache* shardKeyCache = nullptr;
+    {
+      lock_guard<mutex> g(m_mutexShardKeyCaches);
+      shardKeyCache = &m_shardKeyCaches[shardId];
     }
-  }
 
-  if (count != ConsensusCommon::NumForConsensus(B2.size())) {
-    LOG_GENERAL(WARNING, "Cosig was not generated by enough nodes");
-    return false;
+    aggregatedKey = shardKeyCache->Aggregate(
+        shard,
+        [](const Shard::value_type& kv) -> const PubKey& {
+          return std::get<SHARD_NODE_PUBKEY>(kv);
+        },
+        B2);
   }
 
-  shared_ptr<PubKey> aggregatedKey = MultiSig::AggregatePubKeys(keys);
   if (aggregatedKey == nullptr) {
     LOG_GENERAL(WARNING, "Aggregated key generation failed");
     return false;
@@ -112,9 +114,21 @@ bool DirectoryService::VerifyMicroBlockCoSignature(const MicroBlock& microBlock,
   BitVector::SetBitVector(message, message.size(), microBlock.GetB1());
   if (!MultiSig::GetInstance().MultiSigVerify(
           message, 0, message.size(), microBlock.GetCS2(), *aggregatedKey)) {
-    LOG_GENERAL(WARNING, "Cosig verification failed");
-    for (auto& kv : keys) {
-      LOG_GENERAL(WARNING, kv);
+    LOG_GENERAL(WARNING, "Cosig verification failed. Shard " << shardId
+                                                             << " signers:");
+    unsigned int index = 0;
+    if (shardId == m_shards.size()) {
+      for (const auto& ds : *m_mediator.m_DSCommittee) {
+        if (B2.at(index++)) {
+          LOG_GENERAL(WARNING, ds.first);
+        }
+      }
+    } else {
+      for (const auto& kv : m_shards.at(shardId)) {
+        if (B2.at(index++)) {
+          LOG_GENERAL(WARNING, std::get<SHARD_NODE_PUBKEY>(kv));
+        }
+      }
     }
     return false;
   }
@@ -122,17 +136,10 @@ bool DirectoryService::VerifyMicroBlockCoSignature(const MicroBlock& microBlock,
   return true;
 }
 
-bool DirectoryService::ProcessStateDelta(
+bool DirectoryService::CheckStateDelta(
     const bytes& stateDelta, const StateHash& microBlockStateDeltaHash,
-    const BlockHash& microBlockHash) {
-  LOG_MARKER();
-
-  if (LOOKUP_NODE_MODE) {
-    LOG_GENERAL(WARNING,
-                "DirectoryService::ProcessStateDelta not expected to be "
-                "called from LookUp node.");
-    return true;
-  }
+    bool& hasDelta) {
+  hasDelta = false;
 
   string statedeltaStr;
   if (!DataConversion::charArrToHexStr(microBlockStateDeltaHash.asArray(),
@@ -168,25 +175,51 @@ bool DirectoryService::ProcessStateDelta(
     return false;
   }
 
-  if (microBlockStateDeltaHash == StateHash()) {
-    LOG_GENERAL(INFO, "State Delta from microblock is empty");
+  hasDelta = true;
+  return true;
+}
+
+bool DirectoryService::SerializeStateDeltaFromShards() {
+  m_stateDeltaFromShards.clear();
+
+  if (!AccountStore::GetInstance().SerializeDelta()) {
+    LOG_GENERAL(WARNING, "AccountStore::SerializeDelta failed.");
+    return false;
+  }
+
+  AccountStore::GetInstance().GetSerializedDelta(m_stateDeltaFromShards);
+  return true;
+}
+
+bool DirectoryService::ProcessStateDelta(
+    const bytes& stateDelta, const StateHash& microBlockStateDeltaHash,
+    const BlockHash& microBlockHash) {
+  LOG_MARKER();
+
+  if (LOOKUP_NODE_MODE) {
+    LOG_GENERAL(WARNING,
+                "DirectoryService::ProcessStateDelta not expected to be "
+                "called from LookUp node.");
+    return true;
+  }
+
+  bool hasDelta = false;
+  if (!CheckStateDelta(stateDelta, microBlockStateDeltaHash, hasDelta)) {
     return false;
   }
+  if (!hasDelta) {
+    return true;
+  }
 
   if (!AccountStore::GetInstance().DeserializeDeltaTemp(stateDelta, 0)) {
     LOG_GENERAL(WARNING, "AccountStore::DeserializeDeltaTemp failed.");
     return false;
   }
 
-  m_stateDeltaFromShards.clear();
-
-  if (!AccountStore::GetInstance().SerializeDelta()) {
-    LOG_GENERAL(WARNING, "AccountStore::SerializeDelta failed.");
+  if (!SerializeStateDeltaFromShards()) {
     return false;
   }
 
-  AccountStore::GetInstance().GetSerializedDelta(m_stateDeltaFromShards);
-
   m_microBlockStateDeltas[m_mediator.m_currentEpochNum].emplace(microBlockHash,
                                                                 stateDelta);
 
@@ -195,6 +228,8 @@ bool DirectoryService::ProcessStateDelta(
 
 bool DirectoryService::ProcessMicroblockSubmissionFromShardCore(
     const MicroBlock& microBlock, const bytes& stateDelta) {
+  TRACE_SPAN("DirectoryService::ProcessMicroblockSubmissionFromShardCore");
+
   if (LOOKUP_NODE_MODE) {
     LOG_GENERAL(WARNING,
                 "DirectoryService::ProcessMicroblockSubmissionCore not "
@@ -202,6 +237,16 @@ bool DirectoryService::ProcessMicroblockSubmissionFromShardCore(
     return true;
   }
 
+  if (!CheckMicroBlockSubmission(microBlock)) {
+    return false;
+  }
+
+  return StoreMicroBlockSubmissions({{&microBlock, &stateDelta}});
+}
+
+bool DirectoryService::CheckMicroBlockSubmission(const MicroBlock& microBlock) {
+  TRACE_SPAN("DirectoryService::CheckMicroBlockSubmission");
+
   // Verify the Block Hash
   BlockHash temp_blockHash = microBlock.GetHeader().GetMyHash();
   if (temp_blockHash != microBlock.GetBlockHash()) {
@@ -275,10 +320,12 @@ bool DirectoryService::ProcessMicroblockSubmissionFromShardCore(
     return false;
   }
 
-  LOG_GENERAL(INFO, "MicroBlock StateDeltaHash: "
-                        << microBlock.GetHeader().GetHashes());
+  return true;
+}
 
-  lock_guard<mutex> g(m_mutexMicroBlocks);
+bool DirectoryService::StoreMicroBlockSubmissions(
+    const vector<pair<const MicroBlock*, const bytes*>>& submissions) {
+  lock_guard<ProfiledMutex> g(m_mutexMicroBlocks);
 
   if (m_stopRecvNewMBSubmission) {
     LOG_GENERAL(WARNING,
@@ -288,39 +335,106 @@ bool DirectoryService::ProcessMicroblockSubmissionFromShardCore(
   }
 
   auto& microBlocksAtEpoch = m_microBlocks[m_mediator.m_currentEpochNum];
+  const bool processDeltas = !m_mediator.GetIsVacuousEpoch();
+
+  vector<const MicroBlock*> accepted;
+  vector<const bytes*> deltas;
+  vector<size_t> deltaOwners;
+
+  for (const auto& submission : submissions) {
+    const MicroBlock& microBlock = *submission.first;
+    const uint32_t shardId = microBlock.GetHeader().GetShardId();
+
+    LOG_GENERAL(INFO, "MicroBlock StateDeltaHash: "
+                          << microBlock.GetHeader().GetHashes());
+
+    // Check if we already received a validated microblock with the same shard
+    // id
+    auto sameShard = [shardId](const MicroBlock& mb) -> bool {
+      return mb.GetHeader().GetShardId() == shardId;
+    };
+    if (any_of(microBlocksAtEpoch.begin(), microBlocksAtEpoch.end(),
+               sameShard) ||
+        any_of(accepted.begin(), accepted.end(),
+               [&sameShard](const MicroBlock* mb) { return sameShard(*mb); })) {
+      LOG_GENERAL(WARNING,
+                  "Duplicate microblock received for shard " << shardId);
+      continue;
+    }
 
-  // Check if we already received a validated microblock with the same shard id
-  if (find_if(microBlocksAtEpoch.begin(), microBlocksAtEpoch.end(),
-              [shardId](const MicroBlock& mb) -> bool {
-                return mb.GetHeader().GetShardId() == shardId;
-              }) != microBlocksAtEpoch.end()) {
-    LOG_GENERAL(WARNING, "Duplicate microblock received for shard " << shardId);
-    return false;
-  }
+    if (!SaveCoinbase(microBlock.GetB1(), microBlock.GetB2(),
+                      microBlock.GetHeader().GetShardId(),
+                      m_mediator.m_currentEpochNum)) {
+      continue;
+    }
 
-  if (!SaveCoinbase(microBlock.GetB1(), microBlock.GetB2(),
-                    microBlock.GetHeader().GetShardId(),
-                    m_mediator.m_currentEpochNum)) {
-    return false;
-  }
+    bytes body;
+    microBlock.Serialize(body, 0);
+    if (!BlockStorage::GetBlockStorage().PutMicroBlock(
+            microBlock.GetBlockHash(), microBlock.GetHeader().GetEpochNum(),
+            microBlock.GetHeader().GetShardId(), body)) {
+      LOG_GENERAL(WARNING, "Failed to put microblock in persistence");
+    }
 
-  bytes body;
-  microBlock.Serialize(body, 0);
-  if (!BlockStorage::GetBlockStorage().PutMicroBlock(microBlock.GetBlockHash(),
-                                                     body)) {
-    LOG_GENERAL(WARNING, "Failed to put microblock in persistence");
+    if (processDeltas) {
+      bool hasDelta = false;
+      if (!CheckStateDelta(*submission.second,
+                           microBlock.GetHeader().GetStateDeltaHash(),
+                           hasDelta)) {
+        LOG_GENERAL(WARNING,
+                    "State delta attached to the microblock is invalid");
+        continue;
+      }
+      if (hasDelta) {
+        deltaOwners.emplace_back(accepted.size());
+        deltas.emplace_back(submission.second);
+      }
+    }
+
+    accepted.emplace_back(&microBlock);
   }
 
-  if (!m_mediator.GetIsVacuousEpoch()) {
-    if (!ProcessStateDelta(stateDelta,
-                           microBlock.GetHeader().GetStateDeltaHash(),
-                           microBlock.GetBlockHash())) {
-      LOG_GENERAL(WARNING, "State delta attached to the microblock is invalid");
+  // The deltas of all the submissions are merged in one pass
+  vector<bool> stored(accepted.size(), true);
+  if (!deltas.empty()) {
+    vector<bool> applied;
+    if (deltas.size() == 1) {
+      applied.assign(
+          1, AccountStore::GetInstance().DeserializeDeltaTemp(*deltas[0], 0));
+    } else {
+      AccountStore::GetInstance().DeserializeDeltasTemp(deltas, applied);
+    }
+
+    bool anyApplied = false;
+    for (size_t i = 0; i < deltas.size(); i++) {
+      if (!applied[i]) {
+        LOG_GENERAL(WARNING, "AccountStore::DeserializeDeltaTemp failed.");
+        LOG_GENERAL(WARNING,
+                    "State delta attached to the microblock is invalid");
+        stored[deltaOwners[i]] = false;
+        continue;
+      }
+      anyApplied = true;
+      m_microBlockStateDeltas[m_mediator.m_currentEpochNum].emplace(
+          accepted[deltaOwners[i]]->GetBlockHash(), *deltas[i]);
+    }
+
+    if (anyApplied && !SerializeStateDeltaFromShards()) {
       return false;
     }
   }
 
-  microBlocksAtEpoch.emplace(microBlock);
+  size_t numStored = 0;
+  for (size_t i = 0; i < accepted.size(); i++) {
+    if (stored[i]) {
+      microBlocksAtEpoch.emplace(*accepted[i]);
+      numStored++;
+    }
+  }
+
+  if (numStored == 0) {
+    return false;
+  }
 
   LOG_EPOCH(INFO, m_mediator.m_currentEpochNum,
             microBlocksAtEpoch.size()
@@ -349,7 +463,7 @@ bool DirectoryService::ProcessMicroblockSubmissionFromShardCore(
                          << "] FRST RECVD");
   }
 
-  return true;
+  return numStored == submissions.size();
 }
 
 void DirectoryService::CommitMBSubmissionMsgBuffer() {
@@ -362,9 +476,38 @@ void DirectoryService::CommitMBSubmissionMsgBuffer() {
     if (it->first < m_mediator.m_currentEpochNum) {
       it = m_MBSubmissionBuffer.erase(it);
     } else if (it->first == m_mediator.m_currentEpochNum) {
-      for (const auto& entry : it->second) {
-        ProcessMicroblockSubmissionFromShardCore(entry.m_microBlock,
-                                                 entry.m_stateDelta);
+      const auto& entries = it->second;
+      vector<unsigned char> valid(entries.size(), 0);
+
+      // Check the buffered microblocks of all shards in parallel, then store
+      // the valid ones together, merging their state deltas in one pass
+      const unsigned int numThreads = min<size_t>(
+          entries.size(), max(thread::hardware_concurrency(), 1u));
+      vector<future<void>> checks;
+      for (unsigned int t = 1; t < numThreads; t++) {
+        checks.emplace_back(
+            async(launch::async, [this, &entries, &valid, t, numThreads]() {
+              for (size_t i = t; i < entries.size(); i += numThreads) {
+                valid[i] = CheckMicroBlockSubmission(entries[i].m_microBlock);
+              }
+            }));
+      }
+      for (size_t i = 0; i < entries.size(); i += max(numThreads, 1u)) {
+        valid[i] = CheckMicroBlockSubmission(entries[i].m_microBlock);
+      }
+      for (auto& check : checks) {
+        check.get();
+      }
+
+      vector<pair<const MicroBlock*, const bytes*>> submissions;
+      for (size_t i = 0; i < entries.size(); i++) {
+        if (valid[i]) {
+          submissions.emplace_back(&entries[i].m_microBlock,
+                                   &entries[i].m_stateDelta);
+        }
+      }
+      if (!submissions.empty()) {
+        StoreMicroBlockSubmissions(submissions);
       }
       m_MBSubmissionBuffer.erase(it);
       break;
@@ -510,7 +653,7 @@ bool DirectoryService::ProcessMissingMicroblockSubmission(
   }
 
   {
-    lock_guard<mutex> g(m_mutexMicroBlocks);
+    lock_guard<ProfiledMutex> g(m_mutexMicroBlocks);
     auto& microBlocksAtEpoch = m_microBlocks[epochNumber];
 
     if (microBlocks.size() != stateDeltas.size()) {
@@ -637,7 +780,9 @@ bool DirectoryService::ProcessMissingMicroblockSubmission(
       bytes body;
       microBlocks[i].Serialize(body, 0);
       if (!BlockStorage::GetBlockStorage().PutMicroBlock(
-              microBlocks[i].GetBlockHash(), body)) {
+              microBlocks[i].GetBlockHash(),
+              microBlocks[i].GetHeader().GetEpochNum(),
+              microBlocks[i].GetHeader().GetShardId(), body)) {
         LOG_GENERAL(WARNING, "Failed to put microblock in persistence");
       }
 
@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "MicroBlockSet.h"
+#include "libUtils/SafeMath.h"
+
+using namespace std;
+using namespace boost::multiprecision;
+
+void MicroBlockSet::AddToTotals(const MicroBlock& microBlock, Totals& totals) {
+  const auto& header = microBlock.GetHeader();
+
+  // SafeMath only detects the overflow when the result is not an operand
+  Totals sums;
+  if (SafeMath<uint64_t>::add(totals.m_gasLimit, header.GetGasLimit(),
+                              sums.m_gasLimit) &&
+      SafeMath<uint64_t>::add(totals.m_gasUsed, header.GetGasUsed(),
+                              sums.m_gasUsed) &&
+      SafeMath<uint128_t>::add(totals.m_rewards, header.GetRewards(),
+                               sums.m_rewards)) {
+    totals.m_gasLimit = sums.m_gasLimit;
+    totals.m_gasUsed = sums.m_gasUsed;
+    totals.m_rewards = sums.m_rewards;
+  }
+  totals.m_numTxns += header.GetNumTxs();
+}
+
+pair<MicroBlockSet::const_iterator, bool> MicroBlockSet::emplace(
+    const MicroBlock& microBlock) {
+  auto result = m_microBlocks.emplace(microBlock);
+  if (result.second) {
+    m_byHash[microBlock.GetBlockHash()] = result.first;
+    AddToTotals(microBlock, m_totals);
+  }
+  return result;
+}
+
+MicroBlockSet::const_iterator MicroBlockSet::erase(const_iterator it) {
+  auto indexed = m_byHash.find(it->GetBlockHash());
+  if (indexed != m_byHash.end() && indexed->second == it) {
+    m_byHash.erase(indexed);
+  }
+  auto next = m_microBlocks.erase(it);
+
+  // Only done on view changes, so the sums are just rebuilt
+  m_totals = Totals();
+  for (const auto& microBlock : m_microBlocks) {
+    AddToTotals(microBlock, m_totals);
+  }
+
+  return next;
+}
+
+void MicroBlockSet::clear() {
+  m_microBlocks.clear();
+  m_byHash.clear();
+  m_totals = Totals();
+}
+
+const MicroBlock* MicroBlockSet::Find(const BlockHash& hash) const {
+  auto it = m_byHash.find(hash);
+  return (it != m_byHash.end()) ? &*it->second : nullptr;
+}
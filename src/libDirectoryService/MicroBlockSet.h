@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __MICROBLOCKSET_H__
+#define __MICROBLOCKSET_H__
+
+#include <boost/multiprecision/cpp_int.hpp>
+#include <set>
+#include <unordered_map>
+#include <utility>
+
+#include "libData/BlockData/Block.h"
+
+/// The microblocks a DS node holds for one epoch, indexed as they arrive.
+///
+/// A final block lists its microblocks by hash and carries the sums of
+/// their gas, rewards and txn counts. The set keeps a hash index and those
+/// sums up to date on every insert, so a DS backup checks the proposal by
+/// lookups instead of scanning the microblocks once per check. It iterates
+/// like the std::set<MicroBlock> it wraps.
+class MicroBlockSet {
+ public:
+  using const_iterator = std::set<MicroBlock>::const_iterator;
+  using iterator = const_iterator;
+
+  struct Totals {
+    uint64_t m_gasLimit = 0;
+    uint64_t m_gasUsed = 0;
+    boost::multiprecision::uint128_t m_rewards = 0;
+    uint32_t m_numTxns = 0;
+  };
+
+ private:
+  std::set<MicroBlock> m_microBlocks;
+  std::unordered_map<BlockHash, const_iterator> m_byHash;
+  Totals m_totals;
+
+  /// A microblock whose gas or rewards would overflow the sums is left out
+  /// of all three, and only its txns are counted
+  static void AddToTotals(const MicroBlock& microBlock, Totals& totals);
+
+ public:
+  std::pair<const_iterator, bool> emplace(const MicroBlock& microBlock);
+  const_iterator erase(const_iterator it);
+  void clear();
+
+  const_iterator begin() const { return m_microBlocks.begin(); }
+  const_iterator end() const { return m_microBlocks.end(); }
+  size_t size() const { return m_microBlocks.size(); }
+  bool empty() const { return m_microBlocks.empty(); }
+
+  /// Returns the microblock with the hash, or nullptr if there is none
+  const MicroBlock* Find(const BlockHash& hash) const;
+
+  /// Sums over all the microblocks held
+  const Totals& GetTotals() const { return m_totals; }
+};
+
+#endif  // __MICROBLOCKSET_H__
@@ -0,0 +1,178 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+
+#include "PoWOrdering.h"
+#include "common/Constants.h"
+#include "libUtils/HashUtils.h"
+#include "libUtils/Logger.h"
+
+using namespace std;
+
+namespace PoWOrdering {
+
+VectorOfPoWSoln SortByResult(const MapOfPubKeyPoW& pows) {
+  // Sort pointers so no key is copied until the final order is known
+  vector<pair<const PoWHash*, const PubKey*>> order;
+  order.reserve(pows.size());
+  for (const auto& powsoln : pows) {
+    order.emplace_back(&powsoln.second.result, &powsoln.first);
+  }
+
+  // Stable, so of equal results the greatest key (last in the map) is last
+  stable_sort(order.begin(), order.end(),
+              [](const pair<const PoWHash*, const PubKey*>& a,
+                 const pair<const PoWHash*, const PubKey*>& b) {
+                return *a.first < *b.first;
+              });
+
+  VectorOfPoWSoln sortedPoWSolns;
+  sortedPoWSolns.reserve(order.size());
+  for (size_t i = 0; i < order.size(); i++) {
+    if (i + 1 < order.size() && *order[i].first == *order[i + 1].first) {
+      continue;
+    }
+    sortedPoWSolns.emplace_back(*order[i].first, *order[i].second);
+  }
+
+  return sortedPoWSolns;
+}
+
+VectorOfPoWSoln Trim(const VectorOfPoWSoln& sorted, uint32_t numNodes) {
+  const auto end = sorted.begin() + min<size_t>(numNodes, sorted.size());
+  return VectorOfPoWSoln(sorted.begin(), end);
+}
+
+VectorOfPoWSoln TrimWithGuards(
+    const VectorOfPoWSoln& sorted, uint32_t numNodes, uint32_t guardCount,
+    const function<bool(const PubKey&)>& isShardGuard) {
+  vector<bool> picked(sorted.size(), false);
+  uint32_t count = 0;
+
+  // Shard guards first, in order
+  for (size_t i = 0; (i < sorted.size()) && (count < numNodes); i++) {
+    if (isShardGuard(sorted[i].second)) {
+      if (count == guardCount) {
+        LOG_GENERAL(INFO,
+                    "Did not manage to form max number of shard. Only allowed "
+                        << guardCount << " shard guards");
+        break;
+      }
+      picked[i] = true;
+      count++;
+    }
+  }
+
+  // Then any solution not picked yet, if there are slots left
+  for (size_t i = 0; (i < sorted.size()) && (count < numNodes); i++) {
+    if (!picked[i]) {
+      picked[i] = true;
+      count++;
+    }
+  }
+
+  VectorOfPoWSoln trimmed;
+  trimmed.reserve(count);
+  for (size_t i = 0; i < sorted.size(); i++) {
+    if (picked[i]) {
+      trimmed.emplace_back(sorted[i]);
+    }
+  }
+
+  return trimmed;
+}
+
+ShardingHasher::ShardingHasher(const bytes& lastBlockHash)
+    : m_hashVec(lastBlockHash) {
+  m_hashVec.resize(lastBlockHash.size() + POW_SIZE);
+}
+
+PoWHash ShardingHasher::operator()(const PoWHash& result) {
+  copy(result.begin(), result.end(), m_hashVec.end() - POW_SIZE);
+  const bytes& sortHashVec = HashUtils::BytesToHash(m_hashVec);
+
+  PoWHash sortHash;
+  copy(sortHashVec.begin(), sortHashVec.end(), sortHash.begin());
+  return sortHash;
+}
+
+vector<uint32_t> ShardingOrder(const VectorOfPoWSoln& sorted,
+                               const bytes& lastBlockHash) {
+  ShardingHasher hasher(lastBlockHash);
+
+  vector<pair<PoWHash, uint32_t>> hashes;
+  hashes.reserve(sorted.size());
+  for (uint32_t i = 0; i < sorted.size(); i++) {
+    hashes.emplace_back(hasher(sorted[i].first), i);
+  }
+
+  // Ties are broken by index, so unique keeps the first of equal hashes
+  sort(hashes.begin(), hashes.end());
+
+  vector<uint32_t> order;
+  order.reserve(hashes.size());
+  for (size_t i = 0; i < hashes.size(); i++) {
+    if (i > 0 && hashes[i].first == hashes[i - 1].first) {
+      continue;
+    }
+    order.emplace_back(hashes[i].second);
+  }
+
+  return order;
+}
+
+vector<DSPowSolution> CompactPacket(
+    const vector<DSPowSolution>& sols,
+    const function<bool(const DSPowSolution&)>& isKnown) {
+  vector<const DSPowSolution*> order;
+  order.reserve(sols.size());
+  for (const auto& sol : sols) {
+    order.emplace_back(&sol);
+  }
+
+  auto sameGroup = [](const DSPowSolution* a, const DSPowSolution* b) {
+    return a->GetSubmitterKey() == b->GetSubmitterKey() &&
+           a->GetDifficultyLevel() == b->GetDifficultyLevel();
+  };
+
+  // Within a group, the lowest result is first
+  sort(order.begin(), order.end(),
+       [](const DSPowSolution* a, const DSPowSolution* b) {
+         if (!(a->GetSubmitterKey() == b->GetSubmitterKey())) {
+           return a->GetSubmitterKey() < b->GetSubmitterKey();
+         }
+         if (a->GetDifficultyLevel() != b->GetDifficultyLevel()) {
+           return a->GetDifficultyLevel() < b->GetDifficultyLevel();
+         }
+         return a->GetResultingHash() < b->GetResultingHash();
+       });
+
+  vector<DSPowSolution> compact;
+  for (size_t i = 0; i < order.size(); i++) {
+    if (i > 0 && sameGroup(order[i - 1], order[i])) {
+      continue;
+    }
+    if (!isKnown(*order[i])) {
+      compact.emplace_back(*order[i]);
+    }
+  }
+
+  return compact;
+}
+
+}  // namespace PoWOrdering
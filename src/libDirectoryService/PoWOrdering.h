@@ -0,0 +1,71 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __POWORDERING_H__
+#define __POWORDERING_H__
+
+#include <array>
+#include <functional>
+#include <vector>
+
+#include "DirectoryService.h"
+#include "common/BaseType.h"
+
+/// Orderings of the PoW submissions shared by the DS leader composing the
+/// sharding structure and the backups verifying it. Everything works on
+/// contiguous vectors that are sorted once; no per-node tree is built.
+namespace PoWOrdering {
+
+using PoWHash = std::array<unsigned char, 32>;
+
+/// Returns the solutions sorted by result. Of solutions with the same result
+/// only the one of the greatest public key is kept.
+VectorOfPoWSoln SortByResult(const MapOfPubKeyPoW& pows);
+
+/// Returns the first numNodes of the sorted solutions.
+VectorOfPoWSoln Trim(const VectorOfPoWSoln& sorted, uint32_t numNodes);
+
+/// Returns numNodes of the sorted solutions, still sorted: the first
+/// guardCount shard guards, then the best of the rest.
+VectorOfPoWSoln TrimWithGuards(
+    const VectorOfPoWSoln& sorted, uint32_t numNodes, uint32_t guardCount,
+    const std::function<bool(const PubKey&)>& isShardGuard);
+
+/// Computes the sharding order hash H(lastBlockHash, result).
+class ShardingHasher {
+  bytes m_hashVec;
+
+ public:
+  explicit ShardingHasher(const bytes& lastBlockHash);
+  PoWHash operator()(const PoWHash& result);
+};
+
+/// Returns the indexes of the sorted solutions in sharding order. Of
+/// solutions with the same sharding hash only the first is kept.
+std::vector<uint32_t> ShardingOrder(const VectorOfPoWSoln& sorted,
+                                    const bytes& lastBlockHash);
+
+/// Returns the solutions worth forwarding in a PoW packet, sorted by
+/// submitter key: the hardest one per key and difficulty, unless isKnown
+/// says the committee already has it.
+std::vector<DSPowSolution> CompactPacket(
+    const std::vector<DSPowSolution>& sols,
+    const std::function<bool(const DSPowSolution&)>& isKnown);
+
+}  // namespace PoWOrdering
+
+#endif  // __POWORDERING_H__
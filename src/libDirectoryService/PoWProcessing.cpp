@@ -16,10 +16,12 @@
  */
 
 #include <algorithm>
+#include <boost/algorithm/string/predicate.hpp>
 #include <chrono>
 #include <thread>
 
 #include "DirectoryService.h"
+#include "PoWOrdering.h"
 #include "common/Constants.h"
 #include "common/Messages.h"
 #include "common/Serializable.h"
@@ -46,15 +48,43 @@ bool DirectoryService::ProcessAndSendPoWPacketSubmissionToOtherDSComm() {
   bytes powpacketmessage = {MessageType::DIRECTORY,
                             DSInstructionType::POWPACKETSUBMISSION};
 
-  std::unique_lock<std::mutex> lk(m_mutexPowSolution);
+  vector<DSPowSolution> received;
+  {
+    std::unique_lock<std::mutex> lk(m_mutexPowSolution);
+    received = m_powSolutions;
+  }
 
-  if (m_powSolutions.empty()) {
+  if (received.empty()) {
     LOG_GENERAL(INFO, "Didn't receive any pow submissions!!")
     return true;
   }
 
+  // Solutions already accepted came in another sender's packet, and only
+  // the hardest solution of a submitter can replace what it has in m_allPoWs
+  vector<DSPowSolution> powSolutions;
+  {
+    lock_guard<mutex> g(m_mutexAllPOW);
+    powSolutions = PoWOrdering::CompactPacket(
+        received, [this](const DSPowSolution& sol) {
+          auto it = m_allPoWs.find(sol.GetSubmitterKey());
+          if (it == m_allPoWs.end()) {
+            return false;
+          }
+          string result;
+          DataConversion::charArrToHexStr(it->second.result, result);
+          return boost::iequals(result, sol.GetResultingHash());
+        });
+  }
+
+  LOG_GENERAL(INFO, "PoW solutions to forward: " << powSolutions.size()
+                                                 << " of " << received.size());
+
+  if (powSolutions.empty()) {
+    return true;
+  }
+
   if (!Messenger::SetDSPoWPacketSubmission(powpacketmessage,
-                                           MessageOffset::BODY, m_powSolutions,
+                                           MessageOffset::BODY, powSolutions,
                                            m_mediator.m_selfKey)) {
     LOG_EPOCH(WARNING, m_mediator.m_currentEpochNum,
               "Messenger::SetDSPoWPacketSubmission failed.");
@@ -80,9 +110,7 @@ bool DirectoryService::ProcessAndSendPoWPacketSubmissionToOtherDSComm() {
     P2PComm::GetInstance().SendMessage(peerList, powpacketmessage);
   }
 
-  for (auto& sol : m_powSolutions) {
-    ProcessPoWSubmissionFromPacket(sol);
-  }
+  ProcessPoWSubmissionsFromPacket(powSolutions);
 
   return true;
 }
@@ -119,13 +147,57 @@ bool DirectoryService::ProcessPoWPacketSubmission(
   }
 
   LOG_GENERAL(INFO, "PoW solutions received in this packet: " << tmp.size());
-  for (auto& sol : tmp) {
-    ProcessPoWSubmissionFromPacket(sol);
-  }
+  ProcessPoWSubmissionsFromPacket(tmp);
 
   return true;
 }
 
+void DirectoryService::ProcessPoWSubmissionsFromPacket(
+    const vector<DSPowSolution>& sols) {
+  // Past the threshold, the cost of filling dataset items is shared by
+  // enough solutions to beat recomputing each item from the light cache
+  const bool fullDataset = POW_BATCH_VERIFY_THRESHOLD > 0 &&
+                           sols.size() >= POW_BATCH_VERIFY_THRESHOLD;
+
+  if (!m_powVerifyPool || sols.size() < 2) {
+    for (const auto& sol : sols) {
+      ProcessPoWSubmissionFromPacket(sol, fullDataset);
+    }
+    return;
+  }
+
+  // The calling thread takes every (POW_VERIFY_THREADS + 1)-th solution
+  const size_t stride = POW_VERIFY_THREADS + 1;
+  auto processFrom = [this, &sols, stride, fullDataset](size_t first) {
+    for (size_t i = first; i < sols.size(); i += stride) {
+      ProcessPoWSubmissionFromPacket(sols[i], fullDataset);
+    }
+  };
+
+  mutex mutexDone;
+  condition_variable cvDone;
+  size_t jobsLeft = 0;
+
+  vector<ThreadPool::Job> jobs;
+  for (size_t first = 1; first < stride && first < sols.size(); first++) {
+    jobs.emplace_back([&processFrom, &mutexDone, &cvDone, &jobsLeft, first]() {
+      processFrom(first);
+      lock_guard<mutex> g(mutexDone);
+      if (--jobsLeft == 0) {
+        cvDone.notify_one();
+      }
+    });
+  }
+
+  jobsLeft = jobs.size();
+  m_powVerifyPool->AddJobs(jobs.begin(), jobs.end());
+
+  processFrom(0);
+
+  unique_lock<mutex> lock(mutexDone);
+  cvDone.wait(lock, [&jobsLeft] { return jobsLeft == 0; });
+}
+
 bool DirectoryService::ProcessPoWSubmission(const bytes& message,
                                             unsigned int offset,
                                             [[gnu::unused]] const Peer& from) {
@@ -188,8 +260,8 @@ bool DirectoryService::ProcessPoWSubmission(const bytes& message,
   return true;
 }
 
-bool DirectoryService::ProcessPoWSubmissionFromPacket(
-    const DSPowSolution& sol) {
+bool DirectoryService::ProcessPoWSubmissionFromPacket(const DSPowSolution& sol,
+                                                      bool fullDataset) {
   LOG_MARKER();
 
   if (LOOKUP_NODE_MODE) {
@@ -260,6 +332,22 @@ bool DirectoryService::ProcessPoWSubmissionFromPacket(
     return false;
   }
 
+  array<uint8_t, 32> resultingHashArr, mixHashArr;
+  DataConversion::HexStrToStdArray(resultingHash, resultingHashArr);
+  DataConversion::HexStrToStdArray(mixHash, mixHashArr);
+
+  // Packets from several DS members carry the same solutions, so the ones
+  // already accepted are dropped before their hash is verified
+  {
+    lock_guard<mutex> g(m_mutexAllPOW);
+    auto it = m_allPoWs.find(submitterPubKey);
+    if (it != m_allPoWs.end() && it->second.result == resultingHashArr) {
+      LOG_GENERAL(INFO, "PoW submission of " << submitterPeer
+                                             << " already verified");
+      return true;
+    }
+  }
+
   // Log all values
   LOG_EPOCH(INFO, m_mediator.m_currentEpochNum,
             "Winner Public_key   = " << submitterPubKey);
@@ -282,9 +370,13 @@ bool DirectoryService::ProcessPoWSubmissionFromPacket(
   // Non-genesis block
   if (blockNumber > 1) {
     expectedDSDiff =
-        m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetDSDifficulty();
+        m_mediator.m_dsBlockChain.GetLastBlockPtr()
+            ->GetHeader()
+            .GetDSDifficulty();
     expectedDiff =
-        m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetDifficulty();
+        m_mediator.m_dsBlockChain.GetLastBlockPtr()
+            ->GetHeader()
+            .GetDifficulty();
   }
 
   if (!GUARD_MODE) {
@@ -309,15 +401,16 @@ bool DirectoryService::ProcessPoWSubmissionFromPacket(
     }
   }
 
-  m_timespec = r_timer_start();
+  auto timespec = r_timer_start();
 
   auto headerHash = POW::GenHeaderHash(rand1, rand2, submitterPeer.m_ipAddress,
                                        submitterPubKey, lookupId, gasPrice);
-  bool result = POW::GetInstance().PoWVerify(
-      blockNumber, difficultyLevel, headerHash, nonce, resultingHash, mixHash);
+  bool result =
+      POW::GetInstance().PoWVerify(blockNumber, difficultyLevel, headerHash,
+                                   nonce, resultingHash, mixHash, fullDataset);
 
   LOG_EPOCH(INFO, m_mediator.m_currentEpochNum,
-            "[POWSTAT] pow verify (microsec): " << r_timer_end(m_timespec));
+            "[POWSTAT] pow verify (microsec): " << r_timer_end(timespec));
 
   if (result) {
     // Do another check on the state before accessing m_allPoWs
@@ -333,9 +426,6 @@ bool DirectoryService::ProcessPoWSubmissionFromPacket(
       lock_guard<mutex> g(m_mutexAllPOW, adopt_lock);
       lock_guard<mutex> g2(m_mutexAllPoWConns, adopt_lock);
 
-      array<uint8_t, 32> resultingHashArr, mixHashArr;
-      DataConversion::HexStrToStdArray(resultingHash, resultingHashArr);
-      DataConversion::HexStrToStdArray(mixHash, mixHashArr);
       PoWSolution soln(nonce, resultingHashArr, mixHashArr, lookupId, gasPrice);
 
       m_allPoWConns.emplace(submitterPubKey, submitterPeer);
@@ -360,8 +450,8 @@ bool DirectoryService::ProcessPoWSubmissionFromPacket(
 
       uint8_t expectedDSDiff = DS_POW_DIFFICULTY;
       if (blockNumber > 1) {
-        expectedDSDiff = m_mediator.m_dsBlockChain.GetLastBlock()
-                             .GetHeader()
+        expectedDSDiff = m_mediator.m_dsBlockChain.GetLastBlockPtr()
+                             ->GetHeader()
                              .GetDSDifficulty();
       }
 
@@ -223,11 +223,13 @@ void DirectoryService::ProcessViewChangeConsensusWhenDone() {
     for (auto& i : *m_mediator.m_DSCommittee) {
       LOG_GENERAL(INFO, i.second);
     }
+    m_mediator.PublishDSCommittee();
 
     // Consensus update for DS shard
     {
       lock_guard<mutex> g(m_mediator.m_node->m_mutexShardMember);
       m_mediator.m_node->m_myShardMembers = m_mediator.m_DSCommittee;
+      m_mediator.m_node->InvalidateBroadcastLists();
     }
     m_mediator.m_node->SetConsensusMyID(m_consensusMyID.load());
     m_mediator.m_node->SetConsensusLeaderID(m_consensusLeaderID.load());
@@ -301,7 +303,9 @@ void DirectoryService::ProcessViewChangeConsensusWhenDone() {
     // Acquire shard receivers cosigs from MicroBlocks
     unordered_map<uint32_t, BlockBase> t_microBlocks;
     const auto& microBlocks = m_microBlocks
-        [m_mediator.m_txBlockChain.GetLastBlock().GetHeader().GetBlockNum()];
+        [m_mediator.m_txBlockChain.GetLastBlockPtr()
+            ->GetHeader()
+            .GetBlockNum()];
     for (const auto& microBlock : microBlocks) {
       t_microBlocks.emplace(microBlock.GetHeader().GetShardId(), microBlock);
     }
@@ -309,7 +313,7 @@ void DirectoryService::ProcessViewChangeConsensusWhenDone() {
     DataSender::GetInstance().SendDataToOthers(
         *m_pendingVCBlock, tmpDSCommittee, m_shards, t_microBlocks,
         m_mediator.m_lookup->GetLookupNodes(),
-        m_mediator.m_txBlockChain.GetLastBlock().GetBlockHash(),
+        m_mediator.m_txBlockChain.GetLastBlockPtr()->GetBlockHash(),
         m_consensusMyID, composeVCBlockForSender, t_sendDataToLookupFunc);
   }
 }
@@ -422,6 +426,17 @@ bool DirectoryService::ProcessViewChangeConsensus(
     return false;
   }
 
+  // Verify outside m_mutexConsensus, so that the commits and responses of
+  // many backups are checked in parallel
+  shared_ptr<ConsensusCommon> consensusObject;
+  {
+    lock_guard<mutex> g(m_mutexConsensus);
+    consensusObject = m_consensusObject;
+  }
+  if (consensusObject != nullptr) {
+    consensusObject->PreProcessMessage(message, offset);
+  }
+
   lock_guard<mutex> g(m_mutexConsensus);
 
   if (!m_consensusObject->ProcessMessage(message, offset, from)) {
@@ -433,7 +448,10 @@ bool DirectoryService::ProcessViewChangeConsensus(
             "Consensus state = " << m_consensusObject->GetStateString());
 
   if (state == ConsensusCommon::State::DONE) {
-    cv_ViewChangeVCBlock.notify_all();
+    {
+      lock_guard<mutex> g(m_mutexViewChangeTimer);
+      Scheduler::GetInstance().Cancel(m_viewChangeTimer);
+    }
     ProcessViewChangeConsensusWhenDone();
     LOG_EPOCH(INFO, m_mediator.m_currentEpochNum,
               "View change consensus is DONE!!!");
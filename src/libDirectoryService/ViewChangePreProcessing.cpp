@@ -99,11 +99,10 @@ bool DirectoryService::ViewChangeValidator(
   }
 
   // Verify the CommitteeHash member of the BlockHeaderBase
+  uint16_t candidateLeaderIndex;
   CommitteeHash committeeHash;
-  if (!Messenger::GetDSCommitteeHash(*m_mediator.m_DSCommittee,
-                                     committeeHash)) {
-    LOG_EPOCH(WARNING, m_mediator.m_currentEpochNum,
-              "Messenger::GetDSCommitteeHash failed.");
+  if (!GetViewChangeCandidate(m_viewChangeCounter, candidateLeaderIndex,
+                              committeeHash)) {
     return false;
   }
   if (committeeHash != m_pendingVCBlock->GetHeader().GetCommitteeHash()) {
@@ -128,7 +127,6 @@ bool DirectoryService::ViewChangeValidator(
   }
 
   // Verify candidate leader index
-  uint16_t candidateLeaderIndex = CalculateNewLeaderIndex();
   if (m_mediator.m_DSCommittee->at(candidateLeaderIndex).second !=
       m_pendingVCBlock->GetHeader().GetCandidateLeaderNetworkInfo()) {
     LOG_GENERAL(
@@ -274,9 +272,9 @@ void DirectoryService::RunConsensusOnViewChange() {
   SetState(VIEWCHANGE_CONSENSUS_PREP);
 
   uint64_t dsCurBlockNum =
-      m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetBlockNum();
+      m_mediator.m_dsBlockChain.GetLastBlockPtr()->GetHeader().GetBlockNum();
   uint64_t txCurBlockNum =
-      m_mediator.m_txBlockChain.GetLastBlock().GetHeader().GetBlockNum();
+      m_mediator.m_txBlockChain.GetLastBlockPtr()->GetHeader().GetBlockNum();
 
   // Note: Special check as 0 and 1 have special usage when fetching ds block
   // and final block No need check for 1 as
@@ -320,7 +318,13 @@ void DirectoryService::RunConsensusOnViewChange() {
           m_mediator.m_DSCommittee->at(faultyLeaderIndex));
     }
 
-    m_candidateLeaderIndex = CalculateNewLeaderIndex();
+    uint16_t candidateLeaderIndex;
+    CommitteeHash committeeHash;
+    if (!GetViewChangeCandidate(m_viewChangeCounter, candidateLeaderIndex,
+                                committeeHash)) {
+      candidateLeaderIndex = CalculateNewLeaderIndex(m_viewChangeCounter);
+    }
+    m_candidateLeaderIndex = candidateLeaderIndex;
 
     LOG_GENERAL(
         INFO,
@@ -372,16 +376,19 @@ void DirectoryService::ScheduleViewChangeTimeout() {
     return;
   }
 
-  std::unique_lock<std::mutex> cv_lk(m_MutexCVViewChangeVCBlock);
-  if (cv_ViewChangeVCBlock.wait_for(cv_lk,
-                                    std::chrono::seconds(VIEWCHANGE_TIME)) ==
-      std::cv_status::timeout) {
+  PrepareViewChangeCandidate();
+
+  auto timeout = [this]() -> void {
     LOG_EPOCH(WARNING, m_mediator.m_currentEpochNum,
               "Initiated view change again");
 
     auto func = [this]() -> void { RunConsensusOnViewChange(); };
     DetachedFunction(1, func);
-  }
+  };
+
+  lock_guard<mutex> g(m_mutexViewChangeTimer);
+  m_viewChangeTimer = Scheduler::GetInstance().ScheduleAfter(
+      chrono::seconds(VIEWCHANGE_TIME), timeout, "view_change");
 }
 
 bool DirectoryService::ComputeNewCandidateLeader(
@@ -415,11 +422,10 @@ bool DirectoryService::ComputeNewCandidateLeader(
                   << m_mediator.m_DSCommittee->at(candidateLeaderIndex).first);
 
   // Compute the CommitteeHash member of the BlockHeaderBase
+  uint16_t preparedLeaderIndex;
   CommitteeHash committeeHash;
-  if (!Messenger::GetDSCommitteeHash(*m_mediator.m_DSCommittee,
-                                     committeeHash)) {
-    LOG_EPOCH(WARNING, m_mediator.m_currentEpochNum,
-              "Messenger::GetDSCommitteeHash failed.");
+  if (!GetViewChangeCandidate(m_viewChangeCounter, preparedLeaderIndex,
+                              committeeHash)) {
     return false;
   }
   BlockHash prevHash = get<BlockLinkIndex::BLOCKHASH>(
@@ -429,7 +435,9 @@ bool DirectoryService::ComputeNewCandidateLeader(
     // To-do: Handle exceptions.
     m_pendingVCBlock.reset(new VCBlock(
         VCBlockHeader(
-            m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetBlockNum() +
+            m_mediator.m_dsBlockChain.GetLastBlockPtr()
+                ->GetHeader()
+                .GetBlockNum() +
                 1,
             m_mediator.m_currentEpochNum, m_viewChangestate,
             newLeaderNetworkInfo,
@@ -444,18 +452,16 @@ bool DirectoryService::ComputeNewCandidateLeader(
 
 bool DirectoryService::NodeVCPrecheck() {
   LOG_MARKER();
-  {
-    lock_guard<mutex> g(m_MutexCVViewChangePrecheckBlocks);
-    m_vcPreCheckDSBlocks.clear();
-    m_vcPreCheckTxBlocks.clear();
-  }
 
-  std::unique_lock<std::mutex> cv_lk(m_MutexCVViewChangePrecheck);
-  if (cv_viewChangePrecheck.wait_for(
-          cv_lk, std::chrono::seconds(VIEWCHANGE_PRECHECK_TIME)) ==
-      std::cv_status::timeout) {
-    LOG_EPOCH(INFO, m_mediator.m_currentEpochNum,
-              "Timeout while waiting for precheck. ");
+  // The seed's reply may have come in before this wait started
+  {
+    std::unique_lock<std::mutex> cv_lk(m_MutexCVViewChangePrecheck);
+    if (!cv_viewChangePrecheck.wait_for(
+            cv_lk, std::chrono::seconds(VIEWCHANGE_PRECHECK_TIME),
+            [this] { return m_vcPreCheckReceived; })) {
+      LOG_EPOCH(INFO, m_mediator.m_currentEpochNum,
+                "Timeout while waiting for precheck. ");
+    }
   }
 
   {
@@ -472,7 +478,7 @@ bool DirectoryService::NodeVCPrecheck() {
   return false;
 }
 
-uint16_t DirectoryService::CalculateNewLeaderIndex() {
+uint16_t DirectoryService::CalculateNewLeaderIndex(uint32_t vcCounter) {
   // New leader is computed using the following
   // new candidate leader index is
   // H((finalblock or vc block), vc counter) % size
@@ -490,11 +496,11 @@ uint16_t DirectoryService::CalculateNewLeaderIndex() {
     LOG_GENERAL(
         INFO, "Using hash of last final block for computing candidate leader");
     sha2.Update(
-        m_mediator.m_txBlockChain.GetLastBlock().GetBlockHash().asBytes());
+        m_mediator.m_txBlockChain.GetLastBlockPtr()->GetBlockHash().asBytes());
   }
 
   bytes vcCounterBytes;
-  Serializable::SetNumber<uint32_t>(vcCounterBytes, 0, m_viewChangeCounter,
+  Serializable::SetNumber<uint32_t>(vcCounterBytes, 0, vcCounter,
                                     sizeof(uint32_t));
   sha2.Update(vcCounterBytes);
   uint16_t lastBlockHash = DataConversion::charArrTo16Bits(sha2.Finalize());
@@ -524,11 +530,81 @@ uint16_t DirectoryService::CalculateNewLeaderIndex() {
 
     LOG_GENERAL(INFO, "Re-computed candidate leader is at index: "
                           << candidateLeaderIndex
-                          << " VC counter: " << m_viewChangeCounter);
+                          << " VC counter: " << vcCounter);
   }
   return candidateLeaderIndex;
 }
 
+bool DirectoryService::GetViewChangeCandidate(uint32_t vcCounter,
+                                              uint16_t& leaderIndex,
+                                              CommitteeHash& committeeHash) {
+  // Every change of the DS committee comes with a new block link, and the
+  // remaining fields are what CalculateNewLeaderIndex reads. The view change
+  // state only matters when the latest block link is a VC block.
+  VCCandidate candidate;
+  candidate.blockLinkIndex = m_mediator.m_blocklinkchain.GetLatestIndex();
+  candidate.latestIsVC =
+      get<BlockLinkIndex::BLOCKTYPE>(m_mediator.m_blocklinkchain.GetBlockLink(
+          candidate.blockLinkIndex)) == BlockType::VC;
+  candidate.txBlockHash =
+      m_mediator.m_txBlockChain.GetLastBlockPtr()->GetBlockHash();
+  candidate.epochNum = m_mediator.m_currentEpochNum;
+  candidate.consensusLeaderID = m_consensusLeaderID;
+  candidate.viewChangeCounter = vcCounter;
+  candidate.viewChangeState = m_viewChangestate;
+  candidate.committeeSize = m_mediator.m_DSCommittee->size();
+
+  auto sameInputs = [&candidate](const VCCandidate& prepared) {
+    return prepared.blockLinkIndex == candidate.blockLinkIndex &&
+           prepared.txBlockHash == candidate.txBlockHash &&
+           prepared.epochNum == candidate.epochNum &&
+           prepared.consensusLeaderID == candidate.consensusLeaderID &&
+           prepared.viewChangeCounter == candidate.viewChangeCounter &&
+           prepared.latestIsVC == candidate.latestIsVC &&
+           (!candidate.latestIsVC ||
+            prepared.viewChangeState == candidate.viewChangeState) &&
+           prepared.committeeSize == candidate.committeeSize;
+  };
+
+  {
+    lock_guard<mutex> g(m_mutexVCCandidate);
+    if (m_vcCandidate && sameInputs(*m_vcCandidate)) {
+      leaderIndex = m_vcCandidate->leaderIndex;
+      committeeHash = m_vcCandidate->committeeHash;
+      return true;
+    }
+  }
+
+  candidate.leaderIndex = CalculateNewLeaderIndex(vcCounter);
+  if (!Messenger::GetDSCommitteeHash(*m_mediator.m_DSCommittee,
+                                     candidate.committeeHash)) {
+    LOG_EPOCH(WARNING, m_mediator.m_currentEpochNum,
+              "Messenger::GetDSCommitteeHash failed.");
+    return false;
+  }
+
+  leaderIndex = candidate.leaderIndex;
+  committeeHash = candidate.committeeHash;
+
+  lock_guard<mutex> g(m_mutexVCCandidate);
+  m_vcCandidate = make_unique<VCCandidate>(candidate);
+  return true;
+}
+
+void DirectoryService::PrepareViewChangeCandidate() {
+  if (LOOKUP_NODE_MODE) {
+    return;
+  }
+
+  uint16_t leaderIndex;
+  CommitteeHash committeeHash;
+  lock_guard<mutex> g(m_mediator.m_mutexDSCommittee);
+  if (m_mediator.m_DSCommittee->empty()) {
+    return;
+  }
+  GetViewChangeCandidate(m_viewChangeCounter + 1, leaderIndex, committeeHash);
+}
+
 bool DirectoryService::CheckUseVCBlockInsteadOfDSBlock(
     const BlockLink& bl, VCBlockSharedPtr& prevVCBlockptr) {
   BlockType latestBlockType = get<BlockLinkIndex::BLOCKTYPE>(bl);
@@ -597,7 +673,7 @@ bool DirectoryService::RunConsensusOnViewChangeWhenCandidateLeader(
   uint32_t consensusID = m_viewChangeCounter;
   // Create new consensus object
   m_consensusBlockHash =
-      m_mediator.m_txBlockChain.GetLastBlock().GetBlockHash().asBytes();
+      m_mediator.m_txBlockChain.GetLastBlockPtr()->GetBlockHash().asBytes();
 
   m_consensusObject.reset(new ConsensusLeader(
       consensusID, m_mediator.m_currentEpochNum, m_consensusBlockHash,
@@ -658,7 +734,7 @@ bool DirectoryService::RunConsensusOnViewChangeWhenNotCandidateLeader(
                 << m_mediator.m_DSCommittee->at(candidateLeaderIndex).second);
 
   m_consensusBlockHash =
-      m_mediator.m_txBlockChain.GetLastBlock().GetBlockHash().asBytes();
+      m_mediator.m_txBlockChain.GetLastBlockPtr()->GetBlockHash().asBytes();
 
   auto func = [this](const bytes& input, unsigned int offset, bytes& errorMsg,
                      const uint32_t consensusID, const uint64_t blockNumber,
@@ -688,6 +764,15 @@ bool DirectoryService::RunConsensusOnViewChangeWhenNotCandidateLeader(
 
 bool DirectoryService::VCFetchLatestDSTxBlockFromSeedNodes() {
   LOG_MARKER();
+  {
+    lock_guard<mutex> g(m_MutexCVViewChangePrecheckBlocks);
+    m_vcPreCheckDSBlocks.clear();
+    m_vcPreCheckTxBlocks.clear();
+  }
+  {
+    lock_guard<mutex> g(m_MutexCVViewChangePrecheck);
+    m_vcPreCheckReceived = false;
+  }
   m_mediator.m_lookup->SendMessageToRandomSeedNode(
       ComposeVCGetDSTxBlockMessage());
   return true;
@@ -698,9 +783,13 @@ bytes DirectoryService::ComposeVCGetDSTxBlockMessage() {
   bytes getDSTxBlockMessage = {MessageType::LOOKUP,
                                LookupInstructionType::VCGETLATESTDSTXBLOCK};
   uint64_t dslowBlockNum =
-      m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetBlockNum() + 1;
+      m_mediator.m_dsBlockChain.GetLastBlockPtr()
+          ->GetHeader()
+          .GetBlockNum() + 1;
   uint64_t txlowBlockNum =
-      m_mediator.m_txBlockChain.GetLastBlock().GetHeader().GetBlockNum() + 1;
+      m_mediator.m_txBlockChain.GetLastBlockPtr()
+          ->GetHeader()
+          .GetBlockNum() + 1;
   if (!Messenger::SetLookupGetDSTxBlockFromSeed(
           getDSTxBlockMessage, MessageOffset::BODY, dslowBlockNum, 0,
           txlowBlockNum, 0, m_mediator.m_selfPeer.m_listenPortHost)) {
@@ -734,7 +823,7 @@ bool DirectoryService::ProcessGetDSTxBlockMessage(
             << to_string(m_state));
   }
 
-  lock_guard<mutex> g(m_MutexCVViewChangePrecheckBlocks);
+  unique_lock<mutex> g(m_MutexCVViewChangePrecheckBlocks);
 
   PubKey lookupPubKey;
   vector<DSBlock> vcPreCheckDSBlocks;
@@ -757,7 +846,12 @@ bool DirectoryService::ProcessGetDSTxBlockMessage(
 
   m_vcPreCheckDSBlocks = vcPreCheckDSBlocks;
   m_vcPreCheckTxBlocks = vcPreCheckTxBlocks;
+  g.unlock();
 
+  {
+    lock_guard<mutex> g2(m_MutexCVViewChangePrecheck);
+    m_vcPreCheckReceived = true;
+  }
   cv_viewChangePrecheck.notify_all();
   return true;
 }
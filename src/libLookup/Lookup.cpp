@@ -25,6 +25,7 @@
 #include <exception>
 #include <fstream>
 #include <random>
+#include <thread>
 
 #include <boost/property_tree/ptree.hpp>
 #include <boost/property_tree/xml_parser.hpp>
@@ -45,9 +46,11 @@
 #include "libPOW/pow.h"
 #include "libPersistence/BlockStorage.h"
 #include "libServer/GetWorkServer.h"
+#include "libServer/WebSocketServer.h"
 #include "libUtils/DataConversion.h"
 #include "libUtils/DetachedFunction.h"
 #include "libUtils/GetTxnFromFile.h"
+#include "libUtils/RollingBloomFilter.h"
 #include "libUtils/SanityChecks.h"
 #include "libUtils/SysCommand.h"
 
@@ -60,6 +63,10 @@ Lookup::Lookup(Mediator& mediator) : m_mediator(mediator) {
   if (LOOKUP_NODE_MODE) {
     SetDSCommitteInfo();
   }
+  if (USE_REMOTE_TXN_CREATOR && !TXN_CORPUS_FILE.empty() &&
+      !m_txnCorpus.Open(TXN_CORPUS_FILE)) {
+    LOG_GENERAL(WARNING, "Falling back to the txn files in " << TXN_PATH);
+  }
 }
 
 Lookup::~Lookup() {}
@@ -73,6 +80,7 @@ void Lookup::InitAsNewJoiner() {
   {
     std::lock_guard<mutex> lock(m_mediator.m_mutexDSCommittee);
     m_mediator.m_DSCommittee->clear();
+    m_mediator.PublishDSCommittee();
   }
   AccountStore::GetInstance().Init();
 
@@ -175,8 +183,8 @@ void Lookup::SetLookupNodes() {
     level++;
   }
 
-  // Add myself to lookupnodes
-  if (m_syncType == SyncType::NEW_LOOKUP_SYNC) {
+  // Add myself to lookupnodes, unless I am a replica no one sends to
+  if (m_syncType == SyncType::NEW_LOOKUP_SYNC && !READ_REPLICA_MODE) {
     const PubKey& myPubKey = m_mediator.m_selfKey.second;
     if (std::find_if(m_lookupNodes.begin(), m_lookupNodes.end(),
                      [&myPubKey](const std::pair<PubKey, Peer>& node) {
@@ -291,8 +299,7 @@ bool Lookup::GenTxnToSend(size_t num_txn, vector<Transaction>& txn) {
 
     uint64_t nonce = account->GetNonce();
 
-    if (!GetTxnFromFile::GetFromFile(addr, static_cast<uint32_t>(nonce) + 1,
-                                     num_txn, txns)) {
+    if (!GetGeneratedTxns(addr, nonce + 1, num_txn, txns)) {
       LOG_GENERAL(WARNING, "Failed to get txns from file");
       continue;
     }
@@ -303,9 +310,7 @@ bool Lookup::GenTxnToSend(size_t num_txn, vector<Transaction>& txn) {
                           << nonce + num_txn << " of Addr " << addr.hex());
     txns.clear();
 
-    if (!GetTxnFromFile::GetFromFile(addr,
-                                     static_cast<uint32_t>(nonce) + num_txn + 1,
-                                     NUM_TXN_TO_DS, txns)) {
+    if (!GetGeneratedTxns(addr, nonce + num_txn + 1, NUM_TXN_TO_DS, txns)) {
       LOG_GENERAL(WARNING, "Failed to get txns for DS");
       continue;
     }
@@ -348,8 +353,7 @@ bool Lookup::GenTxnToSend(size_t num_txn,
 
     uint64_t nonce = AccountStore::GetInstance().GetAccount(addr)->GetNonce();
 
-    if (!GetTxnFromFile::GetFromFile(addr, static_cast<uint32_t>(nonce) + 1,
-                                     num_txn, txns)) {
+    if (!GetGeneratedTxns(addr, nonce + 1, num_txn, txns)) {
       LOG_GENERAL(WARNING, "Failed to get txns from file");
       continue;
     }
@@ -360,9 +364,7 @@ bool Lookup::GenTxnToSend(size_t num_txn,
                           << nonce + num_txn << " of Addr " << addr.hex());
     txns.clear();
 
-    if (!GetTxnFromFile::GetFromFile(addr,
-                                     static_cast<uint32_t>(nonce) + num_txn + 1,
-                                     NUM_TXN_TO_DS, txns)) {
+    if (!GetGeneratedTxns(addr, nonce + num_txn + 1, NUM_TXN_TO_DS, txns)) {
       LOG_GENERAL(WARNING, "Failed to get txns for DS");
     }
 
@@ -372,6 +374,91 @@ bool Lookup::GenTxnToSend(size_t num_txn,
   return true;
 }
 
+bool Lookup::GenTxnToSend(size_t num_txn,
+                          map<uint32_t, vector<TxnCorpus::Slice>>& mp,
+                          uint32_t numShards) {
+  LOG_MARKER();
+
+  if (GENESIS_WALLETS.size() == 0) {
+    LOG_GENERAL(WARNING, "No genesis accounts found");
+    return false;
+  }
+
+  if (!USE_REMOTE_TXN_CREATOR || !m_txnCorpus.IsOpen() || numShards == 0) {
+    return false;
+  }
+
+  unsigned int NUM_TXN_TO_DS = num_txn / GENESIS_WALLETS.size();
+
+  for (auto& addrStr : GENESIS_WALLETS) {
+    bytes addrBytes;
+    if (!DataConversion::HexStrToUint8Vec(addrStr, addrBytes)) {
+      continue;
+    }
+    Address addr{addrBytes};
+
+    auto txnShard = Transaction::GetShardIndex(addr, numShards);
+
+    auto account = AccountStore::GetInstance().GetAccount(addr);
+    if (!account) {
+      LOG_GENERAL(WARNING, "Failed to get genesis account!");
+      continue;
+    }
+    uint64_t nonce = account->GetNonce();
+
+    TxnCorpus::Slice slice;
+    if (!m_txnCorpus.GetSlice(addr, nonce + 1, num_txn, slice)) {
+      LOG_GENERAL(WARNING, "Failed to get txns from corpus");
+      continue;
+    }
+    mp[txnShard].emplace_back(move(slice));
+
+    LOG_GENERAL(INFO, "[Batching] Last Nonce sent "
+                          << nonce + num_txn << " of Addr " << addr.hex());
+
+    if (NUM_TXN_TO_DS == 0) {
+      continue;
+    }
+
+    if (!m_txnCorpus.GetSlice(addr, nonce + num_txn + 1, NUM_TXN_TO_DS,
+                              slice)) {
+      LOG_GENERAL(WARNING, "Failed to get txns for DS");
+      continue;
+    }
+    mp[numShards].emplace_back(move(slice));
+  }
+
+  return true;
+}
+
+bool Lookup::GetGeneratedTxns(const Address& addr, uint64_t nonce,
+                              size_t num_txn, vector<Transaction>& txns) const {
+  if (!m_txnCorpus.IsOpen()) {
+    return GetTxnFromFile::GetFromFile(addr, static_cast<uint32_t>(nonce),
+                                       num_txn, txns);
+  }
+
+  txns.clear();
+
+  TxnCorpus::Slice slice;
+  if (!m_txnCorpus.GetSlice(addr, nonce, num_txn, slice)) {
+    return false;
+  }
+
+  const unsigned char* data = slice.m_data;
+  for (const auto& txnSize : slice.m_txnSizes) {
+    Transaction txn;
+    if (!Messenger::GetTransaction(bytes(data, data + txnSize), 0, txn)) {
+      LOG_GENERAL(WARNING, "Messenger::GetTransaction failed.");
+      return false;
+    }
+    txns.emplace_back(move(txn));
+    data += txnSize;
+  }
+
+  return true;
+}
+
 VectorOfNode Lookup::GetLookupNodes() const {
   LOG_MARKER();
   lock_guard<mutex> lock(m_mutexLookupNodes);
@@ -495,15 +582,7 @@ void Lookup::SendMessageToRandomLookupNode(const bytes& message) const {
                                 }) == m_multipliers.end();
                });
 
-  int index = rand() % tmp.size();
-
-  auto resolved_ip = TryGettingResolvedIP(tmp[index].second);
-
-  Blacklist::GetInstance().Exclude(
-      resolved_ip);  // exclude this lookup ip from blacklisting
-  Peer tmpPeer(resolved_ip, tmp[index].second.GetListenPortHost());
-  LOG_GENERAL(INFO, "Sending to Random lookup: " << tmpPeer);
-  P2PComm::GetInstance().SendMessage(tmpPeer, message);
+  SendSyncRequest(message, tmp);
 }
 
 void Lookup::SendMessageToSeedNodes(const bytes& message) const {
@@ -561,6 +640,23 @@ bytes Lookup::ComposeGetStateMessage() {
   return getStateMessage;
 }
 
+bytes Lookup::ComposeGetStateSnapshotMessage() {
+  LOG_MARKER();
+
+  bytes getStateSnapshotMessage = {
+      MessageType::LOOKUP, LookupInstructionType::GETSTATESNAPSHOTFROMSEED};
+
+  if (!Messenger::SetLookupGetStateSnapshotFromSeed(
+          getStateSnapshotMessage, MessageOffset::BODY,
+          m_mediator.m_selfPeer.m_listenPortHost)) {
+    LOG_EPOCH(WARNING, m_mediator.m_currentEpochNum,
+              "Messenger::SetLookupGetStateSnapshotFromSeed failed.");
+    return {};
+  }
+
+  return getStateSnapshotMessage;
+}
+
 bool Lookup::GetDSInfoFromSeedNodes() {
   LOG_MARKER();
   SendMessageToRandomSeedNode(ComposeGetDSInfoMessage());
@@ -581,7 +677,11 @@ bool Lookup::GetStateFromLookupNodes() {
 }
 
 bool Lookup::GetStateFromSeedNodes() {
-  SendMessageToRandomSeedNode(ComposeGetStateMessage());
+  if (CHUNKED_STATE_SYNC) {
+    SendMessageToRandomSeedNode(ComposeGetStateSnapshotMessage());
+  } else {
+    SendMessageToRandomSeedNode(ComposeGetStateMessage());
+  }
   return true;
 }
 
@@ -679,12 +779,57 @@ bool Lookup::GetTxBlockFromSeedNodes(uint64_t lowBlockNum,
                                      uint64_t highBlockNum) {
   LOG_MARKER();
 
+  // Only open-ended requests far enough behind a known tip are split up
+  if (TXBLOCK_SYNC_WINDOW_SIZE > 0 && highBlockNum == 0 && lowBlockNum > 1 &&
+      m_txBlockSyncTarget >= lowBlockNum + TXBLOCK_SYNC_WINDOW_SIZE) {
+    GetTxBlockWindowsFromSeedNodes(lowBlockNum);
+    return true;
+  }
+
   SendMessageToRandomSeedNode(
       ComposeGetTxBlockMessage(lowBlockNum, highBlockNum));
 
   return true;
 }
 
+void Lookup::GetTxBlockWindowsFromSeedNodes(uint64_t lowBlockNum) {
+  LOG_MARKER();
+
+  const VectorOfNode seedNodes = GetSeedNodes();
+  if (seedNodes.empty()) {
+    LOG_GENERAL(WARNING, "Seed nodes are empty");
+    return;
+  }
+
+  const uint64_t target = m_txBlockSyncTarget;
+  const uint64_t numBlocks = target - lowBlockNum + 1;
+  const uint64_t numWindows = min<uint64_t>(
+      seedNodes.size(),
+      (numBlocks + TXBLOCK_SYNC_WINDOW_SIZE - 1) / TXBLOCK_SYNC_WINDOW_SIZE);
+  const uint64_t windowSize = (numBlocks + numWindows - 1) / numWindows;
+
+  LOG_GENERAL(INFO, "Fetching tx blocks " << lowBlockNum << " to " << target
+                                          << " in " << numWindows
+                                          << " windows");
+
+  m_txBlockWindowsRequested = true;
+
+  const unsigned int first = rand() % seedNodes.size();
+  for (uint64_t i = 0; i < numWindows; i++) {
+    const uint64_t low = lowBlockNum + i * windowSize;
+    // The last window stays open-ended so it also brings any newer blocks,
+    // and the whole range ends at the tip as CheckTxBlocks expects
+    const uint64_t high = (i + 1 == numWindows) ? 0 : low + windowSize - 1;
+
+    const auto& seed = seedNodes.at((first + i) % seedNodes.size()).second;
+    auto resolved_ip = TryGettingResolvedIP(seed);
+    Blacklist::GetInstance().Exclude(resolved_ip);
+    P2PComm::GetInstance().SendMessage(
+        Peer(resolved_ip, seed.GetListenPortHost()),
+        ComposeGetTxBlockMessage(low, high));
+  }
+}
+
 bool Lookup::GetStateDeltaFromLookupNodes(const uint64_t& blockNum) {
   LOG_MARKER();
 
@@ -733,20 +878,20 @@ bool Lookup::SetDSCommitteInfo() {
       m_mediator.m_DSCommittee->emplace_back(make_pair(key, peer));
     }
   }
+  m_mediator.PublishDSCommittee();
 
   return true;
 }
 
-DequeOfShard Lookup::GetShardPeers() {
+shared_ptr<const DequeOfShard> Lookup::GetShardPeers() {
   if (!LOOKUP_NODE_MODE) {
     LOG_GENERAL(WARNING,
                 "Lookup::GetShardPeers not expected to be called from "
                 "other than the LookUp node.");
-    return DequeOfShard();
+    return make_shared<const DequeOfShard>();
   }
 
-  lock_guard<mutex> g(m_mediator.m_ds->m_mutexShards);
-  return m_mediator.m_ds->m_shards;
+  return m_mediator.m_ds->GetShardsSnapshot();
 }
 
 vector<Peer> Lookup::GetNodePeers() {
@@ -895,14 +1040,125 @@ void Lookup::SendMessageToRandomSeedNode(const bytes& message) const {
     return;
   }
 
-  int index = rand() % m_seedNodes.size();
-  auto resolved_ip = TryGettingResolvedIP(m_seedNodes[index].second);
+  SendSyncRequest(message, m_seedNodes);
+}
+
+namespace {
+
+// Requests sent while syncing and the instruction of their responses
+const pair<unsigned char, unsigned char> SYNC_REQUESTS[] = {
+    {LookupInstructionType::GETDSINFOFROMSEED,
+     LookupInstructionType::SETDSINFOFROMSEED},
+    {LookupInstructionType::GETDSBLOCKFROMSEED,
+     LookupInstructionType::SETDSBLOCKFROMSEED},
+    {LookupInstructionType::GETTXBLOCKFROMSEED,
+     LookupInstructionType::SETTXBLOCKFROMSEED},
+    {LookupInstructionType::GETSTATEFROMSEED,
+     LookupInstructionType::SETSTATEFROMSEED},
+    {LookupInstructionType::GETSTARTPOWFROMSEED,
+     LookupInstructionType::SETSTARTPOWFROMSEED},
+    {LookupInstructionType::GETDIRBLOCKSFROMSEED,
+     LookupInstructionType::SETDIRBLOCKSFROMSEED},
+    {LookupInstructionType::GETSTATEDELTAFROMSEED,
+     LookupInstructionType::SETSTATEDELTAFROMSEED},
+    {LookupInstructionType::GETSTATESNAPSHOTFROMSEED,
+     LookupInstructionType::SETSTATESNAPSHOTFROMSEED}};
+
+bool IsSyncRequest(unsigned char requestType) {
+  for (const auto& request : SYNC_REQUESTS) {
+    if (request.first == requestType) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool GetSyncRequestType(unsigned char responseType,
+                        unsigned char& requestType) {
+  for (const auto& request : SYNC_REQUESTS) {
+    if (request.second == responseType) {
+      requestType = request.first;
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace
+
+void Lookup::SendSyncRequest(const bytes& message,
+                             const VectorOfNode& nodes) const {
+  if (nodes.empty() || message.size() <= MessageOffset::INST) {
+    return;
+  }
+
+  vector<uint128_t> ips;
+  for (const auto& node : nodes) {
+    ips.emplace_back(TryGettingResolvedIP(node.second));
+  }
+
+  const auto sendTo = [&nodes, &ips, &message](size_t index) {
+    Blacklist::GetInstance().Exclude(
+        ips[index]);  // exclude this lookup ip from blacklisting
+    Peer peer(ips[index], nodes[index].second.GetListenPortHost());
+    LOG_GENERAL(INFO, "Sending to lookup: " << peer);
+    P2PComm::GetInstance().SendMessage(peer, message);
+  };
+
+  if (message.at(MessageOffset::TYPE) != MessageType::LOOKUP ||
+      !IsSyncRequest(message.at(MessageOffset::INST))) {
+    sendTo(rand() % nodes.size());
+    return;
+  }
+
+  const size_t index = m_syncRequests.Select(ips);
+  if (!m_syncRequests.Start(message.at(MessageOffset::INST), message,
+                            ips[index])) {
+    LOG_GENERAL(INFO, "Same request still pending, not sending it again");
+    return;
+  }
+  sendTo(index);
+
+  if (m_syncRequests.GetMaxTargets() <= 1 || nodes.size() <= 1) {
+    return;
+  }
+
+  // Hedge: if a node is slow to answer, send the request to another one and
+  // take whichever response comes first
+  auto hedge = [this, message, others = nodes, otherIps = ips]() mutable {
+    for (unsigned int i = 1; i < m_syncRequests.GetMaxTargets(); i++) {
+      this_thread::sleep_for(
+          chrono::milliseconds(m_syncRequests.GetHedgeDelayInMs()));
+
+      const vector<uint128_t> targets = m_syncRequests.GetTargets(message);
+      if (targets.empty()) {
+        return;
+      }
 
-  Blacklist::GetInstance().Exclude(
-      resolved_ip);  // exclude this lookup ip from blacklisting
+      for (size_t j = 0; j < otherIps.size();) {
+        if (find(targets.begin(), targets.end(), otherIps[j]) !=
+            targets.end()) {
+          otherIps.erase(otherIps.begin() + j);
+          others.erase(others.begin() + j);
+        } else {
+          j++;
+        }
+      }
+      if (otherIps.empty()) {
+        return;
+      }
 
-  Peer tmpPeer(resolved_ip, m_seedNodes[index].second.GetListenPortHost());
-  P2PComm::GetInstance().SendMessage(tmpPeer, message);
+      const size_t index = m_syncRequests.Select(otherIps);
+      if (!m_syncRequests.AddTarget(message, otherIps[index])) {
+        return;
+      }
+      Blacklist::GetInstance().Exclude(otherIps[index]);
+      Peer peer(otherIps[index], others[index].second.GetListenPortHost());
+      LOG_GENERAL(INFO, "No response yet, also sending to lookup: " << peer);
+      P2PComm::GetInstance().SendMessage(peer, message);
+    }
+  };
+  DetachedFunction(1, hedge);
 }
 
 // TODO: Refactor the code to remove the following assumption
@@ -926,6 +1182,20 @@ bool Lookup::ProcessGetDSBlockFromSeed(const bytes& message,
     return false;
   }
 
+  Peer requestingNode(from.m_ipAddress, portNo);
+  const SeedResponseKey key = GetSeedResponseKey(
+      LookupInstructionType::SETDSBLOCKFROMSEED, lowBlockNum, highBlockNum);
+
+  shared_ptr<const bytes> cached = GetSeedResponse(key);
+  if (cached) {
+    LOG_EPOCH(INFO, m_mediator.m_currentEpochNum,
+              "ProcessGetDSBlockFromSeed requested by "
+                  << from << " for blocks " << lowBlockNum << " to "
+                  << highBlockNum << " served from cache");
+    P2PComm::GetInstance().SendMessage(requestingNode, *cached);
+    return true;
+  }
+
   vector<DSBlock> dsBlocks;
   RetrieveDSBlocks(dsBlocks, lowBlockNum, highBlockNum);
   LOG_EPOCH(INFO, m_mediator.m_currentEpochNum,
@@ -933,20 +1203,23 @@ bool Lookup::ProcessGetDSBlockFromSeed(const bytes& message,
                                                       << lowBlockNum << " to "
                                                       << highBlockNum);
 
-  bytes dsBlockMessage = {MessageType::LOOKUP,
-                          LookupInstructionType::SETDSBLOCKFROMSEED};
+  auto dsBlockMessage = make_shared<bytes>(
+      bytes{MessageType::LOOKUP, LookupInstructionType::SETDSBLOCKFROMSEED});
 
   if (!Messenger::SetLookupSetDSBlockFromSeed(
-          dsBlockMessage, MessageOffset::BODY, lowBlockNum, highBlockNum,
+          *dsBlockMessage, MessageOffset::BODY, lowBlockNum, highBlockNum,
           m_mediator.m_selfKey, dsBlocks)) {
     LOG_EPOCH(WARNING, m_mediator.m_currentEpochNum,
               "Messenger::SetLookupSetDSBlockFromSeed failed.");
     return false;
   }
 
-  Peer requestingNode(from.m_ipAddress, portNo);
+  if (!dsBlocks.empty()) {
+    AddSeedResponse(key, dsBlockMessage);
+  }
+
   LOG_GENERAL(INFO, requestingNode);
-  P2PComm::GetInstance().SendMessage(requestingNode, dsBlockMessage);
+  P2PComm::GetInstance().SendMessage(requestingNode, *dsBlockMessage);
 
   //#endif // IS_LOOKUP_NODE
 
@@ -962,7 +1235,7 @@ void Lookup::RetrieveDSBlocks(vector<DSBlock>& dsBlocks, uint64_t& lowBlockNum,
   lock_guard<mutex> g(m_mediator.m_node->m_mutexDSBlock);
 
   uint64_t curBlockNum =
-      m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetBlockNum();
+      m_mediator.m_dsBlockChain.GetLastBlockPtr()->GetHeader().GetBlockNum();
 
   if (INIT_BLOCK_NUMBER == curBlockNum) {
     LOG_GENERAL(WARNING,
@@ -1046,6 +1319,97 @@ bool Lookup::ProcessGetStateFromSeed(const bytes& message, unsigned int offset,
   return true;
 }
 
+bool Lookup::ProcessGetStateSnapshotFromSeed(const bytes& message,
+                                             unsigned int offset,
+                                             const Peer& from) {
+  LOG_MARKER();
+
+  uint32_t portNo = 0;
+
+  if (!Messenger::GetLookupGetStateSnapshotFromSeed(message, offset, portNo)) {
+    LOG_EPOCH(WARNING, m_mediator.m_currentEpochNum,
+              "Messenger::GetLookupGetStateSnapshotFromSeed failed.");
+    return false;
+  }
+
+  lock_guard<mutex> g(m_mutexStateSnapshot);
+
+  // Nodes joining in the same epoch share one snapshot, and the previous one
+  // is kept until the state moves on so pending chunk requests are served
+  const dev::h256 stateRoot = AccountStore::GetInstance().GetStateRootHash();
+  if (m_snapshotChunks.empty() || stateRoot != m_snapshotStateRoot) {
+    vector<bytes> chunks;
+    vector<dev::h256> chunkHashes;
+    if (!AccountStore::GetInstance().GetSnapshotChunks(chunks, chunkHashes)) {
+      LOG_GENERAL(WARNING, "AccountStore::GetSnapshotChunks failed");
+      return false;
+    }
+    m_snapshotStateRoot = stateRoot;
+    m_snapshotBlockNum =
+        m_mediator.m_txBlockChain.GetLastBlockPtr()->GetHeader().GetBlockNum();
+    m_snapshotChunks = move(chunks);
+    m_snapshotChunkHashes = move(chunkHashes);
+  }
+
+  Peer requestingNode(from.m_ipAddress, portNo);
+  bytes setStateSnapshotMessage = {
+      MessageType::LOOKUP, LookupInstructionType::SETSTATESNAPSHOTFROMSEED};
+
+  if (!Messenger::SetLookupSetStateSnapshotFromSeed(
+          setStateSnapshotMessage, MessageOffset::BODY, m_mediator.m_selfKey,
+          m_snapshotBlockNum, m_snapshotStateRoot, m_snapshotChunkHashes)) {
+    LOG_EPOCH(WARNING, m_mediator.m_currentEpochNum,
+              "Messenger::SetLookupSetStateSnapshotFromSeed failed.");
+    return false;
+  }
+
+  P2PComm::GetInstance().SendMessage(requestingNode, setStateSnapshotMessage);
+
+  return true;
+}
+
+bool Lookup::ProcessGetStateChunkFromSeed(const bytes& message,
+                                          unsigned int offset,
+                                          const Peer& from) {
+  LOG_MARKER();
+
+  uint32_t portNo = 0;
+  dev::h256 stateRoot;
+  uint32_t chunkIndex = 0;
+
+  if (!Messenger::GetLookupGetStateChunkFromSeed(message, offset, portNo,
+                                                 stateRoot, chunkIndex)) {
+    LOG_EPOCH(WARNING, m_mediator.m_currentEpochNum,
+              "Messenger::GetLookupGetStateChunkFromSeed failed.");
+    return false;
+  }
+
+  lock_guard<mutex> g(m_mutexStateSnapshot);
+
+  if (stateRoot != m_snapshotStateRoot ||
+      chunkIndex >= m_snapshotChunks.size()) {
+    LOG_EPOCH(INFO, m_mediator.m_currentEpochNum,
+              "No chunk " << chunkIndex << " for state root " << stateRoot);
+    return false;
+  }
+
+  Peer requestingNode(from.m_ipAddress, portNo);
+  bytes setStateChunkMessage = {MessageType::LOOKUP,
+                                LookupInstructionType::SETSTATECHUNKFROMSEED};
+
+  if (!Messenger::SetLookupSetStateChunkFromSeed(
+          setStateChunkMessage, MessageOffset::BODY, stateRoot, chunkIndex,
+          m_snapshotChunks.at(chunkIndex))) {
+    LOG_EPOCH(WARNING, m_mediator.m_currentEpochNum,
+              "Messenger::SetLookupSetStateChunkFromSeed failed.");
+    return false;
+  }
+
+  P2PComm::GetInstance().SendMessage(requestingNode, setStateChunkMessage);
+
+  return true;
+}
+
 // TODO: Refactor the code to remove the following assumption
 // lowBlockNum = 1 => Latest block number
 // lowBlockNum = 0 => lowBlockNum set to 1
@@ -1067,6 +1431,20 @@ bool Lookup::ProcessGetTxBlockFromSeed(const bytes& message,
     return false;
   }
 
+  Peer requestingNode(from.m_ipAddress, portNo);
+  const SeedResponseKey key = GetSeedResponseKey(
+      LookupInstructionType::SETTXBLOCKFROMSEED, lowBlockNum, highBlockNum);
+
+  shared_ptr<const bytes> cached = GetSeedResponse(key);
+  if (cached) {
+    LOG_EPOCH(INFO, m_mediator.m_currentEpochNum,
+              "ProcessGetTxBlockFromSeed requested by "
+                  << from << " for blocks " << lowBlockNum << " to "
+                  << highBlockNum << " served from cache");
+    P2PComm::GetInstance().SendMessage(requestingNode, *cached);
+    return true;
+  }
+
   vector<TxBlock> txBlocks;
   RetrieveTxBlocks(txBlocks, lowBlockNum, highBlockNum);
 
@@ -1075,18 +1453,21 @@ bool Lookup::ProcessGetTxBlockFromSeed(const bytes& message,
                                                       << lowBlockNum << " to "
                                                       << highBlockNum);
 
-  bytes txBlockMessage = {MessageType::LOOKUP,
-                          LookupInstructionType::SETTXBLOCKFROMSEED};
+  auto txBlockMessage = make_shared<bytes>(
+      bytes{MessageType::LOOKUP, LookupInstructionType::SETTXBLOCKFROMSEED});
   if (!Messenger::SetLookupSetTxBlockFromSeed(
-          txBlockMessage, MessageOffset::BODY, lowBlockNum, highBlockNum,
+          *txBlockMessage, MessageOffset::BODY, lowBlockNum, highBlockNum,
           m_mediator.m_selfKey, txBlocks)) {
     LOG_EPOCH(WARNING, m_mediator.m_currentEpochNum,
               "Messenger::SetLookupSetTxBlockFromSeed failed.");
     return false;
   }
 
-  Peer requestingNode(from.m_ipAddress, portNo);
-  P2PComm::GetInstance().SendMessage(requestingNode, txBlockMessage);
+  if (!txBlocks.empty()) {
+    AddSeedResponse(key, txBlockMessage);
+  }
+
+  P2PComm::GetInstance().SendMessage(requestingNode, *txBlockMessage);
 
   // #endif // IS_LOOKUP_NODE
 
@@ -1105,18 +1486,18 @@ void Lookup::RetrieveTxBlocks(vector<TxBlock>& txBlocks, uint64_t& lowBlockNum,
     // give all the blocks till now in blockchain
     lowBlockNum = 1;
 
-  } else if (lowBlockNum <= m_mediator.m_dsBlockChain.GetLastBlock()
-                                .GetHeader()
+  } else if (lowBlockNum <= m_mediator.m_dsBlockChain.GetLastBlockPtr()
+                                ->GetHeader()
                                 .GetEpochNum()) {
     // To get block num from dsblockchain instead of txblock chain as node
     // recover from the last ds epoch
     lowBlockNum =
-        m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetEpochNum();
+        m_mediator.m_dsBlockChain.GetLastBlockPtr()->GetHeader().GetEpochNum();
   }
 
   if (highBlockNum == 0) {
     highBlockNum =
-        m_mediator.m_txBlockChain.GetLastBlock().GetHeader().GetBlockNum();
+        m_mediator.m_txBlockChain.GetLastBlockPtr()->GetHeader().GetBlockNum();
   }
 
   if (INIT_BLOCK_NUMBER == highBlockNum) {
@@ -1173,6 +1554,17 @@ bool Lookup::ProcessGetStateDeltaFromSeed(const bytes& message,
             "ProcessGetStateDeltaFromSeed requested by "
                 << from << " for block " << blockNum);
 
+  uint128_t ipAddr = from.m_ipAddress;
+  Peer requestingNode(ipAddr, portNo);
+  const SeedResponseKey key = GetSeedResponseKey(
+      LookupInstructionType::SETSTATEDELTAFROMSEED, blockNum, blockNum);
+
+  shared_ptr<const bytes> cached = GetSeedResponse(key);
+  if (cached) {
+    P2PComm::GetInstance().SendMessage(requestingNode, *cached);
+    return true;
+  }
+
   bytes stateDelta;
 
   if (!BlockStorage::GetBlockStorage().GetStateDelta(blockNum, stateDelta)) {
@@ -1181,24 +1573,78 @@ bool Lookup::ProcessGetStateDeltaFromSeed(const bytes& message,
                           << " absent. Didn't include it in response message.");
   }
 
-  bytes stateDeltaMessage = {MessageType::LOOKUP,
-                             LookupInstructionType::SETSTATEDELTAFROMSEED};
+  auto stateDeltaMessage = make_shared<bytes>(bytes{
+      MessageType::LOOKUP, LookupInstructionType::SETSTATEDELTAFROMSEED});
 
   if (!Messenger::SetLookupSetStateDeltaFromSeed(
-          stateDeltaMessage, MessageOffset::BODY, blockNum,
+          *stateDeltaMessage, MessageOffset::BODY, blockNum,
           m_mediator.m_selfKey, stateDelta)) {
     LOG_EPOCH(WARNING, m_mediator.m_currentEpochNum,
               "Messenger::SetLookupSetStateDeltaFromSeed failed.");
     return false;
   }
 
-  uint128_t ipAddr = from.m_ipAddress;
-  Peer requestingNode(ipAddr, portNo);
+  if (!stateDelta.empty()) {
+    AddSeedResponse(key, stateDeltaMessage);
+  }
+
   LOG_GENERAL(INFO, requestingNode);
-  P2PComm::GetInstance().SendMessage(requestingNode, stateDeltaMessage);
+  P2PComm::GetInstance().SendMessage(requestingNode, *stateDeltaMessage);
   return true;
 }
 
+Lookup::SeedResponseKey Lookup::GetSeedResponseKey(unsigned char type,
+                                                   uint64_t low,
+                                                   uint64_t high) {
+  // Ranges like "0 to latest" resolve differently once the chains move on,
+  // so the tips are part of the key
+  return make_tuple(
+      type, low, high,
+      m_mediator.m_dsBlockChain.GetLastBlockPtr()->GetHeader().GetBlockNum(),
+      m_mediator.m_txBlockChain.GetLastBlockPtr()->GetHeader().GetBlockNum());
+}
+
+shared_ptr<const bytes> Lookup::GetSeedResponse(const SeedResponseKey& key) {
+  if (SEED_RESPONSE_CACHE_SIZE == 0) {
+    return nullptr;
+  }
+
+  lock_guard<mutex> g(m_mutexSeedResponses);
+
+  const auto it = m_seedResponses.find(key);
+  if (it == m_seedResponses.end()) {
+    return nullptr;
+  }
+  return it->second;
+}
+
+void Lookup::AddSeedResponse(const SeedResponseKey& key,
+                             const shared_ptr<const bytes>& response) {
+  if (SEED_RESPONSE_CACHE_SIZE == 0) {
+    return;
+  }
+
+  lock_guard<mutex> g(m_mutexSeedResponses);
+
+  if (!m_seedResponses.emplace(key, response).second) {
+    return;
+  }
+  m_seedResponseOrder.emplace_back(key);
+
+  // Responses built against older tips are never asked for again, and they
+  // sit at the front since the tips only move forward
+  while (!m_seedResponseOrder.empty()) {
+    const SeedResponseKey& oldest = m_seedResponseOrder.front();
+    const bool staleTips = get<3>(oldest) != get<3>(key) ||
+                           get<4>(oldest) != get<4>(key);
+    if (!staleTips && m_seedResponses.size() <= SEED_RESPONSE_CACHE_SIZE) {
+      break;
+    }
+    m_seedResponses.erase(oldest);
+    m_seedResponseOrder.pop_front();
+  }
+}
+
 // Ex-Archival node code
 bool Lookup::ProcessGetShardFromSeed([[gnu::unused]] const bytes& message,
                                      [[gnu::unused]] unsigned int offset,
@@ -1324,8 +1770,9 @@ bool Lookup::AddMicroBlockToStorage(const MicroBlock& microblock) {
 
   bytes body;
   microblock.Serialize(body, 0);
-  if (!BlockStorage::GetBlockStorage().PutMicroBlock(microblock.GetBlockHash(),
-                                                     body)) {
+  if (!BlockStorage::GetBlockStorage().PutMicroBlock(
+          microblock.GetBlockHash(), microblock.GetHeader().GetEpochNum(),
+          microblock.GetHeader().GetShardId(), body)) {
     LOG_GENERAL(WARNING, "Failed to put microblock in body");
     return false;
   }
@@ -1536,6 +1983,7 @@ bool Lookup::ProcessSetDSInfoFromSeed(const bytes& message, unsigned int offset,
           INFO, m_mediator.m_currentEpochNum,
           "ProcessSetDSInfoFromSeed recvd peer " << i++ << ": " << ds.second);
     }
+    m_mediator.PublishDSCommittee();
 
     if (m_mediator.m_blocklinkchain.GetBuiltDSComm().size() !=
         m_mediator.m_DSCommittee->size()) {
@@ -1608,7 +2056,9 @@ bool Lookup::ProcessSetDSBlockFromSeed(const bytes& message,
   }
 
   uint64_t latestSynBlockNum =
-      m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetBlockNum() + 1;
+      m_mediator.m_dsBlockChain.GetLastBlockPtr()
+          ->GetHeader()
+          .GetBlockNum() + 1;
 
   if (latestSynBlockNum > highBlockNum) {
     // TODO: We should get blocks from n nodes.
@@ -1633,6 +2083,9 @@ bool Lookup::ProcessSetDSBlockFromSeed(const bytes& message,
       dsblock.Serialize(serializedDSBlock, 0);
       BlockStorage::GetBlockStorage().PutDSBlock(
           dsblock.GetHeader().GetBlockNum(), serializedDSBlock);
+      BlockStorage::GetBlockStorage().PutBlockHash(
+          BlockType::DS, dsblock.GetHeader().GetBlockNum(),
+          dsblock.GetBlockHash());
     }
 
     if (m_syncType == SyncType::DS_SYNC ||
@@ -1654,7 +2107,7 @@ bool Lookup::ProcessSetTxBlockFromSeed(const bytes& message,
   //#ifndef IS_LOOKUP_NODE
   LOG_MARKER();
 
-  if (AlreadyJoinedNetwork()) {
+  if (AlreadyJoinedNetwork() && !m_followingSeeds) {
     cv_setTxBlockFromSeed.notify_all();
     return true;
   }
@@ -1663,11 +2116,12 @@ bool Lookup::ProcessSetTxBlockFromSeed(const bytes& message,
 
   uint64_t lowBlockNum = 0;
   uint64_t highBlockNum = 0;
-  std::vector<TxBlock> txBlocks;
+  std::vector<bytes> txBlockBodies;
   PubKey lookupPubKey;
 
-  if (!Messenger::GetLookupSetTxBlockFromSeed(
-          message, offset, lowBlockNum, highBlockNum, lookupPubKey, txBlocks)) {
+  if (!Messenger::GetLookupSetTxBlockFromSeed(message, offset, lowBlockNum,
+                                              highBlockNum, lookupPubKey,
+                                              txBlockBodies)) {
     LOG_EPOCH(WARNING, m_mediator.m_currentEpochNum,
               "Messenger::GetLookupSetTxBlockFromSeed failed.");
     return false;
@@ -1708,48 +2162,208 @@ bool Lookup::ProcessSetTxBlockFromSeed(const bytes& message,
     return false;
   }
 
-  if (txBlocks.empty()) {
+  if (txBlockBodies.empty()) {
     LOG_GENERAL(WARNING, "No block actually sent");
     cv_setTxBlockFromSeed.notify_all();
     return false;
   }
 
   uint64_t latestSynBlockNum =
-      m_mediator.m_txBlockChain.GetLastBlock().GetHeader().GetBlockNum() + 1;
+      m_mediator.m_txBlockChain.GetLastBlockPtr()
+          ->GetHeader()
+          .GetBlockNum() + 1;
 
-  if (latestSynBlockNum > highBlockNum) {
-    // TODO: We should get blocks from n nodes.
+  if (highBlockNum > m_txBlockSyncTarget) {
+    m_txBlockSyncTarget = highBlockNum;
+  }
+
+  const bool windowed = m_txBlockWindowsRequested || !m_txBlockWindows.empty();
+
+  // Duplicates are dropped before any block is decoded
+  if (!windowed && latestSynBlockNum > highBlockNum) {
     LOG_EPOCH(INFO, m_mediator.m_currentEpochNum,
               "I already have the block. latestSynBlockNum="
                   << latestSynBlockNum << " highBlockNum=" << highBlockNum);
     return false;
-  } else {
-    auto res = m_mediator.m_validator->CheckTxBlocks(
-        txBlocks, m_mediator.m_blocklinkchain.GetBuiltDSComm(),
-        m_mediator.m_blocklinkchain.GetLatestBlockLink());
-    switch (res) {
-      case ValidatorBase::TxBlockValidationMsg::VALID:
-        CommitTxBlocks(txBlocks);
-        break;
-      case ValidatorBase::TxBlockValidationMsg::INVALID:
-        LOG_GENERAL(INFO, "[TxBlockVerif]"
-                              << "Invalid blocks");
-        break;
-      case ValidatorBase::TxBlockValidationMsg::STALEDSINFO:
-        LOG_GENERAL(INFO, "[TxBlockVerif]"
-                              << "Saved to buffer");
-        m_txBlockBuffer.clear();
-        for (const auto& txBlock : txBlocks) {
-          m_txBlockBuffer.emplace_back(txBlock);
+  }
+
+  // Windows only keep blocks from latestSynBlockNum on, so the ones below it
+  // are skipped on their header alone
+  std::vector<TxBlock> txBlocks;
+  for (const auto& body : txBlockBodies) {
+    if (windowed) {
+      TxBlockHeader header;
+      if (!Messenger::GetTxBlockHeaderOfBlock(body, 0, header) ||
+          header.GetBlockNum() < latestSynBlockNum) {
+        continue;
+      }
+    }
+    TxBlock txBlock;
+    if (!Messenger::GetTxBlock(body, 0, txBlock)) {
+      continue;
+    }
+    txBlocks.emplace_back(move(txBlock));
+  }
+
+  if (txBlocks.empty() && !windowed) {
+    LOG_GENERAL(WARNING, "No block could be decoded");
+    cv_setTxBlockFromSeed.notify_all();
+    return false;
+  }
+
+  // A window past the next block we need waits for the ones before it
+  if (lowBlockNum > latestSynBlockNum) {
+    LOG_GENERAL(INFO, "Keeping tx blocks " << lowBlockNum << " to "
+                                           << highBlockNum << " until "
+                                           << latestSynBlockNum
+                                           << " arrives");
+    m_txBlockWindows[lowBlockNum] = move(txBlocks);
+    return true;
+  }
+
+  if (windowed) {
+    vector<TxBlock> assembled;
+    for (auto& txBlock : txBlocks) {
+      if (txBlock.GetHeader().GetBlockNum() >= latestSynBlockNum) {
+        assembled.emplace_back(move(txBlock));
+      }
+    }
+    uint64_t next = assembled.empty()
+                        ? latestSynBlockNum
+                        : assembled.back().GetHeader().GetBlockNum() + 1;
+
+    for (auto it = m_txBlockWindows.begin();
+         it != m_txBlockWindows.end() && it->first <= next;) {
+      for (auto& txBlock : it->second) {
+        if (txBlock.GetHeader().GetBlockNum() == next) {
+          assembled.emplace_back(move(txBlock));
+          next++;
         }
-        break;
-      default:;
+      }
+      it = m_txBlockWindows.erase(it);
+    }
+
+    if (assembled.empty()) {
+      return false;
     }
+
+    if (m_txBlockWindowsRequested && next <= m_txBlockSyncTarget) {
+      LOG_GENERAL(INFO, "Have tx blocks " << latestSynBlockNum << " to "
+                                          << next - 1 << ", waiting for "
+                                          << m_txBlockSyncTarget);
+      m_txBlockWindows[latestSynBlockNum] = move(assembled);
+      return true;
+    }
+
+    m_txBlockWindows.clear();
+    txBlocks = move(assembled);
+    highBlockNum = next - 1;
+  }
+  m_txBlockWindowsRequested = false;
+
+  if (latestSynBlockNum > highBlockNum) {
+    // TODO: We should get blocks from n nodes.
+    LOG_EPOCH(INFO, m_mediator.m_currentEpochNum,
+              "I already have the block. latestSynBlockNum="
+                  << latestSynBlockNum << " highBlockNum=" << highBlockNum);
+    return false;
   }
 
+  // Every response starts right after my chain, so the one reaching further
+  // replaces what is buffered
+  if (!txBlocks.empty() &&
+      (m_txBlockBuffer.empty() ||
+       txBlocks.back().GetHeader().GetBlockNum() >=
+           m_txBlockBuffer.back().GetHeader().GetBlockNum())) {
+    m_txBlockBuffer = move(txBlocks);
+  }
+  ProcessTxBlockBuffer();
+
   return true;
 }
 
+void Lookup::ProcessTxBlockBuffer() {
+  const uint64_t latestSynBlockNum =
+      m_mediator.m_txBlockChain.GetLastBlockPtr()
+          ->GetHeader()
+          .GetBlockNum() + 1;
+
+  m_txBlockBuffer.erase(
+      m_txBlockBuffer.begin(),
+      find_if(m_txBlockBuffer.begin(), m_txBlockBuffer.end(),
+              [latestSynBlockNum](const TxBlock& txBlock) {
+                return txBlock.GetHeader().GetBlockNum() >= latestSynBlockNum;
+              }));
+
+  if (m_txBlockBuffer.empty()) {
+    return;
+  }
+
+  if (m_txBlockBuffer.front().GetHeader().GetBlockNum() != latestSynBlockNum) {
+    LOG_GENERAL(INFO, "[TxBlockVerif]"
+                          << "Buffer starts after " << latestSynBlockNum);
+    return;
+  }
+
+  // DS epoch the directory blocks have been verified up to, as
+  // Validator::CheckTxBlocks finds it
+  const BlockLink latestBlockLink =
+      m_mediator.m_blocklinkchain.GetLatestBlockLink();
+  uint64_t latestDSIndex = get<BlockLinkIndex::DSINDEX>(latestBlockLink);
+  if (get<BlockLinkIndex::BLOCKTYPE>(latestBlockLink) != BlockType::DS &&
+      latestDSIndex > 0) {
+    latestDSIndex--;
+  }
+
+  // The blocks up to the last one of that epoch can be checked now, the last
+  // one against the DS committee and the others through the hash chain
+  size_t numVerifiable = m_txBlockBuffer.size();
+  while (numVerifiable > 0 &&
+         m_txBlockBuffer.at(numVerifiable - 1).GetHeader().GetDSBlockNum() >
+             latestDSIndex) {
+    numVerifiable--;
+  }
+
+  const bool waitForDirBlocks = numVerifiable == 0;
+  const bool waitForTxBlocks =
+      numVerifiable == m_txBlockBuffer.size() &&
+      m_txBlockBuffer.back().GetHeader().GetDSBlockNum() < latestDSIndex;
+  if (waitForDirBlocks || waitForTxBlocks) {
+    LOG_GENERAL(INFO, "[TxBlockVerif]"
+                          << "Saved to buffer");
+    if (waitForDirBlocks) {
+      ComposeAndSendGetDirectoryBlocksFromSeed(
+          m_mediator.m_blocklinkchain.GetLatestIndex() + 1);
+    }
+    return;
+  }
+
+  vector<TxBlock> txBlocks(m_txBlockBuffer.begin(),
+                           m_txBlockBuffer.begin() + numVerifiable);
+  const auto res = m_mediator.m_validator->CheckTxBlocks(
+      txBlocks, m_mediator.m_blocklinkchain.GetBuiltDSComm(),
+      latestBlockLink);
+
+  if (res != ValidatorBase::TxBlockValidationMsg::VALID) {
+    LOG_GENERAL(WARNING, "[TxBlockVerif]"
+                             << "Invalid blocks");
+    m_txBlockBuffer.clear();
+    return;
+  }
+
+  CommitTxBlocks(txBlocks);
+  m_txBlockBuffer.erase(m_txBlockBuffer.begin(),
+                        m_txBlockBuffer.begin() + numVerifiable);
+
+  if (!m_txBlockBuffer.empty()) {
+    LOG_GENERAL(INFO, "[TxBlockVerif]"
+                          << m_txBlockBuffer.size()
+                          << " blocks wait for directory blocks");
+    ComposeAndSendGetDirectoryBlocksFromSeed(
+        m_mediator.m_blocklinkchain.GetLatestIndex() + 1);
+  }
+}
+
 void Lookup::CommitTxBlocks(const vector<TxBlock>& txBlocks) {
   LOG_GENERAL(INFO, "[TxBlockVerif]"
                         << "Success");
@@ -1757,22 +2371,30 @@ void Lookup::CommitTxBlocks(const vector<TxBlock>& txBlocks) {
     LOG_EPOCH(INFO, m_mediator.m_currentEpochNum, txBlock);
 
     m_mediator.m_node->AddBlock(txBlock);
+    WebSocketServer::GetInstance().PublishTxBlock(txBlock);
     // Store Tx Block to disk
     bytes serializedTxBlock;
     txBlock.Serialize(serializedTxBlock, 0);
     BlockStorage::GetBlockStorage().PutTxBlock(
         txBlock.GetHeader().GetBlockNum(), serializedTxBlock);
+    BlockStorage::GetBlockStorage().PutBlockHash(
+        BlockType::Tx, txBlock.GetHeader().GetBlockNum(),
+        txBlock.GetBlockHash());
   }
 
   m_mediator.m_currentEpochNum =
-      m_mediator.m_txBlockChain.GetLastBlock().GetHeader().GetBlockNum() + 1;
+      m_mediator.m_txBlockChain.GetLastBlockPtr()
+          ->GetHeader()
+          .GetBlockNum() + 1;
 
   m_mediator.m_consensusID =
       m_mediator.m_currentEpochNum % NUM_FINAL_BLOCK_PER_POW;
 
   m_mediator.UpdateTxBlockRand();
 
-  if (m_mediator.m_currentEpochNum % NUM_FINAL_BLOCK_PER_POW == 0) {
+  if (m_followingSeeds) {
+    // FollowSeeds fetches the state deltas of these blocks
+  } else if (m_mediator.m_currentEpochNum % NUM_FINAL_BLOCK_PER_POW == 0) {
     LOG_EPOCH(INFO, m_mediator.m_currentEpochNum,
               "At new DS epoch now, try getting state from lookup");
     GetStateFromSeedNodes();
@@ -1791,7 +2413,7 @@ bool Lookup::ProcessSetStateDeltaFromSeed(const bytes& message,
                                           const Peer& from) {
   LOG_MARKER();
 
-  if (AlreadyJoinedNetwork()) {
+  if (AlreadyJoinedNetwork() && !m_followingSeeds) {
     cv_setStateDeltaFromSeed.notify_all();
     return true;
   }
@@ -1820,13 +2442,31 @@ bool Lookup::ProcessSetStateDeltaFromSeed(const bytes& message,
             "ProcessSetStateDeltaFromSeed sent by " << from << " for block "
                                                     << blockNum);
 
+  if (m_followingSeeds && blockNum != m_followedStateBlockNum + 1) {
+    LOG_GENERAL(INFO, "Not the next state delta, expected block "
+                          << m_followedStateBlockNum + 1);
+    return false;
+  }
+
   if (!AccountStore::GetInstance().DeserializeDelta(stateDelta, 0)) {
     LOG_GENERAL(WARNING, "AccountStore::GetInstance().DeserializeDelta failed");
     return false;
   }
+
+  if (m_followingSeeds) {
+    // As a lookup in the protocol stores it at the end of a DS epoch
+    if (m_mediator.GetIsVacuousEpoch(blockNum) &&
+        !AccountStore::GetInstance().MoveUpdatesToDisk()) {
+      LOG_GENERAL(WARNING, "MoveUpdatesToDisk failed");
+    }
+    if (!AccountStore::GetInstance().RetainStateRoot(blockNum)) {
+      LOG_GENERAL(WARNING, "RetainStateRoot failed");
+    }
+    m_followedStateBlockNum = blockNum;
+  }
   m_mediator.m_ds->SaveCoinbase(
-      m_mediator.m_txBlockChain.GetLastBlock().GetB1(),
-      m_mediator.m_txBlockChain.GetLastBlock().GetB2(),
+      m_mediator.m_txBlockChain.GetLastBlockPtr()->GetB1(),
+      m_mediator.m_txBlockChain.GetLastBlockPtr()->GetB2(),
       CoinbaseReward::FINALBLOCK_REWARD, m_mediator.m_currentEpochNum);
   cv_setStateDeltaFromSeed.notify_all();
   return true;
@@ -1862,6 +2502,171 @@ bool Lookup::ProcessSetStateFromSeed(const bytes& message, unsigned int offset,
     return false;
   }
 
+  return ContinueAfterSetState();
+}
+
+bool Lookup::ProcessSetStateSnapshotFromSeed(const bytes& message,
+                                             unsigned int offset,
+                                             const Peer& from) {
+  LOG_MARKER();
+
+  if (AlreadyJoinedNetwork()) {
+    return true;
+  }
+
+  PubKey lookupPubKey;
+  uint64_t blockNum = 0;
+  dev::h256 stateRoot;
+  vector<dev::h256> chunkHashes;
+  if (!Messenger::GetLookupSetStateSnapshotFromSeed(
+          message, offset, lookupPubKey, blockNum, stateRoot, chunkHashes)) {
+    LOG_EPOCH(WARNING, m_mediator.m_currentEpochNum,
+              "Messenger::GetLookupSetStateSnapshotFromSeed failed.");
+    return false;
+  }
+
+  if (!VerifySenderNode(GetSeedNodes(), lookupPubKey)) {
+    LOG_EPOCH(WARNING, m_mediator.m_currentEpochNum,
+              "The message sender pubkey: "
+                  << lookupPubKey << " is not in my lookup node list.");
+    return false;
+  }
+
+  LOG_EPOCH(INFO, m_mediator.m_currentEpochNum,
+            "State snapshot from " << from << " for block " << blockNum
+                                   << ": " << chunkHashes.size()
+                                   << " chunks, root " << stateRoot);
+
+  lock_guard<mutex> g(m_mutexStateSync);
+
+  // The same manifest again means an earlier download was cut short, so
+  // only the chunks still missing are asked for
+  if (stateRoot != m_stateSyncRoot || chunkHashes != m_stateSyncChunkHashes) {
+    AccountStore::GetInstance().Init();
+    m_stateSyncRoot = stateRoot;
+    m_stateSyncChunkHashes = move(chunkHashes);
+    m_stateSyncReceived.assign(m_stateSyncChunkHashes.size(), false);
+    m_stateSyncNumReceived = 0;
+  } else {
+    LOG_GENERAL(INFO, "Resuming state sync with "
+                          << m_stateSyncNumReceived << " of "
+                          << m_stateSyncChunkHashes.size() << " chunks");
+  }
+
+  RequestMissingStateChunks();
+
+  return true;
+}
+
+void Lookup::RequestMissingStateChunks() {
+  LOG_MARKER();
+
+  const VectorOfNode seedNodes = GetSeedNodes();
+  if (seedNodes.empty()) {
+    LOG_GENERAL(WARNING, "Seed nodes are empty");
+    return;
+  }
+
+  // Spread the requests over the seeds so the chunks arrive in parallel
+  unsigned int next = rand() % seedNodes.size();
+  for (uint32_t i = 0; i < m_stateSyncChunkHashes.size(); i++) {
+    if (m_stateSyncReceived.at(i)) {
+      continue;
+    }
+
+    bytes getStateChunkMessage = {MessageType::LOOKUP,
+                                  LookupInstructionType::GETSTATECHUNKFROMSEED};
+    if (!Messenger::SetLookupGetStateChunkFromSeed(
+            getStateChunkMessage, MessageOffset::BODY,
+            m_mediator.m_selfPeer.m_listenPortHost, m_stateSyncRoot, i)) {
+      LOG_EPOCH(WARNING, m_mediator.m_currentEpochNum,
+                "Messenger::SetLookupGetStateChunkFromSeed failed.");
+      return;
+    }
+
+    const auto& seed = seedNodes.at(next++ % seedNodes.size()).second;
+    auto resolved_ip = TryGettingResolvedIP(seed);
+    Blacklist::GetInstance().Exclude(resolved_ip);
+    P2PComm::GetInstance().SendMessage(
+        Peer(resolved_ip, seed.GetListenPortHost()), getStateChunkMessage);
+  }
+}
+
+bool Lookup::ProcessSetStateChunkFromSeed(const bytes& message,
+                                          unsigned int offset,
+                                          [[gnu::unused]] const Peer& from) {
+  LOG_MARKER();
+
+  if (AlreadyJoinedNetwork()) {
+    return true;
+  }
+
+  dev::h256 stateRoot;
+  uint32_t chunkIndex = 0;
+  bytes chunk;
+  if (!Messenger::GetLookupSetStateChunkFromSeed(message, offset, stateRoot,
+                                                 chunkIndex, chunk)) {
+    LOG_EPOCH(WARNING, m_mediator.m_currentEpochNum,
+              "Messenger::GetLookupSetStateChunkFromSeed failed.");
+    return false;
+  }
+
+  {
+    lock_guard<mutex> g(m_mutexStateSync);
+
+    if (stateRoot != m_stateSyncRoot ||
+        chunkIndex >= m_stateSyncChunkHashes.size()) {
+      LOG_GENERAL(INFO, "Chunk " << chunkIndex << " for root " << stateRoot
+                                 << " is not part of the current sync");
+      return false;
+    }
+
+    if (m_stateSyncReceived.at(chunkIndex)) {
+      return true;
+    }
+
+    // The signed manifest vouches for the hash, so the chunk itself can come
+    // from any seed
+    if (AccountStore::GetSnapshotChunkHash(chunk) !=
+        m_stateSyncChunkHashes.at(chunkIndex)) {
+      LOG_GENERAL(WARNING, "Hash mismatch for state chunk " << chunkIndex);
+      return false;
+    }
+
+    if (!AccountStore::GetInstance().AddSnapshotChunk(chunk)) {
+      LOG_GENERAL(WARNING, "AddSnapshotChunk failed for chunk " << chunkIndex);
+      return false;
+    }
+
+    m_stateSyncReceived.at(chunkIndex) = true;
+    m_stateSyncNumReceived++;
+
+    if (m_stateSyncNumReceived < m_stateSyncChunkHashes.size()) {
+      return true;
+    }
+
+    const dev::h256 loadedRoot = AccountStore::GetInstance().GetStateRootHash();
+    // Start over on the next manifest, whatever the outcome
+    m_stateSyncRoot = dev::h256();
+    m_stateSyncChunkHashes.clear();
+    m_stateSyncReceived.clear();
+    m_stateSyncNumReceived = 0;
+
+    if (loadedRoot != stateRoot) {
+      LOG_GENERAL(WARNING, "State root mismatch after state sync. Expected: "
+                               << stateRoot << " Got: " << loadedRoot);
+      return false;
+    }
+  }
+
+  LOG_EPOCH(INFO, m_mediator.m_currentEpochNum,
+            "State sync finished at root " << stateRoot);
+
+  unique_lock<mutex> lock(m_mutexSetState);
+  return ContinueAfterSetState();
+}
+
+bool Lookup::ContinueAfterSetState() {
   if (!LOOKUP_NODE_MODE) {
     if (m_syncType == SyncType::NEW_SYNC ||
         m_syncType == SyncType::NORMAL_SYNC) {
@@ -1901,8 +2706,8 @@ bool Lookup::ProcessSetStateFromSeed(const bytes& message, unsigned int offset,
       if (!Messenger::SetLookupGetStartPoWFromSeed(
               getpowsubmission_message, MessageOffset::BODY,
               m_mediator.m_selfPeer.m_listenPortHost,
-              m_mediator.m_dsBlockChain.GetLastBlock()
-                  .GetHeader()
+              m_mediator.m_dsBlockChain.GetLastBlockPtr()
+                  ->GetHeader()
                   .GetBlockNum(),
               m_mediator.m_selfKey)) {
         LOG_EPOCH(WARNING, m_mediator.m_currentEpochNum,
@@ -1915,7 +2720,9 @@ bool Lookup::ProcessSetStateFromSeed(const bytes& message, unsigned int offset,
     } else if (m_syncType == SyncType::DS_SYNC ||
                m_syncType == SyncType::GUARD_DS_SYNC) {
       if (!m_currDSExpired &&
-          m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetEpochNum() <
+          m_mediator.m_dsBlockChain.GetLastBlockPtr()
+              ->GetHeader()
+              .GetEpochNum() <
               m_mediator.m_currentEpochNum) {
         m_isFirstLoop = true;
         SetSyncType(SyncType::NO_SYNC);
@@ -2072,7 +2879,9 @@ bool Lookup::CheckStateRoot() {
 
   StateHash stateRoot = AccountStore::GetInstance().GetStateRootHash();
   StateHash rootInFinalBlock =
-      m_mediator.m_txBlockChain.GetLastBlock().GetHeader().GetStateRootHash();
+      m_mediator.m_txBlockChain.GetLastBlockPtr()
+          ->GetHeader()
+          .GetStateRootHash();
 
   if (stateRoot == rootInFinalBlock) {
     LOG_GENERAL(INFO, "CheckStateRoot match");
@@ -2104,7 +2913,7 @@ bool Lookup::InitMining(uint32_t lookupIndex) {
   }
 
   uint64_t curDsBlockNum =
-      m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetBlockNum();
+      m_mediator.m_dsBlockChain.GetLastBlockPtr()->GetHeader().GetBlockNum();
 
   m_mediator.UpdateDSBlockRand();
   auto dsBlockRand = m_mediator.m_dsBlockRand;
@@ -2118,7 +2927,9 @@ bool Lookup::InitMining(uint32_t lookupIndex) {
 
     m_mediator.m_node->SetState(Node::POW_SUBMISSION);
     POW::GetInstance().EthashConfigureClient(
-        m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetBlockNum() + 1,
+        m_mediator.m_dsBlockChain.GetLastBlockPtr()
+            ->GetHeader()
+            .GetBlockNum() + 1,
         FULL_DATASET_MINE);
 
     LOG_EPOCH(INFO, m_mediator.m_currentEpochNum,
@@ -2126,8 +2937,12 @@ bool Lookup::InitMining(uint32_t lookupIndex) {
 
     m_mediator.m_node->StartPoW(
         curDsBlockNum + 1,
-        m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetDSDifficulty(),
-        m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetDifficulty(),
+        m_mediator.m_dsBlockChain.GetLastBlockPtr()
+            ->GetHeader()
+            .GetDSDifficulty(),
+        m_mediator.m_dsBlockChain.GetLastBlockPtr()
+            ->GetHeader()
+            .GetDifficulty(),
         dsBlockRand, txBlockRand, lookupIndex);
   } else {
     LOG_GENERAL(WARNING, "State root check failed");
@@ -2135,14 +2950,14 @@ bool Lookup::InitMining(uint32_t lookupIndex) {
   }
 
   uint64_t lastTxBlockNum =
-      m_mediator.m_txBlockChain.GetLastBlock().GetHeader().GetBlockNum();
+      m_mediator.m_txBlockChain.GetLastBlockPtr()->GetHeader().GetBlockNum();
 
   unique_lock<mutex> lk(m_mutexCVJoined);
   cv_waitJoined.wait(lk);
 
   m_startedPoW = false;
 
-  if (m_mediator.m_txBlockChain.GetLastBlock().GetHeader().GetBlockNum() >
+  if (m_mediator.m_txBlockChain.GetLastBlockPtr()->GetHeader().GetBlockNum() >
       lastTxBlockNum) {
     if (GetSyncType() != SyncType::NO_SYNC) {
       LOG_EPOCH(INFO, m_mediator.m_currentEpochNum,
@@ -2471,13 +3286,13 @@ bool Lookup::ProcessGetStartPoWFromSeed(const bytes& message,
   }
 
   if (blockNumber !=
-      m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetBlockNum()) {
+      m_mediator.m_dsBlockChain.GetLastBlockPtr()->GetHeader().GetBlockNum()) {
     LOG_EPOCH(
         WARNING, m_mediator.m_currentEpochNum,
         "DS block " << blockNumber
                     << " in GetStartPoWFromSeed not equal to current DS block "
-                    << m_mediator.m_dsBlockChain.GetLastBlock()
-                           .GetHeader()
+                    << m_mediator.m_dsBlockChain.GetLastBlockPtr()
+                           ->GetHeader()
                            .GetBlockNum());
     return false;
   }
@@ -2683,6 +3498,11 @@ bool Lookup::GetMyLookupOffline() {
     return true;
   }
 
+  // Read replicas are in no lookup list to go offline from
+  if (READ_REPLICA_MODE) {
+    return true;
+  }
+
   LOG_MARKER();
 
   {
@@ -2716,6 +3536,10 @@ bool Lookup::GetMyLookupOnline() {
     return true;
   }
 
+  if (READ_REPLICA_MODE) {
+    return true;
+  }
+
   LOG_MARKER();
   bool found = false;
   {
@@ -2787,9 +3611,50 @@ bool Lookup::FinishNewJoinAsLookup() {
     return true;
   }
 
+  if (READ_REPLICA_MODE) {
+    FollowSeeds();
+    return true;
+  }
+
   return GetMyLookupOnline();
 }
 
+void Lookup::FollowSeeds() {
+  LOG_MARKER();
+
+  if (m_followingSeeds.exchange(true)) {
+    return;
+  }
+  m_followedStateBlockNum =
+      m_mediator.m_txBlockChain.GetLastBlockPtr()->GetHeader().GetBlockNum();
+  LOG_GENERAL(INFO, "Read replica following the seeds from tx block "
+                        << m_followedStateBlockNum);
+
+  auto func = [this]() -> void {
+    while (true) {
+      const uint64_t lastBlockNum = m_mediator.m_txBlockChain.GetLastBlockPtr()
+                                        ->GetHeader()
+                                        .GetBlockNum();
+
+      // Deltas only apply in block order, so they are asked for one at a time
+      if (m_followedStateBlockNum < lastBlockNum) {
+        unique_lock<mutex> lock(m_MutexCVSetStateDeltaFromSeed);
+        GetStateDeltaFromSeedNodes(m_followedStateBlockNum + 1);
+        cv_setStateDeltaFromSeed.wait_for(
+            lock, chrono::seconds(READ_REPLICA_POLL_INTERVAL_IN_SEC));
+        continue;
+      }
+
+      ComposeAndSendGetDirectoryBlocksFromSeed(
+          m_mediator.m_blocklinkchain.GetLatestIndex() + 1);
+      GetTxBlockFromSeedNodes(m_mediator.m_txBlockChain.GetBlockCount(), 0);
+      this_thread::sleep_for(
+          chrono::seconds(READ_REPLICA_POLL_INTERVAL_IN_SEC));
+    }
+  };
+  DetachedFunction(1, func);
+}
+
 bool Lookup::CleanVariables() {
   if (!LOOKUP_NODE_MODE) {
     LOG_GENERAL(WARNING,
@@ -2805,12 +3670,18 @@ bool Lookup::CleanVariables() {
   {
     std::lock_guard<mutex> lock(m_mediator.m_ds->m_mutexShards);
     m_mediator.m_ds->m_shards.clear();
+    m_mediator.m_ds->PublishShards();
   }
   {
     std::lock_guard<mutex> lock(m_mutexNodesInNetwork);
     m_nodesInNetwork.clear();
     l_nodesInNetwork.clear();
   }
+  {
+    std::lock_guard<mutex> lock(m_mutexSeedResponses);
+    m_seedResponses.clear();
+    m_seedResponseOrder.clear();
+  }
 
   return true;
 }
@@ -2828,6 +3699,8 @@ bool Lookup::ToBlockMessage(unsigned char ins_byte) {
           ins_byte != LookupInstructionType::SETDSINFOFROMSEED &&
           ins_byte != LookupInstructionType::SETTXBLOCKFROMSEED &&
           ins_byte != LookupInstructionType::SETSTATEFROMSEED &&
+          ins_byte != LookupInstructionType::SETSTATESNAPSHOTFROMSEED &&
+          ins_byte != LookupInstructionType::SETSTATECHUNKFROMSEED &&
           ins_byte != LookupInstructionType::SETLOOKUPOFFLINE &&
           ins_byte != LookupInstructionType::SETLOOKUPONLINE &&
           ins_byte != LookupInstructionType::SETSTATEDELTAFROMSEED &&
@@ -2981,7 +3854,7 @@ bool Lookup::ProcessSetDirectoryBlocksFromSeed(
   deque<pair<PubKey, Peer>> newDScomm;
 
   uint64_t dsblocknumbefore =
-      m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetBlockNum();
+      m_mediator.m_dsBlockChain.GetLastBlockPtr()->GetHeader().GetBlockNum();
   LOG_GENERAL(INFO, "[DSINFOVERIF]"
                         << "Recvd " << dirBlocks.size() << " from lookup");
   {
@@ -3002,7 +3875,7 @@ bool Lookup::ProcessSetDirectoryBlocksFromSeed(
     m_mediator.m_blocklinkchain.SetBuiltDSComm(newDScomm);
   }
   uint64_t dsblocknumafter =
-      m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetBlockNum();
+      m_mediator.m_dsBlockChain.GetLastBlockPtr()->GetHeader().GetBlockNum();
 
   if (dsblocknumafter > dsblocknumbefore) {
     if (m_syncType == SyncType::NO_SYNC &&
@@ -3033,32 +3906,7 @@ bool Lookup::ProcessSetDirectoryBlocksFromSeed(
 void Lookup::CheckBufferTxBlocks() {
   unique_lock<mutex> lock(m_mutexSetTxBlockFromSeed);
 
-  if (!m_txBlockBuffer.empty()) {
-    ValidatorBase::TxBlockValidationMsg res =
-        m_mediator.m_validator->CheckTxBlocks(
-            m_txBlockBuffer, m_mediator.m_blocklinkchain.GetBuiltDSComm(),
-            m_mediator.m_blocklinkchain.GetLatestBlockLink());
-
-    switch (res) {
-      case ValidatorBase::TxBlockValidationMsg::VALID:
-        CommitTxBlocks(m_txBlockBuffer);
-        m_txBlockBuffer.clear();
-        break;
-      case ValidatorBase::TxBlockValidationMsg::STALEDSINFO:
-        LOG_GENERAL(
-            WARNING,
-            "Even after the recving latest ds info, the information is stale ");
-        break;
-      case ValidatorBase::TxBlockValidationMsg::INVALID:
-        LOG_GENERAL(WARNING, "The blocks in buffer are invalid ");
-        m_txBlockBuffer.clear();
-        break;
-      default:
-        LOG_GENERAL(WARNING,
-                    "The return value of ValidatorBase::CheckTxBlocks does not "
-                    "match any type");
-    }
-  }
+  ProcessTxBlockBuffer();
 }
 
 void Lookup::ComposeAndSendGetDirectoryBlocksFromSeed(const uint64_t& index_num,
@@ -3119,7 +3967,11 @@ bool Lookup::Execute(const bytes& message, unsigned int offset,
       &Lookup::ProcessVCGetLatestDSTxBlockFromSeed,
       &Lookup::ProcessForwardTxn,
       &Lookup::ProcessGetDSGuardNetworkInfo,
-      &Lookup::ProcessSetHistoricalDB};
+      &Lookup::ProcessSetHistoricalDB,
+      &Lookup::ProcessGetStateSnapshotFromSeed,
+      &Lookup::ProcessSetStateSnapshotFromSeed,
+      &Lookup::ProcessGetStateChunkFromSeed,
+      &Lookup::ProcessSetStateChunkFromSeed};
 
   const unsigned char ins_byte = message.at(offset);
   const unsigned int ins_handlers_count =
@@ -3132,6 +3984,11 @@ bool Lookup::Execute(const bytes& message, unsigned int offset,
     }
   }
 
+  unsigned char requestType = 0;
+  if (GetSyncRequestType(ins_byte, requestType)) {
+    m_syncRequests.OnResponse(requestType, from.GetIpAddress());
+  }
+
   if (ins_byte < ins_handlers_count) {
     result = (this->*ins_handlers[ins_byte])(message, offset + 1, from);
     if (!result) {
@@ -3149,6 +4006,13 @@ bool Lookup::Execute(const bytes& message, unsigned int offset,
 
 bool Lookup::AlreadyJoinedNetwork() { return m_syncType == SyncType::NO_SYNC; }
 
+bool Lookup::IsTxnRecentlyCommitted(const TxnHash& txnHash) const {
+  if (!RollingBloomFilter::GetCommittedTxnFilter().MayContain(txnHash)) {
+    return false;
+  }
+  return BlockStorage::GetBlockStorage().HasTxBody(txnHash);
+}
+
 bool Lookup::AddToTxnShardMap(const Transaction& tx, uint32_t shardId) {
   if (!LOOKUP_NODE_MODE) {
     LOG_GENERAL(WARNING,
@@ -3157,9 +4021,21 @@ bool Lookup::AddToTxnShardMap(const Transaction& tx, uint32_t shardId) {
     return true;
   }
 
-  lock_guard<mutex> g(m_txnShardMapMutex);
+  m_txnShardMap.Add(shardId, tx);
+
+  return true;
+}
+
+bool Lookup::AddToTxnShardMap(
+    const vector<pair<Transaction, uint32_t>>& txns) {
+  if (!LOOKUP_NODE_MODE) {
+    LOG_GENERAL(WARNING,
+                "Lookup::AddToTxnShardMap not expected to be called from "
+                "other than the LookUp node.");
+    return true;
+  }
 
-  m_txnShardMap[shardId].push_back(tx);
+  m_txnShardMap.Add(txns);
 
   return true;
 }
@@ -3172,10 +4048,44 @@ bool Lookup::DeleteTxnShardMap(uint32_t shardId) {
     return true;
   }
 
-  lock_guard<mutex> g(m_txnShardMapMutex);
+  m_txnShardMap.Clear(shardId);
+
+  return true;
+}
+
+void Lookup::AddForwardedTxns(const vector<Transaction>& txns) {
+  if (txns.empty()) {
+    return;
+  }
+
+  lock_guard<mutex> g(m_mutexForwardedTxns);
 
-  m_txnShardMap[shardId].clear();
+  const uint64_t epochNum = m_mediator.m_currentEpochNum;
+  auto& epochTxns = m_forwardedTxnsByEpoch[epochNum];
+  for (const auto& txn : txns) {
+    if (m_forwardedTxns.emplace(txn.GetTranID(), txn).second) {
+      epochTxns.emplace_back(txn.GetTranID());
+    }
+  }
 
+  while (!m_forwardedTxnsByEpoch.empty() &&
+         m_forwardedTxnsByEpoch.begin()->first + FORWARDED_TXNS_EPOCHS <
+             epochNum) {
+    for (const auto& txnHash : m_forwardedTxnsByEpoch.begin()->second) {
+      m_forwardedTxns.erase(txnHash);
+    }
+    m_forwardedTxnsByEpoch.erase(m_forwardedTxnsByEpoch.begin());
+  }
+}
+
+bool Lookup::FindForwardedTxn(const TxnHash& txnHash, Transaction& txn) {
+  lock_guard<mutex> g(m_mutexForwardedTxns);
+
+  const auto it = m_forwardedTxns.find(txnHash);
+  if (it == m_forwardedTxns.end()) {
+    return false;
+  }
+  txn = it->second;
   return true;
 }
 
@@ -3199,10 +4109,7 @@ void Lookup::SenderTxnBatchThread() {
     uint32_t numShards = 0;
     while (true) {
       if (!m_mediator.GetIsVacuousEpoch()) {
-        {
-          lock_guard<mutex> g(m_mediator.m_ds->m_mutexShards);
-          numShards = m_mediator.m_ds->m_shards.size();
-        }
+        numShards = m_mediator.m_ds->GetShardsSnapshot()->size();
         if (numShards == 0) {
           this_thread::sleep_for(chrono::milliseconds(1000));
           continue;
@@ -3227,8 +4134,15 @@ void Lookup::SendTxnPacketToNodes(uint32_t numShards) {
   }
 
   map<uint32_t, vector<Transaction>> mp;
+  map<uint32_t, vector<TxnCorpus::Slice>> slices;
 
-  if (!GenTxnToSend(NUM_TXN_TO_SEND_PER_ACCOUNT, mp, numShards)) {
+  // Txns forwarded by hash only are kept decoded until their microblock
+  // comes back, so they cannot stay in the corpus
+  if (m_txnCorpus.IsOpen() && !MBNFORWARD_TXN_HASHES_ONLY) {
+    if (!GenTxnToSend(NUM_TXN_TO_SEND_PER_ACCOUNT, slices, numShards)) {
+      LOG_GENERAL(WARNING, "GenTxnToSend failed");
+    }
+  } else if (!GenTxnToSend(NUM_TXN_TO_SEND_PER_ACCOUNT, mp, numShards)) {
     LOG_GENERAL(WARNING, "GenTxnToSend failed");
     // return;
   }
@@ -3236,102 +4150,152 @@ void Lookup::SendTxnPacketToNodes(uint32_t numShards) {
   this_thread::sleep_for(
       chrono::milliseconds(LOOKUP_DELAY_SEND_TXNPACKET_IN_MS));
 
-  for (unsigned int i = 0; i < numShards + 1; i++) {
-    bytes msg = {MessageType::NODE, NodeInstructionType::FORWARDTXNPACKET};
-    bool result = false;
-
-    {
-      lock_guard<mutex> g(m_txnShardMapMutex);
-      auto transactionNumber = mp[i].size();
-
-      LOG_GENERAL(INFO, "Transaction number generated: " << transactionNumber);
+  // Shards collect txns until TX_DISTRIBUTE_TIME_IN_MS after the final block;
+  // streaming stops the send delay before that, so the last batch arrives
+  const auto streamEnd =
+      chrono::steady_clock::now() +
+      chrono::milliseconds(
+          TX_DISTRIBUTE_TIME_IN_MS > 2 * LOOKUP_DELAY_SEND_TXNPACKET_IN_MS
+              ? TX_DISTRIBUTE_TIME_IN_MS - 2 * LOOKUP_DELAY_SEND_TXNPACKET_IN_MS
+              : 0);
 
-      if (m_txnShardMap[i].empty() && mp[i].empty()) {
-        LOG_GENERAL(INFO, "No txns to send to shard " << i);
-        continue;
-      }
+  for (unsigned int i = 0; i < numShards + 1; i++) {
+    vector<Transaction> txns;
+    TakeTxnsFromShardMap(i, 0, txns);
 
-      result = Messenger::SetNodeForwardTxnBlock(
-          msg, MessageOffset::BODY, m_mediator.m_currentEpochNum,
-          m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetBlockNum(), i,
-          m_mediator.m_selfKey, m_txnShardMap[i], mp[i]);
+    size_t numGenerated = mp[i].size();
+    for (const auto& slice : slices[i]) {
+      numGenerated += slice.m_txnSizes.size();
     }
+    LOG_GENERAL(INFO, "Transaction number generated: " << numGenerated);
 
-    if (!result) {
-      LOG_EPOCH(WARNING, m_mediator.m_currentEpochNum,
-                "Messenger::SetNodeForwardTxnBlock failed.");
-      LOG_GENERAL(WARNING, "Cannot create packet for " << i << " shard");
+    if (txns.empty() && numGenerated == 0) {
+      LOG_GENERAL(INFO, "No txns to send to shard " << i);
       continue;
     }
-    vector<Peer> toSend;
-    if (i < numShards) {
-      {
-        lock_guard<mutex> g(m_mediator.m_ds->m_mutexShards);
-        uint16_t lastBlockHash = DataConversion::charArrTo16Bits(
-            m_mediator.m_txBlockChain.GetLastBlock().GetBlockHash().asBytes());
-        uint32_t leader_id =
-            lastBlockHash % m_mediator.m_ds->m_shards.at(i).size();
-        LOG_GENERAL(INFO, "Shard leader id " << leader_id);
-
-        auto it = m_mediator.m_ds->m_shards.at(i).begin();
-        // Lookup sends to NUM_NODES_TO_SEND_LOOKUP + Leader
-        unsigned int num_node_to_send = NUM_NODES_TO_SEND_LOOKUP;
-        for (unsigned int j = 0; j < num_node_to_send &&
-                                 it != m_mediator.m_ds->m_shards.at(i).end();
-             j++, it++) {
-          if (distance(m_mediator.m_ds->m_shards.at(i).begin(), it) ==
-              leader_id) {
-            num_node_to_send++;
-          } else {
-            toSend.push_back(std::get<SHARD_NODE_PEER>(*it));
-            LOG_GENERAL(INFO, "Sent to node " << get<SHARD_NODE_PEER>(*it));
-          }
-        }
-        if (m_mediator.m_ds->m_shards.at(i).empty()) {
-          continue;
-        }
+
+    SendTxnPacketToShard(i, numShards, txns, mp[i], slices[i]);
+  }
+
+  if (LOOKUP_TXN_STREAM_INTERVAL_IN_MS == 0) {
+    return;
+  }
+
+  const auto interval = chrono::milliseconds(LOOKUP_TXN_STREAM_INTERVAL_IN_MS);
+  while (chrono::steady_clock::now() + interval <= streamEnd) {
+    this_thread::sleep_for(interval);
+
+    for (unsigned int i = 0; i < numShards + 1; i++) {
+      vector<Transaction> txns;
+      TakeTxnsFromShardMap(i, LOOKUP_TXN_STREAM_BATCH_SIZE, txns);
+      if (!txns.empty()) {
+        LOG_GENERAL(INFO, "Streaming " << txns.size() << " txns to shard "
+                                       << i);
+        SendTxnPacketToShard(i, numShards, txns, {});
       }
+    }
+  }
+}
 
-      P2PComm::GetInstance().SendBroadcastMessage(toSend, msg);
+void Lookup::TakeTxnsFromShardMap(uint32_t shardId, size_t maxTxns,
+                                  vector<Transaction>& txns) {
+  txns = m_txnShardMap.Take(shardId, maxTxns);
+}
 
-      DeleteTxnShardMap(i);
-    } else if (i == numShards) {
-      // To send DS
-      {
-        lock_guard<mutex> g(m_mediator.m_mutexDSCommittee);
+void Lookup::SendTxnPacketToShard(uint32_t shardId, uint32_t numShards,
+                                  const vector<Transaction>& txns,
+                                  const vector<Transaction>& genTxns,
+                                  const vector<TxnCorpus::Slice>& genSlices) {
+  bytes msg = {MessageType::NODE, NodeInstructionType::FORWARDTXNPACKET};
+
+  const uint64_t dsBlockNum =
+      m_mediator.m_dsBlockChain.GetLastBlockPtr()->GetHeader().GetBlockNum();
+
+  // Generated txns come either decoded or as corpus slices, never both
+  const bool packed =
+      genSlices.empty()
+          ? Messenger::SetNodeForwardTxnBlock(
+                msg, MessageOffset::BODY, m_mediator.m_currentEpochNum,
+                dsBlockNum, shardId, m_mediator.m_selfKey, txns, genTxns)
+          : Messenger::SetNodeForwardTxnBlock(
+                msg, MessageOffset::BODY, m_mediator.m_currentEpochNum,
+                dsBlockNum, shardId, m_mediator.m_selfKey, txns, genSlices);
+  if (!packed) {
+    LOG_EPOCH(WARNING, m_mediator.m_currentEpochNum,
+              "Messenger::SetNodeForwardTxnBlock failed.");
+    LOG_GENERAL(WARNING, "Cannot create packet for " << shardId << " shard");
+    return;
+  }
 
-        if (m_mediator.m_DSCommittee->empty()) {
-          continue;
-        }
+  if (MBNFORWARD_TXN_HASHES_ONLY) {
+    AddForwardedTxns(txns);
+    AddForwardedTxns(genTxns);
+  }
+
+  vector<Peer> toSend;
+  if (shardId < numShards) {
+    {
+      const auto shards = m_mediator.m_ds->GetShardsSnapshot();
+      if (shardId >= shards->size() || shards->at(shardId).empty()) {
+        return;
+      }
 
-        // Send to NUM_NODES_TO_SEND_LOOKUP which including DS leader
-        pair<PubKey, Peer> dsLeader;
-        if (Node::GetDSLeader(m_mediator.m_blocklinkchain.GetLatestBlockLink(),
-                              m_mediator.m_dsBlockChain.GetLastBlock(),
-                              *m_mediator.m_DSCommittee,
-                              m_mediator.m_currentEpochNum, dsLeader)) {
-          toSend.push_back(dsLeader.second);
+      const auto& shard = shards->at(shardId);
+      uint16_t lastBlockHash = DataConversion::charArrTo16Bits(
+          m_mediator.m_txBlockChain.GetLastBlockPtr()
+              ->GetBlockHash().asBytes());
+      uint32_t leader_id = lastBlockHash % shard.size();
+      LOG_GENERAL(INFO, "Shard leader id " << leader_id);
+
+      auto it = shard.begin();
+      // Lookup sends to NUM_NODES_TO_SEND_LOOKUP + Leader
+      unsigned int num_node_to_send = NUM_NODES_TO_SEND_LOOKUP;
+      for (unsigned int j = 0; j < num_node_to_send && it != shard.end();
+           j++, it++) {
+        if (distance(shard.begin(), it) == leader_id) {
+          num_node_to_send++;
+        } else {
+          toSend.push_back(std::get<SHARD_NODE_PEER>(*it));
+          LOG_GENERAL(INFO, "Sent to node " << get<SHARD_NODE_PEER>(*it));
         }
+      }
+    }
 
-        for (auto const& i : *m_mediator.m_DSCommittee) {
-          if (toSend.size() < NUM_NODES_TO_SEND_LOOKUP &&
-              i.second != dsLeader.second) {
-            toSend.push_back(i.second);
-          }
+    P2PComm::GetInstance().SendBroadcastMessage(toSend, msg);
+  } else if (shardId == numShards) {
+    // To send DS
+    {
+      const auto dsCommittee = m_mediator.GetDSCommitteeSnapshot();
 
-          if (toSend.size() >= NUM_NODES_TO_SEND_LOOKUP) {
-            break;
-          }
-        }
+      if (dsCommittee->empty()) {
+        return;
       }
 
-      P2PComm::GetInstance().SendBroadcastMessage(toSend, msg);
+      // Send to NUM_NODES_TO_SEND_LOOKUP which including DS leader
+      pair<PubKey, Peer> dsLeader;
+      if (Node::GetDSLeader(m_mediator.m_blocklinkchain.GetLatestBlockLink(),
+                            m_mediator.m_dsBlockChain.GetLastBlock(),
+                            *dsCommittee, m_mediator.m_currentEpochNum,
+                            dsLeader)) {
+        toSend.push_back(dsLeader.second);
+      }
 
-      LOG_GENERAL(INFO, "[DSMB]"
-                            << " Sent DS the txns");
+      for (auto const& i : *dsCommittee) {
+        if (toSend.size() < NUM_NODES_TO_SEND_LOOKUP &&
+            i.second != dsLeader.second) {
+          toSend.push_back(i.second);
+        }
 
-      DeleteTxnShardMap(i);
+        if (toSend.size() >= NUM_NODES_TO_SEND_LOOKUP) {
+          break;
+        }
+      }
     }
+
+    P2PComm::GetInstance().SendBroadcastMessage(toSend, msg);
+
+    LOG_GENERAL(INFO, "[DSMB]"
+                          << " Sent DS the txns");
   }
 }
 
@@ -3384,12 +4348,23 @@ bool Lookup::ProcessForwardTxn(const bytes& message, unsigned int offset,
 
   LOG_GENERAL(INFO, "Recvd from " << from);
 
-  if (!ARCHIVAL_LOOKUP) {
-    uint32_t shard_size = 0;
-    {
-      lock_guard<mutex> g(m_mediator.m_ds->m_mutexShards);
-      shard_size = m_mediator.m_ds->m_shards.size();
+  // Only forward transactions that are correctly signed
+  vector<bool> signatureValid;
+  if (!m_mediator.m_validator->VerifyTransactions(txns, signatureValid)) {
+    vector<Transaction> verifiedTxns;
+    for (unsigned int i = 0; i < txns.size(); i++) {
+      if (signatureValid.at(i)) {
+        verifiedTxns.emplace_back(move(txns.at(i)));
+      } else {
+        LOG_GENERAL(WARNING, "Signature incorrect. Transaction rejected: "
+                                 << txns.at(i).GetTranID());
+      }
     }
+    txns = move(verifiedTxns);
+  }
+
+  if (!ARCHIVAL_LOOKUP) {
+    uint32_t shard_size = m_mediator.m_ds->GetShardsSnapshot()->size();
 
     if (shard_size == 0) {
       LOG_GENERAL(WARNING, "Shard size 0");
@@ -3397,10 +4372,7 @@ bool Lookup::ProcessForwardTxn(const bytes& message, unsigned int offset,
     }
 
     for (const auto& txn : txns) {
-      const PubKey& senderPubKey = txn.GetSenderPubKey();
-      const Address fromAddr = Account::GetAddressFromPublicKey(senderPubKey);
-      unsigned int shard = Transaction::GetShardIndex(fromAddr, shard_size);
-      AddToTxnShardMap(txn, shard);
+      AddToTxnShardMap(txn, txn.GetSenderShardIndex(shard_size));
     }
   } else {
     for (const auto& txn : txns) {
@@ -22,12 +22,19 @@
 #include <chrono>
 #include <condition_variable>
 #include <cstdlib>
+#include <deque>
 #include <map>
+#include <memory>
 #include <mutex>
+#include <tuple>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
+#include "SyncRequestTracker.h"
+#include "TxnShardBuffer.h"
 #include "common/Broadcastable.h"
+#include "common/Constants.h"
 #include "common/Executable.h"
 #include "libCrypto/Schnorr.h"
 #include "libData/AccountData/Transaction.h"
@@ -38,6 +45,7 @@
 #include "libNetwork/ShardStruct.h"
 #include "libUtils/IPConverter.h"
 #include "libUtils/Logger.h"
+#include "libUtils/TxnCorpus.h"
 
 #include <condition_variable>
 #include <map>
@@ -76,6 +84,16 @@ class Lookup : public Executable, public Broadcastable {
 
   std::atomic<bool> m_startedTxnBatchThread;
 
+  // Bodies of the txns sent to the shards in the last few epochs, used to
+  // rebuild the microblocks forwarded back with txn hashes only
+  const static unsigned int FORWARDED_TXNS_EPOCHS = 10;
+  std::mutex m_mutexForwardedTxns;
+  std::unordered_map<TxnHash, Transaction> m_forwardedTxns;
+  std::map<uint64_t, std::vector<TxnHash>> m_forwardedTxnsByEpoch;
+
+  // Pre-signed txns mapped from TXN_CORPUS_FILE
+  TxnCorpus m_txnCorpus;
+
   // Start PoW variables
   bool m_receivedRaiseStartPoW = false;
   std::mutex m_MutexCVStartPoWSubmission;
@@ -84,6 +102,46 @@ class Lookup : public Executable, public Broadcastable {
   /// To indicate which type of synchronization is using
   SyncType m_syncType = SyncType::NO_SYNC;
 
+  // State snapshot kept to serve chunk requests from syncing nodes
+  dev::h256 m_snapshotStateRoot;
+  uint64_t m_snapshotBlockNum = 0;
+  std::vector<bytes> m_snapshotChunks;
+  std::vector<dev::h256> m_snapshotChunkHashes;
+  std::mutex m_mutexStateSnapshot;
+
+  // Serialized block and state delta responses, so that identical requests
+  // from many syncing nodes are answered without re-reading and
+  // re-serializing the blocks. The key holds the response type, the range as
+  // requested, and the DS and tx block tips it was built against.
+  typedef std::tuple<unsigned char, uint64_t, uint64_t, uint64_t, uint64_t>
+      SeedResponseKey;
+  std::map<SeedResponseKey, std::shared_ptr<const bytes>> m_seedResponses;
+  std::deque<SeedResponseKey> m_seedResponseOrder;
+  std::mutex m_mutexSeedResponses;
+
+  SeedResponseKey GetSeedResponseKey(unsigned char type, uint64_t low,
+                                     uint64_t high);
+  std::shared_ptr<const bytes> GetSeedResponse(const SeedResponseKey& key);
+  void AddSeedResponse(const SeedResponseKey& key,
+                       const std::shared_ptr<const bytes>& response);
+
+  // Progress of the chunked state download while joining
+  dev::h256 m_stateSyncRoot;
+  std::vector<dev::h256> m_stateSyncChunkHashes;
+  std::vector<bool> m_stateSyncReceived;
+  uint32_t m_stateSyncNumReceived = 0;
+  std::mutex m_mutexStateSync;
+
+  // Requests sent while syncing and the latency of the nodes answering them
+  mutable SyncRequestTracker m_syncRequests{
+      SYNC_REQUEST_MAX_TARGETS, SYNC_REQUEST_TIMEOUT_IN_MS,
+      SYNC_REQUEST_HEDGE_PERCENTILE, SYNC_REQUEST_HEDGE_MAX_DELAY_IN_MS};
+
+  /// Sends a request to one of nodes, picked by recent latency. A request
+  /// already waiting for its response is not sent again, and one that is not
+  /// answered in time also goes to another node.
+  void SendSyncRequest(const bytes& message, const VectorOfNode& nodes) const;
+
   void SetAboveLayer();
 
   /// Post processing after the DS node successfully synchronized with the
@@ -114,8 +172,39 @@ class Lookup : public Executable, public Broadcastable {
   // TxBlockBuffer
   std::vector<TxBlock> m_txBlockBuffer;
 
+  /// Commits the buffered tx blocks that the verified directory blocks
+  /// already cover, and asks for more directory blocks if some are left.
+  /// Called with m_mutexSetTxBlockFromSeed held.
+  void ProcessTxBlockBuffer();
+
+  // Tx blocks fetched in windows from several seeds, keyed by the first
+  // block number, waiting for the windows before them to arrive
+  std::map<uint64_t, std::vector<TxBlock>> m_txBlockWindows;
+  // Highest tx block number reported by any seed
+  std::atomic<uint64_t> m_txBlockSyncTarget{0};
+  std::atomic<bool> m_txBlockWindowsRequested{false};
+
+  // Set once a read replica has caught up and polls the seeds from then on
+  std::atomic<bool> m_followingSeeds{false};
+  // Last tx block whose state delta a following replica has applied
+  std::atomic<uint64_t> m_followedStateBlockNum{0};
+
+  /// Keeps a read replica's chain and state current by polling the seeds
+  void FollowSeeds();
+
+  /// Splits [lowBlockNum, latest] over the seed nodes, one window each
+  void GetTxBlockWindowsFromSeedNodes(uint64_t lowBlockNum);
+
   bytes ComposeGetDSInfoMessage(bool initialDS = false);
   bytes ComposeGetStateMessage();
+  bytes ComposeGetStateSnapshotMessage();
+
+  /// Asks the seed nodes, in turn, for every state chunk not received yet
+  void RequestMissingStateChunks();
+
+  /// Carries on with joining once the state has been loaded. Called with
+  /// m_mutexSetState held.
+  bool ContinueAfterSetState();
 
   bytes ComposeGetDSBlockMessage(uint64_t lowBlockNum, uint64_t highBlockNum);
   bytes ComposeGetTxBlockMessage(uint64_t lowBlockNum, uint64_t highBlockNum);
@@ -153,8 +242,7 @@ class Lookup : public Executable, public Broadcastable {
   // Getter for m_seedNodes
   VectorOfNode GetSeedNodes() const;
 
-  std::mutex m_txnShardMapMutex;
-  std::map<uint32_t, std::vector<Transaction>> m_txnShardMap;
+  TxnShardBuffer m_txnShardMap;
 
   bool IsLookupNode(const PubKey& pubKey) const;
 
@@ -165,6 +253,14 @@ class Lookup : public Executable, public Broadcastable {
                     std::map<uint32_t, std::vector<Transaction>>& mp,
                     uint32_t numShards);
   bool GenTxnToSend(size_t num_txn, std::vector<Transaction>& txn);
+  /// Same as above, with the txns left serialized in the txn corpus
+  bool GenTxnToSend(size_t num_txn,
+                    std::map<uint32_t, std::vector<TxnCorpus::Slice>>& mp,
+                    uint32_t numShards);
+  /// Gets up to num_txn pre-signed txns of addr, starting from the nonce,
+  /// from the txn corpus if there is one and from TXN_PATH otherwise
+  bool GetGeneratedTxns(const Address& addr, uint64_t nonce, size_t num_txn,
+                        std::vector<Transaction>& txns) const;
 
   // Try resolving ip from the given peer's DNS
   boost::multiprecision::uint128_t TryGettingResolvedIP(const Peer& peer) const;
@@ -211,7 +307,8 @@ class Lookup : public Executable, public Broadcastable {
 
   bool SetDSCommitteInfo();
 
-  DequeOfShard GetShardPeers();
+  /// Returns the current sharding structure without waiting on the DS lock.
+  std::shared_ptr<const DequeOfShard> GetShardPeers();
   std::vector<Peer> GetNodePeers();
 
   // Start synchronization with other lookup nodes as a lookup node
@@ -226,12 +323,24 @@ class Lookup : public Executable, public Broadcastable {
   // Rejoin the network as a lookup node in case of failure happens in protocol
   void RejoinAsLookup();
 
+  /// Returns true if the txn is known to be committed. Only txns committed
+  /// in the epochs kept by the committed txn filter are found, and the txn
+  /// body db is read only when the filter has a hit.
+  bool IsTxnRecentlyCommitted(const TxnHash& txnHash) const;
+
   bool AddToTxnShardMap(const Transaction& tx, uint32_t shardId);
+  /// Adds (txn, shard) pairs under a single lock of the txn shard map
+  bool AddToTxnShardMap(
+      const std::vector<std::pair<Transaction, uint32_t>>& txns);
 
   void CheckBufferTxBlocks();
 
   bool DeleteTxnShardMap(uint32_t shardId);
 
+  /// Keeps the bodies of txns sent to (or fetched from) the shards
+  void AddForwardedTxns(const std::vector<Transaction>& txns);
+  bool FindForwardedTxn(const TxnHash& txnHash, Transaction& txn);
+
   void SetServerTrue();
 
   bool GetIsServer();
@@ -240,6 +349,17 @@ class Lookup : public Executable, public Broadcastable {
 
   void SendTxnPacketToNodes(uint32_t);
 
+  /// Moves up to maxTxns (0 = all) of the txns pending for shardId to txns
+  void TakeTxnsFromShardMap(uint32_t shardId, size_t maxTxns,
+                            std::vector<Transaction>& txns);
+  /// Sends one FORWARDTXNPACKET to shardId, or to the DS committee when
+  /// shardId is numShards
+  void SendTxnPacketToShard(
+      uint32_t shardId, uint32_t numShards,
+      const std::vector<Transaction>& txns,
+      const std::vector<Transaction>& genTxns,
+      const std::vector<TxnCorpus::Slice>& genSlices = {});
+
   bool ProcessEntireShardingStructure();
   bool ProcessGetDSInfoFromSeed(const bytes& message, unsigned int offset,
                                 const Peer& from);
@@ -288,6 +408,14 @@ class Lookup : public Executable, public Broadcastable {
                                     const Peer& from);
   bool ProcessSetStateFromSeed(const bytes& message, unsigned int offset,
                                const Peer& from);
+  bool ProcessGetStateSnapshotFromSeed(const bytes& message,
+                                       unsigned int offset, const Peer& from);
+  bool ProcessSetStateSnapshotFromSeed(const bytes& message,
+                                       unsigned int offset, const Peer& from);
+  bool ProcessGetStateChunkFromSeed(const bytes& message, unsigned int offset,
+                                    const Peer& from);
+  bool ProcessSetStateChunkFromSeed(const bytes& message, unsigned int offset,
+                                    const Peer& from);
 
   bool ProcessSetLookupOffline(const bytes& message, unsigned int offset,
                                const Peer& from);
@@ -0,0 +1,197 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "SyncRequestTracker.h"
+
+using namespace std;
+using namespace boost::multiprecision;
+
+constexpr size_t SyncRequestTracker::NUM_LATENCY_SAMPLES;
+constexpr unsigned int SyncRequestTracker::MIN_HEDGE_DELAY_IN_MS;
+
+SyncRequestTracker::SyncRequestTracker(unsigned int maxTargets,
+                                       unsigned int timeoutInMs,
+                                       unsigned int hedgePercentile,
+                                       unsigned int maxHedgeDelayInMs)
+    : m_maxTargets(max(maxTargets, 1u)),
+      m_timeoutInMs(timeoutInMs),
+      m_hedgePercentile(min(hedgePercentile, 100u)),
+      m_maxHedgeDelayInMs(max(maxHedgeDelayInMs, MIN_HEDGE_DELAY_IN_MS)) {}
+
+void SyncRequestTracker::AddLatency(const uint128_t& peer,
+                                    unsigned int latencyInMs) {
+  auto& stats = m_peers[peer];
+  // Moving average weighted 3:1 towards the history
+  stats.m_latencyInMs = stats.m_hasLatency
+                            ? (3 * stats.m_latencyInMs + latencyInMs) / 4
+                            : latencyInMs;
+  stats.m_hasLatency = true;
+
+  m_latencies.push_back(latencyInMs);
+  if (m_latencies.size() > NUM_LATENCY_SAMPLES) {
+    m_latencies.pop_front();
+  }
+}
+
+void SyncRequestTracker::DropExpired(const Clock::time_point& now) {
+  for (auto it = m_pending.begin(); it != m_pending.end();) {
+    const auto age = now - it->second.m_targets.front().second;
+    if (age < chrono::milliseconds(m_timeoutInMs)) {
+      ++it;
+      continue;
+    }
+    for (const auto& target : it->second.m_targets) {
+      auto& stats = m_peers[target.first];
+      if (stats.m_inFlight > 0) {
+        stats.m_inFlight--;
+      }
+      AddLatency(target.first, m_timeoutInMs);
+    }
+    it = m_pending.erase(it);
+  }
+}
+
+unsigned int SyncRequestTracker::GetScore(const uint128_t& peer) {
+  const auto it = m_peers.find(peer);
+  if (it == m_peers.end()) {
+    // Nodes not heard from yet are tried first so that they get a latency
+    return 0;
+  }
+  return (it->second.m_latencyInMs + 1) * (it->second.m_inFlight + 1);
+}
+
+size_t SyncRequestTracker::Select(const vector<uint128_t>& peers) {
+  if (peers.size() <= 1) {
+    return 0;
+  }
+
+  lock_guard<mutex> g(m_mutex);
+
+  DropExpired(Clock::now());
+
+  // Comparing two random nodes instead of taking the best one keeps the
+  // syncing nodes from all piling onto the same lookup
+  const size_t first = rand() % peers.size();
+  size_t second = rand() % (peers.size() - 1);
+  if (second >= first) {
+    second++;
+  }
+  return GetScore(peers.at(second)) < GetScore(peers.at(first)) ? second
+                                                                 : first;
+}
+
+bool SyncRequestTracker::Start(unsigned char type, const bytes& request,
+                               const uint128_t& peer) {
+  lock_guard<mutex> g(m_mutex);
+
+  const auto now = Clock::now();
+  DropExpired(now);
+
+  Pending pending{type, {{peer, now}}};
+  if (!m_pending.emplace(request, move(pending)).second) {
+    return false;
+  }
+  m_peers[peer].m_inFlight++;
+  return true;
+}
+
+bool SyncRequestTracker::AddTarget(const bytes& request,
+                                   const uint128_t& peer) {
+  lock_guard<mutex> g(m_mutex);
+
+  auto it = m_pending.find(request);
+  if (it == m_pending.end() || it->second.m_targets.size() >= m_maxTargets) {
+    return false;
+  }
+  it->second.m_targets.emplace_back(peer, Clock::now());
+  m_peers[peer].m_inFlight++;
+  return true;
+}
+
+vector<uint128_t> SyncRequestTracker::GetTargets(const bytes& request) {
+  vector<uint128_t> targets;
+
+  lock_guard<mutex> g(m_mutex);
+
+  const auto it = m_pending.find(request);
+  if (it != m_pending.end()) {
+    for (const auto& target : it->second.m_targets) {
+      targets.emplace_back(target.first);
+    }
+  }
+  return targets;
+}
+
+bool SyncRequestTracker::OnResponse(unsigned char type, const uint128_t& peer) {
+  lock_guard<mutex> g(m_mutex);
+
+  auto oldest = m_pending.end();
+  Clock::time_point sent;
+  for (auto it = m_pending.begin(); it != m_pending.end(); ++it) {
+    if (it->second.m_type != type) {
+      continue;
+    }
+    for (const auto& target : it->second.m_targets) {
+      if (target.first == peer &&
+          (oldest == m_pending.end() || target.second < sent)) {
+        oldest = it;
+        sent = target.second;
+      }
+    }
+  }
+
+  if (oldest == m_pending.end()) {
+    return false;
+  }
+
+  for (const auto& target : oldest->second.m_targets) {
+    auto& stats = m_peers[target.first];
+    if (stats.m_inFlight > 0) {
+      stats.m_inFlight--;
+    }
+  }
+  m_pending.erase(oldest);
+
+  AddLatency(peer, chrono::duration_cast<chrono::milliseconds>(Clock::now() -
+                                                                sent)
+                       .count());
+  return true;
+}
+
+unsigned int SyncRequestTracker::GetHedgeDelayInMs() {
+  lock_guard<mutex> g(m_mutex);
+
+  if (m_latencies.empty()) {
+    return m_maxHedgeDelayInMs;
+  }
+
+  vector<unsigned int> latencies(m_latencies.begin(), m_latencies.end());
+  const auto nth = latencies.begin() +
+                   (latencies.size() - 1) * m_hedgePercentile / 100;
+  nth_element(latencies.begin(), nth, latencies.end());
+  return min(max(*nth, MIN_HEDGE_DELAY_IN_MS), m_maxHedgeDelayInMs);
+}
+
+void SyncRequestTracker::Clear() {
+  lock_guard<mutex> g(m_mutex);
+  m_pending.clear();
+  m_peers.clear();
+  m_latencies.clear();
+}
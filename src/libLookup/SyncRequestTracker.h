@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __SYNCREQUESTTRACKER_H__
+#define __SYNCREQUESTTRACKER_H__
+
+#include <boost/multiprecision/cpp_int.hpp>
+#include <chrono>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "common/BaseType.h"
+
+/// Requests a syncing node sends to the lookups and seeds, and how fast each
+/// of those has answered lately. Used to pick the node for a request, to
+/// hold back a request that is already waiting for its response, and to
+/// decide when to send a request that is taking too long to another node.
+class SyncRequestTracker {
+  typedef std::chrono::steady_clock Clock;
+
+  struct Pending {
+    unsigned char m_type;
+    std::vector<std::pair<boost::multiprecision::uint128_t, Clock::time_point>>
+        m_targets;
+  };
+
+  struct PeerStats {
+    unsigned int m_latencyInMs = 0;
+    bool m_hasLatency = false;
+    unsigned int m_inFlight = 0;
+  };
+
+  static constexpr size_t NUM_LATENCY_SAMPLES = 64;
+  static constexpr unsigned int MIN_HEDGE_DELAY_IN_MS = 50;
+
+  const unsigned int m_maxTargets;
+  const unsigned int m_timeoutInMs;
+  const unsigned int m_hedgePercentile;
+  const unsigned int m_maxHedgeDelayInMs;
+
+  std::map<bytes, Pending> m_pending;
+  std::map<boost::multiprecision::uint128_t, PeerStats> m_peers;
+  std::deque<unsigned int> m_latencies;
+  std::mutex m_mutex;
+
+  void AddLatency(const boost::multiprecision::uint128_t& peer,
+                  unsigned int latencyInMs);
+  /// Drops the requests not answered in time, charging the timeout to the
+  /// nodes they were sent to
+  void DropExpired(const Clock::time_point& now);
+  unsigned int GetScore(const boost::multiprecision::uint128_t& peer);
+
+ public:
+  SyncRequestTracker(unsigned int maxTargets, unsigned int timeoutInMs,
+                     unsigned int hedgePercentile,
+                     unsigned int maxHedgeDelayInMs);
+
+  unsigned int GetMaxTargets() const { return m_maxTargets; }
+
+  /// Index of the candidate to send a request to: the better of two picked
+  /// at random, scored by recent latency and requests in flight
+  size_t Select(const std::vector<boost::multiprecision::uint128_t>& peers);
+
+  /// Records request as sent to peer. Returns false, recording nothing, if
+  /// the same request is still waiting for its response.
+  bool Start(unsigned char type, const bytes& request,
+             const boost::multiprecision::uint128_t& peer);
+
+  /// Records a pending request as also sent to peer. Returns false if it
+  /// has been answered or already went to the maximum number of nodes.
+  bool AddTarget(const bytes& request,
+                 const boost::multiprecision::uint128_t& peer);
+
+  /// Nodes a request has been sent to, empty once it is answered
+  std::vector<boost::multiprecision::uint128_t> GetTargets(
+      const bytes& request);
+
+  /// Completes the oldest pending request of the type that was sent to peer.
+  /// Returns false if there is none.
+  bool OnResponse(unsigned char type,
+                  const boost::multiprecision::uint128_t& peer);
+
+  /// How long to wait for a response before asking another node, taken from
+  /// the latencies seen lately
+  unsigned int GetHedgeDelayInMs();
+
+  void Clear();
+};
+
+#endif  // __SYNCREQUESTTRACKER_H__
@@ -72,6 +72,8 @@ bool Synchronizer::AddGenesisDSBlockToBlockChain(DSBlockChain& dsBlockChain,
   dsBlock.Serialize(serializedDSBlock, 0);
   BlockStorage::GetBlockStorage().PutDSBlock(dsBlock.GetHeader().GetBlockNum(),
                                              serializedDSBlock);
+  BlockStorage::GetBlockStorage().PutBlockHash(
+      BlockType::DS, dsBlock.GetHeader().GetBlockNum(), dsBlock.GetBlockHash());
 
   return true;
 }
@@ -113,6 +115,8 @@ bool Synchronizer::AddGenesisTxBlockToBlockChain(TxBlockChain& txBlockChain,
   txBlock.Serialize(serializedTxBlock, 0);
   BlockStorage::GetBlockStorage().PutTxBlock(txBlock.GetHeader().GetBlockNum(),
                                              serializedTxBlock);
+  BlockStorage::GetBlockStorage().PutBlockHash(
+      BlockType::Tx, txBlock.GetHeader().GetBlockNum(), txBlock.GetBlockHash());
 
   return true;
 }
@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <iterator>
+
+#include "TxnShardBuffer.h"
+
+using namespace std;
+
+void TxnShardBuffer::Add(uint32_t shardId, const Transaction& txn) {
+  auto& stripe = GetStripe(shardId);
+  lock_guard<mutex> g(stripe.m_mutex);
+  stripe.m_txns[shardId].push_back(txn);
+}
+
+void TxnShardBuffer::Add(const vector<pair<Transaction, uint32_t>>& txns) {
+  array<vector<const pair<Transaction, uint32_t>*>, NUM_STRIPES> byStripe;
+  for (const auto& txn : txns) {
+    byStripe[txn.second % NUM_STRIPES].push_back(&txn);
+  }
+
+  for (size_t i = 0; i < NUM_STRIPES; i++) {
+    if (byStripe[i].empty()) {
+      continue;
+    }
+    lock_guard<mutex> g(m_stripes[i].m_mutex);
+    for (const auto* txn : byStripe[i]) {
+      m_stripes[i].m_txns[txn->second].push_back(txn->first);
+    }
+  }
+}
+
+vector<Transaction> TxnShardBuffer::Take(uint32_t shardId) {
+  vector<Transaction> txns;
+  auto& stripe = GetStripe(shardId);
+  lock_guard<mutex> g(stripe.m_mutex);
+  auto it = stripe.m_txns.find(shardId);
+  if (it != stripe.m_txns.end()) {
+    txns.swap(it->second);
+  }
+  return txns;
+}
+
+vector<Transaction> TxnShardBuffer::Take(uint32_t shardId, size_t maxTxns) {
+  if (maxTxns == 0) {
+    return Take(shardId);
+  }
+
+  vector<Transaction> txns;
+  auto& stripe = GetStripe(shardId);
+  lock_guard<mutex> g(stripe.m_mutex);
+  auto it = stripe.m_txns.find(shardId);
+  if (it == stripe.m_txns.end()) {
+    return txns;
+  }
+
+  auto& pending = it->second;
+  if (pending.size() <= maxTxns) {
+    txns.swap(pending);
+    return txns;
+  }
+
+  txns.assign(make_move_iterator(pending.begin()),
+              make_move_iterator(pending.begin() + maxTxns));
+  pending.erase(pending.begin(), pending.begin() + maxTxns);
+  return txns;
+}
+
+void TxnShardBuffer::Clear(uint32_t shardId) {
+  auto& stripe = GetStripe(shardId);
+  lock_guard<mutex> g(stripe.m_mutex);
+  stripe.m_txns.erase(shardId);
+}
+
+size_t TxnShardBuffer::Size(uint32_t shardId) {
+  auto& stripe = GetStripe(shardId);
+  lock_guard<mutex> g(stripe.m_mutex);
+  auto it = stripe.m_txns.find(shardId);
+  return it == stripe.m_txns.end() ? 0 : it->second.size();
+}
+
+MemoryUsage TxnShardBuffer::GetMemoryUsage() {
+  MemoryUsage usage;
+  for (auto& stripe : m_stripes) {
+    lock_guard<mutex> g(stripe.m_mutex);
+    usage.m_bytes += MemoryStats::HashContainerBytes(stripe.m_txns);
+    for (const auto& shard : stripe.m_txns) {
+      usage.m_objects += shard.second.size();
+      usage.m_bytes += shard.second.capacity() * sizeof(Transaction);
+      for (const auto& txn : shard.second) {
+        usage.m_bytes += sizeof(PubKey) + txn.GetCode().size() +
+                         txn.GetData().size();
+      }
+    }
+  }
+  return usage;
+}
@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __TXNSHARDBUFFER_H__
+#define __TXNSHARDBUFFER_H__
+
+#include <array>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "libData/AccountData/Transaction.h"
+#include "libUtils/MemoryStats.h"
+
+/// Txns a lookup holds for each shard until they are sent. The shards are
+/// spread over lock stripes, so RPC threads adding txns to one shard do not
+/// wait on a packet being composed for another, and a shard's buffer is
+/// taken by swapping it out.
+class TxnShardBuffer {
+  static constexpr size_t NUM_STRIPES = 16;
+
+  struct Stripe {
+    std::mutex m_mutex;
+    std::unordered_map<uint32_t, std::vector<Transaction>> m_txns;
+  };
+
+  std::array<Stripe, NUM_STRIPES> m_stripes;
+
+  Stripe& GetStripe(uint32_t shardId) {
+    return m_stripes[shardId % NUM_STRIPES];
+  }
+
+ public:
+  void Add(uint32_t shardId, const Transaction& txn);
+
+  /// Adds (txn, shard) pairs, locking each stripe once
+  void Add(const std::vector<std::pair<Transaction, uint32_t>>& txns);
+
+  /// Returns the whole buffer of shardId and leaves it empty
+  std::vector<Transaction> Take(uint32_t shardId);
+
+  /// Returns the oldest maxTxns (0 = all) txns of shardId
+  std::vector<Transaction> Take(uint32_t shardId, size_t maxTxns);
+
+  void Clear(uint32_t shardId);
+
+  size_t Size(uint32_t shardId);
+
+  /// Estimated memory held by the txns of all shards
+  MemoryUsage GetMemoryUsage();
+};
+
+#endif  // __TXNSHARDBUFFER_H__
@@ -23,6 +23,7 @@
 #include "libServer/GetWorkServer.h"
 #include "libUtils/DataConversion.h"
 #include "libUtils/DetachedFunction.h"
+#include "libUtils/EpochMetrics.h"
 #include "libUtils/ShardSizeCalculator.h"
 #include "libValidator/Validator.h"
 
@@ -99,10 +100,10 @@ void Mediator::UpdateTxBlockRand(bool isGenesis) {
 }
 
 std::string Mediator::GetNodeMode(const Peer& peer) {
-  std::lock_guard<mutex> lock(m_mutexDSCommittee);
+  const auto dsCommittee = GetDSCommitteeSnapshot();
   bool bFound = false;
 
-  for (auto const& i : *m_DSCommittee) {
+  for (auto const& i : *dsCommittee) {
     if (i.second == peer) {
       bFound = true;
       break;
@@ -110,7 +111,7 @@ std::string Mediator::GetNodeMode(const Peer& peer) {
   }
 
   if (bFound) {
-    if (peer == (*m_DSCommittee)[0].second) {
+    if (peer == (*dsCommittee)[0].second) {
       return "DSLD";
     } else {
       return "DSBU";
@@ -120,9 +121,42 @@ std::string Mediator::GetNodeMode(const Peer& peer) {
   }
 }
 
+TimelineRole Mediator::GetTimelineRole() const {
+  if (LOOKUP_NODE_MODE) {
+    return TIMELINE_ROLE_LOOKUP;
+  }
+  if ((m_ds != nullptr) && (m_ds->m_mode != DirectoryService::IDLE)) {
+    return TIMELINE_ROLE_DS;
+  }
+  return TIMELINE_ROLE_SHARD;
+}
+
+void Mediator::PublishDSCommittee() {
+  m_DSCommitteeSnapshot.Publish(*m_DSCommittee, m_currentEpochNum);
+}
+
+std::shared_ptr<const DequeOfNode> Mediator::GetDSCommitteeSnapshot() const {
+  return m_DSCommitteeSnapshot.Get();
+}
+
 void Mediator::IncreaseEpochNum() {
   std::lock_guard<mutex> lock(m_mutexVacuousEpoch);
   m_currentEpochNum++;
+
+  // Republish whatever a writer may have changed without publishing, as long
+  // as nobody is changing it right now; the epoch counter must not wait.
+  {
+    std::unique_lock<mutex> g(m_mutexDSCommittee, std::try_to_lock);
+    if (g.owns_lock()) {
+      PublishDSCommittee();
+    }
+  }
+  if (m_ds != nullptr) {
+    std::unique_lock<mutex> g(m_ds->m_mutexShards, std::try_to_lock);
+    if (g.owns_lock()) {
+      m_ds->PublishShards();
+    }
+  }
   if ((m_currentEpochNum + NUM_VACUOUS_EPOCHS) % NUM_FINAL_BLOCK_PER_POW == 0) {
     m_isVacuousEpoch = true;
   } else {
@@ -143,6 +177,10 @@ void Mediator::IncreaseEpochNum() {
 
     GetWorkServer::GetInstance().SetNextPoWTime(now + wait_seconds);
   }
+
+  EpochMetrics::GetInstance().OnNewEpoch(m_currentEpochNum);
+  EpochTimeline::GetInstance().OnNewEpoch(m_currentEpochNum,
+                                          GetTimelineRole());
 }
 
 bool Mediator::GetIsVacuousEpoch() { return m_isVacuousEpoch; }
@@ -174,7 +212,7 @@ bool Mediator::CheckWhetherBlockIsLatest(const uint64_t& dsblockNum,
   LOG_MARKER();
 
   uint64_t latestDSBlockNumInBlockchain =
-      m_dsBlockChain.GetLastBlock().GetHeader().GetBlockNum();
+      m_dsBlockChain.GetLastBlockPtr()->GetHeader().GetBlockNum();
 
   if (dsblockNum < (latestDSBlockNumInBlockchain + 1)) {
     LOG_EPOCH(WARNING, m_currentEpochNum,
@@ -20,6 +20,7 @@
 
 #include <deque>
 
+#include "libCrypto/CommitteeKeyCache.h"
 #include "libCrypto/Schnorr.h"
 #include "libData/BlockChainData/BlockChain.h"
 #include "libData/BlockChainData/BlockLinkChain.h"
@@ -27,6 +28,7 @@
 #include "libLookup/Lookup.h"
 #include "libNetwork/Peer.h"
 #include "libNode/Node.h"
+#include "libUtils/Snapshot.h"
 #include "libValidator/Validator.h"
 
 /// A mediator class for providing access to global members.
@@ -74,6 +76,13 @@ class Mediator {
   std::shared_ptr<DequeOfNode> m_DSCommittee;
   std::mutex m_mutexDSCommittee;
 
+  /// Copy of m_DSCommittee for readers that must not wait on
+  /// m_mutexDSCommittee.
+  Snapshot<DequeOfNode> m_DSCommitteeSnapshot;
+
+  /// Aggregated key of the DS committee, for co-signature checks.
+  CommitteeKeyCache m_DSCommitteeKeyCache;
+
   std::shared_ptr<std::vector<PubKey>> m_initialDSCommittee;
   std::mutex m_mutexInitialDSCommittee;
 
@@ -112,8 +121,18 @@ class Mediator {
 
   std::string GetNodeMode(const Peer& peer);
 
+  /// Role of this node for the epoch timeline
+  TimelineRole GetTimelineRole() const;
+
   void IncreaseEpochNum();
 
+  /// Publishes the current m_DSCommittee to lock-free readers. Call with
+  /// m_mutexDSCommittee held once the committee has been changed.
+  void PublishDSCommittee();
+
+  /// Returns the last published DS committee without locking.
+  std::shared_ptr<const DequeOfNode> GetDSCommitteeSnapshot() const;
+
   bool GetIsVacuousEpoch();
 
   bool GetIsVacuousEpoch(const uint64_t& epochNum);
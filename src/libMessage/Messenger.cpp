@@ -16,6 +16,7 @@
  */
 
 #include "Messenger.h"
+#include "libCrypto/Sha2Batch.h"
 #include "libData/AccountData/AccountStore.h"
 #include "libData/AccountData/Transaction.h"
 #include "libData/BlockChainData/BlockLinkChain.h"
@@ -23,9 +24,16 @@
 #include "libMessage/ZilliqaMessage.pb.h"
 #include "libUtils/Logger.h"
 
+#include <google/protobuf/arena.h>
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/wire_format_lite.h>
+#include <snappy.h>
 #include <algorithm>
+#include <future>
+#include <limits>
 #include <map>
 #include <random>
+#include <unordered_map>
 #include <unordered_set>
 
 using namespace boost::multiprecision;
@@ -45,8 +53,7 @@ void SerializableToProtobufByteArray(const Serializable& serializable,
 
 void ProtobufByteArrayToSerializable(const ByteArray& byteArray,
                                      Serializable& serializable) {
-  bytes tmp;
-  copy(byteArray.data().begin(), byteArray.data().end(), back_inserter(tmp));
+  bytes tmp(byteArray.data().begin(), byteArray.data().end());
   serializable.Deserialize(tmp, 0);
 }
 
@@ -61,8 +68,7 @@ void SerializableToProtobufByteArray(const SerializableDataBlock& serializable,
 // Temporary function for use by data blocks
 void ProtobufByteArrayToSerializable(const ByteArray& byteArray,
                                      SerializableDataBlock& serializable) {
-  bytes tmp;
-  copy(byteArray.data().begin(), byteArray.data().end(), back_inserter(tmp));
+  bytes tmp(byteArray.data().begin(), byteArray.data().end());
   serializable.Deserialize(tmp, 0);
 }
 
@@ -83,12 +89,14 @@ void ProtobufByteArrayToNumber(const ByteArray& byteArray, T& number) {
 template <class T>
 bool SerializeToArray(const T& protoMessage, bytes& dst,
                       const unsigned int offset) {
-  if ((offset + protoMessage.ByteSize()) > dst.size()) {
-    dst.resize(offset + protoMessage.ByteSize());
+  // ByteSizeLong caches the sizes that the serialization below reuses
+  const size_t size = protoMessage.ByteSizeLong();
+  if ((offset + size) > dst.size()) {
+    dst.resize(offset + size);
   }
 
-  return protoMessage.SerializeToArray(dst.data() + offset,
-                                       protoMessage.ByteSize());
+  protoMessage.SerializeWithCachedSizesToArray(dst.data() + offset);
+  return true;
 }
 
 template bool SerializeToArray<ProtoAccountStore>(
@@ -104,7 +112,7 @@ bool RepeatableToArray(const T& repeatable, bytes& dst,
       LOG_GENERAL(WARNING, "SerializeToArray failed, offset: " << tempOffset);
       return false;
     }
-    tempOffset += element.ByteSize();
+    tempOffset += element.GetCachedSize();
   }
   return true;
 }
@@ -114,6 +122,60 @@ void NumberToArray(const T& number, bytes& dst, const unsigned int offset) {
   Serializable::SetNumber<T>(dst, offset, number, S);
 }
 
+/// Protobuf arena kept per thread for parsing large messages
+struct ParseArena {
+  static constexpr size_t INITIAL_BLOCK_SIZE = 256 * 1024;
+
+  vector<char> m_initialBlock;
+  google::protobuf::Arena m_arena;
+  unsigned int m_depth;
+
+  static google::protobuf::ArenaOptions Options(vector<char>& initialBlock) {
+    google::protobuf::ArenaOptions options;
+    options.initial_block = initialBlock.data();
+    options.initial_block_size = initialBlock.size();
+    return options;
+  }
+
+  ParseArena()
+      : m_initialBlock(INITIAL_BLOCK_SIZE),
+        m_arena(Options(m_initialBlock)),
+        m_depth(0) {}
+
+  static ParseArena& GetInstance() {
+    static thread_local ParseArena parseArena;
+    return parseArena;
+  }
+};
+
+/// Protobuf message allocated on the arena of the calling thread. The arena
+/// is reset when the outermost ArenaMessage of the thread goes away, so its
+/// initial block is reused by the next message instead of every string and
+/// repeated field of a packet going through the allocator.
+template <class T>
+class ArenaMessage {
+  ParseArena& m_parseArena;
+  T* m_message;
+
+ public:
+  ArenaMessage() : m_parseArena(ParseArena::GetInstance()) {
+    ++m_parseArena.m_depth;
+    m_message =
+        google::protobuf::Arena::CreateMessage<T>(&m_parseArena.m_arena);
+  }
+
+  ~ArenaMessage() {
+    if (--m_parseArena.m_depth == 0) {
+      m_parseArena.m_arena.Reset();
+    }
+  }
+
+  ArenaMessage(const ArenaMessage&) = delete;
+  ArenaMessage& operator=(const ArenaMessage&) = delete;
+
+  T& Get() { return *m_message; }
+};
+
 // ============================================================================
 // Functions to check for fields in primitives that are used for persistent
 // storage. Remove fields from the checks once they are deprecated.
@@ -506,6 +568,61 @@ void AccountDeltaToProtobuf(const Account* oldAccount,
   }
 }
 
+/// Returns false if the delta can only be carried by a full ProtoAccount
+bool AccountDeltaToCompactProtobuf(
+    const Account* oldAccount, const Account& newAccount,
+    ProtoAccountStore::AccountDelta& protoDelta) {
+  if (!newAccount.GetCode().empty() ||
+      newAccount.GetVersion() != ACCOUNT_VERSION) {
+    return false;
+  }
+
+  const uint128_t oldBalance =
+      oldAccount == nullptr ? 0 : oldAccount->GetBalance();
+  const uint64_t oldNonce = oldAccount == nullptr ? 0 : oldAccount->GetNonce();
+
+  int256_t balanceDelta =
+      int256_t(newAccount.GetBalance()) - int256_t(oldBalance);
+  if (balanceDelta > numeric_limits<int64_t>::max() ||
+      balanceDelta < -numeric_limits<int64_t>::max()) {
+    return false;
+  }
+
+  uint64_t nonceDelta = 0;
+  if (!SafeMath<uint64_t>::sub(newAccount.GetNonce(), oldNonce, nonceDelta)) {
+    return false;
+  }
+
+  if (balanceDelta != 0) {
+    protoDelta.set_balance(balanceDelta.convert_to<int64_t>());
+  }
+  if (nonceDelta != 0) {
+    protoDelta.set_nonce(nonceDelta);
+  }
+
+  return true;
+}
+
+/// Rewrites the compact deltas as regular entries so they can be applied
+/// by the same code as deltas from older senders
+void ExpandCompactAccountDeltas(ProtoAccountStore& protoAccountStore) {
+  for (const auto& delta : protoAccountStore.deltas()) {
+    ProtoAccountStore::AddressAccount* protoEntry =
+        protoAccountStore.add_entries();
+    protoEntry->set_address(delta.address());
+
+    ProtoAccount* protoAccount = protoEntry->mutable_account();
+    protoAccount->set_version(ACCOUNT_VERSION);
+    protoAccount->set_numbersign(delta.balance() > 0);
+    uint128_t balanceDeltaNum(abs(int256_t(delta.balance())));
+    NumberToProtobufByteArray<uint128_t, UINT128_SIZE>(
+        balanceDeltaNum, *protoAccount->mutable_balance());
+    protoAccount->set_nonce(delta.nonce());
+  }
+
+  protoAccountStore.clear_deltas();
+}
+
 bool ProtobufToAccountDelta(const ProtoAccount& protoAccount, Account& account,
                             const Address& addr, const bool fullCopy) {
   if (!CheckRequiredFieldsProtoAccountDeltaDefault(protoAccount)) {
@@ -922,6 +1039,132 @@ bool ProtobufToShardingStructure(
   return true;
 }
 
+void ShardingStructureDiffToProtobuf(
+    const uint32_t& version, const DequeOfShard& shards,
+    const DequeOfShard& prevShards, const ShardingHash& prevShardingHash,
+    ProtoShardingStructureDiff& protoShardingStructureDiff) {
+  protoShardingStructureDiff.set_version(version);
+  protoShardingStructureDiff.set_prevshardinghash(prevShardingHash.data(),
+                                                  prevShardingHash.size);
+
+  unordered_map<PubKey, pair<uint32_t, uint32_t>> prevPositions;
+  for (uint32_t i = 0; i < prevShards.size(); i++) {
+    for (uint32_t j = 0; j < prevShards[i].size(); j++) {
+      prevPositions.emplace(std::get<SHARD_NODE_PUBKEY>(prevShards[i][j]),
+                            make_pair(i, j));
+    }
+  }
+
+  for (const auto& shard : shards) {
+    ProtoShardingStructureDiff::Shard* proto_shard =
+        protoShardingStructureDiff.add_shards();
+
+    for (const auto& node : shard) {
+      ProtoShardingStructureDiff::Member* proto_member =
+          proto_shard->add_members();
+      const PubKey& key = std::get<SHARD_NODE_PUBKEY>(node);
+      const Peer& peer = std::get<SHARD_NODE_PEER>(node);
+
+      auto it = prevPositions.find(key);
+      if (it != prevPositions.end() &&
+          std::get<SHARD_NODE_PEER>(
+              prevShards[it->second.first][it->second.second]) == peer) {
+        proto_member->set_prevshard(it->second.first);
+        proto_member->set_previndex(it->second.second);
+      } else {
+        ProtoShardingStructure::Member* full = proto_member->mutable_member();
+        SerializableToProtobufByteArray(key, *full->mutable_pubkey());
+        SerializableToProtobufByteArray(peer, *full->mutable_peerinfo());
+        full->set_reputation(std::get<SHARD_NODE_REP>(node));
+      }
+      proto_member->set_reputation(std::get<SHARD_NODE_REP>(node));
+    }
+  }
+}
+
+bool ProtobufToShardingStructureDiff(
+    const ProtoShardingStructureDiff& protoShardingStructureDiff,
+    const DequeOfShard& prevShards, uint32_t& version, DequeOfShard& shards) {
+  if (!protoShardingStructureDiff.has_version() ||
+      !protoShardingStructureDiff.has_prevshardinghash()) {
+    LOG_GENERAL(WARNING, "ProtoShardingStructureDiff is incomplete.");
+    return false;
+  }
+
+  ShardingHash prevShardingHash;
+  if (!Messenger::GetShardingStructureHash(
+          protoShardingStructureDiff.version(), prevShards,
+          prevShardingHash)) {
+    LOG_GENERAL(WARNING, "Messenger::GetShardingStructureHash failed.");
+    return false;
+  }
+
+  ShardingHash expectedPrevHash;
+  if (!Messenger::CopyWithSizeCheck(
+          protoShardingStructureDiff.prevshardinghash(),
+          expectedPrevHash.asArray())) {
+    return false;
+  }
+
+  if (prevShardingHash != expectedPrevHash) {
+    LOG_GENERAL(WARNING, "Sharding structure diff is against "
+                             << expectedPrevHash << ", we have "
+                             << prevShardingHash);
+    return false;
+  }
+
+  version = protoShardingStructureDiff.version();
+
+  for (const auto& proto_shard : protoShardingStructureDiff.shards()) {
+    shards.emplace_back();
+
+    for (const auto& proto_member : proto_shard.members()) {
+      if (!proto_member.has_reputation()) {
+        LOG_GENERAL(WARNING, "Sharding structure diff member is incomplete.");
+        return false;
+      }
+
+      if (proto_member.has_member()) {
+        if (!CheckRequiredFieldsProtoShardingStructureMember(
+                proto_member.member())) {
+          LOG_GENERAL(
+              WARNING,
+              "CheckRequiredFieldsProtoShardingStructureMember failed.");
+          return false;
+        }
+
+        PubKey key;
+        Peer peer;
+
+        ProtobufByteArrayToSerializable(proto_member.member().pubkey(), key);
+        ProtobufByteArrayToSerializable(proto_member.member().peerinfo(),
+                                        peer);
+
+        shards.back().emplace_back(key, peer, proto_member.reputation());
+        continue;
+      }
+
+      // Taken over from the previous structure, which costs no key parsing
+      if (!proto_member.has_prevshard() || !proto_member.has_previndex() ||
+          proto_member.prevshard() >= prevShards.size() ||
+          proto_member.previndex() >=
+              prevShards[proto_member.prevshard()].size()) {
+        LOG_GENERAL(WARNING,
+                    "Sharding structure diff refers to a missing member.");
+        return false;
+      }
+
+      const auto& prevNode =
+          prevShards[proto_member.prevshard()][proto_member.previndex()];
+      shards.back().emplace_back(std::get<SHARD_NODE_PUBKEY>(prevNode),
+                                 std::get<SHARD_NODE_PEER>(prevNode),
+                                 proto_member.reputation());
+    }
+  }
+
+  return true;
+}
+
 void AnnouncementShardingStructureToProtobuf(
     const DequeOfShard& shards, const MapOfPubKeyPoW& allPoWs,
     ProtoShardingStructureWithPoWSolns& protoShardingStructure) {
@@ -998,15 +1241,17 @@ void TransactionCoreInfoToProtobuf(const TransactionCoreInfo& txnCoreInfo,
   protoTxnCoreInfo.set_nonce(txnCoreInfo.nonce);
   protoTxnCoreInfo.set_toaddr(txnCoreInfo.toAddr.data(),
                               txnCoreInfo.toAddr.size);
-  SerializableToProtobufByteArray(txnCoreInfo.senderPubKey,
+  SerializableToProtobufByteArray(txnCoreInfo.GetSenderPubKey(),
                                   *protoTxnCoreInfo.mutable_senderpubkey());
   NumberToProtobufByteArray<uint128_t, UINT128_SIZE>(
       txnCoreInfo.amount, *protoTxnCoreInfo.mutable_amount());
   NumberToProtobufByteArray<uint128_t, UINT128_SIZE>(
       txnCoreInfo.gasPrice, *protoTxnCoreInfo.mutable_gasprice());
   protoTxnCoreInfo.set_gaslimit(txnCoreInfo.gasLimit);
-  protoTxnCoreInfo.set_code(txnCoreInfo.code.data(), txnCoreInfo.code.size());
-  protoTxnCoreInfo.set_data(txnCoreInfo.data.data(), txnCoreInfo.data.size());
+  const bytes& code = txnCoreInfo.GetCode();
+  protoTxnCoreInfo.set_code(code.data(), code.size());
+  const bytes& data = txnCoreInfo.GetData();
+  protoTxnCoreInfo.set_data(data.data(), data.size());
 }
 
 void ProtobufToTransactionCoreInfo(
@@ -1019,19 +1264,19 @@ void ProtobufToTransactionCoreInfo(
            min((unsigned int)protoTxnCoreInfo.toaddr().size(),
                (unsigned int)txnCoreInfo.toAddr.size),
        txnCoreInfo.toAddr.asArray().begin());
+  PubKey senderPubKey;
   ProtobufByteArrayToSerializable(protoTxnCoreInfo.senderpubkey(),
-                                  txnCoreInfo.senderPubKey);
+                                  senderPubKey);
+  txnCoreInfo.SetSenderPubKey(senderPubKey);
   ProtobufByteArrayToNumber<uint128_t, UINT128_SIZE>(protoTxnCoreInfo.amount(),
                                                      txnCoreInfo.amount);
   ProtobufByteArrayToNumber<uint128_t, UINT128_SIZE>(
       protoTxnCoreInfo.gasprice(), txnCoreInfo.gasPrice);
   txnCoreInfo.gasLimit = protoTxnCoreInfo.gaslimit();
-  txnCoreInfo.code.resize(protoTxnCoreInfo.code().size());
-  copy(protoTxnCoreInfo.code().begin(), protoTxnCoreInfo.code().end(),
-       txnCoreInfo.code.begin());
-  txnCoreInfo.data.resize(protoTxnCoreInfo.data().size());
-  copy(protoTxnCoreInfo.data().begin(), protoTxnCoreInfo.data().end(),
-       txnCoreInfo.data.begin());
+  txnCoreInfo.code = TransactionCoreInfo::MakePayload(
+      bytes(protoTxnCoreInfo.code().begin(), protoTxnCoreInfo.code().end()));
+  txnCoreInfo.data = TransactionCoreInfo::MakePayload(
+      bytes(protoTxnCoreInfo.data().begin(), protoTxnCoreInfo.data().end()));
 }
 
 void TransactionToProtobuf(const Transaction& transaction,
@@ -1045,8 +1290,11 @@ void TransactionToProtobuf(const Transaction& transaction,
                                   *protoTransaction.mutable_signature());
 }
 
-void ProtobufToTransaction(const ProtoTransaction& protoTransaction,
-                           Transaction& transaction) {
+/// Checks the tranID and signature of a transaction whose serialized core info
+/// and its hash have already been computed
+void ProtobufToTransactionWithHash(const ProtoTransaction& protoTransaction,
+                                   const bytes& txnData, const bytes& hash,
+                                   Transaction& transaction) {
   TxnHash tranID;
   TransactionCoreInfo txnCoreInfo;
   Signature signature;
@@ -1061,16 +1309,6 @@ void ProtobufToTransaction(const ProtoTransaction& protoTransaction,
 
   ProtobufByteArrayToSerializable(protoTransaction.signature(), signature);
 
-  bytes txnData;
-  if (!SerializeToArray(protoTransaction.info(), txnData, 0)) {
-    LOG_GENERAL(WARNING, "Serialize Proto transaction core info failed.");
-    return;
-  }
-
-  SHA2<HASH_TYPE::HASH_VARIANT_256> sha2;
-  sha2.Update(txnData);
-  const bytes& hash = sha2.Finalize();
-
   if (!std::equal(hash.begin(), hash.end(), tranID.begin(), tranID.end())) {
     TxnHash expected;
     copy(hash.begin(), hash.end(), expected.asArray().begin());
@@ -1081,15 +1319,54 @@ void ProtobufToTransaction(const ProtoTransaction& protoTransaction,
 
   // Verify signature
   if (!Schnorr::GetInstance().Verify(txnData, signature,
-                                     txnCoreInfo.senderPubKey)) {
+                                     txnCoreInfo.GetSenderPubKey())) {
     LOG_GENERAL(WARNING, "Signature verification failed.");
     return;
   }
 
-  transaction = Transaction(
-      tranID, txnCoreInfo.version, txnCoreInfo.nonce, txnCoreInfo.toAddr,
-      txnCoreInfo.senderPubKey, txnCoreInfo.amount, txnCoreInfo.gasPrice,
-      txnCoreInfo.gasLimit, txnCoreInfo.code, txnCoreInfo.data, signature);
+  transaction = Transaction(tranID, move(txnCoreInfo), signature);
+}
+
+void ProtobufToTransaction(const ProtoTransaction& protoTransaction,
+                           Transaction& transaction) {
+  bytes txnData;
+  if (!SerializeToArray(protoTransaction.info(), txnData, 0)) {
+    LOG_GENERAL(WARNING, "Serialize Proto transaction core info failed.");
+    return;
+  }
+
+  SHA2<HASH_TYPE::HASH_VARIANT_256> sha2;
+  sha2.Update(txnData);
+  const bytes& hash = sha2.Finalize();
+
+  ProtobufToTransactionWithHash(protoTransaction, txnData, hash, transaction);
+}
+
+/// Same as calling ProtobufToTransaction on each element, but hashes the whole
+/// list with SHA256Batch first
+void ProtobufToTransactions(
+    const google::protobuf::RepeatedPtrField<ProtoTransaction>& protoTxns,
+    std::vector<Transaction>& txns) {
+  vector<bytes> txnData(protoTxns.size());
+  vector<bool> serialized(protoTxns.size(), false);
+  for (int i = 0; i < protoTxns.size(); i++) {
+    serialized[i] = SerializeToArray(protoTxns.Get(i).info(), txnData[i], 0);
+  }
+
+  vector<bytes> hashes;
+  SHA256Batch(txnData, hashes);
+
+  txns.reserve(txns.size() + protoTxns.size());
+  for (int i = 0; i < protoTxns.size(); i++) {
+    Transaction txn;
+    if (serialized[i]) {
+      ProtobufToTransactionWithHash(protoTxns.Get(i), txnData[i], hashes[i],
+                                    txn);
+    } else {
+      LOG_GENERAL(WARNING, "Serialize Proto transaction core info failed.");
+    }
+    txns.push_back(move(txn));
+  }
 }
 
 void TransactionOffsetToProtobuf(const std::vector<uint32_t>& txnOffsets,
@@ -1117,29 +1394,40 @@ void TransactionArrayToProtobuf(const std::vector<Transaction>& txns,
 void ProtobufToTransactionArray(
     const ProtoTransactionArray& protoTransactionArray,
     std::vector<Transaction>& txns) {
-  for (const auto& protoTransaction : protoTransactionArray.transactions()) {
-    Transaction txn;
-    ProtobufToTransaction(protoTransaction, txn);
-    txns.push_back(txn);
-  }
+  ProtobufToTransactions(protoTransactionArray.transactions(), txns);
 }
 
 void TransactionReceiptToProtobuf(const TransactionReceipt& transReceipt,
                                   ProtoTransactionReceipt& protoTransReceipt) {
-  protoTransReceipt.set_receipt(transReceipt.GetString());
+  bytes binary;
+  if (transReceipt.GetBinary(binary)) {
+    // receipt is required, so it is sent empty next to the binary form
+    protoTransReceipt.set_receipt("");
+    protoTransReceipt.set_binary(binary.data(), binary.size());
+  } else {
+    protoTransReceipt.set_receipt(transReceipt.GetString());
+  }
   // protoTransReceipt.set_cumgas(transReceipt.GetCumGas());
   protoTransReceipt.set_cumgas(transReceipt.GetCumGas());
 }
 
-void ProtobufToTransactionReceipt(
+bool ProtobufToTransactionReceipt(
     const ProtoTransactionReceipt& protoTransactionReceipt,
     TransactionReceipt& transactionReceipt) {
+  if (protoTransactionReceipt.has_binary()) {
+    const bytes binary(protoTransactionReceipt.binary().begin(),
+                       protoTransactionReceipt.binary().end());
+    return transactionReceipt.SetBinary(binary,
+                                        protoTransactionReceipt.cumgas());
+  }
+
   std::string tranReceiptStr;
   tranReceiptStr.resize(protoTransactionReceipt.receipt().size());
   copy(protoTransactionReceipt.receipt().begin(),
        protoTransactionReceipt.receipt().end(), tranReceiptStr.begin());
   transactionReceipt.SetString(tranReceiptStr);
   transactionReceipt.SetCumGas(protoTransactionReceipt.cumgas());
+  return true;
 }
 
 void TransactionWithReceiptToProtobuf(
@@ -1153,16 +1441,20 @@ void TransactionWithReceiptToProtobuf(
                                *protoTranReceipt);
 }
 
-void ProtobufToTransactionWithReceipt(
+bool ProtobufToTransactionWithReceipt(
     const ProtoTransactionWithReceipt& protoWithTransaction,
     TransactionWithReceipt& transactionWithReceipt) {
   Transaction transaction;
   ProtobufToTransaction(protoWithTransaction.transaction(), transaction);
 
   TransactionReceipt receipt;
-  ProtobufToTransactionReceipt(protoWithTransaction.receipt(), receipt);
+  if (!ProtobufToTransactionReceipt(protoWithTransaction.receipt(), receipt)) {
+    return false;
+  }
 
-  transactionWithReceipt = TransactionWithReceipt(transaction, receipt);
+  transactionWithReceipt =
+      TransactionWithReceipt(move(transaction), move(receipt));
+  return true;
 }
 
 void PeerToProtobuf(const Peer& peer, ProtoPeer& protoPeer) {
@@ -2371,11 +2663,22 @@ bool Messenger::SetAccountStoreDelta(bytes& dst, const unsigned int offset,
                         << accountStoreTemp.GetNumOfAccounts());
 
   for (const auto& entry : *accountStoreTemp.GetAddressToAccount()) {
+    const Account* oldAccount = accountStore.GetAccount(entry.first);
+
+    if (STATE_DELTA_VERSION >= 2) {
+      ProtoAccountStore::AccountDelta protoDelta;
+      if (AccountDeltaToCompactProtobuf(oldAccount, entry.second,
+                                        protoDelta)) {
+        protoDelta.set_address(entry.first.data(), entry.first.size);
+        *result.add_deltas() = move(protoDelta);
+        continue;
+      }
+    }
+
     ProtoAccountStore::AddressAccount* protoEntry = result.add_entries();
     protoEntry->set_address(entry.first.data(), entry.first.size);
     ProtoAccount* protoEntryAccount = protoEntry->mutable_account();
-    AccountDeltaToProtobuf(accountStore.GetAccount(entry.first), entry.second,
-                           *protoEntryAccount);
+    AccountDeltaToProtobuf(oldAccount, entry.second, *protoEntryAccount);
     if (!protoEntryAccount->IsInitialized()) {
       LOG_GENERAL(WARNING, "ProtoAccount initialization failed.");
       return false;
@@ -2402,6 +2705,8 @@ bool Messenger::StateDeltaToAddressMap(
     return false;
   }
 
+  ExpandCompactAccountDeltas(result);
+
   for (const auto& entry : result.entries()) {
     Address address;
     Account account;
@@ -2439,6 +2744,8 @@ bool Messenger::GetAccountStoreDelta(const bytes& src,
     return false;
   }
 
+  ExpandCompactAccountDeltas(result);
+
   LOG_GENERAL(INFO,
               "Total Number of Accounts Delta: " << result.entries().size());
 
@@ -2492,6 +2799,8 @@ bool Messenger::GetAccountStoreDelta(const bytes& src,
     return false;
   }
 
+  ExpandCompactAccountDeltas(result);
+
   LOG_GENERAL(INFO,
               "Total Number of Accounts Delta: " << result.entries().size());
 
@@ -2535,6 +2844,177 @@ bool Messenger::GetAccountStoreDelta(const bytes& src,
   return true;
 }
 
+/// Runs func(i) for every i in [0, count), spread over the hardware threads
+template <class F>
+void ParallelForEach(size_t count, const F& func) {
+  const size_t numThreads =
+      min<size_t>(count, max(thread::hardware_concurrency(), 1u));
+
+  vector<future<void>> workers;
+  for (size_t t = 1; t < numThreads; t++) {
+    workers.emplace_back(async(launch::async, [&func, count, numThreads, t]() {
+      for (size_t i = t; i < count; i += numThreads) {
+        func(i);
+      }
+    }));
+  }
+  for (size_t i = 0; i < count; i += max<size_t>(numThreads, 1)) {
+    func(i);
+  }
+  for (auto& worker : workers) {
+    worker.get();
+  }
+}
+
+bool Messenger::GetAccountStoreDeltas(const vector<const bytes*>& deltas,
+                                      AccountStoreTemp& accountStoreTemp,
+                                      vector<bool>& applied) {
+  LOG_MARKER();
+
+  vector<ProtoAccountStore> results(deltas.size());
+  vector<unsigned char> valid(deltas.size(), 0);
+
+  ParallelForEach(deltas.size(), [&deltas, &results, &valid](size_t i) {
+    const bytes& src = *deltas.at(i);
+    valid[i] = results[i].ParseFromArray(src.data(), src.size()) &&
+               results[i].IsInitialized();
+    if (valid[i]) {
+      ExpandCompactAccountDeltas(results[i]);
+    }
+  });
+
+  // All the changes to one account, in delta order
+  struct AccountMerge {
+    Address m_address;
+    vector<pair<size_t, const ProtoAccount*>> m_changes;
+    Account m_account;
+    bool m_created = false;
+    bool m_contract = false;
+    // Index of the first delta whose change to this account is invalid
+    size_t m_badDelta = SIZE_MAX;
+  };
+
+  vector<AccountMerge> merges;
+  unordered_map<Address, size_t> mergeIndex;
+  size_t numEntries = 0;
+
+  for (size_t i = 0; i < deltas.size(); i++) {
+    if (!valid[i]) {
+      LOG_GENERAL(WARNING, "ProtoAccountStore initialization failed.");
+      continue;
+    }
+
+    for (const auto& entry : results[i].entries()) {
+      Address address;
+      copy(entry.address().begin(),
+           entry.address().begin() + min((unsigned int)entry.address().size(),
+                                         (unsigned int)address.size),
+           address.asArray().begin());
+
+      auto it = mergeIndex.emplace(address, merges.size()).first;
+      if (it->second == merges.size()) {
+        merges.emplace_back();
+        merges.back().m_address = address;
+      }
+      merges[it->second].m_changes.emplace_back(i, &entry.account());
+      numEntries++;
+    }
+  }
+
+  LOG_GENERAL(INFO, "Total Number of Accounts Delta: "
+                        << numEntries << " in " << deltas.size()
+                        << " deltas, " << numEntries - merges.size()
+                        << " overlapping");
+
+  // Account lookups fill the read-through caches, so they are done here
+  for (auto& merge : merges) {
+    const Account* oriAccount = accountStoreTemp.GetAccount(merge.m_address);
+    if (oriAccount == nullptr) {
+      LOG_GENERAL(INFO, "Creating new account: " << merge.m_address);
+      merge.m_account = Account(0, 0);
+      merge.m_created = true;
+    } else {
+      merge.m_account = *oriAccount;
+    }
+
+    merge.m_contract = merge.m_account.isContract();
+    for (const auto& change : merge.m_changes) {
+      merge.m_contract = merge.m_contract || !change.second->code().empty();
+    }
+  }
+
+  // Applies the changes of the valid deltas to a copy of the account
+  auto mergeAccount = [&valid](AccountMerge& merge, Account& account) {
+    merge.m_badDelta = SIZE_MAX;
+    bool first = true;
+    for (const auto& change : merge.m_changes) {
+      if (!valid[change.first]) {
+        continue;
+      }
+      if (!ProtobufToAccountDelta(*change.second, account, merge.m_address,
+                                  first && merge.m_created)) {
+        LOG_GENERAL(WARNING,
+                    "ProtobufToAccountDelta failed for account at address "
+                        << merge.m_address);
+        merge.m_badDelta = change.first;
+        return false;
+      }
+      first = false;
+    }
+    return true;
+  };
+
+  // Contract changes also update contract storage, so they are applied once,
+  // one account at a time
+  for (auto& merge : merges) {
+    if (merge.m_contract) {
+      mergeAccount(merge, merge.m_account);
+      if (merge.m_badDelta != SIZE_MAX) {
+        valid[merge.m_badDelta] = 0;
+      }
+    }
+  }
+
+  // Other accounts only change balance and nonce, so they are merged in
+  // parallel, again without any delta found invalid
+  vector<Account> merged(merges.size());
+  bool retry = true;
+  while (retry) {
+    ParallelForEach(merges.size(), [&merges, &merged, &mergeAccount](size_t i) {
+      if (!merges[i].m_contract) {
+        merged[i] = merges[i].m_account;
+        mergeAccount(merges[i], merged[i]);
+      }
+    });
+
+    retry = false;
+    for (const auto& merge : merges) {
+      if (!merge.m_contract && merge.m_badDelta != SIZE_MAX &&
+          valid[merge.m_badDelta]) {
+        valid[merge.m_badDelta] = 0;
+        retry = true;
+      }
+    }
+  }
+
+  for (size_t i = 0; i < merges.size(); i++) {
+    const auto& changes = merges[i].m_changes;
+    if (none_of(changes.begin(), changes.end(),
+                [&valid](const pair<size_t, const ProtoAccount*>& change) {
+                  return valid[change.first] != 0;
+                })) {
+      continue;
+    }
+    accountStoreTemp.AddAccountDuringDeserialization(
+        merges[i].m_address,
+        merges[i].m_contract ? merges[i].m_account : merged[i]);
+  }
+
+  applied.assign(valid.begin(), valid.end());
+  return all_of(valid.begin(), valid.end(),
+                [](unsigned char v) { return v != 0; });
+}
+
 bool Messenger::GetMbInfoHash(const std::vector<MicroBlockInfo>& mbInfos,
                               MBInfoHash& dst) {
   bytes tmp;
@@ -2625,6 +3105,21 @@ bool Messenger::GetDSBlock(const bytes& src, const unsigned int offset,
   return ProtobufToDSBlock(result, dsBlock);
 }
 
+bool Messenger::GetDSBlockHeaderOfBlock(const bytes& src,
+                                        const unsigned int offset,
+                                        DSBlockHeader& dsBlockHeader) {
+  ProtoDSBlockHeaderView result;
+
+  result.ParseFromArray(src.data() + offset, src.size() - offset);
+
+  if (!result.IsInitialized() || !result.has_header()) {
+    LOG_GENERAL(WARNING, "ProtoDSBlockHeaderView initialization failed.");
+    return false;
+  }
+
+  return ProtobufToDSBlockHeader(result.header(), dsBlockHeader);
+}
+
 bool Messenger::SetMicroBlockHeader(bytes& dst, const unsigned int offset,
                                     const MicroBlockHeader& microBlockHeader) {
   ProtoMicroBlock::MicroBlockHeader result;
@@ -2683,6 +3178,21 @@ bool Messenger::GetMicroBlock(const bytes& src, const unsigned int offset,
   return ProtobufToMicroBlock(result, microBlock);
 }
 
+bool Messenger::GetMicroBlockHeaderOfBlock(const bytes& src,
+                                           const unsigned int offset,
+                                           MicroBlockHeader& microBlockHeader) {
+  ProtoMicroBlockHeaderView result;
+
+  result.ParseFromArray(src.data() + offset, src.size() - offset);
+
+  if (!result.IsInitialized() || !result.has_header()) {
+    LOG_GENERAL(WARNING, "ProtoMicroBlockHeaderView initialization failed.");
+    return false;
+  }
+
+  return ProtobufToMicroBlockHeader(result.header(), microBlockHeader);
+}
+
 bool Messenger::SetTxBlockHeader(bytes& dst, const unsigned int offset,
                                  const TxBlockHeader& txBlockHeader) {
   ProtoTxBlock::TxBlockHeader result;
@@ -2739,6 +3249,21 @@ bool Messenger::GetTxBlock(const bytes& src, const unsigned int offset,
   return ProtobufToTxBlock(result, txBlock);
 }
 
+bool Messenger::GetTxBlockHeaderOfBlock(const bytes& src,
+                                        const unsigned int offset,
+                                        TxBlockHeader& txBlockHeader) {
+  ProtoTxBlockHeaderView result;
+
+  result.ParseFromArray(src.data() + offset, src.size() - offset);
+
+  if (!result.IsInitialized() || !result.has_header()) {
+    LOG_GENERAL(WARNING, "ProtoTxBlockHeaderView initialization failed.");
+    return false;
+  }
+
+  return ProtobufToTxBlockHeader(result.header(), txBlockHeader);
+}
+
 bool Messenger::SetVCBlockHeader(bytes& dst, const unsigned int offset,
                                  const VCBlockHeader& vcBlockHeader) {
   ProtoVCBlock::VCBlockHeader result;
@@ -2961,7 +3486,8 @@ bool Messenger::SetTransactionArray(bytes& dst, const unsigned int offset,
 
 bool Messenger::GetTransactionArray(const bytes& src, const unsigned int offset,
                                     std::vector<Transaction>& txns) {
-  ProtoTransactionArray result;
+  ArenaMessage<ProtoTransactionArray> arenaMessage;
+  ProtoTransactionArray& result = arenaMessage.Get();
 
   result.ParseFromArray(src.data() + offset, src.size() - offset);
 
@@ -3000,9 +3526,7 @@ bool Messenger::GetTransactionReceipt(const bytes& src,
     return false;
   }
 
-  ProtobufToTransactionReceipt(result, transactionReceipt);
-
-  return true;
+  return ProtobufToTransactionReceipt(result, transactionReceipt);
 }
 
 bool Messenger::SetTransactionWithReceipt(
@@ -3031,9 +3555,7 @@ bool Messenger::GetTransactionWithReceipt(
     return false;
   }
 
-  ProtobufToTransactionWithReceipt(result, transactionWithReceipt);
-
-  return true;
+  return ProtobufToTransactionWithReceipt(result, transactionWithReceipt);
 }
 
 bool Messenger::SetStateIndex(bytes& dst, const unsigned int offset,
@@ -3534,7 +4056,8 @@ bool Messenger::GetDSMicroBlockSubmission(
     vector<bytes>& stateDeltas, PubKey& pubKey) {
   LOG_MARKER();
 
-  DSMicroBlockSubmission result;
+  ArenaMessage<DSMicroBlockSubmission> arenaMessage;
+  DSMicroBlockSubmission& result = arenaMessage.Get();
 
   result.ParseFromArray(src.data() + offset, src.size() - offset);
 
@@ -3985,34 +4508,91 @@ bool Messenger::SetNodeVCDSBlocksMessage(
   return SerializeToArray(result, dst, offset);
 }
 
-bool Messenger::GetNodeVCDSBlocksMessage(const bytes& src,
-                                         const unsigned int offset,
-                                         uint32_t& shardId, DSBlock& dsBlock,
-                                         std::vector<VCBlock>& vcBlocks,
-                                         uint32_t& shardingStructureVersion,
-                                         DequeOfShard& shards) {
+bool Messenger::SetNodeVCDSBlocksMessage(
+    bytes& dst, const unsigned int offset, const uint32_t shardId,
+    const DSBlock& dsBlock, const std::vector<VCBlock>& vcBlocks,
+    const uint32_t& shardingStructureVersion, const DequeOfShard& shards,
+    const DequeOfShard& prevShards, const ShardingHash& prevShardingHash) {
   LOG_MARKER();
 
   NodeDSBlock result;
 
-  result.ParseFromArray(src.data() + offset, src.size() - offset);
+  result.set_shardid(shardId);
+  DSBlockToProtobuf(dsBlock, *result.mutable_dsblock());
+
+  for (const auto& vcblock : vcBlocks) {
+    VCBlockToProtobuf(vcblock, *result.add_vcblocks());
+  }
+  ShardingStructureDiffToProtobuf(shardingStructureVersion, shards,
+                                  prevShards, prevShardingHash,
+                                  *result.mutable_shardingdiff());
 
   if (!result.IsInitialized()) {
     LOG_GENERAL(WARNING, "NodeDSBlock initialization failed.");
     return false;
   }
 
-  shardId = result.shardid();
-  if (!ProtobufToDSBlock(result.dsblock(), dsBlock)) {
+  return SerializeToArray(result, dst, offset);
+}
+
+bool Messenger::SetNodeVCDSBlocksMessageShardId(bytes& dst,
+                                                const unsigned int offset,
+                                                const uint32_t shardId) {
+  if (dst.size() <= offset) {
+    LOG_GENERAL(WARNING, "NodeDSBlock not composed yet.");
     return false;
   }
 
-  for (const auto& proto_vcblock : result.vcblocks()) {
-    VCBlock vcblock;
-    if (!ProtobufToVCBlock(proto_vcblock, vcblock)) {
-      continue;
-    }
-    vcBlocks.emplace_back(move(vcblock));
+  // A scalar field parsed twice keeps its last value, so the new shard id is
+  // appended after the existing message
+  NodeDSBlock result;
+  result.set_shardid(shardId);
+
+  const size_t size = result.ByteSizeLong();
+  const size_t end = dst.size();
+  dst.resize(end + size);
+  return result.SerializePartialToArray(dst.data() + end, size);
+}
+
+bool Messenger::GetNodeVCDSBlocksMessage(const bytes& src,
+                                         const unsigned int offset,
+                                         uint32_t& shardId, DSBlock& dsBlock,
+                                         std::vector<VCBlock>& vcBlocks,
+                                         uint32_t& shardingStructureVersion,
+                                         DequeOfShard& shards,
+                                         const DequeOfShard& prevShards) {
+  LOG_MARKER();
+
+  NodeDSBlock result;
+
+  result.ParseFromArray(src.data() + offset, src.size() - offset);
+
+  if (!result.IsInitialized()) {
+    LOG_GENERAL(WARNING, "NodeDSBlock initialization failed.");
+    return false;
+  }
+
+  shardId = result.shardid();
+  if (!ProtobufToDSBlock(result.dsblock(), dsBlock)) {
+    return false;
+  }
+
+  for (const auto& proto_vcblock : result.vcblocks()) {
+    VCBlock vcblock;
+    if (!ProtobufToVCBlock(proto_vcblock, vcblock)) {
+      continue;
+    }
+    vcBlocks.emplace_back(move(vcblock));
+  }
+
+  if (result.has_shardingdiff()) {
+    return ProtobufToShardingStructureDiff(
+        result.shardingdiff(), prevShards, shardingStructureVersion, shards);
+  }
+
+  if (!result.has_sharding()) {
+    LOG_GENERAL(WARNING, "NodeDSBlock has no sharding structure.");
+    return false;
   }
 
   return ProtobufToShardingStructure(result.sharding(),
@@ -4047,7 +4627,8 @@ bool Messenger::GetNodeFinalBlock(const bytes& src, const unsigned int offset,
                                   bytes& stateDelta) {
   LOG_MARKER();
 
-  NodeFinalBlock result;
+  ArenaMessage<NodeFinalBlock> arenaMessage;
+  NodeFinalBlock& result = arenaMessage.Get();
 
   result.ParseFromArray(src.data() + offset, src.size() - offset);
 
@@ -4101,7 +4682,8 @@ bool Messenger::GetNodeMBnForwardTransaction(const bytes& src,
                                              MBnForwardedTxnEntry& entry) {
   LOG_MARKER();
 
-  NodeMBnForwardTransaction result;
+  ArenaMessage<NodeMBnForwardTransaction> arenaMessage;
+  NodeMBnForwardTransaction& result = arenaMessage.Get();
 
   result.ParseFromArray(src.data() + offset, src.size() - offset);
 
@@ -4126,6 +4708,65 @@ bool Messenger::GetNodeMBnForwardTransaction(const bytes& src,
   return true;
 }
 
+bool Messenger::SetNodeMBnForwardTxnHashes(
+    bytes& dst, const unsigned int offset, const MicroBlock& microBlock,
+    const vector<TransactionReceipt>& receipts, const uint32_t listenPort) {
+  LOG_MARKER();
+
+  NodeMBnForwardTxnHashes result;
+
+  MicroBlockToProtobuf(microBlock, *result.mutable_microblock());
+
+  for (const auto& receipt : receipts) {
+    TransactionReceiptToProtobuf(receipt, *result.add_receipts());
+  }
+
+  result.set_listenport(listenPort);
+
+  if (!result.IsInitialized()) {
+    LOG_GENERAL(WARNING, "NodeMBnForwardTxnHashes initialization failed.");
+    return false;
+  }
+
+  LOG_GENERAL(INFO, "EpochNum: " << microBlock.GetHeader().GetEpochNum()
+                                 << " MBHash: " << microBlock.GetBlockHash()
+                                 << " Receipts: " << receipts.size());
+
+  return SerializeToArray(result, dst, offset);
+}
+
+bool Messenger::GetNodeMBnForwardTxnHashes(
+    const bytes& src, const unsigned int offset, MicroBlock& microBlock,
+    vector<TransactionReceipt>& receipts, uint32_t& listenPort) {
+  LOG_MARKER();
+
+  ArenaMessage<NodeMBnForwardTxnHashes> arenaMessage;
+  NodeMBnForwardTxnHashes& result = arenaMessage.Get();
+
+  result.ParseFromArray(src.data() + offset, src.size() - offset);
+
+  if (!result.IsInitialized()) {
+    LOG_GENERAL(WARNING, "NodeMBnForwardTxnHashes initialization failed.");
+    return false;
+  }
+
+  if (!ProtobufToMicroBlock(result.microblock(), microBlock)) {
+    return false;
+  }
+
+  for (const auto& protoReceipt : result.receipts()) {
+    receipts.emplace_back();
+    if (!ProtobufToTransactionReceipt(protoReceipt, receipts.back())) {
+      LOG_GENERAL(WARNING, "ProtobufToTransactionReceipt failed");
+      return false;
+    }
+  }
+
+  listenPort = result.listenport();
+
+  return true;
+}
+
 bool Messenger::SetNodeVCBlock(bytes& dst, const unsigned int offset,
                                const VCBlock& vcBlock) {
   LOG_MARKER();
@@ -4213,6 +4854,90 @@ bool Messenger::SetNodeForwardTxnBlock(
   return SerializeToArray(result, dst, offset);
 }
 
+bool Messenger::SetNodeForwardTxnBlock(
+    bytes& dst, const unsigned int offset, const uint64_t& epochNumber,
+    const uint64_t& dsBlockNum, const uint32_t& shardId,
+    const PairOfKey& lookupKey, const std::vector<Transaction>& txnsCurrent,
+    const std::vector<TxnCorpus::Slice>& txnsGenerated) {
+  LOG_MARKER();
+
+  using google::protobuf::internal::WireFormatLite;
+  using google::protobuf::io::CodedOutputStream;
+
+  NodeForwardTxnBlock result;
+
+  result.set_epochnumber(epochNumber);
+  result.set_dsblocknum(dsBlockNum);
+  result.set_shardid(shardId);
+  SerializableToProtobufByteArray(lookupKey.second, *result.mutable_pubkey());
+
+  for (const auto& txn : txnsCurrent) {
+    TransactionToProtobuf(txn, *result.add_transactions());
+  }
+
+  // The lookup signs the transactions serialized back to back, and a slice
+  // already holds its transactions that way
+  bytes tmp;
+  if (!RepeatableToArray(result.transactions(), tmp, 0)) {
+    LOG_GENERAL(WARNING, "Failed to serialize transactions.");
+    return false;
+  }
+  unsigned int txnsGeneratedCount = 0;
+  for (const auto& slice : txnsGenerated) {
+    tmp.insert(tmp.end(), slice.m_data, slice.m_data + slice.m_size);
+    txnsGeneratedCount += slice.m_txnSizes.size();
+  }
+
+  Signature signature;
+  if (!tmp.empty() && !Schnorr::GetInstance().Sign(tmp, lookupKey.first,
+                                                   lookupKey.second,
+                                                   signature)) {
+    LOG_GENERAL(WARNING, "Failed to sign transactions.");
+    return false;
+  }
+
+  SerializableToProtobufByteArray(signature, *result.mutable_signature());
+
+  if (!result.IsInitialized()) {
+    LOG_GENERAL(WARNING, "NodeForwardTxnBlock initialization failed.");
+    return false;
+  }
+
+  if (!SerializeToArray(result, dst, offset)) {
+    return false;
+  }
+
+  // Repeated fields may come after the rest of the message, so the slices
+  // are framed as transactions and appended to it
+  const uint32_t tag = WireFormatLite::MakeTag(
+      NodeForwardTxnBlock::kTransactionsFieldNumber,
+      WireFormatLite::WIRETYPE_LENGTH_DELIMITED);
+  size_t pos = offset + result.GetCachedSize();
+  dst.resize(pos);
+  for (const auto& slice : txnsGenerated) {
+    dst.resize(pos + slice.m_size +
+               slice.m_txnSizes.size() *
+                   (CodedOutputStream::VarintSize32(tag) +
+                    CodedOutputStream::VarintSize32(slice.m_size)));
+    const unsigned char* txn = slice.m_data;
+    for (const auto& txnSize : slice.m_txnSizes) {
+      unsigned char* out = dst.data() + pos;
+      out = CodedOutputStream::WriteTagToArray(tag, out);
+      out = CodedOutputStream::WriteVarint32ToArray(txnSize, out);
+      out = copy(txn, txn + txnSize, out);
+      pos = out - dst.data();
+      txn += txnSize;
+    }
+  }
+  dst.resize(pos);
+
+  LOG_GENERAL(INFO, "Epoch: " << epochNumber << " shardId: " << shardId
+                              << " Current txns: " << txnsCurrent.size()
+                              << " Generated txns: " << txnsGeneratedCount);
+
+  return true;
+}
+
 bool Messenger::GetNodeForwardTxnBlock(const bytes& src,
                                        const unsigned int offset,
                                        uint64_t& epochNumber,
@@ -4221,7 +4946,8 @@ bool Messenger::GetNodeForwardTxnBlock(const bytes& src,
                                        std::vector<Transaction>& txns) {
   LOG_MARKER();
 
-  NodeForwardTxnBlock result;
+  ArenaMessage<NodeForwardTxnBlock> arenaMessage;
+  NodeForwardTxnBlock& result = arenaMessage.Get();
 
   result.ParseFromArray(src.data() + offset, src.size() - offset);
 
@@ -4249,11 +4975,7 @@ bool Messenger::GetNodeForwardTxnBlock(const bytes& src,
       return false;
     }
 
-    for (const auto& txn : result.transactions()) {
-      Transaction t;
-      ProtobufToTransaction(txn, t);
-      txns.emplace_back(t);
-    }
+    ProtobufToTransactions(result.transactions(), txns);
   }
 
   LOG_GENERAL(INFO, "Epoch: " << epochNumber << " Shard: " << shardId
@@ -4262,6 +4984,160 @@ bool Messenger::GetNodeForwardTxnBlock(const bytes& src,
   return true;
 }
 
+namespace {
+
+/// Splits a serialized NodeForwardTxnBlock into its header (every other
+/// field) and the (offset, size) of each transaction in src, so that the
+/// header is checked before any transaction is decoded
+bool SplitNodeForwardTxnBlock(
+    const bytes& src, const unsigned int offset, NodeForwardTxnBlock& header,
+    vector<pair<unsigned int, unsigned int>>& txnRanges) {
+  using google::protobuf::internal::WireFormatLite;
+
+  if (offset > src.size()) {
+    LOG_GENERAL(WARNING, "NodeForwardTxnBlock offset out of range.");
+    return false;
+  }
+
+  const int size = src.size() - offset;
+  const char* data = reinterpret_cast<const char*>(src.data()) + offset;
+  google::protobuf::io::CodedInputStream input(src.data() + offset, size);
+
+  string headerBytes;
+  while (input.CurrentPosition() < size) {
+    const int start = input.CurrentPosition();
+    const uint32_t tag = input.ReadTag();
+
+    if (WireFormatLite::GetTagFieldNumber(tag) ==
+            NodeForwardTxnBlock::kTransactionsFieldNumber &&
+        WireFormatLite::GetTagWireType(tag) ==
+            WireFormatLite::WIRETYPE_LENGTH_DELIMITED) {
+      uint32_t length = 0;
+      if (!input.ReadVarint32(&length)) {
+        LOG_GENERAL(WARNING, "Bad transaction length in NodeForwardTxnBlock.");
+        return false;
+      }
+      const int begin = input.CurrentPosition();
+      if (!input.Skip(length)) {
+        LOG_GENERAL(WARNING, "Truncated transaction in NodeForwardTxnBlock.");
+        return false;
+      }
+      txnRanges.emplace_back(offset + begin, length);
+      continue;
+    }
+
+    if (tag == 0 || !WireFormatLite::SkipField(&input, tag)) {
+      LOG_GENERAL(WARNING, "Bad field in NodeForwardTxnBlock.");
+      return false;
+    }
+    headerBytes.append(data + start, input.CurrentPosition() - start);
+  }
+
+  if (!header.ParseFromString(headerBytes) || !header.IsInitialized()) {
+    LOG_GENERAL(WARNING, "NodeForwardTxnBlock initialization failed.");
+    return false;
+  }
+
+  return true;
+}
+
+}  // namespace
+
+bool Messenger::GetNodeForwardTxnBlockHeader(
+    const bytes& src, const unsigned int offset, uint64_t& epochNumber,
+    uint64_t& dsBlockNum, uint32_t& shardId, PubKey& lookupPubKey) {
+  LOG_MARKER();
+
+  NodeForwardTxnBlock header;
+  vector<pair<unsigned int, unsigned int>> txnRanges;
+  if (!SplitNodeForwardTxnBlock(src, offset, header, txnRanges)) {
+    return false;
+  }
+
+  epochNumber = header.epochnumber();
+  dsBlockNum = header.dsblocknum();
+  shardId = header.shardid();
+  ProtobufByteArrayToSerializable(header.pubkey(), lookupPubKey);
+
+  LOG_GENERAL(INFO, "Epoch: " << epochNumber << " Shard: " << shardId
+                              << " Received txns: " << txnRanges.size());
+
+  return true;
+}
+
+bool Messenger::VerifyNodeForwardTxnBlock(const bytes& src,
+                                          const unsigned int offset,
+                                          const PubKey& lookupPubKey) {
+  LOG_MARKER();
+
+  NodeForwardTxnBlock header;
+  vector<pair<unsigned int, unsigned int>> txnRanges;
+  if (!SplitNodeForwardTxnBlock(src, offset, header, txnRanges)) {
+    return false;
+  }
+
+  if (txnRanges.empty()) {
+    return true;
+  }
+
+  // The lookup signs the transactions serialized back to back, which is
+  // exactly their payloads on the wire
+  size_t totalSize = 0;
+  for (const auto& range : txnRanges) {
+    totalSize += range.second;
+  }
+  bytes tmp;
+  tmp.reserve(totalSize);
+  for (const auto& range : txnRanges) {
+    tmp.insert(tmp.end(), src.begin() + range.first,
+               src.begin() + range.first + range.second);
+  }
+
+  Signature signature;
+  ProtobufByteArrayToSerializable(header.signature(), signature);
+
+  if (!Schnorr::GetInstance().Verify(tmp, signature, lookupPubKey)) {
+    LOG_GENERAL(WARNING, "Invalid signature in transactions.");
+    return false;
+  }
+
+  return true;
+}
+
+bool Messenger::GetNodeForwardTxnBlockTransactions(
+    const bytes& src, const unsigned int offset, unsigned int batchSize,
+    const function<void(vector<Transaction>& txns)>& onBatch) {
+  LOG_MARKER();
+
+  NodeForwardTxnBlock header;
+  vector<pair<unsigned int, unsigned int>> txnRanges;
+  if (!SplitNodeForwardTxnBlock(src, offset, header, txnRanges)) {
+    return false;
+  }
+
+  batchSize = max(batchSize, 1u);
+  for (size_t begin = 0; begin < txnRanges.size(); begin += batchSize) {
+    const size_t end = min<size_t>(begin + batchSize, txnRanges.size());
+
+    ArenaMessage<NodeForwardTxnBlock> arenaMessage;
+    auto& protoTxns = *arenaMessage.Get().mutable_transactions();
+    protoTxns.Reserve(end - begin);
+    for (size_t i = begin; i < end; i++) {
+      if (!protoTxns.Add()->ParseFromArray(src.data() + txnRanges[i].first,
+                                           txnRanges[i].second)) {
+        LOG_GENERAL(WARNING, "Failed to parse transaction " << i);
+        return false;
+      }
+    }
+
+    vector<Transaction> txns;
+    ProtobufToTransactions(protoTxns, txns);
+    onBatch(txns);
+  }
+
+  return true;
+}
+
 bool Messenger::SetNodeMicroBlockAnnouncement(
     bytes& dst, const unsigned int offset, const uint32_t consensusID,
     const uint64_t blockNumber, const bytes& blockHash, const uint16_t leaderID,
@@ -4503,56 +5379,239 @@ bool Messenger::ArrayToShardStructure(const bytes& src,
   return ProtobufToShardingStructure(protoShardingStructure, version, shards);
 }
 
-bool Messenger::SetNodeMissingTxnsErrorMsg(
-    bytes& dst, const unsigned int offset,
-    const vector<TxnHash>& missingTxnHashes, const uint64_t epochNum,
-    const uint32_t listenPort) {
+bool Messenger::SetNodeMissingTxnsErrorMsg(
+    bytes& dst, const unsigned int offset,
+    const vector<TxnHash>& missingTxnHashes, const uint64_t epochNum,
+    const uint32_t listenPort) {
+  LOG_MARKER();
+
+  NodeMissingTxnsErrorMsg result;
+
+  for (const auto& hash : missingTxnHashes) {
+    LOG_EPOCH(INFO, epochNum, "Missing txn: " << hash);
+    result.add_txnhashes(hash.data(), hash.size);
+  }
+
+  result.set_epochnum(epochNum);
+  result.set_listenport(listenPort);
+
+  if (!result.IsInitialized()) {
+    LOG_GENERAL(WARNING, "NodeMissingTxnsErrorMsg initialization failed.");
+    return false;
+  }
+
+  return SerializeToArray(result, dst, offset);
+}
+
+bool Messenger::GetNodeMissingTxnsErrorMsg(const bytes& src,
+                                           const unsigned int offset,
+                                           vector<TxnHash>& missingTxnHashes,
+                                           uint64_t& epochNum,
+                                           uint32_t& listenPort) {
+  LOG_MARKER();
+
+  NodeMissingTxnsErrorMsg result;
+
+  result.ParseFromArray(src.data() + offset, src.size() - offset);
+
+  if (!result.IsInitialized()) {
+    LOG_GENERAL(WARNING, "NodeMissingTxnsErrorMsg initialization failed.");
+    return false;
+  }
+
+  for (const auto& hash : result.txnhashes()) {
+    missingTxnHashes.emplace_back();
+    unsigned int size = min((unsigned int)hash.size(),
+                            (unsigned int)missingTxnHashes.back().size);
+    copy(hash.begin(), hash.begin() + size,
+         missingTxnHashes.back().asArray().begin());
+  }
+
+  epochNum = result.epochnum();
+  listenPort = result.listenport();
+
+  return true;
+}
+
+bool Messenger::SetNodeTxnPoolShortHashes(bytes& dst,
+                                          const unsigned int offset,
+                                          const vector<uint64_t>& shortHashes,
+                                          const uint64_t epochNum,
+                                          const uint32_t listenPort) {
+  LOG_MARKER();
+
+  NodeTxnPoolShortHashes result;
+
+  result.mutable_shorthashes()->Reserve(shortHashes.size());
+  for (const auto& shortHash : shortHashes) {
+    result.add_shorthashes(shortHash);
+  }
+
+  result.set_epochnum(epochNum);
+  result.set_listenport(listenPort);
+
+  if (!result.IsInitialized()) {
+    LOG_GENERAL(WARNING, "NodeTxnPoolShortHashes initialization failed.");
+    return false;
+  }
+
+  return SerializeToArray(result, dst, offset);
+}
+
+bool Messenger::GetNodeTxnPoolShortHashes(const bytes& src,
+                                          const unsigned int offset,
+                                          vector<uint64_t>& shortHashes,
+                                          uint64_t& epochNum,
+                                          uint32_t& listenPort) {
+  LOG_MARKER();
+
+  NodeTxnPoolShortHashes result;
+
+  result.ParseFromArray(src.data() + offset, src.size() - offset);
+
+  if (!result.IsInitialized()) {
+    LOG_GENERAL(WARNING, "NodeTxnPoolShortHashes initialization failed.");
+    return false;
+  }
+
+  shortHashes.assign(result.shorthashes().begin(),
+                     result.shorthashes().end());
+  epochNum = result.epochnum();
+  listenPort = result.listenport();
+
+  return true;
+}
+
+bool Messenger::SetNodeBlockChunk(bytes& dst, const unsigned int offset,
+                                  const bytes& msgHash, const uint64_t msgSize,
+                                  const uint32_t dataChunks,
+                                  const uint32_t totalChunks,
+                                  const uint32_t index, const bytes& chunk,
+                                  const bool relay) {
+  LOG_MARKER();
+
+  NodeBlockChunk result;
+
+  result.set_msghash(msgHash.data(), msgHash.size());
+  result.set_msgsize(msgSize);
+  result.set_datachunks(dataChunks);
+  result.set_totalchunks(totalChunks);
+  result.set_index(index);
+  result.set_chunk(chunk.data(), chunk.size());
+  result.set_relay(relay);
+
+  if (!result.IsInitialized()) {
+    LOG_GENERAL(WARNING, "NodeBlockChunk initialization failed.");
+    return false;
+  }
+
+  return SerializeToArray(result, dst, offset);
+}
+
+bool Messenger::GetNodeBlockChunk(const bytes& src, const unsigned int offset,
+                                  bytes& msgHash, uint64_t& msgSize,
+                                  uint32_t& dataChunks, uint32_t& totalChunks,
+                                  uint32_t& index, bytes& chunk, bool& relay) {
+  LOG_MARKER();
+
+  NodeBlockChunk result;
+
+  result.ParseFromArray(src.data() + offset, src.size() - offset);
+
+  if (!result.IsInitialized()) {
+    LOG_GENERAL(WARNING, "NodeBlockChunk initialization failed.");
+    return false;
+  }
+
+  msgHash.assign(result.msghash().begin(), result.msghash().end());
+  msgSize = result.msgsize();
+  dataChunks = result.datachunks();
+  totalChunks = result.totalchunks();
+  index = result.index();
+  chunk.assign(result.chunk().begin(), result.chunk().end());
+  relay = result.relay();
+
+  return true;
+}
+
+bool Messenger::SetNodeGetUpgradeChunk(bytes& dst, const unsigned int offset,
+                                       const bytes& sha, const uint32_t index,
+                                       const uint32_t listenPort) {
+  LOG_MARKER();
+
+  NodeGetUpgradeChunk result;
+
+  result.set_sha(sha.data(), sha.size());
+  result.set_index(index);
+  result.set_listenport(listenPort);
+
+  if (!result.IsInitialized()) {
+    LOG_GENERAL(WARNING, "NodeGetUpgradeChunk initialization failed.");
+    return false;
+  }
+
+  return SerializeToArray(result, dst, offset);
+}
+
+bool Messenger::GetNodeGetUpgradeChunk(const bytes& src,
+                                       const unsigned int offset, bytes& sha,
+                                       uint32_t& index, uint32_t& listenPort) {
   LOG_MARKER();
 
-  NodeMissingTxnsErrorMsg result;
+  NodeGetUpgradeChunk result;
 
-  for (const auto& hash : missingTxnHashes) {
-    LOG_EPOCH(INFO, epochNum, "Missing txn: " << hash);
-    result.add_txnhashes(hash.data(), hash.size);
+  result.ParseFromArray(src.data() + offset, src.size() - offset);
+
+  if (!result.IsInitialized()) {
+    LOG_GENERAL(WARNING, "NodeGetUpgradeChunk initialization failed.");
+    return false;
   }
 
-  result.set_epochnum(epochNum);
-  result.set_listenport(listenPort);
+  sha.assign(result.sha().begin(), result.sha().end());
+  index = result.index();
+  listenPort = result.listenport();
+
+  return true;
+}
+
+bool Messenger::SetNodeUpgradeChunk(bytes& dst, const unsigned int offset,
+                                    const bytes& sha, const uint64_t size,
+                                    const uint32_t index, const bytes& chunk) {
+  LOG_MARKER();
+
+  NodeUpgradeChunk result;
+
+  result.set_sha(sha.data(), sha.size());
+  result.set_size(size);
+  result.set_index(index);
+  result.set_chunk(chunk.data(), chunk.size());
 
   if (!result.IsInitialized()) {
-    LOG_GENERAL(WARNING, "NodeMissingTxnsErrorMsg initialization failed.");
+    LOG_GENERAL(WARNING, "NodeUpgradeChunk initialization failed.");
     return false;
   }
 
   return SerializeToArray(result, dst, offset);
 }
 
-bool Messenger::GetNodeMissingTxnsErrorMsg(const bytes& src,
-                                           const unsigned int offset,
-                                           vector<TxnHash>& missingTxnHashes,
-                                           uint64_t& epochNum,
-                                           uint32_t& listenPort) {
+bool Messenger::GetNodeUpgradeChunk(const bytes& src, const unsigned int offset,
+                                    bytes& sha, uint64_t& size,
+                                    uint32_t& index, bytes& chunk) {
   LOG_MARKER();
 
-  NodeMissingTxnsErrorMsg result;
+  NodeUpgradeChunk result;
 
   result.ParseFromArray(src.data() + offset, src.size() - offset);
 
   if (!result.IsInitialized()) {
-    LOG_GENERAL(WARNING, "NodeMissingTxnsErrorMsg initialization failed.");
+    LOG_GENERAL(WARNING, "NodeUpgradeChunk initialization failed.");
     return false;
   }
 
-  for (const auto& hash : result.txnhashes()) {
-    missingTxnHashes.emplace_back();
-    unsigned int size = min((unsigned int)hash.size(),
-                            (unsigned int)missingTxnHashes.back().size);
-    copy(hash.begin(), hash.begin() + size,
-         missingTxnHashes.back().asArray().begin());
-  }
-
-  epochNum = result.epochnum();
-  listenPort = result.listenport();
+  sha.assign(result.sha().begin(), result.sha().end());
+  size = result.size();
+  index = result.index();
+  chunk.assign(result.chunk().begin(), result.chunk().end());
 
   return true;
 }
@@ -5031,10 +6090,10 @@ bool Messenger::SetLookupSetTxBlockFromSeed(bytes& dst,
 
 bool Messenger::GetLookupSetTxBlockFromSeed(
     const bytes& src, const unsigned int offset, uint64_t& lowBlockNum,
-    uint64_t& highBlockNum, PubKey& lookupPubKey, vector<TxBlock>& txBlocks) {
+    uint64_t& highBlockNum, PubKey& lookupPubKey, vector<bytes>& txBlocks) {
   LOG_MARKER();
 
-  LookupSetTxBlockFromSeed result;
+  LookupSetTxBlockFromSeedView result;
 
   result.ParseFromArray(src.data() + offset, src.size() - offset);
 
@@ -5046,23 +6105,15 @@ bool Messenger::GetLookupSetTxBlockFromSeed(
   lowBlockNum = result.lowblocknum();
   highBlockNum = result.highblocknum();
 
-  for (const auto& txblock : result.txblocks()) {
-    TxBlock block;
-    if (!ProtobufToTxBlock(txblock, block)) {
-      continue;
-    }
-    txBlocks.emplace_back(block);
-  }
-
   ProtobufByteArrayToSerializable(result.pubkey(), lookupPubKey);
   Signature signature;
   ProtobufByteArrayToSerializable(result.signature(), signature);
 
   if (result.txblocks().size() > 0) {
+    // The blocks were signed as serialized, so their bytes are verified as is
     bytes tmp;
-    if (!RepeatableToArray(result.txblocks(), tmp, 0)) {
-      LOG_GENERAL(WARNING, "Failed to serialize tx blocks.");
-      return false;
+    for (const auto& txblock : result.txblocks()) {
+      tmp.insert(tmp.end(), txblock.begin(), txblock.end());
     }
 
     if (!Schnorr::GetInstance().Verify(tmp, signature, lookupPubKey)) {
@@ -5071,6 +6122,11 @@ bool Messenger::GetLookupSetTxBlockFromSeed(
     }
   }
 
+  txBlocks.reserve(result.txblocks().size());
+  for (const auto& txblock : result.txblocks()) {
+    txBlocks.emplace_back(txblock.begin(), txblock.end());
+  }
+
   return true;
 }
 
@@ -5125,12 +6181,21 @@ bool Messenger::SetLookupSetStateDeltaFromSeed(bytes& dst,
 
   result.set_blocknum(blockNum);
 
-  result.set_statedelta(stateDelta.data(), stateDelta.size());
+  if (STATE_DELTA_WIRE_COMPRESSION) {
+    string compressed;
+    snappy::Compress(reinterpret_cast<const char*>(stateDelta.data()),
+                     stateDelta.size(), &compressed);
+    result.set_statedelta(compressed);
+    result.set_compressed(true);
+  } else {
+    result.set_statedelta(stateDelta.data(), stateDelta.size());
+  }
 
   SerializableToProtobufByteArray(lookupKey.second, *result.mutable_pubkey());
 
   Signature signature;
 
+  // The signature covers the uncompressed delta
   if (!Schnorr::GetInstance().Sign(stateDelta, lookupKey.first,
                                    lookupKey.second, signature)) {
     LOG_GENERAL(WARNING, "Failed to sign state delta.");
@@ -5165,118 +6230,348 @@ bool Messenger::GetLookupSetStateDeltaFromSeed(const bytes& src,
 
   blockNum = result.blocknum();
 
-  stateDelta.resize(result.statedelta().size());
-  std::copy(result.statedelta().begin(), result.statedelta().end(),
-            stateDelta.begin());
+  if (result.compressed()) {
+    string uncompressed;
+    if (!snappy::Uncompress(result.statedelta().data(),
+                            result.statedelta().size(), &uncompressed)) {
+      LOG_GENERAL(WARNING, "Failed to uncompress state delta.");
+      return false;
+    }
+    stateDelta.assign(uncompressed.begin(), uncompressed.end());
+  } else {
+    stateDelta.resize(result.statedelta().size());
+    std::copy(result.statedelta().begin(), result.statedelta().end(),
+              stateDelta.begin());
+  }
+
+  ProtobufByteArrayToSerializable(result.pubkey(), lookupPubKey);
+  Signature signature;
+  ProtobufByteArrayToSerializable(result.signature(), signature);
+
+  if (!Schnorr::GetInstance().Verify(stateDelta, signature, lookupPubKey)) {
+    LOG_GENERAL(WARNING, "Invalid signature in state delta.");
+    return false;
+  }
+
+  return true;
+}
+
+bool Messenger::SetLookupGetStateFromSeed(bytes& dst, const unsigned int offset,
+                                          const uint32_t listenPort) {
+  LOG_MARKER();
+
+  LookupGetStateFromSeed result;
+
+  result.set_listenport(listenPort);
+
+  if (!result.IsInitialized()) {
+    LOG_GENERAL(WARNING, "LookupGetStateFromSeed initialization failed.");
+    return false;
+  }
+
+  return SerializeToArray(result, dst, offset);
+}
+
+bool Messenger::GetLookupGetStateFromSeed(const bytes& src,
+                                          const unsigned int offset,
+                                          uint32_t& listenPort) {
+  LOG_MARKER();
+
+  LookupGetStateFromSeed result;
+
+  result.ParseFromArray(src.data() + offset, src.size() - offset);
+
+  if (!result.IsInitialized()) {
+    LOG_GENERAL(WARNING, "LookupGetStateFromSeed initialization failed.");
+    return false;
+  }
+
+  listenPort = result.listenport();
+
+  return true;
+}
+
+bool Messenger::SetLookupSetStateFromSeed(bytes& dst, const unsigned int offset,
+                                          const PairOfKey& lookupKey,
+                                          const AccountStore& accountStore) {
+  LOG_MARKER();
+
+  LookupSetStateFromSeed result;
+
+  SerializableToProtobufByteArray(lookupKey.second, *result.mutable_pubkey());
+  Signature signature;
+
+  bytes tmp;
+
+  if (!accountStore.Serialize(tmp, 0)) {
+    LOG_GENERAL(WARNING, "Failed to serialize AccountStore.");
+    return false;
+  }
+  result.mutable_accountstore()->set_data(tmp.data(), tmp.size());
+
+  if (!Schnorr::GetInstance().Sign(tmp, lookupKey.first, lookupKey.second,
+                                   signature)) {
+    LOG_GENERAL(WARNING, "Failed to sign accounts.");
+    return false;
+  }
+
+  SerializableToProtobufByteArray(signature, *result.mutable_signature());
+
+  if (!result.IsInitialized()) {
+    LOG_GENERAL(WARNING, "LookupSetStateFromSeed initialization failed.");
+    return false;
+  }
+
+  return SerializeToArray(result, dst, offset);
+}
+
+bool Messenger::GetLookupSetStateFromSeed(const bytes& src,
+                                          const unsigned int offset,
+                                          PubKey& lookupPubKey,
+                                          bytes& accountStoreBytes) {
+  LOG_MARKER();
+
+  LookupSetStateFromSeed result;
+
+  result.ParseFromArray(src.data() + offset, src.size() - offset);
+
+  if (!result.IsInitialized()) {
+    LOG_GENERAL(WARNING, "LookupSetStateFromSeed initialization failed.");
+    return false;
+  }
+
+  ProtobufByteArrayToSerializable(result.pubkey(), lookupPubKey);
+  Signature signature;
+  ProtobufByteArrayToSerializable(result.signature(), signature);
+
+  copy(result.accountstore().data().begin(), result.accountstore().data().end(),
+       back_inserter(accountStoreBytes));
+
+  if (!Schnorr::GetInstance().Verify(accountStoreBytes, signature,
+                                     lookupPubKey)) {
+    LOG_GENERAL(WARNING, "Invalid signature in accounts.");
+    return false;
+  }
+
+  return true;
+}
+
+bool Messenger::SetLookupGetStateSnapshotFromSeed(bytes& dst,
+                                                  const unsigned int offset,
+                                                  const uint32_t listenPort) {
+  LOG_MARKER();
+
+  LookupGetStateSnapshotFromSeed result;
+
+  result.set_listenport(listenPort);
+
+  if (!result.IsInitialized()) {
+    LOG_GENERAL(WARNING,
+                "LookupGetStateSnapshotFromSeed initialization failed.");
+    return false;
+  }
+
+  return SerializeToArray(result, dst, offset);
+}
+
+bool Messenger::GetLookupGetStateSnapshotFromSeed(const bytes& src,
+                                                  const unsigned int offset,
+                                                  uint32_t& listenPort) {
+  LOG_MARKER();
+
+  LookupGetStateSnapshotFromSeed result;
+
+  result.ParseFromArray(src.data() + offset, src.size() - offset);
+
+  if (!result.IsInitialized()) {
+    LOG_GENERAL(WARNING,
+                "LookupGetStateSnapshotFromSeed initialization failed.");
+    return false;
+  }
+
+  listenPort = result.listenport();
+
+  return true;
+}
+
+bool Messenger::SetLookupSetStateSnapshotFromSeed(
+    bytes& dst, const unsigned int offset, const PairOfKey& lookupKey,
+    const uint64_t blockNum, const dev::h256& stateRoot,
+    const vector<dev::h256>& chunkHashes) {
+  LOG_MARKER();
+
+  LookupSetStateSnapshotFromSeed result;
+
+  result.mutable_data()->set_blocknum(blockNum);
+  result.mutable_data()->set_stateroot(stateRoot.data(), stateRoot.size);
+  for (const auto& chunkHash : chunkHashes) {
+    result.mutable_data()->add_chunkhashes(chunkHash.data(), chunkHash.size);
+  }
+  SerializableToProtobufByteArray(lookupKey.second, *result.mutable_pubkey());
+
+  Signature signature;
+  if (result.data().IsInitialized()) {
+    bytes tmp(result.data().ByteSize());
+    result.data().SerializeToArray(tmp.data(), tmp.size());
+
+    if (!Schnorr::GetInstance().Sign(tmp, lookupKey.first, lookupKey.second,
+                                     signature)) {
+      LOG_GENERAL(WARNING, "Failed to sign state snapshot manifest.");
+      return false;
+    }
+    SerializableToProtobufByteArray(signature, *result.mutable_signature());
+  } else {
+    LOG_GENERAL(WARNING,
+                "LookupSetStateSnapshotFromSeed.Data initialization failed.");
+    return false;
+  }
+
+  if (!result.IsInitialized()) {
+    LOG_GENERAL(WARNING,
+                "LookupSetStateSnapshotFromSeed initialization failed.");
+    return false;
+  }
+
+  return SerializeToArray(result, dst, offset);
+}
+
+bool Messenger::GetLookupSetStateSnapshotFromSeed(
+    const bytes& src, const unsigned int offset, PubKey& lookupPubKey,
+    uint64_t& blockNum, dev::h256& stateRoot, vector<dev::h256>& chunkHashes) {
+  LOG_MARKER();
+
+  LookupSetStateSnapshotFromSeed result;
+
+  result.ParseFromArray(src.data() + offset, src.size() - offset);
+
+  if (!result.IsInitialized() || !result.data().IsInitialized()) {
+    LOG_GENERAL(WARNING,
+                "LookupSetStateSnapshotFromSeed initialization failed.");
+    return false;
+  }
+
+  ProtobufByteArrayToSerializable(result.pubkey(), lookupPubKey);
+  Signature signature;
+  ProtobufByteArrayToSerializable(result.signature(), signature);
+
+  bytes tmp(result.data().ByteSize());
+  result.data().SerializeToArray(tmp.data(), tmp.size());
+
+  if (!Schnorr::GetInstance().Verify(tmp, 0, tmp.size(), signature,
+                                     lookupPubKey)) {
+    LOG_GENERAL(WARNING, "Invalid signature in state snapshot manifest.");
+    return false;
+  }
 
-  ProtobufByteArrayToSerializable(result.pubkey(), lookupPubKey);
-  Signature signature;
-  ProtobufByteArrayToSerializable(result.signature(), signature);
+  blockNum = result.data().blocknum();
+  copy(result.data().stateroot().begin(),
+       result.data().stateroot().begin() +
+           min((unsigned int)result.data().stateroot().size(),
+               (unsigned int)stateRoot.size),
+       stateRoot.asArray().begin());
 
-  if (!Schnorr::GetInstance().Verify(stateDelta, signature, lookupPubKey)) {
-    LOG_GENERAL(WARNING, "Invalid signature in state delta.");
-    return false;
+  chunkHashes.clear();
+  for (const auto& protoChunkHash : result.data().chunkhashes()) {
+    chunkHashes.emplace_back();
+    copy(protoChunkHash.begin(),
+         protoChunkHash.begin() + min((unsigned int)protoChunkHash.size(),
+                                      (unsigned int)chunkHashes.back().size),
+         chunkHashes.back().asArray().begin());
   }
 
   return true;
 }
 
-bool Messenger::SetLookupGetStateFromSeed(bytes& dst, const unsigned int offset,
-                                          const uint32_t listenPort) {
+bool Messenger::SetLookupGetStateChunkFromSeed(bytes& dst,
+                                               const unsigned int offset,
+                                               const uint32_t listenPort,
+                                               const dev::h256& stateRoot,
+                                               const uint32_t chunkIndex) {
   LOG_MARKER();
 
-  LookupGetStateFromSeed result;
+  LookupGetStateChunkFromSeed result;
 
   result.set_listenport(listenPort);
+  result.set_stateroot(stateRoot.data(), stateRoot.size);
+  result.set_chunkindex(chunkIndex);
 
   if (!result.IsInitialized()) {
-    LOG_GENERAL(WARNING, "LookupGetStateFromSeed initialization failed.");
+    LOG_GENERAL(WARNING, "LookupGetStateChunkFromSeed initialization failed.");
     return false;
   }
 
   return SerializeToArray(result, dst, offset);
 }
 
-bool Messenger::GetLookupGetStateFromSeed(const bytes& src,
-                                          const unsigned int offset,
-                                          uint32_t& listenPort) {
+bool Messenger::GetLookupGetStateChunkFromSeed(const bytes& src,
+                                               const unsigned int offset,
+                                               uint32_t& listenPort,
+                                               dev::h256& stateRoot,
+                                               uint32_t& chunkIndex) {
   LOG_MARKER();
 
-  LookupGetStateFromSeed result;
+  LookupGetStateChunkFromSeed result;
 
   result.ParseFromArray(src.data() + offset, src.size() - offset);
 
   if (!result.IsInitialized()) {
-    LOG_GENERAL(WARNING, "LookupGetStateFromSeed initialization failed.");
+    LOG_GENERAL(WARNING, "LookupGetStateChunkFromSeed initialization failed.");
     return false;
   }
 
   listenPort = result.listenport();
+  copy(result.stateroot().begin(),
+       result.stateroot().begin() + min((unsigned int)result.stateroot().size(),
+                                        (unsigned int)stateRoot.size),
+       stateRoot.asArray().begin());
+  chunkIndex = result.chunkindex();
 
   return true;
 }
 
-bool Messenger::SetLookupSetStateFromSeed(bytes& dst, const unsigned int offset,
-                                          const PairOfKey& lookupKey,
-                                          const AccountStore& accountStore) {
+bool Messenger::SetLookupSetStateChunkFromSeed(bytes& dst,
+                                               const unsigned int offset,
+                                               const dev::h256& stateRoot,
+                                               const uint32_t chunkIndex,
+                                               const bytes& chunk) {
   LOG_MARKER();
 
-  LookupSetStateFromSeed result;
-
-  SerializableToProtobufByteArray(lookupKey.second, *result.mutable_pubkey());
-  Signature signature;
-
-  bytes tmp;
-
-  if (!accountStore.Serialize(tmp, 0)) {
-    LOG_GENERAL(WARNING, "Failed to serialize AccountStore.");
-    return false;
-  }
-  result.mutable_accountstore()->set_data(tmp.data(), tmp.size());
-
-  if (!Schnorr::GetInstance().Sign(tmp, lookupKey.first, lookupKey.second,
-                                   signature)) {
-    LOG_GENERAL(WARNING, "Failed to sign accounts.");
-    return false;
-  }
+  LookupSetStateChunkFromSeed result;
 
-  SerializableToProtobufByteArray(signature, *result.mutable_signature());
+  result.set_stateroot(stateRoot.data(), stateRoot.size);
+  result.set_chunkindex(chunkIndex);
+  result.set_chunk(chunk.data(), chunk.size());
 
   if (!result.IsInitialized()) {
-    LOG_GENERAL(WARNING, "LookupSetStateFromSeed initialization failed.");
+    LOG_GENERAL(WARNING, "LookupSetStateChunkFromSeed initialization failed.");
     return false;
   }
 
   return SerializeToArray(result, dst, offset);
 }
 
-bool Messenger::GetLookupSetStateFromSeed(const bytes& src,
-                                          const unsigned int offset,
-                                          PubKey& lookupPubKey,
-                                          bytes& accountStoreBytes) {
+bool Messenger::GetLookupSetStateChunkFromSeed(const bytes& src,
+                                               const unsigned int offset,
+                                               dev::h256& stateRoot,
+                                               uint32_t& chunkIndex,
+                                               bytes& chunk) {
   LOG_MARKER();
 
-  LookupSetStateFromSeed result;
+  LookupSetStateChunkFromSeed result;
 
   result.ParseFromArray(src.data() + offset, src.size() - offset);
 
   if (!result.IsInitialized()) {
-    LOG_GENERAL(WARNING, "LookupSetStateFromSeed initialization failed.");
+    LOG_GENERAL(WARNING, "LookupSetStateChunkFromSeed initialization failed.");
     return false;
   }
 
-  ProtobufByteArrayToSerializable(result.pubkey(), lookupPubKey);
-  Signature signature;
-  ProtobufByteArrayToSerializable(result.signature(), signature);
-
-  copy(result.accountstore().data().begin(), result.accountstore().data().end(),
-       back_inserter(accountStoreBytes));
-
-  if (!Schnorr::GetInstance().Verify(accountStoreBytes, signature,
-                                     lookupPubKey)) {
-    LOG_GENERAL(WARNING, "Invalid signature in accounts.");
-    return false;
-  }
+  copy(result.stateroot().begin(),
+       result.stateroot().begin() + min((unsigned int)result.stateroot().size(),
+                                        (unsigned int)stateRoot.size),
+       stateRoot.asArray().begin());
+  chunkIndex = result.chunkindex();
+  chunk.assign(result.chunk().begin(), result.chunk().end());
 
   return true;
 }
@@ -5941,7 +7236,8 @@ bool Messenger::GetLookupSetMicroBlockFromLookup(const bytes& src,
                                                  PubKey& lookupPubKey,
                                                  vector<MicroBlock>& mbs) {
   LOG_MARKER();
-  LookupSetMicroBlockFromLookup result;
+  ArenaMessage<LookupSetMicroBlockFromLookup> arenaMessage;
+  LookupSetMicroBlockFromLookup& result = arenaMessage.Get();
 
   result.ParseFromArray(src.data() + offset, src.size() - offset);
 
@@ -6072,7 +7368,8 @@ bool Messenger::GetLookupSetTxnsFromLookup(
     vector<TransactionWithReceipt>& txns) {
   LOG_MARKER();
 
-  LookupSetTxnsFromLookup result;
+  ArenaMessage<LookupSetTxnsFromLookup> arenaMessage;
+  LookupSetTxnsFromLookup& result = arenaMessage.Get();
 
   result.ParseFromArray(src.data() + offset, src.size() - offset);
 
@@ -6785,6 +8082,251 @@ bool Messenger::GetConsensusCollectiveSig(
   return true;
 }
 
+bool Messenger::SetConsensusAggregatedCommit(
+    bytes& dst, const unsigned int offset, const uint32_t consensusID,
+    const uint64_t blockNumber, const bytes& blockHash,
+    const uint16_t aggregatorID, const vector<bool>& bitmap,
+    const CommitPoint& aggregatedCommit,
+    const pair<PrivKey, PubKey>& aggregatorKey) {
+  LOG_MARKER();
+
+  ConsensusAggregatedCommit result;
+
+  result.mutable_consensusinfo()->set_consensusid(consensusID);
+  result.mutable_consensusinfo()->set_blocknumber(blockNumber);
+  result.mutable_consensusinfo()->set_blockhash(blockHash.data(),
+                                                blockHash.size());
+  result.mutable_consensusinfo()->set_backupid(aggregatorID);
+  for (const auto& i : bitmap) {
+    result.mutable_consensusinfo()->add_bitmap(i);
+  }
+  SerializableToProtobufByteArray(
+      aggregatedCommit,
+      *result.mutable_consensusinfo()->mutable_aggregatedcommit());
+
+  if (!result.consensusinfo().IsInitialized()) {
+    LOG_GENERAL(WARNING,
+                "ConsensusAggregatedCommit.Data initialization failed.");
+    return false;
+  }
+
+  bytes tmp(result.consensusinfo().ByteSize());
+  result.consensusinfo().SerializeToArray(tmp.data(), tmp.size());
+
+  Signature signature;
+
+  if (!Schnorr::GetInstance().Sign(tmp, aggregatorKey.first,
+                                   aggregatorKey.second, signature)) {
+    LOG_GENERAL(WARNING, "Failed to sign aggregated commit.");
+    return false;
+  }
+
+  SerializableToProtobufByteArray(signature, *result.mutable_signature());
+
+  if (!result.IsInitialized()) {
+    LOG_GENERAL(WARNING, "ConsensusAggregatedCommit initialization failed.");
+    return false;
+  }
+
+  return SerializeToArray(result, dst, offset);
+}
+
+bool Messenger::GetConsensusAggregatedCommit(
+    const bytes& src, const unsigned int offset, const uint32_t consensusID,
+    const uint64_t blockNumber, const bytes& blockHash, uint16_t& aggregatorID,
+    vector<bool>& bitmap, CommitPoint& aggregatedCommit,
+    const deque<pair<PubKey, Peer>>& committeeKeys) {
+  LOG_MARKER();
+
+  ConsensusAggregatedCommit result;
+
+  result.ParseFromArray(src.data() + offset, src.size() - offset);
+
+  if (!result.IsInitialized()) {
+    LOG_GENERAL(WARNING, "ConsensusAggregatedCommit initialization failed.");
+    return false;
+  }
+
+  if (result.consensusinfo().consensusid() != consensusID) {
+    LOG_GENERAL(WARNING, "Consensus ID mismatch. Expected: "
+                             << consensusID << " Actual: "
+                             << result.consensusinfo().consensusid());
+    return false;
+  }
+
+  if (result.consensusinfo().blocknumber() != blockNumber) {
+    LOG_GENERAL(WARNING, "Block number mismatch. Expected: "
+                             << blockNumber << " Actual: "
+                             << result.consensusinfo().blocknumber());
+    return false;
+  }
+
+  const auto& tmpBlockHash = result.consensusinfo().blockhash();
+  if (!std::equal(blockHash.begin(), blockHash.end(), tmpBlockHash.begin(),
+                  tmpBlockHash.end(),
+                  [](const unsigned char left, const char right) -> bool {
+                    return left == (unsigned char)right;
+                  })) {
+    LOG_GENERAL(WARNING, "Block hash mismatch in aggregated commit");
+    return false;
+  }
+
+  aggregatorID = result.consensusinfo().backupid();
+
+  if (aggregatorID >= committeeKeys.size()) {
+    LOG_GENERAL(WARNING, "Aggregator ID beyond shard size. Aggregator ID: "
+                             << aggregatorID
+                             << " Shard size: " << committeeKeys.size());
+    return false;
+  }
+
+  for (const auto& i : result.consensusinfo().bitmap()) {
+    bitmap.emplace_back(i);
+  }
+
+  ProtobufByteArrayToSerializable(result.consensusinfo().aggregatedcommit(),
+                                  aggregatedCommit);
+
+  bytes tmp(result.consensusinfo().ByteSize());
+  result.consensusinfo().SerializeToArray(tmp.data(), tmp.size());
+
+  Signature signature;
+
+  ProtobufByteArrayToSerializable(result.signature(), signature);
+
+  if (!Schnorr::GetInstance().Verify(tmp, signature,
+                                     committeeKeys.at(aggregatorID).first)) {
+    LOG_GENERAL(WARNING, "Invalid signature in aggregated commit.");
+    return false;
+  }
+
+  return true;
+}
+
+bool Messenger::SetConsensusAggregatedResponse(
+    bytes& dst, const unsigned int offset, const uint32_t consensusID,
+    const uint64_t blockNumber, const uint16_t subsetID, const bytes& blockHash,
+    const uint16_t aggregatorID, const vector<bool>& bitmap,
+    const Response& aggregatedResponse,
+    const pair<PrivKey, PubKey>& aggregatorKey) {
+  LOG_MARKER();
+
+  ConsensusAggregatedResponse result;
+
+  result.mutable_consensusinfo()->set_consensusid(consensusID);
+  result.mutable_consensusinfo()->set_blocknumber(blockNumber);
+  result.mutable_consensusinfo()->set_blockhash(blockHash.data(),
+                                                blockHash.size());
+  result.mutable_consensusinfo()->set_backupid(aggregatorID);
+  result.mutable_consensusinfo()->set_subsetid(subsetID);
+  for (const auto& i : bitmap) {
+    result.mutable_consensusinfo()->add_bitmap(i);
+  }
+  SerializableToProtobufByteArray(
+      aggregatedResponse,
+      *result.mutable_consensusinfo()->mutable_aggregatedresponse());
+
+  if (!result.consensusinfo().IsInitialized()) {
+    LOG_GENERAL(WARNING,
+                "ConsensusAggregatedResponse.Data initialization failed.");
+    return false;
+  }
+
+  bytes tmp(result.consensusinfo().ByteSize());
+  result.consensusinfo().SerializeToArray(tmp.data(), tmp.size());
+
+  Signature signature;
+
+  if (!Schnorr::GetInstance().Sign(tmp, aggregatorKey.first,
+                                   aggregatorKey.second, signature)) {
+    LOG_GENERAL(WARNING, "Failed to sign aggregated response.");
+    return false;
+  }
+
+  SerializableToProtobufByteArray(signature, *result.mutable_signature());
+
+  if (!result.IsInitialized()) {
+    LOG_GENERAL(WARNING, "ConsensusAggregatedResponse initialization failed.");
+    return false;
+  }
+
+  return SerializeToArray(result, dst, offset);
+}
+
+bool Messenger::GetConsensusAggregatedResponse(
+    const bytes& src, const unsigned int offset, const uint32_t consensusID,
+    const uint64_t blockNumber, const bytes& blockHash, uint16_t& aggregatorID,
+    uint16_t& subsetID, vector<bool>& bitmap, Response& aggregatedResponse,
+    const deque<pair<PubKey, Peer>>& committeeKeys) {
+  LOG_MARKER();
+
+  ConsensusAggregatedResponse result;
+
+  result.ParseFromArray(src.data() + offset, src.size() - offset);
+
+  if (!result.IsInitialized()) {
+    LOG_GENERAL(WARNING, "ConsensusAggregatedResponse initialization failed.");
+    return false;
+  }
+
+  if (result.consensusinfo().consensusid() != consensusID) {
+    LOG_GENERAL(WARNING, "Consensus ID mismatch. Expected: "
+                             << consensusID << " Actual: "
+                             << result.consensusinfo().consensusid());
+    return false;
+  }
+
+  if (result.consensusinfo().blocknumber() != blockNumber) {
+    LOG_GENERAL(WARNING, "Block number mismatch. Expected: "
+                             << blockNumber << " Actual: "
+                             << result.consensusinfo().blocknumber());
+    return false;
+  }
+
+  const auto& tmpBlockHash = result.consensusinfo().blockhash();
+  if (!std::equal(blockHash.begin(), blockHash.end(), tmpBlockHash.begin(),
+                  tmpBlockHash.end(),
+                  [](const unsigned char left, const char right) -> bool {
+                    return left == (unsigned char)right;
+                  })) {
+    LOG_GENERAL(WARNING, "Block hash mismatch in aggregated response");
+    return false;
+  }
+
+  aggregatorID = result.consensusinfo().backupid();
+
+  if (aggregatorID >= committeeKeys.size()) {
+    LOG_GENERAL(WARNING, "Aggregator ID beyond shard size. Aggregator ID: "
+                             << aggregatorID
+                             << " Shard size: " << committeeKeys.size());
+    return false;
+  }
+
+  subsetID = result.consensusinfo().subsetid();
+
+  for (const auto& i : result.consensusinfo().bitmap()) {
+    bitmap.emplace_back(i);
+  }
+
+  ProtobufByteArrayToSerializable(result.consensusinfo().aggregatedresponse(),
+                                  aggregatedResponse);
+
+  bytes tmp(result.consensusinfo().ByteSize());
+  result.consensusinfo().SerializeToArray(tmp.data(), tmp.size());
+
+  Signature signature;
+
+  ProtobufByteArrayToSerializable(result.signature(), signature);
+
+  if (!Schnorr::GetInstance().Verify(tmp, signature,
+                                     committeeKeys.at(aggregatorID).first)) {
+    LOG_GENERAL(WARNING, "Invalid signature in aggregated response.");
+    return false;
+  }
+
+  return true;
+}
+
 bool Messenger::SetConsensusCommitFailure(
     bytes& dst, const unsigned int offset, const uint32_t consensusID,
     const uint64_t blockNumber, const bytes& blockHash, const uint16_t backupID,
@@ -18,6 +18,7 @@
 #define __MESSENGER_H__
 
 #include <boost/variant.hpp>
+#include <functional>
 #include "common/BaseType.h"
 #include "common/Serializable.h"
 #include "libCrypto/Schnorr.h"
@@ -28,6 +29,7 @@
 #include "libDirectoryService/DirectoryService.h"
 #include "libNetwork/Peer.h"
 #include "libNetwork/ShardStruct.h"
+#include "libUtils/TxnCorpus.h"
 
 namespace ZilliqaMessage {
 class ByteArray;
@@ -91,6 +93,14 @@ class Messenger {
                                    const bool reversible);
   static bool GetAccountStoreDelta(const bytes& src, const unsigned int offset,
                                    AccountStoreTemp& accountStoreTemp);
+  /// Applies several deltas, with the same result as applying them one after
+  /// the other in order. The deltas are parsed in parallel and the accounts
+  /// they touch are merged in parallel, each account on a single thread, so
+  /// accounts changed by more than one delta are merged in delta order.
+  /// applied records which deltas were valid; invalid ones are skipped.
+  static bool GetAccountStoreDeltas(const std::vector<const bytes*>& deltas,
+                                    AccountStoreTemp& accountStoreTemp,
+                                    std::vector<bool>& applied);
 
   static bool GetMbInfoHash(const std::vector<MicroBlockInfo>& mbInfos,
                             MBInfoHash& dst);
@@ -104,6 +114,10 @@ class Messenger {
                          const DSBlock& dsBlock);
   static bool GetDSBlock(const bytes& src, const unsigned int offset,
                          DSBlock& dsBlock);
+  /// Decodes only the header of a block serialized by SetDSBlock
+  static bool GetDSBlockHeaderOfBlock(const bytes& src,
+                                      const unsigned int offset,
+                                      DSBlockHeader& dsBlockHeader);
 
   static bool SetMicroBlockHeader(bytes& dst, const unsigned int offset,
                                   const MicroBlockHeader& microBlockHeader);
@@ -113,6 +127,10 @@ class Messenger {
                             const MicroBlock& microBlock);
   static bool GetMicroBlock(const bytes& src, const unsigned int offset,
                             MicroBlock& microBlock);
+  /// Decodes only the header of a block serialized by SetMicroBlock
+  static bool GetMicroBlockHeaderOfBlock(const bytes& src,
+                                         const unsigned int offset,
+                                         MicroBlockHeader& microBlockHeader);
 
   static bool SetTxBlockHeader(bytes& dst, const unsigned int offset,
                                const TxBlockHeader& txBlockHeader);
@@ -122,6 +140,10 @@ class Messenger {
                          const TxBlock& txBlock);
   static bool GetTxBlock(const bytes& src, const unsigned int offset,
                          TxBlock& txBlock);
+  /// Decodes only the header of a block serialized by SetTxBlock
+  static bool GetTxBlockHeaderOfBlock(const bytes& src,
+                                      const unsigned int offset,
+                                      TxBlockHeader& txBlockHeader);
 
   static bool SetVCBlockHeader(bytes& dst, const unsigned int offset,
                                const VCBlockHeader& vcBlockHeader);
@@ -324,13 +346,26 @@ class Messenger {
                                        const std::vector<VCBlock>& vcBlocks,
                                        const uint32_t& shardingStructureVersion,
                                        const DequeOfShard& shards);
+  /// Same as above, but with shards sent as a diff against prevShards, the
+  /// structure whose hash is prevShardingHash
+  static bool SetNodeVCDSBlocksMessage(
+      bytes& dst, const unsigned int offset, const uint32_t shardId,
+      const DSBlock& dsBlock, const std::vector<VCBlock>& vcBlocks,
+      const uint32_t& shardingStructureVersion, const DequeOfShard& shards,
+      const DequeOfShard& prevShards, const ShardingHash& prevShardingHash);
+  /// Sets the shard id of a message composed by SetNodeVCDSBlocksMessage
+  /// without serializing its blocks and sharding structure again
+  static bool SetNodeVCDSBlocksMessageShardId(bytes& dst,
+                                              const unsigned int offset,
+                                              const uint32_t shardId);
 
   static bool GetNodeVCDSBlocksMessage(const bytes& src,
                                        const unsigned int offset,
                                        uint32_t& shardId, DSBlock& dsBlock,
                                        std::vector<VCBlock>& vcBlocks,
                                        uint32_t& shardingStructureVersion,
-                                       DequeOfShard& shards);
+                                       DequeOfShard& shards,
+                                       const DequeOfShard& prevShards = {});
 
   static bool SetNodeFinalBlock(bytes& dst, const unsigned int offset,
                                 const uint64_t dsBlockNumber,
@@ -354,17 +389,50 @@ class Messenger {
                                            const unsigned int offset,
                                            MBnForwardedTxnEntry& entry);
 
+  static bool SetNodeMBnForwardTxnHashes(
+      bytes& dst, const unsigned int offset, const MicroBlock& microBlock,
+      const std::vector<TransactionReceipt>& receipts,
+      const uint32_t listenPort);
+  static bool GetNodeMBnForwardTxnHashes(
+      const bytes& src, const unsigned int offset, MicroBlock& microBlock,
+      std::vector<TransactionReceipt>& receipts, uint32_t& listenPort);
+
   static bool SetNodeForwardTxnBlock(
       bytes& dst, const unsigned int offset, const uint64_t& epochNumber,
       const uint64_t& dsBlockNum, const uint32_t& shardId,
       const PairOfKey& lookupKey, const std::vector<Transaction>& txnsCurrent,
       const std::vector<Transaction>& txnsGenerated);
+  /// Same packet, with the generated txns copied as they are from slices of
+  /// a txn corpus instead of being serialized one by one
+  static bool SetNodeForwardTxnBlock(
+      bytes& dst, const unsigned int offset, const uint64_t& epochNumber,
+      const uint64_t& dsBlockNum, const uint32_t& shardId,
+      const PairOfKey& lookupKey, const std::vector<Transaction>& txnsCurrent,
+      const std::vector<TxnCorpus::Slice>& txnsGenerated);
   static bool GetNodeForwardTxnBlock(const bytes& src,
                                      const unsigned int offset,
                                      uint64_t& epochNumber,
                                      uint64_t& dsBlockNum, uint32_t& shardId,
                                      PubKey& lookupPubKey,
                                      std::vector<Transaction>& txns);
+  /// Reads every field of a NodeForwardTxnBlock but the transactions, which
+  /// are only skipped over
+  static bool GetNodeForwardTxnBlockHeader(const bytes& src,
+                                           const unsigned int offset,
+                                           uint64_t& epochNumber,
+                                           uint64_t& dsBlockNum,
+                                           uint32_t& shardId,
+                                           PubKey& lookupPubKey);
+  /// Checks the lookup signature over the transactions of a
+  /// NodeForwardTxnBlock without decoding them
+  static bool VerifyNodeForwardTxnBlock(const bytes& src,
+                                        const unsigned int offset,
+                                        const PubKey& lookupPubKey);
+  /// Decodes the transactions of a NodeForwardTxnBlock batchSize at a time,
+  /// handing each batch to onBatch before decoding the next one
+  static bool GetNodeForwardTxnBlockTransactions(
+      const bytes& src, const unsigned int offset, unsigned int batchSize,
+      const std::function<void(std::vector<Transaction>& txns)>& onBatch);
 
   static bool SetNodeMicroBlockAnnouncement(
       bytes& dst, const unsigned int offset, const uint32_t consensusID,
@@ -411,6 +479,41 @@ class Messenger {
                                          uint64_t& epochNum,
                                          uint32_t& listenPort);
 
+  static bool SetNodeTxnPoolShortHashes(
+      bytes& dst, const unsigned int offset,
+      const std::vector<uint64_t>& shortHashes, const uint64_t epochNum,
+      const uint32_t listenPort);
+  static bool GetNodeTxnPoolShortHashes(const bytes& src,
+                                        const unsigned int offset,
+                                        std::vector<uint64_t>& shortHashes,
+                                        uint64_t& epochNum,
+                                        uint32_t& listenPort);
+
+  static bool SetNodeBlockChunk(bytes& dst, const unsigned int offset,
+                                const bytes& msgHash, const uint64_t msgSize,
+                                const uint32_t dataChunks,
+                                const uint32_t totalChunks,
+                                const uint32_t index, const bytes& chunk,
+                                const bool relay);
+  static bool GetNodeBlockChunk(const bytes& src, const unsigned int offset,
+                                bytes& msgHash, uint64_t& msgSize,
+                                uint32_t& dataChunks, uint32_t& totalChunks,
+                                uint32_t& index, bytes& chunk, bool& relay);
+
+  static bool SetNodeGetUpgradeChunk(bytes& dst, const unsigned int offset,
+                                     const bytes& sha, const uint32_t index,
+                                     const uint32_t listenPort);
+  static bool GetNodeGetUpgradeChunk(const bytes& src,
+                                     const unsigned int offset, bytes& sha,
+                                     uint32_t& index, uint32_t& listenPort);
+
+  static bool SetNodeUpgradeChunk(bytes& dst, const unsigned int offset,
+                                  const bytes& sha, const uint64_t size,
+                                  const uint32_t index, const bytes& chunk);
+  static bool GetNodeUpgradeChunk(const bytes& src, const unsigned int offset,
+                                  bytes& sha, uint64_t& size, uint32_t& index,
+                                  bytes& chunk);
+
   // ============================================================================
   // Lookup messages
   // ============================================================================
@@ -475,12 +578,14 @@ class Messenger {
                                           const uint64_t highBlockNum,
                                           const PairOfKey& lookupKey,
                                           const std::vector<TxBlock>& txBlocks);
+  /// Leaves each tx block serialized so the caller decodes only the blocks
+  /// it keeps, using GetTxBlockHeaderOfBlock and GetTxBlock
   static bool GetLookupSetTxBlockFromSeed(const bytes& src,
                                           const unsigned int offset,
                                           uint64_t& lowBlockNum,
                                           uint64_t& highBlockNum,
                                           PubKey& lookupPubKey,
-                                          std::vector<TxBlock>& txBlocks);
+                                          std::vector<bytes>& txBlocks);
   static bool SetLookupGetStateDeltaFromSeed(bytes& dst,
                                              const unsigned int offset,
                                              const uint64_t blockNum,
@@ -511,6 +616,40 @@ class Messenger {
                                         const unsigned int offset,
                                         PubKey& lookupPubKey,
                                         bytes& accountStoreBytes);
+  static bool SetLookupGetStateSnapshotFromSeed(bytes& dst,
+                                                const unsigned int offset,
+                                                const uint32_t listenPort);
+  static bool GetLookupGetStateSnapshotFromSeed(const bytes& src,
+                                                const unsigned int offset,
+                                                uint32_t& listenPort);
+  static bool SetLookupSetStateSnapshotFromSeed(
+      bytes& dst, const unsigned int offset, const PairOfKey& lookupKey,
+      const uint64_t blockNum, const dev::h256& stateRoot,
+      const std::vector<dev::h256>& chunkHashes);
+  static bool GetLookupSetStateSnapshotFromSeed(
+      const bytes& src, const unsigned int offset, PubKey& lookupPubKey,
+      uint64_t& blockNum, dev::h256& stateRoot,
+      std::vector<dev::h256>& chunkHashes);
+  static bool SetLookupGetStateChunkFromSeed(bytes& dst,
+                                             const unsigned int offset,
+                                             const uint32_t listenPort,
+                                             const dev::h256& stateRoot,
+                                             const uint32_t chunkIndex);
+  static bool GetLookupGetStateChunkFromSeed(const bytes& src,
+                                             const unsigned int offset,
+                                             uint32_t& listenPort,
+                                             dev::h256& stateRoot,
+                                             uint32_t& chunkIndex);
+  static bool SetLookupSetStateChunkFromSeed(bytes& dst,
+                                             const unsigned int offset,
+                                             const dev::h256& stateRoot,
+                                             const uint32_t chunkIndex,
+                                             const bytes& chunk);
+  static bool GetLookupSetStateChunkFromSeed(const bytes& src,
+                                             const unsigned int offset,
+                                             dev::h256& stateRoot,
+                                             uint32_t& chunkIndex,
+                                             bytes& chunk);
   static bool SetLookupSetLookupOffline(bytes& dst, const unsigned int offset,
                                         const uint8_t msgType,
                                         const uint32_t listenPort,
@@ -792,6 +931,29 @@ class Messenger {
       const uint16_t leaderID, std::vector<bool>& bitmap,
       Signature& collectiveSig, const PubKey& leaderKey);
 
+  static bool SetConsensusAggregatedCommit(
+      bytes& dst, const unsigned int offset, const uint32_t consensusID,
+      const uint64_t blockNumber, const bytes& blockHash,
+      const uint16_t aggregatorID, const std::vector<bool>& bitmap,
+      const CommitPoint& aggregatedCommit, const PairOfKey& aggregatorKey);
+  static bool GetConsensusAggregatedCommit(
+      const bytes& src, const unsigned int offset, const uint32_t consensusID,
+      const uint64_t blockNumber, const bytes& blockHash,
+      uint16_t& aggregatorID, std::vector<bool>& bitmap,
+      CommitPoint& aggregatedCommit, const DequeOfNode& committeeKeys);
+
+  static bool SetConsensusAggregatedResponse(
+      bytes& dst, const unsigned int offset, const uint32_t consensusID,
+      const uint64_t blockNumber, const uint16_t subsetID,
+      const bytes& blockHash, const uint16_t aggregatorID,
+      const std::vector<bool>& bitmap, const Response& aggregatedResponse,
+      const PairOfKey& aggregatorKey);
+  static bool GetConsensusAggregatedResponse(
+      const bytes& src, const unsigned int offset, const uint32_t consensusID,
+      const uint64_t blockNumber, const bytes& blockHash,
+      uint16_t& aggregatorID, uint16_t& subsetID, std::vector<bool>& bitmap,
+      Response& aggregatedResponse, const DequeOfNode& committeeKeys);
+
   static bool SetConsensusCommitFailure(bytes& dst, const unsigned int offset,
                                         const uint32_t consensusID,
                                         const uint64_t blockNumber,
@@ -15,13 +15,51 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
+
 #include "Blacklist.h"
 #include "libUtils/IPConverter.h"
 #include "libUtils/Logger.h"
 
 using namespace std;
+using boost::multiprecision::uint128_t;
+
+namespace {
+const unsigned int IPV4_BITS = 32;
+const unsigned int IPV6_BITS = 128;
+
+/// Bit i of the address, counting from the most significant bit of its
+/// first byte. IPConverter keeps the first byte in the lowest 8 bits.
+inline unsigned int AddressBit(uint64_t lo, uint64_t hi, unsigned int i) {
+  const unsigned int pos = 8 * (i / 8) + 7 - (i % 8);
+  return (pos < 64) ? ((lo >> pos) & 1) : ((hi >> (pos - 64)) & 1);
+}
 
-Blacklist::Blacklist() : m_enabled(true) {}
+inline void Split(const uint128_t& ip, uint64_t& lo, uint64_t& hi) {
+  lo = static_cast<uint64_t>(ip & numeric_limits<uint64_t>::max());
+  hi = static_cast<uint64_t>(ip >> 64);
+}
+
+/// Keeps only the prefixLength leading bits, so that one range has one key
+uint128_t Prefix(const uint128_t& ip, unsigned int prefixLength) {
+  uint64_t lo = 0, hi = 0;
+  Split(ip, lo, hi);
+  uint128_t prefix = 0;
+  for (unsigned int i = 0; i < prefixLength; i++) {
+    if (AddressBit(lo, hi, i)) {
+      prefix |= uint128_t(1) << (8 * (i / 8) + 7 - (i % 8));
+    }
+  }
+  return prefix;
+}
+}  // namespace
+
+Blacklist::Blacklist()
+    : m_nextExpiry(Clock::time_point::max()), m_enabled(true) {
+  auto snapshot = make_shared<Snapshot>();
+  snapshot->m_excluded = make_shared<set<uint128_t>>();
+  m_snapshot = snapshot;
+}
 
 Blacklist::~Blacklist() {}
 
@@ -30,26 +68,128 @@ Blacklist& Blacklist::GetInstance() {
   return blacklist;
 }
 
+bool Blacklist::IsIPv6(const uint128_t& ip) {
+  return ip > numeric_limits<uint32_t>::max();
+}
+
+Blacklist::NodePtr Blacklist::Update(const NodePtr& node, uint64_t lo,
+                                     uint64_t hi, unsigned int depth,
+                                     unsigned int length,
+                                     const function<void(Node&)>& apply) {
+  auto copy = node ? make_shared<Node>(*node) : make_shared<Node>();
+  if (depth == length) {
+    apply(*copy);
+  } else {
+    const unsigned int bit = AddressBit(lo, hi, depth);
+    copy->m_child[bit] =
+        Update(copy->m_child[bit], lo, hi, depth + 1, length, apply);
+  }
+
+  if (!copy->m_address && !copy->m_range && !copy->m_child[0] &&
+      !copy->m_child[1]) {
+    return nullptr;
+  }
+  return copy;
+}
+
+void Blacklist::UpdateEntry(bool ipv6, const uint128_t& ip,
+                            unsigned int length,
+                            const function<void(Node&)>& apply) {
+  uint64_t lo = 0, hi = 0;
+  Split(ip, lo, hi);
+  auto next = make_shared<Snapshot>(*m_snapshot);
+  next->m_roots[ipv6] = Update(next->m_roots[ipv6], lo, hi, 0, length, apply);
+  atomic_store(&m_snapshot, shared_ptr<const Snapshot>(move(next)));
+}
+
+void Blacklist::Rebuild() {
+  const Clock::time_point now = Clock::now();
+  auto next = make_shared<Snapshot>(*m_snapshot);
+  next->m_roots[0].reset();
+  next->m_roots[1].reset();
+  m_nextExpiry = Clock::time_point::max();
+
+  for (const auto& ip : m_blacklistIP) {
+    uint64_t lo = 0, hi = 0;
+    Split(ip, lo, hi);
+    const bool ipv6 = IsIPv6(ip);
+    next->m_roots[ipv6] =
+        Update(next->m_roots[ipv6], lo, hi, 0, ipv6 ? IPV6_BITS : IPV4_BITS,
+               [](Node& node) { node.m_address = true; });
+  }
+
+  for (auto it = m_blacklistRange.begin(); it != m_blacklistRange.end();) {
+    if (it->second <= now) {
+      it = m_blacklistRange.erase(it);
+      continue;
+    }
+    const bool ipv6 = get<0>(it->first);
+    const Clock::time_point expiry = it->second;
+    uint64_t lo = 0, hi = 0;
+    Split(get<1>(it->first), lo, hi);
+    next->m_roots[ipv6] =
+        Update(next->m_roots[ipv6], lo, hi, 0, get<2>(it->first),
+               [expiry](Node& node) {
+                 node.m_range = true;
+                 node.m_expiry = expiry;
+               });
+    m_nextExpiry = min(m_nextExpiry, expiry);
+    it++;
+  }
+
+  atomic_store(&m_snapshot, shared_ptr<const Snapshot>(move(next)));
+}
+
+void Blacklist::PurgeExpired() {
+  if (Clock::now() >= m_nextExpiry) {
+    Rebuild();
+  }
+}
+
 /// P2PComm may use this function
-bool Blacklist::Exist(const boost::multiprecision::uint128_t& ip) {
+bool Blacklist::Exist(const uint128_t& ip) {
   if (!m_enabled) {
     return false;
   }
 
-  lock_guard<mutex> g(m_mutexBlacklistIP);
-  return (m_blacklistIP.end() != m_blacklistIP.find(ip) &&
-          (m_excludedIP.end() == m_excludedIP.find(ip)));
+  const shared_ptr<const Snapshot> snapshot = atomic_load(&m_snapshot);
+  if (snapshot->m_excluded->find(ip) != snapshot->m_excluded->end()) {
+    return false;
+  }
+
+  const bool ipv6 = IsIPv6(ip);
+  const unsigned int bits = ipv6 ? IPV6_BITS : IPV4_BITS;
+  uint64_t lo = 0, hi = 0;
+  Split(ip, lo, hi);
+
+  const Clock::time_point now = Clock::now();
+  const Node* node = snapshot->m_roots[ipv6].get();
+  for (unsigned int depth = 0; node != nullptr; depth++) {
+    if (node->m_range && (node->m_expiry > now)) {
+      return true;
+    }
+    if (depth == bits) {
+      return node->m_address;
+    }
+    node = node->m_child[AddressBit(lo, hi, depth)].get();
+  }
+  return false;
 }
 
 /// Reputation Manager may use this function
-void Blacklist::Add(const boost::multiprecision::uint128_t& ip) {
+void Blacklist::Add(const uint128_t& ip) {
   if (!m_enabled) {
     return;
   }
 
   lock_guard<mutex> g(m_mutexBlacklistIP);
   if (m_excludedIP.end() == m_excludedIP.find(ip)) {
-    m_blacklistIP.emplace(ip, true);
+    PurgeExpired();
+    if (m_blacklistIP.emplace(ip).second) {
+      const bool ipv6 = IsIPv6(ip);
+      UpdateEntry(ipv6, ip, ipv6 ? IPV6_BITS : IPV4_BITS,
+                  [](Node& node) { node.m_address = true; });
+    }
   } else {
     LOG_GENERAL(INFO, "Excluding " << IPConverter::ToStrFromNumericalIP(ip)
                                    << " from Blacklist");
@@ -57,19 +197,84 @@ void Blacklist::Add(const boost::multiprecision::uint128_t& ip) {
 }
 
 /// Reputation Manager may use this function
-void Blacklist::Remove(const boost::multiprecision::uint128_t& ip) {
+void Blacklist::Remove(const uint128_t& ip) {
   if (!m_enabled) {
     return;
   }
 
   lock_guard<mutex> g(m_mutexBlacklistIP);
-  m_blacklistIP.erase(ip);
+  if (m_blacklistIP.erase(ip) > 0) {
+    const bool ipv6 = IsIPv6(ip);
+    UpdateEntry(ipv6, ip, ipv6 ? IPV6_BITS : IPV4_BITS,
+                [](Node& node) { node.m_address = false; });
+  }
+}
+
+bool Blacklist::AddRange(const uint128_t& ip, unsigned int prefixLength,
+                         bool ipv6, chrono::seconds ttl) {
+  const unsigned int bits = ipv6 ? IPV6_BITS : IPV4_BITS;
+  if (prefixLength > bits) {
+    LOG_GENERAL(WARNING, "Prefix length " << prefixLength << " over " << bits
+                                          << " bits");
+    return false;
+  }
+
+  const uint128_t prefix = Prefix(ip, prefixLength);
+  const Clock::time_point expiry = (ttl.count() > 0)
+                                       ? Clock::now() + ttl
+                                       : Clock::time_point::max();
+
+  lock_guard<mutex> g(m_mutexBlacklistIP);
+  PurgeExpired();
+  m_blacklistRange[Range(ipv6, prefix, prefixLength)] = expiry;
+  m_nextExpiry = min(m_nextExpiry, expiry);
+  UpdateEntry(ipv6, prefix, prefixLength, [expiry](Node& node) {
+    node.m_range = true;
+    node.m_expiry = expiry;
+  });
+  return true;
+}
+
+bool Blacklist::AddRange(const string& cidr, chrono::seconds ttl) {
+  const size_t slash = cidr.find('/');
+  const string address = cidr.substr(0, slash);
+  const bool ipv6 = address.find(':') != string::npos;
+
+  unsigned int prefixLength = ipv6 ? IPV6_BITS : IPV4_BITS;
+  if (slash != string::npos) {
+    try {
+      prefixLength = stoul(cidr.substr(slash + 1));
+    } catch (const exception& e) {
+      LOG_GENERAL(WARNING, "Bad prefix length in " << cidr);
+      return false;
+    }
+  }
+
+  uint128_t ip = 0;
+  if (!IPConverter::ToNumericalIPFromStr(address, ip)) {
+    return false;
+  }
+  return AddRange(ip, prefixLength, ipv6, ttl);
+}
+
+void Blacklist::RemoveRange(const uint128_t& ip, unsigned int prefixLength,
+                            bool ipv6) {
+  const uint128_t prefix = Prefix(ip, prefixLength);
+  lock_guard<mutex> g(m_mutexBlacklistIP);
+  auto it = m_blacklistRange.find(Range(ipv6, prefix, prefixLength));
+  if (it == m_blacklistRange.end()) {
+    return;
+  }
+  m_blacklistRange.erase(it);
+  UpdateEntry(ipv6, prefix, prefixLength,
+              [](Node& node) { node.m_range = false; });
 }
 
 /// Reputation Manager may use this function
 void Blacklist::Clear() {
   lock_guard<mutex> g(m_mutexBlacklistIP);
   m_blacklistIP.clear();
+  Rebuild();
   LOG_GENERAL(INFO, "[blacklist] Blacklist cleared.");
 }
 
@@ -81,10 +286,14 @@ void Blacklist::Enable(const bool enable) {
   m_enabled = enable;
 }
 
-void Blacklist::Exclude(const boost::multiprecision::uint128_t& ip) {
+void Blacklist::Exclude(const uint128_t& ip) {
   if (!m_enabled) {
     return;
   }
   lock_guard<mutex> g(m_mutexBlacklistIP);
-  m_excludedIP.emplace(ip);
+  if (m_excludedIP.emplace(ip).second) {
+    auto next = make_shared<Snapshot>(*m_snapshot);
+    next->m_excluded = make_shared<set<uint128_t>>(m_excludedIP);
+    atomic_store(&m_snapshot, shared_ptr<const Snapshot>(move(next)));
+  }
 }
@@ -23,20 +23,42 @@
 #include <boost/multiprecision/cpp_int.hpp>
 #pragma GCC diagnostic pop
 #include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <map>
+#include <memory>
 #include <mutex>
 #include <set>
+#include <string>
+#include <tuple>
 #include <unordered_map>
+#include <unordered_set>
 
 namespace std {
 template <>
 struct hash<boost::multiprecision::uint128_t> {
   std::size_t operator()(const boost::multiprecision::uint128_t& key) const {
-    return std::hash<std::string>()(key.convert_to<std::string>());
+    const uint64_t lo =
+        static_cast<uint64_t>(key & std::numeric_limits<uint64_t>::max());
+    const uint64_t hi = static_cast<uint64_t>(key >> 64);
+    return std::hash<uint64_t>()(lo ^ (hi * 0x9e3779b97f4a7c15ULL));
   }
 };
 }  // namespace std
 
+/// Addresses and CIDR ranges that may not connect or be sent to.
+///
+/// Entries live in one binary prefix trie per address family. Writers copy
+/// the path they change and publish a new root, so Exist walks an immutable
+/// trie without taking the mutex. Addresses use the numerical form of
+/// IPConverter; values that fit in 32 bits are taken as IPv4.
 class Blacklist {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+ private:
   Blacklist();
   ~Blacklist();
 
@@ -44,11 +66,55 @@ class Blacklist {
   Blacklist(Blacklist const&) = delete;
   void operator=(Blacklist const&) = delete;
 
+  struct Node {
+    std::shared_ptr<const Node> m_child[2];
+    /// An address added with Add ends here
+    bool m_address = false;
+    /// A range added with AddRange ends here
+    bool m_range = false;
+    /// Clock::time_point::max() for a range without TTL
+    Clock::time_point m_expiry;
+  };
+  using NodePtr = std::shared_ptr<const Node>;
+
+  /// What Exist reads, swapped as a whole on every change
+  struct Snapshot {
+    NodePtr m_roots[2];
+    std::shared_ptr<const std::set<boost::multiprecision::uint128_t>>
+        m_excluded;
+  };
+
+  /// Family, prefix and prefix length
+  using Range =
+      std::tuple<bool, boost::multiprecision::uint128_t, unsigned int>;
+
   std::mutex m_mutexBlacklistIP;
-  std::unordered_map<boost::multiprecision::uint128_t, bool> m_blacklistIP;
+  std::unordered_set<boost::multiprecision::uint128_t> m_blacklistIP;
+  std::map<Range, Clock::time_point> m_blacklistRange;
   std::set<boost::multiprecision::uint128_t> m_excludedIP;
+  Clock::time_point m_nextExpiry;
+  std::shared_ptr<const Snapshot> m_snapshot;
   std::atomic<bool> m_enabled;
 
+  static bool IsIPv6(const boost::multiprecision::uint128_t& ip);
+
+  /// Returns node with the entry of length length along ip changed by apply,
+  /// copying the nodes on the way and dropping the ones left empty
+  static NodePtr Update(const NodePtr& node, uint64_t lo, uint64_t hi,
+                        unsigned int depth, unsigned int length,
+                        const std::function<void(Node&)>& apply);
+
+  /// Applies apply to the entry, and publishes the result. Needs the mutex.
+  void UpdateEntry(bool ipv6, const boost::multiprecision::uint128_t& ip,
+                   unsigned int length,
+                   const std::function<void(Node&)>& apply);
+
+  /// Rebuilds the tries from m_blacklistIP and m_blacklistRange, dropping
+  /// the ranges that expired. Needs the mutex.
+  void Rebuild();
+
+  void PurgeExpired();
+
  public:
   static Blacklist& GetInstance();
 
@@ -58,10 +124,24 @@ class Blacklist {
   /// P2PComm may use this function to blacklist certain non responding nodes
   void Add(const boost::multiprecision::uint128_t& ip);
 
-  /// P2PComm may use this function to remove a node form blacklist
+  /// P2PComm may use this function to remove a node form blacklist. Ranges
+  /// covering it still apply.
   void Remove(const boost::multiprecision::uint128_t& ip);
 
-  /// Node can clear the blacklist
+  /// Blacklists the prefixLength leading bits of ip, for ttl or until
+  /// RemoveRange if ttl is zero. Returns false if prefixLength is too long.
+  bool AddRange(const boost::multiprecision::uint128_t& ip,
+                unsigned int prefixLength, bool ipv6,
+                std::chrono::seconds ttl = std::chrono::seconds(0));
+
+  /// Same as above, for a range written like "10.1.2.0/24" or "2001:db8::/32"
+  bool AddRange(const std::string& cidr,
+                std::chrono::seconds ttl = std::chrono::seconds(0));
+
+  void RemoveRange(const boost::multiprecision::uint128_t& ip,
+                   unsigned int prefixLength, bool ipv6);
+
+  /// Node can clear the blacklist. Ranges stay until they expire.
   void Clear();
 
   /// Enable / disable blacklist
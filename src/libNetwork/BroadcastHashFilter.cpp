@@ -0,0 +1,160 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstring>
+
+#include "BroadcastHashFilter.h"
+#include "libUtils/Logger.h"
+
+using namespace std;
+
+namespace {
+size_t RoundUpToPowerOfTwo(size_t n) {
+  size_t res = 1;
+  while (res < n) {
+    res <<= 1;
+  }
+  return res;
+}
+}  // namespace
+
+bool BroadcastHashFilter::Table::Find(const Digest& digest,
+                                      size_t start) const {
+  const size_t mask = m_slots.size() - 1;
+  for (size_t i = start & mask; m_used[i]; i = (i + 1) & mask) {
+    if (m_slots[i] == digest) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void BroadcastHashFilter::Table::Add(const Digest& digest, size_t start) {
+  // Keep the load factor at or below one half
+  if ((m_count + 1) * 2 > m_slots.size()) {
+    Table bigger;
+    bigger.m_slots.resize(m_slots.size() * 2);
+    bigger.m_used.assign(m_slots.size() * 2, false);
+    bigger.m_count = 0;
+    for (size_t i = 0; i < m_slots.size(); i++) {
+      if (m_used[i]) {
+        bigger.Add(m_slots[i], SlotHash(m_slots[i]));
+      }
+    }
+    swap(*this, bigger);
+  }
+
+  const size_t mask = m_slots.size() - 1;
+  size_t i = start & mask;
+  while (m_used[i]) {
+    i = (i + 1) & mask;
+  }
+  m_slots[i] = digest;
+  m_used[i] = true;
+  m_count++;
+}
+
+void BroadcastHashFilter::Table::Clear() {
+  fill(m_used.begin(), m_used.end(), false);
+  m_count = 0;
+}
+
+BroadcastHashFilter::BroadcastHashFilter(unsigned int numBuckets,
+                                         size_t initialCapacity) {
+  const size_t capacity = RoundUpToPowerOfTwo(max<size_t>(initialCapacity, 2));
+
+  for (auto& shard : m_shards) {
+    shard.m_buckets.resize(max<unsigned int>(numBuckets, 1));
+    for (auto& table : shard.m_buckets) {
+      table.m_slots.resize(capacity);
+      table.m_used.assign(capacity, false);
+      table.m_count = 0;
+    }
+    shard.m_current = 0;
+  }
+}
+
+size_t BroadcastHashFilter::SlotHash(const Digest& digest) {
+  // The digest is already uniformly distributed; byte 0 picks the shard
+  size_t res;
+  memcpy(&res, digest.data() + 1, sizeof(res));
+  return res;
+}
+
+bool BroadcastHashFilter::Insert(const bytes& hash) {
+  if (hash.size() != HASH_SIZE) {
+    LOG_GENERAL(WARNING, "Wrong broadcast hash length " << hash.size());
+    return false;
+  }
+
+  Digest digest;
+  copy(hash.begin(), hash.end(), digest.begin());
+  const size_t start = SlotHash(digest);
+
+  Shard& shard = m_shards[digest[0] % NUM_SHARDS];
+  lock_guard<ProfiledMutex> g(shard.m_mutex);
+
+  for (const auto& table : shard.m_buckets) {
+    if (table.Find(digest, start)) {
+      return false;
+    }
+  }
+
+  shard.m_buckets[shard.m_current].Add(digest, start);
+  return true;
+}
+
+bool BroadcastHashFilter::Contains(const bytes& hash) {
+  if (hash.size() != HASH_SIZE) {
+    return false;
+  }
+
+  Digest digest;
+  copy(hash.begin(), hash.end(), digest.begin());
+  const size_t start = SlotHash(digest);
+
+  Shard& shard = m_shards[digest[0] % NUM_SHARDS];
+  lock_guard<ProfiledMutex> g(shard.m_mutex);
+
+  for (const auto& table : shard.m_buckets) {
+    if (table.Find(digest, start)) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void BroadcastHashFilter::Rotate() {
+  for (auto& shard : m_shards) {
+    lock_guard<ProfiledMutex> g(shard.m_mutex);
+    shard.m_current = (shard.m_current + 1) % shard.m_buckets.size();
+    shard.m_buckets[shard.m_current].Clear();
+  }
+}
+
+size_t BroadcastHashFilter::Size() {
+  size_t res = 0;
+  for (auto& shard : m_shards) {
+    lock_guard<ProfiledMutex> g(shard.m_mutex);
+    for (const auto& table : shard.m_buckets) {
+      res += table.m_count;
+    }
+  }
+  return res;
+}
@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __BROADCASTHASHFILTER_H__
+#define __BROADCASTHASHFILTER_H__
+
+#include <array>
+#include <mutex>
+#include <vector>
+
+#include "common/BaseType.h"
+#include "libUtils/LockProfiler.h"
+
+/// Set of recently seen 32-byte broadcast message hashes.
+///
+/// Hashes are spread over independently locked shards, so concurrent receive
+/// callbacks rarely contend. Each shard keeps one open-addressing table per
+/// time bucket; Rotate() recycles the oldest bucket, which expires everything
+/// inserted numBuckets rotations ago. Tables keep their storage across
+/// rotations, so lookups and inserts do not allocate once warmed up.
+class BroadcastHashFilter {
+ public:
+  static const unsigned int HASH_SIZE = 32;
+
+ private:
+  using Digest = std::array<unsigned char, HASH_SIZE>;
+
+  static const unsigned int NUM_SHARDS = 16;
+
+  struct Table {
+    std::vector<Digest> m_slots;
+    std::vector<bool> m_used;
+    size_t m_count;
+
+    bool Find(const Digest& digest, size_t start) const;
+    void Add(const Digest& digest, size_t start);
+    void Clear();
+  };
+
+  struct Shard {
+    ProfiledMutex m_mutex{"P2PComm::BroadcastHashes"};
+    std::vector<Table> m_buckets;
+    unsigned int m_current;
+  };
+
+  Shard m_shards[NUM_SHARDS];
+
+  BroadcastHashFilter(BroadcastHashFilter const&) = delete;
+  void operator=(BroadcastHashFilter const&) = delete;
+
+  static size_t SlotHash(const Digest& digest);
+
+ public:
+  /// numBuckets rotations is how long a hash stays in the filter
+  BroadcastHashFilter(unsigned int numBuckets, size_t initialCapacity = 64);
+
+  /// Adds the hash. Returns false if it was already present.
+  bool Insert(const bytes& hash);
+
+  bool Contains(const bytes& hash);
+
+  /// Starts a new time bucket and drops the oldest one
+  void Rotate();
+
+  /// Number of hashes currently held
+  size_t Size();
+};
+
+#endif  // __BROADCASTHASHFILTER_H__
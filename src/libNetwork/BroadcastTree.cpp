@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <tuple>
+
+#include "BroadcastTree.h"
+
+using namespace std;
+using namespace boost::multiprecision;
+
+namespace {
+/// First two octets of an address as stored in Peer::m_ipAddress, i.e.,
+/// sin_addr.s_addr in network byte order
+uint32_t GetPrefix(const uint128_t& ip) {
+  const uint32_t addr = static_cast<uint32_t>(ip & 0xFFFFFFFF);
+  return ((addr & 0xFF) << 8) | ((addr >> 8) & 0xFF);
+}
+}  // namespace
+
+vector<uint32_t> BroadcastTree::GetOrder(const vector<uint128_t>& ips,
+                                         uint32_t clusterSize) {
+  vector<uint32_t> order(ips.size());
+  for (uint32_t i = 0; i < order.size(); i++) {
+    order.at(i) = i;
+  }
+
+  const uint32_t numFixed =
+      min(static_cast<uint32_t>(order.size()), max(clusterSize, 1u));
+  sort(order.begin() + numFixed, order.end(),
+       [&ips](uint32_t l, uint32_t r) {
+         return make_tuple(GetPrefix(ips.at(l)), l) <
+                make_tuple(GetPrefix(ips.at(r)), r);
+       });
+  return order;
+}
+
+vector<uint32_t> BroadcastTree::GetReceivers(const vector<uint128_t>& ips,
+                                             uint32_t myIndex,
+                                             uint32_t clusterSize,
+                                             uint32_t numChildClusters) {
+  vector<uint32_t> receivers;
+  if ((myIndex >= ips.size()) || (clusterSize == 0) ||
+      (numChildClusters == 0)) {
+    return receivers;
+  }
+
+  const vector<uint32_t> order = GetOrder(ips, clusterSize);
+  const uint32_t numClusters = (ips.size() + clusterSize - 1) / clusterSize;
+
+  // The clusters of the plain tree are numbered breadth first, with the
+  // children of c being c * numChildClusters + 1 onwards. Run j of the
+  // order plays cluster preorder[j], and cluster c is run position[c].
+  vector<uint32_t> preorder;
+  preorder.reserve(numClusters);
+  vector<uint32_t> stack{0};
+  while (!stack.empty()) {
+    const uint32_t cluster = stack.back();
+    stack.pop_back();
+    preorder.emplace_back(cluster);
+    for (uint32_t i = numChildClusters; i > 0; i--) {
+      const uint64_t child =
+          static_cast<uint64_t>(cluster) * numChildClusters + i;
+      if (child < numClusters) {
+        stack.emplace_back(static_cast<uint32_t>(child));
+      }
+    }
+  }
+  vector<uint32_t> position(numClusters);
+  for (uint32_t j = 0; j < numClusters; j++) {
+    position.at(preorder.at(j)) = j;
+  }
+
+  const uint32_t myRun =
+      (find(order.begin(), order.end(), myIndex) - order.begin()) /
+      clusterSize;
+  const uint32_t myCluster = preorder.at(myRun);
+
+  for (uint32_t i = 1; i <= numChildClusters; i++) {
+    const uint64_t child =
+        static_cast<uint64_t>(myCluster) * numChildClusters + i;
+    if (child >= numClusters) {
+      break;
+    }
+    const uint32_t begin = position.at(child) * clusterSize;
+    const uint32_t end =
+        min(begin + clusterSize, static_cast<uint32_t>(order.size()));
+    receivers.insert(receivers.end(), order.begin() + begin,
+                     order.begin() + end);
+  }
+  return receivers;
+}
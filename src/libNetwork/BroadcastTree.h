@@ -0,0 +1,53 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __BROADCASTTREE_H__
+#define __BROADCASTTREE_H__
+
+#include <boost/multiprecision/cpp_int.hpp>
+#include <cstdint>
+#include <vector>
+
+/// Locality-aware layout of the tree that forwards DS, VC and fallback blocks
+/// through a shard.
+///
+/// The plain tree cuts the shard into clusters by index, and every node of a
+/// cluster sends to all nodes of its child clusters. Every node has to build
+/// the same tree, so it cannot follow RTTs that each node only measures for
+/// itself. This layout groups the nodes by network prefix instead, which
+/// every node sees alike. The first clusterSize nodes keep their place, as
+/// they get the block from the DS committee. The rest are sorted by their
+/// IPv4 /16 and cut into clusters, so a cluster tends to sit in one network.
+/// The clusters are then put in the tree in depth-first order, so each
+/// subtree covers a contiguous run of prefixes. A block mostly crosses
+/// between networks once per subtree instead of bouncing between them on
+/// every level.
+class BroadcastTree {
+ public:
+  /// Returns the shard indices, into ips, that node myIndex forwards a block
+  /// to. clusterSize and numChildClusters must be at least 1.
+  static std::vector<uint32_t> GetReceivers(
+      const std::vector<boost::multiprecision::uint128_t>& ips,
+      uint32_t myIndex, uint32_t clusterSize, uint32_t numChildClusters);
+
+  /// Returns the shard indices in the order they are cut into clusters
+  static std::vector<uint32_t> GetOrder(
+      const std::vector<boost::multiprecision::uint128_t>& ips,
+      uint32_t clusterSize);
+};
+
+#endif  // __BROADCASTTREE_H__
@@ -17,6 +17,9 @@
 
 #include "DataSender.h"
 
+#include <algorithm>
+#include <unordered_set>
+
 #include "libCrypto/Sha2.h"
 #include "libNetwork/Blacklist.h"
 #include "libNetwork/P2PComm.h"
@@ -230,6 +233,46 @@ void DataSender::DetermineNodesToSendDataTo(
   }
 }
 
+void DataSender::DetermineSlicedNodesToSendDataTo(
+    const DequeOfShard& shards, const DequeOfNode& senderCommittee,
+    const uint16_t& numSenders, const uint16_t& indexB2,
+    const uint16_t& offset, const unsigned int& redundancy,
+    std::deque<std::vector<Peer>>& sharded_receivers) {
+  if (numSenders == 0 || indexB2 >= numSenders) {
+    return;
+  }
+
+  const unsigned int copies =
+      max(1U, min<unsigned int>(redundancy, numSenders));
+  const unsigned int stride = numSenders / copies;
+
+  unordered_set<Peer> skipped;
+  for (const auto& member : senderCommittee) {
+    skipped.emplace(member.second);
+  }
+
+  // Every cosigner walks the same list in the same order, so the slices are
+  // disjoint for each copy without any coordination
+  unsigned int index = 0;
+  for (const auto& shard : shards) {
+    vector<Peer> shardReceivers;
+    for (const auto& node : shard) {
+      const Peer& peer = get<SHARD_NODE_PEER>(node);
+      if (!skipped.emplace(peer).second) {
+        continue;
+      }
+      for (unsigned int copy = 0; copy < copies; copy++) {
+        if ((index + offset + copy * stride) % numSenders == indexB2) {
+          shardReceivers.emplace_back(peer);
+          break;
+        }
+      }
+      index++;
+    }
+    sharded_receivers.emplace_back(move(shardReceivers));
+  }
+}
+
 bool DataSender::SendDataToOthers(
     const BlockBase& blockwcosigSender,
     const deque<pair<PubKey, Peer>>& sendercommittee,
@@ -307,7 +350,17 @@ bool DataSender::SendDataToOthers(
       }
     }
 
-    if (!shards.empty()) {
+    if (!shards.empty() && !sendDataToShardFunc && !BROADCAST_GOSSIP_MODE &&
+        MULTICAST_REDUNDANCY > 0) {
+      // Each shard node comes from MULTICAST_REDUNDANCY cosigners instead of
+      // from a whole cluster. Each slice goes out as its own send job per
+      // shard, so the send pool and event loops push them in parallel
+      std::deque<std::vector<Peer>> sharded_receivers;
+      DetermineSlicedNodesToSendDataTo(
+          shards, sendercommittee, tmpCommittee.size(), indexB2, randomDigits,
+          MULTICAST_REDUNDANCY, sharded_receivers);
+      SendDataToShardNodesDefault(message, sharded_receivers);
+    } else if (!shards.empty()) {
       unsigned int my_cluster_num = UINT_MAX;
       unsigned int my_shards_lo = 0;
       unsigned int my_shards_hi = 0;
@@ -63,6 +63,17 @@ class DataSender : Singleton<DataSender> {
       const unsigned int& my_shards_hi,
       std::deque<std::vector<Peer>>& sharded_receivers);
 
+  /// Splits the nodes of all shards among the numSenders cosigners, so that
+  /// each node is given to `redundancy` of them, starting from cosigner
+  /// `offset` and spread evenly over the rest. Fills sharded_receivers with
+  /// the slice of cosigner indexB2, per shard. Nodes of senderCommittee
+  /// already have the block, and a node listed twice is sent to once.
+  void DetermineSlicedNodesToSendDataTo(
+      const DequeOfShard& shards, const DequeOfNode& senderCommittee,
+      const uint16_t& numSenders, const uint16_t& indexB2,
+      const uint16_t& offset, const unsigned int& redundancy,
+      std::deque<std::vector<Peer>>& sharded_receivers);
+
   bool SendDataToOthers(
       const BlockBase& blockwcosig, const DequeOfNode& sendercommittee,
       const DequeOfShard& shards,
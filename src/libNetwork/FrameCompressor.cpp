@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <snappy.h>
+
+#include "FrameCompressor.h"
+#include "common/Messages.h"
+#include "libUtils/Logger.h"
+
+using namespace std;
+
+bool FrameCompressor::Compress(const bytes& body, unsigned int threshold,
+                               bytes& compressed) {
+  if ((threshold == 0) || (body.size() < threshold) ||
+      (body.size() <= MessageOffset::BODY)) {
+    return false;
+  }
+
+  const size_t inputSize = body.size() - MessageOffset::BODY;
+  compressed.resize(MessageOffset::BODY +
+                    snappy::MaxCompressedLength(inputSize));
+  copy(body.begin(), body.begin() + MessageOffset::BODY, compressed.begin());
+
+  size_t compressedSize = 0;
+  snappy::RawCompress(
+      reinterpret_cast<const char*>(body.data() + MessageOffset::BODY),
+      inputSize,
+      reinterpret_cast<char*>(compressed.data() + MessageOffset::BODY),
+      &compressedSize);
+
+  if (compressedSize > inputSize - inputSize / 8) {
+    compressed.clear();
+    return false;
+  }
+
+  compressed.resize(MessageOffset::BODY + compressedSize);
+  return true;
+}
+
+bool FrameCompressor::Decompress(const bytes& src, size_t begin, size_t end,
+                                 size_t maxSize, bytes& dst) {
+  if ((end > src.size()) || (begin + MessageOffset::BODY > end)) {
+    LOG_GENERAL(WARNING, "Compressed body too short");
+    return false;
+  }
+
+  const char* input =
+      reinterpret_cast<const char*>(src.data() + begin + MessageOffset::BODY);
+  const size_t inputSize = end - begin - MessageOffset::BODY;
+
+  size_t outputSize = 0;
+  if (!snappy::GetUncompressedLength(input, inputSize, &outputSize)) {
+    LOG_GENERAL(WARNING, "Corrupt compressed body");
+    return false;
+  }
+
+  // Checked before allocating, so a small frame cannot claim a huge body
+  if (MessageOffset::BODY + outputSize > maxSize) {
+    LOG_GENERAL(WARNING, "Compressed body expands to "
+                             << outputSize << " bytes, more than " << maxSize);
+    return false;
+  }
+
+  const size_t offset = dst.size();
+  dst.insert(dst.end(), src.begin() + begin,
+             src.begin() + begin + MessageOffset::BODY);
+  dst.resize(offset + MessageOffset::BODY + outputSize);
+  if (!snappy::RawUncompress(
+          input, inputSize,
+          reinterpret_cast<char*>(dst.data() + offset + MessageOffset::BODY))) {
+    LOG_GENERAL(WARNING, "Corrupt compressed body");
+    dst.resize(offset);
+    return false;
+  }
+
+  return true;
+}
@@ -0,0 +1,45 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __FRAMECOMPRESSOR_H__
+#define __FRAMECOMPRESSOR_H__
+
+#include <cstddef>
+
+#include "common/BaseType.h"
+
+/// Snappy compression of large P2P message bodies.
+///
+/// The first MessageOffset::BODY bytes of a body (message and instruction
+/// type) stay in the clear, so a compressed frame can still be classified
+/// by the SendQueue without decompressing it. Only the rest is compressed.
+class FrameCompressor {
+ public:
+  /// Sets compressed to the compressed form of body. Returns false if body is
+  /// smaller than threshold (0 never compresses) or if compression would save
+  /// less than an eighth of it, e.g., for a state delta that is already
+  /// compressed.
+  static bool Compress(const bytes& body, unsigned int threshold,
+                       bytes& compressed);
+
+  /// Appends the body compressed in src[begin, end) to dst. Returns false if
+  /// the data is corrupt or the body is larger than maxSize.
+  static bool Decompress(const bytes& src, size_t begin, size_t end,
+                         size_t maxSize, bytes& dst);
+};
+
+#endif  // __FRAMECOMPRESSOR_H__
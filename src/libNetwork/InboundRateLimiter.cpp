@@ -0,0 +1,227 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "InboundRateLimiter.h"
+
+#include <event2/bufferevent.h>
+#include <event2/event.h>
+#include <algorithm>
+
+#include "ReputationManager.h"
+#include "common/Constants.h"
+#include "libUtils/IPConverter.h"
+#include "libUtils/Logger.h"
+
+using namespace std;
+using namespace boost::multiprecision;
+
+namespace {
+/// Idle senders are swept after this many new connections
+const unsigned int ATTACHES_PER_SWEEP = 1024;
+
+inline size_t ToBucketRate(uint64_t rate) {
+  return (rate == 0) ? EV_RATE_LIMIT_MAX
+                     : static_cast<size_t>(
+                           min<uint64_t>(rate, EV_RATE_LIMIT_MAX));
+}
+}  // namespace
+
+InboundRateLimiter::InboundRateLimiter(uint64_t bytesPerSecond,
+                                       uint64_t messagesPerSecond)
+    : m_bytesPerSecond(bytesPerSecond),
+      m_messagesPerSecond(messagesPerSecond),
+      m_bucketConfig(nullptr, ev_token_bucket_cfg_free),
+      m_attachesSinceSweep(0) {
+  if (m_bytesPerSecond > 0) {
+    // Read allowance refills every second with a burst of one second, writes
+    // stay unlimited
+    const size_t rate = ToBucketRate(m_bytesPerSecond);
+    m_bucketConfig.reset(ev_token_bucket_cfg_new(
+        rate, rate, EV_RATE_LIMIT_MAX, EV_RATE_LIMIT_MAX, nullptr));
+    if (!m_bucketConfig) {
+      LOG_GENERAL(WARNING, "ev_token_bucket_cfg_new failure, inbound bytes "
+                           "will not be limited");
+    }
+  }
+}
+
+InboundRateLimiter::~InboundRateLimiter() {
+  lock_guard<mutex> g(m_mutex);
+  for (const auto& connection : m_connections) {
+    bufferevent_remove_from_rate_limit_group(connection.first);
+  }
+  for (const auto& sender : m_senders) {
+    if (sender.second.m_group != nullptr) {
+      bufferevent_rate_limit_group_free(sender.second.m_group);
+    }
+  }
+}
+
+InboundRateLimiter& InboundRateLimiter::GetInstance() {
+  static InboundRateLimiter limiter(INBOUND_BYTES_PER_SECOND,
+                                    INBOUND_MESSAGES_PER_SECOND);
+  return limiter;
+}
+
+void InboundRateLimiter::Refill(Sender& sender,
+                                const Clock::time_point& now) const {
+  const double elapsed =
+      chrono::duration<double>(now - sender.m_lastRefill).count();
+  sender.m_messageTokens =
+      min(static_cast<double>(m_messagesPerSecond),
+          sender.m_messageTokens + elapsed * m_messagesPerSecond);
+  sender.m_lastRefill = now;
+}
+
+bool InboundRateLimiter::IsIdle(Sender& sender,
+                                const Clock::time_point& now) const {
+  if (sender.m_connections > 0) {
+    return false;
+  }
+  // Keep a sender that is still paying off a burst, so reconnecting does
+  // not reset its budget
+  Refill(sender, now);
+  return sender.m_messageTokens >= m_messagesPerSecond;
+}
+
+InboundRateLimiter::Sender& InboundRateLimiter::FindOrAddSender(
+    const uint128_t& ip, const Clock::time_point& now) {
+  auto it = m_senders.find(ip);
+  if (it == m_senders.end()) {
+    it = m_senders
+             .emplace(ip, Sender{nullptr, 0,
+                                 static_cast<double>(m_messagesPerSecond),
+                                 now, Clock::time_point()})
+             .first;
+  }
+  return it->second;
+}
+
+void InboundRateLimiter::SweepIdle(const Clock::time_point& now) {
+  for (auto it = m_senders.begin(); it != m_senders.end();) {
+    if (IsIdle(it->second, now)) {
+      it = m_senders.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+bool InboundRateLimiter::Attach(bufferevent* bev, const uint128_t& ip) {
+  if (bev == nullptr) {
+    return false;
+  }
+
+  lock_guard<mutex> g(m_mutex);
+
+  const Clock::time_point now = Clock::now();
+  if (++m_attachesSinceSweep >= ATTACHES_PER_SWEEP) {
+    m_attachesSinceSweep = 0;
+    SweepIdle(now);
+  }
+
+  Sender& sender = FindOrAddSender(ip, now);
+  if (m_bucketConfig) {
+    if (sender.m_group == nullptr) {
+      sender.m_group = bufferevent_rate_limit_group_new(
+          bufferevent_get_base(bev), m_bucketConfig.get());
+      if (sender.m_group == nullptr) {
+        LOG_GENERAL(WARNING, "bufferevent_rate_limit_group_new failure.");
+        return false;
+      }
+    }
+    if (bufferevent_add_to_rate_limit_group(bev, sender.m_group) != 0) {
+      LOG_GENERAL(WARNING, "bufferevent_add_to_rate_limit_group failure.");
+      return false;
+    }
+  }
+
+  sender.m_connections++;
+  m_connections[bev] = ip;
+  return true;
+}
+
+void InboundRateLimiter::Detach(bufferevent* bev) {
+  lock_guard<mutex> g(m_mutex);
+
+  auto connection = m_connections.find(bev);
+  if (connection == m_connections.end()) {
+    return;
+  }
+  auto it = m_senders.find(connection->second);
+  m_connections.erase(connection);
+  if (it == m_senders.end()) {
+    return;
+  }
+
+  Sender& sender = it->second;
+  if (sender.m_group != nullptr) {
+    bufferevent_remove_from_rate_limit_group(bev);
+  }
+  if (--sender.m_connections > 0) {
+    return;
+  }
+
+  // The group must be empty before it can be freed, and a new connection
+  // starts with a full byte allowance anyway
+  if (sender.m_group != nullptr) {
+    bufferevent_rate_limit_group_free(sender.m_group);
+    sender.m_group = nullptr;
+  }
+  if (IsIdle(sender, Clock::now())) {
+    m_senders.erase(it);
+  }
+}
+
+bool InboundRateLimiter::TakeMessage(const uint128_t& ip) {
+  if (m_messagesPerSecond == 0) {
+    return true;
+  }
+
+  bool punish = false;
+  {
+    lock_guard<mutex> g(m_mutex);
+
+    const Clock::time_point now = Clock::now();
+    Sender& sender = FindOrAddSender(ip, now);
+    Refill(sender, now);
+    if (sender.m_messageTokens >= 1) {
+      sender.m_messageTokens -= 1;
+      return true;
+    }
+
+    if (now - sender.m_lastPunished >= chrono::seconds(1)) {
+      sender.m_lastPunished = now;
+      punish = true;
+    }
+  }
+
+  // PunishNode may blacklist the sender, so run it outside our lock
+  if (punish) {
+    LOG_GENERAL(WARNING, "Node " << IPConverter::ToStrFromNumericalIP(ip)
+                                 << " exceeded " << m_messagesPerSecond
+                                 << " messages per second");
+    ReputationManager::GetInstance().PunishNode(
+        ip, ReputationManager::PENALTY_RATE_LIMIT);
+  }
+  return false;
+}
+
+size_t InboundRateLimiter::GetSenderCount() {
+  lock_guard<mutex> g(m_mutex);
+  return m_senders.size();
+}
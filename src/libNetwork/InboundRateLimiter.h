@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __INBOUNDRATELIMITER_H__
+#define __INBOUNDRATELIMITER_H__
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "Blacklist.h"
+
+struct bufferevent;
+struct bufferevent_rate_limit_group;
+struct ev_token_bucket_cfg;
+
+/// Per-IP budgets for inbound traffic.
+///
+/// Every connection from the same address joins one libevent rate limit
+/// group, so the sender shares a single bytes per second allowance however
+/// many sockets it opens; libevent simply stops reading once it is spent.
+/// Complete messages are counted against a separate token bucket, and a
+/// sender that runs out of message tokens has its messages dropped and is
+/// punished through the ReputationManager, once per second at most.
+///
+/// Calls come from every receive reactor, so they are guarded by a mutex. A
+/// sender's group can hold connections of several reactors, which is why
+/// inbound bufferevents are threadsafe when there is more than one.
+class InboundRateLimiter {
+  using Clock = std::chrono::steady_clock;
+
+  struct Sender {
+    bufferevent_rate_limit_group* m_group;
+    unsigned int m_connections;
+    double m_messageTokens;
+    Clock::time_point m_lastRefill;
+    Clock::time_point m_lastPunished;
+  };
+
+  std::mutex m_mutex;
+  const uint64_t m_bytesPerSecond;
+  const uint64_t m_messagesPerSecond;
+  std::unique_ptr<ev_token_bucket_cfg, void (*)(ev_token_bucket_cfg*)>
+      m_bucketConfig;
+  std::unordered_map<boost::multiprecision::uint128_t, Sender> m_senders;
+  std::unordered_map<bufferevent*, boost::multiprecision::uint128_t>
+      m_connections;
+  unsigned int m_attachesSinceSweep;
+
+  InboundRateLimiter(InboundRateLimiter const&) = delete;
+  void operator=(InboundRateLimiter const&) = delete;
+
+  void Refill(Sender& sender, const Clock::time_point& now) const;
+  bool IsIdle(Sender& sender, const Clock::time_point& now) const;
+  Sender& FindOrAddSender(const boost::multiprecision::uint128_t& ip,
+                          const Clock::time_point& now);
+  void SweepIdle(const Clock::time_point& now);
+
+ public:
+  /// A zero rate leaves that dimension unlimited
+  InboundRateLimiter(uint64_t bytesPerSecond, uint64_t messagesPerSecond);
+  ~InboundRateLimiter();
+
+  /// Returns the instance configured with INBOUND_BYTES_PER_SECOND and
+  /// INBOUND_MESSAGES_PER_SECOND
+  static InboundRateLimiter& GetInstance();
+
+  /// Puts a new inbound connection under the byte budget of its sender
+  bool Attach(bufferevent* bev, const boost::multiprecision::uint128_t& ip);
+
+  /// Takes the connection out of its group; call before freeing bev
+  void Detach(bufferevent* bev);
+
+  /// Spends one message token of the sender, returns false if none is left
+  bool TakeMessage(const boost::multiprecision::uint128_t& ip);
+
+  /// Number of addresses currently tracked
+  size_t GetSenderCount();
+};
+
+#endif  // __INBOUNDRATELIMITER_H__
@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "MessagePool.h"
+#include "common/Constants.h"
+
+using namespace std;
+
+namespace {
+/// Smallest class whose buffers hold size bytes
+unsigned int CeilClass(size_t size) {
+  unsigned int c = 0;
+  while ((MessagePool::MIN_BUFFER_SIZE << c) < size) {
+    c++;
+  }
+  return c;
+}
+
+/// Largest class whose buffer size capacity reaches
+unsigned int FloorClass(size_t capacity) {
+  unsigned int c = 0;
+  while (c + 1 < MessagePool::NUM_CLASSES &&
+         (MessagePool::MIN_BUFFER_SIZE << (c + 1)) <= capacity) {
+    c++;
+  }
+  return c;
+}
+}  // namespace
+
+const size_t MessagePool::MIN_BUFFER_SIZE;
+const unsigned int MessagePool::NUM_CLASSES;
+const size_t MessagePool::MAX_BUFFER_SIZE;
+
+MessagePool::MessagePool()
+    : m_maxIdleBytes(static_cast<size_t>(MESSAGE_POOL_IN_MB) * 1024 * 1024) {}
+
+MessagePool::~MessagePool() {
+  for (auto& sizeClass : m_classes) {
+    lock_guard<mutex> g(sizeClass.m_mutex);
+    for (auto message : sizeClass.m_free) {
+      delete message;
+    }
+    sizeClass.m_free.clear();
+  }
+}
+
+MessagePool& MessagePool::GetInstance() {
+  static MessagePool pool;
+  return pool;
+}
+
+MessagePool::Message* MessagePool::Acquire(size_t size) {
+  if (size <= MAX_BUFFER_SIZE) {
+    const unsigned int c = CeilClass(size);
+    SizeClass& sizeClass = m_classes[c];
+    {
+      lock_guard<mutex> g(sizeClass.m_mutex);
+      if (!sizeClass.m_free.empty()) {
+        Message* message = sizeClass.m_free.back();
+        sizeClass.m_free.pop_back();
+        m_idleBytes -= message->first.capacity();
+        m_hits++;
+        return message;
+      }
+    }
+    // Reserve the full class so the buffer comes back to the same class
+    size = MIN_BUFFER_SIZE << c;
+  }
+
+  m_misses++;
+  Message* message = new Message();
+  message->first.reserve(size);
+  return message;
+}
+
+void MessagePool::Release(Message* message) {
+  if (message == nullptr) {
+    return;
+  }
+
+  const size_t capacity = message->first.capacity();
+  if (capacity < MIN_BUFFER_SIZE || capacity > 2 * MAX_BUFFER_SIZE ||
+      m_idleBytes + capacity > m_maxIdleBytes) {
+    delete message;
+    return;
+  }
+
+  message->first.clear();
+  message->second = Peer();
+
+  SizeClass& sizeClass = m_classes[FloorClass(capacity)];
+  lock_guard<mutex> g(sizeClass.m_mutex);
+  m_idleBytes += capacity;
+  sizeClass.m_free.emplace_back(message);
+}
+
+MemoryUsage MessagePool::GetMemoryUsage() {
+  MemoryUsage usage;
+  for (auto& sizeClass : m_classes) {
+    lock_guard<mutex> g(sizeClass.m_mutex);
+    usage.m_objects += sizeClass.m_free.size();
+    for (const auto message : sizeClass.m_free) {
+      usage.m_bytes += sizeof(Message) + message->first.capacity();
+    }
+  }
+  return usage;
+}
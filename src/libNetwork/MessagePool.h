@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __MESSAGEPOOL_H__
+#define __MESSAGEPOOL_H__
+
+#include <atomic>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "Peer.h"
+#include "common/BaseType.h"
+#include "libUtils/MemoryStats.h"
+
+/// Recycles inbound messages, buffer and pair handed to the dispatcher
+/// together, so a message storm does not churn the allocator.
+///
+/// Idle messages are kept in power-of-two size classes of buffer capacity,
+/// from MIN_BUFFER_SIZE to MAX_BUFFER_SIZE, each behind its own mutex.
+/// Larger messages are allocated and freed as before. At most
+/// MESSAGE_POOL_IN_MB of buffer capacity is kept idle.
+class MessagePool {
+ public:
+  using Message = std::pair<bytes, Peer>;
+
+  static const size_t MIN_BUFFER_SIZE = 512;
+  static const unsigned int NUM_CLASSES = 15;
+  static const size_t MAX_BUFFER_SIZE = MIN_BUFFER_SIZE << (NUM_CLASSES - 1);
+
+ private:
+  struct SizeClass {
+    std::mutex m_mutex;
+    std::vector<Message*> m_free;
+  };
+
+  SizeClass m_classes[NUM_CLASSES];
+  const size_t m_maxIdleBytes;
+  std::atomic<size_t> m_idleBytes{0};
+  std::atomic<uint64_t> m_hits{0};
+  std::atomic<uint64_t> m_misses{0};
+
+  MessagePool();
+  ~MessagePool();
+
+  MessagePool(MessagePool const&) = delete;
+  void operator=(MessagePool const&) = delete;
+
+ public:
+  /// Returns the singleton instance.
+  static MessagePool& GetInstance();
+
+  /// Returns a message with an empty buffer that holds size bytes without
+  /// reallocating. Hand it back with Release once handled.
+  Message* Acquire(size_t size);
+
+  /// Takes back a message from Acquire, or any one allocated with new
+  void Release(Message* message);
+
+  /// Idle buffer capacity and number of idle messages
+  MemoryUsage GetMemoryUsage();
+
+  /// Acquire calls served from, and not from, the idle messages
+  uint64_t GetHits() const { return m_hits; }
+  uint64_t GetMisses() const { return m_misses; }
+};
+
+#endif  // __MESSAGEPOOL_H__
@@ -24,17 +24,24 @@
 #include <event2/event-config.h>
 #include <event2/event.h>
 #include <event2/listener.h>
+#include <event2/thread.h>
 #include <event2/util.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <signal.h>
 #include <stdint.h>
 #include <sys/socket.h>
 #include <unistd.h>
+#include <algorithm>
 #include <cstring>
 #include <memory>
 
 #include "Blacklist.h"
+#include "FrameCompressor.h"
+#include "InboundRateLimiter.h"
+#include "MessagePool.h"
 #include "P2PComm.h"
+#include "PeerConnectionPool.h"
 #include "PeerStore.h"
 #include "common/Messages.h"
 #include "libCrypto/Sha2.h"
@@ -50,6 +57,9 @@ using namespace boost::multiprecision;
 const unsigned char START_BYTE_NORMAL = 0x11;
 const unsigned char START_BYTE_BROADCAST = 0x22;
 const unsigned char START_BYTE_GOSSIP = 0x33;
+/// Set in the start byte of a normal or broadcast frame whose body went
+/// through FrameCompressor
+const unsigned char START_BYTE_COMPRESSED = 0x80;
 const unsigned int HDR_LEN = 6;
 const unsigned int HASH_LEN = 32;
 const unsigned int GOSSIP_MSGTYPE_LEN = 1;
@@ -58,6 +68,7 @@ const unsigned int GOSSIP_SNDR_LISTNR_PORT_LEN = 4;
 
 P2PComm::Dispatcher P2PComm::m_dispatcher;
 P2PComm::BroadcastListFunc P2PComm::m_broadcast_list_retriever;
+int P2PComm::m_inboundOptions = BEV_OPT_CLOSE_ON_FREE | BEV_OPT_DEFER_CALLBACKS;
 
 /// Comparison operator for ordering the list of message hashes.
 struct hash_compare {
@@ -73,62 +84,126 @@ static void close_socket(int* cli_sock) {
   }
 }
 
-static bool comparePairSecond(
-    const pair<bytes, chrono::time_point<chrono::system_clock>>& a,
-    const pair<bytes, chrono::time_point<chrono::system_clock>>& b) {
-  return a.second < b.second;
+namespace {
+const size_t (&GetSendClassCapacity())[SEND_CLASS_COUNT] {
+  static const size_t capacity[SEND_CLASS_COUNT] = {
+      SENDQUEUE_SIZE, SENDQUEUE_SIZE, SENDQUEUE_BULK_SIZE, SENDQUEUE_BULK_SIZE};
+  return capacity;
 }
 
-P2PComm::P2PComm() : m_sendQueue(SENDQUEUE_SIZE) {
-  auto func = [this]() -> void {
-    bytes emptyHash;
+// One time bucket per BROADCAST_INTERVAL, plus the one currently filling up,
+// so that a hash is kept for at least BROADCAST_EXPIRY seconds
+unsigned int GetNumBroadcastBuckets() {
+  return BROADCAST_EXPIRY / max<unsigned int>(BROADCAST_INTERVAL, 1) + 1;
+}
+}  // namespace
 
+P2PComm::P2PComm()
+    : m_broadcastHashes(GetNumBroadcastBuckets()),
+      m_sendQueue(GetSendClassCapacity(), MAXMESSAGE) {
+  auto func = [this]() -> void {
     while (true) {
       this_thread::sleep_for(chrono::seconds(BROADCAST_INTERVAL));
-      lock(m_broadcastToRemoveMutex, m_broadcastHashesMutex);
-      lock_guard<mutex> g(m_broadcastToRemoveMutex, adopt_lock);
-      lock_guard<mutex> g2(m_broadcastHashesMutex, adopt_lock);
-
-      if (m_broadcastToRemove.empty() ||
-          m_broadcastToRemove.front().second >
-              chrono::system_clock::now() - chrono::seconds(BROADCAST_EXPIRY)) {
-        continue;
-      }
-
-      auto up = upper_bound(
-          m_broadcastToRemove.begin(), m_broadcastToRemove.end(),
-          make_pair(emptyHash, chrono::system_clock::now() -
-                                   chrono::seconds(BROADCAST_EXPIRY)),
-          comparePairSecond);
-
-      for (auto it = m_broadcastToRemove.begin(); it != up; ++it) {
-        m_broadcastHashes.erase(it->first);
-      }
-
-      m_broadcastToRemove.erase(m_broadcastToRemove.begin(), up);
+      m_broadcastHashes.Rotate();
     }
   };
 
   DetachedFunction(1, func);
-}
 
-P2PComm::~P2PComm() {
-  SendJob* job = NULL;
-  while (m_sendQueue.pop(job)) {
-    delete job;
+  const auto sendPlacement =
+      ThreadPlacement::Resolve(SEND_PLACEMENT, "SendEventLoop");
+  for (unsigned int i = 0; i < SEND_EVENT_LOOP_THREADS; i++) {
+    unique_ptr<SendEventLoop> loop(new SendEventLoop(sendPlacement));
+    if (loop->IsRunning()) {
+      m_sendLoops.emplace_back(move(loop));
+    }
   }
 }
 
+P2PComm::~P2PComm() {}
+
 P2PComm& P2PComm::GetInstance() {
   static P2PComm comm;
   return comm;
 }
 
+// Transmission format:
+// 0x01 ~ 0xFF - version, defined in constant file
+// 0x11 - start byte
+// 0xLL 0xLL 0xLL 0xLL - 4-byte length of message
+// <message>
+
+// 0x01 ~ 0xFF - version, defined in constant file
+// 0x22 - start byte (broadcast)
+// 0xLL 0xLL 0xLL 0xLL - 4-byte length of hash + message
+// <32-byte hash> <message>
+
+// 0x01 ~ 0xFF - version, defined in constant file
+// 0x33 - start byte (report)
+// 0x00 0x00 0x00 0x01 - 4-byte length of message
+// 0x00
+
+// Normal and broadcast bodies of at least P2P_COMPRESSION_THRESHOLD_IN_BYTES
+// are sent compressed if that makes them smaller: START_BYTE_COMPRESSED is
+// set in the start byte, the length covers the compressed body, and the hash
+// is still that of the uncompressed body
+OutgoingMessage::OutgoingMessage(const bytes& body, unsigned char startByte,
+                                 const bytes& hash) {
+  bytes compressed;
+  const bool compress =
+      ((startByte == START_BYTE_NORMAL) ||
+       (startByte == START_BYTE_BROADCAST)) &&
+      FrameCompressor::Compress(body, P2P_COMPRESSION_THRESHOLD_IN_BYTES,
+                                compressed);
+  const bytes& payload = compress ? compressed : body;
+
+  uint32_t length = payload.size();
+
+  if (startByte == START_BYTE_BROADCAST) {
+    length += HASH_LEN;
+  }
+
+  m_frame.reserve(HDR_LEN + length);
+  m_frame = {(unsigned char)(MSG_VERSION & 0xFF),
+             (unsigned char)(compress ? (startByte | START_BYTE_COMPRESSED)
+                                      : startByte),
+             (unsigned char)((length >> 24) & 0xFF),
+             (unsigned char)((length >> 16) & 0xFF),
+             (unsigned char)((length >> 8) & 0xFF),
+             (unsigned char)(length & 0xFF)};
+
+  if (startByte == START_BYTE_BROADCAST) {
+    if (hash.size() != HASH_LEN) {
+      LOG_GENERAL(WARNING, "Wrong message hash length.");
+    }
+    m_frame.insert(m_frame.end(), hash.begin(), hash.end());
+    m_frame.resize(HDR_LEN + HASH_LEN);
+  }
+
+  m_frame.insert(m_frame.end(), payload.begin(), payload.end());
+}
+
+OutgoingMessage::OutgoingMessage(bytes&& frame) : m_frame(move(frame)) {}
+
+unsigned char OutgoingMessage::GetStartByte() const {
+  return (m_frame.size() < HDR_LEN) ? 0 : (m_frame[1] & ~START_BYTE_COMPRESSED);
+}
+
+bytes OutgoingMessage::GetHash() const {
+  if (GetStartByte() != START_BYTE_BROADCAST ||
+      m_frame.size() < HDR_LEN + HASH_LEN) {
+    return {};
+  }
+  return bytes(m_frame.begin() + HDR_LEN, m_frame.begin() + HDR_LEN + HASH_LEN);
+}
+
 uint32_t SendJob::writeMsg(const void* buf, int cli_sock, const Peer& from,
                            const uint32_t message_length) {
   uint32_t written_length = 0;
 
   while (written_length < message_length) {
+    // Clear any stale error left by an earlier call on this thread
+    errno = 0;
     ssize_t n = write(cli_sock, (unsigned char*)buf + written_length,
                       message_length - written_length);
 
@@ -166,11 +241,10 @@ uint32_t SendJob::writeMsg(const void* buf, int cli_sock, const Peer& from,
   return written_length;
 }
 
-bool SendJob::SendMessageSocketCore(const Peer& peer, const bytes& message,
-                                    unsigned char start_byte,
-                                    const bytes& msg_hash) {
+bool SendJob::SendMessageSocketCore(const Peer& peer,
+                                    const OutgoingMessage& message) {
   // LOG_MARKER();
-  LOG_PAYLOAD(DEBUG, "Sending message to " << peer, message,
+  LOG_PAYLOAD(DEBUG, "Sending message to " << peer, message.GetFrame(),
               Logger::MAX_BYTES_TO_DISPLAY);
 
   if (peer.m_ipAddress == 0 && peer.m_listenPortHost == 0) {
@@ -184,7 +258,12 @@ bool SendJob::SendMessageSocketCore(const Peer& peer, const bytes& message,
   }
 
   try {
-    int cli_sock = socket(AF_INET, SOCK_STREAM, 0);
+    // Reuse an idle connection to this peer if there is one
+    int cli_sock = PeerConnectionPool::GetInstance().Acquire(peer);
+    const bool reused = (cli_sock >= 0);
+    if (!reused) {
+      cli_sock = socket(AF_INET, SOCK_STREAM, 0);
+    }
     unique_ptr<int, void (*)(int*)> cli_sock_closer(&cli_sock, close_socket);
 
     // LINUX HAS NO SO_NOSIGPIPE
@@ -199,71 +278,52 @@ bool SendJob::SendMessageSocketCore(const Peer& peer, const bytes& message,
       return false;
     }
 
-    struct sockaddr_in serv_addr;
-    serv_addr.sin_family = AF_INET;
-    serv_addr.sin_addr.s_addr = peer.m_ipAddress.convert_to<unsigned long>();
-    serv_addr.sin_port = htons(peer.m_listenPortHost);
-
-    if (connect(cli_sock, (struct sockaddr*)&serv_addr, sizeof(serv_addr)) <
-        0) {
-      LOG_GENERAL(WARNING, "Socket connect failed. Code = "
-                               << errno << " Desc: " << std::strerror(errno)
-                               << ". IP address: " << peer);
-      if (P2PComm::IsHostHavingNetworkIssue()) {
-        LOG_GENERAL(WARNING, "[blacklist] Encountered "
-                                 << errno << " (" << std::strerror(errno)
-                                 << "). Adding " << peer.GetPrintableIPAddress()
-                                 << " to blacklist");
-        Blacklist::GetInstance().Add(peer.m_ipAddress);
+    if (!reused) {
+      struct sockaddr_in serv_addr;
+      serv_addr.sin_family = AF_INET;
+      serv_addr.sin_addr.s_addr = peer.m_ipAddress.convert_to<unsigned long>();
+      serv_addr.sin_port = htons(peer.m_listenPortHost);
+
+      if (connect(cli_sock, (struct sockaddr*)&serv_addr, sizeof(serv_addr)) <
+          0) {
+        LOG_GENERAL(WARNING, "Socket connect failed. Code = "
+                                 << errno << " Desc: " << std::strerror(errno)
+                                 << ". IP address: " << peer);
+        if (P2PComm::IsHostHavingNetworkIssue()) {
+          LOG_GENERAL(WARNING, "[blacklist] Encountered "
+                                   << errno << " (" << std::strerror(errno)
+                                   << "). Adding "
+                                   << peer.GetPrintableIPAddress()
+                                   << " to blacklist");
+          Blacklist::GetInstance().Add(peer.m_ipAddress);
+        }
+
+        return false;
       }
 
-      return false;
-    }
-
-    // Transmission format:
-    // 0x01 ~ 0xFF - version, defined in constant file
-    // 0x11 - start byte
-    // 0xLL 0xLL 0xLL 0xLL - 4-byte length of message
-    // <message>
-
-    // 0x01 ~ 0xFF - version, defined in constant file
-    // 0x22 - start byte (broadcast)
-    // 0xLL 0xLL 0xLL 0xLL - 4-byte length of hash + message
-    // <32-byte hash> <message>
-
-    // 0x01 ~ 0xFF - version, defined in constant file
-    // 0x33 - start byte (report)
-    // 0x00 0x00 0x00 0x01 - 4-byte length of message
-    // 0x00
-    uint32_t length = message.size();
-
-    if (start_byte == START_BYTE_BROADCAST) {
-      length += HASH_LEN;
-    }
-
-    unsigned char buf[HDR_LEN] = {(unsigned char)(MSG_VERSION & 0xFF),
-                                  start_byte,
-                                  (unsigned char)((length >> 24) & 0xFF),
-                                  (unsigned char)((length >> 16) & 0xFF),
-                                  (unsigned char)((length >> 8) & 0xFF),
-                                  (unsigned char)(length & 0xFF)};
-
-    if (HDR_LEN != writeMsg(buf, cli_sock, peer, HDR_LEN)) {
-      LOG_GENERAL(INFO, "DEBUG: not written_length == " << HDR_LEN);
+      if (PeerConnectionPool::IsEnabled()) {
+        // The connection stays open after this frame, so don't let Nagle
+        // hold back its tail waiting for more data
+        int set = 1;
+        setsockopt(cli_sock, IPPROTO_TCP, TCP_NODELAY, &set, sizeof(set));
+      }
     }
 
-    if (start_byte != START_BYTE_BROADCAST) {
-      writeMsg(&message.at(0), cli_sock, peer, length);
-      return true;
+    const bytes& frame = message.GetFrame();
+    const uint32_t frameLength = frame.size();
+    const uint32_t written =
+        writeMsg(frame.data(), cli_sock, peer, frameLength);
+    if (written != frameLength) {
+      LOG_GENERAL(INFO, "DEBUG: not written_length == " << frameLength);
+      // A pooled connection may have gone stale, let the caller retry on a
+      // fresh one. Otherwise the frame is incomplete and the connection can't
+      // carry another one.
+      return !(reused && written == 0);
     }
 
-    if (HASH_LEN != writeMsg(&msg_hash.at(0), cli_sock, peer, HASH_LEN)) {
-      LOG_GENERAL(WARNING, "Wrong message hash length.");
-      return false;
-    }
-
-    length -= HASH_LEN;
-    writeMsg(&message.at(0), cli_sock, peer, length);
+    // The whole frame was written, keep the connection for the next message
+    PeerConnectionPool::GetInstance().Release(peer, cli_sock);
+    cli_sock_closer.release();
   } catch (const std::exception& e) {
     LOG_GENERAL(WARNING, "Error with write socket." << ' ' << e.what());
     return false;
@@ -271,10 +331,10 @@ bool SendJob::SendMessageSocketCore(const Peer& peer, const bytes& message,
   return true;
 }
 
-void SendJob::SendMessageCore(const Peer& peer, const bytes message,
-                              unsigned char startbyte, const bytes hash) {
+void SendJob::SendMessageCore(const Peer& peer,
+                              const OutgoingMessage& message) {
   uint32_t retry_counter = 0;
-  while (!SendMessageSocketCore(peer, message, startbyte, hash)) {
+  while (!SendMessageSocketCore(peer, message)) {
     retry_counter++;
     LOG_GENERAL(WARNING, "Socket connect failed " << retry_counter << "/"
                                                   << MAXRETRYCONN
@@ -307,7 +367,9 @@ void SendJobPeer::DoSend() {
     return;
   }
 
-  SendMessageCore(m_peer, m_message, m_startbyte, m_hash);
+  if (!P2PComm::GetInstance().SendOnEventLoop(m_peer, m_message)) {
+    SendMessageCore(m_peer, *m_message);
+  }
 }
 
 template <class T>
@@ -320,8 +382,11 @@ void SendJobPeers<T>::DoSend() {
   random_shuffle(indexes.begin(), indexes.end());
 
   string hashStr;
-  if ((m_startbyte == START_BYTE_BROADCAST) && (m_selfPeer != Peer())) {
-    if (!DataConversion::Uint8VecToHexStr(m_hash, hashStr)) {
+  const bool logBroadcast =
+      (m_message->GetStartByte() == START_BYTE_BROADCAST) &&
+      (m_selfPeer != Peer());
+  if (logBroadcast) {
+    if (!DataConversion::Uint8VecToHexStr(m_message->GetHash(), hashStr)) {
       return;
     }
     LOG_STATE("[BROAD][" << std::setw(15) << std::left
@@ -329,6 +394,7 @@ void SendJobPeers<T>::DoSend() {
                          << hashStr.substr(0, 6) << "] BEGN");
   }
 
+  P2PComm& p2p = P2PComm::GetInstance();
   for (vector<unsigned int>::const_iterator curr = indexes.begin();
        curr < indexes.end(); curr++) {
     const Peer& peer = m_peers.at(*curr);
@@ -341,10 +407,12 @@ void SendJobPeers<T>::DoSend() {
       continue;
     }
 
-    SendMessageCore(peer, m_message, m_startbyte, m_hash);
+    if (!p2p.SendOnEventLoop(peer, m_message)) {
+      SendMessageCore(peer, *m_message);
+    }
   }
 
-  if ((m_startbyte == START_BYTE_BROADCAST) && (m_selfPeer != Peer())) {
+  if (logBroadcast) {
     LOG_STATE("[BROAD][" << std::setw(15) << std::left
                          << m_selfPeer.GetPrintableIPAddress() << "]["
                          << hashStr.substr(0, 6) << "] DONE");
@@ -352,48 +420,53 @@ void SendJobPeers<T>::DoSend() {
 }
 
 void P2PComm::ProcessSendJob(SendJob* job) {
-  auto funcSendMsg = [job]() mutable -> void {
+  auto funcSendMsg = [this, job]() mutable -> void {
     job->DoSend();
     delete job;
+    m_sendQueue.Done();
   };
   m_SendPool.AddJob(funcSendMsg);
 }
 
-void P2PComm::ClearBroadcastHashAsync(const bytes& message_hash) {
-  LOG_MARKER();
-  lock_guard<mutex> guard(m_broadcastToRemoveMutex);
-  m_broadcastToRemove.emplace_back(message_hash, chrono::system_clock::now());
+void P2PComm::QueueSendJob(SendJob* job) {
+  const bytes& frame = job->m_message->GetFrame();
+  const unsigned char startByte = job->m_message->GetStartByte();
+  const unsigned int offset =
+      HDR_LEN + ((startByte == START_BYTE_BROADCAST) ? HASH_LEN : 0);
+
+  SendClass cls = SEND_CLASS_BULK;
+  if (frame.size() >= offset + MessageOffset::BODY) {
+    cls = SendQueue::Classify(startByte, frame[offset + MessageOffset::TYPE],
+                              frame[offset + MessageOffset::INST]);
+  }
+
+  m_sendQueue.Push(job, cls);
 }
 
 /*static*/ void P2PComm::ProcessBroadCastMsg(bytes& message,
                                              const uint32_t messageLength,
-                                             const Peer& from) {
+                                             const Peer& from,
+                                             const bytes& wireFrame) {
   bytes msg_hash(message.begin() + HDR_LEN,
                  message.begin() + HDR_LEN + HASH_LEN);
 
   P2PComm& p2p = P2PComm::GetInstance();
 
   // Check if this message has been received before
-  bool found = false;
-  {
-    lock_guard<mutex> guard(p2p.m_broadcastHashesMutex);
-
-    found =
-        (p2p.m_broadcastHashes.find(msg_hash) != p2p.m_broadcastHashes.end());
-    // While we have the lock, we should quickly add the hash
-    if (!found) {
-      SHA2<HASH_TYPE::HASH_VARIANT_256> sha256;
-      sha256.Update(message, HDR_LEN + HASH_LEN,
-                    message.size() - HDR_LEN - HASH_LEN);
-      bytes this_msg_hash = sha256.Finalize();
-
-      if (this_msg_hash == msg_hash) {
-        p2p.m_broadcastHashes.insert(this_msg_hash);
-      } else {
-        LOG_GENERAL(WARNING, "Incorrect message hash.");
-        return;
-      }
+  bool found = p2p.m_broadcastHashes.Contains(msg_hash);
+
+  if (!found) {
+    SHA2<HASH_TYPE::HASH_VARIANT_256> sha256;
+    sha256.Update(message, HDR_LEN + HASH_LEN,
+                  message.size() - HDR_LEN - HASH_LEN);
+
+    if (sha256.Finalize() != msg_hash) {
+      LOG_GENERAL(WARNING, "Incorrect message hash.");
+      return;
     }
+
+    // Another callback may have verified the same message in the meantime
+    found = !p2p.m_broadcastHashes.Insert(msg_hash);
   }
 
   if (found) {
@@ -413,11 +486,9 @@ void P2PComm::ClearBroadcastHashAsync(const bytes& message_hash) {
       m_broadcast_list_retriever(msg_type, ins_type, from);
 
   if (broadcast_list.size() > 0) {
-    p2p.RebroadcastMessage(broadcast_list, message, msg_hash);
+    p2p.RebroadcastMessage(broadcast_list, wireFrame);
   }
 
-  p2p.ClearBroadcastHashAsync(msg_hash);
-
   string msgHashStr;
   if (!DataConversion::Uint8VecToHexStr(msg_hash, msgHashStr)) {
     return;
@@ -426,35 +497,39 @@ void P2PComm::ClearBroadcastHashAsync(const bytes& message_hash) {
   LOG_STATE("[BROAD][" << std::setw(15) << std::left << p2p.m_selfPeer << "]["
                        << msgHashStr.substr(0, 6) << "] RECV");
 
-  // Move the shared_ptr message to raw pointer type
-  pair<bytes, Peer>* raw_message = new pair<bytes, Peer>(
-      bytes(message.begin() + HDR_LEN + HASH_LEN, message.end()), from);
+  pair<bytes, Peer>* raw_message =
+      MessagePool::GetInstance().Acquire(message.size() - HDR_LEN - HASH_LEN);
+  raw_message->first.assign(message.begin() + HDR_LEN + HASH_LEN,
+                            message.end());
+  raw_message->second = from;
   LOG_GENERAL(INFO, "Size of broadcast message: " << message.size());
 
   // Queue the message
   m_dispatcher(raw_message);
 }
 
-/*static*/ void P2PComm::ProcessGossipMsg(bytes& message, Peer& from) {
-  unsigned char gossipMsgTyp = message.at(HDR_LEN);
+/*static*/ void P2PComm::ProcessGossipSubMsg(const bytes& message,
+                                             size_t begin, size_t end,
+                                             Peer& from) {
+  unsigned char gossipMsgTyp = message.at(begin);
 
   const uint32_t gossipMsgRound =
-      (message.at(HDR_LEN + GOSSIP_MSGTYPE_LEN) << 24) +
-      (message.at(HDR_LEN + GOSSIP_MSGTYPE_LEN + 1) << 16) +
-      (message.at(HDR_LEN + GOSSIP_MSGTYPE_LEN + 2) << 8) +
-      message.at(HDR_LEN + GOSSIP_MSGTYPE_LEN + 3);
+      (message.at(begin + GOSSIP_MSGTYPE_LEN) << 24) +
+      (message.at(begin + GOSSIP_MSGTYPE_LEN + 1) << 16) +
+      (message.at(begin + GOSSIP_MSGTYPE_LEN + 2) << 8) +
+      message.at(begin + GOSSIP_MSGTYPE_LEN + 3);
 
   const uint32_t gossipSenderPort =
-      (message.at(HDR_LEN + GOSSIP_MSGTYPE_LEN + GOSSIP_ROUND_LEN) << 24) +
-      (message.at(HDR_LEN + GOSSIP_MSGTYPE_LEN + GOSSIP_ROUND_LEN + 1) << 16) +
-      (message.at(HDR_LEN + GOSSIP_MSGTYPE_LEN + GOSSIP_ROUND_LEN + 2) << 8) +
-      message.at(HDR_LEN + GOSSIP_MSGTYPE_LEN + GOSSIP_ROUND_LEN + 3);
+      (message.at(begin + GOSSIP_MSGTYPE_LEN + GOSSIP_ROUND_LEN) << 24) +
+      (message.at(begin + GOSSIP_MSGTYPE_LEN + GOSSIP_ROUND_LEN + 1) << 16) +
+      (message.at(begin + GOSSIP_MSGTYPE_LEN + GOSSIP_ROUND_LEN + 2) << 8) +
+      message.at(begin + GOSSIP_MSGTYPE_LEN + GOSSIP_ROUND_LEN + 3);
   from.m_listenPortHost = gossipSenderPort;
 
   RumorManager::RawBytes rumor_message(
-      message.begin() + HDR_LEN + GOSSIP_MSGTYPE_LEN + GOSSIP_ROUND_LEN +
+      message.begin() + begin + GOSSIP_MSGTYPE_LEN + GOSSIP_ROUND_LEN +
           GOSSIP_SNDR_LISTNR_PORT_LEN,
-      message.end());
+      message.begin() + end);
 
   P2PComm& p2p = P2PComm::GetInstance();
   if (gossipMsgTyp == (uint8_t)RRS::Message::Type::FORWARD) {
@@ -462,12 +537,15 @@ void P2PComm::ClearBroadcastHashAsync(const bytes& message_hash) {
 
     if (p2p.SpreadForeignRumor(rumor_message)) {
       // skip the keys and signature.
-      bytes tmp(rumor_message.begin() + PUB_KEY_SIZE +
-                    SIGNATURE_CHALLENGE_SIZE + SIGNATURE_RESPONSE_SIZE,
-                rumor_message.end());
-      std::pair<bytes, Peer>* raw_message = new pair<bytes, Peer>(tmp, from);
+      const auto body = rumor_message.begin() + PUB_KEY_SIZE +
+                        SIGNATURE_CHALLENGE_SIZE + SIGNATURE_RESPONSE_SIZE;
+      std::pair<bytes, Peer>* raw_message =
+          MessagePool::GetInstance().Acquire(rumor_message.end() - body);
+      raw_message->first.assign(body, rumor_message.end());
+      raw_message->second = from;
 
-      LOG_GENERAL(INFO, "Size of rumor message: " << tmp.size());
+      LOG_GENERAL(INFO,
+                  "Size of rumor message: " << raw_message->first.size());
 
       // Queue the message
       m_dispatcher(raw_message);
@@ -477,7 +555,9 @@ void P2PComm::ClearBroadcastHashAsync(const bytes& message_hash) {
         (unsigned int)gossipMsgTyp, gossipMsgRound, rumor_message, from);
     if (resp.first) {
       std::pair<bytes, Peer>* raw_message =
-          new pair<bytes, Peer>(resp.second, from);
+          MessagePool::GetInstance().Acquire(resp.second.size());
+      raw_message->first.assign(resp.second.begin(), resp.second.end());
+      raw_message->second = from;
 
       LOG_GENERAL(INFO, "Size of rumor message: " << rumor_message.size());
 
@@ -487,29 +567,84 @@ void P2PComm::ClearBroadcastHashAsync(const bytes& message_hash) {
   }
 }
 
+/*static*/ void P2PComm::ProcessGossipMsg(bytes& message, Peer& from) {
+  if (message.at(HDR_LEN) != (uint8_t)RRS::Message::Type::BATCH) {
+    ProcessGossipSubMsg(message, HDR_LEN, message.size(), from);
+    return;
+  }
+
+  // <4-byte count> then <4-byte length> <message> per message
+  const auto readLength = [&message](size_t pos) -> uint32_t {
+    return (message.at(pos) << 24) + (message.at(pos + 1) << 16) +
+           (message.at(pos + 2) << 8) + message.at(pos + 3);
+  };
+
+  size_t pos = HDR_LEN + GOSSIP_MSGTYPE_LEN + GOSSIP_ROUND_LEN +
+               GOSSIP_SNDR_LISTNR_PORT_LEN;
+  if (message.size() < pos + sizeof(uint32_t)) {
+    LOG_GENERAL(WARNING, "Gossip batch without a message count");
+    return;
+  }
+  const uint32_t count = readLength(pos);
+  pos += sizeof(uint32_t);
+
+  for (uint32_t i = 0; i < count; i++) {
+    if (message.size() < pos + sizeof(uint32_t)) {
+      LOG_GENERAL(WARNING, "Gossip batch cut off after " << i << " of "
+                                                         << count
+                                                         << " messages");
+      return;
+    }
+    const uint32_t len = readLength(pos);
+    pos += sizeof(uint32_t);
+
+    if (len > message.size() - pos ||
+        len < GOSSIP_MSGTYPE_LEN + GOSSIP_ROUND_LEN +
+                  GOSSIP_SNDR_LISTNR_PORT_LEN ||
+        message.at(pos) == (uint8_t)RRS::Message::Type::BATCH) {
+      LOG_GENERAL(WARNING, "Invalid message " << i << " in gossip batch");
+      return;
+    }
+
+    ProcessGossipSubMsg(message, pos, pos + len, from);
+    pos += len;
+  }
+}
+
+/*static*/ void P2PComm::FreeInboundConnection(struct bufferevent* bev) {
+  InboundRateLimiter::GetInstance().Detach(bev);
+  bufferevent_free(bev);
+}
+
+/*static*/ Peer P2PComm::GetRemotePeer(struct bufferevent* bev) {
+  int fd = bufferevent_getfd(bev);
+  struct sockaddr_in cli_addr;
+  socklen_t addr_size = sizeof(struct sockaddr_in);
+  getpeername(fd, (struct sockaddr*)&cli_addr, &addr_size);
+  return Peer(cli_addr.sin_addr.s_addr, cli_addr.sin_port);
+}
+
 void P2PComm::EventCallback(struct bufferevent* bev, short events,
                             [[gnu::unused]] void* ctx) {
-  unique_ptr<struct bufferevent, decltype(&bufferevent_free)> socket_closer(
-      bev, bufferevent_free);
+  unique_ptr<struct bufferevent, decltype(&FreeInboundConnection)>
+      socket_closer(bev, FreeInboundConnection);
 
   if (events & BEV_EVENT_ERROR) {
     LOG_GENERAL(WARNING, "Error from bufferevent.");
     return;
   }
 
+  if (events & BEV_EVENT_TIMEOUT) {
+    // Idle persistent connection, the sender will open a new one if needed
+    return;
+  }
+
   // Not all bytes read out
   if (!(events & (BEV_EVENT_EOF | BEV_EVENT_ERROR))) {
     LOG_GENERAL(WARNING, "Unknown error from bufferevent.");
     return;
   }
 
-  // Get the IP info
-  int fd = bufferevent_getfd(bev);
-  struct sockaddr_in cli_addr;
-  socklen_t addr_size = sizeof(struct sockaddr_in);
-  getpeername(fd, (struct sockaddr*)&cli_addr, &addr_size);
-  Peer from(cli_addr.sin_addr.s_addr, cli_addr.sin_port);
-
   // Get the data stored in buffer
   struct evbuffer* input = bufferevent_get_input(bev);
   if (input == NULL) {
@@ -518,20 +653,64 @@ void P2PComm::EventCallback(struct bufferevent* bev, short events,
   }
   size_t len = evbuffer_get_length(input);
   if (len == 0) {
-    LOG_GENERAL(WARNING, "evbuffer_get_length failure.");
+    // Every complete message was already processed in ReadCallback
     return;
   }
-  bytes message(len);
+  MessagePool::Message* frame = MessagePool::GetInstance().Acquire(len);
+  bytes& message = frame->first;
+  message.resize(len);
   if (evbuffer_copyout(input, message.data(), len) !=
       static_cast<ev_ssize_t>(len)) {
     LOG_GENERAL(WARNING, "evbuffer_copyout failure.");
+    MessagePool::GetInstance().Release(frame);
     return;
   }
   if (evbuffer_drain(input, len) != 0) {
     LOG_GENERAL(WARNING, "evbuffer_drain failure.");
+    MessagePool::GetInstance().Release(frame);
     return;
   }
 
+  Peer from = GetRemotePeer(bev);
+  if (InboundRateLimiter::GetInstance().TakeMessage(from.m_ipAddress)) {
+    ProcessReceivedMessage(message, from);
+  }
+  MessagePool::GetInstance().Release(frame);
+}
+
+/*static*/ bool P2PComm::DecompressFrame(const bytes& message, bytes& frame) {
+  const unsigned char startByte = message[1] & ~START_BYTE_COMPRESSED;
+  if ((startByte != START_BYTE_NORMAL) && (startByte != START_BYTE_BROADCAST)) {
+    LOG_GENERAL(WARNING, "Compressed message with start byte "
+                             << (unsigned int)startByte);
+    return false;
+  }
+
+  const size_t offset =
+      HDR_LEN + ((startByte == START_BYTE_BROADCAST) ? HASH_LEN : 0);
+  if (message.size() < offset) {
+    LOG_GENERAL(WARNING, "Compressed message too short.");
+    return false;
+  }
+
+  // The restored frame may not be larger than an uncompressed one could be
+  frame.assign(message.begin(), message.begin() + offset);
+  frame[1] = startByte;
+  if (!FrameCompressor::Decompress(message, offset, message.size(),
+                                   MAX_READ_WATERMARK_IN_BYTES - offset,
+                                   frame)) {
+    return false;
+  }
+
+  const uint32_t length = frame.size() - HDR_LEN;
+  frame[2] = (unsigned char)((length >> 24) & 0xFF);
+  frame[3] = (unsigned char)((length >> 16) & 0xFF);
+  frame[4] = (unsigned char)((length >> 8) & 0xFF);
+  frame[5] = (unsigned char)(length & 0xFF);
+  return true;
+}
+
+/*static*/ void P2PComm::ProcessReceivedMessage(bytes& message, Peer& from) {
   // Reception format:
   // 0x01 ~ 0xFF - version, defined in constant file
   // 0x11 - start byte
@@ -589,6 +768,20 @@ void P2PComm::EventCallback(struct bufferevent* bev, short events,
     }
   }
 
+  if ((startByte & START_BYTE_COMPRESSED) != 0) {
+    bytes frame;
+    if (!DecompressFrame(message, frame)) {
+      return;
+    }
+    if (frame[1] == START_BYTE_BROADCAST) {
+      // Forwarded in the compressed form it arrived in
+      ProcessBroadCastMsg(frame, frame.size() - HDR_LEN, from, message);
+    } else {
+      ProcessReceivedMessage(frame, from);
+    }
+    return;
+  }
+
   if (startByte == START_BYTE_BROADCAST) {
     LOG_PAYLOAD(INFO, "Incoming broadcast message from " << from, message,
                 Logger::MAX_BYTES_TO_DISPLAY);
@@ -600,14 +793,15 @@ void P2PComm::EventCallback(struct bufferevent* bev, short events,
       return;
     }
 
-    ProcessBroadCastMsg(message, messageLength, from);
+    ProcessBroadCastMsg(message, messageLength, from, message);
   } else if (startByte == START_BYTE_NORMAL) {
     LOG_PAYLOAD(INFO, "Incoming normal message from " << from, message,
                 Logger::MAX_BYTES_TO_DISPLAY);
 
-    // Move the shared_ptr message to raw pointer type
-    pair<bytes, Peer>* raw_message = new pair<bytes, Peer>(
-        bytes(message.begin() + HDR_LEN, message.end()), from);
+    pair<bytes, Peer>* raw_message =
+        MessagePool::GetInstance().Acquire(message.size() - HDR_LEN);
+    raw_message->first.assign(message.begin() + HDR_LEN, message.end());
+    raw_message->second = from;
     LOG_GENERAL(INFO, "Size of normal message: " << message.size());
 
     // Queue the message
@@ -645,21 +839,67 @@ void P2PComm::EventCallback(struct bufferevent* bev, short events,
 void P2PComm::ReadCallback(struct bufferevent* bev, [[gnu::unused]] void* ctx) {
   struct evbuffer* input = bufferevent_get_input(bev);
 
+  // Get the IP info
+  Peer from = GetRemotePeer(bev);
+
   size_t len = evbuffer_get_length(input);
   if (len >= MAX_READ_WATERMARK_IN_BYTES) {
-    // Get the IP info
-    int fd = bufferevent_getfd(bev);
-    struct sockaddr_in cli_addr;
-    socklen_t addr_size = sizeof(struct sockaddr_in);
-    getpeername(fd, (struct sockaddr*)&cli_addr, &addr_size);
-    Peer from(cli_addr.sin_addr.s_addr, cli_addr.sin_port);
     LOG_GENERAL(WARNING, "[blacklist] Encountered data of size: "
                              << len << " being received."
                              << " Adding sending node "
                              << from.GetPrintableIPAddress()
                              << " to blacklist");
     Blacklist::GetInstance().Add(from.m_ipAddress);
-    bufferevent_free(bev);
+    FreeInboundConnection(bev);
+    return;
+  }
+
+  // A sender keeps its connection open across messages, so pull out every
+  // complete frame now instead of waiting for EOF
+  while (len >= HDR_LEN) {
+    unsigned char hdr[HDR_LEN];
+    if (evbuffer_copyout(input, hdr, HDR_LEN) !=
+        static_cast<ev_ssize_t>(HDR_LEN)) {
+      LOG_GENERAL(WARNING, "evbuffer_copyout failure.");
+      return;
+    }
+
+    const uint32_t messageLength =
+        (hdr[2] << 24) + (hdr[3] << 16) + (hdr[4] << 8) + hdr[5];
+    const size_t frameLength = HDR_LEN + static_cast<size_t>(messageLength);
+    if (len < frameLength) {
+      break;
+    }
+
+    // The frame is copied out of it before dispatch, so the buffer goes
+    // straight back to the pool
+    MessagePool::Message* frame =
+        MessagePool::GetInstance().Acquire(frameLength);
+    bytes& message = frame->first;
+    message.resize(frameLength);
+    if (evbuffer_remove(input, message.data(), frameLength) !=
+        static_cast<int>(frameLength)) {
+      LOG_GENERAL(WARNING, "evbuffer_remove failure.");
+      MessagePool::GetInstance().Release(frame);
+      return;
+    }
+
+    // Frames over the sender's message rate are read out but not dispatched
+    if (!InboundRateLimiter::GetInstance().TakeMessage(from.m_ipAddress)) {
+      MessagePool::GetInstance().Release(frame);
+      if (Blacklist::GetInstance().Exist(from.m_ipAddress)) {
+        LOG_GENERAL(INFO, "Closing connection from blacklisted node " << from);
+        FreeInboundConnection(bev);
+        return;
+      }
+      len = evbuffer_get_length(input);
+      continue;
+    }
+
+    ProcessReceivedMessage(message, from);
+    MessagePool::GetInstance().Release(frame);
+
+    len = evbuffer_get_length(input);
   }
 }
 
@@ -695,8 +935,8 @@ void P2PComm::AcceptConnectionCallback([[gnu::unused]] evconnlistener* listener,
     return;
   }
 
-  struct bufferevent* bev = bufferevent_socket_new(
-      base, cli_sock, BEV_OPT_CLOSE_ON_FREE | BEV_OPT_DEFER_CALLBACKS);
+  struct bufferevent* bev =
+      bufferevent_socket_new(base, cli_sock, m_inboundOptions);
   if (bev == NULL) {
     LOG_GENERAL(WARNING, "bufferevent_socket_new failure.");
 
@@ -706,8 +946,19 @@ void P2PComm::AcceptConnectionCallback([[gnu::unused]] evconnlistener* listener,
     return;
   }
 
+  // Every connection of this sender shares one byte budget
+  if (!InboundRateLimiter::GetInstance().Attach(bev, from.m_ipAddress)) {
+    bufferevent_free(bev);
+    return;
+  }
+
   bufferevent_setwatermark(bev, EV_READ, MIN_READ_WATERMARK_IN_BYTES,
                            MAX_READ_WATERMARK_IN_BYTES);
+  if (IDLE_CONNECTION_TIMEOUT_IN_SECONDS > 0) {
+    // Give the sender time to evict the connection on its side first
+    struct timeval readTimeout = {IDLE_CONNECTION_TIMEOUT_IN_SECONDS * 2, 0};
+    bufferevent_set_timeouts(bev, &readTimeout, NULL);
+  }
   bufferevent_setcb(bev, ReadCallback, NULL, EventCallback, NULL);
   bufferevent_enable(bev, EV_READ | EV_WRITE);
 }
@@ -722,13 +973,11 @@ void P2PComm::StartMessagePump(uint32_t listen_port_host, Dispatcher dispatcher,
   LOG_MARKER();
 
   // Launch the thread that reads messages from the send queue
+  // Jobs are only taken out while a SendPool thread is free for them, so the
+  // queue (not the pool) decides which class goes next
   auto funcCheckSendQueue = [this]() mutable -> void {
-    SendJob* job = NULL;
     while (true) {
-      while (m_sendQueue.pop(job)) {
-        ProcessSendJob(job);
-      }
-      std::this_thread::sleep_for(std::chrono::microseconds(1));
+      ProcessSendJob(m_sendQueue.Pop());
     }
   };
   DetachedFunction(1, funcCheckSendQueue);
@@ -742,29 +991,86 @@ void P2PComm::StartMessagePump(uint32_t listen_port_host, Dispatcher dispatcher,
   serv_addr.sin_port = htons(listen_port_host);
   serv_addr.sin_addr.s_addr = INADDR_ANY;
 
-  // Create the listener
-  struct event_base* base = event_base_new();
-  if (base == NULL) {
-    LOG_GENERAL(WARNING, "event_base_new failure.");
-    // fixme: should we exit here?
-    return;
+  unsigned int numReactors = max(RECEIVE_REACTOR_THREADS, 1u);
+  if (numReactors > 1) {
+    // Connections of one sender can land on different reactors and still
+    // share its rate limit group, so libevent has to lock them
+    if (evthread_use_pthreads() == 0) {
+      m_inboundOptions |= BEV_OPT_THREADSAFE;
+    } else {
+      LOG_GENERAL(WARNING, "evthread_use_pthreads failure, using 1 reactor.");
+      numReactors = 1;
+    }
   }
 
-  struct evconnlistener* listener = evconnlistener_new_bind(
-      base, AcceptConnectionCallback, nullptr,
-      LEV_OPT_REUSEABLE | LEV_OPT_CLOSE_ON_FREE, -1,
-      (struct sockaddr*)&serv_addr, sizeof(struct sockaddr_in));
+  // Create the listeners, one event base each. With SO_REUSEPORT the kernel
+  // spreads the accepted connections over them.
+  const unsigned int listenerOptions =
+      LEV_OPT_REUSEABLE | LEV_OPT_CLOSE_ON_FREE |
+      ((numReactors > 1) ? LEV_OPT_REUSEABLE_PORT : 0);
+  vector<pair<struct event_base*, struct evconnlistener*>> reactors;
+  for (unsigned int i = 0; i < numReactors; i++) {
+    struct event_base* base = event_base_new();
+    if (base == NULL) {
+      LOG_GENERAL(WARNING, "event_base_new failure.");
+      break;
+    }
 
-  if (listener == NULL) {
-    LOG_GENERAL(WARNING, "evconnlistener_new_bind failure.");
-    event_base_free(base);
+    struct evconnlistener* listener = evconnlistener_new_bind(
+        base, AcceptConnectionCallback, nullptr, listenerOptions, -1,
+        (struct sockaddr*)&serv_addr, sizeof(struct sockaddr_in));
+
+    if (listener == NULL) {
+      LOG_GENERAL(WARNING, "evconnlistener_new_bind failure.");
+      event_base_free(base);
+      break;
+    }
+
+    reactors.emplace_back(base, listener);
+  }
+
+  if (reactors.empty()) {
     // fixme: should we exit here?
     return;
   }
 
-  event_base_dispatch(base);
-  evconnlistener_free(listener);
-  event_base_free(base);
+  LOG_GENERAL(INFO, "Listening on port " << listen_port_host << " with "
+                                         << reactors.size() << " reactors");
+
+  // Connections and their buffers are created on the reactor threads, so
+  // placing the threads also keeps the receive buffers on their node
+  const auto placement =
+      ThreadPlacement::Resolve(RECEIVE_PLACEMENT, "ReceiveReactor");
+  auto runReactor = [placement](struct event_base* base,
+                                struct evconnlistener* listener) {
+    placement.ApplyToCurrentThread();
+    event_base_dispatch(base);
+    evconnlistener_free(listener);
+    event_base_free(base);
+  };
+
+  for (unsigned int i = 1; i < reactors.size(); i++) {
+    const auto reactor = reactors.at(i);
+    DetachedFunction(1, [runReactor, reactor]() mutable -> void {
+      runReactor(reactor.first, reactor.second);
+    });
+  }
+
+  // The first reactor runs on the calling thread, as before
+  runReactor(reactors.front().first, reactors.front().second);
+}
+
+template <class Container>
+bool P2PComm::SendOnTransport(const Container& peers, const bytes& message,
+                              unsigned char startByte) const {
+  if (!m_transport) {
+    return false;
+  }
+
+  for (const auto& peer : peers) {
+    m_transport(peer, message, startByte);
+  }
+  return true;
 }
 
 void P2PComm::SendMessage(const vector<Peer>& peers, const bytes& message,
@@ -775,18 +1081,18 @@ void P2PComm::SendMessage(const vector<Peer>& peers, const bytes& message,
     return;
   }
 
+  if (SendOnTransport(peers, message, startByteType)) {
+    return;
+  }
+
   // Make job
   SendJob* job = new SendJobPeers<vector<Peer>>;
   dynamic_cast<SendJobPeers<vector<Peer>>*>(job)->m_peers = peers;
   job->m_selfPeer = m_selfPeer;
-  job->m_startbyte = startByteType;
-  job->m_message = message;
-  job->m_hash.clear();
+  job->m_message = make_shared<const OutgoingMessage>(message, startByteType);
 
   // Queue job
-  if (!m_sendQueue.bounded_push(job)) {
-    LOG_GENERAL(WARNING, "SendQueue is full");
-  }
+  QueueSendJob(job);
 }
 
 void P2PComm::SendMessage(const deque<Peer>& peers, const bytes& message,
@@ -797,36 +1103,36 @@ void P2PComm::SendMessage(const deque<Peer>& peers, const bytes& message,
     return;
   }
 
+  if (SendOnTransport(peers, message, startByteType)) {
+    return;
+  }
+
   // Make job
   SendJob* job = new SendJobPeers<deque<Peer>>;
   dynamic_cast<SendJobPeers<deque<Peer>>*>(job)->m_peers = peers;
   job->m_selfPeer = m_selfPeer;
-  job->m_startbyte = startByteType;
-  job->m_message = message;
-  job->m_hash.clear();
+  job->m_message = make_shared<const OutgoingMessage>(message, startByteType);
 
   // Queue job
-  if (!m_sendQueue.bounded_push(job)) {
-    LOG_GENERAL(WARNING, "SendQueue is full");
-  }
+  QueueSendJob(job);
 }
 
 void P2PComm::SendMessage(const Peer& peer, const bytes& message,
                           const unsigned char& startByteType) {
   // LOG_MARKER();
 
+  if (SendOnTransport(vector<Peer>{peer}, message, startByteType)) {
+    return;
+  }
+
   // Make job
   SendJob* job = new SendJobPeer;
   dynamic_cast<SendJobPeer*>(job)->m_peer = peer;
   job->m_selfPeer = m_selfPeer;
-  job->m_startbyte = startByteType;
-  job->m_message = message;
-  job->m_hash.clear();
+  job->m_message = make_shared<const OutgoingMessage>(message, startByteType);
 
   // Queue job
-  if (!m_sendQueue.bounded_push(job)) {
-    LOG_GENERAL(WARNING, "SendQueue is full");
-  }
+  QueueSendJob(job);
 }
 
 void P2PComm::SendBroadcastMessage(const vector<Peer>& peers,
@@ -837,6 +1143,10 @@ void P2PComm::SendBroadcastMessage(const vector<Peer>& peers,
     return;
   }
 
+  if (SendOnTransport(peers, message, START_BYTE_BROADCAST)) {
+    return;
+  }
+
   SHA2<HASH_TYPE::HASH_VARIANT_256> sha256;
   sha256.Update(message);
 
@@ -844,19 +1154,14 @@ void P2PComm::SendBroadcastMessage(const vector<Peer>& peers,
   SendJob* job = new SendJobPeers<vector<Peer>>;
   dynamic_cast<SendJobPeers<vector<Peer>>*>(job)->m_peers = peers;
   job->m_selfPeer = m_selfPeer;
-  job->m_startbyte = START_BYTE_BROADCAST;
-  job->m_message = message;
-  job->m_hash = sha256.Finalize();
-
-  bytes hashCopy(job->m_hash);
+  const bytes hash = sha256.Finalize();
+  job->m_message =
+      make_shared<const OutgoingMessage>(message, START_BYTE_BROADCAST, hash);
 
   // Queue job
-  if (!m_sendQueue.bounded_push(job)) {
-    LOG_GENERAL(WARNING, "SendQueue is full");
-  }
+  QueueSendJob(job);
 
-  lock_guard<mutex> guard(m_broadcastHashesMutex);
-  m_broadcastHashes.insert(hashCopy);
+  m_broadcastHashes.Insert(hash);
 }
 
 void P2PComm::SendBroadcastMessage(const deque<Peer>& peers,
@@ -867,6 +1172,10 @@ void P2PComm::SendBroadcastMessage(const deque<Peer>& peers,
     return;
   }
 
+  if (SendOnTransport(peers, message, START_BYTE_BROADCAST)) {
+    return;
+  }
+
   SHA2<HASH_TYPE::HASH_VARIANT_256> sha256;
   sha256.Update(message);
 
@@ -874,44 +1183,39 @@ void P2PComm::SendBroadcastMessage(const deque<Peer>& peers,
   SendJob* job = new SendJobPeers<deque<Peer>>;
   dynamic_cast<SendJobPeers<deque<Peer>>*>(job)->m_peers = peers;
   job->m_selfPeer = m_selfPeer;
-  job->m_startbyte = START_BYTE_BROADCAST;
-  job->m_message = message;
-  job->m_hash = sha256.Finalize();
-
-  bytes hashCopy(job->m_hash);
+  const bytes hash = sha256.Finalize();
+  job->m_message =
+      make_shared<const OutgoingMessage>(message, START_BYTE_BROADCAST, hash);
 
   // Queue job
-  if (!m_sendQueue.bounded_push(job)) {
-    LOG_GENERAL(WARNING, "SendQueue is full");
-  }
+  QueueSendJob(job);
 
-  lock_guard<mutex> guard(m_broadcastHashesMutex);
-  m_broadcastHashes.insert(hashCopy);
+  m_broadcastHashes.Insert(hash);
 }
 
 void P2PComm::RebroadcastMessage(const vector<Peer>& peers,
-                                 const bytes& message, const bytes& msg_hash) {
+                                 const bytes& message) {
   LOG_MARKER();
 
   // Make job
   SendJob* job = new SendJobPeers<vector<Peer>>;
   dynamic_cast<SendJobPeers<vector<Peer>>*>(job)->m_peers = peers;
   job->m_selfPeer = Peer();
-  job->m_startbyte = START_BYTE_BROADCAST;
-  copy(message.begin() + HDR_LEN + HASH_LEN, message.end(),
-       back_inserter(job->m_message));
-  job->m_hash = msg_hash;
+  // The received frame already carries the header and hash
+  job->m_message = make_shared<const OutgoingMessage>(bytes(message));
 
   // Queue job
-  if (!m_sendQueue.bounded_push(job)) {
-    LOG_GENERAL(WARNING, "SendQueue is full");
-  }
+  QueueSendJob(job);
 }
 
 void P2PComm::SendMessageNoQueue(const Peer& peer, const bytes& message,
                                  const unsigned char& startByteType) {
   // LOG_MARKER();
 
+  if (SendOnTransport(vector<Peer>{peer}, message, startByteType)) {
+    return;
+  }
+
   if (Blacklist::GetInstance().Exist(peer.m_ipAddress)) {
     LOG_GENERAL(INFO, "The node "
                           << peer
@@ -919,11 +1223,31 @@ void P2PComm::SendMessageNoQueue(const Peer& peer, const bytes& message,
     return;
   }
 
-  SendJob::SendMessageCore(peer, message, startByteType, {});
+  SendJob::SendMessageCore(peer, OutgoingMessage(message, startByteType));
+}
+
+SendQueueStats P2PComm::GetSendQueueStats(SendClass cls) const {
+  return m_sendQueue.GetStats(cls);
+}
+
+bool P2PComm::SendOnEventLoop(const Peer& peer,
+                              const OutgoingMessagePtr& message) {
+  if (m_sendLoops.empty()) {
+    return false;
+  }
+
+  // Keep every peer on the same loop so its frames stay in order
+  m_sendLoops.at(hash<Peer>()(peer) % m_sendLoops.size())->Send(peer, message);
+  return true;
 }
 
 bool P2PComm::SpreadRumor(const bytes& message) {
   LOG_MARKER();
+
+  if (SendOnTransport(vector<Peer>{Peer()}, message, START_BYTE_GOSSIP)) {
+    return true;
+  }
+
   return m_rumorManager.AddRumor(message);
 }
 
@@ -952,6 +1276,10 @@ void P2PComm::SendRumorToForeignPeers(const std::deque<Peer>& foreignPeers,
 
 void P2PComm::SetSelfPeer(const Peer& self) { m_selfPeer = self; }
 
+void P2PComm::SetTransport(Transport transport) {
+  m_transport = move(transport);
+}
+
 void P2PComm::SetSelfKey(const PairOfKey& self) { m_selfKey = self; }
 
 void P2PComm::InitializeRumorManager(
@@ -969,6 +1297,10 @@ void P2PComm::InitializeRumorManager(
   }
 }
 
+MemoryUsage P2PComm::GetRumorMemoryUsage() {
+  return m_rumorManager.GetMemoryUsage();
+}
+
 Signature P2PComm::SignMessage(const bytes& message) {
   // LOG_MARKER();
 
@@ -19,15 +19,18 @@
 #define __P2PCOMM_H__
 
 #include <event2/util.h>
-#include <boost/lockfree/queue.hpp>
 #include <deque>
 #include <functional>
+#include <memory>
 #include <mutex>
 #include <set>
 #include <vector>
 
+#include "BroadcastHashFilter.h"
 #include "Peer.h"
 #include "RumorManager.h"
+#include "SendEventLoop.h"
+#include "SendQueue.h"
 #include "common/BaseType.h"
 #include "common/Constants.h"
 #include "libUtils/Logger.h"
@@ -37,23 +40,43 @@ struct evconnlistener;
 
 extern const unsigned char START_BYTE_NORMAL;
 extern const unsigned char START_BYTE_GOSSIP;
+/// Version, start byte and 4-byte length before every message body
+extern const unsigned int HDR_LEN;
+
+/// Immutable wire frame (header, optional broadcast hash and body) that is
+/// assembled once and shared by every send job and peer it goes out to.
+class OutgoingMessage {
+  bytes m_frame;
+
+ public:
+  /// Frames the message body for sending.
+  OutgoingMessage(const bytes& body, unsigned char startByte,
+                  const bytes& hash = {});
+
+  /// Takes over a frame that is already in wire format (e.g., a received
+  /// broadcast message being forwarded).
+  explicit OutgoingMessage(bytes&& frame);
+
+  const bytes& GetFrame() const { return m_frame; }
+  unsigned char GetStartByte() const;
+  bytes GetHash() const;
+};
+
+using OutgoingMessagePtr = std::shared_ptr<const OutgoingMessage>;
 
 class SendJob {
  protected:
   static uint32_t writeMsg(const void* buf, int cli_sock, const Peer& from,
                            const uint32_t message_length);
-  static bool SendMessageSocketCore(const Peer& peer, const bytes& message,
-                                    unsigned char start_byte,
-                                    const bytes& msg_hash);
+  static bool SendMessageSocketCore(const Peer& peer,
+                                    const OutgoingMessage& message);
 
  public:
   Peer m_selfPeer;
-  unsigned char m_startbyte;
-  bytes m_message;
-  bytes m_hash;
+  OutgoingMessagePtr m_message;
 
-  static void SendMessageCore(const Peer& peer, const bytes message,
-                              unsigned char startbyte, const bytes hash);
+  static void SendMessageCore(const Peer& peer,
+                              const OutgoingMessage& message);
 
   virtual ~SendJob() {}
   virtual void DoSend() = 0;
@@ -74,18 +97,12 @@ class SendJobPeers : public SendJob {
 
 /// Provides network layer functionality.
 class P2PComm {
-  std::set<bytes> m_broadcastHashes;
-  std::mutex m_broadcastHashesMutex;
-  std::deque<
-      std::pair<bytes, std::chrono::time_point<std::chrono::system_clock>>>
-      m_broadcastToRemove;
-  std::mutex m_broadcastToRemoveMutex;
+  /// Hashes of broadcast messages sent or received within BROADCAST_EXPIRY
+  BroadcastHashFilter m_broadcastHashes;
   RumorManager m_rumorManager;
 
   const static uint32_t MAXPUMPMESSAGE = 128;
 
-  void ClearBroadcastHashAsync(const bytes& message_hash);
-
   P2PComm();
   ~P2PComm();
 
@@ -99,14 +116,29 @@ class P2PComm {
   Peer m_selfPeer;
   PairOfKey m_selfKey;
 
-  ThreadPool m_SendPool{MAXMESSAGE, "SendPool"};
+  ThreadPool m_SendPool{MAXMESSAGE, "SendPool",
+                        ThreadPlacement::Resolve(SEND_PLACEMENT, "SendPool")};
 
-  boost::lockfree::queue<SendJob*> m_sendQueue;
+  /// Non-blocking send loops, empty if SEND_EVENT_LOOP_THREADS is 0
+  std::vector<std::unique_ptr<SendEventLoop>> m_sendLoops;
+
+  SendQueue m_sendQueue;
   void ProcessSendJob(SendJob* job);
+  void QueueSendJob(SendJob* job);
 
+  /// wireFrame is the frame as received, which is what gets rebroadcast
   static void ProcessBroadCastMsg(bytes& message, const uint32_t messageLength,
-                                  const Peer& from);
+                                  const Peer& from, const bytes& wireFrame);
   static void ProcessGossipMsg(bytes& message, Peer& from);
+  /// Handles the single gossip message in message[begin, end)
+  static void ProcessGossipSubMsg(const bytes& message, size_t begin,
+                                  size_t end, Peer& from);
+  /// Rebuilds the uncompressed frame of a message sent with
+  /// START_BYTE_COMPRESSED
+  static bool DecompressFrame(const bytes& message, bytes& frame);
+  static void ProcessReceivedMessage(bytes& message, Peer& from);
+  static Peer GetRemotePeer(struct bufferevent* bev);
+  static void FreeInboundConnection(struct bufferevent* bev);
 
   static void EventCallback(struct bufferevent* bev, short events, void* ctx);
   static void ReadCallback(struct bufferevent* bev, void* ctx);
@@ -124,14 +156,31 @@ class P2PComm {
   using BroadcastListFunc = std::function<std::vector<Peer>(
       unsigned char msg_type, unsigned char ins_type, const Peer&)>;
 
+  /// Stands in for the sockets, e.g., in a network simulation. Messages given
+  /// to SendMessage, SendBroadcastMessage and SendMessageNoQueue are handed to
+  /// it once per peer, with their start byte, instead of being queued.
+  /// SpreadRumor hands it a default Peer, meaning the whole gossip network.
+  using Transport = std::function<void(const Peer& peer, const bytes& message,
+                                       unsigned char startByte)>;
+
   void InitializeRumorManager(const VectorOfNode& peers,
                               const std::vector<PubKey>& fullNetworkKeys);
+
+  /// Estimated memory held by the gossip state of the rumor manager
+  MemoryUsage GetRumorMemoryUsage();
   inline static bool IsHostHavingNetworkIssue();
 
  private:
   using SocketCloser = std::unique_ptr<int, void (*)(int*)>;
   static Dispatcher m_dispatcher;
   static BroadcastListFunc m_broadcast_list_retriever;
+  /// bufferevent options of inbound connections, threadsafe with reactors
+  static int m_inboundOptions;
+  Transport m_transport;
+
+  template <class Container>
+  bool SendOnTransport(const Container& peers, const bytes& message,
+                       unsigned char startByte) const;
 
  public:
   /// Accept TCP connection for libevent usage
@@ -140,7 +189,8 @@ class P2PComm {
                                struct sockaddr* cli_addr, int socklen,
                                void* arg);
 
-  /// Listens for incoming socket connections.
+  /// Listens for incoming socket connections on RECEIVE_REACTOR_THREADS
+  /// event loops, and runs the first one on the calling thread.
   void StartMessagePump(uint32_t listen_port_host, Dispatcher dispatcher,
                         BroadcastListFunc broadcast_list_retriever);
 
@@ -164,15 +214,25 @@ class P2PComm {
   void SendBroadcastMessage(const std::deque<Peer>& peers,
                             const bytes& message);
 
-  void RebroadcastMessage(const std::vector<Peer>& peers, const bytes& message,
-                          const bytes& msg_hash);
+  /// Forwards a received broadcast frame (header and hash included) as is.
+  void RebroadcastMessage(const std::vector<Peer>& peers, const bytes& message);
 
   void SendMessageNoQueue(
       const Peer& peer, const bytes& message,
       const unsigned char& startByteType = START_BYTE_NORMAL);
 
+  /// Hands the frame to the peer's send loop. Returns false if the send loops
+  /// are disabled and the caller has to send it with a blocking write.
+  bool SendOnEventLoop(const Peer& peer, const OutgoingMessagePtr& message);
+
+  /// Returns the enqueue/dispatch/drop counters of one send class.
+  SendQueueStats GetSendQueueStats(SendClass cls) const;
+
   void SetSelfPeer(const Peer& self);
 
+  /// Routes all sends through the transport. Set it before anything is sent.
+  void SetTransport(Transport transport);
+
   void SetSelfKey(const PairOfKey& self);
 
   bool SpreadRumor(const bytes& message);
@@ -61,8 +61,8 @@ const string Peer::GetPrintableIPAddress() const {
 
 unsigned int Peer::Serialize(bytes& dst, unsigned int offset) const {
   Serializable::SetNumber<uint128_t>(dst, offset, m_ipAddress, UINT128_SIZE);
-  Serializable::SetNumber<uint32_t>(dst, offset + UINT128_SIZE,
-                                    m_listenPortHost, sizeof(uint32_t));
+  Serializable::SetNumber<uint32_t, sizeof(uint32_t)>(
+      dst, offset + UINT128_SIZE, m_listenPortHost);
 
   return UINT128_SIZE + sizeof(uint32_t);
 }
@@ -70,8 +70,8 @@ unsigned int Peer::Serialize(bytes& dst, unsigned int offset) const {
 int Peer::Deserialize(const bytes& src, unsigned int offset) {
   try {
     m_ipAddress = Serializable::GetNumber<uint128_t>(src, offset, UINT128_SIZE);
-    m_listenPortHost = Serializable::GetNumber<uint32_t>(
-        src, offset + UINT128_SIZE, sizeof(uint32_t));
+    m_listenPortHost = Serializable::GetNumber<uint32_t, sizeof(uint32_t)>(
+        src, offset + UINT128_SIZE);
   } catch (const std::exception& e) {
     LOG_GENERAL(WARNING, "Error with Peer::Deserialize." << ' ' << e.what());
     return -1;
@@ -0,0 +1,213 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <errno.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <thread>
+
+#include "PeerConnectionPool.h"
+#include "common/Constants.h"
+#include "libUtils/DetachedFunction.h"
+#include "libUtils/Logger.h"
+
+using namespace std;
+
+PeerConnectionPool::PeerConnectionPool() {
+  if (!IsEnabled()) {
+    return;
+  }
+
+  auto func = [this]() -> void {
+    while (true) {
+      this_thread::sleep_for(
+          chrono::seconds(IDLE_CONNECTION_TIMEOUT_IN_SECONDS));
+      EvictIdle();
+    }
+  };
+
+  DetachedFunction(1, func);
+}
+
+PeerConnectionPool::~PeerConnectionPool() { Clear(); }
+
+PeerConnectionPool& PeerConnectionPool::GetInstance() {
+  static PeerConnectionPool pool;
+  return pool;
+}
+
+bool PeerConnectionPool::IsEnabled() {
+  return MAX_IDLE_CONNECTIONS_PER_PEER > 0 &&
+         IDLE_CONNECTION_TIMEOUT_IN_SECONDS > 0;
+}
+
+void PeerConnectionPool::CloseSocket(int sock) {
+  shutdown(sock, SHUT_RDWR);
+  close(sock);
+}
+
+bool PeerConnectionPool::IsHealthy(
+    const IdleConnection& conn, const chrono::steady_clock::time_point& now) {
+  if (now - conn.m_lastUsed >=
+      chrono::seconds(IDLE_CONNECTION_TIMEOUT_IN_SECONDS)) {
+    return false;
+  }
+
+  // The remote end never writes back on this connection, so any readable
+  // state means it was either closed (0) or reset (error other than EAGAIN)
+  unsigned char c;
+  ssize_t n = recv(conn.m_socket, &c, 1, MSG_PEEK | MSG_DONTWAIT);
+  if (n < 0) {
+    return errno == EAGAIN || errno == EWOULDBLOCK;
+  }
+
+  return false;
+}
+
+int PeerConnectionPool::Acquire(const Peer& peer) {
+  if (!IsEnabled()) {
+    return -1;
+  }
+
+  const auto now = chrono::steady_clock::now();
+  vector<int> toClose;
+  int sock = -1;
+
+  {
+    lock_guard<mutex> g(m_mutexIdleConnections);
+
+    auto it = m_idleConnections.find(peer);
+    if (it == m_idleConnections.end()) {
+      return -1;
+    }
+
+    // Most recently used connections are at the back
+    auto& conns = it->second;
+    while (!conns.empty()) {
+      IdleConnection conn = conns.back();
+      conns.pop_back();
+      if (IsHealthy(conn, now)) {
+        sock = conn.m_socket;
+        break;
+      }
+      toClose.emplace_back(conn.m_socket);
+    }
+
+    if (conns.empty()) {
+      m_idleConnections.erase(it);
+    }
+  }
+
+  for (const auto& s : toClose) {
+    CloseSocket(s);
+  }
+
+  return sock;
+}
+
+void PeerConnectionPool::Release(const Peer& peer, int sock) {
+  if (sock < 0) {
+    return;
+  }
+
+  if (IsEnabled()) {
+    lock_guard<mutex> g(m_mutexIdleConnections);
+    auto& conns = m_idleConnections[peer];
+    if (conns.size() < MAX_IDLE_CONNECTIONS_PER_PEER) {
+      conns.push_back({sock, chrono::steady_clock::now()});
+      return;
+    }
+  }
+
+  CloseSocket(sock);
+}
+
+void PeerConnectionPool::EvictIdle() {
+  const auto now = chrono::steady_clock::now();
+  vector<int> toClose;
+
+  {
+    lock_guard<mutex> g(m_mutexIdleConnections);
+
+    for (auto it = m_idleConnections.begin(); it != m_idleConnections.end();) {
+      auto& conns = it->second;
+      auto healthyEnd = partition(conns.begin(), conns.end(),
+                                  [&now](const IdleConnection& conn) {
+                                    return IsHealthy(conn, now);
+                                  });
+      for (auto c = healthyEnd; c != conns.end(); ++c) {
+        toClose.emplace_back(c->m_socket);
+      }
+      conns.erase(healthyEnd, conns.end());
+
+      // Keep the most recently used connection at the back
+      sort(conns.begin(), conns.end(),
+           [](const IdleConnection& a, const IdleConnection& b) {
+             return a.m_lastUsed < b.m_lastUsed;
+           });
+
+      if (conns.empty()) {
+        it = m_idleConnections.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+
+  for (const auto& s : toClose) {
+    CloseSocket(s);
+  }
+
+  if (!toClose.empty()) {
+    LOG_GENERAL(INFO, "Closed " << toClose.size() << " idle connections");
+  }
+}
+
+void PeerConnectionPool::Remove(const Peer& peer) {
+  vector<IdleConnection> conns;
+
+  {
+    lock_guard<mutex> g(m_mutexIdleConnections);
+    auto it = m_idleConnections.find(peer);
+    if (it == m_idleConnections.end()) {
+      return;
+    }
+    conns.swap(it->second);
+    m_idleConnections.erase(it);
+  }
+
+  for (const auto& conn : conns) {
+    CloseSocket(conn.m_socket);
+  }
+}
+
+void PeerConnectionPool::Clear() {
+  lock_guard<mutex> g(m_mutexIdleConnections);
+  for (const auto& entry : m_idleConnections) {
+    for (const auto& conn : entry.second) {
+      CloseSocket(conn.m_socket);
+    }
+  }
+  m_idleConnections.clear();
+}
+
+size_t PeerConnectionPool::GetIdleCount(const Peer& peer) {
+  lock_guard<mutex> g(m_mutexIdleConnections);
+  auto it = m_idleConnections.find(peer);
+  return (it == m_idleConnections.end()) ? 0 : it->second.size();
+}
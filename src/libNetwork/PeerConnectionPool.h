@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __PEERCONNECTIONPOOL_H__
+#define __PEERCONNECTIONPOOL_H__
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <vector>
+
+#include "Peer.h"
+
+/// Keeps outgoing TCP connections open after a send so that later messages to
+/// the same peer can skip the connect handshake.
+///
+/// A connection is checked out by exactly one sender at a time (Acquire), so
+/// writes on one connection never interleave. Idle connections are health
+/// checked before reuse and closed once they exceed the idle timeout.
+class PeerConnectionPool {
+  struct IdleConnection {
+    int m_socket;
+    std::chrono::steady_clock::time_point m_lastUsed;
+  };
+
+  std::mutex m_mutexIdleConnections;
+  std::map<Peer, std::vector<IdleConnection>> m_idleConnections;
+
+  PeerConnectionPool();
+  ~PeerConnectionPool();
+
+  // Singleton should not implement these
+  PeerConnectionPool(PeerConnectionPool const&) = delete;
+  void operator=(PeerConnectionPool const&) = delete;
+
+  static bool IsHealthy(const IdleConnection& conn,
+                        const std::chrono::steady_clock::time_point& now);
+  static void CloseSocket(int sock);
+
+ public:
+  static PeerConnectionPool& GetInstance();
+
+  /// Returns true if connections are kept open after a send
+  static bool IsEnabled();
+
+  /// Checks out an idle and healthy connection to the peer, or returns -1 if
+  /// the caller has to open a new one
+  int Acquire(const Peer& peer);
+
+  /// Returns a connection after a successful write. The socket is closed
+  /// instead if the peer already has enough idle connections.
+  void Release(const Peer& peer, int sock);
+
+  /// Closes every idle connection that exceeded the idle timeout
+  void EvictIdle();
+
+  /// Closes all idle connections to the peer (e.g., after blacklisting)
+  void Remove(const Peer& peer);
+
+  /// Closes all idle connections
+  void Clear();
+
+  /// Number of idle connections currently held for the peer
+  size_t GetIdleCount(const Peer& peer);
+};
+
+#endif  // __PEERCONNECTIONPOOL_H__
@@ -15,11 +15,13 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
+
 #include "PeerStore.h"
 
 using namespace std;
 
-PeerStore::PeerStore() {}
+PeerStore::PeerStore() : m_version(1), m_snapshotVersion(0) {}
 
 PeerStore::~PeerStore() {}
 
@@ -30,60 +32,99 @@ PeerStore& PeerStore::GetStore() {
 
 void PeerStore::AddPeerPair(const PubKey& key, const Peer& peer) {
   lock_guard<mutex> g(m_mutexStore);
-  m_store[key] = peer;
+  auto it = m_store.find(key);
+  if (it == m_store.end()) {
+    m_store.emplace(key, peer);
+  } else if (it->second == peer) {
+    return;
+  } else {
+    it->second = peer;
+  }
+  m_version++;
 }
 
-unsigned int PeerStore::GetPeerCount() const { return m_store.size(); }
+unsigned int PeerStore::GetPeerCount() const {
+  lock_guard<mutex> g(m_mutexStore);
+  return m_store.size();
+}
 
 Peer PeerStore::GetPeer(const PubKey& key) {
   lock_guard<mutex> g(m_mutexStore);
-  try {
-    return m_store.at(key);
-  } catch (out_of_range& e) {
+  auto it = m_store.find(key);
+  if (it == m_store.end()) {
     return Peer(0, 0);
   }
+  return it->second;
 }
 
-vector<pair<PubKey, Peer>> PeerStore::GetAllPeerPairs() const {
-  vector<pair<PubKey, Peer>> result;
-
-  lock_guard<mutex> g(m_mutexStore);
+void PeerStore::RefreshSnapshots() const {
+  if (m_snapshotVersion == m_version) {
+    return;
+  }
 
-  for (auto const& i : m_store) {
-    result.push_back(i);
+  auto pairs = make_shared<VectorOfNode>(m_store.begin(), m_store.end());
+  sort(pairs->begin(), pairs->end(),
+       [](const pair<PubKey, Peer>& a, const pair<PubKey, Peer>& b) {
+         return a.first < b.first;
+       });
+
+  auto peers = make_shared<vector<Peer>>();
+  auto keys = make_shared<vector<PubKey>>();
+  peers->reserve(pairs->size());
+  keys->reserve(pairs->size());
+  for (const auto& i : *pairs) {
+    keys->emplace_back(i.first);
+    peers->emplace_back(i.second);
   }
 
-  return result;
+  m_pairsSnapshot = move(pairs);
+  m_peersSnapshot = move(peers);
+  m_keysSnapshot = move(keys);
+  m_snapshotVersion = m_version;
 }
 
-vector<Peer> PeerStore::GetAllPeers() const {
-  vector<Peer> result;
+VectorOfNode PeerStore::GetAllPeerPairs() const {
+  return *GetPeerPairsSnapshot();
+}
 
-  lock_guard<mutex> g(m_mutexStore);
-  for (const auto& it : m_store) {
-    result.emplace_back(it.second);
-  }
+vector<Peer> PeerStore::GetAllPeers() const { return *GetPeersSnapshot(); }
 
-  return result;
+vector<PubKey> PeerStore::GetAllKeys() const { return *GetKeysSnapshot(); }
+
+shared_ptr<const VectorOfNode> PeerStore::GetPeerPairsSnapshot() const {
+  lock_guard<mutex> g(m_mutexStore);
+  RefreshSnapshots();
+  return m_pairsSnapshot;
 }
 
-vector<PubKey> PeerStore::GetAllKeys() const {
-  vector<PubKey> result;
+shared_ptr<const vector<Peer>> PeerStore::GetPeersSnapshot() const {
+  lock_guard<mutex> g(m_mutexStore);
+  RefreshSnapshots();
+  return m_peersSnapshot;
+}
 
+shared_ptr<const vector<PubKey>> PeerStore::GetKeysSnapshot() const {
   lock_guard<mutex> g(m_mutexStore);
-  for (const auto& it : m_store) {
-    result.emplace_back(it.first);
-  }
+  RefreshSnapshots();
+  return m_keysSnapshot;
+}
 
-  return result;
+uint64_t PeerStore::GetVersion() const {
+  lock_guard<mutex> g(m_mutexStore);
+  return m_version;
 }
 
 void PeerStore::RemovePeer(const PubKey& key) {
   lock_guard<mutex> g(m_mutexStore);
-  m_store.erase(key);
+  if (m_store.erase(key) > 0) {
+    m_version++;
+  }
 }
 
 void PeerStore::RemoveAllPeers() {
   lock_guard<mutex> g(m_mutexStore);
-  m_store.clear();
+  if (!m_store.empty()) {
+    m_store.clear();
+    m_version++;
+  }
 }
@@ -19,8 +19,11 @@
 #define __PEER_STORE_H__
 
 #include <array>
-#include <map>
+#include <cstdint>
+#include <memory>
 #include <mutex>
+#include <unordered_map>
+#include <vector>
 
 #include "Peer.h"
 #include "ShardStruct.h"
@@ -29,12 +32,27 @@
 #include "libCrypto/Schnorr.h"
 
 /// Maintains the Peer-PubKey lookup table.
+///
+/// Peers are looked up by the hash of their compressed key. The lists of
+/// all peers are snapshots, ordered by key, rebuilt on the first read after
+/// the table changes and shared by every reader until the next change.
 class PeerStore {
   mutable std::mutex m_mutexStore;
-  std::map<PubKey, Peer> m_store;
+  std::unordered_map<PubKey, Peer> m_store;
+  /// Bumped on every change to m_store
+  uint64_t m_version;
+
+  mutable uint64_t m_snapshotVersion;
+  mutable std::shared_ptr<const VectorOfNode> m_pairsSnapshot;
+  mutable std::shared_ptr<const std::vector<Peer>> m_peersSnapshot;
+  mutable std::shared_ptr<const std::vector<PubKey>> m_keysSnapshot;
+
   PeerStore();
   ~PeerStore();
 
+  /// Rebuilds the snapshots if m_store changed. m_mutexStore must be held.
+  void RefreshSnapshots() const;
+
  public:
   /// Returns the singleton PeerStore instance.
   static PeerStore& GetStore();
@@ -57,6 +75,19 @@ class PeerStore {
   /// Returns a list of all public keys in the table.
   std::vector<PubKey> GetAllKeys() const;
 
+  /// Returns the shared snapshot of all public keys and peers, without
+  /// copying it.
+  std::shared_ptr<const VectorOfNode> GetPeerPairsSnapshot() const;
+
+  /// Returns the shared snapshot of all peers, without copying it.
+  std::shared_ptr<const std::vector<Peer>> GetPeersSnapshot() const;
+
+  /// Returns the shared snapshot of all public keys, without copying it.
+  std::shared_ptr<const std::vector<PubKey>> GetKeysSnapshot() const;
+
+  /// Returns a number that changes whenever the table does.
+  uint64_t GetVersion() const;
+
   /// Removes the Peer associated with the specified PubKey from the table.
   void RemovePeer(const PubKey& key);
 
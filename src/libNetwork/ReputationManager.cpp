@@ -17,12 +17,22 @@
 
 #include "ReputationManager.h"
 
-#include "Blacklist.h"
+#include <algorithm>
+
 #include "libUtils/IPConverter.h"
 #include "libUtils/Logger.h"
 #include "libUtils/SafeMath.h"
 
-ReputationManager::ReputationManager() {}
+using namespace std;
+using namespace boost::multiprecision;
+
+namespace {
+inline uint64_t Pack(int32_t score, uint32_t epoch) {
+  return (static_cast<uint64_t>(epoch) << 32) | static_cast<uint32_t>(score);
+}
+}  // namespace
+
+ReputationManager::ReputationManager() : m_epoch(0) {}
 
 ReputationManager::~ReputationManager() {}
 
@@ -31,112 +41,154 @@ ReputationManager& ReputationManager::GetInstance() {
   return RM;
 }
 
-bool ReputationManager::IsNodeBanned(
-    const boost::multiprecision::uint128_t& IPAddress) {
-  return (GetReputation(IPAddress) <= REPTHRESHOLD);
+ReputationManager::Shard& ReputationManager::GetShard(
+    const uint128_t& IPAddress) {
+  return m_shards[hash<uint128_t>()(IPAddress) % SHARDS];
 }
 
-void ReputationManager::PunishNode(
-    const boost::multiprecision::uint128_t& IPAddress, int32_t Penalty) {
-  UpdateReputation(IPAddress, Penalty);
-  if (!Blacklist::GetInstance().Exist(IPAddress) and IsNodeBanned(IPAddress)) {
-    LOG_GENERAL(INFO, "Node " << IPConverter::ToStrFromNumericalIP(IPAddress)
-                              << " banned.");
-    Blacklist::GetInstance().Add(IPAddress);
+template <typename F>
+auto ReputationManager::WithScore(const uint128_t& IPAddress, F&& func)
+    -> decltype(func(declval<atomic<uint64_t>&>())) {
+  Shard& shard = GetShard(IPAddress);
+  while (true) {
+    {
+      // The counter is updated atomically, the lock only keeps it alive
+      shared_lock<shared_timed_mutex> lock(shard.m_mutex);
+      auto it = shard.m_scores.find(IPAddress);
+      if (it != shard.m_scores.end()) {
+        return func(it->second);
+      }
+    }
+
+    lock_guard<shared_timed_mutex> lock(shard.m_mutex);
+    shard.m_scores.emplace(
+        piecewise_construct, forward_as_tuple(IPAddress),
+        forward_as_tuple(Pack(ScoreType::GOOD, m_epoch.load())));
   }
 }
 
-void ReputationManager::AwardAllNodes() {
-  std::vector<boost::multiprecision::uint128_t> AllKnownIPs = GetAllKnownIP();
-  for (const auto& ip : AllKnownIPs) {
-    AwardNode(ip);
+int32_t ReputationManager::CurrentScore(uint64_t packed,
+                                        uint32_t epoch) const {
+  const int32_t score = static_cast<int32_t>(static_cast<uint32_t>(packed));
+  const uint32_t missed = epoch - static_cast<uint32_t>(packed >> 32);
+  if (missed == 0 || score >= ScoreType::UPPERREPTHRESHOLD) {
+    return score;
   }
+
+  // Awards stop at the upper bound, so k of them add up to one clamp
+  const int64_t awarded =
+      score + static_cast<int64_t>(missed) * ScoreType::AWARD_FOR_GOOD_NODES;
+  return static_cast<int32_t>(
+      min<int64_t>(awarded, ScoreType::UPPERREPTHRESHOLD));
 }
 
-void ReputationManager::AddNodeIfNotKnown(
-    const boost::multiprecision::uint128_t& IPAddress) {
-  std::lock_guard<std::mutex> lock(m_mutexReputations);
-  AddNodeIfNotKnownInternal(IPAddress);
+bool ReputationManager::IsNodeBanned(const uint128_t& IPAddress) {
+  return (GetReputation(IPAddress) <= REPTHRESHOLD);
 }
 
-void ReputationManager::AddNodeIfNotKnownInternal(
-    const boost::multiprecision::uint128_t& IPAddress) {
-  if (m_Reputations.find(IPAddress) == m_Reputations.end()) {
-    m_Reputations.emplace(IPAddress, ScoreType::GOOD);
+void ReputationManager::PunishNode(const uint128_t& IPAddress,
+                                   int32_t Penalty) {
+  if (UpdateReputation(IPAddress, Penalty)) {
+    {
+      lock_guard<mutex> lock(m_mutexBanned);
+      m_banned.insert(IPAddress);
+    }
+    if (!Blacklist::GetInstance().Exist(IPAddress)) {
+      LOG_GENERAL(INFO, "Node " << IPConverter::ToStrFromNumericalIP(IPAddress)
+                                << " banned.");
+      Blacklist::GetInstance().Add(IPAddress);
+    }
   }
 }
 
-int32_t ReputationManager::GetReputation(
-    const boost::multiprecision::uint128_t& IPAddress) {
-  std::lock_guard<std::mutex> lock(m_mutexReputations);
-  AddNodeIfNotKnownInternal(IPAddress);
-  return m_Reputations[IPAddress];
-}
+void ReputationManager::AwardAllNodes() {
+  m_epoch++;
+
+  vector<uint128_t> unbanned;
+  {
+    lock_guard<mutex> lock(m_mutexBanned);
+    for (auto it = m_banned.begin(); it != m_banned.end();) {
+      if (IsNodeBanned(*it)) {
+        ++it;
+      } else {
+        unbanned.emplace_back(*it);
+        it = m_banned.erase(it);
+      }
+    }
+  }
 
-void ReputationManager::Clear() {
-  LOG_MARKER();
-  std::lock_guard<std::mutex> lock(m_mutexReputations);
-  m_Reputations.clear();
+  for (const auto& ip : unbanned) {
+    if (Blacklist::GetInstance().Exist(ip)) {
+      LOG_GENERAL(INFO, "Node " << IPConverter::ToStrFromNumericalIP(ip)
+                                << " unbanned.");
+      Blacklist::GetInstance().Remove(ip);
+    }
+  }
 }
 
-void ReputationManager::SetReputation(
-    const boost::multiprecision::uint128_t& IPAddress,
-    const int32_t ReputationScore) {
-  std::lock_guard<std::mutex> lock(m_mutexReputations);
-  AddNodeIfNotKnownInternal(IPAddress);
-
-  if (ReputationScore > ScoreType::UPPERREPTHRESHOLD) {
-    LOG_GENERAL(
-        WARNING,
-        "Reputation score too high. Exceed upper bound. ReputationScore: "
-            << ReputationScore << ". Setting reputation to "
-            << ScoreType::UPPERREPTHRESHOLD);
-    m_Reputations[IPAddress] = ScoreType::UPPERREPTHRESHOLD;
-    return;
-  }
+void ReputationManager::AddNodeIfNotKnown(const uint128_t& IPAddress) {
+  WithScore(IPAddress, [](atomic<uint64_t>&) {});
+}
 
-  m_Reputations[IPAddress] = ReputationScore;
+int32_t ReputationManager::GetReputation(const uint128_t& IPAddress) {
+  return WithScore(IPAddress, [this](atomic<uint64_t>& counter) {
+    return CurrentScore(counter.load(), m_epoch.load());
+  });
 }
 
-void ReputationManager::UpdateReputation(
-    const boost::multiprecision::uint128_t& IPAddress,
-    const int32_t ReputationScoreDelta) {
-  int32_t NewRep = GetReputation(IPAddress);
+bool ReputationManager::UpdateReputation(const uint128_t& IPAddress,
+                                         const int32_t ReputationScoreDelta) {
+  return WithScore(IPAddress, [&](atomic<uint64_t>& counter) {
+    return UpdateScore(counter, ReputationScoreDelta);
+  });
+}
 
-  // Update result with score delta
-  if (!(SafeMath<int32_t>::add(NewRep, ReputationScoreDelta, NewRep))) {
-    LOG_GENERAL(WARNING, "Underflow/overflow detected.");
-  }
+bool ReputationManager::UpdateScore(atomic<uint64_t>& counter,
+                                    const int32_t ReputationScoreDelta) {
+  uint64_t packed = counter.load();
+  while (true) {
+    const uint32_t epoch = m_epoch.load();
+    const int32_t OldRep = CurrentScore(packed, epoch);
+    int32_t NewRep = OldRep;
+
+    // Update result with score delta
+    if (!(SafeMath<int32_t>::add(NewRep, ReputationScoreDelta, NewRep))) {
+      LOG_GENERAL(WARNING, "Underflow/overflow detected.");
+    }
 
-  // Further deduct score if node is going to be ban
-  if (NewRep <= REPTHRESHOLD && !IsNodeBanned(IPAddress)) {
-    if (!(SafeMath<int32_t>::sub(
-            NewRep, ScoreType::BAN_MULTIPLIER * ScoreType::AWARD_FOR_GOOD_NODES,
-            NewRep))) {
-      LOG_GENERAL(WARNING, "Underflow detected.");
+    // Further deduct score if node is going to be ban
+    const bool banning = (NewRep <= REPTHRESHOLD) && (OldRep > REPTHRESHOLD);
+    if (banning) {
+      if (!(SafeMath<int32_t>::sub(
+              NewRep,
+              ScoreType::BAN_MULTIPLIER * ScoreType::AWARD_FOR_GOOD_NODES,
+              NewRep))) {
+        LOG_GENERAL(WARNING, "Underflow detected.");
+      }
     }
-  }
-  SetReputation(IPAddress, NewRep);
-}
 
-std::vector<boost::multiprecision::uint128_t>
-ReputationManager::GetAllKnownIP() {
-  std::lock_guard<std::mutex> lock(m_mutexReputations);
+    if (NewRep > ScoreType::UPPERREPTHRESHOLD) {
+      LOG_GENERAL(
+          WARNING,
+          "Reputation score too high. Exceed upper bound. ReputationScore: "
+              << NewRep << ". Setting reputation to "
+              << ScoreType::UPPERREPTHRESHOLD);
+      NewRep = ScoreType::UPPERREPTHRESHOLD;
+    }
 
-  std::vector<boost::multiprecision::uint128_t> AllKnownIPs;
-  for (const auto& node : m_Reputations) {
-    AllKnownIPs.emplace_back(node.first);
+    // On failure packed is reloaded, and the update redone on the new score
+    if (counter.compare_exchange_weak(packed, Pack(NewRep, epoch))) {
+      return banning;
+    }
   }
-  return AllKnownIPs;
 }
 
-void ReputationManager::AwardNode(
-    const boost::multiprecision::uint128_t& IPAddress) {
-  UpdateReputation(IPAddress, ScoreType::AWARD_FOR_GOOD_NODES);
-
-  if (Blacklist::GetInstance().Exist(IPAddress) && !IsNodeBanned(IPAddress)) {
-    LOG_GENERAL(INFO, "Node " << IPConverter::ToStrFromNumericalIP(IPAddress)
-                              << " unbanned.");
-    Blacklist::GetInstance().Remove(IPAddress);
+void ReputationManager::Clear() {
+  LOG_MARKER();
+  for (auto& shard : m_shards) {
+    lock_guard<shared_timed_mutex> lock(shard.m_mutex);
+    shard.m_scores.clear();
   }
+  lock_guard<mutex> lock(m_mutexBanned);
+  m_banned.clear();
 }
@@ -18,6 +18,7 @@
 #ifndef __REPUTATION_MANAGER_H__
 #define __REPUTATION_MANAGER_H__
 
+#include "Blacklist.h"
 #include "Peer.h"
 #include "common/Constants.h"
 
@@ -25,22 +26,39 @@
 #pragma GCC diagnostic ignored "-Wunused-parameter"
 #include <boost/multiprecision/cpp_int.hpp>
 #pragma GCC diagnostic pop
-#include <functional>
+#include <atomic>
+#include <cstdint>
 #include <mutex>
+#include <shared_mutex>
 #include <unordered_map>
-#include <vector>
+#include <unordered_set>
+#include <utility>
 
+/// Reputation scores of the IPs we talk to.
+///
+/// Scores live in a sharded map of atomic counters, so checking a node only
+/// takes a shared lock on one shard and an atomic load. Each counter also
+/// records the award epoch it was last written in; AwardAllNodes just starts
+/// a new epoch, and the awards a node missed are added whenever its score is
+/// read or updated.
 class ReputationManager {
-  // Custom hasher
-  // Ref:
-  // https://stackoverflow.com/questions/32082786/why-i-cannot-use-neither-stdunordered-map-nor-boostunordered-map-with-boost
-  template <typename T>
-  struct hash_str {
-    size_t operator()(const T& t) const {
-      return std::hash<std::string>()(t.str());
-    }
+  static const unsigned int SHARDS = 16;
+
+  struct Shard {
+    mutable std::shared_timed_mutex m_mutex;
+    /// Score in the low 32 bits, award epoch of the last write in the high
+    std::unordered_map<boost::multiprecision::uint128_t,
+                       std::atomic<uint64_t>>
+        m_scores;
   };
 
+  Shard m_shards[SHARDS];
+  std::atomic<uint32_t> m_epoch;
+
+  /// Nodes we banned, checked for unbanning after every award
+  std::mutex m_mutexBanned;
+  std::unordered_set<boost::multiprecision::uint128_t> m_banned;
+
   ReputationManager();
   ~ReputationManager();
 
@@ -49,12 +67,13 @@ class ReputationManager {
   void operator=(ReputationManager const&) = delete;
 
  public:
-  /// Returns the singleton P2PComm instance.
+  /// Returns the singleton ReputationManager instance.
   static ReputationManager& GetInstance();
   void AddNodeIfNotKnown(const boost::multiprecision::uint128_t& IPAddress);
   bool IsNodeBanned(const boost::multiprecision::uint128_t& IPAddress);
   void PunishNode(const boost::multiprecision::uint128_t& IPAddress,
                   const int32_t Penalty);
+  /// Awards every known node in O(1), plus a pass over the banned ones
   void AwardAllNodes();
   int32_t GetReputation(const boost::multiprecision::uint128_t& IPAddress);
   void Clear();
@@ -62,6 +81,7 @@ class ReputationManager {
   // To be use once hooked into core protocol
   enum PenaltyType : int32_t {
     PENALTY_CONN_REFUSE = -5,
+    PENALTY_RATE_LIMIT = -10,
     PENALTY_INVALID_MESSAGE = -50
   };
 
@@ -73,21 +93,18 @@ class ReputationManager {
     AWARD_FOR_GOOD_NODES = 50
   };
 
-  std::mutex m_mutexReputations;
-
  private:
-  std::unordered_map<boost::multiprecision::uint128_t, int32_t,
-                     hash_str<boost::multiprecision::uint128_t>>
-      m_Reputations;
-
-  void AddNodeIfNotKnownInternal(
-      const boost::multiprecision::uint128_t& IPAddress);
-  void SetReputation(const boost::multiprecision::uint128_t& IPAddress,
-                     const int32_t ReputationScore);
-  void UpdateReputation(const boost::multiprecision::uint128_t& IPAddress,
+  Shard& GetShard(const boost::multiprecision::uint128_t& IPAddress);
+  /// Calls func on the counter of the node, adding the node first if needed
+  template <typename F>
+  auto WithScore(const boost::multiprecision::uint128_t& IPAddress, F&& func)
+      -> decltype(func(std::declval<std::atomic<uint64_t>&>()));
+  int32_t CurrentScore(uint64_t packed, uint32_t epoch) const;
+  /// Both return true if the update banned the node
+  bool UpdateReputation(const boost::multiprecision::uint128_t& IPAddress,
                         const int32_t ReputationScoreDelta);
-  std::vector<boost::multiprecision::uint128_t> GetAllKnownIP();
-  void AwardNode(const boost::multiprecision::uint128_t& IPAddress);
+  bool UpdateScore(std::atomic<uint64_t>& counter,
+                   const int32_t ReputationScoreDelta);
 };
 
 #endif  // __REPUTATION_MANAGER_H__
@@ -17,6 +17,7 @@
 
 #include "RumorManager.h"
 
+#include <algorithm>
 #include <chrono>
 #include <string>
 #include <thread>
@@ -36,8 +37,70 @@ RRS::Message::Type convertType(uint8_t type) {
   }
 }
 
+/// A bimap keeps every element in two trees
+template <class Bimap>
+uint64_t BimapBytes(const Bimap& bimap) {
+  return bimap.size() * (sizeof(typename Bimap::left_key_type) +
+                         sizeof(typename Bimap::right_key_type) +
+                         6 * sizeof(void*));
+}
+
 }  // anonymous namespace
 
+MemoryUsage RumorManager::GetMemoryUsage() {
+  std::lock_guard<std::mutex> guard(m_mutex);
+
+  MemoryUsage usage;
+  usage.m_objects = m_rumorHashRawMsgBimap.size();
+  // Raw messages, and the hashes in the maps keyed by them
+  usage.m_bytes = m_rawMsgBytes;
+  for (const auto& entry : m_rumorHashRawMsgBimap) {
+    usage.m_bytes += entry.left.size();
+  }
+  for (const auto& entry : m_rumorIdHashBimap) {
+    usage.m_bytes += entry.right.size();
+  }
+  for (const auto& entry : m_hashesSubscriberMap) {
+    usage.m_bytes +=
+        entry.first.size() + MemoryStats::TreeContainerBytes(entry.second);
+  }
+  for (const auto& entry : m_rumorHashKeySigMap) {
+    usage.m_bytes += entry.first.size() + entry.second.m_ofRawMsg.size() +
+                     entry.second.m_ofHash.size();
+  }
+  for (const auto& entry : m_verifiedMsgTimestamp) {
+    usage.m_bytes += entry.first.size();
+  }
+  for (const auto& entry : m_evictedMsgTimestamp) {
+    usage.m_bytes += entry.first.size();
+  }
+  for (const auto& hash : m_verifiedMsgHashes) {
+    usage.m_bytes += hash.size();
+  }
+  for (const auto& hash : m_evictedMsgHashes) {
+    usage.m_bytes += hash.size();
+  }
+  for (const auto& message : m_bufferRawMsg) {
+    usage.m_bytes += message.size();
+  }
+
+  usage.m_bytes += BimapBytes(m_rumorHashRawMsgBimap) +
+                   BimapBytes(m_rumorIdHashBimap) +
+                   BimapBytes(m_peerIdPeerBimap) +
+                   BimapBytes(m_pubKeyPeerBiMap) +
+                   MemoryStats::TreeContainerBytes(m_hashesSubscriberMap) +
+                   MemoryStats::TreeContainerBytes(m_rumorHashKeySigMap) +
+                   MemoryStats::TreeContainerBytes(m_verifiedMsgHashes) +
+                   MemoryStats::TreeContainerBytes(m_evictedMsgHashes) +
+                   MemoryStats::ArrayBytes(m_rumorRawMsgTimestamp) +
+                   MemoryStats::ArrayBytes(m_verifiedMsgTimestamp) +
+                   MemoryStats::ArrayBytes(m_evictedMsgTimestamp) +
+                   MemoryStats::ArrayBytes(m_bufferRawMsg) +
+                   MemoryStats::ArrayBytes(m_fullNetworkKeys) +
+                   MemoryStats::HashContainerBytes(m_peerIdSet);
+  return usage;
+}
+
 // CONSTRUCTORS
 RumorManager::RumorManager()
     : m_peerIdPeerBimap(),
@@ -47,6 +110,7 @@ RumorManager::RumorManager()
       m_selfPeer(),
       m_selfKey(),
       m_rumorRawMsgTimestamp(),
+      m_rawMsgBytes(0),
       m_rumorIdGenerator(0),
       m_mutex(),
       m_continueRoundMutex(),
@@ -142,9 +206,16 @@ bool RumorManager::Initialize(const VectorOfNode& peers, const Peer& myself,
   m_selfKey = myKeys;
   m_rumorHashRawMsgBimap.clear();
   m_rumorRawMsgTimestamp.clear();
+  m_rawMsgBytes = 0;
+  m_evictedMsgHashes.clear();
+  m_evictedMsgTimestamp.clear();
   m_fullNetworkKeys.clear();
   m_pubKeyPeerBiMap.clear();
   m_hashesSubscriberMap.clear();
+  m_rumorHashKeySigMap.clear();
+  m_emptyMsgKeySig.clear();
+  m_verifiedMsgHashes.clear();
+  m_verifiedMsgTimestamp.clear();
 
   int peerIdGenerator = 0;
   for (const auto& p : peers) {
@@ -167,6 +238,11 @@ bool RumorManager::Initialize(const VectorOfNode& peers, const Peer& myself,
     m_rumorHolder.reset(new RRS::RumorHolder(m_peerIdSet, 0));
   }
 
+  if (GOSSIP_ADAPTIVE_FANOUT) {
+    m_rumorHolder->enableAdaptation(GOSSIP_ADAPTIVE_MIN_NEIGHBORS,
+                                    GOSSIP_ADAPTIVE_MIN_ROUNDS);
+  }
+
   // RawMessage older than below expiry will be cleared.
   // Its calculated as (last KEEP_RAWMSG_FROM_LAST_N_ROUNDS rounds X each ROUND
   // time)
@@ -259,6 +335,7 @@ bool RumorManager::AddRumor(const RumorManager::RawBytes& message) {
         // add the timestamp for this raw rumor message
         m_rumorRawMsgTimestamp.push_back(std::make_pair(
             result.first, std::chrono::high_resolution_clock::now()));
+        m_rawMsgBytes += message.size();
 
         std::string output;
         if (!DataConversion::Uint8VecToHexStr(hash, output)) {
@@ -271,7 +348,9 @@ bool RumorManager::AddRumor(const RumorManager::RawBytes& message) {
                         << output.substr(0, 6) << " ]",
                     message, Logger::MAX_BYTES_TO_DISPLAY);
 
-        return m_rumorHolder->addRumor(m_rumorIdGenerator);
+        bool added = m_rumorHolder->addRumor(m_rumorIdGenerator);
+        EvictRawMessages();
+        return added;
       }
     } else {
       LOG_GENERAL(DEBUG, "This Rumor was already received. No problem.");
@@ -283,27 +362,22 @@ bool RumorManager::AddRumor(const RumorManager::RawBytes& message) {
 
 RumorManager::RawBytes RumorManager::GenerateGossipForwardMessage(
     const RawBytes& message) {
-  // Add round and type to outgoing message
-  RawBytes cmd = {(unsigned char)RRS::Message::Type::FORWARD};
-  unsigned int cur_offset = RRSMessageOffset::R_ROUNDS;
-
-  Serializable::SetNumber<uint32_t>(cmd, cur_offset, 0, sizeof(uint32_t));
-
-  cur_offset += sizeof(uint32_t);
-
-  Serializable::SetNumber<uint32_t>(
-      cmd, cur_offset, m_selfPeer.m_listenPortHost, sizeof(uint32_t));
-
-  // Add pubkey and signature before message body
+  // Pubkey and signature go before message body
   RawBytes tmp;
   m_selfKey.second.Serialize(tmp, 0);
 
   Signature sig = P2PComm::GetInstance().SignMessage(message);
   sig.Serialize(tmp, PUB_KEY_SIZE);
 
-  cmd.insert(cmd.end(), tmp.begin(), tmp.end());
+  // Add round and type to outgoing message
+  RawBytes cmd = {(unsigned char)RRS::Message::Type::FORWARD};
+  SerializableWriter writer(cmd, RRSMessageOffset::R_ROUNDS);
+  writer.Reserve(2 * sizeof(uint32_t) + tmp.size() + message.size());
 
-  cmd.insert(cmd.end(), message.begin(), message.end());
+  writer.Write<uint32_t, sizeof(uint32_t)>(0);
+  writer.Write<uint32_t, sizeof(uint32_t)>(m_selfPeer.m_listenPortHost);
+  writer.WriteBytes(tmp);
+  writer.WriteBytes(message);
 
   return cmd;
 }
@@ -396,11 +470,17 @@ std::pair<bool, RumorManager::RawBytes> RumorManager::VerifyMessage(
                                  SIGNATURE_RESPONSE_SIZE,
                              message.end());
 
-    if (!P2PComm::GetInstance().VerifyMessage(message_wo_keysig, toVerify,
-                                              senderPubKey)) {
-      LOG_GENERAL(WARNING,
-                  "Signature verification failed. so ignoring message");
-      return {false, {}};
+    const RawBytes msgHash = HashUtils::BytesToHash(message);
+    if (m_verifiedMsgHashes.find(msgHash) == m_verifiedMsgHashes.end()) {
+      if (!P2PComm::GetInstance().VerifyMessage(message_wo_keysig, toVerify,
+                                                senderPubKey)) {
+        LOG_GENERAL(WARNING,
+                    "Signature verification failed. so ignoring message");
+        return {false, {}};
+      }
+      m_verifiedMsgHashes.emplace(msgHash);
+      m_verifiedMsgTimestamp.emplace_back(
+          msgHash, std::chrono::high_resolution_clock::now());
     }
   } else {
     message_wo_keysig = message;
@@ -465,7 +545,9 @@ std::pair<bool, RumorManager::RawBytes> RumorManager::RumorReceived(
                              << ", Current Round: " << round);
       // check if we have received the real message for this old rumor.
       auto it = m_rumorHashRawMsgBimap.left.find(message_wo_keysig);
-      if (it == m_rumorHashRawMsgBimap.left.end()) {
+      if (it == m_rumorHashRawMsgBimap.left.end() &&
+          m_evictedMsgHashes.find(message_wo_keysig) ==
+              m_evictedMsgHashes.end()) {
         // didn't receive real message (PUSH) yet :( Lets ask this peer.
         RRS::Message pullMsg(RRS::Message::Type::PULL, recvdRumorId, -1);
         SendMessage(from, pullMsg);
@@ -481,6 +563,10 @@ std::pair<bool, RumorManager::RawBytes> RumorManager::RumorReceived(
         RRS::Message pushMsg(RRS::Message::Type::PUSH, recvdRumorId, -1);
         SendMessage(from, pushMsg);
       }
+    } else if (m_evictedMsgHashes.find(message_wo_keysig) !=
+               m_evictedMsgHashes.end()) {
+      LOG_GENERAL(DEBUG, "Ignoring PULL of evicted Gossip message from "
+                             << from);
     } else  // I dont have it as of now. Add this peer to subscriber list for
             // this hash message.
     {
@@ -510,6 +596,11 @@ std::pair<bool, RumorManager::RawBytes> RumorManager::RumorReceived(
         return {false, {}};
       }
 
+      if (m_evictedMsgHashes.find(hash) != m_evictedMsgHashes.end()) {
+        // Already dispatched and dropped to stay within the memory budget
+        return {false, {}};
+      }
+
       // toBeDispatched
       auto result = m_rumorHashRawMsgBimap.insert(
           RumorHashRumorBiMap::value_type(hash, message_wo_keysig));
@@ -523,6 +614,7 @@ std::pair<bool, RumorManager::RawBytes> RumorManager::RumorReceived(
         // add the timestamp for this raw rumor message
         m_rumorRawMsgTimestamp.push_back(std::make_pair(
             result.first, std::chrono::high_resolution_clock::now()));
+        m_rawMsgBytes += message_wo_keysig.size();
       } else {
         LOG_PAYLOAD(DEBUG,
                     "Old Gossip Raw message received from Peer: "
@@ -570,31 +662,31 @@ std::pair<bool, RumorManager::RawBytes> RumorManager::RumorReceived(
 }
 
 void RumorManager::AppendKeyAndSignature(RawBytes& result,
-                                         const RawBytes& messageToSig) {
+                                         const RawBytes& messageToSig,
+                                         RawBytes& cachedKeySig) {
   // Add pubkey and signature before message body
-  RawBytes tmp;
-  m_selfKey.second.Serialize(tmp, 0);
+  if (cachedKeySig.empty()) {
+    m_selfKey.second.Serialize(cachedKeySig, 0);
 
-  Signature sig = P2PComm::GetInstance().SignMessage(messageToSig);
-  sig.Serialize(tmp, PUB_KEY_SIZE);
+    Signature sig = P2PComm::GetInstance().SignMessage(messageToSig);
+    sig.Serialize(cachedKeySig, PUB_KEY_SIZE);
+  }
 
-  result.insert(result.end(), tmp.begin(), tmp.end());
+  result.insert(result.end(), cachedKeySig.begin(), cachedKeySig.end());
 }
 
-void RumorManager::SendMessage(const Peer& toPeer,
-                               const RRS::Message& message) {
+bool RumorManager::BuildMessage(const Peer& toPeer,
+                                const RRS::Message& message, RawBytes& cmd) {
   // Add round and type to outgoing message
   RRS::Message::Type t = message.type();
-  RawBytes cmd = {(unsigned char)t};
-  unsigned int cur_offset = RRSMessageOffset::R_ROUNDS;
-
-  Serializable::SetNumber<uint32_t>(cmd, cur_offset, message.rounds(),
-                                    sizeof(uint32_t));
-
-  cur_offset += sizeof(uint32_t);
+  cmd = {(unsigned char)t};
+  SerializableWriter writer(cmd, RRSMessageOffset::R_ROUNDS);
+  // Room for the header, key and signature; the body grows the rest
+  writer.Reserve(2 * sizeof(uint32_t) + PUB_KEY_SIZE +
+                 SIGNATURE_CHALLENGE_SIZE + SIGNATURE_RESPONSE_SIZE);
 
-  Serializable::SetNumber<uint32_t>(
-      cmd, cur_offset, m_selfPeer.m_listenPortHost, sizeof(uint32_t));
+  writer.Write<uint32_t, sizeof(uint32_t)>(message.rounds());
+  writer.Write<uint32_t, sizeof(uint32_t)>(m_selfPeer.m_listenPortHost);
 
   if (!(RRS::Message::Type::EMPTY_PUSH == t ||
         RRS::Message::Type::EMPTY_PULL == t)) {
@@ -607,14 +699,16 @@ void RumorManager::SendMessage(const Peer& toPeer,
         if (it2 != m_rumorHashRawMsgBimap.left.end()) {
           if (SIGN_VERIFY_NONEMPTY_MSGTYP) {
             // Add pubkey and signature before message body
-            AppendKeyAndSignature(cmd, it2->second);
+            AppendKeyAndSignature(
+                cmd, it2->second,
+                m_rumorHashKeySigMap[it1->second].m_ofRawMsg);
           }
 
           // Add raw message to outgoing message
           cmd.insert(cmd.end(), it2->second.begin(), it2->second.end());
           std::string gossipHashStr;
           if (!DataConversion::Uint8VecToHexStr(it1->second, gossipHashStr)) {
-            return;
+            return false;
           }
           LOG_GENERAL(INFO,
                       "Sending Gossip Raw Message of Gossip_Message_Hash : ["
@@ -622,14 +716,15 @@ void RumorManager::SendMessage(const Peer& toPeer,
                           << "] To Peer : " << toPeer);
         } else {
           // Nothing to send.
-          return;
+          return false;
         }
       } else if (RRS::Message::Type::LAZY_PUSH == t ||
                  RRS::Message::Type::LAZY_PULL == t ||
                  RRS::Message::Type::PULL == t) {
         if (SIGN_VERIFY_NONEMPTY_MSGTYP) {
           // Add pubkey and signature before message body
-          AppendKeyAndSignature(cmd, it1->second);
+          AppendKeyAndSignature(cmd, it1->second,
+                                m_rumorHashKeySigMap[it1->second].m_ofHash);
         }
 
         // Add hash message to outgoing message for types
@@ -638,19 +733,23 @@ void RumorManager::SendMessage(const Peer& toPeer,
         LOG_GENERAL(DEBUG, "Sending Gossip Hash Message: "
                                << message << " To Peer : " << toPeer);
       } else {
-        return;
+        return false;
       }
     }
   } else {  // EMPTY_PULL/ EMPTY_PUSH
     if (SIGN_VERIFY_EMPTY_MSGTYP) {
       // Add pubkey and signature before message body
       RawBytes dummyMsg = {'D', 'U', 'M', 'M', 'Y'};
-      AppendKeyAndSignature(cmd, dummyMsg);
+      AppendKeyAndSignature(cmd, dummyMsg, m_emptyMsgKeySig);
       // Add dummy message to outgoing message
       cmd.insert(cmd.end(), dummyMsg.begin(), dummyMsg.end());
     }
   }
 
+  return true;
+}
+
+void RumorManager::SendGossip(const Peer& toPeer, const RawBytes& cmd) {
   // Send the message to peer .
   if (SIMULATED_NETWORK_DELAY_IN_MS > 0) {
     std::this_thread::sleep_for(
@@ -659,11 +758,82 @@ void RumorManager::SendMessage(const Peer& toPeer,
   P2PComm::GetInstance().SendMessage(toPeer, cmd, START_BYTE_GOSSIP);
 }
 
+void RumorManager::SendMessage(const Peer& toPeer,
+                               const RRS::Message& message) {
+  RawBytes cmd;
+  if (BuildMessage(toPeer, message, cmd)) {
+    SendGossip(toPeer, cmd);
+  }
+}
+
 void RumorManager::SendMessages(const Peer& toPeer,
                                 const std::vector<RRS::Message>& messages) {
+  std::vector<RawBytes> cmds;
   for (auto& k : messages) {
-    SendMessage(toPeer, k);
+    RawBytes cmd;
+    if (BuildMessage(toPeer, k, cmd)) {
+      cmds.emplace_back(std::move(cmd));
+    }
+  }
+
+  if (!GOSSIP_BATCH_MESSAGES || cmds.size() < 2) {
+    for (const auto& cmd : cmds) {
+      SendGossip(toPeer, cmd);
+    }
+    return;
+  }
+
+  // <BATCH type> <4-byte round (unused)> <4-byte listen port> <4-byte count>
+  // then <4-byte length> <message> per message, each as it would have been
+  // sent on its own. Frames are kept under the receiver's size limit.
+  const unsigned int BATCH_HDR_LEN = 1 + 3 * sizeof(uint32_t);
+  const unsigned int COUNT_OFFSET = 1 + 2 * sizeof(uint32_t);
+
+  // Every frame is allocated once, big enough for all messages that fit in it
+  size_t batchCapacity = BATCH_HDR_LEN;
+  for (const auto& cmd : cmds) {
+    batchCapacity += sizeof(uint32_t) + cmd.size();
+  }
+  batchCapacity =
+      std::min<size_t>(batchCapacity, MAX_GOSSIP_MSG_SIZE_IN_BYTES);
+
+  RawBytes batch;
+  uint32_t count = 0;
+  const auto flush = [&]() {
+    if (count == 1) {
+      SendGossip(toPeer, RawBytes(batch.begin() + BATCH_HDR_LEN +
+                                      sizeof(uint32_t),
+                                  batch.end()));
+    } else if (count > 1) {
+      Serializable::SetNumber<uint32_t, sizeof(uint32_t)>(batch, COUNT_OFFSET,
+                                                          count);
+      SendGossip(toPeer, batch);
+    }
+
+    batch = {(unsigned char)RRS::Message::Type::BATCH};
+    batch.reserve(batchCapacity);
+    SerializableWriter writer(batch, RRSMessageOffset::R_ROUNDS);
+    writer.Write<uint32_t, sizeof(uint32_t)>(0);
+    writer.Write<uint32_t, sizeof(uint32_t)>(m_selfPeer.m_listenPortHost);
+    writer.Write<uint32_t, sizeof(uint32_t)>(0);
+    count = 0;
+  };
+
+  flush();
+  for (const auto& cmd : cmds) {
+    if (count > 0 && HDR_LEN + batch.size() + sizeof(uint32_t) + cmd.size() >=
+                         MAX_GOSSIP_MSG_SIZE_IN_BYTES) {
+      flush();
+    }
+    SerializableWriter writer(batch, batch.size());
+    writer.Write<uint32_t, sizeof(uint32_t)>(cmd.size());
+    writer.WriteBytes(cmd);
+    count++;
   }
+  flush();
+
+  LOG_GENERAL(DEBUG, "Sent " << cmds.size() << " Gossip Messages To Peer : "
+                             << toPeer);
 }
 
 // PUBLIC CONST METHODS
@@ -705,9 +875,11 @@ void RumorManager::CleanUp() {
                                                << m_rawMessageExpiryInMs);
     if (elapsed_milliseconds > m_rawMessageExpiryInMs) {  // older
       auto hash = m_rumorRawMsgTimestamp.front().first->left;
+      m_rawMsgBytes -= m_rumorRawMsgTimestamp.front().first->right.size();
       m_rumorHashRawMsgBimap.erase(m_rumorRawMsgTimestamp.front().first);
 
       m_rumorIdHashBimap.right.erase(hash);
+      m_rumorHashKeySigMap.erase(hash);
       m_rumorRawMsgTimestamp.pop_front();
       count++;
     } else {
@@ -717,4 +889,65 @@ void RumorManager::CleanUp() {
   if (count != 0) {
     LOG_GENERAL(INFO, "Cleaned " << count << " messages");
   }
+
+  while (!m_verifiedMsgTimestamp.empty() &&
+         std::chrono::duration_cast<std::chrono::milliseconds>(
+             now - m_verifiedMsgTimestamp.front().second)
+                 .count() > m_rawMessageExpiryInMs) {
+    m_verifiedMsgHashes.erase(m_verifiedMsgTimestamp.front().first);
+    m_verifiedMsgTimestamp.pop_front();
+  }
+
+  while (!m_evictedMsgTimestamp.empty() &&
+         std::chrono::duration_cast<std::chrono::milliseconds>(
+             now - m_evictedMsgTimestamp.front().second)
+                 .count() > m_rawMessageExpiryInMs) {
+    const RawBytes& hash = m_evictedMsgTimestamp.front().first;
+    m_evictedMsgHashes.erase(hash);
+    m_rumorIdHashBimap.right.erase(hash);
+    m_rumorHashKeySigMap.erase(hash);
+    m_evictedMsgTimestamp.pop_front();
+  }
+}
+
+void RumorManager::EvictRawMessages() {
+  if (GOSSIP_RAW_MSG_BUDGET_IN_BYTES == 0 ||
+      m_rawMsgBytes <= GOSSIP_RAW_MSG_BUDGET_IN_BYTES) {
+    return;
+  }
+
+  unsigned int count = 0;
+  auto now = std::chrono::high_resolution_clock::now();
+
+  // First pass only drops rumors that are done spreading; the second pass
+  // drops active ones too so the budget holds even under spam
+  for (bool completedOnly : {true, false}) {
+    auto it = m_rumorRawMsgTimestamp.begin();
+    while (it != m_rumorRawMsgTimestamp.end() &&
+           m_rawMsgBytes > GOSSIP_RAW_MSG_BUDGET_IN_BYTES) {
+      const RawBytes hash = it->first->left;
+      if (completedOnly) {
+        auto idIt = m_rumorIdHashBimap.right.find(hash);
+        if (idIt != m_rumorIdHashBimap.right.end() &&
+            !m_rumorHolder->isOld(idIt->second)) {
+          ++it;
+          continue;
+        }
+      }
+
+      m_rawMsgBytes -= it->first->right.size();
+      m_rumorHashRawMsgBimap.erase(it->first);
+      it = m_rumorRawMsgTimestamp.erase(it);
+      m_hashesSubscriberMap.erase(hash);
+      if (m_evictedMsgHashes.insert(hash).second) {
+        m_evictedMsgTimestamp.emplace_back(hash, now);
+      }
+      count++;
+    }
+  }
+
+  if (count != 0) {
+    LOG_GENERAL(INFO, "Evicted " << count << " raw messages, "
+                                 << m_rawMsgBytes << " bytes held");
+  }
 }
@@ -19,16 +19,19 @@
 #define __RUMORMANAGER_H__
 
 #include <boost/bimap.hpp>
+#include <chrono>
 #include <condition_variable>
 #include <deque>
 #include <map>
 #include <mutex>
+#include <set>
 #include <unordered_map>
 
 #include "Peer.h"
 #include "ShardStruct.h"
 #include "libCrypto/Schnorr.h"
 #include "libRumorSpreading/RumorHolder.h"
+#include "libUtils/MemoryStats.h"
 
 enum RRSMessageOffset : unsigned int {
   R_TYPE = 0,
@@ -52,6 +55,16 @@ class RumorManager {
                                std::chrono::high_resolution_clock::time_point>>
       RumorRawMsgTimestampDeque;
   typedef boost::bimap<PubKey, Peer> PubKeyPeerBiMap;
+  /// Our pubkey and signature prefixes of a rumor, signed once and reused for
+  /// every peer and round
+  struct RumorKeySig {
+    RawBytes m_ofRawMsg;
+    RawBytes m_ofHash;
+  };
+  typedef std::map<RawBytes, RumorKeySig> RumorHashKeySigMap;
+  typedef std::deque<
+      std::pair<RawBytes, std::chrono::high_resolution_clock::time_point>>
+      VerifiedMsgTimestampDeque;
 
   // MEMBERS
   std::shared_ptr<RRS::RumorHolder> m_rumorHolder;
@@ -66,6 +79,18 @@ class RumorManager {
   std::vector<RawBytes> m_bufferRawMsg;
   RumorRawMsgTimestampDeque m_rumorRawMsgTimestamp;
   std::vector<PubKey> m_fullNetworkKeys;
+  RumorHashKeySigMap m_rumorHashKeySigMap;
+  RawBytes m_emptyMsgKeySig;
+  /// Hashes of received messages whose signature was verified; a peer
+  /// resends the same bytes for a rumor, so these are not verified again
+  std::set<RawBytes> m_verifiedMsgHashes;
+  VerifiedMsgTimestampDeque m_verifiedMsgTimestamp;
+  /// Total size of the raw messages held in m_rumorHashRawMsgBimap
+  uint64_t m_rawMsgBytes;
+  /// Hashes of rumors whose raw message was evicted to stay within
+  /// GOSSIP_RAW_MSG_BUDGET_IN_BYTES; they are neither pulled nor stored again
+  std::set<RawBytes> m_evictedMsgHashes;
+  VerifiedMsgTimestampDeque m_evictedMsgTimestamp;
 
   int64_t m_rumorIdGenerator;
   std::mutex m_mutex;
@@ -80,8 +105,19 @@ class RumorManager {
 
   void SendMessage(const Peer& toPeer, const RRS::Message& message);
 
+  /// Serializes a message as sent to toPeer; returns false if there is
+  /// nothing to send
+  bool BuildMessage(const Peer& toPeer, const RRS::Message& message,
+                    RawBytes& cmd);
+
+  void SendGossip(const Peer& toPeer, const RawBytes& cmd);
+
   RawBytes GenerateGossipForwardMessage(const RawBytes& message);
 
+  /// Drops raw messages, oldest first and completed rumors before active
+  /// ones, until the store is back within GOSSIP_RAW_MSG_BUDGET_IN_BYTES
+  void EvictRawMessages();
+
  public:
   // CREATORS
   RumorManager();
@@ -116,12 +152,19 @@ class RumorManager {
 
   void PrintStatistics();
 
+  /// Estimated memory held by the rumors and their bookkeeping; objects
+  /// counts the raw messages held
+  MemoryUsage GetMemoryUsage();
+
   void CleanUp();
 
   std::pair<bool, RumorManager::RawBytes> VerifyMessage(
       const RawBytes& message, const RRS::Message::Type& t, const Peer& from);
 
-  void AppendKeyAndSignature(RawBytes& result, const RawBytes& messageToSig);
+  /// Appends our pubkey and the signature of messageToSig; cachedKeySig is
+  /// filled on first use and appended as is afterwards
+  void AppendKeyAndSignature(RawBytes& result, const RawBytes& messageToSig,
+                             RawBytes& cachedKeySig);
   // CONST METHODS
   const RumorIdRumorBimap& rumors() const;
 };
@@ -0,0 +1,381 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <errno.h>
+#include <event2/buffer.h>
+#include <event2/bufferevent.h>
+#include <event2/event.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cstring>
+
+#include "Blacklist.h"
+#include "P2PComm.h"
+#include "SendEventLoop.h"
+#include "common/Constants.h"
+#include "libUtils/Logger.h"
+
+using namespace std;
+
+namespace {
+bool IsNetworkIssue(int err) {
+  return (err == EHOSTUNREACH || err == EHOSTDOWN || err == ETIMEDOUT ||
+          err == ECONNREFUSED);
+}
+
+void ReleaseFrame([[gnu::unused]] const void* data,
+                  [[gnu::unused]] size_t datalen, void* extra) {
+  delete static_cast<OutgoingMessagePtr*>(extra);
+}
+}  // namespace
+
+SendEventLoop::Channel::Channel(SendEventLoop* loop, const Peer& peer)
+    : m_loop(loop),
+      m_peer(peer),
+      m_bev(nullptr),
+      m_retryTimer(evtimer_new(loop->m_base, RetryCallback, this)),
+      m_queuedBytes(0),
+      m_retries(0),
+      m_lastUsed(chrono::steady_clock::now()) {}
+
+SendEventLoop::Channel::~Channel() {
+  if (m_bev != nullptr) {
+    bufferevent_free(m_bev);
+  }
+  if (m_retryTimer != nullptr) {
+    event_free(m_retryTimer);
+  }
+}
+
+SendEventLoop::SendEventLoop(const ThreadPlacement& placement)
+    : m_base(event_base_new()),
+      m_wakeEvent(nullptr),
+      m_idleTimer(nullptr),
+      m_wakePipe{-1, -1},
+      m_stop(false) {
+  if (m_base == NULL) {
+    LOG_GENERAL(WARNING, "event_base_new failure.");
+    return;
+  }
+
+  if (pipe(m_wakePipe) != 0) {
+    LOG_GENERAL(WARNING, "pipe failure. Code = " << errno << " Desc: "
+                                                 << std::strerror(errno));
+    event_base_free(m_base);
+    m_base = NULL;
+    return;
+  }
+  evutil_make_socket_nonblocking(m_wakePipe[0]);
+  evutil_make_socket_nonblocking(m_wakePipe[1]);
+
+  m_wakeEvent = event_new(m_base, m_wakePipe[0], EV_READ | EV_PERSIST,
+                          WakeCallback, this);
+  event_add(m_wakeEvent, NULL);
+
+  m_idleTimer = event_new(m_base, -1, EV_PERSIST, IdleCallback, this);
+  struct timeval idleInterval = {
+      max<time_t>(IDLE_CONNECTION_TIMEOUT_IN_SECONDS, 1), 0};
+  event_add(m_idleTimer, &idleInterval);
+
+  m_thread = thread([this, placement]() {
+    placement.ApplyToCurrentThread();
+    event_base_dispatch(m_base);
+  });
+}
+
+SendEventLoop::~SendEventLoop() {
+  if (!IsRunning()) {
+    return;
+  }
+
+  m_stop = true;
+  Wake();
+  if (m_thread.joinable()) {
+    m_thread.join();
+  }
+
+  m_channels.clear();
+  event_free(m_idleTimer);
+  event_free(m_wakeEvent);
+  close(m_wakePipe[0]);
+  close(m_wakePipe[1]);
+  event_base_free(m_base);
+}
+
+bool SendEventLoop::IsRunning() const { return m_base != NULL; }
+
+void SendEventLoop::Wake() {
+  // A full pipe means the loop already has a wakeup pending
+  const unsigned char c = 0;
+  [[gnu::unused]] ssize_t n = write(m_wakePipe[1], &c, 1);
+}
+
+void SendEventLoop::Send(const Peer& peer, const OutgoingMessagePtr& message) {
+  if (peer.m_ipAddress == 0 && peer.m_listenPortHost == 0) {
+    LOG_GENERAL(INFO,
+                "I am sending to 0.0.0.0 at port 0. Don't send anything.");
+    return;
+  } else if (peer.m_listenPortHost == 0) {
+    LOG_GENERAL(INFO, "I am sending to " << peer.GetPrintableIPAddress()
+                                         << " at port 0. Investigate why!");
+    return;
+  }
+
+  LOG_PAYLOAD(DEBUG, "Sending message to " << peer, message->GetFrame(),
+              Logger::MAX_BYTES_TO_DISPLAY);
+
+  bool wasEmpty = false;
+  {
+    lock_guard<mutex> g(m_mutexPending);
+    wasEmpty = m_pending.empty();
+    m_pending.emplace_back(peer, message);
+  }
+
+  if (wasEmpty) {
+    Wake();
+  }
+}
+
+void SendEventLoop::WakeCallback(evutil_socket_t fd,
+                                 [[gnu::unused]] short what, void* arg) {
+  SendEventLoop* self = static_cast<SendEventLoop*>(arg);
+
+  unsigned char buf[64];
+  while (read(fd, buf, sizeof(buf)) > 0) {
+  }
+
+  if (self->m_stop) {
+    event_base_loopbreak(self->m_base);
+    return;
+  }
+
+  vector<pair<Peer, OutgoingMessagePtr>> pending;
+  {
+    lock_guard<mutex> g(self->m_mutexPending);
+    pending.swap(self->m_pending);
+  }
+
+  for (const auto& entry : pending) {
+    auto& channel = self->m_channels[entry.first];
+    if (!channel) {
+      channel.reset(new Channel(self, entry.first));
+    }
+    self->Enqueue(*channel, entry.second);
+  }
+}
+
+void SendEventLoop::Enqueue(Channel& channel,
+                            const OutgoingMessagePtr& message) {
+  if (channel.m_bev != nullptr) {
+    AddToOutput(channel, message);
+    return;
+  }
+
+  channel.m_inflight.emplace_back(message, 0);
+
+  // A reconnect is already scheduled and will pick this frame up
+  if (evtimer_pending(channel.m_retryTimer, NULL)) {
+    return;
+  }
+
+  Connect(channel);
+}
+
+void SendEventLoop::AddToOutput(Channel& channel,
+                                const OutgoingMessagePtr& message) {
+  const bytes& frame = message->GetFrame();
+
+  OutgoingMessagePtr* ref = new OutgoingMessagePtr(message);
+  if (evbuffer_add_reference(bufferevent_get_output(channel.m_bev),
+                             frame.data(), frame.size(), ReleaseFrame,
+                             ref) != 0) {
+    LOG_GENERAL(WARNING, "evbuffer_add_reference failure.");
+    delete ref;
+    return;
+  }
+
+  channel.m_queuedBytes += frame.size();
+  channel.m_inflight.emplace_back(message, channel.m_queuedBytes);
+  channel.m_lastUsed = chrono::steady_clock::now();
+}
+
+void SendEventLoop::Connect(Channel& channel) {
+  if (Blacklist::GetInstance().Exist(channel.m_peer.m_ipAddress)) {
+    LOG_GENERAL(INFO, "The node "
+                          << channel.m_peer
+                          << " is in black list, block all message to it.");
+    channel.m_inflight.clear();
+    return;
+  }
+
+  channel.m_bev = bufferevent_socket_new(m_base, -1, BEV_OPT_CLOSE_ON_FREE);
+  if (channel.m_bev == nullptr) {
+    LOG_GENERAL(WARNING, "bufferevent_socket_new failure.");
+    channel.m_inflight.clear();
+    return;
+  }
+
+  bufferevent_setcb(channel.m_bev, NULL, ChannelWriteCallback,
+                    ChannelEventCallback, &channel);
+  // Reading is only enabled to notice the remote end closing the connection
+  bufferevent_enable(channel.m_bev, EV_READ | EV_WRITE);
+
+  struct sockaddr_in serv_addr;
+  memset(&serv_addr, 0, sizeof(serv_addr));
+  serv_addr.sin_family = AF_INET;
+  serv_addr.sin_addr.s_addr =
+      channel.m_peer.m_ipAddress.convert_to<unsigned long>();
+  serv_addr.sin_port = htons(channel.m_peer.m_listenPortHost);
+
+  if (bufferevent_socket_connect(channel.m_bev, (struct sockaddr*)&serv_addr,
+                                 sizeof(serv_addr)) < 0) {
+    const int err = EVUTIL_SOCKET_ERROR();
+    LOG_GENERAL(WARNING, "Socket connect failed. Code = "
+                             << err << " Desc: " << std::strerror(err)
+                             << ". IP address: " << channel.m_peer);
+    bufferevent_free(channel.m_bev);
+    channel.m_bev = nullptr;
+    OnChannelFailure(channel, err);
+    return;
+  }
+
+  // Frames left over from a failed connection go out again from the start
+  auto leftover = move(channel.m_inflight);
+  channel.m_inflight.clear();
+  channel.m_queuedBytes = 0;
+  for (const auto& entry : leftover) {
+    AddToOutput(channel, entry.first);
+  }
+}
+
+void SendEventLoop::OnChannelFailure(Channel& channel, int err) {
+  if (IsNetworkIssue(err)) {
+    LOG_GENERAL(WARNING, "[blacklist] Encountered "
+                             << err << " (" << std::strerror(err)
+                             << "). Adding "
+                             << channel.m_peer.GetPrintableIPAddress()
+                             << " to blacklist");
+    Blacklist::GetInstance().Add(channel.m_peer.m_ipAddress);
+    channel.m_inflight.clear();
+    channel.m_retries = 0;
+    return;
+  }
+
+  if (channel.m_inflight.empty()) {
+    return;
+  }
+
+  channel.m_retries++;
+  if (channel.m_retries > MAXRETRYCONN) {
+    LOG_GENERAL(WARNING, "Socket connect failed over "
+                             << MAXRETRYCONN << " times. Dropping "
+                             << channel.m_inflight.size()
+                             << " messages to " << channel.m_peer);
+    channel.m_inflight.clear();
+    channel.m_retries = 0;
+    return;
+  }
+
+  LOG_GENERAL(WARNING, "Socket connect failed "
+                           << channel.m_retries << "/" << MAXRETRYCONN
+                           << ". IP address: " << channel.m_peer);
+
+  struct timeval delay = {
+      0, static_cast<suseconds_t>(
+             (rand() % PUMPMESSAGE_MILLISECONDS + 1) * 1000)};
+  evtimer_add(channel.m_retryTimer, &delay);
+}
+
+void SendEventLoop::RetryCallback([[gnu::unused]] evutil_socket_t fd,
+                                  [[gnu::unused]] short what, void* arg) {
+  Channel& channel = *static_cast<Channel*>(arg);
+  if (channel.m_bev == nullptr && !channel.m_inflight.empty()) {
+    channel.m_loop->Connect(channel);
+  }
+}
+
+void SendEventLoop::ChannelWriteCallback(
+    [[gnu::unused]] struct bufferevent* bev, void* arg) {
+  // The output buffer was fully flushed to the socket
+  Channel& channel = *static_cast<Channel*>(arg);
+  channel.m_inflight.clear();
+  channel.m_queuedBytes = 0;
+  channel.m_retries = 0;
+  channel.m_lastUsed = chrono::steady_clock::now();
+}
+
+void SendEventLoop::ChannelEventCallback(struct bufferevent* bev, short events,
+                                         void* arg) {
+  Channel& channel = *static_cast<Channel*>(arg);
+
+  if (events & BEV_EVENT_CONNECTED) {
+    int set = 1;
+    setsockopt(bufferevent_getfd(bev), IPPROTO_TCP, TCP_NODELAY, &set,
+               sizeof(set));
+    return;
+  }
+
+  if (!(events & (BEV_EVENT_ERROR | BEV_EVENT_EOF))) {
+    return;
+  }
+
+  const int err = (events & BEV_EVENT_ERROR) ? EVUTIL_SOCKET_ERROR() : 0;
+
+  // Forget the frames that fully made it out on this connection
+  const uint64_t remaining =
+      evbuffer_get_length(bufferevent_get_output(bev));
+  const uint64_t written = channel.m_queuedBytes - remaining;
+  while (!channel.m_inflight.empty() &&
+         channel.m_inflight.front().second <= written) {
+    channel.m_inflight.pop_front();
+  }
+
+  if (!channel.m_inflight.empty()) {
+    LOG_GENERAL(WARNING, "Connection to "
+                             << channel.m_peer << " lost with "
+                             << channel.m_inflight.size()
+                             << " messages not fully written. Code = " << err
+                             << " Desc: " << std::strerror(err));
+  }
+
+  bufferevent_free(bev);
+  channel.m_bev = nullptr;
+  channel.m_queuedBytes = 0;
+
+  channel.m_loop->OnChannelFailure(channel, err);
+}
+
+void SendEventLoop::IdleCallback([[gnu::unused]] evutil_socket_t fd,
+                                 [[gnu::unused]] short what, void* arg) {
+  SendEventLoop* self = static_cast<SendEventLoop*>(arg);
+  const auto now = chrono::steady_clock::now();
+  const auto timeout = chrono::seconds(IDLE_CONNECTION_TIMEOUT_IN_SECONDS);
+
+  for (auto it = self->m_channels.begin(); it != self->m_channels.end();) {
+    Channel& channel = *it->second;
+    const bool idle = channel.m_inflight.empty() &&
+                      !evtimer_pending(channel.m_retryTimer, NULL) &&
+                      (now - channel.m_lastUsed >= timeout);
+    if (idle) {
+      it = self->m_channels.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __SENDEVENTLOOP_H__
+#define __SENDEVENTLOOP_H__
+
+#include <event2/util.h>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "Peer.h"
+#include "libUtils/ThreadPlacement.h"
+
+class OutgoingMessage;
+using OutgoingMessagePtr = std::shared_ptr<const OutgoingMessage>;
+
+struct event;
+struct event_base;
+struct bufferevent;
+
+/// Non-blocking sender that writes frames to peers from a single libevent
+/// loop thread.
+///
+/// Each peer gets one persistent non-blocking connection. Frames are appended
+/// to its output buffer by reference (no copy), and libevent flushes the
+/// buffer chain with scatter-gather writes as the socket becomes writable, so
+/// one thread can keep many connections busy. Frames that were not fully
+/// written when a connection fails are resent on a new connection, up to
+/// MAXRETRYCONN times.
+class SendEventLoop {
+  struct Channel {
+    SendEventLoop* m_loop;
+    Peer m_peer;
+    struct bufferevent* m_bev;
+    struct event* m_retryTimer;
+    /// Frames not yet known to be written, with their end offset in the
+    /// output stream of the current connection
+    std::deque<std::pair<OutgoingMessagePtr, uint64_t>> m_inflight;
+    uint64_t m_queuedBytes;
+    unsigned int m_retries;
+    std::chrono::steady_clock::time_point m_lastUsed;
+
+    Channel(SendEventLoop* loop, const Peer& peer);
+    ~Channel();
+  };
+
+  struct event_base* m_base;
+  struct event* m_wakeEvent;
+  struct event* m_idleTimer;
+  int m_wakePipe[2];
+  std::atomic<bool> m_stop;
+
+  std::mutex m_mutexPending;
+  std::vector<std::pair<Peer, OutgoingMessagePtr>> m_pending;
+
+  /// Only touched from the loop thread
+  std::map<Peer, std::unique_ptr<Channel>> m_channels;
+
+  std::thread m_thread;
+
+  SendEventLoop(SendEventLoop const&) = delete;
+  void operator=(SendEventLoop const&) = delete;
+
+  static void WakeCallback(evutil_socket_t fd, short what, void* arg);
+  static void IdleCallback(evutil_socket_t fd, short what, void* arg);
+  static void RetryCallback(evutil_socket_t fd, short what, void* arg);
+  static void ChannelWriteCallback(struct bufferevent* bev, void* arg);
+  static void ChannelEventCallback(struct bufferevent* bev, short events,
+                                   void* arg);
+
+  void Enqueue(Channel& channel, const OutgoingMessagePtr& message);
+  void AddToOutput(Channel& channel, const OutgoingMessagePtr& message);
+  void Connect(Channel& channel);
+  void OnChannelFailure(Channel& channel, int err);
+  void Wake();
+
+ public:
+  /// The loop thread runs (and allocates its buffers) within placement
+  explicit SendEventLoop(const ThreadPlacement& placement = ThreadPlacement());
+  ~SendEventLoop();
+
+  /// Returns false if the loop could not be set up
+  bool IsRunning() const;
+
+  /// Queues the frame for the peer. Can be called from any thread.
+  void Send(const Peer& peer, const OutgoingMessagePtr& message);
+};
+
+#endif  // __SENDEVENTLOOP_H__
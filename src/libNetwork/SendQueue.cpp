@@ -0,0 +1,220 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+
+#include "P2PComm.h"
+#include "SendQueue.h"
+#include "common/Messages.h"
+#include "libUtils/Logger.h"
+
+using namespace std;
+
+SendQueue::SendQueue(const size_t (&capacity)[SEND_CLASS_COUNT],
+                     size_t maxInFlight)
+    : m_maxInFlight(max<size_t>(maxInFlight, 1)), m_inFlight(0) {
+  for (unsigned int i = 0; i < SEND_CLASS_COUNT; i++) {
+    m_queues[i].m_capacity = max<size_t>(capacity[i], 1);
+    m_queues[i].m_stats = {0, 0, 0, 0, 0};
+  }
+}
+
+SendQueue::~SendQueue() {
+  for (auto& queue : m_queues) {
+    for (const auto& job : queue.m_jobs) {
+      delete job;
+    }
+  }
+}
+
+SendClass SendQueue::Classify(unsigned char startByte, unsigned char msgType,
+                              unsigned char instruction) {
+  if (startByte == START_BYTE_GOSSIP) {
+    return SEND_CLASS_GOSSIP;
+  }
+
+  switch (msgType) {
+    case MessageType::CONSENSUSUSER:
+      return SEND_CLASS_CONSENSUS;
+    case MessageType::DIRECTORY:
+      switch (instruction) {
+        case DSInstructionType::DSBLOCKCONSENSUS:
+        case DSInstructionType::FINALBLOCKCONSENSUS:
+        case DSInstructionType::VIEWCHANGECONSENSUS:
+          return SEND_CLASS_CONSENSUS;
+        case DSInstructionType::POWSUBMISSION:
+        case DSInstructionType::MICROBLOCKSUBMISSION:
+        case DSInstructionType::VCPUSHLATESTDSTXBLOCK:
+          return SEND_CLASS_BLOCK;
+        case DSInstructionType::POWPACKETSUBMISSION:
+          return SEND_CLASS_BULK;
+        default:
+          return SEND_CLASS_GOSSIP;
+      }
+    case MessageType::NODE:
+      switch (instruction) {
+        case NodeInstructionType::MICROBLOCKCONSENSUS:
+        case NodeInstructionType::FALLBACKCONSENSUS:
+          return SEND_CLASS_CONSENSUS;
+        case NodeInstructionType::DSBLOCK:
+        case NodeInstructionType::FINALBLOCK:
+        case NodeInstructionType::MBNFORWARDTRANSACTION:
+        case NodeInstructionType::MBNFORWARDTXNHASHES:
+        case NodeInstructionType::GETMBNFORWARDTXNBODIES:
+        case NodeInstructionType::MBNFORWARDTXNBODIES:
+        case NodeInstructionType::VCBLOCK:
+        case NodeInstructionType::FALLBACKBLOCK:
+        case NodeInstructionType::BLOCKCHUNK:
+          return SEND_CLASS_BLOCK;
+        case NodeInstructionType::SUBMITTRANSACTION:
+        case NodeInstructionType::FORWARDTXNPACKET:
+        case NodeInstructionType::GETUPGRADECHUNK:
+        case NodeInstructionType::UPGRADECHUNK:
+          return SEND_CLASS_BULK;
+        default:
+          return SEND_CLASS_GOSSIP;
+      }
+    case MessageType::LOOKUP:
+      // Requests and replies of the lookup sync protocol
+      return SEND_CLASS_BULK;
+    default:
+      return SEND_CLASS_GOSSIP;
+  }
+}
+
+const char* SendQueue::GetClassName(SendClass cls) {
+  switch (cls) {
+    case SEND_CLASS_CONSENSUS:
+      return "CONSENSUS";
+    case SEND_CLASS_BLOCK:
+      return "BLOCK";
+    case SEND_CLASS_GOSSIP:
+      return "GOSSIP";
+    case SEND_CLASS_BULK:
+      return "BULK";
+    default:
+      return "UNKNOWN";
+  }
+}
+
+bool SendQueue::Push(SendJob* job, SendClass cls) {
+  if (job == NULL) {
+    return false;
+  }
+
+  if (cls >= SEND_CLASS_COUNT) {
+    cls = SEND_CLASS_BULK;
+  }
+
+  SendJob* dropped = NULL;
+  bool accepted = true;
+
+  {
+    lock_guard<mutex> g(m_mutex);
+    ClassQueue& queue = m_queues[cls];
+
+    if (queue.m_jobs.size() >= queue.m_capacity) {
+      queue.m_stats.m_dropped++;
+      if (cls == SEND_CLASS_CONSENSUS || cls == SEND_CLASS_BLOCK) {
+        dropped = queue.m_jobs.front();
+        queue.m_jobs.pop_front();
+      } else {
+        dropped = job;
+        accepted = false;
+      }
+    }
+
+    if (accepted) {
+      queue.m_jobs.emplace_back(job);
+      queue.m_stats.m_enqueued++;
+      queue.m_stats.m_maxDepth =
+          max(queue.m_stats.m_maxDepth, queue.m_jobs.size());
+    }
+  }
+
+  if (dropped != NULL) {
+    LOG_GENERAL(WARNING, "SendQueue is full for class "
+                             << GetClassName(cls) << ", dropped "
+                             << (accepted ? "oldest" : "new") << " job");
+    delete dropped;
+  }
+
+  if (accepted) {
+    m_cv.notify_one();
+  }
+
+  return accepted;
+}
+
+bool SendQueue::CanPopLocked() const {
+  if (m_inFlight >= m_maxInFlight) {
+    return false;
+  }
+
+  for (const auto& queue : m_queues) {
+    if (!queue.m_jobs.empty()) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+SendJob* SendQueue::PopLocked() {
+  for (auto& queue : m_queues) {
+    if (!queue.m_jobs.empty()) {
+      SendJob* job = queue.m_jobs.front();
+      queue.m_jobs.pop_front();
+      queue.m_stats.m_dispatched++;
+      m_inFlight++;
+      return job;
+    }
+  }
+
+  return NULL;
+}
+
+SendJob* SendQueue::Pop() {
+  unique_lock<mutex> lock(m_mutex);
+  m_cv.wait(lock, [this] { return CanPopLocked(); });
+  return PopLocked();
+}
+
+SendJob* SendQueue::TryPop() {
+  lock_guard<mutex> g(m_mutex);
+  return CanPopLocked() ? PopLocked() : NULL;
+}
+
+void SendQueue::Done() {
+  {
+    lock_guard<mutex> g(m_mutex);
+    if (m_inFlight > 0) {
+      m_inFlight--;
+    }
+  }
+  m_cv.notify_one();
+}
+
+SendQueueStats SendQueue::GetStats(SendClass cls) const {
+  lock_guard<mutex> g(m_mutex);
+  if (cls >= SEND_CLASS_COUNT) {
+    return {0, 0, 0, 0, 0};
+  }
+  SendQueueStats stats = m_queues[cls].m_stats;
+  stats.m_depth = m_queues[cls].m_jobs.size();
+  return stats;
+}
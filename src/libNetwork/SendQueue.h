@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __SENDQUEUE_H__
+#define __SENDQUEUE_H__
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+
+class SendJob;
+
+/// Traffic classes of outgoing messages, highest priority first
+enum SendClass : unsigned int {
+  SEND_CLASS_CONSENSUS = 0,
+  SEND_CLASS_BLOCK,
+  SEND_CLASS_GOSSIP,
+  SEND_CLASS_BULK,
+  SEND_CLASS_COUNT
+};
+
+struct SendQueueStats {
+  uint64_t m_enqueued;
+  uint64_t m_dispatched;
+  uint64_t m_dropped;
+  size_t m_depth;
+  size_t m_maxDepth;
+};
+
+/// Bounded multi-class queue of send jobs.
+///
+/// Jobs are dispatched in strict class order, and only while fewer than
+/// maxInFlight jobs are being sent, so queued consensus messages never wait
+/// behind bulk traffic that was handed out earlier. Each class has its own
+/// capacity. When a consensus or block class is full its oldest job is dropped
+/// (a newer round supersedes it); a full gossip or bulk class rejects the new
+/// job instead, pushing back on the producer.
+class SendQueue {
+  struct ClassQueue {
+    std::deque<SendJob*> m_jobs;
+    size_t m_capacity;
+    SendQueueStats m_stats;
+  };
+
+  mutable std::mutex m_mutex;
+  std::condition_variable m_cv;
+  ClassQueue m_queues[SEND_CLASS_COUNT];
+  size_t m_maxInFlight;
+  size_t m_inFlight;
+
+  SendQueue(SendQueue const&) = delete;
+  void operator=(SendQueue const&) = delete;
+
+  SendJob* PopLocked();
+  bool CanPopLocked() const;
+
+ public:
+  /// capacity[i] is the maximum number of queued jobs for class i
+  SendQueue(const size_t (&capacity)[SEND_CLASS_COUNT], size_t maxInFlight);
+  ~SendQueue();
+
+  /// Maps a message to its traffic class, based on the start byte and the
+  /// message type and instruction at the front of the body
+  static SendClass Classify(unsigned char startByte, unsigned char msgType,
+                            unsigned char instruction);
+
+  static const char* GetClassName(SendClass cls);
+
+  /// Queues the job and takes ownership of it. Returns false if the job was
+  /// rejected (and deleted) because its class is full.
+  bool Push(SendJob* job, SendClass cls);
+
+  /// Blocks until a job can be dispatched and returns it. Call Done() once the
+  /// job has been sent.
+  SendJob* Pop();
+
+  /// Same as Pop() but returns NULL instead of blocking
+  SendJob* TryPop();
+
+  /// Marks one popped job as finished
+  void Done();
+
+  SendQueueStats GetStats(SendClass cls) const;
+};
+
+#endif  // __SENDQUEUE_H__
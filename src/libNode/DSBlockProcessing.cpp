@@ -15,6 +15,7 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include <array>
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wunused-parameter"
@@ -33,6 +34,7 @@
 #include "depends/libTrie/TrieDB.h"
 #include "depends/libTrie/TrieHash.h"
 #include "libConsensus/ConsensusUser.h"
+#include "libCrypto/PubKeyTable.h"
 #include "libCrypto/Sha2.h"
 #include "libData/AccountData/Account.h"
 #include "libData/AccountData/AccountStore.h"
@@ -42,6 +44,9 @@
 #include "libNetwork/Blacklist.h"
 #include "libNetwork/Guard.h"
 #include "libPOW/pow.h"
+#include "libPersistence/BackgroundWriter.h"
+#include "libServer/Server.h"
+#include "libServer/WebSocketServer.h"
 #include "libUtils/BitVector.h"
 #include "libUtils/DataConversion.h"
 #include "libUtils/DetachedFunction.h"
@@ -60,6 +65,10 @@ void Node::StoreDSBlockToDisk(const DSBlock& dsblock) {
   LOG_MARKER();
 
   m_mediator.m_dsBlockChain.AddBlock(dsblock);
+  if (LOOKUP_NODE_MODE) {
+    Server::CacheDSBlockResponse(dsblock);
+    WebSocketServer::GetInstance().PublishDSBlock(dsblock);
+  }
   LOG_EPOCH(
       INFO, m_mediator.m_currentEpochNum,
       "Storing DS Block Number: "
@@ -78,6 +87,8 @@ void Node::StoreDSBlockToDisk(const DSBlock& dsblock) {
 
   BlockStorage::GetBlockStorage().PutDSBlock(dsblock.GetHeader().GetBlockNum(),
                                              serializedDSBlock);
+  BlockStorage::GetBlockStorage().PutBlockHash(
+      BlockType::DS, dsblock.GetHeader().GetBlockNum(), dsblock.GetBlockHash());
   m_mediator.m_ds->m_latestActiveDSBlockNum = dsblock.GetHeader().GetBlockNum();
   BlockStorage::GetBlockStorage().PutMetadata(
       LATESTACTIVEDSBLOCKNUM, DataConversion::StringToCharArray(to_string(
@@ -120,9 +131,6 @@ void Node::UpdateDSCommiteeComposition(deque<pair<PubKey, Peer>>& dsComm,
 bool Node::VerifyDSBlockCoSignature(const DSBlock& dsblock) {
   LOG_MARKER();
 
-  unsigned int index = 0;
-  unsigned int count = 0;
-
   const vector<bool>& B2 = dsblock.GetB2();
   if (m_mediator.m_DSCommittee->size() != B2.size()) {
     LOG_GENERAL(WARNING, "Mismatch: DS committee size = "
@@ -131,22 +139,18 @@ bool Node::VerifyDSBlockCoSignature(const DSBlock& dsblock) {
     return false;
   }
 
-  // Generate the aggregated key
-  vector<PubKey> keys;
-  for (auto const& kv : *m_mediator.m_DSCommittee) {
-    if (B2.at(index)) {
-      keys.emplace_back(kv.first);
-      count++;
-    }
-    index++;
-  }
-
-  if (count != ConsensusCommon::NumForConsensus(B2.size())) {
+  if (static_cast<unsigned int>(std::count(B2.begin(), B2.end(), true)) !=
+      ConsensusCommon::NumForConsensus(B2.size())) {
     LOG_GENERAL(WARNING, "Cosig was not generated by enough nodes");
     return false;
   }
 
-  shared_ptr<PubKey> aggregatedKey = MultiSig::AggregatePubKeys(keys);
+  // Generate the aggregated key
+  shared_ptr<PubKey> aggregatedKey =
+      m_mediator.m_DSCommitteeKeyCache.Aggregate(
+          *m_mediator.m_DSCommittee,
+          [](const PairOfNode& node) -> const PubKey& { return node.first; },
+          B2);
   if (aggregatedKey == nullptr) {
     LOG_GENERAL(WARNING, "Aggregated key generation failed");
     return false;
@@ -163,8 +167,11 @@ bool Node::VerifyDSBlockCoSignature(const DSBlock& dsblock) {
   if (!MultiSig::GetInstance().MultiSigVerify(
           message, 0, message.size(), dsblock.GetCS2(), *aggregatedKey)) {
     LOG_GENERAL(WARNING, "Cosig verification failed");
-    for (auto& kv : keys) {
-      LOG_GENERAL(WARNING, kv);
+    unsigned int index = 0;
+    for (const auto& kv : *m_mediator.m_DSCommittee) {
+      if (B2.at(index++)) {
+        LOG_GENERAL(WARNING, kv.first);
+      }
     }
     return false;
   }
@@ -218,6 +225,7 @@ bool Node::LoadShardingStructure(bool callByRetrieve) {
     lock_guard<mutex> g(m_mutexShardMember);
     // m_myShardMembers->clear();
     m_myShardMembers.reset(new std::deque<pair<PubKey, Peer>>);
+    InvalidateBroadcastLists();
     for (const auto& shardNode : my_shard) {
       m_myShardMembers->emplace_back(std::get<SHARD_NODE_PUBKEY>(shardNode),
                                      std::get<SHARD_NODE_PEER>(shardNode));
@@ -237,6 +245,15 @@ bool Node::LoadShardingStructure(bool callByRetrieve) {
     }
   }
 
+  // Precompute the keys the shard consensus responses are checked against.
+  // A shard node is not in the DS committee, so its DS tables can go.
+  vector<PubKey> shardKeys;
+  for (const auto& shardNode : my_shard) {
+    shardKeys.emplace_back(std::get<SHARD_NODE_PUBKEY>(shardNode));
+  }
+  PubKeyTableCache::GetInstance().Prepare(TABLE_GROUP_SHARD, shardKeys);
+  PubKeyTableCache::GetInstance().Prepare(TABLE_GROUP_DS_COMMITTEE, {});
+
   if (!foundMe && !callByRetrieve) {
     LOG_GENERAL(WARNING, "I'm not in the sharding structure, why?");
     RejoinAsNormal();
@@ -262,7 +279,7 @@ void Node::StartFirstTxEpoch() {
   uint16_t lastBlockHash = 0;
   if (m_mediator.m_currentEpochNum > 1) {
     lastBlockHash = DataConversion::charArrTo16Bits(
-        m_mediator.m_txBlockChain.GetLastBlock().GetBlockHash().asBytes());
+        m_mediator.m_txBlockChain.GetLastBlockPtr()->GetBlockHash().asBytes());
   }
 
   lock_guard<mutex> g(m_mutexShardMember);
@@ -290,7 +307,9 @@ void Node::StartFirstTxEpoch() {
         "[SHSTU]["
         << setw(15) << left << m_mediator.m_selfPeer.GetPrintableIPAddress()
         << "]["
-        << m_mediator.m_txBlockChain.GetLastBlock().GetHeader().GetBlockNum() +
+        << m_mediator.m_txBlockChain.GetLastBlockPtr()
+            ->GetHeader()
+            .GetBlockNum() +
                1
         << "] RECVD SHARDING STRUCTURE");
 
@@ -314,6 +333,7 @@ void Node::StartFirstTxEpoch() {
 
   CommitTxnPacketBuffer();
 
+  m_txDistributeStartTime = r_timer_start();
   auto main_func3 = [this]() mutable -> void { RunConsensusOnMicroBlock(); };
 
   DetachedFunction(1, main_func3);
@@ -330,6 +350,8 @@ bool Node::ProcessVCDSBlocksMessage(const bytes& message,
                                     unsigned int cur_offset,
                                     [[gnu::unused]] const Peer& from) {
   LOG_MARKER();
+  EpochTimeline::GetInstance().RecordMark(TIMELINE_MARK_DSBLOCK_RECEIVED,
+                                          m_mediator.GetTimelineRole());
   lock_guard<mutex> g(m_mutexDSBlock);
 
   if (!LOOKUP_NODE_MODE) {
@@ -349,12 +371,16 @@ bool Node::ProcessVCDSBlocksMessage(const bytes& message,
   DequeOfShard t_shards;
   uint32_t shardingStructureVersion = 0;
 
-  if (!Messenger::GetNodeVCDSBlocksMessage(
-          message, cur_offset, shardId, dsblock, vcBlocks,
-          shardingStructureVersion, t_shards)) {
-    LOG_EPOCH(WARNING, m_mediator.m_currentEpochNum,
-              "Messenger::GetNodeVCDSBlocksMessage failed.");
-    return false;
+  {
+    // A sharding structure diff applies on the one of the last DS epoch
+    lock_guard<mutex> g(m_mediator.m_ds->m_mutexShards);
+    if (!Messenger::GetNodeVCDSBlocksMessage(
+            message, cur_offset, shardId, dsblock, vcBlocks,
+            shardingStructureVersion, t_shards, m_mediator.m_ds->m_shards)) {
+      LOG_EPOCH(WARNING, m_mediator.m_currentEpochNum,
+                "Messenger::GetNodeVCDSBlocksMessage failed.");
+      return false;
+    }
   }
 
   if (shardingStructureVersion != SHARDINGSTRUCTURE_VERSION) {
@@ -480,7 +506,11 @@ bool Node::ProcessVCDSBlocksMessage(const bytes& message,
     }
   }
 
-  m_mediator.m_ds->m_shards = move(t_shards);
+  {
+    lock_guard<mutex> g(m_mediator.m_ds->m_mutexShards);
+    m_mediator.m_ds->m_shards = move(t_shards);
+    m_mediator.m_ds->PublishShards();
+  }
 
   m_myshardId = shardId;
   BlockStorage::GetBlockStorage().PutShardStructure(m_mediator.m_ds->m_shards,
@@ -488,10 +518,27 @@ bool Node::ProcessVCDSBlocksMessage(const bytes& message,
 
   LogReceivedDSBlockDetails(dsblock);
 
-  auto func = [this, dsblock]() mutable -> void {
+  // The first few members of the shard fetch a new release from the
+  // release host, everyone else fetches it from them
+  vector<Peer> upgradePeers;
+  if (!LOOKUP_NODE_MODE && m_myshardId < m_mediator.m_ds->m_shards.size()) {
+    const auto& myShard = m_mediator.m_ds->m_shards.at(m_myshardId);
+    for (unsigned int i = 0;
+         i < min<size_t>(UPGRADE_PEER_SEEDS, myShard.size()); i++) {
+      const Peer& peer = std::get<SHARD_NODE_PEER>(myShard.at(i));
+      if (peer == m_mediator.m_selfPeer) {
+        upgradePeers.clear();
+        break;
+      }
+      upgradePeers.emplace_back(peer);
+    }
+  }
+
+  auto func = [this, dsblock, upgradePeers]() mutable -> void {
     lock_guard<mutex> g(m_mediator.m_mutexCurSWInfo);
     if (m_mediator.m_curSWInfo != dsblock.GetHeader().GetSWInfo()) {
-      if (UpgradeManager::GetInstance().DownloadSW()) {
+      if (UpgradeManager::GetInstance().DownloadSW(
+              upgradePeers, m_mediator.m_selfPeer.m_listenPortHost)) {
         m_mediator.m_curSWInfo =
             *UpgradeManager::GetInstance().GetLatestSWInfo();
       }
@@ -510,7 +557,9 @@ bool Node::ProcessVCDSBlocksMessage(const bytes& message,
       "[DSBLK]["
       << setw(15) << left << m_mediator.m_selfPeer.GetPrintableIPAddress()
       << "]["
-      << m_mediator.m_txBlockChain.GetLastBlock().GetHeader().GetBlockNum() + 1
+      << m_mediator.m_txBlockChain.GetLastBlockPtr()
+          ->GetHeader()
+          .GetBlockNum() + 1
       << "] RECVD DSBLOCK");
 
   if (LOOKUP_NODE_MODE) {
@@ -521,6 +570,10 @@ bool Node::ProcessVCDSBlocksMessage(const bytes& message,
   m_mediator.UpdateDSBlockRand();  // Update the rand1 value for next PoW
   UpdateDSCommiteeComposition(*m_mediator.m_DSCommittee,
                               m_mediator.m_dsBlockChain.GetLastBlock());
+  {
+    lock_guard<mutex> g(m_mediator.m_mutexDSCommittee);
+    m_mediator.PublishDSCommittee();
+  }
 
   if (!LOOKUP_NODE_MODE) {
     uint32_t ds_size = m_mediator.m_DSCommittee->size();
@@ -530,7 +583,9 @@ bool Node::ProcessVCDSBlocksMessage(const bytes& message,
     // Assign from size -1 as it will get pop and push into ds committee data
     // structure, Hence, the ordering is reverse.
     const map<PubKey, Peer> dsPoWWinners =
-        m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetDSPoWWinners();
+        m_mediator.m_dsBlockChain.GetLastBlockPtr()
+            ->GetHeader()
+            .GetDSPoWWinners();
     unsigned int newDSMemberIndex = dsPoWWinners.size() - 1;
 
     // Under guard mode, first n member of ds comm belongs to DS guard.
@@ -557,8 +612,8 @@ bool Node::ProcessVCDSBlocksMessage(const bytes& message,
     uint16_t lastBlockHash = 0;
     if (m_mediator.m_currentEpochNum > 1) {
       lastBlockHash = DataConversion::charArrTo16Bits(
-          m_mediator.m_dsBlockChain.GetLastBlock()
-              .GetHeader()
+          m_mediator.m_dsBlockChain.GetLastBlockPtr()
+              ->GetHeader()
               .GetHashForRandom()
               .asBytes());
     }
@@ -576,6 +631,16 @@ bool Node::ProcessVCDSBlocksMessage(const bytes& message,
 
     // If I am the next DS leader -> need to set myself up as a DS node
     if (isNewDSMember) {
+      // Precompute the keys the DS consensus responses are checked against,
+      // and drop those of the shard this node leaves
+      vector<PubKey> dsKeys;
+      for (const auto& dsMember : *m_mediator.m_DSCommittee) {
+        dsKeys.emplace_back(dsMember.first);
+      }
+      PubKeyTableCache::GetInstance().Prepare(TABLE_GROUP_DS_COMMITTEE,
+                                              dsKeys);
+      PubKeyTableCache::GetInstance().Prepare(TABLE_GROUP_SHARD, {});
+
       // Process sharding structure as a DS node
       if (!m_mediator.m_ds->ProcessShardingStructure(
               m_mediator.m_ds->m_shards,
@@ -649,40 +714,49 @@ bool Node::ProcessVCDSBlocksMessage(const bytes& message,
       m_mediator.m_DSCommittee, m_mediator.m_ds->GetConsensusLeaderID());
 
   if (LOOKUP_NODE_MODE) {
-    bool canPutNewEntry = true;
-
-    // There's no quick way to get the oldest entry in leveldb
-    // Hence, we manage deleting old entries here instead
-    if ((MAX_ENTRIES_FOR_DIAGNOSTIC_DATA >
-         0) &&  // If limit is 0, skip deletion
-        (BlockStorage::GetBlockStorage().GetDiagnosticDataCount() >=
-         MAX_ENTRIES_FOR_DIAGNOSTIC_DATA) &&  // Limit reached
-        (m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetBlockNum() >=
-         MAX_ENTRIES_FOR_DIAGNOSTIC_DATA)) {  // DS Block number is not below
-                                              // limit
-
-      const uint64_t oldBlockNum =
-          m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetBlockNum() -
-          MAX_ENTRIES_FOR_DIAGNOSTIC_DATA;
-
-      canPutNewEntry =
-          BlockStorage::GetBlockStorage().DeleteDiagnosticData(oldBlockNum);
-
-      if (canPutNewEntry) {
-        LOG_GENERAL(INFO,
-                    "Deleted old diagnostic data for DS block " << oldBlockNum);
-      } else {
-        LOG_GENERAL(WARNING,
-                    "Failed to delete old diagnostic data for DS block "
-                        << oldBlockNum);
-      }
+    // Copied here, so that the write does not race with the next change of
+    // the sharding structure or the committee
+    const uint64_t dsBlockNum =
+        m_mediator.m_dsBlockChain.GetLastBlockPtr()->GetHeader().GetBlockNum();
+    auto shards = make_shared<DequeOfShard>();
+    {
+      lock_guard<mutex> g(m_mediator.m_ds->m_mutexShards);
+      *shards = m_mediator.m_ds->m_shards;
     }
-
-    if (canPutNewEntry) {
-      BlockStorage::GetBlockStorage().PutDiagnosticData(
-          m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetBlockNum(),
-          m_mediator.m_ds->m_shards, *m_mediator.m_DSCommittee);
+    auto dsCommittee = make_shared<DequeOfNode>();
+    {
+      lock_guard<mutex> g(m_mediator.m_mutexDSCommittee);
+      *dsCommittee = *m_mediator.m_DSCommittee;
     }
+
+    BackgroundWriter::GetInstance().Post(
+        "DiagnosticData", [dsBlockNum, shards, dsCommittee]() {
+          auto& storage = BlockStorage::GetBlockStorage();
+
+          // There's no quick way to get the oldest entry in leveldb
+          // Hence, we manage deleting old entries here instead
+          if ((MAX_ENTRIES_FOR_DIAGNOSTIC_DATA >
+               0) &&  // If limit is 0, skip deletion
+              (storage.GetDiagnosticDataCount() >=
+               MAX_ENTRIES_FOR_DIAGNOSTIC_DATA) &&  // Limit reached
+              (dsBlockNum >=
+               MAX_ENTRIES_FOR_DIAGNOSTIC_DATA)) {  // DS Block number is not
+                                                    // below limit
+            const uint64_t oldBlockNum =
+                dsBlockNum - MAX_ENTRIES_FOR_DIAGNOSTIC_DATA;
+
+            if (!storage.DeleteDiagnosticData(oldBlockNum)) {
+              LOG_GENERAL(WARNING,
+                          "Failed to delete old diagnostic data for DS block "
+                              << oldBlockNum);
+              return false;
+            }
+            LOG_GENERAL(INFO, "Deleted old diagnostic data for DS block "
+                                  << oldBlockNum);
+          }
+
+          return storage.PutDiagnosticData(dsBlockNum, *shards, *dsCommittee);
+        });
   }
 
   return true;
@@ -289,6 +289,7 @@ bool Node::ProcessFallbackBlock(const bytes& message, unsigned int cur_offset,
       UpdateDSCommitteeAfterFallback(shard_id, leaderPubKey, leaderNetworkInfo,
                                      *m_mediator.m_DSCommittee,
                                      m_mediator.m_ds->m_shards);
+      m_mediator.PublishDSCommittee();
     }
     StoreState();
   }
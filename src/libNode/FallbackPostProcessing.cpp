@@ -183,6 +183,7 @@ void Node::ProcessFallbackConsensusWhenDone() {
     for (const auto& node : *m_mediator.m_DSCommittee) {
       LOG_GENERAL(INFO, node.second);
     }
+    m_mediator.PublishDSCommittee();
 
     // Clean processedTxn may have been produced during last microblock
     // consensus
@@ -220,19 +221,23 @@ void Node::ProcessFallbackConsensusWhenDone() {
     DataSender::GetInstance().SendDataToOthers(
         *m_microblock, *m_myShardMembers, m_mediator.m_ds->m_shards, {},
         m_mediator.m_lookup->GetLookupNodes(),
-        m_mediator.m_txBlockChain.GetLastBlock().GetBlockHash(),
+        m_mediator.m_txBlockChain.GetLastBlockPtr()->GetBlockHash(),
         m_consensusMyID, composeFallbackBlockMessageForSender);
   }
 
   if (m_mediator.GetIsVacuousEpoch()) {
     lock_guard<mutex> g(m_mediator.m_mutexCurSWInfo);
     if (m_mediator.m_curSWInfo.GetZilliqaUpgradeDS() - 1 ==
-        m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetBlockNum()) {
+        m_mediator.m_dsBlockChain.GetLastBlockPtr()
+            ->GetHeader()
+            .GetBlockNum()) {
       UpgradeManager::GetInstance().ReplaceNode(m_mediator);
     }
 
     if (m_mediator.m_curSWInfo.GetScillaUpgradeDS() - 1 ==
-        m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetBlockNum()) {
+        m_mediator.m_dsBlockChain.GetLastBlockPtr()
+            ->GetHeader()
+            .GetBlockNum()) {
       UpgradeManager::GetInstance().InstallScilla();
     }
   }
@@ -305,6 +310,17 @@ bool Node::ProcessFallbackConsensus(const bytes& message, unsigned int offset,
     return false;
   }
 
+  // Verify outside m_mutexConsensus, so that the commits and responses of
+  // many backups are checked in parallel
+  shared_ptr<ConsensusCommon> consensusObject;
+  {
+    lock_guard<mutex> g(m_mutexConsensus);
+    consensusObject = m_consensusObject;
+  }
+  if (consensusObject != nullptr) {
+    consensusObject->PreProcessMessage(message, offset);
+  }
+
   lock_guard<mutex> g(m_mutexConsensus);
 
   if (!m_consensusObject->ProcessMessage(message, offset, from)) {
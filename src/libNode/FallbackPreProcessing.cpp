@@ -15,6 +15,8 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
+
 #include "Node.h"
 #include "common/Constants.h"
 #include "common/Messages.h"
@@ -101,10 +103,7 @@ bool Node::FallbackValidator(const bytes& message, unsigned int offset,
 
   // verify the shard committee hash
   CommitteeHash committeeHash;
-  if (!Messenger::GetShardHash(m_mediator.m_ds->m_shards.at(m_myshardId),
-                               committeeHash)) {
-    LOG_EPOCH(WARNING, m_mediator.m_currentEpochNum,
-              "Messenger::GetShardHash failed.");
+  if (!GetFallbackShardHash(m_myshardId, committeeHash)) {
     return false;
   }
   if (committeeHash != m_pendingFallbackBlock->GetHeader().GetCommitteeHash()) {
@@ -289,7 +288,8 @@ void Node::FallbackTimerLaunch() {
   LOG_MARKER();
 
   if (FALLBACK_INTERVAL_STARTED < FALLBACK_CHECK_INTERVAL ||
-      FALLBACK_INTERVAL_WAITING < FALLBACK_CHECK_INTERVAL) {
+      FALLBACK_INTERVAL_WAITING < FALLBACK_CHECK_INTERVAL ||
+      FALLBACK_INTERVAL_WAITING_MIN < FALLBACK_CHECK_INTERVAL) {
     LOG_GENERAL(FATAL,
                 "The configured fallback checking interval must be "
                 "smaller than the timeout value.");
@@ -330,10 +330,16 @@ void Node::FallbackTimerLaunch() {
         }
       } else {
         bool runConsensus = false;
+        const uint32_t intervalWaiting = GetFallbackIntervalWaiting();
 
         if (!LOOKUP_NODE_MODE) {
-          if (m_fallbackTimer >=
-              (FALLBACK_INTERVAL_WAITING * (m_myshardId + 1))) {
+          // Get the shard hash ready while the shard may still recover
+          if (m_fallbackTimer >= intervalWaiting / 2) {
+            CommitteeHash committeeHash;
+            GetFallbackShardHash(m_myshardId, committeeHash);
+          }
+
+          if (m_fallbackTimer >= (intervalWaiting * (m_myshardId + 1))) {
             auto func = [this]() -> void { RunConsensusOnFallback(); };
             DetachedFunction(1, func);
             m_fallbackStarted = true;
@@ -343,7 +349,7 @@ void Node::FallbackTimerLaunch() {
           }
         }
 
-        if (m_fallbackTimer >= FALLBACK_INTERVAL_WAITING &&
+        if (m_fallbackTimer >= intervalWaiting &&
             m_state != WAITING_FALLBACKBLOCK &&
             m_state != FALLBACK_CONSENSUS_PREP &&
             m_state != FALLBACK_CONSENSUS && !runConsensus) {
@@ -366,10 +372,61 @@ void Node::FallbackTimerPulse() {
     return;
   }
   lock_guard<mutex> g(m_mutexFallbackTimer);
+  if (FALLBACK_ADAPTIVE_FACTOR > 0 && FALLBACK_HEALTH_WINDOW > 0 &&
+      !m_fallbackStarted) {
+    m_fallbackPulseGaps.emplace_back(m_fallbackTimer);
+    if (m_fallbackPulseGaps.size() > FALLBACK_HEALTH_WINDOW) {
+      m_fallbackPulseGaps.pop_front();
+    }
+  }
   m_fallbackTimer = 0;
   m_fallbackStarted = false;
 }
 
+uint32_t Node::GetFallbackIntervalWaiting() const {
+  if (FALLBACK_ADAPTIVE_FACTOR == 0 || FALLBACK_HEALTH_WINDOW == 0 ||
+      m_fallbackPulseGaps.size() < FALLBACK_HEALTH_WINDOW) {
+    return FALLBACK_INTERVAL_WAITING;
+  }
+
+  // The longest gap covers the PoW window between DS epochs, which the
+  // adaptive wait must not mistake for a stall
+  const uint64_t longestGap =
+      *max_element(m_fallbackPulseGaps.begin(), m_fallbackPulseGaps.end());
+  const uint64_t interval = max<uint64_t>(
+      longestGap * FALLBACK_ADAPTIVE_FACTOR, FALLBACK_INTERVAL_WAITING_MIN);
+  return min<uint64_t>(interval, FALLBACK_INTERVAL_WAITING);
+}
+
+bool Node::GetFallbackShardHash(uint32_t shardId,
+                                CommitteeHash& committeeHash) {
+  const uint64_t dsBlockNum =
+      m_mediator.m_dsBlockChain.GetLastBlockPtr()->GetHeader().GetBlockNum();
+
+  lock_guard<mutex> g(m_mutexFallbackShardHash);
+  if (!m_fallbackShardHashValid ||
+      m_fallbackShardHashDSBlockNum != dsBlockNum ||
+      m_fallbackShardHashShardId != shardId) {
+    if (shardId >= m_mediator.m_ds->m_shards.size()) {
+      LOG_GENERAL(WARNING, "Shard " << shardId << " does not exist");
+      return false;
+    }
+    if (!Messenger::GetShardHash(m_mediator.m_ds->m_shards.at(shardId),
+                                 m_fallbackShardHash)) {
+      LOG_EPOCH(WARNING, m_mediator.m_currentEpochNum,
+                "Messenger::GetShardHash failed.");
+      m_fallbackShardHashValid = false;
+      return false;
+    }
+    m_fallbackShardHashDSBlockNum = dsBlockNum;
+    m_fallbackShardHashShardId = shardId;
+    m_fallbackShardHashValid = true;
+  }
+
+  committeeHash = m_fallbackShardHash;
+  return true;
+}
+
 void Node::FallbackStop() {
   if (!ENABLE_FALLBACK) {
     return;
@@ -404,10 +461,7 @@ bool Node::ComposeFallbackBlock() {
   LOG_GENERAL(INFO, "LeaderNetworkInfo: " << leaderNetworkInfo);
 
   CommitteeHash committeeHash;
-  if (!Messenger::GetShardHash(m_mediator.m_ds->m_shards.at(m_myshardId),
-                               committeeHash)) {
-    LOG_EPOCH(WARNING, m_mediator.m_currentEpochNum,
-              "Messenger::GetShardHash failed.");
+  if (!GetFallbackShardHash(m_myshardId, committeeHash)) {
     return false;
   }
 
@@ -419,7 +473,9 @@ bool Node::ComposeFallbackBlock() {
   // To-do: Handle exceptions.
   m_pendingFallbackBlock.reset(new FallbackBlock(
       FallbackBlockHeader(
-          m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetBlockNum() +
+          m_mediator.m_dsBlockChain.GetLastBlockPtr()
+              ->GetHeader()
+              .GetBlockNum() +
               1,
           m_mediator.m_currentEpochNum, m_fallbackState,
           {AccountStore::GetInstance().GetStateRootHash()}, m_consensusLeaderID,
@@ -490,7 +546,7 @@ bool Node::RunConsensusOnFallbackWhenLeader() {
 
     // Create new consensus object
     m_consensusBlockHash =
-        m_mediator.m_txBlockChain.GetLastBlock().GetBlockHash().asBytes();
+        m_mediator.m_txBlockChain.GetLastBlockPtr()->GetBlockHash().asBytes();
 
     m_consensusObject.reset(new ConsensusLeader(
         m_mediator.m_consensusID, m_mediator.m_currentEpochNum,
@@ -546,7 +602,7 @@ bool Node::RunConsensusOnFallbackWhenBackup() {
             "I am a fallback backup node. Waiting for Fallback announcement.");
 
   m_consensusBlockHash =
-      m_mediator.m_txBlockChain.GetLastBlock().GetBlockHash().asBytes();
+      m_mediator.m_txBlockChain.GetLastBlockPtr()->GetBlockHash().asBytes();
 
   auto func = [this](const bytes& input, unsigned int offset, bytes& errorMsg,
                      const uint32_t consensusID, const uint64_t blockNumber,
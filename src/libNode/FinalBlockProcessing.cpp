@@ -15,6 +15,7 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include <array>
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wunused-parameter"
@@ -44,16 +45,20 @@
 #include "libNetwork/Blacklist.h"
 #include "libPOW/pow.h"
 #include "libServer/Server.h"
+#include "libServer/WebSocketServer.h"
+#include "libUtils/AsyncExecutor.h"
 #include "libUtils/BitVector.h"
 #include "libUtils/DataConversion.h"
 #include "libUtils/DetachedFunction.h"
 #include "libUtils/HashUtils.h"
 #include "libUtils/Logger.h"
+#include "libUtils/RollingBloomFilter.h"
 #include "libUtils/RootComputation.h"
 #include "libUtils/SanityChecks.h"
 #include "libUtils/TimeLockedFunction.h"
 #include "libUtils/TimeUtils.h"
 #include "libUtils/TimestampVerifier.h"
+#include "libUtils/Tracer.h"
 #include "libUtils/UpgradeManager.h"
 
 using namespace std;
@@ -69,6 +74,11 @@ void Node::StoreFinalBlock(const TxBlock& txBlock) {
 
   AddBlock(txBlock);
 
+  if (LOOKUP_NODE_MODE) {
+    Server::CacheTxBlockResponse(txBlock);
+    WebSocketServer::GetInstance().PublishTxBlock(txBlock);
+  }
+
   m_mediator.IncreaseEpochNum();
 
   // At this point, the transactions in the last Epoch is no longer useful, thus
@@ -83,26 +93,33 @@ void Node::StoreFinalBlock(const TxBlock& txBlock) {
   txBlock.Serialize(serializedTxBlock, 0);
   BlockStorage::GetBlockStorage().PutTxBlock(txBlock.GetHeader().GetBlockNum(),
                                              serializedTxBlock);
+  BlockStorage::GetBlockStorage().PutBlockHash(
+      BlockType::Tx, txBlock.GetHeader().GetBlockNum(), txBlock.GetBlockHash());
 
   string prevHashStr;
-  if (!DataConversion::charArrToHexStr(m_mediator.m_txBlockChain.GetLastBlock()
-                                           .GetHeader()
-                                           .GetPrevHash()
-                                           .asArray(),
-                                       prevHashStr)) {
+  if (!DataConversion::charArrToHexStr(
+          m_mediator.m_txBlockChain.GetLastBlockPtr()
+              ->GetHeader()
+              .GetPrevHash()
+              .asArray(),
+          prevHashStr)) {
     LOG_GENERAL(WARNING, "prev hash cannot be converted to hex str");
   }
   LOG_EPOCH(
       INFO, m_mediator.m_currentEpochNum,
       "Final block "
-          << m_mediator.m_txBlockChain.GetLastBlock().GetHeader().GetBlockNum()
+          << m_mediator.m_txBlockChain.GetLastBlockPtr()
+              ->GetHeader()
+              .GetBlockNum()
           << " received with prevhash 0x" << prevHashStr);
 
   LOG_STATE(
       "[FINBK]["
       << std::setw(15) << std::left
       << m_mediator.m_selfPeer.GetPrintableIPAddress() << "]["
-      << m_mediator.m_txBlockChain.GetLastBlock().GetHeader().GetBlockNum() + 1
+      << m_mediator.m_txBlockChain.GetLastBlockPtr()
+          ->GetHeader()
+          .GetBlockNum() + 1
       << "] RECV");
 }
 
@@ -208,7 +225,9 @@ bool Node::RemoveTxRootHashFromUnavailableMicroBlock(
            .end();
        it++) {
     if (it->first == entry.m_microBlock.GetBlockHash()) {
-      TxnHash txnHash = ComputeRoot(entry.m_transactions);
+      TxnHash txnHash = ComputeMicroBlockTxRoot(
+          entry.m_microBlock.GetBlockHash(),
+          entry.m_microBlock.GetHeader().GetVersion(), entry.m_transactions);
       if (it->second != txnHash) {
         LOG_GENERAL(
             WARNING,
@@ -240,9 +259,6 @@ bool Node::RemoveTxRootHashFromUnavailableMicroBlock(
 bool Node::VerifyFinalBlockCoSignature(const TxBlock& txblock) {
   LOG_MARKER();
 
-  unsigned int index = 0;
-  unsigned int count = 0;
-
   const vector<bool>& B2 = txblock.GetB2();
   if (m_mediator.m_DSCommittee->size() != B2.size()) {
     LOG_GENERAL(WARNING, "Mismatch: DS committee size = "
@@ -251,22 +267,18 @@ bool Node::VerifyFinalBlockCoSignature(const TxBlock& txblock) {
     return false;
   }
 
-  // Generate the aggregated key
-  vector<PubKey> keys;
-  for (auto const& kv : *m_mediator.m_DSCommittee) {
-    if (B2.at(index)) {
-      keys.emplace_back(kv.first);
-      count++;
-    }
-    index++;
-  }
-
-  if (count != ConsensusCommon::NumForConsensus(B2.size())) {
+  if (static_cast<unsigned int>(std::count(B2.begin(), B2.end(), true)) !=
+      ConsensusCommon::NumForConsensus(B2.size())) {
     LOG_GENERAL(WARNING, "Cosig was not generated by enough nodes");
     return false;
   }
 
-  shared_ptr<PubKey> aggregatedKey = MultiSig::AggregatePubKeys(keys);
+  // Generate the aggregated key
+  shared_ptr<PubKey> aggregatedKey =
+      m_mediator.m_DSCommitteeKeyCache.Aggregate(
+          *m_mediator.m_DSCommittee,
+          [](const PairOfNode& node) -> const PubKey& { return node.first; },
+          B2);
   if (aggregatedKey == nullptr) {
     LOG_GENERAL(WARNING, "Aggregated key generation failed");
     return false;
@@ -283,8 +295,11 @@ bool Node::VerifyFinalBlockCoSignature(const TxBlock& txblock) {
   if (!MultiSig::GetInstance().MultiSigVerify(
           message, 0, message.size(), txblock.GetCS2(), *aggregatedKey)) {
     LOG_GENERAL(WARNING, "Cosig verification failed");
-    for (auto& kv : keys) {
-      LOG_GENERAL(WARNING, kv);
+    unsigned int index = 0;
+    for (const auto& kv : *m_mediator.m_DSCommittee) {
+      if (B2.at(index++)) {
+        LOG_GENERAL(WARNING, kv.first);
+      }
     }
     return false;
   }
@@ -302,18 +317,26 @@ void Node::InitiatePoW() {
 
   SetState(POW_SUBMISSION);
   POW::GetInstance().EthashConfigureClient(
-      m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetBlockNum() + 1,
+      m_mediator.m_dsBlockChain.GetLastBlockPtr()
+          ->GetHeader()
+          .GetBlockNum() + 1,
       FULL_DATASET_MINE);
   LOG_EPOCH(INFO, m_mediator.m_currentEpochNum, "Start pow ");
   auto func = [this]() mutable -> void {
     auto epochNumber =
-        m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetBlockNum() + 1;
+        m_mediator.m_dsBlockChain.GetLastBlockPtr()
+            ->GetHeader()
+            .GetBlockNum() + 1;
     auto dsBlockRand = m_mediator.m_dsBlockRand;
     auto txBlockRand = m_mediator.m_txBlockRand;
     StartPoW(
         epochNumber,
-        m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetDSDifficulty(),
-        m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetDifficulty(),
+        m_mediator.m_dsBlockChain.GetLastBlockPtr()
+            ->GetHeader()
+            .GetDSDifficulty(),
+        m_mediator.m_dsBlockChain.GetLastBlockPtr()
+            ->GetHeader()
+            .GetDifficulty(),
         dsBlockRand, txBlockRand);
   };
 
@@ -338,7 +361,7 @@ void Node::UpdateStateForNextConsensusRound() {
   m_mediator.m_consensusID++;
 
   uint16_t lastBlockHash = DataConversion::charArrTo16Bits(
-      m_mediator.m_txBlockChain.GetLastBlock().GetBlockHash().asBytes());
+      m_mediator.m_txBlockChain.GetLastBlockPtr()->GetBlockHash().asBytes());
   {
     lock_guard<mutex> g(m_mutexShardMember);
     m_consensusLeaderID = lastBlockHash % m_myShardMembers->size();
@@ -430,9 +453,14 @@ void Node::CallActOnFinalblock() {
     return;
   }
 
+  SendMBnForwardTxnToLookups(false);
+}
+
+void Node::SendMBnForwardTxnToLookups(bool beforeFinalBlock) {
   auto composeMBnForwardTxnMessageForSender =
-      [this](bytes& forwardtxn_message) -> bool {
-    return ComposeMBnForwardTxnMessageForSender(forwardtxn_message);
+      [this, beforeFinalBlock](bytes& forwardtxn_message) -> bool {
+    return ComposeMBnForwardTxnMessageForSender(forwardtxn_message,
+                                                beforeFinalBlock);
   };
 
   auto sendMbnFowardTxnToShardNodes =
@@ -445,12 +473,14 @@ void Node::CallActOnFinalblock() {
   DataSender::GetInstance().SendDataToOthers(
       *m_microblock, *m_myShardMembers, {}, {},
       m_mediator.m_lookup->GetLookupNodes(),
-      m_mediator.m_txBlockChain.GetLastBlock().GetBlockHash(), m_consensusMyID,
+      m_mediator.m_txBlockChain.GetLastBlockPtr()
+          ->GetBlockHash(), m_consensusMyID,
       composeMBnForwardTxnMessageForSender, SendDataToLookupFuncDefault,
       sendMbnFowardTxnToShardNodes);
 }
 
-bool Node::ComposeMBnForwardTxnMessageForSender(bytes& mb_txns_message) {
+bool Node::ComposeMBnForwardTxnMessageForSender(bytes& mb_txns_message,
+                                                bool beforeFinalBlock) {
   if (LOOKUP_NODE_MODE) {
     LOG_GENERAL(WARNING,
                 "Node::ComposeMBnForwardTxnMessageForSender not expected to be "
@@ -465,12 +495,14 @@ bool Node::ComposeMBnForwardTxnMessageForSender(bytes& mb_txns_message) {
   }
 
   const auto& blocknum =
-      m_mediator.m_txBlockChain.GetLastBlock().GetHeader().GetBlockNum();
+      m_mediator.m_txBlockChain.GetLastBlockPtr()->GetHeader().GetBlockNum();
 
   {
     const vector<TxnHash>& tx_hashes = m_microblock->GetTranHashes();
     lock_guard<mutex> g(m_mutexProcessedTransactions);
-    auto& processedTransactions = m_processedTransactions[blocknum];
+    const auto& processedTransactions = beforeFinalBlock
+                                            ? t_processedTransactions
+                                            : m_processedTransactions[blocknum];
     for (const auto& tx_hash : tx_hashes) {
       const auto& txnIt = processedTransactions.find(tx_hash);
       if (txnIt != processedTransactions.end()) {
@@ -483,22 +515,46 @@ bool Node::ComposeMBnForwardTxnMessageForSender(bytes& mb_txns_message) {
     }
   }
 
-  // Transaction body sharing
-  mb_txns_message = {MessageType::NODE,
-                     NodeInstructionType::MBNFORWARDTRANSACTION};
+  if (MBNFORWARD_TXN_HASHES_ONLY &&
+      txns_to_send.size() == m_microblock->GetTranHashes().size()) {
+    // The lookups hold the bodies they sent us, so the receipts will do
+    vector<TransactionReceipt> receipts;
+    receipts.reserve(txns_to_send.size());
+    for (const auto& txn : txns_to_send) {
+      receipts.emplace_back(txn.GetTransactionReceipt());
+    }
+
+    mb_txns_message = {MessageType::NODE,
+                       NodeInstructionType::MBNFORWARDTXNHASHES};
 
-  if (!Messenger::SetNodeMBnForwardTransaction(
-          mb_txns_message, MessageOffset::BODY, *m_microblock, txns_to_send)) {
-    LOG_EPOCH(WARNING, m_mediator.m_currentEpochNum,
-              "Messenger::SetNodeMBnForwardTransaction failed.");
-    return false;
+    if (!Messenger::SetNodeMBnForwardTxnHashes(
+            mb_txns_message, MessageOffset::BODY, *m_microblock, receipts,
+            m_mediator.m_selfPeer.m_listenPortHost)) {
+      LOG_EPOCH(WARNING, m_mediator.m_currentEpochNum,
+                "Messenger::SetNodeMBnForwardTxnHashes failed.");
+      return false;
+    }
+  } else {
+    // Transaction body sharing
+    mb_txns_message = {MessageType::NODE,
+                       NodeInstructionType::MBNFORWARDTRANSACTION};
+
+    if (!Messenger::SetNodeMBnForwardTransaction(
+            mb_txns_message, MessageOffset::BODY, *m_microblock,
+            txns_to_send)) {
+      LOG_EPOCH(WARNING, m_mediator.m_currentEpochNum,
+                "Messenger::SetNodeMBnForwardTransaction failed.");
+      return false;
+    }
   }
 
   LOG_STATE(
       "[TXBOD]["
       << setw(15) << left << m_mediator.m_selfPeer.GetPrintableIPAddress()
       << "]["
-      << m_mediator.m_txBlockChain.GetLastBlock().GetHeader().GetBlockNum() + 1
+      << m_mediator.m_txBlockChain.GetLastBlockPtr()
+          ->GetHeader()
+          .GetBlockNum() + 1
       << "] BEFORE SENDING MB & FORWARDING TXN BODIES #" << blocknum);
 
   LOG_GENERAL(INFO, "[SendMBnTxn]"
@@ -542,6 +598,7 @@ void Node::PrepareGoodStateForFinalBlock() {
 bool Node::ProcessFinalBlock(const bytes& message, unsigned int offset,
                              [[gnu::unused]] const Peer& from) {
   LOG_MARKER();
+  TRACE_SPAN("Node::ProcessFinalBlock");
 
   uint64_t dsBlockNumber = 0;
   uint32_t consensusID = 0;
@@ -554,6 +611,8 @@ bool Node::ProcessFinalBlock(const bytes& message, unsigned int offset,
               "Messenger::GetNodeFinalBlock failed.");
     return false;
   }
+  EpochTimeline::GetInstance().RecordMark(TIMELINE_MARK_FINALBLOCK_RECEIVED,
+                                          m_mediator.GetTimelineRole());
 
   lock_guard<mutex> g(m_mutexFinalBlock);
 
@@ -631,6 +690,9 @@ bool Node::ProcessFinalBlock(const bytes& message, unsigned int offset,
     return false;
   }
 
+  // Lookups start sending the txns of the next epoch once they have this block
+  m_txDistributeStartTime = r_timer_start();
+
   // Compute the MBInfoHash of the extra MicroBlock information
   MBInfoHash mbInfoHash;
   if (!Messenger::GetMbInfoHash(txBlock.GetMicroBlockInfos(), mbInfoHash)) {
@@ -736,12 +798,14 @@ bool Node::ProcessFinalBlock(const bytes& message, unsigned int offset,
     BlockStorage::GetBlockStorage().PutMetadata(MetaType::DSINCOMPLETED, {'0'});
   }
 
-  auto resumeBlackList = []() mutable -> void {
-    this_thread::sleep_for(chrono::seconds(RESUME_BLACKLIST_DELAY_IN_SECONDS));
-    Blacklist::GetInstance().Enable(true);
-  };
+  if (LOOKUP_NODE_MODE && !AccountStore::GetInstance().RetainStateRoot(
+                              txBlock.GetHeader().GetBlockNum())) {
+    LOG_GENERAL(WARNING, "RetainStateRoot failed");
+  }
 
-  DetachedFunction(1, resumeBlackList);
+  AsyncExecutor::GetInstance().PostAfter(
+      chrono::seconds(RESUME_BLACKLIST_DELAY_IN_SECONDS),
+      []() { Blacklist::GetInstance().Enable(true); });
 
   // m_mediator.HeartBeatPulse();
 
@@ -761,12 +825,16 @@ bool Node::ProcessFinalBlock(const bytes& message, unsigned int offset,
   if (isVacuousEpoch) {
     lock_guard<mutex> g(m_mediator.m_mutexCurSWInfo);
     if (m_mediator.m_curSWInfo.GetZilliqaUpgradeDS() - 1 ==
-        m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetBlockNum()) {
+        m_mediator.m_dsBlockChain.GetLastBlockPtr()
+            ->GetHeader()
+            .GetBlockNum()) {
       UpgradeManager::GetInstance().ReplaceNode(m_mediator);
     }
 
     if (m_mediator.m_curSWInfo.GetScillaUpgradeDS() - 1 ==
-        m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetBlockNum()) {
+        m_mediator.m_dsBlockChain.GetLastBlockPtr()
+            ->GetHeader()
+            .GetBlockNum()) {
       UpgradeManager::GetInstance().InstallScilla();
     }
   }
@@ -858,16 +926,24 @@ bool Node::ProcessStateDeltaFromFinalBlock(
 void Node::CommitForwardedTransactions(const MBnForwardedTxnEntry& entry) {
   LOG_MARKER();
 
-  for (const auto& twr : entry.m_transactions) {
-    if (LOOKUP_NODE_MODE) {
+  if (LOOKUP_NODE_MODE) {
+    auto& committedTxns = RollingBloomFilter::GetCommittedTxnFilter();
+    committedTxns.NewEpoch(entry.m_microBlock.GetHeader().GetEpochNum());
+    for (const auto& twr : entry.m_transactions) {
       Server::AddToRecentTransactions(twr.GetTransaction().GetTranID());
+      committedTxns.Insert(twr.GetTransaction().GetTranID());
     }
+    WebSocketServer::GetInstance().PublishTxns(
+        entry.m_microBlock.GetHeader().GetEpochNum(), entry.m_transactions);
+  }
 
-    // Store TxBody to disk
-    bytes serializedTxBody;
-    twr.Serialize(serializedTxBody, 0);
-    BlockStorage::GetBlockStorage().PutTxBody(twr.GetTransaction().GetTranID(),
-                                              serializedTxBody);
+  // Store TxBodies to disk, off this thread
+  if (!BlockStorage::GetBlockStorage().QueueTxBodies(entry.m_transactions)) {
+    LOG_GENERAL(WARNING, "Failed to store txn bodies of " << entry);
+  }
+  if (!BlockStorage::GetBlockStorage().PutTxnAddressIndex(
+          entry.m_microBlock.GetHeader().GetEpochNum(), entry.m_transactions)) {
+    LOG_GENERAL(WARNING, "Failed to index txns by address of " << entry);
   }
   LOG_EPOCH(INFO, m_mediator.m_currentEpochNum,
             "Proceessed " << entry.m_transactions.size() << " of txns.");
@@ -919,7 +995,7 @@ void Node::DeleteEntryFromFwdingAssgnAndMissingBodyCountMap(
 
 bool Node::ProcessMBnForwardTransaction(const bytes& message,
                                         unsigned int cur_offset,
-                                        [[gnu::unused]] const Peer& from) {
+                                        const Peer& from) {
   if (!LOOKUP_NODE_MODE) {
     LOG_GENERAL(WARNING,
                 "Node::ProcessMBnForwardTransaction not expected to be "
@@ -937,6 +1013,11 @@ bool Node::ProcessMBnForwardTransaction(const bytes& message,
     return false;
   }
 
+  return ProcessMBnForwardedTxnEntry(entry, from);
+}
+
+bool Node::ProcessMBnForwardedTxnEntry(const MBnForwardedTxnEntry& entry,
+                                       const Peer& from) {
   // Verify Microblock agains forwarded txns
   // BlockHash
   BlockHash temp_blockHash = entry.m_microBlock.GetHeader().GetMyHash();
@@ -950,7 +1031,9 @@ bool Node::ProcessMBnForwardTransaction(const bytes& message,
   }
 
   // Verify txnhash
-  TxnHash txnHash = ComputeRoot(entry.m_transactions);
+  TxnHash txnHash = ComputeMicroBlockTxRoot(
+      entry.m_microBlock.GetBlockHash(),
+      entry.m_microBlock.GetHeader().GetVersion(), entry.m_transactions);
   if (txnHash != entry.m_microBlock.GetHeader().GetTxRootHash()) {
     LOG_GENERAL(WARNING, "Transaction root hash doesn't match, computed: "
                              << txnHash << " received: "
@@ -980,16 +1063,27 @@ bool Node::ProcessMBnForwardTransaction(const bytes& message,
       "[TXBOD]["
       << setw(15) << left << m_mediator.m_selfPeer.GetPrintableIPAddress()
       << "]["
-      << m_mediator.m_txBlockChain.GetLastBlock().GetHeader().GetBlockNum() + 1
+      << m_mediator.m_txBlockChain.GetLastBlockPtr()
+          ->GetHeader()
+          .GetBlockNum() + 1
       << "] RECVD MB & TXN BODIES #"
       << entry.m_microBlock.GetHeader().GetEpochNum() << " shard "
       << entry.m_microBlock.GetHeader().GetShardId());
 
-  if (m_mediator.m_txBlockChain.GetLastBlock().GetHeader().GetBlockNum() <
+  if (m_mediator.m_txBlockChain.GetLastBlockPtr()->GetHeader().GetBlockNum() <
       entry.m_microBlock.GetHeader().GetEpochNum()) {
     lock_guard<mutex> g(m_mutexMBnForwardedTxnBuffer);
-    m_mbnForwardedTxnBuffer[entry.m_microBlock.GetHeader().GetEpochNum()]
-        .push_back(entry);
+    auto& buffered =
+        m_mbnForwardedTxnBuffer[entry.m_microBlock.GetHeader().GetEpochNum()];
+    // Shards forwarding on microblock consensus send it again after the
+    // final block
+    for (const auto& bufferedEntry : buffered) {
+      if (bufferedEntry.m_microBlock.GetBlockHash() ==
+          entry.m_microBlock.GetBlockHash()) {
+        return true;
+      }
+    }
+    buffered.push_back(entry);
 
     return true;
   }
@@ -997,6 +1091,218 @@ bool Node::ProcessMBnForwardTransaction(const bytes& message,
   return ProcessMBnForwardTransactionCore(entry);
 }
 
+void Node::RebuildMBnForwardedTxnEntry(
+    const MicroBlock& microBlock, const vector<TransactionReceipt>& receipts,
+    MBnForwardedTxnEntry& entry, vector<TxnHash>& missingTxnHashes) {
+  entry.m_microBlock = microBlock;
+  entry.m_transactions.clear();
+  missingTxnHashes.clear();
+
+  const auto& tranHashes = microBlock.GetTranHashes();
+  for (unsigned int i = 0; i < tranHashes.size(); i++) {
+    Transaction txn;
+    if (m_mediator.m_lookup->FindForwardedTxn(tranHashes.at(i), txn)) {
+      entry.m_transactions.emplace_back(txn, receipts.at(i));
+    } else {
+      missingTxnHashes.emplace_back(tranHashes.at(i));
+    }
+  }
+}
+
+bool Node::ProcessMBnForwardTxnHashes(const bytes& message,
+                                      unsigned int cur_offset,
+                                      const Peer& from) {
+  if (!LOOKUP_NODE_MODE) {
+    LOG_GENERAL(WARNING,
+                "Node::ProcessMBnForwardTxnHashes not expected to be "
+                "called from Normal node.");
+    return true;
+  }
+
+  LOG_MARKER();
+
+  MicroBlock microBlock;
+  vector<TransactionReceipt> receipts;
+  uint32_t listenPort = 0;
+
+  if (!Messenger::GetNodeMBnForwardTxnHashes(message, cur_offset, microBlock,
+                                             receipts, listenPort)) {
+    LOG_EPOCH(WARNING, m_mediator.m_currentEpochNum,
+              "Messenger::GetNodeMBnForwardTxnHashes failed.");
+    return false;
+  }
+
+  if (receipts.size() != microBlock.GetTranHashes().size()) {
+    LOG_GENERAL(WARNING, "Got " << receipts.size() << " receipts for "
+                                << microBlock.GetTranHashes().size()
+                                << " txns from " << from);
+    return false;
+  }
+
+  MBnForwardedTxnEntry entry;
+  vector<TxnHash> missingTxnHashes;
+  RebuildMBnForwardedTxnEntry(microBlock, receipts, entry, missingTxnHashes);
+
+  if (missingTxnHashes.empty()) {
+    return ProcessMBnForwardedTxnEntry(entry, from);
+  }
+
+  const uint64_t epochNum = microBlock.GetHeader().GetEpochNum();
+  {
+    lock_guard<mutex> g(m_mutexPendingMBnForwardTxnHashes);
+
+    // Another sender of this microblock has been asked already
+    if (!m_pendingMBnForwardTxnHashes
+             .emplace(microBlock.GetBlockHash(),
+                      make_pair(microBlock, receipts))
+             .second) {
+      return true;
+    }
+
+    for (auto it = m_pendingMBnForwardTxnHashes.begin();
+         it != m_pendingMBnForwardTxnHashes.end();) {
+      if (it->second.first.GetHeader().GetEpochNum() + 1 < epochNum) {
+        it = m_pendingMBnForwardTxnHashes.erase(it);
+      } else {
+        it++;
+      }
+    }
+  }
+
+  LOG_GENERAL(INFO, "Missing " << missingTxnHashes.size() << " of "
+                               << receipts.size() << " txn bodies of "
+                               << microBlock.GetBlockHash() << ", asking "
+                               << from);
+
+  bytes request = {MessageType::NODE,
+                   NodeInstructionType::GETMBNFORWARDTXNBODIES};
+  if (!Messenger::SetNodeMissingTxnsErrorMsg(
+          request, MessageOffset::BODY, missingTxnHashes, epochNum,
+          m_mediator.m_selfPeer.m_listenPortHost)) {
+    LOG_GENERAL(WARNING, "Messenger::SetNodeMissingTxnsErrorMsg failed.");
+    return false;
+  }
+
+  P2PComm::GetInstance().SendMessage(Peer(from.m_ipAddress, listenPort),
+                                     request);
+
+  return true;
+}
+
+bool Node::ProcessGetMBnForwardTxnBodies(const bytes& message,
+                                         unsigned int cur_offset,
+                                         const Peer& from) {
+  if (LOOKUP_NODE_MODE) {
+    LOG_GENERAL(WARNING,
+                "Node::ProcessGetMBnForwardTxnBodies not expected to be "
+                "called from LookUp node.");
+    return true;
+  }
+
+  LOG_MARKER();
+
+  if (!m_mediator.m_lookup->IsLookupNode(from)) {
+    LOG_GENERAL(WARNING, "Txn bodies requested by " << from
+                                                    << " who is not a lookup");
+    return false;
+  }
+
+  vector<TxnHash> txnHashes;
+  uint64_t epochNum = 0;
+  uint32_t listenPort = 0;
+
+  if (!Messenger::GetNodeMissingTxnsErrorMsg(message, cur_offset, txnHashes,
+                                             epochNum, listenPort)) {
+    LOG_GENERAL(WARNING, "Messenger::GetNodeMissingTxnsErrorMsg failed.");
+    return false;
+  }
+
+  vector<Transaction> txns;
+  {
+    lock_guard<mutex> g(m_mutexProcessedTransactions);
+
+    const auto processedIt = m_processedTransactions.find(epochNum);
+    if (processedIt == m_processedTransactions.end()) {
+      LOG_GENERAL(WARNING, "No processed txns for epoch " << epochNum);
+      return false;
+    }
+
+    for (const auto& txnHash : txnHashes) {
+      const auto txnIt = processedIt->second.find(txnHash);
+      if (txnIt != processedIt->second.end()) {
+        txns.emplace_back(txnIt->second.GetTransaction());
+      }
+    }
+  }
+
+  bytes reply = {MessageType::NODE, NodeInstructionType::MBNFORWARDTXNBODIES};
+  if (!Messenger::SetTransactionArray(reply, MessageOffset::BODY, txns)) {
+    LOG_GENERAL(WARNING, "Messenger::SetTransactionArray failed.");
+    return false;
+  }
+
+  LOG_GENERAL(INFO, "Sending " << txns.size() << " of " << txnHashes.size()
+                               << " requested txn bodies to " << from);
+
+  P2PComm::GetInstance().SendMessage(Peer(from.m_ipAddress, listenPort),
+                                     reply);
+
+  return true;
+}
+
+bool Node::ProcessMBnForwardTxnBodies(const bytes& message,
+                                      unsigned int cur_offset,
+                                      const Peer& from) {
+  if (!LOOKUP_NODE_MODE) {
+    LOG_GENERAL(WARNING,
+                "Node::ProcessMBnForwardTxnBodies not expected to be "
+                "called from Normal node.");
+    return true;
+  }
+
+  LOG_MARKER();
+
+  vector<Transaction> txns;
+  if (!Messenger::GetTransactionArray(message, cur_offset, txns)) {
+    LOG_GENERAL(WARNING, "Messenger::GetTransactionArray failed.");
+    return false;
+  }
+
+  // Bodies that failed verification come back with an empty ID
+  txns.erase(remove_if(txns.begin(), txns.end(),
+                       [](const Transaction& txn) {
+                         return txn.GetTranID() == TxnHash();
+                       }),
+             txns.end());
+  m_mediator.m_lookup->AddForwardedTxns(txns);
+
+  vector<MBnForwardedTxnEntry> entries;
+  {
+    lock_guard<mutex> g(m_mutexPendingMBnForwardTxnHashes);
+
+    for (auto it = m_pendingMBnForwardTxnHashes.begin();
+         it != m_pendingMBnForwardTxnHashes.end();) {
+      MBnForwardedTxnEntry entry;
+      vector<TxnHash> missingTxnHashes;
+      RebuildMBnForwardedTxnEntry(it->second.first, it->second.second, entry,
+                                  missingTxnHashes);
+      if (missingTxnHashes.empty()) {
+        entries.emplace_back(entry);
+        it = m_pendingMBnForwardTxnHashes.erase(it);
+      } else {
+        it++;
+      }
+    }
+  }
+
+  bool result = true;
+  for (const auto& entry : entries) {
+    result = ProcessMBnForwardedTxnEntry(entry, from) && result;
+  }
+
+  return result;
+}
+
 bool Node::ProcessMBnForwardTransactionCore(const MBnForwardedTxnEntry& entry) {
   if (!LOOKUP_NODE_MODE) {
     LOG_GENERAL(WARNING,
@@ -1015,6 +1321,14 @@ bool Node::ProcessMBnForwardTransactionCore(const MBnForwardedTxnEntry& entry) {
 
     if (!IsMicroBlockTxRootHashInFinalBlock(entry,
                                             isEveryMicroBlockAvailable)) {
+      MicroBlockSharedPtr stored;
+      if (MBNFORWARD_ON_MICROBLOCK_CONSENSUS &&
+          BlockStorage::GetBlockStorage().GetMicroBlock(
+              entry.m_microBlock.GetBlockHash(), stored)) {
+        LOG_GENERAL(INFO, "Already have microblock "
+                              << entry.m_microBlock.GetBlockHash());
+        return true;
+      }
       LOG_GENERAL(WARNING, "The forwarded data is not in finalblock, why?");
       return false;
     }
@@ -1032,9 +1346,14 @@ bool Node::ProcessMBnForwardTransactionCore(const MBnForwardedTxnEntry& entry) {
 
       if (LOOKUP_NODE_MODE && m_isVacuousEpochBuffer &&
           entry.m_microBlock.GetHeader().GetEpochNum() ==
-              m_mediator.m_txBlockChain.GetLastBlock()
-                  .GetHeader()
+              m_mediator.m_txBlockChain.GetLastBlockPtr()
+                  ->GetHeader()
                   .GetBlockNum()) {
+        // Every body of the DS epoch must be on disk before it is marked
+        // complete
+        if (!BlockStorage::GetBlockStorage().FlushTxBodies()) {
+          LOG_GENERAL(WARNING, "Failed to write buffered txn bodies");
+        }
         BlockStorage::GetBlockStorage().PutMetadata(MetaType::DSINCOMPLETED,
                                                     {'0'});
         BlockStorage::GetBlockStorage().ResetDB(BlockStorage::TX_BODY_TMP);
@@ -1060,7 +1379,9 @@ void Node::CommitMBnForwardedTransactionBuffer() {
   for (auto it = m_mbnForwardedTxnBuffer.begin();
        it != m_mbnForwardedTxnBuffer.end();) {
     if (it->first <=
-        m_mediator.m_txBlockChain.GetLastBlock().GetHeader().GetBlockNum()) {
+        m_mediator.m_txBlockChain.GetLastBlockPtr()
+            ->GetHeader()
+            .GetBlockNum()) {
       for (const auto& entry : it->second) {
         ProcessMBnForwardTransactionCore(entry);
       }
@@ -224,6 +224,17 @@ bool Node::ProcessMicroBlockConsensusCore(const bytes& message,
     return false;
   }
 
+  // Verify outside m_mutexConsensus, so that the commits and responses of
+  // many backups are checked in parallel
+  shared_ptr<ConsensusCommon> consensusObject;
+  {
+    lock_guard<mutex> g(m_mutexConsensus);
+    consensusObject = m_consensusObject;
+  }
+  if (consensusObject != nullptr) {
+    consensusObject->PreProcessMessage(message, offset);
+  }
+
   lock_guard<mutex> g(m_mutexConsensus);
 
   if (!m_consensusObject->ProcessMessage(message, offset, from)) {
@@ -260,7 +271,9 @@ bool Node::ProcessMicroBlockConsensusCore(const bytes& message,
     };
 
     unordered_map<uint32_t, BlockBase> t_blocks;
-    if (m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetEpochNum() ==
+    if (m_mediator.m_dsBlockChain.GetLastBlockPtr()
+        ->GetHeader()
+        .GetEpochNum() ==
         m_mediator.m_currentEpochNum) {
       t_blocks.emplace(0, m_mediator.m_dsBlockChain.GetLastBlock());
     } else {
@@ -272,15 +285,26 @@ bool Node::ProcessMicroBlockConsensusCore(const bytes& message,
       DataSender::GetInstance().SendDataToOthers(
           *m_microblock, *m_myShardMembers, ds_shards, t_blocks,
           m_mediator.m_lookup->GetLookupNodes(),
-          m_mediator.m_txBlockChain.GetLastBlock().GetBlockHash(),
+          m_mediator.m_txBlockChain.GetLastBlockPtr()->GetBlockHash(),
           m_consensusMyID, composeMicroBlockMessageForSender, nullptr);
     }
+    EpochTimeline::GetInstance().RecordMark(TIMELINE_MARK_MICROBLOCK_SUBMITTED,
+                                            TIMELINE_ROLE_SHARD);
+
+    // Lookups buffer it until the final block arrives, so they have the
+    // bodies by the time it does
+    if (MBNFORWARD_ON_MICROBLOCK_CONSENSUS &&
+        m_microblock->GetHeader().GetTxRootHash() != TxnHash()) {
+      SendMBnForwardTxnToLookups(true);
+    }
 
     LOG_STATE(
         "[MIBLK]["
         << setw(15) << left << m_mediator.m_selfPeer.GetPrintableIPAddress()
         << "]["
-        << m_mediator.m_txBlockChain.GetLastBlock().GetHeader().GetBlockNum() +
+        << m_mediator.m_txBlockChain.GetLastBlockPtr()
+            ->GetHeader()
+            .GetBlockNum() +
                1
         << "] AFTER SENDING MIBLK");
 
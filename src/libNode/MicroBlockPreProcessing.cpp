@@ -19,6 +19,7 @@
 #include <chrono>
 #include <functional>
 #include <thread>
+#include <unordered_set>
 
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wunused-parameter"
@@ -36,6 +37,7 @@
 #include "libCrypto/Sha2.h"
 #include "libData/AccountData/Account.h"
 #include "libData/AccountData/AccountStore.h"
+#include "libData/AccountData/PendingTxnQueue.h"
 #include "libData/AccountData/Transaction.h"
 #include "libData/AccountData/TransactionReceipt.h"
 #include "libData/AccountData/TxnOrderVerifier.h"
@@ -69,7 +71,7 @@ bool Node::ComposeMicroBlock() {
   // TxBlockHeader
   uint32_t version = MICROBLOCK_VERSION;
   uint32_t shardId = m_myshardId;
-  uint64_t gasLimit = MICROBLOCK_GAS_LIMIT;
+  uint64_t gasLimit = m_microBlockGasLimit;
   uint64_t gasUsed = m_gasUsedTotal;
   uint128_t rewards = 0;
   if (m_mediator.GetIsVacuousEpoch() &&
@@ -82,7 +84,7 @@ bool Node::ComposeMicroBlock() {
     rewards = m_txnFees;
   }
   BlockHash prevHash =
-      m_mediator.m_txBlockChain.GetLastBlock().GetHeader().GetMyHash();
+      m_mediator.m_txBlockChain.GetLastBlockPtr()->GetHeader().GetMyHash();
 
   TxnHash txRootHash, txReceiptHash;
   uint32_t numTxs = 0;
@@ -113,7 +115,7 @@ bool Node::ComposeMicroBlock() {
   {
     lock_guard<mutex> g(m_mutexProcessedTransactions);
 
-    txRootHash = ComputeRoot(m_TxnOrder);
+    txRootHash = ComputeMicroBlockTxRoot(version, m_TxnOrder);
 
     numTxs = t_processedTransactions.size();
     if (numTxs != m_TxnOrder.size()) {
@@ -144,7 +146,9 @@ bool Node::ComposeMicroBlock() {
       MicroBlockHeader(
           shardId, gasLimit, gasUsed, rewards, m_mediator.m_currentEpochNum,
           {txRootHash, stateDeltaHash, txReceiptHash}, numTxs, minerPubKey,
-          m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetBlockNum(),
+          m_mediator.m_dsBlockChain.GetLastBlockPtr()
+              ->GetHeader()
+              .GetBlockNum(),
           version, committeeHash, prevHash),
       tranHashes, CoSignatures()));
 
@@ -181,16 +185,6 @@ bool Node::OnNodeMissingTxns(const bytes& errorMsg, const unsigned int offset,
 
   lock_guard<mutex> g(m_mutexProcessedTransactions);
 
-  unsigned int cur_offset = 0;
-  bytes tx_message = {MessageType::NODE,
-                      NodeInstructionType::SUBMITTRANSACTION};
-  cur_offset += MessageOffset::BODY;
-  tx_message.push_back(SUBMITTRANSACTIONTYPE::MISSINGTXN);
-  cur_offset += MessageOffset::INST;
-  Serializable::SetNumber<uint64_t>(tx_message, cur_offset, epochNum,
-                                    sizeof(uint64_t));
-  cur_offset += sizeof(uint64_t);
-
   std::vector<Transaction> txns;
 
   const std::unordered_map<TxnHash, TransactionWithReceipt>&
@@ -211,6 +205,21 @@ bool Node::OnNodeMissingTxns(const bytes& errorMsg, const unsigned int offset,
     }
   }
 
+  return SendMissingTxns(peer, epochNum, txns);
+}
+
+bool Node::SendMissingTxns(const Peer& peer, const uint64_t epochNum,
+                           const vector<Transaction>& txns) {
+  unsigned int cur_offset = 0;
+  bytes tx_message = {MessageType::NODE,
+                      NodeInstructionType::SUBMITTRANSACTION};
+  cur_offset += MessageOffset::BODY;
+  tx_message.push_back(SUBMITTRANSACTIONTYPE::MISSINGTXN);
+  cur_offset += MessageOffset::INST;
+  Serializable::SetNumber<uint64_t>(tx_message, cur_offset, epochNum,
+                                    sizeof(uint64_t));
+  cur_offset += sizeof(uint64_t);
+
   if (!Messenger::SetTransactionArray(tx_message, cur_offset, txns)) {
     LOG_GENERAL(WARNING, "Messenger::SetTransactionArray failed.");
     return false;
@@ -221,6 +230,40 @@ bool Node::OnNodeMissingTxns(const bytes& errorMsg, const unsigned int offset,
   return true;
 }
 
+void Node::SendTxnPoolSummary() {
+  LOG_MARKER();
+
+  vector<uint64_t> shortHashes;
+  {
+    lock_guard<ProfiledMutex> g(m_mutexCreatedTransactions);
+    shortHashes = m_createdTxns.shortHashes();
+  }
+
+  if (shortHashes.empty()) {
+    return;
+  }
+
+  bytes summary = {MessageType::NODE, NodeInstructionType::TXNPOOLSUMMARY};
+  if (!Messenger::SetNodeTxnPoolShortHashes(
+          summary, MessageOffset::BODY, shortHashes,
+          m_mediator.m_currentEpochNum,
+          m_mediator.m_selfPeer.m_listenPortHost)) {
+    LOG_GENERAL(WARNING, "Messenger::SetNodeTxnPoolShortHashes failed.");
+    return;
+  }
+
+  LOG_EPOCH(INFO, m_mediator.m_currentEpochNum,
+            "Sending txn pool summary of " << shortHashes.size() << " txns");
+
+  if (BROADCAST_GOSSIP_MODE) {
+    P2PComm::GetInstance().SpreadRumor(summary);
+  } else {
+    lock_guard<mutex> g(m_mutexShardMember);
+    P2PComm::GetInstance().SendBroadcastMessage(GetBroadcastLists().m_others,
+                                                summary);
+  }
+}
+
 bool Node::OnCommitFailure([
     [gnu::unused]] const std::map<unsigned int, bytes>& commitFailureMap) {
   if (LOOKUP_NODE_MODE) {
@@ -256,30 +299,25 @@ bool Node::OnCommitFailure([
 void Node::ProcessTransactionWhenShardLeader() {
   LOG_MARKER();
 
-  lock_guard<mutex> g(m_mutexCreatedTransactions);
+  lock_guard<ProfiledMutex> g(m_mutexCreatedTransactions);
 
-  t_createdTxns = m_createdTxns;
-  map<Address, map<uint64_t, Transaction>> t_addrNonceTxnMap;
+  m_microBlockGasLimit = GetMicroBlockGasLimit();
+  auto startTime = r_timer_start();
+
+  m_createdTxns.beginTake();
+  PendingTxnQueue pendingTxns;
   t_processedTransactions.clear();
   m_TxnOrder.clear();
 
-  auto findOneFromAddrNonceTxnMap =
-      [](Transaction& t,
-         map<Address, map<uint64_t, Transaction>>& t_addrNonceTxnMap) -> bool {
-    for (auto it = t_addrNonceTxnMap.begin(); it != t_addrNonceTxnMap.end();
-         it++) {
-      if (it->second.begin()->first ==
-          AccountStore::GetInstance().GetNonceTemp(it->first) + 1) {
-        t = std::move(it->second.begin()->second);
-        it->second.erase(it->second.begin());
-
-        if (it->second.empty()) {
-          t_addrNonceTxnMap.erase(it);
-        }
-        return true;
-      }
-    }
-    return false;
+  // Processing a txn may make the next pending txn of its sender ready
+  auto checkCreatedTransaction = [this, &pendingTxns](
+                                     const Transaction& t,
+                                     TransactionReceipt& tr) -> bool {
+    const bool result = m_mediator.m_validator->CheckCreatedTransaction(t, tr);
+    const Address senderAddr = t.GetSenderAddr();
+    pendingTxns.Promote(
+        senderAddr, AccountStore::GetInstance().GetNonceTemp(senderAddr) + 1);
+    return result;
   };
 
   auto appendOne = [this](const Transaction& t, const TransactionReceipt& tr) {
@@ -293,24 +331,24 @@ void Node::ProcessTransactionWhenShardLeader() {
 
   vector<Transaction> gasLimitExceededTxnBuffer;
 
-  while (m_gasUsedTotal < MICROBLOCK_GAS_LIMIT) {
+  while (m_gasUsedTotal < m_microBlockGasLimit) {
     Transaction t;
     TransactionReceipt tr;
 
-    // check m_addrNonceTxnMap contains any txn meets right nonce,
-    // if contains, process it
-    if (findOneFromAddrNonceTxnMap(t, t_addrNonceTxnMap)) {
+    // process the pending txn with the highest gas price whose nonce has
+    // become the sender's next one
+    if (pendingTxns.PopReady(t)) {
       // check whether m_createdTransaction have transaction with same Addr and
       // nonce if has and with larger gasPrice then replace with that one.
       // (*optional step)
-      t_createdTxns.findSameNonceButHigherGas(t);
+      m_createdTxns.findSameNonceButHigherGas(t);
 
-      if (m_gasUsedTotal + t.GetGasLimit() > MICROBLOCK_GAS_LIMIT) {
+      if (m_gasUsedTotal + t.GetGasLimit() > m_microBlockGasLimit) {
         gasLimitExceededTxnBuffer.emplace_back(t);
         continue;
       }
 
-      if (m_mediator.m_validator->CheckCreatedTransaction(t, tr)) {
+      if (checkCreatedTransaction(t, tr)) {
         if (!SafeMath<uint64_t>::add(m_gasUsedTotal, tr.GetCumGas(),
                                      m_gasUsedTotal)) {
           LOG_GENERAL(WARNING, "m_gasUsedTotal addition unsafe!");
@@ -331,13 +369,13 @@ void Node::ProcessTransactionWhenShardLeader() {
         continue;
       }
     }
-    // if no txn in u_map meet right nonce process new come-in transactions
-    else if (t_createdTxns.findOne(t)) {
+    // if no pending txn is ready process new come-in transactions
+    else if (m_createdTxns.findOne(t)) {
       // LOG_GENERAL(INFO, "findOneFromCreated");
 
       Address senderAddr = t.GetSenderAddr();
       // check nonce, if nonce larger than expected, put it into
-      // m_addrNonceTxnMap
+      // pendingTxns
       if (t.GetNonce() >
           AccountStore::GetInstance().GetNonceTemp(senderAddr) + 1) {
         // LOG_GENERAL(INFO, "High nonce: "
@@ -346,19 +384,8 @@ void Node::ProcessTransactionWhenShardLeader() {
         //                     << " nonce: "
         //                     <<
         //                     AccountStore::GetInstance().GetNonceTemp(senderAddr));
-        auto it1 = t_addrNonceTxnMap.find(senderAddr);
-        if (it1 != t_addrNonceTxnMap.end()) {
-          auto it2 = it1->second.find(t.GetNonce());
-          if (it2 != it1->second.end()) {
-            // found the txn with same addr and same nonce
-            // then compare the gasprice and remains the higher one
-            if (t.GetGasPrice() > it2->second.GetGasPrice()) {
-              it2->second = t;
-            }
-            continue;
-          }
-        }
-        t_addrNonceTxnMap[senderAddr].insert({t.GetNonce(), t});
+        // Of two txns with the same nonce the higher gas price is kept
+        pendingTxns.Insert(t);
       }
       // if nonce too small, ignore it
       else if (t.GetNonce() <
@@ -370,8 +397,16 @@ void Node::ProcessTransactionWhenShardLeader() {
         //                 AccountStore::GetInstance().GetNonceTemp(senderAddr)
         //                 << " Found " << t.GetNonce());
       }
+      // if nonce correct and a plain transfer, process it with the ones
+      // after it
+      else if (PARALLEL_PAYMENT_BATCH_SIZE > 1 && t.GetData().empty() &&
+               t.GetCode().empty()) {
+        if (!ProcessPaymentBatch(t, pendingTxns, appendOne)) {
+          break;
+        }
+      }
       // if nonce correct, process it
-      else if (m_mediator.m_validator->CheckCreatedTransaction(t, tr)) {
+      else if (checkCreatedTransaction(t, tr)) {
         if (!SafeMath<uint64_t>::add(m_gasUsedTotal, tr.GetCumGas(),
                                      m_gasUsedTotal)) {
           LOG_GENERAL(WARNING, "m_gasUsedTotal addition unsafe!");
@@ -395,46 +430,304 @@ void Node::ProcessTransactionWhenShardLeader() {
       break;
     }
   }
-  // Put txns in map back into pool
-  for (const auto& kv : t_addrNonceTxnMap) {
+  // Put pending txns back into pool
+  for (const auto& kv : pendingTxns.GetChains()) {
     for (const auto& nonceTxn : kv.second) {
-      t_createdTxns.insert(nonceTxn.second);
+      m_createdTxns.putBack(nonceTxn.second);
     }
   }
 
   for (const auto& t : gasLimitExceededTxnBuffer) {
-    t_createdTxns.insert(t);
+    m_createdTxns.putBack(t);
+  }
+
+  RecordGasTiming(m_gasUsedTotal, r_timer_end(startTime));
+}
+
+uint64_t Node::GetMicroBlockGasLimit() const {
+  if (!ADAPTIVE_MICROBLOCK_GAS_LIMIT || m_gasTimings.empty()) {
+    return MICROBLOCK_GAS_LIMIT;
+  }
+
+  uint64_t gas = 0;
+  uint64_t microseconds = 0;
+  for (const auto& timing : m_gasTimings) {
+    gas += timing.first;
+    microseconds += timing.second;
+  }
+
+  // The gas the recent rate gets through in the target time
+  const uint64_t minLimit =
+      min(MICROBLOCK_GAS_LIMIT_MIN, MICROBLOCK_GAS_LIMIT);
+  const long double budget = (long double)gas *
+                             MICROBLOCK_EXECUTION_TARGET_IN_MS * 1000 /
+                             max<uint64_t>(microseconds, 1);
+  if (budget >= MICROBLOCK_GAS_LIMIT) {
+    return MICROBLOCK_GAS_LIMIT;
+  }
+  return max<uint64_t>((uint64_t)budget, minLimit);
+}
+
+void Node::RecordGasTiming(uint64_t gasUsed, uint64_t microseconds) {
+  // An idle microblock says nothing about the cost of gas
+  if (!ADAPTIVE_MICROBLOCK_GAS_LIMIT || gasUsed == 0) {
+    return;
+  }
+
+  m_gasTimings.emplace_back(gasUsed, microseconds);
+  while (m_gasTimings.size() > max(MICROBLOCK_GAS_TIMING_WINDOW, 1u)) {
+    m_gasTimings.pop_front();
+  }
+
+  LOG_GENERAL(INFO, "Ran " << gasUsed << " gas in " << microseconds / 1000
+                           << " ms, next gas limit "
+                           << GetMicroBlockGasLimit());
+}
+
+bool Node::ProcessPaymentBatch(
+    const Transaction& first, PendingTxnQueue& pendingTxns,
+    const function<void(const Transaction&, const TransactionReceipt&)>&
+        appendOne) {
+  vector<Transaction> txns;
+  txns.reserve(PARALLEL_PAYMENT_BATCH_SIZE);
+  txns.emplace_back(first);
+  unordered_set<Address> touched{first.GetSenderAddr(), first.GetToAddr()};
+
+  // Take the txns the loop in the caller would process next, for as long as
+  // processing them one by one could not change the outcome of the others
+  Transaction t;
+  while (txns.size() < PARALLEL_PAYMENT_BATCH_SIZE &&
+         m_createdTxns.findOne(t)) {
+    const Address senderAddr = t.GetSenderAddr();
+    if (!t.GetData().empty() || !t.GetCode().empty() ||
+        touched.count(senderAddr) > 0 || touched.count(t.GetToAddr()) > 0 ||
+        t.GetNonce() !=
+            AccountStore::GetInstance().GetNonceTemp(senderAddr) + 1) {
+      m_createdTxns.putBack(t);
+      break;
+    }
+    touched.insert(senderAddr);
+    touched.insert(t.GetToAddr());
+    txns.emplace_back(t);
+  }
+
+  vector<PaymentResult> results;
+  m_mediator.m_validator->CheckCreatedPayments(txns, results);
+
+  auto putBackFrom = [this, &txns](size_t begin) {
+    for (size_t i = begin; i < txns.size(); i++) {
+      m_createdTxns.putBack(txns.at(i));
+    }
+  };
+
+  for (size_t i = 0; i < txns.size(); i++) {
+    // The caller checks the gas used, and turns to any pending txn that
+    // became ready, before each txn
+    if (i > 0 &&
+        (m_gasUsedTotal >= m_microBlockGasLimit || pendingTxns.HasReady())) {
+      putBackFrom(i);
+      break;
+    }
+
+    const Transaction& txn = txns.at(i);
+    const PaymentResult& result = results.at(i);
+
+    AccountStore::GetInstance().CommitPaymentTemp(result);
+    const Address senderAddr = txn.GetSenderAddr();
+    pendingTxns.Promote(
+        senderAddr, AccountStore::GetInstance().GetNonceTemp(senderAddr) + 1);
+
+    if (!result.m_ok) {
+      continue;
+    }
+
+    if (!SafeMath<uint64_t>::add(m_gasUsedTotal, result.m_receipt.GetCumGas(),
+                                 m_gasUsedTotal)) {
+      LOG_GENERAL(WARNING, "m_gasUsedTotal addition unsafe!");
+      putBackFrom(i + 1);
+      return false;
+    }
+    uint128_t txnFee;
+    if (!SafeMath<uint128_t>::mul(result.m_receipt.GetCumGas(),
+                                  txn.GetGasPrice(), txnFee)) {
+      LOG_GENERAL(WARNING, "txnFee multiplication unsafe!");
+      continue;
+    }
+    if (!SafeMath<uint128_t>::add(m_txnFees, txnFee, m_txnFees)) {
+      LOG_GENERAL(WARNING, "m_txnFees addition unsafe!");
+      putBackFrom(i + 1);
+      return false;
+    }
+    appendOne(txn, result.m_receipt);
   }
+
+  return true;
 }
 
 bool Node::ProcessTransactionWhenShardBackup(
     const vector<TxnHash>& tranHashes, vector<TxnHash>& missingtranHashes) {
   LOG_MARKER();
 
+  vector<Transaction> txns;
   {
-    lock_guard<mutex> g(m_mutexCreatedTransactions);
+    lock_guard<ProfiledMutex> g(m_mutexCreatedTransactions);
 
     for (const auto& tranHash : tranHashes) {
       if (!m_createdTxns.exist(tranHash)) {
         missingtranHashes.emplace_back(tranHash);
       }
     }
+
+    // Rebuilding the order takes the leader's budget, checked by
+    // CheckMicroBlockGasLimit
+    m_microBlockGasLimit = m_microblock->GetHeader().GetGasLimit();
+
+    if (missingtranHashes.empty() && PREFETCH_PROPOSED_ACCOUNTS) {
+      txns.reserve(tranHashes.size());
+      Transaction t;
+      for (const auto& tranHash : tranHashes) {
+        if (m_createdTxns.findByHash(tranHash, t)) {
+          txns.emplace_back(t);
+        }
+      }
+    }
   }
 
   if (!missingtranHashes.empty()) {
     return true;
   }
 
-  return VerifyTxnsOrdering(tranHashes);
+  // Fault the accounts in side by side rather than one by one as the
+  // transactions run
+  if (!txns.empty()) {
+    m_mediator.m_validator->PrefetchAccounts(txns);
+  }
+
+  auto startTime = r_timer_start();
+  const bool result = BACKUP_APPLY_LEADER_TXN_ORDER
+                          ? ApplyTxnsInLeaderOrder(tranHashes)
+                          : VerifyTxnsOrdering(tranHashes);
+
+  // Any backup may lead a later microblock
+  if (result) {
+    lock_guard<ProfiledMutex> g(m_mutexCreatedTransactions);
+    RecordGasTiming(m_gasUsedTotal, r_timer_end(startTime));
+  }
+
+  return result;
+}
+
+bool Node::ApplyTxnsInLeaderOrder(const vector<TxnHash>& tranHashes) {
+  LOG_MARKER();
+
+  lock_guard<ProfiledMutex> g(m_mutexCreatedTransactions);
+
+  m_createdTxns.beginTake();
+  t_processedTransactions.clear();
+
+  m_gasUsedTotal = 0;
+  m_txnFees = 0;
+
+  auto appendOne = [this](const Transaction& t,
+                          const TransactionReceipt& tr) -> bool {
+    if (!SafeMath<uint64_t>::add(m_gasUsedTotal, tr.GetCumGas(),
+                                 m_gasUsedTotal)) {
+      LOG_GENERAL(WARNING, "m_gasUsedTotal addition overflow!");
+      return false;
+    }
+    uint128_t txnFee;
+    if (!SafeMath<uint128_t>::mul(tr.GetCumGas(), t.GetGasPrice(), txnFee)) {
+      LOG_GENERAL(WARNING, "txnFee multiplication overflow!");
+      return false;
+    }
+    if (!SafeMath<uint128_t>::add(m_txnFees, txnFee, m_txnFees)) {
+      LOG_GENERAL(WARNING, "m_txnFees addition overflow!");
+      return false;
+    }
+    t_processedTransactions.insert(
+        make_pair(t.GetTranID(), TransactionWithReceipt(t, tr)));
+    return true;
+  };
+
+  vector<Transaction> batch;
+  unordered_set<Address> touched;
+
+  auto applyBatch = [this, &batch, &touched, &appendOne]() -> bool {
+    vector<PaymentResult> results;
+    m_mediator.m_validator->CheckCreatedPayments(batch, results);
+
+    for (unsigned int i = 0; i < batch.size(); i++) {
+      if (!results.at(i).m_ok) {
+        LOG_GENERAL(WARNING,
+                    "Proposed txn failed: " << batch.at(i).GetTranID());
+        return false;
+      }
+      AccountStore::GetInstance().CommitPaymentTemp(results.at(i));
+      if (!appendOne(batch.at(i), results.at(i).m_receipt)) {
+        return false;
+      }
+    }
+
+    batch.clear();
+    touched.clear();
+    return true;
+  };
+
+  for (const auto& th : tranHashes) {
+    Transaction t;
+    if (!m_createdTxns.findByHash(th, t)) {
+      LOG_GENERAL(WARNING, "Proposed txn missing or repeated: " << th);
+      return false;
+    }
+
+    const Address senderAddr = t.GetSenderAddr();
+    const bool isPayment = PARALLEL_PAYMENT_BATCH_SIZE > 1 &&
+                           t.GetData().empty() && t.GetCode().empty();
+
+    // A txn can only join the batch if it does not depend on one in it
+    if (!batch.empty() &&
+        (!isPayment || batch.size() >= PARALLEL_PAYMENT_BATCH_SIZE ||
+         touched.count(senderAddr) > 0 || touched.count(t.GetToAddr()) > 0)) {
+      if (!applyBatch()) {
+        return false;
+      }
+    }
+
+    const uint128_t expectedNonce =
+        AccountStore::GetInstance().GetNonceTemp(senderAddr) + 1;
+    if (t.GetNonce() != expectedNonce) {
+      LOG_GENERAL(WARNING, "Proposed txn " << th << " has nonce "
+                                           << t.GetNonce() << ", expected "
+                                           << expectedNonce);
+      return false;
+    }
+
+    if (isPayment) {
+      touched.insert(senderAddr);
+      touched.insert(t.GetToAddr());
+      batch.emplace_back(t);
+      continue;
+    }
+
+    TransactionReceipt tr;
+    if (!m_mediator.m_validator->CheckCreatedTransaction(t, tr)) {
+      LOG_GENERAL(WARNING, "Proposed txn failed: " << th);
+      return false;
+    }
+    if (!appendOne(t, tr)) {
+      return false;
+    }
+  }
+
+  return batch.empty() || applyBatch();
 }
 
 void Node::UpdateProcessedTransactions() {
   LOG_MARKER();
 
   {
-    lock_guard<mutex> g(m_mutexCreatedTransactions);
-    m_createdTxns = std::move(t_createdTxns);
-    t_createdTxns.clear();
+    lock_guard<ProfiledMutex> g(m_mutexCreatedTransactions);
+    m_createdTxns.commitTake();
   }
 
   {
@@ -442,8 +735,8 @@ void Node::UpdateProcessedTransactions() {
     m_processedTransactions[(m_mediator.m_ds->m_mode ==
                              DirectoryService::Mode::IDLE)
                                 ? m_mediator.m_currentEpochNum
-                                : m_mediator.m_txBlockChain.GetLastBlock()
-                                      .GetHeader()
+                                : m_mediator.m_txBlockChain.GetLastBlockPtr()
+                                      ->GetHeader()
                                       .GetBlockNum()] =
         std::move(t_processedTransactions);
     t_processedTransactions.clear();
@@ -453,31 +746,22 @@ void Node::UpdateProcessedTransactions() {
 bool Node::VerifyTxnsOrdering(const vector<TxnHash>& tranHashes) {
   LOG_MARKER();
 
-  lock_guard<mutex> g(m_mutexCreatedTransactions);
+  lock_guard<ProfiledMutex> g(m_mutexCreatedTransactions);
 
-  t_createdTxns = m_createdTxns;
+  m_createdTxns.beginTake();
   vector<TxnHash> t_tranHashes;
-  map<Address, map<uint64_t, Transaction>> t_addrNonceTxnMap;
+  PendingTxnQueue pendingTxns;
   t_processedTransactions.clear();
 
-  auto findOneFromAddrNonceTxnMap =
-      [](Transaction& t,
-         std::map<Address, map<uint64_t, Transaction>>& t_addrNonceTxnMap)
-      -> bool {
-    for (auto it = t_addrNonceTxnMap.begin(); it != t_addrNonceTxnMap.end();
-         it++) {
-      if (it->second.begin()->first ==
-          AccountStore::GetInstance().GetNonceTemp(it->first) + 1) {
-        t = std::move(it->second.begin()->second);
-        it->second.erase(it->second.begin());
-
-        if (it->second.empty()) {
-          t_addrNonceTxnMap.erase(it);
-        }
-        return true;
-      }
-    }
-    return false;
+  // Processing a txn may make the next pending txn of its sender ready
+  auto checkCreatedTransaction = [this, &pendingTxns](
+                                     const Transaction& t,
+                                     TransactionReceipt& tr) -> bool {
+    const bool result = m_mediator.m_validator->CheckCreatedTransaction(t, tr);
+    const Address senderAddr = t.GetSenderAddr();
+    pendingTxns.Promote(
+        senderAddr, AccountStore::GetInstance().GetNonceTemp(senderAddr) + 1);
+    return result;
   };
 
   auto appendOne = [this, &t_tranHashes](const Transaction& t,
@@ -492,24 +776,24 @@ bool Node::VerifyTxnsOrdering(const vector<TxnHash>& tranHashes) {
 
   vector<Transaction> gasLimitExceededTxnBuffer;
 
-  while (m_gasUsedTotal < MICROBLOCK_GAS_LIMIT) {
+  while (m_gasUsedTotal < m_microBlockGasLimit) {
     Transaction t;
     TransactionReceipt tr;
 
-    // check t_addrNonceTxnMap contains any txn meets right nonce,
-    // if contains, process it
-    if (findOneFromAddrNonceTxnMap(t, t_addrNonceTxnMap)) {
+    // process the pending txn with the highest gas price whose nonce has
+    // become the sender's next one
+    if (pendingTxns.PopReady(t)) {
       // check whether m_createdTransaction have transaction with same Addr and
       // nonce if has and with larger gasPrice then replace with that one.
       // (*optional step)
-      t_createdTxns.findSameNonceButHigherGas(t);
+      m_createdTxns.findSameNonceButHigherGas(t);
 
-      if (m_gasUsedTotal + t.GetGasLimit() > MICROBLOCK_GAS_LIMIT) {
+      if (m_gasUsedTotal + t.GetGasLimit() > m_microBlockGasLimit) {
         gasLimitExceededTxnBuffer.emplace_back(t);
         continue;
       }
 
-      if (m_mediator.m_validator->CheckCreatedTransaction(t, tr)) {
+      if (checkCreatedTransaction(t, tr)) {
         if (!SafeMath<uint64_t>::add(m_gasUsedTotal, tr.GetCumGas(),
                                      m_gasUsedTotal)) {
           LOG_GENERAL(WARNING, "m_gasUsedTotal addition unsafe!");
@@ -529,33 +813,30 @@ bool Node::VerifyTxnsOrdering(const vector<TxnHash>& tranHashes) {
         continue;
       }
     }
-    // if no txn in u_map meet right nonce process new come-in transactions
-    else if (t_createdTxns.findOne(t)) {
+    // if no pending txn is ready process new come-in transactions
+    else if (m_createdTxns.findOne(t)) {
       Address senderAddr = t.GetSenderAddr();
       // check nonce, if nonce larger than expected, put it into
-      // t_addrNonceTxnMap
+      // pendingTxns
       if (t.GetNonce() >
           AccountStore::GetInstance().GetNonceTemp(senderAddr) + 1) {
-        auto it1 = t_addrNonceTxnMap.find(senderAddr);
-        if (it1 != t_addrNonceTxnMap.end()) {
-          auto it2 = it1->second.find(t.GetNonce());
-          if (it2 != it1->second.end()) {
-            // found the txn with same addr and same nonce
-            // then compare the gasprice and remains the higher one
-            if (t.GetGasPrice() > it2->second.GetGasPrice()) {
-              it2->second = t;
-            }
-            continue;
-          }
-        }
-        t_addrNonceTxnMap[senderAddr].insert({t.GetNonce(), t});
+        // Of two txns with the same nonce the higher gas price is kept
+        pendingTxns.Insert(t);
       }
       // if nonce too small, ignore it
       else if (t.GetNonce() <
                AccountStore::GetInstance().GetNonceTemp(senderAddr) + 1) {
       }
+      // if nonce correct and a plain transfer, process it with the ones
+      // after it
+      else if (PARALLEL_PAYMENT_BATCH_SIZE > 1 && t.GetData().empty() &&
+               t.GetCode().empty()) {
+        if (!ProcessPaymentBatch(t, pendingTxns, appendOne)) {
+          break;
+        }
+      }
       // if nonce correct, process it
-      else if (m_mediator.m_validator->CheckCreatedTransaction(t, tr)) {
+      else if (checkCreatedTransaction(t, tr)) {
         if (!SafeMath<uint64_t>::add(m_gasUsedTotal, tr.GetCumGas(),
                                      m_gasUsedTotal)) {
           LOG_GENERAL(WARNING, "m_gasUsedTotal addition overflow!");
@@ -580,35 +861,34 @@ bool Node::VerifyTxnsOrdering(const vector<TxnHash>& tranHashes) {
 
   // Put remaining txns back in pool
 
-  for (const auto& kv : t_addrNonceTxnMap) {
+  for (const auto& kv : pendingTxns.GetChains()) {
     for (const auto& nonceTxn : kv.second) {
-      t_createdTxns.insert(nonceTxn.second);
+      m_createdTxns.putBack(nonceTxn.second);
     }
   }
 
   for (const auto& t : gasLimitExceededTxnBuffer) {
-    t_createdTxns.insert(t);
+    m_createdTxns.putBack(t);
   }
 
-  if (!VerifyTxnOrderWTolerance(t_tranHashes, tranHashes,
-                                TXN_MISORDER_TOLERANCE_IN_PERCENT)) {
+  m_txnOrderIndex.Build(tranHashes);
+  vector<TxnHash> mismatchedTxns;
+  if (!VerifyTxnOrderWTolerance(t_tranHashes, m_txnOrderIndex,
+                                TXN_MISORDER_TOLERANCE_IN_PERCENT,
+                                &mismatchedTxns)) {
     LOG_EPOCH(WARNING, m_mediator.m_currentEpochNum,
-              "Failed to Verify due to bad txn ordering");
+              "Failed to Verify due to bad txn ordering, "
+                  << mismatchedTxns.size() << " of " << t_tranHashes.size()
+                  << " txns out of order");
 
-    for (const auto& th : t_tranHashes) {
-      Transaction t;
-      if (m_createdTxns.get(th, t)) {
-        LOG_GENERAL(INFO, "Expected txn: "
-                              << t.GetTranID() << " " << t.GetSenderAddr()
-                              << " " << t.GetNonce() << " " << t.GetGasPrice());
-      }
-    }
-    for (const auto& th : tranHashes) {
+    for (const auto& th : mismatchedTxns) {
       Transaction t;
       if (m_createdTxns.get(th, t)) {
-        LOG_GENERAL(INFO, "Received txn: "
+        LOG_GENERAL(INFO, "Out of order txn: "
                               << t.GetTranID() << " " << t.GetSenderAddr()
                               << " " << t.GetNonce() << " " << t.GetGasPrice());
+      } else {
+        LOG_GENERAL(INFO, "Out of order txn: " << th);
       }
     }
 
@@ -634,13 +914,38 @@ bool Node::RunConsensusOnMicroBlockWhenShardLeader() {
 
   if (m_mediator.m_ds->m_mode == DirectoryService::Mode::IDLE &&
       !m_mediator.GetIsVacuousEpoch()) {
-    std::this_thread::sleep_for(chrono::milliseconds(TX_DISTRIBUTE_TIME_IN_MS));
+    double waitInMs = TX_DISTRIBUTE_TIME_IN_MS;
+    if (PIPELINED_MICROBLOCK_CONSENSUS) {
+      // The txn distribution window already ran while the final block was
+      // being applied and stored
+      const double elapsedInMs = r_timer_end(m_txDistributeStartTime) / 1000;
+      waitInMs = max(waitInMs - elapsedInMs, 0.0);
+      LOG_EPOCH(INFO, m_mediator.m_currentEpochNum,
+                "Txn distribution started " << elapsedInMs
+                                            << " ms ago, waiting " << waitInMs
+                                            << " ms more");
+    }
+    // Leave the backups time to fetch the txns they lack before announcing
+    if (TXN_POOL_SUMMARY_LEAD_TIME_IN_MS > 0) {
+      const double leadInMs =
+          min<double>(TXN_POOL_SUMMARY_LEAD_TIME_IN_MS, waitInMs);
+      std::this_thread::sleep_for(chrono::microseconds(
+          static_cast<uint64_t>((waitInMs - leadInMs) * 1000)));
+      SendTxnPoolSummary();
+      waitInMs = leadInMs;
+    }
+    std::this_thread::sleep_for(
+        chrono::microseconds(static_cast<uint64_t>(waitInMs * 1000)));
   }
 
   if (!m_mediator.GetIsVacuousEpoch() &&
-      m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetDifficulty() >=
+      m_mediator.m_dsBlockChain.GetLastBlockPtr()
+          ->GetHeader()
+          .GetDifficulty() >=
           TXN_SHARD_TARGET_DIFFICULTY &&
-      m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetDSDifficulty() >=
+      m_mediator.m_dsBlockChain.GetLastBlockPtr()
+          ->GetHeader()
+          .GetDSDifficulty() >=
           TXN_DS_TARGET_DIFFICULTY) {
     ProcessTransactionWhenShardLeader();
     AccountStore::GetInstance().SerializeDelta();
@@ -653,8 +958,8 @@ bool Node::RunConsensusOnMicroBlockWhenShardLeader() {
   }
 
   // m_consensusID = 0;
-  m_consensusBlockHash = m_mediator.m_txBlockChain.GetLastBlock()
-                             .GetHeader()
+  m_consensusBlockHash = m_mediator.m_txBlockChain.GetLastBlockPtr()
+                             ->GetHeader()
                              .GetMyHash()
                              .asBytes();
 
@@ -709,7 +1014,9 @@ bool Node::RunConsensusOnMicroBlockWhenShardLeader() {
       "[MICON]["
       << setw(15) << left << m_mediator.m_selfPeer.GetPrintableIPAddress()
       << "]["
-      << m_mediator.m_txBlockChain.GetLastBlock().GetHeader().GetBlockNum() + 1
+      << m_mediator.m_txBlockChain.GetLastBlockPtr()
+          ->GetHeader()
+          .GetBlockNum() + 1
       << "][" << m_myshardId << "] BGIN");
 
   cl->StartConsensus(announcementGeneratorFunc, BROADCAST_GOSSIP_MODE);
@@ -731,8 +1038,8 @@ bool Node::RunConsensusOnMicroBlockWhenShardBackup() {
             "I am a backup node. Waiting for microblock announcement for epoch "
                 << m_mediator.m_currentEpochNum);
   // m_consensusID = 0;
-  m_consensusBlockHash = m_mediator.m_txBlockChain.GetLastBlock()
-                             .GetHeader()
+  m_consensusBlockHash = m_mediator.m_txBlockChain.GetLastBlockPtr()
+                             ->GetHeader()
                              .GetMyHash()
                              .asBytes();
 
@@ -778,9 +1085,91 @@ bool Node::RunConsensusOnMicroBlockWhenShardBackup() {
     return false;
   }
 
+  // Only payment batches look up pre-executed results
+  if (BACKUP_PRE_EXECUTION_LEAD_TIME_IN_MS > 0 &&
+      PARALLEL_PAYMENT_BATCH_SIZE > 1 &&
+      m_mediator.m_ds->m_mode == DirectoryService::Mode::IDLE &&
+      !m_mediator.GetIsVacuousEpoch()) {
+    auto func = [this]() mutable -> void { PreExecuteTxnsWhenShardBackup(); };
+    DetachedFunction(1, func);
+  }
+
   return true;
 }
 
+void Node::PreExecuteTxnsWhenShardBackup() {
+  LOG_MARKER();
+
+  const uint64_t epochNum = m_mediator.m_currentEpochNum;
+
+  // The leader announces once the txn distribution window is over
+  double waitInMs = TX_DISTRIBUTE_TIME_IN_MS;
+  if (PIPELINED_MICROBLOCK_CONSENSUS) {
+    waitInMs -= r_timer_end(m_txDistributeStartTime) / 1000;
+  }
+  waitInMs -= BACKUP_PRE_EXECUTION_LEAD_TIME_IN_MS;
+  if (waitInMs > 0) {
+    std::this_thread::sleep_for(
+        chrono::microseconds(static_cast<uint64_t>(waitInMs * 1000)));
+  }
+
+  if (m_state != MICROBLOCK_CONSENSUS ||
+      epochNum != m_mediator.m_currentEpochNum) {
+    return;
+  }
+
+  auto startTime = r_timer_start();
+
+  vector<Transaction> pooled;
+  {
+    lock_guard<ProfiledMutex> g(m_mutexCreatedTransactions);
+    m_createdTxns.getInGasOrder(MICROBLOCK_GAS_LIMIT / NORMAL_TRAN_GAS,
+                                pooled);
+  }
+
+  // Each sender's txns in nonce order, as the leader takes them
+  vector<Transaction> txns;
+  unordered_map<Address, uint128_t> nextNonces;
+  PendingTxnQueue pendingTxns;
+
+  auto appendOne = [&txns, &nextNonces, &pendingTxns](const Transaction& t) {
+    txns.emplace_back(t);
+    uint128_t& nextNonce = nextNonces[t.GetSenderAddr()];
+    nextNonce++;
+    pendingTxns.Promote(t.GetSenderAddr(), nextNonce);
+  };
+
+  for (const auto& t : pooled) {
+    if (!t.GetData().empty() || !t.GetCode().empty()) {
+      continue;
+    }
+
+    const Address senderAddr = t.GetSenderAddr();
+    if (nextNonces.find(senderAddr) == nextNonces.end()) {
+      nextNonces[senderAddr] =
+          AccountStore::GetInstance().GetNonceTemp(senderAddr) + 1;
+    }
+    const uint128_t nextNonce = nextNonces[senderAddr];
+
+    if (t.GetNonce() > nextNonce) {
+      pendingTxns.Insert(t);
+    } else if (t.GetNonce() == nextNonce) {
+      appendOne(t);
+      Transaction ready;
+      while (pendingTxns.PopReady(ready)) {
+        appendOne(ready);
+      }
+    }
+  }
+
+  AccountStore::GetInstance().PreExecutePayments(txns, epochNum);
+
+  LOG_EPOCH(INFO, epochNum,
+            "Pre-executed " << txns.size() << " of " << pooled.size()
+                            << " pooled txns in "
+                            << r_timer_end(startTime) / 1000 << " ms");
+}
+
 bool Node::RunConsensusOnMicroBlock() {
   if (LOOKUP_NODE_MODE) {
     LOG_GENERAL(WARNING,
@@ -912,6 +1301,39 @@ bool Node::CheckMicroBlockTimestamp() {
                          CONSENSUS_OBJECT_TIMEOUT);
 }
 
+bool Node::CheckMicroBlockGasLimit() {
+  if (LOOKUP_NODE_MODE) {
+    LOG_GENERAL(WARNING,
+                "Node::CheckMicroBlockGasLimit not expected to be called "
+                "from LookUp node.");
+    return true;
+  }
+
+  const uint64_t gasLimit = m_microblock->GetHeader().GetGasLimit();
+  const uint64_t minLimit =
+      ADAPTIVE_MICROBLOCK_GAS_LIMIT
+          ? min(MICROBLOCK_GAS_LIMIT_MIN, MICROBLOCK_GAS_LIMIT)
+          : MICROBLOCK_GAS_LIMIT;
+  if (gasLimit < minLimit || gasLimit > MICROBLOCK_GAS_LIMIT) {
+    LOG_GENERAL(WARNING, "Gas limit check failed. Expected: ["
+                             << minLimit << ", " << MICROBLOCK_GAS_LIMIT
+                             << "] Actual: " << gasLimit);
+    m_consensusObject->SetConsensusErrorCode(
+        ConsensusCommon::INVALID_MICROBLOCK);
+    return false;
+  }
+
+  if (m_microblock->GetHeader().GetGasUsed() > gasLimit) {
+    LOG_GENERAL(WARNING, "Gas used " << m_microblock->GetHeader().GetGasUsed()
+                                     << " exceeds gas limit " << gasLimit);
+    m_consensusObject->SetConsensusErrorCode(
+        ConsensusCommon::INVALID_MICROBLOCK);
+    return false;
+  }
+
+  return true;
+}
+
 unsigned char Node::CheckLegitimacyOfTxnHashes(bytes& errorMsg) {
   if (LOOKUP_NODE_MODE) {
     LOG_GENERAL(WARNING,
@@ -921,9 +1343,13 @@ unsigned char Node::CheckLegitimacyOfTxnHashes(bytes& errorMsg) {
   }
 
   if (!m_mediator.GetIsVacuousEpoch() &&
-      m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetDifficulty() >=
+      m_mediator.m_dsBlockChain.GetLastBlockPtr()
+          ->GetHeader()
+          .GetDifficulty() >=
           TXN_SHARD_TARGET_DIFFICULTY &&
-      m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetDSDifficulty() >=
+      m_mediator.m_dsBlockChain.GetLastBlockPtr()
+          ->GetHeader()
+          .GetDSDifficulty() >=
           TXN_DS_TARGET_DIFFICULTY) {
     vector<TxnHash> missingTxnHashes;
     if (!ProcessTransactionWhenShardBackup(m_microblock->GetTranHashes(),
@@ -941,7 +1367,7 @@ unsigned char Node::CheckLegitimacyOfTxnHashes(bytes& errorMsg) {
       }
 
       {
-        lock_guard<mutex> g(m_mutexCreatedTransactions);
+        lock_guard<ProfiledMutex> g(m_mutexCreatedTransactions);
         LOG_GENERAL(WARNING, m_createdTxns);
       }
 
@@ -1064,7 +1490,9 @@ bool Node::CheckMicroBlockTxnRootHash() {
   }
 
   // Check transaction root
-  TxnHash expectedTxRootHash = ComputeRoot(m_microblock->GetTranHashes());
+  TxnHash expectedTxRootHash = ComputeMicroBlockTxRoot(
+      m_microblock->GetBlockHash(), m_microblock->GetHeader().GetVersion(),
+      m_microblock->GetTranHashes());
 
   string txroothashStr;
   DataConversion::charArrToHexStr(expectedTxRootHash.asArray(), txroothashStr);
@@ -1155,12 +1583,11 @@ bool Node::CheckMicroBlockValidity(bytes& errorMsg) {
   LOG_MARKER();
 
   return CheckMicroBlockVersion() && CheckMicroBlockshardId() &&
-         CheckMicroBlockTimestamp() && CheckMicroBlockHashes(errorMsg) &&
+         CheckMicroBlockTimestamp() && CheckMicroBlockGasLimit() &&
+         CheckMicroBlockHashes(errorMsg) &&
          CheckMicroBlockTxnRootHash() && CheckMicroBlockStateDeltaHash() &&
          CheckMicroBlockTranReceiptHash();
 
-  // Check gas limit (must satisfy some equations)
-  // Check gas used (must be <= gas limit)
   // Check state root (TBD)
   // Check pubkey (must be valid and = shard leader)
   // Check parent DS hash (must be = digest of last DS block header in the DS
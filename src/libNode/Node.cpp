@@ -16,10 +16,12 @@
  */
 
 #include <arpa/inet.h>
+#include <algorithm>
 #include <array>
 #include <chrono>
 #include <functional>
 #include <thread>
+#include <unordered_set>
 
 #include <boost/filesystem.hpp>
 #include <boost/property_tree/ptree.hpp>
@@ -47,15 +49,19 @@
 #include "libMediator/Mediator.h"
 #include "libMessage/Messenger.h"
 #include "libNetwork/Blacklist.h"
+#include "libNetwork/BroadcastTree.h"
 #include "libNetwork/Guard.h"
 #include "libPOW/pow.h"
 #include "libPersistence/Retriever.h"
+#include "libUtils/AsyncExecutor.h"
 #include "libUtils/DataConversion.h"
 #include "libUtils/DetachedFunction.h"
+#include "libUtils/ErasureCode.h"
 #include "libUtils/Logger.h"
 #include "libUtils/SanityChecks.h"
 #include "libUtils/TimeLockedFunction.h"
 #include "libUtils/TimeUtils.h"
+#include "libUtils/UpgradeManager.h"
 #include "libValidator/Validator.h"
 
 using namespace std;
@@ -67,27 +73,133 @@ const unsigned int MIN_CHILD_CLUSTER_SIZE = 2;
 
 #define IP_MAPPING_FILE_NAME "ipMapping.xml"
 
+namespace {
+/// Left by ValidateDB once the DB passed, so that the next run only checks
+/// the co-signatures of the blocks added since
+struct ValidateDBCheckpoint {
+  /// Index of the last directory block link validated
+  uint64_t m_dirBlockIndex = 0;
+  /// SHA256 over the hashes of the links up to m_dirBlockIndex
+  bytes m_dirBlocksDigest;
+  uint64_t m_txBlockNum = 0;
+  BlockHash m_txBlockHash;
+};
+
+const unsigned int CHECKPOINT_SIZE =
+    sizeof(uint64_t) + COMMON_HASH_SIZE + sizeof(uint64_t) + BLOCK_HASH_SIZE;
+
+bytes DigestBlockLinks(const vector<BlockLink>& blocklinks, uint64_t upTo) {
+  SHA2<HASH_TYPE::HASH_VARIANT_256> sha2;
+  for (const auto& blocklink : blocklinks) {
+    if (get<BlockLinkIndex::INDEX>(blocklink) > upTo) {
+      break;
+    }
+    sha2.Update(get<BlockLinkIndex::BLOCKHASH>(blocklink).asBytes());
+  }
+  return sha2.Finalize();
+}
+
+bool PutValidateDBCheckpoint(const ValidateDBCheckpoint& checkpoint,
+                             const PairOfKey& key) {
+  bytes data;
+  SerializableDataBlock::SetNumber<uint64_t>(
+      data, 0, checkpoint.m_dirBlockIndex, sizeof(uint64_t));
+  data.insert(data.end(), checkpoint.m_dirBlocksDigest.begin(),
+              checkpoint.m_dirBlocksDigest.end());
+  SerializableDataBlock::SetNumber<uint64_t>(
+      data, data.size(), checkpoint.m_txBlockNum, sizeof(uint64_t));
+  const bytes txBlockHash = checkpoint.m_txBlockHash.asBytes();
+  data.insert(data.end(), txBlockHash.begin(), txBlockHash.end());
+
+  Signature signature;
+  if (!Schnorr::GetInstance().Sign(data, key.first, key.second, signature)) {
+    LOG_GENERAL(WARNING, "Failed to sign the ValidateDB checkpoint");
+    return false;
+  }
+  signature.Serialize(data, data.size());
+
+  return BlockStorage::GetBlockStorage().PutMetadata(VALIDATEDBCHECKPOINT,
+                                                     data);
+}
+
+bool GetValidateDBCheckpoint(ValidateDBCheckpoint& checkpoint,
+                             const PubKey& pubKey) {
+  bytes data;
+  if (!BlockStorage::GetBlockStorage().GetMetadata(VALIDATEDBCHECKPOINT,
+                                                   data)) {
+    return false;
+  }
+
+  Signature signature;
+  if ((data.size() != CHECKPOINT_SIZE + SIGNATURE_CHALLENGE_SIZE +
+                          SIGNATURE_RESPONSE_SIZE) ||
+      (signature.Deserialize(data, CHECKPOINT_SIZE) != 0)) {
+    LOG_GENERAL(WARNING, "Malformed ValidateDB checkpoint");
+    return false;
+  }
+
+  if (!Schnorr::GetInstance().Verify(data, 0, CHECKPOINT_SIZE, signature,
+                                     pubKey)) {
+    LOG_GENERAL(WARNING, "ValidateDB checkpoint is not signed by this node");
+    return false;
+  }
+
+  unsigned int offset = 0;
+  checkpoint.m_dirBlockIndex = SerializableDataBlock::GetNumber<uint64_t>(
+      data, offset, sizeof(uint64_t));
+  offset += sizeof(uint64_t);
+  checkpoint.m_dirBlocksDigest.assign(data.begin() + offset,
+                                      data.begin() + offset + COMMON_HASH_SIZE);
+  offset += COMMON_HASH_SIZE;
+  checkpoint.m_txBlockNum = SerializableDataBlock::GetNumber<uint64_t>(
+      data, offset, sizeof(uint64_t));
+  offset += sizeof(uint64_t);
+  copy(data.begin() + offset, data.begin() + offset + BLOCK_HASH_SIZE,
+       checkpoint.m_txBlockHash.asArray().begin());
+  return true;
+}
+}  // namespace
+
 void addBalanceToGenesisAccount() {
   LOG_MARKER();
 
   const uint128_t bal{std::numeric_limits<uint128_t>::max()};
   const uint64_t nonce{0};
 
+  // Sorted, and the first of any repeated address kept, for ImportAccounts
+  map<Address, Account> accounts;
   for (auto& walletHexStr : GENESIS_WALLETS) {
     bytes addrBytes;
     if (!DataConversion::HexStrToUint8Vec(walletHexStr, addrBytes)) {
       continue;
     }
     Address addr{addrBytes};
-    AccountStore::GetInstance().AddAccount(addr, {bal, nonce});
+    accounts.emplace(addr, Account{bal, nonce});
     LOG_GENERAL(INFO,
                 "add genesis account " << addr << " with balance " << bal);
   }
 
   // Init account for issuing coinbase rewards
-  AccountStore::GetInstance().AddAccount(Address(),
-                                         {TOTAL_COINBASE_REWARD, nonce});
-  AccountStore::GetInstance().UpdateStateTrieAll();
+  accounts.emplace(Address(), Account{TOTAL_COINBASE_REWARD, nonce});
+
+  auto it = accounts.cbegin();
+  auto next = [&accounts, &it](Address& address, Account& account) {
+    if (it == accounts.cend()) {
+      return false;
+    }
+    address = it->first;
+    account = it->second;
+    ++it;
+    return true;
+  };
+
+  if (!AccountStore::GetInstance().ImportAccounts(next)) {
+    // Not a fresh store, so add them the usual way
+    for (const auto& entry : accounts) {
+      AccountStore::GetInstance().AddAccount(entry.first, entry.second);
+    }
+    AccountStore::GetInstance().UpdateStateTrieAll();
+  }
 }
 
 Node::Node(Mediator& mediator, [[gnu::unused]] unsigned int syncType,
@@ -122,7 +234,9 @@ bool Node::Install(const SyncType syncType, const bool toRetrieveHistory) {
     }
 
     m_mediator.m_currentEpochNum =
-        m_mediator.m_txBlockChain.GetLastBlock().GetHeader().GetBlockNum() + 1;
+        m_mediator.m_txBlockChain.GetLastBlockPtr()
+            ->GetHeader()
+            .GetBlockNum() + 1;
 
     if (wakeupForUpgrade || RECOVERY_TRIM_INCOMPLETED_BLOCK) {
       m_mediator.m_consensusID = m_mediator.m_currentEpochNum == 1 ? 1 : 0;
@@ -219,6 +333,7 @@ void Node::Init() {
   {
     std::lock_guard<mutex> lock(m_mediator.m_mutexDSCommittee);
     m_mediator.m_DSCommittee->clear();
+    m_mediator.PublishDSCommittee();
   }
   // m_committedTransactions.clear();
   AccountStore::GetInstance().Init();
@@ -267,33 +382,68 @@ bool Node::ValidateDB() {
   for (const auto& dsKey : *m_mediator.m_initialDSCommittee) {
     dsComm.emplace_back(dsKey, Peer());
   }
-  std::list<BlockLink> blocklinks;
+  std::vector<BlockLink> blocklinks;
   if (!BlockStorage::GetBlockStorage().GetAllBlockLink(blocklinks)) {
     LOG_GENERAL(WARNING, "BlockStorage skipped or incompleted");
     return false;
   }
 
-  blocklinks.sort([](const BlockLink& a, const BlockLink& b) {
-    return std::get<BlockLinkIndex::INDEX>(a) <
-           std::get<BlockLinkIndex::INDEX>(b);
-  });
+  std::stable_sort(blocklinks.begin(), blocklinks.end(),
+                   [](const BlockLink& a, const BlockLink& b) {
+                     return std::get<BlockLinkIndex::INDEX>(a) <
+                            std::get<BlockLinkIndex::INDEX>(b);
+                   });
 
-  std::list<TxBlockSharedPtr> txblocks;
+  std::vector<TxBlockSharedPtr> txblocks;
   if (!BlockStorage::GetBlockStorage().GetAllTxBlocks(txblocks)) {
     LOG_GENERAL(WARNING, "Failed to get Tx Blocks");
     return false;
   }
 
-  txblocks.sort([](const TxBlockSharedPtr& a, const TxBlockSharedPtr& b) {
-    return a->GetHeader().GetBlockNum() < b->GetHeader().GetBlockNum();
-  });
+  std::stable_sort(
+      txblocks.begin(), txblocks.end(),
+      [](const TxBlockSharedPtr& a, const TxBlockSharedPtr& b) {
+        return a->GetHeader().GetBlockNum() < b->GetHeader().GetBlockNum();
+      });
 
   const auto& latestTxBlockNum = txblocks.back()->GetHeader().GetBlockNum();
   const auto& latestDSIndex = txblocks.back()->GetHeader().GetDSBlockNum();
 
+  // Resume from the last run that passed, if the blocks it covered are
+  // still the ones it saw
+  ValidateDBCheckpoint checkpoint;
+  bool checkpointed =
+      GetValidateDBCheckpoint(checkpoint, m_mediator.m_selfKey.second) &&
+      (DigestBlockLinks(blocklinks, checkpoint.m_dirBlockIndex) ==
+       checkpoint.m_dirBlocksDigest);
+  size_t txBlocksChecked = 0;
+  if (checkpointed) {
+    auto it = find_if(txblocks.begin(), txblocks.end(),
+                      [&checkpoint](const TxBlockSharedPtr& txblock) {
+                        return txblock->GetHeader().GetBlockNum() ==
+                               checkpoint.m_txBlockNum;
+                      });
+    checkpointed = (it != txblocks.end()) &&
+                   ((*it)->GetBlockHash() == checkpoint.m_txBlockHash);
+    txBlocksChecked = checkpointed ? it - txblocks.begin() : 0;
+  }
+  if (checkpointed) {
+    LOG_GENERAL(INFO, "Resuming validation after dir block link "
+                          << checkpoint.m_dirBlockIndex << " and Tx block "
+                          << checkpoint.m_txBlockNum);
+  } else {
+    LOG_GENERAL(INFO, "No usable ValidateDB checkpoint, validating all blocks");
+  }
+
   vector<boost::variant<DSBlock, VCBlock, FallbackBlockWShardingStructure>>
       dirBlocks;
+  size_t dirBlocksChecked = 0;
+  uint64_t lastDirBlockIndex = 0;
   for (const auto& blocklink : blocklinks) {
+    const auto linkIndex = get<BlockLinkIndex::INDEX>(blocklink);
+    const bool covered =
+        checkpointed && (linkIndex <= checkpoint.m_dirBlockIndex);
+    const size_t numDirBlocks = dirBlocks.size();
     if (get<BlockLinkIndex::BLOCKTYPE>(blocklink) == BlockType::DS) {
       auto blockNum = get<BlockLinkIndex::DSINDEX>(blocklink);
       if (blockNum == 0) {
@@ -311,6 +461,12 @@ bool Node::ValidateDB() {
                               << dsblock->GetHeader().GetEpochNum());
         break;
       }
+      if (covered && (dsblock->GetBlockHash() !=
+                      get<BlockLinkIndex::BLOCKHASH>(blocklink))) {
+        LOG_GENERAL(WARNING,
+                    "DS Block " << blockNum << " changed since the checkpoint");
+        checkpointed = false;
+      }
       dirBlocks.emplace_back(*dsblock);
 
     } else if (get<BlockLinkIndex::BLOCKTYPE>(blocklink) == BlockType::VC) {
@@ -335,17 +491,35 @@ bool Node::ValidateDB() {
       }
       dirBlocks.emplace_back(*fallbackwshardingstruct);
     }
+
+    if (dirBlocks.size() > numDirBlocks) {
+      lastDirBlockIndex = linkIndex;
+      if (covered && checkpointed) {
+        dirBlocksChecked = dirBlocks.size();
+      }
+    }
   }
 
-  if (!m_mediator.m_validator->CheckDirBlocks(dirBlocks, dsComm, 0, dsComm)) {
+  if (!checkpointed) {
+    dirBlocksChecked = 0;
+    txBlocksChecked = 0;
+  }
+  LOG_GENERAL(INFO, "Checking the co-signatures of "
+                        << dirBlocks.size() - dirBlocksChecked << " of "
+                        << dirBlocks.size() << " dir blocks");
+
+  if (!m_mediator.m_validator->CheckDirBlocks(dirBlocks, dsComm, 0, dsComm,
+                                              dirBlocksChecked)) {
     LOG_GENERAL(WARNING, "Failed to verify Dir Blocks");
     return false;
   }
 
+  // From the checkpointed Tx block on, which anchors the hash chain
   vector<TxBlock> txBlocks;
 
-  for (const auto& txblock : txblocks) {
-    txBlocks.emplace_back(*txblock);
+  for (auto it = txblocks.begin() + txBlocksChecked; it != txblocks.end();
+       it++) {
+    txBlocks.emplace_back(**it);
   }
 
   if (m_mediator.m_validator->CheckTxBlocks(
@@ -366,13 +540,12 @@ bool Node::ValidateDB() {
       }
       if (BlockStorage::GetBlockStorage().GetMicroBlock(mbInfo.m_microBlockHash,
                                                         mbptr)) {
-        auto tranHashes = mbptr->GetTranHashes();
-        for (const auto& tranHash : tranHashes) {
-          TxBodySharedPtr tx;
-          if (!BlockStorage::GetBlockStorage().GetTxBody(tranHash, tx)) {
-            LOG_GENERAL(WARNING, " " << tranHash << " failed to fetch");
-            return false;
-          }
+        vector<TxBodySharedPtr> txs;
+        if (!BlockStorage::GetBlockStorage().GetTxBodies(
+                mbptr->GetTranHashes(), txs)) {
+          LOG_GENERAL(WARNING, " " << mbInfo.m_microBlockHash
+                                   << " failed to fetch txns");
+          return false;
         }
       } else {
         LOG_GENERAL(WARNING, " " << mbInfo.m_microBlockHash
@@ -383,6 +556,15 @@ bool Node::ValidateDB() {
   }
   LOG_GENERAL(INFO, "ValidateDB Success");
 
+  ValidateDBCheckpoint passed;
+  passed.m_dirBlockIndex = lastDirBlockIndex;
+  passed.m_dirBlocksDigest = DigestBlockLinks(blocklinks, lastDirBlockIndex);
+  passed.m_txBlockNum = latestTxBlockNum;
+  passed.m_txBlockHash = txblocks.back()->GetBlockHash();
+  if (!PutValidateDBCheckpoint(passed, m_mediator.m_selfKey)) {
+    LOG_GENERAL(WARNING, "Failed to store the ValidateDB checkpoint");
+  }
+
   BlockStorage::GetBlockStorage().ReleaseDB();
 
   bytes message = {MessageType::LOOKUP, LookupInstructionType::SETHISTORICALDB};
@@ -405,12 +587,16 @@ bool Node::ValidateDB() {
 void Node::Prepare(bool runInitializeGenesisBlocks) {
   LOG_MARKER();
   m_mediator.m_currentEpochNum =
-      m_mediator.m_txBlockChain.GetLastBlock().GetHeader().GetBlockNum() + 1;
+      m_mediator.m_txBlockChain.GetLastBlockPtr()
+          ->GetHeader()
+          .GetBlockNum() + 1;
   m_mediator.UpdateDSBlockRand(runInitializeGenesisBlocks);
   m_mediator.UpdateTxBlockRand(runInitializeGenesisBlocks);
   SetState(POW_SUBMISSION);
   POW::GetInstance().EthashConfigureClient(
-      m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetBlockNum() + 1,
+      m_mediator.m_dsBlockChain.GetLastBlockPtr()
+          ->GetHeader()
+          .GetBlockNum() + 1,
       FULL_DATASET_MINE);
 }
 
@@ -472,6 +658,10 @@ bool Node::StartRetrieveHistory(const SyncType syncType,
       break;
     }
   }
+  {
+    lock_guard<mutex> g(m_mediator.m_mutexDSCommittee);
+    m_mediator.PublishDSCommittee();
+  }
 
   bytes metaRes;
   if (BlockStorage::GetBlockStorage().GetMetadata(MetaType::WAKEUPFORUPGRADE,
@@ -561,7 +751,9 @@ bool Node::StartRetrieveHistory(const SyncType syncType,
 
       do {
         m_mediator.m_lookup->GetStateDeltaFromSeedNodes(
-            m_mediator.m_txBlockChain.GetLastBlock().GetHeader().GetBlockNum());
+            m_mediator.m_txBlockChain.GetLastBlockPtr()
+                ->GetHeader()
+                .GetBlockNum());
         LOG_GENERAL(INFO,
                     "Retrieve final block state delta from lookup node, please "
                     "wait...");
@@ -582,10 +774,12 @@ bool Node::StartRetrieveHistory(const SyncType syncType,
   if (!LOOKUP_NODE_MODE && !wakeupForUpgrade &&
       SyncType::NO_SYNC == m_mediator.m_lookup->GetSyncType() &&
       SyncType::RECOVERY_ALL_SYNC != syncType &&
-      (m_mediator.m_txBlockChain.GetLastBlock().GetHeader().GetBlockNum() <
+      (m_mediator.m_txBlockChain.GetLastBlockPtr()->GetHeader().GetBlockNum() <
            NUM_FINAL_BLOCK_PER_POW ||
        m_mediator.GetIsVacuousEpoch(
-           m_mediator.m_txBlockChain.GetLastBlock().GetHeader().GetBlockNum() +
+           m_mediator.m_txBlockChain.GetLastBlockPtr()
+               ->GetHeader()
+               .GetBlockNum() +
            1))) {
     LOG_GENERAL(WARNING,
                 "Node recovery with vacuous epoch or in first DS epoch, apply "
@@ -596,24 +790,26 @@ bool Node::StartRetrieveHistory(const SyncType syncType,
   /// Save coin base for final block, from last DS epoch to current TX epoch
   if (bDS && !(RECOVERY_TRIM_INCOMPLETED_BLOCK &&
                SyncType::RECOVERY_ALL_SYNC == syncType)) {
-    for (uint64_t blockNum = m_mediator.m_dsBlockChain.GetLastBlock()
-                                 .GetHeader()
+    for (uint64_t blockNum = m_mediator.m_dsBlockChain.GetLastBlockPtr()
+                                 ->GetHeader()
                                  .GetEpochNum() +
                              1;
          blockNum <=
-         m_mediator.m_txBlockChain.GetLastBlock().GetHeader().GetBlockNum();
+         m_mediator.m_txBlockChain.GetLastBlockPtr()->GetHeader().GetBlockNum();
          ++blockNum) {
       LOG_GENERAL(INFO, "Update coin base for finalblock with blockNum: "
                             << blockNum << ", reward: "
-                            << m_mediator.m_txBlockChain.GetBlock(blockNum)
-                                   .GetHeader()
+                            << m_mediator.m_txBlockChain.GetBlockPtr(blockNum)
+                                   ->GetHeader()
                                    .GetRewards());
       m_mediator.m_ds->SaveCoinbase(
-          m_mediator.m_txBlockChain.GetBlock(blockNum).GetB1(),
-          m_mediator.m_txBlockChain.GetBlock(blockNum).GetB2(),
+          m_mediator.m_txBlockChain.GetBlockPtr(blockNum)->GetB1(),
+          m_mediator.m_txBlockChain.GetBlockPtr(blockNum)->GetB2(),
           CoinbaseReward::FINALBLOCK_REWARD, blockNum + 1);
-      m_mediator.m_ds->m_totalTxnFees +=
-          m_mediator.m_txBlockChain.GetBlock(blockNum).GetHeader().GetRewards();
+      m_mediator.m_ds->m_totalTxnFees += m_mediator.m_txBlockChain
+                                             .GetBlockPtr(blockNum)
+                                             ->GetHeader()
+                                             .GetRewards();
     }
   }
 
@@ -636,6 +832,11 @@ bool Node::StartRetrieveHistory(const SyncType syncType,
       }
     }
 
+    {
+      lock_guard<mutex> g(m_mediator.m_ds->m_mutexShards);
+      m_mediator.m_ds->PublishShards();
+    }
+
     bool bInShardStructure = false;
 
     if (bDS) {
@@ -677,11 +878,15 @@ bool Node::StartRetrieveHistory(const SyncType syncType,
   /// Save coin base for micro block, from last DS epoch to current TX epoch
   if (bDS && !(RECOVERY_TRIM_INCOMPLETED_BLOCK &&
                SyncType::RECOVERY_ALL_SYNC == syncType)) {
-    std::list<MicroBlockSharedPtr> microBlocks;
+    std::vector<MicroBlockSharedPtr> microBlocks;
     if (BlockStorage::GetBlockStorage().GetRangeMicroBlocks(
-            m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetEpochNum() +
+            m_mediator.m_dsBlockChain.GetLastBlockPtr()
+                ->GetHeader()
+                .GetEpochNum() +
                 1,
-            m_mediator.m_txBlockChain.GetLastBlock().GetHeader().GetBlockNum() +
+            m_mediator.m_txBlockChain.GetLastBlockPtr()
+                ->GetHeader()
+                .GetBlockNum() +
                 1,
             0, m_mediator.m_ds->m_shards.size(), microBlocks)) {
       for (const auto& microBlock : microBlocks) {
@@ -747,8 +952,8 @@ void Node::WakeupAtDSEpoch() {
   if (DirectoryService::IDLE != m_mediator.m_ds->m_mode) {
     SetState(POW_SUBMISSION);
     LOG_EPOCH(INFO, m_mediator.m_currentEpochNum,
-              "START OF EPOCH " << m_mediator.m_dsBlockChain.GetLastBlock()
-                                           .GetHeader()
+              "START OF EPOCH " << m_mediator.m_dsBlockChain.GetLastBlockPtr()
+                                           ->GetHeader()
                                            .GetBlockNum() +
                                        1);
     if (BROADCAST_GOSSIP_MODE) {
@@ -768,10 +973,9 @@ void Node::WakeupAtDSEpoch() {
         this_thread::sleep_for(chrono::seconds(POW_WINDOW_IN_SECONDS));
 
         // create and send POW submission packets
-        auto func2 = [this]() mutable -> void {
+        AsyncExecutor::GetInstance().Post([this]() {
           m_mediator.m_ds->ProcessAndSendPoWPacketSubmissionToOtherDSComm();
-        };
-        DetachedFunction(1, func2);
+        });
 
         LOG_EPOCH(INFO, m_mediator.m_currentEpochNum,
                   "Waiting "
@@ -803,11 +1007,15 @@ void Node::WakeupAtDSEpoch() {
                         << m_mediator.m_selfPeer.GetPrintableIPAddress() << ":"
                         << m_mediator.m_selfPeer.m_listenPortHost);
   uint64_t block_num =
-      m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetBlockNum() + 1;
+      m_mediator.m_dsBlockChain.GetLastBlockPtr()
+          ->GetHeader()
+          .GetBlockNum() + 1;
   uint8_t dsDifficulty =
-      m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetDSDifficulty();
+      m_mediator.m_dsBlockChain.GetLastBlockPtr()
+          ->GetHeader()
+          .GetDSDifficulty();
   uint8_t difficulty =
-      m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetDifficulty();
+      m_mediator.m_dsBlockChain.GetLastBlockPtr()->GetHeader().GetDifficulty();
   SetState(POW_SUBMISSION);
 
   auto func = [this, block_num, dsDifficulty, difficulty]() mutable -> void {
@@ -833,11 +1041,13 @@ void Node::WakeupAtTxEpoch() {
   lock_guard<mutex> g(m_mutexShardMember);
   if (DirectoryService::IDLE != m_mediator.m_ds->m_mode) {
     m_myShardMembers = m_mediator.m_DSCommittee;
+    InvalidateBroadcastLists();
   }
 
   m_consensusLeaderID =
       DataConversion::charArrTo16Bits(
-          m_mediator.m_txBlockChain.GetLastBlock().GetBlockHash().asBytes()) %
+          m_mediator.m_txBlockChain.GetLastBlockPtr()
+              ->GetBlockHash().asBytes()) %
       m_myShardMembers->size();
 
   if (DirectoryService::IDLE != m_mediator.m_ds->m_mode) {
@@ -922,7 +1132,9 @@ void Node::StartSynchronization() {
       m_synchronizer.FetchLatestTxBlockSeed(
           m_mediator.m_lookup,
           // m_mediator.m_txBlockChain.GetBlockCount());
-          m_mediator.m_txBlockChain.GetLastBlock().GetHeader().GetBlockNum() +
+          m_mediator.m_txBlockChain.GetLastBlockPtr()
+              ->GetHeader()
+              .GetBlockNum() +
               1);
       this_thread::sleep_for(chrono::seconds(m_mediator.m_lookup->m_startedPoW
                                                  ? POW_WINDOW_IN_SECONDS
@@ -1127,15 +1339,179 @@ bool Node::ProcessSubmitMissingTxn(const bytes& message, unsigned int offset,
     return false;
   }
 
-  lock_guard<mutex> g(m_mutexCreatedTransactions);
-  for (const auto& submittedTxn : txns) {
-    m_createdTxns.insert(submittedTxn);
+  lock_guard<ProfiledMutex> g(m_mutexCreatedTransactions);
+  for (auto& submittedTxn : txns) {
+    m_createdTxns.insert(move(submittedTxn));
   }
 
   cv_MicroBlockMissingTxn.notify_all();
   return true;
 }
 
+bool Node::ProcessTxnPoolSummary(const bytes& message, unsigned int offset,
+                                 [[gnu::unused]] const Peer& from) {
+  if (LOOKUP_NODE_MODE) {
+    LOG_GENERAL(WARNING,
+                "Node::ProcessTxnPoolSummary not expected to be called "
+                "from LookUp node.");
+    return true;
+  }
+
+  vector<uint64_t> shortHashes;
+  uint64_t epochNum = 0;
+  uint32_t portNo = 0;
+
+  if (!Messenger::GetNodeTxnPoolShortHashes(message, offset, shortHashes,
+                                            epochNum, portNo)) {
+    LOG_GENERAL(WARNING, "Messenger::GetNodeTxnPoolShortHashes failed.");
+    return false;
+  }
+
+  if (epochNum != m_mediator.m_currentEpochNum) {
+    LOG_EPOCH(INFO, m_mediator.m_currentEpochNum,
+              "untimely delivery of txn pool summary. received: "
+                  << epochNum << " , local: " << m_mediator.m_currentEpochNum);
+    return false;
+  }
+
+  if (m_isPrimary) {
+    return true;
+  }
+
+  vector<uint64_t> missingShortHashes;
+  {
+    lock_guard<ProfiledMutex> g(m_mutexCreatedTransactions);
+    const vector<uint64_t> ownShortHashes = m_createdTxns.shortHashes();
+    const unordered_set<uint64_t> own(ownShortHashes.begin(),
+                                      ownShortHashes.end());
+    for (const auto& shortHash : shortHashes) {
+      if (own.find(shortHash) == own.end()) {
+        missingShortHashes.emplace_back(shortHash);
+      }
+    }
+  }
+
+  LOG_EPOCH(INFO, m_mediator.m_currentEpochNum,
+            "Leader pools " << shortHashes.size() << " txns, missing "
+                            << missingShortHashes.size());
+
+  if (missingShortHashes.empty()) {
+    return true;
+  }
+
+  Peer leader;
+  {
+    lock_guard<mutex> g(m_mutexShardMember);
+    if (m_consensusLeaderID >= m_myShardMembers->size()) {
+      LOG_GENERAL(WARNING, "Unknown shard leader " << m_consensusLeaderID);
+      return false;
+    }
+    leader = m_myShardMembers->at(m_consensusLeaderID).second;
+  }
+
+  bytes request = {MessageType::NODE, NodeInstructionType::GETTXNPOOLBODIES};
+  if (!Messenger::SetNodeTxnPoolShortHashes(
+          request, MessageOffset::BODY, missingShortHashes, epochNum,
+          m_mediator.m_selfPeer.m_listenPortHost)) {
+    LOG_GENERAL(WARNING, "Messenger::SetNodeTxnPoolShortHashes failed.");
+    return false;
+  }
+
+  P2PComm::GetInstance().SendMessage(leader, request);
+
+  return true;
+}
+
+bool Node::ProcessGetTxnPoolBodies(const bytes& message, unsigned int offset,
+                                   const Peer& from) {
+  if (LOOKUP_NODE_MODE) {
+    LOG_GENERAL(WARNING,
+                "Node::ProcessGetTxnPoolBodies not expected to be called "
+                "from LookUp node.");
+    return true;
+  }
+
+  vector<uint64_t> shortHashes;
+  uint64_t epochNum = 0;
+  uint32_t portNo = 0;
+
+  if (!Messenger::GetNodeTxnPoolShortHashes(message, offset, shortHashes,
+                                            epochNum, portNo)) {
+    LOG_GENERAL(WARNING, "Messenger::GetNodeTxnPoolShortHashes failed.");
+    return false;
+  }
+
+  if (!m_isPrimary || epochNum != m_mediator.m_currentEpochNum) {
+    LOG_EPOCH(INFO, m_mediator.m_currentEpochNum,
+              "Not serving txn pool bodies for epoch " << epochNum);
+    return false;
+  }
+
+  vector<Transaction> txns;
+  {
+    lock_guard<ProfiledMutex> g(m_mutexCreatedTransactions);
+    m_createdTxns.getByShortHashes(
+        unordered_set<uint64_t>(shortHashes.begin(), shortHashes.end()), txns);
+  }
+
+  LOG_EPOCH(INFO, m_mediator.m_currentEpochNum,
+            "Sending " << txns.size() << " of " << shortHashes.size()
+                       << " requested pool txns to " << from);
+
+  if (txns.empty()) {
+    return true;
+  }
+
+  return SendMissingTxns(Peer(from.m_ipAddress, portNo), epochNum, txns);
+}
+
+bool Node::ProcessGetUpgradeChunk(const bytes& message, unsigned int offset,
+                                  const Peer& from) {
+  bytes sha;
+  uint32_t index = 0;
+  uint32_t portNo = 0;
+
+  if (!Messenger::GetNodeGetUpgradeChunk(message, offset, sha, index,
+                                         portNo)) {
+    LOG_GENERAL(WARNING, "Messenger::GetNodeGetUpgradeChunk failed.");
+    return false;
+  }
+
+  uint64_t size = 0;
+  bytes chunk;
+  if (!UpgradeManager::GetInstance().GetPackageChunk(sha, index, size,
+                                                     chunk)) {
+    LOG_GENERAL(INFO, "No upgrade chunk " << index << " to send to " << from);
+    return false;
+  }
+
+  bytes reply = {MessageType::NODE, NodeInstructionType::UPGRADECHUNK};
+  if (!Messenger::SetNodeUpgradeChunk(reply, MessageOffset::BODY, sha, size,
+                                      index, chunk)) {
+    LOG_GENERAL(WARNING, "Messenger::SetNodeUpgradeChunk failed.");
+    return false;
+  }
+
+  P2PComm::GetInstance().SendMessage(Peer(from.m_ipAddress, portNo), reply);
+  return true;
+}
+
+bool Node::ProcessUpgradeChunk(const bytes& message, unsigned int offset,
+                               [[gnu::unused]] const Peer& from) {
+  bytes sha, chunk;
+  uint64_t size = 0;
+  uint32_t index = 0;
+
+  if (!Messenger::GetNodeUpgradeChunk(message, offset, sha, size, index,
+                                      chunk)) {
+    LOG_GENERAL(WARNING, "Messenger::GetNodeUpgradeChunk failed.");
+    return false;
+  }
+
+  UpgradeManager::GetInstance().OnPackageChunk(sha, size, index, chunk);
+  return true;
+}
+
 bool Node::ProcessSubmitTransaction(const bytes& message, unsigned int offset,
                                     [[gnu::unused]] const Peer& from) {
   if (LOOKUP_NODE_MODE) {
@@ -1201,13 +1577,13 @@ bool Node::ProcessTxnPacketFromLookup([[gnu::unused]] const bytes& message,
   uint64_t epochNumber = 0, dsBlockNum = 0;
   uint32_t shardId = 0;
   PubKey lookupPubKey;
-  vector<Transaction> transactions;
 
-  if (!Messenger::GetNodeForwardTxnBlock(message, offset, epochNumber,
-                                         dsBlockNum, shardId, lookupPubKey,
-                                         transactions)) {
+  // Only the header for now; the txns are decoded in batches once the packet
+  // is accepted, and a buffered packet stays in its serialized form
+  if (!Messenger::GetNodeForwardTxnBlockHeader(
+          message, offset, epochNumber, dsBlockNum, shardId, lookupPubKey)) {
     LOG_EPOCH(WARNING, m_mediator.m_currentEpochNum,
-              "Messenger::GetNodeForwardTxnBlock failed.");
+              "Messenger::GetNodeForwardTxnBlockHeader failed.");
     return false;
   }
 
@@ -1240,7 +1616,9 @@ bool Node::ProcessTxnPacketFromLookup([[gnu::unused]] const bytes& message,
           m_justDidFallback) &&
          (m_mediator.m_consensusID != 0)) ||
         ((m_mediator.m_currentEpochNum == 1) &&
-         ((m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetBlockNum() ==
+         ((m_mediator.m_dsBlockChain.GetLastBlockPtr()
+             ->GetHeader()
+             .GetBlockNum() ==
            0) ||
           m_justDidFallback))) {
       lock_guard<mutex> g2(m_mutexTxnPacketBuffer);
@@ -1255,6 +1633,17 @@ bool Node::ProcessTxnPacketFromLookup([[gnu::unused]] const bytes& message,
       LOG_GENERAL(WARNING, "Txn packet from older epoch, discard");
       return false;
     }
+
+    // Lookups stream txns through the distribution window, so take them in
+    // right away, as the gossip path does, rather than in the next round
+    if (epochNumber == m_mediator.m_currentEpochNum &&
+        (m_state == MICROBLOCK_CONSENSUS_PREP ||
+         m_state == MICROBLOCK_CONSENSUS)) {
+      LOG_GENERAL(INFO, "Received txn from lookup in distribution window");
+      return ProcessTxnPacketFromLookupCore(message, offset, epochNumber,
+                                            dsBlockNum, shardId, lookupPubKey);
+    }
+
     lock_guard<mutex> g(m_mutexTxnPacketBuffer);
     LOG_GENERAL(INFO, "Received txn from lookup, stored to buffer");
     LOG_STATE("[TXNPKTPROC]["
@@ -1268,19 +1657,19 @@ bool Node::ProcessTxnPacketFromLookup([[gnu::unused]] const bytes& message,
     LOG_GENERAL(INFO,
                 "Packet received from a non-lookup node, "
                 "should be from gossip neighbor and process it");
-    return ProcessTxnPacketFromLookupCore(message, epochNumber, dsBlockNum,
-                                          shardId, lookupPubKey, transactions);
+    return ProcessTxnPacketFromLookupCore(message, offset, epochNumber,
+                                          dsBlockNum, shardId, lookupPubKey);
   }
 
   return true;
 }
 
 bool Node::ProcessTxnPacketFromLookupCore(const bytes& message,
+                                          unsigned int offset,
                                           const uint64_t& epochNum,
                                           const uint64_t& dsBlockNum,
                                           const uint32_t& shardId,
-                                          const PubKey& lookupPubKey,
-                                          const vector<Transaction>& txns) {
+                                          const PubKey& lookupPubKey) {
   LOG_MARKER();
 
   if (LOOKUP_NODE_MODE) {
@@ -1303,11 +1692,11 @@ bool Node::ProcessTxnPacketFromLookupCore(const bytes& message,
   }
 
   if (dsBlockNum !=
-      m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetBlockNum()) {
+      m_mediator.m_dsBlockChain.GetLastBlockPtr()->GetHeader().GetBlockNum()) {
     LOG_GENERAL(WARNING, "Wrong DS block num ("
                              << dsBlockNum << "), expected ("
-                             << m_mediator.m_dsBlockChain.GetLastBlock()
-                                    .GetHeader()
+                             << m_mediator.m_dsBlockChain.GetLastBlockPtr()
+                                    ->GetHeader()
                                     .GetBlockNum()
                              << ")");
     return false;
@@ -1319,6 +1708,12 @@ bool Node::ProcessTxnPacketFromLookupCore(const bytes& message,
     return false;
   }
 
+  if (!Messenger::VerifyNodeForwardTxnBlock(message, offset, lookupPubKey)) {
+    LOG_EPOCH(WARNING, m_mediator.m_currentEpochNum,
+              "Messenger::VerifyNodeForwardTxnBlock failed.");
+    return false;
+  }
+
   if (BROADCAST_GOSSIP_MODE) {
     LOG_STATE("[TXNPKTPROC-CORE]["
               << std::setw(15) << std::left
@@ -1342,16 +1737,11 @@ bool Node::ProcessTxnPacketFromLookupCore(const bytes& message,
                 << "] BEGN");
     }
   } else {
-    vector<Peer> toSend;
-    {
-      lock_guard<mutex> g(m_mutexShardMember);
-      for (auto& it : *m_myShardMembers) {
-        toSend.push_back(it.second);
-      }
-    }
     LOG_GENERAL(INFO, "[Batching] Broadcast my txns to other shard members");
 
-    P2PComm::GetInstance().SendBroadcastMessage(toSend, message);
+    lock_guard<mutex> g(m_mutexShardMember);
+    P2PComm::GetInstance().SendBroadcastMessage(GetBroadcastLists().m_others,
+                                                message);
   }
 
 #ifdef DM_TEST_DM_LESSTXN_ONE
@@ -1380,14 +1770,70 @@ bool Node::ProcessTxnPacketFromLookupCore(const bytes& message,
   }
 #endif  // DM_TEST_DM_LESSTXN_ALL
 
-  // Process the txns
+  // Process the txns, each batch reaching the pool before the next one is
+  // decoded
+  unsigned int processed_count = 0;
+  if (!Messenger::GetNodeForwardTxnBlockTransactions(
+          message, offset, TXN_PACKET_DECODE_BATCH_SIZE,
+          [this, &processed_count](vector<Transaction>& txns) {
+            processed_count += txns.size();
+            AddTxnsFromLookup(txns);
+          })) {
+    LOG_EPOCH(WARNING, m_mediator.m_currentEpochNum,
+              "Messenger::GetNodeForwardTxnBlockTransactions failed after "
+                  << processed_count << " txns");
+    return false;
+  }
+
+  LOG_STATE("[TXNPKTPROC][" << std::setw(15) << std::left
+                            << m_mediator.m_selfPeer.GetPrintableIPAddress()
+                            << "][" << m_mediator.m_currentEpochNum << "]["
+                            << shardId << "]["
+                            << string(lookupPubKey).substr(0, 6) << "] DONE ["
+                            << processed_count << "]");
+  return true;
+}
+
+unsigned int Node::AddTxnsFromLookup(const vector<Transaction>& txns) {
   unsigned int processed_count = 0;
 
   LOG_GENERAL(INFO, "Start check txn packet from lookup");
 
+  // Drop what the pool would refuse anyway before paying for signatures
+  vector<bool> admitted(txns.size());
+  unsigned int numAdmitted = 0;
+  {
+    lock_guard<ProfiledMutex> g(m_mutexCreatedTransactions);
+    for (unsigned int i = 0; i < txns.size(); i++) {
+      admitted[i] = m_createdTxns.admit(txns[i]);
+      numAdmitted += admitted[i] ? 1 : 0;
+    }
+  }
+  vector<Transaction> admittedTxns;
+  if (numAdmitted < txns.size()) {
+    LOG_GENERAL(INFO, "TxnPool refuses " << txns.size() - numAdmitted
+                                         << " txns of the packet");
+    admittedTxns.reserve(numAdmitted);
+    for (unsigned int i = 0; i < txns.size(); i++) {
+      if (admitted[i]) {
+        admittedTxns.emplace_back(txns[i]);
+      }
+    }
+  }
+  const auto& toCheck = numAdmitted < txns.size() ? admittedTxns : txns;
+
+  // Check all signatures of the packet in one batch
+  vector<bool> signatureValid;
+  m_mediator.m_validator->VerifyTransactions(toCheck, signatureValid);
+
   std::vector<Transaction> checkedTxns;
-  for (const auto& txn : txns) {
-    if (m_mediator.m_validator->CheckCreatedTransactionFromLookup(txn)) {
+  for (unsigned int i = 0; i < toCheck.size(); i++) {
+    const auto& txn = toCheck.at(i);
+    if (!signatureValid.at(i)) {
+      LOG_GENERAL(WARNING, "Signature incorrect. Transaction rejected: "
+                               << txn.GetTranID());
+    } else if (m_mediator.m_validator->CheckCreatedTransactionFromLookup(
+                   txn, false)) {
       checkedTxns.push_back(txn);
     } else {
       LOG_GENERAL(WARNING, "Txn is not valid.");
@@ -1401,12 +1847,12 @@ bool Node::ProcessTxnPacketFromLookupCore(const bytes& message,
   }
 
   {
-    lock_guard<mutex> g(m_mutexCreatedTransactions);
+    lock_guard<ProfiledMutex> g(m_mutexCreatedTransactions);
     LOG_GENERAL(INFO,
                 "TxnPool size before processing: " << m_createdTxns.size());
 
-    for (const auto& txn : checkedTxns) {
-      m_createdTxns.insert(txn);
+    for (auto& txn : checkedTxns) {
+      m_createdTxns.insert(move(txn));
     }
 
     LOG_GENERAL(INFO, "Txn processed: " << processed_count
@@ -1414,13 +1860,7 @@ bool Node::ProcessTxnPacketFromLookupCore(const bytes& message,
                                         << m_createdTxns.size());
   }
 
-  LOG_STATE("[TXNPKTPROC][" << std::setw(15) << std::left
-                            << m_mediator.m_selfPeer.GetPrintableIPAddress()
-                            << "][" << m_mediator.m_currentEpochNum << "]["
-                            << shardId << "]["
-                            << string(lookupPubKey).substr(0, 6) << "] DONE ["
-                            << processed_count << "]");
-  return true;
+  return checkedTxns.size();
 }
 
 bool Node::ProcessProposeGasPrice([[gnu::unused]] const bytes& message,
@@ -1477,18 +1917,17 @@ void Node::CommitTxnPacketBuffer() {
     uint64_t epochNumber = 0, dsBlockNum = 0;
     uint32_t shardId = 0;
     PubKey lookupPubKey;
-    vector<Transaction> transactions;
 
-    if (!Messenger::GetNodeForwardTxnBlock(message, MessageOffset::BODY,
-                                           epochNumber, dsBlockNum, shardId,
-                                           lookupPubKey, transactions)) {
+    if (!Messenger::GetNodeForwardTxnBlockHeader(message, MessageOffset::BODY,
+                                                 epochNumber, dsBlockNum,
+                                                 shardId, lookupPubKey)) {
       LOG_EPOCH(WARNING, m_mediator.m_currentEpochNum,
-                "Messenger::GetNodeForwardTxnBlock failed.");
+                "Messenger::GetNodeForwardTxnBlockHeader failed.");
       return;
     }
 
-    ProcessTxnPacketFromLookupCore(message, epochNumber, dsBlockNum, shardId,
-                                   lookupPubKey, transactions);
+    ProcessTxnPacketFromLookupCore(message, MessageOffset::BODY, epochNumber,
+                                   dsBlockNum, shardId, lookupPubKey);
   }
   m_txnPacketBuffer.clear();
 }
@@ -1522,6 +1961,24 @@ void Node::CommitTxnPacketBuffer() {
 
 void Node::SetState(NodeState state) {
   m_state = state;
+
+  switch (state) {
+    case POW_SUBMISSION:
+      m_epochPhaseTimer.Enter(EPOCH_PHASE_POW);
+      break;
+    case MICROBLOCK_CONSENSUS_PREP:
+    case MICROBLOCK_CONSENSUS:
+      m_epochPhaseTimer.Enter(EPOCH_PHASE_MICROBLOCK_CONSENSUS);
+      break;
+    case FALLBACK_CONSENSUS_PREP:
+    case FALLBACK_CONSENSUS:
+      m_epochPhaseTimer.Enter(EPOCH_PHASE_FALLBACK);
+      break;
+    default:
+      m_epochPhaseTimer.Enter(EPOCH_PHASE_NONE);
+      break;
+  }
+
   LOG_EPOCH(INFO, m_mediator.m_currentEpochNum,
             "Node State is now " << GetStateString() << " at epoch "
                                  << m_mediator.m_currentEpochNum);
@@ -1595,6 +2052,7 @@ bool Node::CleanVariables() {
   {
     lock_guard<mutex> g(m_mutexShardMember);
     m_myShardMembers.reset(new deque<pair<PubKey, Peer>>);
+    InvalidateBroadcastLists();
   }
   m_isPrimary = false;
   m_stillMiningPrimary = false;
@@ -1649,9 +2107,8 @@ void Node::SetMyshardId(uint32_t shardId) {
 void Node::CleanCreatedTransaction() {
   LOG_MARKER();
   {
-    std::lock_guard<mutex> g(m_mutexCreatedTransactions);
+    std::lock_guard<ProfiledMutex> g(m_mutexCreatedTransactions);
     m_createdTxns.clear();
-    t_createdTxns.clear();
   }
   {
     std::lock_guard<mutex> g(m_mutexTxnPacketBuffer);
@@ -1667,6 +2124,11 @@ void Node::CleanCreatedTransaction() {
   m_txnFees = 0;
 }
 
+MemoryUsage Node::GetCreatedTxnsMemoryUsage() {
+  lock_guard<ProfiledMutex> g(m_mutexCreatedTransactions);
+  return m_createdTxns.memoryUsage();
+}
+
 bool Node::IsShardNode(const PubKey& pubKey) {
   lock_guard<mutex> lock(m_mutexShardMember);
   return std::find_if(m_myShardMembers->begin(), m_myShardMembers->end(),
@@ -1750,7 +2212,7 @@ void Node::QueryLookupForDSGuardNetworkInfoUpdate() {
       MessageType::LOOKUP,
       LookupInstructionType::GETGUARDNODENETWORKINFOUPDATE};
   uint64_t dsEpochNum =
-      m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetBlockNum();
+      m_mediator.m_dsBlockChain.GetLastBlockPtr()->GetHeader().GetBlockNum();
 
   LOG_GENERAL(INFO,
               "Querying the lookup for any ds guard node network info change "
@@ -1831,6 +2293,7 @@ bool Node::ProcessDSGuardNetworkInfoUpdate(const bytes& message,
                             << " new network info is "
                             << dsguardupdate.m_dsGuardNewNetworkInfo)
     }
+    m_mediator.PublishDSCommittee();
   }
 
   m_requestedForDSGuardNetworkInfoUpdate = false;
@@ -1849,12 +2312,14 @@ bool Node::ToBlockMessage([[gnu::unused]] unsigned char ins_byte) {
       }
       if (!m_fromNewProcess) {
         if (ins_byte != NodeInstructionType::DSBLOCK &&
-            ins_byte != NodeInstructionType::FORWARDTXNPACKET) {
+            ins_byte != NodeInstructionType::FORWARDTXNPACKET &&
+            ins_byte != NodeInstructionType::BLOCKCHUNK) {
           return true;
         }
       } else {
         if (m_runFromLate && ins_byte != NodeInstructionType::DSBLOCK &&
-            ins_byte != NodeInstructionType::FORWARDTXNPACKET) {
+            ins_byte != NodeInstructionType::FORWARDTXNPACKET &&
+            ins_byte != NodeInstructionType::BLOCKCHUNK) {
           return true;
         }
       }
@@ -1867,8 +2332,8 @@ bool Node::ToBlockMessage([[gnu::unused]] unsigned char ins_byte) {
 }
 
 void Node::GetNodesToBroadCastUsingTreeBasedClustering(
-    uint32_t cluster_size, uint32_t num_of_child_clusters, uint32_t& nodes_lo,
-    uint32_t& nodes_hi) {
+    uint32_t cluster_size, uint32_t num_of_child_clusters,
+    vector<uint32_t>& receivers) {
   // make sure cluster_size is with-in the valid range
   cluster_size = std::max(cluster_size, MIN_CLUSTER_SIZE);
   cluster_size = std::min(cluster_size, (uint32_t)m_myShardMembers->size());
@@ -1882,6 +2347,27 @@ void Node::GetNodesToBroadCastUsingTreeBasedClustering(
   num_of_child_clusters =
       std::min(num_of_child_clusters, num_of_total_clusters - 1);
 
+  receivers.clear();
+
+  if (BROADCAST_TREE_BY_NETWORK_PREFIX) {
+    LOG_GENERAL(INFO, "cluster_size :"
+                          << cluster_size << ", num_of_child_clusters : "
+                          << num_of_child_clusters
+                          << ", num_of_total_clusters : "
+                          << num_of_total_clusters << ", by network prefix");
+
+    vector<uint128_t> ips;
+    ips.reserve(m_myShardMembers->size());
+    for (const auto& kv : *m_myShardMembers) {
+      ips.emplace_back(std::get<SHARD_NODE_PEER>(kv).m_ipAddress);
+    }
+    if (num_of_child_clusters > 0) {
+      receivers = BroadcastTree::GetReceivers(
+          ips, m_consensusMyID, cluster_size, num_of_child_clusters);
+    }
+    return;
+  }
+
   uint32_t my_cluster_num = m_consensusMyID / cluster_size;
 
   LOG_GENERAL(INFO, "cluster_size :"
@@ -1890,9 +2376,65 @@ void Node::GetNodesToBroadCastUsingTreeBasedClustering(
                         << ", num_of_total_clusters : " << num_of_total_clusters
                         << ", my_cluster_num : " << my_cluster_num);
 
-  nodes_lo = (my_cluster_num * num_of_child_clusters + 1) * cluster_size;
-  nodes_hi =
+  const uint32_t nodes_lo =
+      (my_cluster_num * num_of_child_clusters + 1) * cluster_size;
+  uint32_t nodes_hi =
       ((my_cluster_num + 1) * num_of_child_clusters + 1) * cluster_size - 1;
+  if (nodes_lo >= m_myShardMembers->size()) {
+    return;
+  }
+
+  // set to max valid node index, if upperbound is invalid.
+  nodes_hi = std::min(nodes_hi, (uint32_t)m_myShardMembers->size() - 1);
+  for (uint32_t i = nodes_lo; i <= nodes_hi; i++) {
+    receivers.emplace_back(i);
+  }
+}
+
+void Node::InvalidateBroadcastLists() { m_broadcastLists.m_valid = false; }
+
+Node::BroadcastLists& Node::GetBroadcastLists() {
+  BroadcastLists& lists = m_broadcastLists;
+  if (lists.m_valid && lists.m_numMembers == m_myShardMembers->size() &&
+      lists.m_myID == m_consensusMyID) {
+    return lists;
+  }
+
+  lists.m_numMembers = m_myShardMembers->size();
+  lists.m_myID = m_consensusMyID;
+  lists.m_others.clear();
+  lists.m_others.reserve(lists.m_numMembers);
+  for (uint32_t i = 0; i < lists.m_numMembers; i++) {
+    if (i != lists.m_myID) {
+      lists.m_others.emplace_back(
+          std::get<SHARD_NODE_PEER>(m_myShardMembers->at(i)));
+    }
+  }
+  lists.m_treeReceivers.clear();
+  lists.m_valid = true;
+  return lists;
+}
+
+const pair<vector<uint32_t>, vector<Peer>>& Node::GetTreeReceivers(
+    uint32_t cluster_size, uint32_t num_of_child_clusters) {
+  BroadcastLists& lists = GetBroadcastLists();
+
+  const auto key = make_pair(cluster_size, num_of_child_clusters);
+  auto it = lists.m_treeReceivers.find(key);
+  if (it != lists.m_treeReceivers.end()) {
+    return it->second;
+  }
+
+  auto& entry = lists.m_treeReceivers[key];
+  GetNodesToBroadCastUsingTreeBasedClustering(cluster_size,
+                                              num_of_child_clusters,
+                                              entry.first);
+  entry.second.reserve(entry.first.size());
+  for (const auto i : entry.first) {
+    entry.second.emplace_back(
+        std::get<SHARD_NODE_PEER>(m_myShardMembers->at(i)));
+  }
+  return entry;
 }
 
 // Tree-Based Clustering decision
@@ -1903,7 +2445,11 @@ void Node::SendBlockToOtherShardNodes(const bytes& message,
                                       uint32_t num_of_child_clusters) {
   LOG_MARKER();
 
-  uint32_t nodes_lo, nodes_hi;
+  if (ERASURE_CODED_BROADCAST_MODE &&
+      message.size() >= ERASURE_CODED_MIN_MESSAGE_SIZE) {
+    SendBlockChunksToOtherShardNodes(message, cluster_size);
+    return;
+  }
 
   SHA2<HASH_TYPE::HASH_VARIANT_256> sha256;
   sha256.Update(message);  // raw_message hash
@@ -1911,16 +2457,17 @@ void Node::SendBlockToOtherShardNodes(const bytes& message,
 
   lock_guard<mutex> g(m_mutexShardMember);
 
-  GetNodesToBroadCastUsingTreeBasedClustering(
-      cluster_size, num_of_child_clusters, nodes_lo, nodes_hi);
+  // The tree only changes with my shard, so it is worked out once per shard
+  const auto& tree = GetTreeReceivers(cluster_size, num_of_child_clusters);
+  const auto& receivers = tree.first;
+  const auto& shardBlockReceivers = tree.second;
 
   string hashStr;
   if (!DataConversion::Uint8VecToHexStr(this_msg_hash, hashStr)) {
     return;
   }
 
-  std::vector<Peer> shardBlockReceivers;
-  if (nodes_lo >= m_myShardMembers->size()) {
+  if (receivers.empty()) {
     // I am at last level in tree.
     LOG_GENERAL(INFO,
                 "I am at last level in tree. And not supposed to broadcast "
@@ -1929,17 +2476,14 @@ void Node::SendBlockToOtherShardNodes(const bytes& message,
     return;
   }
 
-  // set to max valid node index, if upperbound is invalid.
-  nodes_hi = std::min(nodes_hi, (uint32_t)m_myShardMembers->size() - 1);
-
   LOG_GENERAL(INFO, "I am broadcasting message with hash: ["
                         << hashStr.substr(0, 6) << "] further to following "
-                        << nodes_hi - nodes_lo + 1 << " peers."
-                        << "(" << nodes_lo << "~" << nodes_hi << ")");
+                        << receivers.size() << " peers."
+                        << "(" << receivers.front() << "~" << receivers.back()
+                        << ")");
 
-  for (uint32_t i = nodes_lo; i <= nodes_hi; i++) {
+  for (const auto i : receivers) {
     const auto& kv = m_myShardMembers->at(i);
-    shardBlockReceivers.emplace_back(std::get<SHARD_NODE_PEER>(kv));
     LOG_EPOCH(INFO, m_mediator.m_currentEpochNum,
               " PubKey: " << std::get<SHARD_NODE_PUBKEY>(kv)
                           << " IP: " << std::get<SHARD_NODE_PEER>(kv));
@@ -1947,6 +2491,249 @@ void Node::SendBlockToOtherShardNodes(const bytes& message,
   P2PComm::GetInstance().SendBroadcastMessage(shardBlockReceivers, message);
 }
 
+Node::BlockChunks& Node::GetBlockChunks(const bytes& msgHash) {
+  auto it = m_blockChunks.find(msgHash);
+  if (it != m_blockChunks.end()) {
+    return it->second;
+  }
+
+  if (m_blockChunksOrder.size() >= MAX_BLOCK_CHUNK_SETS) {
+    m_blockChunks.erase(m_blockChunksOrder.front());
+    m_blockChunksOrder.pop_front();
+  }
+  m_blockChunksOrder.emplace_back(msgHash);
+  return m_blockChunks[msgHash];
+}
+
+// Erasure-coded alternative to the tree
+//  --  The nodes that got the block from the DS committee (the first cluster)
+//      encode it into one chunk per shard node, any k of which rebuild it.
+//  --  Chunk i goes to shard node i, which relays it to the whole shard.
+//  --  So each node forwards a chunk rather than the full block.
+void Node::SendBlockChunksToOtherShardNodes(const bytes& message,
+                                            uint32_t cluster_size) {
+  LOG_MARKER();
+
+  SHA2<HASH_TYPE::HASH_VARIANT_256> sha256;
+  sha256.Update(message);
+  const bytes msgHash = sha256.Finalize();
+
+  string hashStr;
+  if (!DataConversion::Uint8VecToHexStr(msgHash, hashStr)) {
+    return;
+  }
+
+  lock_guard<mutex> g(m_mutexShardMember);
+
+  const uint32_t shardSize = m_myShardMembers->size();
+  cluster_size = std::max(cluster_size, MIN_CLUSTER_SIZE);
+  cluster_size = std::min(cluster_size, shardSize);
+
+  if (m_consensusMyID >= cluster_size) {
+    LOG_GENERAL(INFO, "Chunks of message with hash: ["
+                          << hashStr.substr(0, 6)
+                          << "] are sent by the first cluster");
+    return;
+  }
+
+  const uint32_t totalChunks = std::min(shardSize, ErasureCode::MAX_CHUNKS);
+  const uint32_t dataChunks = std::min(
+      totalChunks,
+      std::max(1u, totalChunks * ERASURE_CODED_DATA_CHUNKS_PERCENT / 100));
+
+  vector<bytes> chunks;
+  if (!ErasureCode::Encode(message, dataChunks, totalChunks, chunks)) {
+    LOG_GENERAL(WARNING, "Failed to encode message with hash: ["
+                             << hashStr.substr(0, 6) << "]");
+    return;
+  }
+
+  {
+    lock_guard<mutex> g2(m_mutexBlockChunks);
+    BlockChunks& state = GetBlockChunks(msgHash);
+    state.m_chunks.clear();
+    state.m_relayed = true;
+    state.m_decoded = true;
+  }
+
+  // The first cluster splits the chunks between its nodes, and each of them
+  // relays its own chunk straight away
+  unsigned int numSent = 0;
+  for (uint32_t i = m_consensusMyID; i < totalChunks; i += cluster_size) {
+    const bool isMine = (i == m_consensusMyID);
+
+    bytes chunkMessage = {MessageType::NODE, NodeInstructionType::BLOCKCHUNK};
+    if (!Messenger::SetNodeBlockChunk(chunkMessage, MessageOffset::BODY,
+                                      msgHash, message.size(), dataChunks,
+                                      totalChunks, i, chunks.at(i), !isMine)) {
+      LOG_GENERAL(WARNING, "Messenger::SetNodeBlockChunk failed.");
+      return;
+    }
+
+    if (isMine) {
+      P2PComm::GetInstance().SendBroadcastMessage(GetBroadcastLists().m_others,
+                                                  chunkMessage);
+    } else {
+      P2PComm::GetInstance().SendMessage(
+          std::get<SHARD_NODE_PEER>(m_myShardMembers->at(i)), chunkMessage);
+    }
+    numSent++;
+  }
+
+  LOG_GENERAL(INFO, "I am sending message with hash: ["
+                        << hashStr.substr(0, 6) << "] as " << numSent
+                        << " of " << totalChunks << " chunks, " << dataChunks
+                        << " of which rebuild it");
+}
+
+bool Node::ProcessBlockChunk(const bytes& message, unsigned int offset,
+                             const Peer& from) {
+  LOG_MARKER();
+
+  if (LOOKUP_NODE_MODE) {
+    LOG_GENERAL(WARNING,
+                "Node::ProcessBlockChunk not expected to be called from "
+                "LookUp node.");
+    return true;
+  }
+
+  bytes msgHash, chunk;
+  uint64_t msgSize;
+  uint32_t dataChunks, totalChunks, index;
+  bool relay;
+
+  if (!Messenger::GetNodeBlockChunk(message, offset, msgHash, msgSize,
+                                    dataChunks, totalChunks, index, chunk,
+                                    relay)) {
+    LOG_EPOCH(WARNING, m_mediator.m_currentEpochNum,
+              "Messenger::GetNodeBlockChunk failed.");
+    return false;
+  }
+
+  if (msgHash.size() != BLOCK_HASH_SIZE ||
+      totalChunks > ErasureCode::MAX_CHUNKS || dataChunks == 0 ||
+      dataChunks > totalChunks || index >= totalChunks ||
+      chunk.size() != ErasureCode::GetChunkSize(msgSize, dataChunks)) {
+    LOG_GENERAL(WARNING, "Invalid block chunk " << index << "/" << totalChunks
+                                                << " from " << from);
+    return false;
+  }
+
+  if (relay && index != m_consensusMyID) {
+    LOG_GENERAL(WARNING, "Asked to relay chunk " << index << " from " << from
+                                                 << " but my ID is "
+                                                 << m_consensusMyID);
+    return false;
+  }
+
+  {
+    lock_guard<mutex> g(m_mutexShardMember);
+    if (std::none_of(m_myShardMembers->begin(), m_myShardMembers->end(),
+                     [&from](const PairOfNode& node) {
+                       return std::get<SHARD_NODE_PEER>(node) == from;
+                     })) {
+      LOG_GENERAL(WARNING, "Block chunk from " << from
+                                               << " who is not in my shard");
+      return false;
+    }
+  }
+
+  string hashStr;
+  if (!DataConversion::Uint8VecToHexStr(msgHash, hashStr)) {
+    return false;
+  }
+
+  bool toRelay = false;
+  bytes decoded;
+  {
+    lock_guard<mutex> g(m_mutexBlockChunks);
+    BlockChunks& state = GetBlockChunks(msgHash);
+
+    if (state.m_dataChunks == 0) {
+      state.m_msgSize = msgSize;
+      state.m_dataChunks = dataChunks;
+      state.m_totalChunks = totalChunks;
+    } else if (!state.m_decoded &&
+               (state.m_msgSize != msgSize ||
+                state.m_dataChunks != dataChunks ||
+                state.m_totalChunks != totalChunks)) {
+      LOG_GENERAL(WARNING, "Chunk " << index << " of message with hash: ["
+                                    << hashStr.substr(0, 6) << "] from "
+                                    << from << " does not match the others");
+      return false;
+    }
+
+    if (relay && !state.m_relayed) {
+      state.m_relayed = true;
+      toRelay = true;
+    }
+
+    if (!state.m_decoded) {
+      state.m_chunks.emplace(index, chunk);
+
+      if (state.m_chunks.size() >= state.m_dataChunks) {
+        SHA2<HASH_TYPE::HASH_VARIANT_256> sha256;
+        if (ErasureCode::Decode(state.m_chunks, dataChunks, totalChunks,
+                                msgSize, decoded)) {
+          sha256.Update(decoded);
+        }
+        if (!decoded.empty() && sha256.Finalize() == msgHash) {
+          state.m_decoded = true;
+        } else {
+          LOG_GENERAL(WARNING, "Chunks of message with hash: ["
+                                   << hashStr.substr(0, 6)
+                                   << "] do not rebuild it, dropping them");
+          decoded.clear();
+          state.m_dataChunks = 0;
+        }
+        state.m_chunks.clear();
+      }
+    }
+  }
+
+  if (toRelay) {
+    bytes relayMessage = {MessageType::NODE, NodeInstructionType::BLOCKCHUNK};
+    if (!Messenger::SetNodeBlockChunk(relayMessage, MessageOffset::BODY,
+                                      msgHash, msgSize, dataChunks,
+                                      totalChunks, index, chunk, false)) {
+      LOG_GENERAL(WARNING, "Messenger::SetNodeBlockChunk failed.");
+    } else {
+      std::vector<Peer> shardPeers;
+      {
+        lock_guard<mutex> g(m_mutexShardMember);
+        for (uint32_t j = 0; j < m_myShardMembers->size(); j++) {
+          const auto& peer = std::get<SHARD_NODE_PEER>(m_myShardMembers->at(j));
+          if (j != m_consensusMyID && !(peer == from)) {
+            shardPeers.emplace_back(peer);
+          }
+        }
+      }
+      P2PComm::GetInstance().SendBroadcastMessage(shardPeers, relayMessage);
+    }
+  }
+
+  if (decoded.empty()) {
+    return true;
+  }
+
+  // Only blocks that would otherwise go down the tree can come in as chunks
+  if (decoded.size() <= MessageOffset::INST ||
+      decoded.at(MessageOffset::TYPE) != MessageType::NODE ||
+      (decoded.at(MessageOffset::INST) != NodeInstructionType::DSBLOCK &&
+       decoded.at(MessageOffset::INST) != NodeInstructionType::VCBLOCK &&
+       decoded.at(MessageOffset::INST) != NodeInstructionType::FALLBACKBLOCK)) {
+    LOG_GENERAL(WARNING, "Unexpected message with hash: ["
+                             << hashStr.substr(0, 6)
+                             << "] rebuilt from chunks");
+    return false;
+  }
+
+  LOG_GENERAL(INFO, "Rebuilt message with hash: [" << hashStr.substr(0, 6)
+                                                   << "] from chunks");
+
+  return Execute(decoded, MessageOffset::INST, from);
+}
+
 bool Node::Execute(const bytes& message, unsigned int offset,
                    const Peer& from) {
   // LOG_MARKER();
@@ -1970,6 +2757,14 @@ bool Node::Execute(const bytes& message, unsigned int offset,
       &Node::ProcessFallbackBlock,
       &Node::ProcessProposeGasPrice,
       &Node::ProcessDSGuardNetworkInfoUpdate,
+      &Node::ProcessBlockChunk,
+      &Node::ProcessMBnForwardTxnHashes,
+      &Node::ProcessGetMBnForwardTxnBodies,
+      &Node::ProcessMBnForwardTxnBodies,
+      &Node::ProcessTxnPoolSummary,
+      &Node::ProcessGetTxnPoolBodies,
+      &Node::ProcessGetUpgradeChunk,
+      &Node::ProcessUpgradeChunk,
   };
 
   const unsigned char ins_byte = message.at(offset);
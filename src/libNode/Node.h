@@ -17,8 +17,10 @@
 #ifndef __NODE_H__
 #define __NODE_H__
 
+#include <chrono>
 #include <condition_variable>
 #include <deque>
+#include <functional>
 #include <list>
 #include <map>
 #include <mutex>
@@ -34,6 +36,7 @@
 #include "libData/AccountData/MBnForwardedTxnEntry.h"
 #include "libData/AccountData/Transaction.h"
 #include "libData/AccountData/TransactionReceipt.h"
+#include "libData/AccountData/TxnOrderVerifier.h"
 #include "libData/AccountData/TxnPool.h"
 #include "libData/BlockData/Block.h"
 #include "libLookup/Synchronizer.h"
@@ -41,8 +44,11 @@
 #include "libNetwork/P2PComm.h"
 #include "libNetwork/PeerStore.h"
 #include "libPersistence/BlockStorage.h"
+#include "libUtils/EpochMetrics.h"
+#include "libUtils/LockProfiler.h"
 
 class Mediator;
+class PendingTxnQueue;
 class Retriever;
 
 /// Implements PoW submission and sharding node functionality.
@@ -84,7 +90,7 @@ class Node : public Executable, public Broadcastable {
   std::mutex m_mutexConsensus;
 
   // Sharding information
-  std::atomic<uint32_t> m_numShards;
+  std::atomic<uint32_t> m_numShards{0};
 
   // Consensus variables
   std::mutex m_mutexProcessConsensusMessage;
@@ -113,8 +119,8 @@ class Node : public Executable, public Broadcastable {
   const static unsigned int GOSSIP_RATE = 48;
 
   // Transactions information
-  std::mutex m_mutexCreatedTransactions;
-  TxnPool m_createdTxns, t_createdTxns;
+  ProfiledMutex m_mutexCreatedTransactions{"Node::CreatedTransactions"};
+  TxnPool m_createdTxns;
   std::vector<TxnHash> m_txnsOrdering;
   std::mutex m_mutexProcessedTransactions;
   std::unordered_map<uint64_t,
@@ -123,9 +129,18 @@ class Node : public Executable, public Broadcastable {
   std::unordered_map<TxnHash, TransactionWithReceipt> t_processedTransactions;
   // operates under m_mutexProcessedTransaction
   std::vector<TxnHash> m_TxnOrder;
+  /// Positions of the leader's txns in the microblock being verified,
+  /// operates under m_mutexCreatedTransactions
+  TxnOrderIndex m_txnOrderIndex;
 
   uint64_t m_gasUsedTotal;
   boost::multiprecision::uint128_t m_txnFees;
+  /// Gas budget of the microblock being built or verified, operates under
+  /// m_mutexCreatedTransactions
+  uint64_t m_microBlockGasLimit = MICROBLOCK_GAS_LIMIT;
+  /// Gas used and microseconds taken to run the txns of recent microblocks,
+  /// operates under m_mutexCreatedTransactions
+  std::deque<std::pair<uint64_t, uint64_t>> m_gasTimings;
 
   // std::mutex m_mutexCommittedTransactions;
   // std::unordered_map<uint64_t, std::list<TransactionWithReceipt>>
@@ -135,6 +150,25 @@ class Node : public Executable, public Broadcastable {
   std::unordered_map<uint64_t, std::vector<MBnForwardedTxnEntry>>
       m_mbnForwardedTxnBuffer;
 
+  // Microblocks forwarded with txn hashes only, waiting for missing bodies
+  std::mutex m_mutexPendingMBnForwardTxnHashes;
+  std::map<BlockHash, std::pair<MicroBlock, std::vector<TransactionReceipt>>>
+      m_pendingMBnForwardTxnHashes;
+
+  // Erasure-coded block propagation, keyed by the hash of the whole message
+  struct BlockChunks {
+    uint64_t m_msgSize = 0;
+    uint32_t m_dataChunks = 0;
+    uint32_t m_totalChunks = 0;
+    std::map<unsigned int, bytes> m_chunks;
+    bool m_relayed = false;
+    bool m_decoded = false;
+  };
+  const static unsigned int MAX_BLOCK_CHUNK_SETS = 16;
+  std::mutex m_mutexBlockChunks;
+  std::map<bytes, BlockChunks> m_blockChunks;
+  std::deque<bytes> m_blockChunksOrder;
+
   std::mutex m_mutexTxnPacketBuffer;
   std::vector<bytes> m_txnPacketBuffer;
 
@@ -146,6 +180,14 @@ class Node : public Executable, public Broadcastable {
   uint32_t m_fallbackTimer;
   bool m_fallbackTimerLaunched = false;
   bool m_fallbackStarted;
+  // Seconds between the latest pulses of the fallback timer
+  std::deque<uint32_t> m_fallbackPulseGaps;
+  // Hash of a shard as of a DS block, prepared before fallback runs
+  std::mutex m_mutexFallbackShardHash;
+  uint64_t m_fallbackShardHashDSBlockNum = 0;
+  uint32_t m_fallbackShardHashShardId = 0;
+  CommitteeHash m_fallbackShardHash;
+  bool m_fallbackShardHashValid = false;
   std::mutex m_mutexPendingFallbackBlock;
   std::shared_ptr<FallbackBlock> m_pendingFallbackBlock;
   std::mutex m_MutexCVFallbackBlock;
@@ -172,6 +214,14 @@ class Node : public Executable, public Broadcastable {
                                         std::array<unsigned char, 32>& rand2);
   bool ProcessSubmitMissingTxn(const bytes& message, unsigned int offset,
                                const Peer& from);
+  bool ProcessTxnPoolSummary(const bytes& message, unsigned int offset,
+                             const Peer& from);
+  bool ProcessGetTxnPoolBodies(const bytes& message, unsigned int offset,
+                               const Peer& from);
+  bool ProcessGetUpgradeChunk(const bytes& message, unsigned int offset,
+                              const Peer& from);
+  bool ProcessUpgradeChunk(const bytes& message, unsigned int offset,
+                           const Peer& from);
 
   bool FindTxnInProcessedTxnsList(
       const uint64_t& blockNum, uint8_t sharing_mode,
@@ -229,20 +279,36 @@ class Node : public Executable, public Broadcastable {
   bool ProcessMBnForwardTransaction(const bytes& message,
                                     unsigned int cur_offset, const Peer& from);
   bool ProcessMBnForwardTransactionCore(const MBnForwardedTxnEntry& entry);
+  bool ProcessMBnForwardedTxnEntry(const MBnForwardedTxnEntry& entry,
+                                   const Peer& from);
+  bool ProcessMBnForwardTxnHashes(const bytes& message, unsigned int offset,
+                                  const Peer& from);
+  bool ProcessGetMBnForwardTxnBodies(const bytes& message, unsigned int offset,
+                                     const Peer& from);
+  bool ProcessMBnForwardTxnBodies(const bytes& message, unsigned int offset,
+                                  const Peer& from);
+  /// Fills entry with the txn bodies this lookup knows of, listing the others
+  void RebuildMBnForwardedTxnEntry(
+      const MicroBlock& microBlock,
+      const std::vector<TransactionReceipt>& receipts,
+      MBnForwardedTxnEntry& entry, std::vector<TxnHash>& missingTxnHashes);
   bool ProcessTxnPacketFromLookup(const bytes& message, unsigned int offset,
                                   const Peer& from);
   bool ProcessTxnPacketFromLookupCore(const bytes& message,
+                                      unsigned int offset,
                                       const uint64_t& epochNum,
                                       const uint64_t& dsBlockNum,
                                       const uint32_t& shardId,
-                                      const PubKey& lookupPubKey,
-                                      const std::vector<Transaction>& txns);
+                                      const PubKey& lookupPubKey);
   bool ProcessProposeGasPrice(const bytes& message, unsigned int offset,
                               const Peer& from);
 
   bool ProcessDSGuardNetworkInfoUpdate(const bytes& message,
                                        unsigned int offset, const Peer& from);
 
+  bool ProcessBlockChunk(const bytes& message, unsigned int offset,
+                         const Peer& from);
+
   // bool ProcessCreateAccounts(const bytes & message,
   // unsigned int offset, const Peer & from);
   bool ProcessVCDSBlocksMessage(const bytes& message, unsigned int cur_offset,
@@ -250,7 +316,10 @@ class Node : public Executable, public Broadcastable {
   bool ProcessDoRejoin(const bytes& message, unsigned int offset,
                        const Peer& from);
 
-  bool ComposeMBnForwardTxnMessageForSender(bytes& mb_txns_message);
+  /// Composes my shard's microblock with its txns for the lookups. Before
+  /// the final block the txns are taken from the ones not committed yet.
+  bool ComposeMBnForwardTxnMessageForSender(bytes& mb_txns_message,
+                                            bool beforeFinalBlock = false);
 
   bool VerifyDSBlockCoSignature(const DSBlock& dsblock);
   bool VerifyFinalBlockCoSignature(const TxBlock& txblock);
@@ -277,6 +346,20 @@ class Node : public Executable, public Broadcastable {
   bool CheckMicroBlockVersion();
   bool CheckMicroBlockshardId();
   bool CheckMicroBlockTimestamp();
+  /// The proposed gas limit must be within the bounds any leader may pick,
+  /// and cover the gas used
+  bool CheckMicroBlockGasLimit();
+
+  /// Returns the gas budget for the next microblock. With
+  /// ADAPTIVE_MICROBLOCK_GAS_LIMIT, that is the gas recent microblocks would
+  /// have run in MICROBLOCK_EXECUTION_TARGET_IN_MS, within
+  /// MICROBLOCK_GAS_LIMIT_MIN and MICROBLOCK_GAS_LIMIT. Caller holds
+  /// m_mutexCreatedTransactions.
+  uint64_t GetMicroBlockGasLimit() const;
+  /// Remembers how long gasUsed took to run, over the last
+  /// MICROBLOCK_GAS_TIMING_WINDOW microblocks. Caller holds
+  /// m_mutexCreatedTransactions.
+  void RecordGasTiming(uint64_t gasUsed, uint64_t microseconds);
   bool CheckMicroBlockHashes(bytes& errorMsg);
   bool CheckMicroBlockTxnRootHash();
   bool CheckMicroBlockStateDeltaHash();
@@ -284,10 +367,22 @@ class Node : public Executable, public Broadcastable {
 
   bool VerifyTxnsOrdering(const std::vector<TxnHash>& tranHashes);
 
+  /// Applies the txns of the proposed microblock in the leader's order,
+  /// running runs of plain transfers that share no account concurrently.
+  /// Fails if any of them does not go through, as the leader only proposes
+  /// txns that did.
+  bool ApplyTxnsInLeaderOrder(const std::vector<TxnHash>& tranHashes);
+
   // Fallback Consensus
   void FallbackTimerLaunch();
   void FallbackTimerPulse();
   void FallbackStop();
+  /// Returns how long the timer waits before fallback: a multiple of the
+  /// longest recent gap between blocks, or FALLBACK_INTERVAL_WAITING until
+  /// FALLBACK_HEALTH_WINDOW gaps are known. Caller holds m_mutexFallbackTimer.
+  uint32_t GetFallbackIntervalWaiting() const;
+  /// Returns the committee hash of shardId, computed once per DS block
+  bool GetFallbackShardHash(uint32_t shardId, CommitteeHash& committeeHash);
   bool FallbackValidator(const bytes& message, unsigned int offset,
                          bytes& errorMsg, const uint32_t consensusID,
                          const uint64_t blockNumber, const bytes& blockHash,
@@ -322,9 +417,37 @@ class Node : public Executable, public Broadcastable {
   void SendFallbackBlockToOtherShardNodes(const bytes& fallbackblock_message);
   void SendBlockToOtherShardNodes(const bytes& message, uint32_t cluster_size,
                                   uint32_t num_of_child_clusters);
+  /// Sets receivers to the shard indices this node forwards a block to
   void GetNodesToBroadCastUsingTreeBasedClustering(
-      uint32_t cluster_size, uint32_t num_of_child_clusters, uint32_t& nodes_lo,
-      uint32_t& nodes_hi);
+      uint32_t cluster_size, uint32_t num_of_child_clusters,
+      std::vector<uint32_t>& receivers);
+
+  /// Shard peers this node sends to, built on first use for the current
+  /// m_myShardMembers and m_consensusMyID and then reused every block
+  struct BroadcastLists {
+    bool m_valid = false;
+    size_t m_numMembers = 0;
+    uint16_t m_myID = 0;
+    /// Every member but myself
+    std::vector<Peer> m_others;
+    /// Tree receivers (indices and peers) by cluster size and child clusters
+    std::map<std::pair<uint32_t, uint32_t>,
+             std::pair<std::vector<uint32_t>, std::vector<Peer>>>
+        m_treeReceivers;
+  };
+  BroadcastLists m_broadcastLists;
+
+  /// m_broadcastLists, emptied first if my shard or my ID has changed since
+  /// they were built. Requires m_mutexShardMember.
+  BroadcastLists& GetBroadcastLists();
+
+  /// The cached receivers SendBlockToOtherShardNodes forwards to. Requires
+  /// m_mutexShardMember.
+  const std::pair<std::vector<uint32_t>, std::vector<Peer>>& GetTreeReceivers(
+      uint32_t cluster_size, uint32_t num_of_child_clusters);
+  void SendBlockChunksToOtherShardNodes(const bytes& message,
+                                        uint32_t cluster_size);
+  BlockChunks& GetBlockChunks(const bytes& msgHash);
 
   void GetIpMapping(std::unordered_map<std::string, Peer>& ipMapping);
 
@@ -365,6 +488,10 @@ class Node : public Executable, public Broadcastable {
   std::mutex m_mutexShardMember;
   std::shared_ptr<DequeOfNode> m_myShardMembers;
 
+  /// Drops the peer lists built from m_myShardMembers; called whenever it is
+  /// replaced or its entries change. Requires m_mutexShardMember.
+  void InvalidateBroadcastLists();
+
   std::shared_ptr<MicroBlock> m_microblock;
 
   std::mutex m_mutexCVMicroBlockMissingTxn;
@@ -382,7 +509,7 @@ class Node : public Executable, public Broadcastable {
       m_unavailableMicroBlocks;
 
   /// Sharding variables
-  std::atomic<uint32_t> m_myshardId;
+  std::atomic<uint32_t> m_myshardId{0};
   std::atomic<bool> m_isPrimary;
   std::shared_ptr<ConsensusCommon> m_consensusObject;
 
@@ -395,10 +522,17 @@ class Node : public Executable, public Broadcastable {
   /// The current internal state of this Node instance.
   std::atomic<NodeState> m_state;
 
+  /// Times how long m_state stays in each epoch phase
+  EpochPhaseTimer m_epochPhaseTimer;
+
   // a buffer flag used by lookup to store the isVacuousEpoch state before
   // StoreFinalBlock
   std::atomic<bool> m_isVacuousEpochBuffer;
 
+  // when the txn packets for the current tx epoch started going out, i.e. the
+  // final block (or DS block) opening the epoch arrived
+  std::chrono::system_clock::time_point m_txDistributeStartTime;
+
   // an indicator that whether the non-sync node is still doing mining
   // at standard difficulty
   std::atomic<bool> m_stillMiningPrimary;
@@ -467,6 +601,9 @@ class Node : public Executable, public Broadcastable {
 
   void CleanCreatedTransaction();
 
+  /// Estimated memory held by the pool of created transactions
+  MemoryUsage GetCreatedTxnsMemoryUsage();
+
   void AddToMicroBlockConsensusBuffer(uint32_t consensusId,
                                       const bytes& message, unsigned int offset,
                                       const Peer& peer,
@@ -475,14 +612,39 @@ class Node : public Executable, public Broadcastable {
 
   void CallActOnFinalblock();
 
+  /// Sends my shard's microblock and its txns to the lookups, through the
+  /// senders DataSender picks
+  void SendMBnForwardTxnToLookups(bool beforeFinalBlock);
+
   void ProcessTransactionWhenShardLeader();
+
+  /// Processes first, a plain transfer with its sender's next nonce, along
+  /// with the plain transfers the pool hands out right after it, as long as
+  /// no two of them share an account. The transfers run concurrently but
+  /// are taken in the order, and with the outcome, of processing them one by
+  /// one. Returns false if the caller must stop taking transactions.
+  /// Requires m_mutexCreatedTransactions.
+  bool ProcessPaymentBatch(
+      const Transaction& first, PendingTxnQueue& pendingTxns,
+      const std::function<void(const Transaction&, const TransactionReceipt&)>&
+          appendOne);
   bool ProcessTransactionWhenShardBackup(
       const std::vector<TxnHash>& tranHashes,
       std::vector<TxnHash>& missingtranHashes);
+  /// As shard backup, runs the plain transfers the leader is likely to
+  /// propose shortly before its announcement is due, so that checking the
+  /// microblock can reuse the results
+  void PreExecuteTxnsWhenShardBackup();
   bool ComposeMicroBlock();
   bool CheckMicroBlockValidity(bytes& errorMsg);
   bool OnNodeMissingTxns(const bytes& errorMsg, const unsigned int offset,
                          const Peer& from);
+  /// Sends txns to a shard peer the same way as missing txns of a microblock
+  bool SendMissingTxns(const Peer& peer, const uint64_t epochNum,
+                       const std::vector<Transaction>& txns);
+  /// As shard leader, lists the pooled txns to the shard so backups can
+  /// fetch the bodies they lack before the microblock is announced
+  void SendTxnPoolSummary();
 
   void UpdateStateForNextConsensusRound();
 
@@ -509,6 +671,10 @@ class Node : public Executable, public Broadcastable {
   /// Used by oldest DS node to configure shard ID as a new shard node
   void SetMyshardId(uint32_t shardId);
 
+  /// Checks txns as received in a packet from a lookup and adds the valid
+  /// ones to the pool. Returns the number added.
+  unsigned int AddTxnsFromLookup(const std::vector<Transaction>& txns);
+
   /// Used by oldest DS node to finish setup as a new shard node
   void StartFirstTxEpoch();
 
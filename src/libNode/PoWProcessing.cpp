@@ -59,7 +59,9 @@ bool Node::GetLatestDSBlock() {
          counter <= FETCH_LOOKUP_MSG_MAX_RETRY) {
     m_synchronizer.FetchLatestDSBlocksSeed(
         m_mediator.m_lookup,
-        m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetBlockNum() + 1);
+        m_mediator.m_dsBlockChain.GetLastBlockPtr()
+            ->GetHeader()
+            .GetBlockNum() + 1);
 
     {
       unique_lock<mutex> lock(
@@ -172,8 +174,8 @@ bool Node::StartPoW(const uint64_t& block_num, uint8_t ds_difficulty,
         POW::GetInstance().StopMining();
 
         if (m_mediator.m_currentEpochNum ==
-            m_mediator.m_dsBlockChain.GetLastBlock()
-                .GetHeader()
+            m_mediator.m_dsBlockChain.GetLastBlockPtr()
+                ->GetHeader()
                 .GetEpochNum()) {
           LOG_GENERAL(WARNING, "DS was processed just now, ignore time out");
           return;
@@ -411,6 +413,10 @@ LOG_EPOCH(INFO,m_mediator.m_currentEpochNum,
             << m_mediator.m_DSCommittee->back().second.m_listenPortHost);
     cur_offset += IP_SIZE + PORT_SIZE;
   }
+  {
+    lock_guard<mutex> g(m_mediator.m_mutexDSCommittee);
+    m_mediator.PublishDSCommittee();
+  }
 
   {
     lock_guard<mutex> g(m_mediator.m_mutexInitialDSCommittee);
@@ -454,8 +460,8 @@ bool Node::ProcessStartPoW(const bytes& message, unsigned int offset,
 
   LOG_MARKER();
   LOG_EPOCH(INFO, m_mediator.m_currentEpochNum,
-            "START OF EPOCH " << m_mediator.m_dsBlockChain.GetLastBlock()
-                                         .GetHeader()
+            "START OF EPOCH " << m_mediator.m_dsBlockChain.GetLastBlockPtr()
+                                         ->GetHeader()
                                          .GetBlockNum() +
                                      1);
 
@@ -482,11 +488,17 @@ bool Node::ProcessStartPoW(const bytes& message, unsigned int offset,
 
   if (m_mediator.m_isRetrievedHistory) {
     block_num =
-        m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetBlockNum() + 1;
+        m_mediator.m_dsBlockChain.GetLastBlockPtr()
+            ->GetHeader()
+            .GetBlockNum() + 1;
     dsDifficulty =
-        m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetDSDifficulty();
+        m_mediator.m_dsBlockChain.GetLastBlockPtr()
+            ->GetHeader()
+            .GetDSDifficulty();
     difficulty =
-        m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetDifficulty();
+        m_mediator.m_dsBlockChain.GetLastBlockPtr()
+            ->GetHeader()
+            .GetDifficulty();
     rand1 = m_mediator.m_dsBlockRand;
     rand2 = m_mediator.m_txBlockRand;
   }
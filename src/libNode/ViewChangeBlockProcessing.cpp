@@ -237,6 +237,7 @@ bool Node::ProcessVCBlockCore(const VCBlock& vcblock) {
   }
 
   UpdateDSCommiteeCompositionAfterVC(vcblock, *m_mediator.m_DSCommittee);
+  m_mediator.PublishDSCommittee();
 
   return true;
 }
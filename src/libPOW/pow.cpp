@@ -17,6 +17,7 @@
 
 #include <boost/algorithm/string/predicate.hpp>
 #include <chrono>
+#include <cstring>
 #include <ctime>
 #include <iomanip>
 #include <iostream>
@@ -27,6 +28,9 @@
 #include "libCrypto/Sha2.h"
 #include "libServer/GetWorkServer.h"
 #include "libUtils/DataConversion.h"
+#include "libUtils/DetachedFunction.h"
+#include "libUtils/HugePages.h"
+#include "libUtils/ThreadPlacement.h"
 #include "pow.h"
 
 #ifdef OPENCL_MINE
@@ -37,7 +41,41 @@
 #include "depends/libethash-cuda/CUDAMiner.h"
 #endif
 
+namespace {
+
+HugePages::Mode GetEthashHugePages() {
+  static const HugePages::Mode mode = []() {
+    HugePages::Mode mode = HugePages::OFF;
+    if (!HugePages::ParseMode(ETHASH_HUGE_PAGES, mode)) {
+      LOG_GENERAL(WARNING, "Unknown ETHASH_HUGE_PAGES " << ETHASH_HUGE_PAGES
+                                                        << ", using off");
+    }
+    return mode;
+  }();
+  return mode;
+}
+
+/// Light caches and full datasets, read at random over up to gigabytes
+void* AllocateEthashMemory(size_t size) {
+  return HugePages::Allocate(size, GetEthashHugePages());
+}
+
+/// Where the index-th CPU mining thread runs
+ThreadPlacement MiningThreadPlacement(unsigned int index) {
+  static const ThreadPlacement placement =
+      ThreadPlacement::Resolve(CPU_MINE_PLACEMENT, "CpuMine");
+  return CPU_MINE_PIN_THREADS ? placement.GetOneCpu(index) : placement;
+}
+
+}  // namespace
+
 POW::POW() {
+  // Set before the first context, as each is released with the allocator
+  // set when it is destroyed
+  if (GetEthashHugePages() != HugePages::OFF) {
+    ethash_set_allocator(AllocateEthashMemory, HugePages::Release);
+  }
+
   m_currentBlockNum = 0;
   m_epochContextLight =
       ethash::create_epoch_context(ethash::get_epoch_number(m_currentBlockNum));
@@ -53,11 +91,17 @@ POW::POW() {
   }
 
   if (!LOOKUP_NODE_MODE) {
+    // OpenCL and CUDA devices can mine side by side, each on its own
+    // nonce segment
     if (OPENCL_GPU_MINE) {
       InitOpenCL();
-    } else if (CUDA_GPU_MINE) {
+    }
+    if (CUDA_GPU_MINE) {
       InitCUDA();
     }
+    if (!m_miners.empty()) {
+      PrepareGPUMiners(m_currentBlockNum);
+    }
   }
 }
 
@@ -160,27 +204,146 @@ bool POW::EthashConfigureClient(uint64_t block_number, bool fullDataset) {
                     << " currentBlockNum: " << m_currentBlockNum);
   }
 
-  if (ethash::get_epoch_number(block_number) !=
-      ethash::get_epoch_number(m_currentBlockNum)) {
-    auto epochNumber = ethash::get_epoch_number(block_number);
-    m_epochContextLight = ethash::create_epoch_context(epochNumber);
-  }
+  const auto epochNumber = ethash::get_epoch_number(block_number);
+  const bool epochChanged =
+      epochNumber != ethash::get_epoch_number(m_currentBlockNum);
 
   bool isMineFullCpu = fullDataset && !CUDA_GPU_MINE && !OPENCL_GPU_MINE &&
                        !GETWORK_SERVER_MINE && !REMOTE_MINE;
 
-  if (isMineFullCpu && (m_epochContextFull == nullptr ||
-                        ethash::get_epoch_number(block_number) !=
-                            ethash::get_epoch_number(m_currentBlockNum))) {
-    m_epochContextFull = ethash::create_epoch_context_full(
-        ethash::get_epoch_number(block_number));
+  std::shared_ptr<ethash::epoch_context> pregenLight;
+  std::shared_ptr<ethash::epoch_context_full> pregenFull;
+  if (epochChanged) {
+    TakePregeneratedContext(epochNumber, pregenLight, pregenFull);
+    m_epochContextLight = pregenLight
+                              ? std::move(pregenLight)
+                              : ethash::create_epoch_context(epochNumber);
+  }
+
+  if (isMineFullCpu && (m_epochContextFull == nullptr || epochChanged)) {
+    m_epochContextFull = pregenFull
+                             ? std::move(pregenFull)
+                             : ethash::create_epoch_context_full(epochNumber);
   }
 
   m_currentBlockNum = block_number;
 
+  // Start building the next epoch's context once the boundary is near, so
+  // the first PoW after it does not wait for the light cache or dataset
+  const uint64_t nextEpochStart =
+      static_cast<uint64_t>(epochNumber + 1) * ethash::epoch_length;
+  if (ETHASH_PREGEN_BLOCKS > 0 &&
+      nextEpochStart - block_number <= ETHASH_PREGEN_BLOCKS) {
+    PregenerateEpochContext(epochNumber + 1, isMineFullCpu);
+  }
+
   return true;
 }
 
+void POW::PrepareGPUMiners(uint64_t blockNum) {
+  auto func = [this, blockNum]() -> void {
+    // Miners are not thread safe, so wait for any PoW in progress to finish
+    std::lock_guard<std::mutex> g(m_mutexPoWMine);
+    const auto startTime = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < m_miners.size(); ++i) {
+      if (!m_miners[i]->prepare(blockNum)) {
+        LOG_GENERAL(WARNING, m_minerNames[i]
+                                 << " failed to load DAG, GPU miner log: "
+                                 << m_miners[i]->getLog());
+      }
+    }
+    LOG_GENERAL(INFO,
+                "GPU DAG of epoch "
+                    << ethash::get_epoch_number(blockNum) << " loaded in "
+                    << std::chrono::duration_cast<std::chrono::milliseconds>(
+                           std::chrono::steady_clock::now() - startTime)
+                           .count()
+                    << " ms");
+  };
+  DetachedFunction(1, func);
+}
+
+void POW::PregenerateEpochContext(int epochNumber, bool fullDataset) {
+  {
+    std::lock_guard<std::mutex> g(m_mutexPregen);
+    if (m_pregenRunning || m_pregenEpoch == epochNumber) {
+      return;
+    }
+    m_pregenRunning = true;
+    m_pregenEpoch = epochNumber;
+    m_pregenContextLight.reset();
+    m_pregenContextFull.reset();
+  }
+
+  LOG_GENERAL(INFO, "Pre-generating ethash epoch " << epochNumber);
+
+  auto func = [this, epochNumber, fullDataset]() -> void {
+    std::shared_ptr<ethash::epoch_context> light =
+        ethash::create_epoch_context(epochNumber);
+    std::shared_ptr<ethash::epoch_context_full> full;
+    if (fullDataset) {
+      full = ethash::create_epoch_context_full(epochNumber);
+    }
+
+    {
+      std::lock_guard<std::mutex> g(m_mutexPregen);
+      m_pregenContextLight = std::move(light);
+      m_pregenContextFull = std::move(full);
+      m_pregenRunning = false;
+    }
+    m_cvPregen.notify_all();
+
+    LOG_GENERAL(INFO, "Ethash epoch " << epochNumber << " pre-generated");
+  };
+  DetachedFunction(1, func);
+}
+
+void POW::TakePregeneratedContext(
+    int epochNumber, std::shared_ptr<ethash::epoch_context>& light,
+    std::shared_ptr<ethash::epoch_context_full>& full) {
+  std::unique_lock<std::mutex> lk(m_mutexPregen);
+  if (m_pregenEpoch != epochNumber) {
+    return;
+  }
+
+  // Finishing the pre-generation is never slower than starting over
+  m_cvPregen.wait(lk, [this] { return !m_pregenRunning; });
+
+  light = std::move(m_pregenContextLight);
+  full = std::move(m_pregenContextFull);
+  m_pregenEpoch = -1;
+}
+
+std::shared_ptr<ethash::epoch_context> POW::GetLightContext(
+    uint64_t blockNum) {
+  EthashConfigureClient(blockNum);
+  std::lock_guard<std::mutex> g(m_mutexLightClientConfigure);
+  return m_epochContextLight;
+}
+
+std::shared_ptr<ethash::epoch_context_full> POW::GetVerifyContext(
+    uint64_t blockNum) {
+  const auto epochNumber = ethash::get_epoch_number(blockNum);
+  {
+    std::lock_guard<std::mutex> g(m_mutexLightClientConfigure);
+    if (m_epochContextFull && m_epochContextFull->epoch_number == epochNumber) {
+      return m_epochContextFull;
+    }
+  }
+
+  std::lock_guard<std::mutex> g(m_mutexVerifyContext);
+  if (!m_verifyContextFull ||
+      m_verifyContextFull->epoch_number != epochNumber) {
+    // Dataset items are zeroed and only computed when first looked up
+    m_verifyContextFull = ethash::create_epoch_context_full(epochNumber);
+    if (!m_verifyContextFull) {
+      LOG_GENERAL(WARNING, "Failed to allocate full dataset of epoch "
+                               << epochNumber);
+    }
+  }
+  return m_verifyContextFull;
+}
+
 ethash_mining_result_t POW::MineGetWork(uint64_t blockNum,
                                         ethash_hash256 const& headerHash,
                                         uint8_t difficulty) {
@@ -199,42 +362,77 @@ ethash_mining_result_t POW::MineGetWork(uint64_t blockNum,
   return result;
 }
 
-ethash_mining_result_t POW::MineLight(ethash_hash256 const& headerHash,
-                                      ethash_hash256 const& boundary,
-                                      uint64_t startNonce) {
-  uint64_t nonce = startNonce;
-  while (m_shouldMine) {
-    auto mineResult = ethash::hash(*m_epochContextLight, headerHash, nonce);
-    if (ethash::is_less_or_equal(mineResult.final_hash, boundary)) {
-      ethash_mining_result_t winning_result = {
-          BlockhashToHexString(mineResult.final_hash),
-          BlockhashToHexString(mineResult.mix_hash), nonce, true};
-      return winning_result;
+template <class Context>
+ethash_mining_result_t POW::MineCPU(const Context& context,
+                                    ethash_hash256 const& headerHash,
+                                    ethash_hash256 const& boundary,
+                                    uint64_t startNonce) {
+  const unsigned int numThreads =
+      CPU_MINE_THREADS > 0 ? CPU_MINE_THREADS
+                           : std::max(1u, std::thread::hardware_concurrency());
+
+  ethash_mining_result_t winning_result = {"", "", 0, false};
+  std::mutex mutexWinningResult;
+  std::atomic<bool> found{false};
+  std::atomic<uint64_t> numHashes{0};
+  auto startTime = std::chrono::steady_clock::now();
+
+  // The epoch context is only read, so all workers share it
+  auto worker = [&](unsigned int index) {
+    uint64_t hashes = 0;
+    for (uint64_t nonce = startNonce + index; m_shouldMine && !found;
+         nonce += numThreads) {
+      auto mineResult = ethash::hash(context, headerHash, nonce);
+      hashes++;
+      if (ethash::is_less_or_equal(mineResult.final_hash, boundary)) {
+        std::lock_guard<std::mutex> g(mutexWinningResult);
+        if (!found) {
+          winning_result = {BlockhashToHexString(mineResult.final_hash),
+                            BlockhashToHexString(mineResult.mix_hash), nonce,
+                            true};
+          found = true;
+        }
+      }
+    }
+    numHashes += hashes;
+  };
+
+  if (numThreads == 1) {
+    worker(0);
+  } else {
+    std::vector<std::thread> workers;
+    for (unsigned int i = 0; i < numThreads; i++) {
+      workers.emplace_back([&worker, i]() {
+        MiningThreadPlacement(i).ApplyToCurrentThread();
+        worker(i);
+      });
+    }
+    for (auto& w : workers) {
+      w.join();
     }
-    nonce++;
   }
 
-  ethash_mining_result_t failure_result = {"", "", 0, false};
-  return failure_result;
+  auto elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                       std::chrono::steady_clock::now() - startTime)
+                       .count();
+  LOG_GENERAL(INFO, "CPU mining on " << numThreads << " threads: " << numHashes
+                                     << " hashes in " << elapsedMs << " ms ("
+                                     << numHashes * 1000 / (elapsedMs + 1)
+                                     << " H/s)");
+
+  return winning_result;
+}
+
+ethash_mining_result_t POW::MineLight(ethash_hash256 const& headerHash,
+                                      ethash_hash256 const& boundary,
+                                      uint64_t startNonce) {
+  return MineCPU(*m_epochContextLight, headerHash, boundary, startNonce);
 }
 
 ethash_mining_result_t POW::MineFull(ethash_hash256 const& headerHash,
                                      ethash_hash256 const& boundary,
                                      uint64_t startNonce) {
-  uint64_t nonce = startNonce;
-  while (m_shouldMine) {
-    auto mineResult = ethash::hash(*m_epochContextFull, headerHash, nonce);
-    if (ethash::is_less_or_equal(mineResult.final_hash, boundary)) {
-      ethash_mining_result_t winning_result = {
-          BlockhashToHexString(mineResult.final_hash),
-          BlockhashToHexString(mineResult.mix_hash), nonce, true};
-      return winning_result;
-    }
-    nonce++;
-  }
-
-  ethash_mining_result_t failure_result = {"", "", 0, false};
-  return failure_result;
+  return MineCPU(*m_epochContextFull, headerHash, boundary, startNonce);
 }
 
 ethash_mining_result_t POW::MineFullGPU(uint64_t blockNum,
@@ -242,25 +440,39 @@ ethash_mining_result_t POW::MineFullGPU(uint64_t blockNum,
                                         uint8_t difficulty,
                                         uint64_t startNonce) {
   std::vector<std::unique_ptr<std::thread>> vecThread;
-  uint64_t nonce = startNonce;
-  m_minerIndex = 0;
-  // Clear old result
-  for (auto& miningResult : m_vecMiningResult) {
-    miningResult = ethash_mining_result_t{"", "", 0, false};
+  {
+    std::lock_guard<std::mutex> g(m_mutexMiningResult);
+    // Clear old result
+    for (auto& miningResult : m_vecMiningResult) {
+      miningResult = ethash_mining_result_t{"", "", 0, false};
+    }
+    m_minerHashrates.assign(m_miners.size(), 0);
+    m_numMinersRunning = m_miners.size();
   }
   for (size_t i = 0; i < m_miners.size(); ++i) {
-    vecThread.push_back(std::make_unique<std::thread>(
-        [&] { MineFullGPUThread(blockNum, headerHash, difficulty, nonce); }));
+    vecThread.push_back(std::make_unique<std::thread>([=] {
+      MineFullGPUThread(i, blockNum, headerHash, difficulty, startNonce);
+    }));
   }
 
-  std::this_thread::sleep_for(std::chrono::milliseconds(5));
-  std::unique_lock<std::mutex> lk(m_mutexMiningResult);
-  m_cvMiningResult.wait(lk);
-  m_shouldMine = false;
+  {
+    // Wait until one miner finds a solution or every miner has stopped, so
+    // that a single failing device does not end the search on the others
+    std::unique_lock<std::mutex> lk(m_mutexMiningResult);
+    m_cvMiningResult.wait(lk, [this] { return m_numMinersRunning == 0; });
+  }
   for (auto& ptrThead : vecThread) {
     ptrThead->join();
   }
 
+  uint64_t totalHashrate = 0;
+  for (size_t i = 0; i < m_miners.size(); ++i) {
+    totalHashrate += m_minerHashrates[i];
+    LOG_GENERAL(INFO, m_minerNames[i] << " hashrate " << m_minerHashrates[i]
+                                      << " H/s");
+  }
+  LOG_GENERAL(INFO, "Total GPU hashrate " << totalHashrate << " H/s");
+
   for (const auto& miningResult : m_vecMiningResult) {
     if (miningResult.success) {
       return miningResult;
@@ -485,13 +697,13 @@ bool POW::VerifyRemoteSoln(uint64_t blockNum, ethash_hash256 const& boundary,
                            ethash_hash256& hashResult) {
   LOG_MARKER();
 
-  hashResult = LightHash(blockNum, headerHash, nonce).final_hash;
+  auto context = GetLightContext(blockNum);
+  hashResult = ethash::hash(*context, headerHash, nonce).final_hash;
   if (!ethash::is_less_or_equal(hashResult, boundary)) {
     return false;
   }
 
-  return ethash::verify(*m_epochContextLight, headerHash, mixHash, nonce,
-                        boundary);
+  return ethash::verify(*context, headerHash, mixHash, nonce, boundary);
 }
 
 bool POW::SendVerifyResult(const PairOfKey& pairOfKey,
@@ -550,13 +762,12 @@ bool POW::SendVerifyResult(const PairOfKey& pairOfKey,
   }
 }
 
-void POW::MineFullGPUThread(uint64_t blockNum, ethash_hash256 const& headerHash,
+void POW::MineFullGPUThread(size_t index, uint64_t blockNum,
+                            ethash_hash256 const& headerHash,
                             uint8_t difficulty, uint64_t nonce) {
   LOG_MARKER();
-  auto index = m_minerIndex.load(std::memory_order_relaxed);
-  ++m_minerIndex;
   LOG_GENERAL(INFO, "Difficulty : " << std::to_string(difficulty)
-                                    << ", miner index " << index);
+                                    << ", miner " << m_minerNames[index]);
   dev::eth::WorkPackage wp;
   wp.blockNumber = blockNum;
   wp.boundary = (dev::h256)(dev::u256)((dev::bigint(1) << 256) /
@@ -568,29 +779,46 @@ void POW::MineFullGPUThread(uint64_t blockNum, ethash_hash256 const& headerHash,
   const uint64_t NONCE_SEGMENT = (uint64_t)pow(2, NONCE_SEGMENT_WIDTH);
   wp.startNonce = nonce + index * NONCE_SEGMENT;
 
+  const uint64_t segmentStart = wp.startNonce;
+  const auto startTime = std::chrono::steady_clock::now();
+  const auto boundary = DifficultyLevelInInt(difficulty);
+
+  ethash_mining_result_t result{"", "", 0, false};
   dev::eth::Solution solution;
   while (m_shouldMine) {
     if (!m_miners[index]->mine(wp, solution)) {
-      LOG_GENERAL(WARNING, "GPU failed to do mine, GPU miner log: "
+      LOG_GENERAL(WARNING, m_minerNames[index]
+                               << " failed to do mine, GPU miner log: "
                                << m_miners[index]->getLog());
-      m_vecMiningResult[index] = ethash_mining_result_t{"", "", 0, false};
-      m_cvMiningResult.notify_one();
-      return;
+      break;
     }
     auto hashResult = LightHash(blockNum, headerHash, solution.nonce);
-    auto boundary = DifficultyLevelInInt(difficulty);
     if (ethash::is_less_or_equal(hashResult.final_hash, boundary)) {
-      m_vecMiningResult[index] =
+      result =
           ethash_mining_result_t{BlockhashToHexString(hashResult.final_hash),
                                  solution.mixHash.hex(), solution.nonce, true};
-      m_cvMiningResult.notify_one();
-      return;
+      break;
     }
-    wp.startNonce = solution.nonce;
+    // Resume past a false positive, otherwise the same nonce comes back
+    wp.startNonce = (solution.nonce == wp.startNonce) ? solution.nonce + 1
+                                                      : solution.nonce;
+  }
+
+  auto elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                       std::chrono::steady_clock::now() - startTime)
+                       .count();
+
+  std::lock_guard<std::mutex> g(m_mutexMiningResult);
+  m_vecMiningResult[index] = result;
+  if (elapsedMs > 0) {
+    m_minerHashrates[index] = (wp.startNonce - segmentStart) * 1000 / elapsedMs;
   }
-  m_vecMiningResult[index] = ethash_mining_result_t{"", "", 0, false};
-  m_cvMiningResult.notify_one();
-  return;
+  if (result.success) {
+    // Stop the other devices as soon as one has found a solution
+    m_shouldMine = false;
+  }
+  --m_numMinersRunning;
+  m_cvMiningResult.notify_all();
 }
 
 bytes POW::ConcatAndhash(const std::array<unsigned char, UINT256_SIZE>& rand1,
@@ -663,6 +891,12 @@ ethash_mining_result_t POW::PoWMine(uint64_t blockNum, uint8_t difficulty,
     result = MineGetWork(blockNum, headerHash, difficulty);
   } else if (OPENCL_GPU_MINE || CUDA_GPU_MINE) {
     result = MineFullGPU(blockNum, headerHash, difficulty, startNonce);
+    // The DAG stays on the devices between windows; swap it early when the
+    // next window falls into a new epoch
+    if (ethash::get_epoch_number(blockNum + 1) !=
+        ethash::get_epoch_number(blockNum)) {
+      PrepareGPUMiners(blockNum + 1);
+    }
   } else if (fullDataset) {
     result = MineFull(headerHash, boundary, startNonce);
   } else {
@@ -674,9 +908,8 @@ ethash_mining_result_t POW::PoWMine(uint64_t blockNum, uint8_t difficulty,
 bool POW::PoWVerify(uint64_t blockNum, uint8_t difficulty,
                     const ethash_hash256& headerHash, uint64_t winning_nonce,
                     const std::string& winning_result,
-                    const std::string& winning_mixhash) {
+                    const std::string& winning_mixhash, bool fullDataset) {
   LOG_MARKER();
-  EthashConfigureClient(blockNum);
   const auto boundary = DifficultyLevelInInt(difficulty);
   auto winnning_result = StringToBlockhash(winning_result);
   auto winningMixhash = StringToBlockhash(winning_mixhash);
@@ -686,15 +919,28 @@ bool POW::PoWVerify(uint64_t blockNum, uint8_t difficulty,
     return false;
   }
 
-  return ethash::verify(*m_epochContextLight, headerHash, winningMixhash,
-                        winning_nonce, boundary);
+  if (fullDataset) {
+    auto contextFull = GetVerifyContext(blockNum);
+    if (contextFull) {
+      if (!ethash::verify_final_hash(headerHash, winningMixhash,
+                                     winning_nonce, boundary)) {
+        return false;
+      }
+      auto hashResult = ethash::hash(*contextFull, headerHash, winning_nonce);
+      return std::memcmp(hashResult.mix_hash.bytes, winningMixhash.bytes,
+                         sizeof(winningMixhash.bytes)) == 0;
+    }
+  }
+
+  auto context = GetLightContext(blockNum);
+  return ethash::verify(*context, headerHash, winningMixhash, winning_nonce,
+                        boundary);
 }
 
 ethash::result POW::LightHash(uint64_t blockNum,
                               ethash_hash256 const& headerHash,
                               uint64_t nonce) {
-  EthashConfigureClient(blockNum);
-  return ethash::hash(*m_epochContextLight, headerHash, nonce);
+  return ethash::hash(*GetLightContext(blockNum), headerHash, nonce);
 }
 
 bool POW::CheckSolnAgainstsTargetedDifficulty(const ethash_hash256& result,
@@ -736,6 +982,7 @@ void POW::InitOpenCL() {
     }
 
     m_miners.push_back(std::make_unique<CLMiner>(gpuIndex));
+    m_minerNames.push_back("OpenCL GPU #" + std::to_string(gpuIndex));
     m_vecMiningResult.push_back(ethash_mining_result_t{"", "", 0, false});
   }
   LOG_GENERAL(INFO, "OpenCL GPU initialized in POW");
@@ -751,7 +998,8 @@ void POW::InitCUDA() {
 #ifdef CUDA_MINE
   using namespace dev::eth;
 
-  auto gpuToUse = GetGpuToUse();
+  auto gpuToUse =
+      GetGpuToUse(CUDA_GPU_TO_USE.empty() ? GPU_TO_USE : CUDA_GPU_TO_USE);
   auto deviceGenerateDag = *gpuToUse.begin();
   LOG_GENERAL(INFO, "Generate dag Nvidia GPU #" << deviceGenerateDag);
 
@@ -773,6 +1021,7 @@ void POW::InitCUDA() {
     }
 
     m_miners.push_back(std::make_unique<CUDAMiner>(gpuIndex));
+    m_minerNames.push_back("Nvidia GPU #" + std::to_string(gpuIndex));
     m_vecMiningResult.push_back(ethash_mining_result_t{"", "", 0, false});
   }
   LOG_GENERAL(INFO, "CUDA GPU initialized in POW");
@@ -784,9 +1033,9 @@ void POW::InitCUDA() {
 #endif
 }
 
-std::set<unsigned int> POW::GetGpuToUse() {
+std::set<unsigned int> POW::GetGpuToUse(const std::string& gpuList) {
   std::set<unsigned int> gpuToUse;
-  std::stringstream ss(GPU_TO_USE);
+  std::stringstream ss(gpuList);
   std::string item;
   while (std::getline(ss, item, ',')) {
     unsigned int index = strtol(item.c_str(), NULL, 10);
@@ -20,6 +20,7 @@
 
 #include <stdint.h>
 #include <array>
+#include <condition_variable>
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wunused-parameter"
 #include <boost/multiprecision/cpp_int.hpp>
@@ -87,11 +88,13 @@ class POW {
   /// Terminates proof-of-work mining.
   void StopMining();
 
-  /// Verifies a proof-of-work submission.
+  /// Verifies a proof-of-work submission. With fullDataset, the dataset
+  /// items are looked up in the epoch's full dataset, which is filled on
+  /// first use and shared by all later verifications of the epoch.
   bool PoWVerify(uint64_t blockNum, uint8_t difficulty,
                  const ethash_hash256& headerHash, uint64_t winning_nonce,
                  const std::string& winning_result,
-                 const std::string& winning_mixhash);
+                 const std::string& winning_mixhash, bool fullDataset = false);
   static bytes ConcatAndhash(
       const std::array<unsigned char, UINT256_SIZE>& rand1,
       const std::array<unsigned char, UINT256_SIZE>& rand2,
@@ -104,7 +107,8 @@ class POW {
                                            uint8_t difficulty);
   bool CheckSolnAgainstsTargetedDifficulty(const std::string& result,
                                            uint8_t difficulty);
-  static std::set<unsigned int> GetGpuToUse();
+  static std::set<unsigned int> GetGpuToUse(
+      const std::string& gpuList = GPU_TO_USE);
 
   // Put it to public function so can directly test with it
   ethash_mining_result_t RemoteMine(const PairOfKey& pairOfKey,
@@ -132,27 +136,73 @@ class POW {
   std::shared_ptr<ethash::epoch_context_full> m_epochContextFull = nullptr;
   uint64_t m_currentBlockNum;
   std::atomic<bool> m_shouldMine;
+  // OpenCL and CUDA miners together; each keeps its DAG on the device
+  // until the ethash epoch changes
   std::vector<dev::eth::MinerPtr> m_miners;
+  std::vector<std::string> m_minerNames;
   std::vector<ethash_mining_result_t> m_vecMiningResult;
-  std::atomic<int> m_minerIndex;
+  // Hashes per second each miner managed in the last PoW
+  std::vector<uint64_t> m_minerHashrates;
+  unsigned int m_numMinersRunning = 0;
   std::condition_variable m_cvMiningResult;
   std::mutex m_mutexMiningResult;
   std::unique_ptr<jsonrpc::HttpClient> m_httpClient;
 
+  // Context of the next ethash epoch, built in the background
+  int m_pregenEpoch = -1;
+  bool m_pregenRunning = false;
+  std::shared_ptr<ethash::epoch_context> m_pregenContextLight;
+  std::shared_ptr<ethash::epoch_context_full> m_pregenContextFull;
+  std::mutex m_mutexPregen;
+  std::condition_variable m_cvPregen;
+
+  // Full dataset that batches of PoW solutions are verified against
+  std::shared_ptr<ethash::epoch_context_full> m_verifyContextFull;
+  std::mutex m_mutexVerifyContext;
+
+  /// Loads the DAG of the epoch of blockNum onto every GPU miner on a
+  /// detached thread, so the next PoW window starts hashing right away
+  void PrepareGPUMiners(uint64_t blockNum);
+  /// Builds the context of epochNumber on a detached thread, unless it is
+  /// already built or being built
+  void PregenerateEpochContext(int epochNumber, bool fullDataset);
+  /// Hands over the pre-generated context of epochNumber, if there is one,
+  /// waiting for its generation to finish
+  void TakePregeneratedContext(
+      int epochNumber, std::shared_ptr<ethash::epoch_context>& light,
+      std::shared_ptr<ethash::epoch_context_full>& full);
+
+  /// Searches nonces from startNonce on CPU_MINE_THREADS threads, each
+  /// taking every n-th nonce, until one meets the boundary or mining stops
+  template <class Context>
+  ethash_mining_result_t MineCPU(const Context& context,
+                                 ethash_hash256 const& headerHash,
+                                 ethash_hash256 const& boundary,
+                                 uint64_t startNonce);
   ethash_mining_result_t MineLight(ethash_hash256 const& headerHash,
                                    ethash_hash256 const& boundary,
                                    uint64_t startNonce);
   ethash_mining_result_t MineFull(ethash_hash256 const& headerHash,
                                   ethash_hash256 const& boundary,
                                   uint64_t startNonce);
+  /// Returns the light context of blockNum's epoch; the caller's copy stays
+  /// valid when the epoch changes, so hashing needs no lock
+  std::shared_ptr<ethash::epoch_context> GetLightContext(uint64_t blockNum);
+  /// Returns the full context of blockNum's epoch, reusing the mining one
+  /// when it matches, or nullptr if the dataset cannot be allocated
+  std::shared_ptr<ethash::epoch_context_full> GetVerifyContext(
+      uint64_t blockNum);
   ethash_mining_result_t MineGetWork(uint64_t blockNum,
                                      ethash_hash256 const& headerHash,
                                      uint8_t difficulty);
   ethash_mining_result_t MineFullGPU(uint64_t blockNum,
                                      ethash_hash256 const& headerHash,
                                      uint8_t difficulty, uint64_t startNonce);
-  void MineFullGPUThread(uint64_t blockNum, ethash_hash256 const& headerHash,
-                         uint8_t difficulty, uint64_t nonce);
+  /// Mines the nonce segment of miner index until a solution is found, the
+  /// miner fails or mining stops
+  void MineFullGPUThread(size_t index, uint64_t blockNum,
+                         ethash_hash256 const& headerHash, uint8_t difficulty,
+                         uint64_t nonce);
   void InitOpenCL();
   void InitCUDA();
 };
@@ -0,0 +1,148 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <sstream>
+#include <vector>
+
+#include "BackgroundWriter.h"
+#include "common/Constants.h"
+#include "libUtils/Logger.h"
+
+using namespace std;
+
+BackgroundWriter::BackgroundWriter(unsigned int queueSize,
+                                   unsigned int batchSize)
+    : m_queueSize(max(queueSize, 1u)),
+      m_batchSize(max(batchSize, 1u)),
+      m_thread([this]() { Run(); }) {}
+
+BackgroundWriter::~BackgroundWriter() {
+  {
+    lock_guard<mutex> g(m_mutexQueue);
+    m_stop = true;
+  }
+  m_cvQueue.notify_all();
+  if (m_thread.joinable()) {
+    m_thread.join();
+  }
+}
+
+BackgroundWriter& BackgroundWriter::GetInstance() {
+  static BackgroundWriter writer(BACKGROUND_WRITER_QUEUE_SIZE,
+                                 BACKGROUND_WRITER_BATCH_SIZE);
+  return writer;
+}
+
+bool BackgroundWriter::Post(const string& name, Write write) {
+  {
+    lock_guard<mutex> g(m_mutexQueue);
+    if (m_queue.size() >= m_queueSize) {
+      m_dropped++;
+      LOG_GENERAL(WARNING, "Background write " << name << " dropped, "
+                                               << m_queueSize
+                                               << " writes already queued");
+      return false;
+    }
+    m_queue.push_back({name, move(write)});
+  }
+  m_cvQueue.notify_one();
+  return true;
+}
+
+void BackgroundWriter::Run() {
+  vector<Entry> batch;
+  batch.reserve(m_batchSize);
+
+  while (true) {
+    {
+      unique_lock<mutex> g(m_mutexQueue);
+      m_busy = false;
+      m_cvIdle.notify_all();
+      m_cvQueue.wait(g, [this]() { return m_stop || !m_queue.empty(); });
+      if (m_queue.empty()) {
+        // Only reached once stopping, with nothing left to write
+        return;
+      }
+      m_busy = true;
+      while (!m_queue.empty() && batch.size() < m_batchSize) {
+        batch.emplace_back(move(m_queue.front()));
+        m_queue.pop_front();
+      }
+    }
+
+    m_batches++;
+    for (auto& entry : batch) {
+      bool result = false;
+      try {
+        result = entry.m_write();
+      } catch (const exception& e) {
+        LOG_GENERAL(WARNING,
+                    "Background write " << entry.m_name << " threw: "
+                                        << e.what());
+      }
+      if (result) {
+        m_written++;
+      } else {
+        m_failed++;
+        LOG_GENERAL(WARNING, "Background write " << entry.m_name << " failed");
+      }
+    }
+    batch.clear();
+  }
+}
+
+void BackgroundWriter::Flush() {
+  unique_lock<mutex> g(m_mutexQueue);
+  m_cvIdle.wait(g, [this]() { return m_queue.empty() && !m_busy; });
+}
+
+BackgroundWriter::Stats BackgroundWriter::GetStats() {
+  Stats stats;
+  {
+    lock_guard<mutex> g(m_mutexQueue);
+    stats.m_queued = m_queue.size();
+  }
+  stats.m_written = m_written;
+  stats.m_failed = m_failed;
+  stats.m_dropped = m_dropped;
+  stats.m_batches = m_batches;
+  return stats;
+}
+
+string BackgroundWriter::GetPrometheusText() {
+  const Stats stats = GetStats();
+
+  ostringstream text;
+  text << "# HELP zilliqa_background_writes_queued Background writes not "
+          "started yet.\n"
+       << "# TYPE zilliqa_background_writes_queued gauge\n"
+       << "zilliqa_background_writes_queued " << stats.m_queued << "\n"
+       << "# HELP zilliqa_background_writes_total Background writes run, by "
+          "result.\n"
+       << "# TYPE zilliqa_background_writes_total counter\n"
+       << "zilliqa_background_writes_total{result=\"written\"} "
+       << stats.m_written << "\n"
+       << "zilliqa_background_writes_total{result=\"failed\"} "
+       << stats.m_failed << "\n"
+       << "zilliqa_background_writes_total{result=\"dropped\"} "
+       << stats.m_dropped << "\n"
+       << "# HELP zilliqa_background_write_batches_total Wake-ups of the "
+          "background writer.\n"
+       << "# TYPE zilliqa_background_write_batches_total counter\n"
+       << "zilliqa_background_write_batches_total " << stats.m_batches << "\n";
+  return text.str();
+}
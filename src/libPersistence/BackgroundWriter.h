@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __BACKGROUNDWRITER_H__
+#define __BACKGROUNDWRITER_H__
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+/// Single thread for persistence that consensus does not wait on, such as
+/// the lookup's diagnostic data, so that a slow disk does not hold up the
+/// epoch thread that produced the data.
+///
+/// Writes run in the order they were posted. The thread wakes up once for
+/// up to batchSize of them and runs them back to back, and at most
+/// queueSize wait for it; past that, new writes are dropped, as losing a
+/// diagnostic entry is better than stalling a DS epoch on it.
+class BackgroundWriter {
+ public:
+  /// Returns false if the write failed, which is counted and logged
+  using Write = std::function<bool()>;
+
+  struct Stats {
+    /// Posted and not started yet
+    uint64_t m_queued = 0;
+    uint64_t m_written = 0;
+    uint64_t m_failed = 0;
+    /// Refused by Post because the queue was full
+    uint64_t m_dropped = 0;
+    /// Times the thread woke up to take writes
+    uint64_t m_batches = 0;
+  };
+
+ private:
+  struct Entry {
+    std::string m_name;
+    Write m_write;
+  };
+
+  const unsigned int m_queueSize;
+  const unsigned int m_batchSize;
+
+  std::mutex m_mutexQueue;
+  std::condition_variable m_cvQueue;
+  /// Signalled each time a batch is done, for Flush
+  std::condition_variable m_cvIdle;
+  std::deque<Entry> m_queue;
+  bool m_busy = false;
+  bool m_stop = false;
+
+  std::atomic<uint64_t> m_written{0};
+  std::atomic<uint64_t> m_failed{0};
+  std::atomic<uint64_t> m_dropped{0};
+  std::atomic<uint64_t> m_batches{0};
+
+  std::thread m_thread;
+
+  BackgroundWriter(BackgroundWriter const&) = delete;
+  void operator=(BackgroundWriter const&) = delete;
+
+  void Run();
+
+ public:
+  /// Queues at most queueSize writes and takes up to batchSize per wake-up
+  BackgroundWriter(unsigned int queueSize, unsigned int batchSize);
+
+  /// Runs the writes still queued, then joins the thread
+  ~BackgroundWriter();
+
+  /// Returns the writer sized by BACKGROUND_WRITER_QUEUE_SIZE and
+  /// BACKGROUND_WRITER_BATCH_SIZE.
+  static BackgroundWriter& GetInstance();
+
+  /// Queues the write. The name is only for the logs. Returns false,
+  /// dropping the write, if the queue is full.
+  bool Post(const std::string& name, Write write);
+
+  /// Waits until every write posted so far has run
+  void Flush();
+
+  Stats GetStats();
+
+  /// Returns the stats in the Prometheus text exposition format
+  std::string GetPrometheusText();
+};
+
+#endif  // __BACKGROUNDWRITER_H__
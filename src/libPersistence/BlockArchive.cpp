@@ -0,0 +1,263 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <boost/filesystem.hpp>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+
+#include "BlockArchive.h"
+#include "common/Constants.h"
+#include "libUtils/Logger.h"
+
+using namespace std;
+
+namespace {
+
+const string SEGMENT_SUFFIX = ".seg";
+// segment (4) || offset (8) || length (4), big-endian
+const size_t INDEX_ENTRY_SIZE = 16;
+
+void WriteBigEndian(uint64_t value, size_t size, string& out) {
+  for (size_t i = 0; i < size; i++) {
+    out.push_back((char)((value >> (8 * (size - 1 - i))) & 0xFF));
+  }
+}
+
+uint64_t ReadBigEndian(const string& in, size_t offset, size_t size) {
+  uint64_t value = 0;
+  for (size_t i = 0; i < size; i++) {
+    value = (value << 8) | (unsigned char)in[offset + i];
+  }
+  return value;
+}
+
+}  // namespace
+
+BlockArchive::BlockArchive(const string& name, const uint64_t segmentSize)
+    : m_name(name),
+      m_dir("./" + PERSISTENCE_PATH + "/" + name),
+      m_segmentSize(segmentSize),
+      m_indexDB(make_shared<LevelDB>(name + "Index")),
+      m_activeFd(-1),
+      m_activeSegment(0),
+      m_activeSize(0) {
+  if (!OpenActiveSegment()) {
+    LOG_GENERAL(WARNING, "Cannot open block archive " << m_dir);
+  }
+}
+
+BlockArchive::~BlockArchive() { CloseAll(); }
+
+string BlockArchive::GetSegmentPath(const uint32_t segment) const {
+  ostringstream oss;
+  oss << m_dir << "/" << setw(6) << setfill('0') << segment << SEGMENT_SUFFIX;
+  return oss.str();
+}
+
+bool BlockArchive::OpenActiveSegment() {
+  boost::system::error_code ec;
+  boost::filesystem::create_directories(m_dir, ec);
+  if (ec) {
+    LOG_GENERAL(WARNING, "Cannot create " << m_dir << ": " << ec.message());
+    return false;
+  }
+
+  // Appends always go to the highest numbered segment
+  m_activeSegment = 0;
+  for (boost::filesystem::directory_iterator it(m_dir), end; it != end;
+       ++it) {
+    if (it->path().extension() != SEGMENT_SUFFIX) {
+      continue;
+    }
+    try {
+      m_activeSegment = max(m_activeSegment,
+                            (uint32_t)stoul(it->path().stem().string()));
+    } catch (const exception& e) {
+      LOG_GENERAL(WARNING, "Ignoring " << it->path().string());
+    }
+  }
+
+  const string path = GetSegmentPath(m_activeSegment);
+  m_activeFd = open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+  if (m_activeFd < 0) {
+    LOG_GENERAL(WARNING, "Cannot open " << path << ": " << strerror(errno));
+    return false;
+  }
+
+  struct stat st;
+  if (fstat(m_activeFd, &st) != 0) {
+    LOG_GENERAL(WARNING, "Cannot stat " << path << ": " << strerror(errno));
+    return false;
+  }
+  m_activeSize = st.st_size;
+
+  return true;
+}
+
+void BlockArchive::CloseAll() {
+  if (m_activeFd >= 0) {
+    close(m_activeFd);
+    m_activeFd = -1;
+  }
+  for (const auto& m : m_mappings) {
+    munmap(m.second.m_addr, m.second.m_size);
+  }
+  m_mappings.clear();
+}
+
+bool BlockArchive::Put(const string& key, const bytes& body) {
+  lock_guard<mutex> g(m_mutexWrite);
+
+  if (m_activeFd < 0) {
+    LOG_GENERAL(WARNING, "Block archive " << m_name << " is not open");
+    return false;
+  }
+
+  // A body larger than a segment gets a segment of its own
+  if (m_activeSize > 0 && m_activeSize + body.size() > m_segmentSize) {
+    close(m_activeFd);
+    m_activeSegment++;
+    const string path = GetSegmentPath(m_activeSegment);
+    m_activeFd = open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (m_activeFd < 0) {
+      LOG_GENERAL(WARNING, "Cannot open " << path << ": " << strerror(errno));
+      return false;
+    }
+    m_activeSize = 0;
+  }
+
+  const uint64_t offset = m_activeSize;
+  size_t written = 0;
+  while (written < body.size()) {
+    ssize_t n = write(m_activeFd, body.data() + written, body.size() - written);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      LOG_GENERAL(WARNING, "Write to " << GetSegmentPath(m_activeSegment)
+                                       << " failed: " << strerror(errno));
+      // Whatever made it to disk is unreferenced, skip over it
+      m_activeSize += written;
+      return false;
+    }
+    written += n;
+  }
+  m_activeSize += written;
+
+  string entry;
+  WriteBigEndian(m_activeSegment, 4, entry);
+  WriteBigEndian(offset, 8, entry);
+  WriteBigEndian(body.size(), 4, entry);
+
+  return m_indexDB->Insert(leveldb::Slice(key), leveldb::Slice(entry)) == 0;
+}
+
+bool BlockArchive::Read(const uint32_t segment, const uint64_t offset,
+                        const uint32_t length, bytes& body) {
+  {
+    shared_lock<shared_timed_mutex> g(m_mutexMappings);
+    auto it = m_mappings.find(segment);
+    if (it != m_mappings.end() && offset + length <= it->second.m_size) {
+      const auto* data = (const uint8_t*)it->second.m_addr + offset;
+      body.assign(data, data + length);
+      return true;
+    }
+  }
+
+  // Not mapped yet, or the active segment grew since it was mapped
+  unique_lock<shared_timed_mutex> g(m_mutexMappings);
+  const string path = GetSegmentPath(segment);
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    LOG_GENERAL(WARNING, "Cannot open " << path << ": " << strerror(errno));
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || (uint64_t)st.st_size < offset + length) {
+    LOG_GENERAL(WARNING, "Segment " << path << " is truncated");
+    close(fd);
+    return false;
+  }
+  void* addr = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (addr == MAP_FAILED) {
+    LOG_GENERAL(WARNING, "Cannot map " << path << ": " << strerror(errno));
+    return false;
+  }
+
+  auto it = m_mappings.find(segment);
+  if (it != m_mappings.end()) {
+    munmap(it->second.m_addr, it->second.m_size);
+  }
+  m_mappings[segment] = {addr, (size_t)st.st_size};
+
+  const auto* data = (const uint8_t*)addr + offset;
+  body.assign(data, data + length);
+  return true;
+}
+
+bool BlockArchive::Get(const string& key, bytes& body) {
+  const string entry = m_indexDB->Lookup(key);
+  if (entry.empty()) {
+    return false;
+  }
+  if (entry.size() != INDEX_ENTRY_SIZE) {
+    LOG_GENERAL(WARNING, "Corrupt index entry in " << m_name << " for " << key);
+    return false;
+  }
+
+  return Read(ReadBigEndian(entry, 0, 4), ReadBigEndian(entry, 4, 8),
+              ReadBigEndian(entry, 12, 4), body);
+}
+
+bool BlockArchive::Delete(const string& key) {
+  return m_indexDB->DeleteKey(key) == 0;
+}
+
+bool BlockArchive::GetKeys(vector<string>& keys) {
+  unique_ptr<leveldb::Iterator> it(
+      m_indexDB->GetDB()->NewIterator(leveldb::ReadOptions()));
+  for (it->SeekToFirst(); it->Valid(); it->Next()) {
+    keys.emplace_back(it->key().ToString());
+  }
+  return true;
+}
+
+bool BlockArchive::Reset() {
+  lock_guard<mutex> g(m_mutexWrite);
+  unique_lock<shared_timed_mutex> g2(m_mutexMappings);
+
+  CloseAll();
+
+  boost::system::error_code ec;
+  boost::filesystem::remove_all(m_dir, ec);
+  if (ec) {
+    LOG_GENERAL(WARNING, "Cannot remove " << m_dir << ": " << ec.message());
+    return false;
+  }
+
+  return m_indexDB->ResetDB() && OpenActiveSegment();
+}
+
+vector<string> BlockArchive::GetNames() const {
+  return {m_name, m_indexDB->GetDBName()};
+}
@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef BLOCKARCHIVE_H
+#define BLOCKARCHIVE_H
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+#include "common/BaseType.h"
+#include "depends/libDatabase/LevelDB.h"
+
+/// Append-only store for write-once data such as finalized blocks.
+/// Bodies are appended to segment files of a fixed maximum size and read
+/// back through mmap, so they never go through LevelDB compaction. Only the
+/// small offset index (key -> segment, offset, length) lives in LevelDB.
+class BlockArchive {
+  struct Mapping {
+    void* m_addr;
+    size_t m_size;
+  };
+
+  const std::string m_name;
+  const std::string m_dir;
+  const uint64_t m_segmentSize;
+  std::shared_ptr<LevelDB> m_indexDB;
+
+  std::mutex m_mutexWrite;
+  int m_activeFd;
+  uint32_t m_activeSegment;
+  uint64_t m_activeSize;
+
+  std::shared_timed_mutex m_mutexMappings;
+  std::map<uint32_t, Mapping> m_mappings;
+
+  std::string GetSegmentPath(const uint32_t segment) const;
+  bool OpenActiveSegment();
+  void CloseAll();
+  bool Read(const uint32_t segment, const uint64_t offset,
+            const uint32_t length, bytes& body);
+
+ public:
+  /// Opens (or creates) the archive under the persistence directory.
+  BlockArchive(const std::string& name, const uint64_t segmentSize);
+
+  /// Unmaps all segments and closes the active one.
+  ~BlockArchive();
+
+  /// Appends body and indexes it under key.
+  bool Put(const std::string& key, const bytes& body);
+
+  /// Retrieves the body indexed under key.
+  bool Get(const std::string& key, bytes& body);
+
+  /// Drops key from the index. The space is not reclaimed.
+  bool Delete(const std::string& key);
+
+  /// Retrieves all indexed keys, in index order.
+  bool GetKeys(std::vector<std::string>& keys);
+
+  /// Deletes all segments and the index.
+  bool Reset();
+
+  /// Returns the names of the segment directory and of the index DB.
+  std::vector<std::string> GetNames() const;
+};
+
+#endif  // BLOCKARCHIVE_H
@@ -19,6 +19,7 @@
 #include <sys/syscall.h>
 #include <unistd.h>
 #include <algorithm>
+#include <condition_variable>
 #include <fstream>
 #include <iostream>
 #include <sstream>
@@ -27,15 +28,77 @@
 #include <leveldb/db.h>
 #include <boost/filesystem.hpp>
 
+#include "BackgroundWriter.h"
 #include "BlockStorage.h"
 #include "common/Constants.h"
 #include "common/Serializable.h"
 #include "libData/BlockChainData/BlockLinkChain.h"
 #include "libMessage/Messenger.h"
 #include "libUtils/DataConversion.h"
+#include "libUtils/AsyncExecutor.h"
 
 using namespace std;
 
+namespace {
+// Microblocks are also indexed by epoch and shard, in the same database,
+// under keys that cannot clash with the hex block hashes next to them
+const string MICROBLOCK_INDEX_PREFIX = "mbidx";
+
+// Big-endian numbers so that keys sort by epoch, then shard
+string MicroBlockIndexKey(const uint64_t epochNum, const uint32_t shardId) {
+  string key = MICROBLOCK_INDEX_PREFIX;
+  for (int shift = 56; shift >= 0; shift -= 8) {
+    key.push_back((char)((epochNum >> shift) & 0xFF));
+  }
+  for (int shift = 24; shift >= 0; shift -= 8) {
+    key.push_back((char)((shardId >> shift) & 0xFF));
+  }
+  return key;
+}
+
+bool ParseMicroBlockIndexKey(const leveldb::Slice& key, uint64_t& epochNum,
+                             uint32_t& shardId) {
+  const size_t prefixSize = MICROBLOCK_INDEX_PREFIX.size();
+  if (key.size() < prefixSize + sizeof(epochNum) + sizeof(shardId) ||
+      !key.starts_with(MICROBLOCK_INDEX_PREFIX)) {
+    return false;
+  }
+  const auto* data = (const unsigned char*)key.data() + prefixSize;
+  epochNum = 0;
+  for (size_t i = 0; i < sizeof(epochNum); i++) {
+    epochNum = (epochNum << 8) | data[i];
+  }
+  data += sizeof(epochNum);
+  shardId = 0;
+  for (size_t i = 0; i < sizeof(shardId); i++) {
+    shardId = (shardId << 8) | data[i];
+  }
+  return true;
+}
+
+// Address first, then the big-endian block number, so the transactions of
+// an address are contiguous and in block order
+string TxnAddressIndexKey(const Address& address, const uint64_t blockNum,
+                          const TxnHash& txnHash) {
+  string key(address.begin(), address.end());
+  for (int shift = 56; shift >= 0; shift -= 8) {
+    key.push_back((char)((blockNum >> shift) & 0xFF));
+  }
+  key.append(txnHash.begin(), txnHash.end());
+  return key;
+}
+
+// Block type, then the big-endian block number, so a page of the listing is
+// a contiguous range
+string BlockHashIndexKey(const BlockType& blockType, const uint64_t blockNum) {
+  string key(1, (char)blockType);
+  for (int shift = 56; shift >= 0; shift -= 8) {
+    key.push_back((char)((blockNum >> shift) & 0xFF));
+  }
+  return key;
+}
+}  // namespace
+
 BlockStorage& BlockStorage::GetBlockStorage(const std::string& path,
                                             bool diagnostic) {
   static BlockStorage bs(path, diagnostic);
@@ -46,10 +109,18 @@ bool BlockStorage::PutBlock(const uint64_t& blockNum, const bytes& body,
                             const BlockType& blockType) {
   int ret = -1;  // according to LevelDB::Insert return value
   if (blockType == BlockType::DS) {
-    ret = m_dsBlockchainDB->Insert(blockNum, body);
+    if (m_dsBlockArchive) {
+      ret = m_dsBlockArchive->Put(to_string(blockNum), body) ? 0 : -1;
+    } else {
+      ret = m_dsBlockchainDB->Insert(blockNum, body);
+    }
     LOG_GENERAL(INFO, "Stored DsBlock  Num:" << blockNum);
   } else if (blockType == BlockType::Tx) {
-    ret = m_txBlockchainDB->Insert(blockNum, body);
+    if (m_txBlockArchive) {
+      ret = m_txBlockArchive->Put(to_string(blockNum), body) ? 0 : -1;
+    } else {
+      ret = m_txBlockchainDB->Insert(blockNum, body);
+    }
     LOG_GENERAL(INFO, "Stored TxBlock  Num:" << blockNum);
   }
   return (ret == 0);
@@ -100,17 +171,304 @@ bool BlockStorage::PutTxBody(const dev::h256& key, const bytes& body) {
     return false;
   } else  // IS_LOOKUP_NODE
   {
-    ret = m_txBodyDB->Insert(key, body) && m_txBodyTmpDB->Insert(key, body);
+    ret = m_txBodyDB->Insert(key, body);
+    if (ret == 0) {
+      ret = m_txBodyTmpDB->Insert(key, body);
+    }
   }
 
   return (ret == 0);
 }
 
+bool BlockStorage::PutTxBodies(const vector<TransactionWithReceipt>& txns) {
+  if (!LOOKUP_NODE_MODE) {
+    LOG_GENERAL(WARNING, "Non lookup node should not trigger this.");
+    return false;
+  }
+
+  LevelDB::WriteBatch batch;
+  bytes body;
+  for (const auto& twr : txns) {
+    body.clear();
+    twr.Serialize(body, 0);
+    batch.Put(twr.GetTransaction().GetTranID(), body);
+  }
+
+  return m_txBodyDB->Write(batch) && m_txBodyTmpDB->Write(batch);
+}
+
+bool BlockStorage::QueueTxBodies(const vector<TransactionWithReceipt>& txns) {
+  if (!LOOKUP_NODE_MODE) {
+    LOG_GENERAL(WARNING, "Non lookup node should not trigger this.");
+    return false;
+  }
+
+  vector<pair<dev::h256, bytes>> bodies(txns.size());
+  for (size_t i = 0; i < txns.size(); i++) {
+    bodies[i].first = txns[i].GetTransaction().GetTranID();
+    txns[i].Serialize(bodies[i].second, 0);
+  }
+
+  size_t pending = 0;
+  {
+    lock_guard<ProfiledMutex> g(m_mutexPendingTxBodies);
+    for (auto& body : bodies) {
+      m_pendingTxBodies[body.first] = move(body.second);
+    }
+    pending = m_pendingTxBodies.size();
+  }
+
+  if (pending >= MAX_PENDING_TX_BODIES) {
+    // The writer has fallen behind, so hold up the caller instead of
+    // letting the buffer grow
+    return FlushTxBodies();
+  }
+
+  // A dropped post leaves the bodies for the next flush
+  BackgroundWriter::GetInstance().Post(
+      "TxBodies", [this]() { return FlushTxBodies(); });
+  return true;
+}
+
+bool BlockStorage::FlushTxBodies() {
+  lock_guard<mutex> f(m_mutexTxBodyFlush);
+
+  LevelDB::WriteBatch batch;
+  vector<dev::h256> flushed;
+  {
+    lock_guard<ProfiledMutex> g(m_mutexPendingTxBodies);
+    if (m_pendingTxBodies.empty()) {
+      return true;
+    }
+    flushed.reserve(m_pendingTxBodies.size());
+    for (const auto& entry : m_pendingTxBodies) {
+      batch.Put(entry.first, entry.second);
+      flushed.emplace_back(entry.first);
+    }
+  }
+
+  // A body in m_txBodyDB but not in the tmp db would survive recovery
+  if (!m_txBodyTmpDB->Write(batch) || !m_txBodyDB->Write(batch)) {
+    LOG_GENERAL(WARNING, "Failed to write " << flushed.size()
+                                            << " buffered txn bodies");
+    return false;
+  }
+
+  lock_guard<ProfiledMutex> g(m_mutexPendingTxBodies);
+  for (const auto& key : flushed) {
+    m_pendingTxBodies.erase(key);
+  }
+  return true;
+}
+
+bool BlockStorage::PutTxnAddressIndex(
+    const uint64_t& blockNum, const vector<TransactionWithReceipt>& txns) {
+  if (!m_txnAddressIndexDB) {
+    return true;
+  }
+
+  LevelDB::WriteBatch batch;
+  for (const auto& twr : txns) {
+    const Transaction& txn = twr.GetTransaction();
+    const Address& from = txn.GetSenderAddr();
+    batch.Put(
+        leveldb::Slice(TxnAddressIndexKey(from, blockNum, txn.GetTranID())),
+        leveldb::Slice());
+    if (txn.GetToAddr() != from && txn.GetToAddr() != NullAddress) {
+      batch.Put(leveldb::Slice(TxnAddressIndexKey(txn.GetToAddr(), blockNum,
+                                                  txn.GetTranID())),
+                leveldb::Slice());
+    }
+  }
+
+  lock_guard<ProfiledMutex> g(m_mutexTxnAddressIndex);
+  return m_txnAddressIndexDB->Write(batch);
+}
+
+bool BlockStorage::PutBlockHash(const BlockType& blockType,
+                                const uint64_t& blockNum,
+                                const BlockHash& blockHash) {
+  if (!m_blockHashIndexDB) {
+    return true;
+  }
+
+  lock_guard<ProfiledMutex> g(m_mutexBlockHashIndex);
+  return m_blockHashIndexDB->Insert(
+             leveldb::Slice(BlockHashIndexKey(blockType, blockNum)),
+             leveldb::Slice((const char*)blockHash.data(), blockHash.size)) ==
+         0;
+}
+
+bool BlockStorage::GetBlockHashes(const BlockType& blockType,
+                                  const uint64_t& first, const uint64_t& last,
+                                  map<uint64_t, BlockHash>& blockHashes) {
+  blockHashes.clear();
+
+  if (!m_blockHashIndexDB) {
+    return false;
+  }
+
+  const string end = BlockHashIndexKey(blockType, last);
+
+  lock_guard<ProfiledMutex> g(m_mutexBlockHashIndex);
+
+  unique_ptr<leveldb::Iterator> it(
+      m_blockHashIndexDB->GetDB()->NewIterator(leveldb::ReadOptions()));
+  for (it->Seek(BlockHashIndexKey(blockType, first));
+       it->Valid() && it->key().compare(end) <= 0; it->Next()) {
+    if (it->key().size() != end.size() ||
+        it->value().size() != BlockHash::size) {
+      continue;
+    }
+
+    const auto* data = (const unsigned char*)it->key().data() + 1;
+    uint64_t blockNum = 0;
+    for (size_t i = 0; i < sizeof(blockNum); i++) {
+      blockNum = (blockNum << 8) | data[i];
+    }
+    blockHashes.emplace(
+        blockNum,
+        BlockHash(dev::bytesConstRef((const unsigned char*)it->value().data(),
+                                     BlockHash::size)));
+  }
+
+  return true;
+}
+
+bool BlockStorage::PutStateRoot(const uint64_t& blockNum,
+                                const dev::h256& stateRoot) {
+  if (!m_stateRootDB) {
+    return true;
+  }
+
+  lock_guard<ProfiledMutex> g(m_mutexStateRoot);
+  if (0 != m_stateRootDB->Insert(blockNum, stateRoot.asBytes())) {
+    LOG_GENERAL(WARNING, "Failed to put the state root of block " << blockNum);
+    return false;
+  }
+  return true;
+}
+
+bool BlockStorage::GetStateRoot(const uint64_t& blockNum,
+                                dev::h256& stateRoot) {
+  if (!m_stateRootDB) {
+    return false;
+  }
+
+  string dataStr;
+  {
+    lock_guard<ProfiledMutex> g(m_mutexStateRoot);
+    dataStr = m_stateRootDB->Lookup(blockNum);
+  }
+  if (dataStr.size() != dev::h256::size) {
+    return false;
+  }
+  stateRoot = dev::h256(dev::bytesConstRef(
+      (const unsigned char*)dataStr.data(), dataStr.size()));
+  return true;
+}
+
+bool BlockStorage::GetTxnsForAddress(const Address& address, bytes& cursor,
+                                     unsigned int maxCount,
+                                     vector<pair<uint64_t, TxnHash>>& txns) {
+  txns.clear();
+
+  if (!m_txnAddressIndexDB) {
+    LOG_GENERAL(WARNING, "Transaction address index is not enabled");
+    return false;
+  }
+
+  if (maxCount == 0) {
+    LOG_GENERAL(WARNING, "Page size must be positive");
+    return false;
+  }
+
+  const string prefix(address.begin(), address.end());
+  const size_t keySize = prefix.size() + sizeof(uint64_t) + TxnHash::size;
+  if (!cursor.empty() && cursor.size() != keySize - prefix.size()) {
+    LOG_GENERAL(WARNING, "Invalid cursor of size " << cursor.size());
+    return false;
+  }
+  const string start = prefix + string(cursor.begin(), cursor.end());
+
+  lock_guard<ProfiledMutex> g(m_mutexTxnAddressIndex);
+
+  unique_ptr<leveldb::Iterator> it(
+      m_txnAddressIndexDB->GetDB()->NewIterator(leveldb::ReadOptions()));
+  for (it->Seek(start); it->Valid() && it->key().starts_with(prefix);
+       it->Next()) {
+    if (it->key().size() != keySize) {
+      continue;
+    }
+    if (!cursor.empty() && it->key().compare(start) == 0) {
+      continue;
+    }
+    if (txns.size() == maxCount) {
+      // There is more, so resume after the last one returned
+      const string last =
+          TxnAddressIndexKey(address, txns.back().first, txns.back().second);
+      cursor.assign(last.begin() + prefix.size(), last.end());
+      return true;
+    }
+
+    const auto* data = (const unsigned char*)it->key().data() + prefix.size();
+    uint64_t blockNum = 0;
+    for (size_t i = 0; i < sizeof(blockNum); i++) {
+      blockNum = (blockNum << 8) | data[i];
+    }
+    txns.emplace_back(blockNum,
+                      TxnHash(dev::bytesConstRef(data + sizeof(blockNum),
+                                                 TxnHash::size)));
+  }
+
+  cursor.clear();
+  return true;
+}
+
+bool BlockStorage::CommitEpoch(
+    const uint64_t& blockNum, const bytes& txBlock, const bytes& stateDelta,
+    const vector<pair<MetaType, bytes>>& metadata) {
+  LOG_MARKER();
+
+  if (!PutStateDelta(blockNum, stateDelta)) {
+    return false;
+  }
+
+  if (!metadata.empty()) {
+    LevelDB::WriteBatch batch;
+    for (const auto& entry : metadata) {
+      batch.Put(leveldb::Slice(to_string((int)entry.first)),
+                leveldb::Slice(dev::bytesConstRef(&entry.second)));
+    }
+    if (!m_metadataDB->Write(batch)) {
+      LOG_GENERAL(WARNING, "Failed to store metadata of final block "
+                               << blockNum);
+      return false;
+    }
+  }
+
+  return PutTxBlock(blockNum, txBlock);
+}
+
 bool BlockStorage::PutMicroBlock(const BlockHash& blockHash,
-                                 const bytes& body) {
-  int ret = m_microBlockDB->Insert(blockHash, body);
+                                 const uint64_t& epochNum,
+                                 const uint32_t& shardId, const bytes& body) {
+  // The hash ends the index key, so microblocks of the same epoch and shard
+  // do not overwrite each other
+  const string hashHex = blockHash.hex();
+  LevelDB::WriteBatch batch;
+  if (m_microBlockArchive) {
+    // Only the index stays in LevelDB
+    if (!m_microBlockArchive->Put(hashHex, body)) {
+      return false;
+    }
+  } else {
+    batch.Put(blockHash, body);
+  }
+  batch.Put(leveldb::Slice(MicroBlockIndexKey(epochNum, shardId) + hashHex),
+            leveldb::Slice(hashHex));
 
-  return (ret == 0);
+  return m_microBlockDB->Write(batch);
 }
 
 bool BlockStorage::InitiateHistoricalDB(const string& path) {
@@ -152,6 +510,12 @@ bool BlockStorage::GetMicroBlock(const BlockHash& blockHash,
                                  MicroBlockSharedPtr& microblock) {
   LOG_MARKER();
 
+  bytes body;
+  if (m_microBlockArchive && m_microBlockArchive->Get(blockHash.hex(), body)) {
+    microblock = make_shared<MicroBlock>(body, 0);
+    return true;
+  }
+
   string blockString = m_microBlockDB->Lookup(blockHash);
 
   if (blockString.empty()) {
@@ -167,34 +531,72 @@ bool BlockStorage::GetRangeMicroBlocks(const uint64_t lowEpochNum,
                                        const uint64_t hiEpochNum,
                                        const uint32_t loShardId,
                                        const uint32_t hiShardId,
-                                       list<MicroBlockSharedPtr>& blocks) {
+                                       vector<MicroBlockSharedPtr>& blocks) {
   LOG_MARKER();
 
-  leveldb::Iterator* it =
-      m_microBlockDB->GetDB()->NewIterator(leveldb::ReadOptions());
-  for (it->SeekToFirst(); it->Valid(); it->Next()) {
-    string bns = it->key().ToString();
-    string blockString = it->value().ToString();
-    if (blockString.empty()) {
-      LOG_GENERAL(WARNING, "Lost one block in the chain");
-      delete it;
-      return false;
+  // One block per epoch and shard at most, bounded for wide queries
+  const uint64_t maxBlocks =
+      (hiEpochNum - min(lowEpochNum, hiEpochNum) + 1) *
+      (static_cast<uint64_t>(hiShardId - min(loShardId, hiShardId)) + 1);
+  blocks.reserve(blocks.size() + min<uint64_t>(maxBlocks, 4096));
+
+  unique_ptr<leveldb::Iterator> it(
+      m_microBlockDB->GetDB()->NewIterator(leveldb::ReadOptions()));
+
+  uint64_t epochNum = 0;
+  uint32_t shardId = 0;
+  it->Seek(MicroBlockIndexKey(lowEpochNum, loShardId));
+  while (it->Valid() && ParseMicroBlockIndexKey(it->key(), epochNum, shardId) &&
+         epochNum <= hiEpochNum) {
+    if (shardId < loShardId) {
+      it->Seek(MicroBlockIndexKey(epochNum, loShardId));
+      continue;
     }
-    MicroBlockSharedPtr block = MicroBlockSharedPtr(
-        new MicroBlock(bytes(blockString.begin(), blockString.end()), 0));
-
-    if (block->GetHeader().GetEpochNum() < lowEpochNum ||
-        block->GetHeader().GetEpochNum() > hiEpochNum ||
-        block->GetHeader().GetShardId() < loShardId ||
-        block->GetHeader().GetShardId() > hiShardId) {
+    if (shardId > hiShardId) {
+      if (epochNum == hiEpochNum) {
+        break;
+      }
+      it->Seek(MicroBlockIndexKey(epochNum + 1, loShardId));
       continue;
     }
 
+    MicroBlockSharedPtr block;
+    if (!GetMicroBlock(BlockHash(it->value().ToString()), block)) {
+      LOG_GENERAL(WARNING, "Lost one block in the chain");
+      return false;
+    }
     blocks.emplace_back(block);
-    LOG_GENERAL(INFO, "Retrievd MicroBlock Num:" << bns);
+    LOG_GENERAL(INFO, "Retrievd MicroBlock Num:" << it->value().ToString());
+    it->Next();
   }
 
-  delete it;
+  if (blocks.empty()) {
+    // Microblocks stored before the index existed can only be found by
+    // reading them all
+    for (it->SeekToFirst(); it->Valid(); it->Next()) {
+      if (it->key().starts_with(MICROBLOCK_INDEX_PREFIX)) {
+        continue;
+      }
+      string bns = it->key().ToString();
+      string blockString = it->value().ToString();
+      if (blockString.empty()) {
+        LOG_GENERAL(WARNING, "Lost one block in the chain");
+        return false;
+      }
+      MicroBlockSharedPtr block = MicroBlockSharedPtr(
+          new MicroBlock(bytes(blockString.begin(), blockString.end()), 0));
+
+      if (block->GetHeader().GetEpochNum() < lowEpochNum ||
+          block->GetHeader().GetEpochNum() > hiEpochNum ||
+          block->GetHeader().GetShardId() < loShardId ||
+          block->GetHeader().GetShardId() > hiShardId) {
+        continue;
+      }
+
+      blocks.emplace_back(block);
+      LOG_GENERAL(INFO, "Retrievd MicroBlock Num:" << bns);
+    }
+  }
 
   if (blocks.empty()) {
     LOG_GENERAL(INFO, "Disk has no MicroBlock matching the criteria");
@@ -206,6 +608,12 @@ bool BlockStorage::GetRangeMicroBlocks(const uint64_t lowEpochNum,
 
 bool BlockStorage::GetDSBlock(const uint64_t& blockNum,
                               DSBlockSharedPtr& block) {
+  bytes body;
+  if (m_dsBlockArchive && m_dsBlockArchive->Get(to_string(blockNum), body)) {
+    block = make_shared<DSBlock>(body, 0);
+    return true;
+  }
+
   string blockString = m_dsBlockchainDB->Lookup(blockNum);
 
   if (blockString.empty()) {
@@ -242,6 +650,9 @@ bool BlockStorage::ReleaseDB() {
   m_VCBlockDB.reset();
   m_txBlockchainDB.reset();
   m_dsBlockchainDB.reset();
+  m_dsBlockArchive.reset();
+  m_txBlockArchive.reset();
+  m_microBlockArchive.reset();
   m_fallbackBlockDB.reset();
   m_blockLinkDB.reset();
   return true;
@@ -296,6 +707,12 @@ bool BlockStorage::GetBlockLink(const uint64_t& index,
 
 bool BlockStorage::GetTxBlock(const uint64_t& blockNum,
                               TxBlockSharedPtr& block) {
+  bytes body;
+  if (m_txBlockArchive && m_txBlockArchive->Get(to_string(blockNum), body)) {
+    block = make_shared<TxBlock>(body, 0);
+    return true;
+  }
+
   string blockString = m_txBlockchainDB->Lookup(blockNum);
 
   if (blockString.empty()) {
@@ -309,6 +726,15 @@ bool BlockStorage::GetTxBlock(const uint64_t& blockNum,
 }
 
 bool BlockStorage::GetTxBody(const dev::h256& key, TxBodySharedPtr& body) {
+  {
+    lock_guard<ProfiledMutex> g(m_mutexPendingTxBodies);
+    const auto it = m_pendingTxBodies.find(key);
+    if (it != m_pendingTxBodies.end()) {
+      body = make_shared<TransactionWithReceipt>(it->second, 0);
+      return true;
+    }
+  }
+
   std::string bodyString;
 
   bodyString = m_txBodyDB->Lookup(key);
@@ -322,9 +748,133 @@ bool BlockStorage::GetTxBody(const dev::h256& key, TxBodySharedPtr& body) {
   return true;
 }
 
+bool BlockStorage::HasTxBody(const dev::h256& key) {
+  if (!LOOKUP_NODE_MODE) {
+    LOG_GENERAL(WARNING, "Non lookup node should not trigger this");
+    return false;
+  }
+
+  {
+    lock_guard<ProfiledMutex> g(m_mutexPendingTxBodies);
+    if (m_pendingTxBodies.find(key) != m_pendingTxBodies.end()) {
+      return true;
+    }
+  }
+  return m_txBodyDB->Exists(key);
+}
+
+bool BlockStorage::GetTxBodies(const vector<TxnHash>& keys,
+                               vector<TxBodySharedPtr>& bodies) {
+  if (!LOOKUP_NODE_MODE) {
+    LOG_GENERAL(WARNING, "Non lookup node should not trigger this");
+    return false;
+  }
+
+  bodies.clear();
+  if (keys.empty()) {
+    return true;
+  }
+
+  // Read in key order, which is the order LevelDB lays them out on disk
+  vector<size_t> order(keys.size());
+  for (size_t i = 0; i < order.size(); i++) {
+    order[i] = i;
+  }
+  sort(order.begin(), order.end(),
+       [&keys](size_t a, size_t b) { return keys[a] < keys[b]; });
+
+  vector<string> bodyStrings(keys.size());
+  {
+    lock_guard<ProfiledMutex> g(m_mutexTxBody);
+    auto db = m_txBodyDB->GetDB();
+    leveldb::ReadOptions options;
+    options.snapshot = db->GetSnapshot();
+    bool missing = false;
+    lock_guard<ProfiledMutex> p(m_mutexPendingTxBodies);
+    for (const auto& i : order) {
+      const auto it = m_pendingTxBodies.find(keys[i]);
+      if (it != m_pendingTxBodies.end()) {
+        bodyStrings[i].assign(it->second.begin(), it->second.end());
+        continue;
+      }
+      if (!db->Get(options, keys[i].hex(), &bodyStrings[i]).ok()) {
+        LOG_GENERAL(WARNING, "Missing txn body " << keys[i]);
+        missing = true;
+        break;
+      }
+    }
+    db->ReleaseSnapshot(options.snapshot);
+    if (missing) {
+      return false;
+    }
+  }
+
+  vector<unsigned char> parsed(keys.size(), 0);
+  bodies.resize(keys.size());
+  auto parseRange = [&bodyStrings, &bodies, &parsed](size_t begin,
+                                                     size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      bodies[i] = make_shared<TransactionWithReceipt>();
+      parsed[i] = bodies[i]->Deserialize(
+          bytes(bodyStrings[i].begin(), bodyStrings[i].end()), 0);
+    }
+  };
+
+  // The calling thread takes the first job, so small batches never wait on
+  // the pool
+  const size_t MIN_BODIES_PER_PARSE_JOB = 64;
+  const size_t numThreads = m_txBodyParsePool ? TXN_BODY_PARSE_THREADS : 0;
+  const size_t numJobs = min<size_t>(
+      numThreads + 1,
+      (keys.size() + MIN_BODIES_PER_PARSE_JOB - 1) / MIN_BODIES_PER_PARSE_JOB);
+  const size_t jobSize = (keys.size() + numJobs - 1) / numJobs;
+
+  mutex mutexDone;
+  condition_variable cvDone;
+  size_t jobsLeft = 0;
+
+  vector<ThreadPool::Job> jobs;
+  for (size_t begin = jobSize; begin < keys.size(); begin += jobSize) {
+    const size_t end = min(begin + jobSize, keys.size());
+    jobs.emplace_back([&parseRange, &mutexDone, &cvDone, &jobsLeft, begin,
+                       end]() {
+      parseRange(begin, end);
+      lock_guard<mutex> g(mutexDone);
+      if (--jobsLeft == 0) {
+        cvDone.notify_one();
+      }
+    });
+  }
+
+  if (!jobs.empty()) {
+    jobsLeft = jobs.size();
+    m_txBodyParsePool->AddJobs(jobs.begin(), jobs.end());
+  }
+
+  parseRange(0, min(jobSize, keys.size()));
+
+  {
+    unique_lock<mutex> lock(mutexDone);
+    cvDone.wait(lock, [&jobsLeft] { return jobsLeft == 0; });
+  }
+
+  for (size_t i = 0; i < keys.size(); i++) {
+    if (!parsed[i]) {
+      LOG_GENERAL(WARNING, "Failed to parse txn body " << keys[i]);
+      bodies.clear();
+      return false;
+    }
+  }
+
+  return true;
+}
+
 bool BlockStorage::DeleteDSBlock(const uint64_t& blocknum) {
   LOG_GENERAL(INFO, "Delete DSBlock Num: " << blocknum);
   int ret = m_dsBlockchainDB->DeleteKey(blocknum);
+  if (m_dsBlockArchive && !m_dsBlockArchive->Delete(to_string(blocknum))) {
+    return false;
+  }
   return (ret == 0);
 }
 
@@ -341,6 +891,9 @@ bool BlockStorage::DeleteFallbackBlock(const BlockHash& blockhash) {
 bool BlockStorage::DeleteTxBlock(const uint64_t& blocknum) {
   LOG_GENERAL(INFO, "Delete TxBlock Num: " << blocknum);
   int ret = m_txBlockchainDB->DeleteKey(blocknum);
+  if (m_txBlockArchive && !m_txBlockArchive->Delete(to_string(blocknum))) {
+    return false;
+  }
   return (ret == 0);
 }
 
@@ -350,6 +903,10 @@ bool BlockStorage::DeleteTxBody(const dev::h256& key) {
     LOG_GENERAL(WARNING, "Non lookup node should not trigger this");
     return false;
   } else {
+    {
+      lock_guard<ProfiledMutex> g(m_mutexPendingTxBodies);
+      m_pendingTxBodies.erase(key);
+    }
     ret = m_txBodyDB->DeleteKey(key);
   }
 
@@ -373,7 +930,7 @@ bool BlockStorage::DeleteTxBody(const dev::h256& key) {
 //                                             0) );
 // }
 
-bool BlockStorage::GetAllDSBlocks(std::list<DSBlockSharedPtr>& blocks) {
+bool BlockStorage::GetAllDSBlocks(std::vector<DSBlockSharedPtr>& blocks) {
   LOG_MARKER();
 
   leveldb::Iterator* it =
@@ -395,6 +952,21 @@ bool BlockStorage::GetAllDSBlocks(std::list<DSBlockSharedPtr>& blocks) {
 
   delete it;
 
+  if (m_dsBlockArchive) {
+    vector<string> keys;
+    m_dsBlockArchive->GetKeys(keys);
+    blocks.reserve(blocks.size() + keys.size());
+    for (const auto& bns : keys) {
+      bytes body;
+      if (!m_dsBlockArchive->Get(bns, body)) {
+        LOG_GENERAL(WARNING, "Lost one block in the chain");
+        return false;
+      }
+      blocks.emplace_back(make_shared<DSBlock>(body, 0));
+      LOG_GENERAL(INFO, "Retrievd DsBlock Num:" << bns);
+    }
+  }
+
   if (blocks.empty()) {
     LOG_GENERAL(INFO, "Disk has no DSBlock");
     return false;
@@ -403,7 +975,7 @@ bool BlockStorage::GetAllDSBlocks(std::list<DSBlockSharedPtr>& blocks) {
   return true;
 }
 
-bool BlockStorage::GetAllTxBlocks(std::list<TxBlockSharedPtr>& blocks) {
+bool BlockStorage::GetAllTxBlocks(std::vector<TxBlockSharedPtr>& blocks) {
   LOG_MARKER();
 
   leveldb::Iterator* it =
@@ -424,6 +996,21 @@ bool BlockStorage::GetAllTxBlocks(std::list<TxBlockSharedPtr>& blocks) {
 
   delete it;
 
+  if (m_txBlockArchive) {
+    vector<string> keys;
+    m_txBlockArchive->GetKeys(keys);
+    blocks.reserve(blocks.size() + keys.size());
+    for (const auto& bns : keys) {
+      bytes body;
+      if (!m_txBlockArchive->Get(bns, body)) {
+        LOG_GENERAL(WARNING, "Lost one block in the chain");
+        return false;
+      }
+      blocks.emplace_back(make_shared<TxBlock>(body, 0));
+      LOG_GENERAL(INFO, "Retrievd TxBlock Num:" << bns);
+    }
+  }
+
   if (blocks.empty()) {
     LOG_GENERAL(INFO, "Disk has no TxBlock");
     return false;
@@ -432,7 +1019,54 @@ bool BlockStorage::GetAllTxBlocks(std::list<TxBlockSharedPtr>& blocks) {
   return true;
 }
 
-bool BlockStorage::GetAllTxBodiesTmp(std::list<TxnHash>& txnHashes) {
+bool BlockStorage::GetAllTxBlockNums(vector<uint64_t>& blockNums) {
+  LOG_MARKER();
+
+  // Keys are decimal block numbers, which do not iterate in numeric order
+  unique_ptr<leveldb::Iterator> it(
+      m_txBlockchainDB->GetDB()->NewIterator(leveldb::ReadOptions()));
+  for (it->SeekToFirst(); it->Valid(); it->Next()) {
+    const string bns = it->key().ToString();
+    try {
+      blockNums.emplace_back(stoull(bns));
+    } catch (const exception& e) {
+      LOG_GENERAL(WARNING, "Invalid TxBlock key " << bns << ": " << e.what());
+      return false;
+    }
+    if (blockNums.size() % 100000 == 0) {
+      LOG_GENERAL(INFO, "Scanned " << blockNums.size() << " TxBlocks");
+    }
+  }
+
+  if (m_txBlockArchive) {
+    vector<string> keys;
+    m_txBlockArchive->GetKeys(keys);
+    for (const auto& bns : keys) {
+      try {
+        blockNums.emplace_back(stoull(bns));
+      } catch (const exception& e) {
+        LOG_GENERAL(WARNING,
+                    "Invalid TxBlock key " << bns << ": " << e.what());
+        return false;
+      }
+    }
+  }
+
+  if (blockNums.empty()) {
+    LOG_GENERAL(INFO, "Disk has no TxBlock");
+    return false;
+  }
+
+  sort(blockNums.begin(), blockNums.end());
+  // A block re-stored after enabling the archive is in both
+  blockNums.erase(unique(blockNums.begin(), blockNums.end()), blockNums.end());
+  LOG_GENERAL(INFO, "Disk has " << blockNums.size() << " TxBlocks, last "
+                                << blockNums.back());
+
+  return true;
+}
+
+bool BlockStorage::GetAllTxBodiesTmp(std::vector<TxnHash>& txnHashes) {
   if (!LOOKUP_NODE_MODE) {
     LOG_GENERAL(WARNING,
                 "BlockStorage::GetAllTxBodiesTmp not expected to be called "
@@ -459,7 +1093,7 @@ bool BlockStorage::GetAllTxBodiesTmp(std::list<TxnHash>& txnHashes) {
   return true;
 }
 
-bool BlockStorage::GetAllBlockLink(std::list<BlockLink>& blocklinks) {
+bool BlockStorage::GetAllBlockLink(std::vector<BlockLink>& blocklinks) {
   LOG_MARKER();
   leveldb::Iterator* it =
       m_blockLinkDB->GetDB()->NewIterator(leveldb::ReadOptions());
@@ -520,7 +1154,7 @@ bool BlockStorage::PutDSCommittee(const shared_ptr<DequeOfNode>& dsCommittee,
                                   const uint16_t& consensusLeaderID) {
   LOG_MARKER();
 
-  lock_guard<mutex> g(m_mutexDsCommittee);
+  lock_guard<ProfiledMutex> g(m_mutexDsCommittee);
   m_dsCommitteeDB->ResetDB();
   unsigned int index = 0;
   string leaderId = to_string(consensusLeaderID);
@@ -559,7 +1193,7 @@ bool BlockStorage::GetDSCommittee(
   LOG_MARKER();
 
   unsigned int index = 0;
-  lock_guard<mutex> g(m_mutexDsCommittee);
+  lock_guard<ProfiledMutex> g(m_mutexDsCommittee);
   string strConsensusLeaderID = m_dsCommitteeDB->Lookup(index++);
 
   if (strConsensusLeaderID.empty()) {
@@ -593,7 +1227,7 @@ bool BlockStorage::PutShardStructure(const DequeOfShard& shards,
                                      const uint32_t myshardId) {
   LOG_MARKER();
 
-  lock_guard<mutex> g(m_mutexShardStructure);
+  lock_guard<ProfiledMutex> g(m_mutexShardStructure);
   m_shardStructureDB->ResetDB();
   unsigned int index = 0;
   string shardId = to_string(myshardId);
@@ -630,7 +1264,7 @@ bool BlockStorage::GetShardStructure(DequeOfShard& shards) {
   string dataStr;
 
   {
-    lock_guard<mutex> g(m_mutexShardStructure);
+    lock_guard<ProfiledMutex> g(m_mutexShardStructure);
     dataStr = m_shardStructureDB->Lookup(index++);
   }
 
@@ -662,6 +1296,20 @@ bool BlockStorage::PutStateDelta(const uint64_t& finalBlockNum,
 
   LOG_PAYLOAD(INFO, "Stored state delta of final block " << finalBlockNum,
               stateDelta, Logger::MAX_BYTES_TO_DISPLAY);
+
+  if (STATE_DELTA_RETENTION_BLOCKS > 0) {
+    // Deltas since the start of the DS epoch are replayed on restart, so at
+    // least a DS epoch worth of them is always kept
+    const uint64_t retention = max<uint64_t>(STATE_DELTA_RETENTION_BLOCKS,
+                                             NUM_FINAL_BLOCK_PER_POW);
+    if (finalBlockNum >= retention) {
+      const uint64_t firstKept = finalBlockNum + 1 - retention;
+      // Skipped if the executor is busy, the next block prunes these too
+      AsyncExecutor::GetInstance().Post(
+          [this, firstKept]() { PruneStateDeltas(firstKept); });
+    }
+  }
+
   return true;
 }
 
@@ -676,6 +1324,55 @@ bool BlockStorage::GetStateDelta(const uint64_t& finalBlockNum,
   return true;
 }
 
+bool BlockStorage::PruneStateDeltas(const uint64_t& firstKeptBlockNum) {
+  LOG_MARKER();
+
+  lock_guard<ProfiledMutex> g(m_mutexStateDeltaPrune);
+
+  if (!m_stateDeltaPruneScanned) {
+    // Keys are decimal block numbers, so finding the oldest takes one scan
+    uint64_t oldest = firstKeptBlockNum;
+    unique_ptr<leveldb::Iterator> it(
+        m_stateDeltaDB->GetDB()->NewIterator(leveldb::ReadOptions()));
+    for (it->SeekToFirst(); it->Valid(); it->Next()) {
+      try {
+        oldest = min<uint64_t>(oldest, stoull(it->key().ToString()));
+      } catch (const exception& e) {
+        LOG_GENERAL(WARNING, "Invalid state delta key "
+                                 << it->key().ToString() << ": " << e.what());
+      }
+    }
+    m_stateDeltaPrunedUpTo = oldest;
+    m_stateDeltaPruneScanned = true;
+  }
+
+  if (firstKeptBlockNum <= m_stateDeltaPrunedUpTo) {
+    return true;
+  }
+
+  const uint64_t BATCH_SIZE = 10000;
+  for (uint64_t begin = m_stateDeltaPrunedUpTo; begin < firstKeptBlockNum;
+       begin += BATCH_SIZE) {
+    const uint64_t end = min(firstKeptBlockNum, begin + BATCH_SIZE);
+
+    LevelDB::WriteBatch batch;
+    for (uint64_t blockNum = begin; blockNum < end; blockNum++) {
+      batch.Delete(blockNum);
+    }
+
+    if (!m_stateDeltaDB->Write(batch)) {
+      LOG_GENERAL(WARNING, "Failed to prune state deltas " << begin << " to "
+                                                           << end - 1);
+      return false;
+    }
+    m_stateDeltaPrunedUpTo = end;
+  }
+
+  LOG_GENERAL(INFO, "Pruned state deltas before final block "
+                        << firstKeptBlockNum);
+  return true;
+}
+
 bool BlockStorage::PutDiagnosticData(const uint64_t& dsBlockNum,
                                      const DequeOfShard& shards,
                                      const DequeOfNode& dsCommittee) {
@@ -689,7 +1386,7 @@ bool BlockStorage::PutDiagnosticData(const uint64_t& dsBlockNum,
     return false;
   }
 
-  lock_guard<mutex> g(m_mutexDiagnostic);
+  lock_guard<ProfiledMutex> g(m_mutexDiagnostic);
 
   if (0 != m_diagnosticDB->Insert(dsBlockNum, data)) {
     LOG_GENERAL(WARNING, "Failed to store diagnostic data");
@@ -709,7 +1406,7 @@ bool BlockStorage::GetDiagnosticData(const uint64_t& dsBlockNum,
   string dataStr;
 
   {
-    lock_guard<mutex> g(m_mutexDiagnostic);
+    lock_guard<ProfiledMutex> g(m_mutexDiagnostic);
     dataStr = m_diagnosticDB->Lookup(dsBlockNum);
   }
 
@@ -751,7 +1448,7 @@ void BlockStorage::GetDiagnosticData(
     map<uint64_t, DiagnosticData>& diagnosticDataMap) {
   LOG_MARKER();
 
-  lock_guard<mutex> g(m_mutexDiagnostic);
+  lock_guard<ProfiledMutex> g(m_mutexDiagnostic);
 
   leveldb::Iterator* it =
       m_diagnosticDB->GetDB()->NewIterator(leveldb::ReadOptions());
@@ -816,12 +1513,12 @@ void BlockStorage::GetDiagnosticData(
 }
 
 unsigned int BlockStorage::GetDiagnosticDataCount() {
-  lock_guard<mutex> g(m_mutexDiagnostic);
+  lock_guard<ProfiledMutex> g(m_mutexDiagnostic);
   return m_diagnosticDBCounter;
 }
 
 bool BlockStorage::DeleteDiagnosticData(const uint64_t& dsBlockNum) {
-  lock_guard<mutex> g(m_mutexDiagnostic);
+  lock_guard<ProfiledMutex> g(m_mutexDiagnostic);
   bool result = (0 == m_diagnosticDB->DeleteKey(dsBlockNum));
   if (result) {
     m_diagnosticDBCounter--;
@@ -833,73 +1530,105 @@ bool BlockStorage::ResetDB(DBTYPE type) {
   bool ret = false;
   switch (type) {
     case META: {
-      lock_guard<mutex> g(m_mutexMetadata);
+      lock_guard<ProfiledMutex> g(m_mutexMetadata);
       ret = m_metadataDB->ResetDB();
       break;
     }
     case DS_BLOCK: {
-      lock_guard<mutex> g(m_mutexDsBlockchain);
+      lock_guard<ProfiledMutex> g(m_mutexDsBlockchain);
       ret = m_dsBlockchainDB->ResetDB();
+      if (m_dsBlockArchive) {
+        ret = m_dsBlockArchive->Reset() && ret;
+      }
       break;
     }
     case TX_BLOCK: {
-      lock_guard<mutex> g(m_mutexTxBlockchain);
+      lock_guard<ProfiledMutex> g(m_mutexTxBlockchain);
       ret = m_txBlockchainDB->ResetDB();
+      if (m_txBlockArchive) {
+        ret = m_txBlockArchive->Reset() && ret;
+      }
       break;
     }
     case TX_BODY: {
-      lock_guard<mutex> g(m_mutexTxBody);
+      {
+        lock_guard<ProfiledMutex> p(m_mutexPendingTxBodies);
+        m_pendingTxBodies.clear();
+      }
+      lock_guard<ProfiledMutex> g(m_mutexTxBody);
       ret = m_txBodyDB->ResetDB();
       break;
     }
     case TX_BODY_TMP: {
-      lock_guard<mutex> g(m_mutexTxBodyTmp);
-      ret = m_txBodyTmpDB->ResetDB();
+      // Buffered bodies are covered by the tmp db until written
+      ret = FlushTxBodies();
+      lock_guard<ProfiledMutex> g(m_mutexTxBodyTmp);
+      ret = m_txBodyTmpDB->ResetDB() && ret;
       break;
     }
     case MICROBLOCK: {
-      lock_guard<mutex> g(m_mutexMicroBlock);
+      lock_guard<ProfiledMutex> g(m_mutexMicroBlock);
       ret = m_microBlockDB->ResetDB();
+      if (m_microBlockArchive) {
+        ret = m_microBlockArchive->Reset() && ret;
+      }
       break;
     }
     case DS_COMMITTEE: {
-      lock_guard<mutex> g(m_mutexDsCommittee);
+      lock_guard<ProfiledMutex> g(m_mutexDsCommittee);
       ret = m_dsCommitteeDB->ResetDB();
       break;
     }
     case VC_BLOCK: {
-      lock_guard<mutex> g(m_mutexVCBlock);
+      lock_guard<ProfiledMutex> g(m_mutexVCBlock);
       ret = m_VCBlockDB->ResetDB();
       break;
     }
     case FB_BLOCK: {
-      lock_guard<mutex> g(m_mutexFallbackBlock);
+      lock_guard<ProfiledMutex> g(m_mutexFallbackBlock);
       ret = m_fallbackBlockDB->ResetDB();
       break;
     }
     case BLOCKLINK: {
-      lock_guard<mutex> g(m_mutexBlockLink);
+      lock_guard<ProfiledMutex> g(m_mutexBlockLink);
       ret = m_blockLinkDB->ResetDB();
       break;
     }
     case SHARD_STRUCTURE: {
-      lock_guard<mutex> g(m_mutexShardStructure);
+      lock_guard<ProfiledMutex> g(m_mutexShardStructure);
       ret = m_shardStructureDB->ResetDB();
       break;
     }
     case STATE_DELTA: {
-      lock_guard<mutex> g(m_mutexStateDelta);
+      lock_guard<ProfiledMutex> g(m_mutexStateDelta);
       ret = m_stateDeltaDB->ResetDB();
+      lock_guard<ProfiledMutex> g2(m_mutexStateDeltaPrune);
+      m_stateDeltaPruneScanned = false;
       break;
     }
     case DIAGNOSTIC: {
-      lock_guard<mutex> g(m_mutexDiagnostic);
+      lock_guard<ProfiledMutex> g(m_mutexDiagnostic);
       ret = m_diagnosticDB->ResetDB();
       if (ret) {
         m_diagnosticDBCounter = 0;
       }
       break;
     }
+    case TXN_ADDRESS_INDEX: {
+      lock_guard<ProfiledMutex> g(m_mutexTxnAddressIndex);
+      ret = !m_txnAddressIndexDB || m_txnAddressIndexDB->ResetDB();
+      break;
+    }
+    case BLOCK_HASH_INDEX: {
+      lock_guard<ProfiledMutex> g(m_mutexBlockHashIndex);
+      ret = !m_blockHashIndexDB || m_blockHashIndexDB->ResetDB();
+      break;
+    }
+    case STATE_ROOT: {
+      lock_guard<ProfiledMutex> g(m_mutexStateRoot);
+      ret = !m_stateRootDB || m_stateRootDB->ResetDB();
+      break;
+    }
   }
   if (!ret) {
     LOG_GENERAL(INFO, "FAIL: Reset DB " << type << " failed");
@@ -907,74 +1636,138 @@ bool BlockStorage::ResetDB(DBTYPE type) {
   return ret;
 }
 
+MemoryUsage BlockStorage::GetMemoryUsage() {
+  MemoryUsage usage;
+  auto add = [&usage](ProfiledMutex& m, const shared_ptr<LevelDB>& db) {
+    lock_guard<ProfiledMutex> g(m);
+    if (db) {
+      usage.m_bytes += db->GetApproximateMemoryUsage();
+      usage.m_objects++;
+    }
+  };
+  add(m_mutexMetadata, m_metadataDB);
+  add(m_mutexDsBlockchain, m_dsBlockchainDB);
+  add(m_mutexTxBlockchain, m_txBlockchainDB);
+  add(m_mutexTxBody, m_txBodyDB);
+  add(m_mutexTxBodyTmp, m_txBodyTmpDB);
+  add(m_mutexMicroBlock, m_microBlockDB);
+  add(m_mutexDsCommittee, m_dsCommitteeDB);
+  add(m_mutexVCBlock, m_VCBlockDB);
+  add(m_mutexFallbackBlock, m_fallbackBlockDB);
+  add(m_mutexBlockLink, m_blockLinkDB);
+  add(m_mutexShardStructure, m_shardStructureDB);
+  add(m_mutexStateDelta, m_stateDeltaDB);
+  add(m_mutexDiagnostic, m_diagnosticDB);
+  add(m_mutexTxnAddressIndex, m_txnAddressIndexDB);
+  add(m_mutexBlockHashIndex, m_blockHashIndexDB);
+  add(m_mutexStateRoot, m_stateRootDB);
+  return usage;
+}
+
 std::vector<std::string> BlockStorage::GetDBName(DBTYPE type) {
   std::vector<std::string> ret;
   switch (type) {
     case META: {
-      lock_guard<mutex> g(m_mutexMetadata);
+      lock_guard<ProfiledMutex> g(m_mutexMetadata);
       ret.push_back(m_metadataDB->GetDBName());
       break;
     }
     case DS_BLOCK: {
-      lock_guard<mutex> g(m_mutexDsBlockchain);
+      lock_guard<ProfiledMutex> g(m_mutexDsBlockchain);
       ret.push_back(m_dsBlockchainDB->GetDBName());
+      if (m_dsBlockArchive) {
+        for (const auto& name : m_dsBlockArchive->GetNames()) {
+          ret.push_back(name);
+        }
+      }
       break;
     }
     case TX_BLOCK: {
-      lock_guard<mutex> g(m_mutexTxBlockchain);
+      lock_guard<ProfiledMutex> g(m_mutexTxBlockchain);
       ret.push_back(m_txBlockchainDB->GetDBName());
+      if (m_txBlockArchive) {
+        for (const auto& name : m_txBlockArchive->GetNames()) {
+          ret.push_back(name);
+        }
+      }
       break;
     }
     case TX_BODY: {
-      lock_guard<mutex> g(m_mutexTxBody);
+      lock_guard<ProfiledMutex> g(m_mutexTxBody);
       ret.push_back(m_txBodyDB->GetDBName());
       break;
     }
     case TX_BODY_TMP: {
-      lock_guard<mutex> g(m_mutexTxBodyTmp);
+      lock_guard<ProfiledMutex> g(m_mutexTxBodyTmp);
       ret.push_back(m_txBodyTmpDB->GetDBName());
       break;
     }
     case MICROBLOCK: {
-      lock_guard<mutex> g(m_mutexMicroBlock);
+      lock_guard<ProfiledMutex> g(m_mutexMicroBlock);
       ret.push_back(m_microBlockDB->GetDBName());
+      if (m_microBlockArchive) {
+        for (const auto& name : m_microBlockArchive->GetNames()) {
+          ret.push_back(name);
+        }
+      }
       break;
     }
     case DS_COMMITTEE: {
-      lock_guard<mutex> g(m_mutexDsCommittee);
+      lock_guard<ProfiledMutex> g(m_mutexDsCommittee);
       ret.push_back(m_dsCommitteeDB->GetDBName());
       break;
     }
     case VC_BLOCK: {
-      lock_guard<mutex> g(m_mutexVCBlock);
+      lock_guard<ProfiledMutex> g(m_mutexVCBlock);
       ret.push_back(m_VCBlockDB->GetDBName());
       break;
     }
     case FB_BLOCK: {
-      lock_guard<mutex> g(m_mutexFallbackBlock);
+      lock_guard<ProfiledMutex> g(m_mutexFallbackBlock);
       ret.push_back(m_fallbackBlockDB->GetDBName());
       break;
     }
     case BLOCKLINK: {
-      lock_guard<mutex> g(m_mutexBlockLink);
+      lock_guard<ProfiledMutex> g(m_mutexBlockLink);
       ret.push_back(m_blockLinkDB->GetDBName());
       break;
     }
     case SHARD_STRUCTURE: {
-      lock_guard<mutex> g(m_mutexShardStructure);
+      lock_guard<ProfiledMutex> g(m_mutexShardStructure);
       ret.push_back(m_shardStructureDB->GetDBName());
       break;
     }
     case STATE_DELTA: {
-      lock_guard<mutex> g(m_mutexStateDelta);
+      lock_guard<ProfiledMutex> g(m_mutexStateDelta);
       ret.push_back(m_stateDeltaDB->GetDBName());
       break;
     }
     case DIAGNOSTIC: {
-      lock_guard<mutex> g(m_mutexDiagnostic);
+      lock_guard<ProfiledMutex> g(m_mutexDiagnostic);
       ret.push_back(m_diagnosticDB->GetDBName());
       break;
     }
+    case TXN_ADDRESS_INDEX: {
+      lock_guard<ProfiledMutex> g(m_mutexTxnAddressIndex);
+      if (m_txnAddressIndexDB) {
+        ret.push_back(m_txnAddressIndexDB->GetDBName());
+      }
+      break;
+    }
+    case BLOCK_HASH_INDEX: {
+      lock_guard<ProfiledMutex> g(m_mutexBlockHashIndex);
+      if (m_blockHashIndexDB) {
+        ret.push_back(m_blockHashIndexDB->GetDBName());
+      }
+      break;
+    }
+    case STATE_ROOT: {
+      lock_guard<ProfiledMutex> g(m_mutexStateRoot);
+      if (m_stateRootDB) {
+        ret.push_back(m_stateRootDB->GetDBName());
+      }
+      break;
+    }
   }
 
   return ret;
@@ -994,6 +1787,8 @@ bool BlockStorage::ResetAll() {
            ResetDB(TX_BODY) & ResetDB(TX_BODY_TMP) & ResetDB(MICROBLOCK) &
            ResetDB(DS_COMMITTEE) & ResetDB(VC_BLOCK) & ResetDB(FB_BLOCK) &
            ResetDB(BLOCKLINK) & ResetDB(SHARD_STRUCTURE) &
-           ResetDB(STATE_DELTA) & ResetDB(DIAGNOSTIC);
+           ResetDB(STATE_DELTA) & ResetDB(DIAGNOSTIC) &
+           ResetDB(TXN_ADDRESS_INDEX) & ResetDB(BLOCK_HASH_INDEX) &
+           ResetDB(STATE_ROOT);
   }
 }
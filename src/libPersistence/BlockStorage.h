@@ -19,14 +19,20 @@
 #define BLOCKSTORAGE_H
 
 #include <list>
+#include <map>
 #include <mutex>
 #include <shared_mutex>
+#include <unordered_map>
 #include <vector>
 
+#include "BlockArchive.h"
 #include "common/Singleton.h"
 #include "depends/libDatabase/LevelDB.h"
 #include "libData/BlockData/Block.h"
 #include "libData/BlockData/Block/FallbackBlockWShardingStructure.h"
+#include "libUtils/LockProfiler.h"
+#include "libUtils/MemoryStats.h"
+#include "libUtils/ThreadPool.h"
 
 typedef std::tuple<uint32_t, uint64_t, uint64_t, BlockType, BlockHash>
     BlockLink;
@@ -65,6 +71,20 @@ class BlockStorage : public Singleton<BlockStorage> {
   /// used for historical data
   std::shared_ptr<LevelDB> m_txnHistoricalDB;
   std::shared_ptr<LevelDB> m_MBHistoricalDB;
+  /// address -> (block number, txn hash), only with ENABLE_TXN_ADDRESS_INDEX
+  std::shared_ptr<LevelDB> m_txnAddressIndexDB;
+  /// (block type, block number) -> block hash, for the block listings of
+  /// LOOKUP_NODE_MODE
+  std::shared_ptr<LevelDB> m_blockHashIndexDB;
+  /// final block number -> state root, only with STATE_ARCHIVE_MODE
+  std::shared_ptr<LevelDB> m_stateRootDB;
+  /// block bodies, only with BLOCK_ARCHIVE_ENABLED; blocks stored before
+  /// it was enabled are still read from the LevelDBs above
+  std::shared_ptr<BlockArchive> m_dsBlockArchive;
+  std::shared_ptr<BlockArchive> m_txBlockArchive;
+  std::shared_ptr<BlockArchive> m_microBlockArchive;
+  /// parses the bodies fetched by GetTxBodies, only for LOOKUP_NODE_MODE
+  std::unique_ptr<ThreadPool> m_txBodyParsePool;
 
   BlockStorage(const std::string& path = "", bool diagnostic = false)
       : m_metadataDB(std::make_shared<LevelDB>("metadata")),
@@ -80,9 +100,30 @@ class BlockStorage : public Singleton<BlockStorage> {
         m_diagnosticDB(
             std::make_shared<LevelDB>("diagnostic", path, diagnostic)),
         m_diagnosticDBCounter(0) {
+    if (BLOCK_ARCHIVE_ENABLED) {
+      const uint64_t segmentSize =
+          (uint64_t)BLOCK_ARCHIVE_SEGMENT_SIZE_MB * 1024 * 1024;
+      m_dsBlockArchive =
+          std::make_shared<BlockArchive>("dsBlocksArchive", segmentSize);
+      m_txBlockArchive =
+          std::make_shared<BlockArchive>("txBlocksArchive", segmentSize);
+      m_microBlockArchive =
+          std::make_shared<BlockArchive>("microBlocksArchive", segmentSize);
+    }
     if (LOOKUP_NODE_MODE) {
       m_txBodyDB = std::make_shared<LevelDB>("txBodies");
       m_txBodyTmpDB = std::make_shared<LevelDB>("txBodiesTmp");
+      if (TXN_BODY_PARSE_THREADS > 0) {
+        m_txBodyParsePool = std::make_unique<ThreadPool>(
+            TXN_BODY_PARSE_THREADS, "TxBodyParsePool");
+      }
+      if (ENABLE_TXN_ADDRESS_INDEX) {
+        m_txnAddressIndexDB = std::make_shared<LevelDB>("txnAddressIndex");
+      }
+      m_blockHashIndexDB = std::make_shared<LevelDB>("blockHashIndex");
+      if (STATE_ARCHIVE_MODE) {
+        m_stateRootDB = std::make_shared<LevelDB>("stateRoots");
+      }
     }
   };
   ~BlockStorage() = default;
@@ -103,7 +144,10 @@ class BlockStorage : public Singleton<BlockStorage> {
     BLOCKLINK,
     SHARD_STRUCTURE,
     STATE_DELTA,
-    DIAGNOSTIC
+    DIAGNOSTIC,
+    TXN_ADDRESS_INDEX,
+    BLOCK_HASH_INDEX,
+    STATE_ROOT
   };
 
   /// Returns the singleton BlockStorage instance.
@@ -124,12 +168,43 @@ class BlockStorage : public Singleton<BlockStorage> {
   /// Adds a Tx block to storage.
   bool PutTxBlock(const uint64_t& blockNum, const bytes& body);
 
-  // /// Adds a micro block to storage.
-  bool PutMicroBlock(const BlockHash& blockHash, const bytes& body);
+  /// Adds a micro block to storage, indexed by its epoch and shard.
+  bool PutMicroBlock(const BlockHash& blockHash, const uint64_t& epochNum,
+                     const uint32_t& shardId, const bytes& body);
 
   /// Adds a transaction body to storage.
   bool PutTxBody(const dev::h256& key, const bytes& body);
 
+  /// Adds the transaction bodies to storage in a single write.
+  bool PutTxBodies(const std::vector<TransactionWithReceipt>& txns);
+
+  /// Buffers the transaction bodies, readable right away, and leaves the
+  /// write to the BackgroundWriter. Once MAX_PENDING_TX_BODIES are buffered
+  /// they are written here instead.
+  bool QueueTxBodies(const std::vector<TransactionWithReceipt>& txns);
+
+  /// Writes the buffered transaction bodies, to the tmp db first so that
+  /// recovery can still undo them. Bodies that fail stay buffered.
+  bool FlushTxBodies();
+
+  /// Indexes the transactions of a final block by sender and recipient
+  bool PutTxnAddressIndex(const uint64_t& blockNum,
+                          const std::vector<TransactionWithReceipt>& txns);
+
+  /// Retrieves up to maxCount (block number, txn hash) pairs involving
+  /// address, in block order, after cursor (empty for the first page).
+  /// cursor is then set to resume the scan, or cleared if it is done.
+  bool GetTxnsForAddress(const Address& address, bytes& cursor,
+                         unsigned int maxCount,
+                         std::vector<std::pair<uint64_t, TxnHash>>& txns);
+
+  /// Stores a final block together with its state delta and metadata, one
+  /// write per database. The Tx block is written last, so a crash part way
+  /// leaves no stored block without its state delta.
+  bool CommitEpoch(
+      const uint64_t& blockNum, const bytes& txBlock, const bytes& stateDelta,
+      const std::vector<std::pair<MetaType, bytes>>& metadata = {});
+
   /// Retrieves the requested DS block.
   bool GetDSBlock(const uint64_t& blockNum, DSBlockSharedPtr& block);
 
@@ -147,15 +222,24 @@ class BlockStorage : public Singleton<BlockStorage> {
   bool GetMicroBlock(const BlockHash& blockHash,
                      MicroBlockSharedPtr& microblock);
 
-  // /// Retrieves the range Micro blocks
+  /// Retrieves the micro blocks within the epoch and shard ranges, both
+  /// inclusive, from the epoch and shard index
   bool GetRangeMicroBlocks(const uint64_t lowEpochNum,
                            const uint64_t hiEpochNum, const uint32_t loShardId,
                            const uint32_t hiShardId,
-                           std::list<MicroBlockSharedPtr>& blocks);
+                           std::vector<MicroBlockSharedPtr>& blocks);
 
   /// Retrieves the requested transaction body.
   bool GetTxBody(const dev::h256& key, TxBodySharedPtr& body);
 
+  /// Checks for a transaction body without reading it
+  bool HasTxBody(const dev::h256& key);
+
+  /// Retrieves the requested transaction bodies, in the order of keys, from
+  /// one consistent view of the db. Fails if any of them is missing.
+  bool GetTxBodies(const std::vector<TxnHash>& keys,
+                   std::vector<TxBodySharedPtr>& bodies);
+
   bool GetTxnFromHistoricalDB(const dev::h256& key, TxBodySharedPtr& body);
 
   bool GetHistoricalMicroBlock(const BlockHash& blockhash,
@@ -185,16 +269,20 @@ class BlockStorage : public Singleton<BlockStorage> {
   // void GetTxBody(const std::string & key, TxBodySharedPtr & body);
 
   /// Retrieves all the DSBlocks
-  bool GetAllDSBlocks(std::list<DSBlockSharedPtr>& blocks);
+  bool GetAllDSBlocks(std::vector<DSBlockSharedPtr>& blocks);
 
   /// Retrieves all the TxBlocks
-  bool GetAllTxBlocks(std::list<TxBlockSharedPtr>& blocks);
+  bool GetAllTxBlocks(std::vector<TxBlockSharedPtr>& blocks);
+
+  /// Retrieves the numbers of all the stored TxBlocks in ascending order,
+  /// without deserializing the blocks
+  bool GetAllTxBlockNums(std::vector<uint64_t>& blockNums);
 
   /// Retrieves all the TxBodiesTmp
-  bool GetAllTxBodiesTmp(std::list<TxnHash>& txnHashes);
+  bool GetAllTxBodiesTmp(std::vector<TxnHash>& txnHashes);
 
   /// Retrieve all the blocklink
-  bool GetAllBlockLink(std::list<BlockLink>& blocklinks);
+  bool GetAllBlockLink(std::vector<BlockLink>& blocklinks);
 
   /// Save Last Transactions Trie Root Hash
   bool PutMetadata(MetaType type, const bytes& data);
@@ -202,6 +290,23 @@ class BlockStorage : public Singleton<BlockStorage> {
   /// Retrieve Last Transactions Trie Root Hash
   bool GetMetadata(MetaType type, bytes& data);
 
+  /// Records the hash of a committed DS or Tx block for the block listings
+  bool PutBlockHash(const BlockType& blockType, const uint64_t& blockNum,
+                    const BlockHash& blockHash);
+
+  /// Retrieves the recorded hashes of the blocks numbered first to last;
+  /// blocks without one are left out
+  bool GetBlockHashes(const BlockType& blockType, const uint64_t& first,
+                      const uint64_t& last,
+                      std::map<uint64_t, BlockHash>& blockHashes);
+
+  /// Records the state root after final block blockNum, once the trie
+  /// nodes under it are on disk
+  bool PutStateRoot(const uint64_t& blockNum, const dev::h256& stateRoot);
+
+  /// Retrieves the state root recorded for final block blockNum
+  bool GetStateRoot(const uint64_t& blockNum, dev::h256& stateRoot);
+
   /// Save DS committee
   bool PutDSCommittee(const std::shared_ptr<DequeOfNode>& dsCommittee,
                       const uint16_t& consensusLeaderID);
@@ -222,6 +327,9 @@ class BlockStorage : public Singleton<BlockStorage> {
   /// Retrieve state delta
   bool GetStateDelta(const uint64_t& finalBlockNum, bytes& stateDelta);
 
+  /// Delete the state deltas of the final blocks before firstKeptBlockNum
+  bool PruneStateDeltas(const uint64_t& firstKeptBlockNum);
+
   /// Save data for diagnostic / monitoring purposes
   bool PutDiagnosticData(const uint64_t& dsBlockNum, const DequeOfShard& shards,
                          const DequeOfNode& dsCommittee);
@@ -244,25 +352,44 @@ class BlockStorage : public Singleton<BlockStorage> {
 
   std::vector<std::string> GetDBName(DBTYPE type);
 
+  /// Returns the memory leveldb estimates for the memtables and block caches
+  /// of all open databases, the historical ones excepted
+  MemoryUsage GetMemoryUsage();
+
   /// Clean all DB
   bool ResetAll();
 
  private:
-  std::mutex m_mutexMetadata;
-  std::mutex m_mutexDsBlockchain;
-  std::mutex m_mutexTxBlockchain;
-  std::mutex m_mutexMicroBlock;
-  std::mutex m_mutexDsCommittee;
-  std::mutex m_mutexVCBlock;
-  std::mutex m_mutexFallbackBlock;
-  std::mutex m_mutexBlockLink;
-  std::mutex m_mutexShardStructure;
-  std::mutex m_mutexStateDelta;
-  std::mutex m_mutexTxBody;
-  std::mutex m_mutexTxBodyTmp;
-  std::mutex m_mutexDiagnostic;
+  ProfiledMutex m_mutexMetadata{"BlockStorage::Metadata"};
+  ProfiledMutex m_mutexDsBlockchain{"BlockStorage::DsBlockchain"};
+  ProfiledMutex m_mutexTxBlockchain{"BlockStorage::TxBlockchain"};
+  ProfiledMutex m_mutexMicroBlock{"BlockStorage::MicroBlock"};
+  ProfiledMutex m_mutexDsCommittee{"BlockStorage::DsCommittee"};
+  ProfiledMutex m_mutexVCBlock{"BlockStorage::VCBlock"};
+  ProfiledMutex m_mutexFallbackBlock{"BlockStorage::FallbackBlock"};
+  ProfiledMutex m_mutexBlockLink{"BlockStorage::BlockLink"};
+  ProfiledMutex m_mutexShardStructure{"BlockStorage::ShardStructure"};
+  ProfiledMutex m_mutexStateDelta{"BlockStorage::StateDelta"};
+  ProfiledMutex m_mutexStateDeltaPrune{"BlockStorage::StateDeltaPrune"};
+  ProfiledMutex m_mutexTxBody{"BlockStorage::TxBody"};
+  ProfiledMutex m_mutexTxBodyTmp{"BlockStorage::TxBodyTmp"};
+  ProfiledMutex m_mutexPendingTxBodies{"BlockStorage::PendingTxBodies"};
+  /// Serializes FlushTxBodies
+  std::mutex m_mutexTxBodyFlush;
+  ProfiledMutex m_mutexDiagnostic{"BlockStorage::Diagnostic"};
+  ProfiledMutex m_mutexTxnAddressIndex{"BlockStorage::TxnAddressIndex"};
+  ProfiledMutex m_mutexBlockHashIndex{"BlockStorage::BlockHashIndex"};
+  ProfiledMutex m_mutexStateRoot{"BlockStorage::StateRoot"};
 
   unsigned int m_diagnosticDBCounter;
+
+  /// Serialized bodies queued by QueueTxBodies and not written yet
+  std::unordered_map<dev::h256, bytes> m_pendingTxBodies;
+
+  // State deltas before this block number have been pruned, valid once the
+  // first pruning has scanned the db for the oldest one
+  uint64_t m_stateDeltaPrunedUpTo = 0;
+  bool m_stateDeltaPruneScanned = false;
 };
 
 #endif  // BLOCKSTORAGE_H
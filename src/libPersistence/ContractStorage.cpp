@@ -15,8 +15,11 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <unordered_set>
+
 #include "ContractStorage.h"
 
+#include "libCrypto/KeyHashCache.h"
 #include "libCrypto/Sha2.h"
 #include "libMessage/Messenger.h"
 #include "libUtils/DataConversion.h"
@@ -25,15 +28,51 @@ using namespace std;
 
 namespace Contract {
 
+namespace {
+/// Fills item with the vname, type and value of a mutable state; returns
+/// false for immutable states and values that cannot be parsed
+bool StateEntryToJson(const StateEntry& entry, Json::Value& item) {
+  const string& tVname = std::get<VNAME>(entry);
+  const bool tMutable = std::get<MUTABLE>(entry);
+  const string& tType = std::get<TYPE>(entry);
+  const string& tValue = std::get<VALUE>(entry);
+
+  if (!tMutable) {
+    return false;
+  }
+
+  item["vname"] = tVname;
+  item["type"] = tType;
+  if (tValue[0] == '[' || tValue[0] == '{') {
+    Json::CharReaderBuilder builder;
+    unique_ptr<Json::CharReader> reader(builder.newCharReader());
+    Json::Value obj;
+    string errors;
+    if (!reader->parse(tValue.c_str(), tValue.c_str() + tValue.size(), &obj,
+                       &errors)) {
+      LOG_GENERAL(WARNING,
+                  "The json object cannot be extracted from Storage: "
+                      << tValue << endl
+                      << "Error: " << errors);
+      return false;
+    }
+    item["value"] = obj;
+  } else {
+    item["value"] = tValue;
+  }
+  return true;
+}
+}  // namespace
+
 Index GetIndex(const dev::h160& address, const string& key,
                unsigned int counter) {
-  SHA2<HASH_TYPE::HASH_VARIANT_256> sha2;
-  sha2.Update(address.asBytes());
-  sha2.Update(DataConversion::StringToCharArray(key));
+  string preimage(reinterpret_cast<const char*>(address.data()),
+                  dev::h160::size);
+  preimage += key;
   if (counter != 0) {
-    sha2.Update(DataConversion::StringToCharArray(to_string(counter)));
+    preimage += to_string(counter);
   }
-  return dev::h256(sha2.Finalize());
+  return KeyHashCache::GetInstance().Get(preimage);
 }
 
 bool ContractStorage::PutContractCode(const dev::h160& address,
@@ -56,18 +95,25 @@ bool ContractStorage::DeleteContractCode(const dev::h160& address) {
 
 bool ContractStorage::CheckIndexExists(const Index& index) {
   return false;
-  return m_stateDataDB.Exists(index.hex()) || t_stateDataDB.Exists(index.hex());
+  return m_stateDataDB.Exists(index.hex()) || m_stateDataCache.count(index);
 }
 
 Index ContractStorage::GetNewIndex(const dev::h160& address,
                                    const string& key) {
   // LOG_MARKER();
+  auto& indexes = m_indexCache[address];
+  const auto it = indexes.find(key);
+  if (it != indexes.end()) {
+    return it->second;
+  }
+
   Index index;
   unsigned int counter = 0;
 
   index = GetIndex(address, key, counter);
   // TODO: avoid index collision
 
+  indexes.emplace(key, index);
   return index;
 }
 
@@ -78,7 +124,11 @@ bool ContractStorage::PutContractState(const dev::h160& address,
   vector<pair<Index, bytes>> entries;
   dev::RLPStream rlpStream(ITEMS_NUM);
   for (const auto& state : states) {
-    Index index = GetNewIndex(address, std::get<VNAME>(state));
+    Index index;
+    {
+      lock_guard<mutex> g(m_mutexCache);
+      index = GetNewIndex(address, std::get<VNAME>(state));
+    }
 
     bytes rawBytes;
     if (!Messenger::SetStateData(rawBytes, 0, state)) {
@@ -97,91 +147,90 @@ bool ContractStorage::PutContractState(
     dev::h256& stateHash) {
   LOG_MARKER();
 
-  vector<Index> new_entry_indexes;
+  lock_guard<mutex> g(m_mutexCache);
 
-  unordered_map<string, string> batch;
+  // Callers may pass only the fields that changed, so the indexes of the
+  // others are kept in their original order
+  vector<Index> new_entry_indexes = GetStateIndexes(address);
+  unordered_set<Index> known(new_entry_indexes.begin(),
+                             new_entry_indexes.end());
 
   for (const auto& entry : entries) {
     // Append the new index to the existing indexes
-    new_entry_indexes.emplace_back(entry.first);
-
-    batch.insert(
-        {entry.first.hex(), DataConversion::CharArrayToString(entry.second)});
-  }
+    if (known.insert(entry.first).second) {
+      new_entry_indexes.emplace_back(entry.first);
+    }
 
-  if (!t_stateDataDB.BatchInsert(batch)) {
-    LOG_GENERAL(WARNING, "BatchInsert t_stateDataDB failed");
-    return false;
+    m_stateDataCache[entry.first] = {
+        DataConversion::CharArrayToString(entry.second), true};
   }
 
   // Update the stateIndexDB
-  if (!SetContractStateIndexes(address, new_entry_indexes)) {
-    // for (const auto& index : new_entry_indexes) {
-    //   t_stateDataDB.DeleteKey(index.hex());
-    // }
-    // TODO: revert the state data if failed
-    return false;
-  }
+  SetContractStateIndexes(address, new_entry_indexes);
 
-  stateHash = GetContractStateHash(address);
+  stateHash = GetStateHash(address);
 
   return true;
 }
 
-bool ContractStorage::SetContractStateIndexes(
+void ContractStorage::SetContractStateIndexes(
     const dev::h160& address, const std::vector<Index>& indexes) {
   // LOG_MARKER();
-
-  bytes rawBytes;
-  if (!Messenger::SetStateIndex(rawBytes, 0, indexes)) {
-    LOG_GENERAL(WARNING, "Messenger::SetStateIndex failed.");
-    return false;
-  }
-
-  return t_stateIndexDB.Insert(address.hex(), rawBytes) == 0;
+  m_stateIndexCache[address] = {indexes, true};
 }
 
-vector<Index> ContractStorage::GetContractStateIndexes(
+const vector<Index>& ContractStorage::GetStateIndexes(
     const dev::h160& address) {
-  // get from stateIndexDB
-  // return DataConversion::StringToCharArray(m_codeDB.Lookup(address.hex()));
   // LOG_MARKER();
-  std::vector<Index> indexes;
+  const auto it = m_stateIndexCache.find(address);
+  if (it != m_stateIndexCache.end()) {
+    return it->second.m_value;
+  }
 
-  string rawBytes;
+  auto& cached = m_stateIndexCache[address];
+  cached.m_dirty = false;
 
-  if (t_stateIndexDB.Exists(address.hex())) {
-    rawBytes = t_stateIndexDB.Lookup(address.hex());
-  } else if (m_stateIndexDB.Exists(address.hex())) {
-    rawBytes = m_stateIndexDB.Lookup(address.hex());
-  } else {
-    return {};
+  const string rawBytes = m_stateIndexDB.Lookup(address.hex());
+  if (rawBytes.empty()) {
+    return cached.m_value;
   }
 
   if (!Messenger::GetStateIndex(bytes(rawBytes.begin(), rawBytes.end()), 0,
-                                indexes)) {
+                                cached.m_value)) {
     LOG_GENERAL(WARNING, "Messenger::GetStateIndex failed.");
-    return {};
+    cached.m_value.clear();
   }
 
-  return indexes;
+  return cached.m_value;
+}
+
+const string& ContractStorage::GetStateData(const Index& index) {
+  // LOG_MARKER();
+  const auto it = m_stateDataCache.find(index);
+  if (it != m_stateDataCache.end()) {
+    return it->second.m_value;
+  }
+
+  auto& cached = m_stateDataCache[index];
+  cached.m_value = m_stateDataDB.Lookup(index.hex());
+  cached.m_dirty = false;
+  return cached.m_value;
+}
+
+vector<Index> ContractStorage::GetContractStateIndexes(
+    const dev::h160& address) {
+  lock_guard<mutex> g(m_mutexCache);
+  return GetStateIndexes(address);
 }
 
 vector<string> ContractStorage::GetContractStatesData(
     const dev::h160& address) {
   // LOG_MARKER();
-  // get indexes
-  vector<Index> indexes = GetContractStateIndexes(address);
-
   vector<string> rawStates;
 
   // return vector of raw protobuf string
-  for (const auto& index : indexes) {
-    if (t_stateDataDB.Exists(index.hex())) {
-      rawStates.push_back(t_stateDataDB.Lookup(index.hex()));
-      continue;
-    }
-    rawStates.push_back(m_stateDataDB.Lookup(index.hex()));
+  for (const auto& index : GetStateIndexes(address)) {
+    rawStates.push_back(GetStateData(index));
   }
 
   return rawStates;
@@ -189,37 +238,66 @@ vector<string> ContractStorage::GetContractStatesData(
 
 string ContractStorage::GetContractStateData(const Index& index) {
   // LOG_MARKER();
-  if (t_stateDataDB.Exists(index.hex())) {
-    return t_stateDataDB.Lookup(index.hex());
+  lock_guard<mutex> g(m_mutexCache);
+  return GetStateData(index);
+}
+
+bool ContractStorage::GetContractStateEntry(const dev::h160& address,
+                                            const string& vname,
+                                            StateEntry& entry) {
+  string rawState;
+  {
+    lock_guard<mutex> g(m_mutexCache);
+    rawState = GetStateData(GetNewIndex(address, vname));
+  }
+  if (rawState.empty()) {
+    return false;
+  }
+
+  if (!Messenger::GetStateData(bytes(rawState.begin(), rawState.end()), 0,
+                               entry)) {
+    LOG_GENERAL(WARNING, "Messenger::GetStateData failed.");
+    return false;
   }
-  return m_stateDataDB.Lookup(index.hex());
+
+  return true;
 }
 
 bool ContractStorage::CommitTempStateDB() {
   LOG_MARKER();
-  // copy everything into m_stateXXDB;
+
+  lock_guard<mutex> g(m_mutexCache);
+
+  // copy everything dirty into m_stateXXDB;
   // Index
   unordered_map<string, std::string> batch;
   unordered_map<string, std::string> reset_buffer;
-  leveldb::Iterator* it =
-      t_stateIndexDB.GetDB()->NewIterator(leveldb::ReadOptions());
-  for (it->SeekToFirst(); it->Valid(); it->Next()) {
-    batch.insert({it->key().ToString(), it->value().ToString()});
-    reset_buffer.insert(
-        {it->key().ToString(), m_stateIndexDB.Lookup(it->key().ToString())});
+  for (const auto& it : m_stateIndexCache) {
+    if (!it.second.m_dirty) {
+      continue;
+    }
+    bytes rawBytes;
+    if (!Messenger::SetStateIndex(rawBytes, 0, it.second.m_value)) {
+      LOG_GENERAL(WARNING, "Messenger::SetStateIndex failed.");
+      return false;
+    }
+    const string key = it.first.hex();
+    batch.insert({key, DataConversion::CharArrayToString(rawBytes)});
+    reset_buffer.insert({key, m_stateIndexDB.Lookup(key)});
   }
   if (!m_stateIndexDB.BatchInsert(batch)) {
-    LOG_GENERAL(WARNING, "BatchInsert t_stateIndexDB failed");
+    LOG_GENERAL(WARNING, "BatchInsert m_stateIndexDB failed");
     return false;
   }
   batch.clear();
   // Data
-  it = t_stateDataDB.GetDB()->NewIterator(leveldb::ReadOptions());
-  for (it->SeekToFirst(); it->Valid(); it->Next()) {
-    batch.insert({it->key().ToString(), it->value().ToString()});
+  for (const auto& it : m_stateDataCache) {
+    if (it.second.m_dirty) {
+      batch.insert({it.first.hex(), it.second.m_value});
+    }
   }
   if (!m_stateDataDB.BatchInsert(batch)) {
-    LOG_GENERAL(WARNING, "BatchInsert t_stateDataDB failed");
+    LOG_GENERAL(WARNING, "BatchInsert m_stateDataDB failed");
     // Reset the values in m_stateIndexDB
     for (const auto& it : reset_buffer) {
       if (it.second.empty()) {
@@ -240,8 +318,11 @@ bool ContractStorage::CommitTempStateDB() {
     return false;
   }
 
-  t_stateIndexDB.ResetDB();
-  t_stateDataDB.ResetDB();
+  // Start the next epoch from the databases, so that the caches only ever
+  // hold what one epoch touched
+  m_stateIndexCache.clear();
+  m_stateDataCache.clear();
+  m_indexCache.clear();
 
   return true;
 }
@@ -249,7 +330,11 @@ bool ContractStorage::CommitTempStateDB() {
 Json::Value ContractStorage::GetContractStateJson(const dev::h160& address) {
   // LOG_MARKER();
   // iterate and deserialize the vector of raw protobuf string
-  vector<string> rawStates = GetContractStatesData(address);
+  vector<string> rawStates;
+  {
+    lock_guard<mutex> g(m_mutexCache);
+    rawStates = GetContractStatesData(address);
+  }
 
   Json::Value root;
   for (const auto& rawState : rawStates) {
@@ -260,59 +345,119 @@ Json::Value ContractStorage::GetContractStateJson(const dev::h160& address) {
       continue;
     }
 
-    string tVname = std::get<VNAME>(entry);
-    bool tMutable = std::get<MUTABLE>(entry);
-    string tType = std::get<TYPE>(entry);
-    string tValue = std::get<VALUE>(entry);
+    Json::Value item;
+    if (StateEntryToJson(entry, item)) {
+      root.append(item);
+    }
+  }
+  return root;
+}
+
+bool ContractStorage::GetContractStateJsonPage(const dev::h160& address,
+                                               unsigned int& cursor,
+                                               unsigned int maxCount,
+                                               Json::Value& fields) {
+  lock_guard<mutex> g(m_mutexCache);
+
+  const vector<Index>& indexes = GetStateIndexes(address);
+  if (cursor > indexes.size()) {
+    LOG_GENERAL(WARNING, "Cursor " << cursor << " past the "
+                                   << indexes.size() << " states of "
+                                   << address);
+    return false;
+  }
 
-    if (!tMutable) {
+  fields = Json::arrayValue;
+  unsigned int pos = cursor;
+  for (; pos < indexes.size() && fields.size() < maxCount; pos++) {
+    const string& rawState = GetStateData(indexes.at(pos));
+    StateEntry entry;
+    if (!Messenger::GetStateData(bytes(rawState.begin(), rawState.end()), 0,
+                                 entry)) {
+      LOG_GENERAL(WARNING, "Messenger::GetStateData failed.");
       continue;
     }
 
     Json::Value item;
-    item["vname"] = tVname;
-    item["type"] = tType;
-    if (tValue[0] == '[' || tValue[0] == '{') {
-      Json::CharReaderBuilder builder;
-      unique_ptr<Json::CharReader> reader(builder.newCharReader());
-      Json::Value obj;
-      string errors;
-      if (!reader->parse(tValue.c_str(), tValue.c_str() + tValue.size(), &obj,
-                         &errors)) {
-        LOG_GENERAL(WARNING,
-                    "The json object cannot be extracted from Storage: "
-                        << tValue << endl
-                        << "Error: " << errors);
-        continue;
-      }
-      item["value"] = obj;
-    } else {
-      item["value"] = tValue;
+    if (StateEntryToJson(entry, item)) {
+      fields.append(item);
     }
-    root.append(item);
   }
-  return root;
+
+  cursor = (pos < indexes.size()) ? pos : 0;
+  return true;
+}
+
+bool ContractStorage::GetContractStateMapEntries(const dev::h160& address,
+                                                 const string& vname,
+                                                 const string& keyPrefix,
+                                                 unsigned int& cursor,
+                                                 unsigned int maxCount,
+                                                 Json::Value& field) {
+  StateEntry entry;
+  if (!GetContractStateEntry(address, vname, entry) ||
+      !StateEntryToJson(entry, field)) {
+    return false;
+  }
+
+  Json::Value value;
+  value.swap(field["value"]);
+  if (!value.isArray()) {
+    // A single value is its own only page
+    field["value"] = value;
+    cursor = 0;
+    return true;
+  }
+  if (cursor > value.size()) {
+    LOG_GENERAL(WARNING, "Cursor " << cursor << " past the " << value.size()
+                                   << " elements of " << vname);
+    return false;
+  }
+
+  field["value"] = Json::arrayValue;
+  unsigned int pos = cursor;
+  for (; pos < value.size() && field["value"].size() < maxCount; pos++) {
+    const Json::Value& element = value[pos];
+    if (!keyPrefix.empty() &&
+        (!element.isObject() || !element["key"].isString() ||
+         element["key"].asString().compare(0, keyPrefix.size(), keyPrefix) !=
+             0)) {
+      continue;
+    }
+    field["value"].append(element);
+  }
+
+  cursor = (pos < value.size()) ? pos : 0;
+  return true;
 }
 
 dev::h256 ContractStorage::GetContractStateHash(const dev::h160& address) {
+  lock_guard<mutex> g(m_mutexCache);
+  return GetStateHash(address);
+}
+
+dev::h256 ContractStorage::GetStateHash(const dev::h160& address) {
   // LOG_MARKER();
   // iterate the raw protobuf string and hash
-  vector<string> rawStates = GetContractStatesData(address);
   SHA2<HASH_TYPE::HASH_VARIANT_256> sha2;
-  for (const auto& rawState : rawStates) {
-    sha2.Update(DataConversion::StringToCharArray(rawState));
+  for (const auto& index : GetStateIndexes(address)) {
+    sha2.Update(DataConversion::StringToCharArray(GetStateData(index)));
   }
   return dev::h256(sha2.Finalize());
 }
 
 void ContractStorage::Reset() {
+  lock_guard<mutex> g(m_mutexCache);
+
   m_stateDB.ResetDB();
 
   m_codeDB.ResetDB();
   m_stateIndexDB.ResetDB();
   m_stateDataDB.ResetDB();
-  t_stateIndexDB.ResetDB();
-  t_stateDataDB.ResetDB();
+
+  m_stateIndexCache.clear();
+  m_stateDataCache.clear();
+  m_indexCache.clear();
 }
 
 }  // namespace Contract
\ No newline at end of file
@@ -20,6 +20,8 @@
 
 #include <json/json.h>
 #include <leveldb/db.h>
+#include <mutex>
+#include <unordered_map>
 
 #include "common/Constants.h"
 #include "common/Singleton.h"
@@ -41,29 +43,56 @@ class ContractStorage : public Singleton<ContractStorage> {
 
   dev::OverlayDB m_stateDB;
 
-  LevelDB t_stateIndexDB;
-  LevelDB t_stateDataDB;
-
   LevelDB m_stateIndexDB;
   LevelDB m_stateDataDB;
 
-  /// Set the indexes of all the states of an contract account
-  bool SetContractStateIndexes(const dev::h160& address,
+  /// A state entry or index list as last read from or written to the
+  /// databases. Dirty ones are written out by CommitTempStateDB.
+  template <class T>
+  struct CachedState {
+    T m_value;
+    bool m_dirty;
+  };
+
+  // Guards the caches below and the state databases behind them
+  std::mutex m_mutexCache;
+  /// Raw state data by index, empty for an index with no state
+  std::unordered_map<Index, CachedState<std::string>> m_stateDataCache;
+  /// State indexes of each contract account
+  std::unordered_map<dev::h160, CachedState<std::vector<Index>>>
+      m_stateIndexCache;
+  /// Index of each field name already hashed, per contract account
+  std::unordered_map<dev::h160, std::unordered_map<std::string, Index>>
+      m_indexCache;
+
+  /// Set the indexes of all the states of an contract account.
+  /// Requires m_mutexCache.
+  void SetContractStateIndexes(const dev::h160& address,
                                const std::vector<Index>& indexes);
 
-  /// Get the raw rlp string of the states of an account
+  /// Get the indexes of all the states of an contract account.
+  /// Requires m_mutexCache.
+  const std::vector<Index>& GetStateIndexes(const dev::h160& address);
+
+  /// Get the raw rlp string of the state by a index. Requires m_mutexCache.
+  const std::string& GetStateData(const Index& index);
+
+  /// Get the raw rlp string of the states of an account.
+  /// Requires m_mutexCache.
   std::vector<std::string> GetContractStatesData(const dev::h160& address);
 
+  /// Get the state hash of a contract account. Requires m_mutexCache.
+  dev::h256 GetStateHash(const dev::h160& address);
+
   ContractStorage()
       : m_codeDB("contractCode"),
         m_stateDB("contractState"),
-        t_stateIndexDB("tempContractStateIndex"),
-        t_stateDataDB("tempContractStateData"),
         m_stateIndexDB("sontractStateIndex"),
         m_stateDataDB("contractStateData"){};
 
   ~ContractStorage() = default;
 
+  /// Requires m_mutexCache
   Index GetNewIndex(const dev::h160& address, const std::string& key);
 
   bool CheckIndexExists(const Index& index);
@@ -95,20 +124,44 @@ class ContractStorage : public Singleton<ContractStorage> {
   /// Get the raw rlp string of the state by a index
   std::string GetContractStateData(const Index& index);
 
+  /// Get a single state of a contract account by its field name
+  bool GetContractStateEntry(const dev::h160& address, const std::string& vname,
+                             StateEntry& entry);
+
   /// Put one's contract states in database
   bool PutContractState(const dev::h160& address,
                         const std::vector<StateEntry>& states,
                         dev::h256& stateHash);
 
+  /// Entries for fields not given keep their current value
   bool PutContractState(const dev::h160& address,
                         const std::vector<std::pair<Index, bytes>>& entries,
                         dev::h256& stateHash);
 
+  /// Writes the states put since the last call to the databases, each
+  /// entry once however often it was put
   bool CommitTempStateDB();
 
   /// Get the json formatted data of the states for a contract account
   Json::Value GetContractStateJson(const dev::h160& address);
 
+  /// Get up to maxCount fields of GetContractStateJson, from the
+  /// cursor-th state onwards. cursor is set to where the next page starts,
+  /// or 0 after the last page.
+  bool GetContractStateJsonPage(const dev::h160& address,
+                                unsigned int& cursor, unsigned int maxCount,
+                                Json::Value& fields);
+
+  /// Get up to maxCount elements of a map (or list) field, from the
+  /// cursor-th element onwards, without reading the other fields. Only map
+  /// entries whose key starts with keyPrefix are returned. cursor is set as
+  /// in GetContractStateJsonPage.
+  bool GetContractStateMapEntries(const dev::h160& address,
+                                  const std::string& vname,
+                                  const std::string& keyPrefix,
+                                  unsigned int& cursor, unsigned int maxCount,
+                                  Json::Value& field);
+
   /// Get the state hash of a contract account
   dev::h256 GetContractStateHash(const dev::h160& address);
 
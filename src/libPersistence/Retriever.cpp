@@ -36,17 +36,13 @@ Retriever::Retriever(Mediator& mediator) : m_mediator(mediator) {}
 
 bool Retriever::RetrieveTxBlocks(bool trimIncompletedBlocks) {
   LOG_MARKER();
-  std::list<TxBlockSharedPtr> blocks;
-  if (!BlockStorage::GetBlockStorage().GetAllTxBlocks(blocks)) {
+  std::vector<uint64_t> blockNums;
+  if (!BlockStorage::GetBlockStorage().GetAllTxBlockNums(blockNums)) {
     LOG_GENERAL(WARNING, "RetrieveTxBlocks skipped or incompleted");
     return false;
   }
 
-  blocks.sort([](const TxBlockSharedPtr& a, const TxBlockSharedPtr& b) {
-    return a->GetHeader().GetBlockNum() < b->GetHeader().GetBlockNum();
-  });
-
-  unsigned int lastBlockNum = blocks.back()->GetHeader().GetBlockNum();
+  uint64_t lastBlockNum = blockNums.back();
 
   unsigned int extra_txblocks = (lastBlockNum + 1) % NUM_FINAL_BLOCK_PER_POW;
 
@@ -54,12 +50,34 @@ bool Retriever::RetrieveTxBlocks(bool trimIncompletedBlocks) {
     // truncate the extra final blocks at last
     for (unsigned int i = 0; i < extra_txblocks; ++i) {
       BlockStorage::GetBlockStorage().DeleteTxBlock(lastBlockNum - i);
-      blocks.pop_back();
+      blockNums.pop_back();
     }
   }
 
-  for (const auto& block : blocks) {
+  // The chain only keeps the last BLOCKCHAIN_SIZE blocks in memory and reads
+  // older ones from disk, so only those and the blocks whose state deltas
+  // are replayed below need loading
+  const size_t window = std::max<size_t>(BLOCKCHAIN_SIZE, extra_txblocks);
+  const size_t first =
+      blockNums.size() > window ? blockNums.size() - window : 0;
+
+  std::vector<TxBlockSharedPtr> blocks;
+  for (size_t i = first; i < blockNums.size(); i++) {
+    TxBlockSharedPtr block;
+    if (!BlockStorage::GetBlockStorage().GetTxBlock(blockNums[i], block)) {
+      LOG_GENERAL(WARNING, "Could not retrieve TxBlock " << blockNums[i]);
+      return false;
+    }
     m_mediator.m_node->AddBlock(*block);
+    blocks.emplace_back(std::move(block));
+  }
+
+  if (first > 0) {
+    m_mediator.m_txBlockChain.IncreaseBlockCount(blockNums[first] -
+                                                 blockNums.front());
+    LOG_GENERAL(INFO, "Loaded TxBlocks " << blockNums[first] << " to "
+                                         << blockNums.back()
+                                         << ", older ones stay on disk");
   }
 
   /// Retrieve final block state delta from last DS epoch to
@@ -82,7 +100,7 @@ bool Retriever::RetrieveTxBlocks(bool trimIncompletedBlocks) {
 }
 
 bool Retriever::RetrieveBlockLink(bool trimIncompletedBlocks) {
-  std::list<BlockLink> blocklinks;
+  std::vector<BlockLink> blocklinks;
 
   auto dsComm = m_mediator.m_blocklinkchain.GetBuiltDSComm();
 
@@ -90,10 +108,11 @@ bool Retriever::RetrieveBlockLink(bool trimIncompletedBlocks) {
     LOG_GENERAL(WARNING, "RetrieveTxBlocks skipped or incompleted");
     return false;
   }
-  blocklinks.sort([](const BlockLink& a, const BlockLink& b) {
-    return std::get<BlockLinkIndex::INDEX>(a) <
-           std::get<BlockLinkIndex::INDEX>(b);
-  });
+  std::stable_sort(blocklinks.begin(), blocklinks.end(),
+                   [](const BlockLink& a, const BlockLink& b) {
+                     return std::get<BlockLinkIndex::INDEX>(a) <
+                            std::get<BlockLinkIndex::INDEX>(b);
+                   });
 
   if (!blocklinks.empty()) {
     if (m_mediator.m_ds->m_latestActiveDSBlockNum == 0) {
@@ -142,7 +161,7 @@ bool Retriever::RetrieveBlockLink(bool trimIncompletedBlocks) {
     lastDsIndex--;
   }
 
-  std::list<BlockLink>::iterator blocklinkItr;
+  std::vector<BlockLink>::iterator blocklinkItr;
   for (blocklinkItr = blocklinks.begin(); blocklinkItr != blocklinks.end();
        blocklinkItr++) {
     const auto& blocklink = *blocklinkItr;
@@ -252,7 +271,7 @@ bool Retriever::CleanExtraTxBodies() {
   }
 
   LOG_MARKER();
-  std::list<TxnHash> txnHashes;
+  std::vector<TxnHash> txnHashes;
   if (BlockStorage::GetBlockStorage().GetAllTxBodiesTmp(txnHashes)) {
     for (auto i : txnHashes) {
       if (!BlockStorage::GetBlockStorage().DeleteTxBody(i)) {
@@ -272,7 +291,9 @@ bool Retriever::RetrieveStates() {
 bool Retriever::ValidateStates() {
   LOG_MARKER();
 
-  if (m_mediator.m_txBlockChain.GetLastBlock().GetHeader().GetStateRootHash() ==
+  if (m_mediator.m_txBlockChain.GetLastBlockPtr()
+      ->GetHeader()
+      .GetStateRootHash() ==
       AccountStore::GetInstance().GetStateRootHash()) {
     LOG_GENERAL(INFO, "ValidateStates passed.");
     AccountStore::GetInstance().RepopulateStateTrie();
@@ -280,12 +301,12 @@ bool Retriever::ValidateStates() {
   } else {
     LOG_GENERAL(WARNING, "ValidateStates failed.");
     LOG_GENERAL(INFO, "StateRoot in FinalBlock(BlockNum: "
-                          << m_mediator.m_txBlockChain.GetLastBlock()
-                                 .GetHeader()
+                          << m_mediator.m_txBlockChain.GetLastBlockPtr()
+                                 ->GetHeader()
                                  .GetBlockNum()
                           << "): "
-                          << m_mediator.m_txBlockChain.GetLastBlock()
-                                 .GetHeader()
+                          << m_mediator.m_txBlockChain.GetLastBlockPtr()
+                                 ->GetHeader()
                                  .GetStateRootHash()
                           << '\n'
                           << "Retrieved StateRoot: "
@@ -0,0 +1,449 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <errno.h>
+#include <event2/buffer.h>
+#include <event2/bufferevent.h>
+#include <event2/event.h>
+#include <event2/listener.h>
+#include <netinet/in.h>
+#include <unistd.h>
+#include <cstring>
+#include <functional>
+
+#include "ProtoRpcServer.h"
+#include "common/Constants.h"
+#include "libUtils/Logger.h"
+
+using namespace std;
+using namespace ZilliqaMessage;
+
+namespace {
+const size_t LENGTH_PREFIX_BYTES = 4;
+
+/// Returns an error message, or an empty string on success
+using Handler = function<string(ProtoServer& server, const string& params,
+                                string& result)>;
+
+template <class Response>
+Handler NoParams(Response (ProtoServer::*method)()) {
+  return [method](ProtoServer& server, [[gnu::unused]] const string& params,
+                  string& result) {
+    if (!(server.*method)().SerializeToString(&result)) {
+      return string("Failed to serialize the response");
+    }
+    return string();
+  };
+}
+
+template <class Request, class Response>
+Handler WithParams(Response (ProtoServer::*method)(Request&)) {
+  return [method](ProtoServer& server, const string& params, string& result) {
+    Request request;
+    if (!request.ParseFromString(params)) {
+      return string("Invalid params");
+    }
+    if (!(server.*method)(request).SerializeToString(&result)) {
+      return string("Failed to serialize the response");
+    }
+    return string();
+  };
+}
+
+const map<string, Handler>& GetHandlers() {
+  static const map<string, Handler> handlers = {
+      {"GetClientVersion", NoParams(&ProtoServer::GetClientVersion)},
+      {"GetNetworkId", NoParams(&ProtoServer::GetNetworkId)},
+      {"GetProtocolVersion", NoParams(&ProtoServer::GetProtocolVersion)},
+      {"GetGasPrice", NoParams(&ProtoServer::GetGasPrice)},
+      {"GetStorageAt", WithParams(&ProtoServer::GetStorageAt)},
+      {"GetBlockTransactionCount",
+       WithParams(&ProtoServer::GetBlockTransactionCount)},
+      {"CreateMessage", NoParams(&ProtoServer::CreateMessage)},
+      {"GetGasEstimate", NoParams(&ProtoServer::GetGasEstimate)},
+      {"GetTransactionReceipt",
+       WithParams(&ProtoServer::GetTransactionReceipt)},
+      {"isNodeSyncing", NoParams(&ProtoServer::isNodeSyncing)},
+      {"isNodeMining", NoParams(&ProtoServer::isNodeMining)},
+      {"GetHashrate", NoParams(&ProtoServer::GetHashrate)},
+      {"CreateTransaction", WithParams(&ProtoServer::CreateTransaction)},
+      {"GetTransaction", WithParams(&ProtoServer::GetTransaction)},
+      {"GetDsBlock", WithParams(&ProtoServer::GetDsBlock)},
+      {"GetTxBlock", WithParams(&ProtoServer::GetTxBlock)},
+      {"GetLatestDsBlock", NoParams(&ProtoServer::GetLatestDsBlock)},
+      {"GetLatestTxBlock", NoParams(&ProtoServer::GetLatestTxBlock)},
+      {"GetBalance", WithParams(&ProtoServer::GetBalance)},
+      {"GetSmartContractState",
+       WithParams(&ProtoServer::GetSmartContractState)},
+      {"GetSmartContractInit", WithParams(&ProtoServer::GetSmartContractInit)},
+      {"GetSmartContractCode", WithParams(&ProtoServer::GetSmartContractCode)},
+      {"GetSmartContracts", WithParams(&ProtoServer::GetSmartContracts)},
+      {"GetContractAddressFromTransactionID",
+       WithParams(&ProtoServer::GetContractAddressFromTransactionID)},
+      {"GetNumPeers", NoParams(&ProtoServer::GetNumPeers)},
+      {"GetNumTxBlocks", NoParams(&ProtoServer::GetNumTxBlocks)},
+      {"GetNumDSBlocks", NoParams(&ProtoServer::GetNumDSBlocks)},
+      {"GetNumTransactions", NoParams(&ProtoServer::GetNumTransactions)},
+      {"GetTransactionRate", NoParams(&ProtoServer::GetTransactionRate)},
+      {"GetDSBlockRate", NoParams(&ProtoServer::GetDSBlockRate)},
+      {"GetTxBlockRate", NoParams(&ProtoServer::GetTxBlockRate)},
+      {"GetCurrentMiniEpoch", NoParams(&ProtoServer::GetCurrentMiniEpoch)},
+      {"GetCurrentDSEpoch", NoParams(&ProtoServer::GetCurrentDSEpoch)},
+      {"DSBlockListing", WithParams(&ProtoServer::DSBlockListing)},
+      {"TxBlockListing", WithParams(&ProtoServer::TxBlockListing)},
+      {"GetBlockchainInfo", NoParams(&ProtoServer::GetBlockchainInfo)},
+      {"GetRecentTransactions", NoParams(&ProtoServer::GetRecentTransactions)},
+      {"GetShardingStructure", NoParams(&ProtoServer::GetShardingStructure)},
+      {"GetNumTxnsTxEpoch", NoParams(&ProtoServer::GetNumTxnsTxEpoch)},
+      {"GetNumTxnsDSEpoch", NoParams(&ProtoServer::GetNumTxnsDSEpoch)}};
+  return handlers;
+}
+
+string LengthPrefix(size_t len) {
+  string prefix(LENGTH_PREFIX_BYTES, '\0');
+  for (size_t i = 0; i < LENGTH_PREFIX_BYTES; i++) {
+    prefix[i] = static_cast<char>(len >> (8 * (LENGTH_PREFIX_BYTES - 1 - i)));
+  }
+  return prefix;
+}
+}  // namespace
+
+ProtoRpcServer::Client::Client(struct bufferevent* bev, uint64_t id)
+    : m_bev(bev), m_id(id), m_closing(false) {}
+
+ProtoRpcServer::Client::~Client() {
+  if (m_bev != nullptr) {
+    bufferevent_free(m_bev);
+  }
+}
+
+ProtoRpcServer::ProtoRpcServer(ProtoServer& server)
+    : m_server(server),
+      m_base(nullptr),
+      m_listener(nullptr),
+      m_wakeEvent(nullptr),
+      m_wakePipe{-1, -1},
+      m_running(false),
+      m_stop(false),
+      m_inFlight(0),
+      m_nextClientId(0) {}
+
+ProtoRpcServer::~ProtoRpcServer() { Stop(); }
+
+string ProtoRpcServer::Call(ProtoServer& server, const string& method,
+                            const string& params, string& result) {
+  result.clear();
+
+  const auto& handlers = GetHandlers();
+  const auto it = handlers.find(method);
+  if (it == handlers.end()) {
+    return "Method not found";
+  }
+
+  try {
+    return it->second(server, params, result);
+  } catch (const exception& e) {
+    LOG_GENERAL(WARNING, method << " failed: " << e.what());
+    return "Internal error";
+  }
+}
+
+bool ProtoRpcServer::Start() {
+  if (m_running) {
+    return true;
+  }
+
+  if (!m_pool) {
+    m_pool.reset(new ThreadPool(RPC_SERVER_THREADS, "ProtoRpc"));
+  }
+
+  m_base = event_base_new();
+  if (m_base == nullptr) {
+    LOG_GENERAL(WARNING, "event_base_new failure.");
+    return false;
+  }
+
+  if (pipe(m_wakePipe) != 0) {
+    LOG_GENERAL(WARNING, "pipe failure. Code = " << errno << " Desc: "
+                                                 << std::strerror(errno));
+    m_wakePipe[0] = m_wakePipe[1] = -1;
+    Release();
+    return false;
+  }
+  evutil_make_socket_nonblocking(m_wakePipe[0]);
+  evutil_make_socket_nonblocking(m_wakePipe[1]);
+
+  m_wakeEvent = event_new(m_base, m_wakePipe[0], EV_READ | EV_PERSIST,
+                          WakeCallback, this);
+  event_add(m_wakeEvent, NULL);
+
+  struct sockaddr_in serv_addr;
+  memset(&serv_addr, 0, sizeof(struct sockaddr_in));
+  serv_addr.sin_family = AF_INET;
+  serv_addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  serv_addr.sin_port = htons(PROTO_RPC_PORT);
+
+  m_listener = evconnlistener_new_bind(
+      m_base, AcceptCallback, this, LEV_OPT_REUSEABLE | LEV_OPT_CLOSE_ON_FREE,
+      -1, (struct sockaddr*)&serv_addr, sizeof(struct sockaddr_in));
+  if (m_listener == nullptr) {
+    LOG_GENERAL(WARNING, "evconnlistener_new_bind failure on port "
+                             << PROTO_RPC_PORT);
+    Release();
+    return false;
+  }
+
+  m_stop = false;
+  m_running = true;
+  m_thread = thread([this]() { event_base_dispatch(m_base); });
+
+  LOG_GENERAL(INFO, "Proto RPC server listening on port " << PROTO_RPC_PORT);
+  return true;
+}
+
+void ProtoRpcServer::Stop() {
+  if (!m_running) {
+    return;
+  }
+
+  m_running = false;
+  m_stop = true;
+  Wake();
+  if (m_thread.joinable()) {
+    m_thread.join();
+  }
+
+  // Let the calls being processed finish before their replies are dropped
+  m_pool.reset();
+
+  m_clients.clear();
+  m_clientIds.clear();
+  {
+    lock_guard<mutex> g(m_mutexReplies);
+    m_replies.clear();
+  }
+  Release();
+}
+
+void ProtoRpcServer::Release() {
+  if (m_listener != nullptr) {
+    evconnlistener_free(m_listener);
+    m_listener = nullptr;
+  }
+  if (m_wakeEvent != nullptr) {
+    event_free(m_wakeEvent);
+    m_wakeEvent = nullptr;
+  }
+  for (int& fd : m_wakePipe) {
+    if (fd >= 0) {
+      close(fd);
+      fd = -1;
+    }
+  }
+  if (m_base != nullptr) {
+    event_base_free(m_base);
+    m_base = nullptr;
+  }
+}
+
+void ProtoRpcServer::Wake() {
+  const unsigned char c = 0;
+  [[gnu::unused]] ssize_t n = write(m_wakePipe[1], &c, 1);
+}
+
+void ProtoRpcServer::AcceptCallback(
+    [[gnu::unused]] struct evconnlistener* listener, evutil_socket_t fd,
+    [[gnu::unused]] struct sockaddr* addr, [[gnu::unused]] int socklen,
+    void* arg) {
+  ProtoRpcServer* self = static_cast<ProtoRpcServer*>(arg);
+
+  if (self->m_clients.size() >= PROTO_RPC_MAX_CONNECTIONS) {
+    LOG_GENERAL(WARNING, "Refused a proto RPC client, already serving "
+                             << self->m_clients.size());
+    evutil_closesocket(fd);
+    return;
+  }
+
+  struct bufferevent* bev =
+      bufferevent_socket_new(self->m_base, fd, BEV_OPT_CLOSE_ON_FREE);
+  if (bev == nullptr) {
+    LOG_GENERAL(WARNING, "bufferevent_socket_new failure.");
+    evutil_closesocket(fd);
+    return;
+  }
+
+  const uint64_t id = self->m_nextClientId++;
+  self->m_clients[bev].reset(new Client(bev, id));
+  self->m_clientIds[id] = bev;
+  bufferevent_setcb(bev, ReadCallback, NULL, EventCallback, self);
+  bufferevent_enable(bev, EV_READ | EV_WRITE);
+}
+
+void ProtoRpcServer::ReadCallback(struct bufferevent* bev, void* arg) {
+  ProtoRpcServer* self = static_cast<ProtoRpcServer*>(arg);
+
+  auto it = self->m_clients.find(bev);
+  if (it == self->m_clients.end()) {
+    return;
+  }
+  Client& client = *it->second;
+
+  while (!client.m_closing && self->ReadMessage(client)) {
+  }
+
+  if (client.m_closing) {
+    self->RemoveClient(bev);
+  }
+}
+
+void ProtoRpcServer::EventCallback(struct bufferevent* bev, short events,
+                                   void* arg) {
+  if (events & (BEV_EVENT_EOF | BEV_EVENT_ERROR)) {
+    static_cast<ProtoRpcServer*>(arg)->RemoveClient(bev);
+  }
+}
+
+bool ProtoRpcServer::ReadMessage(Client& client) {
+  struct evbuffer* input = bufferevent_get_input(client.m_bev);
+  const size_t available = evbuffer_get_length(input);
+  if (available < LENGTH_PREFIX_BYTES) {
+    return false;
+  }
+
+  unsigned char prefix[LENGTH_PREFIX_BYTES];
+  evbuffer_copyout(input, prefix, sizeof(prefix));
+  size_t len = 0;
+  for (const auto& c : prefix) {
+    len = (len << 8) | c;
+  }
+
+  if (len > RPC_MAX_REQUEST_BYTES) {
+    LOG_GENERAL(WARNING, "Dropped a proto RPC client sending a message of "
+                             << len << " bytes");
+    client.m_closing = true;
+    return false;
+  }
+  if (available < LENGTH_PREFIX_BYTES + len) {
+    return false;
+  }
+
+  evbuffer_drain(input, LENGTH_PREFIX_BYTES);
+  string message(len, '\0');
+  if (len > 0) {
+    evbuffer_remove(input, &message[0], len);
+  }
+
+  HandleRequest(client, message);
+  return true;
+}
+
+void ProtoRpcServer::HandleRequest(Client& client, const string& message) {
+  ProtoRpcRequest request;
+  if (!request.ParseFromString(message)) {
+    // Without an id, the client could not tell which call failed
+    LOG_GENERAL(WARNING, "Dropped a proto RPC client sending an invalid "
+                         "request");
+    client.m_closing = true;
+    return;
+  }
+
+  if (m_inFlight >= RPC_MAX_IN_FLIGHT) {
+    ProtoRpcResponse response;
+    response.set_id(request.id());
+    response.set_error("Server busy");
+    Send(client, response);
+    return;
+  }
+
+  m_inFlight++;
+  const uint64_t clientId = client.m_id;
+  m_pool->AddJob([this, clientId, request]() {
+    ProtoRpcResponse response;
+    response.set_id(request.id());
+
+    string result;
+    const string error =
+        Call(m_server, request.method(), request.params(), result);
+    if (error.empty()) {
+      response.set_result(result);
+    } else {
+      response.set_error(error);
+    }
+
+    string serialized;
+    response.SerializeToString(&serialized);
+
+    bool wasEmpty = false;
+    {
+      lock_guard<mutex> g(m_mutexReplies);
+      wasEmpty = m_replies.empty();
+      m_replies.push_back({clientId, LengthPrefix(serialized.size()) +
+                                         serialized});
+    }
+    m_inFlight--;
+
+    if (wasEmpty) {
+      Wake();
+    }
+  });
+}
+
+void ProtoRpcServer::Send(Client& client, const ProtoRpcResponse& response) {
+  string serialized;
+  response.SerializeToString(&serialized);
+  const string message = LengthPrefix(serialized.size()) + serialized;
+  bufferevent_write(client.m_bev, message.data(), message.size());
+}
+
+void ProtoRpcServer::RemoveClient(struct bufferevent* bev) {
+  auto it = m_clients.find(bev);
+  if (it == m_clients.end()) {
+    return;
+  }
+  m_clientIds.erase(it->second->m_id);
+  m_clients.erase(it);
+}
+
+void ProtoRpcServer::WakeCallback(evutil_socket_t fd,
+                                  [[gnu::unused]] short what, void* arg) {
+  ProtoRpcServer* self = static_cast<ProtoRpcServer*>(arg);
+
+  unsigned char buf[64];
+  while (read(fd, buf, sizeof(buf)) > 0) {
+  }
+
+  if (self->m_stop) {
+    event_base_loopbreak(self->m_base);
+    return;
+  }
+
+  vector<Reply> replies;
+  {
+    lock_guard<mutex> g(self->m_mutexReplies);
+    replies.swap(self->m_replies);
+  }
+
+  for (const auto& reply : replies) {
+    // The client may have gone away while its call was processed
+    const auto it = self->m_clientIds.find(reply.m_clientId);
+    if (it == self->m_clientIds.end()) {
+      continue;
+    }
+    bufferevent_write(it->second, reply.m_message.data(),
+                      reply.m_message.size());
+  }
+}
@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __PROTORPCSERVER_H__
+#define __PROTORPCSERVER_H__
+
+#include <event2/util.h>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Server.h"
+#include "libUtils/ThreadPool.h"
+
+struct event;
+struct event_base;
+struct evconnlistener;
+struct bufferevent;
+
+/// Binary front end of ProtoServer, served alongside the JSON-RPC one.
+///
+/// Each message on the TCP stream is a 4-byte big-endian length followed by
+/// a serialized ProtoRpcRequest (client to server) or ProtoRpcResponse
+/// (server to client). Calls are processed on RPC_SERVER_THREADS threads,
+/// so a client may pipeline many calls on one connection and match the
+/// replies, which can come back in any order, by id.
+///
+/// Sockets are served from one libevent loop thread.
+class ProtoRpcServer {
+  struct Client {
+    struct bufferevent* m_bev;
+    uint64_t m_id;
+    bool m_closing;
+
+    Client(struct bufferevent* bev, uint64_t id);
+    ~Client();
+  };
+
+  struct Reply {
+    uint64_t m_clientId;
+    std::string m_message;
+  };
+
+  ProtoServer& m_server;
+
+  struct event_base* m_base;
+  struct evconnlistener* m_listener;
+  struct event* m_wakeEvent;
+  int m_wakePipe[2];
+  std::atomic<bool> m_running;
+  std::atomic<bool> m_stop;
+  /// Calls queued or being processed
+  std::atomic<unsigned int> m_inFlight;
+
+  std::mutex m_mutexReplies;
+  std::vector<Reply> m_replies;
+
+  /// Only touched from the loop thread
+  std::map<struct bufferevent*, std::unique_ptr<Client>> m_clients;
+  std::map<uint64_t, struct bufferevent*> m_clientIds;
+  uint64_t m_nextClientId;
+
+  std::thread m_thread;
+
+  /// Created by Start, so that nodes not serving it keep no threads
+  std::unique_ptr<ThreadPool> m_pool;
+
+  ProtoRpcServer(ProtoRpcServer const&) = delete;
+  void operator=(ProtoRpcServer const&) = delete;
+
+  static void AcceptCallback(struct evconnlistener* listener,
+                             evutil_socket_t fd, struct sockaddr* addr,
+                             int socklen, void* arg);
+  static void WakeCallback(evutil_socket_t fd, short what, void* arg);
+  static void ReadCallback(struct bufferevent* bev, void* arg);
+  static void EventCallback(struct bufferevent* bev, short events, void* arg);
+
+  /// Returns false once no complete message is left in the input
+  bool ReadMessage(Client& client);
+  void HandleRequest(Client& client, const std::string& message);
+  void Send(Client& client, const ZilliqaMessage::ProtoRpcResponse& response);
+  void RemoveClient(struct bufferevent* bev);
+  void Wake();
+  void Release();
+
+ public:
+  explicit ProtoRpcServer(ProtoServer& server);
+  ~ProtoRpcServer();
+
+  /// Listens on PROTO_RPC_PORT; returns false if that is not possible
+  bool Start();
+  void Stop();
+  bool IsRunning() const { return m_running; }
+
+  /// Runs the named method of ProtoServer on its serialized request;
+  /// returns an error message, or an empty string on success
+  static std::string Call(ProtoServer& server, const std::string& method,
+                          const std::string& params, std::string& result);
+};
+
+#endif  // __PROTORPCSERVER_H__
@@ -41,11 +41,10 @@
 using namespace std;
 using namespace ZilliqaMessage;
 
-CircularArray<std::string> Server::m_RecentTransactions;
-std::mutex Server::m_mutexRecentTxns;
+CircularArray<std::string> ProtoServer::m_RecentTransactions;
+std::mutex ProtoServer::m_mutexRecentTxns;
 
 const unsigned int PAGE_SIZE = 10;
-const unsigned int NUM_PAGES_CACHE = 2;
 const unsigned int TXN_PAGE_SIZE = 100;
 
 //[warning] do not make this constant too big as it loops over blockchain
@@ -60,19 +59,15 @@ void ProtobufToDSBlock(const ProtoDSBlock& protoDSBlock, DSBlock& dsBlock);
 void DSBlockToProtobuf(const DSBlock& dsBlock, ProtoDSBlock& protoDSBlock);
 void TxBlockToProtobuf(const TxBlock& txBlock, ProtoTxBlock& protoTxBlock);
 
-Server::Server(Mediator& mediator) : m_mediator(mediator) {
+ProtoServer::ProtoServer(Mediator& mediator) : m_mediator(mediator) {
   m_StartTimeTx = 0;
   m_StartTimeDs = 0;
-  m_DSBlockCache.first = 0;
-  m_DSBlockCache.second.resize(NUM_PAGES_CACHE * PAGE_SIZE);
-  m_TxBlockCache.first = 0;
-  m_TxBlockCache.second.resize(NUM_PAGES_CACHE * PAGE_SIZE);
   m_RecentTransactions.resize(TXN_PAGE_SIZE);
   m_TxBlockCountSumPair.first = 0;
   m_TxBlockCountSumPair.second = 0;
 }
 
-Server::~Server() {
+ProtoServer::~ProtoServer() {
   // destructor
 }
 
@@ -80,9 +75,10 @@ Server::~Server() {
 // Auxillary functions.
 ////////////////////////////////////////////////////////////////////////
 
-boost::multiprecision::uint256_t Server::GetNumTransactions(uint64_t blockNum) {
+boost::multiprecision::uint256_t ProtoServer::GetNumTransactions(
+    uint64_t blockNum) {
   uint64_t currBlockNum =
-      m_mediator.m_txBlockChain.GetLastBlock().GetHeader().GetBlockNum();
+      m_mediator.m_txBlockChain.GetLastBlockPtr()->GetHeader().GetBlockNum();
 
   if (blockNum >= currBlockNum) {
     return 0;
@@ -90,76 +86,76 @@ boost::multiprecision::uint256_t Server::GetNumTransactions(uint64_t blockNum) {
 
   uint64_t i, res = 0;
   for (i = blockNum + 1; i <= currBlockNum; i++) {
-    res += m_mediator.m_txBlockChain.GetBlock(i).GetHeader().GetNumTxs();
+    res += m_mediator.m_txBlockChain.GetBlockPtr(i)->GetHeader().GetNumTxs();
   }
 
   return res;
 }
 
-void Server::AddToRecentTransactions(const dev::h256& txhash) {
+void ProtoServer::AddToRecentTransactions(const dev::h256& txhash) {
   lock_guard<mutex> g(m_mutexRecentTxns);
   m_RecentTransactions.insert_new(m_RecentTransactions.size(), txhash.hex());
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////
 
-DefaultResponse Server::GetClientVersion() {
+DefaultResponse ProtoServer::GetClientVersion() {
   DefaultResponse ret;
   return ret;
 }
 
-DefaultResponse Server::GetNetworkId() {
+DefaultResponse ProtoServer::GetNetworkId() {
   DefaultResponse ret;
   ret.set_result("TestNet");
   return ret;
 }
 
-DefaultResponse Server::GetProtocolVersion() {
+DefaultResponse ProtoServer::GetProtocolVersion() {
   DefaultResponse ret;
   return ret;
 }
 
-DefaultResponse Server::GetGasPrice() {
+DefaultResponse ProtoServer::GetGasPrice() {
   DefaultResponse ret;
   return ret;
 }
 
-DefaultResponse Server::GetStorageAt([
+DefaultResponse ProtoServer::GetStorageAt([
     [gnu::unused]] GetStorageAtRequest& request) {
   DefaultResponse ret;
   return ret;
 }
 
-DefaultResponse Server::GetBlockTransactionCount([
+DefaultResponse ProtoServer::GetBlockTransactionCount([
     [gnu::unused]] GetBlockTransactionCountRequest& request) {
   DefaultResponse ret;
   return ret;
 }
 
-DefaultResponse Server::GetTransactionReceipt([
+DefaultResponse ProtoServer::GetTransactionReceipt([
     [gnu::unused]] GetTransactionRequest& request) {
   DefaultResponse ret;
   return ret;
 }
 
-DefaultResponse Server::isNodeSyncing() {
+DefaultResponse ProtoServer::isNodeSyncing() {
   DefaultResponse ret;
   return ret;
 }
 
-DefaultResponse Server::isNodeMining() {
+DefaultResponse ProtoServer::isNodeMining() {
   DefaultResponse ret;
   return ret;
 }
 
-DefaultResponse Server::GetHashrate() {
+DefaultResponse ProtoServer::GetHashrate() {
   DefaultResponse ret;
   return ret;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////
 
-CreateTransactionResponse Server::CreateTransaction(
+CreateTransactionResponse ProtoServer::CreateTransaction(
     CreateTransactionRequest& request) {
   LOG_MARKER();
 
@@ -180,17 +176,22 @@ CreateTransactionResponse Server::CreateTransaction(
       return ret;
     }
 
+    if (m_mediator.m_lookup->IsTxnRecentlyCommitted(tx.GetTranID())) {
+      ret.set_error("Txn already committed");
+      return ret;
+    }
+
     // Verify the transaction.
     if (!m_mediator.m_validator->VerifyTransaction(tx)) {
       ret.set_error("Unable to Verify Transaction");
       return ret;
     }
 
-    unsigned int num_shards = m_mediator.m_lookup->GetShardPeers().size();
+    unsigned int num_shards = m_mediator.m_lookup->GetShardPeers()->size();
 
-    const PubKey& senderPubKey = tx.GetSenderPubKey();
-    const Address fromAddr = Account::GetAddressFromPublicKey(senderPubKey);
-    const Account* sender = AccountStore::GetInstance().GetAccount(fromAddr);
+    const Address& fromAddr = tx.GetSenderAddr();
+    const auto sender =
+        AccountStore::GetInstance().GetCommittedAccount(fromAddr);
 
     if (sender == nullptr) {
       ret.set_error("The sender of the txn is null");
@@ -217,8 +218,8 @@ CreateTransactionResponse Server::CreateTransaction(
         }
 
       } else {
-        const Account* account =
-            AccountStore::GetInstance().GetAccount(tx.GetToAddr());
+        const auto account =
+            AccountStore::GetInstance().GetCommittedAccount(tx.GetToAddr());
 
         if (account == nullptr) {
           ret.set_error("To Addr is null");
@@ -254,7 +255,8 @@ CreateTransactionResponse Server::CreateTransaction(
   return ret;
 }
 
-GetTransactionResponse Server::GetTransaction(GetTransactionRequest& request) {
+GetTransactionResponse ProtoServer::GetTransaction(
+    GetTransactionRequest& request) {
   LOG_MARKER();
 
   GetTransactionResponse ret;
@@ -296,7 +298,7 @@ GetTransactionResponse Server::GetTransaction(GetTransactionRequest& request) {
   return ret;
 }
 
-GetDSBlockResponse Server::GetDsBlock(ProtoBlockNum& protoBlockNum) {
+GetDSBlockResponse ProtoServer::GetDsBlock(ProtoBlockNum& protoBlockNum) {
   LOG_MARKER();
 
   GetDSBlockResponse ret;
@@ -309,11 +311,11 @@ GetDSBlockResponse Server::GetDsBlock(ProtoBlockNum& protoBlockNum) {
     uint64_t blockNum = protoBlockNum.blocknum();
 
     // Get the DS block.
-    DSBlock dsblock = m_mediator.m_dsBlockChain.GetBlock(blockNum);
+    const auto dsblock = m_mediator.m_dsBlockChain.GetBlockPtr(blockNum);
 
     // Convert DSBlock to proto.
     ProtoDSBlock protoDSBlock;
-    DSBlockToProtobuf(dsblock, protoDSBlock);
+    DSBlockToProtobuf(*dsblock, protoDSBlock);
     ret.set_allocated_dsblock(&protoDSBlock);
   } catch (const char* msg) {
     ret.set_error(msg);
@@ -337,7 +339,7 @@ GetDSBlockResponse Server::GetDsBlock(ProtoBlockNum& protoBlockNum) {
   return ret;
 }
 
-GetTxBlockResponse Server::GetTxBlock(ProtoBlockNum& protoBlockNum) {
+GetTxBlockResponse ProtoServer::GetTxBlock(ProtoBlockNum& protoBlockNum) {
   LOG_MARKER();
 
   GetTxBlockResponse ret;
@@ -350,11 +352,11 @@ GetTxBlockResponse Server::GetTxBlock(ProtoBlockNum& protoBlockNum) {
     uint64_t blockNum = protoBlockNum.blocknum();
 
     // Get the tx block.
-    TxBlock txblock = m_mediator.m_txBlockChain.GetBlock(blockNum);
+    const auto txblock = m_mediator.m_txBlockChain.GetBlockPtr(blockNum);
 
     // Convert txblock to proto.
     ProtoTxBlock protoTxBlock;
-    TxBlockToProtobuf(txblock, protoTxBlock);
+    TxBlockToProtobuf(*txblock, protoTxBlock);
     ret.set_allocated_txblock(&protoTxBlock);
   } catch (const char* msg) {
     ret.set_error(msg);
@@ -378,47 +380,47 @@ GetTxBlockResponse Server::GetTxBlock(ProtoBlockNum& protoBlockNum) {
   return ret;
 }
 
-GetDSBlockResponse Server::GetLatestDsBlock() {
+GetDSBlockResponse ProtoServer::GetLatestDsBlock() {
   LOG_MARKER();
 
   GetDSBlockResponse ret;
 
   // Retrieve the latest DS block.
-  DSBlock dsblock = m_mediator.m_dsBlockChain.GetLastBlock();
+  const auto dsblock = m_mediator.m_dsBlockChain.GetLastBlockPtr();
 
   LOG_EPOCH(INFO, m_mediator.m_currentEpochNum,
-            "BlockNum " << dsblock.GetHeader().GetBlockNum()
-                        << "  Timestamp:        " << dsblock.GetTimestamp());
+            "BlockNum " << dsblock->GetHeader().GetBlockNum()
+                        << "  Timestamp:        " << dsblock->GetTimestamp());
 
   // Convert DSBlock to proto.
   ProtoDSBlock protoDSBlock;
-  DSBlockToProtobuf(dsblock, protoDSBlock);
+  DSBlockToProtobuf(*dsblock, protoDSBlock);
   ret.set_allocated_dsblock(&protoDSBlock);
 
   return ret;
 }
 
-GetTxBlockResponse Server::GetLatestTxBlock() {
+GetTxBlockResponse ProtoServer::GetLatestTxBlock() {
   LOG_MARKER();
 
   GetTxBlockResponse ret;
 
   // Get the latest tx block.
-  TxBlock txblock = m_mediator.m_txBlockChain.GetLastBlock();
+  const auto txblock = m_mediator.m_txBlockChain.GetLastBlockPtr();
 
   LOG_EPOCH(INFO, m_mediator.m_currentEpochNum,
-            "BlockNum " << txblock.GetHeader().GetBlockNum()
-                        << "  Timestamp:        " << txblock.GetTimestamp());
+            "BlockNum " << txblock->GetHeader().GetBlockNum()
+                        << "  Timestamp:        " << txblock->GetTimestamp());
 
   // Convert txblock to proto.
   ProtoTxBlock protoTxBlock;
-  TxBlockToProtobuf(txblock, protoTxBlock);
+  TxBlockToProtobuf(*txblock, protoTxBlock);
   ret.set_allocated_txblock(&protoTxBlock);
 
   return ret;
 }
 
-GetBalanceResponse Server::GetBalance(ProtoAddress& protoAddress) {
+GetBalanceResponse ProtoServer::GetBalance(ProtoAddress& protoAddress) {
   LOG_MARKER();
 
   GetBalanceResponse ret;
@@ -441,7 +443,7 @@ GetBalanceResponse Server::GetBalance(ProtoAddress& protoAddress) {
     }
 
     Address addr(tmpaddr);
-    const Account* account = AccountStore::GetInstance().GetAccount(addr);
+    const auto account = AccountStore::GetInstance().GetCommittedAccount(addr);
 
     if (account != nullptr) {
       boost::multiprecision::uint128_t balance = account->GetBalance();
@@ -466,7 +468,7 @@ GetBalanceResponse Server::GetBalance(ProtoAddress& protoAddress) {
   return ret;
 }
 
-GetSmartContractStateResponse Server::GetSmartContractState(
+GetSmartContractStateResponse ProtoServer::GetSmartContractState(
     ProtoAddress& protoAddress) {
   LOG_MARKER();
 
@@ -490,7 +492,7 @@ GetSmartContractStateResponse Server::GetSmartContractState(
     }
 
     Address addr(tmpaddr);
-    const Account* account = AccountStore::GetInstance().GetAccount(addr);
+    const auto account = AccountStore::GetInstance().GetCommittedAccount(addr);
 
     if (account == nullptr) {
       ret.set_error("Address does not exist");
@@ -512,7 +514,7 @@ GetSmartContractStateResponse Server::GetSmartContractState(
   return ret;
 }
 
-GetSmartContractInitResponse Server::GetSmartContractInit(
+GetSmartContractInitResponse ProtoServer::GetSmartContractInit(
     ProtoAddress& protoAddress) {
   LOG_MARKER();
 
@@ -536,7 +538,7 @@ GetSmartContractInitResponse Server::GetSmartContractInit(
     }
 
     Address addr(tmpaddr);
-    const Account* account = AccountStore::GetInstance().GetAccount(addr);
+    const auto account = AccountStore::GetInstance().GetCommittedAccount(addr);
 
     if (account == nullptr) {
       ret.set_error("Address does not exist");
@@ -581,7 +583,7 @@ GetSmartContractCodeResponse GetSmartContractCode(ProtoAddress& protoAddress) {
     }
 
     Address addr(tmpaddr);
-    const Account* account = AccountStore::GetInstance().GetAccount(addr);
+    const auto account = AccountStore::GetInstance().GetCommittedAccount(addr);
 
     if (account == nullptr) {
       ret.set_error("Address does not exist");
@@ -604,7 +606,8 @@ GetSmartContractCodeResponse GetSmartContractCode(ProtoAddress& protoAddress) {
   return ret;
 }
 
-GetSmartContractResponse Server::GetSmartContracts(ProtoAddress& protoAddress) {
+GetSmartContractResponse ProtoServer::GetSmartContracts(
+    ProtoAddress& protoAddress) {
   LOG_MARKER();
 
   GetSmartContractResponse ret;
@@ -627,7 +630,7 @@ GetSmartContractResponse Server::GetSmartContracts(ProtoAddress& protoAddress) {
     }
 
     Address addr(tmpaddr);
-    const Account* account = AccountStore::GetInstance().GetAccount(addr);
+    const auto account = AccountStore::GetInstance().GetCommittedAccount(addr);
 
     if (account == nullptr) {
       ret.set_error("Address does not exist");
@@ -644,8 +647,8 @@ GetSmartContractResponse Server::GetSmartContracts(ProtoAddress& protoAddress) {
 
     for (uint64_t i = 0; i < nonce; i++) {
       Address contractAddr = Account::GetAddressForContract(addr, i);
-      const Account* contractAccount =
-          AccountStore::GetInstance().GetAccount(contractAddr);
+      const auto contractAccount =
+          AccountStore::GetInstance().GetCommittedAccount(contractAddr);
 
       if (contractAccount == nullptr || !contractAccount->isContract()) {
         continue;
@@ -666,7 +669,7 @@ GetSmartContractResponse Server::GetSmartContracts(ProtoAddress& protoAddress) {
   return ret;
 }
 
-StringResponse Server::GetContractAddressFromTransactionID(
+StringResponse ProtoServer::GetContractAddressFromTransactionID(
     ProtoTxId& protoTxId) {
   LOG_MARKER();
 
@@ -709,18 +712,17 @@ StringResponse Server::GetContractAddressFromTransactionID(
   return ret;
 }
 
-UIntResponse Server::GetNumPeers() {
+UIntResponse ProtoServer::GetNumPeers() {
   LOG_MARKER();
 
   unsigned int numPeers = m_mediator.m_lookup->GetNodePeers().size();
-  lock_guard<mutex> g(m_mediator.m_mutexDSCommittee);
 
   UIntResponse ret;
-  ret.set_result(numPeers + m_mediator.m_DSCommittee->size());
+  ret.set_result(numPeers + m_mediator.GetDSCommitteeSnapshot()->size());
   return ret;
 }
 
-StringResponse Server::GetNumTxBlocks() {
+StringResponse ProtoServer::GetNumTxBlocks() {
   LOG_MARKER();
 
   StringResponse ret;
@@ -728,7 +730,7 @@ StringResponse Server::GetNumTxBlocks() {
   return ret;
 }
 
-StringResponse Server::GetNumDSBlocks() {
+StringResponse ProtoServer::GetNumDSBlocks() {
   LOG_MARKER();
 
   StringResponse ret;
@@ -736,15 +738,15 @@ StringResponse Server::GetNumDSBlocks() {
   return ret;
 }
 
-StringResponse Server::GetNumTransactions() {
+StringResponse ProtoServer::GetNumTransactions() {
   LOG_MARKER();
 
   uint64_t currBlock =
-      m_mediator.m_txBlockChain.GetLastBlock().GetHeader().GetBlockNum();
+      m_mediator.m_txBlockChain.GetLastBlockPtr()->GetHeader().GetBlockNum();
   if (m_BlockTxPair.first < currBlock) {
     for (uint64_t i = m_BlockTxPair.first + 1; i <= currBlock; i++) {
       m_BlockTxPair.second +=
-          m_mediator.m_txBlockChain.GetBlock(i).GetHeader().GetNumTxs();
+          m_mediator.m_txBlockChain.GetBlockPtr(i)->GetHeader().GetNumTxs();
     }
   }
   m_BlockTxPair.first = currBlock;
@@ -754,13 +756,13 @@ StringResponse Server::GetNumTransactions() {
   return ret;
 }
 
-DoubleResponse Server::GetTransactionRate() {
+DoubleResponse ProtoServer::GetTransactionRate() {
   LOG_MARKER();
 
   DoubleResponse ret;
 
   uint64_t refBlockNum =
-      m_mediator.m_txBlockChain.GetLastBlock().GetHeader().GetBlockNum();
+      m_mediator.m_txBlockChain.GetLastBlockPtr()->GetHeader().GetBlockNum();
 
   uint64_t refTimeTx = 0;
 
@@ -778,12 +780,12 @@ DoubleResponse Server::GetTransactionRate() {
   }
 
   boost::multiprecision::cpp_dec_float_50 numTxns(
-      Server::GetNumTransactions(refBlockNum));
+      ProtoServer::GetNumTransactions(refBlockNum));
   LOG_GENERAL(INFO, "Num Txns: " << numTxns);
 
   try {
-    TxBlock tx = m_mediator.m_txBlockChain.GetBlock(refBlockNum);
-    refTimeTx = tx.GetTimestamp();
+    refTimeTx =
+        m_mediator.m_txBlockChain.GetBlockPtr(refBlockNum)->GetTimestamp();
   } catch (const char* msg) {
     if (string(msg) == "Blocknumber Absent") {
       LOG_GENERAL(INFO, "Error in fetching ref block");
@@ -793,7 +795,7 @@ DoubleResponse Server::GetTransactionRate() {
   }
 
   uint64_t TimeDiff =
-      m_mediator.m_txBlockChain.GetLastBlock().GetTimestamp() - refTimeTx;
+      m_mediator.m_txBlockChain.GetLastBlockPtr()->GetTimestamp() - refTimeTx;
 
   if (TimeDiff == 0 || refTimeTx == 0) {
     // something went wrong
@@ -811,7 +813,7 @@ DoubleResponse Server::GetTransactionRate() {
   return ret;
 }
 
-DoubleResponse Server::GetDSBlockRate() {
+DoubleResponse ProtoServer::GetDSBlockRate() {
   LOG_MARKER();
 
   DoubleResponse ret;
@@ -822,8 +824,7 @@ DoubleResponse Server::GetDSBlockRate() {
   if (m_StartTimeDs == 0) {  // case when m_StartTime has not been set
     try {
       // Refernce time chosen to be the first block's timestamp
-      DSBlock dsb = m_mediator.m_dsBlockChain.GetBlock(1);
-      m_StartTimeDs = dsb.GetTimestamp();
+      m_StartTimeDs = m_mediator.m_dsBlockChain.GetBlockPtr(1)->GetTimestamp();
     } catch (const char* msg) {
       if (string(msg) == "Blocknumber Absent") {
         LOG_GENERAL(INFO, "No DSBlock has been mined yet");
@@ -834,7 +835,8 @@ DoubleResponse Server::GetDSBlockRate() {
   }
 
   uint64_t TimeDiff =
-      m_mediator.m_dsBlockChain.GetLastBlock().GetTimestamp() - m_StartTimeDs;
+      m_mediator.m_dsBlockChain.GetLastBlockPtr()->GetTimestamp() -
+      m_StartTimeDs;
 
   if (TimeDiff == 0) {
     LOG_GENERAL(INFO, "Wait till the second block");
@@ -851,7 +853,7 @@ DoubleResponse Server::GetDSBlockRate() {
   return ret;
 }
 
-DoubleResponse Server::GetTxBlockRate() {
+DoubleResponse ProtoServer::GetTxBlockRate() {
   LOG_MARKER();
 
   DoubleResponse ret;
@@ -862,8 +864,7 @@ DoubleResponse Server::GetTxBlockRate() {
   if (m_StartTimeTx == 0) {
     try {
       // Reference Time chosen to be first block's timestamp
-      TxBlock txb = m_mediator.m_txBlockChain.GetBlock(1);
-      m_StartTimeTx = txb.GetTimestamp();
+      m_StartTimeTx = m_mediator.m_txBlockChain.GetBlockPtr(1)->GetTimestamp();
     } catch (const char* msg) {
       if (string(msg) == "Blocknumber Absent") {
         LOG_GENERAL(INFO, "No TxBlock has been mined yet");
@@ -874,7 +875,8 @@ DoubleResponse Server::GetTxBlockRate() {
   }
 
   uint64_t TimeDiff =
-      m_mediator.m_txBlockChain.GetLastBlock().GetTimestamp() - m_StartTimeTx;
+      m_mediator.m_txBlockChain.GetLastBlockPtr()->GetTimestamp() -
+      m_StartTimeTx;
 
   if (TimeDiff == 0) {
     LOG_GENERAL(INFO, "Wait till the second block");
@@ -890,7 +892,7 @@ DoubleResponse Server::GetTxBlockRate() {
   return ret;
 }
 
-UInt64Response Server::GetCurrentMiniEpoch() {
+UInt64Response ProtoServer::GetCurrentMiniEpoch() {
   LOG_MARKER();
 
   UInt64Response ret;
@@ -898,223 +900,123 @@ UInt64Response Server::GetCurrentMiniEpoch() {
   return ret;
 }
 
-UInt64Response Server::GetCurrentDSEpoch() {
+UInt64Response ProtoServer::GetCurrentDSEpoch() {
   LOG_MARKER();
 
   UInt64Response ret;
   ret.set_result(
-      m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetBlockNum());
+      m_mediator.m_dsBlockChain.GetLastBlockPtr()->GetHeader().GetBlockNum());
   return ret;
 }
 
-ProtoBlockListing Server::DSBlockListing(ProtoPage& protoPage) {
-  LOG_MARKER();
+void ProtoServer::GetBlockListingPage(
+    const BlockType& blockType, const uint64_t& currBlockNum,
+    unsigned int page, vector<pair<uint64_t, BlockHash>>& entries) {
+  entries.clear();
 
-  ProtoBlockListing ret;
-  if (protoPage.has_page()) {
-    ret.set_error("Page not in request");
-    return ret;
-  }
+  const uint64_t high = currBlockNum - PAGE_SIZE * (page - 1);
+  const uint64_t low = (high >= PAGE_SIZE - 1) ? high - (PAGE_SIZE - 1) : 0;
 
-  uint64_t currBlockNum =
-      m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetBlockNum();
-  auto maxPages = (currBlockNum / PAGE_SIZE) + 1;
-  ret.set_maxpages(int(maxPages));
+  map<uint64_t, BlockHash> blockHashes;
+  BlockStorage::GetBlockStorage().GetBlockHashes(blockType, low, high,
+                                                 blockHashes);
 
-  if (m_DSBlockCache.second.size() == 0) {
-    try {
-      // add the hash of genesis block
-      DSBlockHeader dshead = m_mediator.m_dsBlockChain.GetBlock(0).GetHeader();
-      SHA2<HASH_TYPE::HASH_VARIANT_256> sha2;
-      bytes vec;
-      dshead.Serialize(vec, 0);
-      sha2.Update(vec);
-      string vecStr;
-      const bytes& resVec = sha2.Finalize();
-      DataConversion::Uint8VecToHexStr(resVec, vecStr);
-      m_DSBlockCache.second.insert_new(m_DSBlockCache.second.size(), vecStr);
-    } catch (const char* msg) {
-      ret.set_error(msg);
-      return ret;
+  for (uint64_t blockNum = high + 1; blockNum-- > low;) {
+    const auto it = blockHashes.find(blockNum);
+    if (it != blockHashes.end()) {
+      entries.emplace_back(blockNum, it->second);
+      continue;
     }
-  }
-
-  unsigned int page = protoPage.page();
-  if (page > maxPages || page < 1) {
-    ret.set_error("Pages out of limit");
-    return ret;
-  }
 
-  if (currBlockNum > m_DSBlockCache.first) {
-    for (uint64_t i = m_DSBlockCache.first + 1; i < currBlockNum; i++) {
-      m_DSBlockCache.second.insert_new(m_DSBlockCache.second.size(),
-                                       m_mediator.m_dsBlockChain.GetBlock(i + 1)
-                                           .GetHeader()
-                                           .GetPrevHash()
-                                           .hex());
+    // Not indexed yet (e.g., committed before the index existed), so read it
+    // from the chain once and record it
+    const BlockHash blockHash =
+        (blockType == BlockType::DS)
+            ? m_mediator.m_dsBlockChain.GetBlockPtr(blockNum)->GetBlockHash()
+            : m_mediator.m_txBlockChain.GetBlockPtr(blockNum)->GetBlockHash();
+    if (blockHash != BlockHash()) {
+      BlockStorage::GetBlockStorage().PutBlockHash(blockType, blockNum,
+                                                   blockHash);
     }
-    // for the latest block
-    DSBlockHeader dshead =
-        m_mediator.m_dsBlockChain.GetBlock(currBlockNum).GetHeader();
-    SHA2<HASH_TYPE::HASH_VARIANT_256> sha2;
-    bytes vec;
-    dshead.Serialize(vec, 0);
-    sha2.Update(vec);
-    const bytes& resVec = sha2.Finalize();
-    string resStr;
-    DataConversion::Uint8VecToHexStr(resVec, resStr);
-    m_DSBlockCache.second.insert_new(m_DSBlockCache.second.size(), resStr);
-    m_DSBlockCache.first = currBlockNum;
+    entries.emplace_back(blockNum, blockHash);
   }
+}
 
-  unsigned int offset = PAGE_SIZE * (page - 1);
-  if (page <= NUM_PAGES_CACHE) {  // can use cache
-    boost::multiprecision::uint256_t cacheSize(
-        m_DSBlockCache.second.capacity());
-    if (cacheSize > m_DSBlockCache.second.size()) {
-      cacheSize = m_DSBlockCache.second.size();
-    }
-
-    uint64_t size = m_DSBlockCache.second.size();
-
-    for (unsigned int i = offset; i < PAGE_SIZE + offset && i < cacheSize;
-         i++) {
-      auto blockData = ret.add_data();
-      blockData->set_hash(m_DSBlockCache.second[size - i - 1]);
-      blockData->set_blocknum(int(currBlockNum - i));
-    }
-
-  } else {
-    for (uint64_t i = offset; i < PAGE_SIZE + offset && i <= currBlockNum;
-         i++) {
-      auto blockData = ret.add_data();
-      blockData->set_hash(
-          m_mediator.m_dsBlockChain.GetBlock(currBlockNum - i + 1)
-              .GetHeader()
-              .GetPrevHash()
-              .hex());
-      blockData->set_blocknum(int(currBlockNum - i));
-    }
-  }
+ProtoBlockListing ProtoServer::DSBlockListing(ProtoPage& protoPage) {
+  LOG_MARKER();
 
-  return ret;
+  return BlockListing(
+      BlockType::DS,
+      m_mediator.m_dsBlockChain.GetLastBlockPtr()->GetHeader().GetBlockNum(),
+      protoPage);
 }
 
-ProtoBlockListing Server::TxBlockListing(ProtoPage& protoPage) {
+ProtoBlockListing ProtoServer::TxBlockListing(ProtoPage& protoPage) {
   LOG_MARKER();
 
+  return BlockListing(
+      BlockType::Tx,
+      m_mediator.m_txBlockChain.GetLastBlockPtr()->GetHeader().GetBlockNum(),
+      protoPage);
+}
+
+ProtoBlockListing ProtoServer::BlockListing(const BlockType& blockType,
+                                            const uint64_t& currBlockNum,
+                                            ProtoPage& protoPage) {
   ProtoBlockListing ret;
   if (protoPage.has_page()) {
     ret.set_error("Page not in request");
     return ret;
   }
 
-  uint64_t currBlockNum =
-      m_mediator.m_txBlockChain.GetLastBlock().GetHeader().GetBlockNum();
   auto maxPages = (currBlockNum / PAGE_SIZE) + 1;
   ret.set_maxpages(int(maxPages));
 
-  if (m_TxBlockCache.second.size() == 0) {
-    try {
-      // add the hash of genesis block
-      TxBlockHeader txhead = m_mediator.m_txBlockChain.GetBlock(0).GetHeader();
-      SHA2<HASH_TYPE::HASH_VARIANT_256> sha2;
-      bytes vec;
-      txhead.Serialize(vec, 0);
-      sha2.Update(vec);
-      const bytes& resVec = sha2.Finalize();
-      string resStr;
-      DataConversion::Uint8VecToHexStr(resVec, resStr);
-      m_TxBlockCache.second.insert_new(m_TxBlockCache.second.size(), resStr);
-    } catch (const char* msg) {
-      ret.set_error(msg);
-      return ret;
-    }
-  }
-
   unsigned int page = protoPage.page();
   if (page > maxPages || page < 1) {
     ret.set_error("Pages out of limit");
     return ret;
   }
 
-  if (currBlockNum > m_TxBlockCache.first) {
-    for (uint64_t i = m_TxBlockCache.first + 1; i < currBlockNum; i++) {
-      m_TxBlockCache.second.insert_new(m_TxBlockCache.second.size(),
-                                       m_mediator.m_txBlockChain.GetBlock(i + 1)
-                                           .GetHeader()
-                                           .GetPrevHash()
-                                           .hex());
-    }
-    // for the latest block
-    TxBlockHeader txhead =
-        m_mediator.m_txBlockChain.GetBlock(currBlockNum).GetHeader();
-    SHA2<HASH_TYPE::HASH_VARIANT_256> sha2;
-    bytes vec;
-    txhead.Serialize(vec, 0);
-    sha2.Update(vec);
-    const bytes& resVec = sha2.Finalize();
-    string resStr;
-    DataConversion::Uint8VecToHexStr(resVec, resStr);
-    m_TxBlockCache.second.insert_new(m_TxBlockCache.second.size(), resStr);
-    m_TxBlockCache.first = currBlockNum;
+  vector<pair<uint64_t, BlockHash>> entries;
+  try {
+    GetBlockListingPage(blockType, currBlockNum, page, entries);
+  } catch (const char* msg) {
+    ret.set_error(msg);
+    return ret;
   }
 
-  unsigned int offset = PAGE_SIZE * (page - 1);
-  if (page <= NUM_PAGES_CACHE) {  // can use cache
-    boost::multiprecision::uint256_t cacheSize(
-        m_TxBlockCache.second.capacity());
-
-    if (cacheSize > m_TxBlockCache.second.size()) {
-      cacheSize = m_TxBlockCache.second.size();
-    }
-
-    uint64_t size = m_TxBlockCache.second.size();
-    for (unsigned int i = offset; i < PAGE_SIZE + offset && i < cacheSize;
-         i++) {
-      auto blockData = ret.add_data();
-      blockData->set_hash(m_TxBlockCache.second[size - i - 1]);
-      blockData->set_blocknum(int(currBlockNum - i));
-    }
-
-  } else {
-    for (uint64_t i = offset; i < PAGE_SIZE + offset && i <= currBlockNum;
-         i++) {
-      auto blockData = ret.add_data();
-      blockData->set_hash(
-          m_mediator.m_txBlockChain.GetBlock(currBlockNum - i + 1)
-              .GetHeader()
-              .GetPrevHash()
-              .hex());
-      blockData->set_blocknum(int(currBlockNum - i));
-    }
+  for (const auto& entry : entries) {
+    auto blockData = ret.add_data();
+    blockData->set_hash(entry.second.hex());
+    blockData->set_blocknum(int(entry.first));
   }
 
   return ret;
 }
 
-ProtoBlockChainInfo Server::GetBlockchainInfo() {
+ProtoBlockChainInfo ProtoServer::GetBlockchainInfo() {
   ProtoBlockChainInfo ret;
 
-  ret.set_numpeers(Server::GetNumPeers().result());
-  ret.set_numtxblocks(Server::GetNumTxBlocks().result());
-  ret.set_numdsblocks(Server::GetNumDSBlocks().result());
-  ret.set_numtxns(Server::GetNumTransactions().result());
-  ret.set_txrate(Server::GetTransactionRate().result());
-  ret.set_txblockrate(Server::GetTxBlockRate().result());
-  ret.set_dsblockrate(Server::GetDSBlockRate().result());
-  ret.set_currentminiepoch(Server::GetCurrentMiniEpoch().result());
-  ret.set_currentdsepoch(Server::GetCurrentDSEpoch().result());
-  ret.set_numtxnsdsepoch(Server::GetNumTxnsDSEpoch().result());
-  ret.set_numtxnstxepoch(Server::GetNumTxnsTxEpoch().result());
-
-  ProtoShardingStruct sharding = Server::GetShardingStructure();
+  ret.set_numpeers(ProtoServer::GetNumPeers().result());
+  ret.set_numtxblocks(ProtoServer::GetNumTxBlocks().result());
+  ret.set_numdsblocks(ProtoServer::GetNumDSBlocks().result());
+  ret.set_numtxns(ProtoServer::GetNumTransactions().result());
+  ret.set_txrate(ProtoServer::GetTransactionRate().result());
+  ret.set_txblockrate(ProtoServer::GetTxBlockRate().result());
+  ret.set_dsblockrate(ProtoServer::GetDSBlockRate().result());
+  ret.set_currentminiepoch(ProtoServer::GetCurrentMiniEpoch().result());
+  ret.set_currentdsepoch(ProtoServer::GetCurrentDSEpoch().result());
+  ret.set_numtxnsdsepoch(ProtoServer::GetNumTxnsDSEpoch().result());
+  ret.set_numtxnstxepoch(ProtoServer::GetNumTxnsTxEpoch().result());
+
+  ProtoShardingStruct sharding = ProtoServer::GetShardingStructure();
   ret.set_allocated_shardingstructure(&sharding);
 
   return ret;
 }
 
-ProtoTxHashes Server::GetRecentTransactions() {
+ProtoTxHashes ProtoServer::GetRecentTransactions() {
   LOG_MARKER();
 
   lock_guard<mutex> g(m_mutexRecentTxns);
@@ -1136,7 +1038,7 @@ ProtoTxHashes Server::GetRecentTransactions() {
   return ret;
 }
 
-ProtoShardingStruct Server::GetShardingStructure() {
+ProtoShardingStruct ProtoServer::GetShardingStructure() {
   LOG_MARKER();
 
   ProtoShardingStruct ret;
@@ -1144,13 +1046,13 @@ ProtoShardingStruct Server::GetShardingStructure() {
   try {
     auto shards = m_mediator.m_lookup->GetShardPeers();
 
-    unsigned int num_shards = shards.size();
+    unsigned int num_shards = shards->size();
 
     if (num_shards == 0) {
       ret.set_error("No shards yet");
     } else {
       for (unsigned int i = 0; i < num_shards; i++) {
-        ret.set_numpeers(i, static_cast<unsigned int>(shards[i].size()));
+        ret.set_numpeers(i, static_cast<unsigned int>(shards->at(i).size()));
       }
     }
 
@@ -1162,14 +1064,14 @@ ProtoShardingStruct Server::GetShardingStructure() {
   return ret;
 }
 
-UIntResponse Server::GetNumTxnsTxEpoch() {
+UIntResponse ProtoServer::GetNumTxnsTxEpoch() {
   LOG_MARKER();
 
   UIntResponse ret;
 
   try {
     ret.set_result(
-        m_mediator.m_txBlockChain.GetLastBlock().GetHeader().GetNumTxs());
+        m_mediator.m_txBlockChain.GetLastBlockPtr()->GetHeader().GetNumTxs());
   } catch (exception& e) {
     LOG_GENERAL(WARNING, e.what());
     ret.set_result(0);
@@ -1178,37 +1080,38 @@ UIntResponse Server::GetNumTxnsTxEpoch() {
   return ret;
 }
 
-StringResponse Server::GetNumTxnsDSEpoch() {
+StringResponse ProtoServer::GetNumTxnsDSEpoch() {
   LOG_MARKER();
 
   StringResponse ret;
 
   try {
-    auto latestTxBlock = m_mediator.m_txBlockChain.GetLastBlock().GetHeader();
+    auto latestTxBlock = m_mediator.m_txBlockChain.GetLastBlockPtr()
+        ->GetHeader();
     auto latestTxBlockNum = latestTxBlock.GetBlockNum();
     auto latestDSBlockNum = latestTxBlock.GetDSBlockNum();
 
     if (latestTxBlockNum > m_TxBlockCountSumPair.first) {
       // Case where the DS Epoch is same
-      if (m_mediator.m_txBlockChain.GetBlock(m_TxBlockCountSumPair.first)
-              .GetHeader()
+      if (m_mediator.m_txBlockChain.GetBlockPtr(m_TxBlockCountSumPair.first)
+              ->GetHeader()
               .GetDSBlockNum() == latestDSBlockNum) {
         for (auto i = latestTxBlockNum; i > m_TxBlockCountSumPair.first; i--) {
           m_TxBlockCountSumPair.second +=
-              m_mediator.m_txBlockChain.GetBlock(i).GetHeader().GetNumTxs();
+              m_mediator.m_txBlockChain.GetBlockPtr(i)->GetHeader().GetNumTxs();
         }
 
       } else {  // Case if DS Epoch Changed
         m_TxBlockCountSumPair.second = 0;
 
         for (auto i = latestTxBlockNum; i > m_TxBlockCountSumPair.first; i--) {
-          if (m_mediator.m_txBlockChain.GetBlock(i)
-                  .GetHeader()
+          if (m_mediator.m_txBlockChain.GetBlockPtr(i)
+                  ->GetHeader()
                   .GetDSBlockNum() < latestDSBlockNum) {
             break;
           }
           m_TxBlockCountSumPair.second +=
-              m_mediator.m_txBlockChain.GetBlock(i).GetHeader().GetNumTxs();
+              m_mediator.m_txBlockChain.GetBlockPtr(i)->GetHeader().GetNumTxs();
         }
       }
 
@@ -15,11 +15,15 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#ifndef __PROTOSERVER_H__
+#define __PROTOSERVER_H__
+
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wunused-parameter"
 #include <boost/multiprecision/cpp_int.hpp>
 #pragma GCC diagnostic pop
 #include <mutex>
+#include "libData/BlockData/Block.h"
 #include "libData/BlockData/BlockHeader/BlockHeaderBase.h"
 #include "libData/DataStructures/CircularArray.h"
 
@@ -29,20 +33,27 @@
 
 class Mediator;
 
-class Server {
+class ProtoServer {
   Mediator& m_mediator;
   std::pair<uint64_t, boost::multiprecision::uint256_t> m_BlockTxPair;
   std::pair<uint64_t, boost::multiprecision::uint256_t> m_TxBlockCountSumPair;
   uint64_t m_StartTimeTx;
   uint64_t m_StartTimeDs;
-  std::pair<uint64_t, CircularArray<std::string>> m_DSBlockCache;
-  std::pair<uint64_t, CircularArray<std::string>> m_TxBlockCache;
   static CircularArray<std::string> m_RecentTransactions;
   static std::mutex m_mutexRecentTxns;
 
+  /// Hashes of the blocks on a listing page, newest first, read from the
+  /// block hash index
+  void GetBlockListingPage(
+      const BlockType& blockType, const uint64_t& currBlockNum,
+      unsigned int page, std::vector<std::pair<uint64_t, BlockHash>>& entries);
+  ZilliqaMessage::ProtoBlockListing BlockListing(
+      const BlockType& blockType, const uint64_t& currBlockNum,
+      ZilliqaMessage::ProtoPage& protoPage);
+
  public:
-  Server(Mediator& mediator);
-  ~Server();
+  ProtoServer(Mediator& mediator);
+  ~ProtoServer();
 
   // Auxillary functions.
   boost::multiprecision::uint256_t GetNumTransactions(uint64_t blockNum);
@@ -135,3 +146,5 @@ class Server {
 
   ZilliqaMessage::StringResponse GetNumTxnsDSEpoch();
 };
+
+#endif  // __PROTOSERVER_H__
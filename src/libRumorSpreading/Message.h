@@ -37,6 +37,8 @@ class Message {
     FORWARD = 0x05,
     LAZY_PUSH = 0x06,
     LAZY_PULL = 0x07,
+    // Several of the above to the same peer in one frame
+    BATCH = 0x08,
     NUM_TYPES
   };
 
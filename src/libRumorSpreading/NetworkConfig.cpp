@@ -50,4 +50,9 @@ int NetworkConfig::maxRoundsInC() const { return m_maxRoundsInC; }
 
 int NetworkConfig::maxRoundsTotal() const { return m_maxRoundsTotal; }
 
+// PUBLIC METHODS
+void NetworkConfig::setMaxRoundsTotal(int maxRoundsTotal) {
+  m_maxRoundsTotal = maxRoundsTotal;
+}
+
 }  // namespace RRS
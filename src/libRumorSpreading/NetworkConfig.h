@@ -68,6 +68,9 @@ class NetworkConfig {
   int maxRoundsInC() const;
 
   int maxRoundsTotal() const;
+
+  // METHODS
+  void setMaxRoundsTotal(int maxRoundsTotal);
 };
 
 }  // namespace RRS
@@ -35,6 +35,9 @@ std::map<RumorHolder::StatisticKey, std::string>
         {StatisticKey::NumEmptyPushMessages, LITERAL(NumEmptyPushMessages)},
         {StatisticKey::NumLazyPullMessages, LITERAL(NumLazyPullMessages)},
         {StatisticKey::NumEmptyPullMessages, LITERAL(NumEmptyPullMessages)},
+        {StatisticKey::NumNewRumorReceipts, LITERAL(NumNewRumorReceipts)},
+        {StatisticKey::NumDuplicateRumorReceipts,
+         LITERAL(NumDuplicateRumorReceipts)},
 };
 
 // PRIVATE METHODS
@@ -63,6 +66,44 @@ void RumorHolder::increaseStatValue(StatisticKey key, double value) {
   }
 }
 
+void RumorHolder::adapt() {
+  const int receipts =
+      m_adaptation.m_newReceipts + m_adaptation.m_duplicateReceipts;
+  if (receipts > 0) {
+    m_adaptation.m_duplicateRatio =
+        (1 - ADAPT_WEIGHT) * m_adaptation.m_duplicateRatio +
+        ADAPT_WEIGHT * m_adaptation.m_duplicateReceipts / receipts;
+  }
+
+  // Peers only answer pushes if asked to respond to lazy pushes
+  if (SEND_RESPONSE_FOR_LAZY_PUSH && !m_adaptation.m_lastToMembers.empty()) {
+    int numResponded = 0;
+    for (const int peer : m_adaptation.m_lastToMembers) {
+      numResponded += m_peersInCurrentRound.count(peer);
+    }
+    m_adaptation.m_responseRatio =
+        (1 - ADAPT_WEIGHT) * m_adaptation.m_responseRatio +
+        ADAPT_WEIGHT * numResponded / m_adaptation.m_lastToMembers.size();
+  }
+
+  m_adaptation.m_newReceipts = 0;
+  m_adaptation.m_duplicateReceipts = 0;
+
+  int maxRoundsTotal = m_networkConfig.maxRoundsTotal();
+  if (m_adaptation.m_responseRatio < ADAPT_MIN_RESPONSE_RATIO) {
+    m_maxNeighborsPerRound = std::min(m_maxNeighborsPerRound + 1,
+                                      m_adaptation.m_maxNeighborsPerRound);
+    maxRoundsTotal =
+        std::min(maxRoundsTotal + 1, m_adaptation.m_maxRoundsTotal);
+  } else if (m_adaptation.m_duplicateRatio > ADAPT_MAX_DUPLICATE_RATIO) {
+    m_maxNeighborsPerRound = std::max(m_maxNeighborsPerRound - 1,
+                                      m_adaptation.m_minNeighborsPerRound);
+    maxRoundsTotal =
+        std::max(maxRoundsTotal - 1, m_adaptation.m_minRoundsTotal);
+  }
+  m_networkConfig.setMaxRoundsTotal(maxRoundsTotal);
+}
+
 // CONSTRUCTORS
 RumorHolder::RumorHolder(const std::unordered_set<int>& peers, int id)
     : m_id(id),
@@ -154,7 +195,8 @@ RumorHolder::RumorHolder(const RumorHolder& other)
       m_nextMemberCb(other.m_nextMemberCb),
       m_nonPriorityPeers(other.m_nonPriorityPeers),
       m_statistics(other.m_statistics),
-      m_maxNeighborsPerRound(other.m_maxNeighborsPerRound) {}
+      m_maxNeighborsPerRound(other.m_maxNeighborsPerRound),
+      m_adaptation(other.m_adaptation) {}
 
 // MOVE CONSTRUCTOR
 RumorHolder::RumorHolder(RumorHolder&& other) noexcept
@@ -167,7 +209,8 @@ RumorHolder::RumorHolder(RumorHolder&& other) noexcept
       m_nextMemberCb(std::move(other.m_nextMemberCb)),
       m_nonPriorityPeers(std::move(other.m_nonPriorityPeers)),
       m_statistics(std::move(other.m_statistics)),
-      m_maxNeighborsPerRound(other.m_maxNeighborsPerRound) {}
+      m_maxNeighborsPerRound(other.m_maxNeighborsPerRound),
+      m_adaptation(std::move(other.m_adaptation)) {}
 
 // PUBLIC METHODS
 bool RumorHolder::addRumor(int rumorId) {
@@ -212,8 +255,12 @@ std::pair<int, std::vector<Message>> RumorHolder::receivedMessage(
   const int theirRound = message.rounds();
   if (receivedRumorId >= 0) {
     if (m_rumors.count(receivedRumorId) > 0) {
+      increaseStatValue(StatisticKey::NumDuplicateRumorReceipts, 1);
+      m_adaptation.m_duplicateReceipts++;
       m_rumors.at(receivedRumorId).rumorReceived(fromPeer, message.rounds());
     } else {
+      increaseStatValue(StatisticKey::NumNewRumorReceipts, 1);
+      m_adaptation.m_newReceipts++;
       m_rumors.insert(std::make_pair(
           receivedRumorId,
           RumorStateMachine(&m_networkConfig, fromPeer, theirRound)));
@@ -234,6 +281,10 @@ std::pair<std::vector<int>, std::vector<Message>> RumorHolder::advanceRound() {
 
   increaseStatValue(StatisticKey::Rounds, 1);
 
+  if (m_adaptation.m_enabled) {
+    adapt();
+  }
+
   std::vector<int> toMembers;
   int toMember;
   int retryCount = 0;
@@ -321,10 +372,27 @@ std::pair<std::vector<int>, std::vector<Message>> RumorHolder::advanceRound() {
 
   // Clear round state
   m_peersInCurrentRound.clear();
+  if (m_adaptation.m_enabled) {
+    m_adaptation.m_lastToMembers.clear();
+    m_adaptation.m_lastToMembers.insert(toMembers.begin(), toMembers.end());
+  }
 
   return std::make_pair(toMembers, pushMessages);
 }
 
+void RumorHolder::enableAdaptation(int minNeighborsPerRound,
+                                   int minRoundsTotal) {
+  std::lock_guard<std::mutex> guard(m_mutex);  // critical section
+
+  m_adaptation.m_enabled = true;
+  m_adaptation.m_maxNeighborsPerRound = m_maxNeighborsPerRound;
+  m_adaptation.m_minNeighborsPerRound =
+      std::max(1, std::min(minNeighborsPerRound, m_maxNeighborsPerRound));
+  m_adaptation.m_maxRoundsTotal = m_networkConfig.maxRoundsTotal();
+  m_adaptation.m_minRoundsTotal = std::max(
+      1, std::min(minRoundsTotal, m_adaptation.m_maxRoundsTotal));
+}
+
 // PUBLIC CONST METHODS
 int RumorHolder::id() const { return m_id; }
 
@@ -342,11 +410,22 @@ const std::map<RumorHolder::StatisticKey, double>& RumorHolder::statistics()
   return m_statistics;
 }
 
+int RumorHolder::maxNeighborsPerRound() const {
+  std::lock_guard<std::mutex> guard(m_mutex);  // critical section
+  return m_maxNeighborsPerRound;
+}
+
 bool RumorHolder::rumorExists(int rumorId) const {
   std::lock_guard<std::mutex> guard(m_mutex);  // critical section
   return m_rumors.count(rumorId) > 0;
 }
 
+bool RumorHolder::isOld(int rumorId) const {
+  std::lock_guard<std::mutex> guard(m_mutex);  // critical section
+  auto it = m_rumors.find(rumorId);
+  return it != m_rumors.end() && it->second.isOld();
+}
+
 std::ostream& RumorHolder::printStatistics(std::ostream& outStream) const {
   outStream << m_id << ": {"
             << "\n";
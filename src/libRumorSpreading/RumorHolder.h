@@ -46,6 +46,8 @@ class RumorHolder : public RumorSpreadingInterface {
     NumEmptyPushMessages,
     NumLazyPullMessages,
     NumEmptyPullMessages,
+    NumNewRumorReceipts,
+    NumDuplicateRumorReceipts,
   };
 
   static std::map<StatisticKey, std::string> s_enumKeyToString;
@@ -63,7 +65,27 @@ class RumorHolder : public RumorSpreadingInterface {
   std::map<StatisticKey, double> m_statistics;
   int m_maxNeighborsPerRound;
 
+  // Fan-out and total rounds tuned from what came back in the last rounds
+  struct Adaptation {
+    bool m_enabled = false;
+    int m_minNeighborsPerRound = 1;
+    int m_maxNeighborsPerRound = 1;
+    int m_minRoundsTotal = 1;
+    int m_maxRoundsTotal = 1;
+    // Moving averages of the share of rumor receipts we already knew of, and
+    // of the share of last round's peers that sent us anything
+    double m_duplicateRatio = 0;
+    double m_responseRatio = 1;
+    int m_newReceipts = 0;
+    int m_duplicateReceipts = 0;
+    std::unordered_set<int> m_lastToMembers;
+  };
+  Adaptation m_adaptation;
+
   static const int MAX_RETRY = 3;
+  static constexpr double ADAPT_WEIGHT = 0.25;
+  static constexpr double ADAPT_MAX_DUPLICATE_RATIO = 0.8;
+  static constexpr double ADAPT_MIN_RESPONSE_RATIO = 0.5;
 
   // METHODS
   // Copy the member ids into a vector
@@ -75,6 +97,9 @@ class RumorHolder : public RumorSpreadingInterface {
   // Add the specified 'value' to the previous statistic value
   void increaseStatValue(StatisticKey key, double value);
 
+  // Update fan-out and total rounds at the end of a round
+  void adapt();
+
  public:
   // CONSTRUCTORS
   /// Create an instance which automatically figures out the network parameters.
@@ -104,6 +129,11 @@ class RumorHolder : public RumorSpreadingInterface {
 
   std::pair<std::vector<int>, std::vector<Message>> advanceRound() override;
 
+  /// Lets fan-out and total rounds drop down to the given floors while most
+  /// rumor receipts are duplicates, and climb back to their initial values
+  /// when peers stop answering
+  void enableAdaptation(int minNeighborsPerRound, int minRoundsTotal);
+
   // CONST METHODS
   int id() const;
 
@@ -115,6 +145,8 @@ class RumorHolder : public RumorSpreadingInterface {
 
   bool isOld(int rumorId) const;
 
+  int maxNeighborsPerRound() const;
+
   const std::map<StatisticKey, double>& statistics() const;
 
   std::ostream& printStatistics(std::ostream& outStream) const;
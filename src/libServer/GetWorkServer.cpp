@@ -17,10 +17,11 @@
 
 #include <chrono>
 
-#include <jsonrpccpp/server/connectors/httpserver.h>
 #include "depends/libethash/include/ethash/ethash.hpp"
 
 #include "GetWorkServer.h"
+#include "StratumServer.h"
+#include "ThreadedHttpServer.h"
 #include "common/Constants.h"
 #include "libPOW/pow.h"
 #include "libUtils/DataConversion.h"
@@ -36,7 +37,9 @@ static ethash_mining_result_t FAIL_RESULT = {"", "", 0, false};
 
 // GetInstance returns the singleton instance
 GetWorkServer& GetWorkServer::GetInstance() {
-  static HttpServer httpserver(GETWORK_SERVER_PORT);
+  static ThreadedHttpServer httpserver(
+      GETWORK_SERVER_PORT, RPC_SERVER_THREADS, RPC_MAX_CONNECTIONS,
+      RPC_KEEPALIVE_TIMEOUT_IN_SEC, RPC_MAX_REQUEST_BYTES, RPC_MAX_IN_FLIGHT);
   static GetWorkServer powserver(httpserver);
   return powserver;
 }
@@ -78,6 +81,7 @@ bool GetWorkServer::StartMining(const PoWWorkPackage& wp) {
     m_curWork = wp;
     m_isMining = true;
   }
+  StratumServer::GetInstance().PublishWork(wp);
 
   LOG_GENERAL(INFO, "Got PoW Work : "
                         << "header [" << wp.header << "], block ["
@@ -90,6 +94,7 @@ bool GetWorkServer::StartMining(const PoWWorkPackage& wp) {
 // StopMining stops mining and clear result
 void GetWorkServer::StopMining() {
   m_isMining = false;
+  StratumServer::GetInstance().ClearWork();
 
   lock_guard<mutex> g(m_mutexResult);
   m_curResult.success = false;
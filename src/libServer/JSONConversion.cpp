@@ -92,6 +92,47 @@ const Json::Value JSONConversion::convertTxBlocktoJson(const TxBlock& txblock) {
   return ret;
 }
 
+void JSONConversion::convertTxBlocktoJson(const TxBlock& txblock,
+                                          JSONStreamWriter& writer) {
+  std::string HeaderSignStr;
+  if (!DataConversion::SerializableToHexStr(txblock.GetCS2(), HeaderSignStr)) {
+    writer.Null();
+    return;
+  }
+
+  const TxBlockHeader& txheader = txblock.GetHeader();
+
+  // Members in the order jsoncpp sorts them
+  writer.BeginObject().Key("body").BeginObject();
+  writer.Key("HeaderSign").String(HeaderSignStr);
+  writer.Key("MicroBlockInfos").BeginArray();
+  for (auto const& i : txblock.GetMicroBlockInfos()) {
+    writer.BeginObject();
+    writer.Key("MicroBlockHash").Hash(i.m_microBlockHash);
+    writer.Key("MicroBlockShardId").Uint(i.m_shardId);
+    writer.Key("MicroBlockTxnRootHash").Hash(i.m_txnRootHash);
+    writer.EndObject();
+  }
+  writer.EndArray().EndObject();
+
+  writer.Key("header").BeginObject();
+  writer.Key("BlockNum").String(to_string(txheader.GetBlockNum()));
+  writer.Key("DSBlockNum").String(to_string(txheader.GetDSBlockNum()));
+  writer.Key("GasLimit").String(to_string(txheader.GetGasLimit()));
+  writer.Key("GasUsed").String(to_string(txheader.GetGasUsed()));
+  writer.Key("MbInfoHash").Hash(txheader.GetMbInfoHash());
+  writer.Key("MinerPubKey").Hex(txheader.GetMinerPubKey(), "0x");
+  writer.Key("NumMicroBlocks").Uint(txblock.GetMicroBlockInfos().size());
+  writer.Key("NumTxns").Uint(txheader.GetNumTxs());
+  writer.Key("PrevBlockHash").Hash(txheader.GetPrevHash());
+  writer.Key("Rewards").String(txheader.GetRewards().str());
+  writer.Key("StateDeltaHash").Hash(txheader.GetStateDeltaHash());
+  writer.Key("StateRootHash").Hash(txheader.GetStateRootHash());
+  writer.Key("Timestamp").String(to_string(txblock.GetTimestamp()));
+  writer.Key("Version").Uint(txheader.GetVersion());
+  writer.EndObject().EndObject();
+}
+
 const Json::Value JSONConversion::convertDSblocktoJson(const DSBlock& dsblock) {
   Json::Value ret;
   Json::Value ret_header;
@@ -125,14 +166,28 @@ const Json::Value JSONConversion::convertDSblocktoJson(const DSBlock& dsblock) {
 }
 
 const Transaction JSONConversion::convertJsontoTx(const Json::Value& _json) {
-  uint32_t version = _json["version"].asUInt();
+  JSONTxnFields fields;
+  fields.m_version = _json["version"].asUInt();
+  fields.m_nonce = _json["nonce"].asString();
+  fields.m_toAddr = _json["toAddr"].asString();
+  fields.m_amount = _json["amount"].asString();
+  fields.m_gasPrice = _json["gasPrice"].asString();
+  fields.m_gasLimit = _json["gasLimit"].asString();
+  fields.m_pubKey = _json["pubKey"].asString();
+  fields.m_signature = _json["signature"].asString();
+  fields.m_code = _json["code"].asString();
+  fields.m_data = _json["data"].asString();
+  return convertJsontoTx(fields);
+}
 
-  string nonce_str = _json["nonce"].asString();
-  uint64_t nonce = strtoull(nonce_str.c_str(), NULL, 0);
+const Transaction JSONConversion::convertJsontoTx(const JSONTxnFields& fields) {
+  uint32_t version = fields.m_version;
+
+  uint64_t nonce = strtoull(fields.m_nonce.c_str(), NULL, 0);
 
-  string toAddr_str = _json["toAddr"].asString();
   string lower_case_addr;
-  if (!AddressChecksum::VerifyChecksumAddress(toAddr_str, lower_case_addr)) {
+  if (!AddressChecksum::VerifyChecksumAddress(fields.m_toAddr,
+                                              lower_case_addr)) {
     throw jsonrpc::JsonRpcException(Server::RPC_INVALID_PARAMETER,
                                     "To Address checksum does not match");
   }
@@ -145,26 +200,21 @@ const Transaction JSONConversion::convertJsontoTx(const Json::Value& _json) {
 
   Address toAddr(toAddr_ser);
 
-  string amount_str = _json["amount"].asString();
-  uint128_t amount(amount_str);
+  uint128_t amount(fields.m_amount);
 
-  string gasPrice_str = _json["gasPrice"].asString();
-  uint128_t gasPrice(gasPrice_str);
-  string gasLimit_str = _json["gasLimit"].asString();
-  uint64_t gasLimit = strtoull(gasLimit_str.c_str(), NULL, 0);
+  uint128_t gasPrice(fields.m_gasPrice);
+  uint64_t gasLimit = strtoull(fields.m_gasLimit.c_str(), NULL, 0);
 
-  string pubKey_str = _json["pubKey"].asString();
   bytes pubKey_ser;
-  if (!DataConversion::HexStrToUint8Vec(pubKey_str, pubKey_ser)) {
+  if (!DataConversion::HexStrToUint8Vec(fields.m_pubKey, pubKey_ser)) {
     LOG_GENERAL(WARNING, "json cointaining invalid hex str for pubkey");
     throw jsonrpc::JsonRpcException(Server::RPC_INVALID_PARAMETER,
                                     "Invalid Hex Str for PubKey");
   }
   PubKey pubKey(pubKey_ser, 0);
 
-  string sign_str = _json["signature"].asString();
   bytes sign;
-  if (!DataConversion::HexStrToUint8Vec(sign_str, sign)) {
+  if (!DataConversion::HexStrToUint8Vec(fields.m_signature, sign)) {
     LOG_GENERAL(WARNING, "json cointaining invalid hex str for sign");
     throw jsonrpc::JsonRpcException(Server::RPC_INVALID_PARAMETER,
                                     "Invalid Hex Str for Signature");
@@ -172,8 +222,8 @@ const Transaction JSONConversion::convertJsontoTx(const Json::Value& _json) {
 
   bytes code, data;
 
-  code = DataConversion::StringToCharArray(_json["code"].asString());
-  data = DataConversion::StringToCharArray(_json["data"].asString());
+  code = DataConversion::StringToCharArray(fields.m_code);
+  data = DataConversion::StringToCharArray(fields.m_data);
 
   Transaction tx1(version, nonce, toAddr, pubKey, amount, gasPrice, gasLimit,
                   code, data, Signature(sign, 0));
@@ -249,6 +299,35 @@ bool JSONConversion::checkJsonTx(const Json::Value& _json) {
   return ret;
 }
 
+bool JSONConversion::checkJsonTx(const JSONTxnFields& fields) {
+  try {
+    uint128_t amount(fields.m_amount);
+  } catch (exception& e) {
+    LOG_GENERAL(INFO, "Fault in amount " << e.what());
+    throw jsonrpc::JsonRpcException(Server::RPC_INVALID_PARAMETER,
+                                    "Amount invalid string");
+  }
+  if (fields.m_pubKey.size() != PUB_KEY_SIZE * 2) {
+    LOG_GENERAL(INFO, "PubKey size wrong " << fields.m_pubKey.size());
+    throw jsonrpc::JsonRpcException(Server::RPC_INVALID_PARAMETER,
+                                    "Invalid PubKey Size");
+  }
+  if (fields.m_signature.size() != TRAN_SIG_SIZE * 2) {
+    LOG_GENERAL(INFO, "signature size wrong " << fields.m_signature.size());
+    throw jsonrpc::JsonRpcException(Server::RPC_INVALID_PARAMETER,
+                                    "Invalid Signature size");
+  }
+  string lower_case_addr;
+  if (!AddressChecksum::VerifyChecksumAddress(fields.m_toAddr,
+                                              lower_case_addr)) {
+    LOG_GENERAL(INFO, "To Address checksum wrong " << fields.m_toAddr);
+    throw jsonrpc::JsonRpcException(Server::RPC_INVALID_PARAMETER,
+                                    "To Addr checksum wrong");
+  }
+
+  return true;
+}
+
 const Json::Value JSONConversion::convertTxtoJson(
     const TransactionWithReceipt& twr) {
   Json::Value _json;
@@ -267,3 +346,22 @@ const Json::Value JSONConversion::convertTxtoJson(
 
   return _json;
 }
+
+void JSONConversion::convertTxtoJson(const TransactionWithReceipt& twr,
+                                     JSONStreamWriter& writer) {
+  const Transaction& tx = twr.GetTransaction();
+
+  // Members in the order jsoncpp sorts them
+  writer.BeginObject();
+  writer.Key("ID").Hash(tx.GetTranID());
+  writer.Key("amount").String(tx.GetAmount().str());
+  writer.Key("gasLimit").String(to_string(tx.GetGasLimit()));
+  writer.Key("gasPrice").String(tx.GetGasPrice().str());
+  writer.Key("nonce").String(to_string(tx.GetNonce()));
+  writer.Key("receipt").Value(twr.GetTransactionReceipt().GetJsonValue());
+  writer.Key("senderPubKey").Hex(tx.GetSenderPubKey(), "0x");
+  writer.Key("signature").Hex(tx.GetSignature(), "0x");
+  writer.Key("toAddr").Hash(tx.GetToAddr());
+  writer.Key("version").String(to_string(tx.GetVersion()));
+  writer.EndObject();
+}
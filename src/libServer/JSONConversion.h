@@ -24,6 +24,8 @@
 
 #include "libData/BlockData/Block.h"
 #include "libData/BlockData/BlockHeader/BlockHashSet.h"
+#include "libServer/JSONStreamWriter.h"
+#include "libServer/JSONTxnParser.h"
 
 class JSONConversion {
  public:
@@ -32,14 +34,24 @@ class JSONConversion {
       const std::vector<MicroBlockInfo>& v);
   // converts a TxBlock to JSON object
   static const Json::Value convertTxBlocktoJson(const TxBlock& txblock);
+  // writes the same JSON object without building it
+  static void convertTxBlocktoJson(const TxBlock& txblock,
+                                   JSONStreamWriter& writer);
   // converts a DSBlocck to JSON object
   static const Json::Value convertDSblocktoJson(const DSBlock& dsblock);
   // converts a JSON to Tx
   static const Transaction convertJsontoTx(const Json::Value& _json);
+  // converts the members JSONTxnParser read to Tx
+  static const Transaction convertJsontoTx(const JSONTxnFields& fields);
   // check if a Json is a valid Tx
   static bool checkJsonTx(const Json::Value& _json);
+  // makes the checks of checkJsonTx that the parser left to the values
+  static bool checkJsonTx(const JSONTxnFields& fields);
   // Convert a Tx to JSON object
   static const Json::Value convertTxtoJson(const TransactionWithReceipt& twr);
+  // writes the same JSON object without building it
+  static void convertTxtoJson(const TransactionWithReceipt& twr,
+                              JSONStreamWriter& writer);
 };
 
 #endif  // __JSONCONVERSION_H__
@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "JSONResponseCache.h"
+#include "libUtils/Logger.h"
+
+using namespace std;
+
+namespace {
+const uint64_t STATS_LOG_INTERVAL = 10000;
+}  // namespace
+
+JSONResponseCache::JSONResponseCache(size_t capacity) : m_capacity(capacity) {}
+
+bool JSONResponseCache::Get(const string& method, const string& arg,
+                            Json::Value& value) {
+  Value cached;
+  if (!Lookup(method + ":" + arg, cached)) {
+    return false;
+  }
+  value = move(cached.m_value);
+  return true;
+}
+
+void JSONResponseCache::Put(const string& method, const string& arg,
+                            const Json::Value& value) {
+  Store(method + ":" + arg, {value, ""});
+}
+
+bool JSONResponseCache::GetSerialized(const string& method, const string& arg,
+                                      string& json) {
+  Value cached;
+  if (!Lookup(method + "=" + arg, cached)) {
+    return false;
+  }
+  json = move(cached.m_serialized);
+  return true;
+}
+
+void JSONResponseCache::PutSerialized(const string& method, const string& arg,
+                                      const string& json) {
+  Store(method + "=" + arg, {Json::Value(), json});
+}
+
+bool JSONResponseCache::Lookup(const string& key, Value& value) {
+  bool found = false;
+  {
+    lock_guard<mutex> g(m_mutex);
+    auto it = m_index.find(key);
+    if (it != m_index.end()) {
+      m_lru.splice(m_lru.begin(), m_lru, it->second);
+      value = it->second->second;
+      found = true;
+    }
+  }
+
+  const uint64_t hits = found ? ++m_hits : m_hits.load();
+  const uint64_t misses = found ? m_misses.load() : ++m_misses;
+  if ((hits + misses) % STATS_LOG_INTERVAL == 0) {
+    LOG_GENERAL(INFO, "JSON response cache hits " << hits << " misses "
+                                                  << misses);
+  }
+
+  return found;
+}
+
+void JSONResponseCache::Store(const string& key, Value&& value) {
+  if (m_capacity == 0) {
+    return;
+  }
+
+  lock_guard<mutex> g(m_mutex);
+  auto it = m_index.find(key);
+  if (it != m_index.end()) {
+    it->second->second = move(value);
+    m_lru.splice(m_lru.begin(), m_lru, it->second);
+    return;
+  }
+
+  m_lru.emplace_front(key, move(value));
+  m_index[key] = m_lru.begin();
+  if (m_lru.size() > m_capacity) {
+    m_index.erase(m_lru.back().first);
+    m_lru.pop_back();
+  }
+}
+
+JSONResponseCache::Stats JSONResponseCache::GetStats() const {
+  return {m_hits.load(), m_misses.load()};
+}
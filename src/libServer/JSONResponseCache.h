@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __JSONRESPONSECACHE_H__
+#define __JSONRESPONSECACHE_H__
+
+#include <json/json.h>
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+/// Responses of RPCs whose result never changes for the same argument, such
+/// as finalized blocks, keyed by method and argument. The least recently
+/// used entry is evicted once the count limit is reached.
+class JSONResponseCache {
+ public:
+  struct Stats {
+    uint64_t m_hits;
+    uint64_t m_misses;
+  };
+
+  explicit JSONResponseCache(size_t capacity);
+
+  /// Returns true and fills value if the response is cached
+  bool Get(const std::string& method, const std::string& arg,
+           Json::Value& value);
+
+  void Put(const std::string& method, const std::string& arg,
+           const Json::Value& value);
+
+  /// Same, for results the streaming handlers keep already serialized
+  bool GetSerialized(const std::string& method, const std::string& arg,
+                     std::string& json);
+  void PutSerialized(const std::string& method, const std::string& arg,
+                     const std::string& json);
+
+  Stats GetStats() const;
+
+ private:
+  /// One of the two is set, depending on the key
+  struct Value {
+    Json::Value m_value;
+    std::string m_serialized;
+  };
+  using Entry = std::pair<std::string, Value>;
+
+  bool Lookup(const std::string& key, Value& value);
+  void Store(const std::string& key, Value&& value);
+
+  std::mutex m_mutex;
+  std::list<Entry> m_lru;
+  std::unordered_map<std::string, std::list<Entry>::iterator> m_index;
+  const size_t m_capacity;
+
+  std::atomic<uint64_t> m_hits{0};
+  std::atomic<uint64_t> m_misses{0};
+};
+
+#endif  // __JSONRESPONSECACHE_H__
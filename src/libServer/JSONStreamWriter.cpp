@@ -0,0 +1,196 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "JSONStreamWriter.h"
+#include "libUtils/DataConversion.h"
+
+using namespace std;
+
+namespace {
+
+/// Whether str can be written between quotes as is
+bool IsPlain(const string& str) {
+  for (const unsigned char c : str) {
+    if (c < 0x20 || c >= 0x7f || c == '"' || c == '\\') {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+void JSONStreamWriter::BeforeValue() {
+  if (m_afterKey) {
+    m_afterKey = false;
+    return;
+  }
+  if (!m_wroteMember.empty()) {
+    if (m_wroteMember.back()) {
+      m_out += ',';
+    }
+    m_wroteMember.back() = true;
+  }
+}
+
+JSONStreamWriter& JSONStreamWriter::BeginObject() {
+  BeforeValue();
+  m_out += '{';
+  m_wroteMember.push_back(false);
+  return *this;
+}
+
+JSONStreamWriter& JSONStreamWriter::EndObject() {
+  m_wroteMember.pop_back();
+  m_out += '}';
+  return *this;
+}
+
+JSONStreamWriter& JSONStreamWriter::BeginArray() {
+  BeforeValue();
+  m_out += '[';
+  m_wroteMember.push_back(false);
+  return *this;
+}
+
+JSONStreamWriter& JSONStreamWriter::EndArray() {
+  m_wroteMember.pop_back();
+  m_out += ']';
+  return *this;
+}
+
+JSONStreamWriter& JSONStreamWriter::Key(const char* key) {
+  BeforeValue();
+  m_out += '"';
+  m_out += key;
+  m_out += "\":";
+  m_afterKey = true;
+  return *this;
+}
+
+JSONStreamWriter& JSONStreamWriter::String(const string& str) {
+  BeforeValue();
+  if (IsPlain(str)) {
+    m_out += '"';
+    m_out += str;
+    m_out += '"';
+  } else {
+    m_out += Json::valueToQuotedString(str.c_str());
+  }
+  return *this;
+}
+
+JSONStreamWriter& JSONStreamWriter::Int(int64_t value) {
+  BeforeValue();
+  m_out += to_string(value);
+  return *this;
+}
+
+JSONStreamWriter& JSONStreamWriter::Uint(uint64_t value) {
+  BeforeValue();
+  m_out += to_string(value);
+  return *this;
+}
+
+JSONStreamWriter& JSONStreamWriter::Bool(bool value) {
+  BeforeValue();
+  m_out += value ? "true" : "false";
+  return *this;
+}
+
+JSONStreamWriter& JSONStreamWriter::Null() {
+  BeforeValue();
+  m_out += "null";
+  return *this;
+}
+
+JSONStreamWriter& JSONStreamWriter::Hex(const unsigned char* data, size_t size,
+                                        const char* prefix) {
+  BeforeValue();
+  m_out += '"';
+  m_out += prefix;
+  const size_t pos = m_out.size();
+  m_out.resize(pos + 2 * size);
+  DataConversion::HexEncode(data, size, &m_out[pos]);
+  m_out += '"';
+  return *this;
+}
+
+JSONStreamWriter& JSONStreamWriter::Hex(const Serializable& input,
+                                        const char* prefix) {
+  bytes serialized;
+  input.Serialize(serialized, 0);
+  return Hex(serialized.data(), serialized.size(), prefix);
+}
+
+JSONStreamWriter& JSONStreamWriter::LowerHex(const unsigned char* data,
+                                             size_t size) {
+  static const char* digits = "0123456789abcdef";
+
+  BeforeValue();
+  m_out += '"';
+  const size_t pos = m_out.size();
+  m_out.resize(pos + 2 * size);
+  for (size_t i = 0; i < size; i++) {
+    m_out[pos + 2 * i] = digits[data[i] >> 4];
+    m_out[pos + 2 * i + 1] = digits[data[i] & 0x0f];
+  }
+  m_out += '"';
+  return *this;
+}
+
+JSONStreamWriter& JSONStreamWriter::Value(const Json::Value& value) {
+  switch (value.type()) {
+    case Json::nullValue:
+      return Null();
+    case Json::intValue:
+      return Int(value.asLargestInt());
+    case Json::uintValue:
+      return Uint(value.asLargestUInt());
+    case Json::realValue:
+      BeforeValue();
+      m_out += Json::valueToString(value.asDouble());
+      return *this;
+    case Json::stringValue:
+      return String(value.asString());
+    case Json::booleanValue:
+      return Bool(value.asBool());
+    case Json::arrayValue:
+      BeginArray();
+      for (const auto& element : value) {
+        Value(element);
+      }
+      return EndArray();
+    case Json::objectValue:
+      BeginObject();
+      for (auto it = value.begin(); it != value.end(); ++it) {
+        BeforeValue();
+        m_out += Json::valueToQuotedString(it.name().c_str());
+        m_out += ':';
+        m_afterKey = true;
+        Value(*it);
+      }
+      return EndObject();
+  }
+  return *this;
+}
+
+JSONStreamWriter& JSONStreamWriter::Raw(const string& json) {
+  BeforeValue();
+  m_out += json;
+  return *this;
+}
@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __JSONSTREAMWRITER_H__
+#define __JSONSTREAMWRITER_H__
+
+#include <json/json.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "common/Serializable.h"
+#include "depends/common/FixedHash.h"
+
+/// Appends JSON text straight to a string, for RPC results that are not
+/// worth building as a Json::Value first. Commas and colons are placed by
+/// the writer, hex digits are encoded in place.
+///
+/// Members are written in the order given. Writers that have to match the
+/// output of Json::FastWriter give them sorted, as jsoncpp keeps them.
+class JSONStreamWriter {
+ public:
+  explicit JSONStreamWriter(std::string& out) : m_out(out) {}
+
+  JSONStreamWriter& BeginObject();
+  JSONStreamWriter& EndObject();
+  JSONStreamWriter& BeginArray();
+  JSONStreamWriter& EndArray();
+
+  /// Starts the member called key, which must not need escaping
+  JSONStreamWriter& Key(const char* key);
+
+  JSONStreamWriter& String(const std::string& str);
+  JSONStreamWriter& Int(int64_t value);
+  JSONStreamWriter& Uint(uint64_t value);
+  JSONStreamWriter& Bool(bool value);
+  JSONStreamWriter& Null();
+
+  /// Quoted uppercase hex of data, as DataConversion writes it
+  JSONStreamWriter& Hex(const unsigned char* data, size_t size,
+                        const char* prefix = "");
+  JSONStreamWriter& Hex(const Serializable& input, const char* prefix = "");
+
+  /// Quoted lowercase hex, as FixedHash::hex() writes it
+  template <unsigned int N>
+  JSONStreamWriter& Hash(const dev::FixedHash<N>& hash) {
+    return LowerHex(hash.data(), N);
+  }
+
+  /// A Json::Value, as Json::FastWriter writes it
+  JSONStreamWriter& Value(const Json::Value& value);
+
+  /// A value written out before, such as a cached result
+  JSONStreamWriter& Raw(const std::string& json);
+
+ private:
+  std::string& m_out;
+  /// Whether anything was written yet in each open object or array
+  std::vector<bool> m_wroteMember;
+  bool m_afterKey = false;
+
+  void BeforeValue();
+  JSONStreamWriter& LowerHex(const unsigned char* data, size_t size);
+};
+
+#endif  // __JSONSTREAMWRITER_H__
@@ -0,0 +1,369 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cstring>
+#include <limits>
+
+#include "JSONTxnParser.h"
+
+using namespace std;
+
+namespace {
+
+/// Cursor over the request text. Every read returns false on input the
+/// fast path leaves to jsoncpp.
+class Reader {
+ public:
+  Reader(const char* begin, const char* end) : m_pos(begin), m_end(end) {}
+
+  bool Consume(char c) {
+    SkipSpace();
+    if (m_pos == m_end || *m_pos != c) {
+      return false;
+    }
+    ++m_pos;
+    return true;
+  }
+
+  bool Peek(char c) {
+    SkipSpace();
+    return m_pos != m_end && *m_pos == c;
+  }
+
+  bool AtEnd() {
+    SkipSpace();
+    return m_pos == m_end;
+  }
+
+  bool ReadString(string& out);
+  /// Reads an unsigned integer, keeping its digits as asString() has them
+  bool ReadUint(uint64_t& value, string& digits);
+
+ private:
+  const char* m_pos;
+  const char* const m_end;
+
+  void SkipSpace() {
+    while (m_pos != m_end &&
+           (*m_pos == ' ' || *m_pos == '\t' || *m_pos == '\n' ||
+            *m_pos == '\r')) {
+      ++m_pos;
+    }
+  }
+
+  bool ReadEscape(string& out);
+  bool ReadHex4(unsigned int& value);
+};
+
+bool Reader::ReadString(string& out) {
+  if (!Consume('"')) {
+    return false;
+  }
+  out.clear();
+
+  // memchr runs on the vector units, so the long unescaped runs of hex in
+  // a txn are copied in a few instructions per block
+  while (true) {
+    const char* quote =
+        static_cast<const char*>(memchr(m_pos, '"', m_end - m_pos));
+    if (quote == nullptr) {
+      return false;
+    }
+    const char* escape =
+        static_cast<const char*>(memchr(m_pos, '\\', quote - m_pos));
+    if (escape == nullptr) {
+      out.append(m_pos, quote);
+      m_pos = quote + 1;
+      return true;
+    }
+    out.append(m_pos, escape);
+    m_pos = escape + 1;
+    if (!ReadEscape(out)) {
+      return false;
+    }
+  }
+}
+
+bool Reader::ReadHex4(unsigned int& value) {
+  if (m_end - m_pos < 4) {
+    return false;
+  }
+  value = 0;
+  for (int i = 0; i < 4; i++, m_pos++) {
+    const char c = *m_pos;
+    value <<= 4;
+    if (c >= '0' && c <= '9') {
+      value |= c - '0';
+    } else if (c >= 'a' && c <= 'f') {
+      value |= c - 'a' + 10;
+    } else if (c >= 'A' && c <= 'F') {
+      value |= c - 'A' + 10;
+    } else {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool Reader::ReadEscape(string& out) {
+  if (m_pos == m_end) {
+    return false;
+  }
+  switch (*m_pos++) {
+    case '"':
+      out += '"';
+      return true;
+    case '\\':
+      out += '\\';
+      return true;
+    case '/':
+      out += '/';
+      return true;
+    case 'b':
+      out += '\b';
+      return true;
+    case 'f':
+      out += '\f';
+      return true;
+    case 'n':
+      out += '\n';
+      return true;
+    case 'r':
+      out += '\r';
+      return true;
+    case 't':
+      out += '\t';
+      return true;
+    case 'u':
+      break;
+    default:
+      return false;
+  }
+
+  unsigned int cp;
+  if (!ReadHex4(cp) || (cp >= 0xDC00 && cp <= 0xDFFF)) {
+    return false;
+  }
+  if (cp >= 0xD800 && cp <= 0xDBFF) {
+    unsigned int low;
+    if (m_end - m_pos < 2 || m_pos[0] != '\\' || m_pos[1] != 'u') {
+      return false;
+    }
+    m_pos += 2;
+    if (!ReadHex4(low) || low < 0xDC00 || low > 0xDFFF) {
+      return false;
+    }
+    cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+  }
+
+  // UTF-8, as jsoncpp decodes it
+  if (cp < 0x80) {
+    out += static_cast<char>(cp);
+  } else if (cp < 0x800) {
+    out += static_cast<char>(0xC0 | (cp >> 6));
+    out += static_cast<char>(0x80 | (cp & 0x3F));
+  } else if (cp < 0x10000) {
+    out += static_cast<char>(0xE0 | (cp >> 12));
+    out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+    out += static_cast<char>(0x80 | (cp & 0x3F));
+  } else {
+    out += static_cast<char>(0xF0 | (cp >> 18));
+    out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+    out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+    out += static_cast<char>(0x80 | (cp & 0x3F));
+  }
+  return true;
+}
+
+bool Reader::ReadUint(uint64_t& value, string& digits) {
+  SkipSpace();
+  const char* start = m_pos;
+  value = 0;
+  while (m_pos != m_end && *m_pos >= '0' && *m_pos <= '9') {
+    const uint64_t digit = *m_pos - '0';
+    if (value > (numeric_limits<uint64_t>::max() - digit) / 10) {
+      return false;
+    }
+    value = value * 10 + digit;
+    ++m_pos;
+  }
+
+  // Leading zeros, fractions and exponents are rare enough to leave alone
+  if (m_pos == start || (*start == '0' && m_pos - start > 1)) {
+    return false;
+  }
+  if (m_pos != m_end && (*m_pos == '.' || *m_pos == 'e' || *m_pos == 'E')) {
+    return false;
+  }
+  digits.assign(start, m_pos);
+  return true;
+}
+
+/// Reads a string, or an unsigned integer as its digits
+bool ReadStringOrUint(Reader& reader, string& out) {
+  uint64_t value;
+  return reader.Peek('"') ? reader.ReadString(out)
+                          : reader.ReadUint(value, out);
+}
+
+/// Members of a txn object, in the order of the bits that track them
+const char* const TXN_MEMBERS[] = {"version",  "nonce",    "toAddr",
+                                   "amount",   "gasPrice", "gasLimit",
+                                   "pubKey",   "signature", "code",
+                                   "data"};
+const unsigned int TXN_MEMBER_COUNT =
+    sizeof(TXN_MEMBERS) / sizeof(TXN_MEMBERS[0]);
+
+bool ReadTxn(Reader& reader, JSONTxnFields& txn) {
+  if (!reader.Consume('{')) {
+    return false;
+  }
+
+  unsigned int seen = 0;
+  string key, digits;
+  do {
+    if (!reader.ReadString(key) || !reader.Consume(':')) {
+      return false;
+    }
+    unsigned int member = 0;
+    while (member < TXN_MEMBER_COUNT && key != TXN_MEMBERS[member]) {
+      member++;
+    }
+    if (member == TXN_MEMBER_COUNT || (seen & (1u << member))) {
+      return false;
+    }
+    seen |= 1u << member;
+
+    bool ok = false;
+    uint64_t value;
+    switch (member) {
+      case 0:
+        ok = reader.ReadUint(value, digits) &&
+             value <= numeric_limits<uint32_t>::max();
+        txn.m_version = static_cast<uint32_t>(value);
+        break;
+      case 1:
+        ok = reader.ReadUint(value, txn.m_nonce);
+        break;
+      case 2:
+        ok = reader.ReadString(txn.m_toAddr);
+        break;
+      case 3:
+        ok = reader.ReadString(txn.m_amount);
+        break;
+      case 4:
+        ok = ReadStringOrUint(reader, txn.m_gasPrice);
+        break;
+      case 5:
+        ok = ReadStringOrUint(reader, txn.m_gasLimit);
+        break;
+      case 6:
+        ok = reader.ReadString(txn.m_pubKey);
+        break;
+      case 7:
+        ok = reader.ReadString(txn.m_signature);
+        break;
+      case 8:
+        ok = reader.ReadString(txn.m_code);
+        break;
+      case 9:
+        ok = reader.ReadString(txn.m_data);
+        break;
+    }
+    if (!ok) {
+      return false;
+    }
+  } while (reader.Consume(','));
+
+  return reader.Consume('}') && seen == (1u << TXN_MEMBER_COUNT) - 1;
+}
+
+/// Reads [txn] or [[txn, ...]], setting batch for the second
+bool ReadParams(Reader& reader, bool& batch, vector<JSONTxnFields>& txns) {
+  if (!reader.Consume('[')) {
+    return false;
+  }
+  batch = reader.Consume('[');
+  if (!batch || !reader.Peek(']')) {
+    do {
+      txns.emplace_back();
+      if (!ReadTxn(reader, txns.back())) {
+        return false;
+      }
+    } while (batch && reader.Consume(','));
+  }
+  return (!batch || reader.Consume(']')) && reader.Consume(']');
+}
+
+/// Reads an id that is a string or an unsigned integer
+bool ReadId(Reader& reader, Json::Value& id) {
+  if (reader.Peek('"')) {
+    string str;
+    if (!reader.ReadString(str)) {
+      return false;
+    }
+    id = str;
+    return true;
+  }
+  uint64_t value;
+  string digits;
+  if (!reader.ReadUint(value, digits) ||
+      value > static_cast<uint64_t>(numeric_limits<Json::Int64>::max())) {
+    return false;
+  }
+  id = Json::Int64(value);
+  return true;
+}
+
+}  // namespace
+
+bool JSONTxnParser::Parse(const string& request, Call& call) {
+  Reader reader(request.data(), request.data() + request.size());
+  call.m_method.clear();
+  call.m_txns.clear();
+
+  bool hasId = false, hasVersion = false, hasParams = false, batch = false;
+  string key, version;
+  if (!reader.Consume('{')) {
+    return false;
+  }
+  do {
+    if (!reader.ReadString(key) || !reader.Consume(':')) {
+      return false;
+    }
+    bool ok = false;
+    if (key == "id" && !hasId) {
+      ok = hasId = ReadId(reader, call.m_id);
+    } else if (key == "jsonrpc" && !hasVersion) {
+      ok = hasVersion = reader.ReadString(version) && version == "2.0";
+    } else if (key == "method" && call.m_method.empty()) {
+      ok = reader.ReadString(call.m_method) && !call.m_method.empty();
+    } else if (key == "params" && !hasParams) {
+      ok = hasParams = ReadParams(reader, batch, call.m_txns);
+    }
+    if (!ok) {
+      return false;
+    }
+  } while (reader.Consume(','));
+
+  if (!reader.Consume('}') || !reader.AtEnd() || !hasId || !hasVersion ||
+      !hasParams) {
+    return false;
+  }
+  return call.m_method ==
+         (batch ? "CreateTransactionBatch" : "CreateTransaction");
+}
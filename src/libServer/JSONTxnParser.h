@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __JSONTXNPARSER_H__
+#define __JSONTXNPARSER_H__
+
+#include <json/json.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/// Members of a txn object, as the RPC handler would read them with
+/// asUInt() and asString()
+struct JSONTxnFields {
+  uint32_t m_version = 0;
+  std::string m_nonce;
+  std::string m_toAddr;
+  std::string m_amount;
+  std::string m_gasPrice;
+  std::string m_gasLimit;
+  std::string m_pubKey;
+  std::string m_signature;
+  std::string m_code;
+  std::string m_data;
+};
+
+/// Reads a CreateTransaction or CreateTransactionBatch call in one pass,
+/// straight into the txn fields, without building a Json::Value tree.
+///
+/// Only the well-formed shape clients send is accepted: a single call,
+/// txn objects with exactly the expected members, integers where checkJsonTx
+/// wants them. Anything else makes Parse return false, so the request can
+/// go through jsoncpp and get the usual error reply.
+class JSONTxnParser {
+ public:
+  struct Call {
+    Json::Value m_id;
+    std::string m_method;
+    /// One entry for CreateTransaction, the batch for CreateTransactionBatch
+    std::vector<JSONTxnFields> m_txns;
+  };
+
+  static bool Parse(const std::string& request, Call& call);
+};
+
+#endif  // __JSONTXNPARSER_H__
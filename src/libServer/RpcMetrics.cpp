@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <sstream>
+
+#include "RpcMetrics.h"
+
+using namespace std;
+
+RpcMetrics& RpcMetrics::GetInstance() {
+  static RpcMetrics metrics;
+  return metrics;
+}
+
+void RpcMetrics::Record(const string& method, uint64_t durationInMicroseconds,
+                        bool failed) {
+  unsigned int bucket = 0;
+  for (uint64_t units = durationInMicroseconds /
+                        RpcMethodStats::FIRST_BUCKET_IN_MICROSECONDS;
+       units > 0 && bucket < RpcMethodStats::NUM_BUCKETS - 1; units >>= 1) {
+    bucket++;
+  }
+
+  lock_guard<mutex> g(m_mutex);
+
+  auto it = m_stats.find(method);
+  if (it == m_stats.end()) {
+    RpcMethodStats stats{method, 0, 0, 0, 0, {}};
+    it = m_stats.emplace(method, stats).first;
+  }
+
+  RpcMethodStats& stats = it->second;
+  stats.m_count++;
+  if (failed) {
+    stats.m_errorCount++;
+  }
+  stats.m_totalInMicroseconds += durationInMicroseconds;
+  stats.m_maxInMicroseconds =
+      max(stats.m_maxInMicroseconds, durationInMicroseconds);
+  stats.m_buckets.at(bucket)++;
+}
+
+vector<RpcMethodStats> RpcMetrics::GetStats() {
+  lock_guard<mutex> g(m_mutex);
+
+  vector<RpcMethodStats> result;
+  result.reserve(m_stats.size());
+  for (const auto& entry : m_stats) {
+    result.emplace_back(entry.second);
+  }
+  return result;
+}
+
+string RpcMetrics::GetPrometheusText() {
+  const vector<RpcMethodStats> stats = GetStats();
+
+  ostringstream text;
+
+  text << "# HELP zilliqa_rpc_calls_total JSON-RPC calls by method.\n"
+       << "# TYPE zilliqa_rpc_calls_total counter\n";
+  for (const auto& s : stats) {
+    text << "zilliqa_rpc_calls_total{method=\"" << s.m_method << "\"} "
+         << s.m_count << "\n";
+  }
+
+  text << "# HELP zilliqa_rpc_errors_total JSON-RPC calls that returned an "
+          "error, by method.\n"
+       << "# TYPE zilliqa_rpc_errors_total counter\n";
+  for (const auto& s : stats) {
+    text << "zilliqa_rpc_errors_total{method=\"" << s.m_method << "\"} "
+         << s.m_errorCount << "\n";
+  }
+
+  text << "# HELP zilliqa_rpc_duration_seconds JSON-RPC call latency by "
+          "method.\n"
+       << "# TYPE zilliqa_rpc_duration_seconds histogram\n";
+  for (const auto& s : stats) {
+    const string label = "method=\"" + s.m_method + "\"";
+    uint64_t cumulative = 0;
+    for (unsigned int i = 0; i < RpcMethodStats::NUM_BUCKETS - 1; i++) {
+      cumulative += s.m_buckets[i];
+      text << "zilliqa_rpc_duration_seconds_bucket{" << label << ",le=\""
+           << (RpcMethodStats::FIRST_BUCKET_IN_MICROSECONDS << i) / 1e6
+           << "\"} " << cumulative << "\n";
+    }
+    text << "zilliqa_rpc_duration_seconds_bucket{" << label
+         << ",le=\"+Inf\"} " << s.m_count << "\n"
+         << "zilliqa_rpc_duration_seconds_sum{" << label << "} "
+         << s.m_totalInMicroseconds / 1e6 << "\n"
+         << "zilliqa_rpc_duration_seconds_count{" << label << "} "
+         << s.m_count << "\n";
+  }
+
+  return text.str();
+}
@@ -0,0 +1,69 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __RPCMETRICS_H__
+#define __RPCMETRICS_H__
+
+#include <array>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+struct RpcMethodStats {
+  /// Bucket i counts durations below 2^i * 100 us; the last bucket is
+  /// unbounded
+  static const unsigned int NUM_BUCKETS = 20;
+  static const uint64_t FIRST_BUCKET_IN_MICROSECONDS = 100;
+
+  std::string m_method;
+  uint64_t m_count;
+  uint64_t m_errorCount;
+  uint64_t m_totalInMicroseconds;
+  uint64_t m_maxInMicroseconds;
+  std::array<uint64_t, NUM_BUCKETS> m_buckets;
+};
+
+/// Call counts, error counts and latency histograms of the JSON-RPC
+/// methods served by this node, since it started.
+class RpcMetrics {
+  std::mutex m_mutex;
+  std::map<std::string, RpcMethodStats> m_stats;
+
+  RpcMetrics() = default;
+  ~RpcMetrics() = default;
+
+  RpcMetrics(RpcMetrics const&) = delete;
+  void operator=(RpcMetrics const&) = delete;
+
+ public:
+  /// Returns the singleton instance.
+  static RpcMetrics& GetInstance();
+
+  /// Adds one call of the method, which failed if it threw
+  void Record(const std::string& method, uint64_t durationInMicroseconds,
+              bool failed);
+
+  /// Returns the stats of every method called at least once
+  std::vector<RpcMethodStats> GetStats();
+
+  /// Returns the stats in the Prometheus text exposition format
+  std::string GetPrometheusText();
+};
+
+#endif  // __RPCMETRICS_H__
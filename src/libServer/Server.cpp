@@ -16,6 +16,7 @@
  */
 
 #include "JSONConversion.h"
+#include "RpcMetrics.h"
 
 #include <jsonrpccpp/server.h>
 #include <boost/multiprecision/cpp_dec_float.hpp>
@@ -24,10 +25,12 @@
 #include <boost/multiprecision/cpp_int.hpp>
 #pragma GCC diagnostic pop
 #include <iostream>
+#include <unistd.h>
 
 #include "Server.h"
 #include "common/Messages.h"
 #include "common/Serializable.h"
+#include "libConsensus/ConsensusTrace.h"
 #include "libCrypto/Schnorr.h"
 #include "libCrypto/Sha2.h"
 #include "libData/AccountData/Account.h"
@@ -38,8 +41,13 @@
 #include "libNetwork/Peer.h"
 #include "libPersistence/BlockStorage.h"
 #include "libUtils/DetachedFunction.h"
+#include "libUtils/EpochMetrics.h"
 #include "libUtils/Logger.h"
+#include "libUtils/LockProfiler.h"
+#include "libUtils/MemoryStats.h"
+#include "libUtils/SamplingProfiler.h"
 #include "libUtils/TimeUtils.h"
+#include "libUtils/Tracer.h"
 
 using namespace jsonrpc;
 using namespace std;
@@ -48,23 +56,11 @@ CircularArray<std::string> Server::m_RecentTransactions;
 std::mutex Server::m_mutexRecentTxns;
 
 const unsigned int PAGE_SIZE = 10;
-const unsigned int NUM_PAGES_CACHE = 2;
 const unsigned int TXN_PAGE_SIZE = 100;
 
-//[warning] do not make this constant too big as it loops over blockchain
-const unsigned int REF_BLOCK_DIFF = 1;
-
-Server::Server(Mediator& mediator, HttpServer& httpserver)
-    : AbstractZServer(httpserver), m_mediator(mediator) {
-  m_StartTimeTx = 0;
-  m_StartTimeDs = 0;
-  m_DSBlockCache.first = 0;
-  m_DSBlockCache.second.resize(NUM_PAGES_CACHE * PAGE_SIZE);
-  m_TxBlockCache.first = 0;
-  m_TxBlockCache.second.resize(NUM_PAGES_CACHE * PAGE_SIZE);
+Server::Server(Mediator& mediator, AbstractServerConnector& server)
+    : AbstractZServer(server), m_mediator(mediator) {
   m_RecentTransactions.resize(TXN_PAGE_SIZE);
-  m_TxBlockCountSumPair.first = 0;
-  m_TxBlockCountSumPair.second = 0;
 }
 
 Server::~Server() {
@@ -106,157 +102,139 @@ bool Server::StartCollectorThread() {
         }
       }
       LOG_GENERAL(INFO, "Size of txns " << txns.size());
-      {
-        lock_guard<mutex> g(m_mediator.m_lookup->m_txnShardMapMutex);
-        if (m_mediator.m_lookup->m_txnShardMap.find(0) ==
-                m_mediator.m_lookup->m_txnShardMap.end() ||
-            m_mediator.m_lookup->m_txnShardMap.at(0).empty()) {
-          continue;
-        }
-        bytes msg = {MessageType::LOOKUP, LookupInstructionType::FORWARDTXN};
-
-        auto upperLayerNodes = m_mediator.m_lookup->GetAboveLayer();
-        auto upperLayerNode =
-            upperLayerNodes.at(rand() % upperLayerNodes.size());
+      vector<Transaction> txnsToForward;
+      m_mediator.m_lookup->TakeTxnsFromShardMap(0, 0, txnsToForward);
+      if (txnsToForward.empty()) {
+        continue;
+      }
 
-        if (!Messenger::SetTransactionArray(
-                msg, MessageOffset::BODY,
-                m_mediator.m_lookup->m_txnShardMap.at(0))) {
-          continue;
-        }
+      bytes msg = {MessageType::LOOKUP, LookupInstructionType::FORWARDTXN};
 
-        LOG_GENERAL(INFO, "Sent to " << upperLayerNode);
+      auto upperLayerNodes = m_mediator.m_lookup->GetAboveLayer();
+      auto upperLayerNode = upperLayerNodes.at(rand() % upperLayerNodes.size());
 
-        P2PComm::GetInstance().SendMessage(upperLayerNode, msg);
+      if (!Messenger::SetTransactionArray(msg, MessageOffset::BODY,
+                                          txnsToForward)) {
+        continue;
       }
-      m_mediator.m_lookup->DeleteTxnShardMap(0);
+
+      LOG_GENERAL(INFO, "Sent to " << upperLayerNode);
+
+      P2PComm::GetInstance().SendMessage(upperLayerNode, msg);
     }
   };
   DetachedFunction(1, collectorThread);
   return true;
 }
 
-Json::Value Server::CreateTransaction(const Json::Value& _json) {
-  LOG_MARKER();
-
-  try {
-    if (!JSONConversion::checkJsonTx(_json)) {
-      throw JsonRpcException(RPC_PARSE_ERROR, "Invalid Transaction JSON");
-    }
+Json::Value Server::CheckTransaction(const Transaction& tx, bool verified,
+                                     unsigned int& shard) {
+  if (DataConversion::UnpackA(tx.GetVersion()) != CHAIN_ID) {
+    throw JsonRpcException(RPC_VERIFY_REJECTED, "CHAIN_ID incorrect");
+  }
 
-    Transaction tx = JSONConversion::convertJsontoTx(_json);
+  if (tx.GetGasPrice() <
+      m_mediator.m_dsBlockChain.GetLastBlockPtr()->GetHeader().GetGasPrice()) {
+    throw JsonRpcException(RPC_VERIFY_REJECTED,
+                           "GasPrice " +
+                               tx.GetGasPrice().convert_to<string>() +
+                               " lower than minimum allowable " +
+                               m_mediator.m_dsBlockChain.GetLastBlockPtr()
+                                   ->GetHeader()
+                                   .GetGasPrice()
+                                   .convert_to<string>());
+  }
 
-    if (DataConversion::UnpackA(tx.GetVersion()) != CHAIN_ID) {
-      throw JsonRpcException(RPC_VERIFY_REJECTED, "CHAIN_ID incorrect");
-    }
+  if (!verified) {
+    throw JsonRpcException(RPC_VERIFY_REJECTED,
+                           "Unable to verify transaction");
+  }
 
-    if (tx.GetGasPrice() <
-        m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetGasPrice()) {
-      throw JsonRpcException(RPC_VERIFY_REJECTED,
-                             "GasPrice " +
-                                 tx.GetGasPrice().convert_to<string>() +
-                                 " lower than minimum allowable " +
-                                 m_mediator.m_dsBlockChain.GetLastBlock()
-                                     .GetHeader()
-                                     .GetGasPrice()
-                                     .convert_to<string>());
-    }
+  // LOG_GENERAL(INFO, "Nonce: "<<tx.GetNonce().str()<<" toAddr:
+  // "<<tx.GetToAddr().hex()<<" senderPubKey:
+  // "<<static_cast<string>(tx.GetSenderPubKey());<<" amount:
+  // "<<tx.GetAmount().str());
 
-    if (!m_mediator.m_validator->VerifyTransaction(tx)) {
-      throw JsonRpcException(RPC_VERIFY_REJECTED,
-                             "Unable to verify transaction");
-    }
+  unsigned int num_shards = m_mediator.m_lookup->GetShardPeers()->size();
 
-    // LOG_GENERAL(INFO, "Nonce: "<<tx.GetNonce().str()<<" toAddr:
-    // "<<tx.GetToAddr().hex()<<" senderPubKey:
-    // "<<static_cast<string>(tx.GetSenderPubKey());<<" amount:
-    // "<<tx.GetAmount().str());
+  const Address& fromAddr = tx.GetSenderAddr();
+  const auto sender = AccountStore::GetInstance().GetCommittedAccount(fromAddr);
 
-    unsigned int num_shards = m_mediator.m_lookup->GetShardPeers().size();
+  if (fromAddr == Address()) {
+    throw JsonRpcException(RPC_INVALID_ADDRESS_OR_KEY,
+                           "Invalid address for issuing transactions");
+  }
 
-    const PubKey& senderPubKey = tx.GetSenderPubKey();
-    const Address fromAddr = Account::GetAddressFromPublicKey(senderPubKey);
-    const Account* sender = AccountStore::GetInstance().GetAccount(fromAddr);
+  if (sender == nullptr) {
+    throw JsonRpcException(RPC_INVALID_ADDRESS_OR_KEY,
+                           "The sender of the txn has no balance");
+  }
 
-    if (fromAddr == Address()) {
-      throw JsonRpcException(RPC_INVALID_ADDRESS_OR_KEY,
-                             "Invalid address for issuing transactions");
-    }
+  Json::Value ret;
+
+  if (num_shards > 0) {
+    unsigned int from_shard = Transaction::GetShardIndex(fromAddr, num_shards);
+    shard = from_shard;
+    if (tx.GetData().empty() || tx.GetToAddr() == NullAddress) {
+      if (tx.GetData().empty() && tx.GetCode().empty() &&
+          tx.GetToAddr() != NullAddress) {
+        ret["Info"] = "Non-contract txn, sent to shard";
+        ret["TranID"] = tx.GetTranID().hex();
+      } else if (!tx.GetCode().empty() && tx.GetToAddr() == NullAddress) {
+        ret["Info"] = "Contract Creation txn, sent to shard";
+        ret["TranID"] = tx.GetTranID().hex();
+        ret["ContractAddress"] =
+            Account::GetAddressForContract(fromAddr, sender->GetNonce()).hex();
+      } else {
+        throw JsonRpcException(RPC_INVALID_ADDRESS_OR_KEY,
+                               "Code is empty and To addr is null");
+      }
+    } else {
+      const auto account =
+          AccountStore::GetInstance().GetCommittedAccount(tx.GetToAddr());
 
-    if (sender == nullptr) {
-      throw JsonRpcException(RPC_INVALID_ADDRESS_OR_KEY,
-                             "The sender of the txn has no balance");
-    }
+      if (account == nullptr) {
+        throw JsonRpcException(RPC_INVALID_ADDRESS_OR_KEY, "To addr is null");
+      }
 
-    Json::Value ret;
+      else if (!account->isContract()) {
+        throw JsonRpcException(RPC_INVALID_ADDRESS_OR_KEY,
+                               "Non - contract address called");
+      }
 
-    if (num_shards > 0) {
-      unsigned int shard = Transaction::GetShardIndex(fromAddr, num_shards);
-      if (tx.GetData().empty() || tx.GetToAddr() == NullAddress) {
-        if (tx.GetData().empty() && tx.GetCode().empty() &&
-            tx.GetToAddr() != NullAddress) {
-          if (!ARCHIVAL_LOOKUP) {
-            m_mediator.m_lookup->AddToTxnShardMap(tx, shard);
-          } else {
-            m_mediator.m_lookup->AddToTxnShardMap(tx, 0);
-          }
-          ret["Info"] = "Non-contract txn, sent to shard";
-          ret["TranID"] = tx.GetTranID().hex();
-        } else if (!tx.GetCode().empty() && tx.GetToAddr() == NullAddress) {
-          if (!ARCHIVAL_LOOKUP) {
-            m_mediator.m_lookup->AddToTxnShardMap(tx, shard);
-          } else {
-            m_mediator.m_lookup->AddToTxnShardMap(tx, 0);
-          }
-          ret["Info"] = "Contract Creation txn, sent to shard";
-          ret["TranID"] = tx.GetTranID().hex();
-          ret["ContractAddress"] =
-              Account::GetAddressForContract(fromAddr, sender->GetNonce())
-                  .hex();
-        } else {
-          throw JsonRpcException(RPC_INVALID_ADDRESS_OR_KEY,
-                                 "Code is empty and To addr is null");
-        }
+      unsigned int to_shard =
+          Transaction::GetShardIndex(tx.GetToAddr(), num_shards);
+      if (to_shard == from_shard) {
+        ret["Info"] =
+            "Contract Txn, Shards Match of the sender "
+            "and reciever";
+        ret["TranID"] = tx.GetTranID().hex();
       } else {
-        const Account* account =
-            AccountStore::GetInstance().GetAccount(tx.GetToAddr());
+        shard = num_shards;
+        ret["Info"] = "Contract Txn, Sent To Ds";
+        ret["TranID"] = tx.GetTranID().hex();
+      }
+    }
+  } else {
+    LOG_GENERAL(INFO, "No shards yet");
+    throw JsonRpcException(RPC_IN_WARMUP, "Could not create Transaction");
+  }
 
-        if (account == nullptr) {
-          throw JsonRpcException(RPC_INVALID_ADDRESS_OR_KEY, "To addr is null");
-        }
+  if (ARCHIVAL_LOOKUP) {
+    shard = 0;
+  }
+  return ret;
+}
 
-        else if (!account->isContract()) {
-          throw JsonRpcException(RPC_INVALID_ADDRESS_OR_KEY,
-                                 "Non - contract address called");
-        }
+Json::Value Server::CreateTransaction(const Json::Value& _json) {
+  LOG_MARKER();
 
-        unsigned int to_shard =
-            Transaction::GetShardIndex(tx.GetToAddr(), num_shards);
-        if (to_shard == shard) {
-          if (!ARCHIVAL_LOOKUP) {
-            m_mediator.m_lookup->AddToTxnShardMap(tx, shard);
-          } else {
-            m_mediator.m_lookup->AddToTxnShardMap(tx, 0);
-          }
-          ret["Info"] =
-              "Contract Txn, Shards Match of the sender "
-              "and reciever";
-          ret["TranID"] = tx.GetTranID().hex();
-        } else {
-          if (!ARCHIVAL_LOOKUP) {
-            m_mediator.m_lookup->AddToTxnShardMap(tx, num_shards);
-          } else {
-            m_mediator.m_lookup->AddToTxnShardMap(tx, 0);
-          }
-          ret["Info"] = "Contract Txn, Sent To Ds";
-          ret["TranID"] = tx.GetTranID().hex();
-        }
-      }
-    } else {
-      LOG_GENERAL(INFO, "No shards yet");
-      throw JsonRpcException(RPC_IN_WARMUP, "Could not create Transaction");
+  try {
+    if (!JSONConversion::checkJsonTx(_json)) {
+      throw JsonRpcException(RPC_PARSE_ERROR, "Invalid Transaction JSON");
     }
-    return ret;
+
+    return SubmitTransaction(JSONConversion::convertJsontoTx(_json));
   } catch (const JsonRpcException& je) {
     throw je;
   } catch (exception& e) {
@@ -266,6 +244,102 @@ Json::Value Server::CreateTransaction(const Json::Value& _json) {
   }
 }
 
+Json::Value Server::SubmitTransaction(const Transaction& tx) {
+  if (READ_REPLICA_MODE) {
+    throw JsonRpcException(RPC_MISC_ERROR, "Read replicas do not accept txns");
+  }
+  if (m_mediator.m_lookup->IsTxnRecentlyCommitted(tx.GetTranID())) {
+    throw JsonRpcException(RPC_VERIFY_REJECTED, "Txn already committed");
+  }
+
+  unsigned int shard = 0;
+  Json::Value ret = CheckTransaction(
+      tx, m_mediator.m_validator->VerifyTransaction(tx), shard);
+  m_mediator.m_lookup->AddToTxnShardMap(tx, shard);
+  return ret;
+}
+
+Json::Value Server::CreateTransactionBatch(const Json::Value& _json) {
+  LOG_MARKER();
+
+  if (!_json.isArray() || _json.empty()) {
+    throw JsonRpcException(RPC_INVALID_PARAMS, "Expected an array of txns");
+  }
+  return SubmitTransactionBatch(
+      _json.size(), [&_json](unsigned int i) -> Transaction {
+        if (!JSONConversion::checkJsonTx(_json[i])) {
+          throw JsonRpcException(RPC_PARSE_ERROR, "Invalid Transaction JSON");
+        }
+        return JSONConversion::convertJsontoTx(_json[i]);
+      });
+}
+
+Json::Value Server::SubmitTransactionBatch(
+    unsigned int count, const function<Transaction(unsigned int)>& convert) {
+  if (READ_REPLICA_MODE) {
+    throw JsonRpcException(RPC_MISC_ERROR, "Read replicas do not accept txns");
+  }
+  if (count == 0) {
+    throw JsonRpcException(RPC_INVALID_PARAMS, "Expected an array of txns");
+  }
+  if (count > CREATE_TXN_BATCH_MAX_SIZE) {
+    throw JsonRpcException(RPC_INVALID_PARAMS,
+                           "At most " + to_string(CREATE_TXN_BATCH_MAX_SIZE) +
+                               " txns per batch");
+  }
+
+  Json::Value ret = Json::arrayValue;
+
+  // Txns that parse are verified together, then checked one by one
+  vector<Transaction> txns;
+  vector<unsigned int> txnIndex;
+  for (unsigned int i = 0; i < count; i++) {
+    try {
+      Transaction tx = convert(i);
+      if (m_mediator.m_lookup->IsTxnRecentlyCommitted(tx.GetTranID())) {
+        throw JsonRpcException(RPC_VERIFY_REJECTED, "Txn already committed");
+      }
+      txns.emplace_back(move(tx));
+      txnIndex.emplace_back(i);
+      ret[i] = Json::nullValue;
+    } catch (const JsonRpcException& je) {
+      ret[i]["Error"]["code"] = je.GetCode();
+      ret[i]["Error"]["message"] = je.GetMessage();
+    } catch (exception& e) {
+      LOG_GENERAL(INFO, "[Error]" << e.what());
+      ret[i]["Error"]["code"] = RPC_MISC_ERROR;
+      ret[i]["Error"]["message"] = "Unable to Process";
+    }
+  }
+
+  vector<bool> verified;
+  m_mediator.m_validator->VerifyTransactions(txns, verified);
+
+  vector<pair<Transaction, uint32_t>> accepted;
+  accepted.reserve(txns.size());
+  for (unsigned int i = 0; i < txns.size(); i++) {
+    Json::Value& result = ret[txnIndex.at(i)];
+    try {
+      unsigned int shard = 0;
+      result = CheckTransaction(txns.at(i), verified.at(i), shard);
+      accepted.emplace_back(txns.at(i), shard);
+    } catch (const JsonRpcException& je) {
+      result["Error"]["code"] = je.GetCode();
+      result["Error"]["message"] = je.GetMessage();
+    } catch (exception& e) {
+      LOG_GENERAL(INFO, "[Error]" << e.what());
+      result["Error"]["code"] = RPC_MISC_ERROR;
+      result["Error"]["message"] = "Unable to Process";
+    }
+  }
+
+  m_mediator.m_lookup->AddToTxnShardMap(accepted);
+
+  LOG_GENERAL(INFO, "Accepted " << accepted.size() << " of " << count
+                                << " txns in batch");
+  return ret;
+}
+
 Json::Value Server::GetTransaction(const string& transactionHash) {
   LOG_MARKER();
 
@@ -275,20 +349,14 @@ Json::Value Server::GetTransaction(const string& transactionHash) {
     if (transactionHash.size() != TRAN_HASH_SIZE * 2) {
       throw JsonRpcException(RPC_INVALID_PARAMS, "Size not appropriate");
     }
-    bool isPresent = BlockStorage::GetBlockStorage().GetTxBody(tranHash, tptr);
-    if (!isPresent) {
-      if (m_mediator.m_lookup->m_historicalDB) {
-        bool isPresentHistorical =
-            BlockStorage::GetBlockStorage().GetTxnFromHistoricalDB(tranHash,
-                                                                   tptr);
-        if (isPresentHistorical) {
-          return JSONConversion::convertTxtoJson(*tptr);
-        }
-        throw JsonRpcException(RPC_DATABASE_ERROR, "Txn Hash not Present");
-      }
-      throw JsonRpcException(RPC_DATABASE_ERROR, "Txn Hash not Present");
+    Json::Value _json;
+    if (GetResponseCache().Get("GetTransaction", tranHash.hex(), _json)) {
+      return _json;
     }
-    return JSONConversion::convertTxtoJson(*tptr);
+    tptr = FetchTransaction(tranHash);
+    _json = JSONConversion::convertTxtoJson(*tptr);
+    GetResponseCache().Put("GetTransaction", tranHash.hex(), _json);
+    return _json;
   } catch (const JsonRpcException& je) {
     throw je;
   } catch (exception& e) {
@@ -298,11 +366,32 @@ Json::Value Server::GetTransaction(const string& transactionHash) {
   }
 }
 
+TxBodySharedPtr Server::FetchTransaction(const TxnHash& tranHash) {
+  TxBodySharedPtr tptr;
+  if (BlockStorage::GetBlockStorage().GetTxBody(tranHash, tptr)) {
+    return tptr;
+  }
+  if (m_mediator.m_lookup->m_historicalDB &&
+      BlockStorage::GetBlockStorage().GetTxnFromHistoricalDB(tranHash, tptr)) {
+    return tptr;
+  }
+  throw JsonRpcException(RPC_DATABASE_ERROR, "Txn Hash not Present");
+}
+
 Json::Value Server::GetDsBlock(const string& blockNum) {
   try {
     uint64_t BlockNum = stoull(blockNum);
-    return JSONConversion::convertDSblocktoJson(
-        m_mediator.m_dsBlockChain.GetBlock(BlockNum));
+    Json::Value _json;
+    if (GetResponseCache().Get("GetDsBlock", to_string(BlockNum), _json)) {
+      return _json;
+    }
+    const auto dsblock = m_mediator.m_dsBlockChain.GetBlockPtr(BlockNum);
+    _json = JSONConversion::convertDSblocktoJson(*dsblock);
+    // Dummy blocks returned for unknown numbers are not cached
+    if (dsblock->GetHeader().GetBlockNum() == BlockNum) {
+      GetResponseCache().Put("GetDsBlock", to_string(BlockNum), _json);
+    }
+    return _json;
   } catch (const JsonRpcException& je) {
     throw je;
   } catch (runtime_error& e) {
@@ -323,8 +412,17 @@ Json::Value Server::GetDsBlock(const string& blockNum) {
 Json::Value Server::GetTxBlock(const string& blockNum) {
   try {
     uint64_t BlockNum = stoull(blockNum);
-    return JSONConversion::convertTxBlocktoJson(
-        m_mediator.m_txBlockChain.GetBlock(BlockNum));
+    Json::Value _json;
+    if (GetResponseCache().Get("GetTxBlock", to_string(BlockNum), _json)) {
+      return _json;
+    }
+    const auto txblock = m_mediator.m_txBlockChain.GetBlockPtr(BlockNum);
+    _json = JSONConversion::convertTxBlocktoJson(*txblock);
+    // Dummy blocks returned for unknown numbers are not cached
+    if (txblock->GetHeader().GetBlockNum() == BlockNum) {
+      GetResponseCache().Put("GetTxBlock", to_string(BlockNum), _json);
+    }
+    return _json;
   } catch (const JsonRpcException& je) {
     throw je;
   } catch (runtime_error& e) {
@@ -343,32 +441,44 @@ Json::Value Server::GetTxBlock(const string& blockNum) {
 }
 
 string Server::GetMinimumGasPrice() {
-  return m_mediator.m_dsBlockChain.GetLastBlock()
-      .GetHeader()
+  return m_mediator.m_dsBlockChain.GetLastBlockPtr()
+      ->GetHeader()
       .GetGasPrice()
       .str();
 }
 
 Json::Value Server::GetLatestDsBlock() {
   LOG_MARKER();
-  DSBlock Latest = m_mediator.m_dsBlockChain.GetLastBlock();
+  const auto Latest = m_mediator.m_dsBlockChain.GetLastBlockPtr();
 
   LOG_EPOCH(INFO, m_mediator.m_currentEpochNum,
-            "BlockNum " << Latest.GetHeader().GetBlockNum()
-                        << "  Timestamp:        " << Latest.GetTimestamp());
+            "BlockNum " << Latest->GetHeader().GetBlockNum()
+                        << "  Timestamp:        " << Latest->GetTimestamp());
 
-  return JSONConversion::convertDSblocktoJson(Latest);
+  Json::Value _json;
+  const string num = to_string(Latest->GetHeader().GetBlockNum());
+  if (!GetResponseCache().Get("GetDsBlock", num, _json)) {
+    _json = JSONConversion::convertDSblocktoJson(*Latest);
+    GetResponseCache().Put("GetDsBlock", num, _json);
+  }
+  return _json;
 }
 
 Json::Value Server::GetLatestTxBlock() {
   LOG_MARKER();
-  TxBlock Latest = m_mediator.m_txBlockChain.GetLastBlock();
+  const auto Latest = m_mediator.m_txBlockChain.GetLastBlockPtr();
 
   LOG_EPOCH(INFO, m_mediator.m_currentEpochNum,
-            "BlockNum " << Latest.GetHeader().GetBlockNum()
-                        << "  Timestamp:        " << Latest.GetTimestamp());
+            "BlockNum " << Latest->GetHeader().GetBlockNum()
+                        << "  Timestamp:        " << Latest->GetTimestamp());
 
-  return JSONConversion::convertTxBlocktoJson(Latest);
+  Json::Value _json;
+  const string num = to_string(Latest->GetHeader().GetBlockNum());
+  if (!GetResponseCache().Get("GetTxBlock", num, _json)) {
+    _json = JSONConversion::convertTxBlocktoJson(*Latest);
+    GetResponseCache().Put("GetTxBlock", num, _json);
+  }
+  return _json;
 }
 
 Json::Value Server::GetBalance(const string& address) {
@@ -385,7 +495,7 @@ Json::Value Server::GetBalance(const string& address) {
       throw JsonRpcException(RPC_INVALID_ADDRESS_OR_KEY, "invalid address");
     }
     Address addr(tmpaddr);
-    const Account* account = AccountStore::GetInstance().GetAccount(addr);
+    const auto account = AccountStore::GetInstance().GetCommittedAccount(addr);
 
     Json::Value ret;
     if (account != nullptr) {
@@ -410,6 +520,58 @@ Json::Value Server::GetBalance(const string& address) {
   }
 }
 
+Json::Value Server::GetBalanceAt(const string& address,
+                                 const string& blockNum) {
+  LOG_MARKER();
+
+  if (!STATE_ARCHIVE_MODE) {
+    throw JsonRpcException(RPC_MISC_ERROR, "Past states are not kept");
+  }
+
+  try {
+    if (address.size() != ACC_ADDR_SIZE * 2) {
+      throw JsonRpcException(RPC_INVALID_PARAMETER,
+                             "Address size not appropriate");
+    }
+
+    bytes tmpaddr;
+    if (!DataConversion::HexStrToUint8Vec(address, tmpaddr)) {
+      throw JsonRpcException(RPC_INVALID_ADDRESS_OR_KEY, "invalid address");
+    }
+    Address addr(tmpaddr);
+    const uint64_t num = stoull(blockNum);
+
+    dev::h256 root;
+    if (!BlockStorage::GetBlockStorage().GetStateRoot(num, root)) {
+      throw JsonRpcException(RPC_INVALID_PARAMS,
+                             "State of this block is not kept");
+    }
+
+    Account account;
+    if (!AccountStore::GetInstance().GetAccountAt(num, addr, account)) {
+      throw JsonRpcException(RPC_INVALID_ADDRESS_OR_KEY,
+                             "Account is not created");
+    }
+
+    Json::Value ret;
+    ret["balance"] = account.GetBalance().str();
+    // FIXME: a workaround, 256-bit unsigned int being truncated
+    ret["nonce"] = static_cast<unsigned int>(account.GetNonce());
+    return ret;
+  } catch (const JsonRpcException& je) {
+    throw je;
+  } catch (invalid_argument& e) {
+    LOG_GENERAL(INFO, "[Error]" << e.what() << " Input: " << blockNum);
+    throw JsonRpcException(RPC_INVALID_PARAMS, "Invalid arugment");
+  } catch (out_of_range& e) {
+    LOG_GENERAL(INFO, "[Error]" << e.what() << " Input: " << blockNum);
+    throw JsonRpcException(RPC_INVALID_PARAMS, "Out of range");
+  } catch (exception& e) {
+    LOG_GENERAL(INFO, "[Error]" << e.what() << " Input: " << address);
+    throw JsonRpcException(RPC_MISC_ERROR, "Unable To Process");
+  }
+}
+
 Json::Value Server::GetSmartContractState(const string& address) {
   LOG_MARKER();
 
@@ -425,7 +587,7 @@ Json::Value Server::GetSmartContractState(const string& address) {
     }
 
     Address addr(tmpaddr);
-    const Account* account = AccountStore::GetInstance().GetAccount(addr);
+    const auto account = AccountStore::GetInstance().GetCommittedAccount(addr);
 
     if (account == nullptr) {
       throw JsonRpcException(RPC_INVALID_ADDRESS_OR_KEY,
@@ -441,6 +603,62 @@ Json::Value Server::GetSmartContractState(const string& address) {
   }
 }
 
+Json::Value Server::GetSmartContractSubState(const string& address,
+                                             const string& vname,
+                                             const string& keyPrefix,
+                                             const string& cursor) {
+  LOG_MARKER();
+
+  if (!HASHMAP_CONTRACT_STATE_DB) {
+    throw JsonRpcException(RPC_DATABASE_ERROR,
+                           "Contract state is not kept by field");
+  }
+
+  try {
+    if (address.size() != ACC_ADDR_SIZE * 2) {
+      throw JsonRpcException(RPC_INVALID_PARAMETER,
+                             "Address size not appropriate");
+    }
+    bytes tmpaddr;
+    if (!DataConversion::HexStrToUint8Vec(address, tmpaddr)) {
+      throw JsonRpcException(RPC_INVALID_ADDRESS_OR_KEY, "invalid address");
+    }
+
+    unsigned int pos = cursor.empty() ? 0 : stoul(cursor);
+
+    Address addr(tmpaddr);
+    const auto account = AccountStore::GetInstance().GetCommittedAccount(addr);
+
+    if (account == nullptr || !account->isContract()) {
+      throw JsonRpcException(RPC_INVALID_ADDRESS_OR_KEY,
+                             "Address is not a contract");
+    }
+
+    Json::Value _json;
+    auto& storage = Contract::ContractStorage::GetContractStorage();
+    if (vname.empty()) {
+      if (!storage.GetContractStateJsonPage(addr, pos,
+                                            CONTRACT_STATE_PAGE_SIZE,
+                                            _json["State"])) {
+        throw JsonRpcException(RPC_INVALID_PARAMETER, "invalid cursor");
+      }
+    } else if (!storage.GetContractStateMapEntries(addr, vname, keyPrefix, pos,
+                                                   CONTRACT_STATE_PAGE_SIZE,
+                                                   _json)) {
+      throw JsonRpcException(RPC_INVALID_PARAMETER,
+                             "No such field, or invalid cursor");
+    }
+    _json["NextCursor"] = (pos == 0) ? "" : to_string(pos);
+
+    return _json;
+  } catch (const JsonRpcException& je) {
+    throw je;
+  } catch (exception& e) {
+    LOG_GENERAL(INFO, "[Error]" << e.what() << " Input: " << address);
+    throw JsonRpcException(RPC_MISC_ERROR, "Unable To Process");
+  }
+}
+
 Json::Value Server::GetSmartContractInit(const string& address) {
   LOG_MARKER();
 
@@ -456,7 +674,7 @@ Json::Value Server::GetSmartContractInit(const string& address) {
       throw JsonRpcException(RPC_INVALID_ADDRESS_OR_KEY, "invalid address");
     }
     Address addr(tmpaddr);
-    const Account* account = AccountStore::GetInstance().GetAccount(addr);
+    const auto account = AccountStore::GetInstance().GetCommittedAccount(addr);
 
     if (account == nullptr) {
       throw JsonRpcException(RPC_INVALID_ADDRESS_OR_KEY,
@@ -489,7 +707,7 @@ Json::Value Server::GetSmartContractCode(const string& address) {
       throw JsonRpcException(RPC_INVALID_ADDRESS_OR_KEY, "invalid address");
     }
     Address addr(tmpaddr);
-    const Account* account = AccountStore::GetInstance().GetAccount(addr);
+    const auto account = AccountStore::GetInstance().GetCommittedAccount(addr);
 
     if (account == nullptr) {
       throw JsonRpcException(RPC_INVALID_ADDRESS_OR_KEY,
@@ -526,7 +744,7 @@ Json::Value Server::GetSmartContracts(const string& address) {
     }
 
     Address addr(tmpaddr);
-    const Account* account = AccountStore::GetInstance().GetAccount(addr);
+    const auto account = AccountStore::GetInstance().GetCommittedAccount(addr);
 
     if (account == nullptr) {
       throw JsonRpcException(RPC_INVALID_ADDRESS_OR_KEY,
@@ -542,8 +760,8 @@ Json::Value Server::GetSmartContracts(const string& address) {
 
     for (uint64_t i = 0; i < nonce; i++) {
       Address contractAddr = Account::GetAddressForContract(addr, i);
-      const Account* contractAccount =
-          AccountStore::GetInstance().GetAccount(contractAddr);
+      const auto contractAccount =
+          AccountStore::GetInstance().GetCommittedAccount(contractAddr);
 
       if (contractAccount == nullptr || !contractAccount->isContract()) {
         continue;
@@ -604,8 +822,7 @@ string Server::GetGasEstimate([[gnu::unused]] const Json::Value& _json) {
 unsigned int Server::GetNumPeers() {
   LOG_MARKER();
   unsigned int numPeers = m_mediator.m_lookup->GetNodePeers().size();
-  lock_guard<mutex> g(m_mediator.m_mutexDSCommittee);
-  return numPeers + m_mediator.m_DSCommittee->size();
+  return numPeers + m_mediator.GetDSCommitteeSnapshot()->size();
 }
 
 string Server::GetNumTxBlocks() {
@@ -621,165 +838,39 @@ string Server::GetNumDSBlocks() {
 }
 
 uint8_t Server::GetPrevDSDifficulty() {
-  return m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetDSDifficulty();
+  return m_mediator.m_dsBlockChain.GetLastBlockPtr()
+      ->GetHeader()
+      .GetDSDifficulty();
 }
 
 uint8_t Server::GetPrevDifficulty() {
-  return m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetDifficulty();
+  return m_mediator.m_dsBlockChain.GetLastBlockPtr()
+      ->GetHeader()
+      .GetDifficulty();
 }
 
 string Server::GetNumTransactions() {
   LOG_MARKER();
 
-  uint64_t currBlock =
-      m_mediator.m_txBlockChain.GetLastBlock().GetHeader().GetBlockNum();
-  if (m_BlockTxPair.first < currBlock) {
-    for (uint64_t i = m_BlockTxPair.first + 1; i <= currBlock; i++) {
-      m_BlockTxPair.second +=
-          m_mediator.m_txBlockChain.GetBlock(i).GetHeader().GetNumTxs();
-    }
-  }
-  m_BlockTxPair.first = currBlock;
-
-  return m_BlockTxPair.second.str();
+  return m_mediator.m_txBlockChain.GetNumTxns().str();
 }
 
-size_t Server::GetNumTransactions(uint64_t blockNum) {
-  uint64_t currBlockNum =
-      m_mediator.m_txBlockChain.GetLastBlock().GetHeader().GetBlockNum();
-
-  if (blockNum >= currBlockNum) {
-    return 0;
-  }
-
-  size_t i, res = 0;
-
-  for (i = blockNum + 1; i <= currBlockNum; i++) {
-    res += m_mediator.m_txBlockChain.GetBlock(i).GetHeader().GetNumTxs();
-  }
-
-  return res;
-}
 double Server::GetTransactionRate() {
   LOG_MARKER();
 
-  uint64_t refBlockNum =
-      m_mediator.m_txBlockChain.GetLastBlock().GetHeader().GetBlockNum();
-
-  uint64_t refTimeTx = 0;
-
-  if (refBlockNum <= REF_BLOCK_DIFF) {
-    if (refBlockNum <= 1) {
-      LOG_GENERAL(INFO, "Not enough blocks for information");
-      return 0;
-    } else {
-      refBlockNum = 1;
-      // In case there are less than REF_DIFF_BLOCKS blocks in blockchain,
-      // blocknum 1 can be ref block;
-    }
-  } else {
-    refBlockNum = refBlockNum - REF_BLOCK_DIFF;
-  }
-
-  boost::multiprecision::cpp_dec_float_50 numTxns(
-      Server::GetNumTransactions(refBlockNum));
-  LOG_GENERAL(INFO, "Num Txns: " << numTxns);
-
-  try {
-    TxBlock tx = m_mediator.m_txBlockChain.GetBlock(refBlockNum);
-    refTimeTx = tx.GetTimestamp();
-  } catch (const JsonRpcException& je) {
-    throw je;
-  } catch (const char* msg) {
-    if (string(msg) == "Blocknumber Absent") {
-      LOG_GENERAL(INFO, "Error in fetching ref block");
-    }
-    return 0;
-  }
-
-  uint64_t TimeDiff =
-      m_mediator.m_txBlockChain.GetLastBlock().GetTimestamp() - refTimeTx;
-
-  if (TimeDiff == 0 || refTimeTx == 0) {
-    // something went wrong
-    LOG_GENERAL(INFO, "TimeDiff or refTimeTx = 0 \n TimeDiff:"
-                          << TimeDiff << " refTimeTx:" << refTimeTx);
-    return 0;
-  }
-  numTxns = numTxns * 1000000;  // conversion from microseconds to seconds
-  boost::multiprecision::cpp_dec_float_50 TimeDiffFloat =
-      static_cast<boost::multiprecision::cpp_dec_float_50>(TimeDiff);
-  boost::multiprecision::cpp_dec_float_50 ans = numTxns / TimeDiffFloat;
-
-  return ans.convert_to<double>();
+  return m_mediator.m_txBlockChain.GetStats().GetTxnRate();
 }
 
 double Server::GetDSBlockRate() {
   LOG_MARKER();
 
-  string numDSblockStr = to_string(m_mediator.m_dsBlockChain.GetBlockCount());
-  boost::multiprecision::cpp_dec_float_50 numDs(numDSblockStr);
-
-  if (m_StartTimeDs == 0)  // case when m_StartTime has not been set
-  {
-    try {
-      // Refernce time chosen to be the first block's timestamp
-      DSBlock dsb = m_mediator.m_dsBlockChain.GetBlock(1);
-      m_StartTimeDs = dsb.GetTimestamp();
-    } catch (const JsonRpcException& je) {
-      throw je;
-    } catch (const char* msg) {
-      if (string(msg) == "Blocknumber Absent") {
-        LOG_GENERAL(INFO, "No DSBlock has been mined yet");
-      }
-      return 0;
-    }
-  }
-  uint64_t TimeDiff =
-      m_mediator.m_dsBlockChain.GetLastBlock().GetTimestamp() - m_StartTimeDs;
-
-  if (TimeDiff == 0) {
-    LOG_GENERAL(INFO, "Wait till the second block");
-    return 0;
-  }
-  // To convert from microSeconds to seconds
-  numDs = numDs * 1000000;
-  boost::multiprecision::cpp_dec_float_50 TimeDiffFloat =
-      static_cast<boost::multiprecision::cpp_dec_float_50>(TimeDiff);
-  boost::multiprecision::cpp_dec_float_50 ans = numDs / TimeDiffFloat;
-  return ans.convert_to<double>();
+  return m_mediator.m_dsBlockChain.GetStats().GetBlockRate();
 }
 
 double Server::GetTxBlockRate() {
   LOG_MARKER();
 
-  string numTxblockStr = to_string(m_mediator.m_txBlockChain.GetBlockCount());
-  boost::multiprecision::cpp_dec_float_50 numTx(numTxblockStr);
-
-  if (m_StartTimeTx == 0) {
-    try {
-      // Reference Time chosen to be first block's timestamp
-      TxBlock txb = m_mediator.m_txBlockChain.GetBlock(1);
-      m_StartTimeTx = txb.GetTimestamp();
-    } catch (const char* msg) {
-      if (string(msg) == "Blocknumber Absent") {
-        LOG_GENERAL(INFO, "No TxBlock has been mined yet");
-      }
-      return 0;
-    }
-  }
-  uint64_t TimeDiff =
-      m_mediator.m_txBlockChain.GetLastBlock().GetTimestamp() - m_StartTimeTx;
-
-  if (TimeDiff == 0) {
-    LOG_GENERAL(INFO, "Wait till the second block");
-    return 0;
-  }
-  // To convert from microSeconds to seconds
-  numTx = numTx * 1000000;
-  boost::multiprecision::cpp_dec_float_50 TimeDiffFloat(to_string(TimeDiff));
-  boost::multiprecision::cpp_dec_float_50 ans = numTx / TimeDiffFloat;
-  return ans.convert_to<double>();
+  return m_mediator.m_txBlockChain.GetStats().GetBlockRate();
 }
 
 string Server::GetCurrentMiniEpoch() {
@@ -792,185 +883,87 @@ string Server::GetCurrentDSEpoch() {
   LOG_MARKER();
 
   return to_string(
-      m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetBlockNum());
+      m_mediator.m_dsBlockChain.GetLastBlockPtr()->GetHeader().GetBlockNum());
 }
 
-Json::Value Server::DSBlockListing(unsigned int page) {
-  LOG_MARKER();
+void Server::GetBlockListingPage(const BlockType& blockType,
+                                 const uint64_t& currBlockNum,
+                                 unsigned int page,
+                                 vector<pair<uint64_t, BlockHash>>& entries) {
+  entries.clear();
 
-  uint64_t currBlockNum =
-      m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetBlockNum();
-  Json::Value _json;
+  const uint64_t high = currBlockNum - PAGE_SIZE * (page - 1);
+  const uint64_t low = (high >= PAGE_SIZE - 1) ? high - (PAGE_SIZE - 1) : 0;
 
-  auto maxPages = (currBlockNum / PAGE_SIZE) + 1;
-
-  _json["maxPages"] = int(maxPages);
-
-  if (m_DSBlockCache.second.size() == 0) {
-    try {
-      // add the hash of genesis block
-      DSBlockHeader dshead = m_mediator.m_dsBlockChain.GetBlock(0).GetHeader();
-      SHA2<HASH_TYPE::HASH_VARIANT_256> sha2;
-      bytes vec;
-      dshead.Serialize(vec, 0);
-      sha2.Update(vec);
-      const bytes& resVec = sha2.Finalize();
-      string resStr;
-      DataConversion::Uint8VecToHexStr(resVec, resStr);
-      m_DSBlockCache.second.insert_new(m_DSBlockCache.second.size(), resStr);
-    } catch (const char* msg) {
-      throw JsonRpcException(RPC_MISC_ERROR, string(msg));
-    }
-  }
+  map<uint64_t, BlockHash> blockHashes;
+  BlockStorage::GetBlockStorage().GetBlockHashes(blockType, low, high,
+                                                 blockHashes);
 
-  if (page > maxPages || page < 1) {
-    throw JsonRpcException(RPC_INVALID_PARAMETER, "Pages out of limit");
-  }
-
-  if (currBlockNum > m_DSBlockCache.first) {
-    for (uint64_t i = m_DSBlockCache.first + 1; i < currBlockNum; i++) {
-      m_DSBlockCache.second.insert_new(m_DSBlockCache.second.size(),
-                                       m_mediator.m_dsBlockChain.GetBlock(i + 1)
-                                           .GetHeader()
-                                           .GetPrevHash()
-                                           .hex());
+  for (uint64_t blockNum = high + 1; blockNum-- > low;) {
+    const auto it = blockHashes.find(blockNum);
+    if (it != blockHashes.end()) {
+      entries.emplace_back(blockNum, it->second);
+      continue;
     }
-    // for the latest block
-    DSBlockHeader dshead =
-        m_mediator.m_dsBlockChain.GetBlock(currBlockNum).GetHeader();
-    SHA2<HASH_TYPE::HASH_VARIANT_256> sha2;
-    bytes vec;
-    dshead.Serialize(vec, 0);
-    sha2.Update(vec);
-    const bytes& resVec = sha2.Finalize();
-    string resStr;
-    DataConversion::Uint8VecToHexStr(resVec, resStr);
-
-    m_DSBlockCache.second.insert_new(m_DSBlockCache.second.size(), resStr);
-    m_DSBlockCache.first = currBlockNum;
-  }
-
-  unsigned int offset = PAGE_SIZE * (page - 1);
-  Json::Value tmpJson;
-  if (page <= NUM_PAGES_CACHE)  // can use cache
-  {
-    boost::multiprecision::uint128_t cacheSize(
-        m_DSBlockCache.second.capacity());
-    if (cacheSize > m_DSBlockCache.second.size()) {
-      cacheSize = m_DSBlockCache.second.size();
-    }
-
-    uint64_t size = m_DSBlockCache.second.size();
 
-    for (unsigned int i = offset; i < PAGE_SIZE + offset && i < cacheSize;
-         i++) {
-      tmpJson.clear();
-      tmpJson["Hash"] = m_DSBlockCache.second[size - i - 1];
-      tmpJson["BlockNum"] = int(currBlockNum - i);
-      _json["data"].append(tmpJson);
-    }
-  } else {
-    for (uint64_t i = offset; i < PAGE_SIZE + offset && i <= currBlockNum;
-         i++) {
-      tmpJson.clear();
-      tmpJson["Hash"] = m_mediator.m_dsBlockChain.GetBlock(currBlockNum - i + 1)
-                            .GetHeader()
-                            .GetPrevHash()
-                            .hex();
-      tmpJson["BlockNum"] = int(currBlockNum - i);
-      _json["data"].append(tmpJson);
+    // Not indexed yet (e.g., committed before the index existed), so read it
+    // from the chain once and record it
+    const BlockHash blockHash =
+        (blockType == BlockType::DS)
+            ? m_mediator.m_dsBlockChain.GetBlockPtr(blockNum)->GetBlockHash()
+            : m_mediator.m_txBlockChain.GetBlockPtr(blockNum)->GetBlockHash();
+    if (blockHash != BlockHash()) {
+      BlockStorage::GetBlockStorage().PutBlockHash(blockType, blockNum,
+                                                   blockHash);
     }
+    entries.emplace_back(blockNum, blockHash);
   }
+}
 
-  return _json;
+Json::Value Server::DSBlockListing(unsigned int page) {
+  LOG_MARKER();
+
+  return BlockListing(
+      BlockType::DS,
+      m_mediator.m_dsBlockChain.GetLastBlockPtr()->GetHeader().GetBlockNum(),
+      page);
 }
 
 Json::Value Server::TxBlockListing(unsigned int page) {
   LOG_MARKER();
 
-  uint64_t currBlockNum =
-      m_mediator.m_txBlockChain.GetLastBlock().GetHeader().GetBlockNum();
+  return BlockListing(
+      BlockType::Tx,
+      m_mediator.m_txBlockChain.GetLastBlockPtr()->GetHeader().GetBlockNum(),
+      page);
+}
+
+Json::Value Server::BlockListing(const BlockType& blockType,
+                                 const uint64_t& currBlockNum,
+                                 unsigned int page) {
   Json::Value _json;
 
   auto maxPages = (currBlockNum / PAGE_SIZE) + 1;
 
   _json["maxPages"] = int(maxPages);
 
-  if (m_TxBlockCache.second.size() == 0) {
-    try {
-      // add the hash of genesis block
-      TxBlockHeader txhead = m_mediator.m_txBlockChain.GetBlock(0).GetHeader();
-      SHA2<HASH_TYPE::HASH_VARIANT_256> sha2;
-      bytes vec;
-      txhead.Serialize(vec, 0);
-      sha2.Update(vec);
-      const bytes& resVec = sha2.Finalize();
-      string resStr;
-      DataConversion::Uint8VecToHexStr(resVec, resStr);
-      m_TxBlockCache.second.insert_new(m_TxBlockCache.second.size(), resStr);
-    } catch (const char* msg) {
-      throw JsonRpcException(RPC_MISC_ERROR, string(msg));
-    }
-  }
-
   if (page > maxPages || page < 1) {
     throw JsonRpcException(RPC_INVALID_PARAMETER, "Pages out of limit");
   }
 
-  if (currBlockNum > m_TxBlockCache.first) {
-    for (uint64_t i = m_TxBlockCache.first + 1; i < currBlockNum; i++) {
-      m_TxBlockCache.second.insert_new(m_TxBlockCache.second.size(),
-                                       m_mediator.m_txBlockChain.GetBlock(i + 1)
-                                           .GetHeader()
-                                           .GetPrevHash()
-                                           .hex());
-    }
-    // for the latest block
-    TxBlockHeader txhead =
-        m_mediator.m_txBlockChain.GetBlock(currBlockNum).GetHeader();
-    SHA2<HASH_TYPE::HASH_VARIANT_256> sha2;
-    bytes vec;
-    txhead.Serialize(vec, 0);
-    sha2.Update(vec);
-    const bytes& resVec = sha2.Finalize();
-    string resStr;
-    DataConversion::Uint8VecToHexStr(resVec, resStr);
-
-    m_TxBlockCache.second.insert_new(m_TxBlockCache.second.size(), resStr);
-    m_TxBlockCache.first = currBlockNum;
-  }
-
-  unsigned int offset = PAGE_SIZE * (page - 1);
-  Json::Value tmpJson;
-  if (page <= NUM_PAGES_CACHE)  // can use cache
-  {
-    boost::multiprecision::uint128_t cacheSize(
-        m_TxBlockCache.second.capacity());
-
-    if (cacheSize > m_TxBlockCache.second.size()) {
-      cacheSize = m_TxBlockCache.second.size();
-    }
-
-    uint64_t size = m_TxBlockCache.second.size();
+  vector<pair<uint64_t, BlockHash>> entries;
+  try {
+    GetBlockListingPage(blockType, currBlockNum, page, entries);
+  } catch (const char* msg) {
+    throw JsonRpcException(RPC_MISC_ERROR, string(msg));
+  }
 
-    for (unsigned int i = offset; i < PAGE_SIZE + offset && i < cacheSize;
-         i++) {
-      tmpJson.clear();
-      tmpJson["Hash"] = m_TxBlockCache.second[size - i - 1];
-      tmpJson["BlockNum"] = int(currBlockNum - i);
-      _json["data"].append(tmpJson);
-    }
-  } else {
-    for (uint64_t i = offset; i < PAGE_SIZE + offset && i <= currBlockNum;
-         i++) {
-      tmpJson.clear();
-      tmpJson["Hash"] = m_mediator.m_txBlockChain.GetBlock(currBlockNum - i + 1)
-                            .GetHeader()
-                            .GetPrevHash()
-                            .hex();
-      tmpJson["BlockNum"] = int(currBlockNum - i);
-      _json["data"].append(tmpJson);
-    }
+  Json::Value tmpJson;
+  for (const auto& entry : entries) {
+    tmpJson.clear();
+    tmpJson["Hash"] = entry.second.hex();
+    tmpJson["BlockNum"] = int(entry.first);
+    _json["data"].append(tmpJson);
   }
 
   return _json;
@@ -1018,6 +1011,24 @@ void Server::AddToRecentTransactions(const TxnHash& txhash) {
   lock_guard<mutex> g(m_mutexRecentTxns);
   m_RecentTransactions.insert_new(m_RecentTransactions.size(), txhash.hex());
 }
+
+JSONResponseCache& Server::GetResponseCache() {
+  static JSONResponseCache cache(JSON_RESPONSE_CACHE_SIZE);
+  return cache;
+}
+
+void Server::CacheDSBlockResponse(const DSBlock& dsblock) {
+  GetResponseCache().Put("GetDsBlock",
+                         to_string(dsblock.GetHeader().GetBlockNum()),
+                         JSONConversion::convertDSblocktoJson(dsblock));
+}
+
+void Server::CacheTxBlockResponse(const TxBlock& txblock) {
+  GetResponseCache().Put("GetTxBlock",
+                         to_string(txblock.GetHeader().GetBlockNum()),
+                         JSONConversion::convertTxBlocktoJson(txblock));
+}
+
 Json::Value Server::GetShardingStructure() {
   LOG_MARKER();
 
@@ -1026,13 +1037,14 @@ Json::Value Server::GetShardingStructure() {
 
     auto shards = m_mediator.m_lookup->GetShardPeers();
 
-    unsigned int num_shards = shards.size();
+    unsigned int num_shards = shards->size();
 
     if (num_shards == 0) {
       throw JsonRpcException(RPC_IN_WARMUP, "No shards yet");
     } else {
       for (unsigned int i = 0; i < num_shards; i++) {
-        _json["NumPeers"].append(static_cast<unsigned int>(shards[i].size()));
+        _json["NumPeers"].append(
+            static_cast<unsigned int>(shards->at(i).size()));
       }
     }
     return _json;
@@ -1045,87 +1057,521 @@ Json::Value Server::GetShardingStructure() {
   }
 }
 
-string Server::GetNumTxnsTxEpoch() {
-  LOG_MARKER();
+void Server::HandleMethodCall(Procedure& proc, const Json::Value& input,
+                              Json::Value& output) {
+  const auto start = chrono::steady_clock::now();
+  const auto elapsed = [&start]() {
+    return static_cast<uint64_t>(
+        chrono::duration_cast<chrono::microseconds>(
+            chrono::steady_clock::now() - start)
+            .count());
+  };
 
   try {
-    return to_string(
-        m_mediator.m_txBlockChain.GetLastBlock().GetHeader().GetNumTxs());
+    AbstractZServer::HandleMethodCall(proc, input, output);
+  } catch (...) {
+    RpcMetrics::GetInstance().Record(proc.GetProcedureName(), elapsed(),
+                                     true);
+    throw;
+  }
+  RpcMetrics::GetInstance().Record(proc.GetProcedureName(), elapsed(), false);
+}
+
+bool Server::HandleStreamed(const string& request, string& response) {
+  // Txn submissions skip the DOM on the way in, not just on the way out
+  if (request.find("\"CreateTransaction") != string::npos) {
+    JSONTxnParser::Call call;
+    if (JSONTxnParser::Parse(request, call)) {
+      StreamCreateTransaction(call, response);
+      return true;
+    }
+  }
+
+  // Spare the calls to other methods a second parse
+  static const vector<string> streamed = {"\"GetTransaction\"",
+                                          "\"GetTxBlock\"",
+                                          "\"GetTransactionsForTxBlock\""};
+  if (none_of(streamed.begin(), streamed.end(), [&request](const string& s) {
+        return request.find(s) != string::npos;
+      })) {
+    return false;
+  }
+
+  Json::Value call;
+  Json::CharReaderBuilder builder;
+  unique_ptr<Json::CharReader> reader(builder.newCharReader());
+  string errors;
+  if (!reader->parse(request.data(), request.data() + request.size(), &call,
+                     &errors) ||
+      !call.isObject() || call.get("jsonrpc", "") != "2.0" ||
+      !call["method"].isString() ||
+      !(call["id"].isString() || call["id"].isIntegral())) {
+    return false;
+  }
+
+  // Calls with params the procedures would refuse get the handler's error
+  const string method = call["method"].asString();
+  const Json::Value& params = call["params"];
+  if (!params.isArray() || params.size() == 0 || !params[0u].isString()) {
+    return false;
+  }
+  if (method == "GetTransaction" || method == "GetTxBlock") {
+    if (params.size() != 1) {
+      return false;
+    }
+  } else if (method == "GetTransactionsForTxBlock") {
+    if (params.size() != 2 || !params[1u].isUInt()) {
+      return false;
+    }
+  } else {
+    return false;
+  }
+
+  WriteStreamed(method, call["id"], response,
+                [this, &method, &params](JSONStreamWriter& writer) {
+                  if (method == "GetTransaction") {
+                    StreamTransaction(params[0u].asString(), writer);
+                  } else if (method == "GetTxBlock") {
+                    StreamTxBlock(params[0u].asString(), writer);
+                  } else {
+                    StreamTransactionsForTxBlock(params[0u].asString(),
+                                                 params[1u].asUInt(), writer);
+                  }
+                });
+  return true;
+}
+
+void Server::StreamCreateTransaction(const JSONTxnParser::Call& call,
+                                     string& response) {
+  WriteStreamed(call.m_method, call.m_id, response,
+                [this, &call](JSONStreamWriter& writer) {
+                  const auto convert = [&call](unsigned int i) -> Transaction {
+                    if (!JSONConversion::checkJsonTx(call.m_txns.at(i))) {
+                      throw JsonRpcException(RPC_PARSE_ERROR,
+                                             "Invalid Transaction JSON");
+                    }
+                    return JSONConversion::convertJsontoTx(call.m_txns.at(i));
+                  };
+                  if (call.m_method == "CreateTransactionBatch") {
+                    writer.Value(
+                        SubmitTransactionBatch(call.m_txns.size(), convert));
+                    return;
+                  }
+                  try {
+                    writer.Value(SubmitTransaction(convert(0)));
+                  } catch (const JsonRpcException& je) {
+                    throw je;
+                  } catch (exception& e) {
+                    LOG_GENERAL(INFO, "[Error]" << e.what());
+                    throw JsonRpcException(RPC_MISC_ERROR, "Unable to Process");
+                  }
+                });
+}
+
+void Server::WriteStreamed(
+    const string& method, const Json::Value& id, string& response,
+    const function<void(JSONStreamWriter& writer)>& result) {
+  const auto start = chrono::steady_clock::now();
+  bool failed = false;
+
+  response.clear();
+  try {
+    JSONStreamWriter writer(response);
+    writer.BeginObject().Key("id").Value(id);
+    writer.Key("jsonrpc").String("2.0").Key("result");
+    result(writer);
+    writer.EndObject();
   } catch (const JsonRpcException& je) {
-    throw je;
+    failed = true;
+    response.clear();
+    JSONStreamWriter writer(response);
+    writer.BeginObject().Key("error").BeginObject();
+    writer.Key("code").Int(je.GetCode()).Key("message").String(je.GetMessage());
+    writer.EndObject().Key("id").Value(id).Key("jsonrpc").String("2.0");
+    writer.EndObject();
+  } catch (const exception& e) {
+    LOG_GENERAL(INFO, "[Error]" << e.what() << " Method: " << method);
+    failed = true;
+    response.clear();
+    JSONStreamWriter writer(response);
+    writer.BeginObject().Key("error").BeginObject();
+    writer.Key("code").Int(RPC_MISC_ERROR).Key("message").String(
+        "Unable To Process");
+    writer.EndObject().Key("id").Value(id).Key("jsonrpc").String("2.0");
+    writer.EndObject();
+  }
+  response += '\n';
+
+  RpcMetrics::GetInstance().Record(
+      method,
+      chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() -
+                                                  start)
+          .count(),
+      failed);
+}
+
+void Server::StreamTransaction(const string& transactionHash,
+                               JSONStreamWriter& writer) {
+  if (transactionHash.size() != TRAN_HASH_SIZE * 2) {
+    throw JsonRpcException(RPC_INVALID_PARAMS, "Size not appropriate");
+  }
+  TxnHash tranHash(transactionHash);
+
+  string json;
+  if (!GetResponseCache().GetSerialized("GetTransaction", tranHash.hex(),
+                                        json)) {
+    JSONStreamWriter txnWriter(json);
+    JSONConversion::convertTxtoJson(*FetchTransaction(tranHash), txnWriter);
+    GetResponseCache().PutSerialized("GetTransaction", tranHash.hex(), json);
+  }
+  writer.Raw(json);
+}
+
+void Server::StreamTxBlock(const string& blockNum, JSONStreamWriter& writer) {
+  uint64_t BlockNum;
+  try {
+    BlockNum = stoull(blockNum);
+  } catch (invalid_argument&) {
+    throw JsonRpcException(RPC_INVALID_PARAMS, "Invalid arugment");
+  } catch (out_of_range&) {
+    throw JsonRpcException(RPC_INVALID_PARAMS, "Out of range");
+  }
+
+  string json;
+  if (!GetResponseCache().GetSerialized("GetTxBlock", to_string(BlockNum),
+                                        json)) {
+    const auto txblock = m_mediator.m_txBlockChain.GetBlockPtr(BlockNum);
+    JSONStreamWriter blockWriter(json);
+    JSONConversion::convertTxBlocktoJson(*txblock, blockWriter);
+    // Dummy blocks returned for unknown numbers are not cached
+    if (txblock->GetHeader().GetBlockNum() == BlockNum) {
+      GetResponseCache().PutSerialized("GetTxBlock", to_string(BlockNum),
+                                       json);
+    }
+  }
+  writer.Raw(json);
+}
+
+void Server::StreamTransactionsForTxBlock(const string& txBlockNum,
+                                          unsigned int shardID,
+                                          JSONStreamWriter& writer) {
+  const auto tranHashes = GetTranHashesForTxBlock(txBlockNum, shardID);
+  writer.BeginArray();
+  for (const auto& tranHash : tranHashes) {
+    writer.Hash(tranHash);
+  }
+  writer.EndArray();
+}
+
+Json::Value Server::GetConsensusPhaseStats() {
+  LOG_MARKER();
+
+  Json::Value _json = Json::arrayValue;
+
+  for (const auto& stats : ConsensusTrace::GetInstance().GetStats()) {
+    Json::Value entry;
+    entry["BlockType"] = ConsensusTrace::GetBlockTypeName(stats.m_blockType);
+    entry["Phase"] = ConsensusTrace::GetPhaseName(stats.m_phase);
+    entry["SubsetID"] = stats.m_subsetID;
+    entry["LastConsensusID"] = stats.m_lastConsensusID;
+    entry["Count"] = static_cast<Json::UInt64>(stats.m_count);
+    entry["TotalMicroseconds"] =
+        static_cast<Json::UInt64>(stats.m_totalInMicroseconds);
+    entry["MaxMicroseconds"] =
+        static_cast<Json::UInt64>(stats.m_maxInMicroseconds);
+    // Bucket i counts durations below 2^i ms
+    for (const auto& bucket : stats.m_buckets) {
+      entry["Buckets"].append(static_cast<Json::UInt64>(bucket));
+    }
+    _json.append(entry);
+  }
+
+  return _json;
+}
+
+Json::Value Server::GetRpcMethodStats() {
+  LOG_MARKER();
+
+  Json::Value _json = Json::arrayValue;
+
+  for (const auto& stats : RpcMetrics::GetInstance().GetStats()) {
+    Json::Value entry;
+    entry["Method"] = stats.m_method;
+    entry["Count"] = static_cast<Json::UInt64>(stats.m_count);
+    entry["ErrorCount"] = static_cast<Json::UInt64>(stats.m_errorCount);
+    entry["TotalMicroseconds"] =
+        static_cast<Json::UInt64>(stats.m_totalInMicroseconds);
+    entry["MaxMicroseconds"] =
+        static_cast<Json::UInt64>(stats.m_maxInMicroseconds);
+    // Bucket i counts durations below 2^i * 100 us
+    for (const auto& bucket : stats.m_buckets) {
+      entry["Buckets"].append(static_cast<Json::UInt64>(bucket));
+    }
+    _json.append(entry);
+  }
+
+  return _json;
+}
+
+namespace {
+Json::Value HistogramToJson(const MetricHistogram& histogram) {
+  Json::Value _json;
+  _json["Count"] = static_cast<Json::UInt64>(histogram.m_count);
+  _json["Total"] = static_cast<Json::UInt64>(histogram.m_total);
+  _json["Max"] = static_cast<Json::UInt64>(histogram.m_max);
+  _json["Last"] = static_cast<Json::UInt64>(histogram.m_last);
+  for (const auto& bucket : histogram.m_buckets) {
+    _json["Buckets"].append(static_cast<Json::UInt64>(bucket));
+  }
+  return _json;
+}
+}  // namespace
+
+Json::Value Server::GetEpochMetrics() {
+  LOG_MARKER();
+
+  EpochMetrics& metrics = EpochMetrics::GetInstance();
+
+  Json::Value _json;
+  _json["Epoch"] = static_cast<Json::UInt64>(metrics.GetCurrentEpoch());
+
+  // Message bucket i counts times below 2^i * 100 us or sizes below
+  // 2^i * 64 bytes
+  _json["Messages"] = Json::arrayValue;
+  for (const auto& stats : metrics.GetMessageStats()) {
+    Json::Value entry;
+    entry["Message"] = stats.m_name;
+    entry["Microseconds"] = HistogramToJson(stats.m_time);
+    entry["Bytes"] = HistogramToJson(stats.m_size);
+    _json["Messages"].append(entry);
+  }
+
+  // Phase bucket i counts durations below 2^i ms
+  _json["Phases"] = Json::arrayValue;
+  for (const auto& stats : metrics.GetPhaseStats()) {
+    Json::Value entry;
+    entry["Phase"] = EpochMetrics::GetPhaseName(stats.m_phase);
+    entry["LastEpoch"] = static_cast<Json::UInt64>(stats.m_lastEpoch);
+    entry["Microseconds"] = HistogramToJson(stats.m_time);
+    _json["Phases"].append(entry);
+  }
+
+  return _json;
+}
+
+Json::Value Server::GetEpochTimeline(const string& fromEpoch) {
+  LOG_MARKER();
+
+  uint64_t epochNum = 0;
+  try {
+    epochNum = stoull(fromEpoch);
   } catch (exception& e) {
-    LOG_GENERAL(WARNING, e.what());
-    return "0";
+    LOG_GENERAL(INFO, "[Error]" << e.what() << " Input: " << fromEpoch);
+    throw JsonRpcException(RPC_INVALID_PARAMS, "String not numeric");
   }
+
+  Json::Value _json;
+  _json["PubKey"] = static_cast<string>(m_mediator.m_selfKey.second);
+  _json["Peer"] = m_mediator.m_selfPeer.GetPrintableIPAddress() + ":" +
+                  to_string(m_mediator.m_selfPeer.m_listenPortHost);
+  _json["Recorded"] = static_cast<Json::UInt64>(
+      EpochTimeline::GetInstance().GetRecordedCount());
+
+  _json["Events"] = Json::arrayValue;
+  for (const auto& event : EpochTimeline::GetInstance().GetEvents(epochNum)) {
+    Json::Value entry;
+    entry["Epoch"] = static_cast<Json::UInt64>(event.m_epoch);
+    entry["Monotonic"] =
+        static_cast<Json::UInt64>(event.m_monotonicMicroseconds);
+    entry["Wall"] = static_cast<Json::UInt64>(event.m_wallMicroseconds);
+    entry["Kind"] = EpochTimeline::GetKindName(event.m_kind);
+    entry["Name"] =
+        (event.m_kind == TIMELINE_MARK)
+            ? EpochTimeline::GetMarkName(static_cast<TimelineMark>(event.m_id))
+            : EpochMetrics::GetPhaseName(static_cast<EpochPhase>(event.m_id));
+    entry["Role"] = EpochTimeline::GetRoleName(event.m_role);
+    _json["Events"].append(entry);
+  }
+  return _json;
 }
 
-string Server::GetNumTxnsDSEpoch() {
+Json::Value Server::GetChromeTrace() {
+  LOG_MARKER();
+
+  if (!TRACE_ENABLED) {
+    throw JsonRpcException(RPC_MISC_ERROR, "Tracing is disabled");
+  }
+
+  const auto pid = static_cast<Json::UInt>(getpid());
+
+  Json::Value _json;
+  _json["displayTimeUnit"] = "ms";
+  _json["traceEvents"] = Json::arrayValue;
+  for (const auto& thread : Tracer::GetInstance().GetEvents()) {
+    for (const auto& event : thread.m_events) {
+      Json::Value entry;
+      entry["name"] = event.m_name;
+      entry["ph"] = "X";
+      entry["pid"] = pid;
+      entry["tid"] = thread.m_tid;
+      entry["ts"] = static_cast<Json::UInt64>(event.m_startInMicroseconds);
+      entry["dur"] = static_cast<Json::UInt64>(event.m_durationInMicroseconds);
+      _json["traceEvents"].append(entry);
+    }
+  }
+
+  return _json;
+}
+
+string Server::StartProfiler(const string& frequency) {
   LOG_MARKER();
 
+  if (!PROFILER_API) {
+    throw JsonRpcException(RPC_MISC_ERROR, "Profiler API is disabled");
+  }
+
+  unsigned long samplesPerSecond = 0;
   try {
-    auto latestTxBlock = m_mediator.m_txBlockChain.GetLastBlock().GetHeader();
-    auto latestTxBlockNum = latestTxBlock.GetBlockNum();
-    auto latestDSBlockNum = latestTxBlock.GetDSBlockNum();
-
-    if (latestTxBlockNum > m_TxBlockCountSumPair.first) {
-      // Case where the DS Epoch is same
-      if (m_mediator.m_txBlockChain.GetBlock(m_TxBlockCountSumPair.first)
-              .GetHeader()
-              .GetDSBlockNum() == latestDSBlockNum) {
-        for (auto i = latestTxBlockNum; i > m_TxBlockCountSumPair.first; i--) {
-          m_TxBlockCountSumPair.second +=
-              m_mediator.m_txBlockChain.GetBlock(i).GetHeader().GetNumTxs();
-        }
-      }
-      // Case if DS Epoch Changed
-      else {
-        m_TxBlockCountSumPair.second = 0;
-
-        for (auto i = latestTxBlockNum; i > m_TxBlockCountSumPair.first; i--) {
-          if (m_mediator.m_txBlockChain.GetBlock(i)
-                  .GetHeader()
-                  .GetDSBlockNum() < latestDSBlockNum) {
-            break;
-          }
-          m_TxBlockCountSumPair.second +=
-              m_mediator.m_txBlockChain.GetBlock(i).GetHeader().GetNumTxs();
-        }
-      }
+    samplesPerSecond = stoul(frequency);
+  } catch (exception& e) {
+    LOG_GENERAL(INFO, "[Error]" << e.what() << " Input: " << frequency);
+    throw JsonRpcException(RPC_INVALID_PARAMS, "String not numeric");
+  }
+  if (samplesPerSecond == 0 ||
+      samplesPerSecond > SamplingProfiler::MAX_FREQUENCY) {
+    throw JsonRpcException(RPC_INVALID_PARAMS,
+                           "Frequency must be within 1.." +
+                               to_string(SamplingProfiler::MAX_FREQUENCY));
+  }
+
+  if (!SamplingProfiler::GetInstance().Start(samplesPerSecond)) {
+    throw JsonRpcException(RPC_MISC_ERROR, "Profiler could not be started");
+  }
+  return "Profiler started";
+}
+
+Json::Value Server::StopProfiler() {
+  LOG_MARKER();
+
+  if (!PROFILER_API) {
+    throw JsonRpcException(RPC_MISC_ERROR, "Profiler API is disabled");
+  }
+
+  SamplingProfiler::Profile profile;
+  if (!SamplingProfiler::GetInstance().Stop(profile)) {
+    throw JsonRpcException(RPC_MISC_ERROR, "Profiler is not running");
+  }
+
+  Json::Value _json;
+  _json["BuildId"] = SamplingProfiler::GetBuildId();
+  _json["Samples"] = static_cast<Json::UInt64>(profile.m_samples);
+  _json["Dropped"] = static_cast<Json::UInt64>(profile.m_dropped);
+  _json["Milliseconds"] =
+      static_cast<Json::UInt64>(profile.m_durationInMilliseconds);
+  _json["Folded"] = profile.m_folded;
+  return _json;
+}
+
+Json::Value Server::GetMemoryStats() {
+  LOG_MARKER();
+
+  if (!MEMORY_STATS_API) {
+    throw JsonRpcException(RPC_MISC_ERROR, "Memory stats API is disabled");
+  }
 
-      m_TxBlockCountSumPair.first = latestTxBlockNum;
+  Json::Value _json;
+  for (const auto& entry : MemoryStats::GetInstance().Collect()) {
+    Json::Value usage;
+    usage["Bytes"] = static_cast<Json::UInt64>(entry.second.m_bytes);
+    usage["Objects"] = static_cast<Json::UInt64>(entry.second.m_objects);
+    _json[entry.first] = usage;
+  }
+  _json["ResidentBytes"] =
+      static_cast<Json::UInt64>(MemoryStats::GetResidentBytes());
+  return _json;
+}
+
+Json::Value Server::GetLockStats() {
+  LOG_MARKER();
+
+  if (!LOCK_PROFILING) {
+    throw JsonRpcException(RPC_MISC_ERROR, "Lock profiling is disabled");
+  }
+
+  Json::Value _json;
+  for (const auto& stats : LockProfiler::GetInstance().Collect()) {
+    Json::Value entry;
+    entry["Acquisitions"] = static_cast<Json::UInt64>(stats.m_acquisitions);
+    entry["Contentions"] = static_cast<Json::UInt64>(stats.m_contentions);
+    entry["WaitMicroseconds"] =
+        static_cast<Json::UInt64>(stats.m_waitMicroseconds);
+    entry["MaxWaitMicroseconds"] =
+        static_cast<Json::UInt64>(stats.m_maxWaitMicroseconds);
+    entry["HoldMicroseconds"] =
+        static_cast<Json::UInt64>(stats.m_holdMicroseconds);
+    entry["MaxHoldMicroseconds"] =
+        static_cast<Json::UInt64>(stats.m_maxHoldMicroseconds);
+    entry["TopWaiters"] = Json::arrayValue;
+    for (const auto& waiter : stats.m_topWaiters) {
+      Json::Value w;
+      w["Thread"] = waiter.first;
+      w["WaitMicroseconds"] = static_cast<Json::UInt64>(waiter.second);
+      entry["TopWaiters"].append(w);
     }
+    _json[stats.m_name] = entry;
+  }
+  return _json;
+}
+
+string Server::GetNumTxnsTxEpoch() {
+  LOG_MARKER();
 
-    return m_TxBlockCountSumPair.second.str();
+  try {
+    return to_string(
+        m_mediator.m_txBlockChain.GetLastBlockPtr()->GetHeader().GetNumTxs());
   } catch (const JsonRpcException& je) {
     throw je;
-  }
-
-  catch (exception& e) {
+  } catch (exception& e) {
     LOG_GENERAL(WARNING, e.what());
     return "0";
   }
 }
 
+string Server::GetNumTxnsDSEpoch() {
+  LOG_MARKER();
+
+  return to_string(m_mediator.m_txBlockChain.GetStats().GetNumTxnsDSEpoch());
+}
+
 Json::Value Server::GetTransactionsForTxBlock(const string& txBlockNum,
                                               unsigned int shardID) {
   LOG_MARKER();
   LOG_GENERAL(INFO, txBlockNum << " " << shardID);
-  uint64_t txNum;
   Json::Value _json = Json::arrayValue;
+  for (const auto& tranHash : GetTranHashesForTxBlock(txBlockNum, shardID)) {
+    _json.append(tranHash.hex());
+  }
+  return _json;
+}
+
+vector<TxnHash> Server::GetTranHashesForTxBlock(const string& txBlockNum,
+                                                unsigned int shardID) {
+  uint64_t txNum;
   try {
     txNum = strtoull(txBlockNum.c_str(), NULL, 0);
   } catch (exception& e) {
     throw JsonRpcException(RPC_INVALID_PARAMETER, e.what());
   }
 
-  auto const& txBlock = m_mediator.m_txBlockChain.GetBlock(txNum);
+  const auto txBlock = m_mediator.m_txBlockChain.GetBlockPtr(txNum);
 
-  if (txBlock == TxBlock()) {
+  if (*txBlock == TxBlock()) {
     throw JsonRpcException(RPC_INVALID_PARAMS, "Tx Block does not exist");
   }
 
-  auto microBlockInfos = txBlock.GetMicroBlockInfos();
+  const auto& microBlockInfos = txBlock->GetMicroBlockInfos();
 
+  vector<TxnHash> tranHashes;
   for (auto const& mbInfo : microBlockInfos) {
     MicroBlockSharedPtr mbptr;
     if (mbInfo.m_txnRootHash == TxnHash() && mbInfo.m_shardId == shardID) {
@@ -1144,13 +1590,66 @@ Json::Value Server::GetTransactionsForTxBlock(const string& txBlockNum,
                                  "Failed to get Microblock");
         }
       }
-      auto tranHashes = mbptr->GetTranHashes();
-
-      for (const auto& tranHash : tranHashes) {
-        _json.append(tranHash.hex());
-      }
+      const auto& mbTranHashes = mbptr->GetTranHashes();
+      tranHashes.insert(tranHashes.end(), mbTranHashes.begin(),
+                        mbTranHashes.end());
     }
   }
 
-  return _json;
-}
\ No newline at end of file
+  return tranHashes;
+}
+
+Json::Value Server::GetTransactionsForAddress(const string& address,
+                                              const string& cursor) {
+  LOG_MARKER();
+
+  if (!ENABLE_TXN_ADDRESS_INDEX) {
+    throw JsonRpcException(RPC_DATABASE_ERROR,
+                           "Transaction address index is disabled");
+  }
+
+  try {
+    if (address.size() != ACC_ADDR_SIZE * 2) {
+      throw JsonRpcException(RPC_INVALID_PARAMETER,
+                             "Address size not appropriate");
+    }
+    bytes tmpaddr;
+    if (!DataConversion::HexStrToUint8Vec(address, tmpaddr)) {
+      throw JsonRpcException(RPC_INVALID_ADDRESS_OR_KEY, "invalid address");
+    }
+
+    bytes pos;
+    if (!cursor.empty() && !DataConversion::HexStrToUint8Vec(cursor, pos)) {
+      throw JsonRpcException(RPC_INVALID_PARAMETER, "invalid cursor");
+    }
+
+    vector<pair<uint64_t, TxnHash>> txns;
+    if (!BlockStorage::GetBlockStorage().GetTxnsForAddress(
+            Address(tmpaddr), pos, TXN_ADDRESS_INDEX_PAGE_SIZE, txns)) {
+      throw JsonRpcException(RPC_DATABASE_ERROR,
+                             "Failed to read transaction address index");
+    }
+
+    Json::Value _json;
+    _json["Transactions"] = Json::arrayValue;
+    for (const auto& txn : txns) {
+      Json::Value entry;
+      entry["BlockNum"] = to_string(txn.first);
+      entry["TxnHash"] = txn.second.hex();
+      _json["Transactions"].append(entry);
+    }
+
+    string nextCursor;
+    if (!pos.empty() && !DataConversion::Uint8VecToHexStr(pos, nextCursor)) {
+      throw JsonRpcException(RPC_MISC_ERROR, "Unable To Process");
+    }
+    _json["NextCursor"] = nextCursor;
+
+    return _json;
+  } catch (const JsonRpcException& je) {
+    throw je;
+  } catch (exception& e) {
+    LOG_GENERAL(INFO, "[Error]" << e.what() << " Input: " << address);
+    throw JsonRpcException(RPC_MISC_ERROR, "Unable To Process");
+  }
+}
@@ -21,7 +21,12 @@
 #pragma GCC diagnostic ignored "-Wunused-parameter"
 #include <boost/multiprecision/cpp_int.hpp>
 #pragma GCC diagnostic pop
+#include <functional>
 #include <mutex>
+#include "JSONResponseCache.h"
+#include "JSONStreamWriter.h"
+#include "JSONTxnParser.h"
+#include "libData/BlockData/Block.h"
 #include "libData/BlockData/BlockHeader/BlockHeaderBase.h"
 #include "libData/DataStructures/CircularArray.h"
 
@@ -71,6 +76,11 @@ class AbstractZServer : public jsonrpc::AbstractServer<AbstractZServer> {
                            jsonrpc::JSON_OBJECT, "param01",
                            jsonrpc::JSON_OBJECT, NULL),
         &AbstractZServer::CreateTransactionI);
+    this->bindAndAddMethod(
+        jsonrpc::Procedure("CreateTransactionBatch",
+                           jsonrpc::PARAMS_BY_POSITION, jsonrpc::JSON_ARRAY,
+                           "param01", jsonrpc::JSON_ARRAY, NULL),
+        &AbstractZServer::CreateTransactionBatchI);
     this->bindAndAddMethod(
         jsonrpc::Procedure("GetTransaction", jsonrpc::PARAMS_BY_POSITION,
                            jsonrpc::JSON_OBJECT, "param01",
@@ -99,6 +109,12 @@ class AbstractZServer : public jsonrpc::AbstractServer<AbstractZServer> {
                            jsonrpc::JSON_OBJECT, "param01",
                            jsonrpc::JSON_STRING, NULL),
         &AbstractZServer::GetBalanceI);
+    this->bindAndAddMethod(
+        jsonrpc::Procedure("GetBalanceAt", jsonrpc::PARAMS_BY_POSITION,
+                           jsonrpc::JSON_OBJECT, "param01",
+                           jsonrpc::JSON_STRING, "param02",
+                           jsonrpc::JSON_STRING, NULL),
+        &AbstractZServer::GetBalanceAtI);
     this->bindAndAddMethod(
         jsonrpc::Procedure("GetMinimumGasPrice", jsonrpc::PARAMS_BY_POSITION,
                            jsonrpc::JSON_STRING, NULL),
@@ -197,11 +213,58 @@ class AbstractZServer : public jsonrpc::AbstractServer<AbstractZServer> {
         jsonrpc::Procedure("GetNumTxnsDSEpoch", jsonrpc::PARAMS_BY_POSITION,
                            jsonrpc::JSON_STRING, NULL),
         &AbstractZServer::GetNumTxnsDSEpochI);
+    this->bindAndAddMethod(
+        jsonrpc::Procedure("GetConsensusPhaseStats",
+                           jsonrpc::PARAMS_BY_POSITION, jsonrpc::JSON_ARRAY,
+                           NULL),
+        &AbstractZServer::GetConsensusPhaseStatsI);
+    this->bindAndAddMethod(
+        jsonrpc::Procedure("GetRpcMethodStats", jsonrpc::PARAMS_BY_POSITION,
+                           jsonrpc::JSON_ARRAY, NULL),
+        &AbstractZServer::GetRpcMethodStatsI);
+    this->bindAndAddMethod(
+        jsonrpc::Procedure("GetEpochMetrics", jsonrpc::PARAMS_BY_POSITION,
+                           jsonrpc::JSON_OBJECT, NULL),
+        &AbstractZServer::GetEpochMetricsI);
+    this->bindAndAddMethod(
+        jsonrpc::Procedure("GetEpochTimeline", jsonrpc::PARAMS_BY_POSITION,
+                           jsonrpc::JSON_OBJECT, "param01",
+                           jsonrpc::JSON_STRING, NULL),
+        &AbstractZServer::GetEpochTimelineI);
+    this->bindAndAddMethod(
+        jsonrpc::Procedure("GetChromeTrace", jsonrpc::PARAMS_BY_POSITION,
+                           jsonrpc::JSON_OBJECT, NULL),
+        &AbstractZServer::GetChromeTraceI);
+    this->bindAndAddMethod(
+        jsonrpc::Procedure("StartProfiler", jsonrpc::PARAMS_BY_POSITION,
+                           jsonrpc::JSON_STRING, "param01",
+                           jsonrpc::JSON_STRING, NULL),
+        &AbstractZServer::StartProfilerI);
+    this->bindAndAddMethod(
+        jsonrpc::Procedure("StopProfiler", jsonrpc::PARAMS_BY_POSITION,
+                           jsonrpc::JSON_OBJECT, NULL),
+        &AbstractZServer::StopProfilerI);
+    this->bindAndAddMethod(
+        jsonrpc::Procedure("GetMemoryStats", jsonrpc::PARAMS_BY_POSITION,
+                           jsonrpc::JSON_OBJECT, NULL),
+        &AbstractZServer::GetMemoryStatsI);
+    this->bindAndAddMethod(
+        jsonrpc::Procedure("GetLockStats", jsonrpc::PARAMS_BY_POSITION,
+                           jsonrpc::JSON_OBJECT, NULL),
+        &AbstractZServer::GetLockStatsI);
     this->bindAndAddMethod(
         jsonrpc::Procedure("GetSmartContractState", jsonrpc::PARAMS_BY_POSITION,
                            jsonrpc::JSON_OBJECT, "param01",
                            jsonrpc::JSON_STRING, NULL),
         &AbstractZServer::GetSmartContractStateI);
+    this->bindAndAddMethod(
+        jsonrpc::Procedure("GetSmartContractSubState",
+                           jsonrpc::PARAMS_BY_POSITION, jsonrpc::JSON_OBJECT,
+                           "param01", jsonrpc::JSON_STRING, "param02",
+                           jsonrpc::JSON_STRING, "param03",
+                           jsonrpc::JSON_STRING, "param04",
+                           jsonrpc::JSON_STRING, NULL),
+        &AbstractZServer::GetSmartContractSubStateI);
     this->bindAndAddMethod(
         jsonrpc::Procedure("GetSmartContractCode", jsonrpc::PARAMS_BY_POSITION,
                            jsonrpc::JSON_OBJECT, "param01",
@@ -218,6 +281,12 @@ class AbstractZServer : public jsonrpc::AbstractServer<AbstractZServer> {
                            "param01", jsonrpc::JSON_STRING, "param02",
                            jsonrpc::JSON_INTEGER, NULL),
         &AbstractZServer::GetTransactionsForTxBlockI);
+    this->bindAndAddMethod(
+        jsonrpc::Procedure("GetTransactionsForAddress",
+                           jsonrpc::PARAMS_BY_POSITION, jsonrpc::JSON_OBJECT,
+                           "param01", jsonrpc::JSON_STRING, "param02",
+                           jsonrpc::JSON_STRING, NULL),
+        &AbstractZServer::GetTransactionsForAddressI);
   }
 
   inline virtual void GetNetworkIdI(const Json::Value& request,
@@ -229,6 +298,10 @@ class AbstractZServer : public jsonrpc::AbstractServer<AbstractZServer> {
                                          Json::Value& response) {
     response = this->CreateTransaction(request[0u]);
   }
+  inline virtual void CreateTransactionBatchI(const Json::Value& request,
+                                              Json::Value& response) {
+    response = this->CreateTransactionBatch(request[0u]);
+  }
   inline virtual void GetTransactionI(const Json::Value& request,
                                       Json::Value& response) {
     response = this->GetTransaction(request[0u].asString());
@@ -255,6 +328,11 @@ class AbstractZServer : public jsonrpc::AbstractServer<AbstractZServer> {
                                   Json::Value& response) {
     response = this->GetBalance(request[0u].asString());
   }
+  inline virtual void GetBalanceAtI(const Json::Value& request,
+                                    Json::Value& response) {
+    response =
+        this->GetBalanceAt(request[0u].asString(), request[1u].asString());
+  }
   inline virtual void GetMinimumGasPriceI(const Json::Value& request,
                                           Json::Value& response) {
     (void)request;
@@ -367,10 +445,59 @@ class AbstractZServer : public jsonrpc::AbstractServer<AbstractZServer> {
     (void)request;
     response = this->GetNumTxnsDSEpoch();
   }
+  inline virtual void GetConsensusPhaseStatsI(const Json::Value& request,
+                                              Json::Value& response) {
+    (void)request;
+    response = this->GetConsensusPhaseStats();
+  }
+  inline virtual void GetRpcMethodStatsI(const Json::Value& request,
+                                         Json::Value& response) {
+    (void)request;
+    response = this->GetRpcMethodStats();
+  }
+  inline virtual void GetEpochMetricsI(const Json::Value& request,
+                                       Json::Value& response) {
+    (void)request;
+    response = this->GetEpochMetrics();
+  }
+  inline virtual void GetEpochTimelineI(const Json::Value& request,
+                                        Json::Value& response) {
+    response = this->GetEpochTimeline(request[0u].asString());
+  }
+  inline virtual void GetChromeTraceI(const Json::Value& request,
+                                      Json::Value& response) {
+    (void)request;
+    response = this->GetChromeTrace();
+  }
+  inline virtual void StartProfilerI(const Json::Value& request,
+                                     Json::Value& response) {
+    response = this->StartProfiler(request[0u].asString());
+  }
+  inline virtual void StopProfilerI(const Json::Value& request,
+                                    Json::Value& response) {
+    (void)request;
+    response = this->StopProfiler();
+  }
+  inline virtual void GetMemoryStatsI(const Json::Value& request,
+                                      Json::Value& response) {
+    (void)request;
+    response = this->GetMemoryStats();
+  }
+  inline virtual void GetLockStatsI(const Json::Value& request,
+                                    Json::Value& response) {
+    (void)request;
+    response = this->GetLockStats();
+  }
   inline virtual void GetSmartContractStateI(const Json::Value& request,
                                              Json::Value& response) {
     response = this->GetSmartContractState(request[0u].asString());
   }
+  inline virtual void GetSmartContractSubStateI(const Json::Value& request,
+                                                Json::Value& response) {
+    response = this->GetSmartContractSubState(
+        request[0u].asString(), request[1u].asString(),
+        request[2u].asString(), request[3u].asString());
+  }
   inline virtual void GetSmartContractCodeI(const Json::Value& request,
                                             Json::Value& response) {
     response = this->GetSmartContractCode(request[0u].asString());
@@ -384,14 +511,22 @@ class AbstractZServer : public jsonrpc::AbstractServer<AbstractZServer> {
     response = this->GetTransactionsForTxBlock(request[0u].asString(),
                                                request[1u].asUInt());
   }
+  inline virtual void GetTransactionsForAddressI(const Json::Value& request,
+                                                 Json::Value& response) {
+    response = this->GetTransactionsForAddress(request[0u].asString(),
+                                               request[1u].asString());
+  }
   virtual std::string GetNetworkId() = 0;
   virtual Json::Value CreateTransaction(const Json::Value& param01) = 0;
+  virtual Json::Value CreateTransactionBatch(const Json::Value& param01) = 0;
   virtual Json::Value GetTransaction(const std::string& param01) = 0;
   virtual Json::Value GetDsBlock(const std::string& param01) = 0;
   virtual Json::Value GetTxBlock(const std::string& param01) = 0;
   virtual Json::Value GetLatestDsBlock() = 0;
   virtual Json::Value GetLatestTxBlock() = 0;
   virtual Json::Value GetBalance(const std::string& param01) = 0;
+  virtual Json::Value GetBalanceAt(const std::string& param01,
+                                   const std::string& param02) = 0;
   virtual std::string GetMinimumGasPrice() = 0;
   virtual Json::Value GetSmartContracts(const std::string& param01) = 0;
   virtual std::string GetContractAddressFromTransactionID(
@@ -416,36 +551,110 @@ class AbstractZServer : public jsonrpc::AbstractServer<AbstractZServer> {
   virtual Json::Value GetShardingStructure() = 0;
   virtual std::string GetNumTxnsDSEpoch() = 0;
   virtual std::string GetNumTxnsTxEpoch() = 0;
+  virtual Json::Value GetConsensusPhaseStats() = 0;
+  virtual Json::Value GetRpcMethodStats() = 0;
+  virtual Json::Value GetEpochMetrics() = 0;
+  virtual Json::Value GetEpochTimeline(const std::string& param01) = 0;
+  virtual Json::Value GetChromeTrace() = 0;
+  virtual std::string StartProfiler(const std::string& param01) = 0;
+  virtual Json::Value StopProfiler() = 0;
+  virtual Json::Value GetMemoryStats() = 0;
+  virtual Json::Value GetLockStats() = 0;
   virtual Json::Value GetSmartContractState(const std::string& param01) = 0;
+  virtual Json::Value GetSmartContractSubState(const std::string& param01,
+                                               const std::string& param02,
+                                               const std::string& param03,
+                                               const std::string& param04) = 0;
   virtual Json::Value GetSmartContractInit(const std::string& param01) = 0;
   virtual Json::Value GetSmartContractCode(const std::string& param01) = 0;
   virtual Json::Value GetTransactionsForTxBlock(const std::string& param01,
                                                 unsigned int param02) = 0;
+  virtual Json::Value GetTransactionsForAddress(const std::string& param01,
+                                                const std::string& param02) = 0;
 };
 
 class Server : public AbstractZServer {
   Mediator& m_mediator;
-  std::pair<uint64_t, boost::multiprecision::uint128_t> m_BlockTxPair;
-  std::pair<uint64_t, boost::multiprecision::uint128_t> m_TxBlockCountSumPair;
-  uint64_t m_StartTimeTx;
-  uint64_t m_StartTimeDs;
-  std::pair<uint64_t, CircularArray<std::string>> m_DSBlockCache;
-  std::pair<uint64_t, CircularArray<std::string>> m_TxBlockCache;
   static CircularArray<std::string> m_RecentTransactions;
   static std::mutex m_mutexRecentTxns;
+  static JSONResponseCache& GetResponseCache();
+
+  /// Hashes of the blocks on a listing page, newest first, read from the
+  /// block hash index
+  void GetBlockListingPage(
+      const BlockType& blockType, const uint64_t& currBlockNum,
+      unsigned int page, std::vector<std::pair<uint64_t, BlockHash>>& entries);
+  Json::Value BlockListing(const BlockType& blockType,
+                           const uint64_t& currBlockNum, unsigned int page);
+
+  /// Reads a txn body from the block storage or the historical DB; throws
+  /// JsonRpcException if it is in neither
+  std::shared_ptr<TransactionWithReceipt> FetchTransaction(
+      const TxnHash& tranHash);
+  /// Hashes of the shard's txns in the Tx block; throws JsonRpcException
+  std::vector<TxnHash> GetTranHashesForTxBlock(const std::string& txBlockNum,
+                                               unsigned int shardID);
+
+  /// Results of HandleStreamed, as the methods of the same name return them
+  void StreamTransaction(const std::string& transactionHash,
+                         JSONStreamWriter& writer);
+  void StreamTxBlock(const std::string& blockNum, JSONStreamWriter& writer);
+  void StreamTransactionsForTxBlock(const std::string& txBlockNum,
+                                    unsigned int shardID,
+                                    JSONStreamWriter& writer);
+
+  /// Answers a call JSONTxnParser read, as CreateTransaction and
+  /// CreateTransactionBatch would
+  void StreamCreateTransaction(const JSONTxnParser::Call& call,
+                               std::string& response);
+  /// Writes the reply to a call, with the result written by result or the
+  /// error it threw, and records it in RpcMetrics
+  void WriteStreamed(
+      const std::string& method, const Json::Value& id, std::string& response,
+      const std::function<void(JSONStreamWriter& writer)>& result);
+
+  /// Everything CreateTransaction does once the txn is parsed
+  Json::Value SubmitTransaction(const Transaction& tx);
+  /// Everything CreateTransactionBatch does, with convert(i) parsing the
+  /// i-th of count txns or throwing JsonRpcException
+  Json::Value SubmitTransactionBatch(
+      unsigned int count,
+      const std::function<Transaction(unsigned int)>& convert);
+
+  /// Checks a parsed txn whose signature check gave verified, and picks
+  /// its shard; throws JsonRpcException if the txn is rejected
+  Json::Value CheckTransaction(const Transaction& tx, bool verified,
+                               unsigned int& shard);
 
  public:
-  Server(Mediator& mediator, jsonrpc::HttpServer& httpserver);
+  Server(Mediator& mediator, jsonrpc::AbstractServerConnector& server);
+
+  /// Runs a method, recording its latency and outcome in RpcMetrics
+  void HandleMethodCall(jsonrpc::Procedure& proc, const Json::Value& input,
+                        Json::Value& output) override;
   ~Server();
 
+  /// Answers a single GetTransaction, GetTxBlock or GetTransactionsForTxBlock
+  /// call by writing the response straight into response, without building
+  /// the result as a Json::Value, and CreateTransaction or
+  /// CreateTransactionBatch calls JSONTxnParser can read. Returns false for
+  /// any other request, which is left to the RPC handler.
+  bool HandleStreamed(const std::string& request, std::string& response);
+
   virtual std::string GetNetworkId();
   virtual Json::Value CreateTransaction(const Json::Value& _json);
+  /// Per-txn results, in order; rejected txns get an Error object instead
+  virtual Json::Value CreateTransactionBatch(const Json::Value& _json);
   virtual Json::Value GetTransaction(const std::string& transactionHash);
   virtual Json::Value GetDsBlock(const std::string& blockNum);
   virtual Json::Value GetTxBlock(const std::string& blockNum);
   virtual Json::Value GetLatestDsBlock();
   virtual Json::Value GetLatestTxBlock();
   virtual Json::Value GetBalance(const std::string& address);
+  /// Balance and nonce of address after tx block blockNum, for lookups run
+  /// with STATE_ARCHIVE_MODE
+  virtual Json::Value GetBalanceAt(const std::string& address,
+                                   const std::string& blockNum);
   virtual std::string GetMinimumGasPrice();
   virtual Json::Value GetSmartContracts(const std::string& address);
   virtual std::string GetContractAddressFromTransactionID(
@@ -470,17 +679,40 @@ class Server : public AbstractZServer {
   virtual Json::Value GetShardingStructure();
   virtual std::string GetNumTxnsDSEpoch();
   virtual std::string GetNumTxnsTxEpoch();
+  virtual Json::Value GetConsensusPhaseStats();
+  virtual Json::Value GetRpcMethodStats();
+  virtual Json::Value GetEpochMetrics();
+  /// Returns the timeline events of this node from the given epoch on
+  virtual Json::Value GetEpochTimeline(const std::string& fromEpoch);
+  virtual Json::Value GetChromeTrace();
+  /// Starts the SamplingProfiler at the given number of samples per second
+  virtual std::string StartProfiler(const std::string& frequency);
+  /// Stops the SamplingProfiler and returns the folded stacks it recorded
+  virtual Json::Value StopProfiler();
+  /// Returns the bytes and objects held by each subsystem, and the RSS
+  virtual Json::Value GetMemoryStats();
+  /// Returns the wait and hold times of every ProfiledMutex, by name
+  virtual Json::Value GetLockStats();
   static void AddToRecentTransactions(const dev::h256& txhash);
 
-  // gets the number of transaction starting from block blockNum to most recent
-  // block
-  size_t GetNumTransactions(uint64_t blockNum);
+  /// Builds the GetDsBlock / GetTxBlock responses of a newly committed block
+  /// ahead of the first request for it
+  static void CacheDSBlockResponse(const DSBlock& dsblock);
+  static void CacheTxBlockResponse(const TxBlock& txblock);
 
   bool StartCollectorThread();
 
   Json::Value GetSmartContractState(const std::string& address);
+  /// One page of the state: all fields if vname is empty, otherwise the
+  /// entries of that field whose key starts with keyPrefix
+  Json::Value GetSmartContractSubState(const std::string& address,
+                                       const std::string& vname,
+                                       const std::string& keyPrefix,
+                                       const std::string& cursor);
   Json::Value GetSmartContractInit(const std::string& address);
   Json::Value GetSmartContractCode(const std::string& address);
   Json::Value GetTransactionsForTxBlock(const std::string& txBlockNum,
                                         unsigned int shardID);
+  Json::Value GetTransactionsForAddress(const std::string& address,
+                                        const std::string& cursor);
 };
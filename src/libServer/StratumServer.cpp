@@ -0,0 +1,488 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <errno.h>
+#include <event2/buffer.h>
+#include <event2/bufferevent.h>
+#include <event2/event.h>
+#include <event2/listener.h>
+#include <netinet/in.h>
+#include <unistd.h>
+#include <cstdlib>
+#include <cstring>
+
+#include "depends/libethash/include/ethash/ethash.hpp"
+
+#include "StratumServer.h"
+#include "common/Constants.h"
+#include "libPOW/pow.h"
+#include "libUtils/DataConversion.h"
+#include "libUtils/Logger.h"
+
+using namespace std;
+
+namespace {
+/// Requests are single short JSON lines
+const size_t MAX_LINE_BYTES = 4096;
+const size_t MAX_WORKER_NAME = 128;
+/// Clients that stop reading are dropped past this much queued output
+const size_t MAX_CLIENT_BUFFER_BYTES = 1 << 20;
+
+string ToJsonLine(const Json::Value& _json) {
+  Json::StreamWriterBuilder writeBuilder;
+  writeBuilder["indentation"] = "";
+  return Json::writeString(writeBuilder, _json) + "\n";
+}
+
+Json::Value MakeNotification(const string& method, const Json::Value& params) {
+  Json::Value _json;
+  _json["id"] = Json::nullValue;
+  _json["jsonrpc"] = "2.0";
+  _json["method"] = method;
+  _json["params"] = params;
+  return _json;
+}
+}  // namespace
+
+StratumServer::Client::Client(struct bufferevent* bev)
+    : m_bev(bev),
+      m_authorized(false),
+      m_difficulty(STRATUM_SHARE_DIFFICULTY),
+      m_acceptedShares(0),
+      m_rejectedShares(0) {}
+
+StratumServer::Client::~Client() {
+  if (m_bev != nullptr) {
+    bufferevent_free(m_bev);
+  }
+}
+
+StratumServer::StratumServer()
+    : m_base(nullptr),
+      m_listener(nullptr),
+      m_wakeEvent(nullptr),
+      m_wakePipe{-1, -1},
+      m_running(false),
+      m_stop(false),
+      m_jobCounter(0),
+      m_hasPendingJob(false) {}
+
+StratumServer::~StratumServer() { Stop(); }
+
+StratumServer& StratumServer::GetInstance() {
+  static StratumServer server;
+  return server;
+}
+
+bool StratumServer::Start() {
+  if (m_running) {
+    return true;
+  }
+
+  m_base = event_base_new();
+  if (m_base == nullptr) {
+    LOG_GENERAL(WARNING, "event_base_new failure.");
+    return false;
+  }
+
+  if (pipe(m_wakePipe) != 0) {
+    LOG_GENERAL(WARNING, "pipe failure. Code = " << errno << " Desc: "
+                                                 << std::strerror(errno));
+    m_wakePipe[0] = m_wakePipe[1] = -1;
+    Release();
+    return false;
+  }
+  evutil_make_socket_nonblocking(m_wakePipe[0]);
+  evutil_make_socket_nonblocking(m_wakePipe[1]);
+
+  m_wakeEvent = event_new(m_base, m_wakePipe[0], EV_READ | EV_PERSIST,
+                          WakeCallback, this);
+  event_add(m_wakeEvent, NULL);
+
+  struct sockaddr_in serv_addr;
+  memset(&serv_addr, 0, sizeof(struct sockaddr_in));
+  serv_addr.sin_family = AF_INET;
+  serv_addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  serv_addr.sin_port = htons(STRATUM_SERVER_PORT);
+
+  m_listener = evconnlistener_new_bind(
+      m_base, AcceptCallback, this, LEV_OPT_REUSEABLE | LEV_OPT_CLOSE_ON_FREE,
+      -1, (struct sockaddr*)&serv_addr, sizeof(struct sockaddr_in));
+  if (m_listener == nullptr) {
+    LOG_GENERAL(WARNING, "evconnlistener_new_bind failure on port "
+                             << STRATUM_SERVER_PORT);
+    Release();
+    return false;
+  }
+
+  m_stop = false;
+  m_running = true;
+  m_thread = thread([this]() { event_base_dispatch(m_base); });
+
+  LOG_GENERAL(INFO, "Stratum server listening on port " << STRATUM_SERVER_PORT);
+  return true;
+}
+
+void StratumServer::Stop() {
+  if (!m_running) {
+    return;
+  }
+
+  m_running = false;
+  m_stop = true;
+  Wake();
+  if (m_thread.joinable()) {
+    m_thread.join();
+  }
+
+  m_clients.clear();
+  m_job = Job();
+  {
+    lock_guard<mutex> g(m_mutexPendingJob);
+    m_hasPendingJob = false;
+  }
+  Release();
+}
+
+void StratumServer::Release() {
+  if (m_listener != nullptr) {
+    evconnlistener_free(m_listener);
+    m_listener = nullptr;
+  }
+  if (m_wakeEvent != nullptr) {
+    event_free(m_wakeEvent);
+    m_wakeEvent = nullptr;
+  }
+  for (int& fd : m_wakePipe) {
+    if (fd >= 0) {
+      close(fd);
+      fd = -1;
+    }
+  }
+  if (m_base != nullptr) {
+    event_base_free(m_base);
+    m_base = nullptr;
+  }
+}
+
+void StratumServer::Wake() {
+  // A full pipe means the loop already has a wakeup pending
+  const unsigned char c = 0;
+  [[gnu::unused]] ssize_t n = write(m_wakePipe[1], &c, 1);
+}
+
+void StratumServer::AcceptCallback(
+    [[gnu::unused]] struct evconnlistener* listener, evutil_socket_t fd,
+    [[gnu::unused]] struct sockaddr* addr, [[gnu::unused]] int socklen,
+    void* arg) {
+  StratumServer* self = static_cast<StratumServer*>(arg);
+
+  if (self->m_clients.size() >= STRATUM_MAX_CONNECTIONS) {
+    LOG_GENERAL(WARNING, "Refused a stratum worker, already serving "
+                             << self->m_clients.size());
+    evutil_closesocket(fd);
+    return;
+  }
+
+  struct bufferevent* bev =
+      bufferevent_socket_new(self->m_base, fd, BEV_OPT_CLOSE_ON_FREE);
+  if (bev == nullptr) {
+    LOG_GENERAL(WARNING, "bufferevent_socket_new failure.");
+    evutil_closesocket(fd);
+    return;
+  }
+
+  self->m_clients[bev].reset(new Client(bev));
+  bufferevent_setcb(bev, ReadCallback, NULL, EventCallback, self);
+  bufferevent_enable(bev, EV_READ | EV_WRITE);
+}
+
+void StratumServer::ReadCallback(struct bufferevent* bev, void* arg) {
+  StratumServer* self = static_cast<StratumServer*>(arg);
+
+  auto it = self->m_clients.find(bev);
+  if (it == self->m_clients.end()) {
+    return;
+  }
+  Client& client = *it->second;
+
+  struct evbuffer* input = bufferevent_get_input(bev);
+  while (true) {
+    size_t len = 0;
+    char* line = evbuffer_readln(input, &len, EVBUFFER_EOL_CRLF);
+    if (line == nullptr) {
+      break;
+    }
+    const string request(line, len);
+    free(line);
+
+    if (len > MAX_LINE_BYTES) {
+      self->RemoveClient(bev);
+      return;
+    }
+    if (len > 0) {
+      self->HandleRequest(client, request);
+    }
+  }
+
+  if (evbuffer_get_length(input) > MAX_LINE_BYTES) {
+    LOG_GENERAL(WARNING, "Dropped a stratum worker sending an oversized line");
+    self->RemoveClient(bev);
+  }
+}
+
+void StratumServer::EventCallback(struct bufferevent* bev, short events,
+                                  void* arg) {
+  if (events & (BEV_EVENT_EOF | BEV_EVENT_ERROR)) {
+    static_cast<StratumServer*>(arg)->RemoveClient(bev);
+  }
+}
+
+void StratumServer::HandleRequest(Client& client, const string& line) {
+  Json::Value request;
+  Json::Value reply;
+  reply["jsonrpc"] = "2.0";
+  reply["result"] = false;
+  reply["error"] = Json::nullValue;
+
+  Json::CharReaderBuilder readBuilder;
+  unique_ptr<Json::CharReader> reader(readBuilder.newCharReader());
+  string errors;
+  if (!reader->parse(line.c_str(), line.c_str() + line.size(), &request,
+                     &errors) ||
+      !request.isObject() || !request["method"].isString()) {
+    reply["id"] = Json::nullValue;
+    reply["error"] = "Invalid request";
+    Send(client, reply);
+    return;
+  }
+
+  reply["id"] = request["id"];
+  const string method = request["method"].asString();
+  const Json::Value& params = request["params"];
+  bool sendJob = false;
+
+  if (method == "mining.subscribe") {
+    reply["result"] = true;
+  } else if (method == "mining.authorize") {
+    if (!params.isArray() || params.empty() || !params[0u].isString() ||
+        params[0u].asString().size() > MAX_WORKER_NAME) {
+      reply["error"] = "Invalid worker";
+    } else {
+      client.m_worker = params[0u].asString();
+      client.m_authorized = true;
+      reply["result"] = true;
+      sendJob = m_job.m_active;
+    }
+  } else if (method == "mining.suggest_difficulty") {
+    if (!params.isArray() || params.empty() || !params[0u].isUInt() ||
+        params[0u].asUInt() > UINT8_MAX) {
+      reply["error"] = "Invalid difficulty";
+    } else {
+      // Workers may ask for fewer, harder shares but not for easier ones
+      client.m_difficulty =
+          max<unsigned int>(params[0u].asUInt(), STRATUM_SHARE_DIFFICULTY);
+      reply["result"] = true;
+      sendJob = client.m_authorized && m_job.m_active;
+    }
+  } else if (method == "mining.submit") {
+    string error;
+    if (!client.m_authorized) {
+      reply["error"] = "Unauthorized worker";
+    } else if (Submit(client, params, error)) {
+      client.m_acceptedShares++;
+      reply["result"] = true;
+    } else {
+      client.m_rejectedShares++;
+      reply["error"] = error;
+    }
+  } else {
+    reply["error"] = "Unknown method";
+  }
+
+  Send(client, reply);
+  if (sendJob) {
+    SendJob(client);
+  }
+}
+
+bool StratumServer::Submit(Client& client, const Json::Value& params,
+                           string& error) {
+  if (!params.isArray() || params.size() < 5) {
+    error = "Invalid parameters";
+    return false;
+  }
+  for (unsigned int i = 0; i < 5; i++) {
+    if (!params[i].isString()) {
+      error = "Invalid parameters";
+      return false;
+    }
+  }
+
+  if (!m_job.m_active || params[1u].asString() != m_job.m_id) {
+    error = "Stale job";
+    return false;
+  }
+
+  string nonce = params[2u].asString();
+  string header = params[3u].asString();
+  string mixdigest = params[4u].asString();
+  uint64_t winning_nonce = 0;
+  if (!DataConversion::NormalizeHexString(nonce) ||
+      !DataConversion::NormalizeHexString(header) ||
+      !DataConversion::NormalizeHexString(mixdigest) ||
+      !DataConversion::HexStringToUint64(nonce, &winning_nonce) ||
+      mixdigest.size() != 64) {
+    error = "Invalid parameters";
+    return false;
+  }
+
+  if (header != m_job.m_work.header) {
+    error = "Header does not match the job";
+    return false;
+  }
+
+  const uint8_t shareDifficulty =
+      min(client.m_difficulty, m_job.m_work.difficulty);
+  ethash_hash256 final_result;
+  if (!POW::GetInstance().VerifyRemoteSoln(
+          m_job.m_work.blocknum, POW::DifficultyLevelInInt(shareDifficulty),
+          winning_nonce, POW::StringToBlockhash(header),
+          POW::StringToBlockhash(mixdigest), final_result)) {
+    error = "Low difficulty share";
+    return false;
+  }
+
+  const auto boundary = POW::StringToBlockhash(m_job.m_work.boundary);
+  if (ethash::is_less_or_equal(final_result, boundary)) {
+    LOG_GENERAL(INFO, "Stratum worker " << client.m_worker
+                                        << " found a solution for job "
+                                        << m_job.m_id);
+    GetWorkServer::GetInstance().UpdateCurrentResult(ethash_mining_result_t{
+        POW::BlockhashToHexString(final_result), mixdigest, winning_nonce,
+        true});
+  }
+
+  return true;
+}
+
+void StratumServer::SendJob(Client& client) {
+  const uint8_t shareDifficulty =
+      min(client.m_difficulty, m_job.m_work.difficulty);
+
+  Json::Value target;
+  target.append("0x" + POW::BlockhashToHexString(
+                           POW::DifficultyLevelInInt(shareDifficulty)));
+  Send(client, MakeNotification("mining.set_target", target));
+
+  Json::Value notify;
+  notify.append(m_job.m_id);
+  notify.append("0x" + m_job.m_work.seed);
+  notify.append("0x" + m_job.m_work.header);
+  notify.append(true);
+  Send(client, MakeNotification("mining.notify", notify));
+}
+
+void StratumServer::Send(Client& client, const Json::Value& message) {
+  const string line = ToJsonLine(message);
+  bufferevent_write(client.m_bev, line.data(), line.size());
+}
+
+void StratumServer::RemoveClient(struct bufferevent* bev) {
+  auto it = m_clients.find(bev);
+  if (it == m_clients.end()) {
+    return;
+  }
+  if (it->second->m_authorized) {
+    LOG_GENERAL(INFO, "Stratum worker " << it->second->m_worker
+                                        << " left, shares accepted: "
+                                        << it->second->m_acceptedShares
+                                        << " rejected: "
+                                        << it->second->m_rejectedShares);
+  }
+  m_clients.erase(it);
+}
+
+void StratumServer::WakeCallback(evutil_socket_t fd,
+                                 [[gnu::unused]] short what, void* arg) {
+  StratumServer* self = static_cast<StratumServer*>(arg);
+
+  unsigned char buf[64];
+  while (read(fd, buf, sizeof(buf)) > 0) {
+  }
+
+  if (self->m_stop) {
+    event_base_loopbreak(self->m_base);
+    return;
+  }
+
+  {
+    lock_guard<mutex> g(self->m_mutexPendingJob);
+    if (!self->m_hasPendingJob) {
+      return;
+    }
+    self->m_job = move(self->m_pendingJob);
+    self->m_hasPendingJob = false;
+  }
+
+  if (!self->m_job.m_active) {
+    return;
+  }
+
+  vector<struct bufferevent*> slowClients;
+  for (auto& entry : self->m_clients) {
+    if (evbuffer_get_length(bufferevent_get_output(entry.first)) >
+        MAX_CLIENT_BUFFER_BYTES) {
+      slowClients.emplace_back(entry.first);
+    } else if (entry.second->m_authorized) {
+      self->SendJob(*entry.second);
+    }
+  }
+  for (const auto& bev : slowClients) {
+    LOG_GENERAL(WARNING, "Dropped a stratum worker that is not reading");
+    self->RemoveClient(bev);
+  }
+}
+
+void StratumServer::SetPendingJob(Job&& job) {
+  {
+    lock_guard<mutex> g(m_mutexPendingJob);
+    m_pendingJob = move(job);
+    m_hasPendingJob = true;
+  }
+  Wake();
+}
+
+void StratumServer::PublishWork(const PoWWorkPackage& wp) {
+  if (!m_running) {
+    return;
+  }
+
+  Job job;
+  job.m_active = true;
+  job.m_id = to_string(++m_jobCounter);
+  job.m_work = wp;
+  SetPendingJob(move(job));
+}
+
+void StratumServer::ClearWork() {
+  if (!m_running) {
+    return;
+  }
+
+  SetPendingJob(Job());
+}
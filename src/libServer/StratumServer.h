@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __STRATUMSERVER_H__
+#define __STRATUMSERVER_H__
+
+#include <event2/util.h>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "GetWorkServer.h"
+
+struct event;
+struct event_base;
+struct evconnlistener;
+struct bufferevent;
+
+/// Push counterpart of GetWorkServer, so mining farms get each work package
+/// the moment PoW starts instead of on their next eth_getWork poll.
+///
+/// Workers open a TCP connection on STRATUM_SERVER_PORT and exchange
+/// newline-delimited JSON-RPC:
+///   mining.subscribe []                        -> true
+///   mining.authorize [worker, password]        -> true, then the current job
+///   mining.suggest_difficulty [level]          -> true
+///   mining.submit [worker, jobId, nonce, header, mixhash] -> true if a share
+/// The server pushes mining.set_target [boundary] and
+/// mining.notify [jobId, seed, header, true] for every new work package.
+///
+/// Each worker mines against its own share boundary, STRATUM_SHARE_DIFFICULTY
+/// unless it suggested a harder one, and never harder than the job. Shares
+/// that also meet the job boundary are handed to
+/// GetWorkServer::UpdateCurrentResult.
+///
+/// All sockets are served from one libevent loop thread; PublishWork and
+/// ClearWork can be called from any thread.
+class StratumServer {
+  struct Client {
+    struct bufferevent* m_bev;
+    bool m_authorized;
+    std::string m_worker;
+    uint8_t m_difficulty;
+    uint64_t m_acceptedShares;
+    uint64_t m_rejectedShares;
+
+    explicit Client(struct bufferevent* bev);
+    ~Client();
+  };
+
+  struct Job {
+    bool m_active = false;
+    std::string m_id;
+    PoWWorkPackage m_work;
+  };
+
+  struct event_base* m_base;
+  struct evconnlistener* m_listener;
+  struct event* m_wakeEvent;
+  int m_wakePipe[2];
+  std::atomic<bool> m_running;
+  std::atomic<bool> m_stop;
+  std::atomic<uint64_t> m_jobCounter;
+
+  std::mutex m_mutexPendingJob;
+  bool m_hasPendingJob;
+  Job m_pendingJob;
+
+  /// Only touched from the loop thread
+  Job m_job;
+  std::map<struct bufferevent*, std::unique_ptr<Client>> m_clients;
+
+  std::thread m_thread;
+
+  StratumServer();
+  ~StratumServer();
+
+  StratumServer(StratumServer const&) = delete;
+  void operator=(StratumServer const&) = delete;
+
+  static void AcceptCallback(struct evconnlistener* listener,
+                             evutil_socket_t fd, struct sockaddr* addr,
+                             int socklen, void* arg);
+  static void WakeCallback(evutil_socket_t fd, short what, void* arg);
+  static void ReadCallback(struct bufferevent* bev, void* arg);
+  static void EventCallback(struct bufferevent* bev, short events, void* arg);
+
+  void HandleRequest(Client& client, const std::string& line);
+  bool Submit(Client& client, const Json::Value& params, std::string& error);
+  /// Sends the current job with the client's share boundary
+  void SendJob(Client& client);
+  void Send(Client& client, const Json::Value& message);
+  void RemoveClient(struct bufferevent* bev);
+  void SetPendingJob(Job&& job);
+  void Wake();
+  void Release();
+
+ public:
+  static StratumServer& GetInstance();
+
+  /// Listens on STRATUM_SERVER_PORT; returns false if that is not possible
+  bool Start();
+  void Stop();
+  bool IsRunning() const { return m_running; }
+
+  /// Pushes a new job built from wp to every authorized worker
+  void PublishWork(const PoWWorkPackage& wp);
+  /// Rejects submissions until the next PublishWork
+  void ClearWork();
+};
+
+#endif  // __STRATUMSERVER_H__
@@ -0,0 +1,356 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <arpa/inet.h>
+#include <microhttpd.h>
+#include <netinet/in.h>
+#include <cctype>
+#include <cstring>
+#include <sstream>
+#include <unordered_set>
+
+#include "RpcMetrics.h"
+#include "ThreadedHttpServer.h"
+#include "common/Constants.h"
+#include "libPersistence/BackgroundWriter.h"
+#include "libUtils/AsyncExecutor.h"
+#include "libUtils/EpochMetrics.h"
+#include "libUtils/Logger.h"
+#include "libUtils/Scheduler.h"
+
+using namespace std;
+
+namespace {
+
+#if MHD_VERSION >= 0x00097002
+using MHDResult = enum MHD_Result;
+#else
+using MHDResult = int;
+#endif
+
+enum MethodClass : unsigned int {
+  CHEAP_READ = 0,
+  HEAVY_READ,
+  WRITE,
+  NUM_METHOD_CLASSES
+};
+
+MethodClass GetMethodClass(const string& method) {
+  static const unordered_set<string> heavyReads = {
+      "DSBlockListing",           "TxBlockListing",
+      "GetSmartContractState",    "GetSmartContractSubState",
+      "GetSmartContracts",        "GetTransactionsForTxBlock",
+      "GetTransactionsForAddress", "GetShardingStructure",
+      "GetRecentTransactions",    "GetBlockchainInfo",
+      "GetGasEstimate",           "GetMemoryStats",
+      "GetLockStats",             "GetEpochTimeline"};
+  static const unordered_set<string> writes = {
+      "CreateTransaction", "CreateTransactionBatch", "CreateMessage",
+      "eth_submitWork", "eth_submitHashrate", "StartProfiler",
+      "StopProfiler"};
+
+  if (heavyReads.count(method) > 0) {
+    return HEAVY_READ;
+  }
+  if (writes.count(method) > 0) {
+    return WRITE;
+  }
+  return CHEAP_READ;
+}
+
+/// Counts the calls of a single or batch request by method class. The body
+/// is scanned for "method" keys rather than parsed, as the RPC handler
+/// parses it anyway; a body without any is charged as one cheap read.
+vector<unsigned int> CountCalls(const string& request) {
+  vector<unsigned int> calls(NUM_METHOD_CLASSES, 0);
+  bool found = false;
+
+  static const string key = "\"method\"";
+  for (size_t pos = request.find(key); pos != string::npos;
+       pos = request.find(key, pos + key.size())) {
+    size_t i = pos + key.size();
+    while (i < request.size() && isspace((unsigned char)request[i])) {
+      i++;
+    }
+    if (i >= request.size() || request[i] != ':') {
+      continue;
+    }
+    i++;
+    while (i < request.size() && isspace((unsigned char)request[i])) {
+      i++;
+    }
+    if (i >= request.size() || request[i] != '"') {
+      continue;
+    }
+    const size_t end = request.find('"', i + 1);
+    if (end == string::npos) {
+      break;
+    }
+    calls[GetMethodClass(request.substr(i + 1, end - i - 1))]++;
+    found = true;
+  }
+
+  if (!found) {
+    calls[CHEAP_READ]++;
+  }
+  return calls;
+}
+
+string ClientAddress(MHD_Connection* connection) {
+  const union MHD_ConnectionInfo* info =
+      MHD_get_connection_info(connection, MHD_CONNECTION_INFO_CLIENT_ADDRESS);
+  if (info == nullptr || info->client_addr == nullptr) {
+    return "";
+  }
+
+  char buf[INET6_ADDRSTRLEN] = {0};
+  const struct sockaddr* addr = info->client_addr;
+  if (addr->sa_family == AF_INET) {
+    inet_ntop(AF_INET, &((const struct sockaddr_in*)addr)->sin_addr, buf,
+              sizeof(buf));
+  } else if (addr->sa_family == AF_INET6) {
+    inet_ntop(AF_INET6, &((const struct sockaddr_in6*)addr)->sin6_addr, buf,
+              sizeof(buf));
+  }
+  return buf;
+}
+
+string ErrorResponse(const string& message) {
+  return R"({"jsonrpc":"2.0","id":null,"error":{"code":-32005,"message":")" +
+         message + R"("}})";
+}
+
+/// Body of a request still being uploaded
+struct PendingRequest {
+  string m_body;
+  bool m_tooLarge = false;
+};
+
+MHDResult SendReply(MHD_Connection* connection, unsigned int status,
+                    const string& body, bool preflight = false,
+                    const char* contentType = "application/json") {
+  MHD_Response* response = MHD_create_response_from_buffer(
+      body.size(), (void*)body.data(), MHD_RESPMEM_MUST_COPY);
+  if (response == nullptr) {
+    return MHD_NO;
+  }
+  MHD_add_response_header(response, "Content-Type", contentType);
+  // Browser wallets call from other origins
+  MHD_add_response_header(response, "Access-Control-Allow-Origin", "*");
+  if (preflight) {
+    MHD_add_response_header(response, "Access-Control-Allow-Methods",
+                            "POST, OPTIONS");
+    MHD_add_response_header(response, "Access-Control-Allow-Headers",
+                            "Content-Type");
+  }
+  const MHDResult ret = (MHDResult)MHD_queue_response(connection, status,
+                                                      response);
+  MHD_destroy_response(response);
+  return ret;
+}
+
+MHDResult AccessHandler(void* cls, MHD_Connection* connection,
+                        const char* url, const char* method,
+                        [[gnu::unused]] const char* version,
+                        const char* uploadData, size_t* uploadDataSize,
+                        void** conCls) {
+  auto* server = static_cast<ThreadedHttpServer*>(cls);
+
+  if (*conCls == nullptr) {
+    *conCls = new PendingRequest();
+    return MHD_YES;
+  }
+  auto* request = static_cast<PendingRequest*>(*conCls);
+
+  if (*uploadDataSize > 0) {
+    // Keep reading a body that is too large, so the reply is not cut off
+    if (request->m_tooLarge ||
+        request->m_body.size() + *uploadDataSize >
+            server->GetMaxRequestBytes()) {
+      request->m_tooLarge = true;
+      request->m_body.clear();
+    } else {
+      request->m_body.append(uploadData, *uploadDataSize);
+    }
+    *uploadDataSize = 0;
+    return MHD_YES;
+  }
+
+  if (strcmp(method, "OPTIONS") == 0) {
+    return SendReply(connection, MHD_HTTP_OK, "", true);
+  }
+  if (server->GetServeMetrics() && strcmp(method, MHD_HTTP_METHOD_GET) == 0 &&
+      strcmp(url, "/metrics") == 0) {
+    return SendReply(connection, MHD_HTTP_OK, server->GetMetricsText(), false,
+                     "text/plain; version=0.0.4");
+  }
+  if (strcmp(method, MHD_HTTP_METHOD_POST) != 0) {
+    return SendReply(connection, MHD_HTTP_METHOD_NOT_ALLOWED, "");
+  }
+  if (request->m_tooLarge) {
+    LOG_GENERAL(WARNING, "Refused a request body over "
+                             << server->GetMaxRequestBytes() << " bytes");
+    return SendReply(connection, 413, "");
+  }
+
+  string response;
+  const unsigned int status =
+      server->Serve(ClientAddress(connection), request->m_body, response);
+  return SendReply(connection, status, response);
+}
+
+void RequestCompleted([[gnu::unused]] void* cls,
+                      [[gnu::unused]] MHD_Connection* connection,
+                      void** conCls,
+                      [[gnu::unused]] enum MHD_RequestTerminationCode code) {
+  delete static_cast<PendingRequest*>(*conCls);
+  *conCls = nullptr;
+}
+
+}  // namespace
+
+ThreadedHttpServer::ThreadedHttpServer(unsigned int port,
+                                       unsigned int threads,
+                                       unsigned int maxConnections,
+                                       unsigned int keepAliveTimeout,
+                                       size_t maxRequestBytes,
+                                       unsigned int maxInFlight)
+    : m_port(port),
+      m_threads(threads),
+      m_maxConnections(maxConnections),
+      m_keepAliveTimeout(keepAliveTimeout),
+      m_maxRequestBytes(maxRequestBytes),
+      m_maxInFlight(maxInFlight),
+      m_daemon(nullptr),
+      m_serveMetrics(false),
+      m_rateLimiter(
+          {{static_cast<double>(RPC_CHEAP_READ_RATE),
+            static_cast<double>(RPC_CHEAP_READ_BURST)},
+           {static_cast<double>(RPC_HEAVY_READ_RATE),
+            static_cast<double>(RPC_HEAVY_READ_BURST)},
+           {static_cast<double>(RPC_WRITE_RATE),
+            static_cast<double>(RPC_WRITE_BURST)}},
+          RPC_RATE_LIMIT_MAX_CLIENTS),
+      m_inFlight(0),
+      m_busyRejected(0) {}
+
+ThreadedHttpServer::~ThreadedHttpServer() { StopListening(); }
+
+bool ThreadedHttpServer::StartListening() {
+  if (m_daemon != nullptr) {
+    return true;
+  }
+
+  unsigned int flags = MHD_USE_SELECT_INTERNALLY;
+#ifdef __linux__
+  // select() cannot go past FD_SETSIZE connections
+  flags |= MHD_USE_EPOLL_LINUX_ONLY;
+#endif
+
+  m_daemon = MHD_start_daemon(
+      flags, m_port, nullptr, nullptr, &AccessHandler, this,
+      MHD_OPTION_THREAD_POOL_SIZE, m_threads, MHD_OPTION_CONNECTION_LIMIT,
+      m_maxConnections, MHD_OPTION_CONNECTION_TIMEOUT, m_keepAliveTimeout,
+      MHD_OPTION_NOTIFY_COMPLETED, &RequestCompleted, nullptr,
+      MHD_OPTION_END);
+  if (m_daemon == nullptr) {
+    LOG_GENERAL(WARNING, "Cannot start the HTTP server on port " << m_port);
+    return false;
+  }
+
+  LOG_GENERAL(INFO, "HTTP server on port " << m_port << " with " << m_threads
+                                           << " threads");
+  return true;
+}
+
+bool ThreadedHttpServer::StopListening() {
+  if (m_daemon != nullptr) {
+    MHD_stop_daemon(m_daemon);
+    m_daemon = nullptr;
+  }
+  return true;
+}
+
+#if JSONRPC_CPP_MAJOR_VERSION < 1
+bool ThreadedHttpServer::SendResponse(const string& response, void* addInfo) {
+  *static_cast<string*>(addInfo) = response;
+  return true;
+}
+#endif
+
+unsigned int ThreadedHttpServer::Serve(const string& client,
+                                       const string& request,
+                                       string& response) {
+  if (!m_rateLimiter.Admit(client, CountCalls(request))) {
+    if (m_rateLimiter.GetRejected() % 1000 == 1) {
+      LOG_GENERAL(WARNING, "Rate limited " << m_rateLimiter.GetRejected()
+                                           << " requests so far, latest from "
+                                           << client);
+    }
+    response = ErrorResponse("Rate limit exceeded");
+    return 429;
+  }
+
+  if (m_maxInFlight > 0 && ++m_inFlight > m_maxInFlight) {
+    m_inFlight--;
+    if (++m_busyRejected % 1000 == 1) {
+      LOG_GENERAL(WARNING, "Refused " << m_busyRejected
+                                      << " requests so far with "
+                                      << m_maxInFlight << " in flight");
+    }
+    response = ErrorResponse("Server busy");
+    return MHD_HTTP_SERVICE_UNAVAILABLE;
+  }
+
+  Handle(request, response);
+
+  if (m_maxInFlight > 0) {
+    m_inFlight--;
+  }
+  return MHD_HTTP_OK;
+}
+
+string ThreadedHttpServer::GetMetricsText() {
+  ostringstream text;
+  text << RpcMetrics::GetInstance().GetPrometheusText()
+       << "# HELP zilliqa_rpc_rate_limited_total Requests refused with 429.\n"
+       << "# TYPE zilliqa_rpc_rate_limited_total counter\n"
+       << "zilliqa_rpc_rate_limited_total " << m_rateLimiter.GetRejected()
+       << "\n"
+       << "# HELP zilliqa_rpc_busy_total Requests refused with 503.\n"
+       << "# TYPE zilliqa_rpc_busy_total counter\n"
+       << "zilliqa_rpc_busy_total " << m_busyRejected << "\n"
+       << "# HELP zilliqa_rpc_in_flight Requests being processed.\n"
+       << "# TYPE zilliqa_rpc_in_flight gauge\n"
+       << "zilliqa_rpc_in_flight " << m_inFlight << "\n"
+       << EpochMetrics::GetInstance().GetPrometheusText()
+       << AsyncExecutor::GetInstance().GetPrometheusText()
+       << BackgroundWriter::GetInstance().GetPrometheusText()
+       << Scheduler::GetInstance().GetPrometheusText();
+  return text.str();
+}
+
+void ThreadedHttpServer::Handle(const string& request, string& response) {
+  if (m_streamHandler && m_streamHandler(request, response)) {
+    return;
+  }
+#if JSONRPC_CPP_MAJOR_VERSION >= 1
+  ProcessRequest(request, response);
+#else
+  OnRequest(request, &response);
+#endif
+}
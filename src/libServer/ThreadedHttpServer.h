@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __THREADEDHTTPSERVER_H__
+#define __THREADEDHTTPSERVER_H__
+
+#include <jsonrpccpp/server/abstractserverconnector.h>
+#include <jsonrpccpp/version.h>
+#include <atomic>
+#include <functional>
+#include <string>
+
+#include "libUtils/RateLimiter.h"
+
+struct MHD_Daemon;
+
+/// HTTP connector for the JSON-RPC server, on a libmicrohttpd thread pool.
+/// Connections are kept alive, with pipelined requests answered in order,
+/// until idle for the keep-alive timeout. Request bodies larger than
+/// maxRequestBytes are refused with 413, which also caps the size of a batch.
+///
+/// Every call in a request is charged to the client IP's token bucket for
+/// its method class (cheap read, heavy read or write, see RPC_*_RATE). A
+/// request over the limits gets 429, and one arriving while maxInFlight
+/// requests are running gets 503, without reaching the RPC handler.
+///
+/// If enabled, GET /metrics returns RpcMetrics, the refusal counts and
+/// EpochMetrics in the Prometheus text format.
+class ThreadedHttpServer : public jsonrpc::AbstractServerConnector {
+  const unsigned int m_port;
+  const unsigned int m_threads;
+  const unsigned int m_maxConnections;
+  const unsigned int m_keepAliveTimeout;
+  const size_t m_maxRequestBytes;
+  const unsigned int m_maxInFlight;
+  MHD_Daemon* m_daemon;
+  bool m_serveMetrics;
+
+  std::function<bool(const std::string&, std::string&)> m_streamHandler;
+
+  RateLimiter m_rateLimiter;
+  std::atomic<unsigned int> m_inFlight;
+  std::atomic<uint64_t> m_busyRejected;
+
+  /// Runs a request body, single or batch, through the RPC handler
+  void Handle(const std::string& request, std::string& response);
+
+ public:
+  ThreadedHttpServer(unsigned int port, unsigned int threads,
+                     unsigned int maxConnections,
+                     unsigned int keepAliveTimeout, size_t maxRequestBytes,
+                     unsigned int maxInFlight);
+  ~ThreadedHttpServer();
+
+  bool StartListening() override;
+  bool StopListening() override;
+
+#if JSONRPC_CPP_MAJOR_VERSION < 1
+  /// addInfo is the response string of the request being handled
+  bool SendResponse(const std::string& response,
+                    void* addInfo = NULL) override;
+#endif
+
+  /// Admits and runs a request from the client; returns the HTTP status
+  unsigned int Serve(const std::string& client, const std::string& request,
+                     std::string& response);
+
+  size_t GetMaxRequestBytes() const { return m_maxRequestBytes; }
+
+  /// Gives handler the first go at every request it admitted; one that
+  /// returns false leaves the request to the RPC handler. Must be called
+  /// before StartListening.
+  void SetStreamHandler(
+      const std::function<bool(const std::string& request,
+                               std::string& response)>& handler) {
+    m_streamHandler = handler;
+  }
+
+  /// Must be called before StartListening
+  void SetServeMetrics(bool serveMetrics) { m_serveMetrics = serveMetrics; }
+  bool GetServeMetrics() const { return m_serveMetrics; }
+
+  /// Returns the body of GET /metrics
+  std::string GetMetricsText();
+};
+
+#endif  // __THREADEDHTTPSERVER_H__
@@ -0,0 +1,637 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <errno.h>
+#include <event2/buffer.h>
+#include <event2/bufferevent.h>
+#include <event2/event.h>
+#include <event2/listener.h>
+#include <netinet/in.h>
+#include <openssl/evp.h>
+#include <openssl/sha.h>
+#include <unistd.h>
+#include <boost/algorithm/string.hpp>
+#include <cstring>
+#include <iterator>
+
+#include "JSONConversion.h"
+#include "WebSocketServer.h"
+#include "common/Constants.h"
+#include "libData/AccountData/Account.h"
+#include "libUtils/DataConversion.h"
+#include "libUtils/Logger.h"
+
+using namespace std;
+
+namespace {
+const char* const WEBSOCKET_GUID = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+
+/// Handshakes and subscription requests are small
+const size_t MAX_HANDSHAKE_BYTES = 8192;
+const size_t MAX_MESSAGE_BYTES = 65536;
+const size_t MAX_ADDRESSES_PER_CLIENT = 1000;
+
+enum Opcode : uint8_t {
+  OP_CONTINUATION = 0x0,
+  OP_TEXT = 0x1,
+  OP_CLOSE = 0x8,
+  OP_PING = 0x9,
+  OP_PONG = 0xA
+};
+
+enum CloseCode : uint16_t {
+  CLOSE_NORMAL = 1000,
+  CLOSE_PROTOCOL_ERROR = 1002,
+  CLOSE_UNSUPPORTED = 1003,
+  CLOSE_TOO_BIG = 1009
+};
+
+/// Server frames are never masked or fragmented
+string MakeFrame(uint8_t opcode, const string& payload) {
+  string frame;
+  frame.reserve(payload.size() + 10);
+  frame.push_back(static_cast<char>(0x80 | opcode));
+
+  const uint64_t len = payload.size();
+  if (len < 126) {
+    frame.push_back(static_cast<char>(len));
+  } else if (len <= 0xFFFF) {
+    frame.push_back(126);
+    frame.push_back(static_cast<char>(len >> 8));
+    frame.push_back(static_cast<char>(len));
+  } else {
+    frame.push_back(127);
+    for (int shift = 56; shift >= 0; shift -= 8) {
+      frame.push_back(static_cast<char>(len >> shift));
+    }
+  }
+
+  frame += payload;
+  return frame;
+}
+
+string MakeTextFrame(const Json::Value& _json) {
+  Json::StreamWriterBuilder writeBuilder;
+  writeBuilder["indentation"] = "";
+  return MakeFrame(OP_TEXT, Json::writeString(writeBuilder, _json));
+}
+
+string AcceptKey(const string& key) {
+  const string source = key + WEBSOCKET_GUID;
+  unsigned char digest[SHA_DIGEST_LENGTH];
+  SHA1(reinterpret_cast<const unsigned char*>(source.data()), source.size(),
+       digest);
+
+  unsigned char encoded[4 * ((SHA_DIGEST_LENGTH + 2) / 3) + 1];
+  EVP_EncodeBlock(encoded, digest, SHA_DIGEST_LENGTH);
+  return string(reinterpret_cast<char*>(encoded));
+}
+}  // namespace
+
+WebSocketServer::Client::Client(struct bufferevent* bev)
+    : m_bev(bev), m_upgraded(false), m_closing(false), m_newBlocks(false) {}
+
+WebSocketServer::Client::~Client() {
+  if (m_bev != nullptr) {
+    bufferevent_free(m_bev);
+  }
+}
+
+WebSocketServer::WebSocketServer()
+    : m_base(nullptr),
+      m_listener(nullptr),
+      m_wakeEvent(nullptr),
+      m_wakePipe{-1, -1},
+      m_running(false),
+      m_stop(false),
+      m_eventLogClients(0) {}
+
+WebSocketServer::~WebSocketServer() { Stop(); }
+
+WebSocketServer& WebSocketServer::GetInstance() {
+  static WebSocketServer server;
+  return server;
+}
+
+bool WebSocketServer::Start() {
+  if (m_running) {
+    return true;
+  }
+
+  m_base = event_base_new();
+  if (m_base == nullptr) {
+    LOG_GENERAL(WARNING, "event_base_new failure.");
+    return false;
+  }
+
+  if (pipe(m_wakePipe) != 0) {
+    LOG_GENERAL(WARNING, "pipe failure. Code = " << errno << " Desc: "
+                                                 << std::strerror(errno));
+    m_wakePipe[0] = m_wakePipe[1] = -1;
+    Release();
+    return false;
+  }
+  evutil_make_socket_nonblocking(m_wakePipe[0]);
+  evutil_make_socket_nonblocking(m_wakePipe[1]);
+
+  m_wakeEvent = event_new(m_base, m_wakePipe[0], EV_READ | EV_PERSIST,
+                          WakeCallback, this);
+  event_add(m_wakeEvent, NULL);
+
+  struct sockaddr_in serv_addr;
+  memset(&serv_addr, 0, sizeof(struct sockaddr_in));
+  serv_addr.sin_family = AF_INET;
+  serv_addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  serv_addr.sin_port = htons(WEBSOCKET_PORT);
+
+  m_listener = evconnlistener_new_bind(
+      m_base, AcceptCallback, this, LEV_OPT_REUSEABLE | LEV_OPT_CLOSE_ON_FREE,
+      -1, (struct sockaddr*)&serv_addr, sizeof(struct sockaddr_in));
+  if (m_listener == nullptr) {
+    LOG_GENERAL(WARNING, "evconnlistener_new_bind failure on port "
+                             << WEBSOCKET_PORT);
+    Release();
+    return false;
+  }
+
+  m_stop = false;
+  m_running = true;
+  m_thread = thread([this]() { event_base_dispatch(m_base); });
+
+  LOG_GENERAL(INFO, "WebSocket server listening on port " << WEBSOCKET_PORT);
+  return true;
+}
+
+void WebSocketServer::Stop() {
+  if (!m_running) {
+    return;
+  }
+
+  m_running = false;
+  m_stop = true;
+  Wake();
+  if (m_thread.joinable()) {
+    m_thread.join();
+  }
+
+  m_clients.clear();
+  m_eventLogClients = 0;
+  {
+    lock_guard<mutex> g(m_mutexPending);
+    m_pending.clear();
+  }
+  Release();
+}
+
+void WebSocketServer::Release() {
+  if (m_listener != nullptr) {
+    evconnlistener_free(m_listener);
+    m_listener = nullptr;
+  }
+  if (m_wakeEvent != nullptr) {
+    event_free(m_wakeEvent);
+    m_wakeEvent = nullptr;
+  }
+  for (int& fd : m_wakePipe) {
+    if (fd >= 0) {
+      close(fd);
+      fd = -1;
+    }
+  }
+  if (m_base != nullptr) {
+    event_base_free(m_base);
+    m_base = nullptr;
+  }
+}
+
+void WebSocketServer::Wake() {
+  // A full pipe means the loop already has a wakeup pending
+  const unsigned char c = 0;
+  [[gnu::unused]] ssize_t n = write(m_wakePipe[1], &c, 1);
+}
+
+void WebSocketServer::AcceptCallback(
+    [[gnu::unused]] struct evconnlistener* listener, evutil_socket_t fd,
+    [[gnu::unused]] struct sockaddr* addr, [[gnu::unused]] int socklen,
+    void* arg) {
+  WebSocketServer* self = static_cast<WebSocketServer*>(arg);
+
+  if (self->m_clients.size() >= WEBSOCKET_MAX_CONNECTIONS) {
+    LOG_GENERAL(WARNING, "Refused a WebSocket client, already serving "
+                             << self->m_clients.size());
+    evutil_closesocket(fd);
+    return;
+  }
+
+  struct bufferevent* bev =
+      bufferevent_socket_new(self->m_base, fd, BEV_OPT_CLOSE_ON_FREE);
+  if (bev == nullptr) {
+    LOG_GENERAL(WARNING, "bufferevent_socket_new failure.");
+    evutil_closesocket(fd);
+    return;
+  }
+
+  self->m_clients[bev].reset(new Client(bev));
+  bufferevent_setcb(bev, ReadCallback, WriteCallback, EventCallback, self);
+  bufferevent_enable(bev, EV_READ | EV_WRITE);
+}
+
+void WebSocketServer::ReadCallback(struct bufferevent* bev, void* arg) {
+  WebSocketServer* self = static_cast<WebSocketServer*>(arg);
+
+  auto it = self->m_clients.find(bev);
+  if (it == self->m_clients.end()) {
+    return;
+  }
+  Client& client = *it->second;
+
+  // Upgrade drops the client if the handshake is too large
+  if (!client.m_upgraded && !self->Upgrade(client)) {
+    return;
+  }
+
+  while (!client.m_closing && self->ReadFrame(client)) {
+  }
+}
+
+void WebSocketServer::WriteCallback(struct bufferevent* bev, void* arg) {
+  WebSocketServer* self = static_cast<WebSocketServer*>(arg);
+
+  // Output is flushed; a closing client can go now
+  auto it = self->m_clients.find(bev);
+  if (it != self->m_clients.end() && it->second->m_closing) {
+    self->RemoveClient(bev);
+  }
+}
+
+void WebSocketServer::EventCallback(struct bufferevent* bev, short events,
+                                    void* arg) {
+  if (events & (BEV_EVENT_EOF | BEV_EVENT_ERROR)) {
+    static_cast<WebSocketServer*>(arg)->RemoveClient(bev);
+  }
+}
+
+bool WebSocketServer::Upgrade(Client& client) {
+  struct evbuffer* input = bufferevent_get_input(client.m_bev);
+
+  struct evbuffer_ptr end = evbuffer_search(input, "\r\n\r\n", 4, NULL);
+  if (end.pos < 0) {
+    if (evbuffer_get_length(input) > MAX_HANDSHAKE_BYTES) {
+      RemoveClient(client.m_bev);
+    }
+    return false;
+  }
+
+  string request(end.pos + 4, '\0');
+  evbuffer_remove(input, &request[0], request.size());
+
+  vector<string> lines;
+  boost::split(lines, request, boost::is_any_of("\r\n"),
+               boost::token_compress_on);
+
+  string key;
+  bool websocket = false;
+  for (const auto& line : lines) {
+    const auto colon = line.find(':');
+    if (colon == string::npos) {
+      continue;
+    }
+    const string name =
+        boost::to_lower_copy(boost::trim_copy(line.substr(0, colon)));
+    const string value = boost::trim_copy(line.substr(colon + 1));
+    if (name == "sec-websocket-key") {
+      key = value;
+    } else if (name == "upgrade") {
+      websocket = boost::iequals(value, "websocket");
+    }
+  }
+
+  if (key.empty() || !websocket || !boost::starts_with(request, "GET ")) {
+    const string reply =
+        "HTTP/1.1 400 Bad Request\r\n"
+        "Connection: close\r\n"
+        "Content-Length: 0\r\n\r\n";
+    bufferevent_write(client.m_bev, reply.data(), reply.size());
+    bufferevent_disable(client.m_bev, EV_READ);
+    client.m_closing = true;
+    return false;
+  }
+
+  const string reply =
+      "HTTP/1.1 101 Switching Protocols\r\n"
+      "Upgrade: websocket\r\n"
+      "Connection: Upgrade\r\n"
+      "Sec-WebSocket-Accept: " +
+      AcceptKey(key) + "\r\n\r\n";
+  bufferevent_write(client.m_bev, reply.data(), reply.size());
+  client.m_upgraded = true;
+  return true;
+}
+
+bool WebSocketServer::ReadFrame(Client& client) {
+  struct evbuffer* input = bufferevent_get_input(client.m_bev);
+  const size_t available = evbuffer_get_length(input);
+  if (available < 2) {
+    return false;
+  }
+
+  unsigned char header[14];
+  evbuffer_copyout(input, header, min(available, sizeof(header)));
+
+  const bool fin = (header[0] & 0x80) != 0;
+  const uint8_t opcode = header[0] & 0x0F;
+
+  // Clients must mask every frame
+  if ((header[1] & 0x80) == 0) {
+    Close(client, CLOSE_PROTOCOL_ERROR);
+    return false;
+  }
+
+  uint64_t len = header[1] & 0x7F;
+  size_t headerLen = 2;
+  if (len == 126) {
+    headerLen = 4;
+  } else if (len == 127) {
+    headerLen = 10;
+  }
+  if (available < headerLen + 4) {
+    return false;
+  }
+
+  if (len == 126) {
+    len = (header[2] << 8) | header[3];
+  } else if (len == 127) {
+    len = 0;
+    for (size_t i = 2; i < 10; i++) {
+      len = (len << 8) | header[i];
+    }
+  }
+  if (len > MAX_MESSAGE_BYTES) {
+    Close(client, CLOSE_TOO_BIG);
+    return false;
+  }
+
+  unsigned char mask[4];
+  memcpy(mask, header + headerLen, sizeof(mask));
+  headerLen += sizeof(mask);
+  if (available < headerLen + len) {
+    return false;
+  }
+
+  evbuffer_drain(input, headerLen);
+  string payload(len, '\0');
+  if (len > 0) {
+    evbuffer_remove(input, &payload[0], len);
+  }
+  for (size_t i = 0; i < payload.size(); i++) {
+    payload[i] ^= mask[i % 4];
+  }
+
+  switch (opcode) {
+    case OP_TEXT:
+    case OP_CONTINUATION:
+      client.m_message += payload;
+      if (client.m_message.size() > MAX_MESSAGE_BYTES) {
+        Close(client, CLOSE_TOO_BIG);
+        return false;
+      }
+      if (fin) {
+        string message;
+        message.swap(client.m_message);
+        HandleMessage(client, message);
+      }
+      return true;
+    case OP_PING:
+      Send(client, MakeFrame(OP_PONG, payload));
+      return true;
+    case OP_PONG:
+      return true;
+    case OP_CLOSE:
+      Close(client, CLOSE_NORMAL);
+      return false;
+    default:
+      Close(client, CLOSE_UNSUPPORTED);
+      return false;
+  }
+}
+
+void WebSocketServer::HandleMessage(Client& client, const string& message) {
+  Json::Value request;
+  Json::Value reply;
+
+  Json::CharReaderBuilder readBuilder;
+  unique_ptr<Json::CharReader> reader(readBuilder.newCharReader());
+  string errors;
+  if (!reader->parse(message.c_str(), message.c_str() + message.size(),
+                     &request, &errors) ||
+      !request.isObject() || !request["query"].isString()) {
+    reply["error"] = "Invalid query";
+    Send(client, MakeTextFrame(reply));
+    return;
+  }
+
+  const string query = request["query"].asString();
+  const bool hadAddresses = !client.m_addresses.empty();
+  reply["query"] = query;
+
+  if (query == "NewBlock") {
+    client.m_newBlocks = true;
+  } else if (query == "EventLog") {
+    if (!request["addresses"].isArray()) {
+      reply["error"] = "Expected an array of addresses";
+    }
+    for (const auto& address : request["addresses"]) {
+      bytes tmpaddr;
+      if (!address.isString() ||
+          address.asString().size() != ACC_ADDR_SIZE * 2 ||
+          !DataConversion::HexStrToUint8Vec(address.asString(), tmpaddr)) {
+        reply["error"] = "Invalid address";
+        break;
+      }
+      if (client.m_addresses.size() >= MAX_ADDRESSES_PER_CLIENT) {
+        reply["error"] = "Too many addresses";
+        break;
+      }
+      client.m_addresses.emplace(tmpaddr);
+    }
+  } else if (query == "Unsubscribe") {
+    const string type = request["type"].isString()
+                            ? request["type"].asString()
+                            : string();
+    if (type == "NewBlock") {
+      client.m_newBlocks = false;
+    } else if (type == "EventLog") {
+      client.m_addresses.clear();
+    } else {
+      reply["error"] = "Unknown subscription type";
+    }
+  } else {
+    reply["error"] = "Unknown query";
+  }
+
+  if (hadAddresses && client.m_addresses.empty()) {
+    m_eventLogClients--;
+  } else if (!hadAddresses && !client.m_addresses.empty()) {
+    m_eventLogClients++;
+  }
+
+  Send(client, MakeTextFrame(reply));
+}
+
+void WebSocketServer::Send(Client& client, const string& frame) {
+  bufferevent_write(client.m_bev, frame.data(), frame.size());
+}
+
+void WebSocketServer::Close(Client& client, uint16_t code) {
+  if (client.m_closing) {
+    return;
+  }
+
+  const string payload{static_cast<char>(code >> 8),
+                       static_cast<char>(code & 0xFF)};
+  Send(client, MakeFrame(OP_CLOSE, payload));
+  bufferevent_disable(client.m_bev, EV_READ);
+  client.m_closing = true;
+}
+
+void WebSocketServer::RemoveClient(struct bufferevent* bev) {
+  auto it = m_clients.find(bev);
+  if (it == m_clients.end()) {
+    return;
+  }
+  if (!it->second->m_addresses.empty()) {
+    m_eventLogClients--;
+  }
+  m_clients.erase(it);
+}
+
+void WebSocketServer::WakeCallback(evutil_socket_t fd,
+                                   [[gnu::unused]] short what, void* arg) {
+  WebSocketServer* self = static_cast<WebSocketServer*>(arg);
+
+  unsigned char buf[64];
+  while (read(fd, buf, sizeof(buf)) > 0) {
+  }
+
+  if (self->m_stop) {
+    event_base_loopbreak(self->m_base);
+    return;
+  }
+
+  vector<Notification> pending;
+  {
+    lock_guard<mutex> g(self->m_mutexPending);
+    pending.swap(self->m_pending);
+  }
+
+  for (const auto& notification : pending) {
+    for (auto& entry : self->m_clients) {
+      Client& client = *entry.second;
+      if (!client.m_upgraded || client.m_closing) {
+        continue;
+      }
+
+      bool wanted = client.m_newBlocks;
+      if (!notification.m_isBlock) {
+        wanted = false;
+        for (const auto& address : notification.m_addresses) {
+          if (client.m_addresses.count(address) > 0) {
+            wanted = true;
+            break;
+          }
+        }
+      }
+
+      if (wanted) {
+        self->Send(client, notification.m_frame);
+      }
+    }
+  }
+
+  vector<struct bufferevent*> slowClients;
+  for (const auto& entry : self->m_clients) {
+    if (evbuffer_get_length(bufferevent_get_output(entry.first)) >
+        WEBSOCKET_MAX_CLIENT_BUFFER_BYTES) {
+      slowClients.emplace_back(entry.first);
+    }
+  }
+  for (const auto& bev : slowClients) {
+    LOG_GENERAL(WARNING, "Dropped a WebSocket client that is not reading");
+    self->RemoveClient(bev);
+  }
+}
+
+void WebSocketServer::Publish(vector<Notification>&& notifications) {
+  bool wasEmpty = false;
+  {
+    lock_guard<mutex> g(m_mutexPending);
+    wasEmpty = m_pending.empty();
+    move(notifications.begin(), notifications.end(),
+         back_inserter(m_pending));
+  }
+
+  if (wasEmpty) {
+    Wake();
+  }
+}
+
+void WebSocketServer::PublishDSBlock(const DSBlock& dsblock) {
+  if (!m_running) {
+    return;
+  }
+
+  Json::Value _json;
+  _json["type"] = "NewDSBlock";
+  _json["value"] = JSONConversion::convertDSblocktoJson(dsblock);
+  Publish({{true, {}, MakeTextFrame(_json)}});
+}
+
+void WebSocketServer::PublishTxBlock(const TxBlock& txblock) {
+  if (!m_running) {
+    return;
+  }
+
+  Json::Value _json;
+  _json["type"] = "NewTxBlock";
+  _json["value"] = JSONConversion::convertTxBlocktoJson(txblock);
+  Publish({{true, {}, MakeTextFrame(_json)}});
+}
+
+void WebSocketServer::PublishTxns(
+    uint64_t blockNum, const vector<TransactionWithReceipt>& txns) {
+  // Building the receipts is skipped while nobody listens for them
+  if (!m_running || m_eventLogClients == 0) {
+    return;
+  }
+
+  vector<Notification> notifications;
+  notifications.reserve(txns.size());
+  for (const auto& twr : txns) {
+    const Transaction& tx = twr.GetTransaction();
+
+    Json::Value _json;
+    _json["type"] = "TxnReceipt";
+    _json["value"] = JSONConversion::convertTxtoJson(twr);
+    _json["value"]["BlockNum"] = to_string(blockNum);
+    notifications.push_back(
+        {false,
+         {tx.GetSenderAddr(),
+          tx.GetToAddr()},
+         MakeTextFrame(_json)});
+  }
+  Publish(move(notifications));
+}
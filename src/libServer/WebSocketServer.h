@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __WEBSOCKETSERVER_H__
+#define __WEBSOCKETSERVER_H__
+
+#include <event2/util.h>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "libData/AccountData/Address.h"
+#include "libData/AccountData/TransactionReceipt.h"
+#include "libData/BlockData/Block.h"
+
+struct event;
+struct event_base;
+struct evconnlistener;
+struct bufferevent;
+
+/// Push API of the lookup, so clients need not poll for blocks and txns.
+///
+/// Clients open a WebSocket on WEBSOCKET_PORT and send text messages to
+/// subscribe:
+///   {"query":"NewBlock"}  DS and Tx block headers as they are stored
+///   {"query":"EventLog","addresses":["<hex>", ...]}  receipts of committed
+///       txns sent from or to one of the addresses
+///   {"query":"Unsubscribe","type":"NewBlock"|"EventLog"}
+/// Notifications are {"type":"NewDSBlock"|"NewTxBlock"|"TxnReceipt",
+/// "value":...}. Clients that fall more than WEBSOCKET_MAX_CLIENT_BUFFER_BYTES
+/// behind are dropped.
+///
+/// All sockets are served from one libevent loop thread; Publish* can be
+/// called from any thread.
+class WebSocketServer {
+  struct Client {
+    struct bufferevent* m_bev;
+    bool m_upgraded;
+    bool m_closing;
+    bool m_newBlocks;
+    AddressHashSet m_addresses;
+    /// Fragments of the message being received
+    std::string m_message;
+
+    explicit Client(struct bufferevent* bev);
+    ~Client();
+  };
+
+  struct Notification {
+    bool m_isBlock;
+    Addresses m_addresses;
+    std::string m_frame;
+  };
+
+  struct event_base* m_base;
+  struct evconnlistener* m_listener;
+  struct event* m_wakeEvent;
+  int m_wakePipe[2];
+  std::atomic<bool> m_running;
+  std::atomic<bool> m_stop;
+  /// Clients subscribed to at least one address
+  std::atomic<unsigned int> m_eventLogClients;
+
+  std::mutex m_mutexPending;
+  std::vector<Notification> m_pending;
+
+  /// Only touched from the loop thread
+  std::map<struct bufferevent*, std::unique_ptr<Client>> m_clients;
+
+  std::thread m_thread;
+
+  WebSocketServer();
+  ~WebSocketServer();
+
+  WebSocketServer(WebSocketServer const&) = delete;
+  void operator=(WebSocketServer const&) = delete;
+
+  static void AcceptCallback(struct evconnlistener* listener,
+                             evutil_socket_t fd, struct sockaddr* addr,
+                             int socklen, void* arg);
+  static void WakeCallback(evutil_socket_t fd, short what, void* arg);
+  static void ReadCallback(struct bufferevent* bev, void* arg);
+  static void WriteCallback(struct bufferevent* bev, void* arg);
+  static void EventCallback(struct bufferevent* bev, short events, void* arg);
+
+  bool Upgrade(Client& client);
+  /// Returns false once no complete frame is left in the input
+  bool ReadFrame(Client& client);
+  void HandleMessage(Client& client, const std::string& message);
+  void Send(Client& client, const std::string& frame);
+  void Close(Client& client, uint16_t code);
+  void RemoveClient(struct bufferevent* bev);
+  void Publish(std::vector<Notification>&& notifications);
+  void Wake();
+  void Release();
+
+ public:
+  static WebSocketServer& GetInstance();
+
+  /// Listens on WEBSOCKET_PORT; returns false if that is not possible
+  bool Start();
+  void Stop();
+  bool IsRunning() const { return m_running; }
+
+  void PublishDSBlock(const DSBlock& dsblock);
+  void PublishTxBlock(const TxBlock& txblock);
+  void PublishTxns(uint64_t blockNum,
+                   const std::vector<TransactionWithReceipt>& txns);
+};
+
+#endif  // __WEBSOCKETSERVER_H__
@@ -0,0 +1,140 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <memory>
+#include <sstream>
+
+#include "AsyncExecutor.h"
+#include "common/Constants.h"
+
+using namespace std;
+
+AsyncExecutor::AsyncExecutor(unsigned int threads, unsigned int queueSize)
+    : m_threads(max(threads, 1u)),
+      m_queueSize(max(queueSize, 1u)),
+      m_pool(m_threads, "AsyncExecutor") {
+  // Constructed first, so the wheel outlives a static executor
+  Scheduler::GetInstance();
+}
+
+AsyncExecutor::~AsyncExecutor() {
+  unordered_set<TaskId> delayed;
+  {
+    lock_guard<mutex> g(m_mutexDelayed);
+    delayed.swap(m_delayed);
+  }
+  for (const auto& id : delayed) {
+    Scheduler::GetInstance().Cancel(id);
+  }
+}
+
+AsyncExecutor& AsyncExecutor::GetInstance() {
+  static AsyncExecutor executor(ASYNC_EXECUTOR_THREADS,
+                                ASYNC_EXECUTOR_QUEUE_SIZE);
+  return executor;
+}
+
+void AsyncExecutor::Enqueue(Task&& task) {
+  m_queued++;
+  m_pool.AddJob([this, task = move(task)]() {
+    m_queued--;
+    m_running++;
+    try {
+      task();
+    } catch (const exception& e) {
+      LOG_GENERAL(WARNING, "Async task threw: " << e.what());
+    }
+    m_running--;
+    m_completed++;
+  });
+}
+
+bool AsyncExecutor::Post(Task task) {
+  if (m_queued >= m_queueSize) {
+    m_rejected++;
+    LOG_GENERAL(WARNING, "Async task dropped, " << m_queueSize
+                                                << " tasks already queued");
+    return false;
+  }
+  Enqueue(move(task));
+  return true;
+}
+
+AsyncExecutor::TaskId AsyncExecutor::PostAfter(chrono::milliseconds delay,
+                                               Task task, const string& name) {
+  auto id = make_shared<TaskId>(0);
+  // Held so that the timer cannot fire before its id is recorded
+  lock_guard<mutex> g(m_mutexDelayed);
+  *id = Scheduler::GetInstance().ScheduleAfter(
+      delay,
+      [this, id, task = move(task)]() mutable {
+        {
+          lock_guard<mutex> g(m_mutexDelayed);
+          m_delayed.erase(*id);
+        }
+        Enqueue(move(task));
+      },
+      name);
+  m_delayed.insert(*id);
+  return *id;
+}
+
+bool AsyncExecutor::Cancel(TaskId id) {
+  {
+    lock_guard<mutex> g(m_mutexDelayed);
+    if (m_delayed.erase(id) == 0) {
+      return false;
+    }
+  }
+  return Scheduler::GetInstance().Cancel(id);
+}
+
+AsyncExecutor::Stats AsyncExecutor::GetStats() {
+  Stats stats;
+  stats.m_threads = m_threads;
+  stats.m_queued = m_queued;
+  stats.m_running = m_running;
+  stats.m_completed = m_completed;
+  stats.m_rejected = m_rejected;
+  {
+    lock_guard<mutex> g(m_mutexDelayed);
+    stats.m_delayed = m_delayed.size();
+  }
+  return stats;
+}
+
+string AsyncExecutor::GetPrometheusText() {
+  const Stats stats = GetStats();
+
+  ostringstream text;
+  text << "# HELP zilliqa_async_threads Threads of the async executor.\n"
+       << "# TYPE zilliqa_async_threads gauge\n"
+       << "zilliqa_async_threads " << stats.m_threads << "\n"
+       << "# HELP zilliqa_async_tasks Async tasks by state.\n"
+       << "# TYPE zilliqa_async_tasks gauge\n"
+       << "zilliqa_async_tasks{state=\"queued\"} " << stats.m_queued << "\n"
+       << "zilliqa_async_tasks{state=\"running\"} " << stats.m_running << "\n"
+       << "zilliqa_async_tasks{state=\"delayed\"} " << stats.m_delayed << "\n"
+       << "# HELP zilliqa_async_tasks_completed_total Async tasks run.\n"
+       << "# TYPE zilliqa_async_tasks_completed_total counter\n"
+       << "zilliqa_async_tasks_completed_total " << stats.m_completed << "\n"
+       << "# HELP zilliqa_async_tasks_rejected_total Async tasks dropped on "
+          "a full queue.\n"
+       << "# TYPE zilliqa_async_tasks_rejected_total counter\n"
+       << "zilliqa_async_tasks_rejected_total " << stats.m_rejected << "\n";
+  return text.str();
+}
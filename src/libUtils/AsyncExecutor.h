@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __ASYNCEXECUTOR_H__
+#define __ASYNCEXECUTOR_H__
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+
+#include "libUtils/Logger.h"
+#include "libUtils/Scheduler.h"
+#include "libUtils/ThreadPool.h"
+
+/// Shared executor for short background tasks, in place of a new detached
+/// thread per task.
+///
+/// Tasks run on a fixed set of threads, and at most queueSize tasks wait
+/// for one. Delayed tasks wait in the Scheduler timer wheel and join the
+/// queue once due, regardless of its bound, since they were accepted
+/// already.
+///
+/// A task holds its thread until it returns. Loops that live as long as the
+/// node, and tasks that wait for the network or run PoW, keep using
+/// DetachedFunction, so they cannot starve the executor.
+class AsyncExecutor {
+ public:
+  using Task = std::function<void()>;
+  using TaskId = Scheduler::TimerId;
+
+  struct Stats {
+    unsigned int m_threads = 0;
+    /// Posted and not started yet
+    uint64_t m_queued = 0;
+    uint64_t m_running = 0;
+    /// Still waiting for their delay
+    uint64_t m_delayed = 0;
+    uint64_t m_completed = 0;
+    /// Refused by Post because the queue was full
+    uint64_t m_rejected = 0;
+  };
+
+ private:
+  const unsigned int m_threads;
+  const unsigned int m_queueSize;
+  std::atomic<uint64_t> m_queued{0};
+  std::atomic<uint64_t> m_running{0};
+  std::atomic<uint64_t> m_completed{0};
+  std::atomic<uint64_t> m_rejected{0};
+
+  std::mutex m_mutexDelayed;
+  /// Timers still to fire, cancelled when the executor goes away
+  std::unordered_set<TaskId> m_delayed;
+
+  // Destroyed first, so the workers are joined before the rest goes away
+  ThreadPool m_pool;
+
+  AsyncExecutor(AsyncExecutor const&) = delete;
+  void operator=(AsyncExecutor const&) = delete;
+
+  void Enqueue(Task&& task);
+
+ public:
+  /// Runs tasks on threads threads, queueing at most queueSize of them
+  AsyncExecutor(unsigned int threads, unsigned int queueSize);
+  ~AsyncExecutor();
+
+  /// Returns the executor sized by ASYNC_EXECUTOR_THREADS and
+  /// ASYNC_EXECUTOR_QUEUE_SIZE.
+  static AsyncExecutor& GetInstance();
+
+  /// Queues the task. Returns false, dropping it, if the queue is full.
+  bool Post(Task task);
+
+  /// Queues the task once delay has passed. The name groups the timer in
+  /// the Scheduler stats. The id is for Cancel.
+  TaskId PostAfter(std::chrono::milliseconds delay, Task task,
+                   const std::string& name = "async");
+
+  /// Drops a delayed task that is not due yet. Returns false if it is
+  /// unknown, or already queued or run.
+  bool Cancel(TaskId id);
+
+  Stats GetStats();
+
+  /// Returns the stats in the Prometheus text exposition format
+  std::string GetPrometheusText();
+};
+
+#endif  // __ASYNCEXECUTOR_H__
@@ -0,0 +1,227 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "BinaryDelta.h"
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+
+#include "common/Serializable.h"
+#include "libCrypto/Sha2.h"
+#include "libUtils/Logger.h"
+
+using namespace std;
+
+namespace {
+const unsigned char MAGIC[] = {'Z', 'D', 'L', 'T'};
+const unsigned char VERSION = 1;
+const unsigned char OP_COPY = 0x01;
+const unsigned char OP_INSERT = 0x02;
+
+const unsigned int UINT32_LEN = sizeof(uint32_t);
+const unsigned int UINT64_LEN = sizeof(uint64_t);
+const unsigned int SHA_LEN = 32;
+const size_t HEADER_LEN =
+    sizeof(MAGIC) + 1 + SHA_LEN + UINT64_LEN + UINT64_LEN;
+
+/// Multiplier of the rolling hash, arithmetic is modulo 2^64
+const uint64_t PRIME = 1099511628211ULL;
+
+bytes Sha256(const bytes& data) {
+  SHA2<HASH_TYPE::HASH_VARIANT_256> sha2;
+  sha2.Update(data);
+  return sha2.Finalize();
+}
+
+uint64_t HashBlock(const unsigned char* data, size_t len) {
+  uint64_t hash = 0;
+  for (size_t i = 0; i < len; i++) {
+    hash = hash * PRIME + data[i];
+  }
+  return hash;
+}
+
+void AppendNumber(bytes& dst, uint64_t value, unsigned int len) {
+  const size_t offset = dst.size();
+  dst.resize(offset + len);
+  SerializableDataBlock::SetNumber<uint64_t>(dst, offset, value, len);
+}
+
+void AppendInsert(bytes& delta, const bytes& target, size_t begin,
+                  size_t end) {
+  while (begin < end) {
+    const size_t len = min<size_t>(end - begin, UINT32_MAX);
+    delta.push_back(OP_INSERT);
+    AppendNumber(delta, len, UINT32_LEN);
+    delta.insert(delta.end(), target.begin() + begin,
+                 target.begin() + begin + len);
+    begin += len;
+  }
+}
+
+void AppendCopy(bytes& delta, size_t offset, size_t len) {
+  while (len > 0) {
+    const size_t part = min<size_t>(len, UINT32_MAX);
+    delta.push_back(OP_COPY);
+    AppendNumber(delta, offset, UINT64_LEN);
+    AppendNumber(delta, part, UINT32_LEN);
+    offset += part;
+    len -= part;
+  }
+}
+}  // namespace
+
+const size_t BinaryDelta::BLOCK_SIZE;
+
+bool BinaryDelta::Create(const bytes& base, const bytes& target,
+                         bytes& delta) {
+  delta.clear();
+  delta.insert(delta.end(), begin(MAGIC), end(MAGIC));
+  delta.push_back(VERSION);
+  const bytes baseSha = Sha256(base);
+  delta.insert(delta.end(), baseSha.begin(), baseSha.end());
+  AppendNumber(delta, base.size(), UINT64_LEN);
+  AppendNumber(delta, target.size(), UINT64_LEN);
+
+  if (base.size() < BLOCK_SIZE || target.size() < BLOCK_SIZE) {
+    AppendInsert(delta, target, 0, target.size());
+    return true;
+  }
+
+  // Offset of the first base block with each hash; collisions are caught by
+  // comparing the bytes
+  unordered_map<uint64_t, size_t> blocks;
+  blocks.reserve(base.size() / BLOCK_SIZE);
+  for (size_t offset = 0; offset + BLOCK_SIZE <= base.size();
+       offset += BLOCK_SIZE) {
+    blocks.emplace(HashBlock(&base[offset], BLOCK_SIZE), offset);
+  }
+
+  uint64_t outFactor = 1;
+  for (size_t i = 1; i < BLOCK_SIZE; i++) {
+    outFactor *= PRIME;
+  }
+
+  size_t literal = 0;
+  size_t pos = 0;
+  uint64_t hash = HashBlock(&target[0], BLOCK_SIZE);
+  while (pos + BLOCK_SIZE <= target.size()) {
+    auto block = blocks.find(hash);
+    if (block != blocks.end() &&
+        memcmp(&base[block->second], &target[pos], BLOCK_SIZE) == 0) {
+      size_t baseBegin = block->second;
+      size_t targetBegin = pos;
+      while (baseBegin > 0 && targetBegin > literal &&
+             base[baseBegin - 1] == target[targetBegin - 1]) {
+        baseBegin--;
+        targetBegin--;
+      }
+      size_t len = pos + BLOCK_SIZE - targetBegin;
+      while (baseBegin + len < base.size() &&
+             targetBegin + len < target.size() &&
+             base[baseBegin + len] == target[targetBegin + len]) {
+        len++;
+      }
+
+      AppendInsert(delta, target, literal, targetBegin);
+      AppendCopy(delta, baseBegin, len);
+      pos = literal = targetBegin + len;
+      if (pos + BLOCK_SIZE <= target.size()) {
+        hash = HashBlock(&target[pos], BLOCK_SIZE);
+      }
+      continue;
+    }
+
+    if (pos + BLOCK_SIZE < target.size()) {
+      hash = (hash - target[pos] * outFactor) * PRIME +
+             target[pos + BLOCK_SIZE];
+    }
+    pos++;
+  }
+
+  AppendInsert(delta, target, literal, target.size());
+  return true;
+}
+
+bool BinaryDelta::Apply(const bytes& base, const bytes& delta,
+                        bytes& target) {
+  if (delta.size() < HEADER_LEN ||
+      !equal(begin(MAGIC), end(MAGIC), delta.begin()) ||
+      delta[sizeof(MAGIC)] != VERSION) {
+    LOG_GENERAL(WARNING, "Not a binary delta");
+    return false;
+  }
+
+  size_t pos = sizeof(MAGIC) + 1;
+  const bytes baseSha(delta.begin() + pos, delta.begin() + pos + SHA_LEN);
+  pos += SHA_LEN;
+  const uint64_t baseSize =
+      SerializableDataBlock::GetNumber<uint64_t>(delta, pos, UINT64_LEN);
+  pos += UINT64_LEN;
+  const uint64_t targetSize =
+      SerializableDataBlock::GetNumber<uint64_t>(delta, pos, UINT64_LEN);
+  pos += UINT64_LEN;
+
+  if (baseSize != base.size() || baseSha != Sha256(base)) {
+    LOG_GENERAL(WARNING, "Binary delta was made against another base");
+    return false;
+  }
+
+  target.clear();
+  target.reserve(targetSize);
+  while (pos < delta.size()) {
+    const unsigned char op = delta[pos++];
+    if (op == OP_COPY && pos + UINT64_LEN + UINT32_LEN <= delta.size()) {
+      const uint64_t offset =
+          SerializableDataBlock::GetNumber<uint64_t>(delta, pos, UINT64_LEN);
+      pos += UINT64_LEN;
+      const uint64_t len =
+          SerializableDataBlock::GetNumber<uint32_t>(delta, pos, UINT32_LEN);
+      pos += UINT32_LEN;
+      if (offset > base.size() || len > base.size() - offset ||
+          len > targetSize - target.size()) {
+        LOG_GENERAL(WARNING, "Binary delta copies out of range");
+        return false;
+      }
+      target.insert(target.end(), base.begin() + offset,
+                    base.begin() + offset + len);
+    } else if (op == OP_INSERT && pos + UINT32_LEN <= delta.size()) {
+      const uint64_t len =
+          SerializableDataBlock::GetNumber<uint32_t>(delta, pos, UINT32_LEN);
+      pos += UINT32_LEN;
+      if (len > delta.size() - pos || len > targetSize - target.size()) {
+        LOG_GENERAL(WARNING, "Binary delta inserts out of range");
+        return false;
+      }
+      target.insert(target.end(), delta.begin() + pos,
+                    delta.begin() + pos + len);
+      pos += len;
+    } else {
+      LOG_GENERAL(WARNING, "Damaged binary delta operation at " << pos - 1);
+      return false;
+    }
+  }
+
+  if (target.size() != targetSize) {
+    LOG_GENERAL(WARNING, "Binary delta gave " << target.size()
+                                              << " bytes instead of "
+                                              << targetSize);
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,45 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __BINARYDELTA_H__
+#define __BINARYDELTA_H__
+
+#include <cstddef>
+
+#include "common/BaseType.h"
+
+/// Copy/insert delta between two versions of a binary.
+///
+/// A delta starts with the SHA-256 and size of the base it applies to, and
+/// the size of the result, followed by a list of operations that either copy
+/// a range of the base or insert literal bytes. Create finds copies by
+/// indexing the base in BLOCK_SIZE blocks and scanning the target with a
+/// rolling hash, so moved and unchanged regions of a package cost a few
+/// bytes each.
+class BinaryDelta {
+ public:
+  static const size_t BLOCK_SIZE = 64;
+
+  /// Encodes target as a delta against base
+  static bool Create(const bytes& base, const bytes& target, bytes& delta);
+
+  /// Rebuilds the target; fails if base is not the one the delta was made
+  /// against or if the delta is damaged
+  static bool Apply(const bytes& base, const bytes& delta, bytes& target);
+};
+
+#endif  // __BINARYDELTA_H__
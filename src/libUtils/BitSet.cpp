@@ -0,0 +1,160 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include "BitSet.h"
+#include "BitVector.h"
+
+using namespace std;
+
+namespace {
+size_t NumWords(size_t size) { return (size + 63) / 64; }
+}  // namespace
+
+BitSet::BitSet(size_t size) : m_size(size), m_words(NumWords(size), 0) {}
+
+BitSet::BitSet(const vector<bool>& bits) : BitSet(bits.size()) {
+  for (size_t i = 0; i < bits.size(); i++) {
+    if (bits[i]) {
+      Bytes()[i >> 3] |= (0x80 >> (i & 0x07));
+    }
+  }
+}
+
+void BitSet::ClearPadding() {
+  const size_t numBytes = BitVector::GetBitVectorLengthInBytes(m_size);
+  uint8_t* bytes = Bytes();
+  if ((m_size & 0x07) != 0) {
+    bytes[numBytes - 1] &= static_cast<uint8_t>(0xff << (8 - (m_size & 0x07)));
+  }
+  memset(bytes + numBytes, 0, m_words.size() * sizeof(uint64_t) - numBytes);
+}
+
+bool BitSet::Test(size_t index) const {
+  if (index >= m_size) {
+    throw out_of_range("BitSet::Test");
+  }
+  return (Bytes()[index >> 3] & (0x80 >> (index & 0x07))) != 0;
+}
+
+void BitSet::Set(size_t index, bool value) {
+  if (index >= m_size) {
+    throw out_of_range("BitSet::Set");
+  }
+  const uint8_t mask = 0x80 >> (index & 0x07);
+  if (value) {
+    Bytes()[index >> 3] |= mask;
+  } else {
+    Bytes()[index >> 3] &= ~mask;
+  }
+}
+
+void BitSet::Reset(size_t size) {
+  m_size = size;
+  m_words.assign(NumWords(size), 0);
+}
+
+size_t BitSet::Count() const {
+  size_t count = 0;
+  for (const auto& word : m_words) {
+    count += __builtin_popcountll(word);
+  }
+  return count;
+}
+
+size_t BitSet::CountCommon(const BitSet& other) const {
+  size_t count = 0;
+  const size_t numWords = min(m_words.size(), other.m_words.size());
+  for (size_t w = 0; w < numWords; w++) {
+    count += __builtin_popcountll(m_words[w] & other.m_words[w]);
+  }
+  return count;
+}
+
+BitSet& BitSet::operator&=(const BitSet& other) {
+  for (size_t w = 0; w < m_words.size(); w++) {
+    m_words[w] &= (w < other.m_words.size()) ? other.m_words[w] : 0;
+  }
+  return *this;
+}
+
+BitSet& BitSet::operator|=(const BitSet& other) {
+  const size_t numWords = min(m_words.size(), other.m_words.size());
+  for (size_t w = 0; w < numWords; w++) {
+    m_words[w] |= other.m_words[w];
+  }
+  ClearPadding();
+  return *this;
+}
+
+BitSet& BitSet::operator^=(const BitSet& other) {
+  const size_t numWords = min(m_words.size(), other.m_words.size());
+  for (size_t w = 0; w < numWords; w++) {
+    m_words[w] ^= other.m_words[w];
+  }
+  ClearPadding();
+  return *this;
+}
+
+bool BitSet::operator==(const BitSet& other) const {
+  return (m_size == other.m_size) && (m_words == other.m_words);
+}
+
+vector<bool> BitSet::ToVector() const {
+  vector<bool> bits(m_size, false);
+  ForEachSet([&bits](size_t index) { bits[index] = true; });
+  return bits;
+}
+
+unsigned int BitSet::Serialize(bytes& dst, unsigned int offset) const {
+  const unsigned int numBytes = BitVector::GetBitVectorLengthInBytes(m_size);
+  const unsigned int lengthNeeded = 2 + numBytes;
+
+  if ((offset + lengthNeeded) > dst.size()) {
+    dst.resize(offset + lengthNeeded);
+  }
+
+  dst.at(offset) = m_size >> 8;
+  dst.at(offset + 1) = m_size;
+  if (numBytes > 0) {
+    memcpy(&dst.at(offset + 2), Bytes(), numBytes);
+  }
+
+  return lengthNeeded;
+}
+
+bool BitSet::Deserialize(const bytes& src, unsigned int offset) {
+  if ((offset > src.size()) || (src.size() - offset < 2)) {
+    return false;
+  }
+
+  const unsigned int size = (src.at(offset) << 8) + src.at(offset + 1);
+  const unsigned int numBytes = BitVector::GetBitVectorLengthInBytes(size);
+  if (src.size() - offset - 2 < numBytes) {
+    return false;
+  }
+
+  Reset(size);
+  if (numBytes > 0) {
+    memcpy(Bytes(), &src.at(offset + 2), numBytes);
+    ClearPadding();
+  }
+  return true;
+}
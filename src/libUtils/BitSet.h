@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __BITSET_H__
+#define __BITSET_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "common/BaseType.h"
+
+/// Packed bitmap of a fixed number of bits, for committee maps.
+///
+/// Bits are kept in 64-bit words, so counting and combining maps are word
+/// operations. In memory, bit i is in byte i / 8 at mask 0x80 >> (i % 8),
+/// which is the BitVector wire layout, so serialization is a plain copy.
+/// Bits past size() are always zero.
+class BitSet {
+  size_t m_size;
+  std::vector<uint64_t> m_words;
+
+  const uint8_t* Bytes() const {
+    return reinterpret_cast<const uint8_t*>(m_words.data());
+  }
+  uint8_t* Bytes() { return reinterpret_cast<uint8_t*>(m_words.data()); }
+
+  /// Clears the bits past size() in the last word
+  void ClearPadding();
+
+ public:
+  BitSet() : m_size(0) {}
+
+  /// Constructs a map of size bits, all cleared
+  explicit BitSet(size_t size);
+
+  explicit BitSet(const std::vector<bool>& bits);
+
+  size_t size() const { return m_size; }
+
+  /// Returns bit index; throws std::out_of_range if index >= size()
+  bool Test(size_t index) const;
+
+  /// Sets bit index to value; throws std::out_of_range if index >= size()
+  void Set(size_t index, bool value = true);
+
+  /// Resizes the map to size bits and clears all of them
+  void Reset(size_t size);
+
+  /// Number of set bits
+  size_t Count() const;
+
+  /// Number of bits set in both maps
+  size_t CountCommon(const BitSet& other) const;
+
+  /// Word-wise operations. Bits past the end of the shorter map are taken as
+  /// cleared, and the size of this map does not change.
+  BitSet& operator&=(const BitSet& other);
+  BitSet& operator|=(const BitSet& other);
+  BitSet& operator^=(const BitSet& other);
+
+  bool operator==(const BitSet& other) const;
+  bool operator!=(const BitSet& other) const { return !(*this == other); }
+
+  /// Calls f(index) for each set bit, in increasing order
+  template <class F>
+  void ForEachSet(F f) const {
+    for (size_t w = 0; w < m_words.size(); w++) {
+      // Byte-swapped so that the lowest index is the most significant bit
+      uint64_t word = __builtin_bswap64(m_words[w]);
+      while (word != 0) {
+        const unsigned int bit = __builtin_clzll(word);
+        f(w * 64 + bit);
+        word &= ~(1ULL << (63 - bit));
+      }
+    }
+  }
+
+  std::vector<bool> ToVector() const;
+
+  /// Writes the map in the BitVector::SetBitVector format and returns the
+  /// number of bytes written
+  unsigned int Serialize(bytes& dst, unsigned int offset) const;
+
+  /// Reads a map in the BitVector::GetBitVector format, returning false if
+  /// src is too short
+  bool Deserialize(const bytes& src, unsigned int offset);
+};
+
+#endif  // __BITSET_H__
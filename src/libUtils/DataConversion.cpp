@@ -15,10 +15,248 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <cstring>
+
 #include "DataConversion.h"
 
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HEX_CODEC_X86
+#endif
+
 using namespace std;
 
+namespace {
+const char HEX_DIGITS[] = "0123456789ABCDEF";
+
+/// Maps a char to its hex digit value, or to -1 if it is not a hex digit
+struct HexDecodeTable {
+  int8_t m_values[256];
+
+  HexDecodeTable() {
+    memset(m_values, -1, sizeof(m_values));
+    for (int i = 0; i < 10; i++) {
+      m_values['0' + i] = i;
+    }
+    for (int i = 0; i < 6; i++) {
+      m_values['a' + i] = 10 + i;
+      m_values['A' + i] = 10 + i;
+    }
+  }
+};
+
+const HexDecodeTable HEX_DECODE_TABLE;
+
+void HexEncodeScalar(const uint8_t* data, size_t len, char* out) {
+  for (size_t i = 0; i < len; i++) {
+    out[2 * i] = HEX_DIGITS[data[i] >> 4];
+    out[2 * i + 1] = HEX_DIGITS[data[i] & 0x0f];
+  }
+}
+
+bool HexDecodeScalar(const char* hex, size_t numBytes, uint8_t* out) {
+  for (size_t i = 0; i < numBytes; i++) {
+    const int8_t hi =
+        HEX_DECODE_TABLE.m_values[static_cast<uint8_t>(hex[2 * i])];
+    const int8_t lo =
+        HEX_DECODE_TABLE.m_values[static_cast<uint8_t>(hex[2 * i + 1])];
+    if ((hi | lo) < 0) {
+      return false;
+    }
+    out[i] = static_cast<uint8_t>((hi << 4) | lo);
+  }
+  return true;
+}
+
+#ifdef HEX_CODEC_X86
+// Both widths map each byte to two digits with a 16-entry shuffle lookup, and
+// decode by range-checking digits and letters separately, then merging each
+// pair of nibbles with a multiply-add
+
+#define SSSE3_TARGET __attribute__((target("ssse3")))
+#define AVX2_TARGET __attribute__((target("avx2")))
+
+SSSE3_TARGET inline __m128i Load128(const void* p) {
+  return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+}
+
+SSSE3_TARGET inline void Store128(void* p, __m128i v) {
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v);
+}
+
+AVX2_TARGET inline __m256i Load256(const void* p) {
+  return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+}
+
+AVX2_TARGET inline void Store256(void* p, __m256i v) {
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v);
+}
+
+SSSE3_TARGET size_t HexEncodeSSSE3(const uint8_t* data, size_t len,
+                                   char* out) {
+  const __m128i lut = Load128(HEX_DIGITS);
+  const __m128i mask = _mm_set1_epi8(0x0f);
+  size_t i = 0;
+  for (; i + 16 <= len; i += 16) {
+    const __m128i in = Load128(data + i);
+    const __m128i hi =
+        _mm_shuffle_epi8(lut, _mm_and_si128(_mm_srli_epi16(in, 4), mask));
+    const __m128i lo = _mm_shuffle_epi8(lut, _mm_and_si128(in, mask));
+    Store128(out + 2 * i, _mm_unpacklo_epi8(hi, lo));
+    Store128(out + 2 * i + 16, _mm_unpackhi_epi8(hi, lo));
+  }
+  return i;
+}
+
+AVX2_TARGET size_t HexEncodeAVX2(const uint8_t* data, size_t len, char* out) {
+  const __m256i lut = _mm256_broadcastsi128_si256(Load128(HEX_DIGITS));
+  const __m256i mask = _mm256_set1_epi8(0x0f);
+  size_t i = 0;
+  for (; i + 32 <= len; i += 32) {
+    const __m256i in = Load256(data + i);
+    const __m256i hi = _mm256_shuffle_epi8(
+        lut, _mm256_and_si256(_mm256_srli_epi16(in, 4), mask));
+    const __m256i lo = _mm256_shuffle_epi8(lut, _mm256_and_si256(in, mask));
+    // Unpacking works within each 128-bit lane, so put the halves in order
+    const __m256i first = _mm256_unpacklo_epi8(hi, lo);
+    const __m256i second = _mm256_unpackhi_epi8(hi, lo);
+    Store256(out + 2 * i, _mm256_permute2x128_si256(first, second, 0x20));
+    Store256(out + 2 * i + 32, _mm256_permute2x128_si256(first, second, 0x31));
+  }
+  return i;
+}
+
+/// Digit values of 16 chars; lanes that are not hex digits are set in invalid
+SSSE3_TARGET inline __m128i HexValuesSSSE3(__m128i chars, __m128i& invalid) {
+  const __m128i digit = _mm_sub_epi8(chars, _mm_set1_epi8('0'));
+  const __m128i isDigit =
+      _mm_cmpeq_epi8(_mm_min_epu8(digit, _mm_set1_epi8(9)), digit);
+  const __m128i letter = _mm_sub_epi8(
+      _mm_or_si128(chars, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+  const __m128i isLetter =
+      _mm_cmpeq_epi8(_mm_min_epu8(letter, _mm_set1_epi8(5)), letter);
+  invalid = _mm_or_si128(
+      invalid, _mm_andnot_si128(_mm_or_si128(isDigit, isLetter),
+                                _mm_set1_epi8(-1)));
+  const __m128i letterValue = _mm_add_epi8(letter, _mm_set1_epi8(10));
+  return _mm_or_si128(_mm_and_si128(isDigit, digit),
+                      _mm_and_si128(isLetter, letterValue));
+}
+
+SSSE3_TARGET size_t HexDecodeSSSE3(const char* hex, size_t numBytes,
+                                   uint8_t* out, bool& ok) {
+  // Each 16-bit lane becomes hi * 16 + lo
+  const __m128i weights = _mm_set1_epi16(0x0110);
+  size_t i = 0;
+  for (; i + 16 <= numBytes; i += 16) {
+    __m128i invalid = _mm_setzero_si128();
+    const __m128i v0 = HexValuesSSSE3(Load128(hex + 2 * i), invalid);
+    const __m128i v1 = HexValuesSSSE3(Load128(hex + 2 * i + 16), invalid);
+    if (_mm_movemask_epi8(invalid) != 0) {
+      ok = false;
+      return i;
+    }
+    Store128(out + i, _mm_packus_epi16(_mm_maddubs_epi16(v0, weights),
+                                       _mm_maddubs_epi16(v1, weights)));
+  }
+  ok = true;
+  return i;
+}
+
+/// Digit values of 32 chars; lanes that are not hex digits are set in invalid
+AVX2_TARGET inline __m256i HexValuesAVX2(__m256i chars, __m256i& invalid) {
+  const __m256i digit = _mm256_sub_epi8(chars, _mm256_set1_epi8('0'));
+  const __m256i isDigit =
+      _mm256_cmpeq_epi8(_mm256_min_epu8(digit, _mm256_set1_epi8(9)), digit);
+  const __m256i letter = _mm256_sub_epi8(
+      _mm256_or_si256(chars, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+  const __m256i isLetter =
+      _mm256_cmpeq_epi8(_mm256_min_epu8(letter, _mm256_set1_epi8(5)), letter);
+  invalid = _mm256_or_si256(
+      invalid, _mm256_andnot_si256(_mm256_or_si256(isDigit, isLetter),
+                                   _mm256_set1_epi8(-1)));
+  const __m256i letterValue = _mm256_add_epi8(letter, _mm256_set1_epi8(10));
+  return _mm256_or_si256(_mm256_and_si256(isDigit, digit),
+                         _mm256_and_si256(isLetter, letterValue));
+}
+
+AVX2_TARGET size_t HexDecodeAVX2(const char* hex, size_t numBytes,
+                                 uint8_t* out, bool& ok) {
+  const __m256i weights = _mm256_set1_epi16(0x0110);
+  size_t i = 0;
+  for (; i + 32 <= numBytes; i += 32) {
+    __m256i invalid = _mm256_setzero_si256();
+    const __m256i v0 = HexValuesAVX2(Load256(hex + 2 * i), invalid);
+    const __m256i v1 = HexValuesAVX2(Load256(hex + 2 * i + 32), invalid);
+    if (_mm256_movemask_epi8(invalid) != 0) {
+      ok = false;
+      return i;
+    }
+    // Packing also works within lanes, leaving the 8-byte groups out of order
+    const __m256i packed = _mm256_packus_epi16(
+        _mm256_maddubs_epi16(v0, weights), _mm256_maddubs_epi16(v1, weights));
+    Store256(out + i, _mm256_permute4x64_epi64(packed, 0xd8));
+  }
+  ok = true;
+  return i;
+}
+
+enum class HexCodecImpl { SCALAR, SSSE3, AVX2 };
+
+HexCodecImpl GetHexCodecImpl() {
+  static const HexCodecImpl impl = __builtin_cpu_supports("avx2")
+                                       ? HexCodecImpl::AVX2
+                                       : __builtin_cpu_supports("ssse3")
+                                             ? HexCodecImpl::SSSE3
+                                             : HexCodecImpl::SCALAR;
+  return impl;
+}
+#endif  // HEX_CODEC_X86
+}  // namespace
+
+size_t DataConversion::HexEncode(const uint8_t* data, size_t len, char* out) {
+  size_t done = 0;
+#ifdef HEX_CODEC_X86
+  switch (GetHexCodecImpl()) {
+    case HexCodecImpl::AVX2:
+      done = HexEncodeAVX2(data, len, out);
+      break;
+    case HexCodecImpl::SSSE3:
+      done = HexEncodeSSSE3(data, len, out);
+      break;
+    default:
+      break;
+  }
+#endif
+  HexEncodeScalar(data + done, len - done, out + 2 * done);
+  return 2 * len;
+}
+
+bool DataConversion::HexDecode(const char* hex, size_t len, uint8_t* out) {
+  if (len % 2 != 0) {
+    return false;
+  }
+  const size_t numBytes = len / 2;
+  size_t done = 0;
+#ifdef HEX_CODEC_X86
+  bool ok = true;
+  switch (GetHexCodecImpl()) {
+    case HexCodecImpl::AVX2:
+      done = HexDecodeAVX2(hex, numBytes, out, ok);
+      break;
+    case HexCodecImpl::SSSE3:
+      done = HexDecodeSSSE3(hex, numBytes, out, ok);
+      break;
+    default:
+      break;
+  }
+  if (!ok) {
+    return false;
+  }
+#endif
+  return HexDecodeScalar(hex + 2 * done, numBytes - done, out + done);
+}
+
 bool DataConversion::HexStringToUint64(const std::string& s, uint64_t* res) {
   try {
     *res = std::stoull(s, nullptr, 16);
@@ -33,11 +271,9 @@ bool DataConversion::HexStringToUint64(const std::string& s, uint64_t* res) {
 }
 
 bool DataConversion::HexStrToUint8Vec(const string& hex_input, bytes& out) {
-  try {
+  out.resize(hex_input.size() / 2);
+  if (!HexDecode(hex_input.data(), hex_input.size(), out.data())) {
     out.clear();
-    boost::algorithm::unhex(hex_input.begin(), hex_input.end(),
-                            back_inserter(out));
-  } catch (exception& e) {
     LOG_GENERAL(WARNING, "Failed HexStrToUint8Vec conversion");
     return false;
   }
@@ -69,26 +305,19 @@ bool DataConversion::HexStrToStdArray64(const string& hex_input,
 }
 
 bool DataConversion::Uint8VecToHexStr(const bytes& hex_vec, string& str) {
-  try {
-    str = "";
-    boost::algorithm::hex(hex_vec.begin(), hex_vec.end(), back_inserter(str));
-  } catch (exception& e) {
-    LOG_GENERAL(WARNING, "Failed Uint8VecToHexStr conversion");
-    return false;
-  }
+  str.resize(hex_vec.size() * 2);
+  HexEncode(hex_vec.data(), hex_vec.size(), &str[0]);
   return true;
 }
 
 bool DataConversion::Uint8VecToHexStr(const bytes& hex_vec, unsigned int offset,
                                       unsigned int len, string& str) {
-  try {
-    str = "";
-    boost::algorithm::hex(hex_vec.begin() + offset,
-                          hex_vec.begin() + offset + len, back_inserter(str));
-  } catch (exception& e) {
+  if (static_cast<size_t>(offset) + len > hex_vec.size()) {
     LOG_GENERAL(WARNING, "Failed Uint8VecToHexStr conversion");
     return false;
   }
+  str.resize(len * 2);
+  HexEncode(hex_vec.data() + offset, len, &str[0]);
   return true;
 }
 
@@ -96,13 +325,8 @@ bool DataConversion::SerializableToHexStr(const Serializable& input,
                                           string& str) {
   bytes tmp;
   input.Serialize(tmp, 0);
-  try {
-    str = "";
-    boost::algorithm::hex(tmp.begin(), tmp.end(), back_inserter(str));
-  } catch (exception& e) {
-    LOG_GENERAL(WARNING, "Failed SerializableToHexStr conversion");
-    return false;
-  }
+  str.resize(tmp.size() * 2);
+  HexEncode(tmp.data(), tmp.size(), &str[0]);
   return true;
 }
 
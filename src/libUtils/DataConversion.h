@@ -34,6 +34,16 @@ class DataConversion {
   /// Converts alphanumeric hex string to Uint64.
   static bool HexStringToUint64(const std::string& s, uint64_t* res);
 
+  /// Writes the 2 * len uppercase hex digits of data to out, which must have
+  /// room for them, and returns the number of chars written. Uses SSSE3 or
+  /// AVX2 when the CPU supports them.
+  static size_t HexEncode(const uint8_t* data, size_t len, char* out);
+
+  /// Decodes len hex digits of either case into len / 2 bytes at out, which
+  /// must have room for them. Returns false if len is odd or any char is not
+  /// a hex digit, in which case out is left partly written.
+  static bool HexDecode(const char* hex, size_t len, uint8_t* out);
+
   /// Converts alphanumeric hex string to byte vector.
   static bool HexStrToUint8Vec(const std::string& hex_input, bytes& out);
 
@@ -56,14 +66,8 @@ class DataConversion {
   template <size_t SIZE>
   static bool charArrToHexStr(const std::array<uint8_t, SIZE>& hex_arr,
                               std::string& str) {
-    try {
-      str = "";
-      boost::algorithm::hex(hex_arr.begin(), hex_arr.end(),
-                            std::back_inserter(str));
-    } catch (std::exception& e) {
-      LOG_GENERAL(WARNING, "Failed charArrToHexStr conversion");
-      return false;
-    }
+    str.resize(SIZE * 2);
+    HexEncode(hex_arr.data(), SIZE, &str[0]);
     return true;
   }
 
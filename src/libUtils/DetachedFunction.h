@@ -23,7 +23,7 @@
 #include "libUtils/Logger.h"
 
 /// Utility class for executing a function in one or more separate detached
-/// threads.
+/// threads. Short tasks should be posted to the AsyncExecutor instead.
 class DetachedFunction {
  public:
   /// Retry limit for launching the detached threads.
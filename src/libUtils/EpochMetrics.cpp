@@ -0,0 +1,409 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <sstream>
+
+#include "EpochMetrics.h"
+#include "common/Constants.h"
+#include "common/MessageNames.h"
+#include "common/Serializable.h"
+#include "libUtils/Logger.h"
+
+using namespace std;
+
+void MetricHistogram::Add(uint64_t value, uint64_t firstBucket) {
+  unsigned int bucket = 0;
+  for (uint64_t units = value / firstBucket;
+       units > 0 && bucket < NUM_BUCKETS - 1; units >>= 1) {
+    bucket++;
+  }
+
+  m_count++;
+  m_total += value;
+  m_max = max(m_max, value);
+  m_last = value;
+  m_buckets.at(bucket)++;
+}
+
+EpochMetrics::EpochMetrics() : m_currentEpoch(0) {
+  for (unsigned int i = 0; i < m_phases.size(); i++) {
+    m_phases[i] = {static_cast<EpochPhase>(i), 0, {}};
+  }
+
+  if (!EPOCH_METRICS_DUMP_FILE.empty()) {
+    m_dumpFile.open(EPOCH_METRICS_DUMP_FILE, ios::binary | ios::app);
+    if (!m_dumpFile.is_open()) {
+      LOG_GENERAL(WARNING, "Cannot open epoch metrics dump file "
+                               << EPOCH_METRICS_DUMP_FILE);
+    }
+  }
+}
+
+EpochMetrics::~EpochMetrics() {
+  if (m_dumpFile.is_open()) {
+    m_dumpFile.close();
+  }
+}
+
+EpochMetrics& EpochMetrics::GetInstance() {
+  static EpochMetrics metrics;
+  return metrics;
+}
+
+const char* EpochMetrics::GetPhaseName(EpochPhase phase) {
+  switch (phase) {
+    case EPOCH_PHASE_POW:
+      return "POW";
+    case EPOCH_PHASE_DS_CONSENSUS:
+      return "DS_CONSENSUS";
+    case EPOCH_PHASE_MICROBLOCK_CONSENSUS:
+      return "MICROBLOCK_CONSENSUS";
+    case EPOCH_PHASE_MICROBLOCK_SUBMISSION:
+      return "MICROBLOCK_SUBMISSION";
+    case EPOCH_PHASE_FINALBLOCK_CONSENSUS:
+      return "FINALBLOCK_CONSENSUS";
+    case EPOCH_PHASE_VIEWCHANGE:
+      return "VIEWCHANGE";
+    case EPOCH_PHASE_FALLBACK:
+      return "FALLBACK";
+    default:
+      return "NONE";
+  }
+}
+
+void EpochMetrics::RecordMessage(unsigned char msgType,
+                                 unsigned char instruction,
+                                 uint64_t sizeInBytes,
+                                 uint64_t durationInMicroseconds) {
+  const uint16_t key = (static_cast<uint16_t>(msgType) << 8) | instruction;
+
+  lock_guard<mutex> g(m_mutex);
+
+  auto it = m_messages.find(key);
+  if (it == m_messages.end()) {
+    MessageMetrics metrics{msgType, instruction,
+                           GetMessageName(msgType, instruction), {}, {}};
+    it = m_messages.emplace(key, metrics).first;
+  }
+
+  it->second.m_time.Add(durationInMicroseconds,
+                        MessageMetrics::FIRST_TIME_BUCKET_IN_MICROSECONDS);
+  it->second.m_size.Add(sizeInBytes,
+                        MessageMetrics::FIRST_SIZE_BUCKET_IN_BYTES);
+}
+
+void EpochMetrics::RecordPhase(EpochPhase phase,
+                               uint64_t durationInMicroseconds) {
+  if (phase >= EPOCH_PHASE_NONE) {
+    return;
+  }
+
+  lock_guard<mutex> g(m_mutex);
+
+  PhaseMetrics& metrics = m_phases[phase];
+  metrics.m_lastEpoch = m_currentEpoch;
+  metrics.m_time.Add(durationInMicroseconds,
+                     PhaseMetrics::FIRST_TIME_BUCKET_IN_MICROSECONDS);
+}
+
+void EpochMetrics::OnNewEpoch(uint64_t epochNum) {
+  lock_guard<mutex> g(m_mutex);
+
+  m_currentEpoch = epochNum;
+
+  if (!m_dumpFile.is_open() || EPOCH_METRICS_DUMP_INTERVAL == 0 ||
+      epochNum % EPOCH_METRICS_DUMP_INTERVAL != 0) {
+    return;
+  }
+
+  const uint64_t now = chrono::duration_cast<chrono::microseconds>(
+                           chrono::system_clock::now().time_since_epoch())
+                           .count();
+
+  const auto writeRecord = [this, now, epochNum](
+                               RecordKind kind, uint16_t id,
+                               const MetricHistogram& histogram) {
+    bytes record;
+    record.reserve(RECORD_SIZE);
+    Serializable::SetNumber<uint64_t>(record, 0, now, sizeof(uint64_t));
+    Serializable::SetNumber<uint64_t>(record, 8, epochNum, sizeof(uint64_t));
+    record.push_back(kind);
+    Serializable::SetNumber<uint16_t>(record, 17, id, sizeof(uint16_t));
+    unsigned int offset = 19;
+    for (const uint64_t value : {histogram.m_count, histogram.m_total,
+                                 histogram.m_max, histogram.m_last}) {
+      Serializable::SetNumber<uint64_t>(record, offset, value,
+                                        sizeof(uint64_t));
+      offset += sizeof(uint64_t);
+    }
+    for (const uint64_t bucket : histogram.m_buckets) {
+      Serializable::SetNumber<uint64_t>(record, offset, bucket,
+                                        sizeof(uint64_t));
+      offset += sizeof(uint64_t);
+    }
+
+    m_dumpFile.write(reinterpret_cast<const char*>(record.data()),
+                     record.size());
+  };
+
+  for (const auto& entry : m_messages) {
+    writeRecord(RECORD_MESSAGE_TIME, entry.first, entry.second.m_time);
+    writeRecord(RECORD_MESSAGE_SIZE, entry.first, entry.second.m_size);
+  }
+  for (const auto& phase : m_phases) {
+    if (phase.m_time.m_count > 0) {
+      writeRecord(RECORD_PHASE_TIME, phase.m_phase, phase.m_time);
+    }
+  }
+  m_dumpFile.flush();
+}
+
+vector<MessageMetrics> EpochMetrics::GetMessageStats() {
+  lock_guard<mutex> g(m_mutex);
+
+  vector<MessageMetrics> result;
+  result.reserve(m_messages.size());
+  for (const auto& entry : m_messages) {
+    result.emplace_back(entry.second);
+  }
+  return result;
+}
+
+vector<PhaseMetrics> EpochMetrics::GetPhaseStats() {
+  lock_guard<mutex> g(m_mutex);
+
+  vector<PhaseMetrics> result;
+  for (const auto& phase : m_phases) {
+    if (phase.m_time.m_count > 0) {
+      result.emplace_back(phase);
+    }
+  }
+  return result;
+}
+
+uint64_t EpochMetrics::GetCurrentEpoch() {
+  lock_guard<mutex> g(m_mutex);
+  return m_currentEpoch;
+}
+
+namespace {
+void AppendHistogram(ostringstream& text, const string& metric,
+                     const string& label, const MetricHistogram& histogram,
+                     uint64_t firstBucket, double scale) {
+  uint64_t cumulative = 0;
+  for (unsigned int i = 0; i < MetricHistogram::NUM_BUCKETS - 1; i++) {
+    cumulative += histogram.m_buckets[i];
+    text << metric << "_bucket{" << label << ",le=\""
+         << (firstBucket << i) / scale << "\"} " << cumulative << "\n";
+  }
+  text << metric << "_bucket{" << label << ",le=\"+Inf\"} "
+       << histogram.m_count << "\n"
+       << metric << "_sum{" << label << "} " << histogram.m_total / scale
+       << "\n"
+       << metric << "_count{" << label << "} " << histogram.m_count << "\n";
+}
+}  // namespace
+
+string EpochMetrics::GetPrometheusText() {
+  const vector<MessageMetrics> messages = GetMessageStats();
+  const vector<PhaseMetrics> phases = GetPhaseStats();
+
+  ostringstream text;
+
+  text << "# HELP zilliqa_epoch Current epoch number.\n"
+       << "# TYPE zilliqa_epoch gauge\n"
+       << "zilliqa_epoch " << GetCurrentEpoch() << "\n";
+
+  text << "# HELP zilliqa_message_duration_seconds Message processing time "
+          "by type.\n"
+       << "# TYPE zilliqa_message_duration_seconds histogram\n";
+  for (const auto& m : messages) {
+    AppendHistogram(text, "zilliqa_message_duration_seconds",
+                    "message=\"" + m.m_name + "\"", m.m_time,
+                    MessageMetrics::FIRST_TIME_BUCKET_IN_MICROSECONDS, 1e6);
+  }
+
+  text << "# HELP zilliqa_message_size_bytes Message size by type.\n"
+       << "# TYPE zilliqa_message_size_bytes histogram\n";
+  for (const auto& m : messages) {
+    AppendHistogram(text, "zilliqa_message_size_bytes",
+                    "message=\"" + m.m_name + "\"", m.m_size,
+                    MessageMetrics::FIRST_SIZE_BUCKET_IN_BYTES, 1);
+  }
+
+  text << "# HELP zilliqa_epoch_phase_duration_seconds Epoch phase "
+          "duration.\n"
+       << "# TYPE zilliqa_epoch_phase_duration_seconds histogram\n";
+  for (const auto& p : phases) {
+    AppendHistogram(text, "zilliqa_epoch_phase_duration_seconds",
+                    string("phase=\"") + GetPhaseName(p.m_phase) + "\"",
+                    p.m_time, PhaseMetrics::FIRST_TIME_BUCKET_IN_MICROSECONDS,
+                    1e6);
+  }
+
+  return text.str();
+}
+
+EpochTimeline::EpochTimeline()
+    : m_events(EPOCH_TIMELINE_EVENTS),
+      m_next(0),
+      m_recorded(0),
+      m_currentEpoch(0),
+      m_start(chrono::steady_clock::now()) {}
+
+EpochTimeline& EpochTimeline::GetInstance() {
+  static EpochTimeline timeline;
+  return timeline;
+}
+
+const char* EpochTimeline::GetKindName(TimelineEventKind kind) {
+  switch (kind) {
+    case TIMELINE_PHASE_ENTER:
+      return "ENTER";
+    case TIMELINE_PHASE_EXIT:
+      return "EXIT";
+    case TIMELINE_MARK:
+      return "MARK";
+    default:
+      return "UNKNOWN";
+  }
+}
+
+const char* EpochTimeline::GetMarkName(TimelineMark mark) {
+  switch (mark) {
+    case TIMELINE_MARK_NEW_EPOCH:
+      return "NEW_EPOCH";
+    case TIMELINE_MARK_DSBLOCK_RECEIVED:
+      return "DSBLOCK_RECEIVED";
+    case TIMELINE_MARK_FINALBLOCK_RECEIVED:
+      return "FINALBLOCK_RECEIVED";
+    case TIMELINE_MARK_MICROBLOCK_SUBMITTED:
+      return "MICROBLOCK_SUBMITTED";
+    default:
+      return "UNKNOWN";
+  }
+}
+
+const char* EpochTimeline::GetRoleName(TimelineRole role) {
+  switch (role) {
+    case TIMELINE_ROLE_SHARD:
+      return "SHARD";
+    case TIMELINE_ROLE_DS:
+      return "DS";
+    case TIMELINE_ROLE_LOOKUP:
+      return "LOOKUP";
+    default:
+      return "UNKNOWN";
+  }
+}
+
+void EpochTimeline::OnNewEpoch(uint64_t epochNum, TimelineRole role) {
+  {
+    lock_guard<mutex> g(m_mutex);
+    m_currentEpoch = epochNum;
+  }
+  RecordMark(TIMELINE_MARK_NEW_EPOCH, role);
+}
+
+void EpochTimeline::Record(TimelineEventKind kind, uint8_t id,
+                           TimelineRole role,
+                           const chrono::steady_clock::time_point& when) {
+  if (m_events.empty()) {
+    return;
+  }
+
+  // Taken together with when, so both clocks refer to the same instant as
+  // nearly as the caller allows
+  const auto wall = chrono::system_clock::now() -
+                    chrono::duration_cast<chrono::system_clock::duration>(
+                        chrono::steady_clock::now() - when);
+
+  lock_guard<mutex> g(m_mutex);
+  TimelineEvent& event = m_events[m_next];
+  event.m_epoch = m_currentEpoch;
+  event.m_monotonicMicroseconds =
+      chrono::duration_cast<chrono::microseconds>(when - m_start).count();
+  event.m_wallMicroseconds = chrono::duration_cast<chrono::microseconds>(
+                                 wall.time_since_epoch())
+                                 .count();
+  event.m_kind = kind;
+  event.m_id = id;
+  event.m_role = role;
+
+  m_next = (m_next + 1) % m_events.size();
+  m_recorded++;
+}
+
+void EpochTimeline::RecordPhase(TimelineEventKind kind, EpochPhase phase,
+                                TimelineRole role,
+                                const chrono::steady_clock::time_point& when) {
+  Record(kind, phase, role, when);
+}
+
+void EpochTimeline::RecordMark(TimelineMark mark, TimelineRole role) {
+  Record(TIMELINE_MARK, mark, role, chrono::steady_clock::now());
+}
+
+vector<TimelineEvent> EpochTimeline::GetEvents(uint64_t fromEpoch) {
+  lock_guard<mutex> g(m_mutex);
+
+  vector<TimelineEvent> result;
+  const size_t count = min<uint64_t>(m_recorded, m_events.size());
+  const size_t first = (m_next + m_events.size() - count) % m_events.size();
+  for (size_t i = 0; i < count; i++) {
+    const TimelineEvent& event = m_events[(first + i) % m_events.size()];
+    if (event.m_epoch >= fromEpoch) {
+      result.emplace_back(event);
+    }
+  }
+  return result;
+}
+
+uint64_t EpochTimeline::GetRecordedCount() {
+  lock_guard<mutex> g(m_mutex);
+  return m_recorded;
+}
+
+EpochPhaseTimer::EpochPhaseTimer(TimelineRole role)
+    : m_phase(EPOCH_PHASE_NONE),
+      m_start(chrono::steady_clock::now()),
+      m_role(LOOKUP_NODE_MODE ? TIMELINE_ROLE_LOOKUP : role) {}
+
+void EpochPhaseTimer::Enter(EpochPhase phase) {
+  lock_guard<mutex> g(m_mutex);
+
+  if (phase == m_phase) {
+    return;
+  }
+
+  const auto now = chrono::steady_clock::now();
+  if (m_phase != EPOCH_PHASE_NONE) {
+    EpochMetrics::GetInstance().RecordPhase(
+        m_phase, chrono::duration_cast<chrono::microseconds>(now - m_start)
+                     .count());
+    EpochTimeline::GetInstance().RecordPhase(TIMELINE_PHASE_EXIT, m_phase,
+                                             m_role, now);
+  }
+  if (phase != EPOCH_PHASE_NONE) {
+    EpochTimeline::GetInstance().RecordPhase(TIMELINE_PHASE_ENTER, phase,
+                                             m_role, now);
+  }
+
+  m_phase = phase;
+  m_start = now;
+}
@@ -0,0 +1,231 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __EPOCHMETRICS_H__
+#define __EPOCHMETRICS_H__
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/// Parts of an epoch whose wall-clock duration is recorded
+enum EpochPhase : uint8_t {
+  EPOCH_PHASE_POW = 0,
+  EPOCH_PHASE_DS_CONSENSUS,
+  EPOCH_PHASE_MICROBLOCK_CONSENSUS,
+  EPOCH_PHASE_MICROBLOCK_SUBMISSION,
+  EPOCH_PHASE_FINALBLOCK_CONSENSUS,
+  EPOCH_PHASE_VIEWCHANGE,
+  EPOCH_PHASE_FALLBACK,
+  EPOCH_PHASE_NONE
+};
+
+struct MetricHistogram {
+  /// Bucket i counts values below 2^i times the first bound; the last bucket
+  /// is unbounded
+  static const unsigned int NUM_BUCKETS = 20;
+
+  uint64_t m_count;
+  uint64_t m_total;
+  uint64_t m_max;
+  uint64_t m_last;
+  std::array<uint64_t, NUM_BUCKETS> m_buckets;
+
+  void Add(uint64_t value, uint64_t firstBucket);
+};
+
+struct MessageMetrics {
+  static const uint64_t FIRST_TIME_BUCKET_IN_MICROSECONDS = 100;
+  static const uint64_t FIRST_SIZE_BUCKET_IN_BYTES = 64;
+
+  unsigned char m_msgType;
+  unsigned char m_instruction;
+  std::string m_name;
+  MetricHistogram m_time;
+  MetricHistogram m_size;
+};
+
+struct PhaseMetrics {
+  static const uint64_t FIRST_TIME_BUCKET_IN_MICROSECONDS = 1000;
+
+  EpochPhase m_phase;
+  uint64_t m_lastEpoch;
+  MetricHistogram m_time;
+};
+
+/// Per-message-type processing time and size, and per-phase epoch durations,
+/// since this node started.
+///
+/// If a dump file is configured, a snapshot of every histogram is appended to
+/// it every EPOCH_METRICS_DUMP_INTERVAL epochs, one fixed-size big-endian
+/// record per histogram: timestamp (8 bytes, microseconds since epoch), epoch
+/// number (8), kind (1: 0 message time, 1 message size, 2 phase time), ID (2:
+/// message type and instruction, or phase), count (8), total (8), max (8),
+/// last (8) and the NUM_BUCKETS bucket counts (8 each).
+class EpochMetrics {
+  std::mutex m_mutex;
+  std::map<uint16_t, MessageMetrics> m_messages;
+  std::array<PhaseMetrics, EPOCH_PHASE_NONE> m_phases;
+  uint64_t m_currentEpoch;
+  std::ofstream m_dumpFile;
+
+  EpochMetrics();
+  ~EpochMetrics();
+
+  EpochMetrics(EpochMetrics const&) = delete;
+  void operator=(EpochMetrics const&) = delete;
+
+ public:
+  static const unsigned int RECORD_SIZE =
+      51 + 8 * MetricHistogram::NUM_BUCKETS;
+
+  enum RecordKind : uint8_t {
+    RECORD_MESSAGE_TIME = 0,
+    RECORD_MESSAGE_SIZE,
+    RECORD_PHASE_TIME
+  };
+
+  /// Returns the singleton instance.
+  static EpochMetrics& GetInstance();
+
+  static const char* GetPhaseName(EpochPhase phase);
+
+  /// Adds one processed message
+  void RecordMessage(unsigned char msgType, unsigned char instruction,
+                     uint64_t sizeInBytes, uint64_t durationInMicroseconds);
+
+  /// Adds one completed epoch phase
+  void RecordPhase(EpochPhase phase, uint64_t durationInMicroseconds);
+
+  /// Moves to a new epoch, dumping a snapshot if one is due
+  void OnNewEpoch(uint64_t epochNum);
+
+  /// Returns the stats of every message type received at least once
+  std::vector<MessageMetrics> GetMessageStats();
+
+  /// Returns the stats of every phase completed at least once
+  std::vector<PhaseMetrics> GetPhaseStats();
+
+  /// Returns the current epoch as last reported by OnNewEpoch
+  uint64_t GetCurrentEpoch();
+
+  /// Returns the stats in the Prometheus text exposition format
+  std::string GetPrometheusText();
+};
+
+/// What the node was when a timeline event was recorded
+enum TimelineRole : uint8_t {
+  TIMELINE_ROLE_SHARD = 0,
+  TIMELINE_ROLE_DS,
+  TIMELINE_ROLE_LOOKUP
+};
+
+enum TimelineEventKind : uint8_t {
+  TIMELINE_PHASE_ENTER = 0,
+  TIMELINE_PHASE_EXIT,
+  TIMELINE_MARK
+};
+
+/// Points of an epoch that are not the boundary of a phase
+enum TimelineMark : uint8_t {
+  TIMELINE_MARK_NEW_EPOCH = 0,
+  TIMELINE_MARK_DSBLOCK_RECEIVED,
+  TIMELINE_MARK_FINALBLOCK_RECEIVED,
+  TIMELINE_MARK_MICROBLOCK_SUBMITTED,
+  TIMELINE_MARK_NONE
+};
+
+struct TimelineEvent {
+  uint64_t m_epoch;
+  /// Steady clock since the timeline was created, for durations on this node
+  uint64_t m_monotonicMicroseconds;
+  /// System clock, for lining up the timelines of different nodes
+  uint64_t m_wallMicroseconds;
+  TimelineEventKind m_kind;
+  /// EpochPhase for phase events, TimelineMark for marks
+  uint8_t m_id;
+  TimelineRole m_role;
+};
+
+/// The last EPOCH_TIMELINE_EVENTS phase boundaries and marks of this node,
+/// in the order they happened, for the GetEpochTimeline RPC.
+///
+/// Where EpochMetrics aggregates durations, this keeps the individual
+/// events with their timestamps so the timelines of many nodes can be
+/// merged (see src/diagnostic/mergetimelines). The ring buffer is allocated
+/// once; the oldest events are overwritten.
+class EpochTimeline {
+  std::mutex m_mutex;
+  std::vector<TimelineEvent> m_events;
+  size_t m_next;
+  uint64_t m_recorded;
+  uint64_t m_currentEpoch;
+  const std::chrono::steady_clock::time_point m_start;
+
+  EpochTimeline();
+  ~EpochTimeline() = default;
+
+  EpochTimeline(EpochTimeline const&) = delete;
+  void operator=(EpochTimeline const&) = delete;
+
+  void Record(TimelineEventKind kind, uint8_t id, TimelineRole role,
+              const std::chrono::steady_clock::time_point& when);
+
+ public:
+  /// Returns the singleton instance.
+  static EpochTimeline& GetInstance();
+
+  static const char* GetKindName(TimelineEventKind kind);
+  static const char* GetMarkName(TimelineMark mark);
+  static const char* GetRoleName(TimelineRole role);
+
+  /// Moves to a new epoch and records TIMELINE_MARK_NEW_EPOCH
+  void OnNewEpoch(uint64_t epochNum, TimelineRole role);
+
+  void RecordPhase(TimelineEventKind kind, EpochPhase phase, TimelineRole role,
+                   const std::chrono::steady_clock::time_point& when);
+
+  void RecordMark(TimelineMark mark, TimelineRole role);
+
+  /// Returns the buffered events of epochs from fromEpoch on, oldest first
+  std::vector<TimelineEvent> GetEvents(uint64_t fromEpoch = 0);
+
+  /// Returns the number of events recorded since start, overwritten or not
+  uint64_t GetRecordedCount();
+};
+
+/// Times the phase a state machine is in, reporting each finished phase to
+/// EpochMetrics and both ends of it to EpochTimeline when the machine moves
+/// to a different one.
+class EpochPhaseTimer {
+  std::mutex m_mutex;
+  EpochPhase m_phase;
+  std::chrono::steady_clock::time_point m_start;
+  const TimelineRole m_role;
+
+ public:
+  explicit EpochPhaseTimer(TimelineRole role = TIMELINE_ROLE_SHARD);
+
+  void Enter(EpochPhase phase);
+};
+
+#endif  // __EPOCHMETRICS_H__
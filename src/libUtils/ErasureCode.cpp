@@ -0,0 +1,224 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <array>
+
+#include "ErasureCode.h"
+#include "Logger.h"
+
+using namespace std;
+
+namespace {
+
+// Log and antilog tables for GF(2^8) with polynomial x^8+x^4+x^3+x^2+1
+struct GaloisField {
+  array<uint8_t, 512> m_exp;
+  array<uint8_t, 256> m_log;
+
+  GaloisField() {
+    unsigned int x = 1;
+    for (unsigned int i = 0; i < 255; i++) {
+      m_exp[i] = x;
+      m_log[x] = i;
+      x <<= 1;
+      if (x & 0x100) {
+        x ^= 0x11d;
+      }
+    }
+    for (unsigned int i = 255; i < m_exp.size(); i++) {
+      m_exp[i] = m_exp[i - 255];
+    }
+    m_log[0] = 0;
+  }
+
+  uint8_t Mul(uint8_t a, uint8_t b) const {
+    if (a == 0 || b == 0) {
+      return 0;
+    }
+    return m_exp[m_log[a] + m_log[b]];
+  }
+
+  uint8_t Inv(uint8_t a) const { return m_exp[255 - m_log[a]]; }
+
+  /// dst ^= c * src
+  void MulAdd(bytes& dst, const bytes& src, uint8_t c) const {
+    if (c == 0) {
+      return;
+    }
+    const unsigned int logC = m_log[c];
+    for (size_t i = 0; i < dst.size(); i++) {
+      if (src[i] != 0) {
+        dst[i] ^= m_exp[m_log[src[i]] + logC];
+      }
+    }
+  }
+};
+
+const GaloisField& GF() {
+  static const GaloisField gf;
+  return gf;
+}
+
+// Coefficient of data chunk col in parity chunk row (row >= k), taken from
+// the Cauchy matrix 1 / (x_row + y_col) with x_row = row and y_col = col
+uint8_t Coefficient(unsigned int row, unsigned int col) {
+  return GF().Inv(row ^ col);
+}
+
+bool CheckParams(unsigned int k, unsigned int n) {
+  if (k == 0 || k > n || n > ErasureCode::MAX_CHUNKS) {
+    LOG_GENERAL(WARNING, "Invalid erasure code parameters k=" << k
+                                                              << " n=" << n);
+    return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+const unsigned int ErasureCode::MAX_CHUNKS;
+
+size_t ErasureCode::GetChunkSize(size_t dataSize, unsigned int k) {
+  return k == 0 ? 0 : max<size_t>(1, (dataSize + k - 1) / k);
+}
+
+bool ErasureCode::Encode(const bytes& data, unsigned int k, unsigned int n,
+                         vector<bytes>& chunks) {
+  if (!CheckParams(k, n)) {
+    return false;
+  }
+
+  const size_t chunkSize = GetChunkSize(data.size(), k);
+
+  chunks.assign(n, bytes(chunkSize, 0));
+  for (unsigned int i = 0; i < k; i++) {
+    const size_t begin = min(data.size(), i * chunkSize);
+    const size_t end = min(data.size(), begin + chunkSize);
+    copy(data.begin() + begin, data.begin() + end, chunks[i].begin());
+  }
+
+  for (unsigned int row = k; row < n; row++) {
+    for (unsigned int col = 0; col < k; col++) {
+      GF().MulAdd(chunks[row], chunks[col], Coefficient(row, col));
+    }
+  }
+
+  return true;
+}
+
+bool ErasureCode::Decode(const map<unsigned int, bytes>& chunks,
+                         unsigned int k, unsigned int n, size_t dataSize,
+                         bytes& data) {
+  if (!CheckParams(k, n)) {
+    return false;
+  }
+
+  const size_t chunkSize = GetChunkSize(dataSize, k);
+
+  // Pick k chunks, data chunks first since they need no arithmetic
+  vector<unsigned int> rows;
+  for (const auto& entry : chunks) {
+    if (rows.size() == k) {
+      break;
+    }
+    if (entry.first >= n || entry.second.size() != chunkSize) {
+      LOG_GENERAL(WARNING, "Invalid chunk " << entry.first << " of size "
+                                            << entry.second.size());
+      return false;
+    }
+    rows.emplace_back(entry.first);
+  }
+
+  if (rows.size() < k) {
+    LOG_GENERAL(WARNING,
+                "Need " << k << " chunks to decode, have " << rows.size());
+    return false;
+  }
+
+  vector<bytes> decoded(k);
+  vector<unsigned int> missing;
+  vector<bool> present(k, false);
+  for (const auto& row : rows) {
+    if (row < k) {
+      decoded[row] = chunks.at(row);
+      present[row] = true;
+    }
+  }
+  for (unsigned int i = 0; i < k; i++) {
+    if (!present[i]) {
+      missing.emplace_back(i);
+    }
+  }
+
+  if (!missing.empty()) {
+    // Rows of the encoding matrix for the chosen chunks are unit vectors for
+    // data chunks and Cauchy rows for parity chunks; every such k x k matrix
+    // is invertible, so Gauss-Jordan elimination always finds a pivot
+    vector<vector<uint8_t>> matrix(k, vector<uint8_t>(2 * k, 0));
+    for (unsigned int r = 0; r < k; r++) {
+      for (unsigned int c = 0; c < k; c++) {
+        matrix[r][c] =
+            rows[r] < k ? (rows[r] == c ? 1 : 0) : Coefficient(rows[r], c);
+      }
+      matrix[r][k + r] = 1;
+    }
+
+    for (unsigned int c = 0; c < k; c++) {
+      unsigned int pivot = c;
+      while (pivot < k && matrix[pivot][c] == 0) {
+        pivot++;
+      }
+      if (pivot == k) {
+        LOG_GENERAL(WARNING, "Singular decoding matrix");
+        return false;
+      }
+      swap(matrix[c], matrix[pivot]);
+
+      const uint8_t inv = GF().Inv(matrix[c][c]);
+      for (auto& v : matrix[c]) {
+        v = GF().Mul(v, inv);
+      }
+
+      for (unsigned int r = 0; r < k; r++) {
+        const uint8_t factor = matrix[r][c];
+        if (r == c || factor == 0) {
+          continue;
+        }
+        for (unsigned int i = 0; i < 2 * k; i++) {
+          matrix[r][i] ^= GF().Mul(factor, matrix[c][i]);
+        }
+      }
+    }
+
+    for (const auto& i : missing) {
+      decoded[i].assign(chunkSize, 0);
+      for (unsigned int r = 0; r < k; r++) {
+        GF().MulAdd(decoded[i], chunks.at(rows[r]), matrix[i][k + r]);
+      }
+    }
+  }
+
+  data.clear();
+  data.reserve(chunkSize * k);
+  for (const auto& chunk : decoded) {
+    data.insert(data.end(), chunk.begin(), chunk.end());
+  }
+  data.resize(dataSize);
+
+  return true;
+}
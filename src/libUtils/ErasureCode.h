@@ -0,0 +1,48 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __ERASURECODE_H__
+#define __ERASURECODE_H__
+
+#include <cstddef>
+#include <map>
+#include <vector>
+
+#include "common/BaseType.h"
+
+/// Systematic Reed-Solomon code over GF(2^8).
+///
+/// Data is split into k equal chunks, padded with zeros, and n - k parity
+/// chunks are added from a Cauchy matrix, so that any k of the n chunks
+/// give back the data. Chunks 0 to k - 1 are the data itself.
+class ErasureCode {
+ public:
+  static const unsigned int MAX_CHUNKS = 256;
+
+  /// Splits data into n chunks of which any k reconstruct it
+  static bool Encode(const bytes& data, unsigned int k, unsigned int n,
+                     std::vector<bytes>& chunks);
+
+  /// Rebuilds dataSize bytes from at least k chunks keyed by chunk index
+  static bool Decode(const std::map<unsigned int, bytes>& chunks,
+                     unsigned int k, unsigned int n, size_t dataSize,
+                     bytes& data);
+
+  static size_t GetChunkSize(size_t dataSize, unsigned int k);
+};
+
+#endif  // __ERASURECODE_H__
@@ -0,0 +1,184 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <sys/mman.h>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <mutex>
+#include <unordered_map>
+
+#include "HugePages.h"
+#include "libUtils/Logger.h"
+
+using namespace std;
+
+namespace {
+
+const size_t TRANSPARENT_PAGE_SIZE = 2 * 1024 * 1024;
+
+struct Mapping {
+  size_t m_size;
+  bool m_huge;
+};
+
+mutex g_mutex;
+unordered_map<void*, Mapping> g_mappings;
+atomic<size_t> g_hugeBytes{0};
+
+size_t RoundUp(size_t size, size_t unit) {
+  return (size + unit - 1) / unit * unit;
+}
+
+/// The default hugetlbfs page size, which MAP_HUGETLB maps with
+size_t GetExplicitPageSize() {
+  static const size_t pageSize = []() -> size_t {
+    ifstream meminfo("/proc/meminfo");
+    string key;
+    size_t value = 0;
+    while (meminfo >> key >> value) {
+      if (key == "Hugepagesize:") {
+        return value * 1024;
+      }
+      meminfo.ignore(256, '\n');
+    }
+    return TRANSPARENT_PAGE_SIZE;
+  }();
+  return pageSize;
+}
+
+void* MapExplicit(size_t size, size_t& mapped) {
+#ifdef MAP_HUGETLB
+  mapped = RoundUp(size, GetExplicitPageSize());
+  void* addr = mmap(nullptr, mapped, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+  return (addr == MAP_FAILED) ? nullptr : addr;
+#else
+  (void)size;
+  (void)mapped;
+  return nullptr;
+#endif
+}
+
+/// Maps on a 2 MB boundary, so that the whole range can be made of
+/// transparent huge pages
+void* MapAligned(size_t size, size_t& mapped) {
+  mapped = RoundUp(size, TRANSPARENT_PAGE_SIZE);
+  const size_t padded = mapped + TRANSPARENT_PAGE_SIZE;
+  void* addr = mmap(nullptr, padded, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (addr == MAP_FAILED) {
+    return nullptr;
+  }
+
+  char* const start = static_cast<char*>(addr);
+  char* const aligned = reinterpret_cast<char*>(
+      RoundUp(reinterpret_cast<uintptr_t>(start), TRANSPARENT_PAGE_SIZE));
+  if (aligned > start) {
+    munmap(start, aligned - start);
+  }
+  munmap(aligned + mapped, start + padded - (aligned + mapped));
+  return aligned;
+}
+
+}  // namespace
+
+bool HugePages::ParseMode(const string& str, Mode& mode) {
+  if (str == "off") {
+    mode = OFF;
+  } else if (str == "transparent") {
+    mode = TRANSPARENT;
+  } else if (str == "explicit") {
+    mode = EXPLICIT;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+void* HugePages::Allocate(size_t size, Mode mode) {
+  if (mode == OFF || size == 0) {
+    return calloc(1, size);
+  }
+
+  size_t mapped = 0;
+  bool huge = false;
+  void* addr = nullptr;
+
+  if (mode == EXPLICIT) {
+    addr = MapExplicit(size, mapped);
+    if (addr != nullptr) {
+      huge = true;
+    } else {
+      LOG_GENERAL(INFO, "No explicit huge pages for "
+                            << (size >> 20)
+                            << " MB (see vm.nr_hugepages), trying "
+                               "transparent ones");
+    }
+  }
+
+  if (addr == nullptr) {
+    addr = MapAligned(size, mapped);
+    if (addr == nullptr) {
+      LOG_GENERAL(WARNING, "mmap failure for " << (size >> 20) << " MB");
+      return nullptr;
+    }
+#ifdef MADV_HUGEPAGE
+    huge = (madvise(addr, mapped, MADV_HUGEPAGE) == 0);
+#endif
+    if (!huge) {
+      LOG_GENERAL(INFO, "Transparent huge pages unavailable, using normal "
+                        "pages for "
+                            << (size >> 20) << " MB");
+    }
+  }
+
+  {
+    lock_guard<mutex> g(g_mutex);
+    g_mappings.emplace(addr, Mapping{mapped, huge});
+  }
+  if (huge) {
+    g_hugeBytes += mapped;
+  }
+  return addr;
+}
+
+void HugePages::Release(void* ptr) {
+  if (ptr == nullptr) {
+    return;
+  }
+
+  Mapping mapping{0, false};
+  {
+    lock_guard<mutex> g(g_mutex);
+    const auto it = g_mappings.find(ptr);
+    if (it == g_mappings.end()) {
+      free(ptr);
+      return;
+    }
+    mapping = it->second;
+    g_mappings.erase(it);
+  }
+
+  if (mapping.m_huge) {
+    g_hugeBytes -= mapping.m_size;
+  }
+  munmap(ptr, mapping.m_size);
+}
+
+size_t HugePages::GetHugeBytes() { return g_hugeBytes; }
@@ -0,0 +1,50 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __HUGEPAGES_H__
+#define __HUGEPAGES_H__
+
+#include <cstddef>
+#include <string>
+
+/// Large, long-lived buffers on huge pages, to spare the TLB misses of
+/// random reads over gigabytes (the ethash full dataset).
+///
+/// EXPLICIT takes pages from the reserved hugetlbfs pool
+/// (vm.nr_hugepages), TRANSPARENT asks the kernel to back a 2 MB aligned
+/// mapping with transparent huge pages. Each falls back to the next when the
+/// system has none to give, down to normal pages.
+class HugePages {
+ public:
+  enum Mode : unsigned char { OFF = 0, TRANSPARENT, EXPLICIT };
+
+  /// Reads "off", "transparent" or "explicit", as set in constants.xml
+  static bool ParseMode(const std::string& str, Mode& mode);
+
+  /// Zero-filled memory of size bytes, or null when out of memory
+  static void* Allocate(size_t size, Mode mode);
+
+  /// Releases memory from Allocate. Pointers it did not hand out are passed
+  /// to free().
+  static void Release(void* ptr);
+
+  /// Bytes handed out on explicit huge pages or advised to be transparent
+  /// ones (which the kernel may still back with normal pages)
+  static size_t GetHugeBytes();
+};
+
+#endif  // __HUGEPAGES_H__
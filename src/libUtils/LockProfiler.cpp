@@ -0,0 +1,171 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+#include <fstream>
+
+#include "LockProfiler.h"
+#include "common/Constants.h"
+
+using namespace std;
+
+namespace {
+void UpdateMax(atomic<uint64_t>& max, uint64_t value) {
+  uint64_t current = max.load(memory_order_relaxed);
+  while (value > current &&
+         !max.compare_exchange_weak(current, value, memory_order_relaxed)) {
+  }
+}
+
+int32_t CurrentThreadId() {
+  static thread_local int32_t tid =
+      static_cast<int32_t>(syscall(SYS_gettid));
+  return tid;
+}
+
+string ThreadName(int32_t tid) {
+  ifstream comm("/proc/self/task/" + to_string(tid) + "/comm");
+  string name;
+  if (!getline(comm, name) || name.empty()) {
+    name = "thread-" + to_string(tid);
+  }
+  return name;
+}
+
+uint64_t NanosecondsSince(const chrono::steady_clock::time_point& start) {
+  return chrono::duration_cast<chrono::nanoseconds>(
+             chrono::steady_clock::now() - start)
+      .count();
+}
+}  // namespace
+
+void LockProfiler::Counters::RecordWait(uint64_t nanoseconds) {
+  m_contentions.fetch_add(1, memory_order_relaxed);
+  m_waitNanoseconds.fetch_add(nanoseconds, memory_order_relaxed);
+  UpdateMax(m_maxWaitNanoseconds, nanoseconds);
+
+  lock_guard<mutex> g(m_mutexWaiters);
+  m_waitByThread[CurrentThreadId()] += nanoseconds;
+}
+
+void LockProfiler::Counters::RecordHold(uint64_t nanoseconds) {
+  m_holdNanoseconds.fetch_add(nanoseconds, memory_order_relaxed);
+  UpdateMax(m_maxHoldNanoseconds, nanoseconds);
+}
+
+LockProfiler& LockProfiler::GetInstance() {
+  static LockProfiler lockProfiler;
+  return lockProfiler;
+}
+
+LockProfiler::Counters& LockProfiler::GetCounters(const string& name) {
+  lock_guard<mutex> g(m_mutex);
+  return m_counters[name];
+}
+
+vector<LockStats> LockProfiler::Collect() {
+  lock_guard<mutex> g(m_mutex);
+
+  vector<LockStats> result;
+  for (auto& entry : m_counters) {
+    Counters& counters = entry.second;
+
+    LockStats stats;
+    stats.m_name = entry.first;
+    stats.m_acquisitions = counters.m_acquisitions;
+    stats.m_contentions = counters.m_contentions;
+    stats.m_waitMicroseconds = counters.m_waitNanoseconds / 1000;
+    stats.m_maxWaitMicroseconds = counters.m_maxWaitNanoseconds / 1000;
+    stats.m_holdMicroseconds = counters.m_holdNanoseconds / 1000;
+    stats.m_maxHoldMicroseconds = counters.m_maxHoldNanoseconds / 1000;
+
+    vector<pair<int32_t, uint64_t>> waiters;
+    {
+      lock_guard<mutex> g2(counters.m_mutexWaiters);
+      waiters.assign(counters.m_waitByThread.begin(),
+                     counters.m_waitByThread.end());
+    }
+    const size_t top = min<size_t>(TOP_WAITERS, waiters.size());
+    partial_sort(waiters.begin(), waiters.begin() + top, waiters.end(),
+                 [](const pair<int32_t, uint64_t>& a,
+                    const pair<int32_t, uint64_t>& b) {
+                   return a.second > b.second;
+                 });
+    for (size_t i = 0; i < top; i++) {
+      stats.m_topWaiters.emplace_back(ThreadName(waiters[i].first),
+                                      waiters[i].second / 1000);
+    }
+
+    result.emplace_back(move(stats));
+  }
+  return result;
+}
+
+void LockProfiler::Reset() {
+  lock_guard<mutex> g(m_mutex);
+
+  for (auto& entry : m_counters) {
+    Counters& counters = entry.second;
+    counters.m_acquisitions = 0;
+    counters.m_contentions = 0;
+    counters.m_waitNanoseconds = 0;
+    counters.m_maxWaitNanoseconds = 0;
+    counters.m_holdNanoseconds = 0;
+    counters.m_maxHoldNanoseconds = 0;
+
+    lock_guard<mutex> g2(counters.m_mutexWaiters);
+    counters.m_waitByThread.clear();
+  }
+}
+
+ProfiledMutex::ProfiledMutex(const string& name)
+    : m_counters(LockProfiler::GetInstance().GetCounters(name)) {}
+
+void ProfiledMutex::lock() {
+  if (!LOCK_PROFILING) {
+    m_mutex.lock();
+    return;
+  }
+
+  if (!m_mutex.try_lock()) {
+    const auto start = chrono::steady_clock::now();
+    m_mutex.lock();
+    m_counters.RecordWait(NanosecondsSince(start));
+  }
+  m_counters.m_acquisitions.fetch_add(1, memory_order_relaxed);
+  m_acquired = chrono::steady_clock::now();
+}
+
+bool ProfiledMutex::try_lock() {
+  if (!m_mutex.try_lock()) {
+    return false;
+  }
+  if (LOCK_PROFILING) {
+    m_counters.m_acquisitions.fetch_add(1, memory_order_relaxed);
+    m_acquired = chrono::steady_clock::now();
+  }
+  return true;
+}
+
+void ProfiledMutex::unlock() {
+  if (LOCK_PROFILING) {
+    m_counters.RecordHold(NanosecondsSince(m_acquired));
+  }
+  m_mutex.unlock();
+}
@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __LOCKPROFILER_H__
+#define __LOCKPROFILER_H__
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/// Wait and hold times of one named lock, as reported by GetLockStats
+struct LockStats {
+  std::string m_name;
+  uint64_t m_acquisitions = 0;
+  uint64_t m_contentions = 0;
+  uint64_t m_waitMicroseconds = 0;
+  uint64_t m_maxWaitMicroseconds = 0;
+  uint64_t m_holdMicroseconds = 0;
+  uint64_t m_maxHoldMicroseconds = 0;
+  /// Thread name and total wait of the threads that waited longest
+  std::vector<std::pair<std::string, uint64_t>> m_topWaiters;
+};
+
+/// Registry of the counters behind every ProfiledMutex.
+///
+/// Mutexes sharing a name share counters, so a family of locks (the shards
+/// of one table, several instances of one class) shows up as one entry.
+/// Uncontended acquisitions only touch atomics; the per-thread wait totals
+/// are updated under a lock of their own, and only after a thread had to
+/// wait.
+class LockProfiler {
+ public:
+  static const unsigned int TOP_WAITERS = 5;
+
+  struct Counters {
+    std::atomic<uint64_t> m_acquisitions{0};
+    std::atomic<uint64_t> m_contentions{0};
+    std::atomic<uint64_t> m_waitNanoseconds{0};
+    std::atomic<uint64_t> m_maxWaitNanoseconds{0};
+    std::atomic<uint64_t> m_holdNanoseconds{0};
+    std::atomic<uint64_t> m_maxHoldNanoseconds{0};
+    std::mutex m_mutexWaiters;
+    std::unordered_map<int32_t, uint64_t> m_waitByThread;
+
+    void RecordWait(uint64_t nanoseconds);
+    void RecordHold(uint64_t nanoseconds);
+  };
+
+ private:
+  std::mutex m_mutex;
+  std::map<std::string, Counters> m_counters;
+
+  LockProfiler() = default;
+  ~LockProfiler() = default;
+
+  LockProfiler(LockProfiler const&) = delete;
+  void operator=(LockProfiler const&) = delete;
+
+ public:
+  /// Returns the singleton instance.
+  static LockProfiler& GetInstance();
+
+  /// Returns the counters of the named lock, creating them on first use.
+  /// The reference stays valid for the lifetime of the process.
+  Counters& GetCounters(const std::string& name);
+
+  /// Snapshot of every lock, in name order
+  std::vector<LockStats> Collect();
+
+  /// Zeroes all counters, keeping the registered names
+  void Reset();
+};
+
+/// Drop-in replacement for std::mutex that feeds LockProfiler.
+///
+/// With LOCK_PROFILING off, lock and unlock forward to the underlying mutex
+/// after one branch. With it on, an acquisition that succeeds on the first
+/// try only counts, a contended one also measures how long it waited, and
+/// unlock adds the time the lock was held. Meets Lockable, so it works with
+/// lock_guard, unique_lock and std::lock; condition variables need
+/// std::condition_variable_any.
+class ProfiledMutex {
+  std::mutex m_mutex;
+  LockProfiler::Counters& m_counters;
+  /// Written by the owner only, so guarded by m_mutex itself
+  std::chrono::steady_clock::time_point m_acquired;
+
+  ProfiledMutex(ProfiledMutex const&) = delete;
+  void operator=(ProfiledMutex const&) = delete;
+
+ public:
+  explicit ProfiledMutex(const std::string& name);
+
+  void lock();
+  bool try_lock();
+  void unlock();
+};
+
+#endif  // __LOCKPROFILER_H__
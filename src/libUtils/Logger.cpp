@@ -21,6 +21,7 @@
 #include <sys/syscall.h>
 #include <unistd.h>
 #include <cstring>
+#include <ctime>
 #include <iostream>
 using namespace std;
 using namespace g3;
@@ -48,24 +49,48 @@ inline pid_t getCurrentPid() {
 const streampos Logger::MAX_FILE_SIZE =
     1024 * 1024 * 100;  // 100MB per log file
 
-Logger::Logger(const char* prefix, bool log_to_file, streampos max_file_size) {
+Logger::CallSite::CallSite(const char* filename, const unsigned int linenum,
+                           const char* function) {
+  ostringstream oss;
+  const string fileAndLine = string(filename) + ":" + to_string(linenum);
+  oss << LIMIT_RIGHT(fileAndLine, Logger::MAX_FILEANDLINE_LEN);
+  m_fileAndLine = oss.str();
+  oss.str("");
+  oss << LIMIT(function, Logger::MAX_FUNCNAME_LEN);
+  m_function = oss.str();
+}
+
+Logger::Logger(const char* prefix, bool log_to_file, streampos max_file_size)
+    : m_stopWriter(false), m_fileSize(0) {
   this->m_logToFile = log_to_file;
   this->m_maxFileSize = max_file_size;
+  this->m_bRefactor = false;
 
   if (log_to_file) {
     m_fileNamePrefix = prefix ? prefix : "common";
     m_seqNum = 0;
     newLog();
+
+    if (!m_bRefactor) {
+      m_writer = thread(&Logger::WriterLoop, this);
+    }
   }
 }
 
-Logger::~Logger() { m_logFile.close(); }
+Logger::~Logger() {
+  if (m_writer.joinable()) {
+    {
+      lock_guard<mutex> g(m_mutexPending);
+      m_stopWriter = true;
+    }
+    m_cvPending.notify_one();
+    m_writer.join();
+  }
+  m_logFile.close();
+}
 
 void Logger::checkLog() {
-  std::ifstream in(m_fileName.c_str(),
-                   std::ifstream::ate | std::ifstream::binary);
-
-  if (in.tellg() >= m_maxFileSize) {
+  if (m_fileSize >= m_maxFileSize) {
     m_logFile.close();
     newLog();
   }
@@ -92,6 +117,46 @@ void Logger::newLog() {
     initializeLogging(logworker.get());
   } else {
     m_logFile.open(m_fileName.c_str(), ios_base::app);
+    m_logFile.seekp(0, ios_base::end);
+    m_fileSize = max<streamoff>(m_logFile.tellp(), 0);
+  }
+}
+
+void Logger::Output(string&& line) {
+  if (!m_logToFile) {
+    lock_guard<mutex> guard(m);
+    cout << line << endl;
+    return;
+  }
+
+  {
+    lock_guard<mutex> g(m_mutexPending);
+    m_pending.emplace_back(move(line));
+  }
+  m_cvPending.notify_one();
+}
+
+void Logger::WriterLoop() {
+  vector<string> batch;
+
+  while (true) {
+    {
+      unique_lock<mutex> g(m_mutexPending);
+      m_cvPending.wait(g,
+                       [this] { return m_stopWriter || !m_pending.empty(); });
+      if (m_pending.empty()) {
+        return;
+      }
+      batch.swap(m_pending);
+    }
+
+    for (const auto& line : batch) {
+      checkLog();
+      m_logFile << line << '\n';
+      m_fileSize += line.size() + 1;
+    }
+    m_logFile.flush();
+    batch.clear();
   }
 }
 
@@ -113,193 +178,44 @@ Logger& Logger::GetEpochInfoLogger(const char* fname_prefix, bool log_to_file,
   return logger;
 }
 
-void Logger::LogState(const char* msg) {
-  lock_guard<mutex> guard(m);
-
-  if (m_logToFile) {
-    checkLog();
-    m_logFile << msg << endl << flush;
-  } else {
-    cout << msg << endl << flush;
-  }
-}
+void Logger::LogState(const char* msg) { Output(msg); }
 
-void Logger::LogGeneral(LEVELS level, const char* msg,
-                        const unsigned int linenum, const char* filename,
-                        const char* function) {
+void Logger::LogGeneral(LEVELS level, const char* msg, const CallSite& site) {
   if (IsG3Log()) {
-    auto cur = chrono::system_clock::now();
-    auto cur_time_t = chrono::system_clock::to_time_t(cur);
-    LOG(level) << "[" << PAD(GetPid(), TID_LEN, ' ') << "]["
-               << put_time(gmtime(&cur_time_t), "%y-%m-%dT%T.")
-               << PAD(get_ms(cur), 3, '0') << "]["
-               << LIMIT_RIGHT(std::string(std::string(filename) + ":" +
-                                          std::to_string(linenum)),
-                              Logger::MAX_FILEANDLINE_LEN)
-               << "][" << LIMIT(function, MAX_FUNCNAME_LEN) << "] " << msg;
+    LOG(level) << LOG_HEADER(site) << " " << msg;
     return;
   }
 
-  lock_guard<mutex> guard(m);
-
-  if (m_logToFile) {
-    checkLog();
-    auto cur = chrono::system_clock::now();
-    auto cur_time_t = chrono::system_clock::to_time_t(cur);
-    m_logFile << "[" << PAD(GetPid(), TID_LEN, ' ') << "]["
-              << put_time(gmtime(&cur_time_t), "%y-%m-%dT%T.")
-              << PAD(get_ms(cur), 3, '0') << "]["
-              << LIMIT_RIGHT(std::string(std::string(filename) + ":" +
-                                         std::to_string(linenum)),
-                             Logger::MAX_FILEANDLINE_LEN)
-              << "][" << LIMIT(function, MAX_FUNCNAME_LEN) << "] " << msg
-              << endl
-              << flush;
-  } else {
-    auto cur = chrono::system_clock::now();
-    auto cur_time_t = chrono::system_clock::to_time_t(cur);
-    cout << "[" << PAD(GetPid(), TID_LEN, ' ') << "]["
-         << put_time(gmtime(&cur_time_t), "%y-%m-%dT%T.")
-         << PAD(get_ms(cur), 3, '0') << "]["
-         << LIMIT_RIGHT(std::string(std::string(filename) + ":" +
-                                    std::to_string(linenum)),
-                        Logger::MAX_FILEANDLINE_LEN)
-         << "][" << LIMIT(function, MAX_FUNCNAME_LEN) << "] " << msg << endl
-         << flush;
-  }
+  ostringstream oss;
+  oss << LOG_HEADER(site) << " " << msg;
+  Output(oss.str());
 }
 
 void Logger::LogEpoch([[gnu::unused]] LEVELS level, const char* msg,
-                      const char* epoch, const unsigned int linenum,
-                      const char* filename, const char* function) {
-  lock_guard<mutex> guard(m);
-
-  if (m_logToFile) {
-    checkLog();
-    auto cur = chrono::system_clock::now();
-    auto cur_time_t = chrono::system_clock::to_time_t(cur);
-    m_logFile << "[" << PAD(GetPid(), TID_LEN, ' ') << "]["
-              << put_time(gmtime(&cur_time_t), "%y-%m-%dT%T.")
-              << PAD(get_ms(cur), 3, '0') << "]["
-              << LIMIT_RIGHT(std::string(std::string(filename) + ":" +
-                                         std::to_string(linenum)),
-                             Logger::MAX_FILEANDLINE_LEN)
-              << "][" << LIMIT(function, MAX_FUNCNAME_LEN) << "] [Epoch "
-              << epoch << "] " << msg << endl
-              << flush;
-  } else {
-    auto cur = chrono::system_clock::now();
-    auto cur_time_t = chrono::system_clock::to_time_t(cur);
-    cout << "[" << PAD(GetPid(), TID_LEN, ' ') << "]["
-         << put_time(gmtime(&cur_time_t), "%y-%m-%dT%T.")
-         << PAD(get_ms(cur), 3, '0') << "]["
-         << LIMIT_RIGHT(std::string(std::string(filename) + ":" +
-                                    std::to_string(linenum)),
-                        Logger::MAX_FILEANDLINE_LEN)
-         << "][" << LIMIT(function, MAX_FUNCNAME_LEN) << "] [Epoch " << epoch
-         << "] " << msg << endl
-         << flush;
-  }
+                      const char* epoch, const CallSite& site) {
+  ostringstream oss;
+  oss << LOG_HEADER(site) << " [Epoch " << epoch << "] " << msg;
+  Output(oss.str());
 }
 
 void Logger::LogPayload([[gnu::unused]] LEVELS level, const char* msg,
                         const bytes& payload, size_t max_bytes_to_display,
-                        const unsigned int linenum, const char* filename,
-                        const char* function) {
+                        const CallSite& site) {
   std::unique_ptr<char[]> payload_string;
   GetPayloadS(payload, max_bytes_to_display, payload_string);
-  lock_guard<mutex> guard(m);
-
-  if (m_logToFile) {
-    checkLog();
-    auto cur = chrono::system_clock::now();
-    auto cur_time_t = chrono::system_clock::to_time_t(cur);
-
-    if (payload.size() > max_bytes_to_display) {
-      m_logFile << "[" << PAD(GetPid(), TID_LEN, ' ') << "]["
-                << put_time(gmtime(&cur_time_t), "%y-%m-%dT%T.")
-                << PAD(get_ms(cur), 3, '0') << "]["
-                << LIMIT_RIGHT(std::string(std::string(filename) + ":" +
-                                           std::to_string(linenum)),
-                               Logger::MAX_FILEANDLINE_LEN)
-                << "][" << LIMIT(function, MAX_FUNCNAME_LEN) << "] " << msg
-                << " (Len=" << payload.size() << "): " << payload_string.get()
-                << "..." << endl
-                << flush;
-    } else {
-      m_logFile << "[" << PAD(GetPid(), TID_LEN, ' ') << "]["
-                << put_time(gmtime(&cur_time_t), "%y-%m-%dT%T.")
-                << PAD(get_ms(cur), 3, '0') << "]["
-                << LIMIT_RIGHT(std::string(std::string(filename) + ":" +
-                                           std::to_string(linenum)),
-                               Logger::MAX_FILEANDLINE_LEN)
-                << "][" << LIMIT(function, MAX_FUNCNAME_LEN) << "] " << msg
-                << " (Len=" << payload.size() << "): " << payload_string.get()
-                << endl
-                << flush;
-    }
-  } else {
-    auto cur = chrono::system_clock::now();
-    auto cur_time_t = chrono::system_clock::to_time_t(cur);
-
-    if (payload.size() > max_bytes_to_display) {
-      cout << "[" << PAD(GetPid(), TID_LEN, ' ') << "]["
-           << put_time(gmtime(&cur_time_t), "%y-%m-%dT%T.")
-           << PAD(get_ms(cur), 3, '0') << "]["
-           << LIMIT_RIGHT(std::string(std::string(filename) + ":" +
-                                      std::to_string(linenum)),
-                          Logger::MAX_FILEANDLINE_LEN)
-           << "][" << LIMIT(function, MAX_FUNCNAME_LEN) << "] " << msg
-           << " (Len=" << payload.size() << "): " << payload_string.get()
-           << "..." << endl
-           << flush;
-    } else {
-      cout << "[" << PAD(GetPid(), TID_LEN, ' ') << "]["
-           << put_time(gmtime(&cur_time_t), "%y-%m-%dT%T.")
-           << PAD(get_ms(cur), 3, '0') << "]["
-           << LIMIT_RIGHT(std::string(std::string(filename) + ":" +
-                                      std::to_string(linenum)),
-                          Logger::MAX_FILEANDLINE_LEN)
-           << "][" << LIMIT(function, MAX_FUNCNAME_LEN) << "] " << msg
-           << " (Len=" << payload.size() << "): " << payload_string.get()
-           << endl
-           << flush;
-    }
-  }
+
+  ostringstream oss;
+  oss << LOG_HEADER(site) << " " << msg << " (Len=" << payload.size()
+      << "): " << payload_string.get()
+      << ((payload.size() > max_bytes_to_display) ? "..." : "");
+  Output(oss.str());
 }
 
-void Logger::LogEpochInfo(const char* msg, const unsigned int linenum,
-                          const char* filename, const char* function,
+void Logger::LogEpochInfo(const char* msg, const CallSite& site,
                           const char* epoch) {
-  pid_t tid = getCurrentPid();
-  lock_guard<mutex> guard(m);
-
-  if (m_logToFile) {
-    checkLog();
-    auto cur = chrono::system_clock::now();
-    auto cur_time_t = chrono::system_clock::to_time_t(cur);
-    m_logFile << "[" << PAD(tid, TID_LEN, ' ') << "]["
-              << put_time(gmtime(&cur_time_t), "%y-%m-%dT%T.")
-              << PAD(get_ms(cur), 3, '0') << "]["
-              << LIMIT_RIGHT(std::string(std::string(filename) + ":" +
-                                         std::to_string(linenum)),
-                             Logger::MAX_FILEANDLINE_LEN)
-              << "][" << LIMIT(function, MAX_FUNCNAME_LEN) << "] [Epoch "
-              << epoch << "] " << msg << endl
-              << flush;
-  } else {
-    auto cur = chrono::system_clock::now();
-    auto cur_time_t = chrono::system_clock::to_time_t(cur);
-    cout << "[" << PAD(tid, TID_LEN, ' ') << "]["
-         << put_time(gmtime(&cur_time_t), "%y-%m-%dT%T.")
-         << PAD(get_ms(cur), 3, '0') << "]["
-         << LIMIT_RIGHT(std::string(std::string(filename) + ":" +
-                                    std::to_string(linenum)),
-                        Logger::MAX_FILEANDLINE_LEN)
-         << "][" << LIMIT(function, MAX_FUNCNAME_LEN) << "] [Epoch " << epoch
-         << "] " << msg << endl
-         << flush;
-  }
+  ostringstream oss;
+  oss << LOG_HEADER(site) << " [Epoch " << epoch << "] " << msg;
+  Output(oss.str());
 }
 
 void Logger::DisplayLevelAbove(LEVELS level) {
@@ -312,7 +228,43 @@ void Logger::EnableLevel(LEVELS level) { g3::log_levels::enable(level); }
 
 void Logger::DisableLevel(LEVELS level) { g3::log_levels::disable(level); }
 
-pid_t Logger::GetPid() { return getCurrentPid(); }
+pid_t Logger::GetPid() {
+  thread_local const pid_t tid = getCurrentPid();
+  return tid;
+}
+
+const char* Logger::GetTidString() {
+  thread_local char tidString[16] = {0};
+
+  if (tidString[0] == '\0') {
+    snprintf(tidString, sizeof(tidString), "%*d", static_cast<int>(TID_LEN),
+             GetPid());
+  }
+
+  return tidString;
+}
+
+const char* Logger::GetTimestamp() {
+  thread_local char timestamp[32] = {0};
+  thread_local time_t cachedSecond = -1;
+  thread_local size_t prefixLen = 0;
+
+  const auto cur = chrono::system_clock::now();
+  const time_t cur_time_t = chrono::system_clock::to_time_t(cur);
+
+  if (cur_time_t != cachedSecond) {
+    struct tm cur_tm;
+    gmtime_r(&cur_time_t, &cur_tm);
+    prefixLen =
+        strftime(timestamp, sizeof(timestamp), "%y-%m-%dT%T.", &cur_tm);
+    cachedSecond = cur_time_t;
+  }
+
+  snprintf(timestamp + prefixLen, sizeof(timestamp) - prefixLen, "%03ld",
+           get_ms(cur));
+
+  return timestamp;
+}
 
 void Logger::GetPayloadS(const bytes& payload, size_t max_bytes_to_display,
                          std::unique_ptr<char[]>& res) {
@@ -337,15 +289,12 @@ void Logger::GetPayloadS(const bytes& payload, size_t max_bytes_to_display,
   res.get()[payload_string_len - 1] = '\0';
 }
 
-ScopeMarker::ScopeMarker(const unsigned int linenum, const char* filename,
-                         const char* function)
-    : m_linenum(linenum), m_filename(filename), m_function(function) {
+ScopeMarker::ScopeMarker(const Logger::CallSite& site) : m_site(site) {
   Logger& logger = Logger::GetLogger(NULL, true);
-  logger.LogGeneral(INFO, "BEG", linenum, filename, function);
+  logger.LogGeneral(INFO, "BEG", m_site);
 }
 
 ScopeMarker::~ScopeMarker() {
   Logger& logger = Logger::GetLogger(NULL, true);
-  logger.LogGeneral(INFO, "END", m_linenum, m_filename.c_str(),
-                    m_function.c_str());
+  logger.LogGeneral(INFO, "END", m_site);
 }
@@ -23,11 +23,13 @@
 #include <boost/multiprecision/cpp_int.hpp>
 #pragma GCC diagnostic pop
 #include <chrono>
+#include <condition_variable>
 #include <fstream>
 #include <iomanip>
 #include <mutex>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 #include "common/BaseType.h"
 #include "g3log/g3log.hpp"
@@ -45,20 +47,59 @@
 
 #define PAD(n, len, ch) std::setw(len) << std::setfill(ch) << std::right << n
 
+/// Build-time log level filter. Statements below LOG_MIN_LEVEL_VALUE are
+/// compiled out: neither the level check nor the message is evaluated.
+#define LOG_LEVEL_VALUE_DEBUG 0
+#define LOG_LEVEL_VALUE_INFO 1
+#define LOG_LEVEL_VALUE_WARNING 2
+#define LOG_LEVEL_VALUE_FATAL 3
+
+#ifndef LOG_MIN_LEVEL_VALUE
+#define LOG_MIN_LEVEL_VALUE LOG_LEVEL_VALUE_DEBUG
+#endif
+
+#define LOG_LEVEL_COMPILED(level) \
+  (LOG_LEVEL_VALUE_##level >= LOG_MIN_LEVEL_VALUE)
+
 /// Utility logging class for outputting messages to stdout or file.
 class Logger {
+ public:
+  /// File, line and function of a log statement, cut and padded once per
+  /// statement instead of on every line it writes.
+  struct CallSite {
+    CallSite(const char* filename, const unsigned int linenum,
+             const char* function);
+
+    std::string m_fileAndLine;
+    std::string m_function;
+  };
+
  private:
   std::mutex m;
   bool m_logToFile;
   std::streampos m_maxFileSize;
   std::unique_ptr<g3::LogWorker> logworker;
 
+  /// Lines waiting for the writer thread (plain file logs only)
+  std::mutex m_mutexPending;
+  std::condition_variable m_cvPending;
+  std::vector<std::string> m_pending;
+  bool m_stopWriter;
+  std::thread m_writer;
+  std::streamoff m_fileSize;
+
   Logger(const char* prefix, bool log_to_file, std::streampos max_file_size);
   ~Logger();
 
   void checkLog();
   void newLog();
 
+  /// Hands a formatted line to the writer thread, or prints it to stdout
+  void Output(std::string&& line);
+
+  /// Drains pending lines into the log file in batches, one flush per batch
+  void WriterLoop();
+
   std::string m_fileNamePrefix;
   std::string m_fileName;
   std::ofstream m_logFile;
@@ -103,28 +144,18 @@ class Logger {
   void LogState(const char* msg);
 
   /// Outputs the specified message and function name to the main log.
-  void LogGeneral(LEVELS level, const char* msg, const unsigned int linenum,
-                  const char* filename, const char* function);
+  void LogGeneral(LEVELS level, const char* msg, const CallSite& site);
 
   /// Outputs the specified message, function name, and block number to the main
   /// log.
   void LogEpoch(LEVELS level, const char* msg, const char* epoch,
-                const unsigned int linenum, const char* filename,
-                const char* function);
-
-  /// Outputs the specified message, function name, and payload to the main log.
-  void LogMessageAndPayload(const char* msg, const bytes& payload,
-                            size_t max_bytes_to_display,
-                            const unsigned int linenum, const char* filename,
-                            const char* function);
+                const CallSite& site);
+
   /// Outputs the specified message and function name to the epoch info log.
-  void LogEpochInfo(const char* msg, const unsigned int linenum,
-                    const char* filename, const char* function,
-                    const char* epoch);
+  void LogEpochInfo(const char* msg, const CallSite& site, const char* epoch);
 
   void LogPayload(LEVELS level, const char* msg, const bytes& payload,
-                  size_t max_bytes_to_display, const unsigned int linenum,
-                  const char* filename, const char* function);
+                  size_t max_bytes_to_display, const CallSite& site);
 
   /// Setup the display debug level
   ///     INFO: display all message
@@ -144,6 +175,13 @@ class Logger {
   /// Get current process id
   static pid_t GetPid();
 
+  /// Get current thread id padded to TID_LEN, formatted once per thread
+  static const char* GetTidString();
+
+  /// Get current time as yy-mm-ddThh:mm:ss.mmm, the date part being
+  /// formatted once per second per thread
+  static const char* GetTimestamp();
+
   /// Calculate payload string according to payload vector & length
   static void GetPayloadS(const bytes& payload, size_t max_bytes_to_display,
                           std::unique_ptr<char[]>& res);
@@ -151,128 +189,108 @@ class Logger {
 
 /// Utility class for automatically logging function or code block exit.
 class ScopeMarker {
-  unsigned int m_linenum;
-  std::string m_filename;
-  std::string m_function;
+  const Logger::CallSite& m_site;
 
  public:
   /// Constructor.
-  ScopeMarker(const unsigned int linenum, const char* filename,
-              const char* function);
+  explicit ScopeMarker(const Logger::CallSite& site);
 
   /// Destructor.
   ~ScopeMarker();
 };
 
+#define LOG_CALLSITE(name) \
+  static const Logger::CallSite name(__FILE__, __LINE__, __FUNCTION__)
+#define LOG_HEADER(site)                                          \
+  "[" << Logger::GetTidString() << "][" << Logger::GetTimestamp() \
+      << "][" << (site).m_fileAndLine << "][" << (site).m_function \
+      << "]" << std::left
+
 #define INIT_FILE_LOGGER(fname_prefix) Logger::GetLogger(fname_prefix, true)
 #define INIT_STDOUT_LOGGER() Logger::GetLogger(NULL, false)
 #define INIT_STATE_LOGGER(fname_prefix) \
   Logger::GetStateLogger(fname_prefix, true)
 #define INIT_EPOCHINFO_LOGGER(fname_prefix) \
   Logger::GetEpochInfoLogger(fname_prefix, true)
-#define LOG_MARKER() ScopeMarker marker(__LINE__, __FILE__, __FUNCTION__)
-#define LOG_STATE(msg)                                                \
-  {                                                                   \
-    std::ostringstream oss;                                           \
-    auto cur = std::chrono::system_clock::now();                      \
-    auto cur_time_t = std::chrono::system_clock::to_time_t(cur);      \
-    oss << "[ " << std::put_time(gmtime(&cur_time_t), "%y-%m-%dT%T.") \
-        << PAD(get_ms(cur), 3, '0') << " ]" << msg;                   \
-    Logger::GetStateLogger(NULL, true).LogState(oss.str().c_str());   \
+#if defined(DISABLE_LOG_MARKER) || !LOG_LEVEL_COMPILED(INFO)
+#define LOG_MARKER() \
+  do {               \
+  } while (0)
+#else
+#define LOG_MARKER()            \
+  LOG_CALLSITE(logMarkerSite_); \
+  ScopeMarker marker(logMarkerSite_)
+#endif
+#define LOG_STATE(msg)                                              \
+  {                                                                 \
+    std::ostringstream oss;                                         \
+    oss << "[ " << Logger::GetTimestamp() << " ]" << msg;           \
+    Logger::GetStateLogger(NULL, true).LogState(oss.str().c_str()); \
   }
-#define LOG_GENERAL(level, msg)                                                \
-  {                                                                            \
-    if (Logger::GetLogger(NULL, true).IsG3Log()) {                             \
-      auto cur = std::chrono::system_clock::now();                             \
-      auto cur_time_t = std::chrono::system_clock::to_time_t(cur);             \
-      LOG(level) << "[" << PAD(Logger::GetPid(), Logger::TID_LEN, ' ') << "][" \
-                 << std::put_time(gmtime(&cur_time_t), "%y-%m-%dT%T.")         \
-                 << PAD(get_ms(cur), 3, '0') << "]["                           \
-                 << LIMIT_RIGHT(std::string(std::string(__FILE__) + ":" +      \
-                                            std::to_string(__LINE__)),         \
-                                Logger::MAX_FILEANDLINE_LEN)                   \
-                 << "][" << LIMIT(__FUNCTION__, Logger::MAX_FUNCNAME_LEN)      \
-                 << "] " << msg;                                               \
-    } else {                                                                   \
-      std::ostringstream oss;                                                  \
-      oss << msg;                                                              \
-      Logger::GetLogger(NULL, true)                                            \
-          .LogGeneral(level, oss.str().c_str(), __LINE__, __FILE__,            \
-                      __FUNCTION__);                                           \
-    }                                                                          \
+#define LOG_GENERAL(level, msg)                              \
+  {                                                          \
+    if (LOG_LEVEL_COMPILED(level)) {                         \
+      LOG_CALLSITE(logSite_);                                \
+      if (Logger::GetLogger(NULL, true).IsG3Log()) {         \
+        LOG(level) << LOG_HEADER(logSite_) << " " << msg;    \
+      } else {                                               \
+        std::ostringstream oss;                              \
+        oss << msg;                                          \
+        Logger::GetLogger(NULL, true)                        \
+            .LogGeneral(level, oss.str().c_str(), logSite_); \
+      }                                                      \
+    }                                                        \
   }
 #define LOG_EPOCH(level, epoch, msg)                                           \
   {                                                                            \
-    if (Logger::GetLogger(NULL, true).IsG3Log()) {                             \
-      auto cur = std::chrono::system_clock::now();                             \
-      auto cur_time_t = std::chrono::system_clock::to_time_t(cur);             \
-      LOG(level) << "[" << PAD(Logger::GetPid(), Logger::TID_LEN, ' ') << "][" \
-                 << std::put_time(gmtime(&cur_time_t), "%y-%m-%dT%T.")         \
-                 << PAD(get_ms(cur), 3, '0') << "]["                           \
-                 << LIMIT_RIGHT(std::string(std::string(__FILE__) + ":" +      \
-                                            std::to_string(__LINE__)),         \
-                                Logger::MAX_FILEANDLINE_LEN)                   \
-                 << "][" << LIMIT(__FUNCTION__, Logger::MAX_FUNCNAME_LEN)      \
-                 << "] [Epoch " << std::to_string(epoch).c_str() << "] "       \
-                 << msg;                                                       \
-    } else {                                                                   \
-      std::ostringstream oss;                                                  \
-      oss << msg;                                                              \
-      Logger::GetLogger(NULL, true)                                            \
-          .LogEpoch(level, std::to_string(epoch).c_str(), oss.str().c_str(),   \
-                    __LINE__, __FILE__, __FUNCTION__);                         \
-    }                                                                          \
-  }
-#define LOG_PAYLOAD(level, msg, payload, max_bytes_to_display)                 \
-  {                                                                            \
-    if (Logger::GetLogger(NULL, true).IsG3Log()) {                             \
-      std::unique_ptr<char[]> payload_string;                                  \
-      Logger::GetPayloadS(payload, max_bytes_to_display, payload_string);      \
-      auto cur = std::chrono::system_clock::now();                             \
-      auto cur_time_t = std::chrono::system_clock::to_time_t(cur);             \
-      if ((payload).size() > max_bytes_to_display) {                           \
-        LOG(level) << "[" << PAD(Logger::GetPid(), Logger::TID_LEN, ' ')       \
-                   << "]["                                                     \
-                   << std::put_time(gmtime(&cur_time_t), "%y-%m-%dT%T.")       \
-                   << PAD(get_ms(cur), 3, '0') << "]["                         \
-                   << LIMIT_RIGHT(std::string(std::string(__FILE__) + ":" +    \
-                                              std::to_string(__LINE__)),       \
-                                  Logger::MAX_FILEANDLINE_LEN)                 \
-                   << "][" << LIMIT(__FUNCTION__, Logger::MAX_FUNCNAME_LEN)    \
-                   << "] " << msg << " (Len=" << (payload).size()              \
-                   << "): " << payload_string.get() << "...";                  \
+    if (LOG_LEVEL_COMPILED(level)) {                                           \
+      LOG_CALLSITE(logSite_);                                                  \
+      if (Logger::GetLogger(NULL, true).IsG3Log()) {                           \
+        LOG(level) << LOG_HEADER(logSite_) << " [Epoch "                       \
+                   << std::to_string(epoch).c_str() << "] " << msg;            \
       } else {                                                                 \
-        LOG(level) << "[" << PAD(Logger::GetPid(), Logger::TID_LEN, ' ')       \
-                   << "]["                                                     \
-                   << std::put_time(gmtime(&cur_time_t), "%y-%m-%dT%T.")       \
-                   << PAD(get_ms(cur), 3, '0') << "]["                         \
-                   << LIMIT_RIGHT(std::string(std::string(__FILE__) + ":" +    \
-                                              std::to_string(__LINE__)),       \
-                                  Logger::MAX_FILEANDLINE_LEN)                 \
-                   << "][" << LIMIT(__FUNCTION__, Logger::MAX_FUNCNAME_LEN)    \
-                   << "] " << msg << " (Len=" << (payload).size()              \
-                   << "): " << payload_string.get();                           \
+        std::ostringstream oss;                                                \
+        oss << msg;                                                            \
+        Logger::GetLogger(NULL, true)                                          \
+            .LogEpoch(level, oss.str().c_str(), std::to_string(epoch).c_str(), \
+                      logSite_);                                               \
       }                                                                        \
-    } else {                                                                   \
-      std::ostringstream oss;                                                  \
-      oss << msg;                                                              \
-      Logger::GetLogger(NULL, true)                                            \
-          .LogPayload(level, oss.str().c_str(), payload, max_bytes_to_display, \
-                      __LINE__, __FILE__, __FUNCTION__);                       \
     }                                                                          \
   }
+#define LOG_PAYLOAD(level, msg, payload, max_bytes_to_display)              \
+  {                                                                         \
+    if (LOG_LEVEL_COMPILED(level)) {                                        \
+      LOG_CALLSITE(logSite_);                                               \
+      if (Logger::GetLogger(NULL, true).IsG3Log()) {                        \
+        std::unique_ptr<char[]> payload_string;                             \
+        Logger::GetPayloadS(payload, max_bytes_to_display, payload_string); \
+        LOG(level) << LOG_HEADER(logSite_) << " " << msg                    \
+                   << " (Len=" << (payload).size()                          \
+                   << "): " << payload_string.get()                         \
+                   << (((payload).size() > max_bytes_to_display) ? "..."    \
+                                                                 : "");     \
+      } else {                                                              \
+        std::ostringstream oss;                                             \
+        oss << msg;                                                         \
+        Logger::GetLogger(NULL, true)                                       \
+            .LogPayload(level, oss.str().c_str(), payload,                  \
+                        max_bytes_to_display, logSite_);                    \
+      }                                                                     \
+    }                                                                       \
+  }
 #define LOG_DISPLAY_LEVEL_ABOVE(level) \
   { Logger::GetLogger(NULL, true).DisplayLevelAbove(level); }
 #define LOG_ENABLE_LEVEL(level) \
   { Logger::GetLogger(NULL, true).EnableLevel(level); }
 #define LOG_DISABLE_LEVEL(level) \
   { Logger::GetLogger(NULL, true).DisableLevel(level); }
-#define LOG_EPOCHINFO(blockNum, msg)                                       \
-  {                                                                        \
-    std::ostringstream oss;                                                \
-    oss << msg;                                                            \
-    Logger::GetEpochInfoLogger(NULL, true)                                 \
-        .LogEpochInfo(oss.str().c_str(), __LINE__, __FILE__, __FUNCTION__, \
-                      std::to_string(blockNum).c_str());                   \
+#define LOG_EPOCHINFO(blockNum, msg)                            \
+  {                                                             \
+    LOG_CALLSITE(logSite_);                                     \
+    std::ostringstream oss;                                     \
+    oss << msg;                                                 \
+    Logger::GetEpochInfoLogger(NULL, true)                      \
+        .LogEpochInfo(oss.str().c_str(), logSite_,              \
+                      std::to_string(blockNum).c_str());        \
   }
 #endif  // __LOGGER_H__
@@ -0,0 +1,58 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <unistd.h>
+#include <fstream>
+
+#include "MemoryStats.h"
+
+using namespace std;
+
+MemoryStats& MemoryStats::GetInstance() {
+  static MemoryStats memoryStats;
+  return memoryStats;
+}
+
+void MemoryStats::Register(const string& subsystem, const Reporter& reporter) {
+  lock_guard<mutex> g(m_mutex);
+  m_reporters[subsystem] = reporter;
+}
+
+void MemoryStats::Unregister(const string& subsystem) {
+  lock_guard<mutex> g(m_mutex);
+  m_reporters.erase(subsystem);
+}
+
+vector<pair<string, MemoryUsage>> MemoryStats::Collect() {
+  lock_guard<mutex> g(m_mutex);
+
+  vector<pair<string, MemoryUsage>> result;
+  for (const auto& reporter : m_reporters) {
+    result.emplace_back(reporter.first, reporter.second());
+  }
+  return result;
+}
+
+uint64_t MemoryStats::GetResidentBytes() {
+  // Total and resident pages
+  ifstream statm("/proc/self/statm");
+  uint64_t totalPages = 0, residentPages = 0;
+  if (!(statm >> totalPages >> residentPages)) {
+    return 0;
+  }
+  return residentPages * sysconf(_SC_PAGESIZE);
+}
@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __MEMORYSTATS_H__
+#define __MEMORYSTATS_H__
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/// Memory held by one subsystem
+struct MemoryUsage {
+  uint64_t m_bytes = 0;
+  uint64_t m_objects = 0;
+
+  MemoryUsage& operator+=(const MemoryUsage& other) {
+    m_bytes += other.m_bytes;
+    m_objects += other.m_objects;
+    return *this;
+  }
+};
+
+/// Per-subsystem memory accounting, read by the GetMemoryStats RPC.
+///
+/// Each subsystem registers a reporter that walks its own containers under
+/// its own lock when asked, so nothing is counted on the allocation path.
+/// The byte counts estimate the payload plus the per-node overhead of the
+/// standard containers (see the helpers below); allocator slack is not
+/// included, so the sum stays below the process RSS.
+class MemoryStats {
+ public:
+  using Reporter = std::function<MemoryUsage()>;
+
+ private:
+  std::mutex m_mutex;
+  std::map<std::string, Reporter> m_reporters;
+
+  MemoryStats() = default;
+  ~MemoryStats() = default;
+
+  MemoryStats(MemoryStats const&) = delete;
+  void operator=(MemoryStats const&) = delete;
+
+ public:
+  /// Returns the singleton instance.
+  static MemoryStats& GetInstance();
+
+  /// Adds or replaces the reporter of a subsystem
+  void Register(const std::string& subsystem, const Reporter& reporter);
+
+  /// Must be called before whatever the reporter reads is destroyed
+  void Unregister(const std::string& subsystem);
+
+  /// Runs every reporter, in subsystem name order
+  std::vector<std::pair<std::string, MemoryUsage>> Collect();
+
+  /// Resident set size of the process in bytes, 0 if unknown
+  static uint64_t GetResidentBytes();
+
+  /// Bytes of a node-based hash container, elements and buckets included
+  template <class Container>
+  static uint64_t HashContainerBytes(const Container& container) {
+    return container.size() *
+               (sizeof(typename Container::value_type) + 2 * sizeof(void*)) +
+           container.bucket_count() * sizeof(void*);
+  }
+
+  /// Bytes of a red-black tree container (std::map, std::set, ...)
+  template <class Container>
+  static uint64_t TreeContainerBytes(const Container& container) {
+    return container.size() *
+           (sizeof(typename Container::value_type) + 4 * sizeof(void*));
+  }
+
+  /// Bytes of a std::list
+  template <class Container>
+  static uint64_t ListBytes(const Container& container) {
+    return container.size() *
+           (sizeof(typename Container::value_type) + 2 * sizeof(void*));
+  }
+
+  /// Bytes of a contiguous container (std::vector, std::deque, ...)
+  template <class Container>
+  static uint64_t ArrayBytes(const Container& container) {
+    return container.size() * sizeof(typename Container::value_type);
+  }
+};
+
+#endif  // __MEMORYSTATS_H__
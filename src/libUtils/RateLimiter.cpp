@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+
+#include "Logger.h"
+#include "RateLimiter.h"
+
+using namespace std;
+
+RateLimiter::RateLimiter(const vector<Limit>& limits, size_t maxClients)
+    : m_limits(limits),
+      m_maxClients(max<size_t>(maxClients, 1)),
+      m_admitted(0),
+      m_rejected(0) {}
+
+void RateLimiter::Refill(Buckets& buckets, Clock::time_point now) const {
+  const double elapsed =
+      chrono::duration<double>(now - buckets.m_lastRefill).count();
+  if (elapsed <= 0) {
+    return;
+  }
+
+  for (size_t i = 0; i < m_limits.size(); i++) {
+    buckets.m_tokens[i] =
+        min(m_limits[i].m_burst,
+            buckets.m_tokens[i] + elapsed * m_limits[i].m_rate);
+  }
+  buckets.m_lastRefill = now;
+}
+
+bool RateLimiter::IsFull(const Buckets& buckets) const {
+  for (size_t i = 0; i < m_limits.size(); i++) {
+    if (m_limits[i].m_rate > 0 && buckets.m_tokens[i] < m_limits[i].m_burst) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void RateLimiter::Evict(Clock::time_point now) {
+  for (auto it = m_clients.begin(); it != m_clients.end();) {
+    Refill(it->second, now);
+    if (IsFull(it->second)) {
+      it = m_clients.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  if (m_clients.size() >= m_maxClients) {
+    LOG_GENERAL(WARNING, "More than " << m_maxClients
+                                      << " clients are rate limited, "
+                                         "forgetting all of them");
+    m_clients.clear();
+  }
+}
+
+bool RateLimiter::Admit(const string& client, const vector<unsigned int>& costs,
+                        Clock::time_point now) {
+  lock_guard<mutex> g(m_mutex);
+
+  auto it = m_clients.find(client);
+  if (it == m_clients.end()) {
+    if (m_clients.size() >= m_maxClients) {
+      Evict(now);
+    }
+
+    Buckets buckets;
+    buckets.m_tokens.reserve(m_limits.size());
+    for (const auto& limit : m_limits) {
+      buckets.m_tokens.push_back(limit.m_burst);
+    }
+    buckets.m_lastRefill = now;
+    it = m_clients.emplace(client, move(buckets)).first;
+  }
+
+  Buckets& buckets = it->second;
+  Refill(buckets, now);
+
+  const size_t numClasses = min(costs.size(), m_limits.size());
+  for (size_t i = 0; i < numClasses; i++) {
+    if (m_limits[i].m_rate > 0 && buckets.m_tokens[i] < costs[i]) {
+      m_rejected++;
+      return false;
+    }
+  }
+
+  for (size_t i = 0; i < numClasses; i++) {
+    if (m_limits[i].m_rate > 0) {
+      buckets.m_tokens[i] -= costs[i];
+    }
+  }
+  m_admitted++;
+  return true;
+}
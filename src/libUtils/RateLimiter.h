@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __RATELIMITER_H__
+#define __RATELIMITER_H__
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/// Token buckets per client, one for each class of cost.
+///
+/// A class with rate r and burst b lets a client spend b tokens at once and
+/// refills at r tokens per second; a rate of 0 leaves the class unlimited.
+/// At most maxClients clients are tracked: beyond that, clients whose
+/// buckets have refilled are forgotten, and if none have, all are.
+class RateLimiter {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  struct Limit {
+    double m_rate;
+    double m_burst;
+  };
+
+  RateLimiter(const std::vector<Limit>& limits, size_t maxClients);
+
+  /// Takes costs[i] tokens of class i from the client's buckets, or none at
+  /// all if any bucket is short
+  bool Admit(const std::string& client, const std::vector<unsigned int>& costs,
+             Clock::time_point now = Clock::now());
+
+  uint64_t GetAdmitted() const { return m_admitted; }
+  uint64_t GetRejected() const { return m_rejected; }
+
+ private:
+  struct Buckets {
+    std::vector<double> m_tokens;
+    Clock::time_point m_lastRefill;
+  };
+
+  const std::vector<Limit> m_limits;
+  const size_t m_maxClients;
+
+  std::mutex m_mutex;
+  std::unordered_map<std::string, Buckets> m_clients;
+
+  std::atomic<uint64_t> m_admitted;
+  std::atomic<uint64_t> m_rejected;
+
+  void Refill(Buckets& buckets, Clock::time_point now) const;
+  bool IsFull(const Buckets& buckets) const;
+  void Evict(Clock::time_point now);
+};
+
+#endif  // __RATELIMITER_H__
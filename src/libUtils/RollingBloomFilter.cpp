@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+
+#include "RollingBloomFilter.h"
+#include "common/Constants.h"
+
+using namespace std;
+
+RollingBloomFilter::RollingBloomFilter(unsigned int slices,
+                                       unsigned int epochsPerSlice,
+                                       size_t bitsPerSlice, unsigned int probes)
+    : m_epochsPerSlice(max(epochsPerSlice, 1u)),
+      m_bitsPerSlice(max<size_t>(bitsPerSlice, 64)),
+      m_probes(max(probes, 1u)),
+      m_slices(max(slices, 1u),
+               vector<uint64_t>((m_bitsPerSlice + 63) / 64, 0)) {}
+
+RollingBloomFilter& RollingBloomFilter::GetCommittedTxnFilter() {
+  static RollingBloomFilter filter(TXN_FILTER_SLICES,
+                                   TXN_FILTER_EPOCHS_PER_SLICE,
+                                   TXN_FILTER_SLICE_BITS, TXN_FILTER_PROBES);
+  return filter;
+}
+
+template <class F>
+void RollingBloomFilter::ForEachProbe(const dev::h256& key, F&& f) const {
+  // Double hashing, with an odd step so that the probes do not repeat
+  uint64_t h1 = 0;
+  uint64_t h2 = 0;
+  memcpy(&h1, key.data(), sizeof(h1));
+  memcpy(&h2, key.data() + sizeof(h1), sizeof(h2));
+  h2 |= 1;
+  for (unsigned int i = 0; i < m_probes; i++) {
+    f((h1 + i * h2) % m_bitsPerSlice);
+  }
+}
+
+void RollingBloomFilter::Insert(const dev::h256& key) {
+  lock_guard<shared_timed_mutex> g(m_mutex);
+  auto& slice = m_slices[m_current];
+  ForEachProbe(key, [&slice](size_t bit) {
+    slice[bit / 64] |= uint64_t{1} << (bit % 64);
+  });
+}
+
+bool RollingBloomFilter::MayContain(const dev::h256& key) const {
+  shared_lock<shared_timed_mutex> g(m_mutex);
+  for (const auto& slice : m_slices) {
+    bool found = true;
+    ForEachProbe(key, [&slice, &found](size_t bit) {
+      found = found && (slice[bit / 64] & (uint64_t{1} << (bit % 64))) != 0;
+    });
+    if (found) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void RollingBloomFilter::NewEpoch(const uint64_t& epoch) {
+  const uint64_t range = epoch / m_epochsPerSlice;
+
+  lock_guard<shared_timed_mutex> g(m_mutex);
+  if (range <= m_range) {
+    return;
+  }
+  // A jump past every slice clears each of them once
+  const uint64_t steps = min<uint64_t>(range - m_range, m_slices.size());
+  for (uint64_t i = 0; i < steps; i++) {
+    m_current = (m_current + 1) % m_slices.size();
+    fill(m_slices[m_current].begin(), m_slices[m_current].end(), 0);
+  }
+  m_range = range;
+}
+
+void RollingBloomFilter::Clear() {
+  lock_guard<shared_timed_mutex> g(m_mutex);
+  for (auto& slice : m_slices) {
+    fill(slice.begin(), slice.end(), 0);
+  }
+}
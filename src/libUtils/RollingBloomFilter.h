@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __ROLLINGBLOOMFILTER_H__
+#define __ROLLINGBLOOMFILTER_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <shared_mutex>
+#include <vector>
+
+#include "depends/common/FixedHash.h"
+
+/// Bloom filter over the hashes seen in the last few epochs.
+///
+/// Hashes go into the slice of the current epoch range, each slice
+/// covering epochsPerSlice epochs. Starting an epoch past the newest slice
+/// clears and reuses the oldest one, so a hash is remembered for between
+/// (slices - 1) and slices ranges. A miss is certain; a hit may be a false
+/// positive and has to be confirmed by the caller.
+///
+/// The keys are SHA-256 digests already, so the probe positions are taken
+/// from their words rather than hashed again.
+class RollingBloomFilter {
+  const unsigned int m_epochsPerSlice;
+  const size_t m_bitsPerSlice;
+  const unsigned int m_probes;
+
+  mutable std::shared_timed_mutex m_mutex;
+  std::vector<std::vector<uint64_t>> m_slices;
+  /// Epoch range of the newest slice, in epochsPerSlice units
+  uint64_t m_range = 0;
+  size_t m_current = 0;
+
+  template <class F>
+  void ForEachProbe(const dev::h256& key, F&& f) const;
+
+ public:
+  /// probes bits per hash in slices slices of bitsPerSlice bits each
+  RollingBloomFilter(unsigned int slices, unsigned int epochsPerSlice,
+                     size_t bitsPerSlice, unsigned int probes);
+
+  /// Returns the filter sized by the TXN_FILTER_* constants
+  static RollingBloomFilter& GetCommittedTxnFilter();
+
+  void Insert(const dev::h256& key);
+
+  /// Returns false only if key was not inserted in the slices kept
+  bool MayContain(const dev::h256& key) const;
+
+  /// Moves on to the slice of epoch, clearing the slices it rolls over.
+  /// Epochs within or before the newest slice do nothing.
+  void NewEpoch(const uint64_t& epoch);
+
+  void Clear();
+};
+
+#endif  // __ROLLINGBLOOMFILTER_H__
@@ -15,6 +15,12 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <thread>
+
 #include "RootComputation.h"
 #include "libCrypto/Sha2.h"
 
@@ -39,6 +45,67 @@ inline const TxnHash& GetHash(
 inline const TxnHash& GetHash(const TransactionWithReceipt& item) {
   return item.GetTransaction().GetTranID();
 }
+
+// Leaves per subtree hashed on its own thread; a power of two, so that the
+// subtree roots are exactly the nodes of the whole tree at that level
+const size_t MERKLE_SUBTREE_LEAVES = 1024;
+
+// Microblock tx roots kept for ComputeMicroBlockTxRoot
+const size_t TXROOT_CACHE_SIZE = 64;
+
+const uint8_t MERKLE_LEAF_PREFIX = 0x00;
+const uint8_t MERKLE_NODE_PREFIX = 0x01;
+
+TxnHash HashMerkleLeaf(const TxnHash& hash) {
+  SHA2<HASH_TYPE::HASH_VARIANT_256> sha2;
+  sha2.Update({MERKLE_LEAF_PREFIX});
+  sha2.Update(hash.asBytes());
+  return TxnHash{sha2.Finalize()};
+}
+
+TxnHash HashMerkleNode(const TxnHash& left, const TxnHash& right) {
+  SHA2<HASH_TYPE::HASH_VARIANT_256> sha2;
+  sha2.Update({MERKLE_NODE_PREFIX});
+  sha2.Update(left.asBytes());
+  sha2.Update(right.asBytes());
+  return TxnHash{sha2.Finalize()};
+}
+
+/// Reduces the nodes of one level to the root, in place
+TxnHash ReduceMerkleLevels(vector<TxnHash>& nodes) {
+  while (nodes.size() > 1) {
+    size_t next = 0;
+    for (size_t i = 0; i + 1 < nodes.size(); i += 2) {
+      nodes[next++] = HashMerkleNode(nodes[i], nodes[i + 1]);
+    }
+    if (nodes.size() % 2 == 1) {
+      nodes[next++] = nodes.back();
+    }
+    nodes.resize(next);
+  }
+  return nodes.front();
+}
+
+/// Root of the subtree over hashes [begin, end)
+TxnHash ComputeMerkleSubtree(const vector<TxnHash>& hashes, size_t begin,
+                             size_t end) {
+  vector<TxnHash> nodes;
+  nodes.reserve(end - begin);
+  for (size_t i = begin; i < end; i++) {
+    nodes.emplace_back(HashMerkleLeaf(hashes[i]));
+  }
+  return ReduceMerkleLevels(nodes);
+}
+
+struct TxRootCacheEntry {
+  BlockHash m_microBlockHash;
+  uint32_t m_version;
+  vector<TxnHash> m_hashes;
+  TxnHash m_root;
+};
+
+mutex g_mutexTxRootCache;
+deque<TxRootCacheEntry> g_txRootCache;
 };  // namespace
 
 template <typename... Container>
@@ -97,3 +164,83 @@ TxnHash ComputeRoot(const vector<TransactionWithReceipt>& transactions) {
 
   return ConcatTranAndHash(transactions);
 }
+
+TxnHash ComputeMerkleRoot(const vector<TxnHash>& hashes) {
+  LOG_MARKER();
+
+  if (hashes.empty()) {
+    return TxnHash();
+  }
+
+  const size_t numSubtrees =
+      (hashes.size() + MERKLE_SUBTREE_LEAVES - 1) / MERKLE_SUBTREE_LEAVES;
+  if (numSubtrees == 1) {
+    return ComputeMerkleSubtree(hashes, 0, hashes.size());
+  }
+
+  // Each thread takes every numThreads-th subtree
+  const size_t numThreads = min<size_t>(
+      numSubtrees, max<unsigned int>(thread::hardware_concurrency(), 1));
+  vector<TxnHash> subtreeRoots(numSubtrees);
+  auto hashSubtrees = [&hashes, &subtreeRoots, numSubtrees,
+                       numThreads](size_t first) {
+    for (size_t i = first; i < numSubtrees; i += numThreads) {
+      subtreeRoots[i] = ComputeMerkleSubtree(
+          hashes, i * MERKLE_SUBTREE_LEAVES,
+          min(hashes.size(), (i + 1) * MERKLE_SUBTREE_LEAVES));
+    }
+  };
+
+  vector<future<void>> pending;
+  for (size_t t = 1; t < numThreads; t++) {
+    pending.emplace_back(async(launch::async, hashSubtrees, t));
+  }
+  hashSubtrees(0);
+  for (auto& f : pending) {
+    f.get();
+  }
+
+  return ReduceMerkleLevels(subtreeRoots);
+}
+
+TxnHash ComputeMicroBlockTxRoot(uint32_t version,
+                                const vector<TxnHash>& hashes) {
+  if (version >= TXROOT_MERKLE_MICROBLOCK_VERSION) {
+    return ComputeMerkleRoot(hashes);
+  }
+  return ComputeRoot(hashes);
+}
+
+TxnHash ComputeMicroBlockTxRoot(const BlockHash& microBlockHash,
+                                uint32_t version,
+                                const vector<TxnHash>& hashes) {
+  {
+    lock_guard<mutex> g(g_mutexTxRootCache);
+    for (const auto& entry : g_txRootCache) {
+      if (entry.m_microBlockHash == microBlockHash &&
+          entry.m_version == version && entry.m_hashes == hashes) {
+        return entry.m_root;
+      }
+    }
+  }
+
+  const TxnHash root = ComputeMicroBlockTxRoot(version, hashes);
+
+  lock_guard<mutex> g(g_mutexTxRootCache);
+  g_txRootCache.push_back({microBlockHash, version, hashes, root});
+  if (g_txRootCache.size() > TXROOT_CACHE_SIZE) {
+    g_txRootCache.pop_front();
+  }
+  return root;
+}
+
+TxnHash ComputeMicroBlockTxRoot(
+    const BlockHash& microBlockHash, uint32_t version,
+    const vector<TransactionWithReceipt>& transactions) {
+  vector<TxnHash> hashes;
+  hashes.reserve(transactions.size());
+  for (const auto& twr : transactions) {
+    hashes.emplace_back(GetHash(twr));
+  }
+  return ComputeMicroBlockTxRoot(microBlockHash, version, hashes);
+}
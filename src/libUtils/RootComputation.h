@@ -44,4 +44,24 @@ TxnHash ComputeRoot(
 
 TxnHash ComputeRoot(const std::vector<TransactionWithReceipt>& transactions);
 
+/// Binary Merkle root of the hashes. Leaves are SHA256(0x00 || hash) and
+/// inner nodes SHA256(0x01 || left || right); an unpaired node moves up a
+/// level unchanged. Large inputs are split into subtrees hashed in parallel.
+TxnHash ComputeMerkleRoot(const std::vector<TxnHash>& hashes);
+
+/// Tx root of a microblock of the given version: the Merkle root from
+/// TXROOT_MERKLE_MICROBLOCK_VERSION onwards, ComputeRoot before that
+TxnHash ComputeMicroBlockTxRoot(uint32_t version,
+                                const std::vector<TxnHash>& hashes);
+
+/// Same as above, memoized per microblock hash. A stored root is only reused
+/// if the hashes are the same as when it was computed.
+TxnHash ComputeMicroBlockTxRoot(const BlockHash& microBlockHash,
+                                uint32_t version,
+                                const std::vector<TxnHash>& hashes);
+
+TxnHash ComputeMicroBlockTxRoot(
+    const BlockHash& microBlockHash, uint32_t version,
+    const std::vector<TransactionWithReceipt>& transactions);
+
 #endif  // __ROOTCOMPUTATION_H__
@@ -131,8 +131,13 @@ T SafeMath<T>::power(const T& base, const T& exponent, bool isCritical) {
 
   while (count > 0) {
     if (!SafeMath::mul(ret, base, ret)) {
-      LOG_GENERAL(isCritical ? FATAL : WARNING,
-                  "SafeMath::pow failed ret: " << ret << " base " << base);
+      if (isCritical) {
+        LOG_GENERAL(FATAL,
+                    "SafeMath::pow failed ret: " << ret << " base " << base);
+      } else {
+        LOG_GENERAL(WARNING,
+                    "SafeMath::pow failed ret: " << ret << " base " << base);
+      }
       return ret;
     }
     --count;
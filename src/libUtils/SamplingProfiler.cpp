@@ -0,0 +1,328 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <link.h>
+#include <sys/syscall.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+
+#include "SamplingProfiler.h"
+#include "common/Constants.h"
+#include "libUtils/Logger.h"
+
+using namespace std;
+
+namespace {
+// The signal handler and the trampoline that called it
+const int SKIPPED_FRAMES = 2;
+
+// Only ever called through its address, so it is never inlined and the
+// interrupted code is always SKIPPED_FRAMES down the stack
+void HandleProfSignal([[gnu::unused]] int signum) {
+  const int savedErrno = errno;
+  void* frames[SamplingProfiler::MAX_FRAMES + SKIPPED_FRAMES];
+  const int depth =
+      backtrace(frames, SamplingProfiler::MAX_FRAMES + SKIPPED_FRAMES);
+  SamplingProfiler::GetInstance().RecordSample(frames + SKIPPED_FRAMES,
+                                               depth - SKIPPED_FRAMES);
+  errno = savedErrno;
+}
+
+uint64_t NowInMilliseconds() {
+  return chrono::duration_cast<chrono::milliseconds>(
+             chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+bool SetTimer(unsigned int frequency) {
+  struct itimerval timer;
+  timer.it_interval.tv_sec = 0;
+  timer.it_interval.tv_usec = (frequency > 0) ? 1000000 / frequency : 0;
+  timer.it_value = timer.it_interval;
+  return setitimer(ITIMER_PROF, &timer, nullptr) == 0;
+}
+
+struct Module {
+  string m_name;
+  uintptr_t m_base;
+  uintptr_t m_start;
+  uintptr_t m_end;
+};
+
+int CollectModule(struct dl_phdr_info* info, [[gnu::unused]] size_t size,
+                  void* data) {
+  auto& modules = *static_cast<vector<Module>*>(data);
+  string name;
+  if (info->dlpi_name && info->dlpi_name[0] != '\0') {
+    name = info->dlpi_name;
+  } else {
+    // The executable itself
+    char path[PATH_MAX];
+    const ssize_t length = readlink("/proc/self/exe", path, sizeof(path) - 1);
+    name = (length > 0) ? string(path, length) : "exe";
+  }
+  name = name.substr(name.find_last_of('/') + 1);
+  for (int i = 0; i < info->dlpi_phnum; i++) {
+    const auto& phdr = info->dlpi_phdr[i];
+    if (phdr.p_type == PT_LOAD) {
+      const uintptr_t start = info->dlpi_addr + phdr.p_vaddr;
+      modules.push_back({name, info->dlpi_addr, start, start + phdr.p_memsz});
+    }
+  }
+  return 0;
+}
+
+int FindBuildId(struct dl_phdr_info* info, [[gnu::unused]] size_t size,
+                void* data) {
+  auto& buildId = *static_cast<string*>(data);
+  for (int i = 0; i < info->dlpi_phnum; i++) {
+    const auto& phdr = info->dlpi_phdr[i];
+    if (phdr.p_type != PT_NOTE) {
+      continue;
+    }
+    const auto* note =
+        reinterpret_cast<const char*>(info->dlpi_addr + phdr.p_vaddr);
+    const auto* end = note + phdr.p_memsz;
+    while (note + sizeof(ElfW(Nhdr)) <= end) {
+      const auto* nhdr = reinterpret_cast<const ElfW(Nhdr)*>(note);
+      const char* name = note + sizeof(ElfW(Nhdr));
+      const auto* desc = reinterpret_cast<const unsigned char*>(
+          name + ((nhdr->n_namesz + 3) & ~3));
+      if (nhdr->n_type == NT_GNU_BUILD_ID && nhdr->n_namesz == 4 &&
+          memcmp(name, "GNU", 4) == 0) {
+        ostringstream hex;
+        for (unsigned int j = 0; j < nhdr->n_descsz; j++) {
+          hex << setw(2) << setfill('0') << std::hex
+              << static_cast<unsigned int>(desc[j]);
+        }
+        buildId = hex.str();
+        return 1;
+      }
+      note = reinterpret_cast<const char*>(desc) + ((nhdr->n_descsz + 3) & ~3);
+    }
+  }
+  // The first object is the executable
+  return 1;
+}
+
+/// Names a code address, falling back to its offset in the loading module
+string Symbolize(void* address, const vector<Module>& modules) {
+  Dl_info info;
+  if (dladdr(address, &info) != 0 && info.dli_sname != nullptr) {
+    int status = 0;
+    char* demangled =
+        abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+    string name = (status == 0) ? demangled : info.dli_sname;
+    free(demangled);
+    return name;
+  }
+
+  const auto pc = reinterpret_cast<uintptr_t>(address);
+  for (const auto& module : modules) {
+    if (pc >= module.m_start && pc < module.m_end) {
+      ostringstream oss;
+      oss << module.m_name << "+0x" << hex << pc - module.m_base;
+      return oss.str();
+    }
+  }
+  ostringstream oss;
+  oss << "0x" << hex << pc;
+  return oss.str();
+}
+
+string ThreadName(int32_t tid) {
+  ifstream comm("/proc/self/task/" + to_string(tid) + "/comm");
+  string name;
+  if (!getline(comm, name) || name.empty()) {
+    name = "thread-" + to_string(tid);
+  }
+  return name;
+}
+}  // namespace
+
+SamplingProfiler::SamplingProfiler()
+    : m_next(0),
+      m_dropped(0),
+      m_running(false),
+      m_inHandler(0),
+      m_handlerInstalled(false),
+      m_startInMilliseconds(0) {}
+
+SamplingProfiler& SamplingProfiler::GetInstance() {
+  static SamplingProfiler profiler;
+  return profiler;
+}
+
+bool SamplingProfiler::Start(unsigned int frequency) {
+  lock_guard<mutex> g(m_mutexControl);
+
+  if (m_running) {
+    LOG_GENERAL(WARNING, "Profiler already running");
+    return false;
+  }
+  if (frequency == 0 || frequency > MAX_FREQUENCY) {
+    LOG_GENERAL(WARNING, "Profiler frequency " << frequency
+                                               << " not within 1.."
+                                               << MAX_FREQUENCY);
+    return false;
+  }
+
+  m_samples.assign(max(PROFILER_MAX_SAMPLES, 1u), Sample());
+  m_next = 0;
+  m_dropped = 0;
+
+  if (!m_handlerInstalled) {
+    // The first backtrace loads the unwinder, which must not happen inside
+    // the handler
+    void* frames[1];
+    backtrace(frames, 1);
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = HandleProfSignal;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    if (sigaction(SIGPROF, &action, nullptr) != 0) {
+      LOG_GENERAL(WARNING, "Cannot install the SIGPROF handler");
+      return false;
+    }
+    // Kept afterwards, as a signal still pending on Stop would otherwise
+    // terminate the process
+    m_handlerInstalled = true;
+  }
+
+  m_startInMilliseconds = NowInMilliseconds();
+  m_running = true;
+  if (!SetTimer(frequency)) {
+    m_running = false;
+    LOG_GENERAL(WARNING, "Cannot start the profiling timer");
+    return false;
+  }
+
+  LOG_GENERAL(INFO, "Profiler started at " << frequency << " Hz");
+  return true;
+}
+
+void SamplingProfiler::RecordSample(void* const* frames, int depth) {
+  m_inHandler++;
+  if (m_running) {
+    const size_t index = m_next++;
+    if (index < m_samples.size()) {
+      Sample& sample = m_samples[index];
+      sample.m_tid = static_cast<int32_t>(syscall(SYS_gettid));
+      sample.m_depth = min(max(depth, 0), static_cast<int>(MAX_FRAMES));
+      memcpy(sample.m_frames, frames, sample.m_depth * sizeof(void*));
+    } else {
+      m_dropped++;
+    }
+  }
+  m_inHandler--;
+}
+
+bool SamplingProfiler::Stop(Profile& profile) {
+  lock_guard<mutex> g(m_mutexControl);
+
+  if (!m_running) {
+    LOG_GENERAL(WARNING, "Profiler not running");
+    return false;
+  }
+
+  SetTimer(0);
+  m_running = false;
+  // Let handlers already running on other threads finish their sample
+  while (m_inHandler > 0) {
+    this_thread::yield();
+  }
+
+  const size_t count = min<size_t>(m_next, m_samples.size());
+  profile.m_samples = count;
+  profile.m_dropped = m_dropped;
+  profile.m_durationInMilliseconds =
+      NowInMilliseconds() - m_startInMilliseconds;
+
+  vector<Module> modules;
+  dl_iterate_phdr(CollectModule, &modules);
+
+  unordered_map<void*, string> symbols;
+  unordered_map<int32_t, string> threadNames;
+  map<string, uint64_t> stacks;
+  for (size_t i = 0; i < count; i++) {
+    const Sample& sample = m_samples[i];
+    auto thread = threadNames.find(sample.m_tid);
+    if (thread == threadNames.end()) {
+      thread =
+          threadNames.emplace(sample.m_tid, ThreadName(sample.m_tid)).first;
+    }
+
+    string stack = thread->second;
+    for (int depth = sample.m_depth - 1; depth >= 0; depth--) {
+      // Return addresses point past the call; the interrupted one does not
+      void* address = sample.m_frames[depth];
+      if (depth > 0) {
+        address = static_cast<char*>(address) - 1;
+      }
+      auto symbol = symbols.find(address);
+      if (symbol == symbols.end()) {
+        symbol = symbols.emplace(address, Symbolize(address, modules)).first;
+      }
+      stack += ';' + symbol->second;
+    }
+    stacks[stack]++;
+  }
+
+  vector<pair<string, uint64_t>> ordered(stacks.begin(), stacks.end());
+  stable_sort(
+      ordered.begin(), ordered.end(),
+      [](const pair<string, uint64_t>& a, const pair<string, uint64_t>& b) {
+        return a.second > b.second;
+      });
+  ostringstream folded;
+  for (const auto& stack : ordered) {
+    folded << stack.first << ' ' << stack.second << '\n';
+  }
+  profile.m_folded = folded.str();
+
+  m_samples.clear();
+  m_samples.shrink_to_fit();
+
+  LOG_GENERAL(INFO, "Profiler stopped with " << profile.m_samples
+                                             << " samples, "
+                                             << profile.m_dropped
+                                             << " dropped");
+  return true;
+}
+
+string SamplingProfiler::GetBuildId() {
+  string buildId;
+  dl_iterate_phdr(FindBuildId, &buildId);
+  return buildId;
+}
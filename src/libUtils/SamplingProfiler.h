@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __SAMPLINGPROFILER_H__
+#define __SAMPLINGPROFILER_H__
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/// On-demand CPU profiler for a running node.
+///
+/// While running, SIGPROF fires at the requested rate of consumed CPU time
+/// and the handler records the stack of whichever thread was on the CPU
+/// into a preallocated buffer of PROFILER_MAX_SAMPLES samples (later ones
+/// are counted as dropped). Stop turns the stacks into the folded format of
+/// flamegraph.pl, one "thread;outermost;...;innermost count" line per
+/// distinct stack. Frames without a dynamic symbol are written as
+/// "module+0xoffset", to be resolved offline with addr2line against the
+/// binary carrying GetBuildId().
+class SamplingProfiler {
+ public:
+  static const unsigned int MAX_FRAMES = 48;
+  static const unsigned int MAX_FREQUENCY = 1000;
+
+  struct Sample {
+    int32_t m_tid;
+    int32_t m_depth;
+    void* m_frames[MAX_FRAMES];
+  };
+
+  struct Profile {
+    std::string m_folded;
+    uint64_t m_samples;
+    uint64_t m_dropped;
+    uint64_t m_durationInMilliseconds;
+  };
+
+ private:
+  std::mutex m_mutexControl;
+  std::vector<Sample> m_samples;
+  std::atomic<size_t> m_next;
+  std::atomic<uint64_t> m_dropped;
+  std::atomic<bool> m_running;
+  std::atomic<unsigned int> m_inHandler;
+  bool m_handlerInstalled;
+  uint64_t m_startInMilliseconds;
+
+  SamplingProfiler();
+  ~SamplingProfiler() = default;
+
+  SamplingProfiler(SamplingProfiler const&) = delete;
+  void operator=(SamplingProfiler const&) = delete;
+
+ public:
+  /// Returns the singleton instance.
+  static SamplingProfiler& GetInstance();
+
+  /// Starts sampling all threads frequency times per second of CPU time.
+  /// Fails if already running or frequency is not within 1..MAX_FREQUENCY.
+  bool Start(unsigned int frequency);
+
+  /// Stops sampling and folds what was recorded since Start
+  bool Stop(Profile& profile);
+
+  bool IsRunning() const { return m_running; }
+
+  /// Records a stack of the calling thread, innermost frame first; called
+  /// from the signal handler
+  void RecordSample(void* const* frames, int depth);
+
+  /// Returns the GNU build-id of the running executable in hex, or an empty
+  /// string if it was linked without one
+  static std::string GetBuildId();
+};
+
+#endif  // __SAMPLINGPROFILER_H__
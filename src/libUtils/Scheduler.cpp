@@ -15,76 +15,254 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <sstream>
+
 #include "Scheduler.h"
-#include "ReverseLock.h"
+#include "libUtils/Logger.h"
 
 using namespace std;
 
-Scheduler::Scheduler() {}
+const unsigned int Scheduler::LEVELS;
+const unsigned int Scheduler::SLOT_BITS;
+const unsigned int Scheduler::SLOTS;
 
-Scheduler::~Scheduler() {}
+Scheduler::Scheduler(chrono::milliseconds tick)
+    : m_tick(max<Clock::duration>(tick, chrono::milliseconds(1))),
+      m_start(Clock::now()) {
+  m_thread = thread([this]() { Run(); });
+}
 
-void Scheduler::ServiceQueue() {
-  unique_lock<mutex> lock(newTaskMutex);
+Scheduler::~Scheduler() {
+  {
+    lock_guard<mutex> g(m_mutex);
+    m_stopping = true;
+  }
+  m_cvTimer.notify_one();
+  if (m_thread.joinable()) {
+    m_thread.join();
+  }
+}
 
-  while (true) {
-    try {
-      while (taskQueue.empty()) {
-        newTaskScheduled.wait(lock);
-      }
-
-      while (!taskQueue.empty()) {
-        std::chrono::time_point<std::chrono::system_clock> timeToWaitFor =
-            taskQueue.begin()->first;
-        if (newTaskScheduled.wait_until(lock, timeToWaitFor) ==
-            std::cv_status::timeout) {
-          break;
-        }
-      }
-
-      if (taskQueue.empty()) {
-        continue;
-      }
-
-      std::function<void(void)> f = taskQueue.begin()->second;
-      taskQueue.erase(taskQueue.begin());
-
-      {
-        ReverseLock<unique_lock<mutex>> rlock(lock);
-        f();
-      }
-    } catch (...) {
-      throw;
-    }
+Scheduler& Scheduler::GetInstance() {
+  static Scheduler scheduler;
+  return scheduler;
+}
+
+uint64_t Scheduler::NowTick() const {
+  return (Clock::now() - m_start) / m_tick;
+}
+
+uint64_t Scheduler::ToTicks(chrono::milliseconds delay) const {
+  if (delay.count() <= 0) {
+    return 0;
   }
-  newTaskScheduled.notify_one();
+  const Clock::duration d = delay;
+  return (d + m_tick - Clock::duration(1)) / m_tick;
 }
 
-void Scheduler::ScheduleAt(std::function<void(void)> f,
-                           chrono::time_point<chrono::system_clock> t) {
+void Scheduler::Place(Slot& from, Slot::iterator it) {
+  const uint64_t span = uint64_t(1) << (SLOT_BITS * LEVELS);
+  uint64_t delta = (it->m_due > m_current) ? it->m_due - m_current : 0;
+  uint64_t due = m_current + delta;
+  if (delta >= span) {
+    // Parked in the top level, and placed again once it cascades
+    delta = span - 1;
+    due = m_current + delta;
+  }
+
+  unsigned int level = 0;
+  while ((level + 1 < LEVELS) &&
+         (delta >= (uint64_t(1) << (SLOT_BITS * (level + 1))))) {
+    level++;
+  }
+
+  Slot& to = m_wheel[level][(due >> (SLOT_BITS * level)) & (SLOTS - 1)];
+  it->m_slot = &to;
+  to.splice(to.end(), from, it);
+}
+
+Scheduler::TimerId Scheduler::Add(chrono::milliseconds delay, uint64_t period,
+                                  const string& name, Task&& task) {
+  bool wake = false;
+  TimerId id = 0;
   {
-    lock_guard<mutex> lock(newTaskMutex);
-    taskQueue.emplace(t, f);
+    lock_guard<mutex> g(m_mutex);
+    const uint64_t now = NowTick();
+    if (m_timers.empty()) {
+      // The timer thread stops counting ticks while there is nothing to fire
+      m_current = max(m_current, now);
+      wake = true;
+    }
+
+    id = m_nextId++;
+    Slot added;
+    // The current tick is partly gone, so wait for the one after the delay
+    added.push_back(Timer{id, max(now + ToTicks(delay) + 1, m_current + 1),
+                          period, name, move(task), &added});
+    auto it = added.begin();
+    m_timers.emplace(id, it);
+    Place(added, it);
+    m_byName[name].m_pending++;
+  }
+  if (wake) {
+    m_cvTimer.notify_one();
   }
-  newTaskScheduled.notify_one();
+  return id;
+}
+
+Scheduler::TimerId Scheduler::ScheduleAfter(chrono::milliseconds delay,
+                                            Task task, const string& name) {
+  return Add(delay, 0, name, move(task));
 }
 
-void Scheduler::ScheduleAfter(std::function<void(void)> f,
-                              int64_t deltaMilliSeconds) {
-  ScheduleAt(
-      f, chrono::system_clock::now() + chrono::milliseconds(deltaMilliSeconds));
+Scheduler::TimerId Scheduler::SchedulePeriodically(chrono::milliseconds period,
+                                                   Task task,
+                                                   const string& name) {
+  return Add(period, max<uint64_t>(ToTicks(period), 1), name, move(task));
 }
 
-static void SchedulePeriodicallyHelper(Scheduler* s,
-                                       std::function<void(void)> f,
-                                       int64_t deltaMilliSeconds) {
-  f();
-  s->ScheduleAfter(bind(&SchedulePeriodicallyHelper, s, f, deltaMilliSeconds),
-                   deltaMilliSeconds);
+bool Scheduler::Cancel(TimerId id) {
+  unique_lock<mutex> lock(m_mutex);
+  bool found = false;
+  auto timer = m_timers.find(id);
+  if (timer != m_timers.end()) {
+    auto it = timer->second;
+    NameStats& stats = m_byName[it->m_name];
+    stats.m_pending--;
+    stats.m_cancelled++;
+    m_cancelled++;
+    it->m_slot->erase(it);
+    m_timers.erase(timer);
+    found = true;
+  }
+
+  if (this_thread::get_id() != m_thread.get_id()) {
+    m_cvFired.wait(lock, [this, id]() { return m_firing != id; });
+  }
+  return found;
 }
 
-void Scheduler::SchedulePeriodically(std::function<void(void)> f,
-                                     int64_t deltaMilliSeconds) {
-  ScheduleAfter(bind(&SchedulePeriodicallyHelper, this, f, deltaMilliSeconds),
-                deltaMilliSeconds);
+void Scheduler::Advance(unique_lock<mutex>& lock) {
+  m_current++;
+
+  // Cascade from the top, so timers can drop through several levels
+  for (unsigned int level = LEVELS - 1; level > 0; level--) {
+    const unsigned int shift = SLOT_BITS * level;
+    if ((m_current & ((uint64_t(1) << shift) - 1)) != 0) {
+      continue;
+    }
+    Slot cascading;
+    cascading.splice(cascading.end(),
+                     m_wheel[level][(m_current >> shift) & (SLOTS - 1)]);
+    while (!cascading.empty()) {
+      Place(cascading, cascading.begin());
+    }
+  }
+
+  Slot firing;
+  firing.splice(firing.end(), m_wheel[0][m_current & (SLOTS - 1)]);
+  for (auto& timer : firing) {
+    timer.m_slot = &firing;
+  }
+
+  while (!firing.empty()) {
+    auto it = firing.begin();
+    if (it->m_due > m_current) {
+      Place(firing, it);
+      continue;
+    }
+
+    const TimerId id = it->m_id;
+    const uint64_t late = NowTick() - it->m_due;
+    m_maxLateTicks = max(m_maxLateTicks, late);
+    m_byName[it->m_name].m_fired++;
+    m_fired++;
+
+    Task task;
+    if (it->m_period > 0) {
+      task = it->m_task;
+      it->m_due = m_current + it->m_period;
+      Place(firing, it);
+    } else {
+      m_byName[it->m_name].m_pending--;
+      task = move(it->m_task);
+      m_timers.erase(id);
+      firing.erase(it);
+    }
+
+    m_firing = id;
+    lock.unlock();
+    try {
+      task();
+    } catch (const exception& e) {
+      LOG_GENERAL(WARNING, "Timer task threw: " << e.what());
+    }
+    lock.lock();
+    m_firing = 0;
+    m_cvFired.notify_all();
+  }
+}
+
+void Scheduler::Run() {
+  unique_lock<mutex> lock(m_mutex);
+  while (!m_stopping) {
+    if (m_timers.empty()) {
+      m_cvTimer.wait(lock);
+      continue;
+    }
+
+    const uint64_t now = NowTick();
+    while ((m_current < now) && !m_timers.empty() && !m_stopping) {
+      Advance(lock);
+    }
+
+    if (!m_timers.empty() && !m_stopping) {
+      m_cvTimer.wait_until(
+          lock, m_start + m_tick * static_cast<Clock::rep>(m_current + 1));
+    }
+  }
+}
+
+Scheduler::Stats Scheduler::GetStats() {
+  Stats stats;
+  lock_guard<mutex> g(m_mutex);
+  stats.m_pending = m_timers.size();
+  stats.m_fired = m_fired;
+  stats.m_cancelled = m_cancelled;
+  stats.m_maxLateMs =
+      chrono::duration_cast<chrono::milliseconds>(
+          m_tick * static_cast<Clock::rep>(m_maxLateTicks))
+          .count();
+  stats.m_byName = m_byName;
+  return stats;
+}
+
+string Scheduler::GetPrometheusText() {
+  const Stats stats = GetStats();
+
+  ostringstream text;
+  text << "# HELP zilliqa_timers_pending Timers waiting to fire.\n"
+       << "# TYPE zilliqa_timers_pending gauge\n";
+  for (const auto& name : stats.m_byName) {
+    text << "zilliqa_timers_pending{name=\"" << name.first << "\"} "
+         << name.second.m_pending << "\n";
+  }
+  text << "# HELP zilliqa_timers_fired_total Timers fired.\n"
+       << "# TYPE zilliqa_timers_fired_total counter\n";
+  for (const auto& name : stats.m_byName) {
+    text << "zilliqa_timers_fired_total{name=\"" << name.first << "\"} "
+         << name.second.m_fired << "\n";
+  }
+  text << "# HELP zilliqa_timers_cancelled_total Timers cancelled before "
+          "firing.\n"
+       << "# TYPE zilliqa_timers_cancelled_total counter\n";
+  for (const auto& name : stats.m_byName) {
+    text << "zilliqa_timers_cancelled_total{name=\"" << name.first << "\"} "
+         << name.second.m_cancelled << "\n";
+  }
+  text << "# HELP zilliqa_timers_max_late_ms Worst delay of a timer past "
+          "its due time.\n"
+       << "# TYPE zilliqa_timers_max_late_ms gauge\n"
+       << "zilliqa_timers_max_late_ms " << stats.m_maxLateMs << "\n";
+  return text.str();
 }
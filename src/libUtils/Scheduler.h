@@ -20,40 +20,123 @@
 
 #include <chrono>
 #include <condition_variable>
+#include <cstdint>
 #include <functional>
+#include <list>
 #include <map>
 #include <mutex>
+#include <string>
 #include <thread>
+#include <unordered_map>
 
-// should be initialized this way
-// CScheduler::Function serviceLoop = boost::bind(&CScheduler::serviceQueue,
-// &scheduler);
-// threadGroup.create_thread(boost::bind(&TraceThread<CScheduler::Function>,
-// "scheduler", serviceLoop));
-
-/// [TODO] Currently unused
+/// Hierarchical timer wheel shared by the node's timeouts.
+///
+/// Time advances in ticks of a fixed length. Each level has SLOTS slots, and
+/// a slot of one level spans a whole turn of the level below it, so a timer
+/// sits in the level matching how far out it is and moves down as its time
+/// approaches. Scheduling and cancelling are O(1).
+///
+/// Timers fire on the single timer thread, never early and normally within
+/// two ticks of their time. A task must return quickly; anything longer
+/// belongs on AsyncExecutor, which uses this wheel for its delayed tasks.
 class Scheduler {
  public:
-  Scheduler();
+  using Task = std::function<void()>;
+  using TimerId = uint64_t;
+
+  static const unsigned int LEVELS = 4;
+  static const unsigned int SLOT_BITS = 6;
+  static const unsigned int SLOTS = 1 << SLOT_BITS;
+
+  /// Counts for the timers of one name
+  struct NameStats {
+    uint64_t m_pending = 0;
+    uint64_t m_fired = 0;
+    uint64_t m_cancelled = 0;
+  };
+
+  struct Stats {
+    uint64_t m_pending = 0;
+    uint64_t m_fired = 0;
+    uint64_t m_cancelled = 0;
+    /// Worst delay seen between a timer's due time and its firing
+    uint64_t m_maxLateMs = 0;
+    std::map<std::string, NameStats> m_byName;
+  };
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Timer {
+    TimerId m_id;
+    uint64_t m_due;
+    /// Ticks until the next firing, or zero for a one shot timer
+    uint64_t m_period;
+    std::string m_name;
+    Task m_task;
+    /// The slot, or the list being fired, holding the timer
+    std::list<Timer>* m_slot;
+  };
+  using Slot = std::list<Timer>;
+
+  const Clock::duration m_tick;
+  const Clock::time_point m_start;
+
+  std::mutex m_mutex;
+  std::condition_variable m_cvTimer;
+  std::condition_variable m_cvFired;
+  Slot m_wheel[LEVELS][SLOTS];
+  /// Iterators stay valid as timers are spliced between slots
+  std::unordered_map<TimerId, Slot::iterator> m_timers;
+  uint64_t m_current = 0;
+  TimerId m_nextId = 1;
+  TimerId m_firing = 0;
+  bool m_stopping = false;
+
+  uint64_t m_fired = 0;
+  uint64_t m_cancelled = 0;
+  uint64_t m_maxLateTicks = 0;
+  std::map<std::string, NameStats> m_byName;
+
+  std::thread m_thread;
+
+  Scheduler(Scheduler const&) = delete;
+  void operator=(Scheduler const&) = delete;
+
+  uint64_t NowTick() const;
+  uint64_t ToTicks(std::chrono::milliseconds delay) const;
+  TimerId Add(std::chrono::milliseconds delay, uint64_t period,
+              const std::string& name, Task&& task);
+  void Place(Slot& from, Slot::iterator it);
+  void Advance(std::unique_lock<std::mutex>& lock);
+  void Run();
+
+ public:
+  /// Starts the timer thread, advancing the wheel every tick
+  explicit Scheduler(
+      std::chrono::milliseconds tick = std::chrono::milliseconds(10));
   ~Scheduler();
 
-  void ScheduleAt(std::function<void(void)> f,
-                  std::chrono::time_point<std::chrono::system_clock> t =
-                      std::chrono::system_clock::now());
+  static Scheduler& GetInstance();
 
-  void ScheduleAfter(std::function<void(void)> f, int64_t deltaMilliSeconds);
+  /// Runs the task once delay has passed. The name groups the timer in the
+  /// stats. The id is for Cancel.
+  TimerId ScheduleAfter(std::chrono::milliseconds delay, Task task,
+                        const std::string& name = "default");
 
-  void SchedulePeriodically(std::function<void(void)> f,
-                            int64_t deltaMilliSeconds);
+  /// Runs the task every period until cancelled
+  TimerId SchedulePeriodically(std::chrono::milliseconds period, Task task,
+                               const std::string& name = "default");
 
-  void ServiceQueue();
+  /// Drops the timer. Returns false if it is unknown or has fired already.
+  /// If the timer is firing right now, waits for its task to return first,
+  /// unless called from that task.
+  bool Cancel(TimerId id);
 
- private:
-  std::multimap<std::chrono::time_point<std::chrono::system_clock>,
-                std::function<void(void)>>
-      taskQueue;
-  std::condition_variable newTaskScheduled;
-  mutable std::mutex newTaskMutex;
+  Stats GetStats();
+
+  /// Returns the stats in the Prometheus text exposition format
+  std::string GetPrometheusText();
 };
 
 #endif  // __SCHEDULER_H__
@@ -0,0 +1,58 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __SNAPSHOT_H__
+#define __SNAPSHOT_H__
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+/// Immutable copy of a structure that is mutated under a lock but read far
+/// more often than it changes.
+///
+/// Writers keep changing the original under its own mutex and call Publish()
+/// once the change is complete; this swaps in a fresh copy tagged with the
+/// epoch it was taken in. Readers never take the writers' lock: Get() hands
+/// out the copy that was current at the time, which stays valid for as long
+/// as the caller holds on to it, even across later publications.
+template <class T>
+class Snapshot {
+  std::shared_ptr<const T> m_value;
+  std::atomic<uint64_t> m_epoch;
+
+  Snapshot(Snapshot const&) = delete;
+  void operator=(Snapshot const&) = delete;
+
+ public:
+  Snapshot() : m_value(std::make_shared<const T>()), m_epoch(0) {}
+
+  /// Replaces the published copy with a copy of value.
+  void Publish(const T& value, const uint64_t& epoch) {
+    std::shared_ptr<const T> copy = std::make_shared<const T>(value);
+    std::atomic_store(&m_value, copy);
+    m_epoch = epoch;
+  }
+
+  /// Returns the currently published copy. Never null.
+  std::shared_ptr<const T> Get() const { return std::atomic_load(&m_value); }
+
+  /// Returns the epoch passed to the most recent Publish().
+  uint64_t GetEpoch() const { return m_epoch; }
+};
+
+#endif  // __SNAPSHOT_H__
@@ -0,0 +1,218 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "ThreadPlacement.h"
+
+#include <algorithm>
+#include <fstream>
+
+#include <boost/algorithm/string.hpp>
+
+#ifdef __linux__
+#include <linux/mempolicy.h>
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "libUtils/Logger.h"
+
+using namespace std;
+
+namespace {
+
+bool ParseNumber(const string& str, unsigned long& number) {
+  if (str.empty() ||
+      !all_of(str.begin(), str.end(), [](char c) { return isdigit(c); })) {
+    return false;
+  }
+  try {
+    number = stoul(str);
+  } catch (const exception&) {
+    return false;
+  }
+  return true;
+}
+
+bool ReadFirstLine(const string& path, string& line) {
+  ifstream file(path);
+  if (!getline(file, line)) {
+    return false;
+  }
+  boost::trim(line);
+  return true;
+}
+
+#ifdef __linux__
+bool SetAffinity(pthread_t thread, const vector<unsigned int>& cpus) {
+  cpu_set_t cpuset;
+  CPU_ZERO(&cpuset);
+  for (const auto& cpu : cpus) {
+    CPU_SET(cpu, &cpuset);
+  }
+  return pthread_setaffinity_np(thread, sizeof(cpu_set_t), &cpuset) == 0;
+}
+#endif
+
+}  // namespace
+
+bool ThreadPlacement::ParseCpuList(const string& list,
+                                   vector<unsigned int>& cpus) {
+  cpus.clear();
+
+  vector<string> ranges;
+  boost::split(ranges, list, boost::is_any_of(","));
+  for (auto& range : ranges) {
+    boost::trim(range);
+    if (range.empty()) {
+      continue;
+    }
+
+    const auto dash = range.find('-');
+    unsigned long first = 0;
+    if (!ParseNumber(range.substr(0, dash), first)) {
+      return false;
+    }
+    unsigned long last = first;
+    if (dash != string::npos && !ParseNumber(range.substr(dash + 1), last)) {
+      return false;
+    }
+#ifdef __linux__
+    if (last >= CPU_SETSIZE) {
+      return false;
+    }
+#endif
+    if (last < first) {
+      return false;
+    }
+    for (unsigned long cpu = first; cpu <= last; cpu++) {
+      cpus.emplace_back(cpu);
+    }
+  }
+
+  sort(cpus.begin(), cpus.end());
+  cpus.erase(unique(cpus.begin(), cpus.end()), cpus.end());
+  return !cpus.empty();
+}
+
+bool ThreadPlacement::Parse(const string& spec) {
+  m_cpus.clear();
+  m_numaNode = -1;
+
+  string trimmed = boost::trim_copy(spec);
+  if (trimmed.empty()) {
+    return true;
+  }
+
+  string nodeStr;
+  if (boost::starts_with(trimmed, "nic:")) {
+    const string nic = trimmed.substr(4);
+    // -1 when the machine (or the NIC) has no NUMA locality
+    if (nic.empty() || nic.find('/') != string::npos ||
+        !ReadFirstLine("/sys/class/net/" + nic + "/device/numa_node",
+                       nodeStr) ||
+        nodeStr == "-1") {
+      return false;
+    }
+  } else if (boost::starts_with(trimmed, "node:")) {
+    nodeStr = trimmed.substr(5);
+  } else {
+    return ParseCpuList(trimmed, m_cpus);
+  }
+
+  unsigned long node = 0;
+  string cpuList;
+  if (!ParseNumber(nodeStr, node) ||
+      !ReadFirstLine(
+          "/sys/devices/system/node/node" + to_string(node) + "/cpulist",
+          cpuList) ||
+      !ParseCpuList(cpuList, m_cpus)) {
+    m_cpus.clear();
+    return false;
+  }
+  m_numaNode = node;
+  return true;
+}
+
+ThreadPlacement ThreadPlacement::Resolve(const string& spec,
+                                         const string& name) {
+  ThreadPlacement placement;
+  if (!placement.Parse(spec)) {
+    LOG_GENERAL(WARNING, "Cannot place " << name << " threads on \"" << spec
+                                         << "\", leaving them unpinned");
+  }
+  return placement;
+}
+
+ThreadPlacement ThreadPlacement::GetOneCpu(unsigned int index) const {
+  ThreadPlacement placement;
+  placement.m_numaNode = m_numaNode;
+  if (m_cpus.empty()) {
+    placement.m_cpus.emplace_back(index %
+                                  max(1u, thread::hardware_concurrency()));
+  } else {
+    placement.m_cpus.emplace_back(m_cpus[index % m_cpus.size()]);
+  }
+  return placement;
+}
+
+bool ThreadPlacement::ApplyToCurrentThread() const {
+  if (IsEmpty()) {
+    return true;
+  }
+
+#ifdef __linux__
+  if (!SetAffinity(pthread_self(), m_cpus)) {
+    LOG_GENERAL(WARNING, "pthread_setaffinity_np failure. Code = " << errno);
+    return false;
+  }
+
+  if (m_numaNode >= 0) {
+    // The kernel reads maxnode - 1 bits of the mask
+    const unsigned int bitsPerWord = 8 * sizeof(unsigned long);
+    vector<unsigned long> nodeMask(m_numaNode / bitsPerWord + 1, 0);
+    nodeMask[m_numaNode / bitsPerWord] = 1ul << (m_numaNode % bitsPerWord);
+    if (syscall(SYS_set_mempolicy, MPOL_PREFERRED, nodeMask.data(),
+                nodeMask.size() * bitsPerWord + 1) != 0) {
+      LOG_GENERAL(WARNING, "set_mempolicy failure. Code = " << errno);
+      return false;
+    }
+  }
+  return true;
+#else
+  LOG_GENERAL(WARNING, "Thread placement is only supported on Linux");
+  return false;
+#endif
+}
+
+bool ThreadPlacement::Apply(thread& thread) const {
+  if (IsEmpty()) {
+    return true;
+  }
+
+#ifdef __linux__
+  if (!SetAffinity(thread.native_handle(), m_cpus)) {
+    LOG_GENERAL(WARNING, "pthread_setaffinity_np failure. Code = " << errno);
+    return false;
+  }
+  return true;
+#else
+  (void)thread;
+  LOG_GENERAL(WARNING, "Thread placement is only supported on Linux");
+  return false;
+#endif
+}
@@ -0,0 +1,69 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __THREADPLACEMENT_H__
+#define __THREADPLACEMENT_H__
+
+#include <string>
+#include <thread>
+#include <vector>
+
+/// The CPUs and NUMA node a group of threads runs and allocates on.
+///
+/// Placements are read from constants.xml as one of
+///   ""          anywhere, as the scheduler sees fit
+///   "0-7,16"    the listed CPUs
+///   "node:1"    the CPUs of NUMA node 1, preferring its memory
+///   "nic:eth0"  the CPUs and memory of the NUMA node eth0 is attached to
+class ThreadPlacement {
+ public:
+  ThreadPlacement() = default;
+
+  /// Returns false, leaving the placement empty, if spec does not resolve to
+  /// any CPU on this machine
+  bool Parse(const std::string& spec);
+
+  /// Parses the placement of a constants.xml entry, warning if it is ignored
+  static ThreadPlacement Resolve(const std::string& spec,
+                                 const std::string& name);
+
+  /// Reads a kernel CPU list such as "0-3,8,10-11" into sorted CPU numbers
+  static bool ParseCpuList(const std::string& list,
+                           std::vector<unsigned int>& cpus);
+
+  bool IsEmpty() const { return m_cpus.empty(); }
+  const std::vector<unsigned int>& GetCpus() const { return m_cpus; }
+  int GetNumaNode() const { return m_numaNode; }
+
+  /// The index-th CPU of the placement (cycling), on the same node. An empty
+  /// placement picks from all hardware threads.
+  ThreadPlacement GetOneCpu(unsigned int index) const;
+
+  /// Binds the calling thread to the CPUs and, if the placement is a NUMA
+  /// node, makes its new allocations prefer that node's memory
+  bool ApplyToCurrentThread() const;
+
+  /// Binds another thread to the CPUs only, as the memory policy can only be
+  /// set by the thread itself
+  bool Apply(std::thread& thread) const;
+
+ private:
+  std::vector<unsigned int> m_cpus;
+  int m_numaNode = -1;
+};
+
+#endif  // __THREADPLACEMENT_H__
@@ -18,80 +18,129 @@
 #ifndef CONCURRENT_THREADPOOL_H
 #define CONCURRENT_THREADPOOL_H
 
+#include <algorithm>
+#include <atomic>
 #include <condition_variable>
-#include <functional>
+#include <deque>
+#include <iterator>
+#include <memory>
 #include <mutex>
+#include <string>
 #include <thread>
-
-/**
- *  Set to 1 to use vector instead of queue for jobs container to improve
- *  memory locality however changes job order from FIFO to LIFO.
- */
-#define CONTIGUOUS_JOBS_MEMORY 0
-#if CONTIGUOUS_JOBS_MEMORY
+#include <type_traits>
+#include <utility>
 #include <vector>
-#else
-#include <queue>
-#endif
+
+#include "libUtils/ThreadPlacement.h"
 
 /**
- * Simple thread pool that creates `threadCount` threads upon its creation, and
- * pulls from a queue to get new jobs. This class requires a number of C++11
- * features be present in your compiler.
+ * Work-stealing thread pool that creates `threadCount` threads upon its
+ * creation. Every thread owns a deque of jobs; new jobs are spread over the
+ * deques (or kept on the submitting thread's own deque when added from inside
+ * the pool), and a thread whose deque is empty steals from the others. Each
+ * deque has its own lock, so submitters and workers rarely contend.
+ *
+ * Jobs are taken from the front of their deque and stolen from the back, so
+ * ordering is only roughly FIFO.
+ *
+ * Every thread applies the pool's placement (CPUs and NUMA node) to itself
+ * before taking its first job.
  */
 class ThreadPool {
  public:
-  typedef std::function<void()> Job;
+  /// Move-only type-erased job, so that jobs may own non-copyable state.
+  class Job {
+    struct Base {
+      virtual ~Base() {}
+      virtual void Run() = 0;
+    };
+
+    template <class F>
+    struct Impl : Base {
+      F m_func;
+      template <class G>
+      explicit Impl(G&& func) : m_func(std::forward<G>(func)) {}
+      void Run() override { m_func(); }
+    };
+
+    std::unique_ptr<Base> m_impl;
+
+   public:
+    Job() = default;
+    Job(Job&&) = default;
+    Job& operator=(Job&&) = default;
+
+    template <class F, class = typename std::enable_if<!std::is_same<
+                           typename std::decay<F>::type, Job>::value>::type>
+    Job(F&& func)
+        : m_impl(new Impl<typename std::decay<F>::type>(
+              std::forward<F>(func))) {}
+
+    explicit operator bool() const { return m_impl != nullptr; }
+    void operator()() { m_impl->Run(); }
+  };
 
   /// Constructor.
-#if CONTIGUOUS_JOBS_MEMORY
   explicit ThreadPool(const unsigned int threadCount,
                       const std::string& poolName,
-                      const unsigned int jobsReserveCount = 0)
-#else
-  explicit ThreadPool(const unsigned int threadCount,
-                      const std::string& poolName)
-#endif
-      : _jobsLeft(0),
+                      const ThreadPlacement& placement = ThreadPlacement())
+      : _workers(std::max(threadCount, 1u)),
+        _jobsLeft(0),
+        _sleepers(0),
+        _nextWorker(0),
         _bailout(false),
         _poolName(poolName),
-        _jobAvailableVar(),
-        _jobsLeftMutex(),
-        _queueMutex() {
-    _threads.reserve(threadCount);
-    for (unsigned int index = 0; index < threadCount; ++index) {
-      _threads.push_back(std::thread([this] { this->Task(); }));
+        _placement(placement) {
+    _threads.reserve(_workers.size());
+    for (unsigned int index = 0; index < _workers.size(); ++index) {
+      _threads.push_back(std::thread([this, index] { this->Task(index); }));
     }
-
-#if CONTIGUOUS_JOBS_MEMORY
-    if (jobsReserveCount > 0) {
-      _queue.reserve(jobsReserveCount);
-    }
-#endif
   }
 
   /// Destructor (JoinAll on deconstruction).
   ~ThreadPool() { JoinAll(); }
 
-  /// Adds a new job to the pool. If there are no jobs in the queue, a thread is
-  /// woken up to take the job. If all threads are busy, the job is added to the
-  /// end of the queue.
-  void AddJob(const Job& job) {
-    std::lock(_queueMutex, _jobsLeftMutex);
-    std::lock_guard<std::mutex> lg1(_queueMutex, std::adopt_lock);
-    std::lock_guard<std::mutex> lg2(_jobsLeftMutex, std::adopt_lock);
-
-#if CONTIGUOUS_JOBS_MEMORY
-    _queue.push_back(job);
-#else
-    _queue.push(job);
-#endif
-    ++_jobsLeft;
-    _jobAvailableVar.notify_one();
-
-    if (0 == _jobsLeft % 100) {
-      LOG_GENERAL(INFO, "PoolName: " << _poolName << " JobLeft: " << _jobsLeft);
+  /// Adds a new job to the pool. A sleeping thread, if any, is woken up to
+  /// take it.
+  void AddJob(Job job) {
+    const unsigned int index = PickWorker();
+    {
+      std::lock_guard<std::mutex> lock(_workers[index].m_mutex);
+      _workers[index].m_jobs.emplace_back(std::move(job));
+    }
+
+    const int jobsLeft = ++_jobsLeft;
+    WakeUp(1);
+
+    if (0 == jobsLeft % 100) {
+      LOG_GENERAL(INFO, "PoolName: " << _poolName << " JobLeft: " << jobsLeft);
+    }
+  }
+
+  /// Adds all jobs of the range [first, last), moving them out of it. Jobs are
+  /// handed to the threads in contiguous chunks, taking each deque lock once.
+  template <class Iterator>
+  void AddJobs(Iterator first, Iterator last) {
+    const size_t count = std::distance(first, last);
+    if (count == 0) {
+      return;
+    }
+
+    const size_t chunks = std::min(count, _workers.size());
+    const size_t chunkSize = (count + chunks - 1) / chunks;
+    size_t added = 0;
+
+    while (first != last) {
+      const unsigned int index = PickWorker();
+      std::lock_guard<std::mutex> lock(_workers[index].m_mutex);
+      for (size_t i = 0; (i < chunkSize) && (first != last); ++i, ++first) {
+        _workers[index].m_jobs.emplace_back(std::move(*first));
+        ++added;
+      }
     }
+
+    _jobsLeft += added;
+    WakeUp(chunks);
   }
 
   /// Joins with all threads. Blocks until all threads have completed. The queue
@@ -100,7 +149,7 @@ class ThreadPool {
   void JoinAll() {
     // scoped lock
     {
-      std::lock_guard<std::mutex> lock(_queueMutex);
+      std::lock_guard<std::mutex> lock(_idleMutex);
       if (_bailout) {
         return;
       }
@@ -129,64 +178,104 @@ class ThreadPool {
   std::vector<std::thread>& GetThreads() { return _threads; }
 
  private:
+  struct Worker {
+    std::mutex m_mutex;
+    std::deque<Job> m_jobs;
+  };
+
+  /// The pool and worker index the calling thread belongs to, if any
+  static std::pair<const ThreadPool*, unsigned int>& CurrentWorker() {
+    static thread_local std::pair<const ThreadPool*, unsigned int> current{
+        nullptr, 0};
+    return current;
+  }
+
+  unsigned int PickWorker() {
+    const auto& current = CurrentWorker();
+    if (current.first == this) {
+      return current.second;
+    }
+    return _nextWorker++ % _workers.size();
+  }
+
+  void WakeUp(size_t count) {
+    if (_sleepers == 0) {
+      return;
+    }
+
+    std::lock_guard<std::mutex> lock(_idleMutex);
+    if (count == 1) {
+      _jobAvailableVar.notify_one();
+    } else {
+      _jobAvailableVar.notify_all();
+    }
+  }
+
+  bool TryTake(unsigned int index, Job& job) {
+    // Own deque first, then steal from the back of the others
+    for (size_t i = 0; i < _workers.size(); ++i) {
+      Worker& worker = _workers[(index + i) % _workers.size()];
+      std::lock_guard<std::mutex> lock(worker.m_mutex);
+      if (worker.m_jobs.empty()) {
+        continue;
+      }
+      if (i == 0) {
+        job = std::move(worker.m_jobs.front());
+        worker.m_jobs.pop_front();
+      } else {
+        job = std::move(worker.m_jobs.back());
+        worker.m_jobs.pop_back();
+      }
+      --_jobsLeft;
+      return true;
+    }
+    return false;
+  }
+
   /**
-   *  Take the next job in the queue and run it.
-   *  Notify the main thread that a job has completed.
+   *  Take the next job and run it, sleeping while there is none.
    */
-  void Task() {
+  void Task(unsigned int index) {
+    CurrentWorker() = {this, index};
+    _placement.ApplyToCurrentThread();
+
     while (true) {
       Job job;
 
-      // scoped lock
-      {
-        std::unique_lock<std::mutex> lock(_queueMutex);
-
+      if (!TryTake(index, job)) {
+        std::unique_lock<std::mutex> lock(_idleMutex);
         if (_bailout) {
           return;
         }
 
-        // Wait for a job if we don't have any.
+        ++_sleepers;
         _jobAvailableVar.wait(lock,
-                              [this] { return !_queue.empty() || _bailout; });
+                              [this] { return _jobsLeft > 0 || _bailout; });
+        --_sleepers;
 
         if (_bailout) {
           return;
         }
-
-        // Get job from the queue
-#if CONTIGUOUS_JOBS_MEMORY
-        job = _queue.back();
-        _queue.pop_back();
-#else
-        job = _queue.front();
-        _queue.pop();
-#endif
+        continue;
       }
 
       job();
-
-      // scoped lock
-      {
-        std::lock_guard<std::mutex> lock(_jobsLeftMutex);
-        --_jobsLeft;
-      }
     }
   }
 
+  std::vector<Worker> _workers;
   std::vector<std::thread> _threads;
-#if CONTIGUOUS_JOBS_MEMORY
-  std::vector<Job> _queue;
-#else
-  std::queue<Job> _queue;
-#endif
-
-  int _jobsLeft;
-  bool _bailout;
+
+  /// Jobs added but not yet taken by a thread (may briefly go negative while
+  /// a job is taken before its submitter counted it)
+  std::atomic<int> _jobsLeft;
+  std::atomic<unsigned int> _sleepers;
+  std::atomic<unsigned int> _nextWorker;
+  std::atomic<bool> _bailout;
   std::string _poolName;
+  const ThreadPlacement _placement;
   std::condition_variable _jobAvailableVar;
-  std::mutex _jobsLeftMutex;
-  std::mutex _queueMutex;
+  std::mutex _idleMutex;
 };
 
-#undef CONTIGUOUS_JOBS_MEMORY
 #endif  // CONCURRENT_THREADPOOL_H
@@ -24,17 +24,20 @@
 #include <memory>
 #include <thread>
 
+#include "libUtils/AsyncExecutor.h"
 #include "libUtils/Logger.h"
 
-/// Utility class for executing a primary function and a subsequent expiry
-/// function in separate join-able threads.
+/// Utility class for executing a primary function in a join-able thread, and
+/// a subsequent expiry function on the shared AsyncExecutor once the
+/// expiration passes.
 class TimeLockedFunction {
  private:
   std::shared_ptr<std::promise<int>> result_promise;
   std::future<int> result_future;
 
   std::unique_ptr<std::thread> thread_main;
-  std::unique_ptr<std::thread> thread_timer;
+  AsyncExecutor::TaskId timer;
+  std::future<void> timer_future;
 
  public:
   /// Template constructor.
@@ -65,32 +68,40 @@ class TimeLockedFunction {
 
     thread_main = std::make_unique<std::thread>(func_main, result_promise);
 
-    auto func_timer =
-        [expiration_in_seconds, task_expiry](
-            std::shared_ptr<std::promise<int>> result_promise) -> void {
+    auto timer_promise = std::make_shared<std::promise<void>>();
+    timer_future = timer_promise->get_future();
+
+    auto func_timer = [expiration_in_seconds, task_expiry, timer_promise,
+                       result_promise = result_promise]() -> void {
       try {
-        LOG_GENERAL(INFO, "Entering sleep for " +
-                              std::to_string(expiration_in_seconds) +
-                              " seconds");
-        std::this_thread::sleep_for(
-            std::chrono::seconds(expiration_in_seconds));
-        LOG_GENERAL(INFO, "Woken up from the sleep of " +
+        LOG_GENERAL(INFO, "Woken up after " +
                               std::to_string(expiration_in_seconds) +
                               " seconds");
         result_promise->set_value(-1);
         task_expiry();
       } catch (std::future_error&) {
         // Function returned on time
+      } catch (...) {
+        timer_promise->set_value();
+        throw;
       }
+      timer_promise->set_value();
     };
 
-    thread_timer = std::make_unique<std::thread>(func_timer, result_promise);
+    LOG_GENERAL(INFO, "Expiring in " + std::to_string(expiration_in_seconds) +
+                          " seconds");
+    timer = AsyncExecutor::GetInstance().PostAfter(
+        std::chrono::seconds(expiration_in_seconds), func_timer,
+        "time_locked_function");
   }
 
-  /// Destructor. Joins both launched threads.
+  /// Destructor. Joins the main thread, and waits for the expiry function
+  /// unless the main function returned before the expiration.
   ~TimeLockedFunction() {
     thread_main->join();
-    thread_timer->join();
+    if (!AsyncExecutor::GetInstance().Cancel(timer)) {
+      timer_future.wait();
+    }
     result_future.get();
   }
 };
@@ -0,0 +1,232 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <fstream>
+#include <sstream>
+
+#include "Tracer.h"
+#include "common/Constants.h"
+#include "libUtils/Logger.h"
+
+using namespace std;
+
+namespace {
+struct ThreadBufferHolder {
+  shared_ptr<Tracer::ThreadBuffer> m_buffer;
+
+  ~ThreadBufferHolder() {
+    if (m_buffer) {
+      Tracer::GetInstance().RetireThread(m_buffer);
+    }
+  }
+};
+
+thread_local ThreadBufferHolder t_bufferHolder;
+thread_local unsigned int t_spanDepth = 0;
+thread_local bool t_rootSampled = false;
+thread_local uint64_t t_rootSpans = 0;
+
+void HandleDumpSignal([[gnu::unused]] int signum) {
+  Tracer::GetInstance().RequestDump();
+}
+
+vector<TraceEvent> OrderedEvents(const Tracer::ThreadBuffer& buffer) {
+  vector<TraceEvent> events;
+  events.reserve(buffer.m_events.size());
+  events.insert(events.end(), buffer.m_events.begin() + buffer.m_next,
+                buffer.m_events.end());
+  events.insert(events.end(), buffer.m_events.begin(),
+                buffer.m_events.begin() + buffer.m_next);
+  return events;
+}
+}  // namespace
+
+Tracer::Tracer()
+    : m_retiredEvents(0), m_dumpRequested(false), m_stopWatcher(false) {
+  if (TRACE_ENABLED && !TRACE_DUMP_FILE.empty()) {
+    signal(SIGUSR2, HandleDumpSignal);
+    m_watcher = thread(&Tracer::WatchDumpRequests, this);
+  }
+}
+
+Tracer::~Tracer() {
+  if (m_watcher.joinable()) {
+    m_stopWatcher = true;
+    m_watcher.join();
+  }
+}
+
+Tracer& Tracer::GetInstance() {
+  static Tracer tracer;
+  return tracer;
+}
+
+uint64_t Tracer::Now() {
+  return chrono::duration_cast<chrono::microseconds>(
+             chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+shared_ptr<Tracer::ThreadBuffer> Tracer::RegisterThread() {
+  auto buffer = make_shared<ThreadBuffer>();
+  buffer->m_tid = Logger::GetPid();
+  buffer->m_next = 0;
+
+  lock_guard<mutex> g(m_mutexBuffers);
+  m_buffers.emplace_back(buffer);
+  return buffer;
+}
+
+void Tracer::Record(const char* name, uint64_t startInMicroseconds,
+                    uint64_t durationInMicroseconds) {
+  if (!t_bufferHolder.m_buffer) {
+    t_bufferHolder.m_buffer = RegisterThread();
+  }
+
+  ThreadBuffer& buffer = *t_bufferHolder.m_buffer;
+  const TraceEvent event{name, startInMicroseconds, durationInMicroseconds};
+
+  lock_guard<mutex> g(buffer.m_mutex);
+  if (buffer.m_events.size() < max(TRACE_BUFFER_EVENTS, 1u)) {
+    buffer.m_events.emplace_back(event);
+  } else {
+    buffer.m_events[buffer.m_next] = event;
+    buffer.m_next = (buffer.m_next + 1) % buffer.m_events.size();
+  }
+}
+
+void Tracer::RetireThread(const shared_ptr<ThreadBuffer>& buffer) {
+  ThreadTraceEvents retired;
+  {
+    lock_guard<mutex> g(buffer->m_mutex);
+    retired = {buffer->m_tid, OrderedEvents(*buffer)};
+  }
+
+  lock_guard<mutex> g(m_mutexBuffers);
+
+  m_buffers.erase(remove(m_buffers.begin(), m_buffers.end(), buffer),
+                  m_buffers.end());
+
+  if (retired.m_events.empty()) {
+    return;
+  }
+
+  m_retiredEvents += retired.m_events.size();
+  m_retired.emplace_back(move(retired));
+
+  // Drop the oldest events once the shared ring is full
+  while (m_retiredEvents > TRACE_BUFFER_EVENTS && !m_retired.empty()) {
+    auto& oldest = m_retired.front().m_events;
+    const size_t excess = m_retiredEvents - TRACE_BUFFER_EVENTS;
+    if (oldest.size() <= excess) {
+      m_retiredEvents -= oldest.size();
+      m_retired.erase(m_retired.begin());
+    } else {
+      oldest.erase(oldest.begin(), oldest.begin() + excess);
+      m_retiredEvents -= excess;
+    }
+  }
+}
+
+vector<ThreadTraceEvents> Tracer::GetEvents() {
+  lock_guard<mutex> g(m_mutexBuffers);
+
+  vector<ThreadTraceEvents> result = m_retired;
+  for (const auto& buffer : m_buffers) {
+    lock_guard<mutex> gb(buffer->m_mutex);
+    result.push_back({buffer->m_tid, OrderedEvents(*buffer)});
+  }
+  return result;
+}
+
+string Tracer::GetChromeTrace() {
+  const auto pid = getpid();
+
+  ostringstream json;
+  json << "{\"traceEvents\":[";
+
+  bool first = true;
+  for (const auto& thread : GetEvents()) {
+    for (const auto& event : thread.m_events) {
+      if (!first) {
+        json << ",";
+      }
+      first = false;
+      json << "\n{\"name\":\"" << event.m_name
+           << "\",\"ph\":\"X\",\"pid\":" << pid << ",\"tid\":" << thread.m_tid
+           << ",\"ts\":" << event.m_startInMicroseconds
+           << ",\"dur\":" << event.m_durationInMicroseconds << "}";
+    }
+  }
+
+  json << "\n],\"displayTimeUnit\":\"ms\"}\n";
+  return json.str();
+}
+
+bool Tracer::DumpToFile(const string& path) {
+  ofstream file(path, ios::trunc);
+  if (!file.is_open()) {
+    LOG_GENERAL(WARNING, "Cannot open trace file " << path);
+    return false;
+  }
+
+  file << GetChromeTrace();
+  LOG_GENERAL(INFO, "Trace written to " << path);
+  return true;
+}
+
+void Tracer::WatchDumpRequests() {
+  while (!m_stopWatcher) {
+    this_thread::sleep_for(chrono::milliseconds(500));
+    if (m_dumpRequested.exchange(false)) {
+      DumpToFile(TRACE_DUMP_FILE);
+    }
+  }
+}
+
+TraceSpan::TraceSpan(const char* name)
+    : m_name(name), m_start(0), m_active(false) {
+  if (!TRACE_ENABLED) {
+    return;
+  }
+
+  if (t_spanDepth++ == 0) {
+    t_rootSampled =
+        (TRACE_SAMPLE_RATE <= 1) || (t_rootSpans++ % TRACE_SAMPLE_RATE == 0);
+  }
+
+  if (t_rootSampled) {
+    m_active = true;
+    m_start = Tracer::Now();
+  }
+}
+
+TraceSpan::~TraceSpan() {
+  if (!TRACE_ENABLED) {
+    return;
+  }
+
+  t_spanDepth--;
+
+  if (m_active) {
+    Tracer::GetInstance().Record(m_name, m_start, Tracer::Now() - m_start);
+  }
+}
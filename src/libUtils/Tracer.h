@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __TRACER_H__
+#define __TRACER_H__
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct TraceEvent {
+  /// Must point to a string that outlives the tracer, e.g. a literal
+  const char* m_name;
+  uint64_t m_startInMicroseconds;
+  uint64_t m_durationInMicroseconds;
+};
+
+struct ThreadTraceEvents {
+  int32_t m_tid;
+  std::vector<TraceEvent> m_events;
+};
+
+/// Collects the spans opened with TRACE_SPAN while TRACE_ENABLED is set.
+///
+/// Each thread records into its own ring of TRACE_BUFFER_EVENTS events, so
+/// threads never contend with each other; only one in TRACE_SAMPLE_RATE
+/// outermost spans of a thread is kept, together with every span nested in
+/// it. The spans of exited threads are kept in a shared ring of the same
+/// size. The whole trace can be read over RPC, or written as Chrome trace
+/// JSON (chrome://tracing, Perfetto) to TRACE_DUMP_FILE on SIGUSR2.
+class Tracer {
+ public:
+  struct ThreadBuffer {
+    std::mutex m_mutex;
+    int32_t m_tid;
+    std::vector<TraceEvent> m_events;
+    size_t m_next;
+  };
+
+ private:
+  std::mutex m_mutexBuffers;
+  std::vector<std::shared_ptr<ThreadBuffer>> m_buffers;
+  std::vector<ThreadTraceEvents> m_retired;
+  size_t m_retiredEvents;
+
+  std::atomic<bool> m_dumpRequested;
+  std::atomic<bool> m_stopWatcher;
+  std::thread m_watcher;
+
+  Tracer();
+  ~Tracer();
+
+  Tracer(Tracer const&) = delete;
+  void operator=(Tracer const&) = delete;
+
+  std::shared_ptr<ThreadBuffer> RegisterThread();
+  void WatchDumpRequests();
+
+ public:
+  /// Returns the singleton instance.
+  static Tracer& GetInstance();
+
+  /// Returns the time in microseconds since the Unix epoch
+  static uint64_t Now();
+
+  /// Adds a finished span to the calling thread's buffer
+  void Record(const char* name, uint64_t startInMicroseconds,
+              uint64_t durationInMicroseconds);
+
+  /// Moves the events of an exiting thread to the shared ring
+  void RetireThread(const std::shared_ptr<ThreadBuffer>& buffer);
+
+  /// Returns the recorded events of every thread, oldest first
+  std::vector<ThreadTraceEvents> GetEvents();
+
+  /// Returns the events in the Chrome trace event JSON format
+  std::string GetChromeTrace();
+
+  /// Writes GetChromeTrace() to the given file
+  bool DumpToFile(const std::string& path);
+
+  /// Asks the watcher thread to dump to TRACE_DUMP_FILE; async-signal-safe
+  void RequestDump() { m_dumpRequested = true; }
+};
+
+/// Records the time between its construction and destruction as a span.
+class TraceSpan {
+  const char* m_name;
+  uint64_t m_start;
+  bool m_active;
+
+ public:
+  explicit TraceSpan(const char* name);
+  ~TraceSpan();
+};
+
+#define TRACE_SPAN(name) TraceSpan traceSpan_(name)
+
+#endif  // __TRACER_H__
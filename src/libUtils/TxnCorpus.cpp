@@ -0,0 +1,298 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#include "Logger.h"
+#include "TxnCorpus.h"
+
+using namespace std;
+
+namespace {
+
+const string CORPUS_MAGIC = "ZILTXNC1";
+const uint32_t CORPUS_VERSION = 1;
+// magic (8) || version (4) || senders (4) || table (8)
+const size_t HEADER_SIZE = 24;
+// address (20) || first nonce (8) || txns (8) || offsets position (8)
+const size_t SENDER_ENTRY_SIZE = 44;
+const size_t OFFSET_SIZE = 8;
+
+void WriteBigEndian(uint64_t value, size_t size, string& out) {
+  for (size_t i = 0; i < size; i++) {
+    out.push_back((char)((value >> (8 * (size - 1 - i))) & 0xFF));
+  }
+}
+
+uint64_t ReadBigEndian(const unsigned char* in, size_t size) {
+  uint64_t value = 0;
+  for (size_t i = 0; i < size; i++) {
+    value = (value << 8) | in[i];
+  }
+  return value;
+}
+
+}  // namespace
+
+TxnCorpus::TxnCorpus() : m_addr(nullptr), m_size(0) {}
+
+TxnCorpus::~TxnCorpus() { Close(); }
+
+void TxnCorpus::Close() {
+  if (m_addr != nullptr) {
+    munmap((void*)m_addr, m_size);
+    m_addr = nullptr;
+    m_size = 0;
+  }
+  m_senders.clear();
+}
+
+bool TxnCorpus::Open(const string& path) {
+  Close();
+
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    LOG_GENERAL(WARNING, "Cannot open " << path << ": " << strerror(errno));
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || (uint64_t)st.st_size < HEADER_SIZE) {
+    LOG_GENERAL(WARNING, "Txn corpus " << path << " is truncated");
+    close(fd);
+    return false;
+  }
+  void* addr = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (addr == MAP_FAILED) {
+    LOG_GENERAL(WARNING, "Cannot map " << path << ": " << strerror(errno));
+    return false;
+  }
+  m_addr = (const unsigned char*)addr;
+  m_size = st.st_size;
+
+  // Packets are sliced in nonce order from all over the file
+  madvise(addr, m_size, MADV_RANDOM);
+
+  if (memcmp(m_addr, CORPUS_MAGIC.data(), CORPUS_MAGIC.size()) != 0 ||
+      ReadBigEndian(m_addr + 8, 4) != CORPUS_VERSION) {
+    LOG_GENERAL(WARNING, path << " is not a version " << CORPUS_VERSION
+                              << " txn corpus");
+    Close();
+    return false;
+  }
+
+  const uint64_t numSenders = ReadBigEndian(m_addr + 12, 4);
+  const uint64_t tablePos = ReadBigEndian(m_addr + 16, 8);
+  if (tablePos < HEADER_SIZE || tablePos > m_size ||
+      numSenders > (m_size - tablePos) / SENDER_ENTRY_SIZE) {
+    LOG_GENERAL(WARNING, "Bad sender table in txn corpus " << path);
+    Close();
+    return false;
+  }
+
+  for (uint64_t i = 0; i < numSenders; i++) {
+    const unsigned char* entry = m_addr + tablePos + i * SENDER_ENTRY_SIZE;
+    Address addr;
+    copy(entry, entry + Address::size, addr.asArray().begin());
+    Sender sender{ReadBigEndian(entry + 20, 8), ReadBigEndian(entry + 28, 8),
+                  ReadBigEndian(entry + 36, 8)};
+
+    if (sender.m_offsetsPos < HEADER_SIZE || sender.m_offsetsPos > tablePos ||
+        sender.m_numTxns >=
+            (tablePos - sender.m_offsetsPos) / OFFSET_SIZE) {
+      LOG_GENERAL(WARNING, "Bad offsets of " << addr.hex()
+                                             << " in txn corpus " << path);
+      Close();
+      return false;
+    }
+
+    if (!m_senders.emplace(addr, sender).second) {
+      LOG_GENERAL(WARNING, "Duplicate sender " << addr.hex()
+                                               << " in txn corpus " << path);
+      Close();
+      return false;
+    }
+  }
+
+  LOG_GENERAL(INFO, "Mapped txn corpus " << path << " with "
+                                         << m_senders.size() << " senders");
+
+  return true;
+}
+
+uint64_t TxnCorpus::ReadOffset(const Sender& sender, uint64_t index) const {
+  return ReadBigEndian(m_addr + sender.m_offsetsPos + index * OFFSET_SIZE,
+                       OFFSET_SIZE);
+}
+
+bool TxnCorpus::GetSlice(const Address& addr, uint64_t nonce, uint64_t count,
+                         Slice& slice) const {
+  slice = Slice();
+
+  auto it = m_senders.find(addr);
+  if (it == m_senders.end()) {
+    LOG_GENERAL(WARNING, "No txns of " << addr.hex() << " in txn corpus");
+    return false;
+  }
+
+  const auto& sender = it->second;
+  if (nonce < sender.m_firstNonce ||
+      nonce - sender.m_firstNonce >= sender.m_numTxns) {
+    LOG_GENERAL(WARNING, "No txn of " << addr.hex() << " with nonce " << nonce
+                                      << " in txn corpus");
+    return false;
+  }
+
+  const uint64_t first = nonce - sender.m_firstNonce;
+  const uint64_t last = first + min(count, sender.m_numTxns - first);
+
+  uint64_t begin = ReadOffset(sender, first);
+  if (begin < HEADER_SIZE || begin > sender.m_offsetsPos) {
+    LOG_GENERAL(WARNING, "Bad txn offset of " << addr.hex()
+                                              << " in txn corpus");
+    return false;
+  }
+
+  slice.m_data = m_addr + begin;
+  slice.m_txnSizes.reserve(last - first);
+  for (uint64_t i = first; i < last; i++) {
+    const uint64_t end = ReadOffset(sender, i + 1);
+    if (end < begin || end > sender.m_offsetsPos ||
+        end - begin > numeric_limits<uint32_t>::max()) {
+      LOG_GENERAL(WARNING, "Bad txn offset of " << addr.hex()
+                                                << " in txn corpus");
+      slice = Slice();
+      return false;
+    }
+    slice.m_txnSizes.push_back(end - begin);
+    slice.m_size += end - begin;
+    begin = end;
+  }
+
+  return true;
+}
+
+TxnCorpusWriter::TxnCorpusWriter(const string& path)
+    : m_file(path, ios::binary | ios::out | ios::trunc),
+      m_path(path),
+      m_pos(0),
+      m_inSender(false) {
+  // The header goes in last, once the sender table is known
+  if (!Write(string(HEADER_SIZE, '\0'))) {
+    LOG_GENERAL(WARNING, "Cannot create txn corpus " << path);
+  }
+}
+
+bool TxnCorpusWriter::Write(const string& data) {
+  m_file.write(data.data(), data.size());
+  if (!m_file) {
+    LOG_GENERAL(WARNING, "Write to txn corpus " << m_path << " failed");
+    return false;
+  }
+  m_pos += data.size();
+  return true;
+}
+
+bool TxnCorpusWriter::BeginSender(const Address& addr, uint64_t firstNonce) {
+  if (m_inSender) {
+    LOG_GENERAL(WARNING, "Previous sender of txn corpus " << m_path
+                                                          << " not ended");
+    return false;
+  }
+
+  for (const auto& sender : m_senders) {
+    if (sender.m_addr == addr) {
+      LOG_GENERAL(WARNING, "Sender " << addr.hex() << " already in corpus");
+      return false;
+    }
+  }
+
+  m_senders.push_back({addr, firstNonce, 0, 0});
+  m_offsets.clear();
+  m_inSender = true;
+  return true;
+}
+
+bool TxnCorpusWriter::AddTxn(const bytes& serializedTxn) {
+  if (!m_inSender) {
+    LOG_GENERAL(WARNING, "No sender begun in txn corpus " << m_path);
+    return false;
+  }
+
+  m_offsets.push_back(m_pos);
+  m_senders.back().m_numTxns++;
+  return Write(string(serializedTxn.begin(), serializedTxn.end()));
+}
+
+bool TxnCorpusWriter::EndSender() {
+  if (!m_inSender) {
+    LOG_GENERAL(WARNING, "No sender begun in txn corpus " << m_path);
+    return false;
+  }
+  m_inSender = false;
+
+  m_offsets.push_back(m_pos);
+  m_senders.back().m_offsetsPos = m_pos;
+
+  string offsets;
+  offsets.reserve(m_offsets.size() * OFFSET_SIZE);
+  for (const auto& offset : m_offsets) {
+    WriteBigEndian(offset, OFFSET_SIZE, offsets);
+  }
+  m_offsets.clear();
+
+  return Write(offsets);
+}
+
+bool TxnCorpusWriter::Finish() {
+  if (m_inSender && !EndSender()) {
+    return false;
+  }
+
+  const uint64_t tablePos = m_pos;
+  string table;
+  for (const auto& sender : m_senders) {
+    table.append((const char*)sender.m_addr.data(), Address::size);
+    WriteBigEndian(sender.m_firstNonce, 8, table);
+    WriteBigEndian(sender.m_numTxns, 8, table);
+    WriteBigEndian(sender.m_offsetsPos, 8, table);
+  }
+  if (!Write(table)) {
+    return false;
+  }
+
+  string header = CORPUS_MAGIC;
+  WriteBigEndian(CORPUS_VERSION, 4, header);
+  WriteBigEndian(m_senders.size(), 4, header);
+  WriteBigEndian(tablePos, 8, header);
+
+  m_file.seekp(0);
+  m_file.write(header.data(), header.size());
+  m_file.close();
+  if (!m_file) {
+    LOG_GENERAL(WARNING, "Write to txn corpus " << m_path << " failed");
+    return false;
+  }
+
+  return true;
+}
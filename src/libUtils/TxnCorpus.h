@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __TXNCORPUS_H__
+#define __TXNCORPUS_H__
+
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "common/BaseType.h"
+#include "libData/AccountData/Address.h"
+
+/// Pre-signed transactions for load generation, in one indexed file that is
+/// read through mmap. gentxn writes it and the lookup slices it straight
+/// into txn packets, without reading or deserializing the transactions.
+///
+/// Layout, integers big-endian:
+///   header:       magic (8) || version (4) || senders (4) || table (8)
+///   per sender:   its serialized txns back to back, by nonce, followed by
+///                 their file offsets (8 each), plus the end of the last txn
+///   sender table: address (20) || first nonce (8) || txns (8) ||
+///                 offsets position (8), per sender
+class TxnCorpus {
+ public:
+  /// Serialized txns of one sender with consecutive nonces. m_data points
+  /// into the mapping, so a slice is only valid while the corpus is open.
+  struct Slice {
+    const unsigned char* m_data = nullptr;
+    size_t m_size = 0;
+    std::vector<uint32_t> m_txnSizes;
+  };
+
+ private:
+  struct Sender {
+    uint64_t m_firstNonce;
+    uint64_t m_numTxns;
+    uint64_t m_offsetsPos;
+  };
+
+  const unsigned char* m_addr;
+  size_t m_size;
+  std::unordered_map<Address, Sender> m_senders;
+
+  uint64_t ReadOffset(const Sender& sender, uint64_t index) const;
+
+ public:
+  TxnCorpus();
+
+  /// Unmaps the corpus.
+  ~TxnCorpus();
+
+  TxnCorpus(const TxnCorpus&) = delete;
+  TxnCorpus& operator=(const TxnCorpus&) = delete;
+
+  /// Maps the corpus at path and loads its sender table.
+  bool Open(const std::string& path);
+
+  void Close();
+
+  bool IsOpen() const { return m_addr != nullptr; }
+
+  size_t GetNumSenders() const { return m_senders.size(); }
+
+  /// Gets up to count txns of addr, starting from the one with the nonce.
+  /// Fails if the corpus has no txn of addr with that nonce.
+  bool GetSlice(const Address& addr, uint64_t nonce, uint64_t count,
+                Slice& slice) const;
+};
+
+/// Writes a corpus one sender at a time, keeping only the offsets of the
+/// current sender in memory.
+class TxnCorpusWriter {
+  struct Sender {
+    Address m_addr;
+    uint64_t m_firstNonce;
+    uint64_t m_numTxns;
+    uint64_t m_offsetsPos;
+  };
+
+  std::ofstream m_file;
+  std::string m_path;
+  uint64_t m_pos;
+  std::vector<Sender> m_senders;
+  std::vector<uint64_t> m_offsets;
+  bool m_inSender;
+
+  bool Write(const std::string& data);
+
+ public:
+  /// Creates (or truncates) the corpus at path.
+  explicit TxnCorpusWriter(const std::string& path);
+
+  /// Starts the txns of addr, whose nonces count up from firstNonce.
+  bool BeginSender(const Address& addr, uint64_t firstNonce);
+
+  /// Appends the next txn of the current sender.
+  bool AddTxn(const bytes& serializedTxn);
+
+  /// Writes the offsets of the current sender.
+  bool EndSender();
+
+  /// Writes the sender table and the header.
+  bool Finish();
+};
+
+#endif  // __TXNCORPUS_H__
@@ -21,7 +21,11 @@
 #include <boost/property_tree/ptree.hpp>
 #include <boost/property_tree/xml_parser.hpp>
 #include <boost/tokenizer.hpp>
+#include "common/Messages.h"
 #include "libCrypto/MultiSig.h"
+#include "libMessage/Messenger.h"
+#include "libNetwork/P2PComm.h"
+#include "libUtils/BinaryDelta.h"
 #include "libUtils/DetachedFunction.h"
 #include "libUtils/Logger.h"
 
@@ -37,6 +41,7 @@ using namespace std;
 #define PUBLIC_KEY_LENGTH 66
 #define ZILLIQA_PACKAGE_FILE_EXTENSION "-Zilliqa.deb"
 #define SCILLA_PACKAGE_FILE_EXTENSION "-Scilla.deb"
+#define DELTA_FILE_EXTENSION ".delta"
 #define DPKG_BINARY_PATH "/usr/bin/dpkg"
 #define DPKG_CONFIG_PATH "/var/lib/dpkg/status"
 #define UPGRADE_HOST                                                      \
@@ -95,9 +100,46 @@ const string ReadDSCommFile(string propName) {
   auto pt = PTree::GetInstance();
   return pt.get<string>(propName);
 }
+
+/// Packages go to peers in chunks well below the P2P message size limit
+const uint64_t PEER_CHUNK_SIZE = 1024 * 1024;
+const unsigned int PEER_CHUNKS_PER_ROUND = 32;
+const uint64_t MAX_PACKAGE_SIZE = 1024 * PEER_CHUNK_SIZE;
+
+inline uint32_t ChunkCount(uint64_t size) {
+  return static_cast<uint32_t>((size + PEER_CHUNK_SIZE - 1) / PEER_CHUNK_SIZE);
+}
+
+inline string InstalledPackageName(const char* fileTail) {
+  return string(DOWNLOAD_FOLDER) + "/installed" + fileTail;
+}
+
+bytes Sha256(const bytes& data) {
+  SHA2<HASH_TYPE::HASH_VARIANT_256> sha2;
+  sha2.Update(data);
+  return sha2.Finalize();
+}
+
+bool ReadFile(const string& fileName, bytes& data) {
+  ifstream file(fileName, ios::binary);
+  if (!file) {
+    return false;
+  }
+  data.assign(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+  return true;
+}
+
+bool WriteFile(const string& fileName, const bytes& data) {
+  ofstream file(fileName, ios::binary | ios::trunc);
+  if (!file.write(reinterpret_cast<const char*>(data.data()), data.size())) {
+    LOG_GENERAL(WARNING, "Cannot write " << fileName);
+    return false;
+  }
+  return true;
+}
 }  // namespace
 
-UpgradeManager::UpgradeManager() {
+UpgradeManager::UpgradeManager() : m_peerFetchSize(0) {
   curl_global_init(CURL_GLOBAL_DEFAULT);
   m_curl = curl_easy_init();
 
@@ -187,8 +229,11 @@ string UpgradeManager::DownloadFile(const char* fileTail,
 
   string downloadFilePath;
 
+  // Match the end of the name only, "-Zilliqa.deb" must not pick the delta
+  const size_t tailLength = strlen(fileTail);
   for (auto s : downloadFilePaths) {
-    if (string::npos != s.rfind(fileTail)) {
+    if (s.size() >= tailLength &&
+        s.compare(s.size() - tailLength, tailLength, fileTail) == 0) {
       downloadFilePath = s;
       break;
     }
@@ -353,7 +398,8 @@ bool UpgradeManager::HasNewSW() {
   return false;
 }
 
-bool UpgradeManager::DownloadSW() {
+bool UpgradeManager::DownloadSW(const vector<Peer>& peers,
+                                uint32_t listenPort) {
   LOG_MARKER();
   lock_guard<mutex> guard(m_downloadMutex);
   string versionName = DownloadFile(VERSION_FILE_NAME);
@@ -387,31 +433,9 @@ bool UpgradeManager::DownloadSW() {
 
   LOG_GENERAL(INFO, "Constant file has been downloaded successfully.");
 
-  m_zilliqaPackageFileName = DownloadFile(ZILLIQA_PACKAGE_FILE_EXTENSION);
-
-  if (m_zilliqaPackageFileName.empty()) {
-    LOG_GENERAL(INFO, "Cannot download Zilliqa package (.deb) file!");
-  }
-
-  m_scillaPackageFileName = DownloadFile(SCILLA_PACKAGE_FILE_EXTENSION);
-
-  if (m_scillaPackageFileName.empty()) {
-    LOG_GENERAL(INFO, "Cannot download Scilla package (.deb) file!");
-  }
-
-  if (m_zilliqaPackageFileName.empty() && m_scillaPackageFileName.empty()) {
-    LOG_GENERAL(WARNING, "No package downloaded, nothing will be upgraded!");
-    m_latestSWInfo = make_shared<SWInfo>();
-    DataConversion::HexStrToUint8Vec("0", m_latestZilliqaSHA);
-    DataConversion::HexStrToUint8Vec("0", m_latestScillaSHA);
-    return false;
-  }
-
-  LOG_GENERAL(INFO, "Package (.deb) file has been downloaded successfully.");
-
   uint32_t zilliqaMajor, zilliqaMinor, zilliqaFix, zilliqaCommit, scillaMajor,
       scillaMinor, scillaFix, scillaCommit;
-  uint64_t zilliqaUpgradeDS, scillaUpgradeDS;
+  string zilliqaUpgradeDSStr, scillaUpgradeDSStr;
   string zilliqaSha, scillaSha;
 
   try {
@@ -439,18 +463,16 @@ bool UpgradeManager::DownloadSW() {
 
     zilliqaFix = stoul(line);
 
-    while (line_no != ZILLIQA_DS_LINE && getline(versionFile, line)) {
+    while (line_no != ZILLIQA_DS_LINE &&
+           getline(versionFile, zilliqaUpgradeDSStr)) {
       ++line_no;
     }
 
-    zilliqaUpgradeDS = m_zilliqaPackageFileName.empty() ? 0 : stoull(line);
-
-    while (line_no != SCILLA_DS_LINE && getline(versionFile, line)) {
+    while (line_no != SCILLA_DS_LINE &&
+           getline(versionFile, scillaUpgradeDSStr)) {
       ++line_no;
     }
 
-    scillaUpgradeDS = m_scillaPackageFileName.empty() ? 0 : stoull(line);
-
     while (line_no != SCILLA_MAJOR_VERSION_LINE && getline(versionFile, line)) {
       ++line_no;
     }
@@ -494,45 +516,52 @@ bool UpgradeManager::DownloadSW() {
     return false;
   }
 
-  /// Verify SHA-256 checksum of .deb file
-  if (!m_zilliqaPackageFileName.empty()) {
-    fstream debFile(m_zilliqaPackageFileName, ios::in);
-    SHA2<HASH_TYPE::HASH_VARIANT_256> sha2;
-    bytes vec((istreambuf_iterator<char>(debFile)),
-              (istreambuf_iterator<char>()));
-    sha2.Update(vec, 0, vec.size());
-    bytes output = sha2.Finalize();
-    string zilliqaDownloadSha;
-    DataConversion::Uint8VecToHexStr(output, zilliqaDownloadSha);
-
-    if (zilliqaSha != zilliqaDownloadSha) {
-      LOG_GENERAL(WARNING,
-                  "Zilliqa SHA-256 checksum of .deb file mismatch. Expected: "
-                      << zilliqaSha << " Actual: " << zilliqaDownloadSha);
-      return false;
-    }
+  /// The SHA-256 checksums in the version file are what every source of a
+  /// package, release, delta or peer, is verified against
+  bytes zilliqaShaBytes, scillaShaBytes;
+  DataConversion::HexStrToUint8Vec(zilliqaSha, zilliqaShaBytes);
+  DataConversion::HexStrToUint8Vec(scillaSha, scillaShaBytes);
+
+  m_zilliqaPackageFileName = FetchPackage(ZILLIQA_PACKAGE_FILE_EXTENSION,
+                                          zilliqaShaBytes, peers, listenPort);
 
-    DataConversion::HexStrToUint8Vec(zilliqaSha, m_latestZilliqaSHA);
+  if (m_zilliqaPackageFileName.empty()) {
+    LOG_GENERAL(INFO, "Cannot download Zilliqa package (.deb) file!");
   }
 
-  if (!m_scillaPackageFileName.empty()) {
-    fstream debFile(m_scillaPackageFileName, ios::in);
-    SHA2<HASH_TYPE::HASH_VARIANT_256> sha2;
-    bytes vec((istreambuf_iterator<char>(debFile)),
-              (istreambuf_iterator<char>()));
-    sha2.Update(vec, 0, vec.size());
-    bytes output = sha2.Finalize();
-    string scillaDownloadSha;
-    DataConversion::Uint8VecToHexStr(output, scillaDownloadSha);
+  m_scillaPackageFileName = FetchPackage(SCILLA_PACKAGE_FILE_EXTENSION,
+                                         scillaShaBytes, peers, listenPort);
 
-    if (scillaSha != scillaDownloadSha) {
-      LOG_GENERAL(WARNING,
-                  "Scilla SHA-256 checksum of .deb file mismatch. Expected: "
-                      << scillaSha << " Actual: " << scillaDownloadSha);
-      return false;
+  if (m_scillaPackageFileName.empty()) {
+    LOG_GENERAL(INFO, "Cannot download Scilla package (.deb) file!");
+  }
+
+  if (m_zilliqaPackageFileName.empty() && m_scillaPackageFileName.empty()) {
+    LOG_GENERAL(WARNING, "No package downloaded, nothing will be upgraded!");
+    m_latestSWInfo = make_shared<SWInfo>();
+    DataConversion::HexStrToUint8Vec("0", m_latestZilliqaSHA);
+    DataConversion::HexStrToUint8Vec("0", m_latestScillaSHA);
+    return false;
+  }
+
+  LOG_GENERAL(INFO, "Package (.deb) file has been downloaded successfully.");
+
+  uint64_t zilliqaUpgradeDS = 0, scillaUpgradeDS = 0;
+
+  try {
+    if (!m_zilliqaPackageFileName.empty()) {
+      zilliqaUpgradeDS = stoull(zilliqaUpgradeDSStr);
+      m_latestZilliqaSHA = zilliqaShaBytes;
     }
 
-    DataConversion::HexStrToUint8Vec(scillaSha, m_latestScillaSHA);
+    if (!m_scillaPackageFileName.empty()) {
+      scillaUpgradeDS = stoull(scillaUpgradeDSStr);
+      m_latestScillaSHA = scillaShaBytes;
+    }
+  } catch (const std::exception& e) {
+    LOG_GENERAL(WARNING, "Cannot parse " << VERSION_FILE_NAME << ": " << ' '
+                                         << e.what());
+    return false;
   }
 
   m_latestSWInfo = make_shared<SWInfo>(
@@ -541,6 +570,204 @@ bool UpgradeManager::DownloadSW() {
   return true;
 }
 
+string UpgradeManager::FetchPackage(const char* fileTail, const bytes& sha,
+                                    const vector<Peer>& peers,
+                                    uint32_t listenPort) {
+  const string fileName = string(DOWNLOAD_FOLDER) + "/" + fileTail;
+
+  if (!peers.empty() &&
+      FetchPackageFromPeers(sha, fileName, peers, listenPort)) {
+    LOG_GENERAL(INFO, "Package " << fileTail << " fetched from peers");
+  } else if (FetchPackageDelta(fileTail, sha, fileName)) {
+    LOG_GENERAL(INFO, "Package " << fileTail << " rebuilt from delta");
+  } else {
+    const string downloaded = DownloadFile(fileTail);
+    if (downloaded.empty()) {
+      return "";
+    }
+
+    bytes package;
+    if (!ReadFile(downloaded, package) || Sha256(package) != sha) {
+      LOG_GENERAL(WARNING, "SHA-256 checksum of " << downloaded
+                                                  << " mismatch");
+      return "";
+    }
+
+    if (downloaded != fileName) {
+      boost::filesystem::rename(downloaded, fileName);
+    }
+  }
+
+  lock_guard<mutex> g(m_peerMutex);
+  m_servedPackages[sha] = fileName;
+  return fileName;
+}
+
+bool UpgradeManager::FetchPackageDelta(const char* fileTail, const bytes& sha,
+                                       const string& fileName) {
+  bytes base;
+  if (!ReadFile(InstalledPackageName(fileTail), base)) {
+    return false;
+  }
+
+  const string deltaName =
+      DownloadFile((string(fileTail) + DELTA_FILE_EXTENSION).c_str());
+  bytes delta, package;
+  if (deltaName.empty() || !ReadFile(deltaName, delta)) {
+    LOG_GENERAL(INFO, "No delta for " << fileTail << " in the release");
+    return false;
+  }
+
+  if (!BinaryDelta::Apply(base, delta, package) || Sha256(package) != sha) {
+    LOG_GENERAL(WARNING, "Delta for " << fileTail
+                                      << " does not give the released package");
+    return false;
+  }
+
+  return WriteFile(fileName, package);
+}
+
+bool UpgradeManager::FetchPackageFromPeers(const bytes& sha,
+                                           const string& fileName,
+                                           const vector<Peer>& peers,
+                                           uint32_t listenPort) {
+  {
+    lock_guard<mutex> g(m_peerMutex);
+    m_peerFetchSha = sha;
+    m_peerFetchSize = 0;
+    m_peerFetchChunks.clear();
+  }
+
+  LOG_GENERAL(INFO, "Fetching " << fileName << " from " << peers.size()
+                                 << " peers");
+
+  const auto deadline = chrono::steady_clock::now() +
+                        chrono::seconds(UPGRADE_PEER_FETCH_TIMEOUT_IN_SECONDS);
+  bytes package;
+  for (unsigned int round = 0;; round++) {
+    vector<uint32_t> missing;
+    {
+      unique_lock<mutex> lock(m_peerMutex);
+      const uint32_t total = ChunkCount(m_peerFetchSize);
+      for (uint32_t i = 0; i < max(total, 1U); i++) {
+        if (m_peerFetchChunks.find(i) == m_peerFetchChunks.end()) {
+          missing.emplace_back(i);
+        }
+      }
+
+      if (m_peerFetchSize > 0 && missing.empty()) {
+        for (auto& chunk : m_peerFetchChunks) {
+          package.insert(package.end(), chunk.second.begin(),
+                         chunk.second.end());
+        }
+        m_peerFetchSha.clear();
+        m_peerFetchChunks.clear();
+        break;
+      }
+    }
+
+    if (chrono::steady_clock::now() >= deadline) {
+      LOG_GENERAL(INFO, "Peers did not send the package in time");
+      lock_guard<mutex> g(m_peerMutex);
+      m_peerFetchSha.clear();
+      m_peerFetchChunks.clear();
+      return false;
+    }
+
+    // Spread the requests over the peers, a different one every round, and
+    // until the size is known only ask for the first chunk
+    if (missing.size() > PEER_CHUNKS_PER_ROUND) {
+      missing.resize(PEER_CHUNKS_PER_ROUND);
+    }
+    for (unsigned int i = 0; i < missing.size(); i++) {
+      bytes request = {MessageType::NODE,
+                       NodeInstructionType::GETUPGRADECHUNK};
+      if (!Messenger::SetNodeGetUpgradeChunk(request, MessageOffset::BODY, sha,
+                                             missing[i], listenPort)) {
+        LOG_GENERAL(WARNING, "Messenger::SetNodeGetUpgradeChunk failed.");
+        return false;
+      }
+      P2PComm::GetInstance().SendMessage(
+          peers[(i + round) % peers.size()], request);
+    }
+
+    unique_lock<mutex> lock(m_peerMutex);
+    const size_t received = m_peerFetchChunks.size();
+    m_peerCv.wait_for(lock, chrono::seconds(1), [this, received, &missing] {
+      return m_peerFetchChunks.size() >= received + missing.size();
+    });
+  }
+
+  if (Sha256(package) != sha) {
+    LOG_GENERAL(WARNING, "Package from peers fails its SHA-256 checksum");
+    return false;
+  }
+
+  return WriteFile(fileName, package);
+}
+
+bool UpgradeManager::GetPackageChunk(const bytes& sha, uint32_t index,
+                                     uint64_t& size, bytes& chunk) {
+  string fileName;
+  {
+    lock_guard<mutex> g(m_peerMutex);
+    auto it = m_servedPackages.find(sha);
+    if (it == m_servedPackages.end()) {
+      return false;
+    }
+    fileName = it->second;
+  }
+
+  ifstream file(fileName, ios::binary | ios::ate);
+  if (!file) {
+    return false;
+  }
+  size = file.tellg();
+  if (index >= ChunkCount(size)) {
+    return false;
+  }
+
+  const uint64_t offset = static_cast<uint64_t>(index) * PEER_CHUNK_SIZE;
+  chunk.resize(min<uint64_t>(PEER_CHUNK_SIZE, size - offset));
+  file.seekg(offset);
+  return static_cast<bool>(
+      file.read(reinterpret_cast<char*>(chunk.data()), chunk.size()));
+}
+
+void UpgradeManager::OnPackageChunk(const bytes& sha, uint64_t size,
+                                    uint32_t index, const bytes& chunk) {
+  lock_guard<mutex> g(m_peerMutex);
+  if (m_peerFetchSha.empty() || sha != m_peerFetchSha || size == 0 ||
+      size > MAX_PACKAGE_SIZE) {
+    return;
+  }
+
+  // The first answer fixes the size, the checksum catches a wrong one
+  if (m_peerFetchSize == 0) {
+    m_peerFetchSize = size;
+  }
+  const uint64_t offset = static_cast<uint64_t>(index) * PEER_CHUNK_SIZE;
+  if (size != m_peerFetchSize || index >= ChunkCount(size) ||
+      chunk.size() != min<uint64_t>(PEER_CHUNK_SIZE, size - offset)) {
+    return;
+  }
+
+  m_peerFetchChunks.emplace(index, chunk);
+  m_peerCv.notify_all();
+}
+
+void UpgradeManager::KeepInstalledPackage(const string& fileName,
+                                          const char* fileTail) {
+  try {
+    boost::filesystem::copy_file(
+        fileName, InstalledPackageName(fileTail),
+        boost::filesystem::copy_option::overwrite_if_exists);
+  } catch (const boost::filesystem::filesystem_error& e) {
+    LOG_GENERAL(WARNING, "Cannot keep installed package " << fileName << ": "
+                                                          << e.what());
+  }
+}
+
 bool UpgradeManager::ReplaceNode(Mediator& mediator) {
   LOG_MARKER();
 
@@ -602,6 +829,9 @@ bool UpgradeManager::ReplaceNode(Mediator& mediator) {
           boost::filesystem::copy_option::overwrite_if_exists);
     }
 
+    KeepInstalledPackage(m_zilliqaPackageFileName,
+                         ZILLIQA_PACKAGE_FILE_EXTENSION);
+
     /// TBD: The call of "dpkg" should be removed.
     /// (https://github.com/Zilliqa/Issues/issues/185)
     if (execl(DPKG_BINARY_PATH, "dpkg", "-i", m_zilliqaPackageFileName.data(),
@@ -719,6 +949,8 @@ bool UpgradeManager::InstallScilla() {
           } else {
             if (WIFEXITED(status)) {
               LOG_GENERAL(INFO, "Scilla has been installed successfully.");
+              KeepInstalledPackage(m_scillaPackageFileName,
+                                   SCILLA_PACKAGE_FILE_EXTENSION);
             } else {
               LOG_GENERAL(WARNING, "Failed to install scilla with status "
                                        << WEXITSTATUS(status));
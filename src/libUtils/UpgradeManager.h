@@ -19,9 +19,12 @@
 #define __UPGRADEMANAGER_H__
 
 #include <curl/curl.h>
+#include <condition_variable>
 #include <cstring>
+#include <map>
 #include <memory>
 #include <string>
+#include <vector>
 #include "libMediator/Mediator.h"
 #include "libUtils/SWInfo.h"
 
@@ -35,6 +38,15 @@ class UpgradeManager {
   std::string m_zilliqaPackageFileName, m_scillaPackageFileName;
   std::mutex m_downloadMutex;
 
+  /// Verified packages that shard peers may fetch from us, by SHA-256
+  std::map<bytes, std::string> m_servedPackages;
+  /// Chunks of the package being fetched from peers
+  bytes m_peerFetchSha;
+  uint64_t m_peerFetchSize;
+  std::map<uint32_t, bytes> m_peerFetchChunks;
+  std::mutex m_peerMutex;
+  std::condition_variable m_peerCv;
+
   UpgradeManager();
   ~UpgradeManager();
 
@@ -44,6 +56,21 @@ class UpgradeManager {
 
   static bool UnconfigureScillaPackage();
 
+  /// Gets the package ending with fileTail whose SHA-256 is sha: from peers
+  /// if any are given, then as a delta against the installed package, then
+  /// in full. Returns the file name, or an empty string on failure
+  std::string FetchPackage(const char* fileTail, const bytes& sha,
+                           const std::vector<Peer>& peers,
+                           uint32_t listenPort);
+  bool FetchPackageFromPeers(const bytes& sha, const std::string& fileName,
+                             const std::vector<Peer>& peers,
+                             uint32_t listenPort);
+  bool FetchPackageDelta(const char* fileTail, const bytes& sha,
+                         const std::string& fileName);
+  /// Keeps the package as the base for the delta of the next release
+  static void KeepInstalledPackage(const std::string& fileName,
+                                   const char* fileTail);
+
  public:
   /// Returns the singleton UpgradeManager instance.
   static UpgradeManager& GetInstance();
@@ -51,8 +78,11 @@ class UpgradeManager {
   /// Check website, verify if sig is valid && SHA-256 is new
   bool HasNewSW();
 
-  /// Download SW from website, then update current SHA-256 value & curSWInfo
-  bool DownloadSW();
+  /// Download SW from website, then update current SHA-256 value & curSWInfo.
+  /// With peers, the packages are first asked from them, and requests from
+  /// them are answered with the listenPort given.
+  bool DownloadSW(const std::vector<Peer>& peers = {},
+                  uint32_t listenPort = 0);
 
   /// Store all the useful states into metadata, create a new node with loading
   /// the metadata, and kill current node
@@ -68,6 +98,14 @@ class UpgradeManager {
                            const char* releaseUrl = nullptr);
 
   bool LoadInitialDS(std::vector<PubKey>& initialDSCommittee);
+
+  /// Reads chunk index of a verified package, for a peer that asked for it
+  bool GetPackageChunk(const bytes& sha, uint32_t index, uint64_t& size,
+                       bytes& chunk);
+
+  /// Takes a chunk a peer sent for the package being fetched
+  void OnPackageChunk(const bytes& sha, uint64_t size, uint32_t index,
+                      const bytes& chunk);
 };
 
 #endif  // __UPGRADEMANAGER_H__
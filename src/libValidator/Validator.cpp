@@ -15,19 +15,39 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <vector>
 
 #include "Validator.h"
 #include "libData/AccountData/Account.h"
+#include "libData/AccountData/AccountStore.h"
 #include "libMediator/Mediator.h"
 #include "libUtils/BitVector.h"
+#include "libUtils/TimeUtils.h"
 
 using namespace std;
 using namespace boost::multiprecision;
 
 using ShardingHash = dev::h256;
 
-Validator::Validator(Mediator& mediator) : m_mediator(mediator) {}
+Validator::Validator(Mediator& mediator)
+    : m_verifyThreads(TXN_VERIFY_THREADS),
+      m_verifyBatches(0),
+      m_verifiedTxns(0),
+      m_rejectedTxns(0),
+      m_verifyMicroseconds(0),
+      m_mediator(mediator) {
+  if (m_verifyThreads > 0) {
+    m_verifyPool = std::make_unique<ThreadPool>(
+        m_verifyThreads, "TxnVerifyPool",
+        ThreadPlacement::Resolve(VERIFY_PLACEMENT, "TxnVerifyPool"));
+  }
+}
 
 Validator::~Validator() {}
 
@@ -39,6 +59,87 @@ bool Validator::VerifyTransaction(const Transaction& tran) const {
                                        tran.GetSenderPubKey());
 }
 
+bool Validator::VerifyTransactions(const vector<Transaction>& txns,
+                                   vector<bool>& results) const {
+  const auto startTime = r_timer_start();
+
+  vector<bytes> txnData(txns.size());
+  vector<Schnorr::VerifyItem> items;
+  items.reserve(txns.size());
+
+  for (unsigned int i = 0; i < txns.size(); i++) {
+    txns.at(i).SerializeCoreFields(txnData.at(i), 0);
+    items.push_back({&txnData.at(i), 0, (unsigned int)txnData.at(i).size(),
+                     &txns.at(i).GetSignature(),
+                     &txns.at(i).GetSenderPubKey()});
+  }
+
+  // Contiguous ranges, one per job; the first one is checked on this thread
+  const size_t numJobs = min<size_t>(
+      m_verifyThreads + 1,
+      (items.size() + MIN_TXNS_PER_VERIFY_JOB - 1) / MIN_TXNS_PER_VERIFY_JOB);
+  const size_t jobSize =
+      (numJobs > 0) ? (items.size() + numJobs - 1) / numJobs : 0;
+
+  vector<unsigned char> valid(items.size(), 0);
+  mutex mutexDone;
+  condition_variable cvDone;
+  size_t jobsLeft = 0;
+
+  vector<ThreadPool::Job> jobs;
+  for (size_t begin = jobSize; begin < items.size(); begin += jobSize) {
+    const size_t end = min(begin + jobSize, items.size());
+    jobs.emplace_back([&items, &valid, &mutexDone, &cvDone, &jobsLeft, begin,
+                       end]() {
+      Schnorr::GetInstance().VerifyRange(items, begin, end, valid);
+      lock_guard<mutex> g(mutexDone);
+      if (--jobsLeft == 0) {
+        cvDone.notify_one();
+      }
+    });
+  }
+
+  if (!jobs.empty()) {
+    jobsLeft = jobs.size();
+    m_verifyPool->AddJobs(jobs.begin(), jobs.end());
+  }
+
+  if (jobSize > 0) {
+    Schnorr::GetInstance().VerifyRange(items, 0, min(jobSize, items.size()),
+                                       valid);
+  }
+
+  {
+    unique_lock<mutex> lock(mutexDone);
+    cvDone.wait(lock, [&jobsLeft] { return jobsLeft == 0; });
+  }
+
+  results.assign(valid.begin(), valid.end());
+  const uint64_t numValid = count(valid.begin(), valid.end(), 1);
+  const auto elapsed = static_cast<uint64_t>(r_timer_end(startTime));
+
+  m_verifyBatches++;
+  m_verifiedTxns += numValid;
+  m_rejectedTxns += items.size() - numValid;
+  m_verifyMicroseconds += elapsed;
+
+  if (!items.empty()) {
+    const uint64_t txnsPerSec =
+        items.size() * 1000000 / max<uint64_t>(elapsed, 1);
+    LOG_GENERAL(INFO, "Verified " << items.size() << " txn signatures ("
+                                  << items.size() - numValid << " bad) in "
+                                  << elapsed << " us, " << txnsPerSec
+                                  << " txns/s");
+  }
+
+  return numValid == items.size();
+}
+
+TxnVerifyStats Validator::GetTxnVerifyStats() const {
+  return {m_verifyBatches, m_verifiedTxns, m_rejectedTxns,
+          m_verifyMicroseconds};
+}
+
 bool Validator::CheckCreatedTransaction(const Transaction& tx,
                                         TransactionReceipt& receipt) const {
   if (LOOKUP_NODE_MODE) {
@@ -57,8 +158,7 @@ bool Validator::CheckCreatedTransaction(const Transaction& tx,
   }
 
   // Check if from account is sharded here
-  const PubKey& senderPubKey = tx.GetSenderPubKey();
-  Address fromAddr = Account::GetAddressFromPublicKey(senderPubKey);
+  const Address& fromAddr = tx.GetSenderAddr();
 
   if (fromAddr == Address()) {
     LOG_GENERAL(WARNING, "Invalid address for issuing transactions");
@@ -90,7 +190,71 @@ bool Validator::CheckCreatedTransaction(const Transaction& tx,
       m_mediator.m_ds->m_mode != DirectoryService::Mode::IDLE, tx, receipt);
 }
 
-bool Validator::CheckCreatedTransactionFromLookup(const Transaction& tx) {
+void Validator::CheckCreatedPayments(const vector<Transaction>& txns,
+                                     vector<PaymentResult>& results) const {
+  // The same checks as CheckCreatedTransaction. They only read the
+  // committed state, so they do not depend on the order of the batch.
+  vector<bool> eligible(txns.size(), false);
+  for (unsigned int i = 0; i < txns.size(); i++) {
+    const Transaction& tx = txns.at(i);
+
+    if (DataConversion::UnpackA(tx.GetVersion()) != CHAIN_ID) {
+      LOG_GENERAL(WARNING, "CHAIN_ID incorrect");
+      continue;
+    }
+
+    const Address fromAddr = tx.GetSenderAddr();
+
+    if (fromAddr == Address()) {
+      LOG_GENERAL(WARNING, "Invalid address for issuing transactions");
+      continue;
+    }
+
+    if (!AccountStore::GetInstance().IsAccountExist(fromAddr)) {
+      LOG_GENERAL(WARNING, "fromAddr not found: " << fromAddr
+                                                  << ". Transaction rejected: "
+                                                  << tx.GetTranID());
+      continue;
+    }
+
+    if (AccountStore::GetInstance().GetBalance(fromAddr) < tx.GetAmount()) {
+      LOG_EPOCH(WARNING, m_mediator.m_currentEpochNum,
+                "Insufficient funds in source account!"
+                    << " From Account  = 0x" << fromAddr << " Balance = "
+                    << AccountStore::GetInstance().GetBalance(fromAddr)
+                    << " Debit Amount = " << tx.GetAmount());
+      continue;
+    }
+
+    eligible.at(i) = true;
+  }
+
+  results.clear();
+  results.resize(txns.size());
+  for (auto& result : results) {
+    result.m_receipt.SetEpochNum(m_mediator.m_currentEpochNum);
+  }
+
+  AccountStore::GetInstance().ExecutePaymentsTemp(
+      txns, eligible, results, m_verifyPool.get(), m_verifyThreads);
+}
+
+void Validator::PrefetchAccounts(const vector<Transaction>& txns) const {
+  vector<Address> addresses;
+  addresses.reserve(txns.size() * 2);
+  for (const auto& txn : txns) {
+    // The recipient of a contract creation is not in the state yet and is
+    // just not found
+    addresses.emplace_back(txn.GetSenderAddr());
+    addresses.emplace_back(txn.GetToAddr());
+  }
+
+  AccountStore::GetInstance().PrefetchAccounts(
+      addresses, m_verifyPool.get(), m_verifyThreads);
+}
+
+bool Validator::CheckCreatedTransactionFromLookup(const Transaction& tx,
+                                                  bool verifySignature) {
   if (LOOKUP_NODE_MODE) {
     LOG_GENERAL(WARNING,
                 "Validator::CheckCreatedTransactionFromLookup not expected "
@@ -106,8 +270,7 @@ bool Validator::CheckCreatedTransactionFromLookup(const Transaction& tx) {
   }
 
   // Check if from account is sharded here
-  const PubKey& senderPubKey = tx.GetSenderPubKey();
-  Address fromAddr = Account::GetAddressFromPublicKey(senderPubKey);
+  const Address& fromAddr = tx.GetSenderAddr();
   unsigned int shardId = m_mediator.m_node->GetShardId();
   unsigned int numShards = m_mediator.m_node->getNumShards();
 
@@ -145,17 +308,17 @@ bool Validator::CheckCreatedTransactionFromLookup(const Transaction& tx) {
   }
 
   if (tx.GetGasPrice() <
-      m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetGasPrice()) {
+      m_mediator.m_dsBlockChain.GetLastBlockPtr()->GetHeader().GetGasPrice()) {
     LOG_EPOCH(WARNING, m_mediator.m_currentEpochNum,
               "GasPrice " << tx.GetGasPrice()
                           << " lower than minimum allowable "
-                          << m_mediator.m_dsBlockChain.GetLastBlock()
-                                 .GetHeader()
+                          << m_mediator.m_dsBlockChain.GetLastBlockPtr()
+                                 ->GetHeader()
                                  .GetGasPrice());
     return false;
   }
 
-  if (!VerifyTransaction(tx)) {
+  if (verifySignature && !VerifyTransaction(tx)) {
     LOG_EPOCH(WARNING, m_mediator.m_currentEpochNum,
               "Signature incorrect: " << fromAddr << ". Transaction rejected: "
                                       << tx.GetTranID());
@@ -239,137 +402,244 @@ bool Validator::CheckBlockCosignature(const DirectoryBlock& block,
   return true;
 }
 
+void Validator::RunOnVerifyPool(vector<function<bool()>>& checks,
+                                vector<unsigned char>& results) const {
+  results.assign(checks.size(), 0);
+  atomic<size_t> next{0};
+  auto work = [&checks, &results, &next]() {
+    for (size_t i = next++; i < checks.size(); i = next++) {
+      results.at(i) = checks.at(i)() ? 1 : 0;
+    }
+  };
+
+  mutex mutexDone;
+  condition_variable cvDone;
+  size_t jobsLeft = 0;
+
+  vector<ThreadPool::Job> jobs;
+  const size_t numJobs =
+      m_verifyPool ? min<size_t>(m_verifyThreads, checks.size() - 1) : 0;
+  for (size_t i = 0; i < numJobs; i++) {
+    jobs.emplace_back([&work, &mutexDone, &cvDone, &jobsLeft]() {
+      work();
+      lock_guard<mutex> g(mutexDone);
+      if (--jobsLeft == 0) {
+        cvDone.notify_one();
+      }
+    });
+  }
+
+  if (!jobs.empty()) {
+    jobsLeft = jobs.size();
+    m_verifyPool->AddJobs(jobs.begin(), jobs.end());
+  }
+
+  work();
+
+  unique_lock<mutex> lock(mutexDone);
+  cvDone.wait(lock, [&jobsLeft] { return jobsLeft == 0; });
+}
+
 bool Validator::CheckDirBlocks(
     const vector<boost::variant<DSBlock, VCBlock,
                                 FallbackBlockWShardingStructure>>& dirBlocks,
     const deque<pair<PubKey, Peer>>& initDsComm, const uint64_t& index_num,
-    deque<pair<PubKey, Peer>>& newDSComm) {
+    deque<pair<PubKey, Peer>>& newDSComm, size_t numCosigChecked) {
   deque<pair<PubKey, Peer>> mutable_ds_comm = initDsComm;
 
   bool ret = true;
 
   uint64_t prevdsblocknum =
-      m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetBlockNum();
+      m_mediator.m_dsBlockChain.GetLastBlockPtr()->GetHeader().GetBlockNum();
   uint64_t totalIndex = index_num;
   ShardingHash prevShardingHash =
-      m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetShardingHash();
-
-  for (const auto& dirBlock : dirBlocks) {
-    if (typeid(DSBlock) == dirBlock.type()) {
-      const auto& dsblock = get<DSBlock>(dirBlock);
-      if (dsblock.GetHeader().GetBlockNum() != prevdsblocknum + 1) {
-        LOG_GENERAL(WARNING, "DSblocks not in sequence "
-                                 << dsblock.GetHeader().GetBlockNum() << " "
-                                 << prevdsblocknum);
-        ret = false;
-        break;
+      m_mediator.m_dsBlockChain.GetLastBlockPtr()
+          ->GetHeader()
+          .GetShardingHash();
+
+  // Each batch is walked three times. The committee is evolved block by
+  // block first, keeping the one each block was signed by. The
+  // co-signatures are then checked concurrently, and the blocks that passed
+  // are added to the chains in order.
+  for (size_t begin = 0; ret && (begin < dirBlocks.size());
+       begin += DIR_BLOCKS_PER_COSIG_BATCH) {
+    const size_t end =
+        min<size_t>(begin + DIR_BLOCKS_PER_COSIG_BATCH, dirBlocks.size());
+
+    vector<shared_ptr<const DequeOfNode>> signers;
+    vector<uint64_t> dsBlockNums;
+    vector<function<bool()>> checks;
+    size_t checked = begin;
+
+    for (; checked < end; checked++) {
+      const auto& dirBlock = dirBlocks.at(checked);
+      // Blocks before numCosigChecked are only replayed
+      const bool trusted = checked < numCosigChecked;
+      shared_ptr<const DequeOfNode> signer;
+      if (!trusted) {
+        signer = make_shared<const DequeOfNode>(mutable_ds_comm);
       }
-
-      if (!CheckBlockCosignature(dsblock, mutable_ds_comm)) {
-        LOG_GENERAL(WARNING, "Co-sig verification of ds block "
-                                 << prevdsblocknum + 1 << " failed");
-        ret = false;
-        break;
-      }
-      prevdsblocknum++;
-      prevShardingHash = dsblock.GetHeader().GetShardingHash();
-      m_mediator.m_blocklinkchain.AddBlockLink(
-          totalIndex, prevdsblocknum, BlockType::DS, dsblock.GetBlockHash());
-      m_mediator.m_dsBlockChain.AddBlock(dsblock);
-      bytes serializedDSBlock;
-      dsblock.Serialize(serializedDSBlock, 0);
-      BlockStorage::GetBlockStorage().PutDSBlock(
-          dsblock.GetHeader().GetBlockNum(), serializedDSBlock);
-      m_mediator.m_node->UpdateDSCommiteeComposition(mutable_ds_comm, dsblock);
-      totalIndex++;
-
-    } else if (typeid(VCBlock) == dirBlock.type()) {
-      const auto& vcblock = get<VCBlock>(dirBlock);
-
-      if (vcblock.GetHeader().GetVieWChangeDSEpochNo() != prevdsblocknum + 1) {
-        LOG_GENERAL(WARNING,
-                    "VC block ds epoch number does not match the number being "
-                    "processed "
-                        << prevdsblocknum << " "
-                        << vcblock.GetHeader().GetVieWChangeDSEpochNo());
-        ret = false;
-        break;
-      }
-      if (!CheckBlockCosignature(vcblock, mutable_ds_comm)) {
-        LOG_GENERAL(WARNING, "Co-sig verification of vc block in "
-                                 << prevdsblocknum << " failed"
-                                 << totalIndex + 1);
-        ret = false;
-        break;
+      function<bool()> check;
+
+      if (typeid(DSBlock) == dirBlock.type()) {
+        const auto& dsblock = get<DSBlock>(dirBlock);
+        if (dsblock.GetHeader().GetBlockNum() != prevdsblocknum + 1) {
+          LOG_GENERAL(WARNING, "DSblocks not in sequence "
+                                   << dsblock.GetHeader().GetBlockNum() << " "
+                                   << prevdsblocknum);
+          break;
+        }
+
+        check = [this, &dsblock, signer]() {
+          return CheckBlockCosignature(dsblock, *signer);
+        };
+        prevdsblocknum++;
+        prevShardingHash = dsblock.GetHeader().GetShardingHash();
+        m_mediator.m_node->UpdateDSCommiteeComposition(mutable_ds_comm,
+                                                       dsblock);
+      } else if (typeid(VCBlock) == dirBlock.type()) {
+        const auto& vcblock = get<VCBlock>(dirBlock);
+
+        if (vcblock.GetHeader().GetVieWChangeDSEpochNo() !=
+            prevdsblocknum + 1) {
+          LOG_GENERAL(
+              WARNING,
+              "VC block ds epoch number does not match the number being "
+              "processed "
+                  << prevdsblocknum << " "
+                  << vcblock.GetHeader().GetVieWChangeDSEpochNo());
+          break;
+        }
+
+        check = [this, &vcblock, signer]() {
+          return CheckBlockCosignature(vcblock, *signer);
+        };
+        m_mediator.m_node->UpdateRetrieveDSCommiteeCompositionAfterVC(
+            vcblock, mutable_ds_comm);
+      } else if (typeid(FallbackBlockWShardingStructure) == dirBlock.type()) {
+        const auto& fallbackwshardingstructure =
+            get<FallbackBlockWShardingStructure>(dirBlock);
+
+        const auto& fallbackblock = fallbackwshardingstructure.m_fallbackblock;
+        const DequeOfShard& shards = fallbackwshardingstructure.m_shards;
+
+        if (fallbackblock.GetHeader().GetFallbackDSEpochNo() !=
+            prevdsblocknum + 1) {
+          LOG_GENERAL(
+              WARNING,
+              "Fallback block ds epoch number does not match the number "
+              "being processed "
+                  << prevdsblocknum << " "
+                  << fallbackblock.GetHeader().GetFallbackDSEpochNo());
+          break;
+        }
+
+        ShardingHash shardinghash;
+        if (!Messenger::GetShardingStructureHash(SHARDINGSTRUCTURE_VERSION,
+                                                 shards, shardinghash)) {
+          LOG_GENERAL(WARNING, "GetShardingStructureHash failed");
+          break;
+        }
+
+        if (shardinghash != prevShardingHash) {
+          LOG_GENERAL(WARNING, "ShardingHash does not match ");
+          break;
+        }
+
+        uint32_t shard_id = fallbackblock.GetHeader().GetShardId();
+        if (shard_id >= shards.size()) {
+          LOG_GENERAL(WARNING, "Fallback block shard " << shard_id
+                                                       << " does not exist");
+          break;
+        }
+
+        check = [this, &fallbackblock, &shards, shard_id]() {
+          return CheckBlockCosignature(fallbackblock, shards.at(shard_id));
+        };
+        const PubKey& leaderPubKey =
+            fallbackblock.GetHeader().GetLeaderPubKey();
+        const Peer& leaderNetworkInfo =
+            fallbackblock.GetHeader().GetLeaderNetworkInfo();
+        m_mediator.m_node->UpdateDSCommitteeAfterFallback(
+            shard_id, leaderPubKey, leaderNetworkInfo, mutable_ds_comm,
+            shards);
+      } else {
+        LOG_GENERAL(WARNING, "dirBlock type unexpected ");
       }
 
-      m_mediator.m_node->UpdateRetrieveDSCommiteeCompositionAfterVC(
-          vcblock, mutable_ds_comm);
-      m_mediator.m_blocklinkchain.AddBlockLink(totalIndex, prevdsblocknum + 1,
-                                               BlockType::VC,
-                                               vcblock.GetBlockHash());
-      bytes vcblockserialized;
-      vcblock.Serialize(vcblockserialized, 0);
-      BlockStorage::GetBlockStorage().PutVCBlock(vcblock.GetBlockHash(),
-                                                 vcblockserialized);
-      totalIndex++;
-    } else if (typeid(FallbackBlockWShardingStructure) == dirBlock.type()) {
-      const auto& fallbackwshardingstructure =
-          get<FallbackBlockWShardingStructure>(dirBlock);
-
-      const auto& fallbackblock = fallbackwshardingstructure.m_fallbackblock;
-      const DequeOfShard& shards = fallbackwshardingstructure.m_shards;
-
-      if (fallbackblock.GetHeader().GetFallbackDSEpochNo() !=
-          prevdsblocknum + 1) {
-        LOG_GENERAL(WARNING,
-                    "Fallback block ds epoch number does not match the number "
-                    "being processed "
-                        << prevdsblocknum << " "
-                        << fallbackblock.GetHeader().GetFallbackDSEpochNo());
-        ret = false;
-        break;
+      if (trusted || !check) {
+        check = []() { return true; };
       }
+      checks.emplace_back(move(check));
+      signers.emplace_back(signer);
+      dsBlockNums.emplace_back(prevdsblocknum);
+    }
 
-      ShardingHash shardinghash;
-      if (!Messenger::GetShardingStructureHash(SHARDINGSTRUCTURE_VERSION,
-                                               shards, shardinghash)) {
-        LOG_GENERAL(WARNING, "GetShardingStructureHash failed");
-        ret = false;
-        break;
-      }
+    if (checked < end) {
+      ret = false;
+    }
+
+    vector<unsigned char> cosigValid;
+    if (!checks.empty()) {
+      RunOnVerifyPool(checks, cosigValid);
+    }
 
-      if (shardinghash != prevShardingHash) {
-        LOG_GENERAL(WARNING, "ShardingHash does not match ");
+    for (size_t i = 0; i < checks.size(); i++) {
+      const auto& dirBlock = dirBlocks.at(begin + i);
+      if (!cosigValid.at(i)) {
+        if (typeid(DSBlock) == dirBlock.type()) {
+          LOG_GENERAL(WARNING, "Co-sig verification of ds block "
+                                   << dsBlockNums.at(i) << " failed");
+        } else if (typeid(VCBlock) == dirBlock.type()) {
+          LOG_GENERAL(WARNING, "Co-sig verification of vc block in "
+                                   << dsBlockNums.at(i) << " failed"
+                                   << totalIndex + 1);
+        } else {
+          LOG_GENERAL(WARNING, "Co-sig verification of fallbackblock in "
+                                   << dsBlockNums.at(i) << " failed"
+                                   << totalIndex + 1);
+        }
+        mutable_ds_comm = *signers.at(i);
         ret = false;
         break;
       }
 
-      uint32_t shard_id = fallbackblock.GetHeader().GetShardId();
-
-      if (!CheckBlockCosignature(fallbackblock, shards.at(shard_id))) {
-        LOG_GENERAL(WARNING, "Co-sig verification of fallbackblock in "
-                                 << prevdsblocknum << " failed"
-                                 << totalIndex + 1);
-        ret = false;
-        break;
+      if (typeid(DSBlock) == dirBlock.type()) {
+        const auto& dsblock = get<DSBlock>(dirBlock);
+        m_mediator.m_blocklinkchain.AddBlockLink(totalIndex, dsBlockNums.at(i),
+                                                 BlockType::DS,
+                                                 dsblock.GetBlockHash());
+        m_mediator.m_dsBlockChain.AddBlock(dsblock);
+        bytes serializedDSBlock;
+        dsblock.Serialize(serializedDSBlock, 0);
+        BlockStorage::GetBlockStorage().PutDSBlock(
+            dsblock.GetHeader().GetBlockNum(), serializedDSBlock);
+        totalIndex++;
+      } else if (typeid(VCBlock) == dirBlock.type()) {
+        const auto& vcblock = get<VCBlock>(dirBlock);
+        m_mediator.m_blocklinkchain.AddBlockLink(
+            totalIndex, dsBlockNums.at(i) + 1, BlockType::VC,
+            vcblock.GetBlockHash());
+        bytes vcblockserialized;
+        vcblock.Serialize(vcblockserialized, 0);
+        BlockStorage::GetBlockStorage().PutVCBlock(vcblock.GetBlockHash(),
+                                                   vcblockserialized);
+        totalIndex++;
+      } else if (typeid(FallbackBlockWShardingStructure) == dirBlock.type()) {
+        const auto& fallbackwshardingstructure =
+            get<FallbackBlockWShardingStructure>(dirBlock);
+        const auto& fallbackblock = fallbackwshardingstructure.m_fallbackblock;
+        m_mediator.m_blocklinkchain.AddBlockLink(
+            totalIndex, dsBlockNums.at(i) + 1, BlockType::FB,
+            fallbackblock.GetBlockHash());
+        bytes fallbackblockser;
+        fallbackwshardingstructure.Serialize(fallbackblockser, 0);
+        BlockStorage::GetBlockStorage().PutFallbackBlock(
+            fallbackblock.GetBlockHash(), fallbackblockser);
+        totalIndex++;
       }
-      const PubKey& leaderPubKey = fallbackblock.GetHeader().GetLeaderPubKey();
-      const Peer& leaderNetworkInfo =
-          fallbackblock.GetHeader().GetLeaderNetworkInfo();
-      m_mediator.m_node->UpdateDSCommitteeAfterFallback(
-          shard_id, leaderPubKey, leaderNetworkInfo, mutable_ds_comm, shards);
-      m_mediator.m_blocklinkchain.AddBlockLink(totalIndex, prevdsblocknum + 1,
-                                               BlockType::FB,
-                                               fallbackblock.GetBlockHash());
-      bytes fallbackblockser;
-      fallbackwshardingstructure.Serialize(fallbackblockser, 0);
-      BlockStorage::GetBlockStorage().PutFallbackBlock(
-          fallbackblock.GetBlockHash(), fallbackblockser);
-      totalIndex++;
-    } else {
-      LOG_GENERAL(WARNING, "dirBlock type unexpected ");
     }
+
   }
 
   newDSComm = move(mutable_ds_comm);
@@ -18,16 +18,22 @@
 #ifndef __VALIDATOR_H__
 #define __VALIDATOR_H__
 
+#include <atomic>
 #include <boost/variant.hpp>
+#include <functional>
+#include <memory>
 #include <string>
+#include <vector>
 #include "libData/AccountData/Transaction.h"
 #include "libData/AccountData/TransactionReceipt.h"
 #include "libData/BlockChainData/BlockLinkChain.h"
 #include "libData/BlockData/Block.h"
 #include "libData/BlockData/Block/FallbackBlockWShardingStructure.h"
 #include "libNetwork/Peer.h"
+#include "libUtils/ThreadPool.h"
 
 class Mediator;
+struct PaymentResult;
 
 class ValidatorBase {
  public:
@@ -38,42 +44,105 @@ class ValidatorBase {
   /// Verifies the transaction w.r.t given pubKey and signature
   virtual bool VerifyTransaction(const Transaction& tran) const = 0;
 
+  /// Verifies the signatures of a batch of transactions. results[i] tells
+  /// whether txns[i] is correctly signed. Returns true if all of them are.
+  virtual bool VerifyTransactions(const std::vector<Transaction>& txns,
+                                  std::vector<bool>& results) const = 0;
+
   virtual bool CheckCreatedTransaction(const Transaction& tx,
                                        TransactionReceipt& receipt) const = 0;
 
-  virtual bool CheckCreatedTransactionFromLookup(const Transaction& tx) = 0;
+  /// Runs CheckCreatedTransaction on a batch of plain transfers that share no
+  /// account, without applying them yet. See AccountStore::CommitPaymentTemp.
+  virtual void CheckCreatedPayments(
+      const std::vector<Transaction>& txns,
+      std::vector<PaymentResult>& results) const = 0;
+
+  /// Loads the senders and recipients of a batch of transactions from the
+  /// state ahead of running them. See AccountStore::PrefetchAccounts.
+  virtual void PrefetchAccounts(
+      const std::vector<Transaction>& txns) const = 0;
 
+  /// Set verifySignature to false if the signature was already checked
+  /// (e.g., with VerifyTransactions)
+  virtual bool CheckCreatedTransactionFromLookup(
+      const Transaction& tx, bool verifySignature = true) = 0;
+
+  /// The co-signatures of the first numCosigChecked blocks are taken as
+  /// checked already. Those blocks are only replayed.
   virtual bool CheckDirBlocks(
       const std::vector<boost::variant<
           DSBlock, VCBlock, FallbackBlockWShardingStructure>>& dirBlocks,
       const DequeOfNode& initDsComm, const uint64_t& index_num,
-      DequeOfNode& newDSComm) = 0;
+      DequeOfNode& newDSComm, size_t numCosigChecked = 0) = 0;
   virtual TxBlockValidationMsg CheckTxBlocks(
       const std::vector<TxBlock>& txblocks, const DequeOfNode& dsComm,
       const BlockLink& latestBlockLink) = 0;
 };
 
+/// Running totals of the batched transaction signature checks
+struct TxnVerifyStats {
+  uint64_t m_batches;
+  uint64_t m_verified;
+  uint64_t m_rejected;
+  uint64_t m_elapsedMicroseconds;
+};
+
 class Validator : public ValidatorBase {
+  /// Fewest transactions worth handing to another verification thread
+  static const unsigned int MIN_TXNS_PER_VERIFY_JOB = 32;
+  /// Directory blocks whose co-signatures are checked concurrently
+  static const unsigned int DIR_BLOCKS_PER_COSIG_BATCH = 64;
+
+  std::unique_ptr<ThreadPool> m_verifyPool;
+  unsigned int m_verifyThreads;
+
+  mutable std::atomic<uint64_t> m_verifyBatches;
+  mutable std::atomic<uint64_t> m_verifiedTxns;
+  mutable std::atomic<uint64_t> m_rejectedTxns;
+  mutable std::atomic<uint64_t> m_verifyMicroseconds;
+
+  /// Runs the checks on the verification pool and the calling thread
+  void RunOnVerifyPool(std::vector<std::function<bool()>>& checks,
+                       std::vector<unsigned char>& results) const;
+
  public:
   Validator(Mediator& mediator);
   ~Validator();
   std::string name() const override { return "Validator"; }
   bool VerifyTransaction(const Transaction& tran) const override;
 
+  /// Splits the batch over the verification pool (TXN_VERIFY_THREADS) and
+  /// checks part of it on the calling thread too
+  bool VerifyTransactions(const std::vector<Transaction>& txns,
+                          std::vector<bool>& results) const override;
+
+  TxnVerifyStats GetTxnVerifyStats() const;
+
   bool CheckCreatedTransaction(const Transaction& tx,
                                TransactionReceipt& receipt) const override;
 
-  bool CheckCreatedTransactionFromLookup(const Transaction& tx) override;
+  /// The transfers themselves run on the verification pool
+  void CheckCreatedPayments(const std::vector<Transaction>& txns,
+                            std::vector<PaymentResult>& results) const override;
+
+  /// The lookups run on the verification pool
+  void PrefetchAccounts(const std::vector<Transaction>& txns) const override;
+
+  bool CheckCreatedTransactionFromLookup(const Transaction& tx,
+                                         bool verifySignature = true) override;
 
   template <class Container, class DirectoryBlock>
   bool CheckBlockCosignature(const DirectoryBlock& block,
                              const Container& commKeys);
 
+  /// Co-signatures are checked DIR_BLOCKS_PER_COSIG_BATCH blocks at a time
+  /// on the verification pool
   bool CheckDirBlocks(
       const std::vector<boost::variant<
           DSBlock, VCBlock, FallbackBlockWShardingStructure>>& dirBlocks,
       const DequeOfNode& initDsComm, const uint64_t& index_num,
-      DequeOfNode& newDSComm) override;
+      DequeOfNode& newDSComm, size_t numCosigChecked = 0) override;
   // TxBlocks must be in increasing order or it will fail
   TxBlockValidationMsg CheckTxBlocks(const std::vector<TxBlock>& txBlocks,
                                      const DequeOfNode& dsComm,
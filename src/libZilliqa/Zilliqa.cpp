@@ -27,10 +27,16 @@
 #include "libCrypto/Sha2.h"
 #include "libData/AccountData/Address.h"
 #include "libNetwork/Guard.h"
+#include "libNetwork/MessagePool.h"
 #include "libServer/GetWorkServer.h"
+#include "libServer/StratumServer.h"
+#include "libServer/WebSocketServer.h"
 #include "libUtils/DataConversion.h"
 #include "libUtils/DetachedFunction.h"
+#include "libUtils/EpochMetrics.h"
 #include "libUtils/Logger.h"
+#include "libUtils/MemoryStats.h"
+#include "libUtils/Tracer.h"
 #include "libUtils/UpgradeManager.h"
 
 using namespace std;
@@ -60,21 +66,7 @@ void Zilliqa::LogSelfNodeInfo(const PairOfKey& key, const Peer& peer) {
 
 /*static*/ std::string Zilliqa::FormatMessageName(unsigned char msgType,
                                                   unsigned char instruction) {
-  const std::string InvalidMessageType = "INVALID_MESSAGE";
-  if (msgType >= ARRAY_SIZE(MessageTypeStrings)) {
-    return InvalidMessageType;
-  }
-
-  if (NULL == MessageTypeInstructionStrings[msgType]) {
-    return InvalidMessageType;
-  }
-
-  if (instruction >= MessageTypeInstructionSize[msgType]) {
-    return InvalidMessageType;
-  }
-
-  return MessageTypeStrings[msgType] + "_" +
-         MessageTypeInstructionStrings[msgType][instruction];
+  return GetMessageName(msgType, instruction);
 }
 
 void Zilliqa::ProcessMessage(pair<bytes, Peer>* message) {
@@ -90,28 +82,31 @@ void Zilliqa::ProcessMessage(pair<bytes, Peer>* message) {
     if (msg_type < msg_handlers_count) {
       if (msg_handlers[msg_type] == NULL) {
         LOG_GENERAL(WARNING, "Message type NULL");
+        MessagePool::GetInstance().Release(message);
         return;
       }
 
-      std::chrono::time_point<std::chrono::high_resolution_clock> tpStart;
+      const auto ins_byte = message->first.at(MessageOffset::INST);
+      const auto msg_size = message->first.size();
       std::string msgName;
       if (ENABLE_CHECK_PERFORMANCE_LOG) {
-        const auto ins_byte = message->first.at(MessageOffset::INST);
         msgName = FormatMessageName(msg_type, ins_byte);
-        LOG_GENERAL(INFO, MessageSizeKeyword << msgName << " "
-                                             << message->first.size());
-
-        tpStart = std::chrono::high_resolution_clock::now();
+        LOG_GENERAL(INFO, MessageSizeKeyword << msgName << " " << msg_size);
       }
 
+      const auto tpStart = std::chrono::high_resolution_clock::now();
+
       bool result = msg_handlers[msg_type]->Execute(
           message->first, MessageOffset::INST, message->second);
 
+      auto tpNow = std::chrono::high_resolution_clock::now();
+      auto timeInMicro = static_cast<int64_t>(
+          (std::chrono::duration<double, std::micro>(tpNow - tpStart))
+              .count());
+      EpochMetrics::GetInstance().RecordMessage(msg_type, ins_byte, msg_size,
+                                                timeInMicro);
+
       if (ENABLE_CHECK_PERFORMANCE_LOG) {
-        auto tpNow = std::chrono::high_resolution_clock::now();
-        auto timeInMicro = static_cast<int64_t>(
-            (std::chrono::duration<double, std::micro>(tpNow - tpStart))
-                .count());
         LOG_GENERAL(
             INFO, MessgeTimeKeyword << msgName << " " << timeInMicro << " us");
       }
@@ -125,7 +120,7 @@ void Zilliqa::ProcessMessage(pair<bytes, Peer>* message) {
     }
   }
 
-  delete message;
+  MessagePool::GetInstance().Release(message);
 }
 
 Zilliqa::Zilliqa(const PairOfKey& key, const Peer& peer, bool loadConfig,
@@ -135,27 +130,48 @@ Zilliqa::Zilliqa(const PairOfKey& key, const Peer& peer, bool loadConfig,
       m_ds(m_mediator),
       m_lookup(m_mediator),
       m_n(m_mediator, syncType, toRetrieveHistory),
-      m_msgQueue(MSGQUEUE_SIZE),
-      m_httpserver(SERVER_PORT),
-      m_server(m_mediator, m_httpserver)
+      m_httpserver(SERVER_PORT, RPC_SERVER_THREADS, RPC_MAX_CONNECTIONS,
+                   RPC_KEEPALIVE_TIMEOUT_IN_SEC, RPC_MAX_REQUEST_BYTES,
+                   RPC_MAX_IN_FLIGHT),
+      m_server(m_mediator, m_httpserver),
+      m_protoServer(m_mediator),
+      m_protoRpcServer(m_protoServer)
 
 {
   LOG_MARKER();
 
-  // Launch the thread that reads messages from the queue
-  auto funcCheckMsgQueue = [this]() mutable -> void {
-    pair<bytes, Peer>* message = NULL;
-    while (true) {
-      while (m_msgQueue.pop(message)) {
-        // For now, we use a thread pool to handle this message
-        // Eventually processing will be single-threaded
-        m_queuePool.AddJob(
-            [this, message]() mutable -> void { ProcessMessage(message); });
-      }
-      std::this_thread::sleep_for(std::chrono::microseconds(1));
-    }
-  };
-  DetachedFunction(1, funcCheckMsgQueue);
+  m_httpserver.SetServeMetrics(RPC_METRICS_ENDPOINT);
+  m_httpserver.SetStreamHandler(
+      [this](const string& request, string& response) {
+        return m_server.HandleStreamed(request, response);
+      });
+
+  if (TRACE_ENABLED) {
+    // Installs the SIGUSR2 dump handler before the first span is recorded
+    Tracer::GetInstance();
+  }
+
+  const struct {
+    unsigned int threads;
+    unsigned int queueSize;
+    const char* name;
+  } laneConfigs[LANE_COUNT] = {
+      {DISPATCH_CONSENSUS_THREADS, DISPATCH_CONSENSUS_QUEUE_SIZE,
+       "ConsensusLane"},
+      {DISPATCH_DIRECTORY_THREADS, DISPATCH_DIRECTORY_QUEUE_SIZE,
+       "DirectoryLane"},
+      {DISPATCH_NODE_THREADS, DISPATCH_NODE_QUEUE_SIZE, "NodeLane"},
+      {DISPATCH_LOOKUP_THREADS, DISPATCH_LOOKUP_QUEUE_SIZE, "LookupLane"},
+      {DISPATCH_TXN_THREADS, DISPATCH_TXN_QUEUE_SIZE, "TxnLane"}};
+
+  const auto placement =
+      ThreadPlacement::Resolve(DISPATCH_PLACEMENT, "DispatchLane");
+  for (unsigned int i = 0; i < LANE_COUNT; i++) {
+    m_lanes[i].m_pool.reset(new ThreadPool(
+        max(laneConfigs[i].threads, 1u), laneConfigs[i].name, placement));
+    m_lanes[i].m_queueSize = max(laneConfigs[i].queueSize, 1u);
+    m_lanes[i].m_pending = 0;
+  }
 
   m_validator = make_shared<Validator>(m_mediator);
   m_mediator.RegisterColleagues(&m_ds, &m_n, &m_lookup, m_validator.get());
@@ -174,9 +190,15 @@ Zilliqa::Zilliqa(const PairOfKey& key, const Peer& peer, bool loadConfig,
     m_server.StartCollectorThread();
   }
 
+  if (READ_REPLICA_MODE && !LOOKUP_NODE_MODE) {
+    LOG_GENERAL(FATAL, "Read replica mode is true but not lookup ");
+  }
+
   P2PComm::GetInstance().SetSelfPeer(peer);
   P2PComm::GetInstance().SetSelfKey(key);
 
+  RegisterMemoryReporters();
+
   if (GUARD_MODE) {
     // Setting the guard upon process launch
     Guard::GetInstance().Init();
@@ -207,6 +229,14 @@ Zilliqa::Zilliqa(const PairOfKey& key, const Peer& peer, bool loadConfig,
       }
     }
 
+    // A replica always bootstraps from the seeds, then keeps following them
+    if (READ_REPLICA_MODE && syncType != SyncType::NEW_LOOKUP_SYNC) {
+      LOG_GENERAL(WARNING, "Read replica syncs as a new lookup, not as type "
+                               << syncType);
+      syncType = SyncType::NEW_LOOKUP_SYNC;
+      toRetrieveHistory = false;
+    }
+
     LogSelfNodeInfo(key, peer);
 
     switch (syncType) {
@@ -273,6 +303,15 @@ Zilliqa::Zilliqa(const PairOfKey& key, const Peer& peer, bool loadConfig,
     if (!LOOKUP_NODE_MODE) {
       LOG_GENERAL(INFO, "I am a normal node.");
 
+      if (CONSENSUS_TRACE_API || PROFILER_API || MEMORY_STATS_API ||
+          LOCK_PROFILING) {
+        if (m_server.StartListening()) {
+          LOG_GENERAL(INFO, "API Server started for diagnostics");
+        } else {
+          LOG_GENERAL(WARNING, "API Server couldn't start");
+        }
+      }
+
       if (GETWORK_SERVER_MINE) {
         LOG_GENERAL(INFO, "Starting GetWork Mining Server at http://"
                               << peer.GetPrintableIPAddress() << ":"
@@ -285,6 +324,14 @@ Zilliqa::Zilliqa(const PairOfKey& key, const Peer& peer, bool loadConfig,
           LOG_GENERAL(WARNING, "GetWork Mining Server couldn't start");
         }
 
+        if (ENABLE_STRATUM_SERVER) {
+          if (StratumServer::GetInstance().Start()) {
+            LOG_GENERAL(INFO, "Stratum Mining Server started successfully");
+          } else {
+            LOG_GENERAL(WARNING, "Stratum Mining Server couldn't start");
+          }
+        }
+
       } else {
         LOG_GENERAL(INFO, "GetWork Mining Server not enable")
       }
@@ -297,25 +344,118 @@ Zilliqa::Zilliqa(const PairOfKey& key, const Peer& peer, bool loadConfig,
       } else {
         LOG_GENERAL(WARNING, "API Server couldn't start");
       }
+      if (ENABLE_WEBSOCKET) {
+        if (WebSocketServer::GetInstance().Start()) {
+          LOG_GENERAL(INFO, "WebSocket Server started successfully");
+        } else {
+          LOG_GENERAL(WARNING, "WebSocket Server couldn't start");
+        }
+      }
+      if (ENABLE_PROTO_RPC) {
+        if (m_protoRpcServer.Start()) {
+          LOG_GENERAL(INFO, "Proto RPC Server started successfully");
+        } else {
+          LOG_GENERAL(WARNING, "Proto RPC Server couldn't start");
+        }
+      }
     }
   };
   DetachedFunction(1, func);
 }
 
 Zilliqa::~Zilliqa() {
-  pair<bytes, Peer>* message = NULL;
-  while (m_msgQueue.pop(message)) {
-    delete message;
+  // The reporters capture this object's members
+  for (const auto& subsystem :
+       {"AccountStore", "DSBlockChain", "TxBlockChain", "LevelDB",
+        "RumorManager", "MessagePool", "LookupTxnBuffer", "TxnPool"}) {
+    MemoryStats::GetInstance().Unregister(subsystem);
+  }
+}
+
+void Zilliqa::RegisterMemoryReporters() {
+  MemoryStats& stats = MemoryStats::GetInstance();
+
+  stats.Register("AccountStore",
+                 [] { return AccountStore::GetInstance().GetMemoryUsage(); });
+  stats.Register("DSBlockChain", [this] {
+    return m_mediator.m_dsBlockChain.GetMemoryUsage();
+  });
+  stats.Register("TxBlockChain", [this] {
+    return m_mediator.m_txBlockChain.GetMemoryUsage();
+  });
+  stats.Register("LevelDB", [] {
+    return BlockStorage::GetBlockStorage().GetMemoryUsage();
+  });
+  stats.Register("RumorManager",
+                 [] { return P2PComm::GetInstance().GetRumorMemoryUsage(); });
+  stats.Register("MessagePool",
+                 [] { return MessagePool::GetInstance().GetMemoryUsage(); });
+
+  if (LOOKUP_NODE_MODE) {
+    stats.Register("LookupTxnBuffer",
+                   [this] { return m_lookup.m_txnShardMap.GetMemoryUsage(); });
+  } else {
+    stats.Register("TxnPool",
+                   [this] { return m_n.GetCreatedTxnsMemoryUsage(); });
+  }
+}
+
+/*static*/ Zilliqa::DispatchLane Zilliqa::GetDispatchLane(
+    const bytes& message) {
+  if (message.size() < MessageOffset::BODY) {
+    return LANE_NODE;
+  }
+
+  const unsigned char msg_type = message.at(MessageOffset::TYPE);
+  const unsigned char ins_type = message.at(MessageOffset::INST);
+
+  switch (msg_type) {
+    case MessageType::DIRECTORY:
+      switch (ins_type) {
+        case DSInstructionType::DSBLOCKCONSENSUS:
+        case DSInstructionType::FINALBLOCKCONSENSUS:
+        case DSInstructionType::VIEWCHANGECONSENSUS:
+          return LANE_CONSENSUS;
+        default:
+          return LANE_DIRECTORY;
+      }
+    case MessageType::NODE:
+      switch (ins_type) {
+        case NodeInstructionType::MICROBLOCKCONSENSUS:
+        case NodeInstructionType::FALLBACKCONSENSUS:
+          return LANE_CONSENSUS;
+        case NodeInstructionType::SUBMITTRANSACTION:
+        case NodeInstructionType::FORWARDTXNPACKET:
+          return LANE_TXN;
+        default:
+          return LANE_NODE;
+      }
+    case MessageType::LOOKUP:
+      return (ins_type == LookupInstructionType::FORWARDTXN) ? LANE_TXN
+                                                             : LANE_LOOKUP;
+    default:
+      return LANE_NODE;
   }
 }
 
 void Zilliqa::Dispatch(pair<bytes, Peer>* message) {
   // LOG_MARKER();
 
+  const DispatchLane laneId = GetDispatchLane(message->first);
+  MessageLane& lane = m_lanes[laneId];
+
   // Queue message
-  if (!m_msgQueue.bounded_push(message)) {
-    LOG_GENERAL(WARNING, "Input MsgQueue is full");
+  if (lane.m_pending++ >= lane.m_queueSize) {
+    lane.m_pending--;
+    LOG_GENERAL(WARNING, "Input MsgQueue is full for lane " << laneId);
+    MessagePool::GetInstance().Release(message);
+    return;
   }
+
+  lane.m_pool->AddJob([this, message, &lane]() mutable -> void {
+    ProcessMessage(message);
+    lane.m_pending--;
+  });
 }
 
 vector<Peer> Zilliqa::RetrieveBroadcastList(unsigned char msg_type,
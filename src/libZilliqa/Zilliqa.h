@@ -18,7 +18,8 @@
 #ifndef __ZILLIQA_H__
 #define __ZILLIQA_H__
 
-#include <jsonrpccpp/server/connectors/httpserver.h>
+#include <atomic>
+#include <memory>
 #include <vector>
 
 #include "libConsensus/ConsensusUser.h"
@@ -29,7 +30,9 @@
 #include "libNetwork/PeerManager.h"
 #include "libNetwork/PeerStore.h"
 #include "libNode/Node.h"
+#include "libProtoServer/ProtoRpcServer.h"
 #include "libServer/Server.h"
+#include "libServer/ThreadedHttpServer.h"
 #include "libUtils/ThreadPool.h"
 
 /// Main Zilliqa class.
@@ -42,15 +45,39 @@ class Zilliqa {
   Node m_n;
   // ConsensusUser m_cu; // Note: This is just a test class to demo Consensus
   // usage
-  boost::lockfree::queue<std::pair<bytes, Peer>*> m_msgQueue;
 
-  jsonrpc::HttpServer m_httpserver;
+  ThreadedHttpServer m_httpserver;
   Server m_server;
+  ProtoServer m_protoServer;
+  ProtoRpcServer m_protoRpcServer;
 
-  ThreadPool m_queuePool{MAXMESSAGE, "QueuePool"};
+  /// Incoming messages are processed on separate lanes so that a flood of one
+  /// kind (e.g., forwarded transactions) cannot take all the threads
+  enum DispatchLane : unsigned int {
+    LANE_CONSENSUS = 0,
+    LANE_DIRECTORY,
+    LANE_NODE,
+    LANE_LOOKUP,
+    LANE_TXN,
+    LANE_COUNT
+  };
+
+  struct MessageLane {
+    std::unique_ptr<ThreadPool> m_pool;
+    unsigned int m_queueSize;
+    /// Messages queued or being processed on this lane
+    std::atomic<unsigned int> m_pending;
+  };
+
+  MessageLane m_lanes[LANE_COUNT];
+
+  static DispatchLane GetDispatchLane(const bytes& message);
 
   void ProcessMessage(std::pair<bytes, Peer>* message);
 
+  /// Registers the subsystems reported by the GetMemoryStats RPC
+  void RegisterMemoryReporters();
+
  public:
   /// Constructor.
   Zilliqa(const PairOfKey& key, const Peer& peer, bool loadConfig,
@@ -0,0 +1,318 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <json/json.h>
+#include <boost/program_options.hpp>
+
+#include "NetworkSimulator.h"
+#include "common/Constants.h"
+#include "common/Messages.h"
+#include "libConsensus/ConsensusBackup.h"
+#include "libConsensus/ConsensusLeader.h"
+#include "libTestUtils/TestUtils.h"
+#include "libUtils/Logger.h"
+#include "libUtils/TimeUtils.h"
+
+namespace po = boost::program_options;
+
+#define SUCCESS 0
+#define ERROR_IN_COMMAND_LINE -1
+#define ERROR_UNHANDLED_EXCEPTION -2
+#define ERROR_UNEXPECTED -3
+
+using namespace std;
+
+namespace {
+struct Settings {
+  NetworkSimulator::LinkParams m_link;
+  unsigned int m_slowNodes = 0;
+  double m_slowLatencyMs = 0;
+  unsigned int m_fanout = 3;
+  bool m_gossipAnnouncement = false;
+  unsigned int m_payloadBytes = 0;
+  uint32_t m_seed = 0;
+};
+
+/// One round of consensus on a payload within a committee of size nodes,
+/// node 0 being the leader and the first m_slowNodes backups behind slow
+/// links. Returns simulated times and traffic.
+Json::Value RunRound(unsigned int size, const Settings& settings) {
+  const uint32_t consensusID = 1;
+  const uint64_t blockNumber = 1;
+  const bytes blockHash(BLOCK_HASH_SIZE, 0);
+  const unsigned char classByte = MessageType::NODE;
+  const unsigned char insByte = NodeInstructionType::MICROBLOCKCONSENSUS;
+
+  vector<PairOfKey> keys;
+  DequeOfNode committee;
+  for (unsigned int i = 0; i < size; i++) {
+    keys.emplace_back(TestUtils::GenerateRandomKeyPair());
+    committee.emplace_back(keys.back().second, Peer(i + 1, 30000 + i));
+  }
+
+  NetworkSimulator sim(settings.m_seed + size, settings.m_fanout);
+  sim.SetDefaultLink(settings.m_link);
+
+  auto generator = [&settings](bytes& dst, unsigned int offset,
+                               [[gnu::unused]] const uint32_t consensusID,
+                               [[gnu::unused]] const uint64_t blockNumber,
+                               [[gnu::unused]] const bytes& blockHash,
+                               [[gnu::unused]] const uint16_t leaderID,
+                               [[gnu::unused]] const PairOfKey& leaderKey,
+                               bytes& messageToCosign) {
+    messageToCosign = TestUtils::GenerateRandomCharVector(
+        settings.m_payloadBytes);
+    dst.resize(offset);
+    dst.insert(dst.end(), messageToCosign.begin(), messageToCosign.end());
+    return true;
+  };
+  auto validator = [](const bytes& input, unsigned int offset,
+                      [[gnu::unused]] bytes& errorMsg,
+                      [[gnu::unused]] const uint32_t consensusID,
+                      [[gnu::unused]] const uint64_t blockNumber,
+                      [[gnu::unused]] const bytes& blockHash,
+                      [[gnu::unused]] const uint16_t leaderID,
+                      [[gnu::unused]] const PubKey& leaderKey,
+                      bytes& messageToCosign) {
+    if (offset > input.size()) {
+      return false;
+    }
+    messageToCosign.assign(input.begin() + offset, input.end());
+    return true;
+  };
+
+  vector<shared_ptr<ConsensusCommon>> nodes;
+  nodes.emplace_back(make_shared<ConsensusLeader>(
+      consensusID, blockNumber, blockHash, 0, keys.at(0).first, committee,
+      classByte, insByte,
+      []([[gnu::unused]] const bytes& errorMsg,
+         [[gnu::unused]] const Peer& from) { return true; },
+      []([[gnu::unused]] map<unsigned int, bytes> failures) { return true; }));
+  for (unsigned int i = 1; i < size; i++) {
+    nodes.emplace_back(make_shared<ConsensusBackup>(
+        consensusID, blockNumber, blockHash, i, 0, keys.at(i).first, committee,
+        classByte, insByte, validator));
+  }
+
+  vector<double> doneAt(size, -1);
+  for (unsigned int i = 0; i < size; i++) {
+    sim.AddNode(committee.at(i).second, [&, i](const bytes& message,
+                                              const Peer& from) {
+      nodes.at(i)->ProcessMessage(message, MessageOffset::BODY, from);
+      if ((doneAt.at(i) < 0) &&
+          (nodes.at(i)->GetState() == ConsensusCommon::State::DONE)) {
+        doneAt.at(i) = sim.Now();
+      }
+    });
+  }
+
+  NetworkSimulator::LinkParams slowLink = settings.m_link;
+  slowLink.m_latencyMs = settings.m_slowLatencyMs;
+  for (unsigned int i = 1; i <= settings.m_slowNodes && i < size; i++) {
+    for (unsigned int j = 0; j < size; j++) {
+      if (i != j) {
+        sim.SetLink(i, j, slowLink);
+        sim.SetLink(j, i, slowLink);
+      }
+    }
+  }
+
+  bool started = false;
+  auto startTime = r_timer_start();
+  sim.Execute(0, [&]() {
+    started = dynamic_pointer_cast<ConsensusLeader>(nodes.at(0))
+                  ->StartConsensus(generator, settings.m_gossipAnnouncement);
+  });
+  const double endMs = sim.Run();
+  const double wallInUs = r_timer_end(startTime);
+
+  unsigned int backupsDone = 0;
+  double lastBackupMs = 0;
+  for (unsigned int i = 1; i < size; i++) {
+    if (doneAt.at(i) >= 0) {
+      backupsDone++;
+      lastBackupMs = max(lastBackupMs, doneAt.at(i));
+    }
+  }
+
+  const NetworkSimulator::Stats& stats = sim.GetStats();
+  Json::Value round;
+  round["committee_size"] = size;
+  round["started"] = started;
+  round["leader_done"] = doneAt.at(0) >= 0;
+  round["leader_done_ms"] = doneAt.at(0);
+  round["backups_done"] = backupsDone;
+  round["last_backup_done_ms"] = lastBackupMs;
+  round["simulated_ms"] = endMs;
+  round["wall_ms"] = wallInUs / 1000;
+  round["messages"] = static_cast<Json::UInt64>(stats.m_sent);
+  round["retransmitted"] = static_cast<Json::UInt64>(stats.m_retransmitted);
+  round["bytes"] = static_cast<Json::UInt64>(stats.m_bytes);
+  return round;
+}
+
+bool ParseSizes(const string& str, vector<unsigned int>& sizes) {
+  stringstream ss(str);
+  string item;
+  while (getline(ss, item, ',')) {
+    try {
+      const unsigned long size = stoul(item);
+      if (size < 2 || size > numeric_limits<uint16_t>::max()) {
+        return false;
+      }
+      sizes.emplace_back(size);
+    } catch (exception&) {
+      return false;
+    }
+  }
+  return !sizes.empty();
+}
+}  // namespace
+
+/// Runs one round of consensus per committee size over a simulated network:
+/// the leader and backups are the real ConsensusLeader / ConsensusBackup,
+/// their messages are delayed per link in simulated time. Shard and DS
+/// committees run the same protocol, so the sizes cover both.
+int main(int argc, const char* argv[]) {
+  try {
+    string strSizes;
+    Settings settings;
+    string strResultName;
+
+    po::options_description desc("Options");
+
+    desc.add_options()("help,h", "Print help messages")(
+        "sizes", po::value<string>(&strSizes)->default_value("10,50,200,600"),
+        "comma-separated committee sizes")(
+        "latency-ms",
+        po::value<double>(&settings.m_link.m_latencyMs)->default_value(50),
+        "one-way link latency")(
+        "jitter-ms",
+        po::value<double>(&settings.m_link.m_jitterMs)->default_value(10),
+        "uniform extra link latency")(
+        "bandwidth-mbps",
+        po::value<double>(&settings.m_link.m_bandwidthMbps)
+            ->default_value(100),
+        "uplink bandwidth of each node, 0 for unlimited")(
+        "loss",
+        po::value<double>(&settings.m_link.m_lossRate)->default_value(0),
+        "message loss rate, lost messages are resent")(
+        "retransmit-ms",
+        po::value<double>(&settings.m_link.m_retransmitMs)->default_value(200),
+        "delay before a lost message is resent")(
+        "slow-nodes",
+        po::value<unsigned int>(&settings.m_slowNodes)->default_value(0),
+        "number of backups behind slow links")(
+        "slow-latency-ms",
+        po::value<double>(&settings.m_slowLatencyMs)->default_value(500),
+        "one-way latency of the slow links")(
+        "fanout", po::value<unsigned int>(&settings.m_fanout)->default_value(3),
+        "gossip fanout, for rumors")(
+        "gossip-announcement", po::bool_switch(&settings.m_gossipAnnouncement),
+        "spread the announcement as a rumor")(
+        "payload-bytes",
+        po::value<unsigned int>(&settings.m_payloadBytes)->default_value(1024),
+        "size of the announced content")(
+        "seed", po::value<uint32_t>(&settings.m_seed)->default_value(1),
+        "seed of the simulated network")(
+        "result-file-name,r", po::value<string>(&strResultName),
+        "also write the json result into this file");
+
+    po::variables_map vm;
+    try {
+      po::store(po::parse_command_line(argc, argv, desc), vm);
+
+      /** --help option
+       */
+      if (vm.count("help")) {
+        cout << desc << endl;
+        return SUCCESS;
+      }
+      po::notify(vm);
+    } catch (boost::program_options::error& e) {
+      cerr << "ERROR: " << e.what() << endl << endl;
+      return ERROR_IN_COMMAND_LINE;
+    }
+
+    if (settings.m_link.m_lossRate < 0 || settings.m_link.m_lossRate >= 1) {
+      cerr << "ERROR: loss rate must be in [0, 1)" << endl;
+      return ERROR_IN_COMMAND_LINE;
+    }
+
+    vector<unsigned int> sizes;
+    if (!ParseSizes(strSizes, sizes)) {
+      cerr << "ERROR: committee sizes must be between 2 and 65535" << endl;
+      return ERROR_IN_COMMAND_LINE;
+    }
+
+    // The commit windows of several subsets run on their own threads and in
+    // real time, which the simulation cannot follow
+    if (NUM_CONSENSUS_SUBSETS > 1) {
+      cerr << "ERROR: needs NUM_CONSENSUS_SUBSETS of 1 in constants.xml"
+           << endl;
+      return ERROR_UNEXPECTED;
+    }
+
+    // Keep stdout for the result
+    INIT_FILE_LOGGER("benchmark");
+
+    Json::Value result;
+    result["latency_ms"] = settings.m_link.m_latencyMs;
+    result["jitter_ms"] = settings.m_link.m_jitterMs;
+    result["bandwidth_mbps"] = settings.m_link.m_bandwidthMbps;
+    result["loss"] = settings.m_link.m_lossRate;
+    result["retransmit_ms"] = settings.m_link.m_retransmitMs;
+    result["slow_nodes"] = settings.m_slowNodes;
+    result["fanout"] = settings.m_fanout;
+    result["gossip_collective_sig"] = BROADCAST_GOSSIP_MODE;
+    result["gossip_announcement"] = settings.m_gossipAnnouncement;
+    result["payload_bytes"] = settings.m_payloadBytes;
+    result["seed"] = settings.m_seed;
+
+    for (const auto& size : sizes) {
+      result["rounds"].append(RunRound(size, settings));
+    }
+
+    Json::StreamWriterBuilder writeBuilder;
+    const string output = Json::writeString(writeBuilder, result);
+    cout << output << endl;
+
+    if (!strResultName.empty()) {
+      ofstream fs(strResultName, ofstream::out);
+      if (!fs.is_open()) {
+        cerr << "Failed to open file " << strResultName << endl;
+        return ERROR_UNEXPECTED;
+      }
+      fs << output << endl;
+    }
+  } catch (exception& e) {
+    cerr << "Unhandled Exception reached the top of main: " << e.what()
+         << ", application will now exit" << endl;
+    return ERROR_UNHANDLED_EXCEPTION;
+  }
+
+  return SUCCESS;
+}
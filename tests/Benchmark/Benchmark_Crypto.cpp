@@ -0,0 +1,328 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <json/json.h>
+#include <boost/program_options.hpp>
+
+#include "libCrypto/CommitteeKeyCache.h"
+#include "libCrypto/MultiSig.h"
+#include "libCrypto/Schnorr.h"
+#include "libUtils/Logger.h"
+#include "libUtils/TimeUtils.h"
+
+namespace po = boost::program_options;
+
+#define SUCCESS 0
+#define ERROR_IN_COMMAND_LINE -1
+#define ERROR_UNHANDLED_EXCEPTION -2
+#define ERROR_UNEXPECTED -3
+
+using namespace std;
+
+namespace {
+/// Calls op iterations times. op returns false on failure, which marks the
+/// result as not ok.
+template <class Op>
+Json::Value TimeOp(unsigned int iterations, Op op) {
+  bool ok = true;
+  auto startTime = r_timer_start();
+  for (unsigned int i = 0; i < iterations; i++) {
+    ok = op(i) && ok;
+  }
+  const double elapsedInUs = r_timer_end(startTime);
+
+  Json::Value result;
+  result["iterations"] = iterations;
+  result["total_ms"] = elapsedInUs / 1000;
+  result["us_per_op"] = elapsedInUs / iterations;
+  result["ok"] = ok;
+  return result;
+}
+
+bool ParseSizes(const string& str, vector<unsigned int>& sizes) {
+  stringstream ss(str);
+  string item;
+  while (getline(ss, item, ',')) {
+    try {
+      const unsigned long size = stoul(item);
+      if (size < 1 || size > numeric_limits<uint16_t>::max()) {
+        return false;
+      }
+      sizes.emplace_back(size);
+    } catch (exception&) {
+      return false;
+    }
+  }
+  return !sizes.empty();
+}
+
+Json::Value BenchSchnorr(unsigned int iterations, const bytes& message) {
+  Schnorr& schnorr = Schnorr::GetInstance();
+  const PairOfKey keyPair = schnorr.GenKeyPair();
+
+  vector<Signature> signatures(iterations);
+  Json::Value result;
+  result["gen_key_pair"] = TimeOp(iterations, [&schnorr](unsigned int) {
+    return schnorr.GenKeyPair().second.Initialized();
+  });
+  result["sign"] =
+      TimeOp(iterations, [&schnorr, &keyPair, &message,
+                          &signatures](unsigned int i) {
+        return schnorr.Sign(message, keyPair.first, keyPair.second,
+                            signatures.at(i));
+      });
+  result["verify"] = TimeOp(iterations, [&schnorr, &keyPair, &message,
+                                         &signatures](unsigned int i) {
+    return schnorr.Verify(message, signatures.at(i), keyPair.second);
+  });
+
+  // The same signatures again, checked in one call
+  vector<Schnorr::VerifyItem> items;
+  items.reserve(iterations);
+  for (const auto& signature : signatures) {
+    items.push_back({&message, 0, static_cast<unsigned int>(message.size()),
+                     &signature, &keyPair.second});
+  }
+  vector<bool> results;
+  auto startTime = r_timer_start();
+  const bool batchOk = schnorr.BatchVerify(items, results);
+  const double elapsedInUs = r_timer_end(startTime);
+  result["batch_verify"]["iterations"] = iterations;
+  result["batch_verify"]["total_ms"] = elapsedInUs / 1000;
+  result["batch_verify"]["us_per_op"] = elapsedInUs / iterations;
+  result["batch_verify"]["ok"] = batchOk;
+  return result;
+}
+
+Json::Value BenchPubKey(unsigned int iterations) {
+  vector<PubKey> keys;
+  vector<PrivKey> privKeys;
+  for (unsigned int i = 0; i < iterations; i++) {
+    const PairOfKey keyPair = Schnorr::GetInstance().GenKeyPair();
+    privKeys.emplace_back(keyPair.first);
+    keys.emplace_back(keyPair.second);
+  }
+  vector<bytes> serialized(iterations);
+
+  Json::Value result;
+  result["from_privkey"] = TimeOp(iterations, [&privKeys](unsigned int i) {
+    return PubKey(privKeys.at(i)).Initialized();
+  });
+  result["less"] = TimeOp(iterations, [&keys](unsigned int i) {
+    const PubKey& other = keys.at((i + 1) % keys.size());
+    return !((keys.at(i) < other) && (other < keys.at(i)));
+  });
+  result["equal"] = TimeOp(iterations, [&keys](unsigned int i) {
+    return keys.at(i) == keys.at(i);
+  });
+  result["serialize"] = TimeOp(iterations, [&keys,
+                                            &serialized](unsigned int i) {
+    return keys.at(i).Serialize(serialized.at(i), 0) > 0;
+  });
+  result["deserialize"] = TimeOp(iterations, [&keys,
+                                              &serialized](unsigned int i) {
+    return PubKey(serialized.at(i), 0) == keys.at(i);
+  });
+  return result;
+}
+
+/// One multisignature round of a committee of size signers, each operation
+/// timed rounds times
+Json::Value BenchCommittee(unsigned int size, unsigned int rounds,
+                           const bytes& message) {
+  vector<PairOfKey> keyPairs;
+  vector<PubKey> pubKeys;
+  for (unsigned int i = 0; i < size; i++) {
+    keyPairs.emplace_back(Schnorr::GetInstance().GenKeyPair());
+    pubKeys.emplace_back(keyPairs.back().second);
+  }
+  vector<CommitSecret> secrets(size);
+  vector<CommitPoint> points;
+  for (const auto& secret : secrets) {
+    points.emplace_back(secret);
+  }
+
+  Json::Value result;
+  result["committee_size"] = size;
+
+  shared_ptr<PubKey> aggregatedKey;
+  result["aggregate_pubkeys"] =
+      TimeOp(rounds, [&pubKeys, &aggregatedKey](unsigned int) {
+        aggregatedKey = MultiSig::AggregatePubKeys(pubKeys);
+        return aggregatedKey != nullptr;
+      });
+
+  shared_ptr<CommitPoint> aggregatedCommit;
+  result["aggregate_commits"] =
+      TimeOp(rounds, [&points, &aggregatedCommit](unsigned int) {
+        aggregatedCommit = MultiSig::AggregateCommits(points);
+        return aggregatedCommit != nullptr;
+      });
+  if (!aggregatedKey || !aggregatedCommit) {
+    return result;
+  }
+
+  const Challenge challenge(*aggregatedCommit, *aggregatedKey, message);
+  vector<Response> responses;
+  for (unsigned int i = 0; i < size; i++) {
+    responses.emplace_back(secrets.at(i), challenge, keyPairs.at(i).first);
+  }
+
+  // What the leader does once per backup
+  result["verify_responses"] = TimeOp(rounds, [&](unsigned int) {
+    bool ok = true;
+    for (unsigned int i = 0; i < size; i++) {
+      ok = MultiSig::VerifyResponse(responses.at(i), challenge,
+                                    pubKeys.at(i), points.at(i)) &&
+           ok;
+    }
+    return ok;
+  });
+  result["verify_responses"]["us_per_response"] =
+      result["verify_responses"]["us_per_op"].asDouble() / size;
+
+  shared_ptr<Response> aggregatedResponse;
+  result["aggregate_responses"] =
+      TimeOp(rounds, [&responses, &aggregatedResponse](unsigned int) {
+        aggregatedResponse = MultiSig::AggregateResponses(responses);
+        return aggregatedResponse != nullptr;
+      });
+  if (!aggregatedResponse) {
+    return result;
+  }
+
+  const shared_ptr<Signature> signature =
+      MultiSig::AggregateSign(challenge, *aggregatedResponse);
+  if (!signature) {
+    return result;
+  }
+  result["multisig_verify"] =
+      TimeOp(rounds, [&message, &signature, &aggregatedKey](unsigned int) {
+        return MultiSig::GetInstance().MultiSigVerify(message, *signature,
+                                                      *aggregatedKey);
+      });
+
+  // Key of a quorum of two thirds, as checked against a cosig bitmap; the
+  // first round also fills the cache
+  vector<bool> bitmap(size, false);
+  fill(bitmap.begin(), bitmap.begin() + (size * 2 + 2) / 3, true);
+  CommitteeKeyCache cache;
+  result["committee_key_cache"] =
+      TimeOp(rounds, [&pubKeys, &bitmap, &cache](unsigned int) {
+        return cache.Aggregate(
+                   pubKeys, [](const PubKey& key) { return key; },
+                   bitmap) != nullptr;
+      });
+  return result;
+}
+}  // namespace
+
+/// Times the Schnorr and multisignature operations consensus relies on, so
+/// that crypto backends can be compared on the same numbers
+int main(int argc, const char* argv[]) {
+  try {
+    unsigned int iterations = 0;
+    unsigned int rounds = 0;
+    unsigned int messageSize = 0;
+    string strSizes;
+    string strResultName;
+
+    po::options_description desc("Options");
+
+    desc.add_options()("help,h", "Print help messages")(
+        "iterations,i",
+        po::value<unsigned int>(&iterations)->default_value(1000),
+        "iterations of each single-key operation")(
+        "rounds", po::value<unsigned int>(&rounds)->default_value(10),
+        "iterations of each committee operation")(
+        "sizes",
+        po::value<string>(&strSizes)->default_value("10,50,200,600,1000"),
+        "comma-separated committee sizes")(
+        "message-bytes",
+        po::value<unsigned int>(&messageSize)->default_value(1024),
+        "size of the signed message")(
+        "result-file-name,r", po::value<string>(&strResultName),
+        "also write the json result into this file");
+
+    po::variables_map vm;
+    try {
+      po::store(po::parse_command_line(argc, argv, desc), vm);
+
+      /** --help option
+       */
+      if (vm.count("help")) {
+        cout << desc << endl;
+        return SUCCESS;
+      }
+      po::notify(vm);
+    } catch (boost::program_options::error& e) {
+      cerr << "ERROR: " << e.what() << endl << endl;
+      return ERROR_IN_COMMAND_LINE;
+    }
+
+    vector<unsigned int> sizes;
+    if (!ParseSizes(strSizes, sizes)) {
+      cerr << "ERROR: committee sizes must be between 1 and 65535" << endl;
+      return ERROR_IN_COMMAND_LINE;
+    }
+    if (iterations == 0 || rounds == 0) {
+      cerr << "ERROR: need at least one iteration and one round" << endl;
+      return ERROR_IN_COMMAND_LINE;
+    }
+
+    // Keep stdout for the result
+    INIT_FILE_LOGGER("benchmark");
+
+    bytes message(messageSize);
+    generate(message.begin(), message.end(), rand);
+
+    Json::Value result;
+    result["message_bytes"] = messageSize;
+    result["schnorr"] = BenchSchnorr(iterations, message);
+    result["pubkey"] = BenchPubKey(iterations);
+    for (const auto& size : sizes) {
+      result["committees"].append(BenchCommittee(size, rounds, message));
+    }
+
+    Json::StreamWriterBuilder writeBuilder;
+    const string output = Json::writeString(writeBuilder, result);
+    cout << output << endl;
+
+    if (!strResultName.empty()) {
+      ofstream fs(strResultName, ofstream::out);
+      if (!fs.is_open()) {
+        cerr << "Failed to open file " << strResultName << endl;
+        return ERROR_UNEXPECTED;
+      }
+      fs << output << endl;
+    }
+  } catch (exception& e) {
+    cerr << "Unhandled Exception reached the top of main: " << e.what()
+         << ", application will now exit" << endl;
+    return ERROR_UNHANDLED_EXCEPTION;
+  }
+
+  return SUCCESS;
+}
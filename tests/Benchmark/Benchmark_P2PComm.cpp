@@ -0,0 +1,508 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <arpa/inet.h>
+#include <poll.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <json/json.h>
+#include <boost/program_options.hpp>
+
+#include "common/Constants.h"
+#include "libCrypto/Schnorr.h"
+#include "libNetwork/MessagePool.h"
+#include "libNetwork/P2PComm.h"
+#include "libUtils/DetachedFunction.h"
+#include "libUtils/Logger.h"
+#include "libUtils/TimeUtils.h"
+
+namespace po = boost::program_options;
+
+#define SUCCESS 0
+#define ERROR_IN_COMMAND_LINE -1
+#define ERROR_UNHANDLED_EXCEPTION -2
+#define ERROR_UNEXPECTED -3
+
+using namespace std;
+
+namespace {
+/// Sent by the benchmark to a receiver before each case
+struct Command {
+  uint32_t m_caseId;
+  /// Messages the receiver has to get before it reports the case done
+  uint32_t m_expected;
+  /// Nodes 0 .. m_networkSize - 1 take part, node 0 being the sender
+  uint32_t m_networkSize;
+  uint32_t m_gossip;
+};
+
+enum ReportKind : uint32_t { REPORT_READY = 0, REPORT_DONE };
+
+/// Sent by a receiver to the benchmark; smaller than PIPE_BUF, so the reports
+/// of all receivers share one pipe without interleaving
+struct Report {
+  uint32_t m_caseId;
+  uint32_t m_node;
+  uint32_t m_kind;
+  uint64_t m_bytes;
+};
+
+bool ReadFull(int fd, void* dst, size_t size) {
+  auto* p = static_cast<unsigned char*>(dst);
+  while (size > 0) {
+    const ssize_t n = read(fd, p, size);
+    if (n <= 0) {
+      return false;
+    }
+    p += n;
+    size -= n;
+  }
+  return true;
+}
+
+bool WriteFull(int fd, const void* src, size_t size) {
+  return write(fd, src, size) == static_cast<ssize_t>(size);
+}
+
+uint32_t ReadUint32(const bytes& src, size_t offset) {
+  return (src.at(offset) << 24) + (src.at(offset + 1) << 16) +
+         (src.at(offset + 2) << 8) + src.at(offset + 3);
+}
+
+void WriteUint32(bytes& dst, size_t offset, uint32_t value) {
+  for (unsigned int i = 0; i < 4; i++) {
+    dst.at(offset + i) = (value >> (24 - 8 * i)) & 0xFF;
+  }
+}
+
+VectorOfNode NetworkPeers(const vector<PairOfKey>& keys,
+                          const vector<Peer>& peers, unsigned int node,
+                          unsigned int networkSize) {
+  VectorOfNode network;
+  for (unsigned int i = 0; i < networkSize; i++) {
+    if (i != node) {
+      network.emplace_back(keys.at(i).second, peers.at(i));
+    }
+  }
+  return network;
+}
+
+vector<PubKey> NetworkKeys(const vector<PairOfKey>& keys,
+                           unsigned int networkSize) {
+  vector<PubKey> networkKeys;
+  for (unsigned int i = 0; i < networkSize; i++) {
+    networkKeys.emplace_back(keys.at(i).second);
+  }
+  return networkKeys;
+}
+
+/// Body of a receiver process: listens with P2PComm, counts the messages of
+/// the current case, and runs the commands until commandFd is closed
+[[noreturn]] void RunReceiver(unsigned int node, const vector<PairOfKey>& keys,
+                              const vector<Peer>& peers, int commandFd,
+                              int reportFd) {
+  // Only the benchmark writes to stdout
+  if (freopen("/dev/null", "w", stdout) == nullptr) {
+    _exit(ERROR_UNEXPECTED);
+  }
+  INIT_STDOUT_LOGGER();
+
+  P2PComm& p2p = P2PComm::GetInstance();
+  p2p.SetSelfPeer(peers.at(node));
+  p2p.SetSelfKey(keys.at(node));
+
+  mutex mutexCase;
+  Command current{numeric_limits<uint32_t>::max(), 0, 0, 0};
+  uint32_t received = 0;
+  uint64_t receivedBytes = 0;
+
+  auto dispatcher = [&](pair<bytes, Peer>* message) {
+    if (message->first.size() >= sizeof(uint32_t)) {
+      lock_guard<mutex> g(mutexCase);
+      if (ReadUint32(message->first, 0) == current.m_caseId) {
+        receivedBytes += message->first.size();
+        if (++received == current.m_expected) {
+          const Report report{current.m_caseId, node, REPORT_DONE,
+                              receivedBytes};
+          WriteFull(reportFd, &report, sizeof(report));
+        }
+      }
+    }
+    MessagePool::GetInstance().Release(message);
+  };
+  auto broadcastListFunc = [](unsigned char, unsigned char, const Peer&) {
+    return vector<Peer>();
+  };
+  DetachedFunction(1, [&]() {
+    p2p.StartMessagePump(peers.at(node).m_listenPortHost, dispatcher,
+                         broadcastListFunc);
+  });
+
+  Command command;
+  while (ReadFull(commandFd, &command, sizeof(command))) {
+    {
+      lock_guard<mutex> g(mutexCase);
+      current = command;
+      received = 0;
+      receivedBytes = 0;
+    }
+    if (command.m_gossip) {
+      p2p.InitializeRumorManager(
+          NetworkPeers(keys, peers, node, command.m_networkSize),
+          NetworkKeys(keys, command.m_networkSize));
+    }
+    const Report report{command.m_caseId, node, REPORT_READY, 0};
+    WriteFull(reportFd, &report, sizeof(report));
+  }
+  _exit(SUCCESS);
+}
+
+/// Waits for count reports of kind for caseId, or until the deadline.
+/// Returns how many came, and adds up their bytes.
+unsigned int WaitForReports(int reportFd, uint32_t caseId, ReportKind kind,
+                            unsigned int count,
+                            chrono::steady_clock::time_point deadline,
+                            uint64_t& totalBytes) {
+  unsigned int arrived = 0;
+  while (arrived < count) {
+    const auto left = chrono::duration_cast<chrono::milliseconds>(
+        deadline - chrono::steady_clock::now());
+    if (left.count() <= 0) {
+      break;
+    }
+    pollfd fd{reportFd, POLLIN, 0};
+    if (poll(&fd, 1, left.count()) <= 0) {
+      continue;
+    }
+    Report report;
+    if (!ReadFull(reportFd, &report, sizeof(report))) {
+      break;
+    }
+    // Late reports of a case that timed out are dropped
+    if ((report.m_caseId == caseId) && (report.m_kind == kind)) {
+      arrived++;
+      totalBytes += report.m_bytes;
+    }
+  }
+  return arrived;
+}
+
+bool ParseList(const string& str, vector<unsigned int>& values) {
+  stringstream ss(str);
+  string item;
+  while (getline(ss, item, ',')) {
+    try {
+      const unsigned long value = stoul(item);
+      if (value == 0 || value > numeric_limits<uint32_t>::max()) {
+        return false;
+      }
+      values.emplace_back(value);
+    } catch (exception&) {
+      return false;
+    }
+  }
+  return !values.empty();
+}
+}  // namespace
+
+/// Measures P2PComm over loopback: the benchmark process sends, and one
+/// forked process per receiver listens with its own P2PComm, which is a
+/// singleton. Each case sends a number of messages of one size to fanout
+/// receivers, with SendMessage, SendBroadcastMessage or gossip, and times
+/// until every receiver got all of them.
+int main(int argc, const char* argv[]) {
+  try {
+    string strModes;
+    string strSizes;
+    string strFanouts;
+    unsigned int numMessages = 0;
+    unsigned int maxCaseInMB = 0;
+    unsigned int basePort = 0;
+    string strAddress;
+    unsigned int timeoutInSeconds = 0;
+    string strResultName;
+
+    po::options_description desc("Options");
+
+    desc.add_options()("help,h", "Print help messages")(
+        "modes",
+        po::value<string>(&strModes)->default_value("send,broadcast,gossip"),
+        "comma-separated send modes: send, broadcast, gossip")(
+        "sizes",
+        po::value<string>(&strSizes)->default_value(
+            "100,10000,1000000,5000000"),
+        "comma-separated message sizes in bytes")(
+        "fanouts", po::value<string>(&strFanouts)->default_value("1,10,100"),
+        "comma-separated numbers of receivers")(
+        "messages", po::value<unsigned int>(&numMessages)->default_value(100),
+        "messages per case")(
+        "max-case-mb",
+        po::value<unsigned int>(&maxCaseInMB)->default_value(1000),
+        "fewer messages are sent when a case would deliver more than this")(
+        "address",
+        po::value<string>(&strAddress)->default_value("127.0.0.1"),
+        "local address all nodes listen on, e.g. of a veth pair")(
+        "base-port", po::value<unsigned int>(&basePort)->default_value(40000),
+        "port of the sender; receiver i listens on base-port + i")(
+        "timeout-s",
+        po::value<unsigned int>(&timeoutInSeconds)->default_value(60),
+        "time limit of each case")(
+        "result-file-name,r", po::value<string>(&strResultName),
+        "also write the json result into this file");
+
+    po::variables_map vm;
+    try {
+      po::store(po::parse_command_line(argc, argv, desc), vm);
+
+      /** --help option
+       */
+      if (vm.count("help")) {
+        cout << desc << endl;
+        return SUCCESS;
+      }
+      po::notify(vm);
+    } catch (boost::program_options::error& e) {
+      cerr << "ERROR: " << e.what() << endl << endl;
+      return ERROR_IN_COMMAND_LINE;
+    }
+
+    vector<string> modes;
+    {
+      stringstream ss(strModes);
+      string mode;
+      while (getline(ss, mode, ',')) {
+        if (mode != "send" && mode != "broadcast" && mode != "gossip") {
+          cerr << "ERROR: unknown mode " << mode << endl;
+          return ERROR_IN_COMMAND_LINE;
+        }
+        modes.emplace_back(mode);
+      }
+    }
+    vector<unsigned int> sizes;
+    vector<unsigned int> fanouts;
+    if (!ParseList(strSizes, sizes) || !ParseList(strFanouts, fanouts)) {
+      cerr << "ERROR: sizes and fanouts must be positive numbers" << endl;
+      return ERROR_IN_COMMAND_LINE;
+    }
+    const unsigned int numReceivers =
+        *max_element(fanouts.begin(), fanouts.end());
+    if (modes.empty() || numMessages == 0 ||
+        basePort + numReceivers > numeric_limits<uint16_t>::max()) {
+      cerr << "ERROR: need a mode, a message and ports for all receivers"
+           << endl;
+      return ERROR_IN_COMMAND_LINE;
+    }
+    struct in_addr ipAddr;
+    if (inet_pton(AF_INET, strAddress.c_str(), &ipAddr) != 1) {
+      cerr << "ERROR: invalid address " << strAddress << endl;
+      return ERROR_IN_COMMAND_LINE;
+    }
+
+    // Keys and peers of node 0 (this process) and of every receiver
+    vector<PairOfKey> keys;
+    vector<Peer> peers;
+    for (unsigned int i = 0; i <= numReceivers; i++) {
+      keys.emplace_back(Schnorr::GetInstance().GenKeyPair());
+      peers.emplace_back(ipAddr.s_addr, basePort + i);
+    }
+
+    // Fork before this process starts any thread
+    int reportPipe[2];
+    if (pipe(reportPipe) != 0) {
+      cerr << "ERROR: failed to create a pipe" << endl;
+      return ERROR_UNEXPECTED;
+    }
+    vector<int> commandFds;
+    vector<pid_t> children;
+    for (unsigned int node = 1; node <= numReceivers; node++) {
+      int commandPipe[2];
+      if (pipe(commandPipe) != 0) {
+        cerr << "ERROR: failed to create a pipe" << endl;
+        return ERROR_UNEXPECTED;
+      }
+      const pid_t pid = fork();
+      if (pid < 0) {
+        cerr << "ERROR: failed to fork receiver " << node << endl;
+        return ERROR_UNEXPECTED;
+      }
+      if (pid == 0) {
+        close(commandPipe[1]);
+        close(reportPipe[0]);
+        // The parent's ends towards earlier receivers stay with the parent
+        for (const auto& fd : commandFds) {
+          close(fd);
+        }
+        RunReceiver(node, keys, peers, commandPipe[0], reportPipe[1]);
+      }
+      close(commandPipe[0]);
+      commandFds.emplace_back(commandPipe[1]);
+      children.emplace_back(pid);
+    }
+    close(reportPipe[1]);
+
+    // Keep stdout for the result
+    INIT_FILE_LOGGER("benchmark");
+
+    P2PComm& p2p = P2PComm::GetInstance();
+    p2p.SetSelfPeer(peers.at(0));
+    p2p.SetSelfKey(keys.at(0));
+    // The sender listens too, for the pulls of gossip
+    DetachedFunction(1, [&p2p, &peers]() {
+      p2p.StartMessagePump(
+          peers.at(0).m_listenPortHost,
+          [](pair<bytes, Peer>* message) {
+            MessagePool::GetInstance().Release(message);
+          },
+          [](unsigned char, unsigned char, const Peer&) {
+            return vector<Peer>();
+          });
+    });
+    // Short delay for the listeners to come up
+    this_thread::sleep_for(chrono::seconds(1));
+
+    Json::Value result;
+    result["address"] = strAddress;
+    uint32_t caseId = 0;
+
+    for (const auto& mode : modes) {
+      const bool gossip = (mode == "gossip");
+      for (const auto& fanout : fanouts) {
+        for (const auto& size : sizes) {
+          Json::Value entry;
+          entry["mode"] = mode;
+          entry["fanout"] = fanout;
+          entry["message_bytes"] = size;
+
+          // Rumors carry a key and signature on top of the message
+          if (gossip && size + 2 * HDR_LEN + PUB_KEY_SIZE +
+                                SIGNATURE_CHALLENGE_SIZE +
+                                SIGNATURE_RESPONSE_SIZE >=
+                            MAX_GOSSIP_MSG_SIZE_IN_BYTES) {
+            entry["skipped"] = "above MAX_GOSSIP_MSG_SIZE_IN_BYTES";
+            result["cases"].append(entry);
+            continue;
+          }
+
+          const uint64_t maxCaseBytes = (uint64_t)maxCaseInMB * 1024 * 1024;
+          const unsigned int messages = max<uint64_t>(
+              1, min<uint64_t>(numMessages,
+                               maxCaseBytes / ((uint64_t)size * fanout)));
+          entry["messages"] = messages;
+          caseId++;
+
+          const Command command{caseId, messages, fanout + 1, gossip};
+          for (unsigned int node = 1; node <= fanout; node++) {
+            WriteFull(commandFds.at(node - 1), &command, sizeof(command));
+          }
+          if (gossip) {
+            p2p.InitializeRumorManager(NetworkPeers(keys, peers, 0, fanout + 1),
+                                       NetworkKeys(keys, fanout + 1));
+          }
+          uint64_t ignored = 0;
+          const auto deadline = chrono::steady_clock::now() +
+                                chrono::seconds(timeoutInSeconds);
+          if (WaitForReports(reportPipe[0], caseId, REPORT_READY, fanout,
+                             deadline, ignored) < fanout) {
+            entry["error"] = "receivers did not get ready";
+            result["cases"].append(entry);
+            continue;
+          }
+
+          // Every message is distinct, as broadcasts and rumors of the same
+          // content are dropped as duplicates
+          vector<bytes> bodies(messages, bytes(max(size, 8u)));
+          for (unsigned int i = 0; i < messages; i++) {
+            WriteUint32(bodies.at(i), 0, caseId);
+            WriteUint32(bodies.at(i), 4, i);
+          }
+          const vector<Peer> targets(peers.begin() + 1,
+                                     peers.begin() + 1 + fanout);
+
+          auto startTime = r_timer_start();
+          for (const auto& body : bodies) {
+            if (mode == "send") {
+              p2p.SendMessage(targets, body);
+            } else if (mode == "broadcast") {
+              p2p.SendBroadcastMessage(targets, body);
+            } else {
+              p2p.SpreadRumor(body);
+            }
+          }
+          uint64_t deliveredBytes = 0;
+          const unsigned int done =
+              WaitForReports(reportPipe[0], caseId, REPORT_DONE, fanout,
+                             deadline, deliveredBytes);
+          const double elapsedInUs = r_timer_end(startTime);
+
+          entry["receivers_done"] = done;
+          entry["elapsed_ms"] = elapsedInUs / 1000;
+          if (done == fanout && elapsedInUs > 0) {
+            entry["messages_per_second"] =
+                (double)messages * fanout * 1000000 / elapsedInUs;
+            entry["mb_per_second"] =
+                deliveredBytes / (1024.0 * 1024) * 1000000 / elapsedInUs;
+          }
+          result["cases"].append(entry);
+        }
+      }
+    }
+
+    // Closing the command pipes ends the receivers
+    for (const auto& fd : commandFds) {
+      close(fd);
+    }
+    for (const auto& pid : children) {
+      waitpid(pid, nullptr, 0);
+    }
+
+    Json::StreamWriterBuilder writeBuilder;
+    const string output = Json::writeString(writeBuilder, result);
+    cout << output << endl;
+
+    if (!strResultName.empty()) {
+      ofstream fs(strResultName, ofstream::out);
+      if (!fs.is_open()) {
+        cerr << "Failed to open file " << strResultName << endl;
+        return ERROR_UNEXPECTED;
+      }
+      fs << output << endl;
+    }
+
+    // P2PComm cannot stop its threads, so leave without running the static
+    // destructors underneath them
+    cout.flush();
+    _exit(SUCCESS);
+  } catch (exception& e) {
+    cerr << "Unhandled Exception reached the top of main: " << e.what()
+         << ", application will now exit" << endl;
+    return ERROR_UNHANDLED_EXCEPTION;
+  }
+
+  return SUCCESS;
+}
@@ -0,0 +1,476 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <json/json.h>
+#include <boost/program_options.hpp>
+
+#include "common/Constants.h"
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-variable"
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+#include "depends/libDatabase/OverlayDB.h"
+#include "depends/libTrie/TrieDB.h"
+#pragma GCC diagnostic pop
+#include "libCrypto/Schnorr.h"
+#include "libData/AccountData/Transaction.h"
+#include "libData/AccountData/TransactionReceipt.h"
+#include "libData/BlockData/Block/MicroBlock.h"
+#include "libPersistence/BlockStorage.h"
+#include "libTestUtils/TestUtils.h"
+#include "libUtils/Logger.h"
+#include "libUtils/TimeUtils.h"
+
+namespace po = boost::program_options;
+
+#define SUCCESS 0
+#define ERROR_IN_COMMAND_LINE -1
+#define ERROR_UNHANDLED_EXCEPTION -2
+#define ERROR_UNEXPECTED -3
+
+using namespace std;
+
+namespace {
+struct Settings {
+  unsigned int m_entries = 0;
+  unsigned int m_ops = 0;
+  double m_readRatio = 0;
+  string m_distribution;
+  double m_hotFraction = 0;
+  unsigned int m_shards = 0;
+  unsigned int m_txnsPerMicroBlock = 0;
+  unsigned int m_rangeEpochs = 0;
+  unsigned int m_valueBytes = 0;
+  bool m_skipFill = false;
+  bool m_fillOnly = false;
+  uint32_t m_seed = 0;
+};
+
+/// Latency percentiles, in us, of one kind of operation
+Json::Value Summarize(vector<double>& latencies, bool ok) {
+  Json::Value result;
+  result["count"] = static_cast<Json::UInt64>(latencies.size());
+  result["ok"] = ok;
+  if (latencies.empty()) {
+    return result;
+  }
+
+  sort(latencies.begin(), latencies.end());
+  double total = 0;
+  for (const auto& latency : latencies) {
+    total += latency;
+  }
+  auto percentile = [&latencies](double p) {
+    return latencies.at(static_cast<size_t>(p * (latencies.size() - 1)));
+  };
+  result["ops_per_second"] = (total > 0) ? latencies.size() * 1e6 / total : 0;
+  result["mean_us"] = total / latencies.size();
+  result["p50_us"] = percentile(0.5);
+  result["p90_us"] = percentile(0.9);
+  result["p99_us"] = percentile(0.99);
+  result["p999_us"] = percentile(0.999);
+  result["max_us"] = latencies.back();
+  return result;
+}
+
+/// Picks which of count entries a read goes to. With "recent", the age of
+/// the entry is exponential with a mean of m_hotFraction of count, as reads
+/// of a chain mostly go to its latest blocks and txns.
+class KeyPicker {
+  mt19937 m_rng;
+  bool m_recent;
+  double m_hotFraction;
+
+ public:
+  KeyPicker(const Settings& settings, uint32_t salt)
+      : m_rng(settings.m_seed + salt),
+        m_recent(settings.m_distribution == "recent"),
+        m_hotFraction(settings.m_hotFraction) {}
+
+  uint64_t Pick(uint64_t count) {
+    if (!m_recent) {
+      return uniform_int_distribution<uint64_t>(0, count - 1)(m_rng);
+    }
+    const double age = exponential_distribution<double>(
+        1 / max(count * m_hotFraction, 1.0))(m_rng);
+    return count - 1 - min(static_cast<uint64_t>(age), count - 1);
+  }
+
+  bool IsRead(double readRatio) {
+    return uniform_real_distribution<double>(0, 1)(m_rng) < readRatio;
+  }
+};
+
+/// Keys derive from the index only, so --skip-fill finds what an earlier
+/// run stored
+dev::h256 EntryKey(const string& kind, uint64_t index) {
+  return dev::sha3(kind + ":" + to_string(index));
+}
+
+/// Runs ops reads of entries in [0, count) and writes of new entries, mixed
+/// by m_readRatio. read and write take the index and return false on error.
+template <class Read, class Write>
+Json::Value RunMix(const Settings& settings, uint32_t salt, uint64_t& count,
+                   Read read, Write write) {
+  KeyPicker picker(settings, salt);
+  vector<double> reads;
+  vector<double> writes;
+  bool readsOk = true;
+  bool writesOk = true;
+
+  for (unsigned int i = 0; i < settings.m_ops; i++) {
+    if ((count > 0) && picker.IsRead(settings.m_readRatio)) {
+      const uint64_t index = picker.Pick(count);
+      auto startTime = r_timer_start();
+      readsOk = read(index) && readsOk;
+      reads.emplace_back(r_timer_end(startTime));
+    } else {
+      auto startTime = r_timer_start();
+      writesOk = write(count) && writesOk;
+      writes.emplace_back(r_timer_end(startTime));
+      count++;
+    }
+  }
+
+  Json::Value result;
+  result["reads"] = Summarize(reads, readsOk);
+  result["writes"] = Summarize(writes, writesOk);
+  return result;
+}
+
+/// Times fill of count entries, one write each
+template <class Write>
+Json::Value RunFill(uint64_t count, Write write) {
+  vector<double> writes;
+  bool ok = true;
+  for (uint64_t i = 0; i < count; i++) {
+    auto startTime = r_timer_start();
+    ok = write(i) && ok;
+    writes.emplace_back(r_timer_end(startTime));
+  }
+  return Summarize(writes, ok);
+}
+
+Json::Value BenchTxBodies(const Settings& settings) {
+  Json::Value result;
+  if (!LOOKUP_NODE_MODE) {
+    result["skipped"] = "txn bodies are only stored with LOOKUP_NODE_MODE";
+    return result;
+  }
+
+  // A few real bodies, stored under many keys; GetTxBody parses them all
+  vector<bytes> bodies;
+  for (unsigned int i = 0; i < 16; i++) {
+    const TransactionWithReceipt twr(
+        Transaction(0, i, Address(), Schnorr::GetInstance().GenKeyPair(), 0,
+                    1, 2, {}, TestUtils::GenerateRandomCharVector(
+                                  settings.m_valueBytes)),
+        TransactionReceipt());
+    bodies.emplace_back();
+    twr.Serialize(bodies.back(), 0);
+  }
+
+  BlockStorage& storage = BlockStorage::GetBlockStorage();
+  auto write = [&storage, &bodies](uint64_t index) {
+    return storage.PutTxBody(EntryKey("txBody", index),
+                             bodies.at(index % bodies.size()));
+  };
+  auto read = [&storage](uint64_t index) {
+    TxBodySharedPtr body;
+    return storage.GetTxBody(EntryKey("txBody", index), body);
+  };
+
+  uint64_t count = settings.m_entries;
+  if (!settings.m_skipFill) {
+    storage.ResetDB(BlockStorage::TX_BODY);
+    storage.ResetDB(BlockStorage::TX_BODY_TMP);
+    result["fill"] = RunFill(count, write);
+  }
+  if (settings.m_fillOnly) {
+    return result;
+  }
+  result["first_pass"] = RunMix(settings, 1, count, read, write);
+  result["second_pass"] = RunMix(settings, 1, count, read, write);
+  return result;
+}
+
+Json::Value BenchMicroBlocks(const Settings& settings) {
+  vector<TxnHash> tranHashes;
+  for (unsigned int i = 0; i < settings.m_txnsPerMicroBlock; i++) {
+    tranHashes.emplace_back(EntryKey("txn", i));
+  }
+  const MicroBlock microBlock(TestUtils::GenerateRandomMicroBlockHeader(),
+                              tranHashes, CoSignatures());
+  bytes body;
+  microBlock.Serialize(body, 0);
+
+  // Entry i is the microblock of shard i % m_shards in epoch i / m_shards
+  BlockStorage& storage = BlockStorage::GetBlockStorage();
+  const unsigned int shards = settings.m_shards;
+  auto write = [&storage, &body, shards](uint64_t index) {
+    return storage.PutMicroBlock(EntryKey("microBlock", index), index / shards,
+                                 index % shards, body);
+  };
+  auto read = [&storage](uint64_t index) {
+    MicroBlockSharedPtr block;
+    return storage.GetMicroBlock(EntryKey("microBlock", index), block);
+  };
+
+  Json::Value result;
+  uint64_t count = settings.m_entries;
+  if (!settings.m_skipFill) {
+    storage.ResetDB(BlockStorage::MICROBLOCK);
+    result["fill"] = RunFill(count, write);
+  }
+  if (settings.m_fillOnly) {
+    return result;
+  }
+  result["first_pass"] = RunMix(settings, 2, count, read, write);
+  result["second_pass"] = RunMix(settings, 2, count, read, write);
+
+  // Range scans of m_rangeEpochs epochs over all shards, like the explorer
+  // queries of a lookup
+  const uint64_t epochs = max<uint64_t>(count / shards, 1);
+  KeyPicker picker(settings, 3);
+  vector<double> scans;
+  bool ok = true;
+  for (unsigned int i = 0; i < max(settings.m_ops / 100, 1u); i++) {
+    const uint64_t hiEpoch = picker.Pick(epochs);
+    const uint64_t loEpoch =
+        hiEpoch - min<uint64_t>(hiEpoch, settings.m_rangeEpochs - 1);
+    vector<MicroBlockSharedPtr> blocks;
+    auto startTime = r_timer_start();
+    ok = storage.GetRangeMicroBlocks(loEpoch, hiEpoch, 0, shards - 1,
+                                     blocks) &&
+         ok;
+    scans.emplace_back(r_timer_end(startTime));
+  }
+  result["range_scans"] = Summarize(scans, ok);
+  result["range_scans"]["epochs"] = settings.m_rangeEpochs;
+  return result;
+}
+
+Json::Value CacheStats(const dev::OverlayDB& db) {
+  const dev::NodeCache::Stats stats = db.cacheStats();
+  Json::Value result;
+  result["hits"] = static_cast<Json::UInt64>(stats.m_hits);
+  result["negative_hits"] = static_cast<Json::UInt64>(stats.m_negativeHits);
+  result["misses"] = static_cast<Json::UInt64>(stats.m_misses);
+  return result;
+}
+
+/// A state-like trie: hashed 32-byte keys over an OverlayDB, values of
+/// m_valueBytes. The first pass runs on a freshly opened db, so it starts
+/// with cold LevelDB and node caches; the second one runs warm.
+Json::Value BenchTrie(const Settings& settings) {
+  const string dbName = "benchmarkTrie";
+  const dev::h256 rootKey = dev::sha3(string("benchmarkTrieRoot"));
+  const bytes value =
+      TestUtils::GenerateRandomCharVector(settings.m_valueBytes);
+
+  auto db = make_unique<dev::OverlayDB>(dbName);
+  auto trie = make_unique<dev::GenericTrieDB<dev::OverlayDB>>(db.get());
+  auto write = [&trie, &value](uint64_t index) {
+    trie->insert(EntryKey("trie", index).asBytes(), value);
+    return true;
+  };
+  auto read = [&trie, &value](uint64_t index) {
+    return trie->at(EntryKey("trie", index).asBytes()).size() == value.size();
+  };
+  // Commits the trie and keeps its root for --skip-fill
+  auto commit = [&db, &trie, &rootKey]() {
+    const bytes root = trie->root().asBytes();
+    db->insert(rootKey, &root);
+    auto startTime = r_timer_start();
+    db->commit();
+    return r_timer_end(startTime) / 1000;
+  };
+
+  Json::Value result;
+  uint64_t count = settings.m_entries;
+  if (settings.m_skipFill) {
+    const string root = db->lookup(rootKey);
+    if (root.size() != dev::h256::size) {
+      result["error"] = "no trie stored by an earlier run";
+      return result;
+    }
+    trie->setRoot(dev::h256(bytes(root.begin(), root.end())));
+  } else {
+    db->ResetDB();
+    trie->init();
+    result["fill"] = RunFill(count, write);
+    result["fill"]["commit_ms"] = commit();
+  }
+  if (settings.m_fillOnly) {
+    return result;
+  }
+
+  // Reopen, so that nothing read so far is cached
+  const dev::h256 root = trie->root();
+  trie.reset();
+  db.reset();
+  db = make_unique<dev::OverlayDB>(dbName);
+  trie = make_unique<dev::GenericTrieDB<dev::OverlayDB>>(db.get());
+  trie->setRoot(root);
+
+  result["first_pass"] = RunMix(settings, 4, count, read, write);
+  result["first_pass"]["commit_ms"] = commit();
+  result["first_pass"]["node_cache"] = CacheStats(*db);
+  result["second_pass"] = RunMix(settings, 4, count, read, write);
+  result["second_pass"]["commit_ms"] = commit();
+  result["second_pass"]["node_cache"] = CacheStats(*db);
+  return result;
+}
+}  // namespace
+
+/// Measures BlockStorage and trie reads and writes over databases of a
+/// chosen size. A run fills the databases, then does two passes of mixed
+/// reads and writes. --fill-only and then --skip-fill, in a new process,
+/// give cold start numbers for BlockStorage.
+int main(int argc, const char* argv[]) {
+  try {
+    Settings settings;
+    string strWorkloads;
+    string strResultName;
+
+    po::options_description desc(
+        "Options (the databases under the storage path are reset unless "
+        "--skip-fill is given)");
+
+    desc.add_options()("help,h", "Print help messages")(
+        "entries,n",
+        po::value<unsigned int>(&settings.m_entries)->default_value(10000),
+        "entries stored per workload before the passes")(
+        "ops", po::value<unsigned int>(&settings.m_ops)->default_value(10000),
+        "operations per pass")(
+        "read-ratio",
+        po::value<double>(&settings.m_readRatio)->default_value(0.9),
+        "share of reads in a pass, the rest writes new entries")(
+        "distribution",
+        po::value<string>(&settings.m_distribution)->default_value("recent"),
+        "keys read: uniform, or recent to favour the latest entries")(
+        "hot-fraction",
+        po::value<double>(&settings.m_hotFraction)->default_value(0.1),
+        "mean age of a recent read, as a share of the entries")(
+        "shards", po::value<unsigned int>(&settings.m_shards)->default_value(4),
+        "microblocks per epoch")(
+        "txns-per-microblock",
+        po::value<unsigned int>(&settings.m_txnsPerMicroBlock)
+            ->default_value(100),
+        "txn hashes in each microblock")(
+        "range-epochs",
+        po::value<unsigned int>(&settings.m_rangeEpochs)->default_value(10),
+        "epochs per microblock range scan")(
+        "value-bytes",
+        po::value<unsigned int>(&settings.m_valueBytes)->default_value(100),
+        "size of trie values and of txn data")(
+        "workloads",
+        po::value<string>(&strWorkloads)
+            ->default_value("txbody,microblock,trie"),
+        "comma-separated workloads to run")(
+        "skip-fill", po::bool_switch(&settings.m_skipFill),
+        "use the entries stored by an earlier run with the same --entries")(
+        "fill-only", po::bool_switch(&settings.m_fillOnly),
+        "only fill the databases")(
+        "seed", po::value<uint32_t>(&settings.m_seed)->default_value(1),
+        "seed of the key choice")(
+        "result-file-name,r", po::value<string>(&strResultName),
+        "also write the json result into this file");
+
+    po::variables_map vm;
+    try {
+      po::store(po::parse_command_line(argc, argv, desc), vm);
+
+      /** --help option
+       */
+      if (vm.count("help")) {
+        cout << desc << endl;
+        return SUCCESS;
+      }
+      po::notify(vm);
+    } catch (boost::program_options::error& e) {
+      cerr << "ERROR: " << e.what() << endl << endl;
+      return ERROR_IN_COMMAND_LINE;
+    }
+
+    if ((settings.m_distribution != "uniform") &&
+        (settings.m_distribution != "recent")) {
+      cerr << "ERROR: distribution must be uniform or recent" << endl;
+      return ERROR_IN_COMMAND_LINE;
+    }
+    if ((settings.m_readRatio < 0) || (settings.m_readRatio > 1) ||
+        (settings.m_hotFraction <= 0) || (settings.m_shards == 0) ||
+        (settings.m_rangeEpochs == 0)) {
+      cerr << "ERROR: need a read ratio in [0, 1], a positive hot fraction, "
+              "shards and range epochs"
+           << endl;
+      return ERROR_IN_COMMAND_LINE;
+    }
+    if (settings.m_skipFill && settings.m_fillOnly) {
+      cerr << "ERROR: --skip-fill and --fill-only exclude each other" << endl;
+      return ERROR_IN_COMMAND_LINE;
+    }
+
+    // Keep stdout for the result
+    INIT_FILE_LOGGER("benchmark");
+
+    Json::Value result;
+    result["entries"] = settings.m_entries;
+    result["ops"] = settings.m_ops;
+    result["read_ratio"] = settings.m_readRatio;
+    result["distribution"] = settings.m_distribution;
+    result["skip_fill"] = settings.m_skipFill;
+
+    const string workloads = "," + strWorkloads + ",";
+    if (workloads.find(",txbody,") != string::npos) {
+      result["txbody"] = BenchTxBodies(settings);
+    }
+    if (workloads.find(",microblock,") != string::npos) {
+      result["microblock"] = BenchMicroBlocks(settings);
+    }
+    if (workloads.find(",trie,") != string::npos) {
+      result["trie"] = BenchTrie(settings);
+    }
+
+    Json::StreamWriterBuilder writeBuilder;
+    const string output = Json::writeString(writeBuilder, result);
+    cout << output << endl;
+
+    if (!strResultName.empty()) {
+      ofstream fs(strResultName, ofstream::out);
+      if (!fs.is_open()) {
+        cerr << "Failed to open file " << strResultName << endl;
+        return ERROR_UNEXPECTED;
+      }
+      fs << output << endl;
+    }
+  } catch (exception& e) {
+    cerr << "Unhandled Exception reached the top of main: " << e.what()
+         << ", application will now exit" << endl;
+    return ERROR_UNHANDLED_EXCEPTION;
+  }
+
+  return SUCCESS;
+}
@@ -0,0 +1,231 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <json/json.h>
+#include <boost/program_options.hpp>
+
+#include "libData/AccountData/AccountStore.h"
+#include "libDirectoryService/DirectoryService.h"
+#include "libLookup/Lookup.h"
+#include "libMediator/Mediator.h"
+#include "libNode/Node.h"
+#include "libTestUtils/TestUtils.h"
+#include "libUtils/DataConversion.h"
+#include "libUtils/Logger.h"
+#include "libUtils/TimeUtils.h"
+#include "libValidator/Validator.h"
+
+namespace po = boost::program_options;
+
+#define SUCCESS 0
+#define ERROR_IN_COMMAND_LINE -1
+#define ERROR_UNHANDLED_EXCEPTION -2
+#define ERROR_UNEXPECTED -3
+
+using namespace std;
+using namespace boost::multiprecision;
+
+namespace {
+/// Time taken by one phase, with its rate over count items
+Json::Value PhaseResult(double elapsedInUs, size_t count) {
+  Json::Value phase;
+  phase["elapsed_ms"] = elapsedInUs / 1000;
+  phase["count"] = static_cast<Json::UInt64>(count);
+  phase["per_second"] =
+      (elapsedInUs > 0) ? count * 1000000 / elapsedInUs : 0.0;
+  return phase;
+}
+
+/// Plain transfers from numSenders funded accounts, round robin, each
+/// sender's nonces in order
+vector<Transaction> GenerateTxns(unsigned int numTxns, unsigned int numSenders,
+                                 const uint128_t& gasPrice) {
+  vector<PairOfKey> senders;
+  for (unsigned int i = 0; i < numSenders; i++) {
+    senders.emplace_back(TestUtils::GenerateRandomKeyPair());
+    AccountStore::GetInstance().AddAccount(
+        Account::GetAddressFromPublicKey(senders.back().second),
+        {uint128_t(1) << 100, 0});
+  }
+  AccountStore::GetInstance().UpdateStateTrieAll();
+
+  vector<Transaction> txns;
+  txns.reserve(numTxns);
+  for (unsigned int i = 0; i < numTxns; i++) {
+    const Address toAddr =
+        Account::GetAddressFromPublicKey(TestUtils::GenerateRandomPubKey());
+    txns.emplace_back(DataConversion::Pack(CHAIN_ID, 1), i / numSenders + 1,
+                      toAddr, senders.at(i % numSenders), 1 + i, gasPrice,
+                      NORMAL_TRAN_GAS);
+  }
+  return txns;
+}
+}  // namespace
+
+/// Runs one shard epoch in-process: txns from a lookup go into the pool of
+/// a leader and a backup, the leader composes the microblock, the backup
+/// checks it, and the state delta is serialized and committed. Nothing is
+/// sent over the network, as neither node is started.
+int main(int argc, const char* argv[]) {
+  try {
+    unsigned int numTxns = 0;
+    unsigned int numSenders = 0;
+    string strResultName;
+
+    po::options_description desc("Options");
+
+    desc.add_options()("help,h", "Print help messages")(
+        "txns,t", po::value<unsigned int>(&numTxns)->default_value(10000),
+        "number of transactions")(
+        "senders,s", po::value<unsigned int>(&numSenders)->default_value(1000),
+        "number of sending accounts")(
+        "result-file-name,r", po::value<string>(&strResultName),
+        "also write the json result into this file");
+
+    po::variables_map vm;
+    try {
+      po::store(po::parse_command_line(argc, argv, desc), vm);
+
+      /** --help option
+       */
+      if (vm.count("help")) {
+        cout << desc << endl;
+        return SUCCESS;
+      }
+      po::notify(vm);
+    } catch (boost::program_options::error& e) {
+      cerr << "ERROR: " << e.what() << endl << endl;
+      return ERROR_IN_COMMAND_LINE;
+    }
+
+    if (numTxns == 0 || numSenders == 0) {
+      cerr << "ERROR: need at least one transaction and one sender" << endl;
+      return ERROR_IN_COMMAND_LINE;
+    }
+
+    // Keep stdout for the result
+    INIT_FILE_LOGGER("benchmark");
+
+    Mediator mediator(TestUtils::GenerateRandomKeyPair(), Peer());
+    DirectoryService ds(mediator);
+    Node leader(mediator, 0, false);
+    Node backup(mediator, 0, false);
+    Lookup lookup(mediator);
+    Validator validator(mediator);
+    mediator.RegisterColleagues(&ds, &leader, &lookup, &validator);
+    mediator.m_currentEpochNum = 1;
+    ds.m_shards.emplace_back(TestUtils::GenerateRandomShard(1));
+
+    AccountStore::GetInstance().Init();
+
+    const vector<Transaction> txns = GenerateTxns(
+        numTxns, numSenders,
+        mediator.m_dsBlockChain.GetLastBlockPtr()->GetHeader().GetGasPrice());
+
+    Json::Value result;
+    result["txns"] = numTxns;
+    result["senders"] = numSenders;
+
+    // Ingestion, as for a txn packet from a lookup
+    auto startTime = r_timer_start();
+    const unsigned int accepted = leader.AddTxnsFromLookup(txns);
+    result["ingestion"] = PhaseResult(r_timer_end(startTime), txns.size());
+    result["ingestion"]["accepted"] = accepted;
+    backup.AddTxnsFromLookup(txns);
+
+    // Microblock composition by the shard leader
+    AccountStore::GetInstance().InitTemp();
+    startTime = r_timer_start();
+    leader.ProcessTransactionWhenShardLeader();
+    const double processInUs = r_timer_end(startTime);
+
+    startTime = r_timer_start();
+    if (!AccountStore::GetInstance().SerializeDelta()) {
+      cerr << "ERROR: leader failed to serialize the state delta" << endl;
+      return ERROR_UNEXPECTED;
+    }
+    const double serializeInUs = r_timer_end(startTime);
+    bytes stateDelta;
+    AccountStore::GetInstance().GetSerializedDelta(stateDelta);
+    const StateHash leaderDeltaHash =
+        AccountStore::GetInstance().GetStateDeltaHash();
+
+    startTime = r_timer_start();
+    if (!leader.ComposeMicroBlock()) {
+      cerr << "ERROR: leader failed to compose the microblock" << endl;
+      return ERROR_UNEXPECTED;
+    }
+    const vector<TxnHash>& tranHashes = leader.m_microblock->GetTranHashes();
+    result["composition"] =
+        PhaseResult(processInUs + r_timer_end(startTime), tranHashes.size());
+
+    // Microblock validation by a shard backup, from the same temp state
+    AccountStore::GetInstance().InitTemp();
+    vector<TxnHash> missingTxnHashes;
+    startTime = r_timer_start();
+    const bool backupOk = backup.ProcessTransactionWhenShardBackup(
+        tranHashes, missingTxnHashes);
+    result["validation"] =
+        PhaseResult(r_timer_end(startTime), tranHashes.size());
+    result["validation"]["ok"] = backupOk && missingTxnHashes.empty();
+
+    if (!AccountStore::GetInstance().SerializeDelta()) {
+      cerr << "ERROR: backup failed to serialize the state delta" << endl;
+      return ERROR_UNEXPECTED;
+    }
+    result["validation"]["delta_match"] =
+        AccountStore::GetInstance().GetStateDeltaHash() == leaderDeltaHash;
+
+    result["delta_serialization"] =
+        PhaseResult(serializeInUs, tranHashes.size());
+    result["delta_serialization"]["bytes"] =
+        static_cast<Json::UInt64>(stateDelta.size());
+
+    // Commit to the state, then to disk
+    startTime = r_timer_start();
+    AccountStore::GetInstance().CommitTemp();
+    result["commit"] = PhaseResult(r_timer_end(startTime), tranHashes.size());
+
+    startTime = r_timer_start();
+    const bool persisted = AccountStore::GetInstance().MoveUpdatesToDisk();
+    result["persist"] = PhaseResult(r_timer_end(startTime), tranHashes.size());
+    result["persist"]["ok"] = persisted;
+
+    Json::StreamWriterBuilder writeBuilder;
+    const string output = Json::writeString(writeBuilder, result);
+    cout << output << endl;
+
+    if (!strResultName.empty()) {
+      ofstream fs(strResultName, ofstream::out);
+      if (!fs.is_open()) {
+        cerr << "Failed to open file " << strResultName << endl;
+        return ERROR_UNEXPECTED;
+      }
+      fs << output << endl;
+    }
+  } catch (exception& e) {
+    cerr << "Unhandled Exception reached the top of main: " << e.what()
+         << ", application will now exit" << endl;
+    return ERROR_UNHANDLED_EXCEPTION;
+  }
+  return SUCCESS;
+}
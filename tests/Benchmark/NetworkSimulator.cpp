@@ -0,0 +1,154 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "NetworkSimulator.h"
+
+#include <algorithm>
+
+#include "libNetwork/P2PComm.h"
+#include "libUtils/Logger.h"
+
+using namespace std;
+
+NetworkSimulator::NetworkSimulator(uint32_t seed, unsigned int gossipFanout)
+    : m_rng(seed), m_gossipFanout(max(gossipFanout, 1u)) {
+  P2PComm::GetInstance().SetTransport(
+      [this](const Peer& peer, const bytes& message,
+             [[gnu::unused]] unsigned char startByte) {
+        OnSend(peer, message);
+      });
+}
+
+NetworkSimulator::~NetworkSimulator() {
+  P2PComm::GetInstance().SetTransport(nullptr);
+}
+
+size_t NetworkSimulator::AddNode(const Peer& peer, Handler handler) {
+  m_peerIndex.emplace(peer, m_peers.size());
+  m_peers.emplace_back(peer);
+  m_handlers.emplace_back(move(handler));
+  m_uplinkFreeAt.emplace_back(0);
+  return m_peers.size() - 1;
+}
+
+void NetworkSimulator::SetDefaultLink(const LinkParams& params) {
+  m_defaultLink = params;
+}
+
+void NetworkSimulator::SetLink(size_t from, size_t to,
+                               const LinkParams& params) {
+  m_links[{from, to}] = params;
+}
+
+void NetworkSimulator::Execute(size_t node, const function<void()>& action) {
+  m_current = node;
+  m_hasCurrent = true;
+  action();
+  m_hasCurrent = false;
+}
+
+double NetworkSimulator::Run() {
+  while (!m_events.empty()) {
+    const Event event = m_events.top();
+    m_events.pop();
+    m_now = event.m_time;
+    m_stats.m_delivered++;
+
+    if (event.m_tree) {
+      ForwardRumor(event);
+    }
+    Execute(event.m_to, [this, &event]() {
+      m_handlers.at(event.m_to)(*event.m_message, m_peers.at(event.m_from));
+    });
+  }
+  return m_now;
+}
+
+void NetworkSimulator::OnSend(const Peer& peer, const bytes& message) {
+  if (!m_hasCurrent) {
+    LOG_GENERAL(WARNING, "Message sent outside of a simulated node, dropped");
+    return;
+  }
+
+  const auto shared = make_shared<const bytes>(message);
+
+  // A rumor goes to everyone else down a tree rooted at the sender
+  if (peer == Peer()) {
+    auto tree = make_shared<vector<size_t>>();
+    for (size_t i = 0; i < m_peers.size(); i++) {
+      if (i != m_current) {
+        tree->emplace_back(i);
+      }
+    }
+    shuffle(tree->begin(), tree->end(), m_rng);
+    tree->insert(tree->begin(), m_current);
+
+    for (size_t i = 1; i <= m_gossipFanout && i < tree->size(); i++) {
+      Send(m_current, tree->at(i), shared, tree, i);
+    }
+    return;
+  }
+
+  const auto it = m_peerIndex.find(peer);
+  if ((it == m_peerIndex.end()) || (it->second == m_current)) {
+    return;
+  }
+  Send(m_current, it->second, shared, nullptr, 0);
+}
+
+void NetworkSimulator::Send(size_t from, size_t to,
+                            const shared_ptr<const bytes>& message,
+                            const shared_ptr<const vector<size_t>>& tree,
+                            size_t treeIndex) {
+  const LinkParams& link = GetLink(from, to);
+  m_stats.m_sent++;
+  m_stats.m_bytes += message->size();
+
+  const double start = max(m_now, m_uplinkFreeAt.at(from));
+  const double transmitMs =
+      (link.m_bandwidthMbps > 0)
+          ? message->size() * 8 / (link.m_bandwidthMbps * 1000)
+          : 0;
+  m_uplinkFreeAt.at(from) = start + transmitMs;
+
+  uniform_real_distribution<double> unit(0, 1);
+  double arrival =
+      start + transmitMs + link.m_latencyMs + unit(m_rng) * link.m_jitterMs;
+  while (unit(m_rng) < link.m_lossRate) {
+    m_stats.m_retransmitted++;
+    arrival += link.m_retransmitMs;
+  }
+  double& last = m_lastArrival[{from, to}];
+  arrival = max(arrival, last);
+  last = arrival;
+
+  m_events.push({arrival, m_seq++, from, to, message, tree, treeIndex});
+}
+
+void NetworkSimulator::ForwardRumor(const Event& event) {
+  const vector<size_t>& tree = *event.m_tree;
+  const size_t first = event.m_treeIndex * m_gossipFanout + 1;
+  for (size_t i = first; i < first + m_gossipFanout && i < tree.size(); i++) {
+    Send(event.m_to, tree.at(i), event.m_message, event.m_tree, i);
+  }
+}
+
+const NetworkSimulator::LinkParams& NetworkSimulator::GetLink(
+    size_t from, size_t to) const {
+  const auto it = m_links.find({from, to});
+  return (it == m_links.end()) ? m_defaultLink : it->second;
+}
@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __NETWORKSIMULATOR_H__
+#define __NETWORKSIMULATOR_H__
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <queue>
+#include <random>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "common/BaseType.h"
+#include "libNetwork/Peer.h"
+
+/// Discrete-event network for benchmarks. Takes over P2PComm's sends and
+/// delivers them to in-process handlers on one thread, in simulated time,
+/// delayed as configured per link. The same seed gives the same run.
+class NetworkSimulator {
+ public:
+  struct LinkParams {
+    double m_latencyMs = 50;
+    /// Uniform extra delay in [0, m_jitterMs)
+    double m_jitterMs = 0;
+    /// Uplink rate of the sender; 0 for unlimited
+    double m_bandwidthMbps = 100;
+    /// Links are TCP like P2PComm's: a lost message costs a resend after
+    /// m_retransmitMs rather than going missing
+    double m_lossRate = 0;
+    double m_retransmitMs = 200;
+  };
+
+  struct Stats {
+    uint64_t m_sent = 0;
+    uint64_t m_delivered = 0;
+    uint64_t m_retransmitted = 0;
+    uint64_t m_bytes = 0;
+  };
+
+  /// Called with the message body and the peer that sent it
+  using Handler = std::function<void(const bytes& message, const Peer& from)>;
+
+  /// Rumors are pushed down a random tree with this many children per node
+  explicit NetworkSimulator(uint32_t seed, unsigned int gossipFanout = 3);
+  ~NetworkSimulator();
+
+  NetworkSimulator(const NetworkSimulator&) = delete;
+  NetworkSimulator& operator=(const NetworkSimulator&) = delete;
+
+  /// Returns the index of the new node
+  size_t AddNode(const Peer& peer, Handler handler);
+
+  void SetDefaultLink(const LinkParams& params);
+  void SetLink(size_t from, size_t to, const LinkParams& params);
+
+  /// Runs action as node, so that whatever it sends leaves from node
+  void Execute(size_t node, const std::function<void()>& action);
+
+  /// Delivers until nothing is in flight. Returns the simulated time in ms.
+  double Run();
+
+  double Now() const { return m_now; }
+  const Stats& GetStats() const { return m_stats; }
+
+ private:
+  struct Event {
+    double m_time;
+    uint64_t m_seq;
+    size_t m_from;
+    size_t m_to;
+    std::shared_ptr<const bytes> m_message;
+    /// Rumor tree (nodes in push order) and m_to's position in it, if any
+    std::shared_ptr<const std::vector<size_t>> m_tree;
+    size_t m_treeIndex;
+
+    bool operator>(const Event& other) const {
+      return (m_time != other.m_time) ? m_time > other.m_time
+                                      : m_seq > other.m_seq;
+    }
+  };
+
+  void OnSend(const Peer& peer, const bytes& message);
+  void Send(size_t from, size_t to, const std::shared_ptr<const bytes>& message,
+            const std::shared_ptr<const std::vector<size_t>>& tree,
+            size_t treeIndex);
+  void ForwardRumor(const Event& event);
+  const LinkParams& GetLink(size_t from, size_t to) const;
+
+  std::mt19937 m_rng;
+  unsigned int m_gossipFanout;
+  std::vector<Peer> m_peers;
+  std::vector<Handler> m_handlers;
+  std::unordered_map<Peer, size_t> m_peerIndex;
+  LinkParams m_defaultLink;
+  std::map<std::pair<size_t, size_t>, LinkParams> m_links;
+  /// When each node's uplink is done with what it already sends
+  std::vector<double> m_uplinkFreeAt;
+  /// Last arrival per link, so that a link stays in order like TCP
+  std::map<std::pair<size_t, size_t>, double> m_lastArrival;
+  std::priority_queue<Event, std::vector<Event>, std::greater<Event>> m_events;
+  double m_now = 0;
+  uint64_t m_seq = 0;
+  size_t m_current = 0;
+  bool m_hasCurrent = false;
+  Stats m_stats;
+};
+
+#endif  // __NETWORKSIMULATOR_H__
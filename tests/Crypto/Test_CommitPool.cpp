@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <vector>
+
+#include "libCrypto/CommitPool.h"
+#include "libUtils/Logger.h"
+
+#define BOOST_TEST_MODULE commitpool
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(commitpool)
+
+void CheckDistinct(const vector<CommitPool::Commit>& commits) {
+  for (unsigned int i = 0; i < commits.size(); i++) {
+    BOOST_CHECK(commits.at(i).first->Initialized());
+    BOOST_CHECK(commits.at(i).second->Initialized());
+    BOOST_CHECK(CommitPoint(*commits.at(i).first) == *commits.at(i).second);
+    for (unsigned int j = 0; j < i; j++) {
+      BOOST_CHECK(!(*commits.at(i).first == *commits.at(j).first));
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(test_take_from_pool) {
+  INIT_STDOUT_LOGGER();
+
+  const unsigned int poolSize = 3;
+
+  CommitPool pool(poolSize);
+  pool.WaitUntilFull();
+  BOOST_CHECK_EQUAL(pool.GetStats().m_ready, poolSize);
+
+  // Take more than the pool holds, so some may be generated inline
+  vector<CommitPool::Commit> commits;
+  for (unsigned int i = 0; i < 2 * poolSize; i++) {
+    commits.emplace_back(pool.Take());
+  }
+  CheckDistinct(commits);
+
+  CommitPool::Stats stats = pool.GetStats();
+  BOOST_CHECK_GE(stats.m_hits, poolSize);
+  BOOST_CHECK_EQUAL(stats.m_hits + stats.m_misses, 2 * poolSize);
+
+  // The pool is topped up after the takes
+  pool.WaitUntilFull();
+  BOOST_CHECK_EQUAL(pool.GetStats().m_ready, poolSize);
+}
+
+BOOST_AUTO_TEST_CASE(test_take_without_pool) {
+  INIT_STDOUT_LOGGER();
+
+  CommitPool pool(0);
+
+  vector<CommitPool::Commit> commits;
+  for (unsigned int i = 0; i < 3; i++) {
+    commits.emplace_back(pool.Take());
+  }
+  CheckDistinct(commits);
+
+  CommitPool::Stats stats = pool.GetStats();
+  BOOST_CHECK_EQUAL(stats.m_ready, 0);
+  BOOST_CHECK_EQUAL(stats.m_hits, 0);
+  BOOST_CHECK_EQUAL(stats.m_misses, 3);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "libCrypto/CommitteeKeyCache.h"
+#include "libUtils/Logger.h"
+
+#define BOOST_TEST_MODULE committeekeycache
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(committeekeycache)
+
+using Committee = vector<pair<PubKey, unsigned int>>;
+
+const PubKey& GetKey(const Committee::value_type& member) {
+  return member.first;
+}
+
+shared_ptr<PubKey> AggregateDirectly(const Committee& committee,
+                                     const vector<bool>& bitmap) {
+  vector<PubKey> keys;
+  for (unsigned int i = 0; i < committee.size(); i++) {
+    if (bitmap.at(i)) {
+      keys.emplace_back(committee.at(i).first);
+    }
+  }
+  return MultiSig::AggregatePubKeys(keys);
+}
+
+BOOST_AUTO_TEST_CASE(test_aggregate) {
+  INIT_STDOUT_LOGGER();
+
+  const unsigned int committeeSize = 30;
+
+  Committee committee;
+  for (unsigned int i = 0; i < committeeSize; i++) {
+    committee.emplace_back(Schnorr::GetInstance().GenKeyPair().second, i);
+  }
+
+  CommitteeKeyCache cache;
+
+  // Mostly present (derived by subtraction) and mostly absent (summed)
+  for (unsigned int stride : {3, 2, 1}) {
+    for (bool present : {true, false}) {
+      vector<bool> bitmap(committeeSize, present);
+      for (unsigned int i = 0; i < committeeSize; i += stride) {
+        bitmap.at(i) = !present;
+      }
+      if (count(bitmap.begin(), bitmap.end(), true) == 0) {
+        continue;
+      }
+
+      shared_ptr<PubKey> cached = cache.Aggregate(committee, GetKey, bitmap);
+      shared_ptr<PubKey> expected = AggregateDirectly(committee, bitmap);
+      BOOST_REQUIRE(cached != nullptr);
+      BOOST_REQUIRE(expected != nullptr);
+      BOOST_CHECK_MESSAGE(*cached == *expected,
+                          "Wrong aggregated key for stride " << stride);
+    }
+  }
+
+  // Committee all present
+  vector<bool> bitmap(committeeSize, true);
+  BOOST_CHECK(*cache.Aggregate(committee, GetKey, bitmap) ==
+              *AggregateDirectly(committee, bitmap));
+
+  // Bitmap of the wrong size
+  BOOST_CHECK(cache.Aggregate(committee, GetKey, vector<bool>(3, true)) ==
+              nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(test_committee_change) {
+  INIT_STDOUT_LOGGER();
+
+  const unsigned int committeeSize = 12;
+
+  Committee committee;
+  for (unsigned int i = 0; i < committeeSize; i++) {
+    committee.emplace_back(Schnorr::GetInstance().GenKeyPair().second, i);
+  }
+
+  CommitteeKeyCache cache;
+  vector<bool> bitmap(committeeSize, true);
+  bitmap.at(5) = false;
+
+  BOOST_CHECK(*cache.Aggregate(committee, GetKey, bitmap) ==
+              *AggregateDirectly(committee, bitmap));
+
+  // A member replaced, as when a PoW winner joins the DS committee
+  committee.at(0).first = Schnorr::GetInstance().GenKeyPair().second;
+  BOOST_CHECK_MESSAGE(*cache.Aggregate(committee, GetKey, bitmap) ==
+                          *AggregateDirectly(committee, bitmap),
+                      "Cache not rebuilt after a member changed");
+
+  // A member removed
+  committee.pop_back();
+  bitmap.pop_back();
+  BOOST_CHECK_MESSAGE(*cache.Aggregate(committee, GetKey, bitmap) ==
+                          *AggregateDirectly(committee, bitmap),
+                      "Cache not rebuilt after the committee shrank");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <string>
+
+#include "libCrypto/KeyHashCache.h"
+#include "libCrypto/Sha2.h"
+#include "libUtils/DataConversion.h"
+#include "libUtils/Logger.h"
+
+#define BOOST_TEST_MODULE keyhashcache
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(keyhashcache)
+
+dev::h256 Hash(const string& key) {
+  SHA2<HASH_TYPE::HASH_VARIANT_256> sha2;
+  sha2.Update(DataConversion::StringToCharArray(key));
+  return dev::h256(sha2.Finalize());
+}
+
+BOOST_AUTO_TEST_CASE(matchesSha256) {
+  INIT_STDOUT_LOGGER();
+
+  KeyHashCache cache(64);
+  for (unsigned int i = 0; i < 2; i++) {
+    BOOST_CHECK_EQUAL(cache.Get("balances"), Hash("balances"));
+    BOOST_CHECK_EQUAL(cache.Get(string("\0\1", 2)), Hash(string("\0\1", 2)));
+  }
+
+  KeyHashCache::Stats stats = cache.GetStats();
+  BOOST_CHECK_EQUAL(stats.m_hits, 2);
+  BOOST_CHECK_EQUAL(stats.m_misses, 2);
+
+  cache.Clear();
+  BOOST_CHECK_EQUAL(cache.Get("balances"), Hash("balances"));
+  BOOST_CHECK_EQUAL(cache.GetStats().m_misses, 3);
+}
+
+BOOST_AUTO_TEST_CASE(staysBounded) {
+  INIT_STDOUT_LOGGER();
+
+  // One entry per shard
+  KeyHashCache cache(16);
+  for (unsigned int i = 0; i < 1000; i++) {
+    BOOST_CHECK_EQUAL(cache.Get(to_string(i)), Hash(to_string(i)));
+  }
+
+  // At most 16 of the keys can still be cached
+  for (unsigned int i = 0; i < 1000; i++) {
+    cache.Get(to_string(i));
+  }
+  BOOST_CHECK_LE(cache.GetStats().m_hits, 16);
+
+  // Without a capacity every key is hashed
+  KeyHashCache uncached(0);
+  uncached.Get("a");
+  uncached.Get("a");
+  BOOST_CHECK_EQUAL(uncached.GetStats().m_hits, 0);
+  BOOST_CHECK_EQUAL(uncached.GetStats().m_misses, 2);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -17,6 +17,7 @@
 
 #include "libCrypto/MultiSig.h"
 #include "libUtils/Logger.h"
+#include "libUtils/TimeUtils.h"
 
 #define BOOST_TEST_MODULE multisigtest
 #define BOOST_TEST_DYN_LINK
@@ -124,6 +125,132 @@ BOOST_AUTO_TEST_CASE(test_multisig) {
                       "Response operator= failed");
 }
 
+/**
+ * \brief test_aggregate_throughput
+ *
+ * \details Measure the rate of aggregating a DS committee sized key set
+ */
+BOOST_AUTO_TEST_CASE(test_aggregate_throughput) {
+  INIT_STDOUT_LOGGER();
+
+  Schnorr& schnorr = Schnorr::GetInstance();
+
+#ifdef USE_SECP256K1
+  LOG_GENERAL(INFO, "Curve backend = libsecp256k1");
+#else
+  LOG_GENERAL(INFO, "Curve backend = OpenSSL");
+#endif  // USE_SECP256K1
+
+  const unsigned int nbsigners = 600;
+  const unsigned int num_ops = 20;
+
+  vector<PubKey> pubkeys;
+  for (unsigned int i = 0; i < nbsigners; i++) {
+    pubkeys.emplace_back(schnorr.GenKeyPair().second);
+  }
+
+  shared_ptr<PubKey> aggregatedPubkey;
+  auto t = r_timer_start();
+  for (unsigned int i = 0; i < num_ops; i++) {
+    aggregatedPubkey = MultiSig::AggregatePubKeys(pubkeys);
+    BOOST_REQUIRE_MESSAGE(aggregatedPubkey != nullptr,
+                          "AggregatePubKeys failed");
+  }
+  LOG_GENERAL(INFO, "Aggregate " << nbsigners << " keys (ops/sec) = "
+                                 << num_ops * 1000000.0 / r_timer_end(t));
+
+  /// The sum does not depend on the order of the keys
+  reverse(pubkeys.begin(), pubkeys.end());
+  shared_ptr<PubKey> reversedPubkey = MultiSig::AggregatePubKeys(pubkeys);
+  BOOST_REQUIRE_MESSAGE(reversedPubkey != nullptr, "AggregatePubKeys failed");
+  BOOST_CHECK_MESSAGE(*aggregatedPubkey == *reversedPubkey,
+                      "Aggregated keys differ");
+}
+
+/**
+ * \brief test_group_aggregation
+ *
+ * \details Check that responses aggregated per group verify against the
+ * group's aggregated commit and key, and sign as if sent one by one
+ */
+BOOST_AUTO_TEST_CASE(test_group_aggregation) {
+  INIT_STDOUT_LOGGER();
+
+  Schnorr& schnorr = Schnorr::GetInstance();
+  MultiSig& multisig = MultiSig::GetInstance();
+
+  const unsigned int nbgroups = 4;
+  const unsigned int groupsize = 5;
+  vector<vector<PrivKey>> privkeys(nbgroups);
+  vector<vector<PubKey>> pubkeys(nbgroups);
+  vector<vector<CommitSecret>> secrets(nbgroups);
+  vector<vector<CommitPoint>> points(nbgroups);
+  vector<PubKey> allPubkeys;
+  vector<CommitPoint> groupCommits;
+  vector<PubKey> groupKeys;
+  for (unsigned int g = 0; g < nbgroups; g++) {
+    secrets.at(g).resize(groupsize);
+    for (unsigned int i = 0; i < groupsize; i++) {
+      pair<PrivKey, PubKey> keypair = schnorr.GenKeyPair();
+      privkeys.at(g).emplace_back(keypair.first);
+      pubkeys.at(g).emplace_back(keypair.second);
+      allPubkeys.emplace_back(keypair.second);
+      points.at(g).emplace_back(secrets.at(g).at(i));
+    }
+    groupCommits.emplace_back(*MultiSig::AggregateCommits(points.at(g)));
+    groupKeys.emplace_back(*MultiSig::AggregatePubKeys(pubkeys.at(g)));
+  }
+
+  /// The leader only sees the aggregate of each group
+  shared_ptr<CommitPoint> aggregatedCommit =
+      MultiSig::AggregateCommits(groupCommits);
+  shared_ptr<PubKey> aggregatedPubkey = MultiSig::AggregatePubKeys(allPubkeys);
+  BOOST_REQUIRE(aggregatedCommit != nullptr);
+  BOOST_REQUIRE(aggregatedPubkey != nullptr);
+
+  bytes message(1024);
+  generate(message.begin(), message.end(), std::rand);
+  Challenge challenge(*aggregatedCommit, *aggregatedPubkey, message);
+  BOOST_REQUIRE(challenge.Initialized());
+
+  vector<Response> groupResponses;
+  for (unsigned int g = 0; g < nbgroups; g++) {
+    vector<Response> responses;
+    for (unsigned int i = 0; i < groupsize; i++) {
+      responses.emplace_back(secrets.at(g).at(i), challenge,
+                             privkeys.at(g).at(i));
+    }
+    shared_ptr<Response> groupResponse =
+        MultiSig::AggregateResponses(responses);
+    BOOST_REQUIRE(groupResponse != nullptr);
+    BOOST_CHECK_MESSAGE(
+        MultiSig::VerifyResponse(*groupResponse, challenge, groupKeys.at(g),
+                                 groupCommits.at(g)),
+        "Group response verification failed");
+    groupResponses.emplace_back(*groupResponse);
+
+    /// One wrong response makes the whole group fail
+    responses.back() =
+        Response(secrets.at(g).front(), challenge, privkeys.at(g).back());
+    shared_ptr<Response> badResponse = MultiSig::AggregateResponses(responses);
+    BOOST_REQUIRE(badResponse != nullptr);
+    BOOST_CHECK_MESSAGE(
+        !MultiSig::VerifyResponse(*badResponse, challenge, groupKeys.at(g),
+                                  groupCommits.at(g)),
+        "Bad group response verified");
+  }
+
+  shared_ptr<Response> aggregatedResponse =
+      MultiSig::AggregateResponses(groupResponses);
+  BOOST_REQUIRE(aggregatedResponse != nullptr);
+  shared_ptr<Signature> signature =
+      MultiSig::AggregateSign(challenge, *aggregatedResponse);
+  BOOST_REQUIRE(signature != nullptr);
+  BOOST_CHECK_MESSAGE(
+      multisig.MultiSigVerify(message, *signature, *aggregatedPubkey),
+      "Signature over group responses failed");
+}
+
 /**
  * \brief test_serialization
  *
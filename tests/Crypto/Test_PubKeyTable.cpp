@@ -0,0 +1,159 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <chrono>
+
+#include "libCrypto/MultiSig.h"
+#include "libCrypto/PubKeyTable.h"
+#include "libUtils/Logger.h"
+
+#define BOOST_TEST_MODULE pubkeytable
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(pubkeytable)
+
+BOOST_AUTO_TEST_CASE(test_multiply_add) {
+  INIT_STDOUT_LOGGER();
+
+  const Curve& curve = Schnorr::GetInstance().GetCurve();
+  unique_ptr<BN_CTX, void (*)(BN_CTX*)> ctx(BN_CTX_new(), BN_CTX_free);
+  unique_ptr<EC_POINT, void (*)(EC_POINT*)> expected(
+      EC_POINT_new(curve.m_group.get()), EC_POINT_free);
+  unique_ptr<EC_POINT, void (*)(EC_POINT*)> result(
+      EC_POINT_new(curve.m_group.get()), EC_POINT_free);
+  unique_ptr<BIGNUM, void (*)(BIGNUM*)> a(BN_new(), BN_free);
+  unique_ptr<BIGNUM, void (*)(BIGNUM*)> b(BN_new(), BN_free);
+
+  const PubKey pubkey = Schnorr::GetInstance().GenKeyPair().second;
+  const PubKeyTable& tableG = PubKeyTableCache::GetInstance().GetGenerator();
+  const PubKeyTable tableP(pubkey.m_P.get());
+  BOOST_REQUIRE(tableG.Initialized() && tableP.Initialized());
+
+  for (unsigned int i = 0; i < 50; i++) {
+    BOOST_REQUIRE(BN_rand_range(a.get(), curve.m_order.get()));
+    BOOST_REQUIRE(BN_rand_range(b.get(), curve.m_order.get()));
+    if (i == 0) {
+      BN_zero(a.get());
+    } else if (i == 1) {
+      BN_sub(b.get(), curve.m_order.get(), BN_value_one());
+    }
+
+    BOOST_REQUIRE(EC_POINT_mul(curve.m_group.get(), expected.get(), a.get(),
+                               pubkey.m_P.get(), b.get(), ctx.get()));
+    BOOST_REQUIRE(PubKeyTable::MultiplyAdd(tableG, a.get(), tableP, b.get(),
+                                           result.get(), ctx.get()));
+    BOOST_CHECK_MESSAGE(EC_POINT_cmp(curve.m_group.get(), expected.get(),
+                                     result.get(), ctx.get()) == 0,
+                        "Table multiplication mismatch");
+  }
+}
+
+BOOST_AUTO_TEST_CASE(test_cache_groups) {
+  INIT_STDOUT_LOGGER();
+
+  PubKeyTableCache& cache = PubKeyTableCache::GetInstance();
+
+  vector<PubKey> keys;
+  for (unsigned int i = 0; i < 6; i++) {
+    keys.emplace_back(Schnorr::GetInstance().GenKeyPair().second);
+  }
+
+  const vector<PubKey> dsKeys(keys.begin(), keys.begin() + 4);
+  const vector<PubKey> shardKeys(keys.begin() + 3, keys.end());
+
+  cache.Prepare(TABLE_GROUP_DS_COMMITTEE, dsKeys);
+  cache.Prepare(TABLE_GROUP_SHARD, shardKeys);
+  BOOST_CHECK_EQUAL(cache.Size(), keys.size());
+
+  // Tables of keys that stay are reused
+  const auto kept = cache.Get(keys.at(1));
+  BOOST_REQUIRE(kept != nullptr);
+  cache.Prepare(TABLE_GROUP_DS_COMMITTEE,
+                vector<PubKey>(keys.begin() + 1, keys.begin() + 4));
+  BOOST_CHECK(cache.Get(keys.at(1)) == kept);
+  BOOST_CHECK(cache.Get(keys.at(0)) == nullptr);
+
+  // Keys still in another group survive
+  cache.Prepare(TABLE_GROUP_DS_COMMITTEE, {});
+  BOOST_CHECK(cache.Get(keys.at(1)) == nullptr);
+  BOOST_CHECK(cache.Get(keys.at(3)) != nullptr);
+  BOOST_CHECK_EQUAL(cache.Size(), shardKeys.size());
+
+  cache.Prepare(TABLE_GROUP_SHARD, {});
+  BOOST_CHECK_EQUAL(cache.Size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_verify_response) {
+  INIT_STDOUT_LOGGER();
+
+  const unsigned int nbsigners = 20;
+  const unsigned int rounds = 10;
+
+  vector<PrivKey> privkeys;
+  vector<PubKey> pubkeys;
+  for (unsigned int i = 0; i < nbsigners; i++) {
+    const PairOfKey keypair = Schnorr::GetInstance().GenKeyPair();
+    privkeys.emplace_back(keypair.first);
+    pubkeys.emplace_back(keypair.second);
+  }
+
+  const bytes message(64, 0x42);
+  vector<CommitSecret> secrets(nbsigners);
+  vector<CommitPoint> points;
+  for (const auto& secret : secrets) {
+    points.emplace_back(secret);
+  }
+  const Challenge challenge(*MultiSig::AggregateCommits(points),
+                            *MultiSig::AggregatePubKeys(pubkeys), message);
+
+  vector<Response> responses;
+  for (unsigned int i = 0; i < nbsigners; i++) {
+    responses.emplace_back(secrets.at(i), challenge, privkeys.at(i));
+  }
+
+  // Without and then with tables for the committee
+  for (bool tables : {false, true}) {
+    PubKeyTableCache::GetInstance().Prepare(
+        TABLE_GROUP_SHARD, tables ? pubkeys : vector<PubKey>());
+
+    auto start = chrono::steady_clock::now();
+    for (unsigned int r = 0; r < rounds; r++) {
+      for (unsigned int i = 0; i < nbsigners; i++) {
+        BOOST_CHECK(MultiSig::VerifyResponse(responses.at(i), challenge,
+                                             pubkeys.at(i), points.at(i)));
+      }
+    }
+    auto elapsed = chrono::duration_cast<chrono::microseconds>(
+                       chrono::steady_clock::now() - start)
+                       .count();
+    LOG_GENERAL(INFO, (tables ? "With" : "Without")
+                          << " tables: " << nbsigners * rounds
+                          << " responses in " << elapsed << " us");
+
+    // A response checked against the wrong commit is rejected
+    BOOST_CHECK(!MultiSig::VerifyResponse(responses.at(0), challenge,
+                                          pubkeys.at(0), points.at(1)));
+  }
+
+  PubKeyTableCache::GetInstance().Prepare(TABLE_GROUP_SHARD, {});
+}
+
+BOOST_AUTO_TEST_SUITE_END()
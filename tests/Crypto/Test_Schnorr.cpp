@@ -16,6 +16,7 @@
  */
 
 #include <cstring>
+#include <thread>
 #include "libCrypto/Schnorr.h"
 #include "libUtils/Logger.h"
 #include "libUtils/TimeUtils.h"
@@ -122,6 +123,48 @@ BOOST_AUTO_TEST_CASE(test_keys) {
       "Key generation check #4 failed");
 }
 
+/**
+ * \brief test_pubkey_compare
+ *
+ * \details Test that comparisons on the cached encoding match the points
+ */
+BOOST_AUTO_TEST_CASE(test_pubkey_compare) {
+  Schnorr& schnorr = Schnorr::GetInstance();
+
+  for (unsigned int i = 0; i < 20; i++) {
+    PubKey lhs = schnorr.GenKeyPair().second;
+    PubKey rhs = schnorr.GenKeyPair().second;
+
+    bytes lhsBytes, rhsBytes;
+    lhs.Serialize(lhsBytes, 0);
+    rhs.Serialize(rhsBytes, 0);
+
+    // Same order as comparing the serialized points as big numbers
+    unique_ptr<BIGNUM, void (*)(BIGNUM*)> lhsBn(
+        BN_bin2bn(lhsBytes.data(), lhsBytes.size(), NULL), BN_clear_free);
+    unique_ptr<BIGNUM, void (*)(BIGNUM*)> rhsBn(
+        BN_bin2bn(rhsBytes.data(), rhsBytes.size(), NULL), BN_clear_free);
+    const int cmp = BN_cmp(lhsBn.get(), rhsBn.get());
+    BOOST_CHECK_EQUAL(lhs < rhs, cmp < 0);
+    BOOST_CHECK_EQUAL(lhs > rhs, cmp > 0);
+    BOOST_CHECK_EQUAL(lhs == rhs, cmp == 0);
+
+    // Copies, assignments and deserialized keys compare and hash equal
+    PubKey copied(lhs);
+    PubKey assigned;
+    assigned = lhs;
+    PubKey deserialized(lhsBytes, 0);
+    for (const PubKey* key : {&copied, &assigned, &deserialized}) {
+      BOOST_CHECK(*key == lhs);
+      BOOST_CHECK(!(*key < lhs) && !(*key > lhs));
+      BOOST_CHECK_EQUAL(std::hash<PubKey>()(*key), std::hash<PubKey>()(lhs));
+    }
+  }
+
+  BOOST_CHECK_MESSAGE(!(PubKey() == PubKey()),
+                      "Uninitialized keys compared equal");
+}
+
 /**
  * \brief test_sign_verif
  *
@@ -166,6 +209,106 @@ BOOST_AUTO_TEST_CASE(test_sign_verif) {
       "Signature verification (wrong message) failed");
 }
 
+/**
+ * \brief test_batch_verif
+ *
+ * \details Test batch verification with valid and invalid signatures
+ */
+BOOST_AUTO_TEST_CASE(test_batch_verif) {
+  Schnorr& schnorr = Schnorr::GetInstance();
+
+  const unsigned int num_sigs = 20;
+  const unsigned int bad_index = 7;
+
+  vector<pair<PrivKey, PubKey>> keypairs;
+  vector<bytes> messages(num_sigs, bytes(256));
+  vector<Signature> signatures(num_sigs);
+
+  for (unsigned int i = 0; i < num_sigs; i++) {
+    keypairs.emplace_back(schnorr.GenKeyPair());
+    generate(messages[i].begin(), messages[i].end(), std::rand);
+    BOOST_CHECK_MESSAGE(schnorr.Sign(messages[i], keypairs[i].first,
+                                     keypairs[i].second, signatures[i]),
+                        "Signing failed");
+  }
+
+  vector<Schnorr::VerifyItem> items;
+  for (unsigned int i = 0; i < num_sigs; i++) {
+    items.push_back({&messages[i], 0, (unsigned int)messages[i].size(),
+                     &signatures[i], &keypairs[i].second});
+  }
+
+  vector<bool> results;
+  BOOST_CHECK_MESSAGE(schnorr.BatchVerify(items, results),
+                      "Batch verification of valid signatures failed");
+  BOOST_CHECK_EQUAL(results.size(), num_sigs);
+
+  // Signature checked against someone else's key
+  items[bad_index].m_pubkey = &keypairs[bad_index + 1].second;
+  BOOST_CHECK_MESSAGE(!schnorr.BatchVerify(items, results),
+                      "Batch verification accepted a wrong signature");
+  for (unsigned int i = 0; i < num_sigs; i++) {
+    BOOST_CHECK_MESSAGE(results[i] == (i != bad_index),
+                        "Wrong result for signature " << i);
+  }
+
+  BOOST_CHECK_MESSAGE(schnorr.BatchVerify({}, results) && results.empty(),
+                      "Empty batch should verify");
+}
+
+/**
+ * \brief test_parallel_verif
+ *
+ * \details Test verifying disjoint ranges of a batch from several threads
+ */
+BOOST_AUTO_TEST_CASE(test_parallel_verif) {
+  Schnorr& schnorr = Schnorr::GetInstance();
+
+  const unsigned int num_threads = 4;
+  const unsigned int sigs_per_thread = 8;
+  const unsigned int num_sigs = num_threads * sigs_per_thread;
+  const unsigned int bad_index = 13;
+
+  pair<PrivKey, PubKey> keypair = schnorr.GenKeyPair();
+  pair<PrivKey, PubKey> otherKeypair = schnorr.GenKeyPair();
+  vector<bytes> messages(num_sigs, bytes(256));
+  vector<Signature> signatures(num_sigs);
+
+  for (unsigned int i = 0; i < num_sigs; i++) {
+    generate(messages[i].begin(), messages[i].end(), std::rand);
+    BOOST_CHECK_MESSAGE(schnorr.Sign(messages[i], keypair.first,
+                                     keypair.second, signatures[i]),
+                        "Signing failed");
+  }
+
+  vector<Schnorr::VerifyItem> items;
+  for (unsigned int i = 0; i < num_sigs; i++) {
+    items.push_back({&messages[i], 0, (unsigned int)messages[i].size(),
+                     &signatures[i], &keypair.second});
+  }
+  items[bad_index].m_pubkey = &otherKeypair.second;
+
+  vector<unsigned char> results(num_sigs, 0);
+  vector<thread> threads;
+  for (unsigned int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&schnorr, &items, &results, t, sigs_per_thread]() {
+      schnorr.VerifyRange(items, t * sigs_per_thread,
+                          (t + 1) * sigs_per_thread, results);
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  for (unsigned int i = 0; i < num_sigs; i++) {
+    BOOST_CHECK_MESSAGE((results[i] == 1) == (i != bad_index),
+                        "Wrong result for signature " << i);
+  }
+
+  BOOST_CHECK_MESSAGE(!schnorr.VerifyRange(items, 0, num_sigs + 1, results),
+                      "Range beyond the batch accepted");
+}
+
 /**
  * \brief test_performance
  *
@@ -221,6 +364,45 @@ BOOST_AUTO_TEST_CASE(test_performance) {
   }
 }
 
+/**
+ * \brief test_throughput
+ *
+ * \details Measure sign and verify rates on transaction-sized messages
+ */
+BOOST_AUTO_TEST_CASE(test_throughput) {
+  Schnorr& schnorr = Schnorr::GetInstance();
+
+#ifdef USE_SECP256K1
+  LOG_GENERAL(INFO, "Curve backend = libsecp256k1");
+#else
+  LOG_GENERAL(INFO, "Curve backend = OpenSSL");
+#endif  // USE_SECP256K1
+
+  const unsigned int num_ops = 200;
+
+  pair<PrivKey, PubKey> keypair = schnorr.GenKeyPair();
+  bytes message(256);
+  generate(message.begin(), message.end(), std::rand);
+  vector<Signature> signatures(num_ops);
+
+  auto t = r_timer_start();
+  for (unsigned int i = 0; i < num_ops; i++) {
+    BOOST_CHECK_MESSAGE(schnorr.Sign(message, keypair.first, keypair.second,
+                                     signatures[i]),
+                        "Signing failed");
+  }
+  LOG_GENERAL(INFO, "Sign (ops/sec)   = " << num_ops * 1000000.0 /
+                                                 r_timer_end(t));
+
+  t = r_timer_start();
+  for (unsigned int i = 0; i < num_ops; i++) {
+    BOOST_CHECK_MESSAGE(schnorr.Verify(message, signatures[i], keypair.second),
+                        "Verification failed");
+  }
+  LOG_GENERAL(INFO, "Verify (ops/sec) = " << num_ops * 1000000.0 /
+                                                 r_timer_end(t));
+}
+
 /**
  * \brief test_serialization
  *
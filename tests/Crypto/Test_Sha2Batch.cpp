@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <openssl/sha.h>
+
+#include "libCrypto/Sha2Batch.h"
+
+#define BOOST_TEST_MODULE sha2batchtest
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+
+namespace {
+vector<bytes> MakeInputs() {
+  // Sizes around the padding boundaries of one and two blocks
+  const vector<size_t> sizes = {0,  1,   55,  56,  57,  63,   64,
+                                65, 119, 120, 128, 200, 1000, 4096};
+  vector<bytes> inputs;
+  for (size_t size : sizes) {
+    bytes input(size);
+    for (size_t i = 0; i < size; i++) {
+      input[i] = static_cast<uint8_t>(i * 31 + size);
+    }
+    inputs.emplace_back(move(input));
+  }
+  return inputs;
+}
+
+bytes Reference(const bytes& input) {
+  bytes output(SHA256_DIGEST_LENGTH);
+  SHA256(input.data(), input.size(), output.data());
+  return output;
+}
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(sha2batchtest)
+
+BOOST_AUTO_TEST_CASE(test_openssl_matches_reference) {
+  const vector<bytes> inputs = MakeInputs();
+  vector<bytes> outputs;
+  SHA256Batch(inputs, outputs, SHA256BatchImpl::OPENSSL);
+
+  BOOST_REQUIRE_EQUAL(outputs.size(), inputs.size());
+  for (size_t i = 0; i < inputs.size(); i++) {
+    BOOST_CHECK(outputs[i] == Reference(inputs[i]));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(test_avx2_matches_reference) {
+  if (!SHA256BatchHasAVX2()) {
+    BOOST_TEST_MESSAGE("AVX2 not supported, skipping");
+    return;
+  }
+
+  const vector<bytes> inputs = MakeInputs();
+  vector<bytes> outputs;
+  SHA256Batch(inputs, outputs, SHA256BatchImpl::AVX2);
+
+  BOOST_REQUIRE_EQUAL(outputs.size(), inputs.size());
+  for (size_t i = 0; i < inputs.size(); i++) {
+    BOOST_CHECK_MESSAGE(outputs[i] == Reference(inputs[i]),
+                        "Mismatch for input of size " << inputs[i].size());
+  }
+}
+
+BOOST_AUTO_TEST_CASE(test_auto_small_and_empty_batches) {
+  vector<bytes> outputs;
+  SHA256Batch({}, outputs);
+  BOOST_CHECK(outputs.empty());
+
+  const vector<bytes> inputs = {bytes{0x61, 0x62, 0x63}};
+  SHA256Batch(inputs, outputs);
+  BOOST_REQUIRE_EQUAL(outputs.size(), 1);
+  BOOST_CHECK(outputs[0] == Reference(inputs[0]));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -135,6 +135,49 @@ BOOST_AUTO_TEST_CASE(testStorage) {
   acc1.InitStorage();  // Improve coverage
 }
 
+BOOST_AUTO_TEST_CASE(testStorageValue) {
+  INIT_STDOUT_LOGGER();
+  LOG_MARKER();
+
+  if (!HASHMAP_CONTRACT_STATE_DB) {
+    return;
+  }
+
+  Account acc1(TestUtils::DistUint64(), 0);
+  const std::string initStr = "[]";
+  BOOST_CHECK(acc1.InitContract(bytes(initStr.begin(), initStr.end()),
+                                Address(TestUtils::DistUint64())));
+  acc1.SetCode(bytes(8, '0'));
+
+  const std::string balances =
+      R"([{"key":"0x01","val":"10"},{"key":"0x02","val":"20"}])";
+  BOOST_CHECK(acc1.SetStorage(
+      {std::make_tuple("owner", true, "ByStr20", "0x01"),
+       std::make_tuple("balances", true, "Map ByStr20 Uint128", balances)}));
+
+  Json::Value value;
+  BOOST_CHECK(acc1.GetStorageValue("owner", Json::arrayValue, value));
+  BOOST_CHECK_EQUAL(value.asString(), "0x01");
+
+  Json::Value keys = Json::arrayValue;
+  keys.append("0x02");
+  BOOST_CHECK(acc1.GetStorageValue("balances", keys, value));
+  BOOST_CHECK_EQUAL(value.asString(), "20");
+
+  keys[0] = "0x03";
+  BOOST_CHECK(!acc1.GetStorageValue("balances", keys, value));
+  BOOST_CHECK(!acc1.GetStorageValue("missing", Json::arrayValue, value));
+
+  // Storing only the changed field keeps the others
+  BOOST_CHECK(
+      acc1.SetStorage({std::make_tuple("owner", true, "ByStr20", "0x02")}));
+  BOOST_CHECK(acc1.GetStorageValue("owner", Json::arrayValue, value));
+  BOOST_CHECK_EQUAL(value.asString(), "0x02");
+  BOOST_CHECK(acc1.GetStorageValue("balances", Json::arrayValue, value));
+  BOOST_CHECK_EQUAL(value.size(), 2);
+  BOOST_CHECK_EQUAL(acc1.GetStorageJson().size(), 3);
+}
+
 BOOST_AUTO_TEST_CASE(testBalance) {
   INIT_STDOUT_LOGGER();
   LOG_MARKER();
@@ -224,4 +267,31 @@ BOOST_AUTO_TEST_CASE(testSerialize) {
       "expected: " << hash << " actual: " << acc2.GetCodeHash() << "\n");
 }
 
+BOOST_AUTO_TEST_CASE(testCopySharesCode) {
+  INIT_STDOUT_LOGGER();
+  LOG_MARKER();
+
+  Account acc1(TestUtils::DistUint128(), 0);
+  BOOST_CHECK(acc1.GetCode().empty());
+  BOOST_CHECK(acc1.GetInitData().empty());
+
+  const bytes code = dev::h256::random().asBytes();
+  const bytes initData = {'[', ']'};
+  acc1.SetCode(code);
+  acc1.SetInitData(initData);
+
+  // A copy refers to the same code and init data until they are replaced
+  Account acc2(acc1);
+  BOOST_CHECK(&acc1.GetCode() == &acc2.GetCode());
+  BOOST_CHECK(&acc1.GetInitData() == &acc2.GetInitData());
+
+  const bytes newCode = dev::h256::random().asBytes();
+  acc2.SetCode(newCode);
+  acc2.IncreaseNonce();
+  BOOST_CHECK(acc1.GetCode() == code);
+  BOOST_CHECK(acc2.GetCode() == newCode);
+  BOOST_CHECK(acc1.GetInitData() == initData);
+  BOOST_CHECK_EQUAL(acc1.GetNonce(), 0);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -16,7 +16,11 @@
  */
 
 #include <array>
+#include <map>
+#include <memory>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #define BOOST_TEST_MODULE accountstoretest
 #define BOOST_TEST_DYN_LINK
@@ -26,8 +30,10 @@
 #include "libData/AccountData/Account.h"
 #include "libData/AccountData/AccountStore.h"
 #include "libData/AccountData/Address.h"
+#include "libMessage/Messenger.h"
 #include "libUtils/DataConversion.h"
 #include "libUtils/Logger.h"
+#include "libUtils/ThreadPool.h"
 
 BOOST_AUTO_TEST_SUITE(accountstoretest)
 
@@ -366,4 +372,410 @@ BOOST_AUTO_TEST_CASE(increaseNonce) {
   BOOST_CHECK_MESSAGE(root1 != root2, "IncreaseNonce didn't change root!");
 }
 
+BOOST_AUTO_TEST_CASE(paymentsInParallel) {
+  INIT_STDOUT_LOGGER();
+
+  LOG_MARKER();
+
+  AccountStore::GetInstance().Init();
+
+  // Enough transfers to be spread over the pool, some of them failing
+  std::vector<Transaction> txns;
+  for (unsigned int i = 0; i < 100; i++) {
+    const PairOfKey sender = Schnorr::GetInstance().GenKeyPair();
+    const Address receiver = Account::GetAddressFromPublicKey(
+        Schnorr::GetInstance().GenKeyPair().second);
+    AccountStore::GetInstance().AddAccount(
+        Account::GetAddressFromPublicKey(sender.second), {1000, 0});
+    const boost::multiprecision::uint128_t amount = (i % 7 == 0) ? 2000 : i;
+    txns.emplace_back(DataConversion::Pack(CHAIN_ID, 1), 1, receiver, sender,
+                      amount, 1, NORMAL_TRAN_GAS);
+  }
+
+  AccountStore::GetInstance().InitTemp();
+  std::vector<bool> expectedOk;
+  for (const auto& txn : txns) {
+    TransactionReceipt receipt;
+    expectedOk.push_back(AccountStore::GetInstance().UpdateAccountsTemp(
+        1, 1, false, txn, receipt));
+  }
+  BOOST_REQUIRE(AccountStore::GetInstance().SerializeDelta());
+  bytes expectedDelta;
+  AccountStore::GetInstance().GetSerializedDelta(expectedDelta);
+
+  AccountStore::GetInstance().InitTemp();
+  ThreadPool pool(2, "TestPaymentPool");
+  std::vector<PaymentResult> results;
+  AccountStore::GetInstance().ExecutePaymentsTemp(
+      txns, std::vector<bool>(txns.size(), true), results, &pool, 2);
+  BOOST_REQUIRE_EQUAL(results.size(), txns.size());
+  for (unsigned int i = 0; i < txns.size(); i++) {
+    BOOST_CHECK_EQUAL(results.at(i).m_ok, expectedOk.at(i));
+    AccountStore::GetInstance().CommitPaymentTemp(results.at(i));
+  }
+  BOOST_REQUIRE(AccountStore::GetInstance().SerializeDelta());
+  bytes delta;
+  AccountStore::GetInstance().GetSerializedDelta(delta);
+
+  BOOST_CHECK_MESSAGE(delta == expectedDelta,
+                      "Parallel payments left a different state delta");
+}
+
+BOOST_AUTO_TEST_CASE(mergeDeltasInParallel) {
+  INIT_STDOUT_LOGGER();
+
+  LOG_MARKER();
+
+  AccountStore::GetInstance().Init();
+
+  // Three shard deltas against the same state, all paying one receiver
+  const Address receiver = Account::GetAddressFromPublicKey(
+      Schnorr::GetInstance().GenKeyPair().second);
+  std::vector<bytes> deltas;
+  for (unsigned int d = 0; d < 3; d++) {
+    std::vector<Transaction> txns;
+    for (unsigned int i = 0; i < 10; i++) {
+      const PairOfKey sender = Schnorr::GetInstance().GenKeyPair();
+      AccountStore::GetInstance().AddAccount(
+          Account::GetAddressFromPublicKey(sender.second), {1000, 0});
+      txns.emplace_back(DataConversion::Pack(CHAIN_ID, 1), 1, receiver, sender,
+                        10 + d, 1, NORMAL_TRAN_GAS);
+    }
+
+    AccountStore::GetInstance().InitTemp();
+    for (const auto& txn : txns) {
+      TransactionReceipt receipt;
+      AccountStore::GetInstance().UpdateAccountsTemp(1, 1, false, txn,
+                                                     receipt);
+    }
+    BOOST_REQUIRE(AccountStore::GetInstance().SerializeDelta());
+    deltas.emplace_back();
+    AccountStore::GetInstance().GetSerializedDelta(deltas.back());
+  }
+
+  AccountStore::GetInstance().InitTemp();
+  for (const auto& delta : deltas) {
+    BOOST_REQUIRE(AccountStore::GetInstance().DeserializeDeltaTemp(delta, 0));
+  }
+  BOOST_REQUIRE(AccountStore::GetInstance().SerializeDelta());
+  bytes expectedDelta;
+  AccountStore::GetInstance().GetSerializedDelta(expectedDelta);
+
+  // A corrupt delta in between is skipped without affecting the others
+  const bytes corrupt(64, 0xFF);
+  std::vector<const bytes*> batch{&deltas.at(0), &corrupt, &deltas.at(1),
+                                  &deltas.at(2)};
+  std::vector<bool> applied;
+  AccountStore::GetInstance().InitTemp();
+  BOOST_CHECK(!AccountStore::GetInstance().DeserializeDeltasTemp(batch,
+                                                                 applied));
+  BOOST_REQUIRE_EQUAL(applied.size(), batch.size());
+  BOOST_CHECK(applied.at(0) && !applied.at(1) && applied.at(2) &&
+              applied.at(3));
+  BOOST_REQUIRE(AccountStore::GetInstance().SerializeDelta());
+  bytes delta;
+  AccountStore::GetInstance().GetSerializedDelta(delta);
+
+  BOOST_CHECK_MESSAGE(delta == expectedDelta,
+                      "Merging deltas in parallel left a different state");
+}
+
+BOOST_AUTO_TEST_CASE(preExecutedPayments) {
+  INIT_STDOUT_LOGGER();
+
+  LOG_MARKER();
+
+  AccountStore::GetInstance().Init();
+
+  const PairOfKey sender = Schnorr::GetInstance().GenKeyPair();
+  const Address receiver = Account::GetAddressFromPublicKey(
+      Schnorr::GetInstance().GenKeyPair().second);
+  AccountStore::GetInstance().AddAccount(
+      Account::GetAddressFromPublicKey(sender.second), {1000, 0});
+
+  std::vector<Transaction> txns;
+  for (unsigned int i = 0; i < 3; i++) {
+    txns.emplace_back(DataConversion::Pack(CHAIN_ID, 1), i + 1, receiver,
+                      sender, 10 + i, 1, NORMAL_TRAN_GAS);
+  }
+
+  // Runs the txns one by one, as a backup checking a microblock would
+  auto execute = [&txns](std::vector<std::string>& receipts) {
+    AccountStore::GetInstance().InitTemp();
+    for (const auto& txn : txns) {
+      std::vector<PaymentResult> results(1);
+      results.at(0).m_receipt.SetEpochNum(1);
+      AccountStore::GetInstance().ExecutePaymentsTemp({txn}, {true}, results,
+                                                      nullptr, 0);
+      BOOST_CHECK(results.at(0).m_ok);
+      AccountStore::GetInstance().CommitPaymentTemp(results.at(0));
+      receipts.emplace_back(results.at(0).m_receipt.GetString());
+    }
+    BOOST_REQUIRE(AccountStore::GetInstance().SerializeDelta());
+    bytes delta;
+    AccountStore::GetInstance().GetSerializedDelta(delta);
+    return delta;
+  };
+
+  std::vector<std::string> expectedReceipts;
+  const bytes expectedDelta = execute(expectedReceipts);
+
+  // Pre-executed out of nonce order, so only the first txn started from the
+  // state it sees here; the other two have to run again
+  AccountStore::GetInstance().InitTemp();
+  AccountStore::GetInstance().PreExecutePayments({txns[0], txns[2], txns[1]},
+                                                 1);
+  std::vector<std::string> receipts;
+  BOOST_CHECK(execute(receipts) == expectedDelta);
+  BOOST_CHECK(receipts == expectedReceipts);
+
+  // Results for another epoch are not taken
+  AccountStore::GetInstance().InitTemp();
+  AccountStore::GetInstance().PreExecutePayments(txns, 2);
+  receipts.clear();
+  BOOST_CHECK(execute(receipts) == expectedDelta);
+  BOOST_CHECK(receipts == expectedReceipts);
+}
+
+BOOST_AUTO_TEST_CASE(compactStateDelta) {
+  INIT_STDOUT_LOGGER();
+
+  LOG_MARKER();
+
+  AccountStore::GetInstance().Init();
+
+  const PairOfKey sender = Schnorr::GetInstance().GenKeyPair();
+  const Address senderAddr = Account::GetAddressFromPublicKey(sender.second);
+  const Address receiver = Account::GetAddressFromPublicKey(
+      Schnorr::GetInstance().GenKeyPair().second);
+  AccountStore::GetInstance().AddAccount(senderAddr, {1000, 0});
+
+  AccountStore::GetInstance().InitTemp();
+  const Transaction txn(DataConversion::Pack(CHAIN_ID, 1), 1, receiver, sender,
+                        10, 1, NORMAL_TRAN_GAS);
+  TransactionReceipt receipt;
+  BOOST_REQUIRE(AccountStore::GetInstance().UpdateAccountsTemp(1, 1, false, txn,
+                                                               receipt));
+  BOOST_REQUIRE(AccountStore::GetInstance().SerializeDelta());
+  bytes delta;
+  AccountStore::GetInstance().GetSerializedDelta(delta);
+
+  // Both accounts are plain, so the balance changes come back as signed
+  // deltas through the compact encoding
+  std::unordered_map<Address, boost::multiprecision::int256_t> balances;
+  BOOST_REQUIRE(Messenger::StateDeltaToAddressMap(delta, 0, balances));
+  BOOST_CHECK_EQUAL(balances.size(), 2);
+  BOOST_CHECK_EQUAL(balances.at(receiver), 10);
+  BOOST_CHECK_EQUAL(balances.at(senderAddr), -10 - int(NORMAL_TRAN_GAS));
+
+  AccountStore::GetInstance().InitTemp();
+  BOOST_REQUIRE(AccountStore::GetInstance().DeserializeDeltaTemp(delta, 0));
+  BOOST_REQUIRE(AccountStore::GetInstance().SerializeDelta());
+  bytes reserialized;
+  AccountStore::GetInstance().GetSerializedDelta(reserialized);
+  BOOST_CHECK_MESSAGE(reserialized == delta,
+                      "Compact state delta did not round-trip");
+}
+
+BOOST_AUTO_TEST_CASE(committedAccountSnapshots) {
+  INIT_STDOUT_LOGGER();
+
+  LOG_MARKER();
+
+  AccountStore::GetInstance().Init();
+
+  const PairOfKey sender = Schnorr::GetInstance().GenKeyPair();
+  const Address senderAddr = Account::GetAddressFromPublicKey(sender.second);
+  const Address receiver = Account::GetAddressFromPublicKey(
+      Schnorr::GetInstance().GenKeyPair().second);
+  AccountStore::GetInstance().AddAccount(senderAddr, {10000, 0});
+
+  // Not published yet, so read from the live state
+  const auto before =
+      AccountStore::GetInstance().GetCommittedAccount(senderAddr);
+  BOOST_REQUIRE(before != nullptr);
+  BOOST_CHECK_EQUAL(before->GetBalance(), 10000);
+  BOOST_CHECK(AccountStore::GetInstance().GetCommittedAccount(receiver) ==
+              nullptr);
+
+  // Enough commits to have the layers merged at least once
+  const uint64_t firstVersion =
+      AccountStore::GetInstance().GetReadSnapshotVersion();
+  for (unsigned int i = 0; i < 20; i++) {
+    AccountStore::GetInstance().InitTemp();
+    const Transaction txn(DataConversion::Pack(CHAIN_ID, 1), i + 1, receiver,
+                          sender, 1, 1, NORMAL_TRAN_GAS);
+    TransactionReceipt receipt;
+    BOOST_REQUIRE(AccountStore::GetInstance().UpdateAccountsTemp(
+        1, 1, false, txn, receipt));
+    BOOST_REQUIRE(AccountStore::GetInstance().SerializeDelta());
+    AccountStore::GetInstance().CommitTemp();
+
+    const auto committed =
+        AccountStore::GetInstance().GetCommittedAccount(senderAddr);
+    BOOST_REQUIRE(committed != nullptr);
+    BOOST_CHECK_EQUAL(committed->GetBalance(),
+                      AccountStore::GetInstance().GetBalance(senderAddr));
+    BOOST_CHECK_EQUAL(committed->GetNonce(), i + 1);
+    const auto received =
+        AccountStore::GetInstance().GetCommittedAccount(receiver);
+    BOOST_REQUIRE(received != nullptr);
+    BOOST_CHECK_EQUAL(received->GetBalance(), i + 1);
+  }
+  BOOST_CHECK_EQUAL(AccountStore::GetInstance().GetReadSnapshotVersion(),
+                    firstVersion + 20);
+
+  // An account handed out earlier is never changed under its reader
+  BOOST_CHECK_EQUAL(before->GetBalance(), 10000);
+  BOOST_CHECK_EQUAL(before->GetNonce(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(prefetchAccounts) {
+  INIT_STDOUT_LOGGER();
+
+  LOG_MARKER();
+
+  AccountStore::GetInstance().Init();
+
+  std::vector<Address> addresses;
+  for (unsigned int i = 0; i < 100; i++) {
+    addresses.emplace_back(Account::GetAddressFromPublicKey(
+        Schnorr::GetInstance().GenKeyPair().second));
+    AccountStore::GetInstance().AddAccount(addresses.back(), {1000 + i, i});
+  }
+  AccountStore::GetInstance().UpdateStateTrieAll();
+  BOOST_REQUIRE(AccountStore::GetInstance().MoveUpdatesToDisk());
+
+  // Only the trie is left
+  AccountStore::GetInstance().DiscardUnsavedUpdates();
+  BOOST_REQUIRE_EQUAL(AccountStore::GetInstance().GetNumOfAccounts(), 0);
+
+  // Duplicates and accounts not in the state are skipped
+  std::vector<Address> toFetch(addresses);
+  toFetch.emplace_back(addresses.front());
+  toFetch.emplace_back(Account::GetAddressFromPublicKey(
+      Schnorr::GetInstance().GenKeyPair().second));
+
+  ThreadPool pool(2, "TestPrefetchPool");
+  AccountStore::GetInstance().PrefetchAccounts(toFetch, &pool, 2);
+  BOOST_CHECK_EQUAL(AccountStore::GetInstance().GetNumOfAccounts(),
+                    addresses.size());
+  for (unsigned int i = 0; i < addresses.size(); i++) {
+    BOOST_CHECK_EQUAL(
+        AccountStore::GetInstance().GetBalance(addresses.at(i)), 1000 + i);
+  }
+
+  // Nothing left to load
+  AccountStore::GetInstance().PrefetchAccounts(addresses, nullptr, 0);
+  BOOST_CHECK_EQUAL(AccountStore::GetInstance().GetNumOfAccounts(),
+                    addresses.size());
+}
+
+BOOST_AUTO_TEST_CASE(importAccounts) {
+  INIT_STDOUT_LOGGER();
+
+  LOG_MARKER();
+
+  std::map<Address, Account> accounts;
+  for (unsigned int i = 0; i < 1000; i++) {
+    accounts.emplace(Account::GetAddressFromPublicKey(
+                         Schnorr::GetInstance().GenKeyPair().second),
+                     Account{1000 + i, i});
+  }
+
+  // The same accounts added one at a time, the trie updated per account
+  AccountStore::GetInstance().Init();
+  AccountStore::GetInstance().AddAccount(accounts.begin()->first,
+                                         accounts.begin()->second);
+  AccountStore::GetInstance().UpdateStateTrieAll();
+  for (const auto& entry : accounts) {
+    AccountStore::GetInstance().AddAccount(entry.first, entry.second);
+  }
+  AccountStore::GetInstance().UpdateStateTrieAll();
+  const dev::h256 expectedRoot = AccountStore::GetInstance().GetStateRootHash();
+
+  auto makeNext = [](const std::vector<std::pair<Address, Account>>& source) {
+    auto it = std::make_shared<size_t>(0);
+    return [&source, it](Address& address, Account& account) {
+      if (*it == source.size()) {
+        return false;
+      }
+      address = source.at(*it).first;
+      account = source.at(*it).second;
+      (*it)++;
+      return true;
+    };
+  };
+
+  std::vector<std::pair<Address, Account>> sorted(accounts.begin(),
+                                                   accounts.end());
+
+  // Only into an empty store
+  BOOST_CHECK(!AccountStore::GetInstance().ImportAccounts(makeNext(sorted)));
+
+  AccountStore::GetInstance().Init();
+  BOOST_REQUIRE(AccountStore::GetInstance().ImportAccounts(makeNext(sorted)));
+  BOOST_CHECK_EQUAL(AccountStore::GetInstance().GetNumOfAccounts(),
+                    accounts.size());
+  BOOST_CHECK_EQUAL(AccountStore::GetInstance().GetStateRootHash(),
+                    expectedRoot);
+  BOOST_CHECK_EQUAL(
+      AccountStore::GetInstance().GetBalance(sorted.at(10).first), 1010);
+
+  // Out of order, nothing is imported
+  std::vector<std::pair<Address, Account>> unsorted(sorted);
+  std::swap(unsorted.at(3), unsorted.at(4));
+  AccountStore::GetInstance().Init();
+  BOOST_CHECK(!AccountStore::GetInstance().ImportAccounts(makeNext(unsorted)));
+  BOOST_CHECK_EQUAL(AccountStore::GetInstance().GetNumOfAccounts(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(snapshotChunks) {
+  INIT_STDOUT_LOGGER();
+
+  LOG_MARKER();
+
+  AccountStore::GetInstance().Init();
+
+  // Enough accounts to need more than one chunk
+  const unsigned int numAccounts = STATE_SNAPSHOT_CHUNK_ACCOUNTS + 10;
+  for (unsigned int i = 0; i < numAccounts; i++) {
+    PubKey pubKey = Schnorr::GetInstance().GenKeyPair().second;
+    AccountStore::GetInstance().AddAccount(
+        Account::GetAddressFromPublicKey(pubKey), Account(i + 1, i));
+  }
+  AccountStore::GetInstance().UpdateStateTrieAll();
+  const auto root = AccountStore::GetInstance().GetStateRootHash();
+
+  std::vector<bytes> chunks;
+  std::vector<dev::h256> chunkHashes;
+  BOOST_REQUIRE(
+      AccountStore::GetInstance().GetSnapshotChunks(chunks, chunkHashes));
+  BOOST_CHECK_EQUAL(chunks.size(), 2);
+  BOOST_CHECK_EQUAL(chunkHashes.size(), chunks.size());
+
+  // The same state must always give the same chunks
+  std::vector<bytes> chunksAgain;
+  std::vector<dev::h256> chunkHashesAgain;
+  BOOST_REQUIRE(AccountStore::GetInstance().GetSnapshotChunks(
+      chunksAgain, chunkHashesAgain));
+  BOOST_CHECK(chunkHashesAgain == chunkHashes);
+
+  // A tampered chunk is rejected
+  std::vector<bytes> badChunks = chunks;
+  badChunks.back().back() ^= 0x01;
+  BOOST_CHECK(!AccountStore::GetInstance().SetSnapshotChunks(
+      badChunks, chunkHashes, root));
+
+  // So is a state that does not match the expected root
+  BOOST_CHECK(!AccountStore::GetInstance().SetSnapshotChunks(
+      std::vector<bytes>(chunks.begin(), chunks.end() - 1),
+      std::vector<dev::h256>(chunkHashes.begin(), chunkHashes.end() - 1),
+      root));
+
+  BOOST_CHECK(
+      AccountStore::GetInstance().SetSnapshotChunks(chunks, chunkHashes, root));
+  BOOST_CHECK(AccountStore::GetInstance().GetStateRootHash() == root);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "libData/BlockChainData/BlockChainStats.h"
+#include "libUtils/Logger.h"
+
+#define BOOST_TEST_MODULE blockchainstatstest
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(blockchainstatstest)
+
+BOOST_AUTO_TEST_CASE(testRunningTotals) {
+  INIT_STDOUT_LOGGER();
+
+  LOG_MARKER();
+
+  BlockChainStats stats(2);
+  BOOST_CHECK_EQUAL(stats.GetTxnRate(), 0);
+  BOOST_CHECK_EQUAL(stats.GetBlockRate(), 0);
+
+  // Genesis only counts towards the txns
+  stats.OnBlockAdded(0, 0, 7, 0);
+  // One block per second, 10 more txns each time, DS epoch every 3 blocks
+  for (uint64_t i = 1; i <= 6; i++) {
+    stats.OnBlockAdded(i, i * 1000000, 10 * i, (i - 1) / 3 + 1);
+  }
+
+  BOOST_CHECK(stats.GetNumTxns() == 7 + 10 + 20 + 30 + 40 + 50 + 60);
+  BOOST_CHECK_EQUAL(stats.GetFirstBlockNum(), 1u);
+  BOOST_CHECK_CLOSE(stats.GetBlockRate(), 1.0, 0.001);
+  // Blocks 4, 5 and 6
+  BOOST_CHECK_EQUAL(stats.GetNumTxnsDSEpoch(), 40u + 50 + 60);
+  // Blocks 5 and 6 over the two seconds since block 4
+  BOOST_CHECK_CLOSE(stats.GetTxnRate(), (50 + 60) / 2.0, 0.001);
+
+  // Txns of blocks that were never added, like those left on disk
+  stats.AddTxns(5);
+  BOOST_CHECK(stats.GetNumTxns() == 222);
+  BOOST_CHECK_CLOSE(stats.GetTxnRate(), (50 + 60) / 2.0, 0.001);
+
+  stats.Reset();
+  BOOST_CHECK(stats.GetNumTxns() == 0);
+  BOOST_CHECK_EQUAL(stats.GetFirstBlockNum(), 0u);
+  BOOST_CHECK_EQUAL(stats.GetNumTxnsDSEpoch(), 0u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cstdint>
+
+#include "libData/BlockChainData/BlockRangeSums.h"
+#include "libUtils/Logger.h"
+
+#define BOOST_TEST_MODULE blockrangesumstest
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(blockrangesumstest)
+
+BOOST_AUTO_TEST_CASE(testRanges) {
+  INIT_STDOUT_LOGGER();
+
+  LOG_MARKER();
+
+  BlockRangeSums<uint64_t> sums(4);
+  uint64_t sum = 0;
+  BOOST_CHECK(!sums.GetSum(0, 0, sum));
+
+  // Blocks 10 to 15 with values 1 to 6, only the last 4 are kept
+  for (uint64_t i = 10; i <= 15; i++) {
+    sums.OnBlockAdded(i, i - 9);
+  }
+
+  BOOST_CHECK(sums.GetSum(12, 15, sum));
+  BOOST_CHECK_EQUAL(sum, 3u + 4 + 5 + 6);
+  BOOST_CHECK(sums.GetSum(13, 14, sum));
+  BOOST_CHECK_EQUAL(sum, 4u + 5);
+  BOOST_CHECK(sums.GetSum(15, 15, sum));
+  BOOST_CHECK_EQUAL(sum, 6u);
+  // An empty range
+  BOOST_CHECK(sums.GetSum(16, 15, sum));
+  BOOST_CHECK_EQUAL(sum, 0u);
+
+  // Fell out of the window, or not added yet
+  BOOST_CHECK(!sums.GetSum(11, 15, sum));
+  BOOST_CHECK(!sums.GetSum(12, 16, sum));
+}
+
+BOOST_AUTO_TEST_CASE(testStartOver) {
+  BlockRangeSums<uint64_t> sums(8);
+  uint64_t sum = 0;
+
+  for (uint64_t i = 1; i <= 3; i++) {
+    sums.OnBlockAdded(i, 1);
+  }
+
+  // A gap starts over from the new block
+  sums.OnBlockAdded(5, 7);
+  BOOST_CHECK(!sums.GetSum(1, 5, sum));
+  BOOST_CHECK(sums.GetSum(5, 5, sum));
+  BOOST_CHECK_EQUAL(sum, 7u);
+
+  // So does an overflow
+  sums.OnBlockAdded(6, UINT64_MAX);
+  BOOST_CHECK(!sums.GetSum(5, 6, sum));
+  BOOST_CHECK(sums.GetSum(6, 6, sum));
+  BOOST_CHECK_EQUAL(sum, UINT64_MAX);
+
+  sums.Reset();
+  BOOST_CHECK(!sums.GetSum(6, 6, sum));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
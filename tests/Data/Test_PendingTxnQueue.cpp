@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "libCrypto/Schnorr.h"
+#include "libData/AccountData/Account.h"
+#include "libData/AccountData/PendingTxnQueue.h"
+#include "libData/AccountData/Transaction.h"
+#include "libUtils/Logger.h"
+
+#define BOOST_TEST_MODULE pendingtxnqueue
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+using namespace boost::multiprecision;
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(pendingtxnqueue)
+
+Transaction MakeTxn(const PairOfKey& sender, uint64_t nonce,
+                    const uint128_t& gasPrice) {
+  static const PairOfKey receiver = Schnorr::GetInstance().GenKeyPair();
+  return Transaction(DataConversion::Pack(CHAIN_ID, 1), nonce,
+                     Account::GetAddressFromPublicKey(receiver.second), sender,
+                     1, gasPrice, 1, {}, {});
+}
+
+BOOST_AUTO_TEST_CASE(test_ready_order) {
+  INIT_STDOUT_LOGGER();
+
+  const PairOfKey alice = Schnorr::GetInstance().GenKeyPair();
+  const PairOfKey bob = Schnorr::GetInstance().GenKeyPair();
+  const Address aliceAddr = Account::GetAddressFromPublicKey(alice.second);
+  const Address bobAddr = Account::GetAddressFromPublicKey(bob.second);
+
+  PendingTxnQueue queue;
+  const Transaction alice3 = MakeTxn(alice, 3, 10);
+  const Transaction alice4 = MakeTxn(alice, 4, 50);
+  const Transaction bob2 = MakeTxn(bob, 2, 20);
+  queue.Insert(alice4);
+  queue.Insert(alice3);
+  queue.Insert(bob2);
+
+  Transaction t;
+  BOOST_CHECK(!queue.PopReady(t));
+
+  // Only heads carrying the sender's next nonce become ready
+  queue.Promote(aliceAddr, 4);
+  BOOST_CHECK(!queue.PopReady(t));
+  queue.Promote(aliceAddr, 3);
+  queue.Promote(bobAddr, 2);
+
+  BOOST_CHECK(queue.PopReady(t));
+  BOOST_CHECK_EQUAL(t.GetTranID(), bob2.GetTranID());
+  BOOST_CHECK(queue.PopReady(t));
+  BOOST_CHECK_EQUAL(t.GetTranID(), alice3.GetTranID());
+  BOOST_CHECK(!queue.PopReady(t));
+
+  queue.Promote(aliceAddr, 4);
+  BOOST_CHECK(queue.PopReady(t));
+  BOOST_CHECK_EQUAL(t.GetTranID(), alice4.GetTranID());
+  BOOST_CHECK(queue.GetChains().empty());
+}
+
+BOOST_AUTO_TEST_CASE(test_same_nonce) {
+  INIT_STDOUT_LOGGER();
+
+  const PairOfKey alice = Schnorr::GetInstance().GenKeyPair();
+  const Address aliceAddr = Account::GetAddressFromPublicKey(alice.second);
+
+  PendingTxnQueue queue;
+  const Transaction cheap = MakeTxn(alice, 5, 10);
+  const Transaction dear = MakeTxn(alice, 5, 30);
+  queue.Insert(cheap);
+  queue.Promote(aliceAddr, 5);
+
+  // A ready head replaced by a higher gas price stays ready
+  queue.Insert(dear);
+  queue.Insert(MakeTxn(alice, 5, 20));
+
+  Transaction t;
+  BOOST_CHECK(queue.PopReady(t));
+  BOOST_CHECK_EQUAL(t.GetTranID(), dear.GetTranID());
+  BOOST_CHECK(!queue.PopReady(t));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <string>
+
+#include "libData/AccountData/LogEntry.h"
+#include "libData/AccountData/ReceiptCodec.h"
+#include "libData/AccountData/TransactionReceipt.h"
+#include "libUtils/JsonUtils.h"
+#include "libUtils/Logger.h"
+
+#define BOOST_TEST_MODULE receiptcodec
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+
+namespace {
+
+TransactionReceipt MakeReceipt() {
+  TransactionReceipt receipt;
+  receipt.SetResult(true);
+  receipt.SetCumGas(1234);
+  receipt.SetEpochNum(987654321);
+
+  Json::Value event;
+  JSONUtils::convertStrtoJson(
+      "{\"_eventname\":\"Minted\",\"params\":["
+      "{\"vname\":\"to\",\"type\":\"ByStr20\","
+      "\"value\":\"0x0123456789abcdef0123456789abcdef01234567\"},"
+      "{\"vname\":\"amount\",\"type\":\"Uint128\",\"value\":\"0100\"},"
+      "{\"vname\":\"memo\",\"type\":\"String\","
+      "\"value\":\"a \\\"quoted\\\" note\\n\\u00e9\"},"
+      "{\"vname\":\"odd\",\"type\":\"String\",\"value\":\"0xABC\"}]}",
+      event);
+  LogEntry entry;
+  Address address;
+  BOOST_REQUIRE(entry.Install(event, address));
+  receipt.AddEntry(entry);
+  receipt.AddEntry(entry);
+  receipt.update();
+  return receipt;
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(receiptcodec)
+
+BOOST_AUTO_TEST_CASE(test_round_trip_is_exact) {
+  INIT_STDOUT_LOGGER();
+
+  const TransactionReceipt receipt = MakeReceipt();
+  bytes binary;
+  BOOST_REQUIRE(ReceiptCodec::Encode(receipt.GetString(), binary));
+  BOOST_CHECK_LT(binary.size(), receipt.GetString().size() * 2 / 3);
+
+  string json;
+  BOOST_REQUIRE(ReceiptCodec::Decode(binary, json));
+  BOOST_CHECK_EQUAL(json, receipt.GetString());
+
+  // Odd spellings of numbers and hex stay as they were
+  for (const string& text :
+       {string("{\"a\":\"007\",\"b\":\"0x\",\"c\":\"0xabc\",\"d\":\"0XAB\"}"),
+        string("{\t\t\t\"e\":\"18446744073709551615\",\"f\":[true,1.5]}"),
+        string(300, '\t'), string("{}")}) {
+    BOOST_REQUIRE(ReceiptCodec::Encode(text, binary));
+    BOOST_REQUIRE(ReceiptCodec::Decode(binary, json));
+    BOOST_CHECK_EQUAL(json, text);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(test_bad_input_is_refused) {
+  INIT_STDOUT_LOGGER();
+
+  bytes binary;
+  BOOST_CHECK(!ReceiptCodec::Encode("{\"unterminated}", binary));
+  BOOST_CHECK(!ReceiptCodec::Encode(string("{\x02}"), binary));
+
+  string json;
+  BOOST_CHECK(!ReceiptCodec::Decode(bytes(), json));
+  BOOST_CHECK(!ReceiptCodec::Decode(bytes{0x7f, '{', '}'}, json));
+  BOOST_CHECK(!ReceiptCodec::Decode(bytes{0x01, 0x01, 0x05, 'a'}, json));
+  BOOST_CHECK(!ReceiptCodec::Decode(bytes{0x01, 0x04, 0xff}, json));
+}
+
+BOOST_AUTO_TEST_CASE(test_receipt_parses_lazily) {
+  INIT_STDOUT_LOGGER();
+
+  const TransactionReceipt original = MakeReceipt();
+  bytes binary;
+  BOOST_REQUIRE(original.GetBinary(binary));
+
+  TransactionReceipt receipt;
+  BOOST_REQUIRE(receipt.SetBinary(binary, original.GetCumGas()));
+  BOOST_CHECK_EQUAL(receipt.GetString(), original.GetString());
+  BOOST_CHECK_EQUAL(receipt.GetCumGas(), original.GetCumGas());
+
+  // As a receipt stored as JSON reads back, spaces in strings stripped
+  Json::Value expected;
+  BOOST_REQUIRE(JSONUtils::convertStrtoJson(original.GetString(), expected));
+  const TransactionReceipt copy = receipt;
+  BOOST_CHECK(receipt.GetJsonValue() == expected);
+  BOOST_CHECK(copy.GetJsonValue() == expected);
+  BOOST_CHECK_EQUAL(&receipt.GetJsonValue(), &receipt.GetJsonValue());
+
+  // Changes apply on top of the parsed receipt
+  receipt.SetResult(false);
+  receipt.update();
+  BOOST_CHECK(!receipt.GetJsonValue()["success"].asBool());
+  BOOST_CHECK_EQUAL(receipt.GetJsonValue()["epoch_num"].asString(),
+                    "987654321");
+  BOOST_CHECK_EQUAL(receipt.GetJsonValue()["event_logs"].size(), 2);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <boost/filesystem.hpp>
+#include <string>
+
+#include "libData/AccountData/Account.h"
+#include "libData/AccountData/ScillaCodeCache.h"
+#include "libUtils/Logger.h"
+
+#define BOOST_TEST_MODULE scillacodecache
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(scillacodecache)
+
+Account MakeContract(const string& code) {
+  Account account(0, 0);
+  account.SetCode(bytes(code.begin(), code.end()));
+  return account;
+}
+
+BOOST_AUTO_TEST_CASE(test_reuse_and_evict) {
+  INIT_STDOUT_LOGGER();
+
+  ScillaCodeCache cache(2);
+  Account a = MakeContract("contract A()");
+  Account b = MakeContract("contract B()");
+  Account c = MakeContract("contract C()");
+
+  const string pathA = cache.GetCodePath(a);
+  BOOST_REQUIRE(!pathA.empty());
+  BOOST_CHECK(boost::filesystem::exists(pathA));
+  BOOST_CHECK_EQUAL(cache.GetCodePath(a), pathA);
+
+  // Same code under another account shares the entry
+  Account a2 = MakeContract("contract A()");
+  BOOST_CHECK_EQUAL(cache.GetCodePath(a2), pathA);
+  BOOST_CHECK_EQUAL(cache.Size(), 1);
+
+  const string pathB = cache.GetCodePath(b);
+  BOOST_CHECK(pathB != pathA);
+
+  // A was used last before B, then C pushes out the least recent one
+  cache.GetCodePath(a);
+  const string pathC = cache.GetCodePath(c);
+  BOOST_CHECK_EQUAL(cache.Size(), 2);
+  BOOST_CHECK(boost::filesystem::exists(pathA));
+  BOOST_CHECK(!boost::filesystem::exists(pathB));
+  BOOST_CHECK(boost::filesystem::exists(pathC));
+
+  // A file removed behind the cache's back is written again
+  boost::filesystem::remove(pathA);
+  BOOST_CHECK_EQUAL(cache.GetCodePath(a), pathA);
+  BOOST_CHECK(boost::filesystem::exists(pathA));
+
+  cache.Clear();
+  BOOST_CHECK_EQUAL(cache.Size(), 0);
+  BOOST_CHECK(!boost::filesystem::exists(pathA));
+  BOOST_CHECK(!boost::filesystem::exists(pathC));
+}
+
+BOOST_AUTO_TEST_CASE(test_disabled) {
+  INIT_STDOUT_LOGGER();
+
+  ScillaCodeCache cache(0);
+  Account a = MakeContract("contract A()");
+  BOOST_CHECK_EQUAL(cache.GetCodePath(a), INPUT_CODE);
+  BOOST_CHECK_EQUAL(cache.Size(), 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -23,6 +23,7 @@
 #include "libData/AccountData/Account.h"
 #include "libData/AccountData/Address.h"
 #include "libData/AccountData/Transaction.h"
+#include "libMessage/Messenger.h"
 #include "libTestUtils/TestUtils.h"
 #include "libUtils/DataConversion.h"
 #include "libUtils/Logger.h"
@@ -196,4 +197,65 @@ BOOST_AUTO_TEST_CASE(testOperators) {
   BOOST_CHECK_MESSAGE(tx1 < tx3, "Less-than operator failed");
 }
 
+BOOST_AUTO_TEST_CASE(testSharedPayload) {
+  INIT_STDOUT_LOGGER();
+  LOG_MARKER();
+
+  PairOfKey kp = TestUtils::GenerateRandomKeyPair();
+  const bytes code = TestUtils::GenerateRandomCharVector(64);
+
+  Transaction tx1(TxnHash(), 1, 5, Address(), kp.second, 10, 20, 30, code, {},
+                  Signature());
+  Transaction tx2 = tx1;
+
+  BOOST_CHECK_MESSAGE(tx2.GetCode() == code, "Code not copied");
+  BOOST_CHECK_MESSAGE(&tx1.GetCode() == &tx2.GetCode(),
+                      "Copies should share the code payload");
+  BOOST_CHECK_MESSAGE(&tx1.GetSenderPubKey() == &tx2.GetSenderPubKey(),
+                      "Copies should share the sender key");
+  BOOST_CHECK_MESSAGE(!tx1.GetCoreInfo().data && tx1.GetData().empty(),
+                      "Empty data should not be allocated");
+
+  // The shared payloads must serialize exactly like the original fields
+  bytes serialized;
+  BOOST_REQUIRE(tx1.SerializeCoreFields(serialized, 0));
+  TransactionCoreInfo coreInfo;
+  BOOST_REQUIRE(Messenger::GetTransactionCoreInfo(serialized, 0, coreInfo));
+  BOOST_CHECK_MESSAGE(coreInfo.GetCode() == code,
+                      "Round trip changed the code");
+  BOOST_CHECK_MESSAGE(coreInfo.GetSenderPubKey() == kp.second,
+                      "Round trip changed the sender key");
+  BOOST_CHECK_MESSAGE(!coreInfo.data, "Round trip allocated empty data");
+  bytes reserialized;
+  BOOST_REQUIRE(Messenger::SetTransactionCoreInfo(reserialized, 0, coreInfo));
+  BOOST_CHECK_MESSAGE(reserialized == serialized,
+                      "Round trip changed the encoding");
+
+  Transaction tx4(move(tx2));
+  BOOST_CHECK_MESSAGE(tx4.GetCode() == code, "Move lost the code");
+}
+
+BOOST_AUTO_TEST_CASE(testSenderAddr) {
+  INIT_STDOUT_LOGGER();
+  LOG_MARKER();
+
+  PairOfKey kp = TestUtils::GenerateRandomKeyPair();
+  const Address expected = Account::GetAddressFromPublicKey(kp.second);
+
+  Transaction tx1(1, 5, Address(), kp, 10, 20, 30, {}, {});
+  BOOST_CHECK_EQUAL(tx1.GetSenderAddr(), expected);
+  BOOST_CHECK_EQUAL(tx1.GetSenderShardIndex(3),
+                    Transaction::GetShardIndex(expected, 3));
+
+  Transaction tx2 = tx1;
+  BOOST_CHECK_EQUAL(tx2.GetSenderAddr(), expected);
+
+  // Derived again from the key when deserialized
+  bytes serialized;
+  BOOST_REQUIRE(tx1.Serialize(serialized, 0));
+  Transaction tx3;
+  BOOST_REQUIRE(tx3.Deserialize(serialized, 0));
+  BOOST_CHECK_EQUAL(tx3.GetSenderAddr(), expected);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
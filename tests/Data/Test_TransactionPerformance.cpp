@@ -16,12 +16,15 @@
  */
 
 #include <array>
+#include <chrono>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include "libCrypto/Schnorr.h"
 #include "libData/AccountData/Account.h"
 #include "libData/AccountData/Address.h"
 #include "libData/AccountData/Transaction.h"
+#include "libData/AccountData/TxnPool.h"
 #include "libUtils/Logger.h"
 
 #define BOOST_TEST_MODULE transactiontest
@@ -224,4 +227,72 @@ BOOST_AUTO_TEST_CASE(GenTxn1000) {
                 << " ms");
 }
 
+// Sender and nonce index as TxnPool kept it before: each key holds a PubKey
+// copy, so building one allocates an EC point
+struct LegacyPubKeyNonceHash {
+  std::size_t operator()(const std::pair<PubKey, uint64_t>& p) const {
+    std::size_t seed = 0;
+    boost::hash_combine(seed, std::hash<PubKey>()(p.first));
+    boost::hash_combine(seed, p.second);
+
+    return seed;
+  }
+};
+
+BOOST_AUTO_TEST_CASE(TxnPoolThroughput) {
+  INIT_STDOUT_LOGGER();
+  const auto n = 2000u;
+  const auto rounds = 50u;
+  auto sender = Schnorr::GetInstance().GenKeyPair();
+  auto receiver = Schnorr::GetInstance().GenKeyPair();
+  const auto txns = GenWithDummyValue(sender, receiver, n);
+
+  unsigned int found = 0;
+  auto t_start = std::chrono::high_resolution_clock::now();
+  for (auto r = 0u; r < rounds; r++) {
+    std::unordered_map<std::pair<PubKey, uint64_t>, unsigned int,
+                       LegacyPubKeyNonceHash>
+        index;
+    for (auto i = 0u; i < n; i++) {
+      index.emplace(std::make_pair(txns[i].GetSenderPubKey(),
+                                   txns[i].GetNonce()),
+                    i);
+    }
+    for (const auto& t : txns) {
+      found += index.count({t.GetSenderPubKey(), t.GetNonce()});
+    }
+  }
+  auto t_end = std::chrono::high_resolution_clock::now();
+  BOOST_CHECK_EQUAL(found, n * rounds);
+
+  LOG_GENERAL(
+      INFO, "PubKey nonce index: "
+                << n * rounds * 2 /
+                       std::chrono::duration<double>(t_end - t_start).count()
+                << " inserts+lookups/s");
+
+  found = 0;
+  t_start = std::chrono::high_resolution_clock::now();
+  for (auto r = 0u; r < rounds; r++) {
+    TxnPool pool(n);
+    for (const auto& t : txns) {
+      pool.insert(t);
+    }
+    for (const auto& t : txns) {
+      // Looks the txn up by sender and nonce; the pooled one is not dearer
+      Transaction same = t;
+      pool.findSameNonceButHigherGas(same);
+      found += pool.exist(same.GetTranID());
+    }
+  }
+  t_end = std::chrono::high_resolution_clock::now();
+  BOOST_CHECK_EQUAL(found, n * rounds);
+
+  LOG_GENERAL(
+      INFO, "TxnPool: " << n * rounds * 2 /
+                               std::chrono::duration<double>(t_end - t_start)
+                                   .count()
+                        << " inserts+lookups/s");
+}
+
 BOOST_AUTO_TEST_SUITE_END()
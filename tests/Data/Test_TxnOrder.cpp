@@ -16,6 +16,7 @@
  */
 
 #include <algorithm>
+#include <chrono>
 #include <cstdlib>
 #include <vector>
 #include "libCrypto/Schnorr.h"
@@ -152,4 +153,79 @@ BOOST_AUTO_TEST_CASE(GenTxn1000) {
   }
 }
 
+std::vector<TxnHash> GenHashes(size_t n) {
+  std::vector<TxnHash> hashes;
+  hashes.reserve(n);
+  for (size_t i = 0; i < n; i++) {
+    TxnHash hash;
+    for (unsigned int j = 0; j < 8; j++) {
+      hash[j] = (i >> (8 * j)) & 0xFF;
+    }
+    hashes.emplace_back(hash);
+  }
+  return hashes;
+}
+
+BOOST_AUTO_TEST_CASE(LongestInOrder) {
+  INIT_STDOUT_LOGGER();
+
+  // One txn moved from the front to the back leaves 9 of 10 in order
+  auto expected = GenHashes(10);
+  std::vector<TxnHash> received(expected.begin() + 1, expected.end());
+  received.emplace_back(expected.front());
+
+  TxnOrderIndex index;
+  index.Build(received);
+  std::vector<TxnHash> mismatched;
+  BOOST_CHECK(VerifyTxnOrderWTolerance(expected, index, 10, &mismatched));
+  BOOST_REQUIRE_EQUAL(mismatched.size(), 1);
+  BOOST_CHECK(mismatched.front() == expected.front());
+  BOOST_CHECK(!VerifyTxnOrderWTolerance(expected, index, 0, &mismatched));
+
+  // Missing txns count as mismatched too
+  received.assign(expected.begin(), expected.begin() + 8);
+  index.Build(received);
+  BOOST_CHECK(VerifyTxnOrderWTolerance(expected, index, 20, &mismatched));
+  BOOST_REQUIRE_EQUAL(mismatched.size(), 2);
+  BOOST_CHECK(mismatched[0] == expected[8]);
+  BOOST_CHECK(mismatched[1] == expected[9]);
+  BOOST_CHECK(!VerifyTxnOrderWTolerance(expected, index, 19, &mismatched));
+
+  // Fully reversed, only one txn is in order
+  received.assign(expected.rbegin(), expected.rend());
+  index.Build(received);
+  BOOST_CHECK(!VerifyTxnOrderWTolerance(expected, index, 80, &mismatched));
+  BOOST_CHECK_EQUAL(mismatched.size(), 9);
+  BOOST_CHECK(VerifyTxnOrderWTolerance(expected, index, 90, &mismatched));
+
+  BOOST_CHECK(VerifyTxnOrderWTolerance({}, std::vector<TxnHash>{}, 0));
+  BOOST_CHECK(!VerifyTxnOrderWTolerance({}, expected, 0));
+}
+
+BOOST_AUTO_TEST_CASE(Benchmark50k) {
+  INIT_STDOUT_LOGGER();
+
+  const size_t n = 50000;
+  auto expected = GenHashes(n);
+  auto received = expected;
+  // Swap neighbours throughout, about as far as a leader strays in practice
+  for (size_t i = 0; i + 1 < n; i += 20) {
+    std::swap(received[i], received[i + 1]);
+  }
+
+  TxnOrderIndex index;
+  const unsigned int rounds = 10;
+  auto start = std::chrono::steady_clock::now();
+  for (unsigned int i = 0; i < rounds; i++) {
+    index.Build(received);
+    BOOST_CHECK(VerifyTxnOrderWTolerance(expected, index,
+                                         TXN_MISORDER_TOLERANCE_IN_PERCENT));
+  }
+  auto elapsed = std::chrono::duration<double, std::milli>(
+                     std::chrono::steady_clock::now() - start)
+                     .count();
+  LOG_GENERAL(INFO, "Verified " << n << " txns in " << elapsed / rounds
+                                << " ms on average");
+}
+
 BOOST_AUTO_TEST_SUITE_END()
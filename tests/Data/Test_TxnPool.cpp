@@ -0,0 +1,280 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <algorithm>
+#include <vector>
+
+#include "libCrypto/Schnorr.h"
+#include "libData/AccountData/Account.h"
+#include "libData/AccountData/Transaction.h"
+#include "libData/AccountData/TxnPool.h"
+#include "libUtils/Logger.h"
+
+#define BOOST_TEST_MODULE txnpool
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+using namespace boost::multiprecision;
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(txnpool)
+
+Transaction MakeTxn(const PairOfKey& sender, uint64_t nonce,
+                    const uint128_t& gasPrice, const bytes& data = {}) {
+  static const PairOfKey receiver = Schnorr::GetInstance().GenKeyPair();
+  return Transaction(DataConversion::Pack(CHAIN_ID, 1), nonce,
+                     Account::GetAddressFromPublicKey(receiver.second), sender,
+                     1, gasPrice, 1, {}, data);
+}
+
+BOOST_AUTO_TEST_CASE(test_gas_order) {
+  INIT_STDOUT_LOGGER();
+
+  TxnPool pool(10);
+  const PairOfKey sender = Schnorr::GetInstance().GenKeyPair();
+
+  const Transaction low = MakeTxn(sender, 1, 10);
+  const Transaction high = MakeTxn(sender, 2, 30);
+  const Transaction mid = MakeTxn(sender, 3, 20);
+
+  BOOST_CHECK(pool.insert(low));
+  BOOST_CHECK(pool.insert(high));
+  BOOST_CHECK(pool.insert(mid));
+  BOOST_CHECK(!pool.insert(mid));
+  BOOST_CHECK_EQUAL(pool.size(), 3);
+
+  // Same nonce with a higher gas price replaces the pooled txn
+  const Transaction lowReplaced = MakeTxn(sender, 1, 40);
+  BOOST_CHECK(pool.insert(lowReplaced));
+  BOOST_CHECK_EQUAL(pool.size(), 3);
+  BOOST_CHECK(!pool.exist(low.GetTranID()));
+
+  Transaction t;
+  BOOST_CHECK(pool.findOne(t));
+  BOOST_CHECK_EQUAL(t.GetTranID(), lowReplaced.GetTranID());
+  BOOST_CHECK(pool.findOne(t));
+  BOOST_CHECK_EQUAL(t.GetTranID(), high.GetTranID());
+  BOOST_CHECK(pool.findOne(t));
+  BOOST_CHECK_EQUAL(t.GetTranID(), mid.GetTranID());
+  BOOST_CHECK(!pool.findOne(t));
+  BOOST_CHECK_EQUAL(pool.size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_capacity) {
+  INIT_STDOUT_LOGGER();
+
+  TxnPool pool(2);
+  const PairOfKey sender = Schnorr::GetInstance().GenKeyPair();
+
+  const Transaction first = MakeTxn(sender, 1, 20);
+  const Transaction second = MakeTxn(sender, 2, 10);
+  BOOST_CHECK(pool.insert(first));
+  BOOST_CHECK_EQUAL(pool.marginalGasPrice(), 0);
+  BOOST_CHECK(pool.insert(second));
+  BOOST_CHECK_EQUAL(pool.marginalGasPrice(), 10);
+
+  // A full pool rejects txns that do not pay more than its cheapest one
+  BOOST_CHECK(!pool.insert(MakeTxn(sender, 3, 10)));
+
+  // and evicts the cheapest one for txns that do
+  const Transaction third = MakeTxn(sender, 3, 15);
+  BOOST_CHECK(pool.insert(third));
+  BOOST_CHECK_EQUAL(pool.size(), 2);
+  BOOST_CHECK(!pool.exist(second.GetTranID()));
+  BOOST_CHECK(pool.exist(first.GetTranID()));
+  BOOST_CHECK(pool.exist(third.GetTranID()));
+}
+
+BOOST_AUTO_TEST_CASE(test_sender_quota) {
+  INIT_STDOUT_LOGGER();
+
+  TxnPool pool(10, 2, 0);
+  const PairOfKey sender = Schnorr::GetInstance().GenKeyPair();
+  const PairOfKey other = Schnorr::GetInstance().GenKeyPair();
+
+  BOOST_CHECK(pool.insert(MakeTxn(sender, 1, 10)));
+  BOOST_CHECK(pool.insert(MakeTxn(sender, 2, 10)));
+
+  const Transaction overQuota = MakeTxn(sender, 3, 50);
+  BOOST_CHECK(!pool.admit(overQuota));
+  BOOST_CHECK(!pool.insert(overQuota));
+
+  // Replacing a pooled nonce does not count against the quota
+  const Transaction replacement = MakeTxn(sender, 1, 20);
+  BOOST_CHECK(pool.admit(replacement));
+  BOOST_CHECK(pool.insert(replacement));
+  BOOST_CHECK(!pool.admit(MakeTxn(sender, 2, 5)));
+
+  BOOST_CHECK(pool.admit(MakeTxn(other, 1, 10)));
+
+  // Taking a txn out for good frees its share of the quota
+  Transaction t;
+  BOOST_CHECK(pool.findOne(t));
+  BOOST_CHECK_EQUAL(t.GetTranID(), replacement.GetTranID());
+  BOOST_CHECK(pool.admit(overQuota));
+  BOOST_CHECK(pool.insert(overQuota));
+}
+
+BOOST_AUTO_TEST_CASE(test_memory_budget) {
+  INIT_STDOUT_LOGGER();
+
+  // Room for two of these txns, whatever the per-txn overhead
+  const bytes data(10000, 0x5a);
+  TxnPool pool(10, 0, 25000);
+  const PairOfKey sender = Schnorr::GetInstance().GenKeyPair();
+
+  const Transaction first = MakeTxn(sender, 1, 20, data);
+  const Transaction second = MakeTxn(sender, 2, 10, data);
+  BOOST_CHECK(pool.insert(first));
+  BOOST_CHECK(pool.insert(second));
+
+  // Small txns still fit, large ones have to outbid the cheapest
+  BOOST_CHECK(pool.admit(MakeTxn(sender, 3, 1)));
+  BOOST_CHECK(!pool.admit(MakeTxn(sender, 3, 10, data)));
+  BOOST_CHECK(!pool.insert(MakeTxn(sender, 3, 10, data)));
+
+  const Transaction third = MakeTxn(sender, 3, 15, data);
+  BOOST_CHECK(pool.admit(third));
+  BOOST_CHECK(pool.insert(third));
+  BOOST_CHECK_EQUAL(pool.size(), 2);
+  BOOST_CHECK(!pool.exist(second.GetTranID()));
+
+  // A txn larger than the whole budget never fits
+  BOOST_CHECK(!pool.admit(MakeTxn(sender, 4, 100, bytes(30000, 0x5a))));
+
+  pool.clear();
+  BOOST_CHECK(pool.insert(second));
+}
+
+BOOST_AUTO_TEST_CASE(test_take) {
+  INIT_STDOUT_LOGGER();
+
+  TxnPool pool(10);
+  const PairOfKey sender = Schnorr::GetInstance().GenKeyPair();
+
+  vector<Transaction> txns;
+  for (unsigned int i = 0; i < 4; i++) {
+    txns.emplace_back(MakeTxn(sender, i + 1, 10 + i));
+    pool.insert(txns.back());
+  }
+
+  Transaction t;
+  pool.beginTake();
+  BOOST_CHECK(pool.findOne(t));
+  BOOST_CHECK(pool.findOne(t));
+  BOOST_CHECK_EQUAL(pool.size(), 2);
+
+  // Taken txns can still be looked up
+  BOOST_CHECK(pool.exist(txns[3].GetTranID()));
+  BOOST_CHECK(pool.get(txns[3].GetTranID(), t));
+  BOOST_CHECK(!pool.insert(txns[3]));
+
+  pool.rollbackTake();
+  BOOST_CHECK_EQUAL(pool.size(), 4);
+
+  // Starting a new take returns the txns of an unfinished one
+  pool.beginTake();
+  BOOST_CHECK(pool.findOne(t));
+  pool.beginTake();
+  BOOST_CHECK(pool.findOne(t));
+  BOOST_CHECK_EQUAL(t.GetTranID(), txns[3].GetTranID());
+  BOOST_CHECK(pool.findOne(t));
+  BOOST_CHECK(pool.putBack(t));
+  BOOST_CHECK(!pool.putBack(t));
+  pool.commitTake();
+
+  BOOST_CHECK_EQUAL(pool.size(), 3);
+  BOOST_CHECK(!pool.exist(txns[3].GetTranID()));
+  BOOST_CHECK(pool.exist(txns[2].GetTranID()));
+
+  BOOST_CHECK(pool.findOne(t));
+  BOOST_CHECK_EQUAL(t.GetTranID(), txns[2].GetTranID());
+}
+
+BOOST_AUTO_TEST_CASE(test_find_by_hash) {
+  INIT_STDOUT_LOGGER();
+
+  TxnPool pool(10);
+  const PairOfKey sender = Schnorr::GetInstance().GenKeyPair();
+
+  vector<Transaction> txns;
+  for (unsigned int i = 0; i < 3; i++) {
+    txns.emplace_back(MakeTxn(sender, i + 1, 10 + i));
+    pool.insert(txns.back());
+  }
+
+  Transaction t;
+  pool.beginTake();
+  BOOST_CHECK(pool.findByHash(txns[0].GetTranID(), t));
+  BOOST_CHECK_EQUAL(t.GetTranID(), txns[0].GetTranID());
+  BOOST_CHECK(!pool.findByHash(txns[0].GetTranID(), t));
+  BOOST_CHECK(!pool.findByHash(MakeTxn(sender, 9, 1).GetTranID(), t));
+  BOOST_CHECK_EQUAL(pool.size(), 2);
+
+  // The txn is no longer handed out by findOne
+  BOOST_CHECK(pool.findOne(t));
+  BOOST_CHECK_EQUAL(t.GetTranID(), txns[2].GetTranID());
+  BOOST_CHECK(pool.findOne(t));
+  BOOST_CHECK_EQUAL(t.GetTranID(), txns[1].GetTranID());
+  BOOST_CHECK(!pool.findOne(t));
+
+  pool.rollbackTake();
+  BOOST_CHECK_EQUAL(pool.size(), 3);
+}
+
+BOOST_AUTO_TEST_CASE(test_short_hashes) {
+  INIT_STDOUT_LOGGER();
+
+  TxnPool pool(10);
+  const PairOfKey sender = Schnorr::GetInstance().GenKeyPair();
+
+  vector<Transaction> txns;
+  for (unsigned int i = 0; i < 3; i++) {
+    txns.emplace_back(MakeTxn(sender, i + 1, 10 + i));
+    pool.insert(txns.back());
+  }
+
+  // Taken txns are still listed and handed out
+  Transaction t;
+  pool.beginTake();
+  BOOST_CHECK(pool.findByHash(txns[0].GetTranID(), t));
+
+  const vector<uint64_t> shortHashes = pool.shortHashes();
+  BOOST_CHECK_EQUAL(shortHashes.size(), 3);
+  for (const auto& txn : txns) {
+    BOOST_CHECK(find(shortHashes.begin(), shortHashes.end(),
+                     TxnPool::shortHash(txn.GetTranID())) !=
+                shortHashes.end());
+  }
+
+  vector<Transaction> found;
+  pool.getByShortHashes({TxnPool::shortHash(txns[0].GetTranID()),
+                         TxnPool::shortHash(txns[2].GetTranID()),
+                         TxnPool::shortHash(MakeTxn(sender, 9, 1).GetTranID())},
+                        found);
+  BOOST_REQUIRE_EQUAL(found.size(), 2);
+  BOOST_CHECK(found[0].GetTranID() != found[1].GetTranID());
+  for (const auto& txn : found) {
+    BOOST_CHECK(txn.GetTranID() == txns[0].GetTranID() ||
+                txn.GetTranID() == txns[2].GetTranID());
+  }
+
+  pool.rollbackTake();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "libDirectoryService/MicroBlockSet.h"
+#include "libTestUtils/TestUtils.h"
+#include "libUtils/Logger.h"
+
+#define BOOST_TEST_MODULE microblockset
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+using namespace boost::multiprecision;
+
+namespace {
+
+MicroBlock MakeMicroBlock(uint32_t shardId, uint64_t gasLimit, uint64_t gasUsed,
+                          const uint128_t& rewards, uint32_t numTxs) {
+  MicroBlockHeader header(shardId, gasLimit, gasUsed, rewards, 1,
+                          MicroBlockHashSet(), numTxs,
+                          TestUtils::GenerateRandomPubKey(), 1);
+  return MicroBlock(header, vector<TxnHash>(numTxs),
+                    TestUtils::GenerateRandomCoSignatures());
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(microblockset)
+
+BOOST_AUTO_TEST_CASE(indexAndTotals) {
+  INIT_STDOUT_LOGGER();
+
+  MicroBlockSet microBlocks;
+  vector<MicroBlock> added;
+  for (uint32_t i = 0; i < 5; i++) {
+    added.emplace_back(MakeMicroBlock(i, 100 + i, 10 + i, 1000 + i, i + 1));
+    BOOST_CHECK(microBlocks.emplace(added.back()).second);
+  }
+  BOOST_CHECK(!microBlocks.emplace(added.front()).second);
+  BOOST_CHECK_EQUAL(microBlocks.size(), added.size());
+
+  for (const auto& microBlock : added) {
+    const MicroBlock* found = microBlocks.Find(microBlock.GetBlockHash());
+    BOOST_REQUIRE(found != nullptr);
+    BOOST_CHECK(*found == microBlock);
+  }
+  BOOST_CHECK(microBlocks.Find(BlockHash()) == nullptr);
+
+  const auto& totals = microBlocks.GetTotals();
+  BOOST_CHECK_EQUAL(totals.m_gasLimit, 510);
+  BOOST_CHECK_EQUAL(totals.m_gasUsed, 60);
+  BOOST_CHECK(totals.m_rewards == 5010);
+  BOOST_CHECK_EQUAL(totals.m_numTxns, 15);
+
+  auto it = microBlocks.begin();
+  const BlockHash erased = it->GetBlockHash();
+  const uint64_t erasedGasLimit = it->GetHeader().GetGasLimit();
+  microBlocks.erase(it);
+  BOOST_CHECK(microBlocks.Find(erased) == nullptr);
+  BOOST_CHECK_EQUAL(microBlocks.size(), added.size() - 1);
+  BOOST_CHECK_EQUAL(microBlocks.GetTotals().m_gasLimit, 510 - erasedGasLimit);
+
+  microBlocks.clear();
+  BOOST_CHECK(microBlocks.empty());
+  BOOST_CHECK(microBlocks.Find(added.back().GetBlockHash()) == nullptr);
+  BOOST_CHECK_EQUAL(microBlocks.GetTotals().m_numTxns, 0);
+}
+
+BOOST_AUTO_TEST_CASE(overflowingMicroBlockOnlyCountsTxns) {
+  INIT_STDOUT_LOGGER();
+
+  MicroBlockSet microBlocks;
+  microBlocks.emplace(MakeMicroBlock(0, 100, 10, 1000, 2));
+  microBlocks.emplace(
+      MakeMicroBlock(1, numeric_limits<uint64_t>::max(), 10, 1000, 3));
+
+  const auto& totals = microBlocks.GetTotals();
+  BOOST_CHECK_EQUAL(totals.m_gasLimit, 100);
+  BOOST_CHECK_EQUAL(totals.m_gasUsed, 10);
+  BOOST_CHECK(totals.m_rewards == 1000);
+  BOOST_CHECK_EQUAL(totals.m_numTxns, 5);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,257 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <chrono>
+#include <functional>
+#include <map>
+#include <set>
+#include "libDirectoryService/PoWOrdering.h"
+#include "libTestUtils/TestUtils.h"
+#include "libUtils/HashUtils.h"
+#include "libUtils/Logger.h"
+
+#define BOOST_TEST_MODULE powordering
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+
+namespace {
+
+using PoWHash = PoWOrdering::PoWHash;
+
+PoWHash RandomHash() {
+  PoWHash hash;
+  for (auto& c : hash) {
+    c = TestUtils::DistUint8();
+  }
+  return hash;
+}
+
+MapOfPubKeyPoW GeneratePoWs(unsigned int n) {
+  MapOfPubKeyPoW pows;
+  while (pows.size() < n) {
+    PoWSolution soln;
+    soln.result = RandomHash();
+    pows.emplace(TestUtils::GenerateRandomPubKey(), soln);
+  }
+  return pows;
+}
+
+// The map-based orderings the vector pipeline replaces
+VectorOfPoWSoln ReferenceSort(const MapOfPubKeyPoW& pows) {
+  map<PoWHash, PubKey> sorter;
+  for (const auto& powsoln : pows) {
+    sorter[powsoln.second.result] = powsoln.first;
+  }
+  return VectorOfPoWSoln(sorter.begin(), sorter.end());
+}
+
+VectorOfPoWSoln ReferenceTrimWithGuards(
+    const VectorOfPoWSoln& sorted, uint32_t numNodes, uint32_t guardCount,
+    const function<bool(const PubKey&)>& isShardGuard) {
+  map<PoWHash, PubKey> sorter(sorted.begin(), sorted.end());
+  map<PoWHash, PubKey> filtered;
+  map<PoWHash, PubKey> shadow = sorter;
+  uint32_t count = 0;
+  for (auto kv = sorter.begin(); (kv != sorter.end()) && (count < numNodes);
+       kv++) {
+    if (isShardGuard(kv->second)) {
+      if (count == guardCount) {
+        break;
+      }
+      filtered.emplace(*kv);
+      shadow.erase(kv->first);
+      count++;
+    }
+  }
+  for (auto kv = shadow.begin(); (kv != shadow.end()) && (count < numNodes);
+       kv++) {
+    filtered.emplace(*kv);
+    count++;
+  }
+  return VectorOfPoWSoln(filtered.begin(), filtered.end());
+}
+
+vector<PubKey> ReferenceShardingOrder(const VectorOfPoWSoln& sorted,
+                                      const bytes& lastBlockHash) {
+  map<PoWHash, PubKey> sortedPoWs;
+  bytes hashVec(lastBlockHash);
+  hashVec.resize(lastBlockHash.size() + POW_SIZE);
+  for (const auto& kv : sorted) {
+    copy(kv.first.begin(), kv.first.end(), hashVec.end() - POW_SIZE);
+    const bytes& sortHashVec = HashUtils::BytesToHash(hashVec);
+    PoWHash sortHash;
+    copy(sortHashVec.begin(), sortHashVec.end(), sortHash.begin());
+    sortedPoWs.emplace(sortHash, kv.second);
+  }
+
+  vector<PubKey> order;
+  for (const auto& kv : sortedPoWs) {
+    order.emplace_back(kv.second);
+  }
+  return order;
+}
+
+vector<PubKey> KeysInOrder(const VectorOfPoWSoln& sorted,
+                           const vector<uint32_t>& order) {
+  vector<PubKey> keys;
+  for (const auto index : order) {
+    keys.emplace_back(sorted.at(index).second);
+  }
+  return keys;
+}
+
+int64_t ElapsedMicroseconds(const function<void()>& op) {
+  auto start = chrono::high_resolution_clock::now();
+  op();
+  return chrono::duration_cast<chrono::microseconds>(
+             chrono::high_resolution_clock::now() - start)
+      .count();
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(powordering)
+
+BOOST_AUTO_TEST_CASE(test_SortByResult) {
+  INIT_STDOUT_LOGGER();
+
+  auto pows = GeneratePoWs(500);
+
+  // Solutions sharing a result keep only the greatest key
+  auto it = pows.begin();
+  const PoWHash shared = it->second.result;
+  for (unsigned int i = 0; i < 3; i++) {
+    (++it)->second.result = shared;
+  }
+
+  const auto sorted = PoWOrdering::SortByResult(pows);
+  BOOST_CHECK(sorted == ReferenceSort(pows));
+  BOOST_CHECK_EQUAL(sorted.size(), pows.size() - 3);
+}
+
+BOOST_AUTO_TEST_CASE(test_Trim) {
+  INIT_STDOUT_LOGGER();
+
+  const auto sorted = PoWOrdering::SortByResult(GeneratePoWs(300));
+
+  BOOST_CHECK(PoWOrdering::Trim(sorted, 1000) == sorted);
+  const auto trimmed = PoWOrdering::Trim(sorted, 100);
+  BOOST_CHECK(trimmed == VectorOfPoWSoln(sorted.begin(), sorted.begin() + 100));
+
+  // Every third key acts as a shard guard
+  set<PubKey> guards;
+  for (size_t i = 0; i < sorted.size(); i += 3) {
+    guards.emplace(sorted[i].second);
+  }
+  auto isShardGuard = [&guards](const PubKey& key) {
+    return guards.count(key) > 0;
+  };
+
+  for (const auto& counts : vector<pair<uint32_t, uint32_t>>{
+           {200, 67}, {200, 150}, {50, 10}, {300, 300}, {100, 0}}) {
+    BOOST_CHECK(PoWOrdering::TrimWithGuards(sorted, counts.first,
+                                            counts.second, isShardGuard) ==
+                ReferenceTrimWithGuards(sorted, counts.first, counts.second,
+                                        isShardGuard));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(test_ShardingOrder) {
+  INIT_STDOUT_LOGGER();
+
+  const auto sorted = PoWOrdering::SortByResult(GeneratePoWs(500));
+  const bytes lastBlockHash = TestUtils::GenerateRandomCharVector(32);
+
+  BOOST_CHECK(
+      KeysInOrder(sorted, PoWOrdering::ShardingOrder(sorted, lastBlockHash)) ==
+      ReferenceShardingOrder(sorted, lastBlockHash));
+}
+
+BOOST_AUTO_TEST_CASE(test_CompactPacket) {
+  INIT_STDOUT_LOGGER();
+
+  const PubKey keyA = TestUtils::GenerateRandomPubKey();
+  const PubKey keyB = TestUtils::GenerateRandomPubKey();
+  const PubKey keyC = TestUtils::GenerateRandomPubKey();
+  auto solution = [](const PubKey& key, uint8_t difficulty,
+                     const string& result) {
+    return DSPowSolution(1, difficulty, Peer(), key, 0, result, "", 0, 0,
+                         Signature());
+  };
+
+  const vector<DSPowSolution> sols = {
+      solution(keyA, 5, "20"), solution(keyB, 5, "30"),
+      solution(keyA, 5, "10"), solution(keyA, 9, "05"),
+      solution(keyC, 5, "01"), solution(keyB, 5, "30")};
+
+  // keyC's solution is already accepted
+  const auto compact =
+      PoWOrdering::CompactPacket(sols, [&keyC](const DSPowSolution& sol) {
+        return sol.GetSubmitterKey() == keyC;
+      });
+
+  BOOST_REQUIRE(compact.size() == 3);
+  for (size_t i = 1; i < compact.size(); i++) {
+    BOOST_CHECK(!(compact[i].GetSubmitterKey() <
+                  compact[i - 1].GetSubmitterKey()));
+  }
+
+  map<pair<PubKey, uint8_t>, string> results;
+  for (const auto& sol : compact) {
+    results[{sol.GetSubmitterKey(), sol.GetDifficultyLevel()}] =
+        sol.GetResultingHash();
+  }
+  BOOST_CHECK(results.size() == 3);
+  BOOST_CHECK(results[make_pair(keyA, 5)] == "10");
+  BOOST_CHECK(results[make_pair(keyA, 9)] == "05");
+  BOOST_CHECK(results[make_pair(keyB, 5)] == "30");
+}
+
+BOOST_AUTO_TEST_CASE(test_Performance20k) {
+  INIT_STDOUT_LOGGER();
+
+  const auto pows = GeneratePoWs(20000);
+  const bytes lastBlockHash = TestUtils::GenerateRandomCharVector(32);
+  auto isShardGuard = [](const PubKey& key) {
+    return std::hash<PubKey>()(key) % 2 == 0;
+  };
+
+  VectorOfPoWSoln sorted, trimmed, referenceTrimmed;
+  vector<uint32_t> order;
+  vector<PubKey> referenceOrder;
+
+  const auto vectorTime = ElapsedMicroseconds([&]() {
+    sorted = PoWOrdering::SortByResult(pows);
+    trimmed = PoWOrdering::TrimWithGuards(sorted, 18000, 6000, isShardGuard);
+    order = PoWOrdering::ShardingOrder(trimmed, lastBlockHash);
+  });
+  const auto referenceTime = ElapsedMicroseconds([&]() {
+    referenceTrimmed = ReferenceTrimWithGuards(ReferenceSort(pows), 18000,
+                                               6000, isShardGuard);
+    referenceOrder = ReferenceShardingOrder(referenceTrimmed, lastBlockHash);
+  });
+
+  LOG_GENERAL(INFO, "Ordering 20k PoWs: " << vectorTime << " us, map-based "
+                                          << referenceTime << " us");
+
+  BOOST_CHECK(trimmed == referenceTrimmed);
+  BOOST_CHECK(KeysInOrder(trimmed, order) == referenceOrder);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
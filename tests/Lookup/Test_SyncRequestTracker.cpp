@@ -0,0 +1,136 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <chrono>
+#include <thread>
+
+#include "libLookup/SyncRequestTracker.h"
+#include "libUtils/Logger.h"
+
+#define BOOST_TEST_MODULE syncrequesttracker
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+using namespace boost::multiprecision;
+
+BOOST_AUTO_TEST_SUITE(syncrequesttracker)
+
+BOOST_AUTO_TEST_CASE(test_coalesce_pending) {
+  INIT_STDOUT_LOGGER();
+
+  SyncRequestTracker tracker(2, 5000, 90, 3000);
+  const bytes request = {1, 2, 3};
+  const bytes other = {1, 2, 4};
+
+  BOOST_CHECK(tracker.Start(2, request, 10));
+  BOOST_CHECK(!tracker.Start(2, request, 11));
+  BOOST_CHECK(tracker.Start(2, other, 11));
+  BOOST_CHECK(tracker.GetTargets(request) == vector<uint128_t>{10});
+
+  // A response from a node the request did not go to completes nothing
+  BOOST_CHECK(!tracker.OnResponse(2, 12));
+  BOOST_CHECK(!tracker.OnResponse(4, 10));
+
+  BOOST_CHECK(tracker.OnResponse(2, 10));
+  BOOST_CHECK(tracker.GetTargets(request).empty());
+  BOOST_CHECK(tracker.Start(2, request, 10));
+}
+
+BOOST_AUTO_TEST_CASE(test_hedge_targets) {
+  INIT_STDOUT_LOGGER();
+
+  SyncRequestTracker tracker(2, 5000, 90, 3000);
+  const bytes request = {1, 2, 3};
+
+  BOOST_CHECK(!tracker.AddTarget(request, 11));
+  BOOST_CHECK(tracker.Start(2, request, 10));
+  BOOST_CHECK(tracker.AddTarget(request, 11));
+  BOOST_CHECK(!tracker.AddTarget(request, 12));
+  BOOST_CHECK(tracker.GetTargets(request) == (vector<uint128_t>{10, 11}));
+
+  // Whichever node answers first completes the request
+  BOOST_CHECK(tracker.OnResponse(2, 11));
+  BOOST_CHECK(!tracker.OnResponse(2, 10));
+}
+
+BOOST_AUTO_TEST_CASE(test_select_by_latency) {
+  INIT_STDOUT_LOGGER();
+
+  SyncRequestTracker tracker(2, 5000, 90, 3000);
+  const vector<uint128_t> peers = {10, 11};
+
+  BOOST_CHECK(tracker.Start(2, {1}, 10));
+  this_thread::sleep_for(chrono::milliseconds(50));
+  BOOST_CHECK(tracker.OnResponse(2, 10));
+  BOOST_CHECK(tracker.Start(2, {2}, 11));
+  BOOST_CHECK(tracker.OnResponse(2, 11));
+
+  // With two candidates both are always compared
+  for (unsigned int i = 0; i < 20; i++) {
+    BOOST_CHECK_EQUAL(tracker.Select(peers), 1);
+  }
+
+  // Requests in flight count against a node
+  for (unsigned char i = 0; i < 100; i++) {
+    BOOST_CHECK(tracker.Start(2, {3, i}, 11));
+  }
+  BOOST_CHECK_EQUAL(tracker.Select(peers), 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_expired_requests) {
+  INIT_STDOUT_LOGGER();
+
+  SyncRequestTracker tracker(2, 100, 90, 3000);
+  const bytes request = {1, 2, 3};
+
+  BOOST_CHECK(tracker.Start(2, request, 10));
+  BOOST_CHECK(tracker.Start(2, {4}, 11));
+  BOOST_CHECK(tracker.OnResponse(2, 11));
+  this_thread::sleep_for(chrono::milliseconds(150));
+
+  // A request not answered in time can be sent again, and the node that
+  // did not answer is charged the timeout
+  BOOST_CHECK(tracker.Start(2, request, 10));
+  BOOST_CHECK(tracker.OnResponse(2, 10));
+  BOOST_CHECK_EQUAL(tracker.Select({10, 11}), 1);
+}
+
+BOOST_AUTO_TEST_CASE(test_hedge_delay) {
+  INIT_STDOUT_LOGGER();
+
+  SyncRequestTracker tracker(2, 1000, 50, 400);
+  BOOST_CHECK_EQUAL(tracker.GetHedgeDelayInMs(), 400);
+
+  // Quick responses still leave the minimum delay
+  BOOST_CHECK(tracker.Start(2, {1}, 10));
+  BOOST_CHECK(tracker.OnResponse(2, 10));
+  BOOST_CHECK_EQUAL(tracker.GetHedgeDelayInMs(), 50);
+
+  // Timeouts push the percentile up to the maximum delay
+  BOOST_CHECK(tracker.Start(2, {2}, 10));
+  BOOST_CHECK(tracker.Start(2, {3}, 10));
+  this_thread::sleep_for(chrono::milliseconds(1100));
+  BOOST_CHECK(tracker.Start(2, {4}, 10));
+  BOOST_CHECK_EQUAL(tracker.GetHedgeDelayInMs(), 400);
+
+  tracker.Clear();
+  BOOST_CHECK(tracker.GetTargets({4}).empty());
+  BOOST_CHECK_EQUAL(tracker.GetHedgeDelayInMs(), 400);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "libLookup/TxnShardBuffer.h"
+#include "libUtils/Logger.h"
+
+#define BOOST_TEST_MODULE txnshardbuffer
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+
+namespace {
+
+Transaction TxnWithNonce(uint64_t nonce) {
+  return Transaction(TxnHash(), 0, nonce, Address(), PubKey(), 0, 0, 0, {}, {},
+                     Signature());
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(txnshardbuffer)
+
+BOOST_AUTO_TEST_CASE(test_TakeKeepsOrderPerShard) {
+  INIT_STDOUT_LOGGER();
+
+  TxnShardBuffer buffer;
+  for (uint64_t nonce = 0; nonce < 10; nonce++) {
+    buffer.Add(nonce % 2, TxnWithNonce(nonce));
+  }
+  // Shards 1 and 17 share a stripe
+  buffer.Add({{TxnWithNonce(100), 17}, {TxnWithNonce(101), 1}});
+
+  BOOST_CHECK(buffer.Size(0) == 5);
+  BOOST_CHECK(buffer.Size(1) == 6);
+  BOOST_CHECK(buffer.Size(17) == 1);
+
+  const auto firstOfOne = buffer.Take(1, 2);
+  BOOST_REQUIRE(firstOfOne.size() == 2);
+  BOOST_CHECK(firstOfOne[0].GetNonce() == 1);
+  BOOST_CHECK(firstOfOne[1].GetNonce() == 3);
+
+  const auto restOfOne = buffer.Take(1);
+  BOOST_REQUIRE(restOfOne.size() == 4);
+  BOOST_CHECK(restOfOne.back().GetNonce() == 101);
+  BOOST_CHECK(buffer.Size(1) == 0);
+  BOOST_CHECK(buffer.Size(17) == 1);
+
+  buffer.Clear(0);
+  BOOST_CHECK(buffer.Take(0).empty());
+  BOOST_CHECK(buffer.Take(5).empty());
+}
+
+BOOST_AUTO_TEST_CASE(test_ConcurrentAddAndTake) {
+  INIT_STDOUT_LOGGER();
+
+  const unsigned int numShards = 4;
+  const unsigned int numWriters = 4;
+  const uint64_t txnsPerWriter = 5000;
+
+  TxnShardBuffer buffer;
+  vector<thread> writers;
+  for (unsigned int w = 0; w < numWriters; w++) {
+    writers.emplace_back([&buffer, w]() {
+      for (uint64_t i = 0; i < txnsPerWriter; i++) {
+        const uint64_t nonce = w * txnsPerWriter + i;
+        buffer.Add(nonce % numShards, TxnWithNonce(nonce));
+      }
+    });
+  }
+
+  set<uint64_t> taken;
+  auto drain = [&buffer, &taken]() {
+    for (unsigned int shard = 0; shard < numShards; shard++) {
+      for (const auto& txn : buffer.Take(shard)) {
+        BOOST_CHECK(txn.GetNonce() % numShards == shard);
+        taken.insert(txn.GetNonce());
+      }
+    }
+  };
+
+  while (taken.size() < numWriters * txnsPerWriter / 2) {
+    drain();
+  }
+  for (auto& writer : writers) {
+    writer.join();
+  }
+  drain();
+
+  BOOST_CHECK(taken.size() == numWriters * txnsPerWriter);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
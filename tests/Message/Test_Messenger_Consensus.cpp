@@ -102,6 +102,111 @@ BOOST_AUTO_TEST_CASE(test_SetAndGetConsensusChallenge) {
   BOOST_CHECK(challenge == challengeDeserialized);
 }
 
+BOOST_AUTO_TEST_CASE(test_SetAndGetConsensusAggregatedCommit) {
+  bytes dst;
+  unsigned int offset = 0;
+  uint32_t consensusID = TestUtils::DistUint32();
+  uint64_t blockNumber = TestUtils::DistUint32();
+  bytes blockHash(TestUtils::Dist1to99(), TestUtils::DistUint8());
+  uint16_t aggregatorID = max((uint16_t)2, (uint16_t)TestUtils::Dist1to99());
+  CommitPoint aggregatedCommit = CommitPoint(CommitSecret());
+  pair<PrivKey, PubKey> aggregatorKey;
+  aggregatorKey.first = PrivKey();
+  aggregatorKey.second = PubKey(aggregatorKey.first);
+
+  deque<pair<PubKey, Peer>> committeeKeys;
+  for (unsigned int i = 0; i < (unsigned int)aggregatorID + 10; i++) {
+    committeeKeys.emplace_back((i == aggregatorID)
+                                   ? aggregatorKey.second
+                                   : TestUtils::GenerateRandomPubKey(),
+                               TestUtils::GenerateRandomPeer());
+  }
+  vector<bool> bitmap(committeeKeys.size(), false);
+  for (unsigned int i = aggregatorID; i < committeeKeys.size(); i += 2) {
+    bitmap.at(i) = true;
+  }
+
+  BOOST_CHECK(Messenger::SetConsensusAggregatedCommit(
+      dst, offset, consensusID, blockNumber, blockHash, aggregatorID, bitmap,
+      aggregatedCommit, aggregatorKey));
+
+  uint16_t aggregatorIDDeserialized = 0;
+  vector<bool> bitmapDeserialized;
+  CommitPoint aggregatedCommitDeserialized;
+
+  BOOST_CHECK(Messenger::GetConsensusAggregatedCommit(
+      dst, offset, consensusID, blockNumber, blockHash,
+      aggregatorIDDeserialized, bitmapDeserialized,
+      aggregatedCommitDeserialized, committeeKeys));
+
+  BOOST_CHECK(aggregatorID == aggregatorIDDeserialized);
+  BOOST_CHECK(bitmap == bitmapDeserialized);
+  BOOST_CHECK(aggregatedCommit == aggregatedCommitDeserialized);
+
+  // Signed by someone other than the aggregator
+  swap(committeeKeys.at(aggregatorID), committeeKeys.at(0));
+  bitmapDeserialized.clear();
+  BOOST_CHECK(!Messenger::GetConsensusAggregatedCommit(
+      dst, offset, consensusID, blockNumber, blockHash,
+      aggregatorIDDeserialized, bitmapDeserialized,
+      aggregatedCommitDeserialized, committeeKeys));
+}
+
+BOOST_AUTO_TEST_CASE(test_SetAndGetConsensusAggregatedResponse) {
+  bytes dst;
+  unsigned int offset = 0;
+  uint32_t consensusID = TestUtils::DistUint32();
+  uint64_t blockNumber = TestUtils::DistUint32();
+  uint16_t subsetID = TestUtils::DistUint8();
+  bytes blockHash(TestUtils::Dist1to99(), TestUtils::DistUint8());
+  uint16_t aggregatorID = TestUtils::Dist1to99();
+  pair<PrivKey, PubKey> aggregatorKey;
+  aggregatorKey.first = PrivKey();
+  aggregatorKey.second = PubKey(aggregatorKey.first);
+
+  CommitSecret commitSecret;
+  CommitPoint commitPoint(commitSecret);
+  Challenge challenge(commitPoint, aggregatorKey.second,
+                      bytes(TestUtils::Dist1to99(), TestUtils::DistUint8()));
+  Response aggregatedResponse(commitSecret, challenge, aggregatorKey.first);
+
+  deque<pair<PubKey, Peer>> committeeKeys;
+  for (unsigned int i = 0; i <= aggregatorID; i++) {
+    committeeKeys.emplace_back((i == aggregatorID)
+                                   ? aggregatorKey.second
+                                   : TestUtils::GenerateRandomPubKey(),
+                               TestUtils::GenerateRandomPeer());
+  }
+  vector<bool> bitmap(committeeKeys.size(), false);
+  bitmap.back() = true;
+
+  BOOST_CHECK(Messenger::SetConsensusAggregatedResponse(
+      dst, offset, consensusID, blockNumber, subsetID, blockHash, aggregatorID,
+      bitmap, aggregatedResponse, aggregatorKey));
+
+  uint16_t aggregatorIDDeserialized = 0;
+  uint16_t subsetIDDeserialized = 0;
+  vector<bool> bitmapDeserialized;
+  Response aggregatedResponseDeserialized;
+
+  BOOST_CHECK(Messenger::GetConsensusAggregatedResponse(
+      dst, offset, consensusID, blockNumber, blockHash,
+      aggregatorIDDeserialized, subsetIDDeserialized, bitmapDeserialized,
+      aggregatedResponseDeserialized, committeeKeys));
+
+  BOOST_CHECK(aggregatorID == aggregatorIDDeserialized);
+  BOOST_CHECK(subsetID == subsetIDDeserialized);
+  BOOST_CHECK(bitmap == bitmapDeserialized);
+  BOOST_CHECK(aggregatedResponse == aggregatedResponseDeserialized);
+
+  // Another consensus round
+  bitmapDeserialized.clear();
+  BOOST_CHECK(!Messenger::GetConsensusAggregatedResponse(
+      dst, offset, consensusID + 1, blockNumber, blockHash,
+      aggregatorIDDeserialized, subsetIDDeserialized, bitmapDeserialized,
+      aggregatedResponseDeserialized, committeeKeys));
+}
+
 BOOST_AUTO_TEST_CASE(test_SetAndGetConsensusConsensusFailure) {
   bytes dst;
   unsigned int offset = 0;
@@ -0,0 +1,197 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <new>
+#include <string>
+#include "libData/AccountData/Account.h"
+#include "libData/AccountData/AccountStore.h"
+#include "libData/AccountData/Transaction.h"
+#include "libMessage/Messenger.h"
+#include "libTestUtils/TestUtils.h"
+#include "libUtils/Logger.h"
+
+#define BOOST_TEST_MODULE messengerperformance
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+using namespace boost::multiprecision;
+
+// Every allocation of this binary is counted, so each measurement can report
+// the bytes allocated per operation next to its time
+static atomic<uint64_t> allocatedBytes{0};
+
+void* operator new(size_t size) {
+  allocatedBytes += size;
+  void* p = malloc(size);
+  if (p == nullptr) {
+    throw bad_alloc();
+  }
+  return p;
+}
+
+void operator delete(void* p) noexcept { free(p); }
+
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+namespace {
+
+void Measure(const string& name, unsigned int iterations,
+             const function<void()>& op) {
+  op();  // warm up
+
+  const uint64_t bytesBefore = allocatedBytes;
+  auto start = chrono::high_resolution_clock::now();
+  for (unsigned int i = 0; i < iterations; i++) {
+    op();
+  }
+  auto elapsed = chrono::duration_cast<chrono::nanoseconds>(
+                     chrono::high_resolution_clock::now() - start)
+                     .count();
+
+  LOG_GENERAL(INFO, name << ": " << elapsed / iterations << " ns/op, "
+                         << (allocatedBytes - bytesBefore) / iterations
+                         << " bytes/op");
+}
+
+vector<Transaction> GenerateTransactions(unsigned int n) {
+  const PairOfKey sender = Schnorr::GetInstance().GenKeyPair();
+  const Address toAddr = Account::GetAddressFromPublicKey(
+      Schnorr::GetInstance().GenKeyPair().second);
+
+  vector<Transaction> txns;
+  txns.reserve(n);
+  for (unsigned int i = 0; i < n; i++) {
+    txns.emplace_back(DataConversion::Pack(CHAIN_ID, 1), i, toAddr, sender,
+                      i + 1, PRECISION_MIN_VALUE, 50, bytes(), bytes());
+  }
+  return txns;
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(messenger_performance_test)
+
+BOOST_AUTO_TEST_CASE(init) {
+  INIT_STDOUT_LOGGER();
+  TestUtils::Initialize();
+}
+
+BOOST_AUTO_TEST_CASE(test_Transaction) {
+  const Transaction txn = GenerateTransactions(1).front();
+  bytes dst;
+
+  Measure("SetTransaction", 10000,
+          [&]() { BOOST_CHECK(Messenger::SetTransaction(dst, 0, txn)); });
+
+  Transaction txnDeserialized;
+  Measure("GetTransaction", 1000, [&]() {
+    BOOST_CHECK(Messenger::GetTransaction(dst, 0, txnDeserialized));
+  });
+  BOOST_CHECK(txn == txnDeserialized);
+}
+
+BOOST_AUTO_TEST_CASE(test_TransactionArray) {
+  for (unsigned int n : {1000, 10000}) {
+    const vector<Transaction> txns = GenerateTransactions(n);
+    bytes dst;
+
+    Measure("SetTransactionArray " + to_string(n), 10, [&]() {
+      dst.clear();
+      BOOST_CHECK(Messenger::SetTransactionArray(dst, 0, txns));
+    });
+
+    vector<Transaction> txnsDeserialized;
+    Measure("GetTransactionArray " + to_string(n), 3, [&]() {
+      txnsDeserialized.clear();
+      BOOST_CHECK(Messenger::GetTransactionArray(dst, 0, txnsDeserialized));
+    });
+    BOOST_CHECK(txns == txnsDeserialized);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(test_MicroBlock) {
+  for (unsigned int n : {1000, 10000}) {
+    const MicroBlockHeader header(0, 1000000, 500000, 1000, 1,
+                                  MicroBlockHashSet(), n,
+                                  TestUtils::GenerateRandomPubKey(), 1);
+    const MicroBlock microBlock(header, vector<TxnHash>(n),
+                                TestUtils::GenerateRandomCoSignatures());
+    bytes dst;
+
+    Measure("SetMicroBlock " + to_string(n), 100, [&]() {
+      dst.clear();
+      BOOST_CHECK(Messenger::SetMicroBlock(dst, 0, microBlock));
+    });
+  }
+}
+
+BOOST_AUTO_TEST_CASE(test_TxBlock) {
+  const TxBlock txBlock(TestUtils::GenerateRandomTxBlockHeader(),
+                        vector<MicroBlockInfo>(10),
+                        TestUtils::GenerateRandomCoSignatures());
+  bytes dst;
+
+  Measure("SetTxBlock", 1000, [&]() {
+    dst.clear();
+    BOOST_CHECK(Messenger::SetTxBlock(dst, 0, txBlock));
+  });
+}
+
+BOOST_AUTO_TEST_CASE(test_DSBlock) {
+  const DSBlock dsBlock(TestUtils::GenerateRandomDSBlockHeader(),
+                        TestUtils::GenerateRandomCoSignatures());
+  const DequeOfShard shards{TestUtils::GenerateRandomShard(600)};
+  bytes dst;
+
+  Measure("SetDSBlock", 1000, [&]() {
+    dst.clear();
+    BOOST_CHECK(Messenger::SetDSBlock(dst, 0, dsBlock));
+  });
+
+  Measure("SetNodeVCDSBlocksMessage 600 shard members", 100, [&]() {
+    dst.clear();
+    BOOST_CHECK(Messenger::SetNodeVCDSBlocksMessage(
+        dst, 0, 0, dsBlock, {}, SHARDINGSTRUCTURE_VERSION, shards));
+  });
+}
+
+BOOST_AUTO_TEST_CASE(test_AccountStoreDelta) {
+  AccountStore::GetInstance().Init();
+
+  for (unsigned int n : {1000, 10000}) {
+    AccountStoreTemp accountStoreTemp(AccountStore::GetInstance());
+    for (unsigned int i = 0; i < n; i++) {
+      accountStoreTemp.AddAccountDuringDeserialization(
+          Account::GetAddressFromPublicKey(TestUtils::GenerateRandomPubKey()),
+          Account(i + 1, i));
+    }
+    bytes dst;
+
+    Measure("SetAccountStoreDelta " + to_string(n), 10, [&]() {
+      dst.clear();
+      BOOST_CHECK(Messenger::SetAccountStoreDelta(
+          dst, 0, accountStoreTemp, AccountStore::GetInstance()));
+    });
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
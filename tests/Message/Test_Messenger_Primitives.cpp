@@ -15,8 +15,10 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <boost/filesystem.hpp>
 #include <limits>
 #include <random>
+#include "libData/AccountData/Account.h"
 #include "libMessage/Messenger.h"
 #include "libTestUtils/TestUtils.h"
 #include "libUtils/Logger.h"
@@ -183,6 +185,114 @@ BOOST_AUTO_TEST_CASE(test_SetAndGetTxBlock) {
   BOOST_CHECK(txBlock == txBlockDeserialized);
 }
 
+BOOST_AUTO_TEST_CASE(test_GetBlockHeaderOfBlock) {
+  bytes dst;
+
+  DSBlock dsBlock(TestUtils::GenerateRandomDSBlockHeader(),
+                  TestUtils::GenerateRandomCoSignatures());
+  BOOST_CHECK(Messenger::SetDSBlock(dst, 0, dsBlock));
+  DSBlockHeader dsBlockHeader;
+  BOOST_CHECK(Messenger::GetDSBlockHeaderOfBlock(dst, 0, dsBlockHeader));
+  BOOST_CHECK(dsBlock.GetHeader() == dsBlockHeader);
+
+  MicroBlockHeader microBlockHeader =
+      TestUtils::GenerateRandomMicroBlockHeader();
+  vector<TxnHash> tranHashes(microBlockHeader.GetNumTxs());
+  MicroBlock microBlock(microBlockHeader, tranHashes,
+                        TestUtils::GenerateRandomCoSignatures());
+  dst.clear();
+  BOOST_CHECK(Messenger::SetMicroBlock(dst, 0, microBlock));
+  MicroBlockHeader microBlockHeaderDeserialized;
+  BOOST_CHECK(Messenger::GetMicroBlockHeaderOfBlock(
+      dst, 0, microBlockHeaderDeserialized));
+  BOOST_CHECK(microBlockHeader == microBlockHeaderDeserialized);
+
+  TxBlockHeader txBlockHeader = TestUtils::GenerateRandomTxBlockHeader();
+  TxBlock txBlock(txBlockHeader, vector<MicroBlockInfo>(),
+                  TestUtils::GenerateRandomCoSignatures());
+  dst.clear();
+  BOOST_CHECK(Messenger::SetTxBlock(dst, 0, txBlock));
+  TxBlockHeader txBlockHeaderDeserialized;
+  BOOST_CHECK(
+      Messenger::GetTxBlockHeaderOfBlock(dst, 0, txBlockHeaderDeserialized));
+  BOOST_CHECK(txBlockHeader == txBlockHeaderDeserialized);
+}
+
+BOOST_AUTO_TEST_CASE(test_SetNodeVCDSBlocksMessageShardId) {
+  bytes dst;
+  DSBlock dsBlock(TestUtils::GenerateRandomDSBlockHeader(),
+                  TestUtils::GenerateRandomCoSignatures());
+
+  BOOST_CHECK(Messenger::SetNodeVCDSBlocksMessage(dst, 0, 0, dsBlock, {},
+                                                  SHARDINGSTRUCTURE_VERSION,
+                                                  DequeOfShard()));
+  BOOST_CHECK(Messenger::SetNodeVCDSBlocksMessageShardId(dst, 0, 7));
+
+  uint32_t shardId = 0;
+  DSBlock dsBlockDeserialized;
+  vector<VCBlock> vcBlocks;
+  uint32_t shardingStructureVersion = 0;
+  DequeOfShard shards;
+
+  BOOST_CHECK(Messenger::GetNodeVCDSBlocksMessage(
+      dst, 0, shardId, dsBlockDeserialized, vcBlocks, shardingStructureVersion,
+      shards));
+  BOOST_CHECK(shardId == 7);
+  BOOST_CHECK(dsBlock == dsBlockDeserialized);
+}
+
+BOOST_AUTO_TEST_CASE(test_SetNodeVCDSBlocksMessageShardingDiff) {
+  DSBlock dsBlock(TestUtils::GenerateRandomDSBlockHeader(),
+                  TestUtils::GenerateRandomCoSignatures());
+
+  DequeOfShard prevShards{TestUtils::GenerateRandomShard(20),
+                          TestUtils::GenerateRandomShard(20)};
+  ShardingHash prevShardingHash;
+  BOOST_CHECK(Messenger::GetShardingStructureHash(
+      SHARDINGSTRUCTURE_VERSION, prevShards, prevShardingHash));
+
+  // Nodes move between shards, one leaves, one joins, one changes its peer
+  // and reputations change
+  DequeOfShard shards(2);
+  for (unsigned int i = 0; i < 20; i++) {
+    shards[i % 2].emplace_back(prevShards[0][i]);
+    shards[(i + 1) % 2].emplace_back(prevShards[1][i]);
+  }
+  shards[0].pop_back();
+  shards[1].emplace_back(TestUtils::GenerateRandomPubKey(),
+                         TestUtils::GenerateRandomPeer(), 7);
+  std::get<SHARD_NODE_PEER>(shards[0][3]) = TestUtils::GenerateRandomPeer();
+  std::get<SHARD_NODE_REP>(shards[1][5])++;
+
+  bytes full, diff;
+  BOOST_CHECK(Messenger::SetNodeVCDSBlocksMessage(
+      full, 0, 0, dsBlock, {}, SHARDINGSTRUCTURE_VERSION, shards));
+  BOOST_CHECK(Messenger::SetNodeVCDSBlocksMessage(
+      diff, 0, 0, dsBlock, {}, SHARDINGSTRUCTURE_VERSION, shards, prevShards,
+      prevShardingHash));
+  BOOST_CHECK(diff.size() < full.size());
+
+  uint32_t shardId = 0;
+  DSBlock dsBlockDeserialized;
+  vector<VCBlock> vcBlocks;
+  uint32_t shardingStructureVersion = 0;
+  DequeOfShard shardsDeserialized;
+
+  BOOST_CHECK(Messenger::GetNodeVCDSBlocksMessage(
+      diff, 0, shardId, dsBlockDeserialized, vcBlocks,
+      shardingStructureVersion, shardsDeserialized, prevShards));
+  BOOST_CHECK(dsBlock == dsBlockDeserialized);
+  BOOST_CHECK(shardingStructureVersion == SHARDINGSTRUCTURE_VERSION);
+  BOOST_CHECK(shardsDeserialized == shards);
+
+  // A diff does not apply on any other base
+  DequeOfShard otherShards{prevShards[1], prevShards[0]};
+  shardsDeserialized.clear();
+  BOOST_CHECK(!Messenger::GetNodeVCDSBlocksMessage(
+      diff, 0, shardId, dsBlockDeserialized, vcBlocks,
+      shardingStructureVersion, shardsDeserialized, otherShards));
+}
+
 BOOST_AUTO_TEST_CASE(test_SetAndGetVCBlockHeader) {
   bytes dst;
   unsigned int offset = 0;
@@ -274,4 +384,165 @@ BOOST_AUTO_TEST_CASE(test_CopyWithSizeCheck) {
               true);
 }
 
+BOOST_AUTO_TEST_CASE(test_SetAndGetLookupSetStateSnapshotFromSeed) {
+  PairOfKey lookupKey = TestUtils::GenerateRandomKeyPair();
+  uint64_t blockNum = TestUtils::DistUint64();
+  dev::h256 stateRoot;
+  generate(stateRoot.asArray().begin(), stateRoot.asArray().end(),
+           []() -> unsigned char { return TestUtils::DistUint8(); });
+  vector<dev::h256> chunkHashes(TestUtils::Dist1to99());
+  for (auto& chunkHash : chunkHashes) {
+    generate(chunkHash.asArray().begin(), chunkHash.asArray().end(),
+             []() -> unsigned char { return TestUtils::DistUint8(); });
+  }
+
+  bytes dst;
+  BOOST_REQUIRE(Messenger::SetLookupSetStateSnapshotFromSeed(
+      dst, 0, lookupKey, blockNum, stateRoot, chunkHashes));
+
+  PubKey lookupPubKeyDeserialized;
+  uint64_t blockNumDeserialized = 0;
+  dev::h256 stateRootDeserialized;
+  vector<dev::h256> chunkHashesDeserialized;
+  BOOST_REQUIRE(Messenger::GetLookupSetStateSnapshotFromSeed(
+      dst, 0, lookupPubKeyDeserialized, blockNumDeserialized,
+      stateRootDeserialized, chunkHashesDeserialized));
+
+  BOOST_CHECK(lookupPubKeyDeserialized == lookupKey.second);
+  BOOST_CHECK_EQUAL(blockNumDeserialized, blockNum);
+  BOOST_CHECK(stateRootDeserialized == stateRoot);
+  BOOST_CHECK(chunkHashesDeserialized == chunkHashes);
+
+  // A manifest signed by another key must be rejected
+  PairOfKey otherKey = TestUtils::GenerateRandomKeyPair();
+  bytes forged;
+  BOOST_REQUIRE(Messenger::SetLookupSetStateSnapshotFromSeed(
+      forged, 0, make_pair(otherKey.first, lookupKey.second), blockNum,
+      stateRoot, chunkHashes));
+  BOOST_CHECK(!Messenger::GetLookupSetStateSnapshotFromSeed(
+      forged, 0, lookupPubKeyDeserialized, blockNumDeserialized,
+      stateRootDeserialized, chunkHashesDeserialized));
+}
+
+BOOST_AUTO_TEST_CASE(test_StreamNodeForwardTxnBlock) {
+  PairOfKey lookupKey = TestUtils::GenerateRandomKeyPair();
+  const PairOfKey sender = TestUtils::GenerateRandomKeyPair();
+  const Address toAddr =
+      Account::GetAddressFromPublicKey(TestUtils::GenerateRandomPubKey());
+
+  vector<Transaction> txnsCurrent, txnsGenerated;
+  for (unsigned int i = 0; i < 7; i++) {
+    txnsCurrent.emplace_back(DataConversion::Pack(CHAIN_ID, 1), i, toAddr,
+                             sender, i + 1, PRECISION_MIN_VALUE, 50, bytes(),
+                             bytes());
+  }
+  txnsGenerated.emplace_back(DataConversion::Pack(CHAIN_ID, 1), 7, toAddr,
+                             sender, 8, PRECISION_MIN_VALUE, 50, bytes(),
+                             bytes());
+
+  const uint64_t epochNumber = TestUtils::DistUint64();
+  const uint64_t dsBlockNum = TestUtils::DistUint64();
+  const uint32_t shardId = TestUtils::DistUint32();
+
+  bytes dst = {0xAA, 0xBB};
+  BOOST_REQUIRE(Messenger::SetNodeForwardTxnBlock(
+      dst, 2, epochNumber, dsBlockNum, shardId, lookupKey, txnsCurrent,
+      txnsGenerated));
+
+  uint64_t epochNumberDeserialized = 0, dsBlockNumDeserialized = 0;
+  uint32_t shardIdDeserialized = 0;
+  PubKey lookupPubKeyDeserialized;
+  BOOST_REQUIRE(Messenger::GetNodeForwardTxnBlockHeader(
+      dst, 2, epochNumberDeserialized, dsBlockNumDeserialized,
+      shardIdDeserialized, lookupPubKeyDeserialized));
+  BOOST_CHECK_EQUAL(epochNumberDeserialized, epochNumber);
+  BOOST_CHECK_EQUAL(dsBlockNumDeserialized, dsBlockNum);
+  BOOST_CHECK_EQUAL(shardIdDeserialized, shardId);
+  BOOST_CHECK(lookupPubKeyDeserialized == lookupKey.second);
+
+  BOOST_CHECK(Messenger::VerifyNodeForwardTxnBlock(dst, 2, lookupKey.second));
+  BOOST_CHECK(!Messenger::VerifyNodeForwardTxnBlock(
+      dst, 2, TestUtils::GenerateRandomPubKey()));
+
+  // Batches arrive in order and add up to what the full decoder returns
+  vector<Transaction> txnsFull;
+  BOOST_REQUIRE(Messenger::GetNodeForwardTxnBlock(
+      dst, 2, epochNumberDeserialized, dsBlockNumDeserialized,
+      shardIdDeserialized, lookupPubKeyDeserialized, txnsFull));
+
+  vector<Transaction> txnsStreamed;
+  vector<size_t> batchSizes;
+  BOOST_REQUIRE(Messenger::GetNodeForwardTxnBlockTransactions(
+      dst, 2, 3, [&](vector<Transaction>& txns) {
+        batchSizes.push_back(txns.size());
+        txnsStreamed.insert(txnsStreamed.end(), txns.begin(), txns.end());
+      }));
+  BOOST_CHECK(batchSizes == vector<size_t>({3, 3, 2}));
+  BOOST_CHECK(txnsStreamed == txnsFull);
+
+  // A truncated packet is rejected before any batch is handed out
+  bytes truncated(dst.begin(), dst.end() - 10);
+  unsigned int batches = 0;
+  BOOST_CHECK(!Messenger::GetNodeForwardTxnBlockTransactions(
+      truncated, 2, 3, [&](vector<Transaction>&) { batches++; }));
+  BOOST_CHECK_EQUAL(batches, 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_NodeForwardTxnBlockFromCorpus) {
+  PairOfKey lookupKey = TestUtils::GenerateRandomKeyPair();
+  const PairOfKey sender = TestUtils::GenerateRandomKeyPair();
+  const Address fromAddr = Account::GetAddressFromPublicKey(sender.second);
+  const Address toAddr =
+      Account::GetAddressFromPublicKey(TestUtils::GenerateRandomPubKey());
+  const string corpusPath = "Test_NodeForwardTxnBlockFromCorpus.zilc";
+
+  vector<Transaction> txnsCurrent, txnsGenerated;
+  txnsCurrent.emplace_back(DataConversion::Pack(CHAIN_ID, 1), 0, toAddr,
+                           sender, 1, PRECISION_MIN_VALUE, 50, bytes(),
+                           bytes());
+  {
+    TxnCorpusWriter writer(corpusPath);
+    BOOST_REQUIRE(writer.BeginSender(fromAddr, 1));
+    for (unsigned int i = 1; i <= 5; i++) {
+      txnsGenerated.emplace_back(DataConversion::Pack(CHAIN_ID, 1), i, toAddr,
+                                 sender, i + 1, PRECISION_MIN_VALUE, 50,
+                                 bytes(), bytes());
+      bytes txnBuff;
+      BOOST_REQUIRE(
+          Messenger::SetTransaction(txnBuff, 0, txnsGenerated[i - 1]));
+      BOOST_REQUIRE(writer.AddTxn(txnBuff));
+    }
+    BOOST_REQUIRE(writer.Finish());
+  }
+
+  TxnCorpus corpus;
+  BOOST_REQUIRE(corpus.Open(corpusPath));
+  vector<TxnCorpus::Slice> slices(2);
+  BOOST_REQUIRE(corpus.GetSlice(fromAddr, 1, 2, slices[0]));
+  BOOST_REQUIRE(corpus.GetSlice(fromAddr, 3, 3, slices[1]));
+
+  // Same packet as the one built from the decoded txns
+  bytes dst = {0xAA, 0xBB};
+  BOOST_REQUIRE(Messenger::SetNodeForwardTxnBlock(dst, 2, 3, 4, 5, lookupKey,
+                                                  txnsCurrent, slices));
+  BOOST_CHECK(Messenger::VerifyNodeForwardTxnBlock(dst, 2, lookupKey.second));
+
+  uint64_t epochNumber = 0, dsBlockNum = 0;
+  uint32_t shardId = 0;
+  PubKey lookupPubKey;
+  vector<Transaction> txns;
+  BOOST_REQUIRE(Messenger::GetNodeForwardTxnBlock(
+      dst, 2, epochNumber, dsBlockNum, shardId, lookupPubKey, txns));
+  BOOST_CHECK_EQUAL(epochNumber, 3);
+  BOOST_CHECK_EQUAL(dsBlockNum, 4);
+  BOOST_CHECK_EQUAL(shardId, 5);
+
+  vector<Transaction> expected = txnsCurrent;
+  expected.insert(expected.end(), txnsGenerated.begin(), txnsGenerated.end());
+  BOOST_CHECK(txns == expected);
+
+  corpus.Close();
+  boost::filesystem::remove(corpusPath);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -15,7 +15,10 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <chrono>
+#include <thread>
 #include "libNetwork/Blacklist.h"
+#include "libUtils/IPConverter.h"
 #include "libUtils/Logger.h"
 
 #define BOOST_TEST_MODULE blacklist
@@ -81,4 +84,77 @@ BOOST_AUTO_TEST_CASE(test_fundamental) {
   LOG_GENERAL(INFO, "Test Blacklist termination done!");
 }
 
+BOOST_AUTO_TEST_CASE(test_ranges) {
+  INIT_STDOUT_LOGGER();
+
+  Blacklist& bl = Blacklist::GetInstance();
+  bl.Clear();
+
+  auto ip = [](const string& str) {
+    boost::multiprecision::uint128_t result;
+    BOOST_REQUIRE(IPConverter::ToNumericalIPFromStr(str, result));
+    return result;
+  };
+
+  BOOST_REQUIRE(bl.AddRange("10.1.2.0/24"));
+  BOOST_CHECK(bl.Exist(ip("10.1.2.0")));
+  BOOST_CHECK(bl.Exist(ip("10.1.2.77")));
+  BOOST_CHECK(bl.Exist(ip("10.1.2.255")));
+  BOOST_CHECK(!bl.Exist(ip("10.1.3.1")));
+  BOOST_CHECK(!bl.Exist(ip("10.1.1.255")));
+  BOOST_CHECK(!bl.Exist(ip("11.1.2.1")));
+
+  // An address inside a range keeps its own entry
+  bl.Add(ip("10.1.2.5"));
+  bl.Remove(ip("10.1.2.5"));
+  BOOST_CHECK(bl.Exist(ip("10.1.2.5")));
+
+  // Ranges outlive Clear, and go with RemoveRange, given any address in them
+  bl.Clear();
+  BOOST_CHECK(bl.Exist(ip("10.1.2.9")));
+  bl.RemoveRange(ip("10.1.2.200"), 24, false);
+  BOOST_CHECK(!bl.Exist(ip("10.1.2.9")));
+
+  BOOST_REQUIRE(bl.AddRange("2001:db8::/32"));
+  BOOST_CHECK(bl.Exist(ip("2001:db8::1")));
+  BOOST_CHECK(bl.Exist(ip("2001:db8:ffff::1")));
+  BOOST_CHECK(!bl.Exist(ip("2001:db9::1")));
+  bl.RemoveRange(ip("2001:db8::"), 32, true);
+  BOOST_CHECK(!bl.Exist(ip("2001:db8::1")));
+
+  BOOST_CHECK(!bl.AddRange("10.0.0.0/33"));
+  BOOST_CHECK(!bl.AddRange("10.0.0.0/x"));
+
+  // Excluded addresses win over ranges
+  BOOST_REQUIRE(bl.AddRange("192.168.0.0/16"));
+  bl.Exclude(ip("192.168.1.1"));
+  BOOST_CHECK(!bl.Exist(ip("192.168.1.1")));
+  BOOST_CHECK(bl.Exist(ip("192.168.1.2")));
+  bl.RemoveRange(ip("192.168.0.0"), 16, false);
+}
+
+BOOST_AUTO_TEST_CASE(test_range_ttl) {
+  INIT_STDOUT_LOGGER();
+
+  Blacklist& bl = Blacklist::GetInstance();
+  bl.Clear();
+
+  auto ip = [](const string& str) {
+    boost::multiprecision::uint128_t result;
+    BOOST_REQUIRE(IPConverter::ToNumericalIPFromStr(str, result));
+    return result;
+  };
+
+  BOOST_REQUIRE(bl.AddRange(ip("172.16.0.0"), 12, false, chrono::seconds(1)));
+  BOOST_CHECK(bl.Exist(ip("172.20.0.5")));
+  this_thread::sleep_for(chrono::milliseconds(1100));
+  BOOST_CHECK(!bl.Exist(ip("172.20.0.5")));
+
+  // The expired range is dropped on the next change
+  bl.Add(ip("172.20.0.7"));
+  BOOST_CHECK(bl.Exist(ip("172.20.0.7")));
+  BOOST_CHECK(!bl.Exist(ip("172.20.0.5")));
+  bl.Clear();
+}
+
 BOOST_AUTO_TEST_SUITE_END()
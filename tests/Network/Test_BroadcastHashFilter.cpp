@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <string>
+
+#include "libCrypto/Sha2.h"
+#include "libNetwork/BroadcastHashFilter.h"
+#include "libUtils/Logger.h"
+
+#define BOOST_TEST_MODULE broadcasthashfilter
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(broadcasthashfilter)
+
+bytes MakeHash(unsigned int i) {
+  const string s = to_string(i);
+  SHA2<HASH_TYPE::HASH_VARIANT_256> sha256;
+  sha256.Update(bytes(s.begin(), s.end()));
+  return sha256.Finalize();
+}
+
+BOOST_AUTO_TEST_CASE(test_insert) {
+  INIT_STDOUT_LOGGER();
+
+  BroadcastHashFilter filter(3, 4);
+
+  // Enough hashes for every shard table to grow a few times
+  const unsigned int count = 1000;
+  for (unsigned int i = 0; i < count; i++) {
+    BOOST_CHECK(filter.Insert(MakeHash(i)));
+  }
+  for (unsigned int i = 0; i < count; i++) {
+    BOOST_CHECK(filter.Contains(MakeHash(i)));
+    BOOST_CHECK(!filter.Insert(MakeHash(i)));
+  }
+
+  BOOST_CHECK(!filter.Contains(MakeHash(count)));
+  BOOST_CHECK_EQUAL(filter.Size(), count);
+
+  BOOST_CHECK_MESSAGE(!filter.Insert(bytes(10, 0x01)),
+                      "Hash of the wrong size accepted");
+}
+
+BOOST_AUTO_TEST_CASE(test_expiry) {
+  INIT_STDOUT_LOGGER();
+
+  BroadcastHashFilter filter(3);
+
+  filter.Insert(MakeHash(1));
+  filter.Rotate();
+  filter.Insert(MakeHash(2));
+  filter.Rotate();
+
+  BOOST_CHECK(filter.Contains(MakeHash(1)));
+  BOOST_CHECK(filter.Contains(MakeHash(2)));
+
+  filter.Rotate();
+  BOOST_CHECK_MESSAGE(!filter.Contains(MakeHash(1)),
+                      "Hash still present after 3 rotations");
+  BOOST_CHECK(filter.Contains(MakeHash(2)));
+
+  filter.Rotate();
+  BOOST_CHECK(!filter.Contains(MakeHash(2)));
+  BOOST_CHECK_EQUAL(filter.Size(), 0);
+
+  // Expired hashes can be added again
+  BOOST_CHECK(filter.Insert(MakeHash(1)));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
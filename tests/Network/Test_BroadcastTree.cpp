@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <set>
+
+#include "libNetwork/BroadcastTree.h"
+#include "libUtils/Logger.h"
+
+#define BOOST_TEST_MODULE broadcasttree
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+using namespace boost::multiprecision;
+
+BOOST_AUTO_TEST_SUITE(broadcasttree)
+
+/// Address a.b.x.y as stored in Peer::m_ipAddress
+uint128_t MakeIP(uint32_t a, uint32_t b, uint32_t x, uint32_t y) {
+  return uint128_t(a | (b << 8) | (x << 16) | (y << 24));
+}
+
+/// Nodes spread round robin over numNetworks /16s
+vector<uint128_t> MakeShard(uint32_t size, uint32_t numNetworks) {
+  vector<uint128_t> ips;
+  for (uint32_t i = 0; i < size; i++) {
+    ips.emplace_back(MakeIP(10, i % numNetworks, i / 256, i % 256));
+  }
+  return ips;
+}
+
+/// Walks the tree from the first cluster and returns how often each node
+/// gets the block
+vector<uint32_t> Spread(const vector<uint128_t>& ips, uint32_t clusterSize,
+                        uint32_t numChildClusters) {
+  vector<uint32_t> received(ips.size(), 0);
+  vector<uint32_t> pending;
+  for (uint32_t i = 0; i < min<size_t>(clusterSize, ips.size()); i++) {
+    received.at(i)++;
+    pending.emplace_back(i);
+  }
+  while (!pending.empty()) {
+    const uint32_t node = pending.back();
+    pending.pop_back();
+    for (const auto receiver : BroadcastTree::GetReceivers(
+             ips, node, clusterSize, numChildClusters)) {
+      BOOST_REQUIRE_LT(receiver, ips.size());
+      if (received.at(receiver)++ == 0) {
+        pending.emplace_back(receiver);
+      }
+    }
+  }
+  return received;
+}
+
+BOOST_AUTO_TEST_CASE(test_reaches_every_node) {
+  INIT_STDOUT_LOGGER();
+
+  for (uint32_t size : {1, 9, 10, 11, 57, 600}) {
+    for (uint32_t numChildClusters : {1, 3, 5}) {
+      const auto received = Spread(MakeShard(size, 4), 10, numChildClusters);
+      for (uint32_t i = 0; i < size; i++) {
+        // From every node of the parent cluster, or the DS committee
+        BOOST_CHECK_GE(received.at(i), 1);
+        BOOST_CHECK_LE(received.at(i), 10);
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(test_clusters_by_prefix) {
+  INIT_STDOUT_LOGGER();
+
+  const uint32_t clusterSize = 10;
+  const auto ips = MakeShard(200, 4);
+  const auto order = BroadcastTree::GetOrder(ips, clusterSize);
+
+  // The DS receivers keep their place
+  for (uint32_t i = 0; i < clusterSize; i++) {
+    BOOST_CHECK_EQUAL(order.at(i), i);
+  }
+
+  // 190 nodes over 4 networks, so at most 3 clusters mix two of them
+  unsigned int mixed = 0;
+  for (uint32_t begin = clusterSize; begin < order.size();
+       begin += clusterSize) {
+    set<uint128_t> networks;
+    for (uint32_t i = begin; i < begin + clusterSize; i++) {
+      networks.emplace(ips.at(order.at(i)) & 0xFFFF);
+    }
+    mixed += (networks.size() > 1) ? 1 : 0;
+  }
+  BOOST_CHECK_LE(mixed, 3);
+}
+
+BOOST_AUTO_TEST_CASE(test_leaves_send_nothing) {
+  INIT_STDOUT_LOGGER();
+
+  const auto ips = MakeShard(30, 2);
+
+  // Three clusters of ten with one child each: 0 -> 1 -> 2
+  unsigned int numSenders = 0;
+  for (uint32_t i = 0; i < ips.size(); i++) {
+    const auto receivers = BroadcastTree::GetReceivers(ips, i, 10, 1);
+    BOOST_CHECK(receivers.empty() || (receivers.size() == 10));
+    numSenders += receivers.empty() ? 0 : 1;
+  }
+  BOOST_CHECK_EQUAL(numSenders, 20);
+  BOOST_CHECK(BroadcastTree::GetReceivers(ips, 30, 10, 1).empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
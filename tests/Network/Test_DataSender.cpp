@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <climits>
+#include <map>
+#include "libCrypto/Schnorr.h"
+#include "libNetwork/DataSender.h"
+#include "libUtils/Logger.h"
+
+#define BOOST_TEST_MODULE datasendertest
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(datasendertest)
+
+DequeOfShard MakeShards(unsigned int numShards, unsigned int shardSize) {
+  const PubKey key = Schnorr::GetInstance().GenKeyPair().second;
+  DequeOfShard shards(numShards);
+  uint32_t ip = 1;
+  for (auto& shard : shards) {
+    for (unsigned int i = 0; i < shardSize; i++) {
+      shard.emplace_back(key, Peer(ip++, 30303), 0);
+    }
+  }
+  return shards;
+}
+
+map<Peer, unsigned int> CountReceivers(const DequeOfShard& shards,
+                                       const DequeOfNode& committee,
+                                       uint16_t numSenders, uint16_t offset,
+                                       unsigned int redundancy) {
+  map<Peer, unsigned int> counts;
+  for (uint16_t sender = 0; sender < numSenders; sender++) {
+    deque<vector<Peer>> receivers;
+    DataSender::GetInstance().DetermineSlicedNodesToSendDataTo(
+        shards, committee, numSenders, sender, offset, redundancy, receivers);
+    BOOST_REQUIRE_EQUAL(receivers.size(), shards.size());
+    for (const auto& shardReceivers : receivers) {
+      for (const auto& peer : shardReceivers) {
+        counts[peer]++;
+      }
+    }
+  }
+  return counts;
+}
+
+BOOST_AUTO_TEST_CASE(test_disjoint_slices) {
+  INIT_STDOUT_LOGGER();
+
+  const DequeOfShard shards = MakeShards(3, 20);
+  const auto counts = CountReceivers(shards, {}, 7, 12345, 1);
+
+  BOOST_CHECK_EQUAL(counts.size(), 60);
+  for (const auto& count : counts) {
+    BOOST_CHECK_EQUAL(count.second, 1);
+  }
+
+  // Slices differ by at most one node
+  unsigned int smallest = UINT_MAX, largest = 0;
+  for (uint16_t sender = 0; sender < 7; sender++) {
+    deque<vector<Peer>> receivers;
+    DataSender::GetInstance().DetermineSlicedNodesToSendDataTo(
+        shards, {}, 7, sender, 12345, 1, receivers);
+    unsigned int total = 0;
+    for (const auto& shardReceivers : receivers) {
+      total += shardReceivers.size();
+    }
+    smallest = min(smallest, total);
+    largest = max(largest, total);
+  }
+  BOOST_CHECK_LE(largest - smallest, 1);
+}
+
+BOOST_AUTO_TEST_CASE(test_redundancy) {
+  INIT_STDOUT_LOGGER();
+
+  const DequeOfShard shards = MakeShards(2, 15);
+  for (unsigned int redundancy : {2U, 3U}) {
+    const auto counts = CountReceivers(shards, {}, 10, 7, redundancy);
+    BOOST_CHECK_EQUAL(counts.size(), 30);
+    for (const auto& count : counts) {
+      BOOST_CHECK_EQUAL(count.second, redundancy);
+    }
+  }
+
+  // Asking for more copies than there are cosigners means everyone sends
+  const auto counts = CountReceivers(shards, {}, 2, 0, 5);
+  for (const auto& count : counts) {
+    BOOST_CHECK_EQUAL(count.second, 2);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(test_skipped_nodes) {
+  INIT_STDOUT_LOGGER();
+
+  DequeOfShard shards = MakeShards(2, 10);
+  const Peer repeated = get<SHARD_NODE_PEER>(shards.front().front());
+  const Peer sender = get<SHARD_NODE_PEER>(shards.back().front());
+  shards.back().emplace_back(get<SHARD_NODE_PUBKEY>(shards.front().front()),
+                             repeated, 0);
+
+  DequeOfNode committee;
+  committee.emplace_back(get<SHARD_NODE_PUBKEY>(shards.front().front()),
+                         sender);
+
+  const auto counts = CountReceivers(shards, committee, 4, 1, 1);
+  BOOST_CHECK_EQUAL(counts.size(), 19);
+  BOOST_CHECK(counts.find(sender) == counts.end());
+  BOOST_CHECK_EQUAL(counts.at(repeated), 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cstdlib>
+
+#include "common/Messages.h"
+#include "libNetwork/FrameCompressor.h"
+#include "libUtils/Logger.h"
+
+#define BOOST_TEST_MODULE framecompressor
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(framecompressor)
+
+bytes MakeBody(size_t size, bool random) {
+  bytes body(size);
+  for (size_t i = 0; i < size; i++) {
+    body.at(i) = random ? (rand() & 0xFF) : ((i / 64) % 7);
+  }
+  body.at(MessageOffset::TYPE) = 0x05;
+  body.at(MessageOffset::INST) = 0x02;
+  return body;
+}
+
+BOOST_AUTO_TEST_CASE(test_round_trip) {
+  INIT_STDOUT_LOGGER();
+
+  const bytes body = MakeBody(100000, false);
+
+  bytes compressed;
+  BOOST_REQUIRE(FrameCompressor::Compress(body, 1000, compressed));
+  BOOST_CHECK_LT(compressed.size(), body.size());
+
+  // Message and instruction type stay readable
+  BOOST_CHECK_EQUAL(compressed.at(MessageOffset::TYPE), 0x05);
+  BOOST_CHECK_EQUAL(compressed.at(MessageOffset::INST), 0x02);
+
+  // Decompressed after a prefix that is kept, as for a frame header
+  bytes frame = {0x01, 0x02, 0x03};
+  bytes wire = frame;
+  wire.insert(wire.end(), compressed.begin(), compressed.end());
+  BOOST_REQUIRE(FrameCompressor::Decompress(wire, frame.size(), wire.size(),
+                                            body.size(), frame));
+  BOOST_CHECK_EQUAL(frame.size(), 3 + body.size());
+  BOOST_CHECK(equal(body.begin(), body.end(), frame.begin() + 3));
+}
+
+BOOST_AUTO_TEST_CASE(test_not_compressed) {
+  INIT_STDOUT_LOGGER();
+
+  bytes compressed;
+
+  // Disabled, or below the threshold
+  BOOST_CHECK(!FrameCompressor::Compress(MakeBody(10000, false), 0,
+                                         compressed));
+  BOOST_CHECK(!FrameCompressor::Compress(MakeBody(999, false), 1000,
+                                         compressed));
+
+  // Would not get smaller
+  BOOST_CHECK(!FrameCompressor::Compress(MakeBody(10000, true), 1000,
+                                         compressed));
+}
+
+BOOST_AUTO_TEST_CASE(test_bad_input) {
+  INIT_STDOUT_LOGGER();
+
+  const bytes body = MakeBody(100000, false);
+  bytes compressed;
+  BOOST_REQUIRE(FrameCompressor::Compress(body, 1000, compressed));
+
+  // Expands past the limit
+  bytes out;
+  BOOST_CHECK(!FrameCompressor::Decompress(compressed, 0, compressed.size(),
+                                           body.size() - 1, out));
+  BOOST_CHECK(out.empty());
+
+  // Truncated
+  BOOST_CHECK(!FrameCompressor::Decompress(compressed, 0,
+                                           compressed.size() / 2,
+                                           body.size(), out));
+  BOOST_CHECK(out.empty());
+
+  // Shorter than the types
+  BOOST_CHECK(!FrameCompressor::Decompress(compressed, 0, 1, body.size(),
+                                           out));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,133 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <event2/bufferevent.h>
+#include <event2/event.h>
+#include <chrono>
+#include <thread>
+
+#include "libNetwork/Blacklist.h"
+#include "libNetwork/InboundRateLimiter.h"
+#include "libNetwork/ReputationManager.h"
+#include "libUtils/IPConverter.h"
+#include "libUtils/Logger.h"
+
+#define BOOST_TEST_MODULE inboundratelimiter
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+using namespace boost::multiprecision;
+
+BOOST_AUTO_TEST_SUITE(inboundratelimiter)
+
+uint128_t ToIP(const string& str) {
+  uint128_t result;
+  BOOST_REQUIRE(IPConverter::ToNumericalIPFromStr(str, result));
+  return result;
+}
+
+BOOST_AUTO_TEST_CASE(test_message_rate) {
+  INIT_STDOUT_LOGGER();
+
+  InboundRateLimiter limiter(0, 10);
+  const uint128_t flooder = ToIP("10.0.0.1");
+  const uint128_t other = ToIP("10.0.0.2");
+  ReputationManager::GetInstance().Clear();
+  Blacklist::GetInstance().Clear();
+
+  for (unsigned int i = 0; i < 10; i++) {
+    BOOST_CHECK(limiter.TakeMessage(flooder));
+  }
+  BOOST_CHECK(!limiter.TakeMessage(flooder));
+  BOOST_CHECK(!limiter.TakeMessage(flooder));
+
+  // Senders have separate budgets
+  BOOST_CHECK(limiter.TakeMessage(other));
+
+  // Punished once for the burst, not once per message
+  BOOST_CHECK_EQUAL(ReputationManager::GetInstance().GetReputation(flooder),
+                    ReputationManager::PENALTY_RATE_LIMIT);
+  BOOST_CHECK_EQUAL(ReputationManager::GetInstance().GetReputation(other),
+                    ReputationManager::GOOD);
+
+  // Tokens come back at the configured rate
+  this_thread::sleep_for(chrono::milliseconds(250));
+  BOOST_CHECK(limiter.TakeMessage(flooder));
+  BOOST_CHECK(limiter.TakeMessage(flooder));
+
+  ReputationManager::GetInstance().Clear();
+}
+
+BOOST_AUTO_TEST_CASE(test_unlimited) {
+  INIT_STDOUT_LOGGER();
+
+  InboundRateLimiter limiter(0, 0);
+  const uint128_t ip = ToIP("10.0.0.3");
+  for (unsigned int i = 0; i < 10000; i++) {
+    BOOST_REQUIRE(limiter.TakeMessage(ip));
+  }
+  BOOST_CHECK_EQUAL(limiter.GetSenderCount(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_shared_byte_group) {
+  INIT_STDOUT_LOGGER();
+
+  struct event_base* base = event_base_new();
+  BOOST_REQUIRE(base != nullptr);
+
+  {
+    InboundRateLimiter limiter(1000, 10);
+    const uint128_t ip = ToIP("10.0.0.4");
+
+    struct bufferevent* first = bufferevent_socket_new(base, -1, 0);
+    struct bufferevent* second = bufferevent_socket_new(base, -1, 0);
+    BOOST_REQUIRE(limiter.Attach(first, ip));
+    BOOST_CHECK_EQUAL(bufferevent_get_max_to_read(first), 1000);
+
+    // A second connection splits the allowance instead of adding to it
+    BOOST_REQUIRE(limiter.Attach(second, ip));
+    BOOST_CHECK_EQUAL(limiter.GetSenderCount(), 1);
+    BOOST_CHECK_EQUAL(bufferevent_get_max_to_read(first), 500);
+    BOOST_CHECK_EQUAL(bufferevent_get_max_to_read(second), 500);
+
+    limiter.Detach(first);
+    bufferevent_free(first);
+    BOOST_CHECK_EQUAL(limiter.GetSenderCount(), 1);
+
+    // A sender with a full message budget is forgotten with its last
+    // connection
+    limiter.Detach(second);
+    bufferevent_free(second);
+    BOOST_CHECK_EQUAL(limiter.GetSenderCount(), 0);
+
+    // One still paying off a burst is kept, so reconnecting does not help
+    struct bufferevent* third = bufferevent_socket_new(base, -1, 0);
+    BOOST_REQUIRE(limiter.Attach(third, ip));
+    for (unsigned int i = 0; i < 10; i++) {
+      limiter.TakeMessage(ip);
+    }
+    limiter.Detach(third);
+    bufferevent_free(third);
+    BOOST_CHECK_EQUAL(limiter.GetSenderCount(), 1);
+    BOOST_CHECK(!limiter.TakeMessage(ip));
+  }
+
+  event_base_free(base);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <thread>
+#include <vector>
+
+#include "common/Constants.h"
+#include "libNetwork/MessagePool.h"
+#include "libUtils/Logger.h"
+
+#define BOOST_TEST_MODULE messagepool
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(messagepool)
+
+BOOST_AUTO_TEST_CASE(test_recycle) {
+  INIT_STDOUT_LOGGER();
+
+  MessagePool& pool = MessagePool::GetInstance();
+
+  MessagePool::Message* message = pool.Acquire(1000);
+  BOOST_CHECK(message->first.empty());
+  BOOST_CHECK_GE(message->first.capacity(), 1024);
+  message->first.assign(1000, 0xAB);
+  message->second = Peer(0x0100007F, 5000);
+  const bytes::value_type* data = message->first.data();
+  pool.Release(message);
+
+  // Any size in the same class gets the same buffer back, emptied
+  const uint64_t hits = pool.GetHits();
+  MessagePool::Message* again = pool.Acquire(600);
+  BOOST_CHECK_EQUAL(pool.GetHits(), hits + 1);
+  BOOST_CHECK(again->first.empty());
+  BOOST_CHECK_EQUAL(again->first.data(), data);
+  BOOST_CHECK_EQUAL(again->second.m_listenPortHost, 0);
+  pool.Release(again);
+
+  // A smaller class does not take it
+  const uint64_t misses = pool.GetMisses();
+  MessagePool::Message* small = pool.Acquire(100);
+  BOOST_CHECK_EQUAL(pool.GetMisses(), misses + 1);
+  BOOST_CHECK_GE(small->first.capacity(), MessagePool::MIN_BUFFER_SIZE);
+  pool.Release(small);
+}
+
+BOOST_AUTO_TEST_CASE(test_oversized_and_foreign) {
+  INIT_STDOUT_LOGGER();
+
+  MessagePool& pool = MessagePool::GetInstance();
+  const auto idle = pool.GetMemoryUsage().m_objects;
+
+  // Beyond the largest class, messages are not kept
+  MessagePool::Message* big = pool.Acquire(4 * MessagePool::MAX_BUFFER_SIZE);
+  BOOST_CHECK_GE(big->first.capacity(), 4 * MessagePool::MAX_BUFFER_SIZE);
+  pool.Release(big);
+  BOOST_CHECK_EQUAL(pool.GetMemoryUsage().m_objects, idle);
+
+  // Messages allocated elsewhere are taken back too
+  pool.Release(new MessagePool::Message(bytes(2048), Peer()));
+  BOOST_CHECK_EQUAL(pool.GetMemoryUsage().m_objects, idle + 1);
+  pool.Release(nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(test_concurrent) {
+  INIT_STDOUT_LOGGER();
+
+  MessagePool& pool = MessagePool::GetInstance();
+  vector<thread> threads;
+  for (unsigned int t = 0; t < 8; t++) {
+    threads.emplace_back([&pool, t]() {
+      for (unsigned int i = 0; i < 10000; i++) {
+        const size_t size = (i * 7919 + t * 104729) % 100000;
+        MessagePool::Message* message = pool.Acquire(size);
+        message->first.resize(size);
+        pool.Release(message);
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  const MemoryUsage usage = pool.GetMemoryUsage();
+  BOOST_CHECK_LE(usage.m_bytes,
+                 MESSAGE_POOL_IN_MB * 1024 * 1024 +
+                     usage.m_objects * sizeof(MessagePool::Message));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
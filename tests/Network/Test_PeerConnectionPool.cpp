@@ -0,0 +1,133 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cstring>
+#include <thread>
+
+#include "common/Constants.h"
+#include "libNetwork/PeerConnectionPool.h"
+#include "libUtils/Logger.h"
+
+#define BOOST_TEST_MODULE peerconnectionpool
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(peerconnectionpool)
+
+struct LoopbackListener {
+  int m_listenSock;
+  Peer m_peer;
+
+  LoopbackListener() {
+    m_listenSock = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+    addr.sin_port = 0;
+    bind(m_listenSock, (struct sockaddr*)&addr, sizeof(addr));
+    listen(m_listenSock, 8);
+
+    socklen_t len = sizeof(addr);
+    getsockname(m_listenSock, (struct sockaddr*)&addr, &len);
+    m_peer = Peer(addr.sin_addr.s_addr, ntohs(addr.sin_port));
+  }
+
+  ~LoopbackListener() { close(m_listenSock); }
+
+  /// Returns the client end of a new connection, the server end in accepted
+  int Connect(int& accepted) {
+    int sock = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = m_peer.m_ipAddress.convert_to<unsigned long>();
+    addr.sin_port = htons(m_peer.m_listenPortHost);
+    BOOST_REQUIRE(connect(sock, (struct sockaddr*)&addr, sizeof(addr)) == 0);
+    accepted = accept(m_listenSock, NULL, NULL);
+    BOOST_REQUIRE(accepted >= 0);
+    return sock;
+  }
+};
+
+BOOST_AUTO_TEST_CASE(test_reuse) {
+  INIT_STDOUT_LOGGER();
+
+  if (!PeerConnectionPool::IsEnabled()) {
+    LOG_GENERAL(INFO, "Connection pooling disabled in constants.xml");
+    return;
+  }
+
+  PeerConnectionPool& pool = PeerConnectionPool::GetInstance();
+  LoopbackListener listener;
+
+  BOOST_CHECK_MESSAGE(pool.Acquire(listener.m_peer) == -1,
+                      "Nothing should be pooled yet");
+
+  int accepted = -1;
+  int sock = listener.Connect(accepted);
+  pool.Release(listener.m_peer, sock);
+  BOOST_CHECK_EQUAL(pool.GetIdleCount(listener.m_peer), 1);
+
+  BOOST_CHECK_MESSAGE(pool.Acquire(listener.m_peer) == sock,
+                      "Idle connection should be handed out again");
+  BOOST_CHECK_EQUAL(pool.GetIdleCount(listener.m_peer), 0);
+
+  pool.Release(listener.m_peer, sock);
+  close(accepted);
+
+  // Give the FIN time to arrive
+  this_thread::sleep_for(chrono::milliseconds(100));
+
+  BOOST_CHECK_MESSAGE(pool.Acquire(listener.m_peer) == -1,
+                      "Connection closed by the remote end was reused");
+  BOOST_CHECK_EQUAL(pool.GetIdleCount(listener.m_peer), 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_idle_limit) {
+  INIT_STDOUT_LOGGER();
+
+  if (!PeerConnectionPool::IsEnabled()) {
+    return;
+  }
+
+  PeerConnectionPool& pool = PeerConnectionPool::GetInstance();
+  LoopbackListener listener;
+
+  vector<int> accepted(MAX_IDLE_CONNECTIONS_PER_PEER + 1);
+  for (auto& a : accepted) {
+    pool.Release(listener.m_peer, listener.Connect(a));
+  }
+
+  BOOST_CHECK_EQUAL(pool.GetIdleCount(listener.m_peer),
+                    MAX_IDLE_CONNECTIONS_PER_PEER);
+
+  pool.Remove(listener.m_peer);
+  BOOST_CHECK_EQUAL(pool.GetIdleCount(listener.m_peer), 0);
+
+  for (const auto& a : accepted) {
+    close(a);
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -15,6 +15,7 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include "libNetwork/PeerStore.h"
 #include "libUtils/Logger.h"
 
@@ -76,4 +77,45 @@ BOOST_AUTO_TEST_CASE(test1) {
                       "PeerStore RemoveAllPeers failed");
 }
 
+BOOST_AUTO_TEST_CASE(test_snapshots) {
+  INIT_STDOUT_LOGGER();
+
+  PeerStore& ps = PeerStore::GetStore();
+  ps.RemoveAllPeers();
+
+  vector<PubKey> keys;
+  for (unsigned int i = 0; i < 20; i++) {
+    keys.emplace_back(Schnorr::GetInstance().GenKeyPair().second);
+    ps.AddPeerPair(keys.back(), Peer(i + 1, i + 1));
+  }
+  sort(keys.begin(), keys.end());
+
+  // Shared until the table changes
+  const auto pairs = ps.GetPeerPairsSnapshot();
+  const uint64_t version = ps.GetVersion();
+  BOOST_CHECK(pairs == ps.GetPeerPairsSnapshot());
+  BOOST_CHECK_EQUAL(pairs->size(), 20);
+  BOOST_CHECK(*ps.GetKeysSnapshot() == keys);
+  for (unsigned int i = 0; i < pairs->size(); i++) {
+    BOOST_CHECK(pairs->at(i).first == keys.at(i));
+    BOOST_CHECK(ps.GetPeersSnapshot()->at(i) == pairs->at(i).second);
+  }
+
+  // Adding a pair that is there already changes nothing
+  ps.AddPeerPair(pairs->at(0).first, pairs->at(0).second);
+  BOOST_CHECK_EQUAL(ps.GetVersion(), version);
+  BOOST_CHECK(pairs == ps.GetPeerPairsSnapshot());
+
+  ps.RemovePeer(keys.at(3));
+  BOOST_CHECK(ps.GetVersion() != version);
+  const auto after = ps.GetPeerPairsSnapshot();
+  BOOST_CHECK(pairs != after);
+  BOOST_CHECK_EQUAL(after->size(), 19);
+  BOOST_CHECK_EQUAL(pairs->size(), 20);
+  BOOST_CHECK(after->at(3).first == keys.at(4));
+
+  ps.RemoveAllPeers();
+  BOOST_CHECK(ps.GetPeersSnapshot()->empty());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
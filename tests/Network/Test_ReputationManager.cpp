@@ -24,6 +24,8 @@
 #define BOOST_TEST_DYN_LINK
 #include <arpa/inet.h>
 #include <limits.h>
+#include <thread>
+#include <vector>
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wunused-parameter"
 #include <boost/multiprecision/cpp_int.hpp>
@@ -201,4 +203,32 @@ BOOST_AUTO_TEST_CASE(test_rep_underflow) {
   tearDown();
 }
 
+BOOST_AUTO_TEST_CASE(test_concurrent_updates) {
+  setup();
+  ReputationManager& rm = ReputationManager::GetInstance();
+
+  // Punish and award from several threads, no update may be lost
+  const int32_t threads = 8, rounds = 10;
+  vector<thread> workers;
+  for (int32_t t = 0; t < threads; t++) {
+    workers.emplace_back([&rm]() {
+      for (int32_t i = 0; i < rounds; i++) {
+        rm.PunishNode(node2, ReputationManager::PENALTY_CONN_REFUSE);
+      }
+    });
+  }
+  workers.emplace_back([&rm]() { rm.AwardAllNodes(); });
+  for (auto& worker : workers) {
+    worker.join();
+  }
+
+  int32_t expected = ReputationManager::ScoreType::AWARD_FOR_GOOD_NODES +
+                     threads * rounds * ReputationManager::PENALTY_CONN_REFUSE;
+  int32_t result = rm.GetReputation(node2);
+  BOOST_CHECK_MESSAGE(result == expected, "Concurrent updates test: "
+                                              << result
+                                              << ". Expected: " << expected);
+  tearDown();
+}
+
 BOOST_AUTO_TEST_SUITE_END()
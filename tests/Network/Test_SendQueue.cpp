@@ -0,0 +1,141 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "common/Messages.h"
+#include "libNetwork/P2PComm.h"
+#include "libNetwork/SendQueue.h"
+#include "libUtils/Logger.h"
+
+#define BOOST_TEST_MODULE sendqueue
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(sendqueue)
+
+class TestJob : public SendJob {
+ public:
+  unsigned int m_id;
+  explicit TestJob(unsigned int id) : m_id(id) {}
+  void DoSend() {}
+};
+
+unsigned int PopId(SendQueue& queue) {
+  SendJob* job = queue.TryPop();
+  BOOST_REQUIRE(job != NULL);
+  unsigned int id = dynamic_cast<TestJob*>(job)->m_id;
+  delete job;
+  queue.Done();
+  return id;
+}
+
+BOOST_AUTO_TEST_CASE(test_classify) {
+  INIT_STDOUT_LOGGER();
+
+  BOOST_CHECK_EQUAL(
+      SendQueue::Classify(START_BYTE_NORMAL, MessageType::DIRECTORY,
+                          DSInstructionType::FINALBLOCKCONSENSUS),
+      SEND_CLASS_CONSENSUS);
+  BOOST_CHECK_EQUAL(SendQueue::Classify(START_BYTE_NORMAL, MessageType::NODE,
+                                        NodeInstructionType::FINALBLOCK),
+                    SEND_CLASS_BLOCK);
+  BOOST_CHECK_EQUAL(SendQueue::Classify(START_BYTE_NORMAL, MessageType::NODE,
+                                        NodeInstructionType::FORWARDTXNPACKET),
+                    SEND_CLASS_BULK);
+  BOOST_CHECK_EQUAL(
+      SendQueue::Classify(START_BYTE_NORMAL, MessageType::LOOKUP,
+                          LookupInstructionType::SETSTATEFROMSEED),
+      SEND_CLASS_BULK);
+  BOOST_CHECK_EQUAL(SendQueue::Classify(START_BYTE_GOSSIP, MessageType::NODE,
+                                        NodeInstructionType::FINALBLOCK),
+                    SEND_CLASS_GOSSIP);
+}
+
+BOOST_AUTO_TEST_CASE(test_priority_order) {
+  INIT_STDOUT_LOGGER();
+
+  const size_t capacity[SEND_CLASS_COUNT] = {4, 4, 4, 4};
+  SendQueue queue(capacity, 8);
+
+  BOOST_CHECK(queue.Push(new TestJob(1), SEND_CLASS_BULK));
+  BOOST_CHECK(queue.Push(new TestJob(2), SEND_CLASS_GOSSIP));
+  BOOST_CHECK(queue.Push(new TestJob(3), SEND_CLASS_BULK));
+  BOOST_CHECK(queue.Push(new TestJob(4), SEND_CLASS_CONSENSUS));
+  BOOST_CHECK(queue.Push(new TestJob(5), SEND_CLASS_BLOCK));
+
+  BOOST_CHECK_EQUAL(PopId(queue), 4);
+  BOOST_CHECK_EQUAL(PopId(queue), 5);
+  BOOST_CHECK_EQUAL(PopId(queue), 2);
+  BOOST_CHECK_EQUAL(PopId(queue), 1);
+  BOOST_CHECK_EQUAL(PopId(queue), 3);
+  BOOST_CHECK(queue.TryPop() == NULL);
+
+  BOOST_CHECK_EQUAL(queue.GetStats(SEND_CLASS_BULK).m_enqueued, 2);
+  BOOST_CHECK_EQUAL(queue.GetStats(SEND_CLASS_BULK).m_dispatched, 2);
+  BOOST_CHECK_EQUAL(queue.GetStats(SEND_CLASS_BULK).m_maxDepth, 2);
+  BOOST_CHECK_EQUAL(queue.GetStats(SEND_CLASS_BULK).m_depth, 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_drop_policy) {
+  INIT_STDOUT_LOGGER();
+
+  const size_t capacity[SEND_CLASS_COUNT] = {2, 2, 2, 2};
+  SendQueue queue(capacity, 8);
+
+  // Full consensus class drops its oldest job
+  BOOST_CHECK(queue.Push(new TestJob(1), SEND_CLASS_CONSENSUS));
+  BOOST_CHECK(queue.Push(new TestJob(2), SEND_CLASS_CONSENSUS));
+  BOOST_CHECK(queue.Push(new TestJob(3), SEND_CLASS_CONSENSUS));
+
+  // Full bulk class rejects the new job
+  BOOST_CHECK(queue.Push(new TestJob(4), SEND_CLASS_BULK));
+  BOOST_CHECK(queue.Push(new TestJob(5), SEND_CLASS_BULK));
+  BOOST_CHECK(!queue.Push(new TestJob(6), SEND_CLASS_BULK));
+
+  BOOST_CHECK_EQUAL(queue.GetStats(SEND_CLASS_CONSENSUS).m_dropped, 1);
+  BOOST_CHECK_EQUAL(queue.GetStats(SEND_CLASS_BULK).m_dropped, 1);
+
+  BOOST_CHECK_EQUAL(PopId(queue), 2);
+  BOOST_CHECK_EQUAL(PopId(queue), 3);
+  BOOST_CHECK_EQUAL(PopId(queue), 4);
+  BOOST_CHECK_EQUAL(PopId(queue), 5);
+}
+
+BOOST_AUTO_TEST_CASE(test_in_flight_limit) {
+  INIT_STDOUT_LOGGER();
+
+  const size_t capacity[SEND_CLASS_COUNT] = {4, 4, 4, 4};
+  SendQueue queue(capacity, 1);
+
+  BOOST_CHECK(queue.Push(new TestJob(1), SEND_CLASS_BULK));
+  SendJob* job = queue.TryPop();
+  BOOST_REQUIRE(job != NULL);
+
+  // A consensus job queued while the only slot is busy goes out next
+  BOOST_CHECK(queue.Push(new TestJob(2), SEND_CLASS_BULK));
+  BOOST_CHECK(queue.Push(new TestJob(3), SEND_CLASS_CONSENSUS));
+  BOOST_CHECK(queue.TryPop() == NULL);
+
+  delete job;
+  queue.Done();
+
+  BOOST_CHECK_EQUAL(PopId(queue), 3);
+  BOOST_CHECK_EQUAL(PopId(queue), 2);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
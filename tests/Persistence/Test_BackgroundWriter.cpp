@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+#include "libPersistence/BackgroundWriter.h"
+#include "libUtils/Logger.h"
+
+#define BOOST_TEST_MODULE backgroundwriter
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(backgroundwriter)
+
+BOOST_AUTO_TEST_CASE(test_order_and_batches) {
+  INIT_STDOUT_LOGGER();
+
+  BackgroundWriter writer(1000, 8);
+  vector<unsigned int> order;
+  for (unsigned int i = 0; i < 100; i++) {
+    BOOST_CHECK(writer.Post("test", [&order, i]() {
+      order.push_back(i);
+      return i % 10 != 0;
+    }));
+  }
+  writer.Flush();
+
+  BOOST_REQUIRE_EQUAL(order.size(), 100);
+  for (unsigned int i = 0; i < order.size(); i++) {
+    BOOST_CHECK_EQUAL(order[i], i);
+  }
+
+  const auto stats = writer.GetStats();
+  BOOST_CHECK_EQUAL(stats.m_queued, 0);
+  BOOST_CHECK_EQUAL(stats.m_written, 90);
+  BOOST_CHECK_EQUAL(stats.m_failed, 10);
+  BOOST_CHECK_EQUAL(stats.m_dropped, 0);
+  // At least ceil(100 / 8) wake-ups, however the posts raced the thread
+  BOOST_CHECK_GE(stats.m_batches, 13);
+}
+
+BOOST_AUTO_TEST_CASE(test_bounded_queue) {
+  INIT_STDOUT_LOGGER();
+
+  BackgroundWriter writer(4, 2);
+
+  // Holds the thread in the first write while the queue fills up
+  mutex m;
+  condition_variable cv;
+  bool started = false;
+  bool release = false;
+  BOOST_CHECK(writer.Post("blocker", [&]() {
+    unique_lock<mutex> g(m);
+    started = true;
+    cv.notify_all();
+    cv.wait(g, [&release]() { return release; });
+    return true;
+  }));
+  {
+    unique_lock<mutex> g(m);
+    cv.wait(g, [&started]() { return started; });
+  }
+
+  atomic<unsigned int> done{0};
+  for (unsigned int i = 0; i < 4; i++) {
+    BOOST_CHECK(writer.Post("test", [&done]() {
+      done++;
+      return true;
+    }));
+  }
+  BOOST_CHECK(!writer.Post("test", [&done]() {
+    done++;
+    return true;
+  }));
+
+  {
+    lock_guard<mutex> g(m);
+    release = true;
+  }
+  cv.notify_all();
+  writer.Flush();
+
+  BOOST_CHECK_EQUAL(done, 4);
+  const auto stats = writer.GetStats();
+  BOOST_CHECK_EQUAL(stats.m_written, 5);
+  BOOST_CHECK_EQUAL(stats.m_dropped, 1);
+}
+
+BOOST_AUTO_TEST_CASE(test_drain_on_destruction) {
+  INIT_STDOUT_LOGGER();
+
+  atomic<unsigned int> done{0};
+  {
+    BackgroundWriter writer(100, 4);
+    for (unsigned int i = 0; i < 50; i++) {
+      writer.Post("test", [&done]() {
+        done++;
+        return true;
+      });
+    }
+  }
+  BOOST_CHECK_EQUAL(done, 50);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
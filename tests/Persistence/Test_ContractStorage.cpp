@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <string>
+#include <vector>
+#include "libPersistence/ContractStorage.h"
+#include "libUtils/Logger.h"
+
+#define BOOST_TEST_MODULE contractstoragetest
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+using namespace Contract;
+
+BOOST_AUTO_TEST_SUITE(contractstoragetest)
+
+BOOST_AUTO_TEST_CASE(testStatePages) {
+  INIT_STDOUT_LOGGER();
+
+  LOG_MARKER();
+
+  ContractStorage& storage = ContractStorage::GetContractStorage();
+  storage.Reset();
+
+  const dev::h160 address(1);
+  vector<StateEntry> states;
+  states.emplace_back("_balance", true, "Uint128", "0");
+  states.emplace_back("owner", false, "ByStr20", "0x1234");
+  states.emplace_back("total", true, "Uint128", "3");
+  states.emplace_back(
+      "balances", true, "Map ByStr20 Uint128",
+      R"([{"key":"0xaa01","val":"1"},{"key":"0xbb02","val":"2"},)"
+      R"({"key":"0xaa03","val":"3"}])");
+  dev::h256 stateHash;
+  BOOST_REQUIRE(storage.PutContractState(address, states, stateHash));
+
+  // Immutable fields are skipped, as in GetContractStateJson
+  unsigned int cursor = 0;
+  Json::Value fields;
+  BOOST_REQUIRE(storage.GetContractStateJsonPage(address, cursor, 2, fields));
+  BOOST_CHECK_EQUAL(fields.size(), 2u);
+  BOOST_CHECK_EQUAL(fields[0u]["vname"].asString(), "_balance");
+  BOOST_CHECK_EQUAL(fields[1u]["vname"].asString(), "total");
+  BOOST_CHECK_EQUAL(cursor, 3u);
+
+  BOOST_REQUIRE(storage.GetContractStateJsonPage(address, cursor, 2, fields));
+  BOOST_CHECK_EQUAL(fields.size(), 1u);
+  BOOST_CHECK_EQUAL(fields[0u]["vname"].asString(), "balances");
+  BOOST_CHECK_EQUAL(cursor, 0u);
+
+  cursor = 5;
+  BOOST_CHECK(!storage.GetContractStateJsonPage(address, cursor, 2, fields));
+
+  // Map entries with the key prefix, one per page
+  Json::Value field;
+  cursor = 0;
+  BOOST_REQUIRE(storage.GetContractStateMapEntries(address, "balances",
+                                                   "0xaa", cursor, 1, field));
+  BOOST_CHECK_EQUAL(field["value"].size(), 1u);
+  BOOST_CHECK_EQUAL(field["value"][0u]["key"].asString(), "0xaa01");
+  BOOST_CHECK_EQUAL(cursor, 1u);
+
+  BOOST_REQUIRE(storage.GetContractStateMapEntries(address, "balances",
+                                                   "0xaa", cursor, 1, field));
+  BOOST_CHECK_EQUAL(field["value"].size(), 1u);
+  BOOST_CHECK_EQUAL(field["value"][0u]["key"].asString(), "0xaa03");
+  BOOST_CHECK_EQUAL(cursor, 0u);
+
+  // Non-map fields come whole
+  BOOST_REQUIRE(storage.GetContractStateMapEntries(address, "total", "",
+                                                   cursor, 1, field));
+  BOOST_CHECK_EQUAL(field["value"].asString(), "3");
+  BOOST_CHECK_EQUAL(cursor, 0u);
+
+  BOOST_CHECK(!storage.GetContractStateMapEntries(address, "missing", "",
+                                                  cursor, 1, field));
+  BOOST_CHECK(!storage.GetContractStateMapEntries(address, "owner", "",
+                                                  cursor, 1, field));
+
+  storage.Reset();
+}
+
+BOOST_AUTO_TEST_CASE(testCommitCachedStates) {
+  INIT_STDOUT_LOGGER();
+
+  LOG_MARKER();
+
+  ContractStorage& storage = ContractStorage::GetContractStorage();
+  storage.Reset();
+
+  const dev::h160 address(2);
+  vector<StateEntry> states;
+  states.emplace_back("_balance", true, "Uint128", "0");
+  states.emplace_back("total", true, "Uint128", "1");
+  dev::h256 stateHash;
+  BOOST_REQUIRE(storage.PutContractState(address, states, stateHash));
+
+  // Readable before the commit, and unchanged by it
+  StateEntry entry;
+  BOOST_REQUIRE(storage.GetContractStateEntry(address, "total", entry));
+  BOOST_CHECK_EQUAL(std::get<VALUE>(entry), "1");
+  BOOST_REQUIRE(storage.CommitTempStateDB());
+  BOOST_CHECK_EQUAL(storage.GetContractStateHash(address), stateHash);
+  BOOST_REQUIRE(storage.GetContractStateEntry(address, "total", entry));
+  BOOST_CHECK_EQUAL(std::get<VALUE>(entry), "1");
+
+  // Putting a field several times in an epoch commits its last value
+  for (unsigned int i = 2; i <= 5; i++) {
+    const vector<StateEntry> update{
+        StateEntry("total", true, "Uint128", to_string(i))};
+    BOOST_REQUIRE(storage.PutContractState(address, update, stateHash));
+  }
+  BOOST_CHECK_EQUAL(storage.GetContractStateIndexes(address).size(), 2u);
+  BOOST_REQUIRE(storage.CommitTempStateDB());
+  BOOST_CHECK_EQUAL(storage.GetContractStateHash(address), stateHash);
+  BOOST_REQUIRE(storage.GetContractStateEntry(address, "total", entry));
+  BOOST_CHECK_EQUAL(std::get<VALUE>(entry), "5");
+  BOOST_CHECK(!storage.GetContractStateEntry(address, "missing", entry));
+
+  storage.Reset();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
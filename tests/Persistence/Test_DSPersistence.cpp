@@ -403,7 +403,7 @@ BOOST_AUTO_TEST_CASE(testRetrieveAllTheDSBlocksInDB) {
       in_blocks.emplace_back(block);
     }
 
-    std::list<DSBlockSharedPtr> ref_blocks;
+    std::vector<DSBlockSharedPtr> ref_blocks;
     std::list<DSBlock> out_blocks;
     BOOST_CHECK_MESSAGE(
         BlockStorage::GetBlockStorage().GetAllDSBlocks(ref_blocks),
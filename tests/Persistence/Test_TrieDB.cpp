@@ -16,7 +16,10 @@
  */
 
 #include <leveldb/db.h>
+#include <chrono>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "depends/common/CommonIO.h"
 #include "depends/common/FixedHash.h"
@@ -124,4 +127,68 @@ BOOST_AUTO_TEST_CASE(retrieveDataStoredInTheTwoTrie) {
                       "ERROR: Trie4 cannot get the element in Trie2");
 }
 
+BOOST_AUTO_TEST_CASE(pruneUnreachableNodes) {
+  INIT_STDOUT_LOGGER();
+
+  LOG_MARKER();
+
+  const unsigned int keepRoots = 2;
+  vector<h256> keys;
+  vector<h256> roots;
+  {
+    dev::OverlayDB db("prunedTrieDB");
+    db.ResetDB();
+    db.enablePruning(keepRoots);
+
+    SecureTrieDB<h256, dev::OverlayDB> trie(&db);
+    trie.init();
+    for (unsigned int i = 0; i < 50; i++) {
+      keys.emplace_back(h256::random());
+      trie.insert(keys.back(), to_string(0));
+    }
+    db.commit();
+    roots.emplace_back(trie.root());
+
+    // Each round rewrites part of the trie
+    for (unsigned int round = 1; round <= 5; round++) {
+      for (unsigned int i = 0; i < 10; i++) {
+        trie.insert(keys.at(i), to_string(round));
+      }
+      db.commit();
+      roots.emplace_back(trie.root());
+    }
+
+    const uint64_t lastPruned = roots.size() - keepRoots;
+    for (unsigned int i = 0; i < 500; i++) {
+      if (db.pruningProgress().second > lastPruned) {
+        break;
+      }
+      this_thread::sleep_for(chrono::milliseconds(10));
+    }
+    BOOST_CHECK_EQUAL(db.pruningProgress().first, roots.size());
+    BOOST_CHECK_EQUAL(db.pruningProgress().second, lastPruned + 1);
+
+    // The roots kept are whole
+    for (unsigned int r = roots.size() - keepRoots; r < roots.size(); r++) {
+      trie.setRoot(roots.at(r));
+      BOOST_CHECK_EQUAL(trie.at(keys.front()), to_string(r));
+      for (const auto& key : keys) {
+        BOOST_CHECK(trie.contains(key));
+      }
+    }
+
+    // The older ones are gone
+    for (unsigned int r = 0; r < roots.size() - keepRoots; r++) {
+      BOOST_CHECK(!db.exists(roots.at(r)));
+    }
+  }
+
+  // Picks up where it left off
+  dev::OverlayDB db("prunedTrieDB");
+  db.enablePruning(keepRoots);
+  BOOST_CHECK_EQUAL(db.pruningProgress().first, roots.size());
+  BOOST_CHECK_EQUAL(db.pruningProgress().second,
+                    roots.size() - keepRoots + 1);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -15,6 +15,7 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include <array>
 #include <string>
 #include <vector>
@@ -169,4 +170,95 @@ BOOST_AUTO_TEST_CASE(testRandomBlockAccesses) {
   }
 }
 
+BOOST_AUTO_TEST_CASE(testGetTxBodies) {
+  INIT_STDOUT_LOGGER();
+
+  LOG_MARKER();
+  if (LOOKUP_NODE_MODE) {
+    // Enough bodies to be split over several parse jobs
+    vector<TxnHash> hashes;
+    for (int i = 0; i < 300; i++) {
+      TransactionWithReceipt body = constructDummyTxBody(100 + i);
+      bytes serializedTxBody;
+      body.Serialize(serializedTxBody, 0);
+      hashes.emplace_back(body.GetTransaction().GetTranID());
+      BlockStorage::GetBlockStorage().PutTxBody(hashes.back(),
+                                                serializedTxBody);
+    }
+
+    vector<TxBodySharedPtr> bodies;
+    BOOST_CHECK(BlockStorage::GetBlockStorage().GetTxBodies(hashes, bodies));
+    BOOST_CHECK_EQUAL(bodies.size(), hashes.size());
+    for (size_t i = 0; i < bodies.size(); i++) {
+      BOOST_CHECK_MESSAGE(
+          bodies[i]->GetTransaction().GetTranID() == hashes[i],
+          "bodies should come back in the order of the requested hashes");
+    }
+
+    hashes.emplace_back(TxnHash());
+    BOOST_CHECK(!BlockStorage::GetBlockStorage().GetTxBodies(hashes, bodies));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testQueueTxBodies) {
+  INIT_STDOUT_LOGGER();
+
+  LOG_MARKER();
+  if (LOOKUP_NODE_MODE) {
+    vector<TransactionWithReceipt> txns;
+    vector<TxnHash> hashes;
+    for (int i = 0; i < 50; i++) {
+      txns.emplace_back(constructDummyTxBody(500 + i));
+      hashes.emplace_back(txns.back().GetTransaction().GetTranID());
+    }
+    BOOST_CHECK(BlockStorage::GetBlockStorage().QueueTxBodies(txns));
+
+    // Readable whether or not the writer got to them yet
+    vector<TxBodySharedPtr> bodies;
+    BOOST_CHECK(BlockStorage::GetBlockStorage().GetTxBodies(hashes, bodies));
+    BOOST_CHECK_EQUAL(bodies.size(), hashes.size());
+
+    BOOST_CHECK(BlockStorage::GetBlockStorage().FlushTxBodies());
+    vector<TxnHash> tmpHashes;
+    BOOST_CHECK(BlockStorage::GetBlockStorage().GetAllTxBodiesTmp(tmpHashes));
+    for (const auto& hash : hashes) {
+      BOOST_CHECK(find(tmpHashes.begin(), tmpHashes.end(), hash) !=
+                  tmpHashes.end());
+      TxBodySharedPtr body;
+      BOOST_CHECK(BlockStorage::GetBlockStorage().GetTxBody(hash, body));
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testBlockHashIndex) {
+  INIT_STDOUT_LOGGER();
+
+  LOG_MARKER();
+  if (LOOKUP_NODE_MODE) {
+    BlockStorage::GetBlockStorage().ResetDB(BlockStorage::BLOCK_HASH_INDEX);
+
+    // Block numbers that differ only in their high bytes must not mix
+    const vector<uint64_t> blockNums = {0, 1, 2, 255, 256, 1ULL << 40};
+    for (const auto& blockNum : blockNums) {
+      BOOST_CHECK(BlockStorage::GetBlockStorage().PutBlockHash(
+          BlockType::Tx, blockNum, BlockHash(blockNum + 1)));
+    }
+    BOOST_CHECK(BlockStorage::GetBlockStorage().PutBlockHash(
+        BlockType::DS, 1, BlockHash(100)));
+
+    map<uint64_t, BlockHash> blockHashes;
+    BOOST_CHECK(BlockStorage::GetBlockStorage().GetBlockHashes(
+        BlockType::Tx, 1, 256, blockHashes));
+    BOOST_CHECK_EQUAL(blockHashes.size(), 4);
+    for (const auto& entry : blockHashes) {
+      BOOST_CHECK(entry.second == BlockHash(entry.first + 1));
+    }
+
+    BOOST_CHECK(BlockStorage::GetBlockStorage().GetBlockHashes(
+        BlockType::DS, 0, 1ULL << 40, blockHashes));
+    BOOST_CHECK_EQUAL(blockHashes.size(), 1);
+    BOOST_CHECK(blockHashes[1] == BlockHash(100));
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
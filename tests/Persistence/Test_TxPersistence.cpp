@@ -21,6 +21,7 @@
 #include <vector>
 
 #include "libData/BlockData/Block.h"
+#include "libPersistence/BlockArchive.h"
 #include "libPersistence/BlockStorage.h"
 #include "libPersistence/DB.h"
 #include "libUtils/TimeUtils.h"
@@ -311,7 +312,7 @@ BOOST_AUTO_TEST_CASE(testRetrieveAllTheTxBlocksInDB) {
       in_blocks.emplace_back(block);
     }
 
-    std::list<TxBlockSharedPtr> ref_blocks;
+    std::vector<TxBlockSharedPtr> ref_blocks;
     std::list<TxBlock> out_blocks;
     BOOST_CHECK_MESSAGE(
         BlockStorage::GetBlockStorage().GetAllTxBlocks(ref_blocks),
@@ -326,4 +327,154 @@ BOOST_AUTO_TEST_CASE(testRetrieveAllTheTxBlocksInDB) {
   }
 }
 
+BOOST_AUTO_TEST_CASE(testRetrieveTxBlockNumsInOrder) {
+  INIT_STDOUT_LOGGER();
+
+  LOG_MARKER();
+
+  if (BlockStorage::GetBlockStorage().ResetDB(BlockStorage::DBTYPE::TX_BLOCK)) {
+    // The keys are decimal strings, so "10" sorts before "2" on disk
+    for (int i = 0; i < 12; i++) {
+      bytes serializedTxBlock;
+      constructDummyTxBlock(i).Serialize(serializedTxBlock, 0);
+      BlockStorage::GetBlockStorage().PutTxBlock(i, serializedTxBlock);
+    }
+
+    std::vector<uint64_t> blockNums;
+    BOOST_CHECK_MESSAGE(
+        BlockStorage::GetBlockStorage().GetAllTxBlockNums(blockNums),
+        "GetAllTxBlockNums shouldn't fail");
+    BOOST_CHECK_EQUAL(blockNums.size(), 12);
+    for (size_t i = 0; i < blockNums.size(); i++) {
+      BOOST_CHECK_EQUAL(blockNums[i], i);
+    }
+  }
+}
+
+MicroBlock constructDummyMicroBlock(uint64_t epochNum, uint32_t shardId) {
+  PairOfKey pubKey1 = Schnorr::GetInstance().GenKeyPair();
+
+  return MicroBlock(
+      MicroBlockHeader(shardId, 1, 1, 1, epochNum, MicroBlockHashSet(), 0,
+                       pubKey1.second, 1, MICROBLOCK_VERSION, CommitteeHash(),
+                       BlockHash()),
+      vector<TxnHash>(), CoSignatures());
+}
+
+BOOST_AUTO_TEST_CASE(testRetrieveMicroBlocksInRange) {
+  INIT_STDOUT_LOGGER();
+
+  LOG_MARKER();
+
+  if (BlockStorage::GetBlockStorage().ResetDB(
+          BlockStorage::DBTYPE::MICROBLOCK)) {
+    for (uint64_t epochNum = 1; epochNum <= 5; epochNum++) {
+      for (uint32_t shardId = 0; shardId < 4; shardId++) {
+        MicroBlock block = constructDummyMicroBlock(epochNum, shardId);
+        bytes body;
+        block.Serialize(body, 0);
+        BOOST_CHECK(BlockStorage::GetBlockStorage().PutMicroBlock(
+            block.GetBlockHash(), epochNum, shardId, body));
+      }
+    }
+
+    std::vector<MicroBlockSharedPtr> blocks;
+    BOOST_CHECK_MESSAGE(
+        BlockStorage::GetBlockStorage().GetRangeMicroBlocks(2, 4, 1, 2, blocks),
+        "GetRangeMicroBlocks shouldn't fail");
+    BOOST_CHECK_EQUAL(blocks.size(), 6);
+
+    uint64_t lastEpochNum = 0;
+    for (const auto& block : blocks) {
+      const auto& header = block->GetHeader();
+      BOOST_CHECK(header.GetEpochNum() >= 2 && header.GetEpochNum() <= 4);
+      BOOST_CHECK(header.GetShardId() >= 1 && header.GetShardId() <= 2);
+      BOOST_CHECK(header.GetEpochNum() >= lastEpochNum);
+      lastEpochNum = header.GetEpochNum();
+    }
+
+    blocks.clear();
+    BOOST_CHECK(!BlockStorage::GetBlockStorage().GetRangeMicroBlocks(6, 9, 0, 3,
+                                                                     blocks));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testPruneStateDeltas) {
+  INIT_STDOUT_LOGGER();
+
+  LOG_MARKER();
+
+  if (BlockStorage::GetBlockStorage().ResetDB(
+          BlockStorage::DBTYPE::STATE_DELTA)) {
+    for (uint64_t i = 3; i < 12; i++) {
+      BlockStorage::GetBlockStorage().PutStateDelta(i, bytes(8, i));
+    }
+
+    BOOST_CHECK(BlockStorage::GetBlockStorage().PruneStateDeltas(7));
+    // Pruning to an earlier block is a no-op
+    BOOST_CHECK(BlockStorage::GetBlockStorage().PruneStateDeltas(5));
+
+    for (uint64_t i = 3; i < 12; i++) {
+      bytes stateDelta;
+      BlockStorage::GetBlockStorage().GetStateDelta(i, stateDelta);
+      BOOST_CHECK_EQUAL(stateDelta.empty(), i < 7);
+    }
+
+    BOOST_CHECK(BlockStorage::GetBlockStorage().PruneStateDeltas(10));
+    bytes stateDelta;
+    BlockStorage::GetBlockStorage().GetStateDelta(9, stateDelta);
+    BOOST_CHECK(stateDelta.empty());
+    BlockStorage::GetBlockStorage().GetStateDelta(10, stateDelta);
+    BOOST_CHECK(stateDelta == bytes(8, 10));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testBlockArchive) {
+  INIT_STDOUT_LOGGER();
+
+  LOG_MARKER();
+
+  {
+    // Small enough that every other body starts a new segment
+    BlockArchive archive("testArchive", 64);
+    BOOST_CHECK(archive.Reset());
+
+    for (uint8_t i = 0; i < 5; i++) {
+      BOOST_CHECK(archive.Put(to_string(i), bytes(40, i)));
+    }
+    // Larger than a segment
+    BOOST_CHECK(archive.Put("big", bytes(100, 0xAB)));
+
+    for (uint8_t i = 0; i < 5; i++) {
+      bytes body;
+      BOOST_CHECK(archive.Get(to_string(i), body));
+      BOOST_CHECK(body == bytes(40, i));
+    }
+
+    BOOST_CHECK(archive.Delete("2"));
+    bytes body;
+    BOOST_CHECK(!archive.Get("2", body));
+    BOOST_CHECK(!archive.Get("missing", body));
+  }
+
+  // Reopening appends after the existing segments
+  BlockArchive archive("testArchive", 64);
+  BOOST_CHECK(archive.Put("5", bytes(40, 5)));
+
+  vector<string> keys;
+  BOOST_CHECK(archive.GetKeys(keys));
+  BOOST_CHECK_EQUAL(keys.size(), 6u);
+  for (const auto& key : keys) {
+    bytes body;
+    BOOST_CHECK(archive.Get(key, body));
+    BOOST_CHECK(key == "big" ? body == bytes(100, 0xAB)
+                             : body == bytes(40, stoi(key)));
+  }
+
+  BOOST_CHECK(archive.Reset());
+  keys.clear();
+  BOOST_CHECK(archive.GetKeys(keys));
+  BOOST_CHECK(keys.empty());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -67,4 +67,36 @@ BOOST_AUTO_TEST_CASE(RRS_Initialization) {
   BOOST_CHECK(dummy_message_push == dummy_message_push);
   BOOST_TEST_MESSAGE("RRS Message undefined: " << dummy_message_undefined);
 }
+
+/**
+ * \brief Adaptive fan-out and total rounds
+ *
+ * \details Duplicate receipts from every peer pushed to bring fan-out and
+ * total rounds down to their floors; silent peers bring them back up.
+ */
+BOOST_AUTO_TEST_CASE(RRS_Adaptation) {
+  std::unordered_set<int> peerIdSet;
+  for (int i = 0; i < 16; i++) {
+    peerIdSet.insert(i);
+  }
+  RRS::RumorHolder holder(peerIdSet, 2, 3, 6, 5, 0);
+  holder.enableAdaptation(2, 3);
+  BOOST_CHECK(holder.addRumor(1));
+
+  for (int round = 0; round < 20; round++) {
+    const auto toMembers = holder.advanceRound().first;
+    for (const int peer : toMembers) {
+      holder.receivedMessage(RRS::Message(RRS::Message::Type::LAZY_PULL, 1, 1),
+                             peer);
+    }
+  }
+  BOOST_CHECK_EQUAL(holder.maxNeighborsPerRound(), 2);
+  BOOST_CHECK_EQUAL(holder.networkConfig().maxRoundsTotal(), 3);
+
+  for (int round = 0; round < 20; round++) {
+    holder.advanceRound();
+  }
+  BOOST_CHECK_EQUAL(holder.maxNeighborsPerRound(), 5);
+  BOOST_CHECK_EQUAL(holder.networkConfig().maxRoundsTotal(), 6);
+}
 BOOST_AUTO_TEST_SUITE_END()
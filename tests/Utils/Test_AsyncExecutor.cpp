@@ -0,0 +1,155 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "libUtils/AsyncExecutor.h"
+#include "libUtils/Logger.h"
+
+#define BOOST_TEST_MODULE asyncexecutor
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+
+namespace {
+/// Waits up to timeout for pred to hold
+template <class Pred>
+bool WaitFor(Pred pred, chrono::milliseconds timeout) {
+  const auto end = chrono::steady_clock::now() + timeout;
+  while (!pred()) {
+    if (chrono::steady_clock::now() > end) {
+      return false;
+    }
+    this_thread::sleep_for(chrono::milliseconds(1));
+  }
+  return true;
+}
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(asyncexecutor)
+
+BOOST_AUTO_TEST_CASE(test_post) {
+  INIT_STDOUT_LOGGER();
+
+  AsyncExecutor executor(4, 1000);
+  atomic<unsigned int> done{0};
+  for (unsigned int i = 0; i < 500; i++) {
+    BOOST_CHECK(executor.Post([&done]() { done++; }));
+  }
+  BOOST_CHECK(WaitFor([&done]() { return done == 500; },
+                      chrono::milliseconds(5000)));
+  BOOST_CHECK(WaitFor([&executor]() {
+    return executor.GetStats().m_completed == 500;
+  }, chrono::milliseconds(5000)));
+
+  const AsyncExecutor::Stats stats = executor.GetStats();
+  BOOST_CHECK_EQUAL(stats.m_threads, 4);
+  BOOST_CHECK_EQUAL(stats.m_queued, 0);
+  BOOST_CHECK_EQUAL(stats.m_rejected, 0);
+
+  // A throwing task does not take its thread down
+  BOOST_CHECK(executor.Post([]() { throw runtime_error("test"); }));
+  BOOST_CHECK(executor.Post([&done]() { done++; }));
+  BOOST_CHECK(WaitFor([&done]() { return done == 501; },
+                      chrono::milliseconds(5000)));
+}
+
+BOOST_AUTO_TEST_CASE(test_bounded_queue) {
+  INIT_STDOUT_LOGGER();
+
+  AsyncExecutor executor(1, 2);
+  mutex m;
+  condition_variable cv;
+  bool release = false;
+  atomic<bool> started{false};
+  auto blocker = [&]() {
+    started = true;
+    unique_lock<mutex> lock(m);
+    cv.wait(lock, [&release]() { return release; });
+  };
+
+  BOOST_REQUIRE(executor.Post(blocker));
+  BOOST_REQUIRE(WaitFor([&started]() { return started.load(); },
+                        chrono::milliseconds(5000)));
+  BOOST_CHECK_EQUAL(executor.GetStats().m_running, 1);
+
+  BOOST_CHECK(executor.Post([]() {}));
+  BOOST_CHECK(executor.Post([]() {}));
+  BOOST_CHECK(!executor.Post([]() {}));
+  BOOST_CHECK_EQUAL(executor.GetStats().m_queued, 2);
+  BOOST_CHECK_EQUAL(executor.GetStats().m_rejected, 1);
+
+  {
+    lock_guard<mutex> g(m);
+    release = true;
+  }
+  cv.notify_all();
+  BOOST_CHECK(WaitFor([&executor]() {
+    return executor.GetStats().m_completed == 3;
+  }, chrono::milliseconds(5000)));
+}
+
+BOOST_AUTO_TEST_CASE(test_post_after) {
+  INIT_STDOUT_LOGGER();
+
+  AsyncExecutor executor(2, 100);
+  mutex m;
+  vector<unsigned int> order;
+  auto record = [&m, &order](unsigned int i) {
+    return [&m, &order, i]() {
+      lock_guard<mutex> g(m);
+      order.push_back(i);
+    };
+  };
+
+  const auto start = chrono::steady_clock::now();
+  executor.PostAfter(chrono::milliseconds(300), record(3));
+  const auto cancelled =
+      executor.PostAfter(chrono::milliseconds(200), record(0));
+  executor.PostAfter(chrono::milliseconds(100), record(1));
+  executor.PostAfter(chrono::milliseconds(200), record(2));
+  BOOST_CHECK_EQUAL(executor.GetStats().m_delayed, 4);
+
+  BOOST_CHECK(executor.Cancel(cancelled));
+  BOOST_CHECK(!executor.Cancel(cancelled));
+
+  BOOST_REQUIRE(WaitFor([&m, &order]() {
+    lock_guard<mutex> g(m);
+    return order.size() == 3;
+  }, chrono::milliseconds(5000)));
+  BOOST_CHECK(chrono::steady_clock::now() - start >=
+              chrono::milliseconds(300));
+  BOOST_CHECK((order == vector<unsigned int>{1, 2, 3}));
+  BOOST_CHECK_EQUAL(executor.GetStats().m_delayed, 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_prometheus_text) {
+  INIT_STDOUT_LOGGER();
+
+  AsyncExecutor executor(3, 10);
+  const string text = executor.GetPrometheusText();
+  BOOST_CHECK(text.find("zilliqa_async_threads 3\n") != string::npos);
+  BOOST_CHECK(text.find("zilliqa_async_tasks{state=\"queued\"} 0\n") !=
+              string::npos);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
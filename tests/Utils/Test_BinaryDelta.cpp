@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <random>
+
+#include "libUtils/BinaryDelta.h"
+#include "libUtils/Logger.h"
+
+#define BOOST_TEST_MODULE binarydelta
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(binarydelta)
+
+bytes RandomBytes(size_t size, mt19937& rng) {
+  uniform_int_distribution<unsigned int> dist(0, 255);
+  bytes result(size);
+  for (auto& b : result) {
+    b = static_cast<unsigned char>(dist(rng));
+  }
+  return result;
+}
+
+BOOST_AUTO_TEST_CASE(test_roundtrip) {
+  INIT_STDOUT_LOGGER();
+
+  mt19937 rng(7);
+  const bytes base = RandomBytes(200000, rng);
+
+  // Edit the middle, move a region and append some new bytes
+  bytes target(base.begin(), base.begin() + 50000);
+  const bytes inserted = RandomBytes(1000, rng);
+  target.insert(target.end(), inserted.begin(), inserted.end());
+  target.insert(target.end(), base.begin() + 150000, base.end());
+  target.insert(target.end(), base.begin() + 50500, base.begin() + 150000);
+  target[120000] ^= 0xFF;
+  const bytes tail = RandomBytes(333, rng);
+  target.insert(target.end(), tail.begin(), tail.end());
+
+  bytes delta;
+  BOOST_REQUIRE(BinaryDelta::Create(base, target, delta));
+  BOOST_CHECK_LT(delta.size(), 4000);
+
+  bytes rebuilt;
+  BOOST_REQUIRE(BinaryDelta::Apply(base, delta, rebuilt));
+  BOOST_CHECK(rebuilt == target);
+}
+
+BOOST_AUTO_TEST_CASE(test_small_and_unrelated) {
+  INIT_STDOUT_LOGGER();
+
+  mt19937 rng(11);
+  for (size_t size : {0, 1, 63, 64, 65, 5000}) {
+    const bytes base = RandomBytes(size, rng);
+    const bytes target = RandomBytes(size + 17, rng);
+    bytes delta, rebuilt;
+    BOOST_REQUIRE(BinaryDelta::Create(base, target, delta));
+    BOOST_REQUIRE(BinaryDelta::Apply(base, delta, rebuilt));
+    BOOST_CHECK(rebuilt == target);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(test_wrong_base_or_damage) {
+  INIT_STDOUT_LOGGER();
+
+  mt19937 rng(13);
+  const bytes base = RandomBytes(10000, rng);
+  bytes target = base;
+  target[5000] ^= 1;
+
+  bytes delta, rebuilt;
+  BOOST_REQUIRE(BinaryDelta::Create(base, target, delta));
+
+  bytes otherBase = base;
+  otherBase[0] ^= 1;
+  BOOST_CHECK(!BinaryDelta::Apply(otherBase, delta, rebuilt));
+
+  bytes truncated(delta.begin(), delta.end() - 3);
+  BOOST_CHECK(!BinaryDelta::Apply(base, truncated, rebuilt));
+
+  BOOST_CHECK(!BinaryDelta::Apply(base, bytes(10, 0), rebuilt));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "libUtils/BitSet.h"
+#include "libUtils/BitVector.h"
+
+#define BOOST_TEST_MODULE bitset
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+
+namespace {
+vector<bool> MakeBits(size_t size, unsigned int step) {
+  vector<bool> bits(size, false);
+  for (size_t i = 0; i < size; i += step) {
+    bits[i] = true;
+  }
+  return bits;
+}
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(bitset)
+
+BOOST_AUTO_TEST_CASE(test_set_test_count) {
+  BitSet bits(130);
+  BOOST_CHECK_EQUAL(bits.size(), 130);
+  BOOST_CHECK_EQUAL(bits.Count(), 0);
+
+  for (size_t i : {0, 7, 8, 63, 64, 129}) {
+    bits.Set(i);
+  }
+  BOOST_CHECK_EQUAL(bits.Count(), 6);
+  BOOST_CHECK(bits.Test(63));
+  BOOST_CHECK(!bits.Test(62));
+
+  bits.Set(63, false);
+  BOOST_CHECK(!bits.Test(63));
+  BOOST_CHECK_EQUAL(bits.Count(), 5);
+
+  vector<size_t> visited;
+  bits.ForEachSet([&visited](size_t index) { visited.push_back(index); });
+  BOOST_CHECK(visited == (vector<size_t>{0, 7, 8, 64, 129}));
+
+  BOOST_CHECK_THROW(bits.Test(130), out_of_range);
+  BOOST_CHECK_THROW(bits.Set(130), out_of_range);
+
+  bits.Reset(10);
+  BOOST_CHECK_EQUAL(bits.size(), 10);
+  BOOST_CHECK_EQUAL(bits.Count(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_word_operations) {
+  const BitSet twos(MakeBits(200, 2));
+  const BitSet threes(MakeBits(200, 3));
+
+  BOOST_CHECK_EQUAL(twos.CountCommon(threes), BitSet(MakeBits(200, 6)).Count());
+
+  BitSet both = twos;
+  both &= threes;
+  BOOST_CHECK(both == BitSet(MakeBits(200, 6)));
+
+  BitSet either = twos;
+  either |= threes;
+  BitSet exclusive = twos;
+  exclusive ^= threes;
+  for (size_t i = 0; i < 200; i++) {
+    BOOST_CHECK_EQUAL(either.Test(i), (i % 2 == 0) || (i % 3 == 0));
+    BOOST_CHECK_EQUAL(exclusive.Test(i), (i % 2 == 0) != (i % 3 == 0));
+  }
+
+  // Bits of a longer map do not spill past the end of a shorter one
+  BitSet shorter(70);
+  shorter |= BitSet(vector<bool>(200, true));
+  BOOST_CHECK_EQUAL(shorter.Count(), 70);
+}
+
+BOOST_AUTO_TEST_CASE(test_serialization_matches_bitvector) {
+  for (size_t size : {0, 1, 7, 8, 9, 64, 65, 600}) {
+    const vector<bool> bits = MakeBits(size, 3);
+
+    bytes expected;
+    BitVector::SetBitVector(expected, 0, bits);
+
+    bytes serialized;
+    BOOST_CHECK_EQUAL(BitSet(bits).Serialize(serialized, 0), expected.size());
+    BOOST_CHECK(serialized == expected);
+
+    BitSet deserialized;
+    BOOST_REQUIRE(deserialized.Deserialize(expected, 0));
+    BOOST_CHECK(deserialized.ToVector() == bits);
+  }
+
+  bytes truncated;
+  BitVector::SetBitVector(truncated, 0, MakeBits(100, 1));
+  truncated.pop_back();
+  BitSet bits;
+  BOOST_CHECK(!bits.Deserialize(truncated, 0));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
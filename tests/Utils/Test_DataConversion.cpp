@@ -18,8 +18,12 @@
 #include "libUtils/DataConversion.h"
 #include "libUtils/Logger.h"
 
+#include <chrono>
+#include <functional>
+
 #define BOOST_TEST_MODULE data_conversion
 #define BOOST_TEST_DYN_LINK
+#include <boost/algorithm/hex.hpp>
 #include <boost/algorithm/string.hpp>
 #include <boost/test/unit_test.hpp>
 
@@ -149,4 +153,105 @@ BOOST_AUTO_TEST_CASE(test_hexstr) {
   LOG_GENERAL(INFO, "Test HexString Conversion done!");
 }
 
+namespace {
+bytes MakeBytes(size_t size) {
+  bytes data(size);
+  for (size_t i = 0; i < size; i++) {
+    data[i] = static_cast<uint8_t>(i * 167 + 13);
+  }
+  return data;
+}
+
+std::string BoostHex(const bytes& data) {
+  std::string str;
+  boost::algorithm::hex(data.begin(), data.end(), std::back_inserter(str));
+  return str;
+}
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(test_hex_codec_matches_boost) {
+  LOG_GENERAL(INFO, "Test hex codec start...");
+
+  // Lengths around the SSSE3 and AVX2 block sizes
+  for (size_t size = 0; size < 200; size++) {
+    const bytes data = MakeBytes(size);
+    const std::string expected = BoostHex(data);
+
+    std::string str;
+    BOOST_REQUIRE(DataConversion::Uint8VecToHexStr(data, str));
+    BOOST_REQUIRE_MESSAGE(str == expected, "Encode failed for size " << size);
+
+    bytes decoded;
+    BOOST_REQUIRE(DataConversion::HexStrToUint8Vec(str, decoded));
+    BOOST_REQUIRE_MESSAGE(decoded == data, "Decode failed for size " << size);
+
+    BOOST_REQUIRE(
+        DataConversion::HexStrToUint8Vec(boost::to_lower_copy(str), decoded));
+    BOOST_REQUIRE_MESSAGE(decoded == data,
+                          "Lowercase decode failed for size " << size);
+  }
+
+  // Writing into a caller-provided buffer
+  const bytes data = MakeBytes(40);
+  char buffer[80];
+  BOOST_CHECK_EQUAL(DataConversion::HexEncode(data.data(), data.size(), buffer),
+                    80);
+  BOOST_CHECK(std::string(buffer, 80) == BoostHex(data));
+
+  uint8_t decoded[40];
+  BOOST_CHECK(DataConversion::HexDecode(buffer, 80, decoded));
+  BOOST_CHECK(bytes(decoded, decoded + 40) == data);
+  BOOST_CHECK(!DataConversion::HexDecode(buffer, 79, decoded));
+}
+
+BOOST_AUTO_TEST_CASE(test_hex_decode_rejects_invalid_chars) {
+  const std::string valid = BoostHex(MakeBytes(100));
+
+  for (const char bad : {'g', 'G', 'x', ' ', '/', ':', '@', '`', '\x80'}) {
+    for (size_t pos : {0, 1, 31, 32, 63, 64, 100, 199}) {
+      std::string hex = valid;
+      hex[pos] = bad;
+      bytes out;
+      BOOST_CHECK_MESSAGE(!DataConversion::HexStrToUint8Vec(hex, out),
+                          "Accepted '" << bad << "' at " << pos);
+    }
+  }
+
+  bytes out;
+  BOOST_CHECK(!DataConversion::HexStrToUint8Vec("abc", out));
+}
+
+BOOST_AUTO_TEST_CASE(test_hex_codec_benchmark) {
+  const unsigned int ROUNDS = 20000;
+  const bytes data = MakeBytes(256);
+  const std::string hex = BoostHex(data);
+
+  auto measure = [](const std::function<void()>& f) {
+    const auto start = std::chrono::steady_clock::now();
+    for (unsigned int i = 0; i < ROUNDS; i++) {
+      f();
+    }
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now() - start)
+        .count();
+  };
+
+  std::string str;
+  bytes out;
+  const auto boostEncode = measure([&]() { str = BoostHex(data); });
+  const auto encode =
+      measure([&]() { DataConversion::Uint8VecToHexStr(data, str); });
+  const auto boostDecode = measure([&]() {
+    out.clear();
+    boost::algorithm::unhex(hex.begin(), hex.end(), std::back_inserter(out));
+  });
+  const auto decode =
+      measure([&]() { DataConversion::HexStrToUint8Vec(hex, out); });
+
+  LOG_GENERAL(INFO, ROUNDS << " x 256 bytes: encode " << encode
+                           << " us (boost " << boostEncode << " us), decode "
+                           << decode << " us (boost " << boostDecode
+                           << " us)");
+}
+
 BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
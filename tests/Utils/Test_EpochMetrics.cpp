@@ -0,0 +1,157 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <thread>
+#include "common/Constants.h"
+#include "common/Messages.h"
+#include "libUtils/EpochMetrics.h"
+#include "libUtils/Logger.h"
+
+#define BOOST_TEST_MODULE epochmetrics
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(epochmetrics)
+
+BOOST_AUTO_TEST_CASE(test_histogram_buckets) {
+  INIT_STDOUT_LOGGER();
+
+  MetricHistogram histogram{0, 0, 0, 0, {}};
+  histogram.Add(0, 100);
+  histogram.Add(99, 100);
+  histogram.Add(100, 100);
+  histogram.Add(250, 100);
+  histogram.Add(UINT64_MAX / 2, 100);
+
+  BOOST_CHECK_EQUAL(histogram.m_count, 5);
+  BOOST_CHECK_EQUAL(histogram.m_buckets[0], 2);
+  BOOST_CHECK_EQUAL(histogram.m_buckets[1], 1);
+  BOOST_CHECK_EQUAL(histogram.m_buckets[2], 1);
+  BOOST_CHECK_EQUAL(histogram.m_buckets[MetricHistogram::NUM_BUCKETS - 1], 1);
+  BOOST_CHECK_EQUAL(histogram.m_max, UINT64_MAX / 2);
+  BOOST_CHECK_EQUAL(histogram.m_last, UINT64_MAX / 2);
+}
+
+BOOST_AUTO_TEST_CASE(test_message_stats) {
+  INIT_STDOUT_LOGGER();
+
+  EpochMetrics& metrics = EpochMetrics::GetInstance();
+  metrics.RecordMessage(MessageType::NODE, NodeInstructionType::FINALBLOCK,
+                        1000, 500);
+  metrics.RecordMessage(MessageType::NODE, NodeInstructionType::FINALBLOCK,
+                        3000, 1500);
+
+  bool found = false;
+  for (const auto& stats : metrics.GetMessageStats()) {
+    if (stats.m_msgType == MessageType::NODE &&
+        stats.m_instruction == NodeInstructionType::FINALBLOCK) {
+      found = true;
+      BOOST_CHECK_EQUAL(stats.m_name, "NODE_FINALBLOCK");
+      BOOST_CHECK_EQUAL(stats.m_time.m_count, 2);
+      BOOST_CHECK_EQUAL(stats.m_time.m_total, 2000);
+      BOOST_CHECK_EQUAL(stats.m_size.m_total, 4000);
+      BOOST_CHECK_EQUAL(stats.m_size.m_max, 3000);
+    }
+  }
+  BOOST_CHECK(found);
+
+  BOOST_CHECK(metrics.GetPrometheusText().find(
+                  "zilliqa_message_duration_seconds_count{message=\"NODE_"
+                  "FINALBLOCK\"} 2") != string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(test_phase_timer) {
+  INIT_STDOUT_LOGGER();
+
+  EpochMetrics& metrics = EpochMetrics::GetInstance();
+  metrics.OnNewEpoch(7);
+
+  EpochPhaseTimer timer;
+  timer.Enter(EPOCH_PHASE_FINALBLOCK_CONSENSUS);
+  this_thread::sleep_for(chrono::milliseconds(20));
+  // Staying in the same phase does not close it
+  timer.Enter(EPOCH_PHASE_FINALBLOCK_CONSENSUS);
+  this_thread::sleep_for(chrono::milliseconds(20));
+  timer.Enter(EPOCH_PHASE_NONE);
+  // Leaving the idle state records nothing
+  timer.Enter(EPOCH_PHASE_POW);
+
+  const auto phases = metrics.GetPhaseStats();
+  BOOST_REQUIRE_EQUAL(phases.size(), 1);
+  BOOST_CHECK_EQUAL(phases[0].m_phase, EPOCH_PHASE_FINALBLOCK_CONSENSUS);
+  BOOST_CHECK_EQUAL(phases[0].m_lastEpoch, 7);
+  BOOST_CHECK_EQUAL(phases[0].m_time.m_count, 1);
+  BOOST_CHECK_GE(phases[0].m_time.m_last, 40000);
+}
+
+BOOST_AUTO_TEST_CASE(test_epoch_timeline) {
+  INIT_STDOUT_LOGGER();
+
+  EpochTimeline& timeline = EpochTimeline::GetInstance();
+  timeline.OnNewEpoch(42, TIMELINE_ROLE_DS);
+
+  EpochPhaseTimer timer(TIMELINE_ROLE_DS);
+  timer.Enter(EPOCH_PHASE_DS_CONSENSUS);
+  this_thread::sleep_for(chrono::milliseconds(10));
+  timer.Enter(EPOCH_PHASE_NONE);
+  timeline.RecordMark(TIMELINE_MARK_FINALBLOCK_RECEIVED, TIMELINE_ROLE_DS);
+
+  // Events of earlier epochs, such as those of test_phase_timer, are left out
+  const auto events = timeline.GetEvents(42);
+  BOOST_REQUIRE_EQUAL(events.size(), 4);
+  BOOST_CHECK_EQUAL(events[0].m_kind, TIMELINE_MARK);
+  BOOST_CHECK_EQUAL(events[0].m_id, TIMELINE_MARK_NEW_EPOCH);
+  BOOST_CHECK_EQUAL(events[1].m_kind, TIMELINE_PHASE_ENTER);
+  BOOST_CHECK_EQUAL(events[1].m_id, EPOCH_PHASE_DS_CONSENSUS);
+  BOOST_CHECK_EQUAL(events[2].m_kind, TIMELINE_PHASE_EXIT);
+  BOOST_CHECK_EQUAL(events[2].m_id, EPOCH_PHASE_DS_CONSENSUS);
+  BOOST_CHECK_EQUAL(events[3].m_id, TIMELINE_MARK_FINALBLOCK_RECEIVED);
+
+  for (const auto& event : events) {
+    BOOST_CHECK_EQUAL(event.m_epoch, 42);
+    BOOST_CHECK_EQUAL(event.m_role, TIMELINE_ROLE_DS);
+  }
+  BOOST_CHECK_GE(events[2].m_monotonicMicroseconds -
+                     events[1].m_monotonicMicroseconds,
+                 10000);
+  BOOST_CHECK_GE(events[2].m_wallMicroseconds, events[1].m_wallMicroseconds);
+}
+
+BOOST_AUTO_TEST_CASE(test_epoch_timeline_wraps) {
+  INIT_STDOUT_LOGGER();
+
+  EpochTimeline& timeline = EpochTimeline::GetInstance();
+  timeline.OnNewEpoch(100, TIMELINE_ROLE_SHARD);
+  for (unsigned int i = 0; i < EPOCH_TIMELINE_EVENTS + 10; i++) {
+    timeline.RecordMark(TIMELINE_MARK_MICROBLOCK_SUBMITTED,
+                        TIMELINE_ROLE_SHARD);
+  }
+
+  // Only the newest events are kept, still oldest first
+  const auto events = timeline.GetEvents();
+  BOOST_REQUIRE_EQUAL(events.size(), EPOCH_TIMELINE_EVENTS);
+  BOOST_REQUIRE(!events.empty());
+  for (unsigned int i = 1; i < events.size(); i++) {
+    BOOST_CHECK_GE(events[i].m_monotonicMicroseconds,
+                   events[i - 1].m_monotonicMicroseconds);
+  }
+  BOOST_CHECK_EQUAL(events.front().m_id, TIMELINE_MARK_MICROBLOCK_SUBMITTED);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <map>
+#include <vector>
+#include "libUtils/ErasureCode.h"
+#include "libUtils/Logger.h"
+
+#define BOOST_TEST_MODULE erasurecode
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+
+namespace {
+
+bytes MakeData(size_t size) {
+  bytes data(size);
+  for (size_t i = 0; i < size; i++) {
+    data[i] = (i * 131 + 7) % 251;
+  }
+  return data;
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(erasurecode)
+
+BOOST_AUTO_TEST_CASE(test_any_k_chunks_decode) {
+  INIT_STDOUT_LOGGER();
+
+  const unsigned int k = 4, n = 10;
+  const bytes data = MakeData(1001);
+
+  vector<bytes> chunks;
+  BOOST_REQUIRE(ErasureCode::Encode(data, k, n, chunks));
+  BOOST_REQUIRE_EQUAL(chunks.size(), n);
+  for (const auto& chunk : chunks) {
+    BOOST_CHECK_EQUAL(chunk.size(), ErasureCode::GetChunkSize(data.size(), k));
+  }
+
+  // Every choice of k chunks out of n gives back the data
+  for (unsigned int mask = 0; mask < (1u << n); mask++) {
+    if (__builtin_popcount(mask) != (int)k) {
+      continue;
+    }
+    map<unsigned int, bytes> received;
+    for (unsigned int i = 0; i < n; i++) {
+      if (mask & (1u << i)) {
+        received.emplace(i, chunks[i]);
+      }
+    }
+    bytes decoded;
+    BOOST_REQUIRE(ErasureCode::Decode(received, k, n, data.size(), decoded));
+    BOOST_CHECK(decoded == data);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(test_large_code) {
+  INIT_STDOUT_LOGGER();
+
+  const unsigned int n = ErasureCode::MAX_CHUNKS, k = n / 2;
+  const bytes data = MakeData(100000);
+
+  vector<bytes> chunks;
+  BOOST_REQUIRE(ErasureCode::Encode(data, k, n, chunks));
+
+  // One data chunk and all but one of the parity chunks
+  map<unsigned int, bytes> received{{5, chunks[5]}};
+  for (unsigned int i = k + 1; i < n; i++) {
+    received.emplace(i, chunks[i]);
+  }
+  bytes decoded;
+  BOOST_REQUIRE(ErasureCode::Decode(received, k, n, data.size(), decoded));
+  BOOST_CHECK(decoded == data);
+}
+
+BOOST_AUTO_TEST_CASE(test_invalid_input) {
+  INIT_STDOUT_LOGGER();
+
+  vector<bytes> chunks;
+  BOOST_CHECK(!ErasureCode::Encode(MakeData(10), 0, 4, chunks));
+  BOOST_CHECK(!ErasureCode::Encode(MakeData(10), 5, 4, chunks));
+  BOOST_CHECK(!ErasureCode::Encode(MakeData(10), 1,
+                                   ErasureCode::MAX_CHUNKS + 1, chunks));
+
+  BOOST_REQUIRE(ErasureCode::Encode(MakeData(10), 2, 4, chunks));
+  map<unsigned int, bytes> received{{3, chunks[3]}};
+  bytes decoded;
+  BOOST_CHECK(!ErasureCode::Decode(received, 2, 4, 10, decoded));
+
+  received.emplace(1, bytes(1, 0));
+  BOOST_CHECK(!ErasureCode::Decode(received, 2, 4, 10, decoded));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include "libUtils/HugePages.h"
+#include "libUtils/Logger.h"
+
+#define BOOST_TEST_MODULE hugepages
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+
+namespace {
+
+bool IsZero(const char* data, size_t size) {
+  for (size_t i = 0; i < size; i++) {
+    if (data[i] != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(hugepages)
+
+BOOST_AUTO_TEST_CASE(test_parse_mode) {
+  INIT_STDOUT_LOGGER();
+
+  HugePages::Mode mode = HugePages::OFF;
+  BOOST_CHECK(HugePages::ParseMode("explicit", mode));
+  BOOST_CHECK_EQUAL(mode, HugePages::EXPLICIT);
+  BOOST_CHECK(HugePages::ParseMode("transparent", mode));
+  BOOST_CHECK_EQUAL(mode, HugePages::TRANSPARENT);
+  BOOST_CHECK(HugePages::ParseMode("off", mode));
+  BOOST_CHECK_EQUAL(mode, HugePages::OFF);
+  BOOST_CHECK(!HugePages::ParseMode("on", mode));
+}
+
+BOOST_AUTO_TEST_CASE(test_allocate_each_mode) {
+  INIT_STDOUT_LOGGER();
+
+  // Odd sizes, so that the rounding to page sizes is exercised
+  const size_t size = (5 << 20) + 123;
+  for (const auto mode :
+       {HugePages::OFF, HugePages::TRANSPARENT, HugePages::EXPLICIT}) {
+    char* data = static_cast<char*>(HugePages::Allocate(size, mode));
+    BOOST_REQUIRE(data != nullptr);
+    BOOST_CHECK(IsZero(data, size));
+    memset(data, 0xab, size);
+    if (mode != HugePages::OFF) {
+      // Explicit falls back to transparent, which is 2 MB aligned
+      BOOST_CHECK_EQUAL(reinterpret_cast<uintptr_t>(data) % (2 << 20), 0);
+    }
+    HugePages::Release(data);
+  }
+  BOOST_CHECK_EQUAL(HugePages::GetHugeBytes(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_release_foreign_pointer) {
+  INIT_STDOUT_LOGGER();
+
+  // Memory from before the allocator was switched is freed as usual
+  HugePages::Release(malloc(64));
+  HugePages::Release(nullptr);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "common/Constants.h"
+#include "libUtils/LockProfiler.h"
+
+#define BOOST_TEST_MODULE lockprofiler
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+
+namespace {
+const LockStats* Find(const vector<LockStats>& all, const string& name) {
+  for (const auto& stats : all) {
+    if (stats.m_name == name) {
+      return &stats;
+    }
+  }
+  return nullptr;
+}
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(lockprofiler)
+
+BOOST_AUTO_TEST_CASE(test_counters) {
+  LockProfiler& profiler = LockProfiler::GetInstance();
+  LockProfiler::Counters& counters = profiler.GetCounters("test::counters");
+  BOOST_CHECK_EQUAL(&counters, &profiler.GetCounters("test::counters"));
+
+  counters.RecordWait(3000);
+  counters.RecordWait(5000);
+  counters.RecordHold(7000);
+  counters.RecordHold(1000);
+
+  // Waits of another thread land in their own entry
+  thread([&counters]() { counters.RecordWait(20000); }).join();
+
+  const auto all = profiler.Collect();
+  const LockStats* stats = Find(all, "test::counters");
+  BOOST_REQUIRE(stats != nullptr);
+  BOOST_CHECK_EQUAL(stats->m_contentions, 3u);
+  BOOST_CHECK_EQUAL(stats->m_waitMicroseconds, 28u);
+  BOOST_CHECK_EQUAL(stats->m_maxWaitMicroseconds, 20u);
+  BOOST_CHECK_EQUAL(stats->m_holdMicroseconds, 8u);
+  BOOST_CHECK_EQUAL(stats->m_maxHoldMicroseconds, 7u);
+  BOOST_REQUIRE_EQUAL(stats->m_topWaiters.size(), 2u);
+  BOOST_CHECK_EQUAL(stats->m_topWaiters[0].second, 20u);
+  BOOST_CHECK_EQUAL(stats->m_topWaiters[1].second, 8u);
+
+  profiler.Reset();
+  const auto reset = profiler.Collect();
+  stats = Find(reset, "test::counters");
+  BOOST_REQUIRE(stats != nullptr);
+  BOOST_CHECK_EQUAL(stats->m_contentions, 0u);
+  BOOST_CHECK_EQUAL(stats->m_holdMicroseconds, 0u);
+  BOOST_CHECK(stats->m_topWaiters.empty());
+}
+
+BOOST_AUTO_TEST_CASE(test_profiled_mutex) {
+  ProfiledMutex a("test::mutex");
+  ProfiledMutex b("test::mutex");
+  unsigned int total = 0;
+
+  vector<thread> threads;
+  for (unsigned int i = 0; i < 4; i++) {
+    threads.emplace_back([&a, &b, &total]() {
+      for (unsigned int j = 0; j < 1000; j++) {
+        if (j % 2 == 0) {
+          lock_guard<ProfiledMutex> g(a);
+          total++;
+        } else {
+          lock(a, b);
+          lock_guard<ProfiledMutex> g(a, adopt_lock);
+          lock_guard<ProfiledMutex> g2(b, adopt_lock);
+          total++;
+        }
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  BOOST_CHECK_EQUAL(total, 4000u);
+
+  BOOST_CHECK(a.try_lock());
+  BOOST_CHECK(b.try_lock());
+  b.unlock();
+  a.unlock();
+
+  // Both mutexes share one entry, which only counts when enabled
+  const auto all = LockProfiler::GetInstance().Collect();
+  const LockStats* stats = Find(all, "test::mutex");
+  BOOST_REQUIRE(stats != nullptr);
+  if (!LOCK_PROFILING) {
+    BOOST_CHECK_EQUAL(stats->m_acquisitions, 0u);
+  } else {
+    BOOST_CHECK_GE(stats->m_acquisitions, 6000u);
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "libUtils/Logger.h"
+#include "libUtils/MemoryStats.h"
+
+#define BOOST_TEST_MODULE memorystats
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(memorystats)
+
+BOOST_AUTO_TEST_CASE(test_register_collect) {
+  INIT_STDOUT_LOGGER();
+
+  MemoryStats& stats = MemoryStats::GetInstance();
+  vector<uint64_t> values(100);
+  unordered_map<uint64_t, string> index;
+  for (uint64_t i = 0; i < 10; i++) {
+    index[i] = to_string(i);
+  }
+
+  stats.Register("Vector", [&values] {
+    MemoryUsage usage;
+    usage.m_bytes = MemoryStats::ArrayBytes(values);
+    usage.m_objects = values.size();
+    return usage;
+  });
+  stats.Register("Index", [&index] {
+    MemoryUsage usage;
+    usage.m_bytes = MemoryStats::HashContainerBytes(index);
+    usage.m_objects = index.size();
+    return usage;
+  });
+
+  auto collected = stats.Collect();
+  BOOST_REQUIRE_EQUAL(collected.size(), 2);
+  BOOST_CHECK_EQUAL(collected[0].first, "Index");
+  BOOST_CHECK_EQUAL(collected[0].second.m_objects, 10);
+  BOOST_CHECK_GE(collected[0].second.m_bytes,
+                 10 * sizeof(pair<const uint64_t, string>));
+  BOOST_CHECK_EQUAL(collected[1].first, "Vector");
+  BOOST_CHECK_EQUAL(collected[1].second.m_bytes, 100 * sizeof(uint64_t));
+
+  // Reporters are run on every Collect, so they see the current sizes
+  values.resize(200);
+  BOOST_CHECK_EQUAL(stats.Collect()[1].second.m_objects, 200);
+
+  stats.Unregister("Index");
+  collected = stats.Collect();
+  BOOST_REQUIRE_EQUAL(collected.size(), 1);
+  BOOST_CHECK_EQUAL(collected[0].first, "Vector");
+  stats.Unregister("Vector");
+  BOOST_CHECK(stats.Collect().empty());
+}
+
+BOOST_AUTO_TEST_CASE(test_resident_bytes) {
+  INIT_STDOUT_LOGGER();
+
+  BOOST_CHECK_GT(MemoryStats::GetResidentBytes(), 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
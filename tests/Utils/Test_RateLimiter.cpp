@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include "libUtils/Logger.h"
+#include "libUtils/RateLimiter.h"
+
+#define BOOST_TEST_MODULE ratelimiter
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(ratelimiter)
+
+BOOST_AUTO_TEST_CASE(test_burst_and_refill) {
+  INIT_STDOUT_LOGGER();
+
+  // Class 0 is 2/s with a burst of 4, class 1 is unlimited
+  RateLimiter limiter({{2, 4}, {0, 0}}, 10);
+  const auto start = RateLimiter::Clock::now();
+
+  for (unsigned int i = 0; i < 4; i++) {
+    BOOST_CHECK(limiter.Admit("a", {1, 100}, start));
+  }
+  BOOST_CHECK(!limiter.Admit("a", {1, 0}, start));
+  BOOST_CHECK(limiter.Admit("a", {0, 100}, start));
+
+  // Other clients have their own buckets
+  BOOST_CHECK(limiter.Admit("b", {4, 0}, start));
+
+  const auto later = start + chrono::milliseconds(1000);
+  BOOST_CHECK(limiter.Admit("a", {2, 0}, later));
+  BOOST_CHECK(!limiter.Admit("a", {1, 0}, later));
+
+  // Refills stop at the burst
+  const auto muchLater = later + chrono::seconds(60);
+  BOOST_CHECK(!limiter.Admit("a", {5, 0}, muchLater));
+  BOOST_CHECK(limiter.Admit("a", {4, 0}, muchLater));
+
+  BOOST_CHECK_EQUAL(limiter.GetAdmitted(), 8u);
+  BOOST_CHECK_EQUAL(limiter.GetRejected(), 3u);
+}
+
+BOOST_AUTO_TEST_CASE(test_all_or_nothing) {
+  INIT_STDOUT_LOGGER();
+
+  RateLimiter limiter({{1, 2}, {1, 2}}, 10);
+  const auto now = RateLimiter::Clock::now();
+
+  // Class 1 is short, so class 0 must not be charged
+  BOOST_CHECK(!limiter.Admit("a", {2, 3}, now));
+  BOOST_CHECK(limiter.Admit("a", {2, 2}, now));
+}
+
+BOOST_AUTO_TEST_CASE(test_eviction) {
+  INIT_STDOUT_LOGGER();
+
+  RateLimiter limiter({{1, 1}}, 2);
+  const auto now = RateLimiter::Clock::now();
+
+  BOOST_CHECK(limiter.Admit("a", {1}, now));
+  BOOST_CHECK(limiter.Admit("b", {1}, now));
+
+  // Nobody has refilled, so everyone is forgotten to make room
+  BOOST_CHECK(limiter.Admit("c", {1}, now));
+  BOOST_CHECK(limiter.Admit("a", {1}, now));
+  BOOST_CHECK(!limiter.Admit("c", {1}, now));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
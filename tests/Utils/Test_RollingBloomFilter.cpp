@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <random>
+#include <vector>
+#include "libUtils/Logger.h"
+#include "libUtils/RollingBloomFilter.h"
+
+#define BOOST_TEST_MODULE rollingbloomfilter
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+
+namespace {
+vector<dev::h256> RandomKeys(size_t count, mt19937_64& rng) {
+  vector<dev::h256> keys(count);
+  for (auto& key : keys) {
+    for (unsigned int i = 0; i < dev::h256::size; i++) {
+      key[i] = static_cast<uint8_t>(rng());
+    }
+  }
+  return keys;
+}
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(rollingbloomfilter)
+
+BOOST_AUTO_TEST_CASE(test_no_false_negatives) {
+  INIT_STDOUT_LOGGER();
+
+  mt19937_64 rng(1);
+  RollingBloomFilter filter(4, 10, 1 << 16, 7);
+  const auto keys = RandomKeys(4000, rng);
+  for (const auto& key : keys) {
+    filter.Insert(key);
+  }
+  for (const auto& key : keys) {
+    BOOST_CHECK(filter.MayContain(key));
+  }
+
+  // About 10 bits per key at 7 probes, so well under 1% in one slice
+  unsigned int falsePositives = 0;
+  for (const auto& key : RandomKeys(10000, rng)) {
+    falsePositives += filter.MayContain(key) ? 1 : 0;
+  }
+  BOOST_CHECK_LT(falsePositives, 100);
+
+  filter.Clear();
+  for (const auto& key : keys) {
+    BOOST_CHECK(!filter.MayContain(key));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(test_rolling) {
+  INIT_STDOUT_LOGGER();
+
+  mt19937_64 rng(2);
+  RollingBloomFilter filter(3, 10, 1 << 14, 5);
+  const auto first = RandomKeys(100, rng);
+  const auto second = RandomKeys(100, rng);
+
+  filter.NewEpoch(5);
+  for (const auto& key : first) {
+    filter.Insert(key);
+  }
+  filter.NewEpoch(15);
+  for (const auto& key : second) {
+    filter.Insert(key);
+  }
+
+  // Epochs already covered change nothing
+  filter.NewEpoch(12);
+  filter.NewEpoch(29);
+  for (const auto& key : first) {
+    BOOST_CHECK(filter.MayContain(key));
+  }
+
+  // The fourth range reuses the slice of the first
+  filter.NewEpoch(30);
+  unsigned int remembered = 0;
+  for (const auto& key : first) {
+    remembered += filter.MayContain(key) ? 1 : 0;
+  }
+  BOOST_CHECK_LT(remembered, 5);
+  for (const auto& key : second) {
+    BOOST_CHECK(filter.MayContain(key));
+  }
+
+  // A jump past every slice forgets everything
+  filter.NewEpoch(1000);
+  remembered = 0;
+  for (const auto& key : second) {
+    remembered += filter.MayContain(key) ? 1 : 0;
+  }
+  BOOST_CHECK_EQUAL(remembered, 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -83,4 +83,77 @@ BOOST_AUTO_TEST_CASE(compareAllThreeVersions) {
   BOOST_CHECK_EQUAL(hashRoot1, hashRoot3);
 }
 
+TxnHash merkleNode(uint8_t prefix, const bytes& data) {
+  SHA2<HASH_TYPE::HASH_VARIANT_256> sha2;
+  sha2.Update({prefix});
+  sha2.Update(data);
+  return TxnHash{sha2.Finalize()};
+}
+
+/// Plain level-by-level reference for ComputeMerkleRoot
+TxnHash referenceMerkleRoot(const std::vector<TxnHash>& hashes) {
+  if (hashes.empty()) {
+    return TxnHash();
+  }
+  std::vector<TxnHash> level;
+  for (const auto& hash : hashes) {
+    level.emplace_back(merkleNode(0x00, hash.asBytes()));
+  }
+  while (level.size() > 1) {
+    std::vector<TxnHash> next;
+    for (size_t i = 0; i < level.size(); i += 2) {
+      if (i + 1 == level.size()) {
+        next.emplace_back(level[i]);
+      } else {
+        bytes data = level[i].asBytes();
+        bytes right = level[i + 1].asBytes();
+        data.insert(data.end(), right.begin(), right.end());
+        next.emplace_back(merkleNode(0x01, data));
+      }
+    }
+    level.swap(next);
+  }
+  return level.front();
+}
+
+BOOST_AUTO_TEST_CASE(merkleRootMatchesReference) {
+  // Sizes below, at and above the subtree size split across threads
+  for (size_t n : {0, 1, 2, 3, 7, 1024, 1025, 3000}) {
+    std::vector<TxnHash> hashes(n);
+    for (size_t i = 0; i < n; i++) {
+      hashes[i] = merkleNode(0xff, DataConversion::StringToCharArray(
+                                       std::to_string(i)));
+    }
+    BOOST_CHECK_MESSAGE(
+        ComputeMerkleRoot(hashes) == referenceMerkleRoot(hashes),
+        "Merkle root mismatch for " << n << " hashes");
+  }
+}
+
+BOOST_AUTO_TEST_CASE(microBlockTxRootFollowsVersion) {
+  std::vector<TxnHash> hashes;
+  for (uint8_t i = 0; i < 10; i++) {
+    hashes.emplace_back(merkleNode(0xff, {i}));
+  }
+
+  const uint32_t merkleVersion = TXROOT_MERKLE_MICROBLOCK_VERSION;
+  BOOST_CHECK_EQUAL(ComputeMicroBlockTxRoot(merkleVersion - 1, hashes),
+                    ComputeRoot(hashes));
+  BOOST_CHECK_EQUAL(ComputeMicroBlockTxRoot(merkleVersion, hashes),
+                    ComputeMerkleRoot(hashes));
+
+  // A memoized root is not reused once the hashes change
+  const BlockHash microBlockHash(1);
+  const TxnHash root =
+      ComputeMicroBlockTxRoot(microBlockHash, merkleVersion, hashes);
+  BOOST_CHECK_EQUAL(root, ComputeMerkleRoot(hashes));
+  BOOST_CHECK_EQUAL(
+      ComputeMicroBlockTxRoot(microBlockHash, merkleVersion, hashes), root);
+
+  hashes.pop_back();
+  BOOST_CHECK_EQUAL(
+      ComputeMicroBlockTxRoot(microBlockHash, merkleVersion, hashes),
+      ComputeMerkleRoot(hashes));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
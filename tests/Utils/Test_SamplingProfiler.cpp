@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <chrono>
+#include <sstream>
+#include <string>
+#include "libUtils/Logger.h"
+#include "libUtils/SamplingProfiler.h"
+
+#define BOOST_TEST_MODULE samplingprofiler
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+
+namespace {
+volatile uint64_t g_sink = 0;
+
+void BurnCpu(chrono::milliseconds duration) {
+  const auto end = chrono::steady_clock::now() + duration;
+  while (chrono::steady_clock::now() < end) {
+    for (unsigned int i = 0; i < 10000; i++) {
+      g_sink = g_sink * 31 + i;
+    }
+  }
+}
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(samplingprofiler)
+
+BOOST_AUTO_TEST_CASE(test_start_stop) {
+  INIT_STDOUT_LOGGER();
+
+  SamplingProfiler& profiler = SamplingProfiler::GetInstance();
+  SamplingProfiler::Profile profile;
+
+  BOOST_CHECK(!profiler.Stop(profile));
+  BOOST_CHECK(!profiler.Start(0));
+  BOOST_CHECK(!profiler.Start(SamplingProfiler::MAX_FREQUENCY + 1));
+
+  BOOST_REQUIRE(profiler.Start(SamplingProfiler::MAX_FREQUENCY));
+  BOOST_CHECK(profiler.IsRunning());
+  BOOST_CHECK(!profiler.Start(100));
+  BurnCpu(chrono::milliseconds(300));
+  BOOST_REQUIRE(profiler.Stop(profile));
+  BOOST_CHECK(!profiler.IsRunning());
+
+  BOOST_CHECK_GT(profile.m_samples, 0);
+
+  // Every line is a stack of the test thread, ending with its count
+  uint64_t total = 0;
+  istringstream lines(profile.m_folded);
+  string line;
+  while (getline(lines, line)) {
+    const size_t space = line.find_last_of(' ');
+    BOOST_REQUIRE(space != string::npos);
+    BOOST_CHECK(line.find(';') < space);
+    total += stoull(line.substr(space + 1));
+  }
+  BOOST_CHECK_EQUAL(total, profile.m_samples);
+
+  // Runs can follow each other
+  BOOST_REQUIRE(profiler.Start(100));
+  BOOST_REQUIRE(profiler.Stop(profile));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,165 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "libUtils/Logger.h"
+#include "libUtils/Scheduler.h"
+
+#define BOOST_TEST_MODULE scheduler
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+
+namespace {
+/// Waits up to timeout for pred to hold
+template <class Pred>
+bool WaitFor(Pred pred, chrono::milliseconds timeout) {
+  const auto end = chrono::steady_clock::now() + timeout;
+  while (!pred()) {
+    if (chrono::steady_clock::now() > end) {
+      return false;
+    }
+    this_thread::sleep_for(chrono::milliseconds(1));
+  }
+  return true;
+}
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(scheduler)
+
+BOOST_AUTO_TEST_CASE(test_schedule_after) {
+  INIT_STDOUT_LOGGER();
+
+  Scheduler scheduler(chrono::milliseconds(1));
+  mutex m;
+  vector<unsigned int> order;
+  vector<chrono::steady_clock::duration> elapsed;
+  const auto start = chrono::steady_clock::now();
+  auto record = [&](unsigned int i) {
+    return [&, i]() {
+      lock_guard<mutex> g(m);
+      order.push_back(i);
+      elapsed.push_back(chrono::steady_clock::now() - start);
+    };
+  };
+
+  // Spread over the first three levels of the wheel
+  scheduler.ScheduleAfter(chrono::milliseconds(4200), record(4));
+  scheduler.ScheduleAfter(chrono::milliseconds(100), record(2));
+  scheduler.ScheduleAfter(chrono::milliseconds(0), record(0));
+  scheduler.ScheduleAfter(chrono::milliseconds(30), record(1));
+  scheduler.ScheduleAfter(chrono::milliseconds(700), record(3));
+  BOOST_CHECK_EQUAL(scheduler.GetStats().m_pending, 5);
+
+  BOOST_REQUIRE(WaitFor([&]() {
+    lock_guard<mutex> g(m);
+    return order.size() == 5;
+  }, chrono::milliseconds(10000)));
+  BOOST_CHECK((order == vector<unsigned int>{0, 1, 2, 3, 4}));
+
+  const vector<unsigned int> delays{0, 30, 100, 700, 4200};
+  for (unsigned int i = 0; i < delays.size(); i++) {
+    BOOST_CHECK(elapsed[i] >= chrono::milliseconds(delays[i]));
+    BOOST_CHECK(elapsed[i] < chrono::milliseconds(delays[i] + 500));
+  }
+
+  const Scheduler::Stats stats = scheduler.GetStats();
+  BOOST_CHECK_EQUAL(stats.m_pending, 0);
+  BOOST_CHECK_EQUAL(stats.m_fired, 5);
+  BOOST_CHECK_EQUAL(stats.m_byName.at("default").m_fired, 5);
+}
+
+BOOST_AUTO_TEST_CASE(test_cancel) {
+  INIT_STDOUT_LOGGER();
+
+  Scheduler scheduler(chrono::milliseconds(1));
+  atomic<unsigned int> fired{0};
+  vector<Scheduler::TimerId> ids;
+  for (unsigned int i = 0; i < 1000; i++) {
+    ids.push_back(scheduler.ScheduleAfter(chrono::milliseconds(50 + i),
+                                          [&fired]() { fired++; }, "test"));
+  }
+  for (unsigned int i = 0; i < ids.size(); i += 2) {
+    BOOST_CHECK(scheduler.Cancel(ids[i]));
+  }
+  BOOST_CHECK(!scheduler.Cancel(ids[0]));
+  BOOST_CHECK_EQUAL(scheduler.GetStats().m_byName.at("test").m_pending, 500);
+
+  BOOST_REQUIRE(WaitFor([&fired]() { return fired == 500; },
+                        chrono::milliseconds(5000)));
+  this_thread::sleep_for(chrono::milliseconds(50));
+  BOOST_CHECK_EQUAL(fired, 500);
+  BOOST_CHECK(!scheduler.Cancel(ids[1]));
+
+  const Scheduler::NameStats stats = scheduler.GetStats().m_byName.at("test");
+  BOOST_CHECK_EQUAL(stats.m_pending, 0);
+  BOOST_CHECK_EQUAL(stats.m_fired, 500);
+  BOOST_CHECK_EQUAL(stats.m_cancelled, 500);
+}
+
+BOOST_AUTO_TEST_CASE(test_cancel_waits_for_firing_task) {
+  INIT_STDOUT_LOGGER();
+
+  Scheduler scheduler(chrono::milliseconds(1));
+  atomic<bool> started{false};
+  atomic<bool> finished{false};
+  const auto id = scheduler.ScheduleAfter(chrono::milliseconds(10), [&]() {
+    started = true;
+    this_thread::sleep_for(chrono::milliseconds(200));
+    finished = true;
+  });
+
+  BOOST_REQUIRE(WaitFor([&started]() { return started.load(); },
+                        chrono::milliseconds(5000)));
+  BOOST_CHECK(!scheduler.Cancel(id));
+  BOOST_CHECK(finished);
+}
+
+BOOST_AUTO_TEST_CASE(test_schedule_periodically) {
+  INIT_STDOUT_LOGGER();
+
+  Scheduler scheduler(chrono::milliseconds(1));
+  atomic<unsigned int> fired{0};
+  const auto id = scheduler.SchedulePeriodically(
+      chrono::milliseconds(20), [&fired]() { fired++; }, "periodic");
+
+  BOOST_REQUIRE(WaitFor([&fired]() { return fired >= 5; },
+                        chrono::milliseconds(5000)));
+  BOOST_CHECK(scheduler.Cancel(id));
+  const unsigned int count = fired;
+  this_thread::sleep_for(chrono::milliseconds(100));
+  BOOST_CHECK_EQUAL(fired, count);
+  BOOST_CHECK_EQUAL(scheduler.GetStats().m_pending, 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_prometheus_text) {
+  INIT_STDOUT_LOGGER();
+
+  Scheduler scheduler;
+  scheduler.ScheduleAfter(chrono::seconds(60), []() {}, "consensus");
+  const string text = scheduler.GetPrometheusText();
+  BOOST_CHECK(text.find("zilliqa_timers_pending{name=\"consensus\"} 1\n") !=
+              string::npos);
+  BOOST_CHECK(text.find("zilliqa_timers_fired_total{name=\"consensus\"} 0\n") !=
+              string::npos);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -59,4 +59,53 @@ BOOST_AUTO_TEST_CASE(testSerializable) {
                                          32);  // boost, fixed size
 }
 
+template <class number_type, unsigned int size>
+void testFixedWidth(const number_type& n) {
+  bytes runtime(3, 0xEE);
+  Serializable::SetNumber<number_type>(runtime, 3, n, size);
+
+  bytes fixed(3, 0xEE);
+  Serializable::SetNumber<number_type, size>(fixed, 3, n);
+  BOOST_CHECK(fixed == runtime);
+
+  const auto decoded = Serializable::GetNumber<number_type, size>(fixed, 3);
+  BOOST_CHECK(decoded ==
+              Serializable::GetNumber<number_type>(runtime, 3, size));
+
+  const auto outOfRange = Serializable::GetNumber<number_type, size>(fixed, 4);
+  BOOST_CHECK(outOfRange == 0);
+}
+
+BOOST_AUTO_TEST_CASE(testFixedWidthSerializable) {
+  INIT_STDOUT_LOGGER();
+
+  testFixedWidth<uint8_t, 1>(0xAB);
+  testFixedWidth<uint16_t, 2>(0xABCD);
+  testFixedWidth<uint32_t, 4>(0x0102A3B4);
+  testFixedWidth<uint64_t, 8>(0x0102030405A6B7C8);
+  testFixedWidth<uint64_t, 5>(0x0102030405A6B7C8);
+  testFixedWidth<int32_t, 4>(-2);
+  testFixedWidth<boost::multiprecision::uint128_t, 16>(
+      boost::multiprecision::uint128_t("0x0102030405060708090a0b0c0d0e0f10"));
+
+  bytes v;
+  Serializable::SetNumber<uint32_t, 4>(v, 0, 0x01020304);
+  BOOST_CHECK(v == bytes({0x01, 0x02, 0x03, 0x04}));
+}
+
+BOOST_AUTO_TEST_CASE(testSerializableWriter) {
+  INIT_STDOUT_LOGGER();
+
+  bytes v = {0xFF};
+  SerializableWriter writer(v, 1);
+  writer.Reserve(2 + 4 + 3);
+  writer.Write<uint16_t, 2>(0x0102);
+  writer.Write<uint32_t, 4>(0x03040506);
+  writer.WriteBytes(bytes({0x07, 0x08, 0x09}));
+
+  BOOST_CHECK_EQUAL(writer.GetOffset(), 10);
+  BOOST_CHECK(v == bytes({0xFF, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+                          0x08, 0x09}));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
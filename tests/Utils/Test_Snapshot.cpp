@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "libUtils/Snapshot.h"
+
+#define BOOST_TEST_MODULE snapshot
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(snapshot)
+
+BOOST_AUTO_TEST_CASE(test_publish_and_get) {
+  Snapshot<vector<int>> snapshot;
+  BOOST_REQUIRE(snapshot.Get() != nullptr);
+  BOOST_CHECK(snapshot.Get()->empty());
+  BOOST_CHECK_EQUAL(snapshot.GetEpoch(), 0u);
+
+  vector<int> value = {1, 2, 3};
+  snapshot.Publish(value, 5);
+  const auto first = snapshot.Get();
+  BOOST_CHECK_EQUAL(first->size(), 3u);
+  BOOST_CHECK_EQUAL(snapshot.GetEpoch(), 5u);
+
+  // Later changes to the original are not seen until republished
+  value.push_back(4);
+  BOOST_CHECK_EQUAL(snapshot.Get()->size(), 3u);
+
+  snapshot.Publish(value, 6);
+  BOOST_CHECK_EQUAL(snapshot.Get()->size(), 4u);
+  BOOST_CHECK_EQUAL(snapshot.GetEpoch(), 6u);
+
+  // A copy handed out earlier stays intact
+  BOOST_CHECK_EQUAL(first->size(), 3u);
+}
+
+BOOST_AUTO_TEST_CASE(test_concurrent_readers) {
+  Snapshot<vector<int>> snapshot;
+  atomic<bool> done(false);
+  atomic<unsigned int> torn(0);
+
+  vector<thread> readers;
+  for (unsigned int i = 0; i < 4; i++) {
+    readers.emplace_back([&snapshot, &done, &torn]() {
+      while (!done) {
+        const auto value = snapshot.Get();
+        // Every published vector holds its own size in each element
+        for (const auto& v : *value) {
+          if (v != static_cast<int>(value->size())) {
+            torn++;
+          }
+        }
+      }
+    });
+  }
+
+  for (unsigned int n = 1; n <= 1000; n++) {
+    snapshot.Publish(vector<int>(n % 64, n % 64), n);
+  }
+  done = true;
+
+  for (auto& reader : readers) {
+    reader.join();
+  }
+  BOOST_CHECK_EQUAL(torn.load(), 0u);
+  BOOST_CHECK_EQUAL(snapshot.GetEpoch(), 1000u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <sched.h>
+#include <string>
+#include <thread>
+#include <vector>
+#include "libUtils/Logger.h"
+#include "libUtils/ThreadPlacement.h"
+
+#define BOOST_TEST_MODULE threadplacement
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(threadplacement)
+
+BOOST_AUTO_TEST_CASE(test_cpu_lists) {
+  INIT_STDOUT_LOGGER();
+
+  vector<unsigned int> cpus;
+  BOOST_CHECK(ThreadPlacement::ParseCpuList("0-3,8,10-11\n", cpus));
+  BOOST_CHECK((cpus == vector<unsigned int>{0, 1, 2, 3, 8, 10, 11}));
+
+  // Overlaps are merged
+  BOOST_CHECK(ThreadPlacement::ParseCpuList("4, 2-4", cpus));
+  BOOST_CHECK((cpus == vector<unsigned int>{2, 3, 4}));
+
+  BOOST_CHECK(!ThreadPlacement::ParseCpuList("", cpus));
+  BOOST_CHECK(!ThreadPlacement::ParseCpuList("3-1", cpus));
+  BOOST_CHECK(!ThreadPlacement::ParseCpuList("1-", cpus));
+  BOOST_CHECK(!ThreadPlacement::ParseCpuList("-1", cpus));
+  BOOST_CHECK(!ThreadPlacement::ParseCpuList("a", cpus));
+  BOOST_CHECK(!ThreadPlacement::ParseCpuList("0-99999", cpus));
+}
+
+BOOST_AUTO_TEST_CASE(test_specs) {
+  INIT_STDOUT_LOGGER();
+
+  ThreadPlacement placement;
+  BOOST_CHECK(placement.Parse(""));
+  BOOST_CHECK(placement.IsEmpty());
+
+  BOOST_CHECK(placement.Parse("1,3"));
+  BOOST_CHECK((placement.GetCpus() == vector<unsigned int>{1, 3}));
+  BOOST_CHECK_EQUAL(placement.GetNumaNode(), -1);
+  BOOST_CHECK((placement.GetOneCpu(3).GetCpus() == vector<unsigned int>{3}));
+
+  BOOST_CHECK(!placement.Parse("node:x"));
+  BOOST_CHECK(placement.IsEmpty());
+  BOOST_CHECK(!placement.Parse("nic:../../x"));
+  BOOST_CHECK(!placement.Parse("nic:no-such-nic"));
+
+  // Every Linux machine has node 0, even without NUMA
+  if (placement.Parse("node:0")) {
+    BOOST_CHECK(!placement.IsEmpty());
+    BOOST_CHECK_EQUAL(placement.GetNumaNode(), 0);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(test_apply) {
+  INIT_STDOUT_LOGGER();
+
+  cpu_set_t allowed;
+  BOOST_REQUIRE(sched_getaffinity(0, sizeof(allowed), &allowed) == 0);
+  unsigned int cpu = 0;
+  while (!CPU_ISSET(cpu, &allowed)) {
+    cpu++;
+  }
+
+  ThreadPlacement placement;
+  BOOST_REQUIRE(placement.Parse(to_string(cpu)));
+
+  thread([&placement, cpu]() {
+    BOOST_CHECK(placement.ApplyToCurrentThread());
+    cpu_set_t cpuset;
+    BOOST_REQUIRE(sched_getaffinity(0, sizeof(cpuset), &cpuset) == 0);
+    BOOST_CHECK_EQUAL(CPU_COUNT(&cpuset), 1);
+    BOOST_CHECK(CPU_ISSET(cpu, &cpuset));
+  }).join();
+
+  // An empty placement leaves the thread alone
+  BOOST_CHECK(ThreadPlacement().ApplyToCurrentThread());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
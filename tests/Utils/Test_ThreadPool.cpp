@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "libUtils/Logger.h"
+#include "libUtils/ThreadPool.h"
+
+#define BOOST_TEST_MODULE threadpool
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(threadpool)
+
+bool WaitFor(const atomic<unsigned int>& counter, unsigned int expected) {
+  for (unsigned int i = 0; i < 1000 && counter < expected; i++) {
+    this_thread::sleep_for(chrono::milliseconds(10));
+  }
+  return counter == expected;
+}
+
+BOOST_AUTO_TEST_CASE(test_add_job) {
+  INIT_STDOUT_LOGGER();
+
+  atomic<unsigned int> counter{0};
+  ThreadPool pool(4, "TestPool");
+
+  const unsigned int count = 10000;
+  for (unsigned int i = 0; i < count; i++) {
+    pool.AddJob([&counter]() { counter++; });
+  }
+
+  BOOST_CHECK(WaitFor(counter, count));
+}
+
+BOOST_AUTO_TEST_CASE(test_add_jobs_move_only) {
+  INIT_STDOUT_LOGGER();
+
+  atomic<unsigned int> counter{0};
+  ThreadPool pool(4, "TestPool");
+
+  vector<ThreadPool::Job> jobs;
+  const unsigned int count = 1000;
+  for (unsigned int i = 0; i < count; i++) {
+    unique_ptr<unsigned int> value(new unsigned int(2));
+    jobs.emplace_back([&counter, v = move(value)]() { counter += *v; });
+  }
+
+  pool.AddJobs(jobs.begin(), jobs.end());
+
+  BOOST_CHECK(WaitFor(counter, 2 * count));
+}
+
+BOOST_AUTO_TEST_CASE(test_nested_add_job) {
+  INIT_STDOUT_LOGGER();
+
+  atomic<unsigned int> counter{0};
+  ThreadPool pool(2, "TestPool");
+
+  // Jobs added from inside the pool go to the worker's own deque and must
+  // still be picked up (or stolen) by the other thread
+  pool.AddJob([&pool, &counter]() {
+    for (unsigned int i = 0; i < 100; i++) {
+      pool.AddJob([&counter]() {
+        this_thread::sleep_for(chrono::milliseconds(1));
+        counter++;
+      });
+    }
+  });
+
+  BOOST_CHECK(WaitFor(counter, 100));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
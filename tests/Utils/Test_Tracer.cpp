@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <thread>
+#include "common/Constants.h"
+#include "libUtils/Logger.h"
+#include "libUtils/Tracer.h"
+
+#define BOOST_TEST_MODULE tracer
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(tracer)
+
+BOOST_AUTO_TEST_CASE(test_thread_ring_and_retire) {
+  INIT_STDOUT_LOGGER();
+
+  Tracer& tracer = Tracer::GetInstance();
+
+  // The calling thread's ring keeps the newest TRACE_BUFFER_EVENTS spans
+  for (uint64_t i = 0; i < TRACE_BUFFER_EVENTS + 10; i++) {
+    tracer.Record("main", i, 1);
+  }
+
+  // An exited thread's spans move to the shared ring
+  int32_t workerTid = 0;
+  thread worker([&workerTid, &tracer]() {
+    workerTid = Logger::GetPid();
+    tracer.Record("worker", 5, 2);
+  });
+  worker.join();
+
+  bool foundMain = false, foundWorker = false;
+  for (const auto& thread : tracer.GetEvents()) {
+    if (thread.m_tid == Logger::GetPid()) {
+      foundMain = true;
+      BOOST_REQUIRE_EQUAL(thread.m_events.size(), TRACE_BUFFER_EVENTS);
+      BOOST_CHECK_EQUAL(thread.m_events.front().m_startInMicroseconds, 10);
+      BOOST_CHECK_EQUAL(thread.m_events.back().m_startInMicroseconds,
+                        TRACE_BUFFER_EVENTS + 9);
+    } else if (thread.m_tid == workerTid) {
+      foundWorker = true;
+      BOOST_REQUIRE_EQUAL(thread.m_events.size(), 1);
+      BOOST_CHECK_EQUAL(thread.m_events[0].m_name, string("worker"));
+      BOOST_CHECK_EQUAL(thread.m_events[0].m_durationInMicroseconds, 2);
+    }
+  }
+  BOOST_CHECK(foundMain);
+  BOOST_CHECK(foundWorker);
+
+  const string trace = tracer.GetChromeTrace();
+  BOOST_CHECK(trace.find("\"traceEvents\":[") != string::npos);
+  BOOST_CHECK(trace.find("{\"name\":\"worker\",\"ph\":\"X\"") !=
+              string::npos);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
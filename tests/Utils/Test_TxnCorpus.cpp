@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <boost/filesystem.hpp>
+#include <fstream>
+#include <vector>
+#include "libUtils/Logger.h"
+#include "libUtils/TxnCorpus.h"
+
+#define BOOST_TEST_MODULE txncorpus
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+
+namespace {
+
+const string CORPUS_PATH = "Test_TxnCorpus.zilc";
+
+Address MakeAddress(unsigned char seed) {
+  Address addr;
+  addr.asArray().fill(seed);
+  return addr;
+}
+
+// Txns of distinct sizes, so that a slice off by one shows up
+bytes MakeTxn(unsigned char sender, uint64_t nonce) {
+  return bytes(nonce % 7 + 1, (unsigned char)(sender ^ nonce));
+}
+
+void WriteCorpus(uint64_t firstNonce, uint64_t numTxns) {
+  TxnCorpusWriter writer(CORPUS_PATH);
+  for (unsigned char sender = 1; sender <= 3; sender++) {
+    BOOST_REQUIRE(writer.BeginSender(MakeAddress(sender), firstNonce));
+    for (uint64_t nonce = firstNonce; nonce < firstNonce + numTxns; nonce++) {
+      BOOST_REQUIRE(writer.AddTxn(MakeTxn(sender, nonce)));
+    }
+    BOOST_REQUIRE(writer.EndSender());
+  }
+  BOOST_REQUIRE(writer.Finish());
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(txncorpus)
+
+BOOST_AUTO_TEST_CASE(sliceBySenderAndNonce) {
+  INIT_STDOUT_LOGGER();
+
+  WriteCorpus(101, 50);
+
+  TxnCorpus corpus;
+  BOOST_REQUIRE(corpus.Open(CORPUS_PATH));
+  BOOST_CHECK_EQUAL(corpus.GetNumSenders(), 3);
+
+  TxnCorpus::Slice slice;
+  BOOST_REQUIRE(corpus.GetSlice(MakeAddress(2), 110, 20, slice));
+  BOOST_REQUIRE_EQUAL(slice.m_txnSizes.size(), 20);
+
+  // The slice is the txns back to back and nothing else
+  bytes expected;
+  for (uint64_t nonce = 110; nonce < 130; nonce++) {
+    const bytes txn = MakeTxn(2, nonce);
+    BOOST_CHECK_EQUAL(slice.m_txnSizes[nonce - 110], txn.size());
+    expected.insert(expected.end(), txn.begin(), txn.end());
+  }
+  BOOST_CHECK_EQUAL(slice.m_size, expected.size());
+  BOOST_CHECK(bytes(slice.m_data, slice.m_data + slice.m_size) == expected);
+
+  // Cut short at the last txn of the sender
+  BOOST_REQUIRE(corpus.GetSlice(MakeAddress(3), 140, 100, slice));
+  BOOST_CHECK_EQUAL(slice.m_txnSizes.size(), 11);
+
+  BOOST_CHECK(!corpus.GetSlice(MakeAddress(1), 100, 1, slice));
+  BOOST_CHECK(!corpus.GetSlice(MakeAddress(1), 151, 1, slice));
+  BOOST_CHECK(!corpus.GetSlice(MakeAddress(4), 101, 1, slice));
+
+  boost::filesystem::remove(CORPUS_PATH);
+}
+
+BOOST_AUTO_TEST_CASE(rejectBadCorpus) {
+  INIT_STDOUT_LOGGER();
+
+  TxnCorpusWriter writer(CORPUS_PATH);
+  BOOST_REQUIRE(writer.BeginSender(MakeAddress(1), 1));
+  BOOST_CHECK(!writer.BeginSender(MakeAddress(2), 1));
+  BOOST_REQUIRE(writer.EndSender());
+  BOOST_CHECK(!writer.BeginSender(MakeAddress(1), 1));
+  BOOST_REQUIRE(writer.Finish());
+
+  WriteCorpus(1, 10);
+  const auto size = boost::filesystem::file_size(CORPUS_PATH);
+
+  // Losing the end of the file loses the sender table
+  boost::filesystem::resize_file(CORPUS_PATH, size - 1);
+  TxnCorpus corpus;
+  BOOST_CHECK(!corpus.Open(CORPUS_PATH));
+  BOOST_CHECK(!corpus.IsOpen());
+
+  {
+    ofstream file(CORPUS_PATH, ios::binary | ios::trunc);
+    file << "not a txn corpus at all";
+  }
+  BOOST_CHECK(!corpus.Open(CORPUS_PATH));
+
+  boost::filesystem::remove(CORPUS_PATH);
+  BOOST_CHECK(!corpus.Open(CORPUS_PATH));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
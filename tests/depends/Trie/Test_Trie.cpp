@@ -538,6 +538,47 @@ BOOST_AUTO_TEST_CASE(trieLowerBound) {
   }
 }
 
+BOOST_AUTO_TEST_CASE(buildTrie) {
+  INIT_STDOUT_LOGGER();
+
+  LOG_MARKER();
+
+  // Addresses as keys, as in the state trie
+  for (unsigned int count : {0, 1, 2, 17, 1000}) {
+    BytesMap entries;
+    MemoryDB insertedDB;
+    GenericTrieDB<MemoryDB> inserted(&insertedDB);
+    inserted.init();
+    for (unsigned int i = 0; i < count; i++) {
+      const bytes key = h160::random().asBytes();
+      const bytes value = h256::random().asBytes();
+      entries[key] = value;
+      inserted.insert(key, value);
+    }
+
+    vector<pair<h256, bytes>> nodes;
+    const h256 root = dev::buildTrie(entries, nodes);
+    BOOST_CHECK_EQUAL(root, inserted.root());
+    BOOST_CHECK_EQUAL(root, hash256(entries));
+
+    MemoryDB builtDB;
+    for (const auto& node : nodes) {
+      builtDB.insert(node.first, &node.second);
+    }
+    GenericTrieDB<MemoryDB> built(&builtDB);
+    built.setRoot(root);
+    for (const auto& entry : entries) {
+      BOOST_CHECK(built.at(entry.first) == asString(entry.second));
+    }
+
+    // The built trie takes further updates like the other one
+    const bytes key = h160::random().asBytes();
+    built.insert(key, key);
+    inserted.insert(key, key);
+    BOOST_CHECK_EQUAL(built.root(), inserted.root());
+  }
+}
+
 // BOOST_AUTO_TEST_CASE(trieStess)
 // {
 //     LOG_GENERAL(INFO, "Stress-testing Trie...");
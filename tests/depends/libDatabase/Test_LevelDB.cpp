@@ -67,4 +67,40 @@ BOOST_AUTO_TEST_CASE(fat_trie) {
   LOG_GENERAL(INFO, m_testDB.Lookup((boost::multiprecision::uint256_t)3));
 }
 
+BOOST_AUTO_TEST_CASE(write_batch) {
+  INIT_STDOUT_LOGGER();
+
+  LOG_MARKER();
+
+  LevelDB m_testDB("test_batch");
+
+  const bytes body = {'k', 'i', 'w', 'i'};
+  const h256 key(1);
+
+  LevelDB::WriteBatch batch;
+  batch.Put((boost::multiprecision::uint256_t)10, body);
+  batch.Put(key, body);
+  batch.Put(leveldb::Slice("plain"), leveldb::Slice("value"));
+  BOOST_CHECK_EQUAL(batch.Count(), 3);
+
+  BOOST_CHECK_MESSAGE(m_testDB.Write(batch), "ERROR: batch write failed");
+
+  // Keys must match the ones Insert would have used
+  BOOST_CHECK_MESSAGE(
+      m_testDB.Lookup((boost::multiprecision::uint256_t)10) == "kiwi",
+      "ERROR: (boost_int, bytes)");
+  BOOST_CHECK_MESSAGE(m_testDB.Lookup(key.hex()) == "kiwi",
+                      "ERROR: (h256, bytes)");
+  BOOST_CHECK_MESSAGE(m_testDB.Lookup("plain") == "value",
+                      "ERROR: (slice, slice)");
+
+  LevelDB::WriteBatch deletes;
+  deletes.Delete(leveldb::Slice("plain"));
+  BOOST_CHECK_MESSAGE(m_testDB.Write(deletes), "ERROR: batch delete failed");
+  BOOST_CHECK_MESSAGE(!m_testDB.Exists(string("plain")),
+                      "ERROR: key not deleted");
+
+  m_testDB.ResetDB();
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <string>
+
+#define BOOST_TEST_MODULE nodecachetest
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include "depends/common/SHA3.h"
+#include "depends/libDatabase/NodeCache.h"
+#include "libUtils/Logger.h"
+
+using namespace std;
+using namespace dev;
+
+BOOST_AUTO_TEST_SUITE(nodecachetest)
+
+BOOST_AUTO_TEST_CASE(hitsAndMisses) {
+  INIT_STDOUT_LOGGER();
+
+  NodeCache cache(1024 * 1024, 4, 16);
+  const h256 a = sha3(string("a"));
+  const h256 b = sha3(string("b"));
+
+  string value;
+  BOOST_CHECK(!cache.Get(a, value));
+
+  cache.Put(a, "node a");
+  BOOST_CHECK(cache.Get(a, value));
+  BOOST_CHECK_EQUAL(value, "node a");
+
+  cache.PutMissing(b);
+  value = "stale";
+  BOOST_CHECK(cache.Get(b, value));
+  BOOST_CHECK(value.empty());
+
+  // Once written the node must be looked up again
+  cache.ForgetMissing(b);
+  BOOST_CHECK(!cache.Get(b, value));
+
+  NodeCache::Stats stats = cache.GetStats();
+  BOOST_CHECK_EQUAL(stats.m_hits, 1);
+  BOOST_CHECK_EQUAL(stats.m_negativeHits, 1);
+  BOOST_CHECK_EQUAL(stats.m_misses, 2);
+
+  cache.Clear();
+  BOOST_CHECK(!cache.Get(a, value));
+  BOOST_CHECK_EQUAL(cache.Size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(evictsLeastRecentlyUsed) {
+  INIT_STDOUT_LOGGER();
+
+  // A single shard holding about three 200-byte nodes
+  NodeCache cache(1000, 1, 2);
+  const string node(200, 'x');
+  const h256 keys[4] = {sha3(string("0")), sha3(string("1")),
+                        sha3(string("2")), sha3(string("3"))};
+
+  cache.Put(keys[0], node);
+  cache.Put(keys[1], node);
+  cache.Put(keys[2], node);
+
+  string value;
+  BOOST_CHECK(cache.Get(keys[0], value));
+
+  cache.Put(keys[3], node);
+  BOOST_CHECK(cache.Size() <= 1000);
+  BOOST_CHECK(cache.Get(keys[0], value));
+  BOOST_CHECK(!cache.Get(keys[1], value));
+  BOOST_CHECK(cache.Get(keys[3], value));
+
+  // Nodes bigger than the budget are not kept at all
+  const h256 big = sha3(string("big"));
+  cache.Put(big, string(2000, 'y'));
+  BOOST_CHECK(!cache.Get(big, value));
+
+  // The negative cache is bounded by count
+  cache.PutMissing(sha3(string("m0")));
+  cache.PutMissing(sha3(string("m1")));
+  cache.PutMissing(sha3(string("m2")));
+  BOOST_CHECK(!cache.Get(sha3(string("m0")), value));
+  BOOST_CHECK(cache.Get(sha3(string("m2")), value));
+}
+
+BOOST_AUTO_TEST_SUITE_END()